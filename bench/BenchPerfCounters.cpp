@@ -0,0 +1,128 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#include "BenchPerfCounters.h"
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #define SK_BENCH_PERF_EVENTS
+#endif
+
+static const char* gNames[] = {
+    "cycles",
+    "instructions",
+    "L1dMisses",
+    "LLCMisses",
+    "branchMisses",
+    "dTLBMisses",
+};
+SK_COMPILE_ASSERT(SK_ARRAY_COUNT(gNames) == BenchPerfCounters::kEventCount, names_match_events);
+
+const char* BenchPerfCounters::Name(Event event) {
+    return gNames[event];
+}
+
+BenchPerfCounters::BenchPerfCounters() {
+    for (int i = 0; i < kEventCount; ++i) {
+        fFDs[i] = -1;
+        fCounts[i] = -1;
+    }
+}
+
+#ifdef SK_BENCH_PERF_EVENTS
+
+static uint64_t cache_miss(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+static const struct {
+    uint32_t fType;
+    uint64_t fConfig;
+} gEvents[] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB) },
+};
+SK_COMPILE_ASSERT(SK_ARRAY_COUNT(gEvents) == BenchPerfCounters::kEventCount, events_match);
+
+BenchPerfCounters::~BenchPerfCounters() {
+    for (int i = 0; i < kEventCount; ++i) {
+        if (fFDs[i] >= 0) {
+            close(fFDs[i]);
+        }
+    }
+}
+
+int BenchPerfCounters::open() {
+    int opened = 0;
+    for (int i = 0; i < kEventCount; ++i) {
+        if (fFDs[i] < 0) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = gEvents[i].fType;
+            attr.config = gEvents[i].fConfig;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            // The times let end() scale the count when the counters are multiplexed.
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fFDs[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr,
+                                               0 /*this thread*/, -1 /*any cpu*/,
+                                               -1 /*no group*/, 0));
+        }
+        if (fFDs[i] >= 0) {
+            ++opened;
+        }
+    }
+    return opened;
+}
+
+void BenchPerfCounters::start() {
+    for (int i = 0; i < kEventCount; ++i) {
+        if (fFDs[i] >= 0) {
+            ioctl(fFDs[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fFDs[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void BenchPerfCounters::end() {
+    for (int i = 0; i < kEventCount; ++i) {
+        if (fFDs[i] >= 0) {
+            ioctl(fFDs[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (int i = 0; i < kEventCount; ++i) {
+        fCounts[i] = -1;
+        // The count, the time enabled and the time running.
+        uint64_t values[3];
+        if (fFDs[i] >= 0 &&
+            sizeof(values) == read(fFDs[i], values, sizeof(values)) && values[2] > 0) {
+            fCounts[i] = static_cast<double>(values[0]) * values[1] / values[2];
+        }
+    }
+}
+
+#else
+
+BenchPerfCounters::~BenchPerfCounters() {}
+
+int BenchPerfCounters::open() {
+    return 0;
+}
+
+void BenchPerfCounters::start() {}
+
+void BenchPerfCounters::end() {}
+
+#endif
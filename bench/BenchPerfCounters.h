@@ -0,0 +1,50 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#ifndef BenchPerfCounters_DEFINED
+#define BenchPerfCounters_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ * Counts hardware events of the calling thread between start() and end(), using
+ * perf_event_open() on Linux. Elsewhere, or if the kernel does not allow it, no event is counted.
+ */
+class BenchPerfCounters {
+public:
+    enum Event {
+        kCycles_Event,
+        kInstructions_Event,
+        kL1DataMisses_Event,
+        kLastLevelCacheMisses_Event,
+        kBranchMisses_Event,
+        kDataTLBMisses_Event,
+
+        kEventCount
+    };
+
+    // A short name for the event, suitable as a key in results.
+    static const char* Name(Event);
+
+    BenchPerfCounters();
+    ~BenchPerfCounters();
+
+    // Returns the number of events that can be counted.
+    int open();
+
+    void start();
+    void end();
+
+    // The count of the event in the last start()/end() session, scaled up if the kernel had to
+    // share the hardware counters between events. Negative if the event was not counted.
+    double count(Event event) const { return fCounts[event]; }
+
+private:
+    int fFDs[kEventCount];
+    double fCounts[kEventCount];
+};
+
+#endif
@@ -26,7 +26,11 @@ BenchTimer::BenchTimer(SkGLContextHelper* gl)
         , fTruncatedCpu(-1.0)
         , fTruncatedWall(-1.0)
         , fGpu(-1.0)
+        , fPerfCounters(NULL)
 {
+    for (int i = 0; i < BenchPerfCounters::kEventCount; ++i) {
+        fPerfCounts[i] = -1.0;
+    }
     fSysTimer = new BenchSysTimer();
     fTruncatedSysTimer = new BenchSysTimer();
 #if SK_SUPPORT_GPU
@@ -44,6 +48,14 @@ BenchTimer::~BenchTimer() {
 #if SK_SUPPORT_GPU
     delete fGpuTimer;
 #endif
+    delete fPerfCounters;
+}
+
+bool BenchTimer::enablePerfCounters() {
+    if (NULL == fPerfCounters) {
+        fPerfCounters = new BenchPerfCounters();
+    }
+    return fPerfCounters->open() > 0;
 }
 
 void BenchTimer::start(double durationScale) {
@@ -58,9 +70,19 @@ void BenchTimer::start(double durationScale) {
 #endif
     fSysTimer->startCpu();
     fTruncatedSysTimer->startCpu();
+    if (fPerfCounters) {
+        fPerfCounters->start();
+    }
 }
 
 void BenchTimer::end() {
+    if (fPerfCounters) {
+        fPerfCounters->end();
+        for (int i = 0; i < BenchPerfCounters::kEventCount; ++i) {
+            const double count = fPerfCounters->count(static_cast<BenchPerfCounters::Event>(i));
+            fPerfCounts[i] = count < 0 ? -1.0 : count * fDurationScale;
+        }
+    }
     fCpu = fSysTimer->endCpu() * fDurationScale;
 #if SK_SUPPORT_GPU
     //It is important to stop the cpu clocks first,
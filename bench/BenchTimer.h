@@ -9,6 +9,7 @@
 #define SkBenchTimer_DEFINED
 
 #include <SkTypes.h>
+#include "BenchPerfCounters.h"
 
 
 class BenchSysTimer;
@@ -32,11 +33,20 @@ public:
     void start(double durationScale = 1);
     void end();
     void truncatedEnd();
+
+    /**
+     * Also count hardware events between start() and end(), where the OS allows it. Returns
+     * false if none of them can be counted.
+     */
+    bool enablePerfCounters();
+
     double fCpu;
     double fWall;
     double fTruncatedCpu;
     double fTruncatedWall;
     double fGpu;
+    // Indexed by BenchPerfCounters::Event; negative for events that were not counted.
+    double fPerfCounts[BenchPerfCounters::kEventCount];
 
 private:
     BenchSysTimer* fSysTimer;
@@ -44,6 +54,7 @@ private:
 #if SK_SUPPORT_GPU
     BenchGpuTimer* fGpuTimer;
 #endif
+    BenchPerfCounters* fPerfCounters;
     double fDurationScale;  // for this start/end session
 };
 
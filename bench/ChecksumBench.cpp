@@ -17,6 +17,7 @@ enum ChecksumType {
     kMD5_ChecksumType,
     kSHA1_ChecksumType,
     kMurmur3_ChecksumType,
+    kHashKey_ChecksumType,
 };
 
 class ComputeChecksumBench : public SkBenchmark {
@@ -46,6 +47,7 @@ protected:
             case kMD5_ChecksumType: return "compute_md5";
             case kSHA1_ChecksumType: return "compute_sha1";
             case kMurmur3_ChecksumType: return "compute_murmur3";
+            case kHashKey_ChecksumType: return "compute_hashkey";
 
             default: SK_CRASH(); return "";
         }
@@ -81,6 +83,12 @@ protected:
                     sk_ignore_unused_variable(result);
                 }
             }break;
+            case kHashKey_ChecksumType: {
+                for (int i = 0; i < loops; i++) {
+                    volatile uint32_t result = SkChecksum::HashKey(fData, sizeof(fData));
+                    sk_ignore_unused_variable(result);
+                }
+            } break;
         }
 
     }
@@ -95,3 +103,4 @@ DEF_BENCH( return new ComputeChecksumBench(kChecksum_ChecksumType); )
 DEF_BENCH( return new ComputeChecksumBench(kMD5_ChecksumType); )
 DEF_BENCH( return new ComputeChecksumBench(kSHA1_ChecksumType); )
 DEF_BENCH( return new ComputeChecksumBench(kMurmur3_ChecksumType); )
+DEF_BENCH( return new ComputeChecksumBench(kHashKey_ChecksumType); )
@@ -8,6 +8,7 @@
 #include "SkBitmapDevice.h"
 #include "SkBitmapSource.h"
 #include "SkCanvas.h"
+#include "SkColorPriv.h"
 #include "SkDisplacementMapEffect.h"
 
 #define FILTER_WIDTH_SMALL  32
@@ -164,6 +165,76 @@ private:
     typedef DisplacementBaseBench INHERITED;
 };
 
+// A ripple across a screen-sized image, as an interactive effect would redraw
+// it every frame.
+class DisplacementRippleBench : public SkBenchmark {
+public:
+    DisplacementRippleBench() : fInitialized(false) {
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return "displacement_ripple";
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        if (!fInitialized) {
+            this->makeBitmaps();
+            fInitialized = true;
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        SkPaint paint;
+        SkAutoTUnref<SkImageFilter> displ(SkBitmapSource::Create(fRipple));
+        paint.setImageFilter(SkDisplacementMapEffect::Create(
+            SkDisplacementMapEffect::kR_ChannelSelectorType,
+            SkDisplacementMapEffect::kG_ChannelSelectorType, 24.0f, displ))->unref();
+        for (int i = 0; i < loops; ++i) {
+            canvas->drawBitmap(fColor, 0, 0, &paint);
+        }
+    }
+
+private:
+    enum {
+        kWidth = 1024,
+        kHeight = 768
+    };
+
+    void makeBitmaps() {
+        fColor.allocN32Pixels(kWidth, kHeight);
+        SkCanvas canvas(fColor);
+        canvas.clear(0xFF804020);
+        SkPaint lightPaint;
+        lightPaint.setColor(0xFF244484);
+        for (int y = 0; y < kHeight; y += 32) {
+            for (int x = (y / 32 % 2) * 16; x < kWidth; x += 32) {
+                canvas.drawRect(SkRect::MakeXYWH(SkIntToScalar(x), SkIntToScalar(y),
+                                                 16, 32), lightPaint);
+            }
+        }
+
+        // Rings around the center, displacing outward and inward in turn.
+        fRipple.allocN32Pixels(kWidth, kHeight);
+        for (int y = 0; y < kHeight; ++y) {
+            for (int x = 0; x < kWidth; ++x) {
+                SkScalar dx = SkIntToScalar(x - kWidth / 2);
+                SkScalar dy = SkIntToScalar(y - kHeight / 2);
+                SkScalar dist = SkScalarSqrt(dx * dx + dy * dy) + SK_Scalar1;
+                SkScalar wave = 127 * SkScalarSin(dist / 8) / dist;
+                *fRipple.getAddr32(x, y) = SkPackARGB32(0xFF,
+                                                        SkScalarRoundToInt(128 + wave * dx),
+                                                        SkScalarRoundToInt(128 + wave * dy),
+                                                        0x80);
+            }
+        }
+    }
+
+    SkBitmap fColor, fRipple;
+    bool fInitialized;
+    typedef SkBenchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new DisplacementZeroBench(true); )
@@ -172,3 +243,4 @@ DEF_BENCH( return new DisplacementFullBench(true); )
 DEF_BENCH( return new DisplacementZeroBench(false); )
 DEF_BENCH( return new DisplacementAlphaBench(false); )
 DEF_BENCH( return new DisplacementFullBench(false); )
+DEF_BENCH( return new DisplacementRippleBench(); )
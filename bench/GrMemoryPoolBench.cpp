@@ -9,6 +9,7 @@
 #if SK_SUPPORT_GPU
 
 #include "GrMemoryPool.h"
+#include "GrSlabPool.h"
 #include "SkBenchmark.h"
 #include "SkRandom.h"
 #include "SkTDArray.h"
@@ -27,18 +28,31 @@ struct A {
 };
 GrMemoryPool A::gBenchPool(10 * (1 << 10), 10 * (1 << 10));
 
+struct SlabA {
+    int gStuff[10];
+#if OVERRIDE_NEW
+    void* operator new (size_t size) { return gBenchPool.allocate(size); }
+    void operator delete (void* mem) { if (mem) { return gBenchPool.release(mem); } }
+#endif
+    static GrSlabPool gBenchPool;
+};
+GrSlabPool SlabA::gBenchPool;
+
 /**
  * This benchmark creates and deletes objects in stack order
  */
+template <typename A>
 class GrMemoryPoolBenchStack : public SkBenchmark {
 public:
+    explicit GrMemoryPoolBenchStack(const char* name) : fName(name) {}
+
     virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
         return backend == kNonRendering_Backend;
     }
 
 protected:
     virtual const char* onGetName() {
-        return "grmemorypool_stack";
+        return fName;
     }
 
     virtual void onDraw(const int loops, SkCanvas*) {
@@ -76,6 +90,8 @@ protected:
     }
 
 private:
+    const char* fName;
+
     typedef SkBenchmark INHERITED;
 };
 
@@ -89,18 +105,31 @@ struct B {
 };
 GrMemoryPool B::gBenchPool(10 * (1 << 10), 10 * (1 << 10));
 
+struct SlabB {
+    int gStuff[10];
+#if OVERRIDE_NEW
+    void* operator new (size_t size) { return gBenchPool.allocate(size); }
+    void operator delete (void* mem) { if (mem) { return gBenchPool.release(mem); } }
+#endif
+    static GrSlabPool gBenchPool;
+};
+GrSlabPool SlabB::gBenchPool;
+
 /**
  * This benchmark creates objects and deletes them in random order
  */
+template <typename B>
 class GrMemoryPoolBenchRandom : public SkBenchmark {
 public:
+    explicit GrMemoryPoolBenchRandom(const char* name) : fName(name) {}
+
     virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
         return backend == kNonRendering_Backend;
     }
 
 protected:
     virtual const char* onGetName() {
-        return "grmemorypool_random";
+        return fName;
     }
 
     virtual void onDraw(const int loops, SkCanvas*) {
@@ -121,6 +150,8 @@ protected:
     }
 
 private:
+    const char* fName;
+
     typedef SkBenchmark INHERITED;
 };
 
@@ -134,21 +165,34 @@ struct C {
 };
 GrMemoryPool C::gBenchPool(10 * (1 << 10), 10 * (1 << 10));
 
+struct SlabC {
+    int gStuff[10];
+#if OVERRIDE_NEW
+    void* operator new (size_t size) { return gBenchPool.allocate(size); }
+    void operator delete (void* mem) { if (mem) { return gBenchPool.release(mem); } }
+#endif
+    static GrSlabPool gBenchPool;
+};
+GrSlabPool SlabC::gBenchPool;
+
 /**
  * This benchmark creates objects and deletes them in queue order
  */
+template <typename C>
 class GrMemoryPoolBenchQueue : public SkBenchmark {
     enum {
         M = 4 * (1 << 10),
     };
 public:
+    explicit GrMemoryPoolBenchQueue(const char* name) : fName(name) {}
+
     virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
         return backend == kNonRendering_Backend;
     }
 
 protected:
     virtual const char* onGetName() {
-        return "grmemorypool_queue";
+        return fName;
     }
 
     virtual void onDraw(const int loops, SkCanvas*) {
@@ -166,13 +210,19 @@ protected:
     }
 
 private:
+    const char* fName;
+
     typedef SkBenchmark INHERITED;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
-DEF_BENCH( return new GrMemoryPoolBenchStack(); )
-DEF_BENCH( return new GrMemoryPoolBenchRandom(); )
-DEF_BENCH( return new GrMemoryPoolBenchQueue(); )
+DEF_BENCH( return new GrMemoryPoolBenchStack<A>("grmemorypool_stack"); )
+DEF_BENCH( return new GrMemoryPoolBenchRandom<B>("grmemorypool_random"); )
+DEF_BENCH( return new GrMemoryPoolBenchQueue<C>("grmemorypool_queue"); )
+
+DEF_BENCH( return new GrMemoryPoolBenchStack<SlabA>("grslabpool_stack"); )
+DEF_BENCH( return new GrMemoryPoolBenchRandom<SlabB>("grslabpool_random"); )
+DEF_BENCH( return new GrMemoryPoolBenchQueue<SlabC>("grslabpool_queue"); )
 
 #endif
@@ -79,7 +79,62 @@ private:
     typedef SkBenchmark INHERITED;
 };
 
+// A lens with a narrow inset over a screen-sized image, as an interactive zoom
+// would redraw it every frame.
+class MagnifierLensBench : public SkBenchmark {
+public:
+    MagnifierLensBench() : fInitialized(false) {
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return "magnifier_lens";
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        if (!fInitialized) {
+            fBitmap.allocN32Pixels(kWidth, kHeight);
+            SkCanvas canvas(fBitmap);
+            canvas.clear(0xFF804020);
+            SkPaint lightPaint;
+            lightPaint.setColor(0xFF244484);
+            for (int y = 0; y < kHeight; y += 16) {
+                for (int x = (y / 16 % 2) * 8; x < kWidth; x += 16) {
+                    canvas.drawRect(SkRect::MakeXYWH(SkIntToScalar(x), SkIntToScalar(y),
+                                                     8, 16), lightPaint);
+                }
+            }
+            fInitialized = true;
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        SkPaint paint;
+        paint.setImageFilter(
+            SkMagnifierImageFilter::Create(
+                SkRect::MakeXYWH(SkIntToScalar(kWidth * 3 / 8),
+                                 SkIntToScalar(kHeight * 3 / 8),
+                                 SkIntToScalar(kWidth / 4),
+                                 SkIntToScalar(kHeight / 4)), 20))->unref();
+
+        for (int i = 0; i < loops; i++) {
+            canvas->drawBitmap(fBitmap, 0, 0, &paint);
+        }
+    }
+
+private:
+    enum {
+        kWidth = 1024,
+        kHeight = 768
+    };
+
+    SkBitmap fBitmap;
+    bool fInitialized;
+    typedef SkBenchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new MagnifierBench(true); )
 DEF_BENCH( return new MagnifierBench(false); )
+DEF_BENCH( return new MagnifierLensBench(); )
@@ -16,6 +16,7 @@
 static const int GENERATE_EXTENTS = 1000;
 static const int NUM_BUILD_RECTS = 500;
 static const int NUM_QUERY_RECTS = 5000;
+static const int NUM_MIXED_QUERIES = 4;
 static const int GRID_WIDTH = 100;
 
 typedef SkIRect (*MakeRectProc)(SkRandom&, int, int);
@@ -155,6 +156,97 @@ private:
     typedef SkBenchmark INHERITED;
 };
 
+// Time an interactively edited scene: each loop edits one rectangle, then hit-tests a few small
+// queries. Edits either move the tree's entry in place, remove it and insert it elsewhere, or
+// rebuild the whole tree, as recording a picture afresh after each edit would.
+class RTreeMixedBench : public SkBenchmark {
+public:
+    enum EditType {
+        kUpdate_EditType,   // nudge a rect a few pixels with update()
+        kReplace_EditType,  // remove a rect and insert a new one anywhere
+        kRebuild_EditType,  // nudge a rect, then clear and reinsert everything
+    };
+
+    RTreeMixedBench(const char* name, MakeRectProc proc, EditType edit, SkBBoxHierarchy* tree)
+        : fTree(tree)
+        , fProc(proc)
+        , fEdit(edit) {
+        static const char* gEditNames[] = { "update", "replace", "rebuild" };
+        fName.printf("rtree_%s_mixed_%s", name, gEditNames[edit]);
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+    virtual ~RTreeMixedBench() {
+        fTree->unref();
+    }
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+    virtual void onPreDraw() SK_OVERRIDE {
+        SkRandom rand;
+        fRects.setCount(NUM_QUERY_RECTS);
+        for (int j = 0; j < NUM_QUERY_RECTS; ++j) {
+            fRects[j] = fProc(rand, j, NUM_QUERY_RECTS);
+            fTree->insert(reinterpret_cast<void*>(j), fRects[j], true);
+        }
+        fTree->flushDeferredInserts();
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        SkRandom rand;
+        SkTDArray<void*> hits;
+        for (int i = 0; i < loops; ++i) {
+            int j = rand.nextULessThan(NUM_QUERY_RECTS);
+            void* data = reinterpret_cast<void*>(j);
+            SkIRect newRect = fRects[j];
+            if (kReplace_EditType == fEdit) {
+                newRect = fProc(rand, j, NUM_QUERY_RECTS);
+            } else {
+                newRect.offset((int)rand.nextULessThan(17) - 8, (int)rand.nextULessThan(17) - 8);
+            }
+            switch (fEdit) {
+                case kUpdate_EditType:
+                    fTree->update(data, fRects[j], newRect);
+                    fRects[j] = newRect;
+                    break;
+                case kReplace_EditType:
+                    fTree->remove(data, fRects[j]);
+                    fRects[j] = newRect;
+                    fTree->insert(data, newRect);
+                    break;
+                case kRebuild_EditType:
+                    fRects[j] = newRect;
+                    fTree->clear();
+                    for (int k = 0; k < NUM_QUERY_RECTS; ++k) {
+                        fTree->insert(reinterpret_cast<void*>(k), fRects[k], true);
+                    }
+                    fTree->flushDeferredInserts();
+                    break;
+            }
+            for (int q = 0; q < NUM_MIXED_QUERIES; ++q) {
+                SkIRect query;
+                query.fLeft = rand.nextU() % GENERATE_EXTENTS;
+                query.fTop = rand.nextU() % GENERATE_EXTENTS;
+                query.fRight = query.fLeft + (GENERATE_EXTENTS / 20);
+                query.fBottom = query.fTop + (GENERATE_EXTENTS / 20);
+                hits.rewind();
+                fTree->search(query, &hits);
+            }
+        }
+    }
+private:
+    SkBBoxHierarchy* fTree;
+    MakeRectProc fProc;
+    EditType fEdit;
+    SkString fName;
+    SkTDArray<SkIRect> fRects;
+    typedef SkBenchmark INHERITED;
+};
+
 static inline SkIRect make_concentric_rects_increasing(SkRandom&, int index, int numRects) {
     SkIRect out = {0, 0, index + 1, index + 1};
     return out;
@@ -267,3 +359,15 @@ DEF_BENCH(
     return SkNEW_ARGS(RTreeQueryBench, ("(unsorted)concentric", &make_concentric_rects_increasing, true,
                       RTreeQueryBench::kRandom_QueryType, SkRTree::Create(5, 16, 1, false)));
 )
+DEF_BENCH(
+    return SkNEW_ARGS(RTreeMixedBench, ("random", &make_random_rects,
+                      RTreeMixedBench::kUpdate_EditType, SkRTree::Create(5, 16)));
+)
+DEF_BENCH(
+    return SkNEW_ARGS(RTreeMixedBench, ("random", &make_random_rects,
+                      RTreeMixedBench::kReplace_EditType, SkRTree::Create(5, 16)));
+)
+DEF_BENCH(
+    return SkNEW_ARGS(RTreeMixedBench, ("random", &make_random_rects,
+                      RTreeMixedBench::kRebuild_EditType, SkRTree::Create(5, 16)));
+)
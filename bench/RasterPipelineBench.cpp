@@ -0,0 +1,124 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBenchmark.h"
+#include "SkBlitRow.h"
+#include "SkColorPriv.h"
+#include "SkHalf.h"
+#include "SkRandom.h"
+#include "SkRasterPipeline.h"
+#include "SkString.h"
+#include "SkXfermode.h"
+
+// Blends spans of 8888 or F16 pixels with SkRasterPipeline, or 8888 with SkXfermode for
+// comparison.
+enum PipelineBenchType {
+    kXfermode8888_PipelineBenchType,
+    kPipeline8888_PipelineBenchType,
+    kPipelineF16_PipelineBenchType,
+};
+
+class RasterPipelineBench : public SkBenchmark {
+public:
+    RasterPipelineBench(PipelineBenchType type, SkXfermode::Mode mode)
+        : fType(type)
+        , fMode(mode) {
+        static const char* gTypeNames[] = { "xfermode_8888", "pipeline_8888", "pipeline_f16" };
+        fName.printf("raster_pipeline_%s_%s", gTypeNames[type], SkXfermode::ModeName(mode));
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE { return fName.c_str(); }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        SkRandom rand;
+        for (int i = 0; i < N; ++i) {
+            fSrc[i] = SkPreMultiplyColor(rand.nextU());
+            fDst[i] = SkPreMultiplyColor(rand.nextU());
+            float sa = rand.nextF(), da = rand.nextF();
+            // Some channels are brighter than 1, as in HDR content.
+            SkHalf src[4] = { SkFloatToHalf(rand.nextF() * 2 * sa),
+                              SkFloatToHalf(rand.nextF() * sa),
+                              SkFloatToHalf(rand.nextF() * sa),
+                              SkFloatToHalf(sa) };
+            SkHalf dst[4] = { SkFloatToHalf(rand.nextF() * da),
+                              SkFloatToHalf(rand.nextF() * da),
+                              SkFloatToHalf(rand.nextF() * 4 * da),
+                              SkFloatToHalf(da) };
+            memcpy(&fSrcF16[i], src, sizeof(src));
+            memcpy(&fDstF16[i], dst, sizeof(dst));
+        }
+
+        fSrcPtr = fSrc;
+        fDstPtr = fDst;
+        fSrcF16Ptr = fSrcF16;
+        fDstF16Ptr = fDstF16;
+        if (kPipelineF16_PipelineBenchType == fType) {
+            fPipeline.append(SkRasterPipeline::kLoadS_F16_StockStage, &fSrcF16Ptr);
+            fPipeline.append(SkRasterPipeline::kLoadD_F16_StockStage, &fDstF16Ptr);
+            SkAssertResult(fPipeline.appendXfermode(fMode));
+            fPipeline.append(SkRasterPipeline::kStore_F16_StockStage, &fDstF16Ptr);
+        } else {
+            fPipeline.append(SkRasterPipeline::kLoadS_8888_StockStage, &fSrcPtr);
+            fPipeline.append(SkRasterPipeline::kLoadD_8888_StockStage, &fDstPtr);
+            SkAssertResult(fPipeline.appendXfermode(fMode));
+            fPipeline.append(SkRasterPipeline::kStore_8888_StockStage, &fDstPtr);
+        }
+        // SkXfermode has no object for srcover; blitters use SkBlitRow's procs for it instead.
+        fXfermode.reset(SkXfermode::Create(fMode));
+        fSrcOverProc = SkBlitRow::Factory32(SkBlitRow::kSrcPixelAlpha_Flag32);
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        for (int i = 0; i < loops; ++i) {
+            if (kXfermode8888_PipelineBenchType == fType) {
+                if (fXfermode) {
+                    fXfermode->xfer32(fDst, fSrc, N, NULL);
+                } else {
+                    fSrcOverProc(fDst, fSrc, N, 0xFF);
+                }
+            } else {
+                fPipeline.run(N);
+            }
+        }
+    }
+
+private:
+    enum { N = 1024 };
+
+    PipelineBenchType           fType;
+    SkXfermode::Mode            fMode;
+    SkString                    fName;
+    SkRasterPipeline            fPipeline;
+    SkAutoTUnref<SkXfermode>    fXfermode;
+    SkBlitRow::Proc32           fSrcOverProc;
+
+    SkPMColor   fSrc[N];
+    SkPMColor   fDst[N];
+    uint64_t    fSrcF16[N];
+    uint64_t    fDstF16[N];
+
+    const SkPMColor*    fSrcPtr;
+    SkPMColor*          fDstPtr;
+    const uint64_t*     fSrcF16Ptr;
+    uint64_t*           fDstF16Ptr;
+
+    typedef SkBenchmark INHERITED;
+};
+
+#define PIPELINE_BENCHES(mode)                                                                   \
+    DEF_BENCH( return SkNEW_ARGS(RasterPipelineBench, (kXfermode8888_PipelineBenchType, mode)); ) \
+    DEF_BENCH( return SkNEW_ARGS(RasterPipelineBench, (kPipeline8888_PipelineBenchType, mode)); ) \
+    DEF_BENCH( return SkNEW_ARGS(RasterPipelineBench, (kPipelineF16_PipelineBenchType, mode)); )
+
+PIPELINE_BENCHES(SkXfermode::kSrcOver_Mode)
+PIPELINE_BENCHES(SkXfermode::kMultiply_Mode)
+PIPELINE_BENCHES(SkXfermode::kOverlay_Mode)
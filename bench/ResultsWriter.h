@@ -40,6 +40,13 @@ public:
     // Records a single test metric.
     virtual void timer(const char name[], double ms) = 0;
 
+    // Records the bounds of a confidence interval for the metric last passed to timer() under
+    // this name, when it was measured from several samples.
+    virtual void timerInterval(const char name[], double lowMs, double highMs) {}
+
+    // Records how many times a hardware event happened per loop of the bench.
+    virtual void counter(const char name[], double perLoop) {}
+
     // Call when all results are finished.
     virtual void end() = 0;
 };
@@ -69,6 +76,9 @@ public:
         fLogger.logProgress(SkStringPrintf("  %s = ", name));
         fLogger.logProgress(SkStringPrintf(fTimeFormat, ms));
     }
+    virtual void counter(const char name[], double perLoop) {
+        fLogger.logProgress(SkStringPrintf("  %s = %.1f", name, perLoop));
+    }
     virtual void end() {
         fLogger.logProgress("\n");
     }
@@ -97,7 +107,10 @@ private:
  *         {
  *            "name": "565",
  *            "cmsecs" : 143.188128906250,
- *            "msecs" : 143.835957031250
+ *            "cmsecs_ci" : [ 142.91, 143.50 ],
+ *            "msecs" : 143.835957031250,
+ *            "msecs_ci" : [ 143.52, 144.20 ],
+ *            "cycles" : 312044.5         // with --perfCounters
  *         },
  *         ...
  */
@@ -132,6 +145,16 @@ public:
         SkASSERT(NULL != fConfig);
         (*fConfig)[name] = ms;
     }
+    virtual void timerInterval(const char name[], double lowMs, double highMs) {
+        SkASSERT(NULL != fConfig);
+        Json::Value& interval = (*fConfig)[SkStringPrintf("%s_ci", name).c_str()];
+        interval.append(lowMs);
+        interval.append(highMs);
+    }
+    virtual void counter(const char name[], double perLoop) {
+        SkASSERT(NULL != fConfig);
+        (*fConfig)[name] = perLoop;
+    }
     virtual void end() {
         SkFILEWStream stream(fFilename.c_str());
         stream.writeText(Json::FastWriter().write(fRoot).c_str());
@@ -178,6 +201,16 @@ public:
             writers[i]->timer(name, ms);
         }
     }
+    virtual void timerInterval(const char name[], double lowMs, double highMs) {
+        for (int i = 0; i < writers.count(); ++i) {
+            writers[i]->timerInterval(name, lowMs, highMs);
+        }
+    }
+    virtual void counter(const char name[], double perLoop) {
+        for (int i = 0; i < writers.count(); ++i) {
+            writers[i]->counter(name, perLoop);
+        }
+    }
     virtual void end() {
         for (int i = 0; i < writers.count(); ++i) {
             writers[i]->end();
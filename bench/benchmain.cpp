@@ -21,8 +21,11 @@
 #include "SkOSFile.h"
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
+#include "SkRandom.h"
+#include "SkStream.h"
 #include "SkString.h"
 #include "SkSurface.h"
+#include "SkTSort.h"
 
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
@@ -30,12 +33,17 @@
 #include "GrRenderTarget.h"
 #include "SkGpuDevice.h"
 #include "gl/GrGLDefines.h"
+#include "gl/GrGLInterface.h"
 #else
 class GrContext;
 #endif // SK_SUPPORT_GPU
 
 #include <limits>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 enum BenchMode {
     kNormal_BenchMode,
     kDeferred_BenchMode,
@@ -49,6 +57,22 @@ const char* BenchMode_Name[] = {
 
 static const char kDefaultsConfigStr[] = "defaults";
 
+#ifndef SK_OVERRIDE_GLOBAL_NEW
+// Route operator new through sk_malloc, so that --allocCounts counts SkNEW too.
+void* operator new(size_t size) {
+    return sk_malloc_throw(size);
+}
+void* operator new[](size_t size) {
+    return sk_malloc_throw(size);
+}
+void operator delete(void* p) {
+    sk_free(p);
+}
+void operator delete[](void* p) {
+    sk_free(p);
+}
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class Iter {
@@ -271,6 +295,16 @@ DEFINE_string2(resourcePath, i, "resources", "directory for test resources.");
 DEFINE_string(outResultsFile, "", "If given, the results will be written to the file in JSON format.");
 #endif
 DEFINE_bool(dryRun, false, "Don't actually run the tests, just print what would have been done.");
+DEFINE_int32(samples, 10, "Once a bench has converged, time this many samples of it, each "
+                          "calibrated to run for about minMs, and report their median.");
+DEFINE_int32(bootstrap, 1000, "Resamples used to estimate a 95% confidence interval for the "
+                              "median of the samples.  0 to skip.");
+DEFINE_int32(pinCpu, -1, "If not negative, run only on this CPU (Linux only).");
+DEFINE_bool(perfCounters, false, "Also report hardware event counts per loop, such as cycles and "
+                                 "cache misses (Linux only).");
+DEFINE_bool(allocCounts, false, "Also report heap allocations and allocated bytes per loop.");
+DEFINE_bool(glCallCounts, false, "Also report GL calls per loop by kind, and the driver time they "
+                                 "would cost in a simple model, for the NULLGPU config.");
 
 // Has this bench converged?  First arguments are milliseconds / loop iteration,
 // last is overall runtime in milliseconds.
@@ -283,6 +317,63 @@ static bool HasConverged(double prevPerLoop, double currPerLoop, double currRaw)
     return low < ratio && ratio < high;
 }
 
+// Runs the whole process on one CPU, so the samples are not spread across cores that may be
+// clocked differently or be busy with other work.
+static bool pin_to_cpu(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return 0 == sched_setaffinity(0, sizeof(set), &set);
+#else
+    return false;
+#endif
+}
+
+// Reads the frequency scaling governor of a CPU. Anything but "performance" lets the clock move
+// between samples.
+static bool read_cpu_governor(int cpu, SkString* governor) {
+    SkString path;
+    path.printf("/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu);
+    SkFILEStream stream(path.c_str());
+    if (!stream.isValid()) {
+        return false;
+    }
+    char buffer[64];
+    size_t length = stream.read(buffer, sizeof(buffer));
+    while (length > 0 && ('\n' == buffer[length - 1] || ' ' == buffer[length - 1])) {
+        --length;
+    }
+    governor->set(buffer, length);
+    return length > 0;
+}
+
+// Sorts values, and returns their median.
+static double sorted_median(double values[], int count) {
+    SkASSERT(count > 0);
+    SkTQSort(values, values + count - 1);
+    const int half = count / 2;
+    return (count & 1) ? values[half] : (values[half - 1] + values[half]) / 2;
+}
+
+// Estimates a 95% confidence interval for the median of the samples, from the spread of the
+// medians of sets drawn from the samples with replacement.
+static void bootstrap_median_interval(const double samples[], int count, int resamples,
+                                      double* low, double* high) {
+    SkAutoTMalloc<double> medians(resamples);
+    SkAutoTMalloc<double> drawn(count);
+    SkRandom rand;
+    for (int r = 0; r < resamples; ++r) {
+        for (int i = 0; i < count; ++i) {
+            drawn[i] = samples[rand.nextULessThan(count)];
+        }
+        medians[r] = sorted_median(drawn.get(), count);
+    }
+    SkTQSort(medians.get(), medians.get() + resamples - 1);
+    *low = medians[resamples * 25 / 1000];
+    *high = medians[SkTMin(resamples * 975 / 1000, resamples - 1)];
+}
+
 int tool_main(int argc, char** argv);
 int tool_main(int argc, char** argv) {
     SkCommandLineFlags::Parse(argc, argv);
@@ -424,6 +515,24 @@ int tool_main(int argc, char** argv) {
     writer.option("build", "RELEASE");
 #endif
 
+    writer.option("samples", SkStringPrintf("%d", FLAGS_samples).c_str());
+    if (FLAGS_pinCpu >= 0) {
+        if (pin_to_cpu(FLAGS_pinCpu)) {
+            writer.option("cpu", SkStringPrintf("%d", FLAGS_pinCpu).c_str());
+        } else {
+            logger.logError(SkStringPrintf("Could not run on CPU %d only.\n", FLAGS_pinCpu));
+        }
+    }
+    SkString governor;
+    if (read_cpu_governor(SkTMax(FLAGS_pinCpu, 0), &governor)) {
+        writer.option("governor", governor.c_str());
+        if (!governor.equals("performance")) {
+            logger.logError(SkStringPrintf("The CPU frequency governor is \"%s\", so timings may "
+                                           "drift; \"performance\" holds the clock steady.\n",
+                                           governor.c_str()));
+        }
+    }
+
     // Set texture cache limits if non-default.
     for (size_t i = 0; i < SK_ARRAY_COUNT(gConfigs); ++i) {
 #if SK_SUPPORT_GPU
@@ -550,13 +659,33 @@ int tool_main(int argc, char** argv) {
                 contextHelper = gContextFactory.getGLContext(config.contextType);
             }
             BenchTimer timer(contextHelper);
+            // The null interface counts the calls it gets. Unlike times, the counts don't
+            // depend on the machine, so they make a stable measure of GL overhead.
+            const bool countGLCalls = FLAGS_glCallCounts &&
+                                      SkBenchmark::kGPU_Backend == config.backend &&
+                                      kNull == config.contextType;
+            GrGLCallCounts glCallCounts;
+            sk_bzero(&glCallCounts, sizeof(glCallCounts));
 #else
             BenchTimer timer;
 #endif
+            if (FLAGS_perfCounters && !timer.enablePerfCounters()) {
+                logger.logError("Could not open any hardware performance counters.\n");
+            }
+
+            // Allocations of the last iteration.
+            uint32_t allocations = 0, allocatedBytes = 0;
 
             double previous = std::numeric_limits<double>::infinity();
             bool converged = false;
 
+            // Times per 1000 loops of each sample taken once the bench has converged, indexed
+            // like 'times' below.
+            static const int kTimerCount = 5;
+            SkTDArray<double> samples[kTimerCount];
+            // Hardware event counts per loop of the same samples.
+            SkTDArray<double> counterSamples[BenchPerfCounters::kEventCount];
+
             // variables used to compute loopsPerFrame
             double frameIntervalTime = 0.0f;
             int frameIntervalTotalLoops = 0;
@@ -566,10 +695,15 @@ int tool_main(int argc, char** argv) {
             int loopsPerIter = 0;
             if (FLAGS_verbose) { SkDebugf("%s %s: ", bench->getName(), config.name); }
             if (!FLAGS_dryRun) {
+                // Until the time per loop settles, which also warms up the caches and the CPU
+                // clock, each iteration runs twice the loops of the last. Then the samples are
+                // taken with the loop count that takes about minMs.
                 do {
                     // Ramp up 1 -> 2 -> 4 -> 8 -> 16 -> ... -> ~1 billion.
-                    loopsPerIter = (loopsPerIter == 0) ? 1 : loopsPerIter * 2;
-                    if (loopsPerIter >= (1<<30) || timer.fWall > FLAGS_maxMs) {
+                    if (!converged) {
+                        loopsPerIter = (loopsPerIter == 0) ? 1 : loopsPerIter * 2;
+                    }
+                    if (!converged && (loopsPerIter >= (1<<30) || timer.fWall > FLAGS_maxMs)) {
                         // If you find it takes more than a billion loops to get up to 20ms of runtime,
                         // you've got a computer clocked at several THz or have a broken benchmark.  ;)
                         //     "1B ought to be enough for anybody."
@@ -584,6 +718,14 @@ int tool_main(int argc, char** argv) {
                         canvas.reset(SkRef(recorderTo.beginRecording(dim.fX, dim.fY)));
                     }
 
+#if SK_SUPPORT_GPU
+                    if (countGLCalls) {
+                        GrGLResetNullCallCounts();
+                    }
+#endif
+                    if (FLAGS_allocCounts) {
+                        sk_set_allocation_counting(true);
+                    }
                     timer.start();
                     // Inner loop that allows us to break the run into smaller
                     // chunks (e.g. frames). This is especially useful for the GPU
@@ -634,6 +776,28 @@ int tool_main(int argc, char** argv) {
                     }
     #endif
                     timer.end();
+                    if (FLAGS_allocCounts) {
+                        sk_get_allocation_counts(&allocations, &allocatedBytes);
+                        sk_set_allocation_counting(false);
+                    }
+#if SK_SUPPORT_GPU
+                    if (countGLCalls) {
+                        GrGLGetNullCallCounts(&glCallCounts);
+                    }
+#endif
+
+                    if (converged) {
+                        const double normalize = 1000.0 / loopsPerIter;
+                        *samples[0].append() = normalize * timer.fWall;
+                        *samples[1].append() = normalize * timer.fTruncatedWall;
+                        *samples[2].append() = normalize * timer.fCpu;
+                        *samples[3].append() = normalize * timer.fTruncatedCpu;
+                        *samples[4].append() = normalize * timer.fGpu;
+                        for (int i = 0; i < BenchPerfCounters::kEventCount; ++i) {
+                            *counterSamples[i].append() = timer.fPerfCounts[i] / loopsPerIter;
+                        }
+                        continue;
+                    }
 
                     // setup the frame interval for subsequent iterations
                     if (!frameIntervalComputed) {
@@ -657,7 +821,13 @@ int tool_main(int argc, char** argv) {
                     if (FLAGS_verbose) { SkDebugf("%.3g ", current); }
                     converged = HasConverged(previous, current, timer.fWall);
                     previous = current;
-                } while (!FLAGS_runOnce && !converged);
+                    if (converged && FLAGS_samples > 0) {
+                        // This iteration ran for at least minMs; scale it down to about minMs.
+                        loopsPerIter = SkTMax(1, static_cast<int>(loopsPerIter * FLAGS_minMs /
+                                                                  timer.fWall));
+                    }
+                } while (!FLAGS_runOnce &&
+                         (!converged || samples[0].count() < FLAGS_samples));
             }
             if (FLAGS_verbose) { SkDebugf("\n"); }
 
@@ -676,20 +846,67 @@ int tool_main(int argc, char** argv) {
 
             // Normalize to ms per 1000 iterations.
             const double normalize = 1000.0 / loopsPerIter;
-            const struct { char shortName; const char* longName; double ms; } times[] = {
+            struct { char shortName; const char* longName; double ms; } times[] = {
                 {'w', "msecs",  normalize * timer.fWall},
                 {'W', "Wmsecs", normalize * timer.fTruncatedWall},
                 {'c', "cmsecs", normalize * timer.fCpu},
                 {'C', "Cmsecs", normalize * timer.fTruncatedCpu},
                 {'g', "gmsecs", normalize * timer.fGpu},
             };
+            SK_COMPILE_ASSERT(SK_ARRAY_COUNT(times) == kTimerCount, timers_match_samples);
 
             writer.config(config.name);
-            for (size_t i = 0; i < SK_ARRAY_COUNT(times); i++) {
-                if (strchr(FLAGS_timers[0], times[i].shortName) && times[i].ms > 0) {
+            for (int i = 0; i < kTimerCount; i++) {
+                if (!strchr(FLAGS_timers[0], times[i].shortName)) {
+                    continue;
+                }
+                // Without samples (if the bench did not converge) the last iteration stands in.
+                const int count = samples[i].count();
+                if (count > 0) {
+                    SkTDArray<double> sorted(samples[i]);
+                    times[i].ms = sorted_median(sorted.begin(), count);
+                }
+                if (times[i].ms > 0) {
                     writer.timer(times[i].longName, times[i].ms);
+                    if (count > 1 && FLAGS_bootstrap > 0) {
+                        double low, high;
+                        bootstrap_median_interval(samples[i].begin(), count, FLAGS_bootstrap,
+                                                  &low, &high);
+                        writer.timerInterval(times[i].longName, low, high);
+                    }
+                }
+            }
+            for (int i = 0; i < BenchPerfCounters::kEventCount; ++i) {
+                double perLoop = timer.fPerfCounts[i] / loopsPerIter;
+                const int count = counterSamples[i].count();
+                if (count > 0) {
+                    SkTDArray<double> sorted(counterSamples[i]);
+                    perLoop = sorted_median(sorted.begin(), count);
+                }
+                if (perLoop >= 0) {
+                    const BenchPerfCounters::Event event = static_cast<BenchPerfCounters::Event>(i);
+                    writer.counter(BenchPerfCounters::Name(event), perLoop);
                 }
             }
+            if (FLAGS_allocCounts) {
+                writer.counter("allocations", static_cast<double>(allocations) / loopsPerIter);
+                writer.counter("allocated_bytes",
+                               static_cast<double>(allocatedBytes) / loopsPerIter);
+            }
+#if SK_SUPPORT_GPU
+            // The calls of the last iteration; every loop makes the same ones.
+            if (countGLCalls) {
+                for (int i = 0; i < GrGLCallCounts::kKindCount; ++i) {
+                    const GrGLCallCounts::Kind kind = static_cast<GrGLCallCounts::Kind>(i);
+                    writer.counter(SkStringPrintf("gl_%s", GrGLCallCounts::Name(kind)).c_str(),
+                                   static_cast<double>(glCallCounts.fCounts[i]) / loopsPerIter);
+                }
+                writer.counter("gl_calls",
+                               static_cast<double>(glCallCounts.total()) / loopsPerIter);
+                writer.counter("gl_modeled_driver_us",
+                               glCallCounts.modeledDriverMicroseconds() / loopsPerIter);
+            }
+#endif
         }
     }
 #if SK_SUPPORT_GPU
@@ -37,7 +37,8 @@ using skiatest::Test;
 using skiatest::TestRegistry;
 
 DEFINE_int32(threads, -1, "Threads for CPU work. Default NUM_CPUS.");
-DEFINE_int32(gpuThreads, 1, "Threads for GPU work.");
+DEFINE_int32(gpuThreads, 1, "Threads for GPU work, each with its own GL contexts.  "
+                             "-1 means one per core.");
 #ifdef SK_BUILD_JSON_WRITER
 DEFINE_string2(expectations, r, "",
                "If a directory, compare generated images against images under this path. "
@@ -34,6 +34,8 @@ public:
         }
 
         // Delay this calculation as long as possible.  It's expensive.
+        // (SkBitmapHasher::ComputeFastDigest() can't stand in: the expectations hold
+        // ComputeDigest() values.)
         const skiagm::GmResultDigest digest(bitmap);
         return expectations.match(digest);
     }
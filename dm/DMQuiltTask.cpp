@@ -2,6 +2,7 @@
 #include "DMUtil.h"
 #include "DMWriteTask.h"
 
+#include "SkCanvas.h"
 #include "SkCommandLineFlags.h"
 #include "SkPicture.h"
 
@@ -17,37 +18,32 @@ QuiltTask::QuiltTask(const Task& parent, skiagm::GM* gm, SkBitmap reference)
     , fReference(reference)
     {}
 
-static int tiles_needed(int fullDimension, int tileDimension) {
-    return (fullDimension + tileDimension - 1) / tileDimension;
-}
+// Draws each tile straight into its part of one full-size bitmap.
+class SubsetCanvasFactory : public SkPicture::TileCanvasFactory {
+public:
+    explicit SubsetCanvasFactory(const SkBitmap& full) : fFull(full) {}
+
+    virtual SkCanvas* newTileCanvas(const SkIRect& tile) SK_OVERRIDE {
+        SkBitmap subset;
+        if (!fFull.extractSubset(&subset, tile)) {
+            return NULL;
+        }
+        return SkNEW_ARGS(SkCanvas, (subset));
+    }
+
+private:
+    const SkBitmap& fFull;
+};
 
 void QuiltTask::draw() {
     SkAutoTUnref<SkPicture> recorded(RecordPicture(fGM.get()));
 
     SkBitmap full;
     AllocatePixels(fReference, &full);
-    SkCanvas fullCanvas(full);
 
-    SkBitmap tile;
-    tile.allocPixels(SkImageInfo::Make(FLAGS_quiltTile, FLAGS_quiltTile,
-                                       fReference.colorType(), kPremul_SkAlphaType));
-    SkCanvas tileCanvas(tile);
-
-    for (int y = 0; y < tiles_needed(full.height(), tile.height()); y++) {
-        for (int x = 0; x < tiles_needed(full.width(), tile.width()); x++) {
-            SkAutoCanvasRestore ar(&tileCanvas, true/*also save now*/);
-
-            const SkScalar xOffset = SkIntToScalar(x * tile.width()),
-                           yOffset = SkIntToScalar(y * tile.height());
-            SkMatrix matrix = tileCanvas.getTotalMatrix();
-            matrix.postTranslate(-xOffset, -yOffset);
-            tileCanvas.setMatrix(matrix);
-
-            recorded->draw(&tileCanvas);
-            tileCanvas.flush();
-            fullCanvas.drawBitmap(tile, xOffset, yOffset, NULL);
-        }
-    }
+    SubsetCanvasFactory factory(full);
+    // DM already runs many tasks at once, so draw the tiles on this thread.
+    recorded->playbackTiled(&factory, SkISize::Make(FLAGS_quiltTile, FLAGS_quiltTile), 1);
 
     if (!BitmapsEqual(full, fReference)) {
         this->fail();
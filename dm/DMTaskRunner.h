@@ -7,6 +7,8 @@
 
 // TaskRunner runs Tasks on one of two threadpools depending on the need for a GrContextFactory.
 // It's typically a good idea to run fewer GPU threads than CPU threads (go nuts with those).
+// Each GPU thread has its own GrContextFactory, so GPU tasks on different threads draw with
+// different GL contexts and never share a GrContext.
 
 namespace DM {
 
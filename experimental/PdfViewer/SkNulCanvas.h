@@ -32,6 +32,7 @@ public:
     virtual void drawPoints(PointMode mode, size_t count, const SkPoint pts[],
                             const SkPaint& paint) SK_OVERRIDE {}
     virtual void drawRect(const SkRect& rect, const SkPaint& paint) SK_OVERRIDE {}
+    virtual void drawRects(const SkRect rects[], int count, const SkPaint& paint) SK_OVERRIDE {}
     virtual void drawOval(const SkRect& oval, const SkPaint&) SK_OVERRIDE {}
     virtual void drawRRect(const SkRRect& rrect, const SkPaint& paint) SK_OVERRIDE {}
     virtual void drawPath(const SkPath& path, const SkPaint& paint) SK_OVERRIDE {}
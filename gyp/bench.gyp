@@ -52,6 +52,8 @@
       'target_name' : 'bench_timer',
       'type': 'static_library',
       'sources': [
+        '../bench/BenchPerfCounters.h',
+        '../bench/BenchPerfCounters.cpp',
         '../bench/BenchTimer.h',
         '../bench/BenchTimer.cpp',
         '../bench/BenchSysTimer_mach.h',
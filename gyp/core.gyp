@@ -23,6 +23,7 @@
         '../src/core',
         '../src/opts',
         '../src/image',
+        '../src/record',
       ],
       'sources': [
         'core.gypi', # Makes the gypi appear in IDEs (but does not modify the build).
@@ -36,6 +37,14 @@
             ],
           },
         }],
+        [ 'skia_os in ["linux", "chromeos"]', {
+          'link_settings': {
+            'libraries': [
+              # shm_open, for the shared pixels of SkGPipe
+              '-lrt',
+            ],
+          },
+        }],
         [ 'skia_os == "mac"', {
           'include_dirs': [
             '../include/utils/mac',
@@ -30,10 +30,13 @@
         '../src/image/',
         # So src/ports/SkImageDecoder_CG can access SkStreamHelpers.h
         '../src/images/',
+        # for access to SkScaledBitmapSampler_opts.h
+        '../src/opts/',
       ],
       'sources': [
         '../include/images/SkDecodingImageGenerator.h',
         '../include/images/SkForceLinking.h',
+        '../include/images/SkIncrementalImageDecoder.h',
         '../src/images/SkJpegUtility.h',
         '../include/images/SkMovie.h',
         '../include/images/SkPageFlipper.h',
@@ -46,6 +49,7 @@
         '../src/images/SkImageDecoder.cpp',
         '../src/images/SkImageDecoder_FactoryDefault.cpp',
         '../src/images/SkImageDecoder_FactoryRegistrar.cpp',
+        '../src/images/SkIncrementalImageDecoder.cpp',
 
         # If decoders are added/removed to/from (all/individual)
         # platform(s), be sure to update SkForceLinking.cpp
@@ -46,6 +46,8 @@
           ],
           'dependencies': [
             'opts_ssse3',
+            'opts_sse42',
+            'opts_avx2',
           ],
           'sources': [
             '../src/opts/opts_check_x86.cpp',
@@ -54,6 +56,12 @@
             '../src/opts/SkBlitRow_opts_SSE2.cpp',
             '../src/opts/SkBlitRect_opts_SSE2.cpp',
             '../src/opts/SkBlurImage_opts_SSE2.cpp',
+            '../src/opts/SkConfig8888_opts_SSE2.cpp',
+            '../src/opts/SkDisplacementMap_opts_SSE2.cpp',
+            '../src/opts/SkLCDFilter_opts_SSE2.cpp',
+            '../src/opts/SkLighting_opts_SSE2.cpp',
+            '../src/opts/SkMatrixConvolution_opts_SSE2.cpp',
+            '../src/opts/SkMipMap_opts_SSE2.cpp',
             '../src/opts/SkMorphology_opts_SSE2.cpp',
             '../src/opts/SkUtils_opts_SSE2.cpp',
             '../src/opts/SkXfermode_opts_SSE2.cpp',
@@ -80,7 +88,16 @@
             '../src/opts/SkBlitMask_opts_arm.cpp',
             '../src/opts/SkBlitRow_opts_arm.cpp',
             '../src/opts/SkBlurImage_opts_arm.cpp',
+            '../src/opts/SkBitmapHasher_opts_none.cpp',
+            '../src/opts/SkChecksum_opts_none.cpp',
+            '../src/opts/SkConfig8888_opts_none.cpp',
+            '../src/opts/SkDisplacementMap_opts_arm.cpp',
+            '../src/opts/SkLCDFilter_opts_none.cpp',
+            '../src/opts/SkLighting_opts_arm.cpp',
+            '../src/opts/SkMatrixConvolution_opts_arm.cpp',
+            '../src/opts/SkMipMap_opts_none.cpp',
             '../src/opts/SkMorphology_opts_arm.cpp',
+            '../src/opts/SkScaledBitmapSampler_opts_arm.cpp',
             '../src/opts/SkUtils_opts_arm.cpp',
             '../src/opts/SkXfermode_opts_arm.cpp',
           ],
@@ -105,7 +122,16 @@
             '../src/opts/SkBitmapProcState_opts_none.cpp',
             '../src/opts/SkBlitMask_opts_none.cpp',
             '../src/opts/SkBlurImage_opts_none.cpp',
+            '../src/opts/SkBitmapHasher_opts_none.cpp',
+            '../src/opts/SkChecksum_opts_none.cpp',
+            '../src/opts/SkConfig8888_opts_none.cpp',
+            '../src/opts/SkDisplacementMap_opts_none.cpp',
+            '../src/opts/SkLCDFilter_opts_none.cpp',
+            '../src/opts/SkLighting_opts_none.cpp',
+            '../src/opts/SkMatrixConvolution_opts_none.cpp',
+            '../src/opts/SkMipMap_opts_none.cpp',
             '../src/opts/SkMorphology_opts_none.cpp',
+            '../src/opts/SkScaledBitmapSampler_opts_none.cpp',
             '../src/opts/SkUtils_opts_none.cpp',
             '../src/opts/SkXfermode_opts_none.cpp',
           ],
@@ -130,7 +156,16 @@
             '../src/opts/SkBlitMask_opts_none.cpp',
             '../src/opts/SkBlitRow_opts_none.cpp',
             '../src/opts/SkBlurImage_opts_none.cpp',
+            '../src/opts/SkBitmapHasher_opts_none.cpp',
+            '../src/opts/SkChecksum_opts_none.cpp',
+            '../src/opts/SkConfig8888_opts_none.cpp',
+            '../src/opts/SkDisplacementMap_opts_none.cpp',
+            '../src/opts/SkLCDFilter_opts_none.cpp',
+            '../src/opts/SkLighting_opts_none.cpp',
+            '../src/opts/SkMatrixConvolution_opts_none.cpp',
+            '../src/opts/SkMipMap_opts_none.cpp',
             '../src/opts/SkMorphology_opts_none.cpp',
+            '../src/opts/SkScaledBitmapSampler_opts_none.cpp',
             '../src/opts/SkUtils_opts_none.cpp',
             '../src/opts/SkXfermode_opts_none.cpp',
           ],
@@ -153,9 +188,22 @@
             '../src/opts/SkBlitRow_opts_arm.cpp',
             '../src/opts/SkBlitRow_opts_arm_neon.cpp',
             '../src/opts/SkBlurImage_opts_arm.cpp',
+            '../src/opts/SkBitmapHasher_opts_none.cpp',
+            '../src/opts/SkChecksum_opts_none.cpp',
+            '../src/opts/SkConfig8888_opts_none.cpp',
+            '../src/opts/SkDisplacementMap_opts_arm.cpp',
             '../src/opts/SkBlurImage_opts_neon.cpp',
+            '../src/opts/SkDisplacementMap_opts_neon.cpp',
+            '../src/opts/SkLCDFilter_opts_none.cpp',
+            '../src/opts/SkLighting_opts_arm.cpp',
+            '../src/opts/SkLighting_opts_neon.cpp',
+            '../src/opts/SkMatrixConvolution_opts_arm.cpp',
+            '../src/opts/SkMipMap_opts_none.cpp',
+            '../src/opts/SkMatrixConvolution_opts_neon.cpp',
             '../src/opts/SkMorphology_opts_arm.cpp',
             '../src/opts/SkMorphology_opts_neon.cpp',
+            '../src/opts/SkScaledBitmapSampler_opts_arm.cpp',
+            '../src/opts/SkScaledBitmapSampler_opts_neon.cpp',
             '../src/opts/SkUtils_opts_none.cpp',
             '../src/opts/SkXfermode_opts_arm.cpp',
             '../src/opts/SkXfermode_opts_arm_neon.cpp',
@@ -190,6 +238,83 @@
         [ 'skia_arch_type == "x86"', {
           'sources': [
             '../src/opts/SkBitmapProcState_opts_SSSE3.cpp',
+            '../src/opts/SkScaledBitmapSampler_opts_SSSE3.cpp',
+          ],
+        }],
+      ],
+    },
+    # Likewise for SSE4.2, which opts_check_x86.cpp also checks for at
+    # run-time.
+    {
+      'target_name': 'opts_sse42',
+      'product_name': 'skia_opts_sse42',
+      'type': 'static_library',
+      'standalone_static_library': 1,
+      'dependencies': [
+        'core.gyp:*',
+        'effects.gyp:*'
+      ],
+      'include_dirs': [
+        '../src/core',
+        '../src/opts',
+      ],
+      'conditions': [
+        [ 'skia_os in ["linux", "freebsd", "openbsd", "solaris", "nacl", "chromeos", "android"] \
+           and not skia_android_framework', {
+          'cflags': [
+            '-msse4.2',
+          ],
+        }],
+        [ 'skia_os == "mac"', {
+          'xcode_settings': {
+            'OTHER_CPLUSPLUSFLAGS': [
+              '-msse4.2',
+            ],
+          },
+        }],
+        [ 'skia_arch_type == "x86"', {
+          'sources': [
+            '../src/opts/SkBitmapHasher_opts_SSE42.cpp',
+            '../src/opts/SkChecksum_opts_SSE42.cpp',
+          ],
+        }],
+      ],
+    },
+    # Likewise for AVX2: only the *_AVX2.cpp files may be compiled with -mavx2,
+    # and they are only called after opts_check_x86.cpp has found AVX2 at
+    # run-time.
+    {
+      'target_name': 'opts_avx2',
+      'product_name': 'skia_opts_avx2',
+      'type': 'static_library',
+      'standalone_static_library': 1,
+      'dependencies': [
+        'core.gyp:*',
+        'effects.gyp:*'
+      ],
+      'include_dirs': [
+        '../src/core',
+        '../src/opts',
+      ],
+      'conditions': [
+        [ 'skia_os in ["linux", "freebsd", "openbsd", "solaris", "nacl", "chromeos", "android"] \
+           and not skia_android_framework', {
+          'cflags': [
+            '-mavx2',
+          ],
+        }],
+        [ 'skia_os == "mac"', {
+          'xcode_settings': {
+            'OTHER_CPLUSPLUSFLAGS': [
+              '-mavx2',
+            ],
+          },
+        }],
+        [ 'skia_arch_type == "x86"', {
+          'sources': [
+            '../src/opts/SkBlitRow_opts_AVX2.cpp',
+            '../src/opts/SkDisplacementMap_opts_AVX2.cpp',
+            '../src/opts/SkXfermode_opts_AVX2.cpp',
           ],
         }],
       ],
@@ -238,7 +363,11 @@
         '../src/opts/SkBlitMask_opts_arm_neon.cpp',
         '../src/opts/SkBlitRow_opts_arm_neon.cpp',
         '../src/opts/SkBlurImage_opts_neon.cpp',
+        '../src/opts/SkDisplacementMap_opts_neon.cpp',
+        '../src/opts/SkLighting_opts_neon.cpp',
+        '../src/opts/SkMatrixConvolution_opts_neon.cpp',
         '../src/opts/SkMorphology_opts_neon.cpp',
+        '../src/opts/SkScaledBitmapSampler_opts_neon.cpp',
         '../src/opts/SkXfermode_opts_arm_neon.cpp',
       ],
     },
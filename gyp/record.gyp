@@ -8,6 +8,8 @@
             '../include/config',
             '../include/core',
             '../include/record',
+            '../include/utils',
+            '../src/core',
             '../src/utils',
         ],
         'direct_dependent_settings': {
@@ -8,6 +8,7 @@
       'images.gyp:images',
       'opts.gyp:opts',
       'ports.gyp:ports',
+      'record.gyp:record',
       'sfnt.gyp:sfnt',
       'utils.gyp:utils',
     ],
@@ -15,6 +16,7 @@
       [ 'skia_arch_type == "x86" and skia_os != "android"', {
         'component_libs': [
           'opts.gyp:opts_ssse3',
+          'opts.gyp:opts_avx2',
         ],
       }],
       [ 'arm_neon == 1', {
@@ -14,6 +14,7 @@
       'type': 'none',
       'dependencies': [
         'bbh_shootout',
+        'bench_frame',
         'bench_pictures',
         'bench_record',
         'bench_playback',
@@ -23,6 +24,7 @@
         'lua_app',
         'lua_pictures',
         'pinspect',
+        'profile_record',
         'render_pdfs',
         'render_pictures',
         'skdiff',
@@ -55,6 +57,9 @@
         '../tools/skdiff_utils.cpp',
         '../tools/skdiff_utils.h',
       ],
+      'include_dirs': [
+        '../src/utils', # For SkThreadUtils.h, needed by SkThreadPool.h
+      ],
       'dependencies': [
         'skia_lib.gyp:skia_lib',
       ],
@@ -210,10 +215,12 @@
         '../src/core/',
         '../src/images',
         '../src/lazy',
+        '../src/record',
         '../tools/flags',
       ],
       'dependencies': [
         'flags.gyp:flags',
+        'record.gyp:*',
         'skia_lib.gyp:skia_lib',
       ],
     },
@@ -308,6 +315,38 @@
         'tools.gyp:timer_data',
       ],
     },
+    {
+      'target_name': 'bench_frame',
+      'type': 'executable',
+      'sources': [
+        '../tools/bench_frame.cpp',
+        '../tools/LazyDecodeBitmap.cpp',
+      ],
+      'include_dirs': [
+        '../src/core/',
+        '../src/images',
+        '../src/lazy',
+        '../src/record',
+      ],
+      'dependencies': [
+        'bench.gyp:bench_timer',
+        'flags.gyp:flags',
+        'skia_lib.gyp:skia_lib',
+        'record.gyp:*',
+      ],
+      'conditions': [
+        ['skia_gpu == 1',
+          {
+            'include_dirs' : [
+              '../src/gpu',
+            ],
+            'dependencies': [
+              'gputest.gyp:skgputest',
+            ],
+          },
+        ],
+      ],
+    },
     {
       'target_name': 'bench_record',
       'type': 'executable',
@@ -366,6 +405,26 @@
         'skia_lib.gyp:skia_lib',
       ],
     },
+    {
+      'target_name': 'profile_record',
+      'type': 'executable',
+      'sources': [
+        '../tools/profile_record.cpp',
+        '../tools/LazyDecodeBitmap.cpp',
+      ],
+      'include_dirs': [
+        '../src/core/',
+        '../src/images',
+        '../src/lazy',
+        '../src/record',
+      ],
+      'dependencies': [
+        'bench.gyp:bench_timer',
+        'flags.gyp:flags',
+        'record.gyp:*',
+        'skia_lib.gyp:skia_lib',
+      ],
+    },
     {
       'target_name': 'picture_renderer',
       'type': 'static_library',
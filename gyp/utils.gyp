@@ -23,6 +23,7 @@
         '../include/utils/win',
         '../include/xml',
         '../src/core',
+        '../src/opts',
         '../src/utils',
       ],
       'sources': [
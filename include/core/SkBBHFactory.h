@@ -66,4 +66,26 @@ private:
     typedef SkBBHFactory INHERITED;
 };
 
+/**
+ *  Picks between a tile grid and an R-tree once the picture has been recorded, from the bounds
+ *  of its ops, rather than up front. Pictures whose ops are small next to the tiles they will
+ *  be drawn in get a tile grid with queryTileSize tiles, the rest an R-tree.
+ */
+class SK_API SkAdaptiveBBHFactory : public SkBBHFactory {
+public:
+    /**
+     *  @param queryTileSize The size of the tiles the picture is expected to be drawn in. An
+     *                       empty size rules out the tile grid.
+     */
+    explicit SkAdaptiveBBHFactory(const SkISize& queryTileSize = SkISize::Make(256, 256))
+        : fQueryTileSize(queryTileSize) { }
+
+    virtual SkBBoxHierarchy* operator()(int width, int height) const SK_OVERRIDE;
+
+private:
+    SkISize fQueryTileSize;
+
+    typedef SkBBHFactory INHERITED;
+};
+
 #endif
@@ -0,0 +1,27 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkCacheCounters_DEFINED
+#define SkCacheCounters_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  Counts of a cache's lookups and evictions since the cache was created. They
+ *  are kept in release builds too, and only ever grow, so take two snapshots
+ *  and subtract to look at a stretch of time. A cache that keeps missing and
+ *  evicting while at its budget is thrashing, and needs a bigger budget.
+ */
+struct SK_API SkCacheCounters {
+    SkCacheCounters() : fHits(0), fMisses(0), fEvictions(0) {}
+
+    int32_t fHits;       // Lookups that found their entry.
+    int32_t fMisses;     // Lookups that did not, so the entry had to be made.
+    int32_t fEvictions;  // Entries purged, to stay within budget or to free memory.
+};
+
+#endif
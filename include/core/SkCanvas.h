@@ -33,6 +33,7 @@ class SkPicture;
 class SkRRect;
 class SkSurface;
 class SkSurface_Base;
+class SkTextBlob;
 class GrContext;
 class GrRenderTarget;
 
@@ -721,6 +722,17 @@ public:
     */
     virtual void drawRect(const SkRect& rect, const SkPaint& paint);
 
+    /** Draw each of the rectangles using the specified paint. This draws the
+        same as calling drawRect() for each of them, but the raster backend
+        sets up the blitter once for the whole array, which is much faster for
+        many small fills. A paint with a looper or image filter, or a canvas
+        with a draw filter, draws them one at a time.
+        @param rects    The array of rects to be drawn
+        @param count    The number of rects in the array
+        @param paint    The paint used to draw the rects
+    */
+    virtual void drawRects(const SkRect rects[], int count, const SkPaint& paint);
+
     /** Draw the specified rectangle using the specified paint. The rectangle
         will be filled or framed based on the Style in the paint.
         @param rect     The rect to be drawn
@@ -964,6 +976,16 @@ public:
                                 const SkPath& path, const SkMatrix* matrix,
                                 const SkPaint& paint);
 
+    /** Draw the text blob, offset by (x,y), using the specified paint. The
+        blob's runs supply the glyphs, their positions and the font (typeface,
+        size, etc.); the paint supplies everything else (color, shader, etc.).
+        @param blob     The text blob to be drawn
+        @param x        The x-offset of the text blob
+        @param y        The y-offset of the text blob
+        @param paint    The paint used for the text blob
+    */
+    void drawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y, const SkPaint& paint);
+
     /** PRIVATE / EXPERIMENTAL -- do not call
         Perform back-end analysis/optimization of a picture. This may attach
         optimization data to the picture which can be used by a later
@@ -1227,6 +1249,9 @@ protected:
                                   const SkPath& path, const SkMatrix* matrix,
                                   const SkPaint& paint);
 
+    virtual void onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                                const SkPaint& paint);
+
     enum ClipEdgeStyle {
         kHard_ClipEdgeStyle,
         kSoft_ClipEdgeStyle
@@ -1263,6 +1288,12 @@ protected:
     // notify our surface (if we have one) that we are about to draw, so it
     // can perform copy-on-write or invalidate any cached images
     void predrawNotify();
+    // Same, for a draw that only changes pixels within the local-space bounds
+    // (if not NULL) and the clip. If fillPaint is not NULL, the draw fills
+    // fillRect (or everything, if that is NULL) with it, so the surface can
+    // tell whether its contents are about to be replaced and need not be kept.
+    void predrawNotify(const SkRect* bounds, const SkPaint* fillPaint = NULL,
+                       const SkRect* fillRect = NULL);
 
     virtual void onPushCull(const SkRect& cullRect);
     virtual void onPopCull();
@@ -1283,6 +1314,9 @@ private:
     SkMetaData* fMetaData;
 
     SkSurface_Base*  fSurfaceBase;
+    // notify our surface (if we have one) that its pixels are about to be read
+    void prereadNotify();
+    bool wouldOverwriteEntireSurface(const SkRect* rect, const SkPaint&) const;
     SkSurface_Base* getSurfaceBase() const { return fSurfaceBase; }
     void setSurfaceBase(SkSurface_Base* sb) {
         fSurfaceBase = sb;
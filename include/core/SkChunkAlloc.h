@@ -23,6 +23,14 @@ public:
      */
     void reset();
 
+    /**
+     *  Free up all allocated blocks except the largest, which is kept empty
+     *  for the allocations that follow. This invalidates all returned
+     *  pointers. Use this rather than reset() when the allocator is about to
+     *  be filled again with about as much as before.
+     */
+    void rewind();
+
     enum AllocFailType {
         kReturnNil_AllocFailType,
         kThrow_AllocFailType
@@ -13,17 +13,24 @@
 #include "SkRect.h"
 #include "SkRRect.h"
 #include "SkRegion.h"
+#include "SkTArray.h"
 #include "SkTDArray.h"
 #include "SkTLazy.h"
 
 class SkCanvasClipVisitor;
 
 // Because a single save/restore state can have multiple clips, this class
-// stores the stack depth (fSaveCount) and clips (fDeque) separately.
-// Each clip in fDeque stores the stack state to which it belongs
+// stores the stack depth (fSaveCount) and clips (fTop) separately.
+// Each clip in fTop stores the stack state to which it belongs
 // (i.e., the fSaveCount in force when it was added). Restores are thus
-// implemented by removing clips from fDeque that have an fSaveCount larger
+// implemented by removing clips from fTop that have an fSaveCount larger
 // then the freshly decremented count.
+//
+// The clips are a list of ref counted nodes, each pointing at the one below
+// it, that copies of the stack share. Copying a stack is O(1), and a node is
+// only copied if it is changed while shared, so snapshots (e.g. one per tile,
+// or to hand to another thread) are cheap. Shared nodes are never changed,
+// so stacks on different threads may share them.
 class SK_API SkClipStack {
 public:
     enum BoundsType {
@@ -364,8 +371,8 @@ public:
     class Iter {
     public:
         enum IterStart {
-            kBottom_IterStart = SkDeque::Iter::kFront_IterStart,
-            kTop_IterStart = SkDeque::Iter::kBack_IterStart
+            kBottom_IterStart,
+            kTop_IterStart
         };
 
         /**
@@ -395,7 +402,9 @@ public:
 
     private:
         const SkClipStack* fStack;
-        SkDeque::Iter      fIter;
+        // The elements from the bottom of the stack to the top, and the one to return next.
+        SkSTArray<16, const Element*, true> fElements;
+        int                fIndex;
     };
 
     /**
@@ -408,7 +417,7 @@ public:
 
         /**
          * Wrap Iter's 2 parameter ctor to force initialization to the
-         * beginning of the deque/bottom of the stack
+         * bottom of the stack
          */
         B2TIter(const SkClipStack& stack)
         : INHERITED(stack, kBottom_IterStart) {
@@ -418,7 +427,7 @@ public:
 
         /**
          * Wrap Iter::reset to force initialization to the
-         * beginning of the deque/bottom of the stack
+         * bottom of the stack
          */
         void reset(const SkClipStack& stack) {
             this->INHERITED::reset(stack, kBottom_IterStart);
@@ -452,7 +461,9 @@ public:
 private:
     friend class Iter;
 
-    SkDeque fDeque;
+    struct Node;
+
+    Node*   fTop;       // NULL if there are no clips
     int     fSaveCount;
 
     // Generation ID for the clip stack. This is incremented for each
@@ -465,6 +476,11 @@ private:
      */
     void pushElement(const Element& element);
 
+    /**
+     * Returns the top element, copying its node first if it is shared with another stack.
+     */
+    Element* writableTop();
+
     /**
      * Restore the stack back to the specified save count.
      */
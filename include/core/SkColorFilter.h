@@ -62,6 +62,13 @@ public:
      */
     virtual bool asComponentTable(SkBitmap* table) const;
 
+    /**
+     *  If this filter can fold inner into itself, returns a new filter that is
+     *  the same as applying inner and then this, but in one filterSpan() call.
+     *  The caller owns a ref on the returned filter. Otherwise returns NULL.
+     */
+    virtual SkColorFilter* newComposed(const SkColorFilter* inner) const;
+
     /** Called with a scanline of colors, as if there was a shader installed.
         The implementation writes out its filtered version into result[].
         Note: shader and result may be the same buffer.
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkCoverageMask_DEFINED
+#define SkCoverageMask_DEFINED
+
+#include "SkMask.h"
+
+class SkMatrix;
+class SkPath;
+
+/** \class SkCoverageMask
+    Rasterizes the coverage of paths straight into A8 masks, for callers that
+    want nothing but coverage. There is no paint, and no choice of blitter:
+    the scan converter writes coverage into the mask directly.
+*/
+class SK_API SkCoverageMask {
+public:
+    enum Op {
+        kReplace_Op,    //!< Pixels the path covers take its coverage.
+        kUnion_Op,      //!< Pixels the path covers accumulate its coverage.
+    };
+
+    /** Fills path, transformed by matrix, into mask, which must be in
+        kA8_Format. Pixels outside clip or mask.fBounds, both in device
+        coordinates, are left alone. Inverse fill types cover everything
+        in them that the path doesn't.
+    */
+    static void Fill(const SkPath& path, const SkMatrix& matrix,
+                     const SkIRect& clip, bool antiAlias, Op op,
+                     const SkMask& mask);
+
+    /** Allocates a cleared A8 mask over the part of clip that path,
+        transformed by matrix, covers, and fills path into it. The caller
+        frees the image with SkMask::FreeImage(). Returns false, with no
+        image, if the path covers nothing in clip or the mask would be too
+        big.
+    */
+    static bool Create(const SkPath& path, const SkMatrix& matrix,
+                       const SkIRect& clip, bool antiAlias, SkMask* mask);
+};
+
+#endif
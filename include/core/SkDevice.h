@@ -199,6 +199,9 @@ protected:
                             const SkPoint[], const SkPaint& paint) = 0;
     virtual void drawRect(const SkDraw&, const SkRect& r,
                           const SkPaint& paint) = 0;
+    // Default impl calls drawRect() for each rect
+    virtual void drawRects(const SkDraw&, const SkRect[], int count,
+                           const SkPaint& paint);
     virtual void drawOval(const SkDraw&, const SkRect& oval,
                           const SkPaint& paint) = 0;
     virtual void drawRRect(const SkDraw&, const SkRRect& rr,
@@ -375,6 +378,7 @@ private:
     friend class SkDeferredDevice;    // for newSurface
 
     friend class SkSurface_Raster;
+    friend class SkSurface_Tiled;
 
     // used to change the backend's pixels (and possibly config/rowbytes)
     // but cannot change the width/height, so there should be no change to
@@ -34,7 +34,19 @@ public:
     void    drawPoints(SkCanvas::PointMode, size_t count, const SkPoint[],
                        const SkPaint&, bool forceUseDevice = false) const;
     void    drawRect(const SkRect&, const SkPaint&) const;
+    /**
+     *  Same as calling drawRect() for each rect, but when the paint fills
+     *  them the blitter is chosen once for all of them.
+     */
+    void    drawRects(const SkRect[], int count, const SkPaint&) const;
     void    drawRRect(const SkRRect&, const SkPaint&) const;
+    /**
+     *  If the paint is a plain antialiased fill, the matrix only scales and
+     *  translates, and the rrect is an oval or simple rrect, fill it with
+     *  SkScan::AntiFillRRect and return true. Otherwise draw nothing and
+     *  return false.
+     */
+    bool    drawAnalyticRRect(const SkRRect&, const SkPaint&) const;
     /**
      *  To save on mallocs, we allow a flag that tells us that srcPath is
      *  mutable, so that we don't have to make copies of it as we transform it.
@@ -120,6 +132,14 @@ private:
     void    drawPath(const SkPath&, const SkPaint&, const SkMatrix* preMatrix,
                      bool pathIsMutable, bool drawCoverage) const;
 
+    /**
+     *  If path is made of open lines, dashed by the paint's path effect and
+     *  either hairlined or butt-capped and axis-aligned, draw it one dash at a
+     *  time and return true. Otherwise draw nothing and return false.
+     */
+    bool    drawDashedLines(const SkPath&, const SkMatrix&, const SkPaint&,
+                            bool drawCoverage) const;
+
     /**
      *  Return the current clip bounds, in local coordinates, with slop to account
      *  for antialiasing or hairlines (i.e. device-bounds outset by 1, and then
@@ -10,11 +10,9 @@
 #ifndef SkFlate_DEFINED
 #define SkFlate_DEFINED
 
-#include "SkTypes.h"
+#include "SkStream.h"
 
 class SkData;
-class SkWStream;
-class SkStream;
 
 /** \class SkFlate
     A class to provide access to the flate compression algorithm.
@@ -49,4 +47,52 @@ public:
     static bool Inflate(SkStream* src, SkWStream* dst);
 };
 
+/** \class SkDeflateWStream
+    A stream that compresses what is written to it with the flate algorithm,
+    passing the result on to another stream.  Its compressor state lives
+    across reset(), so compressing many small objects with one instance
+    saves setting up zlib for each of them.
+*/
+class SkDeflateWStream : public SkWStream {
+public:
+    enum {
+        kDefault_Level = -1,    // zlib's default, currently 6.
+        kFastest_Level = 1,
+        kSmallest_Level = 9,
+    };
+
+    enum Strategy {
+        kDefault_Strategy,
+        kFiltered_Strategy,     // For data from a predictor, e.g. PNG rows.
+        kHuffmanOnly_Strategy,
+        kRLE_Strategy,
+    };
+
+    SkDeflateWStream(int level = kDefault_Level,
+                     Strategy strategy = kDefault_Strategy);
+    virtual ~SkDeflateWStream();
+
+    /**
+     *  Starts a new compressed stream, written to dst, abandoning any
+     *  unfinished one.  dst must outlive the call to finish().
+     */
+    void reset(SkWStream* dst);
+
+    /**
+     *  Flushes the end of the compressed stream to dst and detaches from it.
+     *  Returns false if an error occurred since reset().
+     */
+    bool finish();
+
+    virtual bool write(const void* buffer, size_t size) SK_OVERRIDE;
+    // Uncompressed bytes written since reset().
+    virtual size_t bytesWritten() const SK_OVERRIDE;
+
+private:
+    struct Impl;
+    Impl* fImpl;
+
+    typedef SkWStream INHERITED;
+};
+
 #endif
@@ -193,6 +193,32 @@ int SkNumXRayCrossingsForCubic(const SkXRay& pt, const SkPoint cubic[4],
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/** Return the smallest number of lines, at equal steps in t, that stay
+    within tol of the curve when they replace it. This is Wang's formula,
+    which bounds the error by the largest second difference of the control
+    points, so it neither misses the bends of S-shaped cubics nor overcounts
+    shallow curves. The result is pinned to [1, maxCount]; non-finite curves
+    return maxCount.
+*/
+int SkQuadSubdivisionCount(const SkPoint src[3], SkScalar tol, int maxCount);
+int SkCubicSubdivisionCount(const SkPoint src[4], SkScalar tol, int maxCount);
+
+/** As above, for flatteners that need a power of two lines: return the
+    smallest shift such that (1 << shift) lines are within tol of the curve,
+    pinned to [0, maxShift].
+*/
+int SkQuadSubdivisionShift(const SkPoint src[3], SkScalar tol, int maxShift);
+int SkCubicSubdivisionShift(const SkPoint src[4], SkScalar tol, int maxShift);
+
+/** Evaluate the curve at t = 1/count, 2/count, ... 1, writing count points to
+    dst. The last point is exactly the curve's end point. The start point is
+    not written, so consecutive curves can be flattened into one buffer.
+*/
+void SkEvalQuadUniform(const SkPoint src[3], int count, SkPoint dst[]);
+void SkEvalCubicUniform(const SkPoint src[4], int count, SkPoint dst[]);
+
+///////////////////////////////////////////////////////////////////////////////
+
 enum SkRotationDirection {
     kCW_SkRotationDirection,
     kCCW_SkRotationDirection
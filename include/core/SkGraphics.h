@@ -12,6 +12,9 @@
 
 #include "SkTypes.h"
 
+class SkMemoryDump;
+struct SkCacheCounters;
+
 class SK_API SkGraphics {
 public:
     /**
@@ -72,6 +75,52 @@ public:
      */
     static int SetFontCacheCountLimit(int count);
 
+    /**
+     *  Return the max number of bytes the font cache may spend on large
+     *  strikes: text about 40 pixels or taller, and color glyphs such as
+     *  emoji. They are purged to this budget on their own, so that they do
+     *  not push smaller text out of the cache. It is part of, not in addition
+     *  to, GetFontCacheLimit().
+     */
+    static size_t GetFontCacheLargeStrikeLimit();
+
+    /**
+     *  Specify the max number of bytes the font cache may spend on large
+     *  strikes, and return the previous setting.
+     */
+    static size_t SetFontCacheLargeStrikeLimit(size_t bytes);
+
+    /**
+     *  Usage of one strike (a typeface at one size and matrix) in the font
+     *  cache. Hits count lookups answered from the strike, and misses those
+     *  that had to ask the font for a glyph's metrics or to rasterize it.
+     */
+    struct FontCacheStrikeStats {
+        uint32_t    fFontID;
+        float       fTextSize;
+        size_t      fMemoryUsed;
+        int         fGlyphCount;
+        int         fCompressedImageCount;
+        uint32_t    fGlyphHits;
+        uint32_t    fGlyphMisses;
+        uint32_t    fImageHits;
+        uint32_t    fImageMisses;
+        bool        fIsLarge;
+    };
+
+    /**
+     *  Fill stats with up to maxCount of the strikes in the font cache, and
+     *  return how many strikes there are. Strikes being drawn with at the
+     *  time are not counted.
+     */
+    static int GetFontCacheStrikeStats(FontCacheStrikeStats stats[], int maxCount);
+
+    /**
+     *  Lookups of strikes in the font cache, and strikes purged from it. The
+     *  glyphs within each strike are counted by GetFontCacheStrikeStats().
+     */
+    static void GetFontCacheCounters(SkCacheCounters*);
+
     /**
      *  For debugging purposes, this will attempt to purge the font cache. It
      *  does not change the limit, but will cause subsequent font measures and
@@ -83,6 +132,54 @@ public:
     static size_t GetImageCacheByteLimit();
     static size_t SetImageCacheByteLimit(size_t newLimit);
 
+    /**
+     *  Lookups of scaled bitmaps, mipmaps and picture shader tiles in the
+     *  image cache, and entries purged from it.
+     */
+    static void GetImageCacheCounters(SkCacheCounters*);
+
+    /**
+     *  Call when the system is running low on memory. Purges unlocked memory
+     *  of the global discardable memory pool, and shrinks the image and font
+     *  caches with it: by about half, or as far as possible if 'critical'.
+     *  The budgets are not changed.
+     */
+    static void PurgeForMemoryPressure(bool critical);
+
+    /**
+     *  Report the memory held by each process wide cache and pool (the font
+     *  and image caches, the global discardable memory pool, ...) to 'dump'.
+     *  GPU caches belong to their GrContext, which reports them itself.
+     */
+    static void DumpMemoryStatistics(SkMemoryDump* dump);
+
+    /**
+     *  Raster blurs of large images and masks split each of their passes into
+     *  bands of rows run on up to this many threads. The default of 1 blurs on
+     *  the calling thread; a negative count uses one thread per core.
+     *  The threads are started by the first such blur and shared by all later
+     *  ones, so once they are running this only turns threading on or off.
+     *  Returns the previous count.
+     */
+    static int SetBlurThreadCount(int count);
+    static int GetBlurThreadCount();
+
+    /**
+     *  High quality resizes of large images (see SkBitmapScaler) convolve
+     *  bands of output rows on up to this many threads, the same way.
+     *  Returns the previous count.
+     */
+    static int SetResizeThreadCount(int count);
+    static int GetResizeThreadCount();
+
+    /**
+     *  Compressing large masks to R11 EAC or LATC textures (see GrSWMaskHelper)
+     *  splits them into rows of blocks compressed on up to this many threads,
+     *  the same way. Returns the previous count.
+     */
+    static int SetTextureCompressionThreadCount(int count);
+    static int GetTextureCompressionThreadCount();
+
     /**
      *  Applications with command line options may pass optional state, such
      *  as cache sizes, here, for instance:
@@ -19,6 +19,7 @@ class SkPaint;
 class SkShader;
 class GrContext;
 class GrTexture;
+struct GrBackendTextureDesc;
 
 // need for TileMode
 #include "SkShader.h"
@@ -50,6 +51,36 @@ public:
      */
     static SkImage* NewTexture(const SkBitmap&);
 
+    typedef void (*RasterReleaseProc)(const void* pixels, void* releaseContext);
+
+    /**
+     *  Return a new image that draws from the caller's pixels in place,
+     *  without copying them. The pixels must not change for as long as the
+     *  image, or a picture or shader it was drawn into, may still read them.
+     *  Once nothing does, releaseProc (if not NULL) is called with the pixels
+     *  and releaseContext. If the image cannot be made, releaseProc is called
+     *  right away and NULL is returned.
+     */
+    static SkImage* NewFromPixels(const Info&, const void* pixels, size_t rowBytes,
+                                  RasterReleaseProc, void* releaseContext);
+
+    typedef void (*TextureReleaseProc)(void* releaseContext);
+
+    /**
+     *  Return a new image that wraps a texture the caller created with the
+     *  context's 3D API, without copying it. The caller keeps ownership of the
+     *  texture, and must neither delete nor change it until releaseProc (if
+     *  not NULL) is called with releaseContext, once the context no longer
+     *  uses it. If the image cannot be made, releaseProc is called right away
+     *  and NULL is returned.
+     *
+     *  Commands reading the texture may still be queued on the GPU when
+     *  releaseProc is called. Use GrContext::flushWithFence() to know when
+     *  they have run.
+     */
+    static SkImage* NewFromTexture(GrContext*, const GrBackendTextureDesc&, SkAlphaType,
+                                   TextureReleaseProc, void* releaseContext);
+
     int width() const { return fWidth; }
     int height() const { return fHeight; }
     uint32_t uniqueID() const { return fUniqueID; }
@@ -219,6 +219,16 @@ public:
      */
     void resetSampleSize() { this->setSampleSize(1); }
 
+    /** Ask for the decoded bitmap to be width x height, box filtered down from the original
+        as it is decoded, so that a thumbnail does not need the whole image in memory and a
+        resize afterwards. The target is clamped to the original size; it does not upscale.
+        When set it takes the place of the sample size, in the decoders that support it
+        (JPEG and PNG, into premultiplied N32). Others use the sample size as before, so check
+        the size of the result. Pass 0, 0 (the default) to go back to the sample size.
+     */
+    void setTargetSize(int width, int height);
+    const SkISize& getTargetSize() const { return fTargetSize; }
+
     /** Decoding is synchronous, but for long decodes, a different thread can
         call this method safely. This sets a state that the decoders will
         periodically check, and if they see it changed to cancel, they will
@@ -287,6 +297,20 @@ public:
      */
     bool decodeSubset(SkBitmap* bm, const SkIRect& subset, SkColorType pref);
 
+    /**
+     * Decode the luma (Y) and chroma (U and V) planes of the image in the
+     * stream, 8 bits per sample, without converting them to RGB.
+     *
+     * If planes or rowBytes is NULL, only the dimensions of the planes are
+     * returned in componentSizes. Otherwise each plane is written to
+     * planes[i], which must hold componentSizes[i].fHeight rows of
+     * rowBytes[i] bytes.
+     *
+     * Return false if the decoder can't produce YUV planes for this image.
+     */
+    bool decodeYUV8Planes(SkStream* stream, SkISize componentSizes[3],
+                          void* planes[3], size_t rowBytes[3]);
+
     /** Given a stream, this will try to find an appropriate decoder object.
         If none is found, the method returns NULL.
     */
@@ -389,6 +413,14 @@ protected:
         return false;
     }
 
+    // If the decoder can return the YUV planes of an image without converting
+    // them to RGB, this method must be overridden. This guy is called by
+    // decodeYUV8Planes(...)
+    virtual bool onDecodeYUV8Planes(SkStream*, SkISize componentSizes[3],
+                                    void* planes[3], size_t rowBytes[3]) {
+        return false;
+    }
+
     /*
      * Crop a rectangle from the src Bitmap to the dest Bitmap. src and dst are
      * both sampled by sampleSize from an original Bitmap.
@@ -470,6 +502,7 @@ private:
 #endif
     SkBitmap::Allocator*    fAllocator;
     int                     fSampleSize;
+    SkISize                 fTargetSize;
     SkColorType             fDefaultPref;   // use if fUsePrefTable is false
     PrefConfigTable         fPrefTable;     // use if fUsePrefTable is true
     bool                    fDitherImage;
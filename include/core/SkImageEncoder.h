@@ -30,8 +30,18 @@ public:
     };
     static SkImageEncoder* Create(Type);
 
+    SkImageEncoder() : fThreadCount(1) {}
     virtual ~SkImageEncoder();
 
+    /**
+     *  Encoders that can split up their work, currently PNG, use up to
+     *  threadCount threads on each image large enough to be worth it. The
+     *  default of 1 encodes on the calling thread. The output may differ
+     *  from a single threaded encode, but decodes to the same pixels.
+     */
+    void setThreadCount(int threadCount) { fThreadCount = SkMax32(1, threadCount); }
+    int getThreadCount() const { return fThreadCount; }
+
     /*  Quality ranges from 0..100 */
     enum {
         kDefaultQuality = 80
@@ -74,6 +84,9 @@ protected:
      * This must be overridden by each SkImageEncoder implementation.
      */
     virtual bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) = 0;
+
+private:
+    int fThreadCount;
 };
 
 // This macro declares a global (i.e., non-class owned) creation entry point
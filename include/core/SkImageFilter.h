@@ -50,13 +50,29 @@ public:
 
     class SK_API Cache : public SkRefCnt {
     public:
+        // Identifies a result: the filter that made it, and everything about the context
+        // and src that it depends on. A filter shared within a DAG, or reached again by way
+        // of an SkComposeImageFilter with a different src, is told apart by these.
+        struct Key {
+            Key(uint32_t uniqueID, const SkMatrix& matrix, const SkIRect& clipBounds,
+                uint32_t srcGenID);
+            bool operator==(const Key& other) const {
+                return 0 == memcmp(this, &other, sizeof(Key));
+            }
+            uint32_t fUniqueID;
+            SkScalar fMatrix[9];
+            SkIRect  fClipBounds;
+            uint32_t fSrcGenID;
+        };
+
         // By default, we cache only image filters with 2 or more children.
         static Cache* Create(int minChildren = 2);
         virtual ~Cache() {}
-        virtual bool get(const SkImageFilter* key, SkBitmap* result, SkIPoint* offset) = 0;
-        virtual void set(const SkImageFilter* key,
+        virtual bool get(const Key& key, SkBitmap* result, SkIPoint* offset) = 0;
+        // 'filter' made the result; a cache may use it to decide what is worth keeping.
+        virtual void set(const Key& key, const SkImageFilter* filter,
                          const SkBitmap& result, const SkIPoint& offset) = 0;
-        virtual void remove(const SkImageFilter* key) = 0;
+        virtual void remove(const Key& key) = 0;
     };
 
     class Context {
@@ -109,6 +125,16 @@ public:
      */
     bool filterBounds(const SkIRect& src, const SkMatrix& ctm, SkIRect* dst) const;
 
+    /**
+     *  Returns in clipBounds the part of srcBounds that has to be filtered for the result to
+     *  be complete over visible, by mapping visible back through filterBounds(). This is the
+     *  clip to filter a src with when only part of the result will be seen; every node of the
+     *  DAG is then evaluated over that rather than the whole src. Returns false if no part of
+     *  the result can be seen.
+     */
+    bool computeClipBounds(const SkIRect& visible, const SkIRect& srcBounds, const SkMatrix& ctm,
+                           SkIRect* clipBounds) const;
+
     /**
      *  Returns true if the filter can be processed on the GPU.  This is most
      *  often used for multi-pass effects, where intermediate results must be
@@ -131,6 +157,14 @@ public:
     virtual bool filterImageGPU(Proxy*, const SkBitmap& src, const Context&,
                                 SkBitmap* result, SkIPoint* offset) const;
 
+    /**
+     *  Returns true if this filter and all of its inputs can be evaluated on the GPU without
+     *  reading any texture back to the CPU. If not, and cpuFilter is not NULL, it is set to
+     *  the first filter of the DAG (depth first) that would need the pixels on the CPU. This
+     *  only inspects the filters, so it can be asked whenever a paint is recorded.
+     */
+    bool canFilterGraphGPU(const SkImageFilter** cpuFilter = NULL) const;
+
     /**
      *  Returns whether this image filter is a color filter and puts the color filter into the
      *  "filterPtr" parameter if it can. Does nothing otherwise.
@@ -140,6 +174,11 @@ public:
      */
     virtual bool asColorFilter(SkColorFilter** filterPtr) const;
 
+    /**
+     *  Returns an ID unique to this filter, which keys its results in the Cache.
+     */
+    uint32_t uniqueID() const { return fUniqueID; }
+
     /**
      *  Returns the number of inputs this filter will accept (some inputs can
      *  be NULL).
@@ -237,6 +276,14 @@ protected:
      */
     virtual bool onFilterImage(Proxy*, const SkBitmap& src, const Context&,
                                SkBitmap* result, SkIPoint* offset) const;
+    /**
+     *  Returns true if onFilterImage() only draws its inputs through devices made by the
+     *  proxy, and never touches their pixels itself. On the GPU those devices are render
+     *  targets, so such a filter never causes a readback even without filterImageGPU().
+     *  The default returns false.
+     */
+    virtual bool drawsThroughProxy() const;
+
     // Given the bounds of the destination rect to be filled in device
     // coordinates (first parameter), and the CTM, compute (conservatively)
     // which rect of the source image would be required (third parameter).
@@ -291,6 +338,7 @@ private:
     int fInputCount;
     SkImageFilter** fInputs;
     CropRect fCropRect;
+    uint32_t fUniqueID;
 };
 
 #endif
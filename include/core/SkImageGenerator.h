@@ -14,6 +14,7 @@
 class SkBitmap;
 class SkData;
 class SkImageGenerator;
+struct SkIRect;
 
 /**
  *  Takes ownership of SkImageGenerator.  If this method fails for
@@ -116,12 +117,48 @@ public:
     bool getPixels(const SkImageInfo& info, void* pixels, size_t rowBytes);
 #endif
 
+    /**
+     *  Decode only the pixels inside subset, given in the coordinates of
+     *  getInfo(), downscaled by sampleSize (1, 2, 4 or 8). This lets a
+     *  caller that only shows part of a large image, or shows it small,
+     *  avoid decoding all of it. JPEG, for example, scales in the DCT
+     *  and stops reading after the last row of the subset.
+     *
+     *  On success bitmap is allocated and holds the decoded pixels in the
+     *  color type of getInfo(). Its dimensions are those of the subset
+     *  divided by sampleSize, give or take the rounding of the codec.
+     *
+     *  @return false if the generator can't decode subsets, or if anything
+     *          goes wrong.
+     */
+    bool getPixels(const SkIRect& subset, int sampleSize, SkBitmap* bitmap);
+
+    /**
+     *  Decode the image to its luma (Y) and chroma (U and V) planes, 8 bits
+     *  per sample, without converting it to RGB. This lets the GPU upload a
+     *  YUV image, e.g. a JPEG, at a fraction of the size of its RGBA pixels
+     *  and do the color conversion itself.
+     *
+     *  If planes or rowBytes is NULL, only set sizes to the dimensions of
+     *  the three planes, which may differ when the chroma is subsampled.
+     *  Otherwise planes[i] must hold sizes[i].fHeight rows of rowBytes[i]
+     *  bytes, at least sizes[i].fWidth each, as returned by an earlier call.
+     *
+     *  @return false if the generator can't provide YUV planes, or if
+     *          anything goes wrong.
+     */
+    bool getYUV8Planes(SkISize sizes[3], void* planes[3], size_t rowBytes[3]);
+
 protected:
     virtual SkData* onRefEncodedData();
     virtual bool onGetInfo(SkImageInfo* info);
     virtual bool onGetPixels(const SkImageInfo& info,
                              void* pixels, size_t rowBytes,
                              SkPMColor ctable[], int* ctableCount);
+    // returns false
+    virtual bool onGetSubsetPixels(const SkIRect& subset, int sampleSize, SkBitmap* bitmap);
+    // returns false
+    virtual bool onGetYUV8Planes(SkISize sizes[3], void* planes[3], size_t rowBytes[3]);
 };
 
 #endif  // SkImageGenerator_DEFINED
@@ -165,9 +165,15 @@ protected:
     };
 
     struct NinePatch {
+        NinePatch() : fCache(NULL) {
+            fMask.fImage = NULL;
+        }
+        ~NinePatch();
+
         SkMask      fMask;      // fBounds must have [0,0] in its top-left
         SkIRect     fOuterRect; // width/height must be >= fMask.fBounds'
         SkIPoint    fCenter;    // identifies center row/col for stretching
+        const SkRefCnt* fCache; // if not NULL, owns fMask.fImage in place of the patch
     };
 
     /**
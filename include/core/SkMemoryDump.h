@@ -0,0 +1,46 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMemoryDump_DEFINED
+#define SkMemoryDump_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  Receives the memory held by Skia's caches and pools, one dumpCache() call
+ *  per cache. Pass one to SkGraphics::DumpMemoryStatistics() for the process
+ *  wide caches, and to GrContext::dumpMemoryStatistics() for a context's.
+ */
+class SK_API SkMemoryDump {
+public:
+    virtual ~SkMemoryDump() {}
+
+    /**
+     *  'name' identifies the cache, e.g. "skia/font_cache". It is a literal,
+     *  but may be reported more than once if there are several such caches.
+     *  'allocatedBytes' is all the memory the cache holds, and
+     *  'purgeableBytes' the part of it that could be freed right now, because
+     *  no one is using it.
+     *
+     *  Caches that allocate from discardable memory report their bytes, and
+     *  the discardable pool reports them again if they came from the global
+     *  pool.
+     */
+    virtual void dumpCache(const char name[], size_t allocatedBytes,
+                           size_t purgeableBytes) = 0;
+
+    typedef void (*DumpProc)(SkMemoryDump*);
+
+    /**
+     *  Adds a proc for SkGraphics::DumpMemoryStatistics() to call, so that a
+     *  cache outside of core can report itself. Caches register when they
+     *  are first created. Registering a proc again does nothing.
+     */
+    static void RegisterGlobalProc(DumpProc);
+};
+
+#endif
@@ -1001,6 +1001,7 @@ private:
     friend class Iter;
 
     friend class SkPathStroker;
+    friend class SkPathHeap;    // writeToCompact(), readFromCompact()
 
     /*  Append, in reverse order, the first contour of path, ignoring path's
         last point. If no moveTo() call has been made for this contour, the
@@ -1039,6 +1040,15 @@ private:
         ed.setBounds(rect);
     }
 
+    /*  The lossy encoding of SkPicture::kCompactPaths_SerializeFlag; see
+        SkPathRef::writeCompact(). writeToCompact() returns false, appending
+        nothing, if the path is not finite. readFromCompact() returns false if
+        the data is malformed, and otherwise leaves the path with its bounds
+        (and convexity, if it was known when written) computed.
+     */
+    bool writeToCompact(SkTDArray<uint8_t>* data) const;
+    bool readFromCompact(const void* buffer, size_t length);
+
     friend class SkAutoPathBoundsUpdate;
     friend class SkAutoDisableOvalCheck;
     friend class SkAutoDisableDirectionCheck;
@@ -11,6 +11,13 @@
 #include "SkPath.h"
 #include "SkTDArray.h"
 
+/** \class SkPathMeasure
+
+    Measures the length of a path's contours, and finds positions and segments
+    along them. Measuring a path with curves (or many verbs) again, e.g. to lay
+    out text along it every frame, reuses the earlier measurements: they are
+    kept in a global, size-bounded cache keyed on the path's generation ID.
+*/
 class SK_API SkPathMeasure : SkNoncopyable {
 public:
     SkPathMeasure();
@@ -78,13 +85,6 @@ public:
 #endif
 
 private:
-    SkPath::Iter    fIter;
-    const SkPath*   fPath;
-    SkScalar        fLength;            // relative to the current contour
-    int             fFirstPtIndex;      // relative to the current contour
-    bool            fIsClosed;          // relative to the current contour
-    bool            fForceClosed;
-
     struct Segment {
         SkScalar    fDistance;  // total distance up to this point
         unsigned    fPtIndex : 15; // index into the fPts array
@@ -93,17 +93,22 @@ private:
 
         SkScalar getScalarT() const;
     };
-    SkTDArray<Segment>  fSegments;
-    SkTDArray<SkPoint>  fPts; // Points used to define the segments
+    struct Contour;
+    class Table;
+
+    SkPath::Iter    fIter;
+    const SkPath*   fPath;
+    Table*          fTable;         // NULL until the path is first measured
+    int             fContourIndex;  // the current contour in fTable, or -1
+    bool            fTableIsShared; // fTable came from the cache, and is complete
+    bool            fForceClosed;
 
     static const Segment* NextSegment(const Segment*);
+    static Table* FindCachedTable(const SkPath&, bool forceClosed);
 
-    void     buildSegments();
-    SkScalar compute_quad_segs(const SkPoint pts[3], SkScalar distance,
-                                int mint, int maxt, int ptIndex);
-    SkScalar compute_cubic_segs(const SkPoint pts[3], SkScalar distance,
-                                int mint, int maxt, int ptIndex);
-    const Segment* distanceToSegment(SkScalar distance, SkScalar* t);
+    const Contour* currentContour();
+    const Segment* distanceToSegment(const Contour&, SkScalar distance,
+                                     SkScalar* t) const;
 };
 
 #endif
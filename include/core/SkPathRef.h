@@ -17,6 +17,7 @@
 #include <stddef.h> // ptrdiff_t
 
 class SkRBuffer;
+class SkRBufferWithSizeCheck;
 class SkWBuffer;
 
 /**
@@ -175,6 +176,11 @@ public:
 
     static SkPathRef* CreateFromBuffer(SkRBuffer* buffer);
 
+    /**
+     * Reads a path ref written by writeCompact(), or returns NULL if the data is malformed.
+     */
+    static SkPathRef* CreateFromCompact(SkRBufferWithSizeCheck* buffer);
+
     /**
      * Rollsback a path ref to zero verbs and points with the assumption that the path ref will be
      * repopulated with approximately the same number of verbs and points. A new path ref is created
@@ -246,6 +252,14 @@ public:
      */
     uint32_t writeSize() const;
 
+    /**
+     * Appends a compact, lossy encoding of the path points and verbs to data. The points are
+     * quantized to 1/65535 of the larger side of the bounds and stored as varint deltas, and each
+     * run of a repeated verb is stored once. Returns false, appending nothing, if the path ref is
+     * not finite.
+     */
+    bool writeCompact(SkTDArray<uint8_t>* data) const;
+
     /**
      * Gets an ID that uniquely identifies the contents of the path ref. If two path refs have the
      * same ID then they have the same verbs and points. However, two path refs may have the same
@@ -25,6 +25,8 @@ class SkDrawPictureCallback;
 class SkData;
 class SkPicturePlayback;
 class SkPictureRecord;
+class SkRecord;
+class SkRecordBBH;
 class SkStream;
 class SkWStream;
 
@@ -102,6 +104,20 @@ public:
     static SkPicture* CreateFromStream(SkStream*,
                                        InstallPixelRefProc proc = &SkImageDecoder::DecodeMemory);
 
+    /**
+     *  Recreate a picture that was serialized into 'data', e.g. an SKP file loaded with
+     *  SkData::NewFromFD(). Instead of copying them, the picture refs 'data' and reads its
+     *  drawing commands in place (for SKPs written at version 29 or later).
+     *  @param SkData Serialized picture data.
+     *  @param proc Function pointer for installing pixelrefs on SkBitmaps representing the
+     *              encoded bitmap data. Pass a proc that installs a lazily decoding pixelref
+     *              (e.g. one backed by SkDecodingImageGenerator) to defer decoding.
+     *  @return A new SkPicture representing the serialized data, or NULL if the data is
+     *          invalid.
+     */
+    static SkPicture* CreateFromData(SkData*,
+                                     InstallPixelRefProc proc = &SkImageDecoder::DecodeMemory);
+
     /**
      *  Recreate a picture that was serialized into a buffer. If the creation requires bitmap
      *  decoding, the decoder must be set on the SkReadBuffer parameter by calling
@@ -136,6 +152,34 @@ public:
     */
     void draw(SkCanvas* canvas, SkDrawPictureCallback* = NULL) const;
 
+    /**
+     *  Supplies the canvases that playbackTiled() draws tiles into.
+     */
+    class TileCanvasFactory {
+    public:
+        virtual ~TileCanvasFactory() {}
+
+        /**
+         *  Return a new canvas for 'tile' (in picture coordinates) whose origin
+         *  corresponds to the tile's top left corner, or NULL to skip the tile.
+         *  This may be called from several threads at once. The caller unrefs
+         *  the canvas once the tile is drawn.
+         */
+        virtual SkCanvas* newTileCanvas(const SkIRect& tile) = 0;
+    };
+
+    /**
+     *  Draw the picture as a grid of tiles of 'tileSize' (the last row and
+     *  column are cropped to the picture's bounds), each into its own canvas
+     *  from 'factory'. With a threadCount above 1 the tiles are drawn by that
+     *  many threads, each playing back its own clone of the picture, which
+     *  shares the recorded op data. Pictures recorded with a bounding box
+     *  hierarchy only play back the ops that touch each tile.
+     *  Returns once every tile has been drawn.
+     */
+    void playbackTiled(TileCanvasFactory* factory, const SkISize& tileSize,
+                       int threadCount) const;
+
     /** Return the width of the picture's recording canvas. This
         value reflects what was passed to setSize(), and does not necessarily
         reflect the bounds of what has been recorded into the picture.
@@ -169,12 +213,31 @@ public:
      */
     typedef SkData* (*EncodeBitmap)(size_t* pixelRefOffset, const SkBitmap& bm);
 
+    enum SerializeFlags {
+        /**
+         *  Store paths in a compact, lossy encoding, usually half the size or
+         *  less: points are rounded to 1/65535 of the larger side of their
+         *  path's bounds, and stored as deltas from the previous point. Paths
+         *  are expanded as the picture first draws them. Paths that are not
+         *  finite are stored as usual.
+         */
+        kCompactPaths_SerializeFlag = 1 << 0,
+        /**
+         *  Deflate the op stream, and separately the flattened bitmaps, paints,
+         *  paths and text blobs, where that makes them smaller. Reading them
+         *  back needs SkFlate::HaveFlate(); without it this flag is ignored
+         *  when writing.
+         */
+        kCompressed_SerializeFlag   = 1 << 1,
+    };
+
     /**
      *  Serialize to a stream. If non NULL, encoder will be used to encode
      *  any bitmaps in the picture.
      *  encoder will never be called with a NULL pixelRefOffset.
+     *  flags is a combination of SerializeFlags.
      */
-    void serialize(SkWStream*, EncodeBitmap encoder = NULL) const;
+    void serialize(SkWStream*, EncodeBitmap encoder = NULL, uint32_t flags = 0) const;
 
     /**
      *  Serialize to a buffer.
@@ -245,13 +308,19 @@ protected:
     // V26: Removed boolean from SkColorShader for inheriting color from SkPaint.
     // V27: Remove SkUnitMapper from gradients (and skia).
     // V28: No longer call bitmap::flatten inside SkWriteBuffer::writeBitmap.
+    // V29: Pad the SK_PICT_READER_TAG and SK_PICT_BUFFER_SIZE_TAG payloads to 4 byte alignment
+    //      so they can be read in place.
+    // V30: Add SK_PICT_COMPACT_PATH_BUFFER_TAG for kCompactPaths_SerializeFlag.
+    // V31: Add DRAW_TEXT_BLOB and SK_PICT_TEXTBLOB_BUFFER_TAG.
+    // V32: Add SK_PICT_DEFLATED_READER_TAG and SK_PICT_DEFLATED_BUFFER_SIZE_TAG for
+    //      kCompressed_SerializeFlag.
 
     // Note: If the picture version needs to be increased then please follow the
     // steps to generate new SKPs in (only accessible to Googlers): http://goo.gl/qATVcw
 
     // Only SKPs within the min/current picture version range (inclusive) can be read.
     static const uint32_t MIN_PICTURE_VERSION = 19;
-    static const uint32_t CURRENT_PICTURE_VERSION = 28;
+    static const uint32_t CURRENT_PICTURE_VERSION = 32;
 
     mutable uint32_t      fUniqueID;
 
@@ -271,9 +340,29 @@ protected:
     SkPicture(int width, int height, const SkPictureRecord& record, bool deepCopyOps);
 
 private:
+    // Takes ownership of the SkRecord, which should already be optimized.
+    // If bbh is not NULL, it is filled with the record's ops and used to cull playback.
+    SkPicture(int width, int height, SkRecord*, SkBBoxHierarchy* bbh);
+
+    // An SkRecord-backed picture has an fRecord and no fPlayback. For the
+    // things only SkPicturePlayback can do, like serializing, we replay the
+    // record into an SkPictureRecord and make a (caller-owned) playback from it.
+    SkPicturePlayback* backport() const;
+
+    // Makes an independent copy of fRecord, for SkPicture copies and clones.
+    // The copy matches fRecord op for op, so fRecordBBH can be shared.
+    SkRecord* copyRecord() const;
+
+    SkRecord*             fRecord;
+    const SkRecordBBH*    fRecordBBH;   // ref counted, may be NULL
+
     static void WriteTagSize(SkWriteBuffer& buffer, uint32_t tag, size_t size);
     static void WriteTagSize(SkWStream* stream, uint32_t tag, size_t size);
 
+    // If non-NULL, 'streamData' holds the contents of 'stream' (an SkMemoryStream), letting the
+    // playback reference the op data in place rather than copying it.
+    static SkPicture* CreateFromStream(SkStream*, InstallPixelRefProc, const SkData* streamData);
+
     // An OperationList encapsulates a set of operation offsets into the picture byte
     // stream along with the CTMs needed for those operation.
     class OperationList : ::SkNoncopyable {
@@ -14,10 +14,12 @@
 
 class SkCanvas;
 class SkPictureRecord;
+class SkRecord;
+class SkRecorder;
 
 class SK_API SkPictureRecorder : SkNoncopyable {
 public:
-    SkPictureRecorder() : fCanvas(NULL) { }
+    SkPictureRecorder() : fCanvas(NULL), fRecord(NULL), fRecorder(NULL), fBBH(NULL) { }
     ~SkPictureRecorder();
 
     /** Returns the canvas that records the drawing commands.
@@ -33,6 +35,13 @@ public:
                              SkBBHFactory* bbhFactory = NULL,
                              uint32_t recordFlags = 0);
 
+    /** Same as beginRecording(), but the picture is recorded into an SkRecord
+        and played back directly from it. The bounding box hierarchy, if any,
+        is filled from the finished record. Record flags are not supported.
+    */
+    SkCanvas* EXPERIMENTAL_beginRecording(int width, int height,
+                                          SkBBHFactory* bbhFactory = NULL);
+
     /** Returns the recording canvas if one is active, or NULL if recording is
         not active. This does not alter the refcnt on the canvas (if present).
     */
@@ -64,6 +73,9 @@ private:
     int                     fWidth;
     int                     fHeight;
     SkPictureRecord*        fCanvas;   // ref counted
+    SkRecord*               fRecord;   // owned until endRecording()
+    SkRecorder*             fRecorder; // ref counted
+    SkBBoxHierarchy*        fBBH;      // ref counted, for fRecord
 
     typedef SkNoncopyable INHERITED;
 };
@@ -184,6 +184,16 @@ public:
         return this->onRefEncodedData();
     }
 
+    /**
+     *  If the pixelRef can produce the luma and chroma planes of its image
+     *  without decoding to RGB, e.g. from a JPEG, copy them into planes and
+     *  return true. See SkImageGenerator::getYUV8Planes(): if planes or
+     *  rowBytes is NULL, only the sizes of the planes are returned.
+     */
+    bool getYUV8Planes(SkISize sizes[3], void* planes[3], size_t rowBytes[3]) {
+        return this->onGetYUV8Planes(sizes, planes, rowBytes);
+    }
+
     /**
      *  Experimental -- tells the caller if it is worth it to call decodeInto().
      *  Just an optimization at this point, to avoid checking the cache first.
@@ -307,6 +317,9 @@ protected:
     // default impl returns NULL.
     virtual SkData* onRefEncodedData();
 
+    // default impl returns false.
+    virtual bool onGetYUV8Planes(SkISize sizes[3], void* planes[3], size_t rowBytes[3]);
+
     /**
      *  Returns the size (in bytes) of the internally allocated memory.
      *  This should be implemented in all serializable SkPixelRef derived classes.
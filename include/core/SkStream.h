@@ -277,9 +277,15 @@ public:
 
     virtual size_t getLength() const SK_OVERRIDE;
 
+    /** Maps the file, if it can be, the first time it is called. Duplicates
+        and forks made after that share the mapping, rather than reopening
+        the file.
+     */
     virtual const void* getMemoryBase() SK_OVERRIDE;
 
 private:
+    SkData* mapData() const;
+
     SkFILE*     fFILE;
     SkString    fName;
     Ownership   fOwnership;
@@ -13,6 +13,7 @@
 
 class SkCanvas;
 class SkPaint;
+class SkRegion;
 class GrContext;
 class GrRenderTarget;
 
@@ -55,6 +56,20 @@ public:
         return NewRaster(SkImageInfo::MakeN32Premul(width, height));
     }
 
+    /**
+     *  Return a new raster surface whose canvas records draws rather than
+     *  rasterizing them immediately. The first time the pixels are needed
+     *  (newImageSnapshot, draw, peekPixels), the pending draws are replayed
+     *  into tileWidth x tileHeight tiles of the surface in parallel, on a pool
+     *  of threadCount worker threads owned by the surface. A negative
+     *  threadCount uses one thread per core; 0 rasterizes on the calling thread.
+     *
+     *  If the requested surface cannot be created, or the request is not a
+     *  supported configuration, NULL will be returned.
+     */
+    static SkSurface* NewRasterTiled(const SkImageInfo&, int tileWidth = 256,
+                                     int tileHeight = 256, int threadCount = -1);
+
     /**
      *  Text rendering modes that can be passed to NewRenderTarget*
      */
@@ -184,6 +199,25 @@ public:
      */
     const void* peekPixels(SkImageInfo* info, size_t* rowBytes);
 
+    /**
+     *  While damage tracking is on, the surface accumulates the device bounds
+     *  of every draw into it, so that a compositor can upload or present only
+     *  what changed. The region is conservative: it holds every pixel that may
+     *  have changed, and may hold more. Draws that can't be bounded, and calls
+     *  to notifyContentWillChange(), damage the whole surface.
+     *
+     *  Turning tracking on or off empties the damage.
+     */
+    void setTracksDamage(bool);
+    bool tracksDamage() const;
+
+    /**
+     *  Returns the damage since tracking was turned on or resetDamage() was
+     *  last called. A region with many rects is simplified to its bounds.
+     */
+    const SkRegion& damage() const;
+    void resetDamage();
+
 protected:
     SkSurface(int width, int height);
     SkSurface(const SkImageInfo&);
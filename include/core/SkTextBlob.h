@@ -0,0 +1,155 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTextBlob_DEFINED
+#define SkTextBlob_DEFINED
+
+#include "SkPaint.h"
+#include "SkRefCnt.h"
+#include "SkTArray.h"
+#include "SkTDArray.h"
+
+class SkReadBuffer;
+class SkWriteBuffer;
+
+/** \class SkTextBlob
+
+    SkTextBlob is an immutable, shaped run of text: glyph IDs, their
+    positions, and the fonts they are drawn with, plus precomputed bounds.
+    It is built once with SkTextBlobBuilder and may then be drawn any number
+    of times with SkCanvas::drawTextBlob(). Recording canvases keep a ref on
+    the blob rather than copying its glyphs and positions.
+*/
+class SK_API SkTextBlob : public SkRefCnt {
+public:
+    SK_DECLARE_INST_COUNT(SkTextBlob)
+
+    virtual ~SkTextBlob();
+
+    /** Returns the blob's conservative bounds, relative to its origin.
+    */
+    const SkRect& bounds() const { return fBounds; }
+
+    /** Returns a non-zero ID unique to this blob.
+    */
+    uint32_t uniqueID() const { return fUniqueID; }
+
+    /** Serializes the blob, for CreateFromBuffer(). */
+    void flatten(SkWriteBuffer&) const;
+
+    /** Recreates a blob written by flatten(), or returns NULL if the buffer
+        is invalid. The caller owns the returned ref.
+    */
+    static const SkTextBlob* CreateFromBuffer(SkReadBuffer&);
+
+    enum GlyphPositioning {
+        kDefault_Positioning,       // Default glyph advances, from an origin.
+        kHorizontal_Positioning,    // Horizontal positions, on one baseline.
+        kFull_Positioning           // Point positions.
+    };
+
+    /** Iterates over the runs of a blob. The blob must outlive the iterator.
+    */
+    class SK_API RunIterator {
+    public:
+        explicit RunIterator(const SkTextBlob* blob);
+
+        bool done() const { return fIndex >= fBlob->fRuns.count(); }
+        void next() { fIndex += 1; }
+
+        int glyphCount() const;
+        const uint16_t* glyphs() const;
+        // kDefault: NULL. kHorizontal: one x per glyph. kFull: x,y per glyph.
+        const SkScalar* pos() const;
+        // The run's origin for kDefault, or its baseline y in fY for kHorizontal.
+        const SkPoint& offset() const;
+        GlyphPositioning positioning() const;
+
+        /** Sets paint's text attributes (typeface, size, etc.) to the run's,
+            and its text encoding to glyph IDs.
+        */
+        void applyFontToPaint(SkPaint* paint) const;
+
+    private:
+        const SkTextBlob* fBlob;
+        int               fIndex;
+    };
+
+private:
+    struct Run {
+        SkPaint          fFont;
+        int              fCount;
+        int              fGlyphStart;
+        int              fPosStart;
+        SkPoint          fOffset;
+        GlyphPositioning fPositioning;
+    };
+
+    SkTextBlob();
+
+    SkTArray<Run>       fRuns;
+    SkTDArray<uint16_t> fGlyphs;
+    SkTDArray<SkScalar> fPos;
+    SkRect              fBounds;
+    uint32_t            fUniqueID;
+
+    friend class SkTextBlobBuilder;
+
+    typedef SkRefCnt INHERITED;
+};
+
+/** \class SkTextBlobBuilder
+
+    Builds an SkTextBlob run by run. Each allocRun* call returns buffers for
+    the run's glyphs (and positions) that the caller fills in; they are only
+    valid until the next call on the builder.
+*/
+class SK_API SkTextBlobBuilder {
+public:
+    SkTextBlobBuilder();
+    ~SkTextBlobBuilder();
+
+    struct RunBuffer {
+        uint16_t* glyphs;
+        SkScalar* pos;
+    };
+
+    /** Adds a run of count glyphs drawn with font's text attributes, placed
+        by their advances from (x, y). If bounds is not NULL it is used as the
+        run's bounds, instead of measuring the glyphs.
+    */
+    const RunBuffer& allocRun(const SkPaint& font, int count, SkScalar x, SkScalar y,
+                              const SkRect* bounds = NULL);
+
+    /** Adds a run of count glyphs on the baseline y, each with its own x
+        (count scalars in pos).
+    */
+    const RunBuffer& allocRunPosH(const SkPaint& font, int count, SkScalar y,
+                                  const SkRect* bounds = NULL);
+
+    /** Adds a run of count glyphs, each with its own x, y (2 * count scalars
+        in pos).
+    */
+    const RunBuffer& allocRunPos(const SkPaint& font, int count, const SkRect* bounds = NULL);
+
+    /** Returns a blob of the runs added so far, and resets the builder. The
+        caller owns the returned ref.
+    */
+    const SkTextBlob* build();
+
+private:
+    const RunBuffer& allocInternal(const SkPaint& font, int count, SkPoint offset,
+                                   SkTextBlob::GlyphPositioning, const SkRect* bounds);
+    void updateDeferredBounds();
+
+    SkTextBlob* fBlob;          // the blob being built, or NULL
+    SkRect      fBounds;
+    bool        fDeferredBounds;    // the last run's bounds are still to be added
+    RunBuffer   fCurrentRunBuffer;
+};
+
+#endif
@@ -65,6 +65,17 @@ SK_API extern void* sk_calloc(size_t size);
  */
 SK_API extern void* sk_calloc_throw(size_t size);
 
+/** Turns allocation counting on or off, for benchmarks. Turning it on resets the counts. While it
+    is on, every successful allocation by the functions above counts once, along with its size.
+    Memory from operator new is only counted when it comes from sk_malloc, as it does with
+    SK_OVERRIDE_GLOBAL_NEW.
+*/
+SK_API extern void sk_set_allocation_counting(bool enabled);
+/** Returns the allocations and bytes counted since counting was last turned on. The counts wrap
+    at 2^32.
+*/
+SK_API extern void sk_get_allocation_counts(uint32_t* allocations, uint32_t* bytes);
+
 // bzero is safer than memset, but we can't rely on it, so... sk_bzero()
 static inline void sk_bzero(void* buffer, size_t size) {
     memset(buffer, 0, size);
@@ -19,9 +19,17 @@
 #include "SkRegion.h"
 #include "SkScalar.h"
 #include "SkStream.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
 #include "SkTypes.h"
 
+/**
+ *  SkWriter32 stores what it writes in a list of segments. When a write does not fit in the
+ *  current segment, it starts a new one instead of reallocating and copying what has been written
+ *  so far. A single write is never split across segments, so a record written by one call can be
+ *  read or overwritten in place. The segments are joined into one buffer only when a caller asks
+ *  for contiguous data (contiguousArray(), snapshotAsData()).
+ */
 class SkWriter32 : SkNoncopyable {
 public:
     /**
@@ -31,42 +39,38 @@ public:
      *  first time an allocation doesn't fit.  From then it will use dynamically allocated storage.
      *  This used to be optional behavior, but pipe now relies on it.
      */
-    SkWriter32(void* external = NULL, size_t externalBytes = 0) {
+    SkWriter32(void* external = NULL, size_t externalBytes = 0) : fSpare(NULL), fSpareCapacity(0) {
         this->reset(external, externalBytes);
     }
 
+    ~SkWriter32();
+
     // return the current offset (will always be a multiple of 4)
     size_t bytesWritten() const { return fUsed; }
 
     SK_ATTR_DEPRECATED("use bytesWritten")
     size_t size() const { return this->bytesWritten(); }
 
-    void reset(void* external = NULL, size_t externalBytes = 0) {
-        SkASSERT(SkIsAlign4((uintptr_t)external));
-        SkASSERT(SkIsAlign4(externalBytes));
-
-        fSnapshot.reset(NULL);
-        fData = (uint8_t*)external;
-        fCapacity = externalBytes;
-        fUsed = 0;
-        fExternal = external;
-    }
+    void reset(void* external = NULL, size_t externalBytes = 0);
 
-    // Returns the current buffer.
+    // Returns the written data as one buffer, joining the segments if there are several.
     // The pointer may be invalidated by any future write calls.
     const uint32_t* contiguousArray() const {
+        if (fSegments.count() > 1) {
+            const_cast<SkWriter32*>(this)->joinSegments();
+        }
         return (uint32_t*)fData;
     }
 
     // size MUST be multiple of 4
     uint32_t* reserve(size_t size) {
         SkASSERT(SkAlign4(size) == size);
-        size_t offset = fUsed;
-        size_t totalRequired = fUsed + size;
-        if (totalRequired > fCapacity) {
-            this->growToAtLeast(totalRequired);
+        size_t offset = fUsed - fDataOffset;
+        if (offset + size > fCapacity) {
+            this->growToAtLeast(size);
+            offset = fUsed - fDataOffset;
         }
-        fUsed = totalRequired;
+        fUsed += size;
         return (uint32_t*)(fData + offset);
     }
 
@@ -78,7 +82,7 @@ public:
     const T& readTAt(size_t offset) const {
         SkASSERT(SkAlign4(offset) == offset);
         SkASSERT(offset < fUsed);
-        return *(T*)(fData + offset);
+        return *(const T*)this->addressOf(offset, sizeof(T));
     }
 
     /**
@@ -90,7 +94,7 @@ public:
         SkASSERT(SkAlign4(offset) == offset);
         SkASSERT(offset < fUsed);
         SkASSERT(fSnapshot.get() == NULL);
-        *(T*)(fData + offset) = value;
+        *(T*)this->addressOf(offset, sizeof(T)) = value;
     }
 
     bool writeBool(bool value) {
@@ -215,17 +219,16 @@ public:
     void rewindToOffset(size_t offset) {
         SkASSERT(SkAlign4(offset) == offset);
         SkASSERT(offset <= bytesWritten());
+        if (offset < fDataOffset) {
+            this->dropSegmentsAfter(offset);
+        }
         fUsed = offset;
     }
 
     // copy into a single buffer (allocated by caller). Must be at least size()
-    void flatten(void* dst) const {
-        memcpy(dst, fData, fUsed);
-    }
+    void flatten(void* dst) const;
 
-    bool writeToStream(SkWStream* stream) const {
-        return stream->write(fData, fUsed);
-    }
+    bool writeToStream(SkWStream* stream) const;
 
     // read from the stream, and write up to length bytes. Return the actual
     // number of bytes written.
@@ -246,13 +249,44 @@ public:
      */
     SkData* snapshotAsData() const;
 private:
-    void growToAtLeast(size_t size);
+    struct Segment {
+        uint8_t* fData;
+        size_t   fOffset;    // Offset of fData[0] in the written data.
+        size_t   fCapacity;
+    };
+
+    // Returns where the record of size bytes at offset is stored.
+    uint8_t* addressOf(size_t offset, size_t size) const {
+        if (offset >= fDataOffset) {
+            SkASSERT(offset + size <= fDataOffset + fCapacity);
+            return fData + (offset - fDataOffset);
+        }
+        return this->findInSegments(offset, size);
+    }
 
-    uint8_t* fData;                    // Points to either fInternal or fExternal.
+    // Returns the number of bytes written to fSegments[index].
+    size_t segmentBytes(int index) const {
+        const size_t end = index + 1 < fSegments.count() ? fSegments[index + 1].fOffset : fUsed;
+        return end - fSegments[index].fOffset;
+    }
+
+    bool isOwned(const Segment& segment) const { return segment.fData != fExternal; }
+
+    void growToAtLeast(size_t size);
+    uint8_t* findInSegments(size_t offset, size_t size) const;
+    void dropSegmentsAfter(size_t offset);
+    void recycle(const Segment&);
+    void joinSegments();
+    void setCurrentSegment();
+
+    SkTDArray<Segment> fSegments;      // The last one is where we are writing.
+    uint8_t* fData;                    // fSegments.top().fData, or NULL if there are none.
+    size_t fDataOffset;                // fSegments.top().fOffset.
     size_t fCapacity;                  // Number of bytes we can write to fData.
     size_t fUsed;                      // Number of bytes written.
-    void* fExternal;                   // Unmanaged memory block.
-    SkAutoTMalloc<uint8_t> fInternal;  // Managed memory block.
+    void* fExternal;                   // Unmanaged memory block, in fSegments[0] if not NULL.
+    uint8_t* fSpare;                   // A freed segment, kept for the next one we need.
+    size_t fSpareCapacity;
     SkAutoTUnref<SkData> fSnapshot;    // Holds the result of last asData.
 };
 
@@ -27,6 +27,7 @@ protected:
 
     virtual bool onFilterImage(Proxy*, const SkBitmap& src, const Context&,
                                SkBitmap* result, SkIPoint* loc) const SK_OVERRIDE;
+    virtual bool drawsThroughProxy() const SK_OVERRIDE { return true; }
 
     virtual bool asColorFilter(SkColorFilter**) const SK_OVERRIDE;
 
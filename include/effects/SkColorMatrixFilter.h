@@ -25,6 +25,7 @@ public:
     virtual void filterSpan16(const uint16_t src[], int count, uint16_t[]) const SK_OVERRIDE;
     virtual uint32_t getFlags() const SK_OVERRIDE;
     virtual bool asColorMatrix(SkScalar matrix[20]) const SK_OVERRIDE;
+    virtual SkColorFilter* newComposed(const SkColorFilter* inner) const SK_OVERRIDE;
 #if SK_SUPPORT_GPU
     virtual GrEffectRef* asNewEffect(GrContext*) const SK_OVERRIDE;
 #endif
@@ -41,6 +41,7 @@ protected:
 
     virtual bool onFilterImage(Proxy*, const SkBitmap& src, const Context&,
                                SkBitmap* result, SkIPoint* loc) const SK_OVERRIDE;
+    virtual bool drawsThroughProxy() const SK_OVERRIDE { return true; }
 
 private:
     uint8_t*            fModes; // SkXfermode::Mode
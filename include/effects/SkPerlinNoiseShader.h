@@ -84,13 +84,18 @@ public:
 
     private:
         SkPMColor shade(const SkPoint& point, StitchData& stitchData) const;
-        SkScalar calculateTurbulenceValueForPoint(
-            int channel, const PaintingData& paintingData,
-            StitchData& stitchData, const SkPoint& point) const;
-        SkScalar noise2D(int channel, const PaintingData& paintingData,
-                         const StitchData& stitchData, const SkPoint& noiseVector) const;
+        SkPMColor generate(const SkPoint& patternPoint, StitchData& stitchData) const;
+        void calculateTurbulenceValuesForPoint(
+            const PaintingData& paintingData, StitchData& stitchData,
+            const SkPoint& point, SkScalar values[4]) const;
+        void noise2D(const PaintingData& paintingData, const StitchData& stitchData,
+                     const SkPoint& noiseVector, SkScalar noise[4]) const;
+        void lockTile();
 
         SkMatrix fMatrix;
+        // generate() at the integer points of the stitched tile, from SkScaledImageCache.
+        // Empty unless the shader stitches tiles and the paint is opaque.
+        SkBitmap fTile;
 
         typedef SkShader::Context INHERITED;
     };
@@ -123,6 +128,9 @@ private:
     /*const*/ SkISize                   fTileSize;
     /*const*/ bool                      fStitchTiles;
 
+    // Keys the shader's stitched tile in SkScaledImageCache.
+    uint32_t fUniqueID;
+
     PaintingData* fPaintingData;
 
     typedef SkShader INHERITED;
@@ -36,6 +36,7 @@ public:
                                const Context& ctx,
                                SkBitmap* dst,
                                SkIPoint* offset) const SK_OVERRIDE;
+    virtual bool drawsThroughProxy() const SK_OVERRIDE { return true; }
 #if SK_SUPPORT_GPU
     virtual bool canFilterImageGPU() const SK_OVERRIDE;
     virtual bool filterImageGPU(Proxy* proxy, const SkBitmap& src, const Context& ctx,
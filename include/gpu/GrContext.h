@@ -14,13 +14,16 @@
 #include "GrPathRendererChain.h"
 #include "GrRenderTarget.h"
 #include "GrTexture.h"
+#include "SkCacheCounters.h"
 #include "SkMatrix.h"
 #include "SkPathEffect.h"
+#include "SkTArray.h"
 #include "SkTypes.h"
 
 class GrAARectRenderer;
 class GrAutoScratchTexture;
 class GrCacheable;
+class GrContextShareGroup;
 class GrDrawState;
 class GrDrawTarget;
 class GrEffect;
@@ -32,6 +35,7 @@ class GrInOrderDrawBuffer;
 class GrLayerCache;
 class GrOvalRenderer;
 class GrPath;
+class GrPixelReadback;
 class GrPathRenderer;
 class GrResourceEntry;
 class GrResourceCache;
@@ -41,7 +45,9 @@ class GrTextureParams;
 class GrVertexBuffer;
 class GrVertexBufferAllocPool;
 class GrStrokeInfo;
+class SkData;
 class GrSoftwarePathRenderer;
+class SkMemoryDump;
 class SkStrokeRec;
 
 class SK_API GrContext : public SkRefCnt {
@@ -49,9 +55,11 @@ public:
     SK_DECLARE_INST_COUNT(GrContext)
 
     /**
-     * Creates a GrContext for a backend context.
+     * Creates a GrContext for a backend context. If a share group is given, the context uses the
+     * cached textures of the other contexts in the group and makes its own available to them.
+     * Their backend contexts must share objects with the new one.
      */
-    static GrContext* Create(GrBackend, GrBackendContext);
+    static GrContext* Create(GrBackend, GrBackendContext, GrContextShareGroup* shareGroup = NULL);
 
     virtual ~GrContext();
 
@@ -130,6 +138,30 @@ public:
      */
     void getResourceCacheUsage(int* resourceCount, size_t* resourceBytes) const;
 
+    /**
+     *  Reports the GPU memory held by the context's caches to 'dump': the
+     *  resource cache, and the atlases of the font and layer caches.
+     */
+    void dumpMemoryStatistics(SkMemoryDump* dump) const;
+
+    /**
+     *  Lookups in the GPU resource cache, and resources it purged. See SkCacheCounters.
+     */
+    void getResourceCacheCounters(SkCacheCounters*) const;
+
+    /**
+     *  Scratch texture requests that reused a cached texture (hits) or had to create one
+     *  (misses), and scratch textures purged from the cache. The counts only grow; sample them
+     *  once a frame to see the frame's reuse.
+     */
+    void getScratchTextureCounters(SkCacheCounters*) const;
+
+    /**
+     *  Lookups of compiled shader programs, and programs dropped to make room. The counts stay
+     *  zero for backends that don't cache programs.
+     */
+    void getProgramCacheCounters(SkCacheCounters*) const;
+
     SK_ATTR_DEPRECATED("Use getResourceCacheUsage().")
     size_t getGpuTextureCacheBytes() const {
         size_t bytes;
@@ -148,6 +180,9 @@ public:
      *  Specify the GPU resource cache limits. If the current cache exceeds either
      *  of these, it will be purged (LRU) to keep the cache within these limits.
      *
+     *  While drawing, the cache is only purged once it grows well past these
+     *  limits; it is brought back within them by performDeferredCleanup().
+     *
      *  @param maxResources The maximum number of resources that can be held in
      *                      the cache.
      *  @param maxResourceBytes The maximum number of bytes of video memory
@@ -165,6 +200,22 @@ public:
      */
     void freeGpuResources();
 
+    /**
+     * Purges unused resources until the resource cache is within the limits set by
+     * setResourceCacheLimits(). Draws only purge the cache when it is far over those limits, so
+     * this should be called regularly at a point where the work can be absorbed, e.g. once per
+     * frame after flushing.
+     */
+    void performDeferredCleanup();
+
+    /**
+     * Flushes and purges unused resources until the resource cache holds no more than
+     * maxResourceBytes, without changing its limits, e.g. on memory pressure or when the
+     * context's content goes to the background. Pass 0 to purge everything that can be.
+     * Unlike freeGpuResources() this leaves the font and layer caches alone.
+     */
+    void purgeUnlockedResources(size_t maxResourceBytes);
+
     /**
      * This method should be called whenever a GrResource is unreffed or
      * switched from exclusive to non-exclusive. This
@@ -193,6 +244,32 @@ public:
      */
     GrCacheable* findAndRefCachedResource(const GrResourceKey&);
 
+    /**
+     * Client-provided storage for data that is expensive to recreate and worth keeping across
+     * runs, such as linked shader programs. Keys and data are opaque bytes; keys include the
+     * identity of the driver that produced the data.
+     */
+    class PersistentCache : public SkRefCnt {
+    public:
+        /**
+         * Returns the data last stored for the key, or NULL. The caller must balance with a
+         * call to unref().
+         */
+        virtual SkData* load(const SkData& key) = 0;
+
+        virtual void store(const SkData& key, const SkData& data) = 0;
+
+    private:
+        typedef SkRefCnt INHERITED;
+    };
+
+    /**
+     * Sets the cache used to save and reload shader programs, or NULL (the default) to keep
+     * them in memory only. Only programs created after this call are affected.
+     */
+    void setPersistentCache(PersistentCache* cache) { fPersistentCache.reset(SkSafeRef(cache)); }
+    PersistentCache* getPersistentCache() const { return fPersistentCache.get(); }
+
     ///////////////////////////////////////////////////////////////////////////
     // Textures
 
@@ -582,6 +659,55 @@ public:
      */
     void flush(int flagsBitfield = 0);
 
+    /**
+     * Submits all the commands issued to the 3D API so far, including any the client made
+     * directly on the context's GL context, and returns a fence that is signaled once the GPU
+     * has executed them. This does not flush the context's own drawing, call flush() first.
+     *
+     * Returns 0 when fences aren't supported, in which case the work has already finished
+     * (glFinish). Otherwise the fence must be passed to deleteFence().
+     */
+    GrFence flushWithFence();
+
+    /**
+     * Blocks until the fence is signaled. Only the work before the fence is waited for, not
+     * everything on the GPU. Returns false if that can't be determined.
+     */
+    bool waitFence(GrFence);
+    void deleteFence(GrFence);
+
+    /**
+     * The GPU time spent under one trace marker name (see GR_CREATE_TRACE_MARKER) in a frame.
+     * Times are inclusive: a marker's time includes that of the markers nested within it.
+     */
+    struct GpuScopeTime {
+        const char* fName;
+        int         fCount;     // how many scopes of the frame had this marker active
+        double      fMs;
+    };
+
+    /**
+     * While GPU timing is enabled, the work issued under each trace marker is timed on the GPU.
+     * This requires timer queries and does nothing without them. Enabling timing also turns on
+     * the trace markers, as enableGpuTracing() does.
+     */
+    void enableGpuTiming() { fGpuTimingEnabled = true; }
+    void disableGpuTiming() { fGpuTimingEnabled = false; }
+    bool isGpuTimingEnabled() const { return fGpuTimingEnabled; }
+
+    /**
+     * Flushes and marks the end of a frame for GPU timing. Call once per frame, outside of any
+     * trace marker.
+     */
+    void endGpuTimingFrame();
+
+    /**
+     * Gets the times of the most recent frame the GPU has finished, which is usually a few
+     * frames behind the one being drawn so that reading the times doesn't stall. Returns false
+     * if no frame's times are available yet.
+     */
+    bool getGpuFrameTimes(SkTArray<GpuScopeTime>* times) const;
+
    /**
     * These flags can be used with the read/write pixels functions below.
     */
@@ -617,6 +743,37 @@ public:
                                 size_t rowBytes = 0,
                                 uint32_t pixelOpsFlags = 0);
 
+    /**
+     * Starts reading a rectangle of pixels from a render target without waiting for the GPU to
+     * get to it, where the backend allows. The parameters are those of readRenderTargetPixels(),
+     * less the destination, and the rectangle must lie within the target. Conversions are done
+     * on the GPU, or while the pixels are copied out, where possible. Where the backend can't
+     * read asynchronously the pixels are read before this returns.
+     *
+     * @return a token for isReadRenderTargetPixelsReady() and finishReadRenderTargetPixels(), or
+     *         0 if the read can't be made.
+     */
+    uint32_t beginReadRenderTargetPixels(GrRenderTarget* target,
+                                         int left, int top, int width, int height,
+                                         GrPixelConfig config,
+                                         uint32_t pixelOpsFlags = 0);
+
+    /**
+     * Returns true once finishReadRenderTargetPixels() won't have to wait for the GPU.
+     */
+    bool isReadRenderTargetPixelsReady(uint32_t token);
+
+    /**
+     * Copies the pixels of a read begun by beginReadRenderTargetPixels() into buffer, waiting for
+     * the GPU if it hasn't finished, and retires the token.
+     * @param rowBytes      number of bytes between consecutive rows. Zero means rows are tightly
+     *                      packed.
+     *
+     * @return true if the read succeeded, false if not. The read can fail because the context was
+     *         lost or the token is unknown.
+     */
+    bool finishReadRenderTargetPixels(uint32_t token, void* buffer, size_t rowBytes = 0);
+
     /**
      * Copy the src pixels [buffer, row bytes, pixel config] into a render target at the specified
      * rectangle.
@@ -988,13 +1145,39 @@ private:
 
     int                             fMaxTextureSizeOverride;
 
+    SkAutoTUnref<PersistentCache>   fPersistentCache;
+
+    // Reads begun by beginReadRenderTargetPixels(). Each has either a readback in flight or the
+    // pixels, already read.
+    struct PendingRead {
+        uint32_t            fToken;
+        int                 fWidth;
+        int                 fHeight;
+        GrPixelConfig       fConfig;
+        bool                fSwapRAndB;     // still to be done on the CPU
+        bool                fUnpremul;
+        GrPixelReadback*    fReadback;
+        void*               fPixels;        // sk_malloc'ed and tightly packed
+    };
+    SkCacheCounters                 fScratchCounters;
+
+    SkTDArray<PendingRead>          fPendingReads;
+    uint32_t                        fLastReadToken;
+
     bool                            fGpuTracingEnabled;
+    bool                            fGpuTimingEnabled;
 
     GrContext(); // init must be called after the constructor.
-    bool init(GrBackend, GrBackendContext);
+    bool init(GrBackend, GrBackendContext, GrContextShareGroup*);
 
     void setupDrawBuffer();
 
+    // Wraps the texture published to the share group under the key, if any, and adds it to the
+    // cache. Returns a ref on the texture.
+    GrTexture* refSharedTexture(const GrResourceKey&);
+    // Publishes a texture just added to the cache to the share group.
+    void shareTexture(const GrResourceKey&, GrTexture*);
+
     class AutoRestoreEffects;
     class AutoCheckFlush;
     /// Sets the paint and returns the target to draw into. The paint can be NULL in which case the
@@ -1004,6 +1187,17 @@ private:
     void internalDrawPath(GrDrawTarget* target, bool useAA, const SkPath& path,
                           const GrStrokeInfo& stroke);
 
+    // Draws a rectangle of src into a scratch render target, swapping R and B and unpremultiplying
+    // as asked. Clears *swapRAndB and *unpremul for the conversions the draw did. Returns the
+    // scratch, or NULL if there was nothing to gain from it; flipY says the draw would pay off
+    // for the y-flip alone.
+    GrRenderTarget* drawForReadPixels(GrRenderTarget* target,
+                                      int left, int top, int width, int height,
+                                      GrPixelConfig readConfig, bool flipY,
+                                      bool* swapRAndB, bool* unpremul, GrAutoScratchTexture*);
+    int findPendingRead(uint32_t token) const;
+    void deletePendingRead(const PendingRead&);
+
     GrTexture* createResizedTexture(const GrTextureDesc& desc,
                                     const GrCacheID& cacheID,
                                     const void* srcData,
@@ -1014,6 +1208,7 @@ private:
     // addExistingTextureToCache
     friend class GrTexture;
     friend class GrStencilAndCoverPathRenderer;
+    friend class GrStencilAndCoverTextContext;
 
     // Add an existing texture to the texture cache. This is intended solely
     // for use with textures released from an GrAutoScratchTexture.
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrContextShareGroup_DEFINED
+#define GrContextShareGroup_DEFINED
+
+#include "GrTypes.h"
+#include "SkRefCnt.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
+
+class GrResourceKey;
+
+/**
+ * Lets GrContexts whose backend contexts share objects (e.g. GL contexts in one share group) use
+ * each other's cached textures instead of uploading the same content once per context. This is
+ * meant for several contexts rasterizing tiles of the same content on different threads.
+ *
+ * When a context creates a cached texture that isn't a render target, it publishes the texture
+ * to the group under its cache key along with a fence marking the end of the upload. Another
+ * context that misses the key in its own cache wraps the published texture after waiting on the
+ * fence. The backend texture is deleted when the last context using it lets go of it.
+ *
+ * The group may be used from several threads at once. It must outlive the GrContexts using it
+ * and all of them must be created for the same backend.
+ */
+class SK_API GrContextShareGroup : public SkRefCnt {
+public:
+    SK_DECLARE_INST_COUNT(GrContextShareGroup)
+
+    GrContextShareGroup();
+    virtual ~GrContextShareGroup();
+
+    /**
+     * Returns the number of textures currently published to the group.
+     */
+    int getSharedTextureCount() const;
+
+private:
+    struct Texture;
+
+    /**
+     * Publishes a texture under 'key', taking one ref on it for the caller. 'fence' is waited on
+     * by the other contexts before they use the texture and is owned by the group from here on.
+     * Returns false, leaving the fence to the caller, if a texture is already published under
+     * the key.
+     */
+    bool addTexture(const GrResourceKey& key, const GrBackendTextureDesc& desc, GrFence fence);
+
+    /**
+     * Looks up the texture published under 'key' and takes a ref on it. The fence returned must
+     * be waited on before using the texture but must not be deleted.
+     */
+    bool refTexture(const GrResourceKey& key, GrBackendTextureDesc* desc, GrFence* fence);
+
+    bool hasTexture(const GrResourceKey& key) const;
+
+    /**
+     * Drops a ref on the texture with backend handle 'handle'. Returns true if that was the last
+     * ref, in which case the caller must delete the backend texture and 'fence'.
+     */
+    bool unrefTexture(GrBackendObject handle, GrFence* fence);
+
+    int findTexture(const GrResourceKey& key) const;
+
+    mutable SkMutex     fMutex;
+    SkTDArray<Texture*> fTextures;
+
+    friend class GrContext;
+    friend class GrGLTexture;
+
+    typedef SkRefCnt INHERITED;
+};
+
+#endif
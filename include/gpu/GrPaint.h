@@ -60,6 +60,13 @@ public:
     GrBlendCoeff getSrcBlendCoeff() const { return fSrcBlendCoeff; }
     GrBlendCoeff getDstBlendCoeff() const { return fDstBlendCoeff; }
 
+    /**
+     * Sets the blend equation. An advanced equation replaces the blend coefficients and requires
+     * GrDrawTargetCaps::advancedBlendEquationSupport(). Defaults to kAdd.
+     */
+    void setBlendEquation(GrBlendEquation equation) { fBlendEquation = equation; }
+    GrBlendEquation getBlendEquation() const { return fBlendEquation; }
+
     /**
      * The initial color of the drawn primitive. Defaults to solid white.
      */
@@ -132,6 +139,7 @@ public:
     GrPaint& operator=(const GrPaint& paint) {
         fSrcBlendCoeff = paint.fSrcBlendCoeff;
         fDstBlendCoeff = paint.fDstBlendCoeff;
+        fBlendEquation = paint.fBlendEquation;
         fAntiAlias = paint.fAntiAlias;
         fDither = paint.fDither;
 
@@ -220,6 +228,7 @@ private:
 
     GrBlendCoeff                fSrcBlendCoeff;
     GrBlendCoeff                fDstBlendCoeff;
+    GrBlendEquation             fBlendEquation;
     bool                        fAntiAlias;
     bool                        fDither;
 
@@ -229,6 +238,7 @@ private:
     void resetBlend() {
         fSrcBlendCoeff = kOne_GrBlendCoeff;
         fDstBlendCoeff = kZero_GrBlendCoeff;
+        fBlendEquation = kAdd_GrBlendEquation;
     }
 
     void resetOptions() {
@@ -69,6 +69,18 @@ public:
     SK_ATTR_DEPRECATED("Renamed to textureParamsModified.")
     void invalidateCachedState() { this->textureParamsModified(); }
 
+    typedef void (*ReleaseProc)(void* context);
+
+    /**
+     * Sets a proc to call once Skia is done with the backend texture: when this object is
+     * freed, or when its context releases or abandons it. Meant for wrapped textures, whose
+     * backend object belongs to the client. The proc is called at most once.
+     */
+    void setRelease(ReleaseProc proc, void* context) {
+        fReleaseProc = proc;
+        fReleaseContext = context;
+    }
+
     /**
      * Informational texture flags. This will be moved to the private GrTextureImpl class soon.
      */
@@ -80,6 +92,10 @@ public:
          * it is no longer reffed
          */
         kReturnToCache_FlagBit        = kFirstBit,
+        /**
+         * The backend texture is shared with other contexts through a GrContextShareGroup
+         */
+        kSharedContent_FlagBit        = kFirstBit << 1,
     };
 
     void resetFlag(GrTextureFlags flags) {
@@ -104,7 +120,9 @@ protected:
 
     GrTexture(GrGpu* gpu, bool isWrapped, const GrTextureDesc& desc)
     : INHERITED(gpu, isWrapped, desc)
-    , fRenderTarget(NULL) {
+    , fRenderTarget(NULL)
+    , fReleaseProc(NULL)
+    , fReleaseContext(NULL) {
         // only make sense if alloc size is pow2
         fShiftFixedX = 31 - SkCLZ(fDesc.fWidth);
         fShiftFixedY = 31 - SkCLZ(fDesc.fHeight);
@@ -121,11 +139,16 @@ protected:
 private:
     virtual void internal_dispose() const SK_OVERRIDE;
 
+    void invokeReleaseProc();
+
     // these two shift a fixed-point value into normalized coordinates
     // for this texture if the texture is power of two sized.
     int                 fShiftFixedX;
     int                 fShiftFixedY;
 
+    ReleaseProc         fReleaseProc;
+    void*               fReleaseContext;
+
     typedef GrSurface INHERITED;
 };
 
@@ -177,6 +177,12 @@ enum GrBackend {
  */
 typedef intptr_t GrBackendContext;
 
+/**
+ * Backend-specific handle for a point in the 3D API's command stream that the CPU can wait on.
+ *      GLsync for OpenGL. Zero is never a valid fence.
+ */
+typedef uint64_t GrFence;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -225,6 +231,42 @@ enum GrBlendCoeff {
     kPublicGrBlendCoeffCount
 };
 
+/**
+ * Equations for blending. The default equation combines src and dst using the blend coefficients.
+ * The others are the advanced equations of KHR_blend_equation_advanced. They implement the
+ * separable and non-separable SkXfermode modes of the same names in the blend hardware and ignore
+ * the blend coefficients. They are only available if
+ * GrDrawTargetCaps::advancedBlendEquationSupport() is true.
+ */
+enum GrBlendEquation {
+    kAdd_GrBlendEquation,
+
+    kMultiply_GrBlendEquation,
+    kScreen_GrBlendEquation,
+    kOverlay_GrBlendEquation,
+    kDarken_GrBlendEquation,
+    kLighten_GrBlendEquation,
+    kColorDodge_GrBlendEquation,
+    kColorBurn_GrBlendEquation,
+    kHardLight_GrBlendEquation,
+    kSoftLight_GrBlendEquation,
+    kDifference_GrBlendEquation,
+    kExclusion_GrBlendEquation,
+    kHSLHue_GrBlendEquation,
+    kHSLSaturation_GrBlendEquation,
+    kHSLColor_GrBlendEquation,
+    kHSLLuminosity_GrBlendEquation,
+
+    kFirstAdvanced_GrBlendEquation = kMultiply_GrBlendEquation,
+    kLast_GrBlendEquation = kHSLLuminosity_GrBlendEquation
+};
+
+static const int kGrBlendEquationCnt = kLast_GrBlendEquation + 1;
+
+static inline bool GrBlendEquationIsAdvanced(GrBlendEquation equation) {
+    return equation >= kFirstAdvanced_GrBlendEquation;
+}
+
 /**
  *  Formats for masks, used by the font cache.
  *  Important that these are 0-based.
@@ -282,8 +324,12 @@ enum GrPixelConfig {
      * LATC/RGTC/3Dc/BC4 Compressed Data
      */
     kLATC_GrPixelConfig,
+    /**
+     * ETC2 R11 EAC Compressed Data
+     */
+    kR11_EAC_GrPixelConfig,
 
-    kLast_GrPixelConfig = kLATC_GrPixelConfig
+    kLast_GrPixelConfig = kR11_EAC_GrPixelConfig
 };
 static const int kGrPixelConfigCnt = kLast_GrPixelConfig + 1;
 
@@ -305,6 +351,7 @@ static inline bool GrPixelConfigIsCompressed(GrPixelConfig config) {
     switch (config) {
         case kETC1_GrPixelConfig:
         case kLATC_GrPixelConfig:
+        case kR11_EAC_GrPixelConfig:
             return true;
         default:
             return false;
@@ -364,6 +411,7 @@ static inline bool GrPixelConfigIsOpaque(GrPixelConfig config) {
 static inline bool GrPixelConfigIsAlphaOnly(GrPixelConfig config) {
     switch (config) {
         case kLATC_GrPixelConfig:
+        case kR11_EAC_GrPixelConfig:
         case kAlpha_8_GrPixelConfig:
             return true;
         default:
@@ -635,7 +683,8 @@ enum GrGLBackendState {
 };
 
 /**
- * Returns the data size for the given compressed pixel config
+ * Returns the data size for the given compressed pixel config. Dimensions that aren't a multiple
+ * of the block size take whole blocks, as GL's compressed formats do.
  */ 
 static inline size_t GrCompressedFormatDataSize(GrPixelConfig config,
                                                 int width, int height) {
@@ -644,9 +693,9 @@ static inline size_t GrCompressedFormatDataSize(GrPixelConfig config,
     switch (config) {
         case kLATC_GrPixelConfig:
         case kETC1_GrPixelConfig:
-            SkASSERT((width & 3) == 0);
-            SkASSERT((height & 3) == 0);
-            return (width >> 2) * (height >> 2) * 8;
+        case kR11_EAC_GrPixelConfig:
+            // 4x4 blocks of 8 bytes
+            return ((width + 3) >> 2) * ((height + 3) >> 2) * 8;
 
         default:
             SkFAIL("Unknown compressed pixel config");
@@ -155,6 +155,7 @@ private:
     GrClipData      fClipData;
 
     GrTextContext*  fMainTextContext;
+    GrTextContext*  fPathTextContext;       // NULL without path rendering support
     GrTextContext*  fFallbackTextContext;
 
     // state for our render-target
@@ -194,13 +195,15 @@ private:
                           int maxTileSize,
                           int* tileSize,
                           SkIRect* clippedSrcRect) const;
+    // If the draw needs a texture domain it is domainRect, or srcRect if that is NULL.
     void internalDrawBitmap(const SkBitmap&,
                             const SkRect&,
                             const GrTextureParams& params,
                             const SkPaint& paint,
                             SkCanvas::DrawBitmapRectFlags flags,
                             bool bicubic,
-                            bool needsTextureDomain);
+                            bool needsTextureDomain,
+                            const SkRect* domainRect = NULL);
     void drawTiledBitmap(const SkBitmap& bitmap,
                          const SkRect& srcRect,
                          const SkIRect& clippedSrcRect,
@@ -57,10 +57,58 @@ const GrGLInterface* GrGLCreateANGLEInterface();
 
 /**
  * Creates a null GrGLInterface that doesn't draw anything. Used for measuring
- * CPU overhead.
+ * CPU overhead. It counts the calls made through it, see GrGLGetNullCallCounts().
  */
 const SK_API GrGLInterface* GrGLCreateNullInterface();
 
+/**
+ * Counts of GL calls by kind. Calls of other kinds (queries, object creation,
+ * shader compilation, ...) are not counted.
+ */
+struct SK_API GrGLCallCounts {
+    enum Kind {
+        kDraw_Kind,             // DrawArrays, DrawElements
+        kClear_Kind,
+        kUseProgram_Kind,
+        kUniform_Kind,          // Uniform*
+        kBindBuffer_Kind,
+        kBindTexture_Kind,
+        kBindFramebuffer_Kind,  // and BindRenderbuffer
+        kBindVertexArray_Kind,
+        kBufferData_Kind,       // BufferData, BufferSubData
+        kMapBuffer_Kind,        // MapBuffer(Range), FlushMappedBufferRange, UnmapBuffer
+        kTexUpload_Kind,        // (Compressed)TexImage2D, (Compressed)TexSubImage2D
+        kState_Kind,            // fixed function, texture parameter and vertex attribute state
+
+        kLast_Kind = kState_Kind
+    };
+    static const int kKindCount = kLast_Kind + 1;
+
+    int fCounts[kKindCount];
+
+    /** A short name for the kind, e.g. "draw" or "bind_texture". */
+    static const char* Name(Kind);
+
+    int total() const;
+
+    /**
+     * A simple model of what the calls would cost a driver on the CPU: a fixed
+     * cost in microseconds for each kind of call. The costs are rough relative
+     * weights (a draw or a framebuffer bind costs far more than setting a
+     * uniform), not measurements, so this is for comparing runs, not for
+     * predicting times.
+     */
+    double modeledDriverMicroseconds() const;
+};
+
+/**
+ * Gets the counts of the calls made through null interfaces on the calling
+ * thread since the last GrGLResetNullCallCounts(). Unlike timings these are
+ * deterministic, so they can be checked in to track GL call reduction.
+ */
+SK_API void GrGLGetNullCallCounts(GrGLCallCounts*);
+SK_API void GrGLResetNullCallCounts();
+
 /**
  * Creates a debugging GrGLInterface that doesn't draw anything. Used for
  * finding memory leaks and invalid memory accesses.
@@ -83,6 +131,28 @@ const GrGLInterface* GrGLInterfaceAddTestDebugMarker(const GrGLInterface*,
                                                      GrGLPushGroupMarkerProc pushGroupMarkerFn,
                                                      GrGLPopGroupMarkerProc popGroupMarkerFn);
 
+typedef void (*GrGLSubmitProc)(void* data);
+
+/** Function that returns a new interface that records the GL calls made through it and plays
+    them back through "interface" on a thread of its own. makeCurrent(makeCurrentData) is called
+    on that thread before any GL call, and must make the GL context current there; the context
+    must not be current on any other thread. The returned interface must only be used on the
+    thread that created it. Calls that return values wait for the GL thread to catch up.
+    GL_NV_path_rendering and fence syncs are not supported. Returns NULL if the thread could not
+    be started. */
+const GrGLInterface* GrGLCreateThreadedInterface(const GrGLInterface* interface,
+                                                 GrGLSubmitProc makeCurrent,
+                                                 void* makeCurrentData);
+
+/** Hands the calls recorded so far by a threaded interface to its GL thread, followed by a call
+    to proc(data) on that thread, e.g. to swap buffers. Doesn't wait for them to execute. */
+void GrGLThreadedInterfaceSubmit(const GrGLInterface* threadedInterface,
+                                 GrGLSubmitProc proc,
+                                 void* data);
+
+/** Waits for all of the calls recorded by a threaded interface to execute. */
+void GrGLThreadedInterfaceFinish(const GrGLInterface* threadedInterface);
+
 /**
  * GrContext uses the following interface to make all calls into OpenGL. When a
  * GrContext is created it is given a GrGLInterface. The interface's function
@@ -156,12 +226,16 @@ public:
         GLPtr<GrGLBindRenderbufferProc> fBindRenderbuffer;
         GLPtr<GrGLBindTextureProc> fBindTexture;
         GLPtr<GrGLBindVertexArrayProc> fBindVertexArray;
+        GLPtr<GrGLBlendBarrierProc> fBlendBarrier;
         GLPtr<GrGLBlendColorProc> fBlendColor;
+        GLPtr<GrGLBlendEquationProc> fBlendEquation;
         GLPtr<GrGLBlendFuncProc> fBlendFunc;
         GLPtr<GrGLBlitFramebufferProc> fBlitFramebuffer;
         GLPtr<GrGLBufferDataProc> fBufferData;
+        GLPtr<GrGLBufferStorageProc> fBufferStorage;
         GLPtr<GrGLBufferSubDataProc> fBufferSubData;
         GLPtr<GrGLCheckFramebufferStatusProc> fCheckFramebufferStatus;
+        GLPtr<GrGLClientWaitSyncProc> fClientWaitSync;
         GLPtr<GrGLClearProc> fClear;
         GLPtr<GrGLClearColorProc> fClearColor;
         GLPtr<GrGLClearStencilProc> fClearStencil;
@@ -179,18 +253,21 @@ public:
         GLPtr<GrGLDeleteQueriesProc> fDeleteQueries;
         GLPtr<GrGLDeleteRenderbuffersProc> fDeleteRenderbuffers;
         GLPtr<GrGLDeleteShaderProc> fDeleteShader;
+        GLPtr<GrGLDeleteSyncProc> fDeleteSync;
         GLPtr<GrGLDeleteTexturesProc> fDeleteTextures;
         GLPtr<GrGLDeleteVertexArraysProc> fDeleteVertexArrays;
         GLPtr<GrGLDepthMaskProc> fDepthMask;
         GLPtr<GrGLDisableProc> fDisable;
         GLPtr<GrGLDisableVertexAttribArrayProc> fDisableVertexAttribArray;
         GLPtr<GrGLDrawArraysProc> fDrawArrays;
+        GLPtr<GrGLDrawArraysInstancedProc> fDrawArraysInstanced;
         GLPtr<GrGLDrawBufferProc> fDrawBuffer;
         GLPtr<GrGLDrawBuffersProc> fDrawBuffers;
         GLPtr<GrGLDrawElementsProc> fDrawElements;
         GLPtr<GrGLEnableProc> fEnable;
         GLPtr<GrGLEnableVertexAttribArrayProc> fEnableVertexAttribArray;
         GLPtr<GrGLEndQueryProc> fEndQuery;
+        GLPtr<GrGLFenceSyncProc> fFenceSync;
         GLPtr<GrGLFinishProc> fFinish;
         GLPtr<GrGLFlushProc> fFlush;
         GLPtr<GrGLFlushMappedBufferRangeProc> fFlushMappedBufferRange;
@@ -214,6 +291,7 @@ public:
         GLPtr<GrGLGetQueryObjectui64vProc> fGetQueryObjectui64v;
         GLPtr<GrGLGetQueryObjectuivProc> fGetQueryObjectuiv;
         GLPtr<GrGLGetQueryivProc> fGetQueryiv;
+        GLPtr<GrGLGetProgramBinaryProc> fGetProgramBinary;
         GLPtr<GrGLGetProgramInfoLogProc> fGetProgramInfoLog;
         GLPtr<GrGLGetProgramivProc> fGetProgramiv;
         GLPtr<GrGLGetRenderbufferParameterivProc> fGetRenderbufferParameteriv;
@@ -238,8 +316,11 @@ public:
         GLPtr<GrGLMapTexSubImage2DProc> fMapTexSubImage2D;
         GLPtr<GrGLMatrixLoadfProc> fMatrixLoadf;
         GLPtr<GrGLMatrixLoadIdentityProc> fMatrixLoadIdentity;
+        GLPtr<GrGLMaxShaderCompilerThreadsProc> fMaxShaderCompilerThreads;
         GLPtr<GrGLPixelStoreiProc> fPixelStorei;
         GLPtr<GrGLPopGroupMarkerProc> fPopGroupMarker;
+        GLPtr<GrGLProgramBinaryProc> fProgramBinary;
+        GLPtr<GrGLProgramParameteriProc> fProgramParameteri;
         GLPtr<GrGLPushGroupMarkerProc> fPushGroupMarker;
         GLPtr<GrGLQueryCounterProc> fQueryCounter;
         GLPtr<GrGLReadBufferProc> fReadBuffer;
@@ -311,6 +392,7 @@ public:
         GLPtr<GrGLUnmapTexSubImage2DProc> fUnmapTexSubImage2D;
         GLPtr<GrGLUseProgramProc> fUseProgram;
         GLPtr<GrGLVertexAttrib4fvProc> fVertexAttrib4fv;
+        GLPtr<GrGLVertexAttribDivisorProc> fVertexAttribDivisor;
         GLPtr<GrGLVertexAttribPointerProc> fVertexAttribPointer;
         GLPtr<GrGLViewportProc> fViewport;
 
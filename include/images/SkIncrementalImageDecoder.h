@@ -0,0 +1,140 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkIncrementalImageDecoder_DEFINED
+#define SkIncrementalImageDecoder_DEFINED
+
+#include "SkBitmap.h"
+#include "SkImageDecoder.h"
+#include "SkImageGenerator.h"
+#include "SkRefCnt.h"
+#include "SkThread.h"
+#include "SkTRegistry.h"
+
+/**
+ *  A push-based decoder for images whose encoded bytes arrive a chunk at a
+ *  time, e.g. from the network. Unlike SkImageDecoder, which blocks until its
+ *  stream has been read to the end, append() decodes as far as the data
+ *  received so far allows and returns, so that the rows decoded so far can be
+ *  shown while the rest is still on its way.
+ *
+ *  Interlaced PNGs and progressive JPEGs fill in the whole image with each
+ *  pass or scan, so they show a coarse version of the image early on.
+ *
+ *  The pixels are always decoded to kN32_SkColorType, premultiplied unless
+ *  the image is known to be opaque.
+ *
+ *  append() may be called on one thread while another reads the pixels,
+ *  either directly or through newGenerator().
+ */
+class SkIncrementalImageDecoder : public SkRefCnt {
+public:
+    SK_DECLARE_INST_COUNT(SkIncrementalImageDecoder)
+
+    /**
+     *  Returns a decoder for the image whose encoded data starts with 'data',
+     *  or NULL if the format can't be told from these bytes or has no
+     *  incremental decoder. The bytes are only looked at, they still have to
+     *  be passed to append().
+     */
+    static SkIncrementalImageDecoder* Create(const void* data, size_t length);
+
+    enum Status {
+        kNeedMoreData_Status,   //!< everything received so far has been decoded
+        kComplete_Status,       //!< the whole image has been decoded
+        kError_Status,          //!< the data is invalid, nothing more will be decoded
+    };
+
+    virtual ~SkIncrementalImageDecoder();
+
+    virtual SkImageDecoder::Format getFormat() const = 0;
+
+    /**
+     *  Decodes the next 'length' bytes of the encoded image. Once the decoder
+     *  is complete or has failed, more data is ignored. The pixels decoded
+     *  before an error are kept.
+     */
+    Status append(const void* data, size_t length);
+
+    Status getStatus() const;
+
+    /**
+     *  Returns false until enough data has arrived to know the dimensions of
+     *  the image.
+     */
+    bool getInfo(SkImageInfo* info) const;
+
+    /**
+     *  Returns how many rows, from the top, have received pixels. Progressive
+     *  and interlaced images may still refine rows above that.
+     */
+    int getDecodedRowCount() const;
+
+    /**
+     *  Copies the pixels decoded so far, which must be requested in the info
+     *  of getInfo(). Pixels not decoded yet are transparent black. Returns
+     *  false if the info isn't known yet or doesn't match.
+     */
+    bool readPixels(const SkImageInfo& info, void* pixels, size_t rowBytes) const;
+
+    /**
+     *  Returns a generator for the pixels decoded so far, or NULL if the info
+     *  isn't known yet. The generator refs this decoder, so data may still be
+     *  appended after it was created.
+     *
+     *  Since the content of the generator changes as data arrives, install it
+     *  in a new pixel ref each time the caller wants to show new pixels, so
+     *  that the bitmap gets a new generation ID and no stale decode is reused.
+     */
+    SkImageGenerator* newGenerator();
+
+protected:
+    SkIncrementalImageDecoder();
+
+    /**
+     *  Subclasses decode as far as 'data' allows, calling setInfo() once the
+     *  header has been read and writing decoded rows into getPixels().
+     */
+    virtual Status onAppend(const void* data, size_t length) = 0;
+
+    /**
+     *  Allocates the pixels, cleared to transparent black.
+     */
+    bool setInfo(int width, int height, SkAlphaType alphaType);
+
+    /**
+     *  Returns the address of row 'y' of the pixels.
+     */
+    SkPMColor* getRow(int y) {
+        SkASSERT(NULL != fBitmap.getPixels());
+        return fBitmap.getAddr32(0, y);
+    }
+
+    /**
+     *  Records that rows [0, rowCount) have received pixels.
+     */
+    void markRowsDecoded(int rowCount) {
+        fDecodedRowCount = SkMax32(fDecodedRowCount, rowCount);
+    }
+
+private:
+    mutable SkMutex fMutex;
+    SkBitmap        fBitmap;
+    Status          fStatus;
+    int             fDecodedRowCount;
+
+    typedef SkRefCnt INHERITED;
+};
+
+/**
+ *  Each incremental decoder registers a factory that returns a new decoder
+ *  for its format, or NULL for any other format.
+ */
+typedef SkTRegistry<SkIncrementalImageDecoder*(*)(SkImageDecoder::Format)>
+        SkIncrementalImageDecoder_Reg;
+
+#endif  // SkIncrementalImageDecoder_DEFINED
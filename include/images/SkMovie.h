@@ -12,6 +12,7 @@
 
 #include "SkRefCnt.h"
 #include "SkCanvas.h"
+#include "SkThreadPool.h"
 
 class SkStreamRewindable;
 
@@ -51,6 +52,13 @@ public:
     // return the right bitmap for the current time code
     const SkBitmap& bitmap();
 
+    /** Composite the frame after the current one on the pool while the
+        current one is shown, so that it is ready when the animation gets
+        there. The pool is not owned, and must outlive the movie or be
+        replaced with NULL first. Movies that can't do this ignore it.
+    */
+    void setDecodeAheadPool(SkThreadPool*);
+
 protected:
     struct Info {
         SkMSec  fDuration;
@@ -62,6 +70,7 @@ protected:
     virtual bool onGetInfo(Info*) = 0;
     virtual bool onSetTime(SkMSec) = 0;
     virtual bool onGetBitmap(SkBitmap*) = 0;
+    virtual void onSetDecodeAheadPool(SkThreadPool*) {}
 
     // visible for subclasses
     SkMovie();
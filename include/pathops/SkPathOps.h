@@ -7,9 +7,9 @@
 #ifndef SkPathOps_DEFINED
 #define SkPathOps_DEFINED
 
-#include "SkPreConfig.h"
-
-class SkPath;
+#include "SkPath.h"
+#include "SkTArray.h"
+#include "SkTDArray.h"
 
 // FIXME: move everything below into the SkPath class
 /**
@@ -54,4 +54,55 @@ bool SK_API Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result
   */
 bool SK_API Simplify(const SkPath& path, SkPath* result);
 
+/** Applies op to count independent pairs of paths, setting each results[i]
+    to (ones[i] op twos[i]) as Op() does. The pairs are spread across
+    threadCount threads, or one thread per core if threadCount is negative;
+    with 0 or 1 they are all resolved on the calling thread. Each thread
+    reuses its scratch storage from one pair to the next.
+
+    Copies of an SkPath share its points, so applying one path to many, such
+    as intersecting each with a viewport, only needs twos filled with copies.
+
+    @param ones The first operands (for difference, the minuends)
+    @param twos The second operands (for difference, the subtrahends)
+    @param count The number of pairs
+    @param op The operation to apply to every pair
+    @param results The products of the pairs. results[i] may be ones[i] or
+                   twos[i], but no other input.
+    @param succeeded If not NULL, set to whether each pair produced a result;
+                     as with Op(), results[i] is unmodified if it did not.
+    @param threadCount The number of threads to resolve the pairs on.
+    @return True if every pair succeeded.
+  */
+bool SK_API BatchOp(const SkPath ones[], const SkPath twos[], int count, SkPathOp op,
+                    SkPath results[], bool succeeded[], int threadCount);
+
+/** Accumulates paths and the operations that combine them, and resolves them
+    all at once. The builder starts out empty, so the first path added is
+    combined with an empty path; each later path is combined with the result
+    of those before it:
+
+        result = ((((empty op1 path1) op2 path2) op3 path3) ...)
+
+    Unions of convex paths are resolved together in a single pass rather than
+    one operation at a time.
+  */
+class SK_API SkOpBuilder {
+public:
+    /** Adds path, to be combined with the paths before it using op. */
+    void add(const SkPath& path, SkPathOp op);
+
+    /** Sets result to the combination of the paths added so far, and empties
+        the builder. Returns false, leaving the builder empty, if some
+        operation failed.
+      */
+    bool resolve(SkPath* result);
+
+private:
+    void reset();
+
+    SkTArray<SkPath> fPathRefs;
+    SkTDArray<SkPathOp> fOps;
+};
+
 #endif
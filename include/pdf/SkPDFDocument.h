@@ -16,12 +16,16 @@
 #include "SkTemplates.h"
 
 class SkPDFCatalog;
+class SkPDFArray;
 class SkPDFDevice;
 class SkPDFDict;
+class SkPDFGlyphSetMap;
 class SkPDFPage;
 class SkPDFObject;
+class SkParallelForBody;
 class SkWStream;
 template <typename T> class SkTSet;
+template <typename T> class SkTThreadPool;
 
 /** \class SkPDFDocument
 
@@ -41,12 +45,25 @@ public:
     /** Create a PDF document.
      */
     explicit SK_API SkPDFDocument(Flags flags = (Flags)0);
+
+    /** Create a PDF document that is written to stream as it is built.  Each
+     *  page, with the resources that only it uses, is written out when it is
+     *  appended and then released.  Fonts (which are subset using the glyphs
+     *  of the whole document) and other shared resources are kept until
+     *  emitPDF().  Pages can only be added with appendPage().
+     *
+     *  @param stream    The writable output stream to send the PDF to.  It
+     *                   must outlive the document.
+     */
+    SK_API SkPDFDocument(SkWStream* stream, Flags flags = (Flags)0);
     SK_API ~SkPDFDocument();
 
     /** Output the PDF to the passed stream.  It is an error to call this (it
      *  will return false and not modify stream) if no pages have been added
      *  or there are pages missing (i.e. page 1 and 3 have been added, but not
-     *  page 2).
+     *  page 2).  A streaming document writes its remaining objects and
+     *  trailer to the stream it was created with, which must be the one
+     *  passed, and can only be emitted once.
      *
      *  @param stream    The writable output stream to send the PDF to.
      */
@@ -54,7 +71,7 @@ public:
 
     /** Sets the specific page to the passed PDF device. If the specified
      *  page is already set, this overrides it. Returns true if successful.
-     *  Will fail if the document has already been emitted.
+     *  Will fail if the document has already been emitted, or is streaming.
      *
      *  @param pageNumber The position to add the passed device (1 based).
      *  @param pdfDevice  The page to add to this document.
@@ -68,6 +85,17 @@ public:
      */
     SK_API bool appendPage(SkPDFDevice* pdfDevice);
 
+    /** Set the number of threads that build page contents and compress
+     *  streams and images, when the document is emitted (or, for a streaming
+     *  document, as each page is appended).  The default of 1 does all the
+     *  work on the calling thread; a negative count uses one thread per core.
+     *  Object numbering and output stay on the calling thread, so the
+     *  output does not depend on the count.
+     *
+     *  @param count     The number of threads.
+     */
+    SK_API void setThreadCount(int count);
+
     /** Get the count of unique font types used in the document.
      */
     SK_API void getCountOfFontTypes(
@@ -86,6 +114,19 @@ private:
 
     SkPDFDict* fTrailerDict;
 
+    int fThreadCount;
+    SkTThreadPool<void>* fThreadPool;               // created on first use
+
+    // Streaming mode only.
+    SkWStream* fStream;                             // NULL unless streaming
+    SkPDFArray* fKids;                              // of the flat page tree
+    SkPDFDict* fDests;
+    SkTSet<SkPDFObject*>* fStreamedResources;       // emitted, maybe shared
+    SkTSet<SkPDFObject*>* fDeferredResources;       // fonts, emitted at the end
+    SkAutoTDelete<SkPDFGlyphSetMap> fGlyphUsage;
+    SkTDArray<uint32_t> fSeenFontIDs;                // SkFontIDs
+    int fFontTypeCounts[SkAdvancedTypefaceMetrics::kNotEmbeddable_Font + 1];
+
     /** Output the PDF header to the passed stream.
      *  @param stream    The writable output stream to send the header to.
      */
@@ -100,6 +141,28 @@ private:
      *  @param objCount  The number of objects in the PDF.
      */
     void emitFooter(SkWStream* stream, int64_t objCount);
+
+    /** Call prepareToEmit() on each of the objects, on fThreadCount threads.
+     */
+    void prepareObjects(const SkTDArray<SkPDFObject*>& objects);
+
+    /** Subset the fonts in usage, on fThreadCount threads, and register the
+     *  subsets as substitutes in the catalog.
+     */
+    void performFontSubsetting(const SkPDFGlyphSetMap& usage);
+
+    /** Run body for the indices [0, count), on fThreadCount threads.
+     */
+    void parallelFor(int count, SkParallelForBody* body);
+
+    /** Finalize a page of a streaming document, and write it out with the
+     *  resources it adds that are not fonts.
+     */
+    void streamPage(SkPDFPage* page);
+
+    /** Write out the rest of a streaming document.
+     */
+    bool emitStreamedPDF();
 };
 
 #endif
@@ -50,6 +50,15 @@ public:
     // length must be a multiple of 4
     Status playback(const void* data, size_t length, uint32_t playbackFlags = 0,
                     size_t* bytesRead = NULL);
+
+    /**
+     *  Drop the fonts that pipes with SkGPipeWriter::kSharedFontData_Flag
+     *  have sent to this process. Their writers must forget them too, with
+     *  SkGPipeWriter::ForgetSharedFonts(), before they next record; a reader
+     *  that is then sent the hash of a dropped font fails.
+     */
+    static void PurgeSharedFonts();
+
 private:
     SkCanvas*                       fCanvas;
     class SkGPipeState*             fState;
@@ -120,8 +129,56 @@ public:
          *  simultaneously.
          */
         kSimultaneousReaders_Flag       = 1 << 2,
+
+        /**
+         *  Only meaningful if kCrossProcess_Flag is set and
+         *  kSharedAddressSpace_Flag is not. Tells the writer to put the pixels
+         *  of bitmaps in shared memory that the readers map, rather than in
+         *  the stream, so that all of them use one copy. The readers must run
+         *  as the same user on the same machine. Bitmaps whose pixels can't be
+         *  shared are sent in the stream as usual.
+         */
+        kSharedPixelMemory_Flag         = 1 << 3,
+
+        /**
+         *  Tells the writer that the same readers play back all of its
+         *  recording sessions, so what it sent them in one session is still
+         *  there in the next. The effects on paints (shaders, filters, ...)
+         *  are then cached by content across sessions: one that was sent
+         *  before is referred to by its id rather than sent again, and the
+         *  readers are told to drop the ones the writer evicts. The paint
+         *  state carries over too. Effects are flattened with their bitmaps
+         *  in this mode, since bitmap slots only last for one session.
+         *  Every session must use the same flags, and if one fails the
+         *  readers must be replaced.
+         */
+        kPersistentFlattenables_Flag    = 1 << 4,
+
+        /**
+         *  Only meaningful if kCrossProcess_Flag is set. Tells the writer that
+         *  its readers are in a process that keeps a cache of fonts made from
+         *  data (see SkFontDataCache), shared by all of its pipes. The data of
+         *  a font, such as a web font, is then sent once per writer and pinned
+         *  there, so that every pipe shares one typeface; the writer's later
+         *  sessions refer to it by a hash of its content. To start over, call
+         *  ForgetSharedFonts() here and SkGPipeReader::PurgeSharedFonts() in
+         *  the reader process.
+         *
+         *  A reader that meets the hash of data it doesn't have, because the
+         *  data was purged while the writer still counted on it, stops with
+         *  kError_Status rather than draw with another font.
+         */
+        kSharedFontData_Flag            = 1 << 5,
     };
 
+    /**
+     *  Make every writer with kSharedFontData_Flag forget which fonts it has
+     *  sent, so that their data is sent again from its next session on. Call
+     *  it when the reader process is replaced, or when it purges its shared
+     *  fonts.
+     */
+    static void ForgetSharedFonts();
+
     SkCanvas* startRecording(SkGPipeController*, uint32_t flags = 0,
         uint32_t width = kDefaultRecordingCanvasSize,
         uint32_t height = kDefaultRecordingCanvasSize);
@@ -161,8 +218,10 @@ private:
         kDefaultRecordingCanvasSize = 32767,
     };
 
-    SkGPipeCanvas* fCanvas;
-    SkWriter32     fWriter;
+    SkGPipeCanvas*          fCanvas;
+    class SkGPipeFlatCache* fFlatCache;
+    class SkGPipeSentFonts* fSentFonts;
+    SkWriter32              fWriter;
 };
 
 #endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGPipeSharedRing_DEFINED
+#define SkGPipeSharedRing_DEFINED
+
+#include "SkGPipe.h"
+#include "SkString.h"
+
+struct SkGPipeSharedRingHeader;
+
+/**
+ *  A controller that has the writer record straight into a ring buffer in named shared memory,
+ *  which an SkGPipeSharedRingReader in another process plays back in place. Unlike a controller
+ *  that forwards each block in its own message, the pipe data is never copied.
+ *
+ *  The writer waits in requestBlock() while the ring has no room for the block, so a slow
+ *  reader holds the writer back instead of letting the data pile up. If the reader goes away,
+ *  requestBlock() returns NULL and the writer stops.
+ *
+ *  The processes wait for each other on futexes in the segment on Linux, and poll elsewhere.
+ *  Only available where POSIX shared memory is; elsewhere Create() and Open() fail.
+ */
+class SkGPipeSharedRingController : public SkGPipeController {
+public:
+    /**
+     *  Makes a ring that holds at least 'capacity' bytes. Blocks are never split around its end,
+     *  so it should be several times the largest block the writer asks for (which is at least
+     *  16K). Returns NULL if no segment could be made.
+     */
+    static SkGPipeSharedRingController* Create(size_t capacity);
+
+    virtual ~SkGPipeSharedRingController();
+
+    /**
+     *  The name the reader passes to SkGPipeSharedRingReader::Open().
+     */
+    const char* name() const { return fName.c_str(); }
+
+    virtual void* requestBlock(size_t minRequest, size_t* actual) SK_OVERRIDE;
+    virtual void notifyWritten(size_t bytes) SK_OVERRIDE;
+
+private:
+    SkGPipeSharedRingController(SkGPipeSharedRingHeader*, size_t mappedSize, const SkString&);
+
+    SkGPipeSharedRingHeader* fHeader;
+    size_t fMappedSize;
+    SkString fName;
+};
+
+/**
+ *  Plays back the pipe written through an SkGPipeSharedRingController, reading the commands
+ *  from the shared ring and handing the space back to the writer as they are drawn.
+ */
+class SkGPipeSharedRingReader {
+public:
+    /**
+     *  Maps the ring called 'name'. Returns NULL if there is no such ring. The name is unlinked,
+     *  so only one reader may open a ring.
+     */
+    static SkGPipeSharedRingReader* Open(const char name[]);
+
+    ~SkGPipeSharedRingReader();
+
+    /**
+     *  Plays back the commands in the ring into the canvas of 'reader'. If 'wait' is true, waits
+     *  for more until the writer is done or goes away; otherwise returns once the ring is empty.
+     *  Returns kDone_Status when the writer is done (also if it went away without finishing),
+     *  kEOF_Status when more may follow, and kError_Status if the data could not be read.
+     */
+    SkGPipeReader::Status playback(SkGPipeReader* reader, bool wait = true);
+
+private:
+    SkGPipeSharedRingReader(SkGPipeSharedRingHeader*, size_t mappedSize);
+
+    SkGPipeSharedRingHeader* fHeader;
+    size_t fMappedSize;
+};
+
+#endif
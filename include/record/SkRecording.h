@@ -70,6 +70,51 @@ private:
     SkAutoTUnref<SkRecorder> fRecorder;
 };
 
+/** Like SkRecording, but recorded commands are handed off in chunks as they are recorded, so
+ *  one thread can play back the start of a frame while another is still recording the rest.
+ *
+ *  // Recording thread.
+ *  canvas = pipelined->canvas();
+ *  canvas->drawThis();  // Every chunkSize commands, a chunk is handed off.
+ *  pipelined->flush();  // Hand off what's recorded so far without waiting to fill a chunk.
+ *  canvas->drawThat();
+ *  pipelined->finish(); // Hand off the rest.  canvas() may not be used after this.
+ *
+ *  // Playback thread, at the same time.
+ *  pipelined->draw(&someCanvas);  // Returns once finish() is called and every chunk is drawn.
+ *
+ *  canvas(), flush() and finish() must be called from one thread, draw() (once) from another.
+ *  Chunks are not run through SkRecordOptimize.  Make sure draw() has returned, or was never
+ *  called, before deleting the SkPipelinedRecording.
+ */
+class SK_API SkPipelinedRecording : SkNoncopyable {
+public:
+    static const int kDefaultChunkSize = 256;
+
+    SkPipelinedRecording(int width, int height, int chunkSize = kDefaultChunkSize);
+    ~SkPipelinedRecording();
+
+    // Draws issued to this canvas will be replayed by draw().  Returns NULL after finish().
+    SkCanvas* canvas();
+
+    // Hand off any commands recorded since the last chunk.
+    void flush();
+
+    // Hand off the last commands, and let draw() return when it's drawn them.
+    // Any refs held on canvas() must be dropped before you may call finish().
+    void finish();
+
+    // Draw chunks into canvas as they arrive, returning after finish() once all are drawn.
+    // Commands are drawn as if they were one recording: SetMatrix is relative to canvas' matrix
+    // when draw() was called, and saves left open across chunks stay open until the end.
+    void draw(SkCanvas*);
+
+private:
+    class ChunkQueue;
+    SkAutoTDelete<ChunkQueue> fQueue;
+    SkAutoTUnref<SkRecorder> fRecorder;
+};
+
 }  // namespace EXPERIMENTAL
 
 #endif//SkRecording_DEFINED
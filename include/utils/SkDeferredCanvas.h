@@ -137,6 +137,43 @@ public:
      */
     void silentFlush();
 
+    /**
+     *  Identifies a point in the stream of draw commands. See insertFence().
+     */
+    typedef uint32_t Fence;
+
+    /**
+     *  Enable or disable playing back the draw commands on a thread of their
+     *  own, so that recording them and drawing them into the surface can
+     *  overlap. The commands are handed to that thread by insertFence() and
+     *  when the recording storage limit is reached; anything that needs the
+     *  surface's pixels still waits for all of them to be drawn.
+     *  Only raster surfaces are supported. Returns false, and keeps playing
+     *  back on the calling thread, for other surfaces or if the thread could
+     *  not be started.
+     *
+     *  @param threaded true/false
+     */
+    bool setThreadedPlayback(bool threaded);
+
+    /**
+     *  Hands the pending draw commands to the playback thread without waiting
+     *  for them, and returns a fence that is passed once they have been
+     *  drawn. Without threaded playback the commands are drawn before this
+     *  returns, so the fence has already been passed.
+     */
+    Fence insertFence();
+
+    /**
+     *  Returns true if the draw commands before the fence have been drawn.
+     */
+    bool isFencePassed(Fence fence) const;
+
+    /**
+     *  Waits until the draw commands before the fence have been drawn.
+     */
+    void waitForFence(Fence fence);
+
     // Overrides of the SkCanvas interface
     virtual bool isDrawingToLayer() const SK_OVERRIDE;
     virtual void clear(SkColor) SK_OVERRIDE;
@@ -145,6 +182,8 @@ public:
                             const SkPaint& paint) SK_OVERRIDE;
     virtual void drawOval(const SkRect&, const SkPaint& paint) SK_OVERRIDE;
     virtual void drawRect(const SkRect& rect, const SkPaint& paint) SK_OVERRIDE;
+    virtual void drawRects(const SkRect rects[], int count,
+                           const SkPaint& paint) SK_OVERRIDE;
     virtual void drawRRect(const SkRRect&, const SkPaint& paint) SK_OVERRIDE;
     virtual void drawPath(const SkPath& path, const SkPaint& paint)
                           SK_OVERRIDE;
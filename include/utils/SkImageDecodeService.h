@@ -0,0 +1,64 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkImageDecodeService_DEFINED
+#define SkImageDecodeService_DEFINED
+
+#include "SkTaskGroup.h"
+#include "SkThreadPool.h"
+#include "SkTypes.h"
+
+class SkPicture;
+class SkPixelRef;
+struct SkRect;
+
+/**
+ * SkImageDecodeService decodes lazily decoded pixel refs (e.g. the ones installed by
+ * SkInstallDiscardablePixelRef) on a thread pool, ahead of the raster calls that need them.
+ * Otherwise the first draw that touches such a bitmap decodes it on the raster thread, one image
+ * after the other.
+ *
+ * A prefetch is just a lock and unlock of the pixel ref on a pool thread. The decoded pixels stay
+ * in the pixel ref's cache until they are purged, and a raster thread locking the pixel ref while
+ * it is being decoded waits for that decode instead of starting another one.
+ */
+class SK_API SkImageDecodeService : SkNoncopyable {
+public:
+    /**
+     * Does not take ownership of the pool, which must outlive this service.
+     */
+    explicit SkImageDecodeService(SkThreadPool*);
+
+    /**
+     * Waits for the queued decodes.
+     */
+    ~SkImageDecodeService();
+
+    /**
+     * Queues a decode of the pixel ref, which is reffed until the decode is done. Pixel refs that
+     * are locked, and so already decoded, are skipped. NULL is a safe no-op.
+     */
+    void prefetch(SkPixelRef*);
+
+    /**
+     * Queues decodes of the pixel refs drawing the area of the picture may lock, as found by
+     * SkPictureUtils::GatherPixelRefs(). Call this for a tile before rasterizing it.
+     */
+    void prefetch(SkPicture*, const SkRect& area);
+
+    /**
+     * Blocks until all the decodes queued so far are done.
+     */
+    void wait();
+
+private:
+    class DecodeTask;
+
+    SkTaskGroup fTasks;
+};
+
+#endif
@@ -19,6 +19,8 @@
 #include "SkSize.h"
 
 class SkCanvas;
+class SkSurface;
+class GrContext;
 
 class SkLayer : public SkRefCnt {
 
@@ -98,6 +100,39 @@ public:
      */
     void localToGlobal(SkMatrix* matrix) const;
 
+    // content caching
+
+    /** When set, what onDraw() draws is rasterized once into a surface the
+        size of the layer, and that surface is drawn with the layer's
+        transform and opacity from then on, until the layer is invalidated.
+        Moving, transforming or fading the layer (or its parents) then costs
+        no rasterization. Children are drawn separately, and follow their
+        own setting.
+
+        The content is rasterized at one pixel per unit of the layer's size,
+        into a surface made by the canvas it is drawn into, so that it stays
+        on the GPU when drawn into a GPU canvas. onDraw() is passed an
+        opacity of 1, and the opacity is applied to the layer as a whole.
+        Canvases that can't make surfaces, like recording canvases, are
+        drawn into directly.
+     */
+    void setCachesContent(bool);
+    bool cachesContent() const;
+
+    /** Mark all of the cached content as needing to be drawn again.
+     */
+    void invalidate();
+
+    /** Mark the cached content within rect, in the layer's coordinates, as
+        needing to be drawn again. Only that part is redrawn, with onDraw()
+        clipped to it.
+     */
+    void invalidate(const SkRect& rect);
+
+    /** Free the cached content. It is drawn again the next time the layer is.
+     */
+    void purgeCachedContent();
+
     // paint method
 
     void draw(SkCanvas*, SkScalar opacity);
@@ -110,9 +145,13 @@ protected:
 
 private:
     enum Flags {
-        kInheritFromRootTransform_Flag = 0x01
+        kInheritFromRootTransform_Flag = 0x01,
+        kCachesContent_Flag            = 0x02
     };
 
+    // Brings the cached content up to date, returns false if it can't be cached.
+    bool updateCachedContent(SkCanvas*);
+
     SkLayer*    fParent;
     SkScalar    m_opacity;
     SkSize      m_size;
@@ -124,6 +163,11 @@ private:
 
     SkTDArray<SkLayer*> m_children;
 
+    SkSurface*  fCache;
+    // The context fCache was made for, only compared against.
+    GrContext*  fCacheContext;
+    SkRect      fInvalidRect;
+
     typedef SkRefCnt INHERITED;
 };
 
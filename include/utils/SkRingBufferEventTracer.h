@@ -0,0 +1,89 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkRingBufferEventTracer_DEFINED
+#define SkRingBufferEventTracer_DEFINED
+
+#include "SkEventTracer.h"
+#include "SkThread.h"
+
+class SkWStream;
+
+/**
+ *  An SkEventTracer for when there is no embedder to hand the trace events to. Each thread
+ *  records its events into its own fixed-size ring of binary records, without locks, so only
+ *  the most recent events of each thread are kept. writeJSON() turns them into the JSON that
+ *  chrome://tracing loads.
+ *
+ *  Tracing starts out disabled and is turned on and off with setEnabled(); while it is off the
+ *  TRACE_EVENT macros cost a load and a branch. The macros remember the category flags they
+ *  are handed, so the tracer must be installed with SkEventTracer::SetInstance() before the
+ *  first event is traced.
+ *
+ *  Only pointers are recorded, so event names and string arguments must outlive the tracer,
+ *  as literals do. The TRACE_EVENT_COPY_* names and copied string arguments are dropped.
+ */
+class SK_API SkRingBufferEventTracer : public SkEventTracer {
+public:
+    /**
+     *  Each thread keeps its last 'eventsPerThread' events, rounded up to a power of two.
+     */
+    explicit SkRingBufferEventTracer(int eventsPerThread = 1 << 14);
+    virtual ~SkRingBufferEventTracer();
+
+    /**
+     *  Turns recording on or off for every category, except the ones named with
+     *  TRACE_DISABLED_BY_DEFAULT().
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return fEnabled; }
+
+    /**
+     *  Writes the events in the rings as a JSON trace. Events that are recorded while this runs
+     *  may come out garbled, so disable tracing first for an exact capture.
+     */
+    void writeJSON(SkWStream*) const;
+
+    virtual const uint8_t* getCategoryGroupEnabled(const char* name) SK_OVERRIDE;
+    virtual const char* getCategoryGroupName(const uint8_t* categoryEnabledFlag) SK_OVERRIDE;
+
+    virtual SkEventTracer::Handle
+        addTraceEvent(char phase,
+                      const uint8_t* categoryEnabledFlag,
+                      const char* name,
+                      uint64_t id,
+                      int32_t numArgs,
+                      const char** argNames,
+                      const uint8_t* argTypes,
+                      const uint64_t* argValues,
+                      uint8_t flags) SK_OVERRIDE;
+
+    virtual void
+        updateTraceEventDuration(const uint8_t* categoryEnabledFlag,
+                                 const char* name,
+                                 SkEventTracer::Handle handle) SK_OVERRIDE;
+
+private:
+    struct Event;
+    struct Ring;
+
+    Ring* threadRing();
+
+    const int32_t   fID;
+    const int       fEventsPerThread;
+    const uint64_t  fStartTime;
+    bool            fEnabled;
+
+    // Guards the list of rings, which each thread adds to the first time it records an event.
+    mutable SkMutex fRingMutex;
+    Ring*           fRings;
+    int             fRingCount;
+
+    typedef SkEventTracer INHERITED;
+};
+
+#endif
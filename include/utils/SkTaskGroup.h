@@ -0,0 +1,71 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTaskGroup_DEFINED
+#define SkTaskGroup_DEFINED
+
+#include "SkCondVar.h"
+#include "SkRunnable.h"
+#include "SkThreadPool.h"
+#include "SkTypes.h"
+
+/**
+ * A body for SkTaskGroup::parallelFor().  run(i) is called once for each index in the range,
+ * possibly from several threads at once.
+ */
+class SkParallelForBody {
+public:
+    virtual ~SkParallelForBody() {}
+    virtual void run(int index) = 0;
+};
+
+/**
+ * SkTaskGroup tracks a set of SkRunnables added to an SkThreadPool, so that one caller can wait
+ * for just that work to finish while the pool keeps running.  Unlike SkThreadPool::wait(), the
+ * group may be reused: add() is fine again once wait() has returned.
+ */
+class SkTaskGroup : SkNoncopyable {
+public:
+    /**
+     * Does not take ownership of the pool, which must outlive this group.
+     */
+    explicit SkTaskGroup(SkThreadPool*);
+
+    /**
+     * Waits for any outstanding work.
+     */
+    ~SkTaskGroup();
+
+    /**
+     * Queues up an SkRunnable on the pool as part of this group.  Does not take ownership.
+     * NULL is a safe no-op.
+     */
+    void add(SkRunnable*);
+
+    /**
+     * Queues up calls to body->run(i) for each i in [start, end), batched into runnables of
+     * at least grainSize indices each.  Does not take ownership; body must live until wait().
+     */
+    void parallelFor(int start, int end, SkParallelForBody* body, int grainSize = 1);
+
+    /**
+     * Block until everything added to this group has finished.
+     */
+    void wait();
+
+private:
+    class Tracked;
+    class ForChunk;
+
+    void done();
+
+    SkThreadPool* fPool;    // Unowned.
+    SkCondVar     fReady;   // Guards fPending.
+    int32_t       fPending;
+};
+
+#endif
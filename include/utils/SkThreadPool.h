@@ -11,7 +11,7 @@
 #include "SkCondVar.h"
 #include "SkRunnable.h"
 #include "SkTDArray.h"
-#include "SkTInternalLList.h"
+#include "SkThread.h"
 #include "SkThreadUtils.h"
 #include "SkTypes.h"
 
@@ -32,6 +32,14 @@ static inline int num_cores() {
 #endif
 }
 
+/**
+ * SkTThreadPool runs SkTRunnables on a fixed set of threads.
+ *
+ * Each thread owns a deque of runnables with its own lock.  Threads take work from the head of
+ * their own deque, and when that runs dry they steal from the tail of the other threads' deques,
+ * so busy threads rarely contend for the same lock.  Idle threads sleep on a single condition
+ * variable, which is touched only when some thread is actually asleep.
+ */
 template <typename T>
 class SkTThreadPool {
 public:
@@ -50,19 +58,30 @@ public:
     void add(SkTRunnable<T>*);
 
     /**
-     * Same as add, but adds the runnable as the very next to run rather than enqueueing it.
+     * Same as add, but adds the runnable as the very next to run on the thread it is queued for,
+     * rather than enqueueing it behind that thread's other work.
      */
     void addNext(SkTRunnable<T>*);
 
     /**
-     * Block until all added SkRunnables have completed.  Once called, calling add() is undefined.
+     * Block until all added SkRunnables have completed.  Once called, calling add() is undefined,
+     * except from SkRunnables that are already running on this pool.
      */
     void wait();
 
+    /**
+     * Number of threads in this pool.  0 means runnables are run synchronously by add().
+     */
+    int threadCount() const { return fThreads.count(); }
+
  private:
-    struct LinkedRunnable {
-        SkTRunnable<T>* fRunnable;  // Unowned.
-        SK_DECLARE_INTERNAL_LLIST_INTERFACE(LinkedRunnable);
+    // A deque of runnables, guarded by its own lock.  Live entries are [fHead, fRunnables.count()).
+    struct Deque {
+        Deque() : fHead(0) {}
+
+        SkMutex                     fLock;
+        SkTDArray<SkTRunnable<T>*>  fRunnables;  // Unowned.
+        int                         fHead;
     };
 
     enum State {
@@ -71,26 +90,53 @@ public:
         kHalting_State,  // There's no work to do and no thread is busy.  All threads can shut down.
     };
 
-    void addSomewhere(SkTRunnable<T>* r,
-                      void (SkTInternalLList<LinkedRunnable>::*)(LinkedRunnable*));
+    void addSomewhere(SkTRunnable<T>* r, bool next);
+
+    // Pop the head of deque index, or failing that steal the tail of another thread's deque.
+    SkTRunnable<T>* take(int index);
+
+    // Block the calling thread until there is queued work or it's time to halt.
+    // Returns false when the calling thread should halt.
+    bool sleep();
 
-    SkTInternalLList<LinkedRunnable> fQueue;
-    SkCondVar                        fReady;
-    SkTDArray<SkThread*>             fThreads;
-    State                            fState;
-    int                              fBusyThreads;
+    SkTDArray<Deque*>    fDeques;     // One per thread.
+    SkTDArray<SkThread*> fThreads;
+    SkCondVar            fReady;      // Guards fState; idle threads sleep on this.
+    State                fState;
+    int32_t              fQueued;     // Runnables sitting in some Deque.  Atomic.
+    int32_t              fPending;    // Runnables added but not yet finished.  Atomic.
+    int32_t              fSleeping;   // Threads blocked in sleep().  Atomic.
+    int32_t              fNextDeque;  // Round robin counter to pick a Deque in add().  Atomic.
+
+    struct LoopArg {
+        SkTThreadPool<T>* fPool;
+        int               fIndex;
+    };
+    SkTDArray<LoopArg> fLoopArgs;
 
-    static void Loop(void*);  // Static because we pass in this.
+    static void Loop(void*);  // Static because we pass in a LoopArg.
 };
 
 template <typename T>
-SkTThreadPool<T>::SkTThreadPool(int count) : fState(kRunning_State), fBusyThreads(0) {
+SkTThreadPool<T>::SkTThreadPool(int count)
+    : fState(kRunning_State)
+    , fQueued(0)
+    , fPending(0)
+    , fSleeping(0)
+    , fNextDeque(0) {
     if (count < 0) {
         count = num_cores();
     }
+    // Set up all the deques before any thread starts stealing from them.
+    fLoopArgs.setCount(count);
+    for (int i = 0; i < count; i++) {
+        *fDeques.append() = SkNEW(Deque);
+        fLoopArgs[i].fPool = this;
+        fLoopArgs[i].fIndex = i;
+    }
     // Create count threads, all running SkTThreadPool::Loop.
     for (int i = 0; i < count; i++) {
-        SkThread* thread = SkNEW_ARGS(SkThread, (&SkTThreadPool::Loop, this));
+        SkThread* thread = SkNEW_ARGS(SkThread, (&SkTThreadPool::Loop, &fLoopArgs[i]));
         *fThreads.append() = thread;
         thread->start();
     }
@@ -101,6 +147,7 @@ SkTThreadPool<T>::~SkTThreadPool() {
     if (kRunning_State == fState) {
         this->wait();
     }
+    fDeques.deleteAll();
 }
 
 namespace SkThreadPoolPrivate {
@@ -119,8 +166,7 @@ struct ThreadLocal<void> {
 }  // namespace SkThreadPoolPrivate
 
 template <typename T>
-void SkTThreadPool<T>::addSomewhere(SkTRunnable<T>* r,
-                                    void (SkTInternalLList<LinkedRunnable>::* f)(LinkedRunnable*)) {
+void SkTThreadPool<T>::addSomewhere(SkTRunnable<T>* r, bool next) {
     if (r == NULL) {
         return;
     }
@@ -131,25 +177,103 @@ void SkTThreadPool<T>::addSomewhere(SkTRunnable<T>* r,
         return;
     }
 
-    LinkedRunnable* linkedRunnable = SkNEW(LinkedRunnable);
-    linkedRunnable->fRunnable = r;
-    fReady.lock();
     SkASSERT(fState != kHalting_State);  // Shouldn't be able to add work when we're halting.
-    (fQueue.*f)(linkedRunnable);
-    fReady.signal();
-    fReady.unlock();
+
+    // Count r as pending before anyone can see it, so wait() can't halt while it's queued.
+    sk_atomic_inc(&fPending);
+
+    const int index = (sk_atomic_inc(&fNextDeque) & SK_MaxS32) % fDeques.count();
+    Deque* deque = fDeques[index];
+    deque->fLock.acquire();
+    if (next && deque->fHead > 0) {
+        deque->fRunnables[--deque->fHead] = r;
+    } else if (next) {
+        *deque->fRunnables.insert(0) = r;
+    } else {
+        *deque->fRunnables.append() = r;
+    }
+    deque->fLock.release();
+
+    // If sleep() saw fQueued == 0, we're guaranteed to see its fSleeping increment here.
+    sk_atomic_inc(&fQueued);
+    if (sk_atomic_add(&fSleeping, 0) > 0) {
+        fReady.lock();
+        fReady.signal();
+        fReady.unlock();
+    }
 }
 
 template <typename T>
 void SkTThreadPool<T>::add(SkTRunnable<T>* r) {
-    this->addSomewhere(r, &SkTInternalLList<LinkedRunnable>::addToTail);
+    this->addSomewhere(r, false);
 }
 
 template <typename T>
 void SkTThreadPool<T>::addNext(SkTRunnable<T>* r) {
-    this->addSomewhere(r, &SkTInternalLList<LinkedRunnable>::addToHead);
+    this->addSomewhere(r, true);
+}
+
+template <typename T>
+SkTRunnable<T>* SkTThreadPool<T>::take(int index) {
+    // Our own deque first, oldest work first.
+    Deque* own = fDeques[index];
+    own->fLock.acquire();
+    if (own->fHead < own->fRunnables.count()) {
+        SkTRunnable<T>* r = own->fRunnables[own->fHead++];
+        if (own->fHead == own->fRunnables.count()) {
+            own->fRunnables.rewind();
+            own->fHead = 0;
+        }
+        own->fLock.release();
+        sk_atomic_dec(&fQueued);
+        return r;
+    }
+    own->fLock.release();
+
+    // Then steal the newest work from everyone else.
+    for (int i = 1; i < fDeques.count(); i++) {
+        Deque* victim = fDeques[(index + i) % fDeques.count()];
+        victim->fLock.acquire();
+        if (victim->fHead < victim->fRunnables.count()) {
+            SkTRunnable<T>* r;
+            victim->fRunnables.pop(&r);
+            if (victim->fHead == victim->fRunnables.count()) {
+                victim->fRunnables.rewind();
+                victim->fHead = 0;
+            }
+            victim->fLock.release();
+            sk_atomic_dec(&fQueued);
+            return r;
+        }
+        victim->fLock.release();
+    }
+    return NULL;
 }
 
+template <typename T>
+bool SkTThreadPool<T>::sleep() {
+    fReady.lock();
+    sk_atomic_inc(&fSleeping);
+    while (sk_atomic_add(&fQueued, 0) <= 0) {
+        // Does the client want to stop and are all the threads ready to stop?
+        // If so, we move into the halting state, and whack all the threads so they notice.
+        if (kWaiting_State == fState && sk_atomic_add(&fPending, 0) == 0) {
+            fState = kHalting_State;
+            fReady.broadcast();
+        }
+        // Any time we find ourselves in the halting state, it's quitting time.
+        if (kHalting_State == fState) {
+            sk_atomic_dec(&fSleeping);
+            fReady.unlock();
+            return false;
+        }
+        // wait yields the lock while waiting, but will have it again when awoken.
+        fReady.wait();
+    }
+    sk_atomic_dec(&fSleeping);
+    fReady.unlock();
+    return true;
+}
 
 template <typename T>
 void SkTThreadPool<T>::wait() {
@@ -163,54 +287,36 @@ void SkTThreadPool<T>::wait() {
         fThreads[i]->join();
         SkDELETE(fThreads[i]);
     }
-    SkASSERT(fQueue.isEmpty());
+    SkASSERT(0 == fQueued);
+    SkASSERT(0 == fPending);
 }
 
 template <typename T>
 /*static*/ void SkTThreadPool<T>::Loop(void* arg) {
-    // The SkTThreadPool passes itself as arg to each thread as they're created.
-    SkTThreadPool<T>* pool = static_cast<SkTThreadPool<T>*>(arg);
+    // The SkTThreadPool passes each thread its own LoopArg as they're created.
+    LoopArg* loopArg = static_cast<LoopArg*>(arg);
+    SkTThreadPool<T>* pool = loopArg->fPool;
+    const int index = loopArg->fIndex;
     SkThreadPoolPrivate::ThreadLocal<T> threadLocal;
 
     while (true) {
-        // We have to be holding the lock to read the queue and to call wait.
-        pool->fReady.lock();
-        while(pool->fQueue.isEmpty()) {
-            // Does the client want to stop and are all the threads ready to stop?
-            // If so, we move into the halting state, and whack all the threads so they notice.
-            if (kWaiting_State == pool->fState && pool->fBusyThreads == 0) {
-                pool->fState = kHalting_State;
-                pool->fReady.broadcast();
-            }
-            // Any time we find ourselves in the halting state, it's quitting time.
-            if (kHalting_State == pool->fState) {
-                pool->fReady.unlock();
+        SkTRunnable<T>* r = pool->take(index);
+        if (NULL == r) {
+            if (!pool->sleep()) {
                 return;
             }
-            // wait yields the lock while waiting, but will have it again when awoken.
-            pool->fReady.wait();
+            continue;
         }
-        // We've got the lock back here, no matter if we ran wait or not.
-
-        // The queue is not empty, so we have something to run.  Claim it.
-        LinkedRunnable* r = pool->fQueue.head();
 
-        pool->fQueue.remove(r);
-
-        // Having claimed our SkRunnable, we now give up the lock while we run it.
-        // Otherwise, we'd only ever do work on one thread at a time, which rather
-        // defeats the point of this code.
-        pool->fBusyThreads++;
-        pool->fReady.unlock();
-
-        // OK, now really do the work.
-        threadLocal.run(r->fRunnable);
-        SkDELETE(r);
+        // OK, now really do the work.  r may delete itself, so don't touch it after this.
+        threadLocal.run(r);
 
-        // Let everyone know we're not busy.
-        pool->fReady.lock();
-        pool->fBusyThreads--;
-        pool->fReady.unlock();
+        // If that was the last piece of work, sleeping threads may be waiting to halt.
+        if (sk_atomic_dec(&pool->fPending) == 1) {
+            pool->fReady.lock();
+            pool->fReady.broadcast();
+            pool->fReady.unlock();
+        }
     }
 
     SkASSERT(false); // Unreachable.  The only exit happens when pool->fState is kHalting_State.
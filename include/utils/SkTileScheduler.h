@@ -0,0 +1,141 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTileScheduler_DEFINED
+#define SkTileScheduler_DEFINED
+
+#include "SkPicture.h"
+#include "SkPoint.h"
+#include "SkRect.h"
+#include "SkSize.h"
+#include "SkTDArray.h"
+#include "SkTaskGroup.h"
+#include "SkThread.h"
+#include "SkThreadPool.h"
+
+class SkBitmap;
+
+/**
+ * SkTileScheduler rasterizes the tiles of a scrolling picture on a thread pool, most urgent
+ * first, rather than in grid order.
+ *
+ * Each call to setViewport() reorders the queue. Tiles in the viewport come first, then the
+ * tiles the viewport will reach soonest at its current velocity, then the ones just around it.
+ * Tiles that are no longer near the viewport are dropped from the queue. A tile that can't be
+ * drawn before it becomes visible, given how long tiles have been taking, is first drawn at a
+ * low resolution as a placeholder, which is much cheaper than checkerboarding.
+ *
+ * Tiles are drawn by playing back a clone of the picture per thread, clipped to the tile, so
+ * pictures recorded with a bounding box hierarchy only play back the ops that touch the tile.
+ */
+class SK_API SkTileScheduler : SkNoncopyable {
+public:
+    class Client {
+    public:
+        virtual ~Client() {}
+
+        /**
+         * Called with each tile drawn, on the pool thread that drew it. 'tile' is the area of
+         * the picture it covers, drawn into 'bitmap' at 'scale': 1 for a finished tile, less for
+         * a placeholder that the finished tile will replace. The client may keep the bitmap.
+         *
+         * This may be called from several threads at once. A tile invalidated while it is being
+         * drawn is not delivered, but one invalidated during this call may still arrive once.
+         */
+        virtual void tileReady(const SkIRect& tile, SkScalar scale, const SkBitmap& bitmap) = 0;
+    };
+
+    /**
+     * Does not take ownership of the pool, which must outlive the scheduler, or of the client.
+     */
+    SkTileScheduler(SkThreadPool*, Client*, const SkISize& tileSize);
+
+    /**
+     * Drops the queued tiles and waits for the ones being drawn.
+     */
+    ~SkTileScheduler();
+
+    /**
+     * Replaces the picture to draw, which is reffed, and forgets every tile drawn so far. Waits
+     * for the tiles being drawn from the old picture. NULL stops drawing.
+     */
+    void setPicture(SkPicture*);
+
+    /**
+     * Sets the visible area of the picture and how fast it is moving, in picture units per
+     * second, and reorders the queue to match.
+     */
+    void setViewport(const SkIRect& viewport, const SkVector& velocity);
+
+    /**
+     * Marks the tiles touching 'area' of the picture as changed, so that they are drawn again.
+     */
+    void invalidate(const SkIRect& area);
+
+    /**
+     * Placeholders are drawn at this scale. 0 turns them off. Defaults to 1/4.
+     */
+    void setLowResScale(SkScalar);
+
+    /**
+     * How far ahead, in seconds of scrolling, tiles are drawn before they are visible. Defaults
+     * to half a second. A ring of one tile around the viewport is always drawn.
+     */
+    void setPrefetchSeconds(SkScalar);
+
+    /**
+     * Blocks until every queued tile has been drawn.
+     */
+    void wait();
+
+private:
+    class Worker;
+
+    enum Content {
+        kNone_Content,
+        kLowRes_Content,
+        kFull_Content,
+    };
+
+    struct Tile {
+        int32_t fGeneration;  // Bumped when the tile changes, to drop stale draws.
+        Content fContent;
+    };
+
+    struct Work {
+        int     fTile;
+        int32_t fGeneration;
+        bool    fLowRes;
+    };
+
+    SkIRect tileRect(int index) const;
+    int schedule();
+    void startWorkers(int count);
+    void drainQueue();
+
+    SkTaskGroup     fTasks;
+    Client*         fClient;     // Unowned.
+    const SkISize   fTileSize;
+    const int       fMaxWorkers;
+
+    SkMutex         fMutex;      // Guards everything below.
+    SkAutoTUnref<SkPicture> fPicture;
+    SkPicture*      fClones;     // One per worker.
+    SkTDArray<bool> fCloneInUse;
+    int             fColumns;
+    int             fRows;
+    SkTDArray<Tile> fTiles;
+    SkTDArray<Work> fQueue;      // The most urgent last.
+    int             fWorkers;    // Workers started and not yet done.
+    double          fTileMs;     // How long a tile takes to draw at full resolution, on average.
+    SkIRect         fViewport;
+    SkVector        fVelocity;
+    SkScalar        fLowResScale;
+    SkScalar        fPrefetchSeconds;
+};
+
+#endif
@@ -1655,6 +1655,75 @@ bool SkAAClip::op(const SkAAClip& clipAOrig, const SkAAClip& clipBOrig,
     return builder.finish(this);
 }
 
+// Append the part of row that lies in [left, right) (relative to the row's
+// start) to dst. The runs keep their alpha, and their counts only shrink.
+static void crop_row(const uint8_t* row, int left, int right,
+                     SkTDArray<uint8_t>* dst) {
+    int x = 0;
+    while (x < right) {
+        int n = row[0];
+        int start = SkMax32(x, left);
+        int stop = SkMin32(x + n, right);
+        if (start < stop) {
+            uint8_t* run = dst->append(2);
+            run[0] = SkToU8(stop - start);
+            run[1] = row[1];
+        }
+        x += n;
+        row += 2;
+    }
+}
+
+/*
+ *  Intersecting with a rect leaves our alpha unchanged inside the rect (it is
+ *  multiplied by 0xFF), so rather than merging with the rect's runs we just
+ *  copy the part of each row that lies inside it.
+ */
+bool SkAAClip::cropToRect(const SkIRect& r) {
+    AUTO_AACLIP_VALIDATE(*this);
+    SkASSERT(!this->isEmpty());
+    SkASSERT(fBounds.contains(r) && !r.isEmpty());
+
+    const int left = r.fLeft - fBounds.fLeft;
+    const int right = r.fRight - fBounds.fLeft;
+
+    SkTDArray<YOffset> yoffsets;
+    SkTDArray<uint8_t> data;
+    data.setReserve(fRunHead->fDataSize);
+    for (Iter iter(*this); !iter.done() && iter.top() < r.fBottom; iter.next()) {
+        if (iter.bottom() <= r.fTop) {
+            continue;
+        }
+        int lastY = SkMin32(iter.bottom(), r.fBottom) - 1 - r.fTop;
+        int start = data.count();
+        crop_row(iter.data(), left, right, &data);
+
+        // Rows that only differed outside of r can now be merged.
+        if (yoffsets.count() > 0) {
+            YOffset& prev = yoffsets.top();
+            int prevLength = start - prev.fOffset;
+            if (prevLength == data.count() - start &&
+                !memcmp(&data[prev.fOffset], &data[start], prevLength)) {
+                data.setCount(start);
+                prev.fY = lastY;
+                continue;
+            }
+        }
+        YOffset* yoff = yoffsets.append();
+        yoff->fY = lastY;
+        yoff->fOffset = start;
+    }
+
+    RunHead* head = RunHead::Alloc(yoffsets.count(), data.count());
+    memcpy(head->yoffsets(), yoffsets.begin(), yoffsets.bytes());
+    memcpy(head->data(), data.begin(), data.bytes());
+
+    this->freeRuns();
+    fBounds = r;
+    fRunHead = head;
+    return this->trimBounds();
+}
+
 /*
  *  It can be expensive to build a local aaclip before applying the op, so
  *  we first see if we can restrict the bounds of new rect to our current
@@ -1679,8 +1748,7 @@ bool SkAAClip::op(const SkIRect& rOrig, SkRegion::Op op) {
                 // the intersection is wholly inside us, we're a rect
                 return this->setRect(rStorage);
             }
-            r = &rStorage;   // use the intersected bounds
-            break;
+            return this->cropToRect(rStorage);
         case SkRegion::kDifference_Op:
             break;
         case SkRegion::kUnion_Op:
@@ -80,6 +80,7 @@ private:
     RunHead* fRunHead;
 
     void freeRuns();
+    bool cropToRect(const SkIRect&);
     bool trimBounds();
     bool trimTopBottom();
     bool trimLeftRight();
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkAdaptiveBBH.h"
+#include "SkBBHFactory.h"
+
+// With this few ops any hierarchy searches quickly, and an R-tree answers any query.
+static const int kMinGridOps = 64;
+// A tile grid copies each op into every tile it touches. Past this many tiles per op, on
+// average, the copies cost more to build and to merge across tiles than an R-tree does.
+static const int kMaxTilesPerOp = 4;
+
+SkAdaptiveBBH::SkAdaptiveBBH(int width, int height, const SkISize& queryTileSize)
+    : fWidth(width)
+    , fHeight(height)
+    , fQueryTileSize(queryTileSize) {
+}
+
+void SkAdaptiveBBH::insert(void* data, const SkIRect& bounds, bool defer) {
+    if (NULL != fBBH.get()) {
+        fBBH->insert(data, bounds, defer);
+        return;
+    }
+    Entry* entry = fPending.append();
+    entry->fData = data;
+    entry->fBounds = bounds;
+}
+
+bool SkAdaptiveBBH::remove(void* data, const SkIRect& bounds) {
+    if (NULL != fBBH.get()) {
+        return fBBH->remove(data, bounds);
+    }
+    for (int i = 0; i < fPending.count(); ++i) {
+        if (fPending[i].fData == data && fPending[i].fBounds == bounds) {
+            fPending.remove(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SkAdaptiveBBH::update(void* data, const SkIRect& oldBounds, const SkIRect& newBounds) {
+    if (NULL != fBBH.get()) {
+        return fBBH->update(data, oldBounds, newBounds);
+    }
+    // Pending ops keep their place, so the hierarchy is chosen from the same order either way.
+    for (int i = 0; i < fPending.count(); ++i) {
+        if (fPending[i].fData == data && fPending[i].fBounds == oldBounds) {
+            fPending[i].fBounds = newBounds;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SkAdaptiveBBH::flushDeferredInserts() {
+    if (NULL == fBBH.get()) {
+        this->build();
+    } else {
+        fBBH->flushDeferredInserts();
+    }
+}
+
+void SkAdaptiveBBH::search(const SkIRect& query, SkTDArray<void*>* results) {
+    this->flushDeferredInserts();
+    fBBH->search(query, results);
+}
+
+void SkAdaptiveBBH::clear() {
+    fBBH.reset(NULL);
+    fPending.reset();
+}
+
+int SkAdaptiveBBH::getCount() const {
+    return NULL != fBBH.get() ? fBBH->getCount() : 0;
+}
+
+int SkAdaptiveBBH::getDepth() const {
+    return NULL != fBBH.get() ? fBBH->getDepth() : 0;
+}
+
+void SkAdaptiveBBH::rewindInserts() {
+    if (NULL != fBBH.get()) {
+        fBBH->rewindInserts();
+        return;
+    }
+    SkASSERT(fClient);
+    while (!fPending.isEmpty() && fClient->shouldRewind(fPending.top().fData)) {
+        fPending.pop();
+    }
+}
+
+SkBBoxHierarchy* SkAdaptiveBBH::choose() const {
+    const int tileW = fQueryTileSize.width(), tileH = fQueryTileSize.height();
+    if (fPending.count() >= kMinGridOps && tileW > 0 && tileH > 0 &&
+        fWidth > 0 && fHeight > 0) {
+        // Count the tiles a grid would copy the ops into. Those off the picture are dropped.
+        const SkIRect picture = SkIRect::MakeWH(fWidth, fHeight);
+        int64_t tiles = 0;
+        for (int i = 0; i < fPending.count(); ++i) {
+            SkIRect bounds = fPending[i].fBounds;
+            if (bounds.intersect(picture)) {
+                tiles += (int64_t)((bounds.fRight - 1) / tileW - bounds.fLeft / tileW + 1) *
+                                  ((bounds.fBottom - 1) / tileH - bounds.fTop / tileH + 1);
+            }
+        }
+        if (tiles <= (int64_t)kMaxTilesPerOp * fPending.count()) {
+            SkTileGridFactory::TileGridInfo info;
+            info.fTileInterval = fQueryTileSize;
+            info.fMargin.setEmpty();
+            info.fOffset.setZero();
+            return SkTileGridFactory(info)(fWidth, fHeight);
+        }
+    }
+    return SkRTreeFactory()(fWidth, fHeight);
+}
+
+void SkAdaptiveBBH::build() {
+    SkASSERT(NULL == fBBH.get());
+    fBBH.reset(this->choose());
+    fBBH->setClient(fClient);
+    for (int i = 0; i < fPending.count(); ++i) {
+        fBBH->insert(fPending[i].fData, fPending[i].fBounds, true);
+    }
+    fBBH->flushDeferredInserts();
+    fPending.reset();
+}
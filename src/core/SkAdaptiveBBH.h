@@ -0,0 +1,67 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkAdaptiveBBH_DEFINED
+#define SkAdaptiveBBH_DEFINED
+
+#include "SkBBoxHierarchy.h"
+#include "SkSize.h"
+
+/**
+ * An SkBBoxHierarchy that holds on to its inserts until it is first flushed or searched, and
+ * then builds whichever hierarchy suits their bounds best.
+ *
+ * Ops that each fit within a few query tiles go in an SkTileGrid whose tiles match the queries,
+ * so that a search is a lookup. Larger or overlapping ops, which a grid would have to copy into
+ * many tiles, go in an SkRTree. Inserts after the build go straight to the chosen hierarchy,
+ * and clear() starts over.
+ */
+class SkAdaptiveBBH : public SkBBoxHierarchy {
+public:
+    SK_DECLARE_INST_COUNT(SkAdaptiveBBH)
+
+    /**
+     * @param width, height The size of the picture
+     * @param queryTileSize The size of the tiles the picture is expected to be drawn in
+     */
+    SkAdaptiveBBH(int width, int height, const SkISize& queryTileSize);
+
+    virtual void insert(void* data, const SkIRect& bounds, bool defer = false) SK_OVERRIDE;
+    virtual bool remove(void* data, const SkIRect& bounds) SK_OVERRIDE;
+    virtual bool update(void* data, const SkIRect& oldBounds,
+                        const SkIRect& newBounds) SK_OVERRIDE;
+    virtual void flushDeferredInserts() SK_OVERRIDE;
+    virtual void search(const SkIRect& query, SkTDArray<void*>* results) SK_OVERRIDE;
+    virtual void clear() SK_OVERRIDE;
+    virtual int getCount() const SK_OVERRIDE;
+
+    /**
+     * 0 until the hierarchy is built, then that of the hierarchy: -1 for a tile grid.
+     */
+    virtual int getDepth() const SK_OVERRIDE;
+
+    virtual void rewindInserts() SK_OVERRIDE;
+
+private:
+    struct Entry {
+        void*   fData;
+        SkIRect fBounds;
+    };
+
+    SkBBoxHierarchy* choose() const;
+    void build();
+
+    const int                       fWidth;
+    const int                       fHeight;
+    const SkISize                   fQueryTileSize;
+    SkTDArray<Entry>                fPending;   // In insertion order, until fBBH is built.
+    SkAutoTUnref<SkBBoxHierarchy>   fBBH;
+
+    typedef SkBBoxHierarchy INHERITED;
+};
+
+#endif
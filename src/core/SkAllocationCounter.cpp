@@ -0,0 +1,33 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkAllocationCounter.h"
+#include "SkThread.h"
+
+bool gSkCountingAllocations = false;
+
+static int32_t gAllocations = 0;
+static int32_t gAllocatedBytes = 0;
+
+void SkCountAllocationSlow(size_t size) {
+    sk_atomic_inc(&gAllocations);
+    sk_atomic_add(&gAllocatedBytes, static_cast<int32_t>(size));
+}
+
+void sk_set_allocation_counting(bool enabled) {
+    if (enabled) {
+        gAllocations = 0;
+        gAllocatedBytes = 0;
+    }
+    gSkCountingAllocations = enabled;
+}
+
+void sk_get_allocation_counts(uint32_t* allocations, uint32_t* bytes) {
+    // Wrapping is fine: callers only look at the counts since counting was turned on.
+    *allocations = static_cast<uint32_t>(gAllocations);
+    *bytes = static_cast<uint32_t>(gAllocatedBytes);
+}
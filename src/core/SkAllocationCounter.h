@@ -0,0 +1,27 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkAllocationCounter_DEFINED
+#define SkAllocationCounter_DEFINED
+
+#include "SkTypes.h"
+
+// For the memory ports: each sk_malloc_flags, sk_realloc_throw and sk_calloc that succeeds calls
+// SkCountAllocation with its size. While counting is off (see sk_set_allocation_counting) this is
+// a single test of a global.
+
+extern bool gSkCountingAllocations;
+
+void SkCountAllocationSlow(size_t size);
+
+static inline void SkCountAllocation(size_t size) {
+    if (gSkCountingAllocations) {
+        SkCountAllocationSlow(size);
+    }
+}
+
+#endif
@@ -6,7 +6,7 @@
  */
 
 #include "SkBBHFactory.h"
-#include "SkPictureStateTree.h"
+#include "SkAdaptiveBBH.h"
 #include "SkQuadTree.h"
 #include "SkRTree.h"
 #include "SkTileGrid.h"
@@ -39,6 +39,9 @@ SkBBoxHierarchy* SkTileGridFactory::operator()(int width, int height) const {
     // "-1"s below.
     int xTileCount = (width + fInfo.fTileInterval.width() - 1) / fInfo.fTileInterval.width();
     int yTileCount = (height + fInfo.fTileInterval.height() - 1) / fInfo.fTileInterval.height();
-    return SkNEW_ARGS(SkTileGrid, (xTileCount, yTileCount, fInfo,
-                                    SkTileGridNextDatum<SkPictureStateTree::Draw>));
+    return SkNEW_ARGS(SkTileGrid, (xTileCount, yTileCount, fInfo));
+}
+
+SkBBoxHierarchy* SkAdaptiveBBHFactory::operator()(int width, int height) const {
+    return SkNEW_ARGS(SkAdaptiveBBH, (width, height, fQueryTileSize));
 }
@@ -51,6 +51,33 @@ public:
      */
     virtual void insert(void* data, const SkIRect& bounds, bool defer = false) = 0;
 
+    /**
+     * Remove a data pointer inserted earlier, so a hierarchy can be updated in place when only
+     * some of its elements change, rather than rebuilt.
+     * @param data The data pointer
+     * @param bounds The bounding box data was inserted with
+     * @return true if data was found and removed; if it was inserted more than once with these
+     *         bounds, only one is removed
+     */
+    virtual bool remove(void* data, const SkIRect& bounds) = 0;
+
+    /**
+     * Move a data pointer inserted earlier to new bounds, as when the object it refers to is
+     * edited. This is remove() followed by insert(), but hierarchies may do it in place when the
+     * new bounds are close to the old ones.
+     * @param data The data pointer
+     * @param oldBounds The bounding box data was inserted or last updated with
+     * @param newBounds The new bounding box, should not be empty
+     * @return true if data was found and moved; false, changing nothing, if it wasn't found
+     */
+    virtual bool update(void* data, const SkIRect& oldBounds, const SkIRect& newBounds) {
+        if (!this->remove(data, oldBounds)) {
+            return false;
+        }
+        this->insert(data, newBounds);
+        return true;
+    }
+
     /**
      * If any insertions have been deferred, this forces them to be inserted
      */
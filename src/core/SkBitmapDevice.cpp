@@ -9,6 +9,7 @@
 #include "SkConfig8888.h"
 #include "SkDraw.h"
 #include "SkRasterClip.h"
+#include "SkRRect.h"
 #include "SkShader.h"
 #include "SkSurface.h"
 
@@ -272,9 +273,21 @@ void SkBitmapDevice::drawRect(const SkDraw& draw, const SkRect& r, const SkPaint
     draw.drawRect(r, paint);
 }
 
+void SkBitmapDevice::drawRects(const SkDraw& draw, const SkRect rects[], int count,
+                               const SkPaint& paint) {
+    CHECK_FOR_ANNOTATION(paint);
+    draw.drawRects(rects, count, paint);
+}
+
 void SkBitmapDevice::drawOval(const SkDraw& draw, const SkRect& oval, const SkPaint& paint) {
     CHECK_FOR_ANNOTATION(paint);
 
+    SkRRect rrect;
+    rrect.setOval(oval);
+    if (draw.drawAnalyticRRect(rrect, paint)) {
+        return;
+    }
+
     SkPath path;
     path.addOval(oval);
     // call the VIRTUAL version, so any subclasses who do handle drawPath aren't
@@ -173,6 +173,8 @@ public:
         if (fExternalStorage != NULL) {
             return NULL;
         }
+        // The owners may read from another thread while insert() grows the storage.
+        SkAutoMutexAcquire lock(fStorageMutex);
         return fStorage[slot];
     }
 
@@ -286,6 +288,8 @@ private:
 
     // heap storage
     SkTDArray<SkBitmapHeapEntry*> fStorage;
+    // Held by getEntry(), and while fStorage is resized.
+    mutable SkMutex fStorageMutex;
     // Used to mark slots in fStorage as deleted without actually deleting
     // the slot so as not to mess up the numbering.
     SkTDArray<int> fUnusedSlots;
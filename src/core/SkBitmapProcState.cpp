@@ -261,7 +261,7 @@ bool SkBitmapProcState::possiblyScaleImage() {
         fScaledCacheID = SkScaledImageCache::FindAndLockMip(fOrigBitmap, &mip);
         if (!fScaledCacheID) {
             SkASSERT(NULL == mip);
-            mip = SkMipMap::Build(fOrigBitmap);
+            mip = SkMipMap::Build(fOrigBitmap, SkScaledImageCache::GetDiscardableFactory());
             if (mip) {
                 fScaledCacheID = SkScaledImageCache::AddAndLockMip(fOrigBitmap,
                                                                    mip);
@@ -362,6 +362,131 @@ bool SkBitmapProcState::lockBaseBitmap() {
     return true;
 }
 
+// Bitmaps narrower than this are repeated side by side when pre-tiled, so that
+// the repeat shaderprocs copy longer runs between wraps.
+static const int kMinPretiledWidth = 64;
+// Pre-tiled copies stay small, and narrow enough that the normalized
+// coordinates of the repeat matrix procs keep 4 bits of subpixel precision.
+static const int kMaxPretiledDimension = 4096;
+static const size_t kMaxPretiledBytes = 256 * 1024;
+
+// Writes src's width pixels, then (if mirror) them reversed, copies times over.
+static void pretile_row(const uint8_t* src, int width, size_t bpp, bool mirror,
+                        int copies, uint8_t* dst) {
+    const size_t rowBytes = width * bpp;
+    memcpy(dst, src, rowBytes);
+    size_t periodBytes = rowBytes;
+    if (mirror) {
+        uint8_t* rev = dst + rowBytes;
+        for (int x = width - 1; x >= 0; --x) {
+            memcpy(rev, src + x * bpp, bpp);
+            rev += bpp;
+        }
+        periodBytes += rowBytes;
+    }
+    for (int i = 1; i < copies; ++i) {
+        memcpy(dst + i * periodBytes, dst, periodBytes);
+    }
+}
+
+/*
+ *  Mirroring is repeating a bitmap twice the size, and small bitmaps repeat
+ *  in short runs, so for either we can sample a copy of the bitmap already
+ *  tiled out, with the faster repeat procs. The copies are cached alongside
+ *  the scaled bitmaps.
+ */
+bool SkBitmapProcState::possiblyPretileImage() {
+    if (SkShader::kClamp_TileMode == fTileModeX ||
+        SkShader::kClamp_TileMode == fTileModeY ||
+        SkPaint::kHigh_FilterLevel == fFilterLevel) {
+        return false;
+    }
+    // The affine and perspective procs step through normalized coordinates in
+    // 16.16, whose error grows with the width they are scaled back up by.
+    if (fInvMatrix.getType() & ~(SkMatrix::kTranslate_Mask | SkMatrix::kScale_Mask)) {
+        return false;
+    }
+    switch (fBitmap->colorType()) {
+        case kN32_SkColorType:
+        case kRGB_565_SkColorType:
+        case kIndex_8_SkColorType:
+        case kARGB_4444_SkColorType:
+        case kAlpha_8_SkColorType:
+            break;
+        default:
+            return false;
+    }
+
+    const int width = fBitmap->width();
+    const int height = fBitmap->height();
+    const bool mirrorX = SkShader::kMirror_TileMode == fTileModeX;
+    const bool mirrorY = SkShader::kMirror_TileMode == fTileModeY;
+    const int periodX = mirrorX ? 2 * width : width;
+    const int copiesX = periodX < kMinPretiledWidth ?
+                        (kMinPretiledWidth + periodX - 1) / periodX : 1;
+    const int tiledWidth = periodX * copiesX;
+    const int tiledHeight = mirrorY ? 2 * height : height;
+    if (tiledWidth == width && tiledHeight == height) {
+        return false;
+    }
+    if (tiledWidth > kMaxPretiledDimension || tiledHeight > kMaxPretiledDimension ||
+        (size_t)tiledWidth * tiledHeight * fBitmap->bytesPerPixel() > kMaxPretiledBytes) {
+        return false;
+    }
+
+    const SkShader::TileMode tileX = (SkShader::TileMode)fTileModeX;
+    const SkShader::TileMode tileY = (SkShader::TileMode)fTileModeY;
+    SkBitmap tiled;
+    SkScaledImageCache::ID* tiledID = SkScaledImageCache::FindAndLockTiled(fOrigBitmap,
+                                                                          tileX, tileY,
+                                                                          &tiled);
+    if (tiledID) {
+        tiled.lockPixels();
+        if (!tiled.getPixels()) {
+            tiled.unlockPixels();
+            // found a purged entry (discardablememory?), release it
+            SkScaledImageCache::Unlock(tiledID);
+            tiledID = NULL;
+            // fall through to rebuild
+        }
+    }
+
+    if (NULL == tiledID) {
+        SkImageInfo info = fBitmap->info();
+        info.fWidth = tiledWidth;
+        info.fHeight = tiledHeight;
+        tiled.setInfo(info);
+        if (!tiled.allocPixels(SkScaledImageCache::GetAllocator(), fBitmap->getColorTable())) {
+            return false;
+        }
+
+        const size_t bpp = fBitmap->bytesPerPixel();
+        for (int y = 0; y < tiledHeight; ++y) {
+            const int srcY = y < height ? y : 2 * height - 1 - y;
+            pretile_row((const uint8_t*)fBitmap->getAddr(0, srcY), width, bpp, mirrorX,
+                        copiesX, (uint8_t*)tiled.getAddr(0, y));
+        }
+        tiled.setImmutable();
+
+        tiledID = SkScaledImageCache::AddAndLockTiled(fOrigBitmap, tileX, tileY, tiled);
+        if (!tiledID) {
+            return false;
+        }
+    }
+
+    // The base bitmap is no longer needed.
+    fScaledBitmap = tiled;
+    fScaledBitmap.lockPixels();
+    if (fScaledCacheID) {
+        SkScaledImageCache::Unlock(fScaledCacheID);
+    }
+    fScaledCacheID = tiledID;
+    fBitmap = &fScaledBitmap;
+    fTileModeX = SkShader::kRepeat_TileMode;
+    fTileModeY = SkShader::kRepeat_TileMode;
+    return true;
+}
+
 SkBitmapProcState::~SkBitmapProcState() {
     if (fScaledCacheID) {
         SkScaledImageCache::Unlock(fScaledCacheID);
@@ -383,10 +508,12 @@ bool SkBitmapProcState::chooseProcs(const SkMatrix& inv, const SkPaint& paint) {
     // a nearby mipmap level.  If it does, it will adjust the working
     // matrix as well as the working bitmap.  It may also adjust the filter
     // quality to avoid re-filtering an already perfectly scaled image.
+    bool pretiled = false;
     if (!this->possiblyScaleImage()) {
         if (!this->lockBaseBitmap()) {
             return false;
         }
+        pretiled = this->possiblyPretileImage();
     }
     // The above logic should have always assigned fBitmap, but in case it
     // didn't, we check for that now...
@@ -406,7 +533,9 @@ bool SkBitmapProcState::chooseProcs(const SkMatrix& inv, const SkPaint& paint) {
                       SkShader::kClamp_TileMode == fTileModeY;
 
     if (!(clampClamp || trivialMatrix)) {
-        fInvMatrix.postIDiv(fOrigBitmap.width(), fOrigBitmap.height());
+        // a pre-tiled bitmap repeats at its own size
+        const SkBitmap& period = pretiled ? *fBitmap : fOrigBitmap;
+        fInvMatrix.postIDiv(period.width(), period.height());
     }
 
     // Now that all possible changes to the matrix have taken place, check
@@ -163,6 +163,10 @@ private:
     // means we have to abort the shader.
     bool lockBaseBitmap();
 
+    // returns true if fBitmap was replaced by a copy already repeated (and
+    // mirrored) to the tile modes, which are then both kRepeat_TileMode.
+    bool possiblyPretileImage();
+
     SkBitmapFilter* fBitmapFilter;
 
     // If supported, sets fShaderProc32 and fShaderProc16 and returns true,
@@ -220,6 +224,14 @@ void ClampX_ClampY_filter_affine(const SkBitmapProcState& s,
                                  uint32_t xy[], int count, int x, int y);
 void ClampX_ClampY_nofilter_affine(const SkBitmapProcState& s,
                                    uint32_t xy[], int count, int x, int y);
+void ClampX_ClampY_filter_persp(const SkBitmapProcState& s,
+                                uint32_t xy[], int count, int x, int y);
+void ClampX_ClampY_nofilter_persp(const SkBitmapProcState& s,
+                                  uint32_t xy[], int count, int x, int y);
+void RepeatX_RepeatY_filter_scale(const SkBitmapProcState& s, uint32_t xy[],
+                                  int count, int x, int y);
+void RepeatX_RepeatY_nofilter_scale(const SkBitmapProcState& s, uint32_t xy[],
+                                    int count, int x, int y);
 void S32_D16_filter_DX(const SkBitmapProcState& s,
                        const uint32_t* xy, int count, uint16_t* colors);
 
@@ -74,6 +74,10 @@ void ClampX_ClampY_nofilter_affine(const SkBitmapProcState& s, uint32_t xy[],
                                   int count, int x, int y) {
     return NoFilterProc_Affine<ClampTileProcs>(s, xy, count, x, y);
 }
+void ClampX_ClampY_nofilter_persp(const SkBitmapProcState& s, uint32_t xy[],
+                                  int count, int x, int y) {
+    return NoFilterProc_Persp<ClampTileProcs>(s, xy, count, x, y);
+}
 
 static SkBitmapProcState::MatrixProc ClampX_ClampY_Procs[] = {
     // only clamp lives in the right coord space to check for decal
@@ -81,7 +85,7 @@ static SkBitmapProcState::MatrixProc ClampX_ClampY_Procs[] = {
     ClampX_ClampY_filter_scale,
     ClampX_ClampY_nofilter_affine,
     ClampX_ClampY_filter_affine,
-    NoFilterProc_Persp<ClampTileProcs>,
+    ClampX_ClampY_nofilter_persp,
     ClampX_ClampY_filter_persp
 };
 
@@ -101,8 +105,14 @@ struct RepeatTileProcs {
     }
 };
 
+// Referenced in opts_check_x86.cpp
+void RepeatX_RepeatY_nofilter_scale(const SkBitmapProcState& s, uint32_t xy[],
+                                    int count, int x, int y) {
+    return NoFilterProc_Scale<RepeatTileProcs, false>(s, xy, count, x, y);
+}
+
 static SkBitmapProcState::MatrixProc RepeatX_RepeatY_Procs[] = {
-    NoFilterProc_Scale<RepeatTileProcs, false>,
+    RepeatX_RepeatY_nofilter_scale,
     RepeatX_RepeatY_filter_scale,
     NoFilterProc_Affine<RepeatTileProcs>,
     RepeatX_RepeatY_filter_affine,
@@ -4,6 +4,7 @@
 #include "SkTArray.h"
 #include "SkErrorInternals.h"
 #include "SkConvolver.h"
+#include "SkGraphics.h"
 
 // SkResizeFilter ----------------------------------------------------------------
 
@@ -308,7 +309,7 @@ bool SkBitmapScaler::Resize(SkBitmap* resultPtr,
         !source.isOpaque(), filter.xFilter(), filter.yFilter(),
         static_cast<int>(result.rowBytes()),
         static_cast<unsigned char*>(result.getPixels()),
-        convolveProcs, true);
+        convolveProcs, true, SkGraphics::GetResizeThreadCount());
 
     *resultPtr = result;
     resultPtr->lockPixels();
@@ -16,6 +16,7 @@
 #include "SkMask.h"
 #include "SkMaskFilter.h"
 #include "SkString.h"
+#include "SkTLS.h"
 #include "SkTLazy.h"
 #include "SkUtils.h"
 #include "SkXfermode.h"
@@ -193,6 +194,12 @@ void SkBlitter::blitMask(const SkMask& mask, const SkIRect& clip) {
     }
 }
 
+void SkBlitter::blitMasks(const SkMask masks[], const SkIRect clips[], int count) {
+    for (int i = 0; i < count; ++i) {
+        this->blitMask(masks[i], clips[i]);
+    }
+}
+
 /////////////////////// these guys are not virtual, just a helpers
 
 void SkBlitter::blitMaskRegion(const SkMask& mask, const SkRegion& clip) {
@@ -900,11 +907,22 @@ SkBlitter* SkBlitter::Choose(const SkBitmap& device,
         p->setColor(0);
     }
 
+#ifdef SK_USE_FLOAT_PIPELINE
+    if (kN32_SkColorType == device.colorType() && NULL == shader3D) {
+        blitter = SkCreateRasterPipelineBlitter(device, *paint, matrix, allocator);
+        if (blitter) {
+            return blitter;
+        }
+    }
+#endif
+
+    // The shaders we wrap the paint's in are owned by allocator, which destroys them after the
+    // blitter has unref'ed them, so they are not allocated on the heap for every draw.
     if (NULL == shader) {
         if (mode) {
             // xfermodes (and filters) require shaders for our current blitters
-            shader = SkNEW_ARGS(SkColorShader, (paint->getColor()));
-            paint.writable()->setShader(shader)->unref();
+            shader = allocator->createT<SkColorShader>(paint->getColor());
+            paint.writable()->setShader(shader);
             paint.writable()->setAlpha(0xFF);
         } else if (cf) {
             // if no shader && no xfermode, we just apply the colorfilter to
@@ -918,8 +936,8 @@ SkBlitter* SkBlitter::Choose(const SkBitmap& device,
 
     if (cf) {
         SkASSERT(shader);
-        shader = SkNEW_ARGS(SkFilterShader, (shader, cf));
-        paint.writable()->setShader(shader)->unref();
+        shader = allocator->createT<SkFilterShader>(shader, cf);
+        paint.writable()->setShader(shader);
         // blitters should ignore the presence/absence of a filter, since
         // if there is one, the shader will take care of it.
     }
@@ -1039,3 +1057,114 @@ bool SkShaderBlitter::resetShaderContext(const SkShader::ContextRec& rec) {
     }
     return true;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Precedes each block, padded so the block keeps sk_malloc's alignment.
+union ScratchHeader {
+    size_t  fCapacity;
+    double  fAlign0;
+    void*   fAlign1;
+};
+
+class ScratchCache {
+public:
+    ScratchCache() { sk_bzero(fBlocks, sizeof(fBlocks)); }
+    ~ScratchCache() { this->purge(); }
+
+    void* acquire(size_t size) {
+        // Reuse the smallest cached block that is big enough.
+        int best = -1;
+        for (int i = 0; i < kSlotCount; ++i) {
+            if (NULL != fBlocks[i] && fBlocks[i]->fCapacity >= size &&
+                    (best < 0 || fBlocks[i]->fCapacity < fBlocks[best]->fCapacity)) {
+                best = i;
+            }
+        }
+        ScratchHeader* header;
+        if (best >= 0) {
+            header = fBlocks[best];
+            fBlocks[best] = NULL;
+        } else {
+            // Round up, so slightly wider devices can share blocks.
+            const size_t capacity = (size + kGranularity - 1) & ~(kGranularity - 1);
+            header = (ScratchHeader*)sk_malloc_throw(sizeof(ScratchHeader) + capacity);
+            header->fCapacity = capacity;
+        }
+        return header + 1;
+    }
+
+    void release(void* block) {
+        ScratchHeader* header = static_cast<ScratchHeader*>(block) - 1;
+        if (header->fCapacity > kMaxCachedBytes) {
+            sk_free(header);
+            return;
+        }
+        // Keep it in an empty slot, or in place of the smallest cached block.
+        int smallest = 0;
+        for (int i = 0; i < kSlotCount; ++i) {
+            if (NULL == fBlocks[i]) {
+                fBlocks[i] = header;
+                return;
+            }
+            if (fBlocks[i]->fCapacity < fBlocks[smallest]->fCapacity) {
+                smallest = i;
+            }
+        }
+        if (fBlocks[smallest]->fCapacity < header->fCapacity) {
+            SkTSwap(fBlocks[smallest], header);
+        }
+        sk_free(header);
+    }
+
+    void purge() {
+        for (int i = 0; i < kSlotCount; ++i) {
+            sk_free(fBlocks[i]);
+            fBlocks[i] = NULL;
+        }
+    }
+
+private:
+    // Enough for a few blitters alive at once, e.g. a layer being drawn into
+    // while its parent's draw is still in progress.
+    static const int kSlotCount = 4;
+    static const size_t kGranularity = 1024;
+    // Rows of a 16K pixel wide device.
+    static const size_t kMaxCachedBytes = 64 * 1024;
+
+    ScratchHeader* fBlocks[kSlotCount];
+};
+
+}  // namespace
+
+static void* create_scratch_cache() {
+    return SkNEW(ScratchCache);
+}
+
+static void delete_scratch_cache(void* cache) {
+    SkDELETE(static_cast<ScratchCache*>(cache));
+}
+
+void* SkBlitterScratch::Acquire(size_t size) {
+    ScratchCache* cache = static_cast<ScratchCache*>(
+            SkTLS::Get(create_scratch_cache, delete_scratch_cache));
+    return cache->acquire(size);
+}
+
+void SkBlitterScratch::Release(void* block) {
+    if (NULL == block) {
+        return;
+    }
+    ScratchCache* cache = static_cast<ScratchCache*>(
+            SkTLS::Get(create_scratch_cache, delete_scratch_cache));
+    cache->release(block);
+}
+
+void SkBlitterScratch::PurgeThread() {
+    ScratchCache* cache = static_cast<ScratchCache*>(SkTLS::Find(create_scratch_cache));
+    if (NULL != cache) {
+        cache->purge();
+    }
+}
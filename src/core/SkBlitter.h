@@ -47,6 +47,10 @@ public:
     /// Blit a pattern of pixels defined by a rectangle-clipped mask;
     /// typically used for text.
     virtual void blitMask(const SkMask&, const SkIRect& clip);
+    /// Blit count masks, each through its own clip, in order. Used for runs
+    /// of glyphs, so that blitters can choose their mask procs once per run
+    /// rather than once per glyph. The default calls blitMask() for each.
+    virtual void blitMasks(const SkMask masks[], const SkIRect clips[], int count);
 
     /** If the blitter just sets a single value for each pixel, return the
         bitmap it draws into, and assign value. If not, return NULL and ignore
@@ -175,4 +179,25 @@ private:
     SkRgnClipBlitter    fRgnBlitter;
 };
 
+/** Per-thread cache of scanline buffers for blitters. A frame of many small
+    draws creates and destroys a blitter for each draw; taking their row
+    buffers from here lets a thread reuse a few blocks rather than going to
+    the heap every time.
+*/
+class SkBlitterScratch {
+public:
+    /** Return a block of at least size bytes, aligned as by sk_malloc_throw.
+        Never returns NULL. The block must be given back with Release().
+    */
+    static void* Acquire(size_t size);
+
+    /** Return a block from Acquire() to the calling thread's cache, or free
+        it if the cache is full. NULL is ignored.
+    */
+    static void Release(void* block);
+
+    /** Free the blocks cached for the calling thread. */
+    static void PurgeThread();
+};
+
 #endif
@@ -181,6 +181,36 @@ void SkARGB32_Opaque_Blitter::blitMask(const SkMask& mask,
     }
 }
 
+// Glyph runs are nearly always one mask format, so look the color proc up once
+// per change of format; anything the factory can't handle goes to blitMask().
+void SkARGB32_Blitter::blitMasks(const SkMask masks[], const SkIRect clips[], int count) {
+    if (fSrcA == 0) {
+        return;
+    }
+
+    const SkColorType ct = fDevice.colorType();
+    const size_t rowBytes = fDevice.rowBytes();
+    SkMask::Format format = SkMask::kBW_Format;
+    SkBlitMask::ColorProc proc = NULL;
+    for (int i = 0; i < count; ++i) {
+        const SkMask& mask = masks[i];
+        const SkIRect& clip = clips[i];
+        SkASSERT(mask.fBounds.contains(clip));
+
+        if (0 == i || mask.fFormat != format) {
+            format = mask.fFormat;
+            proc = SkBlitMask::ColorFactory(ct, format, fColor);
+        }
+        if (proc) {
+            proc(fDevice.getAddr32(clip.fLeft, clip.fTop), rowBytes,
+                 mask.getAddr(clip.fLeft, clip.fTop), mask.fRowBytes,
+                 fColor, clip.width(), clip.height());
+        } else {
+            this->blitMask(mask, clip);
+        }
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkARGB32_Blitter::blitV(int x, int y, int height, SkAlpha alpha) {
@@ -278,7 +308,7 @@ SkARGB32_Shader_Blitter::SkARGB32_Shader_Blitter(const SkBitmap& device,
         const SkPaint& paint, SkShader::Context* shaderContext)
     : INHERITED(device, paint, shaderContext)
 {
-    fBuffer = (SkPMColor*)sk_malloc_throw(device.width() * (sizeof(SkPMColor)));
+    fBuffer = (SkPMColor*)SkBlitterScratch::Acquire(device.width() * sizeof(SkPMColor));
 
     fXfermode = paint.getXfermode();
     SkSafeRef(fXfermode);
@@ -312,7 +342,7 @@ SkARGB32_Shader_Blitter::SkARGB32_Shader_Blitter(const SkBitmap& device,
 
 SkARGB32_Shader_Blitter::~SkARGB32_Shader_Blitter() {
     SkSafeUnref(fXfermode);
-    sk_free(fBuffer);
+    SkBlitterScratch::Release(fBuffer);
 }
 
 void SkARGB32_Shader_Blitter::blitH(int x, int y, int width) {
@@ -811,7 +811,7 @@ SkRGB16_Shader_Blitter::SkRGB16_Shader_Blitter(const SkBitmap& device,
 : INHERITED(device, paint, shaderContext) {
     SkASSERT(paint.getXfermode() == NULL);
 
-    fBuffer = (SkPMColor*)sk_malloc_throw(device.width() * sizeof(SkPMColor));
+    fBuffer = (SkPMColor*)SkBlitterScratch::Acquire(device.width() * sizeof(SkPMColor));
 
     // compute SkBlitRow::Procs
     unsigned flags = 0;
@@ -833,7 +833,7 @@ SkRGB16_Shader_Blitter::SkRGB16_Shader_Blitter(const SkBitmap& device,
 }
 
 SkRGB16_Shader_Blitter::~SkRGB16_Shader_Blitter() {
-    sk_free(fBuffer);
+    SkBlitterScratch::Release(fBuffer);
 }
 
 void SkRGB16_Shader_Blitter::blitH(int x, int y, int width) {
@@ -941,13 +941,14 @@ SkRGB16_Shader_Xfermode_Blitter::SkRGB16_Shader_Xfermode_Blitter(
     fXfermode->ref();
 
     int width = device.width();
-    fBuffer = (SkPMColor*)sk_malloc_throw((width + (SkAlign4(width) >> 2)) * sizeof(SkPMColor));
+    fBuffer = (SkPMColor*)SkBlitterScratch::Acquire((width + (SkAlign4(width) >> 2)) *
+                                                    sizeof(SkPMColor));
     fAAExpand = (uint8_t*)(fBuffer + width);
 }
 
 SkRGB16_Shader_Xfermode_Blitter::~SkRGB16_Shader_Xfermode_Blitter() {
     fXfermode->unref();
-    sk_free(fBuffer);
+    SkBlitterScratch::Release(fBuffer);
 }
 
 void SkRGB16_Shader_Xfermode_Blitter::blitH(int x, int y, int width) {
@@ -8,6 +8,7 @@
 
 #include "SkCanvas.h"
 #include "SkBitmapDevice.h"
+#include "SkColorFilter.h"
 #include "SkDeviceImageFilterProxy.h"
 #include "SkDraw.h"
 #include "SkDrawFilter.h"
@@ -17,12 +18,16 @@
 #include "SkPicture.h"
 #include "SkRasterClip.h"
 #include "SkRRect.h"
+#include "SkShader.h"
 #include "SkSmallAllocator.h"
 #include "SkSurface_Base.h"
 #include "SkTemplates.h"
+#include "SkTextBlob.h"
 #include "SkTextFormatParams.h"
 #include "SkTLazy.h"
+#include "SkTraceEvent.h"
 #include "SkUtils.h"
+#include "SkXfermode.h"
 
 #if SK_SUPPORT_GPU
 #include "GrRenderTarget.h"
@@ -98,9 +103,7 @@ private:
 typedef SkTLazy<SkPaint> SkLazyPaint;
 
 void SkCanvas::predrawNotify() {
-    if (fSurfaceBase) {
-        fSurfaceBase->aboutToDraw(SkSurface::kRetain_ContentChangeMode);
-    }
+    this->predrawNotify(NULL);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -186,6 +189,11 @@ private:
     stored in the ...Storage field, and the pointer points to that. If the
     value is not copied for this level, we ignore ...Storage, and just point
     at the corresponding value in the previous level in the stack.
+
+    A level that saves the matrix or clip only copies it the first time it is
+    changed (see writableMatrix() and writableRasterClip()), so a save() and
+    restore() around drawing that leaves them alone copies nothing. Changes
+    must go through those calls; fMatrix and fRasterClip are for reading.
 */
 class SkCanvas::MCRec {
 public:
@@ -203,21 +211,11 @@ public:
     */
     DeviceCM*   fTopLayer;
 
-    MCRec(const MCRec* prev, int flags) : fFlags(flags) {
+    MCRec(MCRec* prev, int flags) : fFlags(flags) {
         if (NULL != prev) {
-            if (flags & SkCanvas::kMatrix_SaveFlag) {
-                fMatrixStorage = *prev->fMatrix;
-                fMatrix = &fMatrixStorage;
-            } else {
-                fMatrix = prev->fMatrix;
-            }
-
-            if (flags & SkCanvas::kClip_SaveFlag) {
-                fRasterClipStorage = *prev->fRasterClip;
-                fRasterClip = &fRasterClipStorage;
-            } else {
-                fRasterClip = prev->fRasterClip;
-            }
+            fMatrix = prev->fMatrix;
+            fInverse = prev->fInverse;
+            fRasterClip = prev->fRasterClip;
 
             fFilter = prev->fFilter;
             SkSafeRef(fFilter);
@@ -227,6 +225,7 @@ public:
             fMatrixStorage.reset();
 
             fMatrix     = &fMatrixStorage;
+            fInverse    = &fInverseStorage;
             fRasterClip = &fRasterClipStorage;
             fFilter     = NULL;
             fTopLayer   = NULL;
@@ -242,8 +241,52 @@ public:
         dec_rec();
     }
 
+    SkMatrix* writableMatrix() {
+        if ((fFlags & SkCanvas::kMatrix_SaveFlag) && fMatrix != &fMatrixStorage) {
+            fMatrixStorage = *fMatrix;
+            fMatrix = &fMatrixStorage;
+            fInverse = &fInverseStorage;
+        }
+        fInverse->fState = Inverse::kUnknown_State;
+        return fMatrix;
+    }
+
+    SkRasterClip* writableRasterClip() {
+        if ((fFlags & SkCanvas::kClip_SaveFlag) && fRasterClip != &fRasterClipStorage) {
+            fRasterClipStorage = *fRasterClip;
+            fRasterClip = &fRasterClipStorage;
+        }
+        return fRasterClip;
+    }
+
+    /**
+     *  Returns the inverse of the matrix, or NULL if it has none. It is kept until the matrix
+     *  changes, and shared with the levels above that have not changed it.
+     */
+    const SkMatrix* inverse() const {
+        if (Inverse::kUnknown_State == fInverse->fState) {
+            fInverse->fState = fMatrix->invert(&fInverse->fMatrix) ? Inverse::kValid_State
+                                                                   : Inverse::kNone_State;
+        }
+        return Inverse::kValid_State == fInverse->fState ? &fInverse->fMatrix : NULL;
+    }
+
 private:
+    struct Inverse {
+        enum State {
+            kUnknown_State,
+            kValid_State,
+            kNone_State,
+        };
+        Inverse() : fState(kUnknown_State) {}
+
+        SkMatrix fMatrix;
+        State    fState;
+    };
+
+    Inverse*        fInverse;       // goes with fMatrix
     SkMatrix        fMatrixStorage;
+    Inverse         fInverseStorage;
     SkRasterClip    fRasterClipStorage;
 };
 
@@ -418,6 +461,95 @@ bool AutoDrawLooper::doNext(SkDrawFilter::Type drawType) {
     return true;
 }
 
+void SkCanvas::predrawNotify(const SkRect* bounds, const SkPaint* fillPaint,
+                             const SkRect* fillRect) {
+    if (NULL == fSurfaceBase) {
+        return;
+    }
+
+    // Nothing is drawn outside of the clip, so that bounds the pixels the draw may change.
+    SkIRect dirty = fMCRec->fRasterClip->getBounds();
+    if (NULL != bounds && !fMCRec->fMatrix->hasPerspective()) {
+        SkRect devBounds;
+        fMCRec->fMatrix->mapRect(&devBounds, *bounds);
+        if (devBounds.isFinite()) {
+            SkIRect idevBounds;
+            devBounds.roundOut(&idevBounds);
+            idevBounds.outset(1, 1);    // for antialiasing
+            if (!dirty.intersect(idevBounds)) {
+                dirty.setEmpty();
+            }
+        }
+    }
+
+    SkSurface::ContentChangeMode mode = SkSurface::kRetain_ContentChangeMode;
+    if (NULL != fillPaint && fSurfaceBase->outstandingImageSnapshot() &&
+        this->wouldOverwriteEntireSurface(fillRect, *fillPaint)) {
+        mode = SkSurface::kDiscard_ContentChangeMode;
+    }
+    fSurfaceBase->aboutToDraw(mode, &dirty);
+}
+
+void SkCanvas::prereadNotify() {
+    if (fSurfaceBase) {
+        fSurfaceBase->aboutToRead();
+    }
+}
+
+static bool paint_overwrites(const SkPaint& paint) {
+    if (paint.getStyle() == SkPaint::kStroke_Style || NULL != paint.getPathEffect() ||
+        NULL != paint.getMaskFilter() || NULL != paint.getLooper() ||
+        NULL != paint.getImageFilter()) {
+        return false;
+    }
+
+    SkXfermode::Mode mode;
+    if (!SkXfermode::AsMode(paint.getXfermode(), &mode)) {
+        return false;
+    }
+    if (SkXfermode::kSrc_Mode == mode || SkXfermode::kClear_Mode == mode) {
+        return true;
+    }
+    if (SkXfermode::kSrcOver_Mode != mode || 0xFF != paint.getAlpha()) {
+        return false;
+    }
+    if (NULL != paint.getShader() && !paint.getShader()->isOpaque()) {
+        return false;
+    }
+    const SkColorFilter* filter = paint.getColorFilter();
+    return NULL == filter || SkToBool(filter->getFlags() & SkColorFilter::kAlphaUnchanged_Flag);
+}
+
+// True if filling the rect (or everything, if it is NULL) with the paint replaces every pixel of
+// the surface, so that its previous contents need not be kept.
+bool SkCanvas::wouldOverwriteEntireSurface(const SkRect* rect, const SkPaint& paint) const {
+    // Layers only reach the surface when they are restored, and a draw filter may change the
+    // paint after we've looked at it.
+    if (fSaveLayerCount > 0 || NULL != fMCRec->fFilter) {
+        return false;
+    }
+
+    const SkISize size = this->getBaseLayerSize();
+    const SkIRect surfaceBounds = SkIRect::MakeWH(size.width(), size.height());
+    const SkRasterClip& clip = *fMCRec->fRasterClip;
+    if (!clip.isRect() || !clip.getBounds().contains(surfaceBounds)) {
+        return false;
+    }
+
+    if (NULL != rect) {
+        const SkMatrix& matrix = *fMCRec->fMatrix;
+        if (!matrix.rectStaysRect()) {
+            return false;
+        }
+        SkRect devRect;
+        matrix.mapRect(&devRect, *rect);
+        if (!devRect.contains(SkRect::Make(surfaceBounds))) {
+            return false;
+        }
+    }
+    return paint_overwrites(paint);
+}
+
 #include "SkColorPriv.h"
 
 ////////// macros to place around the internal draw calls //////////////////
@@ -429,11 +561,18 @@ bool AutoDrawLooper::doNext(SkDrawFilter::Type drawType) {
         SkDrawIter          iter(this);
 
 #define LOOPER_BEGIN(paint, type, bounds)                           \
-    this->predrawNotify();                                          \
+    this->predrawNotify(bounds);                                    \
     AutoDrawLooper  looper(this, paint, false, bounds);             \
     while (looper.next(type)) {                                     \
         SkDrawIter          iter(this);
 
+// For draws that fill the rect, or everything if it is NULL, with the paint.
+#define LOOPER_BEGIN_CHECK_COMPLETE_OVERWRITE(paint, type, bounds, rect)    \
+    this->predrawNotify(bounds, &paint, rect);                              \
+    AutoDrawLooper  looper(this, paint, false, bounds);                     \
+    while (looper.next(type)) {                                             \
+        SkDrawIter          iter(this);
+
 #define LOOPER_END    }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -605,9 +744,9 @@ SkBaseDevice* SkCanvas::setRootDevice(SkBaseDevice* device) {
         bounds.setEmpty();
     }
     // now jam our 1st clip to be bounds, and intersect the rest with that
-    rec->fRasterClip->setRect(bounds);
+    rec->writableRasterClip()->setRect(bounds);
     while ((rec = (MCRec*)iter.next()) != NULL) {
-        (void)rec->fRasterClip->op(bounds, SkRegion::kIntersect_Op);
+        (void)rec->writableRasterClip()->op(bounds, SkRegion::kIntersect_Op);
     }
 
     return device;
@@ -672,6 +811,7 @@ bool SkCanvas::readPixels(const SkImageInfo& origInfo, void* dstP, size_t rowByt
         return false;
     }
 
+    this->prereadNotify();
     SkBaseDevice* device = this->getDevice();
     if (!device) {
         return false;
@@ -733,6 +873,10 @@ bool SkCanvas::writePixels(const SkImageInfo& origInfo, const void* pixels, size
         return false;
     }
 
+    // The pixels are written straight into the base layer, whatever the clip.
+    if (NULL != fSurfaceBase) {
+        fSurfaceBase->aboutToDraw(SkSurface::kRetain_ContentChangeMode, &target);
+    }
     SkBaseDevice* device = this->getDevice();
     if (!device) {
         return false;
@@ -839,7 +983,7 @@ bool SkCanvas::clipRectBounds(const SkRect* bounds, SaveFlags flags,
         // early exit if the layer's bounds are clipped out
         if (!ir.intersect(clipBounds)) {
             if (bounds_affects_clip(flags)) {
-                fMCRec->fRasterClip->setEmpty();
+                fMCRec->writableRasterClip()->setEmpty();
             }
             return false;
         }
@@ -850,7 +994,7 @@ bool SkCanvas::clipRectBounds(const SkRect* bounds, SaveFlags flags,
     if (bounds_affects_clip(flags)) {
         fClipStack.clipDevRect(ir, op);
         // early exit if the clip is now empty
-        if (!fMCRec->fRasterClip->op(ir, op)) {
+        if (!fMCRec->writableRasterClip()->op(ir, op)) {
             return false;
         }
     }
@@ -1043,6 +1187,7 @@ SkImageInfo SkCanvas::imageInfo() const {
 }
 
 const void* SkCanvas::peekPixels(SkImageInfo* info, size_t* rowBytes) {
+    this->prereadNotify();
     return this->onPeekPixels(info, rowBytes);
 }
 
@@ -1052,6 +1197,7 @@ const void* SkCanvas::onPeekPixels(SkImageInfo* info, size_t* rowBytes) {
 }
 
 void* SkCanvas::accessTopLayerPixels(SkImageInfo* info, size_t* rowBytes, SkIPoint* origin) {
+    this->prereadNotify();
     void* pixels = this->onAccessTopLayerPixels(info, rowBytes);
     if (pixels && origin) {
         *origin = this->getTopDevice(false)->getOrigin();
@@ -1205,7 +1351,15 @@ void SkCanvas::internalDrawDevice(SkBaseDevice* srcDev, int x, int y,
             const SkBitmap& src = srcDev->accessBitmap(false);
             SkMatrix matrix = *iter.fMatrix;
             matrix.postTranslate(SkIntToScalar(-pos.x()), SkIntToScalar(-pos.y()));
-            SkIRect clipBounds = SkIRect::MakeWH(srcDev->width(), srcDev->height());
+            // Only filter what is needed for the part of the result inside the clip.
+            SkIRect visible = iter.fRC->getBounds();
+            visible.offset(-pos.x(), -pos.y());
+            SkIRect clipBounds;
+            if (!filter->computeClipBounds(visible,
+                                           SkIRect::MakeWH(srcDev->width(), srcDev->height()),
+                                           matrix, &clipBounds)) {
+                continue;
+            }
             SkImageFilter::Cache* cache = SkImageFilter::GetExternalCache();
             SkAutoUnref aur(NULL);
             if (!cache) {
@@ -1251,7 +1405,14 @@ void SkCanvas::drawSprite(const SkBitmap& bitmap, int x, int y,
             SkIPoint offset = SkIPoint::Make(0, 0);
             SkMatrix matrix = *iter.fMatrix;
             matrix.postTranslate(SkIntToScalar(-pos.x()), SkIntToScalar(-pos.y()));
-            SkIRect clipBounds = SkIRect::MakeWH(bitmap.width(), bitmap.height());
+            // Only filter what is needed for the part of the result inside the clip.
+            SkIRect visible = iter.fRC->getBounds();
+            visible.offset(-pos.x(), -pos.y());
+            SkIRect clipBounds;
+            if (!filter->computeClipBounds(visible, SkIRect::MakeWH(bitmap.width(), bitmap.height()),
+                                           matrix, &clipBounds)) {
+                continue;
+            }
             SkImageFilter::Cache* cache = SkImageFilter::GetExternalCache();
             SkAutoUnref aur(NULL);
             if (!cache) {
@@ -1304,7 +1465,7 @@ void SkCanvas::concat(const SkMatrix& matrix) {
 
     fDeviceCMDirty = true;
     fCachedLocalClipBoundsDirty = true;
-    fMCRec->fMatrix->preConcat(matrix);
+    fMCRec->writableMatrix()->preConcat(matrix);
 
     this->didConcat(matrix);
 }
@@ -1312,7 +1473,7 @@ void SkCanvas::concat(const SkMatrix& matrix) {
 void SkCanvas::setMatrix(const SkMatrix& matrix) {
     fDeviceCMDirty = true;
     fCachedLocalClipBoundsDirty = true;
-    *fMCRec->fMatrix = matrix;
+    *fMCRec->writableMatrix() = matrix;
     this->didSetMatrix(matrix);
 }
 
@@ -1342,7 +1503,7 @@ void SkCanvas::onClipRect(const SkRect& rect, SkRegion::Op op, ClipEdgeStyle edg
             fCachedLocalClipBoundsDirty = true;
 
             fClipStack.clipEmpty();
-            return fMCRec->fRasterClip->setEmpty();
+            return fMCRec->writableRasterClip()->setEmpty();
         }
     }
 #endif
@@ -1364,7 +1525,7 @@ void SkCanvas::onClipRect(const SkRect& rect, SkRegion::Op op, ClipEdgeStyle edg
 
         fMCRec->fMatrix->mapRect(&r, rect);
         fClipStack.clipDevRect(r, op, kSoft_ClipEdgeStyle == edgeStyle);
-        fMCRec->fRasterClip->op(r, op, kSoft_ClipEdgeStyle == edgeStyle);
+        fMCRec->writableRasterClip()->op(r, op, kSoft_ClipEdgeStyle == edgeStyle);
     } else {
         // since we're rotated or some such thing, we convert the rect to a path
         // and clip against that, since it can handle any matrix. However, to
@@ -1442,7 +1603,7 @@ void SkCanvas::onClipRRect(const SkRRect& rrect, SkRegion::Op op, ClipEdgeStyle
         SkPath devPath;
         devPath.addRRect(transformedRRect);
 
-        clip_path_helper(this, fMCRec->fRasterClip, devPath, op, kSoft_ClipEdgeStyle == edgeStyle);
+        clip_path_helper(this, fMCRec->writableRasterClip(), devPath, op, kSoft_ClipEdgeStyle == edgeStyle);
         return;
     }
 
@@ -1474,7 +1635,7 @@ void SkCanvas::onClipPath(const SkPath& path, SkRegion::Op op, ClipEdgeStyle edg
             fCachedLocalClipBoundsDirty = true;
 
             fClipStack.clipEmpty();
-            return fMCRec->fRasterClip->setEmpty();
+            return fMCRec->writableRasterClip()->setEmpty();
         }
     }
 #endif
@@ -1531,7 +1692,7 @@ void SkCanvas::onClipPath(const SkPath& path, SkRegion::Op op, ClipEdgeStyle edg
         op = SkRegion::kReplace_Op;
     }
 
-    clip_path_helper(this, fMCRec->fRasterClip, devPath, op, edgeStyle);
+    clip_path_helper(this, fMCRec->writableRasterClip(), devPath, op, edgeStyle);
 }
 
 void SkCanvas::updateClipConservativelyUsingBounds(const SkRect& bounds, SkRegion::Op op,
@@ -1624,7 +1785,7 @@ void SkCanvas::onClipRegion(const SkRegion& rgn, SkRegion::Op op) {
     // we have to ignore it, and use the region directly?
     fClipStack.clipDevRect(rgn.getBounds(), op);
 
-    fMCRec->fRasterClip->op(rgn, op);
+    fMCRec->writableRasterClip()->op(rgn, op);
 }
 
 #ifdef SK_DEBUG
@@ -1721,9 +1882,9 @@ bool SkCanvas::getClipBounds(SkRect* bounds) const {
         return false;
     }
 
-    SkMatrix inverse;
     // if we can't invert the CTM, we can't return local clip bounds
-    if (!fMCRec->fMatrix->invert(&inverse)) {
+    const SkMatrix* inverse = fMCRec->inverse();
+    if (NULL == inverse) {
         if (bounds) {
             bounds->setEmpty();
         }
@@ -1737,7 +1898,7 @@ bool SkCanvas::getClipBounds(SkRect* bounds) const {
 
         r.iset(ibounds.fLeft - inset, ibounds.fTop - inset,
                ibounds.fRight + inset, ibounds.fBottom + inset);
-        inverse.mapRect(bounds, r);
+        inverse->mapRect(bounds, r);
     }
     return true;
 }
@@ -1775,18 +1936,18 @@ SkCanvas::ClipType SkCanvas::getClipType() const {
 
 #ifdef SK_SUPPORT_LEGACY_GETTOTALCLIP
 const SkRegion& SkCanvas::getTotalClip() const {
-    return fMCRec->fRasterClip->forceGetBW();
+    return fMCRec->writableRasterClip()->forceGetBW();
 }
 #endif
 
 const SkRegion& SkCanvas::internal_private_getTotalClip() const {
-    return fMCRec->fRasterClip->forceGetBW();
+    return fMCRec->writableRasterClip()->forceGetBW();
 }
 
 void SkCanvas::internal_private_getTotalClipAsPath(SkPath* path) const {
     path->reset();
 
-    const SkRegion& rgn = fMCRec->fRasterClip->forceGetBW();
+    const SkRegion& rgn = fMCRec->writableRasterClip()->forceGetBW();
     if (rgn.isEmpty()) {
         return;
     }
@@ -1844,7 +2005,12 @@ void SkCanvas::drawDRRect(const SkRRect& outer, const SkRRect& inner,
 
 void SkCanvas::clear(SkColor color) {
     SkDrawIter  iter(this);
-    this->predrawNotify();
+    if (NULL != fSurfaceBase) {
+        // clear() ignores the clip, and outside of a layer replaces all of the surface.
+        fSurfaceBase->aboutToDraw(0 == fSaveLayerCount && fSurfaceBase->outstandingImageSnapshot()
+                                          ? SkSurface::kDiscard_ContentChangeMode
+                                          : SkSurface::kRetain_ContentChangeMode);
+    }
     while (iter.next()) {
         iter.fDevice->clear(color);
     }
@@ -1861,7 +2027,7 @@ void SkCanvas::drawPaint(const SkPaint& paint) {
 }
 
 void SkCanvas::internalDrawPaint(const SkPaint& paint) {
-    LOOPER_BEGIN(paint, SkDrawFilter::kPaint_Type, NULL)
+    LOOPER_BEGIN_CHECK_COMPLETE_OVERWRITE(paint, SkDrawFilter::kPaint_Type, NULL, NULL)
 
     while (iter.next()) {
         iter.fDevice->drawPaint(iter, looper.paint());
@@ -1912,7 +2078,7 @@ void SkCanvas::drawRect(const SkRect& r, const SkPaint& paint) {
         }
     }
 
-    LOOPER_BEGIN(paint, SkDrawFilter::kRect_Type, bounds)
+    LOOPER_BEGIN_CHECK_COMPLETE_OVERWRITE(paint, SkDrawFilter::kRect_Type, bounds, &r)
 
     while (iter.next()) {
         iter.fDevice->drawRect(iter, r, looper.paint());
@@ -1921,6 +2087,49 @@ void SkCanvas::drawRect(const SkRect& r, const SkPaint& paint) {
     LOOPER_END
 }
 
+void SkCanvas::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    if (count <= 0) {
+        return;
+    }
+
+    // A looper or image filter would apply to the batch as a whole rather than to each rect in
+    // turn, and a draw filter expects to see every rect.
+    if (NULL != paint.getLooper() || NULL != paint.getImageFilter() ||
+        NULL != this->getDrawFilter()) {
+        for (int i = 0; i < count; ++i) {
+            this->drawRect(rects[i], paint);
+        }
+        return;
+    }
+
+    SkAutoSTMalloc<32, SkRect> visible(count);
+    int visibleCount = 0;
+    SkRect unionBounds = SkRect::MakeEmpty();
+    const bool fastBounds = paint.canComputeFastBounds();
+    for (int i = 0; i < count; ++i) {
+        if (fastBounds) {
+            SkRect storage;
+            const SkRect& bounds = paint.computeFastBounds(rects[i], &storage);
+            if (this->quickReject(bounds)) {
+                continue;
+            }
+            unionBounds.join(bounds);
+        }
+        visible[visibleCount++] = rects[i];
+    }
+    if (0 == visibleCount) {
+        return;
+    }
+
+    LOOPER_BEGIN(paint, SkDrawFilter::kRect_Type, fastBounds ? &unionBounds : NULL)
+
+    while (iter.next()) {
+        iter.fDevice->drawRects(iter, visible.get(), visibleCount, looper.paint());
+    }
+
+    LOOPER_END
+}
+
 void SkCanvas::drawOval(const SkRect& oval, const SkPaint& paint) {
     SkRect storage;
     const SkRect* bounds = NULL;
@@ -2315,6 +2524,48 @@ void SkCanvas::onDrawTextOnPath(const void* text, size_t byteLength, const SkPat
     LOOPER_END
 }
 
+void SkCanvas::onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                              const SkPaint& paint) {
+    if (paint.canComputeFastBounds()) {
+        SkRect storage;
+        SkRect bounds = blob->bounds().makeOffset(x, y);
+        if (this->quickReject(paint.computeFastBounds(bounds, &storage))) {
+            return;
+        }
+    }
+
+    // Draw each run as the positioned text it is, with its own font.
+    SkPaint runPaint(paint);
+    SkAutoSTMalloc<64, SkScalar> offsetPos;
+    for (SkTextBlob::RunIterator it(blob); !it.done(); it.next()) {
+        const int count = it.glyphCount();
+        const size_t byteLength = count * sizeof(uint16_t);
+        it.applyFontToPaint(&runPaint);
+
+        switch (it.positioning()) {
+        case SkTextBlob::kDefault_Positioning:
+            this->onDrawText(it.glyphs(), byteLength, x + it.offset().x(), y + it.offset().y(),
+                             runPaint);
+            break;
+        case SkTextBlob::kHorizontal_Positioning: {
+            SkScalar* xpos = offsetPos.reset(count);
+            for (int i = 0; i < count; ++i) {
+                xpos[i] = it.pos()[i] + x;
+            }
+            this->onDrawPosTextH(it.glyphs(), byteLength, xpos, y + it.offset().y(), runPaint);
+        } break;
+        case SkTextBlob::kFull_Positioning: {
+            SkScalar* pos = offsetPos.reset(2 * count);
+            for (int i = 0; i < count; ++i) {
+                pos[2 * i] = it.pos()[2 * i] + x;
+                pos[2 * i + 1] = it.pos()[2 * i + 1] + y;
+            }
+            this->onDrawPosText(it.glyphs(), byteLength, (const SkPoint*)pos, runPaint);
+        } break;
+        }
+    }
+}
+
 // These will become non-virtual, so they always call the (virtual) onDraw... method
 void SkCanvas::drawText(const void* text, size_t byteLength, SkScalar x, SkScalar y,
                         const SkPaint& paint) {
@@ -2332,6 +2583,12 @@ void SkCanvas::drawTextOnPath(const void* text, size_t byteLength, const SkPath&
                               const SkMatrix* matrix, const SkPaint& paint) {
     this->onDrawTextOnPath(text, byteLength, path, matrix, paint);
 }
+void SkCanvas::drawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                            const SkPaint& paint) {
+    if (NULL != blob) {
+        this->onDrawTextBlob(blob, x, y, paint);
+    }
+}
 
 void SkCanvas::drawVertices(VertexMode vmode, int vertexCount,
                             const SkPoint verts[], const SkPoint texs[],
@@ -2480,6 +2737,7 @@ void SkCanvas::EXPERIMENTAL_purge(const SkPicture* picture) {
 }
 
 void SkCanvas::drawPicture(const SkPicture* picture) {
+    TRACE_EVENT0("skia", "SkCanvas::drawPicture");
     if (NULL != picture) {
         this->onDrawPicture(picture);
     }
@@ -0,0 +1,14 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkChecksum.h"
+#include "SkChecksum_opts.h"
+
+uint32_t SkChecksum::HashKey(const uint32_t* data, size_t size) {
+    static const SkChecksumHashProc gProc = SkChecksumGetPlatformHashProc();
+    return gProc ? gProc(data, size) : Compute(data, size);
+}
@@ -6,6 +6,8 @@
  */
 
 #include "SkChunkAlloc.h"
+#include "SkMath.h"
+#include "SkTLS.h"
 
 // Don't malloc any chunks smaller than this
 #define MIN_CHUNKALLOC_BLOCK_SIZE   1024
@@ -17,6 +19,105 @@ static size_t increase_next_size(size_t size) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ *  Blocks whose size, not counting their header, is a power of two from 1K to 64K are not freed,
+ *  but kept on a free list of the thread that releases them, for any SkChunkAlloc on that thread
+ *  to reuse.  (Counting the header would push every power-of-two request into the next class.)
+ *  Allocators that are filled and reset over and over, as during playback, then stop going to
+ *  the heap (and contending for its lock when several threads draw at once).
+ */
+static const int kMinCachedBlockLog2 = 10;
+static const int kCachedBlockClasses = 7;
+static const size_t kMaxCachedBlockBytes = (size_t)1 << (kMinCachedBlockLog2 +
+                                                         kCachedBlockClasses - 1);
+// The most a thread keeps on its free lists.
+static const size_t kMaxCachedBytes = 512 * 1024;
+
+namespace {
+
+struct FreeBlock {
+    FreeBlock* fNext;
+};
+
+struct BlockCache {
+    FreeBlock* fFree[kCachedBlockClasses];
+    size_t     fBytes;
+};
+
+}  // namespace
+
+static void* create_block_cache() {
+    BlockCache* cache = SkNEW(BlockCache);
+    sk_bzero(cache, sizeof(BlockCache));
+    return cache;
+}
+
+static void delete_block_cache(void* ptr) {
+    BlockCache* cache = static_cast<BlockCache*>(ptr);
+    for (int i = 0; i < kCachedBlockClasses; ++i) {
+        FreeBlock* block = cache->fFree[i];
+        while (block) {
+            FreeBlock* next = block->fNext;
+            sk_free(block);
+            block = next;
+        }
+    }
+    SkDELETE(cache);
+}
+
+static BlockCache* get_block_cache() {
+    return static_cast<BlockCache*>(SkTLS::Get(create_block_cache, delete_block_cache));
+}
+
+// Returns the free list for blocks of exactly 'bytes' after the header, or -1 if they are not
+// cached.
+static int block_class(size_t bytes) {
+    if (bytes > kMaxCachedBlockBytes || !SkIsPow2(SkToInt(bytes))) {
+        return -1;
+    }
+    const int log2 = SkNextLog2(SkToU32(bytes));
+    return log2 < kMinCachedBlockLog2 ? -1 : log2 - kMinCachedBlockLog2;
+}
+
+// Rounds 'bytes' up to the size of a cached block, if it is not too big for one.
+static size_t round_block_size(size_t bytes) {
+    if (bytes > kMaxCachedBlockBytes) {
+        return bytes;
+    }
+    return SkTMax((size_t)1 << kMinCachedBlockLog2, (size_t)SkNextPow2(SkToInt(bytes)));
+}
+
+static void* alloc_block(size_t headerBytes, size_t bytes, unsigned flags) {
+    const int index = block_class(bytes);
+    if (index >= 0) {
+        BlockCache* cache = get_block_cache();
+        FreeBlock* block = cache->fFree[index];
+        if (block) {
+            cache->fFree[index] = block->fNext;
+            cache->fBytes -= headerBytes + bytes;
+            return block;
+        }
+    }
+    return sk_malloc_flags(headerBytes + bytes, flags);
+}
+
+static void free_block(void* ptr, size_t headerBytes, size_t bytes) {
+    const int index = block_class(bytes);
+    if (index >= 0) {
+        BlockCache* cache = get_block_cache();
+        if (cache->fBytes + headerBytes + bytes <= kMaxCachedBytes) {
+            FreeBlock* block = static_cast<FreeBlock*>(ptr);
+            block->fNext = cache->fFree[index];
+            cache->fFree[index] = block;
+            cache->fBytes += headerBytes + bytes;
+            return;
+        }
+    }
+    sk_free(ptr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 struct SkChunkAlloc::Block {
     Block*  fNext;
     size_t  fFreeSize;
@@ -27,10 +128,18 @@ struct SkChunkAlloc::Block {
         return reinterpret_cast<char*>(this + 1);
     }
 
+    size_t blockSize() {
+        return fFreePtr - this->startOfData() + fFreeSize;
+    }
+
+    static void Free(Block* block) {
+        free_block(block, sizeof(Block), block->blockSize());
+    }
+
     static void FreeChain(Block* block) {
         while (block) {
             Block* next = block->fNext;
-            sk_free(block);
+            Free(block);
             block = next;
         }
     };
@@ -69,13 +178,45 @@ void SkChunkAlloc::reset() {
     fBlockCount = 0;
 }
 
+void SkChunkAlloc::rewind() {
+    Block* largest = NULL;
+    size_t largestSize = 0;
+    Block* block = fBlock;
+    while (block) {
+        Block* next = block->fNext;
+        size_t size = block->blockSize();
+        if (size > largestSize) {
+            if (largest) {
+                Block::Free(largest);
+            }
+            largest = block;
+            largestSize = size;
+        } else {
+            Block::Free(block);
+        }
+        block = next;
+    }
+
+    fBlock = largest;
+    fTotalCapacity = largestSize;
+    fTotalUsed = 0;
+    fBlockCount = 0;
+    if (largest) {
+        largest->fNext = NULL;
+        largest->fFreeSize = largestSize;
+        largest->fFreePtr = largest->startOfData();
+        fBlockCount = 1;
+    }
+}
+
 SkChunkAlloc::Block* SkChunkAlloc::newBlock(size_t bytes, AllocFailType ftype) {
     size_t size = bytes;
     if (size < fChunkSize) {
         size = fChunkSize;
     }
+    size = round_block_size(size);
 
-    Block* block = (Block*)sk_malloc_flags(sizeof(Block) + size,
+    Block* block = (Block*)alloc_block(sizeof(Block), size,
                         ftype == kThrow_AllocFailType ? SK_MALLOC_THROW : 0);
 
     if (block) {
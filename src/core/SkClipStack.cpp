@@ -484,24 +484,47 @@ void SkClipStack::Element::updateBoundAndGenID(const Element* prior) {
     }
 }
 
-// This constant determines how many Element's are allocated together as a block in
-// the deque. As such it needs to balance allocating too much memory vs.
-// incurring allocation/deallocation thrashing. It should roughly correspond to
-// the deepest save/restore stack we expect to see.
-static const int kDefaultElementAllocCnt = 8;
+struct SkClipStack::Node : public SkRefCnt {
+    // Takes over the caller's ref on prev.
+    Node(const Element& element, Node* prev)
+        : fElement(element)
+        , fPrev(prev)
+        , fCount(NULL == prev ? 1 : prev->fCount + 1) {
+    }
+
+    virtual ~Node() {
+        SkSafeUnref(fPrev);
+    }
+
+    // Unrefs node, and frees the nodes below it that nothing else refs one at a time rather than
+    // recursively, as deep stacks would run out of C stack.
+    static void UnrefChain(Node* node) {
+        while (NULL != node && node->unique()) {
+            Node* prev = node->fPrev;
+            node->fPrev = NULL;
+            node->unref();
+            node = prev;
+        }
+        SkSafeUnref(node);
+    }
+
+    Element fElement;
+    Node*   fPrev;      // The element below this one, or NULL.
+    int     fCount;     // Number of elements from this one to the bottom.
+};
 
 SkClipStack::SkClipStack()
-    : fDeque(sizeof(Element), kDefaultElementAllocCnt)
+    : fTop(NULL)
     , fSaveCount(0) {
 }
 
 SkClipStack::SkClipStack(const SkClipStack& b)
-    : fDeque(sizeof(Element), kDefaultElementAllocCnt) {
-    *this = b;
+    : fTop(SkSafeRef(b.fTop))
+    , fSaveCount(b.fSaveCount) {
 }
 
 SkClipStack::SkClipStack(const SkRect& r)
-    : fDeque(sizeof(Element), kDefaultElementAllocCnt)
+    : fTop(NULL)
     , fSaveCount(0) {
     if (!r.isEmpty()) {
         this->clipDevRect(r, SkRegion::kReplace_Op, false);
@@ -509,7 +532,7 @@ SkClipStack::SkClipStack(const SkRect& r)
 }
 
 SkClipStack::SkClipStack(const SkIRect& r)
-    : fDeque(sizeof(Element), kDefaultElementAllocCnt)
+    : fTop(NULL)
     , fSaveCount(0) {
     if (!r.isEmpty()) {
         SkRect temp;
@@ -519,23 +542,14 @@ SkClipStack::SkClipStack(const SkIRect& r)
 }
 
 SkClipStack::~SkClipStack() {
-    reset();
+    Node::UnrefChain(fTop);
 }
 
 SkClipStack& SkClipStack::operator=(const SkClipStack& b) {
-    if (this == &b) {
-        return *this;
-    }
-    reset();
-
+    Node* top = SkSafeRef(b.fTop);
+    Node::UnrefChain(fTop);
+    fTop = top;
     fSaveCount = b.fSaveCount;
-    SkDeque::F2BIter recIter(b.fDeque);
-    for (const Element* element = (const Element*)recIter.next();
-         element != NULL;
-         element = (const Element*)recIter.next()) {
-        new (fDeque.push_back()) Element(*element);
-    }
-
     return *this;
 }
 
@@ -543,34 +557,24 @@ bool SkClipStack::operator==(const SkClipStack& b) const {
     if (this->getTopmostGenID() == b.getTopmostGenID()) {
         return true;
     }
-    if (fSaveCount != b.fSaveCount ||
-        fDeque.count() != b.fDeque.count()) {
+    const int count = NULL == fTop ? 0 : fTop->fCount;
+    const int bCount = NULL == b.fTop ? 0 : b.fTop->fCount;
+    if (fSaveCount != b.fSaveCount || count != bCount) {
         return false;
     }
-    SkDeque::F2BIter myIter(fDeque);
-    SkDeque::F2BIter bIter(b.fDeque);
-    const Element* myElement = (const Element*)myIter.next();
-    const Element* bElement = (const Element*)bIter.next();
-
-    while (myElement != NULL && bElement != NULL) {
-        if (*myElement != *bElement) {
+    for (const Node *node = fTop, *bNode = b.fTop;
+         node != bNode;
+         node = node->fPrev, bNode = bNode->fPrev) {
+        if (node->fElement != bNode->fElement) {
             return false;
         }
-        myElement = (const Element*)myIter.next();
-        bElement = (const Element*)bIter.next();
     }
-    return myElement == NULL && bElement == NULL;
+    return true;
 }
 
 void SkClipStack::reset() {
-    // We used a placement new for each object in fDeque, so we're responsible
-    // for calling the destructor on each of them as well.
-    while (!fDeque.empty()) {
-        Element* element = (Element*)fDeque.back();
-        element->~Element();
-        fDeque.pop_back();
-    }
-
+    Node::UnrefChain(fTop);
+    fTop = NULL;
     fSaveCount = 0;
 }
 
@@ -584,14 +588,21 @@ void SkClipStack::restore() {
 }
 
 void SkClipStack::restoreTo(int saveCount) {
-    while (!fDeque.empty()) {
-        Element* element = (Element*)fDeque.back();
-        if (element->fSaveCount <= saveCount) {
-            break;
-        }
-        element->~Element();
-        fDeque.pop_back();
+    while (NULL != fTop && fTop->fElement.fSaveCount > saveCount) {
+        Node* top = fTop;
+        fTop = SkSafeRef(top->fPrev);
+        top->unref();
+    }
+}
+
+SkClipStack::Element* SkClipStack::writableTop() {
+    SkASSERT(NULL != fTop);
+    if (!fTop->unique()) {
+        Node* copy = SkNEW_ARGS(Node, (fTop->fElement, SkSafeRef(fTop->fPrev)));
+        fTop->unref();
+        fTop = copy;
     }
+    return &fTop->fElement;
 }
 
 void SkClipStack::getBounds(SkRect* canvFiniteBound,
@@ -599,7 +610,7 @@ void SkClipStack::getBounds(SkRect* canvFiniteBound,
                             bool* isIntersectionOfRects) const {
     SkASSERT(NULL != canvFiniteBound && NULL != boundType);
 
-    Element* element = (Element*)fDeque.back();
+    const Element* element = NULL == fTop ? NULL : &fTop->fElement;
 
     if (NULL == element) {
         // the clip is wide open - the infinite plane w/ no pixels un-writeable
@@ -663,11 +674,8 @@ bool SkClipStack::quickContains(const SkRect& rect) const {
 }
 
 void SkClipStack::pushElement(const Element& element) {
-    // Use reverse iterator instead of back because Rect path may need previous
-    SkDeque::Iter iter(fDeque, SkDeque::Iter::kBack_IterStart);
-    Element* prior = (Element*) iter.prev();
-
-    if (NULL != prior) {
+    if (NULL != fTop) {
+        const Element* prior = &fTop->fElement;
         if (prior->canBeIntersectedInPlace(fSaveCount, element.getOp())) {
             switch (prior->fType) {
                 case Element::kEmpty_Type:
@@ -678,14 +686,16 @@ void SkClipStack::pushElement(const Element& element) {
                         if (prior->rectRectIntersectAllowed(element.getRect(), element.isAA())) {
                             SkRect isectRect;
                             if (!isectRect.intersect(prior->getRect(), element.getRect())) {
-                                prior->setEmpty();
+                                this->writableTop()->setEmpty();
                                 return;
                             }
 
-                            prior->fRRect.setRect(isectRect);
-                            prior->fDoAA = element.isAA();
-                            Element* priorPrior = (Element*) iter.prev();
-                            prior->updateBoundAndGenID(priorPrior);
+                            Element* top = this->writableTop();
+                            top->fRRect.setRect(isectRect);
+                            top->fDoAA = element.isAA();
+                            const Node* priorPrior = fTop->fPrev;
+                            top->updateBoundAndGenID(NULL == priorPrior ? NULL
+                                                                        : &priorPrior->fElement);
                             return;
                         }
                         break;
@@ -693,18 +703,18 @@ void SkClipStack::pushElement(const Element& element) {
                     // fallthrough
                 default:
                     if (!SkRect::Intersects(prior->getBounds(), element.getBounds())) {
-                        prior->setEmpty();
+                        this->writableTop()->setEmpty();
                         return;
                     }
                     break;
             }
         } else if (SkRegion::kReplace_Op == element.getOp()) {
             this->restoreTo(fSaveCount - 1);
-            prior = (Element*) fDeque.back();
         }
     }
-    Element* newElement = SkNEW_PLACEMENT_ARGS(fDeque.push_back(), Element, (element));
-    newElement->updateBoundAndGenID(prior);
+    // The new node takes over our ref on the old top.
+    fTop = SkNEW_ARGS(Node, (element, fTop));
+    fTop->fElement.updateBoundAndGenID(NULL == fTop->fPrev ? NULL : &fTop->fPrev->fElement);
 }
 
 void SkClipStack::clipDevRRect(const SkRRect& rrect, SkRegion::Op op, bool doAA) {
@@ -723,14 +733,13 @@ void SkClipStack::clipDevPath(const SkPath& path, SkRegion::Op op, bool doAA) {
 }
 
 void SkClipStack::clipEmpty() {
-    Element* element = (Element*) fDeque.back();
-
-    if (element && element->canBeIntersectedInPlace(fSaveCount, SkRegion::kIntersect_Op)) {
-        element->setEmpty();
+    if (NULL != fTop &&
+        fTop->fElement.canBeIntersectedInPlace(fSaveCount, SkRegion::kIntersect_Op)) {
+        this->writableTop()->setEmpty();
     }
-    new (fDeque.push_back()) Element(fSaveCount);
+    fTop = SkNEW_ARGS(Node, (Element(fSaveCount), fTop));
 
-    ((Element*)fDeque.back())->fGenID = kEmptyGenID;
+    fTop->fElement.fGenID = kEmptyGenID;
 }
 
 bool SkClipStack::isWideOpen() const {
@@ -739,7 +748,7 @@ bool SkClipStack::isWideOpen() const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-SkClipStack::Iter::Iter() : fStack(NULL) {
+SkClipStack::Iter::Iter() : fStack(NULL), fIndex(0) {
 }
 
 SkClipStack::Iter::Iter(const SkClipStack& stack, IterStart startLoc)
@@ -747,12 +756,19 @@ SkClipStack::Iter::Iter(const SkClipStack& stack, IterStart startLoc)
     this->reset(stack, startLoc);
 }
 
+// Once the iterator runs off either end, it stays there.
 const SkClipStack::Element* SkClipStack::Iter::next() {
-    return (const SkClipStack::Element*)fIter.next();
+    if (fIndex < 0 || fIndex >= fElements.count()) {
+        return NULL;
+    }
+    return fElements[fIndex++];
 }
 
 const SkClipStack::Element* SkClipStack::Iter::prev() {
-    return (const SkClipStack::Element*)fIter.prev();
+    if (fIndex < 0 || fIndex >= fElements.count()) {
+        return NULL;
+    }
+    return fElements[fIndex--];
 }
 
 const SkClipStack::Element* SkClipStack::Iter::skipToTopmost(SkRegion::Op op) {
@@ -761,42 +777,26 @@ const SkClipStack::Element* SkClipStack::Iter::skipToTopmost(SkRegion::Op op) {
         return NULL;
     }
 
-    fIter.reset(fStack->fDeque, SkDeque::Iter::kBack_IterStart);
-
-    const SkClipStack::Element* element = NULL;
-
-    for (element = (const SkClipStack::Element*) fIter.prev();
-         NULL != element;
-         element = (const SkClipStack::Element*) fIter.prev()) {
-
-        if (op == element->fOp) {
-            // The Deque's iterator is actually one pace ahead of the
-            // returned value. So while "element" is the element we want to
-            // return, the iterator is actually pointing at (and will
-            // return on the next "next" or "prev" call) the element
-            // in front of it in the deque. Bump the iterator forward a
-            // step so we get the expected result.
-            if (NULL == fIter.next()) {
-                // The reverse iterator has run off the front of the deque
-                // (i.e., the "op" clip is the first clip) and can't
-                // recover. Reset the iterator to start at the front.
-                fIter.reset(fStack->fDeque, SkDeque::Iter::kFront_IterStart);
-            }
+    this->reset(*fStack, kBottom_IterStart);
+    for (int i = fElements.count() - 1; i >= 0; --i) {
+        if (op == fElements[i]->fOp) {
+            fIndex = i;
             break;
         }
     }
-
-    if (NULL == element) {
-        // There were no "op" clips
-        fIter.reset(fStack->fDeque, SkDeque::Iter::kFront_IterStart);
-    }
-
+    // If there were no "op" clips, this is the first clip.
     return this->next();
 }
 
 void SkClipStack::Iter::reset(const SkClipStack& stack, IterStart startLoc) {
     fStack = &stack;
-    fIter.reset(stack.fDeque, static_cast<SkDeque::Iter::IterStart>(startLoc));
+    const int count = NULL == stack.fTop ? 0 : stack.fTop->fCount;
+    fElements.reset(count);
+    int index = count;
+    for (const Node* node = stack.fTop; NULL != node; node = node->fPrev) {
+        fElements[--index] = &node->fElement;
+    }
+    fIndex = kBottom_IterStart == startLoc ? 0 : count - 1;
 }
 
 // helper method
@@ -834,11 +834,11 @@ int32_t SkClipStack::GetNextGenID() {
 }
 
 int32_t SkClipStack::getTopmostGenID() const {
-    if (fDeque.empty()) {
+    if (NULL == fTop) {
         return kWideOpenGenID;
     }
 
-    const Element* back = static_cast<const Element*>(fDeque.back());
+    const Element* back = &fTop->fElement;
     if (kInsideOut_BoundsType == back->fFiniteBoundType && back->fFiniteBound.isEmpty()) {
         return kWideOpenGenID;
     }
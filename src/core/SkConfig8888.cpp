@@ -1,4 +1,5 @@
 #include "SkConfig8888.h"
+#include "SkConfig8888_opts.h"
 #include "SkColorPriv.h"
 #include "SkMathPriv.h"
 #include "SkUnPreMultiply.h"
@@ -73,14 +74,23 @@ bool SkSrcPixelInfo::convertPixelsTo(SkDstPixelInfo* dst, int width, int height)
         return false;
     }
 
-    void (*proc)(uint32_t* dst, const uint32_t* src, int count);
+    SkConvert8888RowProc proc;
     AlphaVerb doAlpha = compute_AlphaVerb(fAlphaType, dst->fAlphaType);
     bool doSwapRB = fColorType != dst->fColorType;
 
+    SkConvert8888Procs procs;
+    if (!SkConvert8888GetPlatformProcs(&procs)) {
+        procs.fSwapRB = convert32_row<true, kNothing_AlphaVerb>;
+        procs.fPremul = convert32_row<false, kPremul_AlphaVerb>;
+        procs.fSwapRBPremul = convert32_row<true, kPremul_AlphaVerb>;
+        procs.fUnpremul = convert32_row<false, kUnpremul_AlphaVerb>;
+        procs.fSwapRBUnpremul = convert32_row<true, kUnpremul_AlphaVerb>;
+    }
+
     switch (doAlpha) {
         case kNothing_AlphaVerb:
             if (doSwapRB) {
-                proc = convert32_row<true, kNothing_AlphaVerb>;
+                proc = procs.fSwapRB;
             } else {
                 if (fPixels == dst->fPixels) {
                     return true;
@@ -89,18 +99,10 @@ bool SkSrcPixelInfo::convertPixelsTo(SkDstPixelInfo* dst, int width, int height)
             }
             break;
         case kPremul_AlphaVerb:
-            if (doSwapRB) {
-                proc = convert32_row<true, kPremul_AlphaVerb>;
-            } else {
-                proc = convert32_row<false, kPremul_AlphaVerb>;
-            }
+            proc = doSwapRB ? procs.fSwapRBPremul : procs.fPremul;
             break;
         case kUnpremul_AlphaVerb:
-            if (doSwapRB) {
-                proc = convert32_row<true, kUnpremul_AlphaVerb>;
-            } else {
-                proc = convert32_row<false, kUnpremul_AlphaVerb>;
-            }
+            proc = doSwapRB ? procs.fSwapRBUnpremul : procs.fUnpremul;
             break;
     }
 
@@ -4,6 +4,7 @@
 
 #include "SkConvolver.h"
 #include "SkSize.h"
+#include "SkTaskGroup.h"
 #include "SkTypes.h"
 
 namespace {
@@ -330,26 +331,32 @@ const SkConvolutionFilter1D::ConvolutionFixed* SkConvolutionFilter1D::GetSingleF
     return &fFilterValues[filter.fDataLocation];
 }
 
-void BGRAConvolve2D(const unsigned char* sourceData,
-                    int sourceByteRowStride,
-                    bool sourceHasAlpha,
-                    const SkConvolutionFilter1D& filterX,
-                    const SkConvolutionFilter1D& filterY,
-                    int outputByteRowStride,
-                    unsigned char* output,
-                    const SkConvolutionProcs& convolveProcs,
-                    bool useSimdIfPossible) {
+namespace {
+
+// Does the convolution for output rows [firstOutputRow, endOutputRow), with a
+// row buffer of its own, so that bands of rows can be done in parallel.
+void ConvolveRowRange(const unsigned char* sourceData,
+                      int sourceByteRowStride,
+                      bool sourceHasAlpha,
+                      const SkConvolutionFilter1D& filterX,
+                      const SkConvolutionFilter1D& filterY,
+                      int outputByteRowStride,
+                      unsigned char* output,
+                      const SkConvolutionProcs& convolveProcs,
+                      int firstOutputRow,
+                      int endOutputRow) {
 
     int maxYFilterSize = filterY.maxFilter();
 
     // The next row in the input that we will generate a horizontally
     // convolved row for. If the filter doesn't start at the beginning of the
-    // image (this is the case when we are only resizing a subset), then we
-    // don't want to generate any output rows before that. Compute the starting
-    // row for convolution as the first pixel for the first vertical filter.
+    // image (this is the case when we are only resizing a subset, or doing a
+    // band of rows), then we don't want to generate any output rows before
+    // that. Compute the starting row for convolution as the first pixel for
+    // the first vertical filter.
     int filterOffset, filterLength;
     const SkConvolutionFilter1D::ConvolutionFixed* filterValues =
-        filterY.FilterForValue(0, &filterOffset, &filterLength);
+        filterY.FilterForValue(firstOutputRow, &filterOffset, &filterLength);
     int nextXRow = filterOffset;
 
     // We loop over each row in the input doing a horizontal convolution. This
@@ -393,7 +400,7 @@ void BGRAConvolve2D(const unsigned char* sourceData,
     filterY.FilterForValue(numOutputRows - 1, &lastFilterOffset,
                            &lastFilterLength);
 
-    for (int outY = 0; outY < numOutputRows; outY++) {
+    for (int outY = firstOutputRow; outY < endOutputRow; outY++) {
         filterValues = filterY.FilterForValue(outY,
                                               &filterOffset, &filterLength);
 
@@ -459,3 +466,82 @@ void BGRAConvolve2D(const unsigned char* sourceData,
         }
     }
 }
+
+// Each band is convolved on its own. The bands overlap by the height of the
+// vertical filter in the source, so those rows are convolved horizontally by
+// both bands.
+class ConvolveBands : public SkParallelForBody {
+public:
+    ConvolveBands(const unsigned char* sourceData,
+                  int sourceByteRowStride,
+                  bool sourceHasAlpha,
+                  const SkConvolutionFilter1D& filterX,
+                  const SkConvolutionFilter1D& filterY,
+                  int outputByteRowStride,
+                  unsigned char* output,
+                  const SkConvolutionProcs& convolveProcs,
+                  int bandRows)
+        : fSourceData(sourceData),
+          fSourceByteRowStride(sourceByteRowStride),
+          fSourceHasAlpha(sourceHasAlpha),
+          fFilterX(filterX),
+          fFilterY(filterY),
+          fOutputByteRowStride(outputByteRowStride),
+          fOutput(output),
+          fConvolveProcs(convolveProcs),
+          fBandRows(bandRows) {
+    }
+
+    virtual void run(int band) SK_OVERRIDE {
+        int firstRow = band * fBandRows;
+        int endRow = SkTMin(firstRow + fBandRows, fFilterY.numValues());
+        ConvolveRowRange(fSourceData, fSourceByteRowStride, fSourceHasAlpha,
+                         fFilterX, fFilterY, fOutputByteRowStride, fOutput,
+                         fConvolveProcs, firstRow, endRow);
+    }
+
+private:
+    const unsigned char* fSourceData;
+    int fSourceByteRowStride;
+    bool fSourceHasAlpha;
+    const SkConvolutionFilter1D& fFilterX;
+    const SkConvolutionFilter1D& fFilterY;
+    int fOutputByteRowStride;
+    unsigned char* fOutput;
+    const SkConvolutionProcs& fConvolveProcs;
+    int fBandRows;
+};
+
+// Bands much shorter than the vertical filter would mostly redo each other's
+// horizontal convolutions.
+const int kMinBandRows = 32;
+
+}  // namespace
+
+void BGRAConvolve2D(const unsigned char* sourceData,
+                    int sourceByteRowStride,
+                    bool sourceHasAlpha,
+                    const SkConvolutionFilter1D& filterX,
+                    const SkConvolutionFilter1D& filterY,
+                    int outputByteRowStride,
+                    unsigned char* output,
+                    const SkConvolutionProcs& convolveProcs,
+                    bool useSimdIfPossible,
+                    int threadCount) {
+    const int numOutputRows = filterY.numValues();
+    const int bandRows = SkTMax(kMinBandRows, 2 * filterY.maxFilter());
+    if ((threadCount >= 0 && threadCount <= 1) || numOutputRows < 2 * bandRows) {
+        ConvolveRowRange(sourceData, sourceByteRowStride, sourceHasAlpha,
+                         filterX, filterY, outputByteRowStride, output,
+                         convolveProcs, 0, numOutputRows);
+        return;
+    }
+
+    ConvolveBands bands(sourceData, sourceByteRowStride, sourceHasAlpha,
+                        filterX, filterY, outputByteRowStride, output,
+                        convolveProcs, bandRows);
+    SkThreadPool pool(threadCount);
+    SkTaskGroup group(&pool);
+    group.parallelFor(0, (numOutputRows + bandRows - 1) / bandRows, &bands);
+    group.wait();
+}
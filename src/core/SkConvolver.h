@@ -198,6 +198,7 @@ SK_API void BGRAConvolve2D(const unsigned char* sourceData,
     int outputByteRowStride,
     unsigned char* output,
     const SkConvolutionProcs&,
-    bool useSimdIfPossible);
+    bool useSimdIfPossible,
+    int threadCount = 1);
 
 #endif  // SK_CONVOLVER_H
@@ -119,6 +119,7 @@ public:
     virtual void blitV(int x, int y, int height, SkAlpha alpha);
     virtual void blitRect(int x, int y, int width, int height);
     virtual void blitMask(const SkMask&, const SkIRect&);
+    virtual void blitMasks(const SkMask masks[], const SkIRect clips[], int count);
     virtual const SkBitmap* justAnOpaqueColor(uint32_t*);
 
 protected:
@@ -200,4 +201,13 @@ SkBlitter* SkBlitter_ChooseD565(const SkBitmap& device, const SkPaint& paint,
                                 SkShader::Context* shaderContext,
                                 SkTBlitterAllocator* allocator);
 
+/*  Returns a blitter for an N32 device that filters and blends in float, through SkRasterPipeline,
+    or NULL if the paint's xfermode or color filter can't be done that way. Unlike the blitters
+    above, this one handles the paint's color filter itself, and creates its own shader context.
+    SkBlitter::Choose() only uses it when SK_USE_FLOAT_PIPELINE is defined.
+ */
+SkBlitter* SkCreateRasterPipelineBlitter(const SkBitmap& device, const SkPaint& paint,
+                                         const SkMatrix& matrix,
+                                         SkTBlitterAllocator* allocator);
+
 #endif
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCoverageMask.h"
+#include "SkBlitter.h"
+#include "SkMatrix.h"
+#include "SkPath.h"
+#include "SkRasterClip.h"
+#include "SkScan.h"
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
+
+// Union accumulates coverage as srcover does: c + d * (255 - c) / 255.
+static inline uint8_t union_coverage(unsigned d, unsigned c) {
+    return SkToU8(c + SkMulDiv255Round(d, 255 - c));
+}
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+// union_coverage() on eight 16 bit lanes, rounding the same way.
+static inline __m128i union_coverage8(__m128i d, __m128i c) {
+    __m128i prod = _mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), c)),
+                                 _mm_set1_epi16(128));
+    prod = _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+    return _mm_add_epi16(c, prod);
+}
+
+// union_coverage() on sixteen bytes.
+static inline __m128i union_coverage16(__m128i d, __m128i c) {
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_packus_epi16(union_coverage8(_mm_unpacklo_epi8(d, zero),
+                                            _mm_unpacklo_epi8(c, zero)),
+                            union_coverage8(_mm_unpackhi_epi8(d, zero),
+                                            _mm_unpackhi_epi8(c, zero)));
+}
+#endif
+
+// Accumulates the same coverage into count pixels.
+static void union_span(uint8_t* dst, U8CPU coverage, int count) {
+    if (0xFF == coverage) {
+        memset(dst, 0xFF, count);
+        return;
+    }
+    int i = 0;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128i c = _mm_set1_epi8((char)coverage);
+    for (; i + 16 <= count; i += 16) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), union_coverage16(d, c));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = union_coverage(dst[i], coverage);
+    }
+}
+
+// Accumulates per pixel coverage into count pixels.
+static void union_row(uint8_t* dst, const uint8_t* coverage, int count) {
+    int i = 0;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    for (; i + 16 <= count; i += 16) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coverage + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), union_coverage16(d, c));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = union_coverage(dst[i], coverage[i]);
+    }
+}
+
+static void replace_row(uint8_t* dst, const uint8_t* coverage, int count) {
+    for (int i = 0; i < count; ++i) {
+        if (coverage[i]) {
+            dst[i] = coverage[i];
+        }
+    }
+}
+
+// Writes coverage straight into an A8 mask, in device coordinates.
+class SkCoverageMaskBlitter : public SkBlitter {
+public:
+    SkCoverageMaskBlitter(const SkMask& mask, SkCoverageMask::Op op) : fMask(mask), fOp(op) {}
+
+    virtual void blitH(int x, int y, int width) SK_OVERRIDE {
+        memset(fMask.getAddr8(x, y), 0xFF, width);
+    }
+
+    virtual void blitAntiH(int x, int y, const SkAlpha antialias[],
+                           const int16_t runs[]) SK_OVERRIDE {
+        uint8_t* dst = fMask.getAddr8(x, y);
+        for (;;) {
+            const int count = runs[0];
+            SkASSERT(count >= 0);
+            if (0 == count) {
+                return;
+            }
+            this->span(dst, antialias[0], count);
+            runs += count;
+            antialias += count;
+            dst += count;
+        }
+    }
+
+    virtual void blitV(int x, int y, int height, SkAlpha alpha) SK_OVERRIDE {
+        uint8_t* dst = fMask.getAddr8(x, y);
+        while (--height >= 0) {
+            this->span(dst, alpha, 1);
+            dst += fMask.fRowBytes;
+        }
+    }
+
+    virtual void blitRect(int x, int y, int width, int height) SK_OVERRIDE {
+        uint8_t* dst = fMask.getAddr8(x, y);
+        while (--height >= 0) {
+            memset(dst, 0xFF, width);
+            dst += fMask.fRowBytes;
+        }
+    }
+
+    // Small anti-aliased paths are supersampled into a mask of their own.
+    virtual void blitMask(const SkMask& mask, const SkIRect& clip) SK_OVERRIDE {
+        SkASSERT(SkMask::kA8_Format == mask.fFormat);
+        uint8_t* dst = fMask.getAddr8(clip.fLeft, clip.fTop);
+        const uint8_t* src = mask.getAddr8(clip.fLeft, clip.fTop);
+        for (int y = clip.height(); --y >= 0;) {
+            if (SkCoverageMask::kUnion_Op == fOp) {
+                union_row(dst, src, clip.width());
+            } else {
+                replace_row(dst, src, clip.width());
+            }
+            dst += fMask.fRowBytes;
+            src += mask.fRowBytes;
+        }
+    }
+
+private:
+    void span(uint8_t* dst, U8CPU coverage, int count) {
+        if (0 == coverage) {
+            return;
+        }
+        if (SkCoverageMask::kUnion_Op == fOp) {
+            union_span(dst, coverage, count);
+        } else {
+            memset(dst, coverage, count);
+        }
+    }
+
+    const SkMask& fMask;
+    const SkCoverageMask::Op fOp;
+};
+
+void SkCoverageMask::Fill(const SkPath& path, const SkMatrix& matrix, const SkIRect& clip,
+                          bool antiAlias, Op op, const SkMask& mask) {
+    SkASSERT(SkMask::kA8_Format == mask.fFormat);
+    SkIRect bounds;
+    if (NULL == mask.fImage || !bounds.intersect(clip, mask.fBounds)) {
+        return;
+    }
+
+    SkPath devPath;
+    const SkPath* src = &path;
+    if (!matrix.isIdentity()) {
+        path.transform(matrix, &devPath);
+        src = &devPath;
+    }
+
+    SkCoverageMaskBlitter blitter(mask, op);
+    const SkRasterClip rasterClip(bounds);
+    if (antiAlias) {
+        SkScan::AntiFillPath(*src, rasterClip, &blitter);
+    } else {
+        SkScan::FillPath(*src, rasterClip, &blitter);
+    }
+}
+
+bool SkCoverageMask::Create(const SkPath& path, const SkMatrix& matrix, const SkIRect& clip,
+                            bool antiAlias, SkMask* mask) {
+    mask->fImage = NULL;
+
+    SkPath devPath;
+    path.transform(matrix, &devPath);
+    SkIRect bounds = clip;
+    if (!devPath.isInverseFillType()) {
+        SkIRect pathBounds;
+        devPath.getBounds().roundOut(&pathBounds);
+        if (!bounds.intersect(pathBounds)) {
+            return false;
+        }
+    }
+    if (bounds.isEmpty()) {
+        return false;
+    }
+
+    mask->fBounds = bounds;
+    mask->fFormat = SkMask::kA8_Format;
+    mask->fRowBytes = bounds.width();
+    const size_t size = mask->computeImageSize();
+    if (0 == size) {
+        // Too big to allocate.
+        return false;
+    }
+    mask->fImage = SkMask::AllocImage(size);
+    sk_bzero(mask->fImage, size);
+
+    Fill(devPath, SkMatrix::I(), bounds, antiAlias, kReplace_Op, *mask);
+    return true;
+}
@@ -77,6 +77,13 @@ void SkBaseDevice::drawDRRect(const SkDraw& draw, const SkRRect& outer,
     this->drawPath(draw, path, paint, preMatrix, pathIsMutable);
 }
 
+void SkBaseDevice::drawRects(const SkDraw& draw, const SkRect rects[], int count,
+                             const SkPaint& paint) {
+    for (int i = 0; i < count; ++i) {
+        this->drawRect(draw, rects[i], paint);
+    }
+}
+
 bool SkBaseDevice::readPixels(const SkImageInfo& info, void* dstP, size_t rowBytes, int x, int y) {
 #ifdef SK_DEBUG
     SkASSERT(info.width() > 0 && info.height() > 0);
@@ -8,6 +8,10 @@
 #include "SkDistanceFieldGen.h"
 #include "SkPoint.h"
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
+
 struct DFData {
     float   fAlpha;      // alpha value of source texel
     float   fDistSq;     // distance squared to nearest (so far) edge texel
@@ -191,124 +195,99 @@ static void init_distances(DFData* data, unsigned char* edges, int width, int he
 
 // Danielsson's 8SSEDT
 
-// first stage forward pass
-// (forward in Y, forward in X)
-static void F1(DFData* curr, int width) {
-    // upper left
-    DFData* check = curr - width-1;
+// If the edge nearest to the neighbor 'check', which sits at offset (dx, dy) from 'curr',
+// is closer to 'curr' than the nearest edge found so far, take it instead
+static inline void check_neighbor(DFData* curr, const DFData* check, float dx, float dy) {
     SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq - 2.0f*(distVec.fX + distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-
-    // up
-    check = curr - width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-
-    // upper right
-    check = curr - width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX - distVec.fY + 1.0f);
+    float distSq = check->fDistSq + 2.0f*(dx*distVec.fX + dy*distVec.fY) + (dx*dx + dy*dy);
     if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-
-    // left
-    check = curr - 1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
+        distVec.fX += dx;
+        distVec.fY += dy;
         curr->fDistSq = distSq;
         curr->fDistVector = distVec;
     }
 }
 
-// second stage forward pass
-// (forward in Y, backward in X)
-static void F2(DFData* curr, int width) {
-    // right
-    DFData* check = curr + 1;
-    float distSq = check->fDistSq;
-    SkPoint distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+// four pixel version of check_neighbor, on transposed data
+static inline void check_neighbor4(__m128* distSq, __m128* vecX, __m128* vecY, __m128 notEdge,
+                                   const DFData* check, float dx, float dy) {
+    __m128 checkAlpha = _mm_loadu_ps(&check[0].fAlpha);
+    __m128 checkDistSq = _mm_loadu_ps(&check[1].fAlpha);
+    __m128 checkX = _mm_loadu_ps(&check[2].fAlpha);
+    __m128 checkY = _mm_loadu_ps(&check[3].fAlpha);
+    _MM_TRANSPOSE4_PS(checkAlpha, checkDistSq, checkX, checkY);
+
+    __m128 dxx = _mm_set1_ps(dx);
+    __m128 dyy = _mm_set1_ps(dy);
+    __m128 dot = _mm_add_ps(_mm_mul_ps(dxx, checkX), _mm_mul_ps(dyy, checkY));
+    __m128 candSq = _mm_add_ps(_mm_add_ps(checkDistSq, _mm_mul_ps(_mm_set1_ps(2.0f), dot)),
+                               _mm_set1_ps(dx*dx + dy*dy));
+    __m128 closer = _mm_and_ps(_mm_cmplt_ps(candSq, *distSq), notEdge);
+
+    *distSq = _mm_or_ps(_mm_and_ps(closer, candSq), _mm_andnot_ps(closer, *distSq));
+    *vecX = _mm_or_ps(_mm_and_ps(closer, _mm_add_ps(checkX, dxx)), _mm_andnot_ps(closer, *vecX));
+    *vecY = _mm_or_ps(_mm_and_ps(closer, _mm_add_ps(checkY, dyy)), _mm_andnot_ps(closer, *vecY));
 }
+#endif
 
-// first stage backward pass
-// (backward in Y, forward in X)
-static void B1(DFData* curr, int width) {
-    // left
-    DFData* check = curr - 1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-}
+// Checks the three neighbors in the row above (dy = -1) or below (dy = 1) for every
+// non-edge pixel in the row. Unlike the left and right neighbors, these don't depend on
+// earlier results in the same row, so we can do the whole row at once, 4 pixels at a time
+// where we have SSE2.
+static void check_row(DFData* curr, const unsigned char* edges, int count, int width, float dy) {
+    const DFData* check = dy < 0 ? curr - width : curr + width;
+    int i = 0;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        uint32_t edges4;
+        memcpy(&edges4, edges + i, sizeof(edges4));
+        __m128i edgesWide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(edges4),
+                                                                 zero), zero);
+        __m128 notEdge = _mm_castsi128_ps(_mm_cmpeq_epi32(edgesWide, zero));
+        if (0 == _mm_movemask_ps(notEdge)) {
+            continue;
+        }
 
-// second stage backward pass
-// (backward in Y, backwards in X)
-static void B2(DFData* curr, int width) {
-    // right
-    DFData* check = curr + 1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+        __m128 alpha = _mm_loadu_ps(&curr[i].fAlpha);
+        __m128 distSq = _mm_loadu_ps(&curr[i+1].fAlpha);
+        __m128 vecX = _mm_loadu_ps(&curr[i+2].fAlpha);
+        __m128 vecY = _mm_loadu_ps(&curr[i+3].fAlpha);
+        _MM_TRANSPOSE4_PS(alpha, distSq, vecX, vecY);
+
+        check_neighbor4(&distSq, &vecX, &vecY, notEdge, check + i - 1, -1.0f, dy);
+        check_neighbor4(&distSq, &vecX, &vecY, notEdge, check + i,      0.0f, dy);
+        check_neighbor4(&distSq, &vecX, &vecY, notEdge, check + i + 1,  1.0f, dy);
+
+        _MM_TRANSPOSE4_PS(alpha, distSq, vecX, vecY);
+        _mm_storeu_ps(&curr[i].fAlpha, alpha);
+        _mm_storeu_ps(&curr[i+1].fAlpha, distSq);
+        _mm_storeu_ps(&curr[i+2].fAlpha, vecX);
+        _mm_storeu_ps(&curr[i+3].fAlpha, vecY);
     }
-
-    // bottom left
-    check = curr + width-1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*(distVec.fX - distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+#endif
+    for (; i < count; ++i) {
+        // don't need to calculate distance for edge pixels
+        if (!edges[i]) {
+            check_neighbor(curr + i, check + i - 1, -1.0f, dy);
+            check_neighbor(curr + i, check + i,      0.0f, dy);
+            check_neighbor(curr + i, check + i + 1,  1.0f, dy);
+        }
     }
+}
 
-    // bottom
-    check = curr + width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// Propagates along the row from the left, then back from the right
+static void check_row_sides(DFData* curr, const unsigned char* edges, int count) {
+    for (int i = 0; i < count; ++i) {
+        if (!edges[i]) {
+            check_neighbor(curr + i, curr + i - 1, -1.0f, 0.0f);
+        }
     }
-
-    // bottom right
-    check = curr + width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX + distVec.fY + 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+    for (int i = count - 1; i >= 0; --i) {
+        if (!edges[i]) {
+            check_neighbor(curr + i, curr + i + 1, 1.0f, 0.0f);
+        }
     }
 }
 
@@ -367,60 +346,20 @@ static bool generate_distance_field_from_image(unsigned char* distanceField,
     DFData* currData = dataPtr+dataWidth+1; // skip outer buffer
     unsigned char* currEdge = edgePtr+dataWidth+1;
     for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
-
-        currData += dataWidth+1;
-        currEdge += dataWidth+1;
+        check_row(currData, currEdge, dataWidth-2, dataWidth, -1.0f);
+        check_row_sides(currData, currEdge, dataWidth-2);
+        currData += dataWidth;
+        currEdge += dataWidth;
     }
 
     // backwards in y
-    currData = dataPtr+dataWidth*(dataHeight-2) - 1; // skip outer buffer
-    currEdge = edgePtr+dataWidth*(dataHeight-2) - 1;
+    currData = dataPtr+dataWidth*(dataHeight-2) + 1; // skip outer buffer
+    currEdge = edgePtr+dataWidth*(dataHeight-2) + 1;
     for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
-
-        currData -= dataWidth-1;
-        currEdge -= dataWidth-1;
+        check_row(currData, currEdge, dataWidth-2, dataWidth, 1.0f);
+        check_row_sides(currData, currEdge, dataWidth-2);
+        currData -= dataWidth;
+        currEdge -= dataWidth;
     }
 
     // copy results to final distance field data
@@ -15,6 +15,7 @@
 #include "SkMaskFilter.h"
 #include "SkPaint.h"
 #include "SkPathEffect.h"
+#include "SkPathMaskCache.h"
 #include "SkRasterClip.h"
 #include "SkRasterizer.h"
 #include "SkRRect.h"
@@ -377,34 +378,29 @@ static void bw_pt_hair_proc(const PtProcRec& rec, const SkPoint devPts[],
     }
 }
 
+// The hairline scanners clip against rec.fRC themselves, once per batch, so
+// these are handed the blitter before chooseProc() wraps it for fClip.
+
 static void bw_line_hair_proc(const PtProcRec& rec, const SkPoint devPts[],
                               int count, SkBlitter* blitter) {
-    for (int i = 0; i < count; i += 2) {
-        SkScan::HairLine(devPts[i], devPts[i+1], *rec.fRC, blitter);
-    }
+    SkScan::HairLines(devPts, count, *rec.fRC, blitter);
 }
 
 static void bw_poly_hair_proc(const PtProcRec& rec, const SkPoint devPts[],
                               int count, SkBlitter* blitter) {
-    for (int i = 0; i < count - 1; i++) {
-        SkScan::HairLine(devPts[i], devPts[i+1], *rec.fRC, blitter);
-    }
+    SkScan::HairPolyline(devPts, count, *rec.fRC, blitter);
 }
 
 // aa versions
 
 static void aa_line_hair_proc(const PtProcRec& rec, const SkPoint devPts[],
                               int count, SkBlitter* blitter) {
-    for (int i = 0; i < count; i += 2) {
-        SkScan::AntiHairLine(devPts[i], devPts[i+1], *rec.fRC, blitter);
-    }
+    SkScan::AntiHairLines(devPts, count, *rec.fRC, blitter);
 }
 
 static void aa_poly_hair_proc(const PtProcRec& rec, const SkPoint devPts[],
                               int count, SkBlitter* blitter) {
-    for (int i = 0; i < count - 1; i++) {
-        SkScan::AntiHairLine(devPts[i], devPts[i+1], *rec.fRC, blitter);
-    }
+    SkScan::AntiHairPolyline(devPts, count, *rec.fRC, blitter);
 }
 
 // square procs (strokeWidth > 0 but matrix is square-scale (sx == sy)
@@ -481,6 +477,22 @@ bool PtProcRec::init(SkCanvas::PointMode mode, const SkPaint& paint,
 PtProcRec::Proc PtProcRec::chooseProc(SkBlitter** blitterPtr) {
     Proc proc = NULL;
 
+    // for our arrays
+    SkASSERT(0 == SkCanvas::kPoints_PointMode);
+    SkASSERT(1 == SkCanvas::kLines_PointMode);
+    SkASSERT(2 == SkCanvas::kPolygon_PointMode);
+    SkASSERT((unsigned)fMode <= (unsigned)SkCanvas::kPolygon_PointMode);
+
+    if (0 == fPaint->getStrokeWidth() && SkCanvas::kPoints_PointMode != fMode) {
+        static const Proc gAAProcs[] = {
+            NULL, aa_line_hair_proc, aa_poly_hair_proc
+        };
+        static const Proc gBWProcs[] = {
+            NULL, bw_line_hair_proc, bw_poly_hair_proc
+        };
+        return fPaint->isAntiAlias() ? gAAProcs[fMode] : gBWProcs[fMode];
+    }
+
     SkBlitter* blitter = *blitterPtr;
     if (fRC->isBW()) {
         fClip = &fRC->bwRgn();
@@ -491,18 +503,9 @@ PtProcRec::Proc PtProcRec::chooseProc(SkBlitter** blitterPtr) {
         *blitterPtr = blitter;
     }
 
-    // for our arrays
-    SkASSERT(0 == SkCanvas::kPoints_PointMode);
-    SkASSERT(1 == SkCanvas::kLines_PointMode);
-    SkASSERT(2 == SkCanvas::kPolygon_PointMode);
-    SkASSERT((unsigned)fMode <= (unsigned)SkCanvas::kPolygon_PointMode);
-
     if (fPaint->isAntiAlias()) {
         if (0 == fPaint->getStrokeWidth()) {
-            static const Proc gAAProcs[] = {
-                aa_square_proc, aa_line_hair_proc, aa_poly_hair_proc
-            };
-            proc = gAAProcs[fMode];
+            proc = aa_square_proc;
         } else if (fPaint->getStrokeCap() != SkPaint::kRound_Cap) {
             SkASSERT(SkCanvas::kPoints_PointMode == fMode);
             proc = aa_square_proc;
@@ -520,10 +523,7 @@ PtProcRec::Proc PtProcRec::chooseProc(SkBlitter** blitterPtr) {
                     proc = bw_pt_rect_hair_proc;
                 }
             } else {
-                static Proc gBWProcs[] = {
-                    bw_pt_hair_proc, bw_line_hair_proc, bw_poly_hair_proc
-                };
-                proc = gBWProcs[fMode];
+                proc = bw_pt_hair_proc;
             }
         } else {
             proc = bw_square_proc;
@@ -865,6 +865,67 @@ void SkDraw::drawRect(const SkRect& rect, const SkPaint& paint) const {
     }
 }
 
+void SkDraw::drawRects(const SkRect rects[], int count, const SkPaint& paint) const {
+    SkDEBUGCODE(this->validate();)
+
+    // nothing to draw
+    if (fRC->isEmpty() || count <= 0) {
+        return;
+    }
+
+    // Frames and paths gain little from sharing a blitter, so only fills are batched.
+    SkPoint strokeSize;
+    if (kFill_RectType != ComputeRectType(paint, *fMatrix, &strokeSize)) {
+        for (int i = 0; i < count; ++i) {
+            this->drawRect(rects[i], paint);
+        }
+        return;
+    }
+
+    // Drop the rects that miss the clip up front, so that we only build a blitter if some of
+    // them are left.
+    const SkMatrix& matrix = *fMatrix;
+    SkAutoSTMalloc<32, SkRect> devRects(count);
+    int devCount = 0;
+    SkIRect bounds = SkIRect::MakeEmpty();
+    for (int i = 0; i < count; ++i) {
+        SkRect& devRect = devRects[devCount];
+        matrix.mapPoints(rect_points(devRect), rect_points(rects[i]), 2);
+        devRect.sort();
+
+        SkIRect ir;
+        devRect.roundOut(&ir);
+        if (!fRC->quickReject(ir)) {
+            bounds.join(ir);
+            devCount++;
+        }
+    }
+    if (0 == devCount) {
+        return;
+    }
+
+    SkDeviceLooper looper(*fBitmap, *fRC, bounds, paint.isAntiAlias());
+    while (looper.next()) {
+        SkMatrix localMatrix;
+        looper.mapMatrix(&localMatrix, matrix);
+
+        SkAutoBlitterChoose blitterStorage(looper.getBitmap(), localMatrix,
+                                           paint);
+        const SkRasterClip& clip = looper.getRC();
+        SkBlitter*          blitter = blitterStorage.get();
+
+        for (int i = 0; i < devCount; ++i) {
+            SkRect localDevRect;
+            looper.mapRect(&localDevRect, devRects[i]);
+            if (paint.isAntiAlias()) {
+                SkScan::AntiFillRect(localDevRect, clip, blitter);
+            } else {
+                SkScan::FillRect(localDevRect, clip, blitter);
+            }
+        }
+    }
+}
+
 void SkDraw::drawDevMask(const SkMask& srcM, const SkPaint& paint) const {
     if (srcM.fBounds.isEmpty()) {
         return;
@@ -946,6 +1007,37 @@ bool SkDrawTreatAAStrokeAsHairline(SkScalar strokeWidth, const SkMatrix& matrix,
     return false;
 }
 
+bool SkDraw::drawAnalyticRRect(const SkRRect& rrect, const SkPaint& paint) const {
+    if (!paint.isAntiAlias() || paint.getStyle() != SkPaint::kFill_Style ||
+        paint.getPathEffect() || paint.getMaskFilter() || paint.getRasterizer()) {
+        return false;
+    }
+
+    SkRRect devRRect;
+    if (!rrect.transform(*fMatrix, &devRRect) || !SkScan::CanAntiFillRRect(devRRect)) {
+        return false;
+    }
+
+    SkIRect ir;
+    devRRect.getBounds().roundOut(&ir);
+    if (fRC->quickReject(ir)) {
+        return true;
+    }
+
+    SkDeviceLooper looper(*fBitmap, *fRC, ir, true);
+    while (looper.next()) {
+        SkMatrix localMatrix;
+        looper.mapMatrix(&localMatrix, *fMatrix);
+        // localMatrix is just translated from fMatrix, so this can't fail.
+        SkRRect localRRect;
+        SkAssertResult(rrect.transform(localMatrix, &localRRect));
+
+        SkAutoBlitterChoose blitter(looper.getBitmap(), localMatrix, paint);
+        SkScan::AntiFillRRect(localRRect, looper.getRC(), blitter.get());
+    }
+    return true;
+}
+
 void SkDraw::drawRRect(const SkRRect& rrect, const SkPaint& paint) const {
     SkDEBUGCODE(this->validate());
 
@@ -953,6 +1045,10 @@ void SkDraw::drawRRect(const SkRRect& rrect, const SkPaint& paint) const {
         return;
     }
 
+    if (this->drawAnalyticRRect(rrect, paint)) {
+        return;
+    }
+
     {
         // TODO: Investigate optimizing these options. They are in the same
         // order as SkDraw::drawPath, which handles each case. It may be
@@ -990,6 +1086,266 @@ DRAW_PATH:
     this->drawPath(path, paint, NULL, true);
 }
 
+#ifndef SK_DISABLE_DASHING_OPTIMIZATION
+
+namespace {
+
+/*  Steps through a dash pattern along a contour the same way that
+    SkDashPath::FilterDashPath() does, so the "on" intervals it visits are the
+    pieces that SkDashPathEffect would have added to the dashed path.
+ */
+class DashWalker {
+public:
+    DashWalker(const SkScalar intervals[], int count, SkScalar phase)
+        : fIntervals(intervals)
+        , fCount(count)
+        , fIntervalLength(0) {
+        for (int i = 0; i < count; ++i) {
+            fIntervalLength += intervals[i];
+        }
+        fInitialIndex = 0;
+        fInitialLength = intervals[0];
+        // phase has already been reduced to [0, fIntervalLength).
+        for (int i = 0; i < count; ++i) {
+            if (phase > intervals[i]) {
+                phase -= intervals[i];
+            } else {
+                fInitialIndex = i;
+                fInitialLength = intervals[i] - phase;
+                break;
+            }
+        }
+        this->restart();
+    }
+
+    SkScalar intervalLength() const { return fIntervalLength; }
+
+    /** Go back to the start of the pattern, for a new contour. */
+    void restart() {
+        fDistance = 0;
+        fLength = fInitialLength;
+        fIndex = fInitialIndex;
+    }
+
+    double start() const { return fDistance; }
+    double end() const { return fDistance + fLength; }
+    bool isOn() const { return !(fIndex & 1) && fLength > 0; }
+
+    void next() {
+        fDistance += fLength;
+        if (++fIndex == fCount) {
+            fIndex = 0;
+        }
+        fLength = fIntervals[fIndex];
+    }
+
+    /** Step past every interval that ends at or before distance. */
+    void skipTo(double distance) {
+        // The pattern repeats every fIntervalLength, so skip whole repeats at once.
+        double repeats = floor((distance - fDistance) / fIntervalLength);
+        if (repeats > 1) {
+            fDistance += (repeats - 1) * fIntervalLength;
+        }
+        while (this->end() <= distance) {
+            this->next();
+        }
+    }
+
+private:
+    const SkScalar* fIntervals;
+    int             fCount;
+    SkScalar        fIntervalLength;
+    SkScalar        fInitialLength;
+    int             fInitialIndex;
+
+    // Using double precision, as FilterDashPath() does.
+    double          fDistance;
+    double          fLength;
+    int             fIndex;
+};
+
+}  // namespace
+
+// Narrow [0, 1] to the part of the line from pts[0] to pts[1] within bounds.
+static bool clip_line_to_bounds(const SkPoint pts[2], const SkRect& bounds,
+                                SkScalar* t0, SkScalar* t1) {
+    const SkScalar start[2] = { pts[0].fX, pts[0].fY };
+    const SkScalar delta[2] = { pts[1].fX - pts[0].fX, pts[1].fY - pts[0].fY };
+    const SkScalar lo[2] = { bounds.fLeft, bounds.fTop };
+    const SkScalar hi[2] = { bounds.fRight, bounds.fBottom };
+    *t0 = 0;
+    *t1 = SK_Scalar1;
+    for (int i = 0; i < 2; ++i) {
+        if (0 == delta[i]) {
+            if (start[i] < lo[i] || start[i] > hi[i]) {
+                return false;
+            }
+            continue;
+        }
+        SkScalar ta = (lo[i] - start[i]) / delta[i];
+        SkScalar tb = (hi[i] - start[i]) / delta[i];
+        if (ta > tb) {
+            SkTSwap(ta, tb);
+        }
+        *t0 = SkMaxScalar(*t0, ta);
+        *t1 = SkMinScalar(*t1, tb);
+    }
+    return *t0 <= *t1;
+}
+
+/*  The point distance along the line, as SkPathMeasure::getSegment() finds
+    it. SkPathMeasure keeps the t of a line's end as 32767 / 32767, which it
+    evaluates as 32767 * 3.05185e-5f, a hair under 1; using the same scale
+    keeps dashed hairlines pixel-for-pixel the same as the dashed path's.
+ */
+static SkPoint point_on_line(const SkPoint line[2], SkScalar distance, SkScalar length) {
+    static const SkScalar kLineEndT = 32767 * 3.05185e-5f;
+    SkScalar t = SkScalarMulDiv(kLineEndT, distance, length);
+    SkPoint pt;
+    pt.set(SkScalarInterp(line[0].fX, line[1].fX, t),
+           SkScalarInterp(line[0].fY, line[1].fY, t));
+    return pt;
+}
+
+// Beyond this many dashes SkDashPath::FilterDashPath() gives up, so we do too.
+static const SkScalar kMaxDashCount = 1000000;
+
+bool SkDraw::drawDashedLines(const SkPath& path, const SkMatrix& matrix,
+                             const SkPaint& paint, bool drawCoverage) const {
+    SkPathEffect* pathEffect = paint.getPathEffect();
+    if (SkPaint::kStroke_Style != paint.getStyle() || NULL != paint.getMaskFilter() ||
+            NULL != paint.getRasterizer() || matrix.hasPerspective() ||
+            path.isInverseFillType() || !path.isFinite() ||
+            SkPath::kLine_SegmentMask != path.getSegmentMasks()) {
+        return false;
+    }
+
+    SkPathEffect::DashInfo info;
+    if (SkPathEffect::kDash_DashType != pathEffect->asADash(&info) || info.fCount < 2) {
+        return false;
+    }
+    SkAutoSTMalloc<8, SkScalar> intervals(info.fCount);
+    info.fIntervals = intervals.get();
+    pathEffect->asADash(&info);
+    DashWalker walker(intervals.get(), info.fCount, info.fPhase);
+    if (!(walker.intervalLength() > 0) || !SkScalarIsFinite(walker.intervalLength()) ||
+            info.fPhase < 0 || info.fPhase >= walker.intervalLength()) {
+        return false;
+    }
+
+    // Beyond hairlines, only butt-capped axis-aligned lines are handled: each
+    // of their dashes is a rect. Anything wider has joins and caps to draw.
+    const SkScalar width = paint.getStrokeWidth();
+    SkPoint line[2];
+    if (width > 0 && (SkPaint::kButt_Cap != paint.getStrokeCap() || !matrix.rectStaysRect() ||
+            !path.isLine(line) || (line[0].fX != line[1].fX && line[0].fY != line[1].fY))) {
+        return false;
+    }
+
+    // Closed contours dash across their start, so leave them to the path effect.
+    SkPath::RawIter iter(path);
+    SkPoint pts[4];
+    SkPath::Verb verb;
+    SkScalar length = 0;
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        if (SkPath::kClose_Verb == verb) {
+            return false;
+        }
+        if (SkPath::kLine_Verb == verb) {
+            length += SkPoint::Distance(pts[0], pts[1]);
+        }
+    }
+    if (length * (info.fCount >> 1) / walker.intervalLength() > kMaxDashCount) {
+        return false;
+    }
+
+    // Only dashes near the clip are visited.
+    const SkScalar radius = SkScalarHalf(width) * matrix.getMaxScale();
+    SkRect clipBounds = SkRect::Make(fRC->getBounds());
+    clipBounds.outset(SK_Scalar1 + radius, SK_Scalar1 + radius);
+
+    SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, paint, drawCoverage);
+    const bool doAA = paint.isAntiAlias();
+    SkPoint devPts[MAX_DEV_PTS];
+    int devCount = 0;
+
+    // Distances along each contour are accumulated as SkPathMeasure does,
+    // and dashes are placed on the local lines before mapping, as
+    // SkPathMeasure::getSegment() would place them.
+    SkScalar segStart = 0;
+    SkPoint segPt = { 0, 0 };
+    iter.setPath(path);
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        if (SkPath::kMove_Verb == verb) {
+            walker.restart();
+            segStart = 0;
+            segPt = pts[0];
+            continue;
+        }
+        SkASSERT(SkPath::kLine_Verb == verb);
+        const SkScalar segEnd = segStart + SkPoint::Distance(pts[0], pts[1]);
+        if (!(segEnd > segStart)) {
+            continue;   // too short to measure, so SkPathMeasure drops it
+        }
+        const SkPoint seg[2] = { segPt, pts[1] };
+        segPt = pts[1];
+        const SkScalar segLength = segEnd - segStart;
+        SkPoint dev[2];
+        matrix.mapPoints(dev, seg, 2);
+        SkScalar t0, t1;
+        if (clip_line_to_bounds(dev, clipBounds, &t0, &t1)) {
+            const double visibleEnd = segStart + t1 * segLength;
+            walker.skipTo(segStart + t0 * segLength);
+            while (walker.start() < visibleEnd) {
+                SkScalar d0 = SkMaxScalar(SkDoubleToScalar(walker.start()), segStart);
+                SkScalar d1 = SkMinScalar(SkDoubleToScalar(walker.end()), segEnd);
+                if (walker.isOn() && d0 < d1) {
+                    SkPoint ends[2];
+                    ends[0] = point_on_line(seg, d0 - segStart, segLength);
+                    ends[1] = point_on_line(seg, d1 - segStart, segLength);
+                    if (width > 0) {
+                        // A butt-capped dash on an axis-aligned line, as a rect.
+                        SkRect r;
+                        r.set(ends, 2);
+                        r.outset(seg[0].fX == seg[1].fX ? SkScalarHalf(width) : 0,
+                                 seg[0].fY == seg[1].fY ? SkScalarHalf(width) : 0);
+                        matrix.mapRect(&r);
+                        if (doAA) {
+                            SkScan::AntiFillRect(r, *fRC, blitter.get());
+                        } else {
+                            SkScan::FillRect(r, *fRC, blitter.get());
+                        }
+                    } else {
+                        if (devCount == MAX_DEV_PTS) {
+                            if (doAA) {
+                                SkScan::AntiHairLines(devPts, devCount, *fRC, blitter.get());
+                            } else {
+                                SkScan::HairLines(devPts, devCount, *fRC, blitter.get());
+                            }
+                            devCount = 0;
+                        }
+                        matrix.mapPoints(&devPts[devCount], ends, 2);
+                        devCount += 2;
+                    }
+                }
+                if (walker.end() > segEnd) {
+                    break;  // this interval carries on into the next line
+                }
+                walker.next();
+            }
+        }
+        segStart = segEnd;
+    }
+    if (doAA) {
+        SkScan::AntiHairLines(devPts, devCount, *fRC, blitter.get());
+    } else {
+        SkScan::HairLines(devPts, devCount, *fRC, blitter.get());
+    }
+    return true;
+}
+
+#endif
+
 void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& origPaint,
                       const SkMatrix* prePathMatrix, bool pathIsMutable,
                       bool drawCoverage) const {
@@ -1051,6 +1407,26 @@ void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& origPaint,
         }
     }
 
+    // A complex path drawn again at the same scale can reuse its coverage.
+    if (pathPtr == &origSrcPath) {
+        SkAutoTUnref<const SkPathMaskCache::Mask> cachedMask(
+                SkPathMaskCache::Find(origSrcPath, *matrix, *paint));
+        if (NULL != cachedMask.get()) {
+            SkAutoBlitterChoose blitter(*fBitmap, *fMatrix, *paint, drawCoverage);
+            cachedMask->draw(*matrix, *fRC, blitter.get());
+            return;
+        }
+    }
+
+#ifndef SK_DISABLE_DASHING_OPTIMIZATION
+    // Dashed lines are scan converted a dash at a time, without building the
+    // dashed path.
+    if (NULL != paint->getPathEffect() &&
+            this->drawDashedLines(*pathPtr, *matrix, *paint, drawCoverage)) {
+        return;
+    }
+#endif
+
     if (paint->getPathEffect() || paint->getStyle() != SkPaint::kFill_Style) {
         SkRect cullRect;
         const SkRect* cullRectPtr = NULL;
@@ -1302,7 +1678,7 @@ void SkDraw::drawSprite(const SkBitmap& bitmap, int x, int y,
     SkPaint paint(origPaint);
     paint.setStyle(SkPaint::kFill_Style);
 
-    if (NULL == paint.getColorFilter() && clipHandlesSprite(*fRC, x, y, bitmap)) {
+    if (clipHandlesSprite(*fRC, x, y, bitmap)) {
         SkTBlitterAllocator allocator;
         // blitter will be owned by the allocator.
         SkBlitter* blitter = SkBlitter::ChooseSprite(*fBitmap, paint, bitmap,
@@ -1495,11 +1871,12 @@ static bool needsRasterTextBlit(const SkDraw& draw) {
 }
 
 SkDraw1Glyph::Proc SkDraw1Glyph::init(const SkDraw* draw, SkBlitter* blitter, SkGlyphCache* cache,
-                                      const SkPaint& pnt) {
+                                      const SkPaint& pnt, SkMaskBatch* batch) {
     fDraw = draw;
     fBlitter = blitter;
     fCache = cache;
     fPaint = &pnt;
+    fBatch = batch;
 
     if (cache->isSubpixel()) {
         fHalfSampleX = fHalfSampleY = (SK_FixedHalf >> SkGlyph::kSubBits);
@@ -1509,6 +1886,7 @@ SkDraw1Glyph::Proc SkDraw1Glyph::init(const SkDraw* draw, SkBlitter* blitter, Sk
 
     if (hasCustomD1GProc(*draw)) {
         // todo: fix this assumption about clips w/ custom
+        fBatch = NULL;
         fClip = draw->fClip;
         fClipBounds = fClip->getBounds();
         return draw->fProcs->fD1GProc;
@@ -1606,8 +1984,11 @@ void SkDraw::drawText(const char text[], size_t byteLength,
     }
 
     SkAutoKern          autokern;
+    // declared after the blitter and glyph cache, so it flushes before they go away
+    SkMaskBatch         batch(blitter);
     SkDraw1Glyph        d1g;
-    SkDraw1Glyph::Proc  proc = d1g.init(this, blitter, cache, paint);
+    SkDraw1Glyph::Proc  proc = d1g.init(this, blitter, cache, paint,
+                                        blitter ? &batch : NULL);
 
     SkFixed fxMask = ~0;
     SkFixed fyMask = ~0;
@@ -1728,8 +2109,11 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
 
     const char*        stop = text + byteLength;
     SkTextAlignProc    alignProc(paint.getTextAlign());
+    // declared after the blitter and glyph cache, so it flushes before they go away
+    SkMaskBatch        batch(blitter);
     SkDraw1Glyph       d1g;
-    SkDraw1Glyph::Proc proc = d1g.init(this, blitter, cache, paint);
+    SkDraw1Glyph::Proc proc = d1g.init(this, blitter, cache, paint,
+                                       blitter ? &batch : NULL);
     SkTextMapStateProc tmsProc(*fMatrix, constY, scalarsPerPosition);
 
     if (cache->isSubpixel()) {
@@ -15,6 +15,44 @@
 class SkAAClip;
 class SkBlitter;
 
+/**
+ *  Collects the glyph masks of a text run and hands them to the blitter in
+ *  batches through SkBlitter::blitMasks(). The masks point into the glyph
+ *  cache, so the batch must be flushed (or destroyed) before the cache is
+ *  detached.
+ */
+class SkMaskBatch : SkNoncopyable {
+public:
+    explicit SkMaskBatch(SkBlitter* blitter) : fBlitter(blitter), fCount(0) {}
+    ~SkMaskBatch() { this->flush(); }
+
+    void add(const SkMask& mask, const SkIRect& clip) {
+        if (kMaxMasks == fCount) {
+            this->flush();
+        }
+        fMasks[fCount] = mask;
+        fClips[fCount] = clip;
+        fCount += 1;
+    }
+
+    void flush() {
+        if (fCount > 0) {
+            fBlitter->blitMasks(fMasks, fClips, fCount);
+            fCount = 0;
+        }
+    }
+
+private:
+    enum {
+        kMaxMasks = 32
+    };
+
+    SkBlitter*  fBlitter;
+    int         fCount;
+    SkMask      fMasks[kMaxMasks];
+    SkIRect     fClips[kMaxMasks];
+};
+
 struct SkDraw1Glyph {
     const SkDraw* fDraw;
     const SkRegion* fClip;
@@ -22,6 +60,8 @@ struct SkDraw1Glyph {
     SkBlitter* fBlitter;
     SkGlyphCache* fCache;
     const SkPaint* fPaint;
+    /** If not NULL, blitMask() queues its masks here instead of blitting. */
+    SkMaskBatch* fBatch;
     SkIRect fClipBounds;
     /** Half the sampling frequency of the rasterized glyph in x. */
     SkFixed fHalfSampleX;
@@ -38,14 +78,20 @@ struct SkDraw1Glyph {
     typedef void (*Proc)(const SkDraw1Glyph&, SkFixed x, SkFixed y, const SkGlyph&);
 
     Proc init(const SkDraw* draw, SkBlitter* blitter, SkGlyphCache* cache,
-              const SkPaint&);
+              const SkPaint&, SkMaskBatch* batch = NULL);
 
     // call this instead of fBlitter->blitMask() since this wrapper will handle
     // the case when the mask is ARGB32_Format
     //
     void blitMask(const SkMask& mask, const SkIRect& clip) const {
         if (SkMask::kARGB32_Format == mask.fFormat) {
+            if (fBatch) {
+                // keep the glyphs in order
+                fBatch->flush();
+            }
             this->blitMaskAsSprite(mask);
+        } else if (fBatch) {
+            fBatch->add(mask, clip);
         } else {
             fBlitter->blitMask(mask, clip);
         }
@@ -9,6 +9,7 @@
 
 #include "SkEdge.h"
 #include "SkFDot6.h"
+#include "SkGeometry.h"
 #include "SkMath.h"
 
 /*
@@ -132,38 +133,21 @@ void SkEdge::chopLineWithClip(const SkIRect& clip)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-/*  We store 1<<shift in a (signed) byte, so its maximum value is 1<<6 == 64.
-    Note that this limits the number of lines we use to approximate a curve.
-    If we need to increase this, we need to store fCurveCount in something
-    larger than int8_t.
+/*  Curves are flattened to within 1/2 of a (supersampled) pixel, using the
+    same Wang's formula bound as the other backends.
 */
-#define MAX_COEFF_SHIFT     6
-
-static inline SkFDot6 cheap_distance(SkFDot6 dx, SkFDot6 dy)
-{
-    dx = SkAbs32(dx);
-    dy = SkAbs32(dy);
-    // return max + min/2
-    if (dx > dy)
-        dx += dy >> 1;
-    else
-        dx = dy + (dx >> 1);
-    return dx;
+static SkScalar curve_tolerance(int shiftUp) {
+    return SK_ScalarHalf / (1 << shiftUp);
 }
 
-static inline int diff_to_shift(SkFDot6 dx, SkFDot6 dy)
-{
-    // cheap calc of distance from center of p0-p2 to the center of the curve
-    SkFDot6 dist = cheap_distance(dx, dy);
-
-    // shift down dist (it is currently in dot6)
-    // down by 5 should give us 1/2 pixel accuracy (assuming our dist is accurate...)
-    // this is chosen by heuristic: make it as big as possible (to minimize segments)
-    // ... but small enough so that our curves still look smooth
-    dist = (dist + (1 << 4)) >> 5;
+int SkQuadraticEdge::CurveShift(const SkPoint pts[3], int shiftUp) {
+    return SkQuadSubdivisionShift(pts, curve_tolerance(shiftUp),
+                                  kMaxCurveShift + kMaxCurveChops);
+}
 
-    // each subdivision (shift value) cuts this dist (error) by 1/4
-    return (32 - SkCLZ(dist)) >> 1;
+int SkCubicEdge::CurveShift(const SkPoint pts[4], int shiftUp) {
+    return SkCubicSubdivisionShift(pts, curve_tolerance(shiftUp),
+                                   kMaxCurveShift + kMaxCurveChops);
 }
 
 int SkQuadraticEdge::setQuadratic(const SkPoint pts[3], int shift)
@@ -197,17 +181,12 @@ int SkQuadraticEdge::setQuadratic(const SkPoint pts[3], int shift)
         return 0;
 
     // compute number of steps needed (1 << shift)
-    {
-        SkFDot6 dx = ((x1 << 1) - x0 - x2) >> 2;
-        SkFDot6 dy = ((y1 << 1) - y0 - y2) >> 2;
-        shift = diff_to_shift(dx, dy);
-        SkASSERT(shift >= 0);
-    }
+    shift = CurveShift(pts, shift);
     // need at least 1 subdivision for our bias trick
     if (shift == 0) {
         shift = 1;
-    } else if (shift > MAX_COEFF_SHIFT) {
-        shift = MAX_COEFF_SHIFT;
+    } else if (shift > kMaxCurveShift) {
+        shift = kMaxCurveShift;
     }
 
     fWinding    = SkToS8(winding);
@@ -300,22 +279,6 @@ static inline int SkFDot6UpShift(SkFDot6 x, int upShift) {
     return x << upShift;
 }
 
-/*  f(1/3) = (8a + 12b + 6c + d) / 27
-    f(2/3) = (a + 6b + 12c + 8d) / 27
-
-    f(1/3)-b = (8a - 15b + 6c + d) / 27
-    f(2/3)-c = (a + 6b - 15c + 8d) / 27
-
-    use 16/512 to approximate 1/27
-*/
-static SkFDot6 cubic_delta_from_line(SkFDot6 a, SkFDot6 b, SkFDot6 c, SkFDot6 d)
-{
-    SkFDot6 oneThird = ((a << 3) - ((b << 4) - b) + 6*c + d) * 19 >> 9;
-    SkFDot6 twoThird = (a + 6*b - ((c << 4) - c) + (d << 3)) * 19 >> 9;
-
-    return SkMax32(SkAbs32(oneThird), SkAbs32(twoThird));
-}
-
 int SkCubicEdge::setCubic(const SkPoint pts[4], const SkIRect* clip, int shift)
 {
     SkFDot6 x0, y0, x1, y1, x2, y2, x3, y3;
@@ -354,19 +317,12 @@ int SkCubicEdge::setCubic(const SkPoint pts[4], const SkIRect* clip, int shift)
         return 0;
 
     // compute number of steps needed (1 << shift)
-    {
-        // Can't use (center of curve - center of baseline), since center-of-curve
-        // need not be the max delta from the baseline (it could even be coincident)
-        // so we try just looking at the two off-curve points
-        SkFDot6 dx = cubic_delta_from_line(x0, x1, x2, x3);
-        SkFDot6 dy = cubic_delta_from_line(y0, y1, y2, y3);
-        // add 1 (by observation)
-        shift = diff_to_shift(dx, dy) + 1;
-    }
+    shift = CurveShift(pts, shift);
     // need at least 1 subdivision for our bias trick
-    SkASSERT(shift > 0);
-    if (shift > MAX_COEFF_SHIFT) {
-        shift = MAX_COEFF_SHIFT;
+    if (shift == 0) {
+        shift = 1;
+    } else if (shift > kMaxCurveShift) {
+        shift = kMaxCurveShift;
     }
 
     /*  Since our in coming data is initially shifted down by 10 (or 8 in
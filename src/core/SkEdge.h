@@ -24,6 +24,13 @@ struct SkEdge {
         kCubic_Type
     };
 
+    /*  fCurveCount holds 1 << shift in a signed byte, so one edge approximates
+        a curve with at most 1 << kMaxCurveShift lines. SkEdgeBuilder chops
+        curves that need more than that in half, up to kMaxCurveChops times.
+    */
+    static const int kMaxCurveShift = 6;
+    static const int kMaxCurveChops = 4;
+
     SkEdge* fNext;
     SkEdge* fPrev;
 
@@ -72,6 +79,11 @@ struct SkQuadraticEdge : public SkEdge {
 
     int setQuadratic(const SkPoint pts[3], int shiftUp);
     int updateQuadratic();
+
+    /** Return the shift setQuadratic() wants for pts, which may exceed
+        kMaxCurveShift by up to kMaxCurveChops.
+    */
+    static int CurveShift(const SkPoint pts[3], int shiftUp);
 };
 
 struct SkCubicEdge : public SkEdge {
@@ -83,6 +95,11 @@ struct SkCubicEdge : public SkEdge {
 
     int setCubic(const SkPoint pts[4], const SkIRect* clip, int shiftUp);
     int updateCubic();
+
+    /** Return the shift setCubic() wants for pts, which may exceed
+        kMaxCurveShift by up to kMaxCurveChops.
+    */
+    static int CurveShift(const SkPoint pts[4], int shiftUp);
 };
 
 int SkEdge::setLine(const SkPoint& p0, const SkPoint& p1, int shift) {
@@ -31,7 +31,23 @@ void SkEdgeBuilder::addLine(const SkPoint pts[]) {
     }
 }
 
+/*  A curve that needs more lines than one edge can step through is chopped in
+    half (each half needing a quarter of the lines), rather than being
+    flattened too coarsely, which shows up as facets on large curves.
+*/
 void SkEdgeBuilder::addQuad(const SkPoint pts[]) {
+    int chops = SkQuadraticEdge::CurveShift(pts, fShiftUp) - SkEdge::kMaxCurveShift;
+    this->addChoppedQuad(pts, chops);
+}
+
+void SkEdgeBuilder::addChoppedQuad(const SkPoint pts[], int chops) {
+    if (chops > 0) {
+        SkPoint tmp[5];
+        SkChopQuadAtHalf(pts, tmp);
+        this->addChoppedQuad(tmp, chops - 1);
+        this->addChoppedQuad(tmp + 2, chops - 1);
+        return;
+    }
     SkQuadraticEdge* edge = typedAllocThrow<SkQuadraticEdge>(fAlloc);
     if (edge->setQuadratic(pts, fShiftUp)) {
         fList.push(edge);
@@ -41,6 +57,18 @@ void SkEdgeBuilder::addQuad(const SkPoint pts[]) {
 }
 
 void SkEdgeBuilder::addCubic(const SkPoint pts[]) {
+    int chops = SkCubicEdge::CurveShift(pts, fShiftUp) - SkEdge::kMaxCurveShift;
+    this->addChoppedCubic(pts, chops);
+}
+
+void SkEdgeBuilder::addChoppedCubic(const SkPoint pts[], int chops) {
+    if (chops > 0) {
+        SkPoint tmp[7];
+        SkChopCubicAtHalf(pts, tmp);
+        this->addChoppedCubic(tmp, chops - 1);
+        this->addChoppedCubic(tmp + 3, chops - 1);
+        return;
+    }
     SkCubicEdge* edge = typedAllocThrow<SkCubicEdge>(fAlloc);
     if (edge->setCubic(pts, NULL, fShiftUp)) {
         fList.push(edge);
@@ -72,6 +100,48 @@ void SkEdgeBuilder::addClipper(SkEdgeClipper* clipper) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// NaN bounds are not outside, so such contours are left for the clipper to deal with.
+static bool outside_clip(const SkRect& bounds, const SkRect& clip) {
+    return bounds.fBottom <= clip.fTop || bounds.fTop >= clip.fBottom ||
+           bounds.fRight <= clip.fLeft || bounds.fLeft >= clip.fRight;
+}
+
+void SkEdgeBuilder::FindVisibleContours(const SkPath& path, const SkRect& clip,
+                                        SkTDArray<bool>* visible) {
+    SkPath::RawIter iter(path);
+    SkPoint         pts[4];
+    SkPath::Verb    verb;
+    SkRect          bounds = SkRect::MakeEmpty();
+    bool            inContour = false;
+
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kMove_Verb:
+                if (inContour) {
+                    *visible->append() = !outside_clip(bounds, clip);
+                }
+                bounds.set(pts[0].fX, pts[0].fY, pts[0].fX, pts[0].fY);
+                inContour = true;
+                break;
+            case SkPath::kLine_Verb:
+                bounds.growToInclude(pts[1].fX, pts[1].fY);
+                break;
+            case SkPath::kQuad_Verb:
+            case SkPath::kConic_Verb:
+                bounds.growToInclude(&pts[1], 2);
+                break;
+            case SkPath::kCubic_Verb:
+                bounds.growToInclude(&pts[1], 3);
+                break;
+            default:
+                break;
+        }
+    }
+    if (inContour) {
+        *visible->append() = !outside_clip(bounds, clip);
+    }
+}
+
 static void setShiftedClip(SkRect* dst, const SkIRect& src, int shift) {
     dst->set(SkIntToScalar(src.fLeft >> shift),
              SkIntToScalar(src.fTop >> shift),
@@ -105,8 +175,19 @@ int SkEdgeBuilder::buildPoly(const SkPath& path, const SkIRect* iclip,
     if (iclip) {
         SkRect clip;
         setShiftedClip(&clip, *iclip, shiftUp);
+        SkTDArray<bool> visible;
+        FindVisibleContours(path, clip, &visible);
+        int contour = -1;
+        bool skipContour = false;
 
         while ((verb = iter.next(pts, false)) != SkPath::kDone_Verb) {
+            if (SkPath::kMove_Verb == verb) {
+                SkASSERT(contour + 1 < visible.count());
+                skipContour = !visible[++contour];
+            }
+            if (skipContour) {
+                continue;
+            }
             switch (verb) {
                 case SkPath::kMove_Verb:
                 case SkPath::kClose_Verb:
@@ -181,8 +262,19 @@ int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip,
         SkRect clip;
         setShiftedClip(&clip, *iclip, shiftUp);
         SkEdgeClipper clipper;
+        SkTDArray<bool> visible;
+        FindVisibleContours(path, clip, &visible);
+        int contour = -1;
+        bool skipContour = false;
 
         while ((verb = iter.next(pts, false)) != SkPath::kDone_Verb) {
+            if (SkPath::kMove_Verb == verb) {
+                SkASSERT(contour + 1 < visible.count());
+                skipContour = !visible[++contour];
+            }
+            if (skipContour) {
+                continue;
+            }
             switch (verb) {
                 case SkPath::kMove_Verb:
                 case SkPath::kClose_Verb:
@@ -26,6 +26,16 @@ public:
 
     SkEdge** edgeList() { return fEdgeList; }
 
+    /**
+     *  Paths are walked with forceClose, so every contour is closed. A closed
+     *  contour wholly above, below, left or right of the clip adds no winding
+     *  inside it, so none of its segments need to be clipped or chopped.
+     *  Appends, for each contour in the order of its moveTo, whether it may
+     *  reach into the clip.
+     */
+    static void FindVisibleContours(const SkPath&, const SkRect& clip,
+                                    SkTDArray<bool>* visible);
+
 private:
     SkChunkAlloc        fAlloc;
     SkTDArray<SkEdge*>  fList;
@@ -40,6 +50,9 @@ private:
 
     int                 fShiftUp;
 
+    void addChoppedQuad(const SkPoint pts[], int chops);
+    void addChoppedCubic(const SkPoint pts[], int chops);
+
 public:
     void addLine(const SkPoint pts[]);
     void addQuad(const SkPoint pts[]);
@@ -201,7 +201,12 @@ bool SkEdgeClipper::clipQuad(const SkPoint srcPts[3], const SkRect& clip) {
     SkRect  bounds;
     bounds.set(srcPts, 3);
 
-    if (!quick_reject(bounds, clip)) {
+    if (quick_reject(bounds, clip)) {
+        // wholly above or below the clip, so it adds nothing
+    } else if (bounds.fRight <= clip.fLeft || bounds.fLeft >= clip.fRight) {
+        this->appendSideLine(srcPts[0].fY, srcPts[2].fY,
+                             bounds.fRight <= clip.fLeft ? clip.fLeft : clip.fRight, clip);
+    } else {
         SkPoint monoY[5];
         int countY = SkChopQuadAtYExtrema(srcPts, monoY);
         for (int y = 0; y <= countY; y++) {
@@ -409,7 +414,12 @@ bool SkEdgeClipper::clipCubic(const SkPoint srcPts[4], const SkRect& clip) {
     SkRect  bounds;
     bounds.set(srcPts, 4);
 
-    if (!quick_reject(bounds, clip)) {
+    if (quick_reject(bounds, clip)) {
+        // wholly above or below the clip, so it adds nothing
+    } else if (bounds.fRight <= clip.fLeft || bounds.fLeft >= clip.fRight) {
+        this->appendSideLine(srcPts[0].fY, srcPts[3].fY,
+                             bounds.fRight <= clip.fLeft ? clip.fLeft : clip.fRight, clip);
+    } else {
         SkPoint monoY[10];
         int countY = SkChopCubicAtYExtrema(srcPts, monoY);
         for (int y = 0; y <= countY; y++) {
@@ -431,6 +441,19 @@ bool SkEdgeClipper::clipCubic(const SkPoint srcPts[4], const SkRect& clip) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/*  A curve wholly to the left or right of the clip adds the same winding, at
+    every height, as a vertical line between its ends, whatever it does in
+    between. So it needn't be chopped into monotonic pieces to get there.
+ */
+void SkEdgeClipper::appendSideLine(SkScalar y0, SkScalar y1, SkScalar x,
+                                   const SkRect& clip) {
+    y0 = SkScalarPin(y0, clip.fTop, clip.fBottom);
+    y1 = SkScalarPin(y1, clip.fTop, clip.fBottom);
+    if (y0 != y1) {
+        this->appendVLine(x, y0, y1, false);
+    }
+}
+
 void SkEdgeClipper::appendVLine(SkScalar x, SkScalar y0, SkScalar y1,
                                 bool reverse) {
     *fCurrVerb++ = SkPath::kLine_Verb;
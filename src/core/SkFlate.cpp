@@ -17,6 +17,14 @@ bool SkFlate::Deflate(SkStream*, SkWStream*) { return false; }
 bool SkFlate::Deflate(const void*, size_t, SkWStream*) { return false; }
 bool SkFlate::Deflate(const SkData*, SkWStream*) { return false; }
 bool SkFlate::Inflate(SkStream*, SkWStream*) { return false; }
+
+struct SkDeflateWStream::Impl {};
+SkDeflateWStream::SkDeflateWStream(int, Strategy) : fImpl(NULL) {}
+SkDeflateWStream::~SkDeflateWStream() {}
+void SkDeflateWStream::reset(SkWStream*) {}
+bool SkDeflateWStream::finish() { return false; }
+bool SkDeflateWStream::write(const void*, size_t) { return false; }
+size_t SkDeflateWStream::bytesWritten() const { return 0; }
 #else
 
 // static
@@ -137,4 +145,134 @@ bool SkFlate::Inflate(SkStream* src, SkWStream* dst) {
     return doFlate(false, src, dst);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+struct SkDeflateWStream::Impl {
+    z_stream fZStream;
+    SkWStream* fOut;
+    size_t fInBytes;
+    bool fInitialized;
+    bool fOK;
+    uint8_t fOutBuffer[4 * kBufferSize];
+
+    // Runs deflate() over whatever is in fZStream.next_in, passing full
+    // output buffers on to fOut.  With Z_FINISH, keeps going to the end of
+    // the stream.
+    bool deflateInput(int flush) {
+        for (;;) {
+            int rc = deflate(&fZStream, flush);
+            if (Z_STREAM_ERROR == rc) {
+                return false;
+            }
+            size_t produced = sizeof(fOutBuffer) - fZStream.avail_out;
+            if (produced > 0 &&
+                (fZStream.avail_out == 0 || Z_FINISH == flush)) {
+                if (!fOut->write(fOutBuffer, produced)) {
+                    return false;
+                }
+                fZStream.next_out = fOutBuffer;
+                fZStream.avail_out = sizeof(fOutBuffer);
+            }
+            if (Z_FINISH == flush) {
+                if (Z_STREAM_END == rc) {
+                    return true;
+                }
+            } else if (fZStream.avail_in == 0) {
+                return true;
+            }
+        }
+    }
+};
+
+static int zlib_strategy(SkDeflateWStream::Strategy strategy) {
+    switch (strategy) {
+        case SkDeflateWStream::kFiltered_Strategy:
+            return Z_FILTERED;
+        case SkDeflateWStream::kHuffmanOnly_Strategy:
+            return Z_HUFFMAN_ONLY;
+        case SkDeflateWStream::kRLE_Strategy:
+            return Z_RLE;
+        default:
+            return Z_DEFAULT_STRATEGY;
+    }
+}
+
+SkDeflateWStream::SkDeflateWStream(int level, Strategy strategy)
+        : fImpl(SkNEW(Impl)) {
+    fImpl->fZStream.zalloc = NULL;
+    fImpl->fZStream.zfree = NULL;
+    fImpl->fZStream.opaque = NULL;
+    fImpl->fZStream.next_in = NULL;
+    fImpl->fZStream.avail_in = 0;
+    fImpl->fOut = NULL;
+    fImpl->fInBytes = 0;
+    fImpl->fInitialized = Z_OK == deflateInit2(&fImpl->fZStream, level,
+                                               Z_DEFLATED, MAX_WBITS, 8,
+                                               zlib_strategy(strategy));
+    fImpl->fOK = false;
+}
+
+SkDeflateWStream::~SkDeflateWStream() {
+    if (fImpl->fInitialized) {
+        deflateEnd(&fImpl->fZStream);
+    }
+    SkDELETE(fImpl);
+}
+
+void SkDeflateWStream::reset(SkWStream* dst) {
+    if (fImpl->fInitialized && NULL != fImpl->fOut) {
+        // Abandon the unfinished stream.
+        deflateReset(&fImpl->fZStream);
+    }
+    fImpl->fOut = dst;
+    fImpl->fInBytes = 0;
+    fImpl->fOK = fImpl->fInitialized && NULL != dst;
+    fImpl->fZStream.next_out = fImpl->fOutBuffer;
+    fImpl->fZStream.avail_out = sizeof(fImpl->fOutBuffer);
+}
+
+bool SkDeflateWStream::finish() {
+    if (NULL == fImpl->fOut) {
+        return false;
+    }
+    bool ok = fImpl->fOK;
+    if (ok) {
+        fImpl->fZStream.next_in = NULL;
+        fImpl->fZStream.avail_in = 0;
+        ok = fImpl->deflateInput(Z_FINISH);
+    }
+    // Ready for the next reset(), which then has nothing to abandon.
+    if (fImpl->fInitialized) {
+        deflateReset(&fImpl->fZStream);
+    }
+    fImpl->fOut = NULL;
+    fImpl->fOK = false;
+    return ok;
+}
+
+bool SkDeflateWStream::write(const void* buffer, size_t size) {
+    if (!fImpl->fOK) {
+        return false;
+    }
+    fImpl->fInBytes += size;
+    const uint8_t* input = static_cast<const uint8_t*>(buffer);
+    while (size > 0) {
+        // avail_in is only 32 bits wide.
+        const size_t chunk = SkTMin<size_t>(size, 1 << 30);
+        fImpl->fZStream.next_in = const_cast<uint8_t*>(input);
+        fImpl->fZStream.avail_in = SkToUInt(chunk);
+        if (!fImpl->deflateInput(Z_NO_FLUSH)) {
+            fImpl->fOK = false;
+            return false;
+        }
+        input += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+size_t SkDeflateWStream::bytesWritten() const {
+    return fImpl->fInBytes;
+}
+
 #endif
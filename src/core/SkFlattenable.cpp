@@ -72,6 +72,53 @@ struct Entry {
 static int gCount;
 static Entry gEntries[MAX_ENTRY_COUNT];
 
+/*
+ *  Deserializing looks entries up by name, and serializing by factory, so each
+ *  has an open addressed hash table of entry indices, kept up to date by
+ *  Register(). They are at most half full. A name registered again maps to
+ *  its latest entry, as with a search from the end of gEntries.
+ */
+#define INDEX_TABLE_SIZE  (2 * MAX_ENTRY_COUNT)
+#define EMPTY_SLOT        (-1)
+
+static int16_t gNameIndex[INDEX_TABLE_SIZE];
+static int16_t gFactoryIndex[INDEX_TABLE_SIZE];
+
+static uint32_t hash_name(const char name[]) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (; *name; ++name) {
+        hash = (hash ^ (uint8_t)*name) * 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t hash_factory(SkFlattenable::Factory factory) {
+    uintptr_t bits = (uintptr_t)factory;
+    uint32_t hash = (uint32_t)(bits ^ (bits >> 16 >> 16));
+    // Functions are aligned, so mix the low bits up from the rest.
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+static int name_slot(const char name[]) {
+    int slot = hash_name(name) & (INDEX_TABLE_SIZE - 1);
+    while (EMPTY_SLOT != gNameIndex[slot] && strcmp(gEntries[gNameIndex[slot]].fName, name)) {
+        slot = (slot + 1) & (INDEX_TABLE_SIZE - 1);
+    }
+    return slot;
+}
+
+static int factory_slot(SkFlattenable::Factory factory) {
+    int slot = hash_factory(factory) & (INDEX_TABLE_SIZE - 1);
+    while (EMPTY_SLOT != gFactoryIndex[slot] && gEntries[gFactoryIndex[slot]].fFactory != factory) {
+        slot = (slot + 1) & (INDEX_TABLE_SIZE - 1);
+    }
+    return slot;
+}
+
 void SkFlattenable::Register(const char name[], Factory factory, SkFlattenable::Type type) {
     SkASSERT(name);
     SkASSERT(factory);
@@ -79,6 +126,9 @@ void SkFlattenable::Register(const char name[], Factory factory, SkFlattenable::
     static bool gOnce = false;
     if (!gOnce) {
         gCount = 0;
+        for (int i = 0; i < INDEX_TABLE_SIZE; ++i) {
+            gNameIndex[i] = gFactoryIndex[i] = EMPTY_SLOT;
+        }
         gOnce = true;
     }
 
@@ -87,6 +137,8 @@ void SkFlattenable::Register(const char name[], Factory factory, SkFlattenable::
     gEntries[gCount].fName = name;
     gEntries[gCount].fFactory = factory;
     gEntries[gCount].fType = type;
+    gNameIndex[name_slot(name)] = gCount;
+    gFactoryIndex[factory_slot(factory)] = gCount;
     gCount += 1;
 }
 
@@ -100,18 +152,21 @@ static void report_no_entries(const char* functionName) {
 }
 #endif
 
+static const Entry* find_name(const char name[]) {
+    if (0 == gCount) {
+        return NULL;
+    }
+    int index = gNameIndex[name_slot(name)];
+    return EMPTY_SLOT == index ? NULL : &gEntries[index];
+}
+
 SkFlattenable::Factory SkFlattenable::NameToFactory(const char name[]) {
     InitializeFlattenablesIfNeeded();
 #ifdef SK_DEBUG
     report_no_entries(__FUNCTION__);
 #endif
-    const Entry* entries = gEntries;
-    for (int i = gCount - 1; i >= 0; --i) {
-        if (strcmp(entries[i].fName, name) == 0) {
-            return entries[i].fFactory;
-        }
-    }
-    return NULL;
+    const Entry* entry = find_name(name);
+    return entry ? entry->fFactory : NULL;
 }
 
 bool SkFlattenable::NameToType(const char name[], SkFlattenable::Type* type) {
@@ -120,14 +175,12 @@ bool SkFlattenable::NameToType(const char name[], SkFlattenable::Type* type) {
 #ifdef SK_DEBUG
     report_no_entries(__FUNCTION__);
 #endif
-    const Entry* entries = gEntries;
-    for (int i = gCount - 1; i >= 0; --i) {
-        if (strcmp(entries[i].fName, name) == 0) {
-            *type = entries[i].fType;
-            return true;
-        }
+    const Entry* entry = find_name(name);
+    if (NULL == entry) {
+        return false;
     }
-    return false;
+    *type = entry->fType;
+    return true;
 }
 
 const char* SkFlattenable::FactoryToName(Factory fact) {
@@ -135,11 +188,9 @@ const char* SkFlattenable::FactoryToName(Factory fact) {
 #ifdef SK_DEBUG
     report_no_entries(__FUNCTION__);
 #endif
-    const Entry* entries = gEntries;
-    for (int i = gCount - 1; i >= 0; --i) {
-        if (entries[i].fFactory == fact) {
-            return entries[i].fName;
-        }
+    if (0 == gCount) {
+        return NULL;
     }
-    return NULL;
+    int index = gFactoryIndex[factory_slot(fact)];
+    return EMPTY_SLOT == index ? NULL : gEntries[index].fName;
 }
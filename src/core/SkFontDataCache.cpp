@@ -0,0 +1,168 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkFontDataCache.h"
+#include "SkChecksum.h"
+#include "SkData.h"
+#include "SkStream.h"
+#include "SkTemplates.h"
+#include "SkThread.h"
+#include "SkTLRUByteCache.h"
+#include "SkTypeface.h"
+
+#ifndef SK_DEFAULT_FONT_DATA_CACHE_LIMIT
+    #define SK_DEFAULT_FONT_DATA_CACHE_LIMIT    (8 * 1024 * 1024)
+#endif
+
+namespace {
+
+typedef SkFontDataCache::ID ID;
+
+struct Rec {
+    Rec(const ID& id, SkData* data, SkTypeface* typeface)
+        : fID(id)
+        , fData(SkRef(data))
+        , fTypeface(SkRef(typeface)) {}
+    ~Rec() {
+        fData->unref();
+        fTypeface->unref();
+    }
+
+    static const ID& GetKey(const Rec& rec) { return rec.fID; }
+    static uint32_t Hash(const ID& id) { return id.fHash[0]; }
+
+    size_t bytesUsed() const {
+        return sizeof(*this) + fData->size();
+    }
+
+    const ID           fID;
+    SkData* const      fData;
+    SkTypeface* const  fTypeface;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Rec);
+};
+
+typedef SkTLRUByteCache<Rec, ID> Cache;
+
+bool same_data(const SkData* a, const SkData* b) {
+    return a->size() == b->size() && 0 == memcmp(a->data(), b->data(), a->size());
+}
+
+}  // namespace
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+static Cache* gFontDataCache = NULL;
+static void cleanup_gFontDataCache() {
+#if SK_DEVELOPER
+    SkDELETE(gFontDataCache);
+#endif
+}
+
+/** Must hold gMutex when calling. */
+static Cache* get_cache() {
+    gMutex.assertHeld();
+    if (NULL == gFontDataCache) {
+        gFontDataCache = SkNEW_ARGS(Cache, (SK_DEFAULT_FONT_DATA_CACHE_LIMIT));
+        atexit(cleanup_gFontDataCache);
+    }
+    return gFontDataCache;
+}
+
+/**
+ *  Must hold gMutex when calling. Returns the cached typeface for id, ref()ed, if its data is the
+ *  same as data, or else NULL.
+ */
+static SkTypeface* find_same(const SkFontDataCache::ID& id, const SkData* data, bool pin) {
+    Rec* rec = get_cache()->find(id);
+    if (NULL == rec || !same_data(rec->fData, data)) {
+        return NULL;
+    }
+    if (pin) {
+        get_cache()->pin(rec);
+    }
+    return SkRef(rec->fTypeface);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkFontDataCache::ID SkFontDataCache::ComputeID(const SkData* data) {
+    const size_t length = data->size();
+    const size_t alignedLength = length & ~3;
+
+    // Murmur3 needs whole, aligned words. Data from the heap is aligned; a subset may not be.
+    const uint32_t* words = static_cast<const uint32_t*>(data->data());
+    SkAutoTMalloc<uint32_t> storage;
+    if (!SkIsAlign4(reinterpret_cast<uintptr_t>(words))) {
+        storage.reset(alignedLength / sizeof(uint32_t));
+        memcpy(storage.get(), words, alignedLength);
+        words = storage.get();
+    }
+
+    // Fold the last few bytes into the seed.
+    uint32_t tail = 0;
+    memcpy(&tail, data->bytes() + alignedLength, length - alignedLength);
+
+    ID id;
+    id.fHash[0] = SkChecksum::Murmur3(words, alignedLength, tail);
+    id.fHash[1] = SkChecksum::Murmur3(words, alignedLength, ~tail);
+    id.fLength = SkToU32(length);
+    return id;
+}
+
+SkTypeface* SkFontDataCache::FindOrCreate(SkData* data, bool pin) {
+    const ID id = ComputeID(data);
+    {
+        SkAutoMutexAcquire am(gMutex);
+        if (SkTypeface* cached = find_same(id, data, pin)) {
+            return cached;
+        }
+    }
+
+    // Make the typeface without holding the lock; font hosts may take locks of their own.
+    SkAutoTUnref<SkMemoryStream> stream(SkNEW_ARGS(SkMemoryStream, (data)));
+    SkAutoTUnref<SkTypeface> typeface(SkTypeface::CreateFromStream(stream.get()));
+    if (NULL == typeface.get()) {
+        return NULL;
+    }
+
+    SkAutoMutexAcquire am(gMutex);
+    if (SkTypeface* cached = find_same(id, data, pin)) {
+        // Another thread got there first; share its typeface.
+        return cached;
+    }
+    // Unless the ID collided with different data, which then goes uncached.
+    if (NULL == get_cache()->find(id)) {
+        get_cache()->add(SkNEW_ARGS(Rec, (id, data, typeface.get())), pin);
+    }
+    return typeface.detach();
+}
+
+SkTypeface* SkFontDataCache::Find(const ID& id) {
+    SkAutoMutexAcquire am(gMutex);
+    Rec* rec = get_cache()->find(id);
+    return NULL == rec ? NULL : SkRef(rec->fTypeface);
+}
+
+size_t SkFontDataCache::GetBytesUsed() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->bytesUsed();
+}
+
+size_t SkFontDataCache::GetByteLimit() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->byteLimit();
+}
+
+size_t SkFontDataCache::SetByteLimit(size_t newLimit) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->setByteLimit(newLimit);
+}
+
+void SkFontDataCache::Purge() {
+    SkAutoMutexAcquire am(gMutex);
+    get_cache()->purgeAll();
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkFontDataCache_DEFINED
+#define SkFontDataCache_DEFINED
+
+#include "SkTypes.h"
+
+class SkData;
+class SkTypeface;
+
+/**
+ *  A global cache of the typefaces made from font data that came in a stream, such as the web
+ *  fonts embedded in SKPs and sent through pipes, found by the content of that data. Every copy
+ *  of a font that is deserialized, from however many pictures or pipes, then shares one typeface,
+ *  and so one glyph cache; and a pipe reader can find a font that an earlier pipe sent from its
+ *  ID alone.
+ *
+ *  Entries are dropped least recently used first once their data adds up to more than the byte
+ *  limit. Pinned entries don't count towards the limit, and stay until Purge().
+ *
+ *  The static methods are thread-safe.
+ */
+class SkFontDataCache {
+public:
+    /**
+     *  Identifies font data by its content: its length and two hashes of it.
+     */
+    struct ID {
+        uint32_t fHash[2];
+        uint32_t fLength;
+
+        bool operator==(const ID& other) const {
+            return fHash[0] == other.fHash[0] && fHash[1] == other.fHash[1] &&
+                   fLength == other.fLength;
+        }
+    };
+
+    static ID ComputeID(const SkData* data);
+
+    /**
+     *  Return the typeface for the font in data, ref()ed: the cached one if the same data was
+     *  seen before, or else one made from data and cached. Returns NULL if no typeface could be
+     *  made from data.
+     *  @param pin Keep the entry until Purge(), whatever the byte limit.
+     */
+    static SkTypeface* FindOrCreate(SkData* data, bool pin = false);
+
+    /**
+     *  Return the cached typeface whose font data has this ID, ref()ed, or NULL if there is none.
+     */
+    static SkTypeface* Find(const ID&);
+
+    static size_t GetBytesUsed();
+    static size_t GetByteLimit();
+    static size_t SetByteLimit(size_t newLimit);
+
+    /** Remove every entry from the cache, pinned or not. */
+    static void Purge();
+};
+
+#endif
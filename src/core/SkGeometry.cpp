@@ -8,6 +8,12 @@
 #include "SkGeometry.h"
 #include "SkMatrix.h"
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+    #include <arm_neon.h>
+#endif
+
 bool SkXRayCrossesLine(const SkXRay& pt,
                        const SkPoint pts[2],
                        bool* ambiguous) {
@@ -1006,6 +1012,165 @@ int SkNumXRayCrossingsForCubic(const SkXRay& pt,
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/*  Wang's formula: a degree d curve flattened into n equal steps in t stays
+    within tol of its chords when
+
+        n^2 >= d(d - 1)/8 * max|p[i] - 2p[i+1] + p[i+2]| / tol
+*/
+static SkScalar second_difference_length(const SkPoint& a, const SkPoint& b,
+                                         const SkPoint& c) {
+    return SkPoint::Length(a.fX - b.fX - b.fX + c.fX, a.fY - b.fY - b.fY + c.fY);
+}
+
+static SkScalar quad_segments_sqd(const SkPoint src[3], SkScalar tol) {
+    SkASSERT(tol > 0);
+    return second_difference_length(src[0], src[1], src[2]) / (4 * tol);
+}
+
+static SkScalar cubic_segments_sqd(const SkPoint src[4], SkScalar tol) {
+    SkASSERT(tol > 0);
+    SkScalar diff = SkMaxScalar(second_difference_length(src[0], src[1], src[2]),
+                                second_difference_length(src[1], src[2], src[3]));
+    return diff * 3 / (4 * tol);
+}
+
+static int subdivision_count(SkScalar nSqd, int maxCount) {
+    // Also catches NaN.
+    if (!(nSqd < SkIntToScalar(maxCount) * maxCount)) {
+        return maxCount;
+    }
+    return SkMax32(SkScalarCeilToInt(SkScalarSqrt(nSqd)), 1);
+}
+
+// Each halving of the step divides the error by 4, so we want the smallest
+// shift with 4^shift >= n^2.
+static int subdivision_shift(SkScalar nSqd, int maxShift) {
+    if (!SkScalarIsFinite(nSqd)) {
+        return maxShift;
+    }
+    int shift = 0;
+    while (nSqd > SK_Scalar1 && shift < maxShift) {
+        nSqd *= SK_Scalar1 / 4;
+        shift += 1;
+    }
+    return shift;
+}
+
+int SkQuadSubdivisionCount(const SkPoint src[3], SkScalar tol, int maxCount) {
+    return subdivision_count(quad_segments_sqd(src, tol), maxCount);
+}
+
+int SkCubicSubdivisionCount(const SkPoint src[4], SkScalar tol, int maxCount) {
+    return subdivision_count(cubic_segments_sqd(src, tol), maxCount);
+}
+
+int SkQuadSubdivisionShift(const SkPoint src[3], SkScalar tol, int maxShift) {
+    return subdivision_shift(quad_segments_sqd(src, tol), maxShift);
+}
+
+int SkCubicSubdivisionShift(const SkPoint src[4], SkScalar tol, int maxShift) {
+    return subdivision_shift(cubic_segments_sqd(src, tol), maxShift);
+}
+
+/*  Both evaluators use the polynomial form, so each point costs a few
+    multiply-adds and no point depends on the previous one (unlike forward
+    differencing, error does not accumulate). The SIMD loops compute the same
+    expressions in the same order as the scalar tails, so all points of a curve
+    are rounded alike.
+*/
+void SkEvalQuadUniform(const SkPoint src[3], int count, SkPoint dst[]) {
+    SkASSERT(count > 0);
+
+    // A t^2 + B t + C
+    const SkScalar ax = src[0].fX - src[1].fX - src[1].fX + src[2].fX;
+    const SkScalar ay = src[0].fY - src[1].fY - src[1].fY + src[2].fY;
+    const SkScalar bx = 2 * (src[1].fX - src[0].fX);
+    const SkScalar by = 2 * (src[1].fY - src[0].fY);
+    const SkScalar cx = src[0].fX;
+    const SkScalar cy = src[0].fY;
+    const SkScalar dt = SK_Scalar1 / count;
+
+    int i = 1;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 A = _mm_setr_ps(ax, ay, ax, ay);
+    const __m128 B = _mm_setr_ps(bx, by, bx, by);
+    const __m128 C = _mm_setr_ps(cx, cy, cx, cy);
+    const __m128 DT = _mm_set1_ps(dt);
+    for (; i + 1 < count; i += 2) {
+        __m128 t = _mm_mul_ps(_mm_setr_ps(i, i, i + 1, i + 1), DT);
+        __m128 p = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(A, t), B), t), C);
+        _mm_storeu_ps(&dst[i - 1].fX, p);
+    }
+#elif defined(__ARM_NEON__)
+    for (; i + 3 < count; i += 4) {
+        const float ti[4] = { i, i + 1, i + 2, i + 3 };
+        float32x4_t t = vmulq_n_f32(vld1q_f32(ti), dt);
+        float32x4x2_t p;
+        p.val[0] = vaddq_f32(vmulq_f32(vaddq_f32(vmulq_n_f32(t, ax), vdupq_n_f32(bx)), t),
+                             vdupq_n_f32(cx));
+        p.val[1] = vaddq_f32(vmulq_f32(vaddq_f32(vmulq_n_f32(t, ay), vdupq_n_f32(by)), t),
+                             vdupq_n_f32(cy));
+        vst2q_f32(&dst[i - 1].fX, p);
+    }
+#endif
+    for (; i < count; ++i) {
+        SkScalar t = i * dt;
+        dst[i - 1].set((ax * t + bx) * t + cx, (ay * t + by) * t + cy);
+    }
+    dst[count - 1] = src[2];
+}
+
+void SkEvalCubicUniform(const SkPoint src[4], int count, SkPoint dst[]) {
+    SkASSERT(count > 0);
+
+    // A t^3 + B t^2 + C t + D
+    const SkScalar ax = src[3].fX + 3 * (src[1].fX - src[2].fX) - src[0].fX;
+    const SkScalar ay = src[3].fY + 3 * (src[1].fY - src[2].fY) - src[0].fY;
+    const SkScalar bx = 3 * (src[0].fX - src[1].fX - src[1].fX + src[2].fX);
+    const SkScalar by = 3 * (src[0].fY - src[1].fY - src[1].fY + src[2].fY);
+    const SkScalar cx = 3 * (src[1].fX - src[0].fX);
+    const SkScalar cy = 3 * (src[1].fY - src[0].fY);
+    const SkScalar dx = src[0].fX;
+    const SkScalar dy = src[0].fY;
+    const SkScalar dt = SK_Scalar1 / count;
+
+    int i = 1;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 A = _mm_setr_ps(ax, ay, ax, ay);
+    const __m128 B = _mm_setr_ps(bx, by, bx, by);
+    const __m128 C = _mm_setr_ps(cx, cy, cx, cy);
+    const __m128 D = _mm_setr_ps(dx, dy, dx, dy);
+    const __m128 DT = _mm_set1_ps(dt);
+    for (; i + 1 < count; i += 2) {
+        __m128 t = _mm_mul_ps(_mm_setr_ps(i, i, i + 1, i + 1), DT);
+        __m128 p = _mm_add_ps(_mm_mul_ps(A, t), B);
+        p = _mm_add_ps(_mm_mul_ps(p, t), C);
+        p = _mm_add_ps(_mm_mul_ps(p, t), D);
+        _mm_storeu_ps(&dst[i - 1].fX, p);
+    }
+#elif defined(__ARM_NEON__)
+    for (; i + 3 < count; i += 4) {
+        const float ti[4] = { i, i + 1, i + 2, i + 3 };
+        float32x4_t t = vmulq_n_f32(vld1q_f32(ti), dt);
+        float32x4x2_t p;
+        p.val[0] = vaddq_f32(vmulq_n_f32(t, ax), vdupq_n_f32(bx));
+        p.val[0] = vaddq_f32(vmulq_f32(p.val[0], t), vdupq_n_f32(cx));
+        p.val[0] = vaddq_f32(vmulq_f32(p.val[0], t), vdupq_n_f32(dx));
+        p.val[1] = vaddq_f32(vmulq_n_f32(t, ay), vdupq_n_f32(by));
+        p.val[1] = vaddq_f32(vmulq_f32(p.val[1], t), vdupq_n_f32(cy));
+        p.val[1] = vaddq_f32(vmulq_f32(p.val[1], t), vdupq_n_f32(dy));
+        vst2q_f32(&dst[i - 1].fX, p);
+    }
+#endif
+    for (; i < count; ++i) {
+        SkScalar t = i * dt;
+        dst[i - 1].set(((ax * t + bx) * t + cx) * t + dx, ((ay * t + by) * t + cy) * t + dy);
+    }
+    dst[count - 1] = src[3];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 /*  Find t value for quadratic [a, b, c] = d.
     Return 0 if there is no solution within [0, 1)
 */
@@ -12,10 +12,14 @@
 #include "SkDistanceFieldGen.h"
 #include "SkGraphics.h"
 #include "SkLazyPtr.h"
+#include "SkPackBits.h"
 #include "SkPaint.h"
 #include "SkPath.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkTLS.h"
+#include "SkTraceEvent.h"
+#include "SkTSort.h"
 #include "SkTypeface.h"
 
 //#define SPEW_PURGE_STATUS
@@ -73,6 +77,14 @@ static SkGlyphCache_Globals& getGlobals() {
 #define kMinGlyphImageSize  (16*2)
 #define kMinAllocAmount     ((sizeof(SkGlyph) + kMinGlyphImageSize) * kMinGlyphCount)
 
+// Strikes whose ascent to descent is this many pixels or more are large.
+#ifndef SK_FONT_CACHE_LARGE_STRIKE_HEIGHT
+    #define SK_FONT_CACHE_LARGE_STRIKE_HEIGHT   48
+#endif
+
+// A8 images at least this big are kept compressed, if that saves a quarter.
+static const size_t kMinCompressedImageSize = 1024;
+
 SkGlyphCache::SkGlyphCache(SkTypeface* typeface, const SkDescriptor* desc, SkScalerContext* ctx)
         : fScalerContext(ctx), fGlyphAlloc(kMinAllocAmount) {
     SkASSERT(typeface);
@@ -94,6 +106,16 @@ SkGlyphCache::SkGlyphCache(SkTypeface* typeface, const SkDescriptor* desc, SkSca
     fGlyphArray.setReserve(kMinGlyphCount);
 
     fAuxProcList = NULL;
+
+    fIsLargeStrike = SkMask::kARGB32_Format == ctx->getMaskFormat() ||
+                     fFontMetrics.fDescent - fFontMetrics.fAscent >=
+                             SkIntToScalar(SK_FONT_CACHE_LARGE_STRIKE_HEIGHT);
+
+    fGlyphHits = fGlyphMisses = 0;
+    fImageHits = fImageMisses = 0;
+
+    fScratchGlyph = NULL;
+    fScratchImageSize = 0;
 }
 
 SkGlyphCache::~SkGlyphCache() {
@@ -176,6 +198,8 @@ const SkGlyph& SkGlyphCache::getUnicharAdvance(SkUnichar charCode) {
         // this ID is based on the glyph index
         id = SkGlyph::MakeID(fScalerContext->charToGlyphID(charCode));
         rec->fGlyph = this->lookupMetrics(id, kJustAdvance_MetricsType);
+    } else {
+        fGlyphHits += 1;
     }
     return *rec->fGlyph;
 }
@@ -189,6 +213,8 @@ const SkGlyph& SkGlyphCache::getGlyphIDAdvance(uint16_t glyphID) {
     if (NULL == glyph || glyph->fID != id) {
         glyph = this->lookupMetrics(glyphID, kJustAdvance_MetricsType);
         fGlyphHash[index] = glyph;
+    } else {
+        fGlyphHits += 1;
     }
     return *glyph;
 }
@@ -211,6 +237,9 @@ const SkGlyph& SkGlyphCache::getUnicharMetrics(SkUnichar charCode) {
         RecordHashSuccess();
         if (rec->fGlyph->isJustAdvance()) {
             fScalerContext->getMetrics(rec->fGlyph);
+            fGlyphMisses += 1;
+        } else {
+            fGlyphHits += 1;
         }
     }
     SkASSERT(rec->fGlyph->isFullMetrics());
@@ -234,6 +263,9 @@ const SkGlyph& SkGlyphCache::getUnicharMetrics(SkUnichar charCode,
         RecordHashSuccess();
         if (rec->fGlyph->isJustAdvance()) {
             fScalerContext->getMetrics(rec->fGlyph);
+            fGlyphMisses += 1;
+        } else {
+            fGlyphHits += 1;
         }
     }
     SkASSERT(rec->fGlyph->isFullMetrics());
@@ -254,6 +286,9 @@ const SkGlyph& SkGlyphCache::getGlyphIDMetrics(uint16_t glyphID) {
         RecordHashSuccess();
         if (glyph->isJustAdvance()) {
             fScalerContext->getMetrics(glyph);
+            fGlyphMisses += 1;
+        } else {
+            fGlyphHits += 1;
         }
     }
     SkASSERT(glyph->isFullMetrics());
@@ -275,6 +310,9 @@ const SkGlyph& SkGlyphCache::getGlyphIDMetrics(uint16_t glyphID,
         RecordHashSuccess();
         if (glyph->isJustAdvance()) {
             fScalerContext->getMetrics(glyph);
+            fGlyphMisses += 1;
+        } else {
+            fGlyphHits += 1;
         }
     }
     SkASSERT(glyph->isFullMetrics());
@@ -282,6 +320,30 @@ const SkGlyph& SkGlyphCache::getGlyphIDMetrics(uint16_t glyphID,
 }
 
 SkGlyph* SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
+    bool added;
+    SkGlyph* glyph = this->findOrAddGlyph(id, &added);
+
+    if (kJustAdvance_MetricsType == mtype) {
+        if (added) {
+            fScalerContext->getAdvance(glyph);
+            fGlyphMisses += 1;
+        } else {
+            fGlyphHits += 1;
+        }
+    } else {
+        SkASSERT(kFull_MetricsType == mtype);
+        if (glyph->isJustAdvance()) {
+            fScalerContext->getMetrics(glyph);
+            fGlyphMisses += 1;
+        } else {
+            fGlyphHits += 1;
+        }
+    }
+
+    return glyph;
+}
+
+SkGlyph* SkGlyphCache::findOrAddGlyph(uint32_t id, bool* added) {
     SkGlyph* glyph;
 
     int     hi = 0;
@@ -302,9 +364,7 @@ SkGlyph* SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
         }
         glyph = gptr[hi];
         if (glyph->fID == id) {
-            if (kFull_MetricsType == mtype && glyph->isJustAdvance()) {
-                fScalerContext->getMetrics(glyph);
-            }
+            *added = false;
             return glyph;
         }
 
@@ -321,21 +381,43 @@ SkGlyph* SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
                                         SkChunkAlloc::kThrow_AllocFailType);
     glyph->init(id);
     *fGlyphArray.insert(hi) = glyph;
-
-    if (kJustAdvance_MetricsType == mtype) {
-        fScalerContext->getAdvance(glyph);
-    } else {
-        SkASSERT(kFull_MetricsType == mtype);
-        fScalerContext->getMetrics(glyph);
-    }
-
+    *added = true;
     return glyph;
 }
 
 const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
     if (glyph.fWidth > 0 && glyph.fWidth < kMaxGlyphWidth) {
-        if (NULL == glyph.fImage) {
-            size_t  size = glyph.computeImageSize();
+        if (NULL != glyph.fImage) {
+            fImageHits += 1;
+            return glyph.fImage;
+        }
+
+        TRACE_EVENT0("skia", "SkGlyphCache::findImage");
+        size_t  size = glyph.computeImageSize();
+        const CompressedImage* compressed = NULL;
+        if (fCompressedImages.count() > 0) {
+            compressed = fCompressedImages.find(glyph.fID);
+        }
+        if (NULL != compressed) {
+            void* image = this->useScratchImage(glyph, size);
+            SkPackBits::Unpack8(compressed->data(), compressed->fSize, (uint8_t*)image);
+            const_cast<SkGlyph&>(glyph).fImage = image;
+            fImageHits += 1;
+        } else if (SkMask::kA8_Format == glyph.fMaskFormat && size >= kMinCompressedImageSize) {
+            // Generate into the scratch image, and keep it there if it compresses.
+            const_cast<SkGlyph&>(glyph).fImage = this->useScratchImage(glyph, size);
+            fScalerContext->getImage(glyph);
+            fImageMisses += 1;
+            if (!this->compressImage(glyph)) {
+                void* image = fGlyphAlloc.alloc(size, SkChunkAlloc::kReturnNil_AllocFailType);
+                if (NULL != image) {
+                    memcpy(image, glyph.fImage, size);
+                    fMemoryUsed += size;
+                }
+                fScratchGlyph = NULL;
+                const_cast<SkGlyph&>(glyph).fImage = image;
+            }
+        } else {
             const_cast<SkGlyph&>(glyph).fImage = fGlyphAlloc.alloc(size,
                                         SkChunkAlloc::kReturnNil_AllocFailType);
             // check that alloc() actually succeeded
@@ -346,12 +428,53 @@ const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
                 // overallocated the buffer. Check if the new computedImageSize
                 // is smaller, and if so, strink the alloc size in fImageAlloc.
                 fMemoryUsed += size;
+                fImageMisses += 1;
             }
         }
     }
     return glyph.fImage;
 }
 
+void* SkGlyphCache::useScratchImage(const SkGlyph& glyph, size_t size) {
+    // Only one glyph at a time may point at the scratch image.
+    if (NULL != fScratchGlyph) {
+        const_cast<SkGlyph*>(fScratchGlyph)->fImage = NULL;
+    }
+    fScratchGlyph = &glyph;
+    if (size > fScratchImageSize) {
+        fMemoryUsed += size - fScratchImageSize;
+        fScratchImageSize = size;
+    }
+    return fScratchImage.reset(fScratchImageSize, SkAutoMalloc::kReuse_OnShrink);
+}
+
+bool SkGlyphCache::compressImage(const SkGlyph& glyph) {
+    if (SkMask::kA8_Format != glyph.fMaskFormat) {
+        // getImage() may have changed the format.
+        return false;
+    }
+    const int size = SkToInt(glyph.computeImageSize());
+    SkAutoSMalloc<4096> packed(SkPackBits::ComputeMaxSize8(size));
+    size_t packedSize = SkPackBits::Pack8((const uint8_t*)glyph.fImage, size,
+                                          (uint8_t*)packed.get());
+    if (packedSize > (size_t)(size - (size >> 2))) {
+        return false;
+    }
+
+    size_t allocSize = sizeof(CompressedImage) + packedSize;
+    CompressedImage* compressed = (CompressedImage*)fGlyphAlloc.alloc(allocSize,
+                                        SkChunkAlloc::kReturnNil_AllocFailType);
+    if (NULL == compressed) {
+        return false;
+    }
+    compressed->fID = glyph.fID;
+    compressed->fSize = SkToU32(packedSize);
+    memcpy(compressed->data(), packed.get(), packedSize);
+    fCompressedImages.add(compressed);
+    fMemoryUsed += allocSize;
+    return true;
+}
+
 const SkPath* SkGlyphCache::findPath(const SkGlyph& glyph) {
     if (glyph.fWidth) {
         if (glyph.fPath == NULL) {
@@ -405,6 +528,198 @@ const void* SkGlyphCache::findDistanceField(const SkGlyph& glyph) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Fewer new glyphs than this are generated faster on the calling thread than
+// it takes to open a face for each worker.
+static const int kMinGlyphsToPrepareInParallel = 32;
+
+namespace {
+
+struct GlyphIDLessThan {
+    bool operator()(const SkGlyph* a, const SkGlyph* b) const { return a->fID < b->fID; }
+};
+
+// The glyphs handed to the workers for one pass, and the next one to take.
+struct GlyphBatch {
+    SkGlyph* const* fGlyphs;
+    int             fCount;
+    bool            fImages;    // else metrics
+    int32_t         fNext;
+};
+
+// Generates metrics or images for glyphs taken from a shared batch until none
+// are left, using a scaler context no other thread touches.
+class GlyphPreparer : public SkRunnable {
+public:
+    GlyphPreparer(SkScalerContext* context, GlyphBatch* batch)
+        : fContext(context)
+        , fBatch(batch) {}
+
+    virtual void run() SK_OVERRIDE {
+        for (int i = sk_atomic_inc(&fBatch->fNext); i < fBatch->fCount;
+             i = sk_atomic_inc(&fBatch->fNext)) {
+            if (fBatch->fImages) {
+                fContext->getImage(*fBatch->fGlyphs[i]);
+            } else {
+                fContext->getMetrics(fBatch->fGlyphs[i]);
+            }
+        }
+    }
+
+private:
+    SkScalerContext* fContext;
+    GlyphBatch*      fBatch;
+};
+
+void run_batch(SkTaskGroup* group, const SkTDArray<GlyphPreparer*>& preparers,
+               GlyphBatch* batch, const SkTDArray<SkGlyph*>& glyphs, bool images) {
+    batch->fGlyphs = glyphs.begin();
+    batch->fCount = glyphs.count();
+    batch->fImages = images;
+    batch->fNext = 0;
+    for (int i = 0; i < preparers.count(); ++i) {
+        group->add(preparers[i]);
+    }
+    group->wait();
+}
+
+}  // namespace
+
+void SkGlyphCache::prepareGlyphIDImages(const uint16_t glyphIDs[], int count, int threadCount) {
+    VALIDATE();
+
+    // Add every glyph here, so the workers never touch the cache's arrays or
+    // allocator, only the glyphs they are given.
+    SkTDArray<SkGlyph*> glyphs;
+    for (int i = 0; i < count; ++i) {
+        uint32_t id = SkGlyph::MakeID(glyphIDs[i]);
+        unsigned index = ID2HashIndex(id);
+        SkGlyph* glyph = fGlyphHash[index];
+        if (NULL == glyph || glyph->fID != id) {
+            bool added;
+            glyph = this->findOrAddGlyph(id, &added);
+            fGlyphHash[index] = glyph;
+        }
+        if (glyph->isJustAdvance() ||
+            (NULL == glyph->fImage && glyph->fWidth > 0 && glyph->fWidth < kMaxGlyphWidth &&
+             NULL == fCompressedImages.find(glyph->fID))) {
+            *glyphs.append() = glyph;
+        }
+    }
+
+    // Text repeats glyphs; each must go to only one worker.
+    if (glyphs.count() > 1) {
+        SkTQSort(glyphs.begin(), glyphs.end() - 1, GlyphIDLessThan());
+        int unique = 1;
+        for (int i = 1; i < glyphs.count(); ++i) {
+            if (glyphs[i] != glyphs[unique - 1]) {
+                glyphs[unique++] = glyphs[i];
+            }
+        }
+        glyphs.setCount(unique);
+    }
+
+    SkTDArray<SkScalerContext*> contexts;
+    if (threadCount > 1 && glyphs.count() >= kMinGlyphsToPrepareInParallel) {
+        threadCount = SkMin32(threadCount, glyphs.count());
+        for (int i = 0; i < threadCount; ++i) {
+            SkScalerContext* context = fScalerContext->createIndependentContext(fDesc);
+            if (NULL == context) {
+                break;
+            }
+            *contexts.append() = context;
+        }
+    }
+
+    if (contexts.isEmpty()) {
+        for (int i = 0; i < glyphs.count(); ++i) {
+            if (glyphs[i]->isJustAdvance()) {
+                fScalerContext->getMetrics(glyphs[i]);
+            }
+            this->findImage(*glyphs[i]);
+        }
+        return;
+    }
+
+    {
+        SkThreadPool pool(contexts.count());
+        SkTaskGroup group(&pool);
+        GlyphBatch batch;
+        SkTDArray<GlyphPreparer*> preparers;
+        for (int i = 0; i < contexts.count(); ++i) {
+            *preparers.append() = SkNEW_ARGS(GlyphPreparer, (contexts[i], &batch));
+        }
+
+        // Metrics first, since they decide how much image memory each glyph needs.
+        SkTDArray<SkGlyph*> work;
+        for (int i = 0; i < glyphs.count(); ++i) {
+            if (glyphs[i]->isJustAdvance()) {
+                *work.append() = glyphs[i];
+            }
+        }
+        run_batch(&group, preparers, &batch, work, false);
+
+        // Allocate the images here, as findImage() would, then fill them in.
+        // Those that may be compressed are generated into temporary memory.
+        work.rewind();
+        SkTDArray<SkGlyph*> compressible;
+        for (int i = 0; i < glyphs.count(); ++i) {
+            SkGlyph* glyph = glyphs[i];
+            if (glyph->fWidth > 0 && glyph->fWidth < kMaxGlyphWidth && NULL == glyph->fImage) {
+                size_t size = glyph->computeImageSize();
+                if (SkMask::kA8_Format == glyph->fMaskFormat && size >= kMinCompressedImageSize) {
+                    glyph->fImage = sk_malloc_throw(size);
+                    *compressible.append() = glyph;
+                } else {
+                    glyph->fImage = fGlyphAlloc.alloc(size,
+                                                      SkChunkAlloc::kReturnNil_AllocFailType);
+                    if (NULL == glyph->fImage) {
+                        break;
+                    }
+                    fMemoryUsed += size;
+                }
+                *work.append() = glyph;
+            }
+        }
+        run_batch(&group, preparers, &batch, work, true);
+
+        for (int i = 0; i < compressible.count(); ++i) {
+            SkGlyph* glyph = compressible[i];
+            void* generated = glyph->fImage;
+            if (this->compressImage(*glyph)) {
+                glyph->fImage = NULL;
+            } else {
+                size_t size = glyph->computeImageSize();
+                glyph->fImage = fGlyphAlloc.alloc(size, SkChunkAlloc::kReturnNil_AllocFailType);
+                if (NULL != glyph->fImage) {
+                    memcpy(glyph->fImage, generated, size);
+                    fMemoryUsed += size;
+                }
+            }
+            sk_free(generated);
+        }
+
+        preparers.deleteAll();
+    }
+    contexts.deleteAll();
+}
+
+void SkGlyphCache::getStats(SkGraphics::FontCacheStrikeStats* stats) const {
+    const SkScalerContext::Rec* rec = (const SkScalerContext::Rec*)
+            fDesc->findEntry(kRec_SkDescriptorTag, NULL);
+    stats->fFontID = rec->fFontID;
+    stats->fTextSize = SkScalarToFloat(rec->fTextSize);
+    stats->fMemoryUsed = fMemoryUsed;
+    stats->fGlyphCount = fGlyphArray.count();
+    stats->fCompressedImageCount = fCompressedImages.count();
+    stats->fGlyphHits = fGlyphHits;
+    stats->fGlyphMisses = fGlyphMisses;
+    stats->fImageHits = fImageHits;
+    stats->fImageMisses = fImageMisses;
+    stats->fIsLarge = fIsLargeStrike;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 bool SkGlyphCache::getAuxProcData(void (*proc)(void*), void** dataPtr) const {
     const AuxProcRec* rec = fAuxProcList;
     while (rec) {
@@ -461,47 +776,86 @@ size_t SkGlyphCache_Globals::setCacheSizeLimit(size_t newLimit) {
         newLimit = minLimit;
     }
 
-    SkAutoMutexAcquire    ac(fMutex);
+    size_t prevLimit = this->getCacheSizeLimit();
+    sk_release_store(&fCacheSizeLimit, newLimit);
+    this->purge();
+    return prevLimit;
+}
 
-    size_t prevLimit = fCacheSizeLimit;
-    fCacheSizeLimit = newLimit;
-    this->internalPurge();
+size_t SkGlyphCache_Globals::setLargeStrikeLimit(size_t newLimit) {
+    size_t prevLimit = this->getLargeStrikeLimit();
+    sk_release_store(&fLargeStrikeLimit, newLimit);
+    this->purge();
     return prevLimit;
 }
 
+int SkGlyphCache_Globals::getStrikeStats(SkGraphics::FontCacheStrikeStats stats[],
+                                         int maxCount) const {
+    int count = 0;
+    for (int stripe = 0; stripe < fStripeCount; ++stripe) {
+        SkAutoMutexAcquire    ac(fStripes[stripe].fMutex);
+        for (const SkGlyphCache* cache = fStripes[stripe].fHead; cache != NULL;
+             cache = cache->fNext) {
+            if (count < maxCount) {
+                cache->getStats(&stats[count]);
+            }
+            count += 1;
+        }
+    }
+    return count;
+}
+
 int SkGlyphCache_Globals::setCacheCountLimit(int newCount) {
     if (newCount < 0) {
         newCount = 0;
     }
 
-    SkAutoMutexAcquire    ac(fMutex);
-
-    int prevCount = fCacheCountLimit;
-    fCacheCountLimit = newCount;
-    this->internalPurge();
+    int prevCount = this->getCacheCountLimit();
+    sk_release_store(&fCacheCountLimit, newCount);
+    this->purge();
     return prevCount;
 }
 
+void SkGlyphCache_Globals::getCounters(SkCacheCounters* counters) const {
+    counters->fHits = sk_acquire_load(&fHits);
+    counters->fMisses = sk_acquire_load(&fMisses);
+    counters->fEvictions = sk_acquire_load(&fEvictions);
+}
+
 void SkGlyphCache_Globals::purgeAll() {
-    SkAutoMutexAcquire    ac(fMutex);
-    this->internalPurge(fTotalMemoryUsed);
+    this->purge(this->getTotalMemoryUsed());
+}
+
+void SkGlyphCache_Globals::purgeHalf() {
+    this->purge(this->getTotalMemoryUsed() / 2);
+}
+
+void SkGlyphCache::PurgeForMemoryPressure(bool critical) {
+    if (critical) {
+        getSharedGlobals().purgeAll();
+    } else {
+        getSharedGlobals().purgeHalf();
+    }
 }
 
 void SkGlyphCache::VisitAllCaches(bool (*proc)(SkGlyphCache*, void*),
                                   void* context) {
     SkGlyphCache_Globals& globals = getGlobals();
-    SkAutoMutexAcquire    ac(globals.fMutex);
-    SkGlyphCache*         cache;
 
-    globals.validate();
+    for (int stripe = 0; stripe < globals.getStripeCount(); ++stripe) {
+        SkAutoMutexAcquire    ac(globals.stripeMutex(stripe));
+        SkGlyphCache*         cache;
 
-    for (cache = globals.internalGetHead(); cache != NULL; cache = cache->fNext) {
-        if (proc(cache, context)) {
-            break;
+        globals.validate(stripe);
+
+        for (cache = globals.internalGetHead(stripe); cache != NULL; cache = cache->fNext) {
+            if (proc(cache, context)) {
+                return;
+            }
         }
-    }
 
-    globals.validate();
+        globals.validate(stripe);
+    }
 }
 
 /*  This guy calls the visitor from within the mutext lock, so the visitor
@@ -520,15 +874,17 @@ SkGlyphCache* SkGlyphCache::VisitCache(SkTypeface* typeface,
     SkASSERT(desc);
 
     SkGlyphCache_Globals& globals = getGlobals();
-    SkAutoMutexAcquire    ac(globals.fMutex);
+    const int             stripe = globals.stripeFor(*desc);
+    SkAutoMutexAcquire    ac(globals.stripeMutex(stripe));
     SkGlyphCache*         cache;
     bool                  insideMutex = true;
 
-    globals.validate();
+    globals.validate(stripe);
 
-    for (cache = globals.internalGetHead(); cache != NULL; cache = cache->fNext) {
+    for (cache = globals.internalGetHead(stripe); cache != NULL; cache = cache->fNext) {
         if (cache->fDesc->equals(*desc)) {
             globals.internalDetachCache(cache);
+            globals.countHit();
             goto FOUND_IT;
         }
     }
@@ -536,6 +892,7 @@ SkGlyphCache* SkGlyphCache::VisitCache(SkTypeface* typeface,
     /* Release the mutex now, before we create a new entry (which might have
         side-effects like trying to access the cache/mutex (yikes!)
     */
+    globals.countMiss();
     ac.release();           // release the mutex now
     insideMutex = false;    // can't use globals anymore
 
@@ -543,6 +900,7 @@ SkGlyphCache* SkGlyphCache::VisitCache(SkTypeface* typeface,
     // If not, we may have exhausted OS/font resources, so try purging the
     // cache once and try again.
     {
+        TRACE_EVENT0("skia", "SkGlyphCache::VisitCache miss");
         // pass true the first time, to notice if the scalercontext failed,
         // so we can try the purge.
         SkScalerContext* ctx = typeface->createScalerContext(desc, true);
@@ -579,17 +937,20 @@ void SkGlyphCache::AttachCache(SkGlyphCache* cache) {
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkGlyphCache_Globals::attachCacheToHead(SkGlyphCache* cache) {
-    SkAutoMutexAcquire    ac(fMutex);
+    {
+        const int stripe = this->stripeFor(*cache->fDesc);
+        SkAutoMutexAcquire    ac(fStripes[stripe].fMutex);
 
-    this->validate();
-    cache->validate();
+        this->validate(stripe);
+        cache->validate();
 
-    this->internalAttachCacheToHead(cache);
-    this->internalPurge();
+        this->internalAttachCacheToHead(cache);
+    }
+    this->purge();
 }
 
-SkGlyphCache* SkGlyphCache_Globals::internalGetTail() const {
-    SkGlyphCache* cache = fHead;
+SkGlyphCache* SkGlyphCache_Globals::internalGetTail(int stripe) const {
+    SkGlyphCache* cache = fStripes[stripe].fHead;
     if (cache) {
         while (cache->fNext) {
             cache = cache->fNext;
@@ -598,49 +959,105 @@ SkGlyphCache* SkGlyphCache_Globals::internalGetTail() const {
     return cache;
 }
 
-size_t SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
-    this->validate();
+size_t SkGlyphCache_Globals::purgeLargeStrikes() {
+    const size_t largeMemoryUsed = this->getLargeMemoryUsed();
+    const size_t largeStrikeLimit = this->getLargeStrikeLimit();
+    if (largeMemoryUsed <= largeStrikeLimit) {
+        return 0;
+    }
+    // no small purges!
+    const size_t bytesNeeded = SkTMax(largeMemoryUsed - largeStrikeLimit, largeMemoryUsed >> 2);
+
+    size_t  bytesFreed = 0;
+    int     countFreed = 0;
+    const int first = sk_atomic_inc(&fNextPurgeStripe);
+    for (int i = 0; i < fStripeCount && bytesFreed < bytesNeeded; ++i) {
+        const int stripe = (uint32_t)(first + i) % (uint32_t)fStripeCount;
+        SkAutoMutexAcquire    ac(fStripes[stripe].fMutex);
+        this->internalPurgeStripe(stripe, bytesNeeded, 0, true, &bytesFreed, &countFreed);
+    }
+    return bytesFreed;
+}
+
+size_t SkGlyphCache_Globals::purge(size_t minBytesNeeded) {
+    const size_t largeBytesFreed = this->purgeLargeStrikes();
+
+    const size_t totalMemoryUsed = this->getTotalMemoryUsed();
+    const size_t cacheSizeLimit = this->getCacheSizeLimit();
+    const int cacheCount = this->getCacheCountUsed();
+    const int cacheCountLimit = this->getCacheCountLimit();
 
     size_t bytesNeeded = 0;
-    if (fTotalMemoryUsed > fCacheSizeLimit) {
-        bytesNeeded = fTotalMemoryUsed - fCacheSizeLimit;
+    if (totalMemoryUsed > cacheSizeLimit) {
+        bytesNeeded = totalMemoryUsed - cacheSizeLimit;
     }
     bytesNeeded = SkTMax(bytesNeeded, minBytesNeeded);
     if (bytesNeeded) {
         // no small purges!
-        bytesNeeded = SkTMax(bytesNeeded, fTotalMemoryUsed >> 2);
+        bytesNeeded = SkTMax(bytesNeeded, totalMemoryUsed >> 2);
     }
 
     int countNeeded = 0;
-    if (fCacheCount > fCacheCountLimit) {
-        countNeeded = fCacheCount - fCacheCountLimit;
+    if (cacheCount > cacheCountLimit) {
+        countNeeded = cacheCount - cacheCountLimit;
         // no small purges!
-        countNeeded = SkMax32(countNeeded, fCacheCount >> 2);
+        countNeeded = SkMax32(countNeeded, cacheCount >> 2);
     }
 
     // early exit
     if (!countNeeded && !bytesNeeded) {
-        return 0;
+        return largeBytesFreed;
     }
 
     size_t  bytesFreed = 0;
     int     countFreed = 0;
 
-    // we start at the tail and proceed backwards, as the linklist is in LRU
-    // order, with unimportant entries at the tail.
-    SkGlyphCache* cache = this->internalGetTail();
-    while (cache != NULL &&
-           (bytesFreed < bytesNeeded || countFreed < countNeeded)) {
-        SkGlyphCache* prev = cache->fPrev;
-        bytesFreed += cache->fMemoryUsed;
-        countFreed += 1;
+    // Each stripe is in LRU order, so take a turn from the tail of each,
+    // starting where the last purge stopped, until enough is freed. The
+    // stripes are locked one at a time, so this never holds two mutexes.
+    const int first = sk_atomic_inc(&fNextPurgeStripe);
+    for (int i = 0; i < fStripeCount; ++i) {
+        if (bytesFreed >= bytesNeeded && countFreed >= countNeeded) {
+            break;
+        }
+        const int stripe = (uint32_t)(first + i) % (uint32_t)fStripeCount;
+        // Give each of the remaining stripes an equal share of what is left.
+        const int remaining = fStripeCount - i;
+        size_t bytesShare = 0;
+        if (bytesFreed < bytesNeeded) {
+            bytesShare = (bytesNeeded - bytesFreed + remaining - 1) / remaining;
+        }
+        int countShare = 0;
+        if (countFreed < countNeeded) {
+            countShare = (countNeeded - countFreed + remaining - 1) / remaining;
+        }
 
-        this->internalDetachCache(cache);
-        SkDELETE(cache);
-        cache = prev;
+        SkAutoMutexAcquire    ac(fStripes[stripe].fMutex);
+        size_t stripeBytesFreed = 0;
+        int stripeCountFreed = 0;
+        this->internalPurgeStripe(stripe, bytesShare, countShare, false,
+                                  &stripeBytesFreed, &stripeCountFreed);
+        bytesFreed += stripeBytesFreed;
+        countFreed += stripeCountFreed;
     }
 
-    this->validate();
+    // If some stripes were too small for their share, go round once more
+    // without shares.
+    for (int i = 0; i < fStripeCount; ++i) {
+        if (bytesFreed >= bytesNeeded && countFreed >= countNeeded) {
+            break;
+        }
+        const int stripe = (uint32_t)(first + i) % (uint32_t)fStripeCount;
+        SkAutoMutexAcquire    ac(fStripes[stripe].fMutex);
+        size_t stripeBytesFreed = 0;
+        int stripeCountFreed = 0;
+        this->internalPurgeStripe(stripe,
+                                  bytesFreed < bytesNeeded ? bytesNeeded - bytesFreed : 0,
+                                  countFreed < countNeeded ? countNeeded - countFreed : 0,
+                                  false, &stripeBytesFreed, &stripeCountFreed);
+        bytesFreed += stripeBytesFreed;
+        countFreed += stripeCountFreed;
+    }
 
 #ifdef SPEW_PURGE_STATUS
     if (countFreed) {
@@ -649,30 +1066,69 @@ size_t SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
     }
 #endif
 
-    return bytesFreed;
+    return largeBytesFreed + bytesFreed;
+}
+
+void SkGlyphCache_Globals::internalPurgeStripe(int stripe, size_t bytesNeeded,
+                                               int countNeeded, bool largeOnly,
+                                               size_t* bytesFreed, int* countFreed) {
+    this->validate(stripe);
+
+    // we start at the tail and proceed backwards, as the linklist is in LRU
+    // order, with unimportant entries at the tail.
+    SkGlyphCache* cache = this->internalGetTail(stripe);
+    while (cache != NULL &&
+           (*bytesFreed < bytesNeeded || *countFreed < countNeeded)) {
+        SkGlyphCache* prev = cache->fPrev;
+        if (largeOnly && !cache->fIsLargeStrike) {
+            cache = prev;
+            continue;
+        }
+        *bytesFreed += cache->fMemoryUsed;
+        *countFreed += 1;
+
+        this->internalDetachCache(cache);
+        SkDELETE(cache);
+        sk_atomic_inc(&fEvictions);
+        cache = prev;
+    }
+
+    this->validate(stripe);
 }
 
 void SkGlyphCache_Globals::internalAttachCacheToHead(SkGlyphCache* cache) {
     SkASSERT(NULL == cache->fPrev && NULL == cache->fNext);
-    if (fHead) {
-        fHead->fPrev = cache;
-        cache->fNext = fHead;
+    Stripe& stripe = fStripes[this->stripeFor(*cache->fDesc)];
+    if (stripe.fHead) {
+        stripe.fHead->fPrev = cache;
+        cache->fNext = stripe.fHead;
+    }
+    stripe.fHead = cache;
+
+    stripe.fCacheCount += 1;
+    stripe.fMemoryUsed += cache->fMemoryUsed;
+    sk_atomic_inc(&fCacheCount);
+    sk_atomic_add(&fTotalMemoryUsed, (int32_t)cache->fMemoryUsed);
+    if (cache->fIsLargeStrike) {
+        sk_atomic_add(&fLargeMemoryUsed, (int32_t)cache->fMemoryUsed);
     }
-    fHead = cache;
-
-    fCacheCount += 1;
-    fTotalMemoryUsed += cache->fMemoryUsed;
 }
 
 void SkGlyphCache_Globals::internalDetachCache(SkGlyphCache* cache) {
-    SkASSERT(fCacheCount > 0);
-    fCacheCount -= 1;
-    fTotalMemoryUsed -= cache->fMemoryUsed;
+    Stripe& stripe = fStripes[this->stripeFor(*cache->fDesc)];
+    SkASSERT(stripe.fCacheCount > 0);
+    stripe.fCacheCount -= 1;
+    stripe.fMemoryUsed -= cache->fMemoryUsed;
+    sk_atomic_dec(&fCacheCount);
+    sk_atomic_add(&fTotalMemoryUsed, -(int32_t)cache->fMemoryUsed);
+    if (cache->fIsLargeStrike) {
+        sk_atomic_add(&fLargeMemoryUsed, -(int32_t)cache->fMemoryUsed);
+    }
 
     if (cache->fPrev) {
         cache->fPrev->fNext = cache->fNext;
     } else {
-        fHead = cache->fNext;
+        stripe.fHead = cache->fNext;
     }
     if (cache->fNext) {
         cache->fNext->fPrev = cache->fPrev;
@@ -701,19 +1157,20 @@ void SkGlyphCache::validate() const {
 #endif
 }
 
-void SkGlyphCache_Globals::validate() const {
+void SkGlyphCache_Globals::validate(int stripe) const {
     size_t computedBytes = 0;
     int computedCount = 0;
 
-    const SkGlyphCache* head = fHead;
+    const SkGlyphCache* head = fStripes[stripe].fHead;
     while (head != NULL) {
+        SkASSERT(this->stripeFor(*head->fDesc) == stripe);
         computedBytes += head->fMemoryUsed;
         computedCount += 1;
         head = head->fNext;
     }
 
-    SkASSERT(fTotalMemoryUsed == computedBytes);
-    SkASSERT(fCacheCount == computedCount);
+    SkASSERT(fStripes[stripe].fMemoryUsed == computedBytes);
+    SkASSERT(fStripes[stripe].fCacheCount == computedCount);
 }
 
 #endif
@@ -735,6 +1192,22 @@ size_t SkGraphics::GetFontCacheUsed() {
     return getSharedGlobals().getTotalMemoryUsed();
 }
 
+size_t SkGraphics::GetFontCacheLargeStrikeLimit() {
+    return getSharedGlobals().getLargeStrikeLimit();
+}
+
+size_t SkGraphics::SetFontCacheLargeStrikeLimit(size_t bytes) {
+    return getSharedGlobals().setLargeStrikeLimit(bytes);
+}
+
+int SkGraphics::GetFontCacheStrikeStats(FontCacheStrikeStats stats[], int maxCount) {
+    return getSharedGlobals().getStrikeStats(stats, maxCount);
+}
+
+void SkGraphics::GetFontCacheCounters(SkCacheCounters* counters) {
+    getSharedGlobals().getCounters(counters);
+}
+
 int SkGraphics::GetFontCacheCountLimit() {
     return getSharedGlobals().getCacheCountLimit();
 }
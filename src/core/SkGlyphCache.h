@@ -14,7 +14,9 @@
 #include "SkChunkAlloc.h"
 #include "SkDescriptor.h"
 #include "SkGlyph.h"
+#include "SkGraphics.h"
 #include "SkScalerContext.h"
+#include "SkTDynamicHash.h"
 #include "SkTemplates.h"
 #include "SkTDArray.h"
 
@@ -86,6 +88,11 @@ public:
 
     /** Return the image associated with the glyph. If it has not been generated
         this will trigger that.
+
+        Large A8 images may be kept compressed, and decompressed into a
+        scratch image shared by the whole strike. So the returned image is
+        only valid until the next call to findImage, and glyph.fImage of the
+        glyph decompressed before is set back to NULL.
     */
     const void* findImage(const SkGlyph&);
     /** Return the Path associated with the glyph. If it has not been generated
@@ -97,6 +104,15 @@ public:
      */
     const void* findDistanceField(const SkGlyph&);
 
+    /** Generate the metrics and images of the given glyphs (as getGlyphIDMetrics
+        and findImage would, at subpixel position 0, 0) using up to threadCount
+        threads, so that drawing them afterwards finds them already cached.
+        The work is done on the calling thread instead if threadCount <= 1,
+        if there are too few new glyphs to be worth it, or if the scaler
+        context cannot be used from several threads at once.
+    */
+    void prepareGlyphIDImages(const uint16_t glyphIDs[], int count, int threadCount);
+
     /** Return the vertical metrics for this strike.
     */
     const SkPaint::FontMetrics& getFontMetrics() const {
@@ -113,6 +129,13 @@ public:
         return fScalerContext->isSubpixel();
     }
 
+    /** Large strikes (tall text, or color glyphs) are purged to a budget of
+        their own, so that they cannot push smaller text out of the cache.
+    */
+    bool isLargeStrike() const { return fIsLargeStrike; }
+
+    void getStats(SkGraphics::FontCacheStrikeStats*) const;
+
     /*  AuxProc/Data allow a client to associate data with this cache entry.
         Multiple clients can use this, as their data is keyed with a function
         pointer. In addition to serving as a key, the function pointer is called
@@ -135,6 +158,11 @@ public:
     */
     static void VisitAllCaches(bool (*proc)(SkGlyphCache*, void*), void* ctx);
 
+    /** Purge the least recently used half of the shared caches' memory, or
+        all of the caches not in use if critical is true.
+    */
+    static void PurgeForMemoryPressure(bool critical);
+
     /** Find a matching cache entry, and call proc() with it. If none is found
         create a new one. If the proc() returns true, detach the cache and
         return it, otherwise leave it and return NULL.
@@ -199,6 +227,14 @@ private:
     };
 
     SkGlyph* lookupMetrics(uint32_t id, MetricsType);
+    // Returns the glyph for id, adding one with no metrics if it is not found.
+    SkGlyph* findOrAddGlyph(uint32_t id, bool* added);
+    // Returns the strike's scratch image, at least size bytes, for glyph.
+    void* useScratchImage(const SkGlyph& glyph, size_t size);
+    // Compresses glyph's image, just generated outside fGlyphAlloc, into the
+    // strike if that is worth it. Returns false if the image should be kept
+    // uncompressed instead.
+    bool compressImage(const SkGlyph& glyph);
     static bool DetachProc(const SkGlyphCache*, void*) { return true; }
 
     SkGlyphCache*       fNext, *fPrev;
@@ -231,6 +267,31 @@ private:
     // used to track (approx) how much ram is tied-up in this cache
     size_t  fMemoryUsed;
 
+    bool    fIsLargeStrike;
+
+    // Lookups served from the strike, and those that had to generate.
+    uint32_t fGlyphHits, fGlyphMisses;
+    uint32_t fImageHits, fImageMisses;
+
+    // A PackBits-compressed glyph image, allocated in fGlyphAlloc.
+    struct CompressedImage {
+        uint32_t    fID;
+        uint32_t    fSize;
+        // followed by fSize bytes of packed data
+
+        const uint8_t* data() const { return (const uint8_t*)(this + 1); }
+        uint8_t* data() { return (uint8_t*)(this + 1); }
+
+        static const uint32_t& GetKey(const CompressedImage& image) { return image.fID; }
+        static uint32_t Hash(const uint32_t& id) { return id; }
+    };
+    SkTDynamicHash<CompressedImage, uint32_t> fCompressedImages;
+
+    // The glyph whose fImage is the scratch image, or NULL.
+    const SkGlyph*  fScratchGlyph;
+    SkAutoMalloc    fScratchImage;
+    size_t          fScratchImageSize;
+
     struct AuxProcRec {
         AuxProcRec* fNext;
         void (*fProc)(void*);
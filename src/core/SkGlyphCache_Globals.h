@@ -8,7 +8,9 @@
 #ifndef SkGlyphCache_Globals_DEFINED
 #define SkGlyphCache_Globals_DEFINED
 
+#include "SkCacheCounters.h"
 #include "SkGlyphCache.h"
+#include "SkThread.h"
 #include "SkTLS.h"
 
 #ifndef SK_DEFAULT_FONT_CACHE_COUNT_LIMIT
@@ -19,10 +21,24 @@
     #define SK_DEFAULT_FONT_CACHE_LIMIT     (2 * 1024 * 1024)
 #endif
 
-///////////////////////////////////////////////////////////////////////////////
+#ifndef SK_DEFAULT_FONT_CACHE_LARGE_STRIKE_LIMIT
+    #define SK_DEFAULT_FONT_CACHE_LARGE_STRIKE_LIMIT    (SK_DEFAULT_FONT_CACHE_LIMIT / 4)
+#endif
 
-class SkMutex;
+///////////////////////////////////////////////////////////////////////////////
 
+/**
+ *  The list of detached (not in use) glyph caches, in LRU order.
+ *
+ *  The shared globals split their caches into stripes by descriptor checksum,
+ *  each with its own mutex and LRU list, so threads looking up different
+ *  strikes rarely contend. The memory and count budgets are global: the
+ *  totals are kept with atomics, and purging walks the stripes round-robin,
+ *  evicting from the tail of each in turn.
+ *
+ *  Large strikes are also held to a budget of their own, purged before the
+ *  overall one and evicting only large strikes.
+ */
 class SkGlyphCache_Globals {
 public:
     enum UseMutex {
@@ -30,60 +46,100 @@ public:
         kYes_UseMutex  // shared cache
     };
 
+    enum {
+        kMaxStripes = 8
+    };
+
     SkGlyphCache_Globals(UseMutex um) {
-        fHead = NULL;
         fTotalMemoryUsed = 0;
         fCacheSizeLimit = SK_DEFAULT_FONT_CACHE_LIMIT;
         fCacheCount = 0;
         fCacheCountLimit = SK_DEFAULT_FONT_CACHE_COUNT_LIMIT;
-
-        fMutex = (kYes_UseMutex == um) ? SkNEW(SkMutex) : NULL;
+        fLargeMemoryUsed = 0;
+        fLargeStrikeLimit = SK_DEFAULT_FONT_CACHE_LARGE_STRIKE_LIMIT;
+        fNextPurgeStripe = 0;
+        fHits = 0;
+        fMisses = 0;
+        fEvictions = 0;
+
+        // A thread-local cache is never contended, so one list will do.
+        fStripeCount = (kYes_UseMutex == um) ? kMaxStripes : 1;
+        for (int i = 0; i < fStripeCount; ++i) {
+            fStripes[i].fMutex = (kYes_UseMutex == um) ? SkNEW(SkMutex) : NULL;
+            fStripes[i].fHead = NULL;
+            fStripes[i].fMemoryUsed = 0;
+            fStripes[i].fCacheCount = 0;
+        }
     }
 
     ~SkGlyphCache_Globals() {
-        SkGlyphCache* cache = fHead;
-        while (cache) {
-            SkGlyphCache* next = cache->fNext;
-            SkDELETE(cache);
-            cache = next;
+        for (int i = 0; i < fStripeCount; ++i) {
+            SkGlyphCache* cache = fStripes[i].fHead;
+            while (cache) {
+                SkGlyphCache* next = cache->fNext;
+                SkDELETE(cache);
+                cache = next;
+            }
+
+            SkDELETE(fStripes[i].fMutex);
         }
+    }
+
+    int getStripeCount() const { return fStripeCount; }
 
-        SkDELETE(fMutex);
+    // the stripe that holds caches for this descriptor
+    int stripeFor(const SkDescriptor& desc) const {
+        return desc.getChecksum() % (uint32_t)fStripeCount;
     }
 
-    SkMutex*        fMutex;
+    // can be NULL, for a thread-local cache
+    SkMutex* stripeMutex(int stripe) const { return fStripes[stripe].fMutex; }
 
-    SkGlyphCache* internalGetHead() const { return fHead; }
-    SkGlyphCache* internalGetTail() const;
+    // can only be called when the stripe's mutex is held
+    SkGlyphCache* internalGetHead(int stripe) const { return fStripes[stripe].fHead; }
+    SkGlyphCache* internalGetTail(int stripe) const;
 
-    size_t getTotalMemoryUsed() const { return fTotalMemoryUsed; }
-    int getCacheCountUsed() const { return fCacheCount; }
+    size_t getTotalMemoryUsed() const { return sk_acquire_load(&fTotalMemoryUsed); }
+    int getCacheCountUsed() const { return sk_acquire_load(&fCacheCount); }
 
 #ifdef SK_DEBUG
-    void validate() const;
+    // can only be called when the stripe's mutex is held
+    void validate(int stripe) const;
 #else
-    void validate() const {}
+    void validate(int) const {}
 #endif
 
-    int getCacheCountLimit() const { return fCacheCountLimit; }
+    int getCacheCountLimit() const { return sk_acquire_load(&fCacheCountLimit); }
     int setCacheCountLimit(int limit);
 
-    size_t  getCacheSizeLimit() const { return fCacheSizeLimit; }
+    size_t  getCacheSizeLimit() const { return sk_acquire_load(&fCacheSizeLimit); }
     size_t  setCacheSizeLimit(size_t limit);
 
+    size_t  getLargeMemoryUsed() const { return sk_acquire_load(&fLargeMemoryUsed); }
+    size_t  getLargeStrikeLimit() const { return sk_acquire_load(&fLargeStrikeLimit); }
+    size_t  setLargeStrikeLimit(size_t limit);
+
+    int getStrikeStats(SkGraphics::FontCacheStrikeStats stats[], int maxCount) const;
+
+    // Lookups of strikes (not of glyphs within them), and strikes purged.
+    void countHit() { sk_atomic_inc(&fHits); }
+    void countMiss() { sk_atomic_inc(&fMisses); }
+    void getCounters(SkCacheCounters*) const;
+
     // returns true if this cache is over-budget either due to size limit
     // or count limit.
     bool isOverBudget() const {
-        return fCacheCount > fCacheCountLimit ||
-               fTotalMemoryUsed > fCacheSizeLimit;
+        return this->getCacheCountUsed() > this->getCacheCountLimit() ||
+               this->getTotalMemoryUsed() > this->getCacheSizeLimit();
     }
 
     void purgeAll(); // does not change budget
+    void purgeHalf(); // does not change budget
 
     // call when a glyphcache is available for caching (i.e. not in use)
     void attachCacheToHead(SkGlyphCache*);
 
-    // can only be called when the mutex is already held
+    // can only be called when the mutex of the cache's stripe is already held
     void internalDetachCache(SkGlyphCache*);
     void internalAttachCacheToHead(SkGlyphCache*);
 
@@ -99,16 +155,44 @@ public:
     static void DeleteTLS() { SkTLS::Delete(CreateTLS); }
 
 private:
-    SkGlyphCache* fHead;
-    size_t  fTotalMemoryUsed;
+    struct Stripe {
+        SkMutex*        fMutex;
+        SkGlyphCache*   fHead;
+        size_t          fMemoryUsed;
+        int             fCacheCount;
+    };
+
+    Stripe  fStripes[kMaxStripes];
+    int     fStripeCount;
+
+    // Totals over all the stripes, updated atomically.
+    int32_t fTotalMemoryUsed;
+    int32_t fCacheCount;
+    int32_t fNextPurgeStripe;
+    int32_t fLargeMemoryUsed;
+    int32_t fHits;
+    int32_t fMisses;
+    int32_t fEvictions;
+
     size_t  fCacheSizeLimit;
     int32_t fCacheCountLimit;
-    int32_t fCacheCount;
+    size_t  fLargeStrikeLimit;
 
     // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
-    // and attempt to purge caches to match.
+    // and attempt to purge caches to match. Must be called with no stripe
+    // mutex held.
     // Returns number of bytes freed.
-    size_t internalPurge(size_t minBytesNeeded = 0);
+    size_t purge(size_t minBytesNeeded = 0);
+
+    // Purges large strikes down to their own budget. Must be called with no
+    // stripe mutex held. Returns number of bytes freed.
+    size_t purgeLargeStrikes();
+
+    // Frees caches from the tail of one stripe, whose mutex must be held,
+    // until bytesNeeded and countNeeded are met or the stripe is empty.
+    // If largeOnly, only large strikes are freed.
+    void internalPurgeStripe(int stripe, size_t bytesNeeded, int countNeeded, bool largeOnly,
+                             size_t* bytesFreed, int* countFreed);
 
     static void* CreateTLS() {
         return SkNEW_ARGS(SkGlyphCache_Globals, (kNo_UseMutex));
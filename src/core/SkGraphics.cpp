@@ -131,6 +131,42 @@ void SkGraphics::Term() {
     SkPaint::Term();
 }
 
+static int gBlurThreadCount = 1;
+
+int SkGraphics::SetBlurThreadCount(int count) {
+    int prev = gBlurThreadCount;
+    gBlurThreadCount = count;
+    return prev;
+}
+
+int SkGraphics::GetBlurThreadCount() {
+    return gBlurThreadCount;
+}
+
+static int gResizeThreadCount = 1;
+
+int SkGraphics::SetResizeThreadCount(int count) {
+    int prev = gResizeThreadCount;
+    gResizeThreadCount = count;
+    return prev;
+}
+
+int SkGraphics::GetResizeThreadCount() {
+    return gResizeThreadCount;
+}
+
+static int gTextureCompressionThreadCount = 1;
+
+int SkGraphics::SetTextureCompressionThreadCount(int count) {
+    int prev = gTextureCompressionThreadCount;
+    gTextureCompressionThreadCount = count;
+    return prev;
+}
+
+int SkGraphics::GetTextureCompressionThreadCount() {
+    return gTextureCompressionThreadCount;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static const char kFontCacheLimitStr[] = "font-cache-limit";
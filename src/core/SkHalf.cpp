@@ -0,0 +1,66 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkHalf.h"
+
+// Both conversions work on the bits, so that they are exact and don't depend on the FPU's rounding
+// mode. SkRasterPipeline does the same four at a time.
+
+static inline uint32_t float_bits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static inline float bits_float(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+float SkHalfToFloat(SkHalf h) {
+    static const uint32_t kShiftedExp = 0x7c00 << 13;   // a half's exponent mask, in place
+
+    // The exponent and mantissa, in place for a float.
+    uint32_t bits = static_cast<uint32_t>(h & 0x7fff) << 13;
+    uint32_t exp = bits & kShiftedExp;
+    bits += (127 - 15) << 23;                           // rebias the exponent
+    if (exp == kShiftedExp) {
+        bits += (128 - 16) << 23;                       // infinity or NaN
+    } else if (0 == exp) {
+        // Denormals are renormalized by letting the FPU subtract the implicit one back off.
+        bits += 1 << 23;
+        bits = float_bits(bits_float(bits) - bits_float(113 << 23));
+    }
+    return bits_float(bits | (static_cast<uint32_t>(h & 0x8000) << 16));
+}
+
+SkHalf SkFloatToHalf(float f) {
+    static const uint32_t kInfinity    = 255 << 23;
+    static const uint32_t kHalfTooBig  = (127 + 16) << 23;
+    static const uint32_t kDenormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+    uint32_t bits = float_bits(f);
+    uint32_t sign = bits & 0x80000000;
+    bits ^= sign;
+
+    uint32_t h;
+    if (bits >= kHalfTooBig) {
+        h = bits > kInfinity ? 0x7e00 : 0x7c00;
+    } else if (bits < (113 << 23)) {
+        // Too small to be a normal half. Adding the magic number lines the mantissa up with a
+        // half's denormal, and the FPU rounds it to even.
+        h = float_bits(bits_float(bits) + bits_float(kDenormMagic)) - kDenormMagic;
+    } else {
+        uint32_t mantissaOdd = (bits >> 13) & 1;
+        bits -= (127 - 15) << 23;
+        bits += 0xfff;
+        bits += mantissaOdd;
+        h = bits >> 13;
+    }
+    return SkToU16(h | (sign >> 16));
+}
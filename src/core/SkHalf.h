@@ -0,0 +1,31 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkHalf_DEFINED
+#define SkHalf_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  An IEEE 754 half precision float: 1 sign bit, 5 exponent bits and 10 mantissa bits. It holds
+ *  values up to 65504, and steps of 1/1024 at 1.0, which is enough for colors outside [0, 1].
+ */
+typedef uint16_t SkHalf;
+
+static const SkHalf SK_HalfMax = 0x7bff;    // 65504
+static const SkHalf SK_Half1   = 0x3c00;    // 1.0
+
+/** Converts h to a float exactly. Infinities and NaNs are kept. */
+float SkHalfToFloat(SkHalf h);
+
+/**
+ *  Rounds f to the nearest half, ties to even. Values too large for a half become infinity, and
+ *  NaNs stay NaNs.
+ */
+SkHalf SkFloatToHalf(float f);
+
+#endif
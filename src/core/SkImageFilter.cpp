@@ -13,6 +13,7 @@
 #include "SkWriteBuffer.h"
 #include "SkRect.h"
 #include "SkTDynamicHash.h"
+#include "SkThread.h"
 #include "SkValidationUtils.h"
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
@@ -22,10 +23,31 @@
 
 SkImageFilter::Cache* gExternalCache;
 
+static uint32_t next_image_filter_unique_id() {
+    static int32_t gImageFilterUniqueID;
+
+    // Never return 0.
+    int32_t id;
+    do {
+        id = sk_atomic_inc(&gImageFilterUniqueID) + 1;
+    } while (0 == id);
+    return id;
+}
+
+SkImageFilter::Cache::Key::Key(uint32_t uniqueID, const SkMatrix& matrix,
+                               const SkIRect& clipBounds, uint32_t srcGenID)
+  : fUniqueID(uniqueID), fClipBounds(clipBounds), fSrcGenID(srcGenID) {
+    // Compare the matrix by its values; its type mask is computed lazily.
+    for (int i = 0; i < 9; ++i) {
+        fMatrix[i] = matrix[i];
+    }
+}
+
 SkImageFilter::SkImageFilter(int inputCount, SkImageFilter** inputs, const CropRect* cropRect)
   : fInputCount(inputCount),
     fInputs(new SkImageFilter*[inputCount]),
-    fCropRect(cropRect ? *cropRect : CropRect(SkRect(), 0x0)) {
+    fCropRect(cropRect ? *cropRect : CropRect(SkRect(), 0x0)),
+    fUniqueID(next_image_filter_unique_id()) {
     for (int i = 0; i < inputCount; ++i) {
         fInputs[i] = inputs[i];
         SkSafeRef(fInputs[i]);
@@ -35,14 +57,16 @@ SkImageFilter::SkImageFilter(int inputCount, SkImageFilter** inputs, const CropR
 SkImageFilter::SkImageFilter(SkImageFilter* input, const CropRect* cropRect)
   : fInputCount(1),
     fInputs(new SkImageFilter*[1]),
-    fCropRect(cropRect ? *cropRect : CropRect(SkRect(), 0x0)) {
+    fCropRect(cropRect ? *cropRect : CropRect(SkRect(), 0x0)),
+    fUniqueID(next_image_filter_unique_id()) {
     fInputs[0] = input;
     SkSafeRef(fInputs[0]);
 }
 
 SkImageFilter::SkImageFilter(SkImageFilter* input1, SkImageFilter* input2, const CropRect* cropRect)
   : fInputCount(2), fInputs(new SkImageFilter*[2]),
-    fCropRect(cropRect ? *cropRect : CropRect(SkRect(), 0x0)) {
+    fCropRect(cropRect ? *cropRect : CropRect(SkRect(), 0x0)),
+    fUniqueID(next_image_filter_unique_id()) {
     fInputs[0] = input1;
     fInputs[1] = input2;
     SkSafeRef(fInputs[0]);
@@ -56,7 +80,8 @@ SkImageFilter::~SkImageFilter() {
     delete[] fInputs;
 }
 
-SkImageFilter::SkImageFilter(int inputCount, SkReadBuffer& buffer) {
+SkImageFilter::SkImageFilter(int inputCount, SkReadBuffer& buffer)
+  : fUniqueID(next_image_filter_unique_id()) {
     fInputCount = buffer.readInt();
     if (buffer.validate((fInputCount >= 0) && ((inputCount < 0) || (fInputCount == inputCount)))) {
         fInputs = new SkImageFilter*[fInputCount];
@@ -103,7 +128,8 @@ bool SkImageFilter::filterImage(Proxy* proxy, const SkBitmap& src,
     SkASSERT(result);
     SkASSERT(offset);
     SkASSERT(cache);
-    if (cache->get(this, result, offset)) {
+    Cache::Key key(fUniqueID, context.ctm(), context.clipBounds(), src.getGenerationID());
+    if (cache->get(key, result, offset)) {
         return true;
     }
     /*
@@ -112,7 +138,7 @@ bool SkImageFilter::filterImage(Proxy* proxy, const SkBitmap& src,
      */
     if ((proxy && proxy->filterImage(this, src, context, result, offset)) ||
         this->onFilterImage(proxy, src, context, result, offset)) {
-        cache->set(this, *result, *offset);
+        cache->set(key, this, *result, *offset);
         return true;
     }
     return false;
@@ -125,6 +151,18 @@ bool SkImageFilter::filterBounds(const SkIRect& src, const SkMatrix& ctm,
     return this->onFilterBounds(src, ctm, dst);
 }
 
+bool SkImageFilter::computeClipBounds(const SkIRect& visible, const SkIRect& srcBounds,
+                                      const SkMatrix& ctm, SkIRect* clipBounds) const {
+    SkASSERT(clipBounds);
+    SkIRect needed;
+    if (!this->filterBounds(visible, ctm, &needed)) {
+        // Nothing is known about what the filter reads, so filter all of the src.
+        needed = srcBounds;
+    }
+    *clipBounds = srcBounds;
+    return clipBounds->intersect(needed);
+}
+
 void SkImageFilter::computeFastBounds(const SkRect& src, SkRect* dst) const {
     if (0 == fInputCount) {
         *dst = src;
@@ -156,6 +194,25 @@ bool SkImageFilter::canFilterImageGPU() const {
     return this->asNewEffect(NULL, NULL, SkMatrix::I(), SkIRect());
 }
 
+bool SkImageFilter::drawsThroughProxy() const {
+    return false;
+}
+
+bool SkImageFilter::canFilterGraphGPU(const SkImageFilter** cpuFilter) const {
+    if (!this->canFilterImageGPU() && !this->drawsThroughProxy()) {
+        if (cpuFilter) {
+            *cpuFilter = this;
+        }
+        return false;
+    }
+    for (int i = 0; i < fInputCount; ++i) {
+        if (fInputs[i] && !fInputs[i]->canFilterGraphGPU(cpuFilter)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool SkImageFilter::filterImageGPU(Proxy* proxy, const SkBitmap& src, const Context& ctx,
                                    SkBitmap* result, SkIPoint* offset) const {
 #if SK_SUPPORT_GPU
@@ -321,24 +378,31 @@ bool SkImageFilter::getInputResultGPU(SkImageFilter::Proxy* proxy,
     // called are restored before we return to the caller.
     GrContext* context = src.getTexture()->getContext();
     GrContext::AutoWideOpenIdentityDraw awoid(context, NULL);
-    if (this->canFilterImageGPU()) {
-        return this->filterImageGPU(proxy, src, ctx, result, offset);
-    } else {
-        if (this->filterImage(proxy, src, ctx, result, offset)) {
-            if (!result->getTexture()) {
-                const SkImageInfo info = result->info();
-                if (kUnknown_SkColorType == info.colorType()) {
-                    return false;
-                }
-                GrTexture* resultTex = GrLockAndRefCachedBitmapTexture(context, *result, NULL);
-                result->setPixelRef(new SkGrPixelRef(info, resultTex))->unref();
-                GrUnlockAndUnrefCachedBitmapTexture(resultTex);
-            }
-            return true;
-        } else {
+    // Like filterImage(), reuse the result of a filter that more than one input refers to.
+    Cache* cache = ctx.cache();
+    SkASSERT(cache);
+    Cache::Key key(fUniqueID, ctx.ctm(), ctx.clipBounds(), src.getGenerationID());
+    if (cache->get(key, result, offset)) {
+        // The result may be from filterImage(), and still need uploading.
+    } else if (this->canFilterImageGPU()) {
+        if (!this->filterImageGPU(proxy, src, ctx, result, offset)) {
+            return false;
+        }
+        cache->set(key, this, *result, *offset);
+        return true;
+    } else if (!this->filterImage(proxy, src, ctx, result, offset)) {
+        return false;
+    }
+    if (!result->getTexture()) {
+        const SkImageInfo info = result->info();
+        if (kUnknown_SkColorType == info.colorType()) {
             return false;
         }
+        GrTexture* resultTex = GrLockAndRefCachedBitmapTexture(context, *result, NULL);
+        result->setPixelRef(new SkGrPixelRef(info, resultTex))->unref();
+        GrUnlockAndUnrefCachedBitmapTexture(resultTex);
     }
+    return true;
 }
 #endif
 
@@ -371,13 +435,13 @@ class CacheImpl : public SkImageFilter::Cache {
 public:
     explicit CacheImpl(int minChildren) : fMinChildren(minChildren) {}
     virtual ~CacheImpl();
-    bool get(const SkImageFilter* key, SkBitmap* result, SkIPoint* offset) SK_OVERRIDE;
-    void set(const SkImageFilter* key, const SkBitmap& result, const SkIPoint& offset) SK_OVERRIDE;
-    void remove(const SkImageFilter* key) SK_OVERRIDE;
+    bool get(const Key& key, SkBitmap* result, SkIPoint* offset) SK_OVERRIDE;
+    void set(const Key& key, const SkImageFilter* filter,
+             const SkBitmap& result, const SkIPoint& offset) SK_OVERRIDE;
+    void remove(const Key& key) SK_OVERRIDE;
 private:
-    typedef const SkImageFilter* Key;
     struct Value {
-        Value(Key key, const SkBitmap& bitmap, const SkIPoint& offset)
+        Value(const Key& key, const SkBitmap& bitmap, const SkIPoint& offset)
             : fKey(key), fBitmap(bitmap), fOffset(offset) {}
         Key fKey;
         SkBitmap fBitmap;
@@ -385,7 +449,7 @@ private:
         static const Key& GetKey(const Value& v) {
             return v.fKey;
         }
-        static uint32_t Hash(Key key) {
+        static uint32_t Hash(const Key& key) {
             return compute_hash(reinterpret_cast<const uint32_t*>(&key), sizeof(Key) / sizeof(uint32_t));
         }
     };
@@ -393,7 +457,7 @@ private:
     int fMinChildren;
 };
 
-bool CacheImpl::get(const SkImageFilter* key, SkBitmap* result, SkIPoint* offset) {
+bool CacheImpl::get(const Key& key, SkBitmap* result, SkIPoint* offset) {
     Value* v = fData.find(key);
     if (v) {
         *result = v->fBitmap;
@@ -403,7 +467,7 @@ bool CacheImpl::get(const SkImageFilter* key, SkBitmap* result, SkIPoint* offset
     return false;
 }
 
-void CacheImpl::remove(const SkImageFilter* key) {
+void CacheImpl::remove(const Key& key) {
     Value* v = fData.find(key);
     if (v) {
         fData.remove(key);
@@ -411,8 +475,9 @@ void CacheImpl::remove(const SkImageFilter* key) {
     }
 }
 
-void CacheImpl::set(const SkImageFilter* key, const SkBitmap& result, const SkIPoint& offset) {
-    if (key->getRefCnt() >= fMinChildren) {
+void CacheImpl::set(const Key& key, const SkImageFilter* filter,
+                    const SkBitmap& result, const SkIPoint& offset) {
+    if (filter->getRefCnt() >= fMinChildren && NULL == fData.find(key)) {
         fData.add(new Value(key, result, offset));
     }
 }
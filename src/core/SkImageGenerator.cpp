@@ -6,6 +6,7 @@
  */
 
 #include "SkImageGenerator.h"
+#include "SkRect.h"
 
 #ifndef SK_SUPPORT_LEGACY_IMAGEGENERATORAPI
 bool SkImageGenerator::getInfo(SkImageInfo* info) {
@@ -57,6 +58,26 @@ bool SkImageGenerator::getPixels(const SkImageInfo& info, void* pixels, size_t r
 }
 #endif
 
+bool SkImageGenerator::getPixels(const SkIRect& subset, int sampleSize, SkBitmap* bitmap) {
+    SkASSERT(NULL != bitmap);
+    if (subset.isEmpty() || sampleSize < 1) {
+        return false;
+    }
+    return this->onGetSubsetPixels(subset, sampleSize, bitmap);
+}
+
+bool SkImageGenerator::getYUV8Planes(SkISize sizes[3], void* planes[3], size_t rowBytes[3]) {
+    SkASSERT(NULL != sizes);
+    if (NULL != planes && NULL != rowBytes) {
+        for (int i = 0; i < 3; ++i) {
+            if (NULL == planes[i] || rowBytes[i] < (size_t) sizes[i].fWidth) {
+                return false;
+            }
+        }
+    }
+    return this->onGetYUV8Planes(sizes, planes, rowBytes);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 SkData* SkImageGenerator::onRefEncodedData() {
@@ -70,3 +91,11 @@ bool SkImageGenerator::onGetInfo(SkImageInfo*) {
 bool SkImageGenerator::onGetPixels(const SkImageInfo&, void*, size_t, SkPMColor*, int*) {
     return false;
 }
+
+bool SkImageGenerator::onGetSubsetPixels(const SkIRect&, int, SkBitmap*) {
+    return false;
+}
+
+bool SkImageGenerator::onGetYUV8Planes(SkISize[3], void*[3], size_t[3]) {
+    return false;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkLCDFilter.h"
+#include "SkColorPriv.h"
+
+// An N tap FIR is defined by
+// out[n] = coeff[0]*x[n] + coeff[1]*x[n-1] + ... + coeff[N]*x[n-N]
+// or
+// out[n] = sum(i, 0, N, coeff[i]*x[n-i])
+
+// The strategy is to use one FIR (different coefficients) for each of r, g, and b.
+// This means using every 4th FIR output value of each FIR and discarding the rest.
+// The FIRs are aligned, and the coefficients reach 5 samples to each side of their 'center'.
+// (For r and b this is technically incorrect, but the coeffs outside round to zero anyway.)
+
+// These are in some fixed point repesentation.
+// Adding up to more than one simulates ink spread.
+// For implementation reasons, these should never add up to more than two.
+
+// Coefficients determined by a gausian where 5 samples = 3 std deviations (0x110 'contrast').
+// Calculated using tools/generate_fir_coeff.py
+// With this one almost no fringing is ever seen, but it is imperceptibly blurry.
+// The lcd smoothed text is almost imperceptibly different from gray,
+// but is still sharper on small stems and small rounded corners than gray.
+// This also seems to be about as wide as one can get and only have a three pixel kernel.
+// TODO: caculate these at runtime so parameters can be adjusted (esp contrast).
+static const uint8_t gCoefficients[3][12] = {
+    //The red subpixel is centered inside the first sample (at 1/6 pixel), and is shifted.
+    { 0x03, 0x0b, 0x1c, 0x33,  0x40, 0x39, 0x24, 0x10,  0x05, 0x01, 0x00, 0x00, },
+    //The green subpixel is centered between two samples (at 1/2 pixel), so is symetric
+    { 0x00, 0x02, 0x08, 0x16,  0x2b, 0x3d, 0x3d, 0x2b,  0x16, 0x08, 0x02, 0x00, },
+    //The blue subpixel is centered inside the last sample (at 5/6 pixel), and is shifted.
+    { 0x00, 0x00, 0x01, 0x05,  0x10, 0x24, 0x39, 0x40,  0x33, 0x1c, 0x0b, 0x03, },
+};
+
+// The padding means every pixel sees all 12 of its samples, so there are no edge cases.
+static void filter_row(const uint8_t padded[], int pixelCount,
+                       const uint8_t coefficients[3][12],
+                       uint8_t r[], uint8_t g[], uint8_t b[]) {
+    for (int i = 0; i < pixelCount; ++i) {
+        const uint8_t* samples = padded + 4 * i;
+        unsigned fir[3] = { 0, 0, 0 };
+        for (int k = 0; k < 12; ++k) {
+            fir[0] += coefficients[0][k] * samples[k];
+            fir[1] += coefficients[1][k] * samples[k];
+            fir[2] += coefficients[2][k] * samples[k];
+        }
+        r[i] = SkTMin(fir[0] >> 8, 255u);
+        g[i] = SkTMin(fir[1] >> 8, 255u);
+        b[i] = SkTMin(fir[2] >> 8, 255u);
+    }
+}
+
+static void pack_row(const uint8_t r[], const uint8_t g[], const uint8_t b[],
+                     uint16_t dst[], int count) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = SkPack888ToRGB16(r[i], g[i], b[i]);
+    }
+}
+
+SkLCDFilter::SkLCDFilter() {
+    if (!SkLCDFilterGetPlatformProcs(&fFilterRow, &fPackRow)) {
+        fFilterRow = filter_row;
+        fPackRow = pack_row;
+    }
+}
+
+void SkLCDFilter::filterRow(const uint8_t padded[], int pixelCount,
+                            uint8_t r[], uint8_t g[], uint8_t b[]) const {
+    fFilterRow(padded, pixelCount, gCoefficients, r, g, b);
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkLCDFilter_DEFINED
+#define SkLCDFilter_DEFINED
+
+#include "SkLCDFilter_opts.h"
+
+/**
+ *  Row-at-a-time helpers for building LCD16 glyph masks, using SIMD where the
+ *  platform has it. Subpixels are kept in planar rows (all the reds, then
+ *  all the greens, then all the blues), so that a gamma table can be applied
+ *  to each channel in one tight pass before the row is packed.
+ */
+class SkLCDFilter {
+public:
+    /** Picks the platform's row procs, if it has any. */
+    SkLCDFilter();
+
+    /**
+     *  The number of bytes of padded samples filterRow() needs for pixelCount
+     *  pixels: 8 zeros, the row's samples, then zeros to the end.
+     */
+    static int PaddedSampleCount(int pixelCount) { return 4 * pixelCount + 16; }
+
+    /**
+     *  Filters a row of 4x horizontally oversampled coverage down to
+     *  pixelCount pixels of red, green and blue coverage, each subpixel being
+     *  a 12 tap FIR of the samples around it. padded is as described by
+     *  PaddedSampleCount(); pixel i is centered on samples 4 * i - 4 to
+     *  4 * i - 1 of the unpadded row.
+     */
+    void filterRow(const uint8_t padded[], int pixelCount,
+                   uint8_t r[], uint8_t g[], uint8_t b[]) const;
+
+    /** Replaces each of the count values in row with lut[value]. */
+    static void ApplyLUT(uint8_t row[], int count, const uint8_t lut[]) {
+        for (int i = 0; i < count; ++i) {
+            row[i] = lut[row[i]];
+        }
+    }
+
+    /** Packs count pixels of planar red, green and blue coverage to RGB16. */
+    void packRow(const uint8_t r[], const uint8_t g[], const uint8_t b[],
+                 uint16_t dst[], int count) const {
+        fPackRow(r, g, b, dst, count);
+    }
+
+private:
+    SkLCDFilterRowProc fFilterRow;
+    SkLCDPackRowProc   fPackRow;
+};
+
+#endif
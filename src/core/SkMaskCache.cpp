@@ -0,0 +1,148 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMaskCache.h"
+#include "SkChecksum.h"
+#include "SkTemplates.h"
+#include "SkThread.h"
+#include "SkTLRUByteCache.h"
+
+#ifndef SK_DEFAULT_MASK_CACHE_LIMIT
+    #define SK_DEFAULT_MASK_CACHE_LIMIT     (1024 * 1024)
+#endif
+
+// Larger masks would push most of the others out of the cache.
+static const size_t kMaxMaskBytes = 64 * 1024;
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkMaskCache::Entry::Entry(const SkMask& mask) : fMask(mask) {}
+
+SkMaskCache::Entry::~Entry() {
+    SkMask::FreeImage(fMask.fImage);
+}
+
+size_t SkMaskCache::Entry::bytesUsed() const {
+    return sizeof(*this) + fMask.computeTotalImageSize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Refers to the caller's bytes for lookups, and to a Rec's own copy once added.
+struct Key {
+    Key(const void* data, size_t size)
+        : fData(static_cast<const uint32_t*>(data))
+        , fSize(size)
+        , fHash(SkChecksum::Murmur3(fData, size)) {
+        SkASSERT(SkIsAlign4(size));
+    }
+
+    // A copy of other that refers to data, which must hold the same bytes.
+    Key(const uint32_t* data, const Key& other)
+        : fData(data)
+        , fSize(other.fSize)
+        , fHash(other.fHash) {}
+
+    bool operator==(const Key& other) const {
+        return fHash == other.fHash && fSize == other.fSize &&
+               0 == memcmp(fData, other.fData, fSize);
+    }
+
+    const uint32_t* fData;
+    size_t          fSize;
+    uint32_t        fHash;
+};
+
+struct Rec {
+    Rec(const Key& key, const SkMaskCache::Entry* entry)
+        : fStorage(key.fSize / sizeof(uint32_t))
+        , fKey(static_cast<const uint32_t*>(memcpy(fStorage.get(), key.fData, key.fSize)), key)
+        , fEntry(entry) {}
+    ~Rec() { fEntry->unref(); }
+
+    static const Key& GetKey(const Rec& rec) { return rec.fKey; }
+    static uint32_t Hash(const Key& key) { return key.fHash; }
+
+    size_t bytesUsed() const {
+        return sizeof(*this) + fKey.fSize + fEntry->bytesUsed();
+    }
+
+    SkAutoTMalloc<uint32_t>         fStorage;
+    const Key                       fKey;
+    const SkMaskCache::Entry* const fEntry;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Rec);
+};
+
+typedef SkTLRUByteCache<Rec, Key> Cache;
+
+}  // namespace
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+static Cache* gMaskCache = NULL;
+static void cleanup_gMaskCache() {
+#if SK_DEVELOPER
+    SkDELETE(gMaskCache);
+#endif
+}
+
+/** Must hold gMutex when calling. */
+static Cache* get_cache() {
+    gMutex.assertHeld();
+    if (NULL == gMaskCache) {
+        gMaskCache = SkNEW_ARGS(Cache, (SK_DEFAULT_MASK_CACHE_LIMIT));
+        atexit(cleanup_gMaskCache);
+    }
+    return gMaskCache;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const SkMaskCache::Entry* SkMaskCache::Find(const void* key, size_t keySize) {
+    const Key k(key, keySize);
+    SkAutoMutexAcquire am(gMutex);
+    Rec* rec = get_cache()->find(k);
+    return NULL == rec ? NULL : SkRef(rec->fEntry);
+}
+
+const SkMaskCache::Entry* SkMaskCache::Add(const void* key, size_t keySize,
+                                           const SkMask& mask) {
+    if (NULL == mask.fImage || mask.computeTotalImageSize() > kMaxMaskBytes) {
+        return NULL;
+    }
+    const Key k(key, keySize);
+    SkAutoTUnref<const Entry> entry(SkNEW_ARGS(Entry, (mask)));
+
+    SkAutoMutexAcquire am(gMutex);
+    if (Rec* existing = get_cache()->find(k)) {
+        return SkRef(existing->fEntry);
+    }
+    get_cache()->add(SkNEW_ARGS(Rec, (k, SkRef(entry.get()))));
+    return entry.detach();
+}
+
+size_t SkMaskCache::GetBytesUsed() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->bytesUsed();
+}
+
+size_t SkMaskCache::GetByteLimit() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->byteLimit();
+}
+
+size_t SkMaskCache::SetByteLimit(size_t newLimit) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->setByteLimit(newLimit);
+}
+
+void SkMaskCache::Purge() {
+    SkAutoMutexAcquire am(gMutex);
+    get_cache()->purgeAll();
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMaskCache_DEFINED
+#define SkMaskCache_DEFINED
+
+#include "SkMask.h"
+#include "SkRefCnt.h"
+
+/**
+ *  A global, size-bounded cache of small A8 masks that are expensive to make
+ *  and often made again the same, such as the nine-patches mask filters
+ *  stretch over rects and round rects. Shadows of many identical cards share
+ *  one blurred nine-patch.
+ *
+ *  Callers key their masks with whatever bytes describe them. The key must
+ *  identify what made the mask as well as its geometry, e.g. by starting with
+ *  a tag.
+ *
+ *  The static methods are thread-safe.
+ */
+class SkMaskCache {
+public:
+    /**
+     *  A cached mask. Immutable once created, so it may be drawn from any
+     *  thread.
+     */
+    class Entry : public SkRefCnt {
+    public:
+        virtual ~Entry();
+
+        const SkMask& mask() const { return fMask; }
+
+        /** Bytes of memory held by this entry. */
+        size_t bytesUsed() const;
+
+    private:
+        explicit Entry(const SkMask&);
+
+        const SkMask fMask;
+
+        friend class SkMaskCache;
+
+        typedef SkRefCnt INHERITED;
+    };
+
+    /**
+     *  Return the entry for the keySize bytes at key, ref()ed, or NULL if
+     *  there is none. keySize must be a multiple of 4.
+     */
+    static const Entry* Find(const void* key, size_t keySize);
+
+    /**
+     *  Cache mask under the keySize bytes at key and return its entry,
+     *  ref()ed. The cache takes ownership of mask.fImage, which must come from
+     *  SkMask::AllocImage(), and the caller should draw the returned entry's
+     *  mask from then on: if the key was added meanwhile, that entry is
+     *  returned and the image freed. Returns NULL, leaving the image to the
+     *  caller, if the mask is too big to be worth caching.
+     */
+    static const Entry* Add(const void* key, size_t keySize, const SkMask& mask);
+
+    static size_t GetBytesUsed();
+    static size_t GetByteLimit();
+    static size_t SetByteLimit(size_t newLimit);
+
+    /** Remove every entry from the cache. */
+    static void Purge();
+};
+
+#endif
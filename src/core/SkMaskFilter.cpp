@@ -211,7 +211,6 @@ bool SkMaskFilter::filterRRect(const SkRRect& devRRect, const SkMatrix& matrix,
     // cannot be used, return false to allow our caller to recover and perform
     // the drawing another way.
     NinePatch patch;
-    patch.fMask.fImage = NULL;
     if (kTrue_FilterReturn != this->filterRRectToNine(devRRect, matrix,
                                                       clip.getBounds(),
                                                       &patch)) {
@@ -219,7 +218,6 @@ bool SkMaskFilter::filterRRect(const SkRRect& devRRect, const SkMatrix& matrix,
         return false;
     }
     draw_nine(patch.fMask, patch.fOuterRect, patch.fCenter, true, clip, blitter);
-    SkMask::FreeImage(patch.fMask.fImage);
     return true;
 }
 
@@ -233,8 +231,6 @@ bool SkMaskFilter::filterPath(const SkPath& devPath, const SkMatrix& matrix,
     }
     if (rectCount > 0) {
         NinePatch patch;
-
-        patch.fMask.fImage = NULL;
         switch (this->filterRectsToNine(rects, rectCount, matrix,
                                         clip.getBounds(), &patch)) {
             case kFalse_FilterReturn:
@@ -244,7 +240,6 @@ bool SkMaskFilter::filterPath(const SkPath& devPath, const SkMatrix& matrix,
             case kTrue_FilterReturn:
                 draw_nine(patch.fMask, patch.fOuterRect, patch.fCenter, 1 == rectCount, clip,
                           blitter);
-                SkMask::FreeImage(patch.fMask.fImage);
                 return true;
 
             case kUnimplemented_FilterReturn:
@@ -285,6 +280,14 @@ bool SkMaskFilter::filterPath(const SkPath& devPath, const SkMatrix& matrix,
     return true;
 }
 
+SkMaskFilter::NinePatch::~NinePatch() {
+    if (NULL != fCache) {
+        fCache->unref();
+    } else {
+        SkMask::FreeImage(fMask.fImage);
+    }
+}
+
 SkMaskFilter::FilterReturn
 SkMaskFilter::filterRRectToNine(const SkRRect&, const SkMatrix&,
                                 const SkIRect& clipBounds, NinePatch*) const {
@@ -11,6 +11,12 @@
 
 #include <stddef.h>
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+    #include <arm_neon.h>
+#endif
+
 // In a few places, we performed the following
 //      a * b + c * d + e
 // as
@@ -867,19 +873,53 @@ void SkMatrix::Identity_pts(const SkMatrix& m, SkPoint dst[],
         memcpy(dst, src, count * sizeof(SkPoint));
 }
 
+/*  The procs below map as many points as they can a vector at a time, then
+    finish the rest one at a time. The vector code does each multiply and add
+    in the same order as the scalar code, so both give identical results.
+
+    With SSE2 a register holds two points, x0 y0 x1 y1. The affine procs splat
+    that into x0 x0 x1 x1 and y0 y0 y1 y1, so that each lane computes
+        lane's x or y = x * (mx or ky) + y * (kx or my) + (tx or ty)
+    With NEON, vld2q splits four points into a register of x and one of y.
+ */
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+static inline __m128 splat_x(__m128 pts) {
+    return _mm_shuffle_ps(pts, pts, _MM_SHUFFLE(2, 2, 0, 0));
+}
+
+static inline __m128 splat_y(__m128 pts) {
+    return _mm_shuffle_ps(pts, pts, _MM_SHUFFLE(3, 3, 1, 1));
+}
+#endif
+
 void SkMatrix::Trans_pts(const SkMatrix& m, SkPoint dst[],
                          const SkPoint src[], int count) {
     SkASSERT(m.getType() == kTranslate_Mask);
 
-    if (count > 0) {
-        SkScalar tx = m.fMat[kMTransX];
-        SkScalar ty = m.fMat[kMTransY];
-        do {
-            dst->fY = src->fY + ty;
-            dst->fX = src->fX + tx;
-            src += 1;
-            dst += 1;
-        } while (--count);
+    SkScalar tx = m.fMat[kMTransX];
+    SkScalar ty = m.fMat[kMTransY];
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 trans = _mm_setr_ps(tx, ty, tx, ty);
+    for (; count >= 2; count -= 2) {
+        _mm_storeu_ps(&dst->fX, _mm_add_ps(_mm_loadu_ps(&src->fX), trans));
+        src += 2;
+        dst += 2;
+    }
+#elif defined(__ARM_NEON__)
+    for (; count >= 4; count -= 4) {
+        float32x4x2_t pts = vld2q_f32(&src->fX);
+        pts.val[0] = vaddq_f32(pts.val[0], vdupq_n_f32(tx));
+        pts.val[1] = vaddq_f32(pts.val[1], vdupq_n_f32(ty));
+        vst2q_f32(&dst->fX, pts);
+        src += 4;
+        dst += 4;
+    }
+#endif
+    for (; count > 0; --count) {
+        dst->fY = src->fY + ty;
+        dst->fX = src->fX + tx;
+        src += 1;
+        dst += 1;
     }
 }
 
@@ -887,15 +927,30 @@ void SkMatrix::Scale_pts(const SkMatrix& m, SkPoint dst[],
                          const SkPoint src[], int count) {
     SkASSERT(m.getType() == kScale_Mask);
 
-    if (count > 0) {
-        SkScalar mx = m.fMat[kMScaleX];
-        SkScalar my = m.fMat[kMScaleY];
-        do {
-            dst->fY = src->fY * my;
-            dst->fX = src->fX * mx;
-            src += 1;
-            dst += 1;
-        } while (--count);
+    SkScalar mx = m.fMat[kMScaleX];
+    SkScalar my = m.fMat[kMScaleY];
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 scale = _mm_setr_ps(mx, my, mx, my);
+    for (; count >= 2; count -= 2) {
+        _mm_storeu_ps(&dst->fX, _mm_mul_ps(_mm_loadu_ps(&src->fX), scale));
+        src += 2;
+        dst += 2;
+    }
+#elif defined(__ARM_NEON__)
+    for (; count >= 4; count -= 4) {
+        float32x4x2_t pts = vld2q_f32(&src->fX);
+        pts.val[0] = vmulq_n_f32(pts.val[0], mx);
+        pts.val[1] = vmulq_n_f32(pts.val[1], my);
+        vst2q_f32(&dst->fX, pts);
+        src += 4;
+        dst += 4;
+    }
+#endif
+    for (; count > 0; --count) {
+        dst->fY = src->fY * my;
+        dst->fX = src->fX * mx;
+        src += 1;
+        dst += 1;
     }
 }
 
@@ -903,17 +958,34 @@ void SkMatrix::ScaleTrans_pts(const SkMatrix& m, SkPoint dst[],
                               const SkPoint src[], int count) {
     SkASSERT(m.getType() == (kScale_Mask | kTranslate_Mask));
 
-    if (count > 0) {
-        SkScalar mx = m.fMat[kMScaleX];
-        SkScalar my = m.fMat[kMScaleY];
-        SkScalar tx = m.fMat[kMTransX];
-        SkScalar ty = m.fMat[kMTransY];
-        do {
-            dst->fY = src->fY * my + ty;
-            dst->fX = src->fX * mx + tx;
-            src += 1;
-            dst += 1;
-        } while (--count);
+    SkScalar mx = m.fMat[kMScaleX];
+    SkScalar my = m.fMat[kMScaleY];
+    SkScalar tx = m.fMat[kMTransX];
+    SkScalar ty = m.fMat[kMTransY];
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 scale = _mm_setr_ps(mx, my, mx, my);
+    const __m128 trans = _mm_setr_ps(tx, ty, tx, ty);
+    for (; count >= 2; count -= 2) {
+        __m128 pts = _mm_mul_ps(_mm_loadu_ps(&src->fX), scale);
+        _mm_storeu_ps(&dst->fX, _mm_add_ps(pts, trans));
+        src += 2;
+        dst += 2;
+    }
+#elif defined(__ARM_NEON__)
+    for (; count >= 4; count -= 4) {
+        float32x4x2_t pts = vld2q_f32(&src->fX);
+        pts.val[0] = vaddq_f32(vmulq_n_f32(pts.val[0], mx), vdupq_n_f32(tx));
+        pts.val[1] = vaddq_f32(vmulq_n_f32(pts.val[1], my), vdupq_n_f32(ty));
+        vst2q_f32(&dst->fX, pts);
+        src += 4;
+        dst += 4;
+    }
+#endif
+    for (; count > 0; --count) {
+        dst->fY = src->fY * my + ty;
+        dst->fX = src->fX * mx + tx;
+        src += 1;
+        dst += 1;
     }
 }
 
@@ -921,19 +993,38 @@ void SkMatrix::Rot_pts(const SkMatrix& m, SkPoint dst[],
                        const SkPoint src[], int count) {
     SkASSERT((m.getType() & (kPerspective_Mask | kTranslate_Mask)) == 0);
 
-    if (count > 0) {
-        SkScalar mx = m.fMat[kMScaleX];
-        SkScalar my = m.fMat[kMScaleY];
-        SkScalar kx = m.fMat[kMSkewX];
-        SkScalar ky = m.fMat[kMSkewY];
-        do {
-            SkScalar sy = src->fY;
-            SkScalar sx = src->fX;
-            src += 1;
-            dst->fY = sdot(sx, ky, sy, my);
-            dst->fX = sdot(sx, mx, sy, kx);
-            dst += 1;
-        } while (--count);
+    SkScalar mx = m.fMat[kMScaleX];
+    SkScalar my = m.fMat[kMScaleY];
+    SkScalar kx = m.fMat[kMSkewX];
+    SkScalar ky = m.fMat[kMSkewY];
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 xCoeff = _mm_setr_ps(mx, ky, mx, ky);
+    const __m128 yCoeff = _mm_setr_ps(kx, my, kx, my);
+    for (; count >= 2; count -= 2) {
+        __m128 pts = _mm_loadu_ps(&src->fX);
+        _mm_storeu_ps(&dst->fX, _mm_add_ps(_mm_mul_ps(splat_x(pts), xCoeff),
+                                           _mm_mul_ps(splat_y(pts), yCoeff)));
+        src += 2;
+        dst += 2;
+    }
+#elif defined(__ARM_NEON__)
+    for (; count >= 4; count -= 4) {
+        const float32x4x2_t pts = vld2q_f32(&src->fX);
+        float32x4x2_t result;
+        result.val[0] = vaddq_f32(vmulq_n_f32(pts.val[0], mx), vmulq_n_f32(pts.val[1], kx));
+        result.val[1] = vaddq_f32(vmulq_n_f32(pts.val[0], ky), vmulq_n_f32(pts.val[1], my));
+        vst2q_f32(&dst->fX, result);
+        src += 4;
+        dst += 4;
+    }
+#endif
+    for (; count > 0; --count) {
+        SkScalar sy = src->fY;
+        SkScalar sx = src->fX;
+        src += 1;
+        dst->fY = sdot(sx, ky, sy, my);
+        dst->fX = sdot(sx, mx, sy, kx);
+        dst += 1;
     }
 }
 
@@ -941,26 +1032,60 @@ void SkMatrix::RotTrans_pts(const SkMatrix& m, SkPoint dst[],
                             const SkPoint src[], int count) {
     SkASSERT(!m.hasPerspective());
 
-    if (count > 0) {
-        SkScalar mx = m.fMat[kMScaleX];
-        SkScalar my = m.fMat[kMScaleY];
-        SkScalar kx = m.fMat[kMSkewX];
-        SkScalar ky = m.fMat[kMSkewY];
-        SkScalar tx = m.fMat[kMTransX];
-        SkScalar ty = m.fMat[kMTransY];
-        do {
-            SkScalar sy = src->fY;
-            SkScalar sx = src->fX;
-            src += 1;
+    SkScalar mx = m.fMat[kMScaleX];
+    SkScalar my = m.fMat[kMScaleY];
+    SkScalar kx = m.fMat[kMSkewX];
+    SkScalar ky = m.fMat[kMSkewY];
+    SkScalar tx = m.fMat[kMTransX];
+    SkScalar ty = m.fMat[kMTransY];
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 xCoeff = _mm_setr_ps(mx, ky, mx, ky);
+    const __m128 yCoeff = _mm_setr_ps(kx, my, kx, my);
+    const __m128 trans = _mm_setr_ps(tx, ty, tx, ty);
+    for (; count >= 2; count -= 2) {
+        __m128 pts = _mm_loadu_ps(&src->fX);
+        __m128 x = _mm_mul_ps(splat_x(pts), xCoeff);
+        __m128 y = _mm_mul_ps(splat_y(pts), yCoeff);
 #ifdef SK_LEGACY_MATRIX_MATH_ORDER
-            dst->fY = sx * ky + (sy * my + ty);
-            dst->fX = sx * mx + (sy * kx + tx);
+        _mm_storeu_ps(&dst->fX, _mm_add_ps(x, _mm_add_ps(y, trans)));
 #else
-            dst->fY = sdot(sx, ky, sy, my) + ty;
-            dst->fX = sdot(sx, mx, sy, kx) + tx;
+        _mm_storeu_ps(&dst->fX, _mm_add_ps(_mm_add_ps(x, y), trans));
 #endif
-            dst += 1;
-        } while (--count);
+        src += 2;
+        dst += 2;
+    }
+#elif defined(__ARM_NEON__)
+    for (; count >= 4; count -= 4) {
+        const float32x4x2_t pts = vld2q_f32(&src->fX);
+        float32x4x2_t result;
+#ifdef SK_LEGACY_MATRIX_MATH_ORDER
+        result.val[0] = vaddq_f32(vmulq_n_f32(pts.val[0], mx),
+                                  vaddq_f32(vmulq_n_f32(pts.val[1], kx), vdupq_n_f32(tx)));
+        result.val[1] = vaddq_f32(vmulq_n_f32(pts.val[0], ky),
+                                  vaddq_f32(vmulq_n_f32(pts.val[1], my), vdupq_n_f32(ty)));
+#else
+        result.val[0] = vaddq_f32(vaddq_f32(vmulq_n_f32(pts.val[0], mx),
+                                            vmulq_n_f32(pts.val[1], kx)), vdupq_n_f32(tx));
+        result.val[1] = vaddq_f32(vaddq_f32(vmulq_n_f32(pts.val[0], ky),
+                                            vmulq_n_f32(pts.val[1], my)), vdupq_n_f32(ty));
+#endif
+        vst2q_f32(&dst->fX, result);
+        src += 4;
+        dst += 4;
+    }
+#endif
+    for (; count > 0; --count) {
+        SkScalar sy = src->fY;
+        SkScalar sx = src->fX;
+        src += 1;
+#ifdef SK_LEGACY_MATRIX_MATH_ORDER
+        dst->fY = sx * ky + (sy * my + ty);
+        dst->fX = sx * mx + (sy * kx + tx);
+#else
+        dst->fY = sdot(sx, ky, sy, my) + ty;
+        dst->fX = sdot(sx, mx, sy, kx) + tx;
+#endif
+        dst += 1;
     }
 }
 
@@ -968,27 +1093,57 @@ void SkMatrix::Persp_pts(const SkMatrix& m, SkPoint dst[],
                          const SkPoint src[], int count) {
     SkASSERT(m.hasPerspective());
 
-    if (count > 0) {
-        do {
-            SkScalar sy = src->fY;
-            SkScalar sx = src->fX;
-            src += 1;
+    // NEON (ARMv7) has no exact divide, so it only gets the scalar loop.
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 xCoeff = _mm_setr_ps(m.fMat[kMScaleX], m.fMat[kMSkewY],
+                                      m.fMat[kMScaleX], m.fMat[kMSkewY]);
+    const __m128 yCoeff = _mm_setr_ps(m.fMat[kMSkewX], m.fMat[kMScaleY],
+                                      m.fMat[kMSkewX], m.fMat[kMScaleY]);
+    const __m128 trans = _mm_setr_ps(m.fMat[kMTransX], m.fMat[kMTransY],
+                                     m.fMat[kMTransX], m.fMat[kMTransY]);
+    const __m128 persp0 = _mm_set1_ps(m.fMat[kMPersp0]);
+    const __m128 persp1 = _mm_set1_ps(m.fMat[kMPersp1]);
+    const __m128 persp2 = _mm_set1_ps(m.fMat[kMPersp2]);
+    const __m128 zero = _mm_setzero_ps();
+    for (; count >= 2; count -= 2) {
+        __m128 pts = _mm_loadu_ps(&src->fX);
+        __m128 sx = splat_x(pts);
+        __m128 sy = splat_y(pts);
+        __m128 xy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, xCoeff), _mm_mul_ps(sy, yCoeff)),
+                               trans);
+#ifdef SK_LEGACY_MATRIX_MATH_ORDER
+        __m128 z = _mm_add_ps(_mm_mul_ps(sx, persp0),
+                              _mm_add_ps(_mm_mul_ps(sy, persp1), persp2));
+#else
+        __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, persp0), _mm_mul_ps(sy, persp1)),
+                              persp2);
+#endif
+        // As below, a zero z is left as zero rather than inverted.
+        z = _mm_and_ps(_mm_cmpneq_ps(z, zero), _mm_div_ps(_mm_set1_ps(SK_Scalar1), z));
+        _mm_storeu_ps(&dst->fX, _mm_mul_ps(xy, z));
+        src += 2;
+        dst += 2;
+    }
+#endif
+    for (; count > 0; --count) {
+        SkScalar sy = src->fY;
+        SkScalar sx = src->fX;
+        src += 1;
 
-            SkScalar x = sdot(sx, m.fMat[kMScaleX], sy, m.fMat[kMSkewX])  + m.fMat[kMTransX];
-            SkScalar y = sdot(sx, m.fMat[kMSkewY],  sy, m.fMat[kMScaleY]) + m.fMat[kMTransY];
+        SkScalar x = sdot(sx, m.fMat[kMScaleX], sy, m.fMat[kMSkewX])  + m.fMat[kMTransX];
+        SkScalar y = sdot(sx, m.fMat[kMSkewY],  sy, m.fMat[kMScaleY]) + m.fMat[kMTransY];
 #ifdef SK_LEGACY_MATRIX_MATH_ORDER
-            SkScalar z = sx * m.fMat[kMPersp0] + (sy * m.fMat[kMPersp1] + m.fMat[kMPersp2]);
+        SkScalar z = sx * m.fMat[kMPersp0] + (sy * m.fMat[kMPersp1] + m.fMat[kMPersp2]);
 #else
-            SkScalar z = sdot(sx, m.fMat[kMPersp0], sy, m.fMat[kMPersp1]) + m.fMat[kMPersp2];
+        SkScalar z = sdot(sx, m.fMat[kMPersp0], sy, m.fMat[kMPersp1]) + m.fMat[kMPersp2];
 #endif
-            if (z) {
-                z = SkScalarFastInvert(z);
-            }
+        if (z) {
+            z = SkScalarFastInvert(z);
+        }
 
-            dst->fY = y * z;
-            dst->fX = x * z;
-            dst += 1;
-        } while (--count);
+        dst->fY = y * z;
+        dst->fX = x * z;
+        dst += 1;
     }
 }
 
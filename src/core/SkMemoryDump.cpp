@@ -0,0 +1,54 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMemoryDump.h"
+
+#include "SkGraphics.h"
+#include "SkScaledImageCache.h"
+#include "SkThread.h"
+
+// Procs registered by caches outside of core. They are only ever added, and
+// there are only a handful of such caches, so a fixed array will do.
+static const int kMaxGlobalProcs = 16;
+
+SK_DECLARE_STATIC_MUTEX(gProcsMutex);
+static SkMemoryDump::DumpProc gProcs[kMaxGlobalProcs];
+static int gProcCount;
+
+void SkMemoryDump::RegisterGlobalProc(DumpProc proc) {
+    SkAutoMutexAcquire lock(gProcsMutex);
+    for (int i = 0; i < gProcCount; ++i) {
+        if (gProcs[i] == proc) {
+            return;
+        }
+    }
+    SkASSERT(gProcCount < kMaxGlobalProcs);
+    if (gProcCount < kMaxGlobalProcs) {
+        gProcs[gProcCount++] = proc;
+    }
+}
+
+void SkGraphics::DumpMemoryStatistics(SkMemoryDump* dump) {
+    // The strikes in the font cache are all purgeable; the ones being drawn
+    // with are taken out of the cache, and out of its total, meanwhile.
+    const size_t fontCacheUsed = SkGraphics::GetFontCacheUsed();
+    dump->dumpCache("skia/font_cache", fontCacheUsed, fontCacheUsed);
+
+    SkScaledImageCache::DumpMemoryStatistics(dump);
+
+    // Copy the procs so that they may register others, or take their own locks.
+    SkMemoryDump::DumpProc procs[kMaxGlobalProcs];
+    int count;
+    {
+        SkAutoMutexAcquire lock(gProcsMutex);
+        count = gProcCount;
+        memcpy(procs, gProcs, count * sizeof(SkMemoryDump::DumpProc));
+    }
+    for (int i = 0; i < count; ++i) {
+        procs[i](dump);
+    }
+}
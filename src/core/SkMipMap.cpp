@@ -8,33 +8,37 @@
 #include "SkMipMap.h"
 #include "SkBitmap.h"
 #include "SkColorPriv.h"
-
-static void downsampleby2_proc32(SkBitmap* dst, int x, int y,
-                                 const SkBitmap& src) {
-    x <<= 1;
-    y <<= 1;
-    const SkPMColor* p = src.getAddr32(x, y);
-    const SkPMColor* baseP = p;
-    SkPMColor c, ag, rb;
-
-    c = *p; ag = (c >> 8) & 0xFF00FF; rb = c & 0xFF00FF;
-    if (x < src.width() - 1) {
-        p += 1;
-    }
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
-
-    p = baseP;
-    if (y < src.height() - 1) {
-        p += src.rowBytes() >> 2;
+#include "SkDiscardableMemory.h"
+#include "SkMipMap_opts.h"
+
+// Each downsample proc reduces two rows of the larger level to one of the smaller, each pixel
+// the average of a 2x2 block. The smaller level is half the size rounded down, so an odd last
+// row or column of the larger one is left out.
+typedef void (*DownsampleRowProc)(void* dst, const void* src0, const void* src1, int dstWidth);
+
+static void downsample_row32(void* dst, const void* src0, const void* src1, int dstWidth) {
+    SkPMColor* d = static_cast<SkPMColor*>(dst);
+    const SkPMColor* p0 = static_cast<const SkPMColor*>(src0);
+    const SkPMColor* p1 = static_cast<const SkPMColor*>(src1);
+    for (int i = 0; i < dstWidth; ++i) {
+        SkPMColor c, ag, rb;
+
+        c = p0[0]; ag = (c >> 8) & 0xFF00FF; rb = c & 0xFF00FF;
+        c = p0[1]; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
+        c = p1[0]; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
+        c = p1[1]; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
+
+        d[i] = ((rb >> 2) & 0xFF00FF) | ((ag << 6) & 0xFF00FF00);
+        p0 += 2;
+        p1 += 2;
     }
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
-    if (x < src.width() - 1) {
-        p += 1;
-    }
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
+}
 
-    *dst->getAddr32(x >> 1, y >> 1) =
-    ((rb >> 2) & 0xFF00FF) | ((ag << 6) & 0xFF00FF00);
+static void downsample_row32_platform(void* dst, const void* src0, const void* src1,
+                                      int dstWidth) {
+    static const SkMipMapDownsample32Proc gProc = SkMipMapGetPlatformDownsample32Proc();
+    gProc(static_cast<SkPMColor*>(dst), static_cast<const SkPMColor*>(src0),
+          static_cast<const SkPMColor*>(src1), dstWidth);
 }
 
 static inline uint32_t expand16(U16CPU c) {
@@ -47,31 +51,16 @@ static inline U16CPU pack16(uint32_t c) {
     return (c & ~SK_G16_MASK_IN_PLACE) | ((c >> 16) & SK_G16_MASK_IN_PLACE);
 }
 
-static void downsampleby2_proc16(SkBitmap* dst, int x, int y,
-                                 const SkBitmap& src) {
-    x <<= 1;
-    y <<= 1;
-    const uint16_t* p = src.getAddr16(x, y);
-    const uint16_t* baseP = p;
-    SkPMColor       c;
-
-    c = expand16(*p);
-    if (x < src.width() - 1) {
-        p += 1;
+static void downsample_row16(void* dst, const void* src0, const void* src1, int dstWidth) {
+    uint16_t* d = static_cast<uint16_t*>(dst);
+    const uint16_t* p0 = static_cast<const uint16_t*>(src0);
+    const uint16_t* p1 = static_cast<const uint16_t*>(src1);
+    for (int i = 0; i < dstWidth; ++i) {
+        uint32_t c = expand16(p0[0]) + expand16(p0[1]) + expand16(p1[0]) + expand16(p1[1]);
+        d[i] = (uint16_t)pack16(c >> 2);
+        p0 += 2;
+        p1 += 2;
     }
-    c += expand16(*p);
-
-    p = baseP;
-    if (y < src.height() - 1) {
-        p += src.rowBytes() >> 1;
-    }
-    c += expand16(*p);
-    if (x < src.width() - 1) {
-        p += 1;
-    }
-    c += expand16(*p);
-
-    *dst->getAddr16(x >> 1, y >> 1) = (uint16_t)pack16(c >> 2);
 }
 
 static uint32_t expand4444(U16CPU c) {
@@ -82,66 +71,39 @@ static U16CPU collaps4444(uint32_t c) {
     return (c & 0xF0F) | ((c >> 12) & ~0xF0F);
 }
 
-static void downsampleby2_proc4444(SkBitmap* dst, int x, int y,
-                                   const SkBitmap& src) {
-    x <<= 1;
-    y <<= 1;
-    const uint16_t* p = src.getAddr16(x, y);
-    const uint16_t* baseP = p;
-    uint32_t        c;
-
-    c = expand4444(*p);
-    if (x < src.width() - 1) {
-        p += 1;
-    }
-    c += expand4444(*p);
-
-    p = baseP;
-    if (y < src.height() - 1) {
-        p += src.rowBytes() >> 1;
-    }
-    c += expand4444(*p);
-    if (x < src.width() - 1) {
-        p += 1;
-    }
-    c += expand4444(*p);
-
-    *dst->getAddr16(x >> 1, y >> 1) = (uint16_t)collaps4444(c >> 2);
-}
-
-SkMipMap::Level* SkMipMap::AllocLevels(int levelCount, size_t pixelSize) {
-    if (levelCount < 0) {
-        return NULL;
-    }
-    int64_t size = sk_64_mul(levelCount + 1, sizeof(Level)) + pixelSize;
-    if (!sk_64_isS32(size)) {
-        return NULL;
+static void downsample_row4444(void* dst, const void* src0, const void* src1, int dstWidth) {
+    uint16_t* d = static_cast<uint16_t*>(dst);
+    const uint16_t* p0 = static_cast<const uint16_t*>(src0);
+    const uint16_t* p1 = static_cast<const uint16_t*>(src1);
+    for (int i = 0; i < dstWidth; ++i) {
+        uint32_t c = expand4444(p0[0]) + expand4444(p0[1]) +
+                     expand4444(p1[0]) + expand4444(p1[1]);
+        d[i] = (uint16_t)collaps4444(c >> 2);
+        p0 += 2;
+        p1 += 2;
     }
-    return (Level*)sk_malloc_throw(sk_64_asS32(size));
 }
 
-SkMipMap* SkMipMap::Build(const SkBitmap& src) {
-    void (*proc)(SkBitmap* dst, int x, int y, const SkBitmap& src);
-
-    const SkColorType ct = src.colorType();
-    const SkAlphaType at = src.alphaType();
+static DownsampleRowProc choose_downsample_proc(SkColorType ct) {
     switch (ct) {
         case kRGBA_8888_SkColorType:
         case kBGRA_8888_SkColorType:
-            proc = downsampleby2_proc32;
-            break;
+            if (SkMipMapGetPlatformDownsample32Proc()) {
+                return downsample_row32_platform;
+            }
+            return downsample_row32;
         case kRGB_565_SkColorType:
-            proc = downsampleby2_proc16;
-            break;
+            return downsample_row16;
         case kARGB_4444_SkColorType:
-            proc = downsampleby2_proc4444;
-            break;
+            return downsample_row4444;
         default:
             return NULL; // don't build mipmaps for any other colortypes (yet)
     }
+}
 
-    SkAutoLockPixels alp(src);
-    if (!src.readyToDraw()) {
+SkMipMap* SkMipMap::Build(const SkBitmap& src, DiscardableFactory factory) {
+    const SkColorType ct = src.colorType();
+    if (NULL == choose_downsample_proc(ct)) {
         return NULL;
     }
 
@@ -165,60 +127,150 @@ SkMipMap* SkMipMap::Build(const SkBitmap& src) {
         return NULL;
     }
 
-    Level* levels = SkMipMap::AllocLevels(countLevels, size);
-    if (NULL == levels) {
+    int64_t levelsSize = sk_64_mul(countLevels, sizeof(LevelRec));
+    if (!sk_64_isS32(levelsSize) || !sk_64_isS32(size)) {
         return NULL;
     }
+    LevelRec* levels = (LevelRec*)sk_malloc_throw(sk_64_asS32(levelsSize));
 
-    uint8_t*    baseAddr = (uint8_t*)&levels[countLevels];
-    uint8_t*    addr = baseAddr;
+    size_t      offset = 0;
     int         width = src.width();
     int         height = src.height();
-    uint32_t    rowBytes;
-    SkBitmap    srcBM(src);
-
     for (int i = 0; i < countLevels; ++i) {
         width >>= 1;
         height >>= 1;
-        rowBytes = SkToU32(SkColorTypeMinRowBytes(ct, width));
+        uint32_t rowBytes = SkToU32(SkColorTypeMinRowBytes(ct, width));
+
+        levels[i].fLevel.fPixels   = NULL;
+        levels[i].fLevel.fWidth    = width;
+        levels[i].fLevel.fHeight   = height;
+        levels[i].fLevel.fRowBytes = rowBytes;
+        levels[i].fLevel.fScale    = (float)width / src.width();
+        levels[i].fOffset = offset;
+        levels[i].fBuilt = false;
+        offset += height * rowBytes;
+    }
+    SkASSERT(offset == size);
 
-        levels[i].fPixels   = addr;
-        levels[i].fWidth    = width;
-        levels[i].fHeight   = height;
-        levels[i].fRowBytes = rowBytes;
-        levels[i].fScale    = (float)width / src.width();
+    return SkNEW_ARGS(SkMipMap, (src, levels, countLevels, size, factory));
+}
 
-        SkBitmap dstBM;
-        dstBM.installPixels(SkImageInfo::Make(width, height, ct, at), addr, rowBytes);
+void* SkMipMap::storage() const {
+    fMutex.assertHeld();
+    if (NULL == fFactory) {
+        if (NULL == fStorage) {
+            fStorage = sk_malloc_flags(fSize, 0);
+        }
+    } else if (0 == fStorageLockCount) {
+        // Only valid while the owner holds a lock.
+        return NULL;
+    }
+    return fStorage;
+}
 
-        srcBM.lockPixels();
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                proc(&dstBM, x, y, srcBM);
-            }
+bool SkMipMap::buildLevel(int index) const {
+    fMutex.assertHeld();
+    LevelRec& rec = fLevels[index];
+    if (rec.fBuilt) {
+        return true;
+    }
+
+    void* base = this->storage();
+    if (NULL == base) {
+        return false;
+    }
+
+    const void* srcPixels;
+    size_t srcRowBytes;
+    SkAutoLockPixels alp(fSrc, 0 == index);
+    if (0 == index) {
+        if (!fSrc.readyToDraw()) {
+            return false;
+        }
+        srcPixels = fSrc.getPixels();
+        srcRowBytes = fSrc.rowBytes();
+    } else {
+        if (!this->buildLevel(index - 1)) {
+            return false;
         }
-        srcBM.unlockPixels();
+        const LevelRec& larger = fLevels[index - 1];
+        srcPixels = static_cast<const char*>(base) + larger.fOffset;
+        srcRowBytes = larger.fLevel.fRowBytes;
+    }
 
-        srcBM = dstBM;
-        addr += height * rowBytes;
+    DownsampleRowProc proc = choose_downsample_proc(fColorType);
+    const char* src = static_cast<const char*>(srcPixels);
+    char* dst = static_cast<char*>(base) + rec.fOffset;
+    for (uint32_t y = 0; y < rec.fLevel.fHeight; ++y) {
+        proc(dst, src, src + srcRowBytes, rec.fLevel.fWidth);
+        src += 2 * srcRowBytes;
+        dst += rec.fLevel.fRowBytes;
     }
-    SkASSERT(addr == baseAddr + size);
+    rec.fBuilt = true;
 
-    return SkNEW_ARGS(SkMipMap, (levels, countLevels, size));
+    if (0 == index && NULL == fFactory) {
+        // The smaller levels are built from this one, and it can't be purged.
+        fSrc.reset();
+    }
+    return true;
+}
+
+void SkMipMap::lockStorage() const {
+    SkAutoMutexAcquire lock(fMutex);
+    if (NULL == fFactory || fStorageLockCount++ > 0) {
+        return;
+    }
+    if (NULL != fDM && fDM->lock()) {
+        fStorage = fDM->data();
+        return;
+    }
+    // Purged, or never allocated: start over.
+    SkDELETE(fDM);
+    fDM = fFactory(fSize);
+    fStorage = NULL != fDM ? fDM->data() : NULL;
+    for (int i = 0; i < fCount; ++i) {
+        fLevels[i].fBuilt = false;
+    }
+}
+
+void SkMipMap::unlockStorage() const {
+    SkAutoMutexAcquire lock(fMutex);
+    if (NULL == fFactory) {
+        return;
+    }
+    SkASSERT(fStorageLockCount > 0);
+    if (0 == --fStorageLockCount && NULL != fDM) {
+        fDM->unlock();
+        fStorage = NULL;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 //static int gCounter;
 
-SkMipMap::SkMipMap(Level* levels, int count, size_t size)
-    : fSize(size), fLevels(levels), fCount(count) {
+SkMipMap::SkMipMap(const SkBitmap& src, LevelRec* levels, int count, size_t size,
+                   DiscardableFactory factory)
+    : fSize(size)
+    , fLevels(levels)
+    , fCount(count)
+    , fColorType(src.colorType())
+    , fSrc(src)
+    , fStorage(NULL)
+    , fFactory(factory)
+    , fDM(NULL)
+    , fStorageLockCount(0) {
     SkASSERT(levels);
     SkASSERT(count > 0);
 //    SkDebugf("mips %d\n", ++gCounter);
 }
 
 SkMipMap::~SkMipMap() {
+    SkASSERT(0 == fStorageLockCount);
+    if (NULL == fFactory) {
+        sk_free(fStorage);
+    }
+    SkDELETE(fDM);
     sk_free(fLevels);
 //    SkDebugf("mips %d\n", --gCounter);
 }
@@ -249,7 +301,12 @@ bool SkMipMap::extractLevel(SkScalar scale, Level* levelPtr) const {
         level = fCount;
     }
     if (levelPtr) {
-        *levelPtr = fLevels[level - 1];
+        SkAutoMutexAcquire lock(fMutex);
+        if (!this->buildLevel(level - 1)) {
+            return false;
+        }
+        *levelPtr = fLevels[level - 1].fLevel;
+        levelPtr->fPixels = static_cast<char*>(fStorage) + fLevels[level - 1].fOffset;
     }
     return true;
 }
@@ -8,14 +8,30 @@
 #ifndef SkMipMap_DEFINED
 #define SkMipMap_DEFINED
 
+#include "SkBitmap.h"
 #include "SkRefCnt.h"
 #include "SkScalar.h"
+#include "SkThread.h"
 
-class SkBitmap;
+class SkDiscardableMemory;
 
+/**
+ *  The levels of a mipmap are generated lazily: extractLevel() builds the level it returns (and
+ *  the larger ones it is reduced from) the first time it is asked for, so a draw only pays for
+ *  the levels it samples. The storage for all of them is reserved by Build(), so getSize() does
+ *  not change.
+ */
 class SkMipMap : public SkRefCnt {
 public:
-    static SkMipMap* Build(const SkBitmap& src);
+    typedef SkDiscardableMemory* (*DiscardableFactory)(size_t bytes);
+
+    /**
+     *  Returns a mipmap of src, or NULL if src is too small or of an unsupported color type.
+     *  The mipmap keeps a ref to src's pixels until it no longer needs them. If factory is not
+     *  NULL, the levels are stored in discardable memory that the owner must lock with
+     *  lockStorage() around calls to extractLevel() and uses of the levels.
+     */
+    static SkMipMap* Build(const SkBitmap& src, DiscardableFactory factory = NULL);
 
     struct Level {
         void*       fPixels;
@@ -28,16 +44,41 @@ public:
 
     size_t getSize() const { return fSize; }
 
+    /**
+     *  Pins the storage of the levels, if it is discardable. If it was purged, the levels are
+     *  built again as they are extracted. Calls nest, and must be balanced by unlockStorage().
+     */
+    void lockStorage() const;
+    void unlockStorage() const;
+
 private:
-    size_t  fSize;
-    Level*  fLevels;
-    int     fCount;
+    struct LevelRec {
+        Level   fLevel;     // fPixels is filled in by extractLevel()
+        size_t  fOffset;    // of the pixels in the storage
+        bool    fBuilt;
+    };
+
+    size_t      fSize;
+    LevelRec*   fLevels;
+    int         fCount;
+    SkColorType fColorType;
+
+    // Guards everything below, which extractLevel() changes as it builds levels.
+    mutable SkMutex fMutex;
+    // The source, until level 0 is built into storage that can not be purged.
+    mutable SkBitmap fSrc;
+    mutable void* fStorage;
+    DiscardableFactory fFactory;
+    mutable SkDiscardableMemory* fDM;
+    mutable int fStorageLockCount;
 
     // we take ownership of levels, and will free it with sk_free()
-    SkMipMap(Level* levels, int count, size_t size);
+    SkMipMap(const SkBitmap& src, LevelRec* levels, int count, size_t size,
+             DiscardableFactory factory);
     virtual ~SkMipMap();
 
-    static Level* AllocLevels(int levelCount, size_t pixelSize);
+    void* storage() const;
+    bool buildLevel(int index) const;
 };
 
 #endif
@@ -2108,6 +2108,43 @@ size_t SkPath::readFromMemory(const void* storage, size_t length) {
     return sizeRead;
 }
 
+bool SkPath::writeToCompact(SkTDArray<uint8_t>* data) const {
+    SkDEBUGCODE(this->validate();)
+
+    // Quantizing can dent a nearly convex path, so the convexity is recomputed
+    // when the path is read rather than stored.
+    *data->append() = SkToU8(fFillType | ((kUnknown_Convexity != fConvexity) << 2));
+    if (!fPathRef->writeCompact(data)) {
+        data->setCount(data->count() - 1);
+        return false;
+    }
+    return true;
+}
+
+bool SkPath::readFromCompact(const void* storage, size_t length) {
+    SkRBufferWithSizeCheck buffer(storage, length);
+
+    uint8_t packed;
+    if (!buffer.readU8(&packed)) {
+        return false;
+    }
+    SkPathRef* pathRef = SkPathRef::CreateFromCompact(&buffer);
+    if (NULL == pathRef) {
+        return false;
+    }
+
+    fPathRef.reset(pathRef);
+    fFillType = packed & 0x3;
+    fConvexity = kUnknown_Convexity;
+    fDirection = kUnknown_Direction;
+    this->updateBoundsCache();
+    if (packed & 0x4) {
+        (void)this->getConvexity();
+    }
+    SkDEBUGCODE(this->validate();)
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SkString.h"
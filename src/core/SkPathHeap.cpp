@@ -6,6 +6,7 @@
  * found in the LICENSE file.
  */
 #include "SkPathHeap.h"
+#include "SkOnce.h"
 #include "SkPath.h"
 #include "SkStream.h"
 #include "SkReadBuffer.h"
@@ -15,12 +16,48 @@
 
 #define kPathCount  64
 
+// Leads each path of the compact encoding that is quantized. Paths that could
+// not be quantized are written with writeToMemory() after a zero instead.
+static const uint8_t kCompactPathTag = 1;
+
 SkPathHeap::SkPathHeap() : fHeap(kPathCount * sizeof(SkPath)) {
 }
 
-SkPathHeap::SkPathHeap(SkReadBuffer& buffer)
+SkPathHeap::SkPathHeap(SkReadBuffer& buffer, Encoding encoding)
             : fHeap(kPathCount * sizeof(SkPath)) {
     const int count = buffer.readInt();
+    if (kCompact_Encoding == encoding) {
+        // Make sure the ends fit in the data, and come in order, so that
+        // expanding a path later can't read outside of it.
+        SkData* data = NULL;
+        if (buffer.validate(count >= 0)) {
+            fCompactEnds.setCount(count);
+            if (buffer.readIntArray(fCompactEnds.begin(), count)) {
+                data = buffer.readByteArrayAsData();
+            }
+        }
+        int32_t prevEnd = 0;
+        for (int i = 0; NULL != data && i < count; i++) {
+            if (!buffer.validate(fCompactEnds[i] >= prevEnd &&
+                                 (size_t)fCompactEnds[i] <= data->size())) {
+                data->unref();
+                data = NULL;
+            } else {
+                prevEnd = fCompactEnds[i];
+            }
+        }
+        if (NULL == data) {
+            // Leave every path empty.
+            fCompactEnds.reset();
+            if (count < 0) {
+                return;
+            }
+        } else {
+            fCompactData.reset(data);
+            fExpanded.reset(count);
+            sk_bzero(fExpanded.get(), count * sizeof(SkOnceFlag));
+        }
+    }
 
     fPaths.setCount(count);
     SkPath** ptr = fPaths.begin();
@@ -28,7 +65,9 @@ SkPathHeap::SkPathHeap(SkReadBuffer& buffer)
 
     for (int i = 0; i < count; i++) {
         new (p) SkPath;
-        buffer.readPath(p);
+        if (kFull_Encoding == encoding) {
+            buffer.readPath(p);
+        }
         *ptr++ = p; // record the pointer
         p++;        // move to the next storage location
     }
@@ -82,14 +121,63 @@ int SkPathHeap::insert(const SkPath& path) {
     return newSlot;
 }
 
-void SkPathHeap::flatten(SkWriteBuffer& buffer) const {
+void SkPathHeap::ExpandPath(ExpandArgs args) {
+    const SkPathHeap* heap = args.fHeap;
+    const int index = args.fIndex;
+    const int32_t start = index > 0 ? heap->fCompactEnds[index - 1] : 0;
+    const int32_t end = heap->fCompactEnds[index];
+    const uint8_t* data = heap->fCompactData->bytes() + start;
+    SkPath* path = heap->fPaths[index];
+    bool success;
+    if (end > start && kCompactPathTag == data[0]) {
+        success = path->readFromCompact(data + 1, end - start - 1);
+    } else {
+        success = end > start && path->readFromMemory(data + 1, end - start - 1) > 0;
+    }
+    if (!success) {
+        // The data was bad; leave the path empty.
+        path->reset();
+    }
+}
+
+void SkPathHeap::expand(int index) const {
+    SkASSERT((unsigned)index < (unsigned)fPaths.count());
+    ExpandArgs args = { this, index };
+    SkOnce(&fExpanded[index], ExpandPath, args);
+}
+
+void SkPathHeap::flatten(SkWriteBuffer& buffer, Encoding encoding) const {
     int count = fPaths.count();
 
     buffer.writeInt(count);
-    SkPath* const* iter = fPaths.begin();
-    SkPath* const* stop = fPaths.end();
-    while (iter < stop) {
-        buffer.writePath(**iter);
-        iter++;
+    if (kFull_Encoding == encoding) {
+        for (int i = 0; i < count; i++) {
+            buffer.writePath((*this)[i]);
+        }
+        return;
+    }
+
+    if (NULL != fCompactData.get()) {
+        // Rewrite what was read, rather than quantizing the paths again.
+        buffer.writeIntArray(fCompactEnds.begin(), count);
+        buffer.writeDataAsByteArray(fCompactData.get());
+        return;
+    }
+
+    SkTDArray<int32_t> ends;
+    SkTDArray<uint8_t> data;
+    ends.setCount(count);
+    for (int i = 0; i < count; i++) {
+        const SkPath& path = *fPaths[i];
+        const int start = data.count();
+        *data.append() = kCompactPathTag;
+        if (!path.writeToCompact(&data)) {
+            data[start] = 0;
+            size_t size = path.writeToMemory(NULL);
+            path.writeToMemory(data.append(SkToInt(size)));
+        }
+        ends[i] = data.count();
     }
+    buffer.writeIntArray(ends.begin(), count);
+    buffer.writeByteArray(data.begin(), data.count());
 }
@@ -10,8 +10,11 @@
 
 #include "SkRefCnt.h"
 #include "SkChunkAlloc.h"
+#include "SkData.h"
 #include "SkTDArray.h"
+#include "SkTemplates.h"
 
+class SkOnceFlag;
 class SkPath;
 class SkReadBuffer;
 class SkWriteBuffer;
@@ -20,8 +23,17 @@ class SkPathHeap : public SkRefCnt {
 public:
     SK_DECLARE_INST_COUNT(SkPathHeap)
 
+    enum Encoding {
+        kFull_Encoding,
+        /** Points quantized and delta encoded; see SkPicture::kCompactPaths_SerializeFlag. */
+        kCompact_Encoding,
+    };
+
     SkPathHeap();
-    SkPathHeap(SkReadBuffer&);
+    /** Reads what flatten() wrote with the same encoding. Compact paths are
+        only expanded the first time operator[] returns them.
+     */
+    SkPathHeap(SkReadBuffer&, Encoding = kFull_Encoding);
     virtual ~SkPathHeap();
 
     /** Copy the path into the heap, and return the new total number of paths.
@@ -38,10 +50,13 @@ public:
     // called during picture-playback
     int count() const { return fPaths.count(); }
     const SkPath& operator[](int index) const {
+        if (NULL != fCompactData.get()) {
+            this->expand(index);
+        }
         return *fPaths[index];
     }
 
-    void flatten(SkWriteBuffer&) const;
+    void flatten(SkWriteBuffer&, Encoding = kFull_Encoding) const;
 
 private:
     // we store the paths in the heap (placement new)
@@ -68,8 +83,23 @@ private:
 
     SkTDArray<LookupEntry> fLookupTable;
 
+    // Set while reading compact paths. Path i is encoded in fCompactData from
+    // fCompactEnds[i - 1] (or 0) to fCompactEnds[i], and fExpanded[i] guards
+    // decoding it into *fPaths[i], which is empty until then.
+    SkAutoTUnref<SkData>        fCompactData;
+    SkTDArray<int32_t>          fCompactEnds;
+    mutable SkAutoTMalloc<SkOnceFlag> fExpanded;
+
     SkPathHeap::LookupEntry* addIfNotPresent(const SkPath& path);
 
+    struct ExpandArgs {
+        const SkPathHeap* fHeap;
+        int               fIndex;
+    };
+
+    void expand(int index) const;
+    static void ExpandPath(ExpandArgs);
+
     typedef SkRefCnt INHERITED;
 };
 
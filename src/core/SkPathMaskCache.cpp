@@ -0,0 +1,388 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPathMaskCache.h"
+#include "SkBitmap.h"
+#include "SkBlitter.h"
+#include "SkChecksum.h"
+#include "SkCoreBlitters.h"
+#include "SkMatrix.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkRasterClip.h"
+#include "SkScan.h"
+#include "SkTemplates.h"
+#include "SkThread.h"
+#include "SkTLRUByteCache.h"
+
+#ifndef SK_DEFAULT_PATH_MASK_CACHE_LIMIT
+    #define SK_DEFAULT_PATH_MASK_CACHE_LIMIT     (2 * 1024 * 1024)
+#endif
+
+// Paths simpler than this are about as cheap to scan convert as to look up.
+static const int kMinVerbsToCache = 16;
+// Larger masks would push most of the others out of the cache.
+static const int64_t kMaxMaskPixels = 256 * 256;
+
+static const int kTileShift = 5;
+static const int kTileSize = 1 << kTileShift;
+
+static int tile_count(int size) {
+    return (size + kTileSize - 1) >> kTileShift;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct SkPathMaskCache::Mask::Tile {
+    enum Type {
+        kEmpty_Type,    // no coverage, nothing to blit
+        kFull_Type,     // fully covered, nothing stored
+        kPartial_Type,  // coverage stored at fImage + fOffset
+    };
+    Type    fType;
+    size_t  fOffset;
+};
+
+SkPathMaskCache::Mask::Mask(const SkIRect& bounds, Tile* tiles, uint8_t* image,
+                            size_t imageSize)
+    : fBounds(bounds)
+    , fTileCountX(tile_count(bounds.width()))
+    , fTileCountY(tile_count(bounds.height()))
+    , fTiles(tiles)
+    , fImage(image)
+    , fImageSize(imageSize) {}
+
+SkPathMaskCache::Mask::~Mask() {
+    SkDELETE_ARRAY(fTiles);
+    sk_free(fImage);
+}
+
+size_t SkPathMaskCache::Mask::bytesUsed() const {
+    return sizeof(*this) + fTileCountX * fTileCountY * sizeof(Tile) + fImageSize;
+}
+
+void SkPathMaskCache::Mask::draw(const SkMatrix& matrix, const SkRasterClip& clip,
+                                 SkBlitter* blitter) const {
+    SkIRect bounds = fBounds;
+    bounds.offset(SkScalarFloorToInt(matrix.getTranslateX()),
+                  SkScalarFloorToInt(matrix.getTranslateY()));
+    if (bounds.isEmpty() || !SkIRect::Intersects(bounds, clip.getBounds())) {
+        return;
+    }
+
+    // Clip exactly as SkScan::AntiFillPath would.
+    SkAAClipBlitterWrapper wrapper;
+    const SkRegion* clipRgn;
+    if (clip.isBW()) {
+        clipRgn = &clip.bwRgn();
+    } else {
+        wrapper.init(clip, blitter);
+        clipRgn = &wrapper.getRgn();
+        blitter = wrapper.getBlitter();
+    }
+    SkBlitterClipper clipper;
+    blitter = clipper.apply(blitter, clipRgn, &bounds);
+
+    // Replay the coverage through blitAntiH, one row at a time, so the pixels
+    // match those of an uncached draw.
+    const int width = bounds.width();
+    SkAutoSTMalloc<256, int16_t> runs(width + 1);
+    SkAutoSTMalloc<256, SkAlpha> alpha(width + 1);
+    for (int ty = 0; ty < fTileCountY; ++ty) {
+        const int top = ty << kTileShift;
+        const int bottom = SkMin32(top + kTileSize, bounds.height());
+        const Tile* rowTiles = fTiles + ty * fTileCountX;
+        for (int y = top; y < bottom; ++y) {
+            bool empty = true;
+            for (int tx = 0; tx < fTileCountX; ++tx) {
+                const Tile& tile = rowTiles[tx];
+                const int left = tx << kTileShift;
+                const int tileWidth = SkMin32(left + kTileSize, width) - left;
+                if (Tile::kEmpty_Type == tile.fType) {
+                    memset(&alpha[left], 0, tileWidth);
+                    continue;
+                }
+                empty = false;
+                if (Tile::kFull_Type == tile.fType) {
+                    memset(&alpha[left], 0xFF, tileWidth);
+                } else {
+                    memcpy(&alpha[left], fImage + tile.fOffset + (y - top) * tileWidth,
+                           tileWidth);
+                }
+            }
+            if (empty) {
+                continue;
+            }
+            for (int i = 0; i < width;) {
+                int j = i + 1;
+                while (j < width && alpha[j] == alpha[i]) {
+                    ++j;
+                }
+                runs[i] = SkToS16(j - i);
+                i = j;
+            }
+            runs[width] = 0;
+            blitter->blitAntiH(bounds.fLeft, bounds.fTop + y, alpha.get(), runs.get());
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Key {
+    Key(const SkPath& path, const SkMatrix& matrix, const SkPaint& paint) {
+        // Zero everything first, so padding and unused fields compare equal.
+        sk_bzero(this, sizeof(*this));
+        fGenID = path.getGenerationID();
+        fFlags = path.getFillType() | (paint.getStyle() << 2) |
+                 (paint.getStrokeCap() << 4) | (paint.getStrokeJoin() << 6);
+        fScaleX = matrix.getScaleX();
+        fSkewX = matrix.getSkewX();
+        fSkewY = matrix.getSkewY();
+        fScaleY = matrix.getScaleY();
+        fFracX = matrix.getTranslateX() - SkScalarFloorToScalar(matrix.getTranslateX());
+        fFracY = matrix.getTranslateY() - SkScalarFloorToScalar(matrix.getTranslateY());
+        if (SkPaint::kFill_Style != paint.getStyle()) {
+            fStrokeWidth = paint.getStrokeWidth();
+            fStrokeMiter = paint.getStrokeMiter();
+        }
+        fHash = SkChecksum::Murmur3(&fGenID, sizeof(*this) - sizeof(fHash));
+    }
+
+    bool operator==(const Key& other) const {
+        return 0 == memcmp(this, &other, sizeof(*this));
+    }
+
+    uint32_t fHash;
+    uint32_t fGenID;
+    uint32_t fFlags;
+    SkScalar fScaleX;
+    SkScalar fSkewX;
+    SkScalar fSkewY;
+    SkScalar fScaleY;
+    SkScalar fFracX;
+    SkScalar fFracY;
+    SkScalar fStrokeWidth;
+    SkScalar fStrokeMiter;
+};
+
+struct Rec {
+    Rec(const Key& key, const SkPathMaskCache::Mask* mask) : fKey(key), fMask(SkRef(mask)) {}
+    ~Rec() { fMask->unref(); }
+
+    static const Key& GetKey(const Rec& rec) { return rec.fKey; }
+    static uint32_t Hash(const Key& key) { return key.fHash; }
+
+    size_t bytesUsed() const { return sizeof(*this) + fMask->bytesUsed(); }
+
+    const Key                       fKey;
+    const SkPathMaskCache::Mask*    fMask;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Rec);
+};
+
+typedef SkTLRUByteCache<Rec, Key> Cache;
+
+}  // namespace
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+static Cache* gPathMaskCache = NULL;
+static void cleanup_gPathMaskCache() {
+#if SK_DEVELOPER
+    SkDELETE(gPathMaskCache);
+#endif
+}
+
+/** Must hold gMutex when calling. */
+static Cache* get_cache() {
+    gMutex.assertHeld();
+    if (NULL == gPathMaskCache) {
+        gPathMaskCache = SkNEW_ARGS(Cache, (SK_DEFAULT_PATH_MASK_CACHE_LIMIT,
+                                             Cache::kSecondSighting_AdmitPolicy));
+        atexit(cleanup_gPathMaskCache);
+    }
+    return gPathMaskCache;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*  Can the coverage of this draw be cached? The paint's own effects must not
+    change the coverage (or, for mask filters, depend on the clip), and the
+    device-space mask must be small enough to be worth keeping.
+ */
+static bool can_cache(const SkPath& path, const SkMatrix& matrix, const SkPaint& paint) {
+    if (!paint.isAntiAlias() || NULL != paint.getPathEffect() ||
+            NULL != paint.getMaskFilter() || NULL != paint.getRasterizer() ||
+            path.isInverseFillType() || matrix.hasPerspective() ||
+            path.countVerbs() < kMinVerbsToCache) {
+        return false;
+    }
+    if (SkPaint::kFill_Style != paint.getStyle() && 0 == paint.getStrokeWidth()) {
+        return false;  // hairline
+    }
+    if (!paint.canComputeFastBounds()) {
+        return false;
+    }
+    SkRect storage;
+    SkRect devBounds;
+    matrix.mapRect(&devBounds, paint.computeFastBounds(path.getBounds(), &storage));
+    return devBounds.isFinite() &&
+           (int64_t)SkScalarCeilToInt(devBounds.width() + 1) *
+                    SkScalarCeilToInt(devBounds.height() + 1) <= kMaxMaskPixels;
+}
+
+const SkPathMaskCache::Mask* SkPathMaskCache::CreateMask(const SkPath& path,
+                                                         const SkMatrix& matrix,
+                                                         const SkPaint& paint) {
+    SkPath fillPath;
+    const SkPath* srcPath = &path;
+    if (SkPaint::kFill_Style != paint.getStyle()) {
+        if (!paint.getFillPath(path, &fillPath)) {
+            return NULL;
+        }
+        srcPath = &fillPath;
+    }
+
+    // Render relative to the integer part of the translation.
+    SkMatrix fracMatrix(matrix);
+    fracMatrix.setTranslateX(matrix.getTranslateX() -
+                             SkScalarFloorToScalar(matrix.getTranslateX()));
+    fracMatrix.setTranslateY(matrix.getTranslateY() -
+                             SkScalarFloorToScalar(matrix.getTranslateY()));
+    SkPath devPath;
+    srcPath->transform(fracMatrix, &devPath);
+
+    SkIRect bounds;
+    devPath.getBounds().roundOut(&bounds);
+    if (bounds.isEmpty()) {
+        bounds.setEmpty();
+        return SkNEW_ARGS(Mask, (bounds, NULL, NULL, 0));
+    }
+    if ((int64_t)bounds.width() * bounds.height() > kMaxMaskPixels) {
+        return NULL;
+    }
+    devPath.offset(-SkIntToScalar(bounds.fLeft), -SkIntToScalar(bounds.fTop));
+
+    const int width = bounds.width();
+    const int height = bounds.height();
+    SkBitmap bm;
+    bm.allocPixels(SkImageInfo::MakeA8(width, height));
+    bm.eraseColor(SK_ColorTRANSPARENT);
+    {
+        SkPaint coveragePaint;
+        SkA8_Coverage_Blitter blitter(bm, coveragePaint);
+        SkScan::AntiFillPath(devPath, SkRasterClip(SkIRect::MakeWH(width, height)), &blitter);
+    }
+
+    // Classify the tiles, then pack the partially covered ones.
+    const int tileCountX = tile_count(width);
+    const int tileCountY = tile_count(height);
+    typedef Mask::Tile Tile;
+    Tile* tiles = SkNEW_ARRAY(Tile, tileCountX * tileCountY);
+    size_t imageSize = 0;
+    Tile* tile = tiles;
+    for (int ty = 0; ty < tileCountY; ++ty) {
+        const int top = ty << kTileShift;
+        const int bottom = SkMin32(top + kTileSize, height);
+        for (int tx = 0; tx < tileCountX; ++tx, ++tile) {
+            const int left = tx << kTileShift;
+            const int right = SkMin32(left + kTileSize, width);
+            bool empty = true, full = true;
+            for (int y = top; y < bottom && (empty || full); ++y) {
+                const uint8_t* row = bm.getAddr8(0, y);
+                for (int x = left; x < right; ++x) {
+                    empty &= 0x00 == row[x];
+                    full &= 0xFF == row[x];
+                }
+            }
+            if (empty) {
+                tile->fType = Tile::kEmpty_Type;
+            } else if (full) {
+                tile->fType = Tile::kFull_Type;
+            } else {
+                tile->fType = Tile::kPartial_Type;
+                tile->fOffset = imageSize;
+                imageSize += (right - left) * (bottom - top);
+            }
+        }
+    }
+
+    uint8_t* image = imageSize > 0 ? (uint8_t*)sk_malloc_throw(imageSize) : NULL;
+    tile = tiles;
+    for (int ty = 0; ty < tileCountY; ++ty) {
+        const int top = ty << kTileShift;
+        const int bottom = SkMin32(top + kTileSize, height);
+        for (int tx = 0; tx < tileCountX; ++tx, ++tile) {
+            if (Tile::kPartial_Type != tile->fType) {
+                continue;
+            }
+            const int left = tx << kTileShift;
+            const int tileWidth = SkMin32(left + kTileSize, width) - left;
+            uint8_t* dst = image + tile->fOffset;
+            for (int y = top; y < bottom; ++y) {
+                memcpy(dst, bm.getAddr8(left, y), tileWidth);
+                dst += tileWidth;
+            }
+        }
+    }
+
+    return SkNEW_ARGS(Mask, (bounds, tiles, image, imageSize));
+}
+
+const SkPathMaskCache::Mask* SkPathMaskCache::Find(const SkPath& path, const SkMatrix& matrix,
+                                                   const SkPaint& paint) {
+    if (!can_cache(path, matrix, paint)) {
+        return NULL;
+    }
+
+    const Key key(path, matrix, paint);
+    {
+        SkAutoMutexAcquire am(gMutex);
+        Rec* rec = get_cache()->find(key);
+        if (NULL != rec) {
+            return SkRef(rec->fMask);
+        }
+        if (!get_cache()->admit(key)) {
+            return NULL;
+        }
+    }
+
+    // Render the mask without holding the lock.
+    SkAutoTUnref<const Mask> mask(CreateMask(path, matrix, paint));
+    if (NULL == mask.get()) {
+        return NULL;
+    }
+
+    SkAutoMutexAcquire am(gMutex);
+    // Another thread may have rendered it too while we were.
+    if (NULL == get_cache()->find(key)) {
+        get_cache()->add(SkNEW_ARGS(Rec, (key, mask.get())));
+    }
+    return mask.detach();
+}
+
+size_t SkPathMaskCache::GetBytesUsed() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->bytesUsed();
+}
+
+size_t SkPathMaskCache::GetByteLimit() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->byteLimit();
+}
+
+size_t SkPathMaskCache::SetByteLimit(size_t newLimit) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->setByteLimit(newLimit);
+}
+
+void SkPathMaskCache::Purge() {
+    SkAutoMutexAcquire am(gMutex);
+    get_cache()->purgeAll();
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPathMaskCache_DEFINED
+#define SkPathMaskCache_DEFINED
+
+#include "SkRect.h"
+#include "SkRefCnt.h"
+
+class SkBlitter;
+class SkMatrix;
+class SkPaint;
+class SkPath;
+class SkRasterClip;
+
+/**
+ *  A global, size-bounded cache of the antialiased coverage of filled and
+ *  stroked paths, so that SkDraw::drawPath can blit a path drawn again with the
+ *  same matrix (up to an integer translation) without scan converting it.
+ *
+ *  Entries are keyed on the path's generation ID and fill type, the
+ *  non-translate part of the matrix, the fractional part of its translation,
+ *  and the paint's stroke parameters. A path is only rendered into the cache
+ *  the second time it is seen, so paths that are drawn once cost no more than
+ *  a lookup.
+ *
+ *  The static methods are thread-safe.
+ */
+class SkPathMaskCache {
+public:
+    /**
+     *  The coverage of a path, split into square tiles. Tiles the path does not
+     *  touch and tiles it covers entirely are not stored.
+     *  Immutable once created, so it may be drawn from any thread.
+     */
+    class Mask : public SkRefCnt {
+    public:
+        virtual ~Mask();
+
+        /**
+         *  Blit the coverage through blitter, clipped to clip, for the matrix
+         *  that was passed to Find(). The blitter sees the same blitAntiH()
+         *  coverage it would from SkScan::AntiFillPath().
+         */
+        void draw(const SkMatrix&, const SkRasterClip&, SkBlitter*) const;
+
+        /** Bytes of memory held by this mask. */
+        size_t bytesUsed() const;
+
+    private:
+        struct Tile;
+
+        Mask(const SkIRect& bounds, Tile* tiles, uint8_t* image, size_t imageSize);
+
+        const SkIRect   fBounds;    // relative to the integer part of the translation
+        const int       fTileCountX;
+        const int       fTileCountY;
+        Tile*           fTiles;
+        uint8_t*        fImage;     // pixels of the partially covered tiles
+        const size_t    fImageSize;
+
+        friend class SkPathMaskCache;
+
+        typedef SkRefCnt INHERITED;
+    };
+
+    /**
+     *  Return the cached coverage for drawing path with matrix and paint, or
+     *  NULL if that draw cannot be cached or has not been seen before. A
+     *  returned mask is ref()ed and must be unref()ed by the caller.
+     */
+    static const Mask* Find(const SkPath&, const SkMatrix&, const SkPaint&);
+
+    static size_t GetBytesUsed();
+    static size_t GetByteLimit();
+    static size_t SetByteLimit(size_t newLimit);
+
+    /** Remove every entry from the cache. */
+    static void Purge();
+
+private:
+    static const Mask* CreateMask(const SkPath&, const SkMatrix&, const SkPaint&);
+};
+
+#endif
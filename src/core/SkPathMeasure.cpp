@@ -8,9 +8,26 @@
 
 
 #include "SkPathMeasure.h"
+#include "SkChecksum.h"
 #include "SkGeometry.h"
 #include "SkPath.h"
+#include "SkTLRUByteCache.h"
 #include "SkTSearch.h"
+#include "SkThread.h"
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #include <float.h>
+#endif
+
+#ifndef SK_DEFAULT_PATH_MEASURE_CACHE_LIMIT
+    #define SK_DEFAULT_PATH_MEASURE_CACHE_LIMIT     (512 * 1024)
+#endif
+
+// Paths of only a few lines are about as cheap to measure as to look up.
+static const int kMinVerbsToCache = 16;
 
 // these must be 0,1,2 since they are in our 2-bit field
 enum {
@@ -41,98 +58,164 @@ const SkPathMeasure::Segment* SkPathMeasure::NextSegment(const Segment* seg) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static inline int tspan_big_enough(int tspan) {
-    SkASSERT((unsigned)tspan <= kMaxTValue);
-    return tspan >> 10;
-}
+struct SkPathMeasure::Contour {
+    int         fSegmentStart;  // index of this contour's first segment
+    int         fSegmentCount;
+    SkScalar    fLength;
+    bool        fIsClosed;
+};
 
-// can't use tangents, since we need [0..1..................2] to be seen
-// as definitely not a line (it is when drawn, but not parametrically)
-// so we compare midpoints
-#define CHEAP_DIST_LIMIT    (SK_Scalar1/2)  // just made this value up
-
-static bool quad_too_curvy(const SkPoint pts[3]) {
-    // diff = (a/4 + b/2 + c/4) - (a/2 + c/2)
-    // diff = -a/4 + b/2 - c/4
-    SkScalar dx = SkScalarHalf(pts[1].fX) -
-                        SkScalarHalf(SkScalarHalf(pts[0].fX + pts[2].fX));
-    SkScalar dy = SkScalarHalf(pts[1].fY) -
-                        SkScalarHalf(SkScalarHalf(pts[0].fY + pts[2].fY));
-
-    SkScalar dist = SkMaxScalar(SkScalarAbs(dx), SkScalarAbs(dy));
-    return dist > CHEAP_DIST_LIMIT;
-}
+/*  The measurements of a path's contours, appended one contour at a time as
+    they are needed. A table that has measured every contour can be shared by
+    all the measures of that path (see FindCachedTable()); it is then never
+    modified again, so may be read from any thread.
+ */
+class SkPathMeasure::Table : public SkRefCnt {
+public:
+    Table() : fNextPtIndex(-1), fDone(false) {}
 
-static bool cheap_dist_exceeds_limit(const SkPoint& pt,
-                                     SkScalar x, SkScalar y) {
-    SkScalar dist = SkMaxScalar(SkScalarAbs(x - pt.fX), SkScalarAbs(y - pt.fY));
-    // just made up the 1/2
-    return dist > CHEAP_DIST_LIMIT;
-}
+    /** Measure the next contour that iter returns, and append it. */
+    void appendContour(SkPath::Iter* iter, bool forceClosed);
 
-static bool cubic_too_curvy(const SkPoint pts[4]) {
-    return  cheap_dist_exceeds_limit(pts[1],
-                         SkScalarInterp(pts[0].fX, pts[3].fX, SK_Scalar1/3),
-                         SkScalarInterp(pts[0].fY, pts[3].fY, SK_Scalar1/3))
-                         ||
-            cheap_dist_exceeds_limit(pts[2],
-                         SkScalarInterp(pts[0].fX, pts[3].fX, SK_Scalar1*2/3),
-                         SkScalarInterp(pts[0].fY, pts[3].fY, SK_Scalar1*2/3));
-}
+    /** Measure and append all of iter's remaining contours. */
+    void appendAllContours(SkPath::Iter* iter, bool forceClosed) {
+        do {
+            this->appendContour(iter, forceClosed);
+        } while (!fDone);
+    }
 
-SkScalar SkPathMeasure::compute_quad_segs(const SkPoint pts[3],
-                          SkScalar distance, int mint, int maxt, int ptIndex) {
-    if (tspan_big_enough(maxt - mint) && quad_too_curvy(pts)) {
-        SkPoint tmp[5];
-        int     halft = (mint + maxt) >> 1;
+    int countContours() const { return fContours.count(); }
+    const Contour& getContour(int index) const { return fContours[index]; }
+    const Segment* getSegments(const Contour& contour) const {
+        return fSegments.begin() + contour.fSegmentStart;
+    }
+    const SkPoint* getPoints() const { return fPts.begin(); }
 
-        SkChopQuadAtHalf(pts, tmp);
-        distance = this->compute_quad_segs(tmp, distance, mint, halft, ptIndex);
-        distance = this->compute_quad_segs(&tmp[2], distance, halft, maxt, ptIndex);
-    } else {
-        SkScalar d = SkPoint::Distance(pts[0], pts[2]);
-        SkScalar prevD = distance;
-        distance += d;
-        if (distance > prevD) {
-            Segment* seg = fSegments.append();
-            seg->fDistance = distance;
-            seg->fPtIndex = ptIndex;
-            seg->fType = kQuad_SegType;
-            seg->fTValue = maxt;
-        }
+    size_t bytesUsed() const {
+        return sizeof(*this) + fSegments.reserved() * sizeof(Segment) +
+               fPts.reserved() * sizeof(SkPoint) + fContours.reserved() * sizeof(Contour);
     }
-    return distance;
-}
 
-SkScalar SkPathMeasure::compute_cubic_segs(const SkPoint pts[4],
-                           SkScalar distance, int mint, int maxt, int ptIndex) {
-    if (tspan_big_enough(maxt - mint) && cubic_too_curvy(pts)) {
-        SkPoint tmp[7];
-        int     halft = (mint + maxt) >> 1;
+private:
+    SkScalar compute_quad_segs(const SkPoint pts[3], SkScalar distance, int ptIndex);
+    SkScalar compute_cubic_segs(const SkPoint pts[4], SkScalar distance, int ptIndex);
+    SkScalar compute_chord_segs(const SkPoint& start, const SkPoint chordEnds[],
+                                int shift, SkScalar distance, int ptIndex,
+                                unsigned segType);
 
-        SkChopCubicAtHalf(pts, tmp);
-        distance = this->compute_cubic_segs(tmp, distance, mint, halft, ptIndex);
-        distance = this->compute_cubic_segs(&tmp[3], distance, halft, maxt, ptIndex);
-    } else {
-        SkScalar d = SkPoint::Distance(pts[0], pts[3]);
+    SkTDArray<Segment>  fSegments;
+    SkTDArray<SkPoint>  fPts;           // points used to define the segments
+    SkTDArray<Contour>  fContours;
+    int                 fNextPtIndex;   // index of the next contour's first point
+    bool                fDone;          // the iterator has no more contours
+
+    typedef SkRefCnt INHERITED;
+};
+
+/*  Curves are measured along chords that stay within kChordTolerance of them
+    (using the same Wang's formula bound the rasterizer flattens with). We can
+    use at most 1 << kMaxChordShift chords and still have 32 t-values between
+    their ends.
+*/
+static const SkScalar kChordTolerance = SK_Scalar1 / 2;
+static const int kMaxChordShift = 10;
+
+/*  Set lengths[i] to the length of the chord ending at ends[i], the first one
+    starting at start and each of the others at the previous end.
+ */
+static void chord_lengths(const SkPoint& start, const SkPoint ends[], int count,
+                          SkScalar lengths[]) {
+    lengths[0] = SkPoint::Distance(start, ends[0]);
+    int i = 1;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    for (; i + 4 <= count; i += 4) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(&ends[i].fX), _mm_loadu_ps(&ends[i - 1].fX));
+        __m128 e = _mm_sub_ps(_mm_loadu_ps(&ends[i + 2].fX), _mm_loadu_ps(&ends[i + 1].fX));
+        d = _mm_mul_ps(d, d);
+        e = _mm_mul_ps(e, e);
+        __m128 mag2 = _mm_add_ps(_mm_shuffle_ps(d, e, _MM_SHUFFLE(2, 0, 2, 0)),
+                                 _mm_shuffle_ps(d, e, _MM_SHUFFLE(3, 1, 3, 1)));
+        _mm_storeu_ps(&lengths[i], _mm_sqrt_ps(mag2));
+    }
+#elif defined(__ARM_NEON__)
+    const float32x4_t tiny = vdupq_n_f32(FLT_MIN);
+    for (; i + 4 <= count; i += 4) {
+        float32x4x2_t p = vld2q_f32(&ends[i].fX);
+        float32x4x2_t prev = vld2q_f32(&ends[i - 1].fX);
+        float32x4_t dx = vsubq_f32(p.val[0], prev.val[0]);
+        float32x4_t dy = vsubq_f32(p.val[1], prev.val[1]);
+        float32x4_t mag2 = vmlaq_f32(vmulq_f32(dx, dx), dy, dy);
+        // There is no vector square root, so refine an estimate of 1/sqrt.
+        float32x4_t x = vmaxq_f32(mag2, tiny);
+        float32x4_t est = vrsqrteq_f32(x);
+        est = vmulq_f32(est, vrsqrtsq_f32(vmulq_f32(x, est), est));
+        est = vmulq_f32(est, vrsqrtsq_f32(vmulq_f32(x, est), est));
+        vst1q_f32(&lengths[i], vmulq_f32(mag2, est));
+    }
+#endif
+    for (; i < count; ++i) {
+        lengths[i] = SkPoint::Distance(ends[i - 1], ends[i]);
+    }
+}
+
+SkScalar SkPathMeasure::Table::compute_chord_segs(const SkPoint& start,
+                                                  const SkPoint chordEnds[], int shift,
+                                                  SkScalar distance, int ptIndex,
+                                                  unsigned segType) {
+    int count = 1 << shift;
+    SkScalar lengths[1 << kMaxChordShift];
+    chord_lengths(start, chordEnds, count, lengths);
+    for (int i = 0; i < count; ++i) {
+        SkScalar d = lengths[i];
+        if (!SkScalarIsFinite(d)) {
+            // The squared length overflowed; SkPoint::Distance() copes.
+            d = SkPoint::Distance(i > 0 ? chordEnds[i - 1] : start, chordEnds[i]);
+        }
         SkScalar prevD = distance;
         distance += d;
         if (distance > prevD) {
             Segment* seg = fSegments.append();
             seg->fDistance = distance;
             seg->fPtIndex = ptIndex;
-            seg->fType = kCubic_SegType;
-            seg->fTValue = maxt;
+            seg->fType = segType;
+            seg->fTValue = ((i + 1) * kMaxTValue) >> shift;
         }
     }
     return distance;
 }
 
-void SkPathMeasure::buildSegments() {
+SkScalar SkPathMeasure::Table::compute_quad_segs(const SkPoint pts[3],
+                                                 SkScalar distance, int ptIndex) {
+    SkPoint chordEnds[1 << kMaxChordShift];
+    int shift = SkQuadSubdivisionShift(pts, kChordTolerance, kMaxChordShift);
+    SkEvalQuadUniform(pts, 1 << shift, chordEnds);
+    return this->compute_chord_segs(pts[0], chordEnds, shift, distance, ptIndex,
+                                    kQuad_SegType);
+}
+
+SkScalar SkPathMeasure::Table::compute_cubic_segs(const SkPoint pts[4],
+                                                  SkScalar distance, int ptIndex) {
+    SkPoint chordEnds[1 << kMaxChordShift];
+    int shift = SkCubicSubdivisionShift(pts, kChordTolerance, kMaxChordShift);
+    SkEvalCubicUniform(pts, 1 << shift, chordEnds);
+    return this->compute_chord_segs(pts[0], chordEnds, shift, distance, ptIndex,
+                                    kCubic_SegType);
+}
+
+void SkPathMeasure::Table::appendContour(SkPath::Iter* iter, bool forceClosed) {
+    Contour* contour = fContours.append();
+    contour->fSegmentStart = fSegments.count();
+    if (fDone) {
+        contour->fSegmentCount = 0;
+        contour->fLength = 0;
+        contour->fIsClosed = forceClosed;
+        return;
+    }
+
     SkPoint         pts[4];
-    int             ptIndex = fFirstPtIndex;
+    int             ptIndex = fNextPtIndex;
     SkScalar        distance = 0;
-    bool            isClosed = fForceClosed;
+    bool            isClosed = forceClosed;
     bool            firstMoveTo = ptIndex < 0;
     Segment*        seg;
 
@@ -141,12 +224,11 @@ void SkPathMeasure::buildSegments() {
      *  actually made it larger, since a very small delta might be > 0, but
      *  still have no effect on distance (if distance >>> delta).
      *
-     *  We do this check below, and in compute_quad_segs and compute_cubic_segs
+     *  We do this check below, and in compute_chord_segs
      */
-    fSegments.reset();
     bool done = false;
     do {
-        switch (fIter.next(pts)) {
+        switch (iter->next(pts)) {
             case SkPath::kConic_Verb:
                 SkASSERT(0);
                 break;
@@ -178,8 +260,7 @@ void SkPathMeasure::buildSegments() {
 
             case SkPath::kQuad_Verb: {
                 SkScalar prevD = distance;
-                distance = this->compute_quad_segs(pts, distance, 0,
-                                                   kMaxTValue, ptIndex);
+                distance = this->compute_quad_segs(pts, distance, ptIndex);
                 if (distance > prevD) {
                     fPts.append(2, pts + 1);
                     ptIndex += 2;
@@ -188,8 +269,7 @@ void SkPathMeasure::buildSegments() {
 
             case SkPath::kCubic_Verb: {
                 SkScalar prevD = distance;
-                distance = this->compute_cubic_segs(pts, distance, 0,
-                                                    kMaxTValue, ptIndex);
+                distance = this->compute_cubic_segs(pts, distance, ptIndex);
                 if (distance > prevD) {
                     fPts.append(3, pts + 1);
                     ptIndex += 3;
@@ -202,18 +282,20 @@ void SkPathMeasure::buildSegments() {
 
             case SkPath::kDone_Verb:
                 done = true;
+                fDone = true;
                 break;
         }
     } while (!done);
 
-    fLength = distance;
-    fIsClosed = isClosed;
-    fFirstPtIndex = ptIndex;
+    contour->fSegmentCount = fSegments.count() - contour->fSegmentStart;
+    contour->fLength = distance;
+    contour->fIsClosed = isClosed;
+    fNextPtIndex = ptIndex;
 
 #ifdef SK_DEBUG
     {
-        const Segment* seg = fSegments.begin();
-        const Segment* stop = fSegments.end();
+        const Segment* seg = this->getSegments(*contour);
+        const Segment* stop = seg + contour->fSegmentCount;
         unsigned        ptIndex = 0;
         SkScalar        distance = 0;
 
@@ -233,7 +315,6 @@ void SkPathMeasure::buildSegments() {
             ptIndex = seg->fPtIndex;
             seg += 1;
         }
-    //  SkDebugf("\n");
     }
 #endif
 }
@@ -333,59 +414,182 @@ static void seg_to(const SkPoint pts[], int segType,
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////////////////////////
 
-SkPathMeasure::SkPathMeasure() {
-    fPath = NULL;
-    fLength = -1;   // signal we need to compute it
-    fForceClosed = false;
-    fFirstPtIndex = -1;
+namespace {
+
+struct Key {
+    Key(const SkPath& path, bool forceClosed) {
+        // Zero everything first, so padding compares equal.
+        sk_bzero(this, sizeof(*this));
+        fGenID = path.getGenerationID();
+        fForceClosed = forceClosed;
+        fHash = SkChecksum::Murmur3(&fGenID, sizeof(*this) - sizeof(fHash));
+    }
+
+    bool operator==(const Key& other) const {
+        return 0 == memcmp(this, &other, sizeof(*this));
+    }
+
+    uint32_t fHash;
+    uint32_t fGenID;
+    uint32_t fForceClosed;
+};
+
+struct Rec {
+    Rec(const Key& key, SkRefCnt* table, size_t tableBytes)
+        : fKey(key), fTable(SkRef(table)), fTableBytes(tableBytes) {}
+    ~Rec() { fTable->unref(); }
+
+    static const Key& GetKey(const Rec& rec) { return rec.fKey; }
+    static uint32_t Hash(const Key& key) { return key.fHash; }
+
+    size_t bytesUsed() const { return sizeof(*this) + fTableBytes; }
+
+    const Key       fKey;
+    SkRefCnt* const fTable;     // an SkPathMeasure::Table
+    const size_t    fTableBytes;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Rec);
+};
+
+typedef SkTLRUByteCache<Rec, Key> Cache;
+
+}  // namespace
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+static Cache* gPathMeasureCache = NULL;
+static void cleanup_gPathMeasureCache() {
+#if SK_DEVELOPER
+    SkDELETE(gPathMeasureCache);
+#endif
 }
 
-SkPathMeasure::SkPathMeasure(const SkPath& path, bool forceClosed) {
-    fPath = &path;
-    fLength = -1;   // signal we need to compute it
-    fForceClosed = forceClosed;
-    fFirstPtIndex = -1;
+/** Must hold gMutex when calling. */
+static Cache* get_cache() {
+    gMutex.assertHeld();
+    if (NULL == gPathMeasureCache) {
+        gPathMeasureCache = SkNEW_ARGS(Cache, (SK_DEFAULT_PATH_MEASURE_CACHE_LIMIT,
+                                                 Cache::kSecondSighting_AdmitPolicy));
+        atexit(cleanup_gPathMeasureCache);
+    }
+    return gPathMeasureCache;
+}
+
+/*  Returns the measurements of every contour of path, ref()ed, if they are in
+    the cache or this is the second time path has been measured. Otherwise
+    returns NULL, and the caller should measure the contours it needs itself.
+ */
+SkPathMeasure::Table* SkPathMeasure::FindCachedTable(const SkPath& path,
+                                                     bool forceClosed) {
+    // Lines are cheap to measure; curves are flattened into many chords.
+    if (path.countVerbs() < kMinVerbsToCache &&
+            0 == (path.getSegmentMasks() &
+                  (SkPath::kQuad_SegmentMask | SkPath::kCubic_SegmentMask))) {
+        return NULL;
+    }
+
+    const Key key(path, forceClosed);
+    {
+        SkAutoMutexAcquire am(gMutex);
+        Rec* rec = get_cache()->find(key);
+        if (NULL != rec) {
+            return SkRef(static_cast<Table*>(rec->fTable));
+        }
+        if (!get_cache()->admit(key)) {
+            return NULL;
+        }
+    }
 
+    // Measure the whole path without holding the lock.
+    Table* table = SkNEW(Table);
+    SkPath::Iter iter(path, forceClosed);
+    table->appendAllContours(&iter, forceClosed);
+
+    {
+        SkAutoMutexAcquire am(gMutex);
+        // Another thread may have measured it too while we were.
+        if (NULL == get_cache()->find(key)) {
+            get_cache()->add(SkNEW_ARGS(Rec, (key, table, table->bytesUsed())));
+        }
+    }
+    return table;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SkPathMeasure::SkPathMeasure()
+    : fPath(NULL)
+    , fTable(NULL)
+    , fContourIndex(-1)
+    , fTableIsShared(false)
+    , fForceClosed(false) {
+}
+
+SkPathMeasure::SkPathMeasure(const SkPath& path, bool forceClosed)
+    : fPath(&path)
+    , fTable(NULL)
+    , fContourIndex(-1)
+    , fTableIsShared(false)
+    , fForceClosed(forceClosed) {
     fIter.setPath(path, forceClosed);
 }
 
-SkPathMeasure::~SkPathMeasure() {}
+SkPathMeasure::~SkPathMeasure() {
+    SkSafeUnref(fTable);
+}
 
 /** Assign a new path, or null to have none.
 */
 void SkPathMeasure::setPath(const SkPath* path, bool forceClosed) {
     fPath = path;
-    fLength = -1;   // signal we need to compute it
     fForceClosed = forceClosed;
-    fFirstPtIndex = -1;
 
     if (path) {
         fIter.setPath(*path, forceClosed);
     }
-    fSegments.reset();
-    fPts.reset();
+    SkSafeSetNull(fTable);
+    fContourIndex = -1;
+    fTableIsShared = false;
 }
 
-SkScalar SkPathMeasure::getLength() {
-    if (fPath == NULL) {
-        return 0;
+/*  Returns the current contour, measuring it first if need be. Returns NULL if
+    there is no path, or we are past the last contour of a shared table.
+ */
+const SkPathMeasure::Contour* SkPathMeasure::currentContour() {
+    if (NULL == fPath) {
+        return NULL;
+    }
+    if (NULL == fTable) {
+        fTable = FindCachedTable(*fPath, fForceClosed);
+        fTableIsShared = NULL != fTable;
+        if (!fTableIsShared) {
+            fTable = SkNEW(Table);
+        }
+    }
+    if (fContourIndex < 0) {
+        fContourIndex = 0;
     }
-    if (fLength < 0) {
-        this->buildSegments();
+    if (fContourIndex >= fTable->countContours()) {
+        if (fTableIsShared) {
+            return NULL;
+        }
+        SkASSERT(fContourIndex == fTable->countContours());
+        fTable->appendContour(&fIter, fForceClosed);
     }
-    SkASSERT(fLength >= 0);
-    return fLength;
+    return &fTable->getContour(fContourIndex);
+}
+
+SkScalar SkPathMeasure::getLength() {
+    const Contour* contour = this->currentContour();
+    return NULL != contour ? contour->fLength : 0;
 }
 
 const SkPathMeasure::Segment* SkPathMeasure::distanceToSegment(
-                                            SkScalar distance, SkScalar* t) {
-    SkDEBUGCODE(SkScalar length = ) this->getLength();
-    SkASSERT(distance >= 0 && distance <= length);
+                    const Contour& contour, SkScalar distance, SkScalar* t) const {
+    SkASSERT(distance >= 0 && distance <= contour.fLength);
 
-    const Segment*  seg = fSegments.begin();
-    int             count = fSegments.count();
+    const Segment*  seg = fTable->getSegments(contour);
+    int             count = contour.fSegmentCount;
 
     int index = SkTSearch<SkScalar>(&seg->fDistance, count, distance, sizeof(Segment));
     // don't care if we hit an exact match or not, so we xor index if it is negative
@@ -415,18 +619,13 @@ const SkPathMeasure::Segment* SkPathMeasure::distanceToSegment(
 
 bool SkPathMeasure::getPosTan(SkScalar distance, SkPoint* pos,
                               SkVector* tangent) {
-    if (NULL == fPath) {
-        return false;
-    }
-
-    SkScalar    length = this->getLength(); // call this to force computing it
-    int         count = fSegments.count();
-
-    if (count == 0 || length == 0) {
+    const Contour* contour = this->currentContour();
+    if (NULL == contour || 0 == contour->fSegmentCount || 0 == contour->fLength) {
         return false;
     }
 
     // pin the distance to a legal range
+    SkScalar length = contour->fLength;
     if (distance < 0) {
         distance = 0;
     } else if (distance > length) {
@@ -434,9 +633,9 @@ bool SkPathMeasure::getPosTan(SkScalar distance, SkPoint* pos,
     }
 
     SkScalar        t;
-    const Segment*  seg = this->distanceToSegment(distance, &t);
+    const Segment*  seg = this->distanceToSegment(*contour, distance, &t);
 
-    compute_pos_tan(&fPts[seg->fPtIndex], seg->fType, t, pos, tangent);
+    compute_pos_tan(&fTable->getPoints()[seg->fPtIndex], seg->fType, t, pos, tangent);
     return true;
 }
 
@@ -469,7 +668,8 @@ bool SkPathMeasure::getSegment(SkScalar startD, SkScalar stopD, SkPath* dst,
                                bool startWithMoveTo) {
     SkASSERT(dst);
 
-    SkScalar length = this->getLength();    // ensure we have built our segments
+    const Contour* contour = this->currentContour();
+    SkScalar length = NULL != contour ? contour->fLength : 0;
 
     if (startD < 0) {
         startD = 0;
@@ -481,40 +681,41 @@ bool SkPathMeasure::getSegment(SkScalar startD, SkScalar stopD, SkPath* dst,
         return false;
     }
 
+    const SkPoint* pts = fTable->getPoints();
     SkPoint  p;
     SkScalar startT, stopT;
-    const Segment* seg = this->distanceToSegment(startD, &startT);
-    const Segment* stopSeg = this->distanceToSegment(stopD, &stopT);
+    const Segment* seg = this->distanceToSegment(*contour, startD, &startT);
+    const Segment* stopSeg = this->distanceToSegment(*contour, stopD, &stopT);
     SkASSERT(seg <= stopSeg);
 
     if (startWithMoveTo) {
-        compute_pos_tan(&fPts[seg->fPtIndex], seg->fType, startT, &p, NULL);
+        compute_pos_tan(&pts[seg->fPtIndex], seg->fType, startT, &p, NULL);
         dst->moveTo(p);
     }
 
     if (seg->fPtIndex == stopSeg->fPtIndex) {
-        seg_to(&fPts[seg->fPtIndex], seg->fType, startT, stopT, dst);
+        seg_to(&pts[seg->fPtIndex], seg->fType, startT, stopT, dst);
     } else {
         do {
-            seg_to(&fPts[seg->fPtIndex], seg->fType, startT, SK_Scalar1, dst);
+            seg_to(&pts[seg->fPtIndex], seg->fType, startT, SK_Scalar1, dst);
             seg = SkPathMeasure::NextSegment(seg);
             startT = 0;
         } while (seg->fPtIndex < stopSeg->fPtIndex);
-        seg_to(&fPts[seg->fPtIndex], seg->fType, 0, stopT, dst);
+        seg_to(&pts[seg->fPtIndex], seg->fType, 0, stopT, dst);
     }
     return true;
 }
 
 bool SkPathMeasure::isClosed() {
-    (void)this->getLength();
-    return fIsClosed;
+    const Contour* contour = this->currentContour();
+    return NULL != contour ? contour->fIsClosed : fForceClosed;
 }
 
 /** Move to the next contour in the path. Return true if one exists, or false if
     we're done with the path.
 */
 bool SkPathMeasure::nextContour() {
-    fLength = -1;
+    fContourIndex += 1;
     return this->getLength() > 0;
 }
 
@@ -524,10 +725,16 @@ bool SkPathMeasure::nextContour() {
 #ifdef SK_DEBUG
 
 void SkPathMeasure::dump() {
-    SkDebugf("pathmeas: length=%g, segs=%d\n", fLength, fSegments.count());
+    const Contour* contour = this->currentContour();
+    if (NULL == contour) {
+        SkDebugf("pathmeas: no contour\n");
+        return;
+    }
+    const Segment* segs = fTable->getSegments(*contour);
+    SkDebugf("pathmeas: length=%g, segs=%d\n", contour->fLength, contour->fSegmentCount);
 
-    for (int i = 0; i < fSegments.count(); i++) {
-        const Segment* seg = &fSegments[i];
+    for (int i = 0; i < contour->fSegmentCount; i++) {
+        const Segment* seg = &segs[i];
         SkDebugf("pathmeas: seg[%d] distance=%g, point=%d, t=%g, type=%d\n",
                 i, seg->fDistance, seg->fPtIndex, seg->getScalarT(),
                  seg->fType);
@@ -71,6 +71,8 @@ void SkPathRef::CreateTransformedCopy(SkAutoTUnref<SkPathRef>* dst,
     bool canXformBounds = !src.fBoundsIsDirty && matrix.rectStaysRect() && src.countPoints() > 1;
 
     matrix.mapPoints((*dst)->fPoints, src.points(), src.fPointCnt);
+    // The points changed, so even an in-place transform needs a new ID.
+    (*dst)->fGenerationID = 0;
 
     /*
         *  Here we optimize the bounds computation, by noting if the bounds are
@@ -252,6 +254,192 @@ uint32_t SkPathRef::writeSize() const {
                     sizeof(SkRect));
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+// writeCompact() stores coordinates as steps of 1/kCompactSteps of the larger
+// side of the bounds from its top left, so they take at most 16 bits.
+static const int32_t kCompactSteps = 65535;
+
+static void write_varint(SkTDArray<uint8_t>* data, uint32_t value) {
+    while (value >= 0x80) {
+        *data->append() = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *data->append() = (uint8_t)value;
+}
+
+static bool read_varint(SkRBuffer* buffer, uint32_t* value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+        uint8_t byte;
+        if (!buffer->readU8(&byte)) {
+            return false;
+        }
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Map small deltas of either sign to small unsigned values: 0, -1, 1, -2, ...
+static uint32_t zigzag(int32_t delta) {
+    return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+bool SkPathRef::writeCompact(SkTDArray<uint8_t>* data) const {
+    SkDEBUGCODE(this->validate();)
+
+    const SkRect& bounds = this->getBounds();
+    const SkScalar range = SkMaxScalar(bounds.width(), bounds.height());
+    if (!this->isFinite() || !SkScalarIsFinite(range)) {
+        return false;
+    }
+
+    write_varint(data, fIsOval);
+    write_varint(data, fVerbCnt);
+    write_varint(data, fPointCnt);
+    write_varint(data, fConicWeights.count());
+
+    // Verbs are written in memory order, a run of the same verb at a time.
+    const uint8_t* verbs = this->verbsMemBegin();
+    for (int i = 0; i < fVerbCnt;) {
+        int run = 1;
+        while (i + run < fVerbCnt && verbs[i + run] == verbs[i]) {
+            ++run;
+        }
+        write_varint(data, (run << 3) | verbs[i]);
+        i += run;
+    }
+
+    if (fPointCnt > 0) {
+        const SkScalar step = range / kCompactSteps;
+        const SkScalar scale = step > 0 ? SkScalarInvert(step) : 0;
+        memcpy(data->append(sizeof(SkScalar)), &bounds.fLeft, sizeof(SkScalar));
+        memcpy(data->append(sizeof(SkScalar)), &bounds.fTop, sizeof(SkScalar));
+        memcpy(data->append(sizeof(SkScalar)), &step, sizeof(SkScalar));
+
+        int32_t prevX = 0, prevY = 0;
+        for (int i = 0; i < fPointCnt; ++i) {
+            int32_t x = SkPin32(SkScalarRoundToInt((fPoints[i].fX - bounds.fLeft) * scale),
+                                0, kCompactSteps);
+            int32_t y = SkPin32(SkScalarRoundToInt((fPoints[i].fY - bounds.fTop) * scale),
+                                0, kCompactSteps);
+            write_varint(data, zigzag(x - prevX));
+            write_varint(data, zigzag(y - prevY));
+            prevX = x;
+            prevY = y;
+        }
+    }
+
+    memcpy(data->append(SkToInt(fConicWeights.bytes())), fConicWeights.begin(),
+           fConicWeights.bytes());
+    return true;
+}
+
+SkPathRef* SkPathRef::CreateFromCompact(SkRBufferWithSizeCheck* buffer) {
+    uint32_t isOval, verbCount, pointCount, conicCount;
+    if (!read_varint(buffer, &isOval) ||
+        !read_varint(buffer, &verbCount) ||
+        !read_varint(buffer, &pointCount) ||
+        !read_varint(buffer, &conicCount)) {
+        return NULL;
+    }
+    // Every point takes at least two bytes and every conic weight four, and
+    // every close follows a verb with at least one point. Checking this keeps
+    // bad data from asking for a huge allocation.
+    const size_t remaining = buffer->size() - buffer->pos();
+    if (isOval > 1 || pointCount > remaining / 2 || conicCount > remaining / 4 ||
+        verbCount > 2 * pointCount) {
+        return NULL;
+    }
+
+    SkAutoTUnref<SkPathRef> ref(SkNEW(SkPathRef));
+    ref->resetToSize(verbCount, pointCount, conicCount);
+
+    uint8_t* verbs = ref->verbsMemWritable();
+    uint32_t pointsUsed = 0, conicsUsed = 0;
+    uint8_t segmentMask = 0;
+    for (uint32_t i = 0; i < verbCount;) {
+        uint32_t packed;
+        if (!read_varint(buffer, &packed)) {
+            return NULL;
+        }
+        const uint32_t verb = packed & 7;
+        const uint32_t run = packed >> 3;
+        if (0 == run || run > verbCount - i) {
+            return NULL;
+        }
+        switch (verb) {
+            case SkPath::kMove_Verb:
+                pointsUsed += run;
+                break;
+            case SkPath::kLine_Verb:
+                pointsUsed += run;
+                segmentMask |= SkPath::kLine_SegmentMask;
+                break;
+            case SkPath::kQuad_Verb:
+                pointsUsed += 2 * run;
+                segmentMask |= SkPath::kQuad_SegmentMask;
+                break;
+            case SkPath::kConic_Verb:
+                pointsUsed += 2 * run;
+                conicsUsed += run;
+                segmentMask |= SkPath::kConic_SegmentMask;
+                break;
+            case SkPath::kCubic_Verb:
+                pointsUsed += 3 * run;
+                segmentMask |= SkPath::kCubic_SegmentMask;
+                break;
+            case SkPath::kClose_Verb:
+                break;
+            default:
+                return NULL;
+        }
+        memset(verbs + i, verb, run);
+        i += run;
+    }
+    if (pointsUsed != pointCount || conicsUsed != conicCount) {
+        return NULL;
+    }
+
+    if (pointCount > 0) {
+        SkScalar left, top, step;
+        if (!buffer->readScalar(&left) || !buffer->readScalar(&top) ||
+            !buffer->readScalar(&step)) {
+            return NULL;
+        }
+        int32_t x = 0, y = 0;
+        for (uint32_t i = 0; i < pointCount; ++i) {
+            uint32_t dx, dy;
+            if (!read_varint(buffer, &dx) || !read_varint(buffer, &dy)) {
+                return NULL;
+            }
+            x += unzigzag(dx);
+            y += unzigzag(dy);
+            if ((uint32_t)x > (uint32_t)kCompactSteps || (uint32_t)y > (uint32_t)kCompactSteps) {
+                return NULL;
+            }
+            ref->fPoints[i].set(left + x * step, top + y * step);
+        }
+    }
+
+    if (!buffer->read(ref->fConicWeights.begin(), conicCount * sizeof(SkScalar))) {
+        return NULL;
+    }
+
+    // resetToSize clears fSegmentMask and fIsOval, and leaves the bounds dirty
+    ref->fSegmentMask = segmentMask;
+    ref->fIsOval = SkToBool(isOval);
+    return ref.detach();
+}
+
 void SkPathRef::copy(const SkPathRef& ref,
                      int additionalReserveVerbs,
                      int additionalReservePoints) {
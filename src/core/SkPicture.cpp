@@ -28,6 +28,11 @@
 #include "SkRTree.h"
 #include "SkBBoxHierarchyRecord.h"
 
+#include "SkRecord.h"
+#include "SkRecordAnalysis.h"
+#include "SkRecordDraw.h"
+#include "SkRecorder.h"
+
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
 #endif
@@ -82,6 +87,7 @@ const char* DrawTypeToString(DrawType drawType) {
         case DRAW_SPRITE: return "DRAW_SPRITE";
         case DRAW_TEXT: return "DRAW_TEXT";
         case DRAW_TEXT_ON_PATH: return "DRAW_TEXT_ON_PATH";
+        case DRAW_TEXT_BLOB: return "DRAW_TEXT_BLOB";
         case DRAW_TEXT_TOP_BOTTOM: return "DRAW_TEXT_TOP_BOTTOM";
         case DRAW_VERTICES: return "DRAW_VERTICES";
         case RESTORE: return "RESTORE";
@@ -124,7 +130,9 @@ static void validateMatrix(const SkMatrix* matrix) {
 ///////////////////////////////////////////////////////////////////////////////
 
 SkPicture::SkPicture()
-    : fAccelData(NULL) {
+    : fAccelData(NULL)
+    , fRecord(NULL)
+    , fRecordBBH(NULL) {
     this->needsNewGenID();
     fPlayback = NULL;
     fWidth = fHeight = 0;
@@ -135,7 +143,9 @@ SkPicture::SkPicture(int width, int height,
                      bool deepCopyOps)
     : fWidth(width)
     , fHeight(height)
-    , fAccelData(NULL) {
+    , fAccelData(NULL)
+    , fRecord(NULL)
+    , fRecordBBH(NULL) {
     this->needsNewGenID();
 
     SkPictInfo info;
@@ -143,9 +153,25 @@ SkPicture::SkPicture(int width, int height,
     fPlayback = SkNEW_ARGS(SkPicturePlayback, (record, info, deepCopyOps));
 }
 
+SkPicture::SkPicture(int width, int height, SkRecord* record, SkBBoxHierarchy* bbh)
+    : fPlayback(NULL)
+    , fWidth(width)
+    , fHeight(height)
+    , fAccelData(NULL)
+    , fRecord(record)
+    , fRecordBBH(NULL) {
+    SkASSERT(NULL != record);
+    this->needsNewGenID();
+    if (NULL != bbh) {
+        fRecordBBH = SkNEW_ARGS(SkRecordBBH, (*record, width, height, bbh));
+    }
+}
+
 SkPicture::SkPicture(const SkPicture& src)
     : INHERITED()
-    , fAccelData(NULL) {
+    , fAccelData(NULL)
+    , fRecord(NULL)
+    , fRecordBBH(NULL) {
     this->needsNewGenID();
     fWidth = src.fWidth;
     fHeight = src.fHeight;
@@ -155,17 +181,26 @@ SkPicture::SkPicture(const SkPicture& src)
         fUniqueID = src.uniqueID();     // need to call method to ensure != 0
     } else {
         fPlayback = NULL;
+        if (src.fRecord) {
+            fRecord = src.copyRecord();
+            fRecordBBH = SkSafeRef(src.fRecordBBH);
+            fUniqueID = src.uniqueID();
+        }
     }
 }
 
 SkPicture::~SkPicture() {
     SkDELETE(fPlayback);
+    SkDELETE(fRecord);
+    SkSafeUnref(fRecordBBH);
     SkSafeUnref(fAccelData);
 }
 
 void SkPicture::swap(SkPicture& other) {
     SkTSwap(fUniqueID, other.fUniqueID);
     SkTSwap(fPlayback, other.fPlayback);
+    SkTSwap(fRecord, other.fRecord);
+    SkTSwap(fRecordBBH, other.fRecordBBH);
     SkTSwap(fAccelData, other.fAccelData);
     SkTSwap(fWidth, other.fWidth);
     SkTSwap(fHeight, other.fHeight);
@@ -187,6 +222,9 @@ void SkPicture::clone(SkPicture* pictures, int count) const {
         clone->fWidth = fWidth;
         clone->fHeight = fHeight;
         SkDELETE(clone->fPlayback);
+        SkDELETE(clone->fRecord);
+        clone->fRecord = NULL;
+        SkSafeSetNull(clone->fRecordBBH);
 
         /*  We want to copy the src's playback. However, if that hasn't been built
             yet, we need to fake a call to endRecording() without actually calling
@@ -239,8 +277,43 @@ void SkPicture::clone(SkPicture* pictures, int count) const {
             clone->fUniqueID = this->uniqueID(); // need to call method to ensure != 0
         } else {
             clone->fPlayback = NULL;
+            if (fRecord) {
+                clone->fRecord = this->copyRecord();
+                clone->fRecordBBH = SkSafeRef(fRecordBBH);
+                clone->fUniqueID = this->uniqueID();
+            }
+        }
+    }
+}
+
+SkRecord* SkPicture::copyRecord() const {
+    SkASSERT(NULL != fRecord);
+    // Playing an SkRecord back into an SkRecorder reproduces it command for
+    // command, already optimized.
+    SkRecord* copy = SkNEW(SkRecord);
+    SkRecorder recorder(copy, fWidth, fHeight);
+    for (SkRecords::Draw draw(&recorder); draw.index() < fRecord->count(); draw.next()) {
+        fRecord->visit<void>(draw.index(), draw);
+        // NoOps, and anything culled, record nothing; hold their places.
+        while (copy->count() <= draw.index()) {
+            SkNEW_PLACEMENT(copy->append<SkRecords::NoOp>(), SkRecords::NoOp);
         }
     }
+    SkASSERT(copy->count() == fRecord->count());
+    return copy;
+}
+
+SkPicturePlayback* SkPicture::backport() const {
+    SkASSERT(NULL != fRecord);
+    SkPictureRecord rec(SkISize::Make(fWidth, fHeight), 0 /*flags*/);
+    rec.beginRecording();
+    SkRecordDraw(*fRecord, &rec);
+    rec.endRecording();
+
+    SkPictInfo info;
+    this->createHeader(&info);
+    const bool deepCopyOps = true;  // rec is about to go away
+    return SkNEW_ARGS(SkPicturePlayback, (rec, info, deepCopyOps));
 }
 
 SkPicture::AccelData::Domain SkPicture::AccelData::GenerateDomain() {
@@ -262,7 +335,7 @@ const SkPicture::OperationList& SkPicture::OperationList::InvalidList() {
 }
 
 const SkPicture::OperationList& SkPicture::EXPERIMENTAL_getActiveOps(const SkIRect& queryRect) const {
-    SkASSERT(NULL != fPlayback);
+    SkASSERT(NULL != fPlayback || NULL != fRecord);
     if (NULL != fPlayback) {
         return fPlayback->getActiveOps(queryRect);
     }
@@ -277,10 +350,96 @@ size_t SkPicture::EXPERIMENTAL_curOpID() const {
 }
 
 void SkPicture::draw(SkCanvas* surface, SkDrawPictureCallback* callback) const {
-    SkASSERT(NULL != fPlayback);
+    SkASSERT(NULL != fPlayback || NULL != fRecord);
     if (NULL != fPlayback) {
         fPlayback->draw(*surface, callback);
     }
+    if (NULL != fRecord) {
+        SkRecordDraw(*fRecord, surface, fRecordBBH, callback);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SkTaskGroup.h"
+
+static void draw_tile(const SkPicture* picture, SkPicture::TileCanvasFactory* factory,
+                      const SkIRect& tile) {
+    SkAutoTUnref<SkCanvas> canvas(factory->newTileCanvas(tile));
+    if (NULL == canvas.get()) {
+        return;
+    }
+    SkAutoCanvasRestore acr(canvas, true);
+    canvas->clipRect(SkRect::MakeWH(SkIntToScalar(tile.width()), SkIntToScalar(tile.height())));
+    canvas->translate(-SkIntToScalar(tile.fLeft), -SkIntToScalar(tile.fTop));
+    picture->draw(canvas);
+}
+
+namespace {
+
+// Draws tiles, taking the next one from a shared counter, until none are left.
+class TileDrawer : public SkRunnable {
+public:
+    TileDrawer(const SkPicture* picture, SkPicture::TileCanvasFactory* factory,
+               const SkISize& tileSize, int32_t* nextTile)
+        : fPicture(picture)
+        , fFactory(factory)
+        , fTileSize(tileSize)
+        , fNextTile(nextTile) {}
+
+    virtual void run() SK_OVERRIDE {
+        const int columns = (fPicture->width() + fTileSize.width() - 1) / fTileSize.width();
+        const int rows = (fPicture->height() + fTileSize.height() - 1) / fTileSize.height();
+        const SkIRect bounds = SkIRect::MakeWH(fPicture->width(), fPicture->height());
+
+        for (int i = sk_atomic_inc(fNextTile); i < columns * rows; i = sk_atomic_inc(fNextTile)) {
+            SkIRect tile = SkIRect::MakeXYWH((i % columns) * fTileSize.width(),
+                                             (i / columns) * fTileSize.height(),
+                                             fTileSize.width(), fTileSize.height());
+            SkAssertResult(tile.intersect(bounds));
+            draw_tile(fPicture, fFactory, tile);
+        }
+    }
+
+private:
+    const SkPicture*               fPicture;
+    SkPicture::TileCanvasFactory*  fFactory;
+    const SkISize                  fTileSize;
+    int32_t*                       fNextTile;
+};
+
+}  // namespace
+
+void SkPicture::playbackTiled(TileCanvasFactory* factory, const SkISize& tileSize,
+                              int threadCount) const {
+    SkASSERT(NULL != factory);
+    if (tileSize.isEmpty() || fWidth <= 0 || fHeight <= 0) {
+        return;
+    }
+
+    int32_t nextTile = 0;
+    if (threadCount <= 1) {
+        TileDrawer(this, factory, tileSize, &nextTile).run();
+        return;
+    }
+
+    // Playback keeps per-draw state, so each thread needs its own clone. Clones
+    // share the op data and bounding box hierarchy; only that state is copied.
+    SkPicture* clones = SkNEW_ARRAY(SkPicture, threadCount);
+    this->clone(clones, threadCount);
+    {
+        SkTDArray<TileDrawer*> drawers;
+        SkThreadPool pool(threadCount);
+        SkTaskGroup group(&pool);
+        for (int i = 0; i < threadCount; ++i) {
+            *drawers.append() = SkNEW_ARGS(TileDrawer, (&clones[i], factory, tileSize,
+                                                        &nextTile));
+            group.add(drawers[i]);
+        }
+        group.wait();
+        drawers.deleteAll();
+    }
+    SkDELETE_ARRAY(clones);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -338,11 +497,26 @@ SkPicture::SkPicture(SkPicturePlayback* playback, int width, int height)
     : fPlayback(playback)
     , fWidth(width)
     , fHeight(height)
-    , fAccelData(NULL) {
+    , fAccelData(NULL)
+    , fRecord(NULL)
+    , fRecordBBH(NULL) {
     this->needsNewGenID();
 }
 
 SkPicture* SkPicture::CreateFromStream(SkStream* stream, InstallPixelRefProc proc) {
+    return CreateFromStream(stream, proc, NULL);
+}
+
+SkPicture* SkPicture::CreateFromData(SkData* data, InstallPixelRefProc proc) {
+    if (NULL == data) {
+        return NULL;
+    }
+    SkMemoryStream stream(data);
+    return CreateFromStream(&stream, proc, data);
+}
+
+SkPicture* SkPicture::CreateFromStream(SkStream* stream, InstallPixelRefProc proc,
+                                       const SkData* streamData) {
     SkPictInfo info;
 
     if (!InternalOnly_StreamIsSKP(stream, &info)) {
@@ -351,7 +525,8 @@ SkPicture* SkPicture::CreateFromStream(SkStream* stream, InstallPixelRefProc pro
 
     // Check to see if there is a playback to recreate.
     if (stream->readBool()) {
-        SkPicturePlayback* playback = SkPicturePlayback::CreateFromStream(stream, info, proc);
+        SkPicturePlayback* playback = SkPicturePlayback::CreateFromStream(stream, info, proc,
+                                                                          streamData);
         if (NULL == playback) {
             return NULL;
         }
@@ -401,15 +576,18 @@ void SkPicture::createHeader(SkPictInfo* info) const {
     }
 }
 
-void SkPicture::serialize(SkWStream* stream, EncodeBitmap encoder) const {
+void SkPicture::serialize(SkWStream* stream, EncodeBitmap encoder, uint32_t flags) const {
     SkPicturePlayback* playback = fPlayback;
+    if (NULL == playback && NULL != fRecord) {
+        playback = this->backport();
+    }
 
     SkPictInfo info;
     this->createHeader(&info);
     stream->write(&info, sizeof(info));
     if (playback) {
         stream->writeBool(true);
-        playback->serialize(stream, encoder);
+        playback->serialize(stream, encoder, flags);
         // delete playback if it is a local version (i.e. cons'd up just now)
         if (playback != fPlayback) {
             SkDELETE(playback);
@@ -431,6 +609,9 @@ void SkPicture::WriteTagSize(SkWStream* stream, uint32_t tag,  size_t size) {
 
 void SkPicture::flatten(SkWriteBuffer& buffer) const {
     SkPicturePlayback* playback = fPlayback;
+    if (NULL == playback && NULL != fRecord) {
+        playback = this->backport();
+    }
 
     SkPictInfo info;
     this->createHeader(&info);
@@ -449,6 +630,10 @@ void SkPicture::flatten(SkWriteBuffer& buffer) const {
 
 #if SK_SUPPORT_GPU
 bool SkPicture::suitableForGpuRasterization(GrContext* context, const char **reason) const {
+    if (NULL == fPlayback && NULL != fRecord) {
+        SkAutoTDelete<SkPicturePlayback> playback(this->backport());
+        return playback->suitableForGpuRasterization(context, reason);
+    }
     if (NULL == fPlayback) {
         if (NULL != reason) {
             *reason = "Missing playback object.";
@@ -461,6 +646,9 @@ bool SkPicture::suitableForGpuRasterization(GrContext* context, const char **rea
 #endif
 
 bool SkPicture::willPlayBackBitmaps() const {
+    if (fRecord) {
+        return SkRecordWillPlaybackBitmaps(*fRecord);
+    }
     if (!fPlayback) {
         return false;
     }
@@ -67,8 +67,9 @@ enum DrawType {
     DRAW_DRRECT,
     PUSH_CULL,
     POP_CULL,
+    DRAW_TEXT_BLOB,
 
-    LAST_DRAWTYPE_ENUM = POP_CULL
+    LAST_DRAWTYPE_ENUM = DRAW_TEXT_BLOB
 };
 
 // In the 'match' method, this constant will match any flavor of DRAW_BITMAP*
@@ -349,7 +350,7 @@ private:
         fIndex     = index;
         fFlatSize  = size;
         fTopBot[0] = SK_ScalarNaN;  // Mark as unwritten.
-        fChecksum  = SkChecksum::Compute((uint32_t*)this->data(), size);
+        fChecksum  = SkChecksum::HashKey((uint32_t*)this->data(), size);
     }
 
     int fIndex;
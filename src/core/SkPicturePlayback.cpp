@@ -6,13 +6,17 @@
  */
 #include <new>
 #include "SkBBoxHierarchy.h"
+#include "SkFlate.h"
 #include "SkPicturePlayback.h"
 #include "SkPictureRecord.h"
 #include "SkPictureStateTree.h"
 #include "SkReadBuffer.h"
+#include "SkShader.h"
+#include "SkTextBlob.h"
 #include "SkTypeface.h"
 #include "SkTSort.h"
 #include "SkWriteBuffer.h"
+#include "SkXfermode.h"
 
 template <typename T> int SafeCount(const T* obj) {
     return obj ? obj->count() : 0;
@@ -141,6 +145,15 @@ SkPicturePlayback::SkPicturePlayback(const SkPictureRecord& record,
         }
     }
 
+    const SkTDArray<const SkTextBlob* >& blobs = record.getTextBlobRefs();
+    fTextBlobCount = blobs.count();
+    if (fTextBlobCount > 0) {
+        fTextBlobRefs = SkNEW_ARRAY(const SkTextBlob*, fTextBlobCount);
+        for (int i = 0; i < fTextBlobCount; i++) {
+            fTextBlobRefs[i] = SkRef(blobs[i]);
+        }
+    }
+
 #ifdef SK_DEBUG_SIZE
     int overall = fPlayback->size(&overallBytes);
     bitmaps = fPlayback->bitmaps(&bitmapBytes);
@@ -217,6 +230,13 @@ SkPicturePlayback::SkPicturePlayback(const SkPicturePlayback& src, SkPictCopyInf
             fPictureRefs[i]->ref();
         }
     }
+
+    // Blobs are immutable, so even a deep copy can share them.
+    fTextBlobCount = src.fTextBlobCount;
+    fTextBlobRefs = SkNEW_ARRAY(const SkTextBlob*, fTextBlobCount);
+    for (int i = 0; i < fTextBlobCount; i++) {
+        fTextBlobRefs[i] = SkRef(src.fTextBlobRefs[i]);
+    }
 }
 
 void SkPicturePlayback::init() {
@@ -224,6 +244,8 @@ void SkPicturePlayback::init() {
     fPaints = NULL;
     fPictureRefs = NULL;
     fPictureCount = 0;
+    fTextBlobRefs = NULL;
+    fTextBlobCount = 0;
     fOpData = NULL;
     fFactoryPlayback = NULL;
     fBoundingHierarchy = NULL;
@@ -231,6 +253,7 @@ void SkPicturePlayback::init() {
     fCachedActiveOps = NULL;
     fCurOffset = 0;
     fUseBBH = true;
+    fUseOcclusionCulling = true;
     fStart = 0;
     fStop = 0;
     fReplacements = NULL;
@@ -251,6 +274,11 @@ SkPicturePlayback::~SkPicturePlayback() {
     }
     SkDELETE_ARRAY(fPictureRefs);
 
+    for (int i = 0; i < fTextBlobCount; i++) {
+        fTextBlobRefs[i]->unref();
+    }
+    SkDELETE_ARRAY(fTextBlobRefs);
+
     SkDELETE(fFactoryPlayback);
 }
 
@@ -340,7 +368,8 @@ void SkPicturePlayback::WriteTypefaces(SkWStream* stream, const SkRefCntSet& rec
     }
 }
 
-void SkPicturePlayback::flattenToBuffer(SkWriteBuffer& buffer) const {
+void SkPicturePlayback::flattenToBuffer(SkWriteBuffer& buffer,
+                                        SkPathHeap::Encoding pathEncoding) const {
     int i, n;
 
     if ((n = SafeCount(fBitmaps)) > 0) {
@@ -358,20 +387,107 @@ void SkPicturePlayback::flattenToBuffer(SkWriteBuffer& buffer) const {
     }
 
     if ((n = SafeCount(fPathHeap.get())) > 0) {
-        SkPicture::WriteTagSize(buffer, SK_PICT_PATH_BUFFER_TAG, n);
-        fPathHeap->flatten(buffer);
+        SkPicture::WriteTagSize(buffer, SkPathHeap::kCompact_Encoding == pathEncoding ?
+                                        SK_PICT_COMPACT_PATH_BUFFER_TAG : SK_PICT_PATH_BUFFER_TAG,
+                                n);
+        fPathHeap->flatten(buffer, pathEncoding);
+    }
+
+    if (fTextBlobCount > 0) {
+        SkPicture::WriteTagSize(buffer, SK_PICT_TEXTBLOB_BUFFER_TAG, fTextBlobCount);
+        for (i = 0; i < fTextBlobCount; i++) {
+            fTextBlobRefs[i]->flatten(buffer);
+        }
     }
 }
 
+// Since v29 the payloads of the op data and buffer tags are preceded by padding that
+// aligns them to 4 bytes from the start of the stream, so that a picture loaded from
+// memory (SkPicture::CreateFromData) can read them in place.
+static void write_payload_padding(SkWStream* stream) {
+    static const uint8_t kZeros[3] = { 0, 0, 0 };
+    const size_t start = stream->bytesWritten() + sizeof(uint32_t);
+    const size_t padding = SkAlign4(start) - start;
+    stream->write32(SkToU32(padding));
+    stream->write(kZeros, padding);
+}
+
+static bool skip_payload_padding(SkStream* stream, const SkPictInfo& info) {
+    if (info.fVersion < 29) {
+        return true;
+    }
+    const uint32_t padding = stream->readU32();
+    return padding < 4 && stream->skip(padding) == padding;
+}
+
+// Returns the in-place address of the next 'size' bytes of 'stream' if they lie 4 byte
+// aligned inside 'streamData', or NULL if they have to be copied out.
+static const void* payload_in_place(SkStream* stream, const SkData* streamData, size_t size) {
+    if (NULL == streamData || stream->getMemoryBase() != streamData->data()) {
+        return NULL;
+    }
+    const size_t offset = stream->getPosition();
+    if (offset > streamData->size() || size > streamData->size() - offset) {
+        return NULL;
+    }
+    const uint8_t* payload = streamData->bytes() + offset;
+    return SkIsAlign4((intptr_t)payload) ? payload : NULL;
+}
+
+// Writes a payload under tag, or if deflate is set and it shrinks the payload, under
+// deflatedTag in deflated form. Each payload is deflated on its own, so it can be
+// inflated without the rest of the picture.
+void SkPicturePlayback::WritePayload(SkWStream* stream, uint32_t tag, uint32_t deflatedTag,
+                                     const void* data, size_t size, bool deflate) {
+    if (deflate) {
+        SkDynamicMemoryWStream deflated;
+        if (SkFlate::Deflate(data, size, &deflated) &&
+            deflated.bytesWritten() + sizeof(uint32_t) < size) {
+            SkAutoDataUnref payload(deflated.copyToData());
+            SkPicture::WriteTagSize(stream, deflatedTag, sizeof(uint32_t) + payload->size());
+            stream->write32(SkToU32(size));
+            stream->write(payload->data(), payload->size());
+            return;
+        }
+    }
+    SkPicture::WriteTagSize(stream, tag, size);
+    write_payload_padding(stream);
+    stream->write(data, size);
+}
+
+// Reads the payload of a deflated tag, returning NULL if it does not inflate to
+// the size recorded for it.
+static SkData* read_deflated_payload(SkStream* stream, uint32_t size) {
+    if (size < sizeof(uint32_t)) {
+        return NULL;
+    }
+    const uint32_t inflatedSize = stream->readU32();
+    size -= sizeof(uint32_t);
+
+    SkAutoMalloc storage(size);
+    if (stream->read(storage.get(), size) != size) {
+        return NULL;
+    }
+    SkMemoryStream deflated(storage.get(), size);
+    SkDynamicMemoryWStream inflated;
+    if (!SkFlate::Inflate(&deflated, &inflated) || inflated.bytesWritten() != inflatedSize) {
+        return NULL;
+    }
+    return inflated.copyToData();
+}
+
 void SkPicturePlayback::serialize(SkWStream* stream,
-                                  SkPicture::EncodeBitmap encoder) const {
-    SkPicture::WriteTagSize(stream, SK_PICT_READER_TAG, fOpData->size());
-    stream->write(fOpData->bytes(), fOpData->size());
+                                  SkPicture::EncodeBitmap encoder,
+                                  uint32_t flags) const {
+    const bool deflate = (flags & SkPicture::kCompressed_SerializeFlag) && SkFlate::HaveFlate();
+
+    WritePayload(stream, SK_PICT_READER_TAG, SK_PICT_DEFLATED_READER_TAG,
+                 fOpData->bytes(), fOpData->size(), deflate);
 
     if (fPictureCount > 0) {
         SkPicture::WriteTagSize(stream, SK_PICT_PICTURE_TAG, fPictureCount);
         for (int i = 0; i < fPictureCount; i++) {
-            fPictureRefs[i]->serialize(stream, encoder);
+            fPictureRefs[i]->serialize(stream, encoder, flags);
         }
     }
 
@@ -386,7 +502,9 @@ void SkPicturePlayback::serialize(SkWStream* stream,
         buffer.setFactoryRecorder(&factSet);
         buffer.setBitmapEncoder(encoder);
 
-        this->flattenToBuffer(buffer);
+        this->flattenToBuffer(buffer, (flags & SkPicture::kCompactPaths_SerializeFlag) ?
+                                      SkPathHeap::kCompact_Encoding :
+                                      SkPathHeap::kFull_Encoding);
 
         // We have to write these two sets into the stream *before* we write
         // the buffer, since parsing that buffer will require that we already
@@ -394,8 +512,16 @@ void SkPicturePlayback::serialize(SkWStream* stream,
         WriteFactories(stream, factSet);
         WriteTypefaces(stream, typefaceSet);
 
-        SkPicture::WriteTagSize(stream, SK_PICT_BUFFER_SIZE_TAG, buffer.bytesWritten());
-        buffer.writeToStream(stream);
+        if (deflate) {
+            SkAutoMalloc storage(buffer.bytesWritten());
+            buffer.writeToMemory(storage.get());
+            WritePayload(stream, SK_PICT_BUFFER_SIZE_TAG, SK_PICT_DEFLATED_BUFFER_SIZE_TAG,
+                         storage.get(), buffer.bytesWritten(), deflate);
+        } else {
+            SkPicture::WriteTagSize(stream, SK_PICT_BUFFER_SIZE_TAG, buffer.bytesWritten());
+            write_payload_padding(stream);
+            buffer.writeToStream(stream);
+        }
     }
 
     stream->write32(SK_PICT_EOF_TAG);
@@ -445,7 +571,8 @@ static uint32_t pictInfoFlagsToReadBufferFlags(uint32_t pictInfoFlags) {
 bool SkPicturePlayback::parseStreamTag(SkStream* stream,
                                        uint32_t tag,
                                        uint32_t size,
-                                       SkPicture::InstallPixelRefProc proc) {
+                                       SkPicture::InstallPixelRefProc proc,
+                                       const SkData* streamData) {
     /*
      *  By the time we encounter BUFFER_SIZE_TAG, we need to have already seen
      *  its dependents: FACTORY_TAG and TYPEFACE_TAG. These two are not required
@@ -459,13 +586,30 @@ bool SkPicturePlayback::parseStreamTag(SkStream* stream,
 
     switch (tag) {
         case SK_PICT_READER_TAG: {
+            if (!skip_payload_padding(stream, fInfo)) {
+                return false;
+            }
+            SkASSERT(NULL == fOpData);
+            if (NULL != payload_in_place(stream, streamData, size)) {
+                fOpData = SkData::NewSubset(streamData, stream->getPosition(), size);
+                if (stream->skip(size) != size) {
+                    return false;
+                }
+                break;
+            }
             SkAutoMalloc storage(size);
             if (stream->read(storage.get(), size) != size) {
                 return false;
             }
-            SkASSERT(NULL == fOpData);
             fOpData = SkData::NewFromMalloc(storage.detach(), size);
         } break;
+        case SK_PICT_DEFLATED_READER_TAG: {
+            SkASSERT(NULL == fOpData);
+            fOpData = read_deflated_payload(stream, size);
+            if (NULL == fOpData) {
+                return false;
+            }
+        } break;
         case SK_PICT_FACTORY_TAG: {
             SkASSERT(!haveBuffer);
         // Remove this code when v21 and below are no longer supported. At the
@@ -510,7 +654,7 @@ bool SkPicturePlayback::parseStreamTag(SkStream* stream,
             bool success = true;
             int i = 0;
             for ( ; i < fPictureCount; i++) {
-                fPictureRefs[i] = SkPicture::CreateFromStream(stream, proc);
+                fPictureRefs[i] = SkPicture::CreateFromStream(stream, proc, streamData);
                 if (NULL == fPictureRefs[i]) {
                     success = false;
                     break;
@@ -523,17 +667,39 @@ bool SkPicturePlayback::parseStreamTag(SkStream* stream,
                 }
                 // Delete the array
                 SkDELETE_ARRAY(fPictureRefs);
+                fPictureRefs = NULL;
                 fPictureCount = 0;
                 return false;
             }
         } break;
+        case SK_PICT_DEFLATED_BUFFER_SIZE_TAG:
         case SK_PICT_BUFFER_SIZE_TAG: {
-            SkAutoMalloc storage(size);
-            if (stream->read(storage.get(), size) != size) {
+            // Everything in the buffer is unflattened into new objects, so it only
+            // needs to be copied out when it can't be read in place.
+            SkAutoMalloc storage;
+            SkAutoDataUnref inflated;
+            const void* payload = NULL;
+            if (SK_PICT_DEFLATED_BUFFER_SIZE_TAG == tag) {
+                inflated.reset(read_deflated_payload(stream, size));
+                if (NULL == inflated.get()) {
+                    return false;
+                }
+                payload = inflated->data();
+                size = SkToU32(inflated->size());
+            } else if (!skip_payload_padding(stream, fInfo)) {
                 return false;
+            } else if (NULL != (payload = payload_in_place(stream, streamData, size))) {
+                if (stream->skip(size) != size) {
+                    return false;
+                }
+            } else {
+                payload = storage.reset(size);
+                if (stream->read(storage.get(), size) != size) {
+                    return false;
+                }
             }
 
-            SkReadBuffer buffer(storage.get(), size);
+            SkReadBuffer buffer(payload, size);
             buffer.setFlags(pictInfoFlagsToReadBufferFlags(fInfo.fFlags));
             buffer.setVersion(fInfo.fVersion);
 
@@ -578,6 +744,26 @@ bool SkPicturePlayback::parseBufferTag(SkReadBuffer& buffer,
                 fPathHeap.reset(SkNEW_ARGS(SkPathHeap, (buffer)));
             }
             break;
+        case SK_PICT_COMPACT_PATH_BUFFER_TAG:
+            if (size > 0) {
+                fPathHeap.reset(SkNEW_ARGS(SkPathHeap, (buffer, SkPathHeap::kCompact_Encoding)));
+            }
+            break;
+        case SK_PICT_TEXTBLOB_BUFFER_TAG: {
+            if (!buffer.validate((0 == fTextBlobCount) && (NULL == fTextBlobRefs))) {
+                return false;
+            }
+            fTextBlobCount = size;
+            fTextBlobRefs = SkNEW_ARRAY(const SkTextBlob*, fTextBlobCount);
+            for (int i = 0; i < fTextBlobCount; i++) {
+                fTextBlobRefs[i] = SkTextBlob::CreateFromBuffer(buffer);
+                if (NULL == fTextBlobRefs[i]) {
+                    // Only keep the blobs that were created (up to but excluding i).
+                    fTextBlobCount = i;
+                    return false;
+                }
+            }
+        } break;
         case SK_PICT_READER_TAG: {
             SkAutoMalloc storage(size);
             if (!buffer.readByteArray(storage.get(), size) ||
@@ -609,6 +795,7 @@ bool SkPicturePlayback::parseBufferTag(SkReadBuffer& buffer,
                 }
                 // Delete the array
                 SkDELETE_ARRAY(fPictureRefs);
+                fPictureRefs = NULL;
                 fPictureCount = 0;
                 return false;
             }
@@ -622,10 +809,11 @@ bool SkPicturePlayback::parseBufferTag(SkReadBuffer& buffer,
 
 SkPicturePlayback* SkPicturePlayback::CreateFromStream(SkStream* stream,
                                                        const SkPictInfo& info,
-                                                       SkPicture::InstallPixelRefProc proc) {
+                                                       SkPicture::InstallPixelRefProc proc,
+                                                       const SkData* streamData) {
     SkAutoTDelete<SkPicturePlayback> playback(SkNEW_ARGS(SkPicturePlayback, (info)));
 
-    if (!playback->parseStream(stream, proc)) {
+    if (!playback->parseStream(stream, proc, streamData)) {
         return NULL;
     }
     return playback.detach();
@@ -643,7 +831,8 @@ SkPicturePlayback* SkPicturePlayback::CreateFromBuffer(SkReadBuffer& buffer,
 }
 
 bool SkPicturePlayback::parseStream(SkStream* stream,
-                                    SkPicture::InstallPixelRefProc proc) {
+                                    SkPicture::InstallPixelRefProc proc,
+                                    const SkData* streamData) {
     for (;;) {
         uint32_t tag = stream->readU32();
         if (SK_PICT_EOF_TAG == tag) {
@@ -651,7 +840,7 @@ bool SkPicturePlayback::parseStream(SkStream* stream,
         }
 
         uint32_t size = stream->readU32();
-        if (!this->parseStreamTag(stream, tag, size, proc)) {
+        if (!this->parseStreamTag(stream, tag, size, proc, streamData)) {
             return false; // we're invalid
         }
     }
@@ -757,10 +946,165 @@ const SkPicture::OperationList& SkPicturePlayback::getActiveOps(const SkIRect& q
             reinterpret_cast<SkPictureStateTree::Draw**>(fCachedActiveOps->fOps.end()-1));
     }
 
+    if (fUseOcclusionCulling) {
+        this->cullOccludedOps(query, &fCachedActiveOps->fOps);
+    }
+
     fCachedActiveOps->fCacheQueryRect = query;
     return *fCachedActiveOps;
 }
 
+void SkPicturePlayback::setUseOcclusionCulling(bool useOcclusionCulling) {
+    fUseOcclusionCulling = useOcclusionCulling;
+    if (NULL != fCachedActiveOps) {
+        fCachedActiveOps->fCacheQueryRect.setEmpty();
+    }
+}
+
+// Returns true if drawing with 'paint' replaces whatever it covers with opaque
+// pixels. Any fill coverage, including anti-aliased edges, is left alone because
+// occluders are required to cover the whole (rounded out) query rect.
+static bool paint_is_opaque(const SkPaint* paint) {
+    if (NULL == paint) {
+        return true;
+    }
+    if (0xFF != paint->getAlpha() ||
+        SkPaint::kFill_Style != paint->getStyle() ||
+        NULL != paint->getColorFilter() ||
+        NULL != paint->getMaskFilter() ||
+        NULL != paint->getPathEffect() ||
+        NULL != paint->getLooper() ||
+        NULL != paint->getRasterizer() ||
+        NULL != paint->getImageFilter()) {
+        return false;
+    }
+    if (NULL != paint->getShader() && !paint->getShader()->isOpaque()) {
+        return false;
+    }
+    return SkXfermode::IsMode(paint->getXfermode(), SkXfermode::kSrcOver_Mode) ||
+           SkXfermode::IsMode(paint->getXfermode(), SkXfermode::kSrc_Mode);
+}
+
+static bool rect_covers(const SkRect& rect, const SkMatrix& matrix, const SkRect& query) {
+    if (!matrix.rectStaysRect()) {
+        return false;
+    }
+    SkRect devRect;
+    matrix.mapRect(&devRect, rect);
+    return devRect.contains(query);
+}
+
+bool SkPicturePlayback::drawCovers(uint32_t offset, const SkMatrix& matrix, const SkRect& query) {
+    SkReader32 reader(fOpData->bytes(), fOpData->size());
+    reader.setOffset(offset);
+
+    uint32_t size;
+    switch (read_op_and_size(&reader, &size)) {
+        case DRAW_CLEAR:
+            return 0xFF == SkColorGetA(reader.readInt());
+        case DRAW_PAINT:
+            return paint_is_opaque(this->getPaint(reader));
+        case DRAW_RECT: {
+            const SkPaint* paint = this->getPaint(reader);
+            const SkRect& rect = reader.skipT<SkRect>();
+            return paint_is_opaque(paint) && rect_covers(rect, matrix, query);
+        }
+        case DRAW_BITMAP: {
+            const SkPaint* paint = this->getPaint(reader);
+            const SkBitmap& bitmap = this->getBitmap(reader);
+            const SkPoint& loc = reader.skipT<SkPoint>();
+            SkRect rect = SkRect::MakeXYWH(loc.fX, loc.fY,
+                                           SkIntToScalar(bitmap.width()),
+                                           SkIntToScalar(bitmap.height()));
+            return bitmap.isOpaque() && paint_is_opaque(paint) &&
+                   rect_covers(rect, matrix, query);
+        }
+        case DRAW_BITMAP_RECT_TO_RECT: {
+            const SkPaint* paint = this->getPaint(reader);
+            const SkBitmap& bitmap = this->getBitmap(reader);
+            this->getRectPtr(reader);
+            const SkRect& dst = reader.skipT<SkRect>();
+            return bitmap.isOpaque() && paint_is_opaque(paint) &&
+                   rect_covers(dst, matrix, query);
+        }
+        default:
+            return false;
+    }
+}
+
+bool SkPicturePlayback::clipsOnlyShrink(const SkTDArray<uint32_t>& offsets) {
+    SkReader32 reader(fOpData->bytes(), fOpData->size());
+    for (int i = 0; i < offsets.count(); ++i) {
+        reader.setOffset(offsets[i]);
+
+        uint32_t size;
+        switch (read_op_and_size(&reader, &size)) {
+            case SAVE_LAYER:
+            case NOOP:
+                // A layer is composited back before any later draw outside it.
+                continue;
+            case CLIP_PATH:
+                reader.readInt();
+                break;
+            case CLIP_REGION: {
+                SkRegion region;
+                this->getRegion(reader, &region);
+            } break;
+            case CLIP_RECT:
+                reader.skipT<SkRect>();
+                break;
+            case CLIP_RRECT: {
+                SkRRect rrect;
+                reader.readRRect(&rrect);
+            } break;
+            default:
+                return false;
+        }
+
+        SkRegion::Op op = ClipParams_unpackRegionOp(reader.readInt());
+        if (SkRegion::kIntersect_Op != op && SkRegion::kDifference_Op != op) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SkPicturePlayback::cullOccludedOps(const SkIRect& query, SkTDArray<void*>* ops) {
+    const SkRect queryRect = SkRect::Make(query);
+    SkTDArray<uint32_t> offsets;
+
+    for (int i = ops->count() - 1; i > 0; --i) {
+        const SkPictureStateTree::Draw* occluder =
+            static_cast<const SkPictureStateTree::Draw*>((*ops)[i]);
+        if (!this->drawCovers(occluder->fOffset, *occluder->fMatrix, queryRect)) {
+            continue;
+        }
+        // Clips that can grow (e.g. kReplace_Op) could let the occluder's clip
+        // reach outside the query rect, leaving earlier draws exposed there.
+        SkAssertResult(SkPictureStateTree::GetStateOffsets(*occluder, NULL, &offsets));
+        if (!this->clipsOnlyShrink(offsets)) {
+            continue;
+        }
+
+        // An earlier draw is hidden if it was made inside the occluder's clip and
+        // layer state, possibly further clipped or in a nested layer.
+        int kept = 0;
+        for (int j = 0; j < i; ++j) {
+            const SkPictureStateTree::Draw* draw =
+                static_cast<const SkPictureStateTree::Draw*>((*ops)[j]);
+            if (!SkPictureStateTree::GetStateOffsets(*draw, occluder, &offsets) ||
+                !this->clipsOnlyShrink(offsets)) {
+                (*ops)[kept++] = (*ops)[j];
+            }
+        }
+        if (kept < i) {
+            memmove(ops->begin() + kept, ops->begin() + i, (ops->count() - i) * sizeof(void*));
+            ops->setCount(ops->count() - (i - kept));
+            i = kept;
+        }
+    }
+}
+
 class SkAutoResetOpID {
 public:
     SkAutoResetOpID(SkPicturePlayback* playback) : fPlayback(playback) { }
@@ -897,7 +1241,15 @@ void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback)
                 SkASSERT(NULL != temp->fPaint);
                 canvas.save();
                 canvas.setMatrix(initialMatrix);
-                canvas.drawBitmap(*temp->fBM, temp->fPos.fX, temp->fPos.fY, temp->fPaint);
+                if (temp->fSrcRect == SkIRect::MakeWH(temp->fBM->width(), temp->fBM->height())) {
+                    canvas.drawBitmap(*temp->fBM, temp->fPos.fX, temp->fPos.fY, temp->fPaint);
+                } else {
+                    SkRect src = SkRect::Make(temp->fSrcRect);
+                    SkRect dst = SkRect::MakeXYWH(SkIntToScalar(temp->fPos.fX),
+                                                  SkIntToScalar(temp->fPos.fY),
+                                                  src.width(), src.height());
+                    canvas.drawBitmapRectToRect(*temp->fBM, &src, dst, temp->fPaint);
+                }
                 canvas.restore();
 
                 if (it.isValid()) {
@@ -1141,6 +1493,13 @@ void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback)
             case DRAW_PICTURE:
                 canvas.drawPicture(this->getPicture(reader));
                 break;
+            case DRAW_TEXT_BLOB: {
+                const SkPaint& paint = *this->getPaint(reader);
+                const SkTextBlob* blob = this->getTextBlob(reader);
+                SkScalar x = reader.readScalar();
+                SkScalar y = reader.readScalar();
+                canvas.drawTextBlob(blob, x, y, paint);
+            } break;
             case DRAW_POINTS: {
                 const SkPaint& paint = *this->getPaint(reader);
                 SkCanvas::PointMode mode = (SkCanvas::PointMode)reader.readInt();
@@ -1344,10 +1703,13 @@ bool SkPicturePlayback::suitableForGpuRasterization(GrContext* context, const ch
 
     bool ret = fContentInfo.numPaintWithPathEffectUses() < kNumPaintWithPathEffectUsesTol &&
                     (fContentInfo.numAAConcavePaths() - fContentInfo.numAAHairlineConcavePaths()) 
-                    < kNumAAConcavePaths;
+                    < kNumAAConcavePaths &&
+                    0 == fContentInfo.numPaintWithCPUImageFilterUses();
     if (!ret && NULL != reason) {
         if (fContentInfo.numPaintWithPathEffectUses() >= kNumPaintWithPathEffectUsesTol)
             *reason = "Too many path effects.";
+        else if (fContentInfo.numPaintWithCPUImageFilterUses() > 0)
+            *reason = "Image filter needs a CPU readback.";
         else if ((fContentInfo.numAAConcavePaths() - fContentInfo.numAAHairlineConcavePaths()) 
                  >= kNumAAConcavePaths)
             *reason = "Too many anti-aliased concave paths.";
@@ -1724,6 +2086,12 @@ void SkPicturePlayback::dumpStream() {
             case DRAW_PICTURE: {
                 DUMP_PTR(SkPicture, &getPicture());
                 } break;
+            case DRAW_TEXT_BLOB: {
+                DUMP_PTR(SkPaint, getPaint());
+                DUMP_PTR(SkTextBlob, getTextBlob());
+                DUMP_SCALAR(x);
+                DUMP_SCALAR(y);
+                } break;
             case DRAW_POINTS: {
                 DUMP_PTR(SkPaint, getPaint());
                 (void)getInt(); // PointMode
@@ -28,6 +28,7 @@ class SkMatrix;
 class SkPaint;
 class SkPath;
 class SkPictureStateTree;
+class SkTextBlob;
 class SkReadBuffer;
 class SkRegion;
 
@@ -56,6 +57,13 @@ struct SkPictInfo {
 #define SK_PICT_BITMAP_BUFFER_TAG  SkSetFourByteTag('b', 't', 'm', 'p')
 #define SK_PICT_PAINT_BUFFER_TAG   SkSetFourByteTag('p', 'n', 't', ' ')
 #define SK_PICT_PATH_BUFFER_TAG    SkSetFourByteTag('p', 't', 'h', ' ')
+#define SK_PICT_COMPACT_PATH_BUFFER_TAG SkSetFourByteTag('p', 't', 'h', 'c')
+#define SK_PICT_TEXTBLOB_BUFFER_TAG SkSetFourByteTag('b', 'l', 'o', 'b')
+
+// The deflated forms of SK_PICT_READER_TAG and SK_PICT_BUFFER_SIZE_TAG. Their payload is
+// the inflated size, followed by the deflated bytes.
+#define SK_PICT_DEFLATED_READER_TAG         SkSetFourByteTag('r', 'e', 'a', 'z')
+#define SK_PICT_DEFLATED_BUFFER_SIZE_TAG    SkSetFourByteTag('a', 'r', 'a', 'z')
 
 // Always write this guy last (with no length field afterwards)
 #define SK_PICT_EOF_TAG     SkSetFourByteTag('e', 'o', 'f', ' ')
@@ -72,18 +80,21 @@ public:
         fNumPaintWithPathEffectUses = src.fNumPaintWithPathEffectUses;
         fNumAAConcavePaths = src.fNumAAConcavePaths;
         fNumAAHairlineConcavePaths = src.fNumAAHairlineConcavePaths;
+        fNumPaintWithCPUImageFilterUses = src.fNumPaintWithCPUImageFilterUses;
     }
 
     void reset() {
         fNumPaintWithPathEffectUses = 0;
         fNumAAConcavePaths = 0;
         fNumAAHairlineConcavePaths = 0;
+        fNumPaintWithCPUImageFilterUses = 0;
     }
 
     void swap(SkPictureContentInfo* other) {
         SkTSwap(fNumPaintWithPathEffectUses, other->fNumPaintWithPathEffectUses);
         SkTSwap(fNumAAConcavePaths, other->fNumAAConcavePaths);
         SkTSwap(fNumAAHairlineConcavePaths, other->fNumAAHairlineConcavePaths);
+        SkTSwap(fNumPaintWithCPUImageFilterUses, other->fNumPaintWithCPUImageFilterUses);
     }
 
     void incPaintWithPathEffectUses() { ++fNumPaintWithPathEffectUses; }
@@ -98,6 +109,9 @@ public:
     }
     int numAAHairlineConcavePaths() const { return fNumAAHairlineConcavePaths; }
 
+    void incPaintWithCPUImageFilterUses() { ++fNumPaintWithCPUImageFilterUses; }
+    int numPaintWithCPUImageFilterUses() const { return fNumPaintWithCPUImageFilterUses; }
+
 private:
     // This field is incremented every time a paint with a path effect is
     // used (i.e., it is not a de-duplicated count)
@@ -108,6 +122,9 @@ private:
     // This field is incremented every time a drawPath call is
     // issued for a hairline stroked concave path.
     int fNumAAHairlineConcavePaths;
+    // This field is incremented every time a paint is used whose image filter
+    // would read its source back from the GPU (see SkImageFilter::canFilterGraphGPU).
+    int fNumPaintWithCPUImageFilterUses;
 };
 
 /**
@@ -127,9 +144,11 @@ public:
     SkPicturePlayback(const SkPicturePlayback& src,
                       SkPictCopyInfo* deepCopyInfo = NULL);
     SkPicturePlayback(const SkPictureRecord& record, const SkPictInfo&, bool deepCopyOps);
+    // 'streamData', if not NULL, holds the contents of 'stream' (see SkPicture::CreateFromData).
     static SkPicturePlayback* CreateFromStream(SkStream*,
                                                const SkPictInfo&,
-                                               SkPicture::InstallPixelRefProc);
+                                               SkPicture::InstallPixelRefProc,
+                                               const SkData* streamData = NULL);
     static SkPicturePlayback* CreateFromBuffer(SkReadBuffer&,
                                                const SkPictInfo&);
 
@@ -139,9 +158,13 @@ public:
 
     void setUseBBH(bool useBBH) { fUseBBH = useBBH; }
 
+    // When enabled (the default), getActiveOps() drops the draws that a later
+    // opaque draw completely covers within the query rect.
+    void setUseOcclusionCulling(bool useOcclusionCulling);
+
     void draw(SkCanvas& canvas, SkDrawPictureCallback*);
 
-    void serialize(SkWStream*, SkPicture::EncodeBitmap) const;
+    void serialize(SkWStream*, SkPicture::EncodeBitmap, uint32_t flags = 0) const;
     void flatten(SkWriteBuffer&) const;
 
     void dumpSize() const;
@@ -160,7 +183,7 @@ public:
 protected:
     explicit SkPicturePlayback(const SkPictInfo& info);
 
-    bool parseStream(SkStream*, SkPicture::InstallPixelRefProc);
+    bool parseStream(SkStream*, SkPicture::InstallPixelRefProc, const SkData* streamData);
     bool parseBuffer(SkReadBuffer& buffer);
 #ifdef SK_DEVELOPER
     virtual bool preDraw(int opIndex, int type);
@@ -202,6 +225,12 @@ private:
         return fPictureRefs[index - 1];
     }
 
+    const SkTextBlob* getTextBlob(SkReader32& reader) {
+        int index = reader.readInt();
+        SkASSERT(index > 0 && index <= fTextBlobCount);
+        return fTextBlobRefs[index - 1];
+    }
+
     const SkPaint* getPaint(SkReader32& reader) {
         int index = reader.readInt();
         if (index == 0) {
@@ -273,9 +302,11 @@ public:
 #endif
 
 private:    // these help us with reading/writing
-    bool parseStreamTag(SkStream*, uint32_t tag, uint32_t size, SkPicture::InstallPixelRefProc);
+    bool parseStreamTag(SkStream*, uint32_t tag, uint32_t size, SkPicture::InstallPixelRefProc,
+                        const SkData* streamData);
     bool parseBufferTag(SkReadBuffer&, uint32_t tag, uint32_t size);
-    void flattenToBuffer(SkWriteBuffer&) const;
+    void flattenToBuffer(SkWriteBuffer&,
+                         SkPathHeap::Encoding = SkPathHeap::kFull_Encoding) const;
 
 private:
     friend class SkPicture;
@@ -296,6 +327,8 @@ private:
 
     const SkPicture** fPictureRefs;
     int fPictureCount;
+    const SkTextBlob** fTextBlobRefs;
+    int fTextBlobCount;
 
     SkBBoxHierarchy* fBoundingHierarchy;
     SkPictureStateTree* fStateTree;
@@ -318,13 +351,15 @@ private:
     class PlaybackReplacements {
     public:
         // All the operations between fStart and fStop (inclusive) will be replaced with
-        // a single drawBitmap call using fPos, fBM and fPaint.
+        // a single drawBitmap call using fPos, fBM and fPaint. Only the fSrcRect part of
+        // fBM is drawn when it doesn't cover the whole bitmap (e.g. the bitmap is an atlas).
         // fPaint will be NULL if the picture's paint wasn't copyable
         struct ReplacementInfo {
             size_t          fStart;
             size_t          fStop;
             SkIPoint        fPos;
             SkBitmap*       fBM;
+            SkIRect         fSrcRect;
             const SkPaint*  fPaint;  // Note: this object doesn't own the paint
         };
 
@@ -359,6 +394,7 @@ private:
     }
 
     bool   fUseBBH;
+    bool   fUseOcclusionCulling;
     size_t fStart;
     size_t fStop;
     PlaybackReplacements* fReplacements;
@@ -386,6 +422,14 @@ private:
 
     CachedOperationList* fCachedActiveOps;
 
+    // Removes the draws in 'ops' (sorted SkPictureStateTree::Draw*s) that are
+    // hidden behind a later opaque draw covering all of 'query'.
+    void cullOccludedOps(const SkIRect& query, SkTDArray<void*>* ops);
+    // Returns true if the draw at 'offset' paints every pixel of 'query' opaquely.
+    bool drawCovers(uint32_t offset, const SkMatrix& matrix, const SkRect& query);
+    // Returns true if none of the clips at 'offsets' can grow the clip.
+    bool clipsOnlyShrink(const SkTDArray<uint32_t>& offsets);
+
     SkTypefacePlayback fTFPlayback;
     SkFactoryPlayback* fFactoryPlayback;
 
@@ -396,6 +440,8 @@ private:
 
     static void WriteFactories(SkWStream* stream, const SkFactorySet& rec);
     static void WriteTypefaces(SkWStream* stream, const SkRefCntSet& rec);
+    static void WritePayload(SkWStream* stream, uint32_t tag, uint32_t deflatedTag,
+                             const void* data, size_t size, bool deflate);
 
     void initForPlayback() const;
 
@@ -6,11 +6,15 @@
  */
 
 #include "SkPictureRecord.h"
+#include "SkChecksum.h"
+#include "SkShader.h"
 #include "SkTSearch.h"
 #include "SkPixelRef.h"
 #include "SkRRect.h"
+#include "SkTextBlob.h"
 #include "SkBBoxHierarchy.h"
 #include "SkDevice.h"
+#include "SkImageFilter.h"
 #include "SkPictureStateTree.h"
 
 #define HEAP_BLOCK_SIZE 4096
@@ -64,11 +68,13 @@ SkPictureRecord::SkPictureRecord(const SkISize& dimensions, uint32_t flags)
 }
 
 SkPictureRecord::~SkPictureRecord() {
+    fPaintCacheEntries.deleteAll();
     SkSafeUnref(fBitmapHeap);
     SkSafeUnref(fBoundingHierarchy);
     SkSafeUnref(fStateTree);
     fFlattenableHeap.setBitmapStorage(NULL);
     fPictureRefs.unrefAll();
+    fTextBlobRefs.unrefAll();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -122,6 +128,7 @@ static inline size_t getPaintOffset(DrawType op, size_t opSize) {
         1,  // DRAWDRRECT - right after op code
         0,  // PUSH_CULL - no paint
         0,  // POP_CULL - no paint
+        1,  // DRAW_TEXT_BLOB - right after op code
     };
 
     SK_COMPILE_ASSERT(sizeof(gPaintOffsets) == LAST_DRAWTYPE_ENUM + 1,
@@ -482,7 +489,7 @@ static bool remove_save_layer2(SkWriter32* writer, int32_t offset,
 }
 
 static bool is_drawing_op(DrawType op) {
-    return (op > CONCAT && op < ROTATE) || DRAW_DRRECT == op;
+    return (op > CONCAT && op < ROTATE) || DRAW_DRRECT == op || DRAW_TEXT_BLOB == op;
 }
 
 /*
@@ -1024,6 +1031,12 @@ void SkPictureRecord::drawRect(const SkRect& rect, const SkPaint& paint) {
     this->validate(initialOffset, size);
 }
 
+void SkPictureRecord::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    for (int i = 0; i < count; ++i) {
+        this->drawRect(rects[i], paint);
+    }
+}
+
 void SkPictureRecord::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
 
 #ifdef SK_COLLAPSE_MATRIX_CLIP_STATE
@@ -1415,6 +1428,24 @@ void SkPictureRecord::onDrawPicture(const SkPicture* picture) {
     this->validate(initialOffset, size);
 }
 
+void SkPictureRecord::onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                                     const SkPaint& paint) {
+
+#ifdef SK_COLLAPSE_MATRIX_CLIP_STATE
+    fMCMgr.call(SkMatrixClipStateMgr::kOther_CallType);
+#endif
+
+    // op + paint index + blob index + x/y
+    size_t size = 3 * kUInt32Size + 2 * sizeof(SkScalar);
+    size_t initialOffset = this->addDraw(DRAW_TEXT_BLOB, &size);
+    SkASSERT(initialOffset+getPaintOffset(DRAW_TEXT_BLOB, size) == fWriter.bytesWritten());
+    this->addPaint(paint);
+    this->addTextBlob(blob);
+    this->addScalar(x);
+    this->addScalar(y);
+    this->validate(initialOffset, size);
+}
+
 void SkPictureRecord::drawVertices(VertexMode vmode, int vertexCount,
                           const SkPoint vertices[], const SkPoint texs[],
                           const SkColor colors[], SkXfermode* xfer,
@@ -1582,14 +1613,93 @@ void SkPictureRecord::addMatrix(const SkMatrix& matrix) {
     fWriter.writeMatrix(matrix);
 }
 
+/**
+ *  A paint is the same as one recorded before if it compares equal, which means its effects
+ *  are the same objects. Effects are immutable, except that a shader's local matrix can be
+ *  changed with SK_SUPPORT_LEGACY_SHADER_LOCALMATRIX, so that is compared too. Bitmaps can change under the same effect, so paints whose
+ *  effects may hold one (see can_cache_paint()) are always flattened.
+ */
+struct SkPictureRecord::PaintKey {
+    PaintKey(const SkPaint& paint) : fPaint(&paint) {
+        if (NULL != paint.getShader()) {
+            fShaderLocalMatrix = paint.getShader()->getLocalMatrix();
+        } else {
+            fShaderLocalMatrix.reset();
+        }
+    }
+
+    bool operator==(const PaintKey& other) const {
+        return *fPaint == *other.fPaint && fShaderLocalMatrix == other.fShaderLocalMatrix;
+    }
+
+    const SkPaint* fPaint;
+    SkMatrix fShaderLocalMatrix;
+};
+
+struct SkPictureRecord::PaintCacheEntry {
+    PaintCacheEntry(const SkPaint& paint, const SkFlatData* flat)
+        : fPaint(paint)     // Holds refs to the effects, so their addresses are not reused.
+        , fKey(fPaint)
+        , fFlat(flat) {}
+
+    SkPaint fPaint;
+    PaintKey fKey;
+    const SkFlatData* fFlat;  // owned by fFlattenableHeap
+};
+
+struct SkPictureRecord::PaintCacheTraits {
+    static const PaintKey& GetKey(const PaintCacheEntry& entry) { return entry.fKey; }
+
+    // Only looks at some of the fields, but much cheaper than flattening.
+    static uint32_t Hash(const PaintKey& key) {
+        const SkPaint& paint = *key.fPaint;
+        const uint32_t fields[] = {
+            paint.getColor(),
+            static_cast<uint32_t>(SkFloat2Bits(paint.getTextSize())),
+            static_cast<uint32_t>(SkFloat2Bits(paint.getStrokeWidth())),
+            paint.getFlags(),
+            (static_cast<uint32_t>(paint.getStyle()) << 8) | paint.getTextAlign(),
+            static_cast<uint32_t>(reinterpret_cast<uintptr_t>(paint.getShader())),
+            static_cast<uint32_t>(reinterpret_cast<uintptr_t>(paint.getTypeface())),
+            static_cast<uint32_t>(reinterpret_cast<uintptr_t>(paint.getXfermode())),
+        };
+        return SkChecksum::Murmur3(fields, sizeof(fields));
+    }
+};
+
+static bool can_cache_paint(const SkPaint& paint) {
+    const SkShader* shader = paint.getShader();
+    return (NULL == shader || SkShader::kNone_GradientType != shader->asAGradient(NULL)) &&
+           NULL == paint.getLooper() && NULL == paint.getImageFilter();
+}
+
 const SkFlatData* SkPictureRecord::getFlatPaintData(const SkPaint& paint) {
-    return fPaints.findAndReturnFlat(paint);
+    if (!can_cache_paint(paint)) {
+        return fPaints.findAndReturnFlat(paint);
+    }
+
+    // Only paints that miss the cache are flattened. Entries are never removed from fPaints,
+    // so the cached SkFlatData stay valid.
+    const PaintCacheEntry* entry = fPaintCache.find(PaintKey(paint));
+    if (NULL != entry) {
+        return entry->fFlat;
+    }
+
+    const SkFlatData* flat = fPaints.findAndReturnFlat(paint);
+    PaintCacheEntry* newEntry = SkNEW_ARGS(PaintCacheEntry, (paint, flat));
+    *fPaintCacheEntries.append() = newEntry;
+    fPaintCache.add(newEntry);
+    return flat;
 }
 
 const SkFlatData* SkPictureRecord::addPaintPtr(const SkPaint* paint) {
     if (NULL != paint && NULL != paint->getPathEffect()) {
         fContentInfo.incPaintWithPathEffectUses();
     }
+    if (NULL != paint && NULL != paint->getImageFilter() &&
+        !paint->getImageFilter()->canFilterGraphGPU()) {
+        fContentInfo.incPaintWithCPUImageFilterUses();
+    }
 
     const SkFlatData* data = paint ? getFlatPaintData(*paint) : NULL;
     this->addFlatPaint(data);
@@ -1627,6 +1737,17 @@ void SkPictureRecord::addPicture(const SkPicture* picture) {
     this->addInt(index + 1);
 }
 
+void SkPictureRecord::addTextBlob(const SkTextBlob* blob) {
+    int index = fTextBlobRefs.find(blob);
+    if (index < 0) {    // not found
+        index = fTextBlobRefs.count();
+        *fTextBlobRefs.append() = blob;
+        blob->ref();
+    }
+    // follow the convention of recording a 1-based index
+    this->addInt(index + 1);
+}
+
 void SkPictureRecord::addPoint(const SkPoint& point) {
 #ifdef SK_DEBUG_SIZE
     size_t start = fWriter.bytesWritten();
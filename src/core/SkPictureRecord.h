@@ -43,6 +43,7 @@ public:
                             const SkPaint&) SK_OVERRIDE;
     virtual void drawOval(const SkRect&, const SkPaint&) SK_OVERRIDE;
     virtual void drawRect(const SkRect&, const SkPaint&) SK_OVERRIDE;
+    virtual void drawRects(const SkRect[], int count, const SkPaint&) SK_OVERRIDE;
     virtual void drawRRect(const SkRRect&, const SkPaint&) SK_OVERRIDE;
     virtual void drawPath(const SkPath& path, const SkPaint&) SK_OVERRIDE;
     virtual void drawBitmap(const SkBitmap&, SkScalar left, SkScalar top,
@@ -74,6 +75,10 @@ public:
         return fPictureRefs;
     }
 
+    const SkTDArray<const SkTextBlob* >& getTextBlobRefs() const {
+        return fTextBlobRefs;
+    }
+
     SkData* opData(bool deepCopy) const {
         this->validate(fWriter.bytesWritten(), 0);
 
@@ -179,6 +184,7 @@ private:
     void addFlatPaint(const SkFlatData* flatPaint);
     void addPath(const SkPath& path);
     void addPicture(const SkPicture* picture);
+    void addTextBlob(const SkTextBlob* blob);
     void addPoint(const SkPoint& point);
     void addPoints(const SkPoint pts[], int count);
     void addRect(const SkRect& rect);
@@ -252,6 +258,8 @@ protected:
                                 SkScalar constY, const SkPaint&) SK_OVERRIDE;
     virtual void onDrawTextOnPath(const void* text, size_t byteLength, const SkPath& path,
                                   const SkMatrix* matrix, const SkPaint&) SK_OVERRIDE;
+    virtual void onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                                const SkPaint& paint) SK_OVERRIDE;
 
     virtual void onClipRect(const SkRect&, SkRegion::Op, ClipEdgeStyle) SK_OVERRIDE;
     virtual void onClipRRect(const SkRRect&, SkRegion::Op, ClipEdgeStyle) SK_OVERRIDE;
@@ -316,10 +324,18 @@ private:
 
     SkPaintDictionary fPaints;
 
+    // Paints recorded so far, so that a repeated paint is found without flattening it again.
+    struct PaintKey;
+    struct PaintCacheEntry;
+    struct PaintCacheTraits;
+    SkTDynamicHash<PaintCacheEntry, PaintKey, PaintCacheTraits> fPaintCache;
+    SkTDArray<PaintCacheEntry*> fPaintCacheEntries;  // owned
+
     SkWriter32 fWriter;
 
     // we ref each item in these arrays
     SkTDArray<const SkPicture*> fPictureRefs;
+    SkTDArray<const SkTextBlob*> fTextBlobRefs;
 
     uint32_t fRecordFlags;
     bool     fOptsEnabled;
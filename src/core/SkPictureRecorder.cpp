@@ -9,16 +9,27 @@
 #include "SkPicturePlayback.h"
 #include "SkPictureRecord.h"
 #include "SkPictureRecorder.h"
+#include "SkRecord.h"
+#include "SkRecordDraw.h"
+#include "SkRecordOpts.h"
+#include "SkRecorder.h"
 #include "SkTypes.h" 
 
 SkPictureRecorder::~SkPictureRecorder() {
     SkSafeSetNull(fCanvas);
+    SkSafeSetNull(fRecorder);
+    SkSafeSetNull(fBBH);
+    SkDELETE(fRecord);
 }
 
 SkCanvas* SkPictureRecorder::beginRecording(int width, int height,
                                             SkBBHFactory* bbhFactory /* = NULL */,
                                             uint32_t recordFlags /* = 0 */) {
     SkSafeSetNull(fCanvas); // terminate any prior recording(s)
+    SkSafeSetNull(fRecorder);
+    SkSafeSetNull(fBBH);
+    SkDELETE(fRecord);
+    fRecord = NULL;
 
     fWidth = width;
     fHeight = height;
@@ -38,11 +49,46 @@ SkCanvas* SkPictureRecorder::beginRecording(int width, int height,
     return fCanvas;
 }
 
+SkCanvas* SkPictureRecorder::EXPERIMENTAL_beginRecording(int width, int height,
+                                                          SkBBHFactory* bbhFactory /* = NULL */) {
+    SkSafeSetNull(fCanvas); // terminate any prior recording(s)
+    SkSafeSetNull(fRecorder);
+    SkSafeSetNull(fBBH);
+    SkDELETE(fRecord);
+
+    fWidth = width;
+    fHeight = height;
+
+    if (NULL != bbhFactory) {
+        fBBH = (*bbhFactory)(width, height);
+        SkASSERT(NULL != fBBH);
+    }
+
+    fRecord = SkNEW(SkRecord);
+    fRecorder = SkNEW_ARGS(SkRecorder, (fRecord, width, height));
+    return fRecorder;
+}
+
 SkCanvas* SkPictureRecorder::getRecordingCanvas() {
+    if (NULL != fRecorder) {
+        return fRecorder;
+    }
     return fCanvas;
 }
 
 SkPicture* SkPictureRecorder::endRecording() {
+    if (NULL != fRecord) {
+        // The recorder may outlive us if someone else took a ref on it.
+        fRecorder->forgetRecord();
+        SkSafeSetNull(fRecorder);
+
+        SkRecordOptimize(fRecord);
+        SkPicture* picture = SkNEW_ARGS(SkPicture, (fWidth, fHeight, fRecord, fBBH));
+        fRecord = NULL;
+        SkSafeSetNull(fBBH);
+        return picture;
+    }
+
     if (NULL == fCanvas) {
         return NULL;
     }
@@ -64,8 +110,18 @@ void SkPictureRecorder::internalOnly_EnableOpts(bool enableOpts) {
 }
 
 void SkPictureRecorder::partialReplay(SkCanvas* canvas) const {
-    if (NULL == fCanvas || NULL == canvas) {
-        // Not recording or nothing to replay into
+    if (NULL == canvas) {
+        // Nothing to replay into
+        return;
+    }
+
+    if (NULL != fRecord) {
+        SkRecordDraw(*fRecord, canvas);
+        return;
+    }
+
+    if (NULL == fCanvas) {
+        // Not recording
         return;
     }
 
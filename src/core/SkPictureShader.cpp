@@ -13,6 +13,7 @@
 #include "SkMatrixUtils.h"
 #include "SkPicture.h"
 #include "SkReadBuffer.h"
+#include "SkScaledImageCache.h"
 
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
@@ -84,22 +85,54 @@ SkShader* SkPictureShader::refBitmapShader(const SkMatrix& matrix, const SkMatri
     // TODO(fmalita): remove fCachedLocalMatrix from this key after getLocalMatrix is removed.
     if (!fCachedBitmapShader || tileScale != fCachedTileScale ||
         this->getLocalMatrix() != fCachedLocalMatrix) {
+        // Tiles are shared through the scaled image cache, so other shaders (and
+        // frames) drawing the same picture at the same scale don't re-rasterize it.
+        // On the GPU the tile's stable generation ID lets its texture be reused too.
+        const SkIRect tile = SkIRect::MakeSize(tileSize);
         SkBitmap bm;
-        if (!bm.allocN32Pixels(tileSize.width(), tileSize.height())) {
-            return NULL;
+        SkScaledImageCache::ID* id = SkScaledImageCache::FindAndLockPicture(
+            fPicture->uniqueID(), tileScale.width(), tileScale.height(), tile, &bm);
+        if (NULL != id) {
+            bm.lockPixels();
+            if (NULL == bm.getPixels()) {
+                // Its (discardable) pixels were purged; draw the tile again.
+                bm.unlockPixels();
+                SkScaledImageCache::Unlock(id);
+                id = NULL;
+            }
         }
-        bm.eraseColor(SK_ColorTRANSPARENT);
 
-        SkCanvas canvas(bm);
-        canvas.scale(tileScale.width(), tileScale.height());
-        canvas.drawPicture(fPicture);
+        if (NULL == id) {
+            bm.reset();
+            bm.setInfo(SkImageInfo::MakeN32Premul(tileSize.width(), tileSize.height()));
+            if (!bm.allocPixels(SkScaledImageCache::GetAllocator(), NULL)) {
+                return NULL;
+            }
+            bm.eraseColor(SK_ColorTRANSPARENT);
+
+            SkCanvas canvas(bm);
+            canvas.scale(tileScale.width(), tileScale.height());
+            canvas.drawPicture(fPicture);
+            bm.setImmutable();
+
+            // If the cache won't take it, we can still use the tile ourselves.
+            id = SkScaledImageCache::AddAndLockPicture(
+                fPicture->uniqueID(), tileScale.width(), tileScale.height(), tile, bm);
+        }
+        if (NULL != id) {
+            SkScaledImageCache::Unlock(id);
+        }
+
+        // bm is still locked here, so its pixels survive the old tile's unlock.
+        fCachedBitmap = bm;
+        fCachedBitmap.lockPixels();
 
         fCachedTileScale = tileScale;
         fCachedLocalMatrix = this->getLocalMatrix();
 
         SkMatrix shaderMatrix = this->getLocalMatrix();
         shaderMatrix.preScale(1 / tileScale.width(), 1 / tileScale.height());
-        fCachedBitmapShader.reset(CreateBitmapShader(bm, fTmx, fTmy, &shaderMatrix));
+        fCachedBitmapShader.reset(CreateBitmapShader(fCachedBitmap, fTmx, fTmy, &shaderMatrix));
     }
 
     // Increment the ref counter inside the mutex to ensure the returned pointer is still valid.
@@ -47,6 +47,8 @@ private:
 
     mutable SkMutex                 fCachedBitmapShaderMutex;
     mutable SkAutoTUnref<SkShader>  fCachedBitmapShader;
+    // The tile fCachedBitmapShader draws, kept locked so its pixels can't be discarded.
+    mutable SkBitmap                fCachedBitmap;
     mutable SkSize                  fCachedTileScale;
     mutable SkMatrix                fCachedLocalMatrix;
 
@@ -8,12 +8,22 @@
 
 #include "SkPictureStateTree.h"
 #include "SkCanvas.h"
+#include "SkChecksum.h"
+
+uint32_t SkPictureStateTree::MatrixTraits::Hash(const SkMatrix& matrix) {
+    SkScalar values[9];
+    for (int i = 0; i < 9; ++i) {
+        values[i] = matrix[i];
+    }
+    return SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(values), sizeof(values));
+}
 
 SkPictureStateTree::SkPictureStateTree()
     : fAlloc(2048)
     , fLastRestoredNode(NULL)
     , fStateStack(sizeof(Draw), 16) {
     fRootMatrix.reset();
+    fMatrices.add(&fRootMatrix);
     fRoot.fParent = NULL;
     fRoot.fMatrix = &fRootMatrix;
     fRoot.fFlags = Node::kSave_Flag;
@@ -64,8 +74,14 @@ void SkPictureStateTree::appendRestore() {
 }
 
 void SkPictureStateTree::appendTransform(const SkMatrix& trans) {
-    SkMatrix* m = static_cast<SkMatrix*>(fAlloc.allocThrow(sizeof(SkMatrix)));
-    *m = trans;
+    // Content often translates into place, draws, and translates back, or sets the same matrix
+    // over and over. Each of those returns to a matrix that is already in the tree.
+    SkMatrix* m = fMatrices.find(trans);
+    if (NULL == m) {
+        m = static_cast<SkMatrix*>(fAlloc.allocThrow(sizeof(SkMatrix)));
+        *m = trans;
+        fMatrices.add(m);
+    }
     fCurrentState.fMatrix = m;
 }
 
@@ -78,6 +94,24 @@ SkPictureStateTree::Iterator SkPictureStateTree::getIterator(const SkTDArray<voi
     return Iterator(draws, canvas, &fRoot);
 }
 
+bool SkPictureStateTree::GetStateOffsets(const Draw& draw, const Draw* ancestor,
+                                         SkTDArray<uint32_t>* offsets) {
+    SkASSERT(NULL != offsets);
+    offsets->rewind();
+
+    const Node* stop = NULL != ancestor ? ancestor->fNode : NULL;
+    for (const Node* node = draw.fNode; node != stop; node = node->fParent) {
+        if (NULL == node) {
+            return false;
+        }
+        // The root has no command of its own.
+        if (NULL != node->fParent) {
+            offsets->push(node->fOffset);
+        }
+    }
+    return true;
+}
+
 void SkPictureStateTree::appendNode(size_t offset) {
     Node* n = static_cast<Node*>(fAlloc.allocThrow(sizeof(Node)));
     n->fOffset = SkToU32(offset);
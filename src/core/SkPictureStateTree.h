@@ -14,6 +14,7 @@
 #include "SkDeque.h"
 #include "SkMatrix.h"
 #include "SkRefCnt.h"
+#include "SkTDynamicHash.h"
 
 class SkCanvas;
 
@@ -56,6 +57,14 @@ public:
      */
     Iterator getIterator(const SkTDArray<void*>& draws, SkCanvas* canvas);
 
+    /**
+     * Collects the command offsets of the clips and saveLayers that 'draw' was recorded under but
+     * 'ancestor' was not, innermost first. Returns false if 'draw' was not recorded within the
+     * clip/layer state of 'ancestor'. Passing NULL for 'ancestor' collects all of them.
+     */
+    static bool GetStateOffsets(const Draw& draw, const Draw* ancestor,
+                                SkTDArray<uint32_t>* offsets);
+
     void appendSave();
     void appendSaveLayer(size_t offset);
     void appendRestore();
@@ -126,7 +135,15 @@ private:
 
     void appendNode(size_t offset);
 
+    // Matrices are interned, so that draws and nodes under equal matrices share one, and the
+    // iterator, which compares them by address, doesn't set the same matrix again.
+    struct MatrixTraits {
+        static const SkMatrix& GetKey(const SkMatrix& matrix) { return matrix; }
+        static uint32_t Hash(const SkMatrix&);
+    };
+
     SkChunkAlloc fAlloc;
+    SkTDynamicHash<SkMatrix, SkMatrix, MatrixTraits> fMatrices;
     // Needed by saveCollapsed() because nodes do not currently store
     // references to their children.  If they did, we could just retrieve the
     // last added child.
@@ -285,6 +285,10 @@ SkData* SkPixelRef::onRefEncodedData() {
     return NULL;
 }
 
+bool SkPixelRef::onGetYUV8Planes(SkISize[3], void*[3], size_t[3]) {
+    return false;
+}
+
 size_t SkPixelRef::getAllocatedSizeInBytes() const {
     return 0;
 }
@@ -10,6 +10,9 @@
 #include <stdio.h>
 
 static const int kSplitThreshold = 8;
+// Children are merged back into their parent at half the split threshold, so that a node which
+// just merged doesn't split again on the next insert.
+static const int kMergeThreshold = kSplitThreshold / 2;
 
 enum {
     kTopLeft,
@@ -46,6 +49,17 @@ static U8CPU child_intersect(const SkIRect& query, const SkIPoint& split) {
     return intersect;
 }
 
+// Returns the child that bounds falls in alone, or -1 if it straddles the split point.
+static int child_index(const SkIRect& bounds, const SkIPoint& split) {
+    switch (child_intersect(bounds, split)) {
+        case kTopLeft_Bit:     return kTopLeft;
+        case kTopRight_Bit:    return kTopRight;
+        case kBottomLeft_Bit:  return kBottomLeft;
+        case kBottomRight_Bit: return kBottomRight;
+        default:               return -1;
+    }
+}
+
 SkQuadTree::SkQuadTree(const SkIRect& bounds) : fRoot(NULL) {
     SkASSERT((bounds.width() * bounds.height()) > 0);
     fRootBounds = bounds;
@@ -57,23 +71,13 @@ SkQuadTree::~SkQuadTree() {
 void SkQuadTree::insert(Node* node, Entry* entry) {
     // does it belong in a child?
     if (NULL != node->fChildren[0]) {
-        switch(child_intersect(entry->fBounds, node->fSplitPoint)) {
-            case kTopLeft_Bit:
-                this->insert(node->fChildren[kTopLeft], entry);
-                return;
-            case kTopRight_Bit:
-                this->insert(node->fChildren[kTopRight], entry);
-                return;
-            case kBottomLeft_Bit:
-                this->insert(node->fChildren[kBottomLeft], entry);
-                return;
-            case kBottomRight_Bit:
-                this->insert(node->fChildren[kBottomRight], entry);
-                return;
-            default:
-                node->fEntries.push(entry);
-                return;
+        int index = child_index(entry->fBounds, node->fSplitPoint);
+        if (index >= 0) {
+            this->insert(node->fChildren[index], entry);
+        } else {
+            node->fEntries.push(entry);
         }
+        return;
     }
     // No children yet, add to this node
     node->fEntries.push(entry);
@@ -110,6 +114,26 @@ void SkQuadTree::split(Node* node) {
     }
 }
 
+void SkQuadTree::merge(Node* node) {
+    int count = node->fEntries.getCount();
+    for (int index = 0; index < kChildCount; ++index) {
+        const Node* child = node->fChildren[index];
+        if (NULL != child->fChildren[0]) {
+            return;
+        }
+        count += child->fEntries.getCount();
+    }
+    if (count > kMergeThreshold) {
+        return;
+    }
+    for (int index = 0; index < kChildCount; ++index) {
+        Node* child = node->fChildren[index];
+        node->fChildren[index] = NULL;
+        node->fEntries.pushAll(&child->fEntries);
+        fNodePool.release(child);
+    }
+}
+
 void SkQuadTree::search(Node* node, const SkIRect& query,
                         SkTDArray<void*>* results) const {
     for (Entry* entry = node->fEntries.head(); NULL != entry;
@@ -144,11 +168,12 @@ void SkQuadTree::clear(Node* node) {
 }
 
 int SkQuadTree::getDepth(Node* node) const {
+    if (NULL == node) {
+        return 0;
+    }
     int maxDepth = 0;
-    if (NULL != node) {
-        for(int index=0; index<kChildCount; ++index) {
-            maxDepth = SkMax32(maxDepth, getDepth(node->fChildren[index]));
-        }
+    for(int index=0; index<kChildCount; ++index) {
+        maxDepth = SkMax32(maxDepth, getDepth(node->fChildren[index]));
     }
     return maxDepth + 1;
 }
@@ -168,6 +193,80 @@ void SkQuadTree::insert(void* data, const SkIRect& bounds, bool) {
     }
 }
 
+// Releases the first entry in entries matching data and bounds.
+bool SkQuadTree::removeEntry(SkTInternalSList<Entry>* entries, void* data,
+                             const SkIRect& bounds) {
+    SkTInternalSList<Entry> kept;
+    bool found = false;
+    while (!entries->isEmpty()) {
+        Entry* entry = entries->pop();
+        if (!found && entry->fData == data && entry->fBounds == bounds) {
+            entry->fData = NULL;
+            fEntryPool.release(entry);
+            found = true;
+        } else {
+            kept.push(entry);
+        }
+    }
+    // Popping and pushing reversed the entries; do it again to restore their order.
+    while (!kept.isEmpty()) {
+        entries->push(kept.pop());
+    }
+    return found;
+}
+
+// Returns the node an entry with these bounds is in: the first one on the way down that has no
+// children, or whose split point the bounds straddle.
+SkQuadTree::Node* SkQuadTree::findNode(const SkIRect& bounds) const {
+    Node* node = fRoot;
+    while (NULL != node->fChildren[0]) {
+        int index = child_index(bounds, node->fSplitPoint);
+        if (index < 0) {
+            break;
+        }
+        node = node->fChildren[index];
+    }
+    return node;
+}
+
+bool SkQuadTree::remove(Node* node, void* data, const SkIRect& bounds) {
+    if (NULL == node->fChildren[0]) {
+        return this->removeEntry(&node->fEntries, data, bounds);
+    }
+    int index = child_index(bounds, node->fSplitPoint);
+    if (index < 0 ? !this->removeEntry(&node->fEntries, data, bounds)
+                  : !this->remove(node->fChildren[index], data, bounds)) {
+        return false;
+    }
+    // A merge may leave node without children, so its parent can then merge too.
+    this->merge(node);
+    return true;
+}
+
+bool SkQuadTree::remove(void* data, const SkIRect& bounds) {
+    if (NULL == fRoot) {
+        return this->removeEntry(&fDeferred, data, bounds);
+    }
+    return this->remove(fRoot, data, bounds);
+}
+
+bool SkQuadTree::update(void* data, const SkIRect& oldBounds, const SkIRect& newBounds) {
+    if (NULL != fRoot && !newBounds.isEmpty()) {
+        Node* node = this->findNode(oldBounds);
+        if (node == this->findNode(newBounds)) {
+            for (Entry* entry = node->fEntries.head(); NULL != entry;
+                 entry = entry->getSListNext()) {
+                if (entry->fData == data && entry->fBounds == oldBounds) {
+                    entry->fBounds = newBounds;
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+    return this->INHERITED::update(data, oldBounds, newBounds);
+}
+
 void SkQuadTree::search(const SkIRect& query, SkTDArray<void*>* results) {
     SkASSERT(NULL != fRoot);
     SkASSERT(NULL != results);
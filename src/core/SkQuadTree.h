@@ -46,6 +46,19 @@ public:
      */
     virtual void insert(void* data, const SkIRect& bounds, bool defer = false) SK_OVERRIDE;
 
+    /**
+     * Remove a data value inserted with these bounds. Once the children of a node hold few
+     * enough entries between them, they are merged back into it, so a tree that sees many inserts
+     * and removes doesn't keep every node it ever split.
+     */
+    virtual bool remove(void* data, const SkIRect& bounds) SK_OVERRIDE;
+
+    /**
+     * Changes an entry's bounds in place if the new ones belong in the same node as the old ones.
+     */
+    virtual bool update(void* data, const SkIRect& oldBounds,
+                        const SkIRect& newBounds) SK_OVERRIDE;
+
     /**
      * If any inserts have been deferred, this will add them into the tree
      */
@@ -102,7 +115,11 @@ private:
     SkTInternalSList<Entry> fDeferred;
 
     void insert(Node* node, Entry* entry);
+    Node* findNode(const SkIRect& bounds) const;
+    bool remove(Node* node, void* data, const SkIRect& bounds);
+    bool removeEntry(SkTInternalSList<Entry>* entries, void* data, const SkIRect& bounds);
     void split(Node* node);
+    void merge(Node* node);
     void search(Node* node, const SkIRect& query, SkTDArray<void*>* results) const;
     void clear(Node* node);
     int getDepth(Node* node) const;
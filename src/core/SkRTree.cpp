@@ -8,6 +8,12 @@
 #include "SkRTree.h"
 #include "SkTSort.h"
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+    #include <arm_neon.h>
+#endif
+
 static inline uint32_t get_area(const SkIRect& rect);
 static inline uint32_t get_overlap(const SkIRect& rect1, const SkIRect& rect2);
 static inline uint32_t get_margin(const SkIRect& rect);
@@ -33,7 +39,8 @@ SkRTree::SkRTree(int minChildren, int maxChildren, SkScalar aspectRatio,
     , fCount(0)
     , fNodes(fNodeSize * 256)
     , fAspectRatio(aspectRatio)
-    , fSortWhenBulkLoading(sortWhenBulkLoading) {
+    , fSortWhenBulkLoading(sortWhenBulkLoading)
+    , fGroups(NULL) {
     SkASSERT(minChildren < maxChildren && minChildren > 0 && maxChildren <
              static_cast<int>(SK_MaxU16));
     SkASSERT((maxChildren + 1) / 2 >= minChildren);
@@ -53,6 +60,7 @@ void SkRTree::insert(void* data, const SkIRect& bounds, bool defer) {
     Branch newBranch;
     newBranch.fBounds = bounds;
     newBranch.fChild.data = data;
+    this->unpack();
     if (this->isEmpty()) {
         // since a bulk-load into an existing tree is as of yet unimplemented (and arguably not
         // of vital importance right now), we only batch up inserts if the tree is empty.
@@ -82,6 +90,127 @@ void SkRTree::insert(void* data, const SkIRect& bounds, bool defer) {
     this->validate();
 }
 
+bool SkRTree::remove(void* data, const SkIRect& bounds) {
+    this->validate();
+    for (int i = 0; i < fDeferredInserts.count(); ++i) {
+        if (fDeferredInserts[i].fChild.data == data && fDeferredInserts[i].fBounds == bounds) {
+            fDeferredInserts.remove(i);
+            return true;
+        }
+    }
+    if (this->isEmpty() || !fRoot.fBounds.contains(bounds)) {
+        return false;
+    }
+
+    SkTDArray<Branch> orphans;
+    if (!this->remove(fRoot.fChild.subtree, data, bounds, &orphans)) {
+        return false;
+    }
+    this->unpack();
+    fCount -= 1 + orphans.count();
+
+    // An interior root left with one child hands the root over to it.
+    Node* root = fRoot.fChild.subtree;
+    while (!root->isLeaf() && 1 == root->fNumChildren) {
+        fRoot = *root->child(0);
+        root = fRoot.fChild.subtree;
+    }
+    if (0 != root->fNumChildren) {
+        fRoot.fBounds = this->computeBounds(root);
+    } else {
+        SkASSERT(0 == fCount);
+    }
+
+    for (int i = 0; i < orphans.count(); ++i) {
+        this->insert(orphans[i].fChild.data, orphans[i].fBounds);
+    }
+    this->validate();
+    return true;
+}
+
+bool SkRTree::remove(Node* root, void* data, const SkIRect& bounds,
+                     SkTDArray<Branch>* orphans) {
+    for (int i = 0; i < root->fNumChildren; ++i) {
+        Branch* branch = root->child(i);
+        if (root->isLeaf()) {
+            if (branch->fChild.data != data || branch->fBounds != bounds) {
+                continue;
+            }
+        } else {
+            Node* subtree = branch->fChild.subtree;
+            if (!branch->fBounds.contains(bounds) ||
+                !this->remove(subtree, data, bounds, orphans)) {
+                continue;
+            }
+            if (subtree->fNumChildren >= fMinChildren) {
+                branch->fBounds = this->computeBounds(subtree);
+                return true;
+            }
+            this->collectLeaves(subtree, orphans);
+        }
+        // Drop the branch, keeping the rest in order.
+        memmove(root->child(i), root->child(i + 1),
+                (root->fNumChildren - i - 1) * sizeof(Branch));
+        --root->fNumChildren;
+        return true;
+    }
+    return false;
+}
+
+bool SkRTree::update(void* data, const SkIRect& oldBounds, const SkIRect& newBounds) {
+    this->validate();
+    if (!newBounds.isEmpty()) {
+        for (int i = 0; i < fDeferredInserts.count(); ++i) {
+            if (fDeferredInserts[i].fChild.data == data &&
+                fDeferredInserts[i].fBounds == oldBounds) {
+                fDeferredInserts[i].fBounds = newBounds;
+                return true;
+            }
+        }
+        if (!this->isEmpty() && fRoot.fBounds.contains(oldBounds) &&
+            this->update(fRoot.fChild.subtree, fRoot.fBounds, data, oldBounds, newBounds)) {
+            this->unpack();
+            fRoot.fBounds = this->computeBounds(fRoot.fChild.subtree);
+            this->validate();
+            return true;
+        }
+    }
+    return this->INHERITED::update(data, oldBounds, newBounds);
+}
+
+bool SkRTree::update(Node* root, const SkIRect& rootBounds, void* data,
+                     const SkIRect& oldBounds, const SkIRect& newBounds) {
+    for (int i = 0; i < root->fNumChildren; ++i) {
+        Branch* branch = root->child(i);
+        if (root->isLeaf()) {
+            if (branch->fChild.data == data && branch->fBounds == oldBounds) {
+                if (!rootBounds.contains(newBounds)) {
+                    return false;
+                }
+                branch->fBounds = newBounds;
+                return true;
+            }
+        } else if (branch->fBounds.contains(oldBounds) &&
+                   this->update(branch->fChild.subtree, branch->fBounds, data, oldBounds,
+                                newBounds)) {
+            // The new bounds may be smaller, so this can shrink.
+            branch->fBounds = this->computeBounds(branch->fChild.subtree);
+            return true;
+        }
+    }
+    return false;
+}
+
+void SkRTree::collectLeaves(Node* root, SkTDArray<Branch>* leaves) {
+    for (int i = 0; i < root->fNumChildren; ++i) {
+        if (root->isLeaf()) {
+            leaves->push(*root->child(i));
+        } else {
+            this->collectLeaves(root->child(i)->fChild.subtree, leaves);
+        }
+    }
+}
+
 void SkRTree::flushDeferredInserts() {
     this->validate();
     if (this->isEmpty() && fDeferredInserts.count() > 0) {
@@ -94,6 +223,7 @@ void SkRTree::flushDeferredInserts() {
         } else {
             fRoot = this->bulkLoad(&fDeferredInserts);
         }
+        this->pack();
     } else {
         // TODO: some algorithm for bulk loading into an already populated tree
         SkASSERT(0 == fDeferredInserts.count());
@@ -108,13 +238,18 @@ void SkRTree::search(const SkIRect& query, SkTDArray<void*>* results) {
         this->flushDeferredInserts();
     }
     if (!this->isEmpty() && SkIRect::IntersectsNoEmptyCheck(fRoot.fBounds, query)) {
-        this->search(fRoot.fChild.subtree, query, results);
+        if (fPackedNodes.isEmpty()) {
+            this->search(fRoot.fChild.subtree, query, results);
+        } else {
+            this->searchPacked(0, query, results);
+        }
     }
     this->validate();
 }
 
 void SkRTree::clear() {
     this->validate();
+    this->unpack();
     fNodes.reset();
     fDeferredInserts.rewind();
     fCount = 0;
@@ -314,6 +449,133 @@ void SkRTree::search(Node* root, const SkIRect query, SkTDArray<void*>* results)
     }
 }
 
+// Returns a bit for each of group's 4 children that intersects query, bit 0 for the first child.
+static inline unsigned intersect_group(const int32_t left[4], const int32_t top[4],
+                                       const int32_t right[4], const int32_t bottom[4],
+                                       const SkIRect& query) {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128i l = _mm_load_si128(reinterpret_cast<const __m128i*>(left)),
+                  t = _mm_load_si128(reinterpret_cast<const __m128i*>(top)),
+                  r = _mm_load_si128(reinterpret_cast<const __m128i*>(right)),
+                  b = _mm_load_si128(reinterpret_cast<const __m128i*>(bottom));
+    const __m128i hits = _mm_and_si128(
+            _mm_and_si128(_mm_cmplt_epi32(l, _mm_set1_epi32(query.fRight)),
+                          _mm_cmpgt_epi32(r, _mm_set1_epi32(query.fLeft))),
+            _mm_and_si128(_mm_cmplt_epi32(t, _mm_set1_epi32(query.fBottom)),
+                          _mm_cmpgt_epi32(b, _mm_set1_epi32(query.fTop))));
+    return _mm_movemask_ps(_mm_castsi128_ps(hits));
+#elif defined(__ARM_NEON__)
+    const uint32x4_t hits = vandq_u32(
+            vandq_u32(vcltq_s32(vld1q_s32(left), vdupq_n_s32(query.fRight)),
+                      vcgtq_s32(vld1q_s32(right), vdupq_n_s32(query.fLeft))),
+            vandq_u32(vcltq_s32(vld1q_s32(top), vdupq_n_s32(query.fBottom)),
+                      vcgtq_s32(vld1q_s32(bottom), vdupq_n_s32(query.fTop))));
+    // Each lane is all ones or all zeros; keep one bit from each, in its lane's position.
+    static const uint32_t kLaneBits[4] = { 1, 2, 4, 8 };
+    const uint32x4_t bits = vandq_u32(hits, vld1q_u32(kLaneBits));
+    const uint32x2_t pairs = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return vget_lane_u32(pairs, 0) | vget_lane_u32(pairs, 1);
+#else
+    unsigned hits = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (left[i] < query.fRight && query.fLeft < right[i] &&
+            top[i] < query.fBottom && query.fTop < bottom[i]) {
+            hits |= 1 << i;
+        }
+    }
+    return hits;
+#endif
+}
+
+void SkRTree::searchPacked(int nodeIndex, const SkIRect& query,
+                           SkTDArray<void*>* results) const {
+    const PackedNode& node = fPackedNodes[nodeIndex];
+    for (int g = 0; g < node.fNumGroups; ++g) {
+        const BoundsGroup& group = fGroups[node.fFirstGroup + g];
+        unsigned hits = intersect_group(group.fLeft, group.fTop, group.fRight, group.fBottom,
+                                        query);
+        const PackedChild* children = &fPackedChildren[4 * (node.fFirstGroup + g)];
+        for (int i = 0; 0 != hits; ++i, hits >>= 1) {
+            if (hits & 1) {
+                if (0 == node.fLevel) {
+                    results->push(children[i].fData);
+                } else {
+                    this->searchPacked(children[i].fNode, query, results);
+                }
+            }
+        }
+    }
+}
+
+void SkRTree::pack() {
+    this->unpack();
+    if (this->isEmpty()) {
+        return;
+    }
+
+    // Lay the nodes out breadth-first, so a search's early steps share a few cache lines.
+    SkTDArray<Node*> nodes;
+    nodes.push(fRoot.fChild.subtree);
+    int groupCount = 0;
+    for (int n = 0; n < nodes.count(); ++n) {
+        Node* node = nodes[n];
+        PackedNode* packed = fPackedNodes.append();
+        packed->fFirstGroup = groupCount;
+        packed->fNumGroups = (node->fNumChildren + 3) >> 2;
+        packed->fLevel = node->fLevel;
+        groupCount += packed->fNumGroups;
+        if (!node->isLeaf()) {
+            for (int i = 0; i < node->fNumChildren; ++i) {
+                nodes.push(node->child(i)->fChild.subtree);
+            }
+        }
+    }
+
+    static const size_t kCacheLine = 64;
+    SK_COMPILE_ASSERT(sizeof(BoundsGroup) == kCacheLine, BoundsGroup_should_fill_a_cache_line);
+    void* storage = fGroupStorage.reset(groupCount * sizeof(BoundsGroup) + kCacheLine - 1);
+    fGroups = reinterpret_cast<BoundsGroup*>(
+            (reinterpret_cast<uintptr_t>(storage) + kCacheLine - 1) & ~(kCacheLine - 1));
+    fPackedChildren.setCount(4 * groupCount);
+
+    // Children of an interior node were pushed in order, so their indices count up from here.
+    int nextNode = 1;
+    for (int n = 0; n < nodes.count(); ++n) {
+        Node* node = nodes[n];
+        const PackedNode& packed = fPackedNodes[n];
+        for (int i = 0; i < 4 * packed.fNumGroups; ++i) {
+            BoundsGroup* group = &fGroups[packed.fFirstGroup + (i >> 2)];
+            PackedChild* child = &fPackedChildren[4 * packed.fFirstGroup + i];
+            if (i < node->fNumChildren) {
+                const Branch* branch = node->child(i);
+                group->fLeft  [i & 3] = branch->fBounds.fLeft;
+                group->fTop   [i & 3] = branch->fBounds.fTop;
+                group->fRight [i & 3] = branch->fBounds.fRight;
+                group->fBottom[i & 3] = branch->fBounds.fBottom;
+                if (node->isLeaf()) {
+                    child->fData = branch->fChild.data;
+                } else {
+                    child->fNode = nextNode++;
+                }
+            } else {
+                group->fLeft  [i & 3] = SK_MaxS32;
+                group->fTop   [i & 3] = SK_MaxS32;
+                group->fRight [i & 3] = SK_MinS32;
+                group->fBottom[i & 3] = SK_MinS32;
+                child->fData = NULL;
+            }
+        }
+    }
+    SkASSERT(nextNode == nodes.count());
+}
+
+void SkRTree::unpack() {
+    fPackedNodes.rewind();
+    fPackedChildren.rewind();
+    fGroupStorage.free();
+    fGroups = NULL;
+}
+
 SkRTree::Branch SkRTree::bulkLoad(SkTDArray<Branch>* branches, int level) {
     if (branches->count() == 1) {
         // Only one branch: it will be the root
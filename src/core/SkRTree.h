@@ -13,6 +13,7 @@
 #include "SkTDArray.h"
 #include "SkChunkAlloc.h"
 #include "SkBBoxHierarchy.h"
+#include "SkTemplates.h"
 
 /**
  * An R-Tree implementation. In short, it is a balanced n-ary tree containing a hierarchy of
@@ -25,11 +26,10 @@
  * something resembling an R*-tree, which attempts to minimize area and overlap during insertion,
  * and aims to minimize a combination of margin, overlap, and area when splitting.
  *
- * One detail that is thus far unimplemented that may improve tree quality is attempting to remove
- * and reinsert nodes when they become full, instead of immediately splitting (nodes that may have
- * been placed well early on may hurt the tree later when more nodes have been added; removing
- * and reinserting nodes generally helps reduce overlap and make a better tree). Deletion of nodes
- * is also unimplemented.
+ * One detail of R*-trees left out is removing and reinserting some children of a node when it
+ * becomes full, instead of immediately splitting it (nodes that were placed well early on may hurt
+ * the tree later when more nodes have been added; reinserting them can reduce overlap). With the
+ * small nodes used here it made inserts slower without making searches any faster.
  *
  * For more details see:
  *
@@ -39,6 +39,10 @@
  * It also supports bulk-loading from a batch of bounds and values; if you don't require the tree
  * to be usable in its intermediate states while it is being constructed, this is significantly
  * quicker than individual insertions and produces more consistent trees.
+ *
+ * After a bulk load the tree is also packed into a flat, breadth-first array of nodes whose child
+ * bounds are stored four to a cache line, so search() can test a query against four children at
+ * once and walks memory mostly front to back. Any later insert drops the packed copy.
  */
 class SkRTree : public SkBBoxHierarchy {
 public:
@@ -69,6 +73,19 @@ public:
      */
     virtual void insert(void* data, const SkIRect& bounds, bool defer = false) SK_OVERRIDE;
 
+    /**
+     * Remove a data value inserted with these bounds. Nodes left with too few children are
+     * dissolved and their data reinserted, as in Guttman's CondenseTree.
+     */
+    virtual bool remove(void* data, const SkIRect& bounds) SK_OVERRIDE;
+
+    /**
+     * Changes a data value's bounds in place if the new ones still fit in its leaf node's bounds,
+     * so no node needs to grow. Otherwise it is removed and reinserted.
+     */
+    virtual bool update(void* data, const SkIRect& oldBounds,
+                        const SkIRect& newBounds) SK_OVERRIDE;
+
     /**
      * If any inserts have been deferred, this will add them into the tree
      */
@@ -144,6 +161,32 @@ private:
         }
     };
 
+    /**
+     * The bounds of four consecutive children of a packed node, one cache line in all. Unused
+     * slots hold inverted bounds, which intersect nothing.
+     */
+    struct BoundsGroup {
+        int32_t fLeft[4];
+        int32_t fTop[4];
+        int32_t fRight[4];
+        int32_t fBottom[4];
+    };
+
+    /**
+     * A node of the packed tree. Its children are fGroups[fFirstGroup, fFirstGroup + fNumGroups),
+     * with four child slots in fPackedChildren for each group.
+     */
+    struct PackedNode {
+        int32_t fFirstGroup;
+        uint16_t fNumGroups;
+        uint16_t fLevel;
+    };
+
+    union PackedChild {
+        int32_t fNode;  // Index into fPackedNodes, for interior nodes.
+        void* fData;    // For leaves.
+    };
+
     struct RectLessY {
         bool operator()(const SkRTree::Branch lhs, const SkRTree::Branch rhs) {
             return ((lhs.fBounds.fBottom - lhs.fBounds.fTop) >> 1) <
@@ -159,11 +202,32 @@ private:
      */
     Branch* insert(Node* root, Branch* branch, uint16_t level = 0);
 
+    /**
+     * Recursively find and remove the leaf branch for data, fixing bounds on the way up. Children
+     * that become underfull are removed too, and their leaf branches appended to orphans.
+     */
+    bool remove(Node* root, void* data, const SkIRect& bounds, SkTDArray<Branch>* orphans);
+    void collectLeaves(Node* root, SkTDArray<Branch>* leaves);
+
+    /**
+     * Recursively find data's leaf branch and give it newBounds, if those fit in its node's
+     * bounds. Returns false if it wasn't found or didn't fit.
+     */
+    bool update(Node* root, const SkIRect& rootBounds, void* data, const SkIRect& oldBounds,
+                const SkIRect& newBounds);
+
     int chooseSubtree(Node* root, Branch* branch);
     SkIRect computeBounds(Node* n);
     int distributeChildren(Branch* children);
     void search(Node* root, const SkIRect query, SkTDArray<void*>* results) const;
 
+    /**
+     * Builds the packed copy of the tree, or drops it.
+     */
+    void pack();
+    void unpack();
+    void searchPacked(int nodeIndex, const SkIRect& query, SkTDArray<void*>* results) const;
+
     /**
      * This performs a bottom-up bulk load using the STR (sort-tile-recursive) algorithm, this
      * seems to generally produce better, more consistent trees at significantly lower cost than
@@ -193,6 +257,12 @@ private:
     SkScalar fAspectRatio;
     bool fSortWhenBulkLoading;
 
+    // The packed tree, root first; empty if there is none.
+    SkTDArray<PackedNode> fPackedNodes;
+    SkTDArray<PackedChild> fPackedChildren;
+    SkAutoMalloc fGroupStorage;
+    BoundsGroup* fGroups;  // fGroupStorage, aligned to a cache line.
+
     Node* allocateNode(uint16_t level);
 
     typedef SkBBoxHierarchy INHERITED;
@@ -12,6 +12,7 @@ SkRasterClip::SkRasterClip() {
     fIsBW = true;
     fIsEmpty = true;
     fIsRect = false;
+    fHasDeferredRect = false;
     SkDEBUGCODE(this->validate();)
 }
 
@@ -25,8 +26,11 @@ SkRasterClip::SkRasterClip(const SkRasterClip& src) {
         fAA = src.fAA;
     }
 
-    fIsEmpty = src.isEmpty();
-    fIsRect = src.isRect();
+    fIsEmpty = src.fIsEmpty;
+    fIsRect = src.fIsRect;
+    fHasDeferredRect = src.fHasDeferredRect;
+    fDeferredRect = src.fDeferredRect;
+    fDeferredBounds = src.fDeferredBounds;
     SkDEBUGCODE(this->validate();)
 }
 
@@ -34,6 +38,7 @@ SkRasterClip::SkRasterClip(const SkIRect& bounds) : fBW(bounds) {
     fIsBW = true;
     fIsEmpty = this->computeIsEmpty();  // bounds might be empty, so compute
     fIsRect = !fIsEmpty;
+    fHasDeferredRect = false;
     SkDEBUGCODE(this->validate();)
 }
 
@@ -42,10 +47,14 @@ SkRasterClip::~SkRasterClip() {
 }
 
 bool SkRasterClip::isComplex() const {
+    this->applyDeferredRect();
     return fIsBW ? fBW.isComplex() : !fAA.isEmpty();
 }
 
 const SkIRect& SkRasterClip::getBounds() const {
+    if (fHasDeferredRect) {
+        return fDeferredBounds;
+    }
     return fIsBW ? fBW.getBounds() : fAA.getBounds();
 }
 
@@ -57,6 +66,7 @@ bool SkRasterClip::setEmpty() {
     fAA.setEmpty();
     fIsEmpty = true;
     fIsRect = false;
+    fHasDeferredRect = false;
     return false;
 }
 
@@ -67,12 +77,16 @@ bool SkRasterClip::setRect(const SkIRect& rect) {
     fAA.setEmpty();
     fIsRect = fBW.setRect(rect);
     fIsEmpty = !fIsRect;
+    fHasDeferredRect = false;
     return fIsRect;
 }
 
 bool SkRasterClip::setPath(const SkPath& path, const SkRegion& clip, bool doAA) {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
+    // Whatever we held is replaced.
+    fHasDeferredRect = false;
+
     if (this->isBW() && !doAA) {
         (void)fBW.setPath(path, clip);
     } else {
@@ -95,6 +109,10 @@ bool SkRasterClip::setPath(const SkPath& path, const SkIRect& clip, bool doAA) {
 bool SkRasterClip::op(const SkIRect& rect, SkRegion::Op op) {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
+    if (SkRegion::kIntersect_Op == op && this->deferIntersect(rect)) {
+        return !fIsEmpty;
+    }
+    this->applyDeferredRect();
     fIsBW ? fBW.op(rect, op) : fAA.op(rect, op);
     return this->updateCacheAndReturnNonEmpty();
 }
@@ -102,6 +120,7 @@ bool SkRasterClip::op(const SkIRect& rect, SkRegion::Op op) {
 bool SkRasterClip::op(const SkRegion& rgn, SkRegion::Op op) {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
+    this->applyDeferredRect();
     if (fIsBW) {
         (void)fBW.op(rgn, op);
     } else {
@@ -116,8 +135,9 @@ bool SkRasterClip::op(const SkRasterClip& clip, SkRegion::Op op) {
     AUTO_RASTERCLIP_VALIDATE(*this);
     clip.validate();
 
+    this->applyDeferredRect();
     if (this->isBW() && clip.isBW()) {
-        (void)fBW.op(clip.fBW, op);
+        (void)fBW.op(clip.bwRgn(), op);
     } else {
         SkAAClip tmp;
         const SkAAClip* other;
@@ -152,7 +172,7 @@ static bool nearly_integral(SkScalar x) {
 bool SkRasterClip::op(const SkRect& r, SkRegion::Op op, bool doAA) {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
-    if (fIsBW && doAA) {
+    if (doAA) {
         // check that the rect really needs aa, or is it close enought to
         // integer boundaries that we can just treat it as a BW rect?
         if (nearly_integral(r.fLeft) && nearly_integral(r.fTop) &&
@@ -161,6 +181,15 @@ bool SkRasterClip::op(const SkRect& r, SkRegion::Op op, bool doAA) {
         }
     }
 
+    if (!doAA && SkRegion::kIntersect_Op == op) {
+        SkIRect ir;
+        r.round(&ir);
+        if (this->deferIntersect(ir)) {
+            return !fIsEmpty;
+        }
+    }
+
+    this->applyDeferredRect();
     if (fIsBW && !doAA) {
         SkIRect ir;
         r.round(&ir);
@@ -190,6 +219,7 @@ void SkRasterClip::translate(int dx, int dy, SkRasterClip* dst) const {
         return;
     }
 
+    this->applyDeferredRect();
     dst->fIsBW = fIsBW;
     if (fIsBW) {
         fBW.translate(dx, dy, &dst->fBW);
@@ -202,6 +232,9 @@ void SkRasterClip::translate(int dx, int dy, SkRasterClip* dst) const {
 }
 
 bool SkRasterClip::quickContains(const SkIRect& ir) const {
+    if (fHasDeferredRect && !fDeferredRect.contains(ir)) {
+        return false;
+    }
     return fIsBW ? fBW.quickContains(ir) : fAA.quickContains(ir);
 }
 
@@ -210,6 +243,7 @@ bool SkRasterClip::quickContains(const SkIRect& ir) const {
 const SkRegion& SkRasterClip::forceGetBW() {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
+    this->applyDeferredRect();
     if (!fIsBW) {
         fBW.setRect(fAA.getBounds());
     }
@@ -219,7 +253,7 @@ const SkRegion& SkRasterClip::forceGetBW() {
 void SkRasterClip::convertToAA() {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
-    SkASSERT(fIsBW);
+    SkASSERT(fIsBW && !fHasDeferredRect);
     fAA.setRegion(fBW);
     fIsBW = false;
     (void)this->updateCacheAndReturnNonEmpty();
@@ -237,9 +271,58 @@ void SkRasterClip::validate() const {
 
     SkASSERT(this->computeIsEmpty() == fIsEmpty);
     SkASSERT(this->computeIsRect() == fIsRect);
+
+    if (fHasDeferredRect) {
+        SkASSERT(!fIsEmpty && !fIsRect);
+        SkIRect bounds = fIsBW ? fBW.getBounds() : fAA.getBounds();
+        SkASSERT(bounds.intersect(fDeferredRect) && bounds == fDeferredBounds);
+    }
 }
 #endif
 
+/*  A stack of rect clips on top of a complex clip is common (e.g. scrolled
+    content nested inside rounded-corner clips), and each intersection would
+    rebuild the whole complex clip. Instead we collect the rects, and intersect
+    with them once, when the clip is next needed. Returns false if the rect
+    should just be applied now.
+*/
+bool SkRasterClip::deferIntersect(const SkIRect& rect) {
+    if (fIsEmpty || fIsRect) {
+        // Cheap enough to do now.
+        return false;
+    }
+
+    SkIRect bounds = this->getBounds();
+    if (!bounds.intersect(rect)) {
+        (void)this->setEmpty();
+        return true;
+    }
+    if (bounds == this->getBounds()) {
+        // The rect contains us.
+        return true;
+    }
+
+    if (fHasDeferredRect) {
+        SkAssertResult(fDeferredRect.intersect(rect));
+    } else {
+        fDeferredRect = rect;
+        fHasDeferredRect = true;
+    }
+    fDeferredBounds = bounds;
+    return true;
+}
+
+void SkRasterClip::doApplyDeferredRect() {
+    SkASSERT(fHasDeferredRect);
+    fHasDeferredRect = false;
+    if (fIsBW) {
+        (void)fBW.op(fDeferredRect, SkRegion::kIntersect_Op);
+    } else {
+        (void)fAA.op(fDeferredRect, SkRegion::kIntersect_Op);
+    }
+    (void)this->updateCacheAndReturnNonEmpty();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SkAAClipBlitterWrapper::SkAAClipBlitterWrapper() {
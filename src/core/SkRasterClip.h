@@ -11,6 +11,16 @@
 #include "SkRegion.h"
 #include "SkAAClip.h"
 
+/**
+ *  The clip of a raster canvas: either a BW region or an AA clip.
+ *
+ *  Intersecting a complex clip with an integer rect is deferred until the
+ *  clip is next looked at, so that a stack of such clips costs one
+ *  intersection rather than one per clip. Until then, getBounds() may be
+ *  larger than the clip's true bounds. The const accessors that need the
+ *  exact clip apply the pending intersection, so an SkRasterClip must not be
+ *  read from several threads at once.
+ */
 class SkRasterClip {
 public:
     SkRasterClip();
@@ -20,15 +30,25 @@ public:
 
     bool isBW() const { return fIsBW; }
     bool isAA() const { return !fIsBW; }
-    const SkRegion& bwRgn() const { SkASSERT(fIsBW); return fBW; }
-    const SkAAClip& aaRgn() const { SkASSERT(!fIsBW); return fAA; }
+    const SkRegion& bwRgn() const {
+        SkASSERT(fIsBW);
+        this->applyDeferredRect();
+        return fBW;
+    }
+    const SkAAClip& aaRgn() const {
+        SkASSERT(!fIsBW);
+        this->applyDeferredRect();
+        return fAA;
+    }
 
     bool isEmpty() const {
+        this->applyDeferredRect();
         SkASSERT(this->computeIsEmpty() == fIsEmpty);
         return fIsEmpty;
     }
 
     bool isRect() const {
+        this->applyDeferredRect();
         SkASSERT(this->computeIsRect() == fIsRect);
         return fIsRect;
     }
@@ -63,7 +83,9 @@ public:
      *  intersect, but returning true is a guarantee that they do not.
      */
     bool quickReject(const SkIRect& rect) const {
-        return this->isEmpty() || rect.isEmpty() ||
+        // fIsEmpty may be stale while an intersection is deferred, but then
+        // it is false, which is fine for a quick answer.
+        return fIsEmpty || rect.isEmpty() ||
                !SkIRect::Intersects(this->getBounds(), rect);
     }
 
@@ -83,6 +105,11 @@ private:
     // these 2 are caches based on querying the right obj based on fIsBW
     bool        fIsEmpty;
     bool        fIsRect;
+    // If set, the clip is fBW or fAA intersected with fDeferredRect, and
+    // fDeferredBounds is the intersection of their bounds.
+    bool        fHasDeferredRect;
+    SkIRect     fDeferredRect;
+    SkIRect     fDeferredBounds;
 
     bool computeIsEmpty() const {
         return fIsBW ? fBW.isEmpty() : fAA.isEmpty();
@@ -99,6 +126,14 @@ private:
     }
 
     void convertToAA();
+
+    bool deferIntersect(const SkIRect&);
+    void applyDeferredRect() const {
+        if (fHasDeferredRect) {
+            const_cast<SkRasterClip*>(this)->doApplyDeferredRect();
+        }
+    }
+    void doApplyDeferredRect();
 };
 
 class SkAutoRasterClipValidate : SkNoncopyable {
@@ -0,0 +1,561 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkRasterPipeline.h"
+#include "SkColorPriv.h"
+#include "SkHalf.h"
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace {
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+
+// Four floats in an SSE register. Comparisons return lane masks, which are only good for Select().
+class Sk4f {
+public:
+    Sk4f() {}
+    Sk4f(float v) : fVec(_mm_set1_ps(v)) {}
+    Sk4f(__m128 v) : fVec(v) {}
+
+    static Sk4f Load(const float p[4]) { return _mm_loadu_ps(p); }
+    void store(float p[4]) const { _mm_storeu_ps(p, fVec); }
+
+    Sk4f operator+(const Sk4f& o) const { return _mm_add_ps(fVec, o.fVec); }
+    Sk4f operator-(const Sk4f& o) const { return _mm_sub_ps(fVec, o.fVec); }
+    Sk4f operator*(const Sk4f& o) const { return _mm_mul_ps(fVec, o.fVec); }
+    Sk4f operator/(const Sk4f& o) const { return _mm_div_ps(fVec, o.fVec); }
+
+    Sk4f operator<=(const Sk4f& o) const { return _mm_cmple_ps(fVec, o.fVec); }
+    Sk4f operator>(const Sk4f& o) const { return _mm_cmpgt_ps(fVec, o.fVec); }
+
+    static Sk4f Min(const Sk4f& a, const Sk4f& b) { return _mm_min_ps(a.fVec, b.fVec); }
+    static Sk4f Max(const Sk4f& a, const Sk4f& b) { return _mm_max_ps(a.fVec, b.fVec); }
+
+    static Sk4f Select(const Sk4f& mask, const Sk4f& t, const Sk4f& e) {
+        return _mm_or_ps(_mm_and_ps(mask.fVec, t.fVec), _mm_andnot_ps(mask.fVec, e.fVec));
+    }
+
+    __m128 fVec;
+};
+
+#else
+
+// Four floats, in a form compilers are able to vectorize. Comparisons return 1 or 0 per lane,
+// which are only good for Select().
+class Sk4f {
+public:
+    Sk4f() {}
+    Sk4f(float v) { fVals[0] = fVals[1] = fVals[2] = fVals[3] = v; }
+
+    static Sk4f Load(const float p[4]) { Sk4f v; memcpy(v.fVals, p, sizeof(v.fVals)); return v; }
+    void store(float p[4]) const { memcpy(p, fVals, sizeof(fVals)); }
+
+#define SK4F_OP(op, expr)                                   \
+    Sk4f operator op(const Sk4f& o) const {                 \
+        Sk4f v;                                             \
+        for (int i = 0; i < 4; ++i) {                       \
+            v.fVals[i] = expr;                              \
+        }                                                   \
+        return v;                                           \
+    }
+    SK4F_OP(+, fVals[i] + o.fVals[i])
+    SK4F_OP(-, fVals[i] - o.fVals[i])
+    SK4F_OP(*, fVals[i] * o.fVals[i])
+    SK4F_OP(/, fVals[i] / o.fVals[i])
+    SK4F_OP(<=, fVals[i] <= o.fVals[i] ? 1.0f : 0.0f)
+    SK4F_OP(>, fVals[i] > o.fVals[i] ? 1.0f : 0.0f)
+#undef SK4F_OP
+
+    static Sk4f Min(const Sk4f& a, const Sk4f& b) {
+        Sk4f v;
+        for (int i = 0; i < 4; ++i) {
+            v.fVals[i] = SkTMin(a.fVals[i], b.fVals[i]);
+        }
+        return v;
+    }
+    static Sk4f Max(const Sk4f& a, const Sk4f& b) {
+        Sk4f v;
+        for (int i = 0; i < 4; ++i) {
+            v.fVals[i] = SkTMax(a.fVals[i], b.fVals[i]);
+        }
+        return v;
+    }
+
+    static Sk4f Select(const Sk4f& mask, const Sk4f& t, const Sk4f& e) {
+        Sk4f v;
+        for (int i = 0; i < 4; ++i) {
+            v.fVals[i] = mask.fVals[i] ? t.fVals[i] : e.fVals[i];
+        }
+        return v;
+    }
+
+    float fVals[4];
+};
+
+#endif
+
+}  // namespace
+
+static inline Sk4f clamp_01(const Sk4f& v) {
+    return Sk4f::Min(Sk4f::Max(v, 0.0f), 1.0f);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Converting four pixels at a time. A tail of fewer than four goes through a copy on the stack.
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+
+static inline __m128i select_epi32(__m128i mask, __m128i t, __m128i e) {
+    return _mm_or_si128(_mm_and_si128(mask, t), _mm_andnot_si128(mask, e));
+}
+
+static inline Sk4f byte_to_float(__m128i px, int shift) {
+    __m128i byte = _mm_and_si128(_mm_srli_epi32(px, shift), _mm_set1_epi32(0xFF));
+    return _mm_mul_ps(_mm_cvtepi32_ps(byte), _mm_set1_ps(1.0f / 255));
+}
+
+static inline __m128i float_to_byte(const Sk4f& v, int shift) {
+    __m128i byte = _mm_cvtps_epi32(_mm_mul_ps(clamp_01(v).fVec, _mm_set1_ps(255)));
+    return _mm_slli_epi32(byte, shift);
+}
+
+static inline void load_four_8888(const SkPMColor src[4], Sk4f* r, Sk4f* g, Sk4f* b, Sk4f* a) {
+    __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    *r = byte_to_float(px, SK_R32_SHIFT);
+    *g = byte_to_float(px, SK_G32_SHIFT);
+    *b = byte_to_float(px, SK_B32_SHIFT);
+    *a = byte_to_float(px, SK_A32_SHIFT);
+}
+
+static inline void store_four_8888(const Sk4f& r, const Sk4f& g, const Sk4f& b, const Sk4f& a,
+                                   SkPMColor dst[4]) {
+    __m128i px = _mm_or_si128(_mm_or_si128(float_to_byte(r, SK_R32_SHIFT),
+                                           float_to_byte(g, SK_G32_SHIFT)),
+                              _mm_or_si128(float_to_byte(b, SK_B32_SHIFT),
+                                           float_to_byte(a, SK_A32_SHIFT)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), px);
+}
+
+// The same bit twiddling as SkHalfToFloat(), on halves in the low 16 bits of each lane. Scaling the
+// exponent with a multiply would be shorter, but a multiply by a denormal takes a slow path.
+static inline Sk4f half_to_float(__m128i h) {
+    const __m128i kShiftedExp = _mm_set1_epi32(0x7c00 << 13);
+    __m128i bits = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+    __m128i exp = _mm_and_si128(bits, kShiftedExp);
+    bits = _mm_add_epi32(bits, _mm_set1_epi32((127 - 15) << 23));
+
+    __m128i infOrNaN = _mm_cmpeq_epi32(exp, kShiftedExp);
+    bits = _mm_add_epi32(bits, _mm_and_si128(infOrNaN, _mm_set1_epi32((128 - 16) << 23)));
+
+    __m128i denorm = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+    __m128 renormed = _mm_sub_ps(
+            _mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(1 << 23))),
+            _mm_castsi128_ps(_mm_set1_epi32(113 << 23)));
+    bits = select_epi32(denorm, _mm_castps_si128(renormed), bits);
+
+    __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+    return _mm_castsi128_ps(_mm_or_si128(bits, sign));
+}
+
+// The same bit twiddling as SkFloatToHalf(). The halves are left in the low 16 bits of each lane.
+static inline __m128i float_to_half(const Sk4f& f) {
+    const int kInfinity    = 255 << 23;
+    const int kHalfTooBig  = (127 + 16) << 23;
+    const int kDenormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+    __m128i bits = _mm_castps_si128(f.fVec);
+    __m128i sign = _mm_and_si128(bits, _mm_set1_epi32(static_cast<int>(0x80000000)));
+    bits = _mm_xor_si128(bits, sign);
+
+    // With the sign cleared, signed comparisons of the bits order the floats.
+    __m128i tooBig = _mm_cmpgt_epi32(bits, _mm_set1_epi32(kHalfTooBig - 1));
+    __m128i isNaN = _mm_cmpgt_epi32(bits, _mm_set1_epi32(kInfinity));
+    __m128i big = select_epi32(isNaN, _mm_set1_epi32(0x7e00), _mm_set1_epi32(0x7c00));
+
+    __m128i tooSmall = _mm_cmplt_epi32(bits, _mm_set1_epi32(113 << 23));
+    __m128i denorm = _mm_sub_epi32(
+            _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits),
+                                        _mm_castsi128_ps(_mm_set1_epi32(kDenormMagic)))),
+            _mm_set1_epi32(kDenormMagic));
+
+    __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+    __m128i normal = _mm_sub_epi32(bits, _mm_set1_epi32((127 - 15) << 23));
+    normal = _mm_add_epi32(normal, _mm_add_epi32(_mm_set1_epi32(0xfff), mantissaOdd));
+    normal = _mm_srli_epi32(normal, 13);
+
+    __m128i h = select_epi32(tooBig, big, select_epi32(tooSmall, denorm, normal));
+    return _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+}
+
+static inline void load_four_f16(const uint64_t src[4], Sk4f* r, Sk4f* g, Sk4f* b, Sk4f* a) {
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src) + 1);
+    __m128i t0 = _mm_unpacklo_epi16(lo, hi);    // r0 r2 g0 g2 b0 b2 a0 a2
+    __m128i t1 = _mm_unpackhi_epi16(lo, hi);    // r1 r3 g1 g3 b1 b3 a1 a3
+    __m128i rg = _mm_unpacklo_epi16(t0, t1);    // r0 r1 r2 r3 g0 g1 g2 g3
+    __m128i ba = _mm_unpackhi_epi16(t0, t1);    // b0 b1 b2 b3 a0 a1 a2 a3
+    const __m128i zero = _mm_setzero_si128();
+    *r = half_to_float(_mm_unpacklo_epi16(rg, zero));
+    *g = half_to_float(_mm_unpackhi_epi16(rg, zero));
+    *b = half_to_float(_mm_unpacklo_epi16(ba, zero));
+    *a = half_to_float(_mm_unpackhi_epi16(ba, zero));
+}
+
+// Sign extends a half, so that the signed saturating pack leaves all 16 bits alone.
+static inline __m128i packable(__m128i h) {
+    return _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+}
+
+static inline void store_four_f16(const Sk4f& r, const Sk4f& g, const Sk4f& b, const Sk4f& a,
+                                  uint64_t dst[4]) {
+    __m128i rg = _mm_packs_epi32(packable(float_to_half(r)), packable(float_to_half(g)));
+    __m128i ba = _mm_packs_epi32(packable(float_to_half(b)), packable(float_to_half(a)));
+    __m128i rb = _mm_unpacklo_epi16(rg, ba);    // r0 b0 r1 b1 r2 b2 r3 b3
+    __m128i ga = _mm_unpackhi_epi16(rg, ba);    // g0 a0 g1 a1 g2 a2 g3 a3
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(rb, ga));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst) + 1, _mm_unpackhi_epi16(rb, ga));
+}
+
+#else
+
+static inline void load_four_8888(const SkPMColor src[4], Sk4f* r, Sk4f* g, Sk4f* b, Sk4f* a) {
+    for (int i = 0; i < 4; ++i) {
+        r->fVals[i] = SkGetPackedR32(src[i]) * (1.0f / 255);
+        g->fVals[i] = SkGetPackedG32(src[i]) * (1.0f / 255);
+        b->fVals[i] = SkGetPackedB32(src[i]) * (1.0f / 255);
+        a->fVals[i] = SkGetPackedA32(src[i]) * (1.0f / 255);
+    }
+}
+
+static inline unsigned float_to_byte(float v) {
+    return static_cast<unsigned>(SkTMin(SkTMax(v, 0.0f), 1.0f) * 255 + 0.5f);
+}
+
+static inline void store_four_8888(const Sk4f& r, const Sk4f& g, const Sk4f& b, const Sk4f& a,
+                                   SkPMColor dst[4]) {
+    for (int i = 0; i < 4; ++i) {
+        dst[i] = SkPackARGB32NoCheck(float_to_byte(a.fVals[i]), float_to_byte(r.fVals[i]),
+                                     float_to_byte(g.fVals[i]), float_to_byte(b.fVals[i]));
+    }
+}
+
+static inline void load_four_f16(const uint64_t src[4], Sk4f* r, Sk4f* g, Sk4f* b, Sk4f* a) {
+    const SkHalf* h = reinterpret_cast<const SkHalf*>(src);
+    for (int i = 0; i < 4; ++i) {
+        r->fVals[i] = SkHalfToFloat(h[4 * i + 0]);
+        g->fVals[i] = SkHalfToFloat(h[4 * i + 1]);
+        b->fVals[i] = SkHalfToFloat(h[4 * i + 2]);
+        a->fVals[i] = SkHalfToFloat(h[4 * i + 3]);
+    }
+}
+
+static inline void store_four_f16(const Sk4f& r, const Sk4f& g, const Sk4f& b, const Sk4f& a,
+                                  uint64_t dst[4]) {
+    SkHalf* h = reinterpret_cast<SkHalf*>(dst);
+    for (int i = 0; i < 4; ++i) {
+        h[4 * i + 0] = SkFloatToHalf(r.fVals[i]);
+        h[4 * i + 1] = SkFloatToHalf(g.fVals[i]);
+        h[4 * i + 2] = SkFloatToHalf(b.fVals[i]);
+        h[4 * i + 3] = SkFloatToHalf(a.fVals[i]);
+    }
+}
+
+#endif
+
+// Loads four pixels, or just tail of them if it isn't zero. The conversion is a template parameter,
+// so that it is inlined.
+template <typename T, void (*loadFour)(const T[4], Sk4f*, Sk4f*, Sk4f*, Sk4f*)>
+static inline void load(const T* src, int tail, Sk4f* r, Sk4f* g, Sk4f* b, Sk4f* a) {
+    if (0 == tail) {
+        loadFour(src, r, g, b, a);
+    } else {
+        T four[4] = { 0, 0, 0, 0 };
+        memcpy(four, src, tail * sizeof(T));
+        loadFour(four, r, g, b, a);
+    }
+}
+
+template <typename T,
+          void (*storeFour)(const Sk4f&, const Sk4f&, const Sk4f&, const Sk4f&, T[4])>
+static inline void store(const Sk4f& r, const Sk4f& g, const Sk4f& b, const Sk4f& a,
+                         int tail, T* dst) {
+    if (0 == tail) {
+        storeFour(r, g, b, a, dst);
+    } else {
+        T four[4];
+        storeFour(r, g, b, a, four);
+        memcpy(dst, four, tail * sizeof(T));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The stages. x is the offset of the four pixels in the span, and tail is how many of them there
+// are, with zero meaning all four. Every stage passes everything on to the next stage.
+
+typedef SkRasterPipeline::Stage Stage;
+
+#define STAGE_PARAMS const Stage* st, int x, int tail,                          \
+                     Sk4f r, Sk4f g, Sk4f b, Sk4f a, Sk4f dr, Sk4f dg, Sk4f db, Sk4f da
+#define NEXT         next(st, x, tail, r, g, b, a, dr, dg, db, da)
+
+typedef void (*StageFn)(STAGE_PARAMS);
+
+static inline void next(STAGE_PARAMS) {
+    reinterpret_cast<StageFn>(st->fNext)(st + 1, x, tail, r, g, b, a, dr, dg, db, da);
+}
+
+template <typename T>
+static inline T* ctx_pixels(const Stage* st, int x) {
+    return *static_cast<T* const*>(st->fCtx) + x;
+}
+
+static void just_return(STAGE_PARAMS) {}
+
+static void constant_color(STAGE_PARAMS) {
+    const float* color = static_cast<const float*>(st->fCtx);
+    r = color[0];
+    g = color[1];
+    b = color[2];
+    a = color[3];
+    NEXT;
+}
+
+static void load_s_8888(STAGE_PARAMS) {
+    load<SkPMColor, load_four_8888>(ctx_pixels<const SkPMColor>(st, x), tail, &r, &g, &b, &a);
+    NEXT;
+}
+
+static void load_s_f16(STAGE_PARAMS) {
+    load<uint64_t, load_four_f16>(ctx_pixels<const uint64_t>(st, x), tail, &r, &g, &b, &a);
+    NEXT;
+}
+
+static void load_d_8888(STAGE_PARAMS) {
+    load<SkPMColor, load_four_8888>(ctx_pixels<const SkPMColor>(st, x), tail,
+                                    &dr, &dg, &db, &da);
+    NEXT;
+}
+
+static void load_d_f16(STAGE_PARAMS) {
+    load<uint64_t, load_four_f16>(ctx_pixels<const uint64_t>(st, x), tail,
+                                  &dr, &dg, &db, &da);
+    NEXT;
+}
+
+static void store_8888(STAGE_PARAMS) {
+    store<SkPMColor, store_four_8888>(r, g, b, a, tail, ctx_pixels<SkPMColor>(st, x));
+}
+
+static void store_f16(STAGE_PARAMS) {
+    store<uint64_t, store_four_f16>(r, g, b, a, tail, ctx_pixels<uint64_t>(st, x));
+}
+
+// Like SkColorMatrixFilter, this works on unpremultiplied colors, and its translation column is in
+// [0, 255].
+static void color_matrix(STAGE_PARAMS) {
+    const SkScalar* m = static_cast<const SkScalar*>(st->fCtx);
+    Sk4f invA = Sk4f::Select(a > 0.0f, Sk4f(1.0f) / a, 0.0f);
+    Sk4f ur = r * invA,
+         ug = g * invA,
+         ub = b * invA;
+    const float kTranslateScale = 1.0f / 255;
+    Sk4f nr = clamp_01(ur * m[ 0] + ug * m[ 1] + ub * m[ 2] + a * m[ 3] + m[ 4] * kTranslateScale),
+         ng = clamp_01(ur * m[ 5] + ug * m[ 6] + ub * m[ 7] + a * m[ 8] + m[ 9] * kTranslateScale),
+         nb = clamp_01(ur * m[10] + ug * m[11] + ub * m[12] + a * m[13] + m[14] * kTranslateScale),
+         na = clamp_01(ur * m[15] + ug * m[16] + ub * m[17] + a * m[18] + m[19] * kTranslateScale);
+    r = nr * na;
+    g = ng * na;
+    b = nb * na;
+    a = na;
+    NEXT;
+}
+
+static inline Sk4f lerp(const Sk4f& from, const Sk4f& to, const Sk4f& t) {
+    return from + (to - from) * t;
+}
+
+static void lerp_constant(STAGE_PARAMS) {
+    Sk4f c = *static_cast<const float*>(st->fCtx);
+    r = lerp(dr, r, c);
+    g = lerp(dg, g, c);
+    b = lerp(db, b, c);
+    a = lerp(da, a, c);
+    NEXT;
+}
+
+static void lerp_u8(STAGE_PARAMS) {
+    const uint8_t* coverage = ctx_pixels<const uint8_t>(st, x);
+    float cs[4] = { 0, 0, 0, 0 };
+    for (int i = 0, n = tail ? tail : 4; i < n; ++i) {
+        cs[i] = coverage[i] * (1.0f / 255);
+    }
+    Sk4f c = Sk4f::Load(cs);
+    r = lerp(dr, r, c);
+    g = lerp(dg, g, c);
+    b = lerp(db, b, c);
+    a = lerp(da, a, c);
+    NEXT;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Xfermodes. Each kernel works on one channel of premultiplied colors.
+
+// Porter-Duff modes treat alpha like the color channels.
+#define PORTER_DUFF_STAGE(name, expr)                                                   \
+    static inline Sk4f name##_kernel(const Sk4f& s, const Sk4f& sa,                     \
+                                     const Sk4f& d, const Sk4f& da) {                   \
+        return expr;                                                                    \
+    }                                                                                   \
+    static void name(STAGE_PARAMS) {                                                    \
+        Sk4f sa = a;                                                                    \
+        r = name##_kernel(r, sa, dr, da);                                               \
+        g = name##_kernel(g, sa, dg, da);                                               \
+        b = name##_kernel(b, sa, db, da);                                               \
+        a = name##_kernel(a, sa, da, da);                                               \
+        NEXT;                                                                           \
+    }
+
+// The other separable modes all find alpha as srcover does.
+#define SEPARABLE_STAGE(name, expr)                                                     \
+    static inline Sk4f name##_kernel(const Sk4f& s, const Sk4f& sa,                     \
+                                     const Sk4f& d, const Sk4f& da) {                   \
+        return expr;                                                                    \
+    }                                                                                   \
+    static void name(STAGE_PARAMS) {                                                    \
+        r = name##_kernel(r, a, dr, da);                                                \
+        g = name##_kernel(g, a, dg, da);                                                \
+        b = name##_kernel(b, a, db, da);                                                \
+        a = a + da - a * da;                                                            \
+        NEXT;                                                                           \
+    }
+
+static inline Sk4f inv(const Sk4f& v) { return Sk4f(1.0f) - v; }
+
+PORTER_DUFF_STAGE(clear,    Sk4f(0.0f))
+PORTER_DUFF_STAGE(src,      s)
+PORTER_DUFF_STAGE(dst,      d)
+PORTER_DUFF_STAGE(srcover,  s + d * inv(sa))
+PORTER_DUFF_STAGE(dstover,  d + s * inv(da))
+PORTER_DUFF_STAGE(srcin,    s * da)
+PORTER_DUFF_STAGE(dstin,    d * sa)
+PORTER_DUFF_STAGE(srcout,   s * inv(da))
+PORTER_DUFF_STAGE(dstout,   d * inv(sa))
+PORTER_DUFF_STAGE(srcatop,  s * da + d * inv(sa))
+PORTER_DUFF_STAGE(dstatop,  d * sa + s * inv(da))
+PORTER_DUFF_STAGE(xor_,     s * inv(da) + d * inv(sa))
+PORTER_DUFF_STAGE(plus,     Sk4f::Min(s + d, 1.0f))
+PORTER_DUFF_STAGE(modulate, s * d)
+PORTER_DUFF_STAGE(screen,   s + d - s * d)
+
+// Hard light is overlay with the source and destination swapped.
+static inline Sk4f hard_light(const Sk4f& s, const Sk4f& sa, const Sk4f& d, const Sk4f& da) {
+    return s * inv(da) + d * inv(sa) +
+           Sk4f::Select(s + s <= sa, Sk4f(2.0f) * s * d,
+                        sa * da - Sk4f(2.0f) * (da - d) * (sa - s));
+}
+
+SEPARABLE_STAGE(overlay,    hard_light(d, da, s, sa))
+SEPARABLE_STAGE(darken,     s + d - Sk4f::Max(s * da, d * sa))
+SEPARABLE_STAGE(lighten,    s + d - Sk4f::Min(s * da, d * sa))
+SEPARABLE_STAGE(hardlight,  hard_light(s, sa, d, da))
+SEPARABLE_STAGE(difference, s + d - Sk4f(2.0f) * Sk4f::Min(s * da, d * sa))
+SEPARABLE_STAGE(exclusion,  s + d - Sk4f(2.0f) * s * d)
+SEPARABLE_STAGE(multiply,   s * inv(da) + d * inv(sa) + s * d)
+
+static StageFn xfermode_stage(SkXfermode::Mode mode) {
+    switch (mode) {
+        case SkXfermode::kClear_Mode:       return clear;
+        case SkXfermode::kSrc_Mode:         return src;
+        case SkXfermode::kDst_Mode:         return dst;
+        case SkXfermode::kSrcOver_Mode:     return srcover;
+        case SkXfermode::kDstOver_Mode:     return dstover;
+        case SkXfermode::kSrcIn_Mode:       return srcin;
+        case SkXfermode::kDstIn_Mode:       return dstin;
+        case SkXfermode::kSrcOut_Mode:      return srcout;
+        case SkXfermode::kDstOut_Mode:      return dstout;
+        case SkXfermode::kSrcATop_Mode:     return srcatop;
+        case SkXfermode::kDstATop_Mode:     return dstatop;
+        case SkXfermode::kXor_Mode:         return xor_;
+        case SkXfermode::kPlus_Mode:        return plus;
+        case SkXfermode::kModulate_Mode:    return modulate;
+        case SkXfermode::kScreen_Mode:      return screen;
+        case SkXfermode::kOverlay_Mode:     return overlay;
+        case SkXfermode::kDarken_Mode:      return darken;
+        case SkXfermode::kLighten_Mode:     return lighten;
+        case SkXfermode::kHardLight_Mode:   return hardlight;
+        case SkXfermode::kDifference_Mode:  return difference;
+        case SkXfermode::kExclusion_Mode:   return exclusion;
+        case SkXfermode::kMultiply_Mode:    return multiply;
+        default:                            return NULL;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkRasterPipeline::SkRasterPipeline() : fStart(NULL) {}
+
+void SkRasterPipeline::appendFn(ErasedFn fn, const void* ctx) {
+    // The new stage is called from the one before it. It calls just_return itself, until another
+    // stage is appended after it.
+    if (fStages.empty()) {
+        fStart = fn;
+    } else {
+        fStages.back().fNext = fn;
+    }
+    Stage* stage = &fStages.push_back();
+    stage->fNext = reinterpret_cast<ErasedFn>(just_return);
+    stage->fCtx = ctx;
+}
+
+void SkRasterPipeline::append(StockStage stage, const void* ctx) {
+    static const StageFn gStockStages[] = {
+        constant_color,     // kConstantColor_StockStage
+        load_s_8888,        // kLoadS_8888_StockStage
+        load_s_f16,         // kLoadS_F16_StockStage
+        color_matrix,       // kColorMatrix_StockStage
+        load_d_8888,        // kLoadD_8888_StockStage
+        load_d_f16,         // kLoadD_F16_StockStage
+        lerp_constant,      // kLerpConstant_StockStage
+        lerp_u8,            // kLerpU8_StockStage
+        store_8888,         // kStore_8888_StockStage
+        store_f16,          // kStore_F16_StockStage
+    };
+    SkASSERT(static_cast<size_t>(stage) < SK_ARRAY_COUNT(gStockStages));
+    this->appendFn(reinterpret_cast<ErasedFn>(gStockStages[stage]), ctx);
+}
+
+bool SkRasterPipeline::SupportsXfermode(SkXfermode::Mode mode) {
+    return NULL != xfermode_stage(mode);
+}
+
+bool SkRasterPipeline::appendXfermode(SkXfermode::Mode mode) {
+    StageFn fn = xfermode_stage(mode);
+    if (NULL == fn) {
+        return false;
+    }
+    this->appendFn(reinterpret_cast<ErasedFn>(fn), NULL);
+    return true;
+}
+
+void SkRasterPipeline::run(int count) const {
+    if (fStages.empty()) {
+        return;
+    }
+    StageFn start = reinterpret_cast<StageFn>(fStart);
+    const Stage* stages = fStages.begin();
+    const Sk4f zero(0.0f);
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        start(stages, x, 0, zero, zero, zero, zero, zero, zero, zero, zero);
+    }
+    if (x < count) {
+        start(stages, x, count - x, zero, zero, zero, zero, zero, zero, zero, zero);
+    }
+}
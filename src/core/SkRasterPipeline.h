@@ -0,0 +1,91 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkRasterPipeline_DEFINED
+#define SkRasterPipeline_DEFINED
+
+#include "SkTArray.h"
+#include "SkXfermode.h"
+
+/**
+ *  SkRasterPipeline runs spans of pixels through a list of stages, such as load a shader's colors,
+ *  apply a color matrix, blend with the destination and store. Pixels are premultiplied floats,
+ *  and nothing is rounded or clamped between stages unless a stage says so.
+ *
+ *  The stages are appended once, typically when a blitter is created. Each stage then calls the
+ *  next one directly, four pixels at a time, with the source and destination colors passed along
+ *  in SIMD registers. So a span is processed in a single loop, rather than by a chain of procs
+ *  that each store their results back to memory.
+ *
+ *  Stages that read or write memory take a pointer to a pointer to the first pixel of the span.
+ *  The caller can point that at the next span between calls to run(), without rebuilding the
+ *  pipeline. 8888 pixels are SkPMColors; F16 pixels are four SkHalfs, in RGBA order.
+ */
+class SkRasterPipeline {
+public:
+    SkRasterPipeline();
+
+    enum StockStage {
+        // Set the source color.
+        kConstantColor_StockStage,      ///< ctx: const float[4], premultiplied RGBA
+        kLoadS_8888_StockStage,         ///< ctx: const SkPMColor**
+        kLoadS_F16_StockStage,          ///< ctx: const uint64_t**
+
+        // Apply a color matrix, as SkColorMatrixFilter does, to the source color. The result is
+        // clamped to [0, 1].
+        kColorMatrix_StockStage,        ///< ctx: const SkScalar[20], as from asColorMatrix()
+
+        // Set the destination color.
+        kLoadD_8888_StockStage,         ///< ctx: SkPMColor**
+        kLoadD_F16_StockStage,          ///< ctx: uint64_t**
+
+        // Blend the source color towards the destination by one minus the coverage.
+        kLerpConstant_StockStage,       ///< ctx: const float*, coverage in [0, 1]
+        kLerpU8_StockStage,             ///< ctx: const uint8_t**, coverage per pixel
+
+        // Store the source color. 8888 clamps to [0, 1]; F16 doesn't clamp.
+        kStore_8888_StockStage,         ///< ctx: SkPMColor**
+        kStore_F16_StockStage,          ///< ctx: uint64_t**
+    };
+
+    void append(StockStage, const void* ctx = NULL);
+
+    /**
+     *  Appends a stage that blends the source color with the destination color using mode, and
+     *  leaves the result in the source color. Returns false, without appending anything, if the
+     *  mode isn't supported.
+     */
+    bool appendXfermode(SkXfermode::Mode);
+
+    /**
+     *  All the Porter-Duff modes are supported, as are the separable modes except color dodge,
+     *  color burn and soft light. The non-separable modes are not.
+     */
+    static bool SupportsXfermode(SkXfermode::Mode);
+
+    /** Runs count pixels through the stages. */
+    void run(int count) const;
+
+    bool isEmpty() const { return fStages.empty(); }
+
+    typedef void (*ErasedFn)();
+
+    // Each stage is called with a pointer to its own entry, which holds its context and the
+    // function of the stage after it.
+    struct Stage {
+        ErasedFn    fNext;
+        const void* fCtx;
+    };
+
+private:
+    void appendFn(ErasedFn, const void* ctx);
+
+    SkSTArray<10, Stage, true>  fStages;
+    ErasedFn                    fStart;
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCoreBlitters.h"
+#include "SkColorFilter.h"
+#include "SkColorShader.h"
+#include "SkRasterPipeline.h"
+#include "SkTLazy.h"
+#include "SkXfermode.h"
+
+// Shades, filters and blends into an N32 device in float, through SkRasterPipeline. The shader
+// still shades into 8888, but its colors are then filtered and blended without rounding between
+// the steps, and a paint without a shader isn't rounded at all until it is stored.
+class SkRasterPipelineBlitter : public SkShaderBlitter {
+public:
+    SkRasterPipelineBlitter(const SkBitmap& device, const SkPaint& paint,
+                            SkShader::Context* shaderContext);
+    virtual ~SkRasterPipelineBlitter();
+
+    virtual void blitH(int x, int y, int width) SK_OVERRIDE;
+    virtual void blitAntiH(int x, int y, const SkAlpha[], const int16_t[]) SK_OVERRIDE;
+    virtual void blitMask(const SkMask&, const SkIRect&) SK_OVERRIDE;
+
+private:
+    // Appends stages that load and filter the source, and blend it with the destination.
+    void appendShadeAndBlend(SkRasterPipeline*) const;
+
+    void shade(int x, int y, int width);
+
+    SkRasterPipeline    fBlit;
+    SkRasterPipeline    fBlitConstantCoverage;
+    SkRasterPipeline    fBlitMaskCoverage;
+
+    SkXfermode::Mode    fMode;
+    bool                fHasColorMatrix;
+    SkScalar            fColorMatrix[20];
+    bool                fConstantColor;
+    float               fColor[4];
+    SkPMColor*          fBuffer;
+
+    // Where the pipelines read and write the current span.
+    const SkPMColor*    fSrc;
+    SkPMColor*          fDst;
+    const uint8_t*      fCoverageRow;
+    float               fCoverage;
+
+    typedef SkShaderBlitter INHERITED;
+};
+
+SkRasterPipelineBlitter::SkRasterPipelineBlitter(const SkBitmap& device, const SkPaint& paint,
+                                                 SkShader::Context* shaderContext)
+        : INHERITED(device, paint, shaderContext)
+        , fMode(SkXfermode::kSrcOver_Mode)
+        , fHasColorMatrix(false)
+        , fConstantColor(false)
+        , fBuffer(NULL)
+        , fSrc(NULL)
+        , fDst(NULL)
+        , fCoverageRow(NULL)
+        , fCoverage(0) {
+    if (paint.getXfermode()) {
+        SkAssertResult(paint.getXfermode()->asMode(&fMode));
+    }
+    if (paint.getColorFilter()) {
+        SkAssertResult(paint.getColorFilter()->asColorMatrix(fColorMatrix));
+        fHasColorMatrix = true;
+    }
+
+    // A color shader's color is used directly, rather than shaded into 8888.
+    SkColor color;
+    SkShader::GradientInfo info;
+    info.fColors = &color;
+    info.fColorOffsets = NULL;
+    info.fColorCount = 1;
+    if (SkShader::kColor_GradientType == fShader->asAGradient(&info)) {
+        float a = SkColorGetA(color) * paint.getAlpha() * (1.0f / (255 * 255));
+        fColor[0] = SkColorGetR(color) * (1.0f / 255) * a;
+        fColor[1] = SkColorGetG(color) * (1.0f / 255) * a;
+        fColor[2] = SkColorGetB(color) * (1.0f / 255) * a;
+        fColor[3] = a;
+        fConstantColor = true;
+    } else {
+        fBuffer = (SkPMColor*)sk_malloc_throw(device.width() * sizeof(SkPMColor));
+    }
+
+    // The three pipelines differ only in how coverage is applied, between blending and storing.
+    this->appendShadeAndBlend(&fBlit);
+    fBlit.append(SkRasterPipeline::kStore_8888_StockStage, &fDst);
+
+    this->appendShadeAndBlend(&fBlitConstantCoverage);
+    fBlitConstantCoverage.append(SkRasterPipeline::kLerpConstant_StockStage, &fCoverage);
+    fBlitConstantCoverage.append(SkRasterPipeline::kStore_8888_StockStage, &fDst);
+
+    this->appendShadeAndBlend(&fBlitMaskCoverage);
+    fBlitMaskCoverage.append(SkRasterPipeline::kLerpU8_StockStage, &fCoverageRow);
+    fBlitMaskCoverage.append(SkRasterPipeline::kStore_8888_StockStage, &fDst);
+}
+
+SkRasterPipelineBlitter::~SkRasterPipelineBlitter() {
+    sk_free(fBuffer);
+}
+
+void SkRasterPipelineBlitter::appendShadeAndBlend(SkRasterPipeline* pipeline) const {
+    if (fConstantColor) {
+        pipeline->append(SkRasterPipeline::kConstantColor_StockStage, fColor);
+    } else {
+        pipeline->append(SkRasterPipeline::kLoadS_8888_StockStage, &fSrc);
+    }
+    if (fHasColorMatrix) {
+        pipeline->append(SkRasterPipeline::kColorMatrix_StockStage, fColorMatrix);
+    }
+    pipeline->append(SkRasterPipeline::kLoadD_8888_StockStage, &fDst);
+    SkAssertResult(pipeline->appendXfermode(fMode));
+}
+
+void SkRasterPipelineBlitter::shade(int x, int y, int width) {
+    if (!fConstantColor) {
+        fShaderContext->shadeSpan(x, y, fBuffer, width);
+        fSrc = fBuffer;
+    }
+    fDst = fDevice.getAddr32(x, y);
+}
+
+void SkRasterPipelineBlitter::blitH(int x, int y, int width) {
+    SkASSERT(x >= 0 && y >= 0 && x + width <= fDevice.width());
+    this->shade(x, y, width);
+    fBlit.run(width);
+}
+
+void SkRasterPipelineBlitter::blitAntiH(int x, int y, const SkAlpha antialias[],
+                                        const int16_t runs[]) {
+    for (;;) {
+        int count = *runs;
+        if (count <= 0) {
+            break;
+        }
+        int aa = *antialias;
+        if (255 == aa) {
+            this->blitH(x, y, count);
+        } else if (0 != aa) {
+            this->shade(x, y, count);
+            fCoverage = aa * (1.0f / 255);
+            fBlitConstantCoverage.run(count);
+        }
+        runs += count;
+        antialias += count;
+        x += count;
+    }
+}
+
+void SkRasterPipelineBlitter::blitMask(const SkMask& mask, const SkIRect& clip) {
+    if (SkMask::kA8_Format != mask.fFormat) {
+        this->INHERITED::blitMask(mask, clip);
+        return;
+    }
+    SkASSERT(mask.fBounds.contains(clip));
+
+    const int width = clip.width();
+    for (int y = clip.fTop; y < clip.fBottom; ++y) {
+        this->shade(clip.fLeft, y, width);
+        fCoverageRow = mask.getAddr8(clip.fLeft, y);
+        fBlitMaskCoverage.run(width);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkBlitter* SkCreateRasterPipelineBlitter(const SkBitmap& device, const SkPaint& paint,
+                                         const SkMatrix& matrix,
+                                         SkTBlitterAllocator* allocator) {
+    SkASSERT(kN32_SkColorType == device.colorType());
+
+    SkXfermode::Mode mode = SkXfermode::kSrcOver_Mode;
+    if (paint.getXfermode() && !paint.getXfermode()->asMode(&mode)) {
+        return NULL;
+    }
+    if (!SkRasterPipeline::SupportsXfermode(mode)) {
+        return NULL;
+    }
+    if (paint.getColorFilter() && !paint.getColorFilter()->asColorMatrix(NULL)) {
+        return NULL;
+    }
+
+    // SkShaderBlitter wants a shader, even though a solid color is never shaded.
+    SkTCopyOnFirstWrite<SkPaint> shaderPaint(paint);
+    SkShader* shader = paint.getShader();
+    if (NULL == shader) {
+        shader = allocator->createT<SkColorShader>(paint.getColor());
+        shaderPaint.writable()->setShader(shader);
+        shaderPaint.writable()->setAlpha(0xFF);
+    }
+
+    SkShader::ContextRec rec(device, *shaderPaint, matrix);
+    void* storage = allocator->reserveT<SkShader::Context>(shader->contextSize());
+    SkShader::Context* shaderContext = shader->createContext(rec, storage);
+    if (NULL == shaderContext) {
+        allocator->freeLast();
+        return allocator->createT<SkNullBlitter>();
+    }
+    return allocator->createT<SkRasterPipelineBlitter>(device, *shaderPaint, shaderContext);
+}
@@ -56,21 +56,33 @@ static uint32_t compute_hash(const uint32_t data[], int count) {
 }
 
 struct SkScaledImageCache::Key {
+    // Pixel generation IDs, picture unique IDs and shader unique IDs are
+    // counted separately. Pre-tiled bitmaps share the pixel generation IDs,
+    // with the tile modes in place of the scale.
+    enum Domain {
+        kBitmap_Domain,
+        kPicture_Domain,
+        kShader_Domain,
+        kTiled_Domain
+    };
+
     Key(uint32_t genID,
         SkScalar scaleX,
         SkScalar scaleY,
-        SkIRect  bounds)
+        SkIRect  bounds,
+        Domain   domain = kBitmap_Domain)
         : fGenID(genID)
         , fScaleX(scaleX)
         , fScaleY(scaleY)
-        , fBounds(bounds) {
-        fHash = compute_hash(&fGenID, 7);
+        , fBounds(bounds)
+        , fDomain(domain) {
+        fHash = compute_hash(&fGenID, 8);
     }
 
     bool operator<(const Key& other) const {
         const uint32_t* a = &fGenID;
         const uint32_t* b = &other.fGenID;
-        for (int i = 0; i < 7; ++i) {
+        for (int i = 0; i < 8; ++i) {
             if (a[i] < b[i]) {
                 return true;
             }
@@ -84,7 +96,7 @@ struct SkScaledImageCache::Key {
     bool operator==(const Key& other) const {
         const uint32_t* a = &fHash;
         const uint32_t* b = &other.fHash;
-        for (int i = 0; i < 8; ++i) {
+        for (int i = 0; i < 9; ++i) {
             if (a[i] != b[i]) {
                 return false;
             }
@@ -97,6 +109,7 @@ struct SkScaledImageCache::Key {
     float       fScaleX;
     float       fScaleY;
     SkIRect     fBounds;
+    uint32_t    fDomain;
 };
 
 struct SkScaledImageCache::Rec {
@@ -105,14 +118,22 @@ struct SkScaledImageCache::Rec {
         fMip = NULL;
     }
 
+    // The mip's storage is locked as long as the rec is.
     Rec(const Key& key, const SkMipMap* mip) : fKey(key) {
         fLockCount = 1;
         fMip = mip;
         mip->ref();
+        mip->lockStorage();
     }
 
     ~Rec() {
-        SkSafeUnref(fMip);
+        if (fMip) {
+            // A rec that lost a racy insert is deleted while still locked.
+            for (int i = 0; i < fLockCount; ++i) {
+                fMip->unlockStorage();
+            }
+            fMip->unref();
+        }
     }
 
     static const Key& GetKey(const Rec& rec) { return rec.fKey; }
@@ -325,7 +346,8 @@ SkScaledImageCache::Rec* SkScaledImageCache::findAndLock(uint32_t genID,
 /**
    This private method is the fully general record finder. All other
    record finders should call this function or the one above. */
-SkScaledImageCache::Rec* SkScaledImageCache::findAndLock(const SkScaledImageCache::Key& key) {
+SkScaledImageCache::Rec* SkScaledImageCache::findAndLock(const SkScaledImageCache::Key& key,
+                                                         bool countLookup) {
     if (key.fBounds.isEmpty()) {
         return NULL;
     }
@@ -334,9 +356,19 @@ SkScaledImageCache::Rec* SkScaledImageCache::findAndLock(const SkScaledImageCach
 #else
     Rec* rec = find_rec_in_list(fHead, key);
 #endif
+    if (countLookup) {
+        if (rec) {
+            fCounters.fHits += 1;
+        } else {
+            fCounters.fMisses += 1;
+        }
+    }
     if (rec) {
         this->moveToHead(rec);  // for our LRU
         rec->fLockCount += 1;
+        if (rec->fMip) {
+            rec->fMip->lockStorage();
+        }
     }
     return rec;
 }
@@ -387,6 +419,48 @@ SkScaledImageCache::ID* SkScaledImageCache::findAndLock(const SkBitmap& orig,
     return rec_to_id(rec);
 }
 
+SkScaledImageCache::ID* SkScaledImageCache::findAndLockPicture(uint32_t pictureID,
+                                                               SkScalar scaleX,
+                                                               SkScalar scaleY,
+                                                               const SkIRect& tile,
+                                                               SkBitmap* bitmap) {
+    Rec* rec = this->findAndLock(Key(pictureID, scaleX, scaleY, tile, Key::kPicture_Domain));
+    if (rec) {
+        SkASSERT(NULL == rec->fMip);
+        SkASSERT(rec->fBitmap.pixelRef());
+        *bitmap = rec->fBitmap;
+    }
+    return rec_to_id(rec);
+}
+
+SkScaledImageCache::ID* SkScaledImageCache::findAndLockShaderTile(uint32_t shaderID,
+                                                                  const SkIRect& tile,
+                                                                  SkBitmap* bitmap) {
+    Rec* rec = this->findAndLock(Key(shaderID, SK_Scalar1, SK_Scalar1, tile,
+                                     Key::kShader_Domain));
+    if (rec) {
+        SkASSERT(NULL == rec->fMip);
+        SkASSERT(rec->fBitmap.pixelRef());
+        *bitmap = rec->fBitmap;
+    }
+    return rec_to_id(rec);
+}
+
+SkScaledImageCache::ID* SkScaledImageCache::findAndLockTiled(const SkBitmap& orig,
+                                                             SkShader::TileMode tileX,
+                                                             SkShader::TileMode tileY,
+                                                             SkBitmap* bitmap) {
+    Rec* rec = this->findAndLock(Key(orig.getGenerationID(), SkIntToScalar(tileX),
+                                     SkIntToScalar(tileY), get_bounds_from_bitmap(orig),
+                                     Key::kTiled_Domain));
+    if (rec) {
+        SkASSERT(NULL == rec->fMip);
+        SkASSERT(rec->fBitmap.pixelRef());
+        *bitmap = rec->fBitmap;
+    }
+    return rec_to_id(rec);
+}
+
 SkScaledImageCache::ID* SkScaledImageCache::findAndLockMip(const SkBitmap& orig,
                                                            SkMipMap const ** mip) {
     Rec* rec = this->findAndLock(orig.getGenerationID(), 0, 0,
@@ -407,7 +481,7 @@ SkScaledImageCache::ID* SkScaledImageCache::findAndLockMip(const SkBitmap& orig,
 SkScaledImageCache::ID* SkScaledImageCache::addAndLock(SkScaledImageCache::Rec* rec) {
     SkASSERT(rec);
     // See if we already have this key (racy inserts, etc.)
-    Rec* existing = this->findAndLock(rec->fKey);
+    Rec* existing = this->findAndLock(rec->fKey, false);
     if (NULL != existing) {
         // Since we already have a matching entry, just delete the new one and return.
         // Call sites cannot assume the passed in object will live past this call.
@@ -453,6 +527,44 @@ SkScaledImageCache::ID* SkScaledImageCache::addAndLock(const SkBitmap& orig,
     return this->addAndLock(rec);
 }
 
+SkScaledImageCache::ID* SkScaledImageCache::addAndLockPicture(uint32_t pictureID,
+                                                              SkScalar scaleX,
+                                                              SkScalar scaleY,
+                                                              const SkIRect& tile,
+                                                              const SkBitmap& bitmap) {
+    if (tile.isEmpty()) {
+        return NULL;
+    }
+    Key key(pictureID, scaleX, scaleY, tile, Key::kPicture_Domain);
+    Rec* rec = SkNEW_ARGS(Rec, (key, bitmap));
+    return this->addAndLock(rec);
+}
+
+SkScaledImageCache::ID* SkScaledImageCache::addAndLockShaderTile(uint32_t shaderID,
+                                                                 const SkIRect& tile,
+                                                                 const SkBitmap& bitmap) {
+    if (tile.isEmpty()) {
+        return NULL;
+    }
+    Key key(shaderID, SK_Scalar1, SK_Scalar1, tile, Key::kShader_Domain);
+    Rec* rec = SkNEW_ARGS(Rec, (key, bitmap));
+    return this->addAndLock(rec);
+}
+
+SkScaledImageCache::ID* SkScaledImageCache::addAndLockTiled(const SkBitmap& orig,
+                                                            SkShader::TileMode tileX,
+                                                            SkShader::TileMode tileY,
+                                                            const SkBitmap& bitmap) {
+    SkIRect bounds = get_bounds_from_bitmap(orig);
+    if (bounds.isEmpty()) {
+        return NULL;
+    }
+    Key key(orig.getGenerationID(), SkIntToScalar(tileX), SkIntToScalar(tileY), bounds,
+            Key::kTiled_Domain);
+    Rec* rec = SkNEW_ARGS(Rec, (key, bitmap));
+    return this->addAndLock(rec);
+}
+
 SkScaledImageCache::ID* SkScaledImageCache::addAndLockMip(const SkBitmap& orig,
                                                           const SkMipMap* mip) {
     SkIRect bounds = get_bounds_from_bitmap(orig);
@@ -484,6 +596,9 @@ void SkScaledImageCache::unlock(SkScaledImageCache::ID* id) {
     Rec* rec = id_to_rec(id);
     SkASSERT(rec->fLockCount > 0);
     rec->fLockCount -= 1;
+    if (rec->fMip) {
+        rec->fMip->unlockStorage();
+    }
 
     // we may have been over-budget, but now have released something, so check
     // if we should purge.
@@ -504,12 +619,23 @@ void SkScaledImageCache::purgeAsNeeded() {
         byteLimit = fByteLimit;
     }
 
+    // Purge until we are under both limits.
+    size_t bytesNeeded = fBytesUsed >= byteLimit ? fBytesUsed - byteLimit + 1 : 0;
+    int    countNeeded = fCount >= countLimit ? fCount - countLimit + 1 : 0;
+    if (bytesNeeded || countNeeded) {
+        this->purge(bytesNeeded, countNeeded);
+    }
+}
+
+void SkScaledImageCache::purge(size_t bytesNeeded, int countNeeded) {
     size_t bytesUsed = fBytesUsed;
     int    countUsed = fCount;
+    size_t bytesFreed = 0;
+    int    countFreed = 0;
 
     Rec* rec = fTail;
     while (rec) {
-        if (bytesUsed < byteLimit && countUsed < countLimit) {
+        if (bytesFreed >= bytesNeeded && countFreed >= countNeeded) {
             break;
         }
 
@@ -523,9 +649,12 @@ void SkScaledImageCache::purgeAsNeeded() {
 #endif
 
             SkDELETE(rec);
+            fCounters.fEvictions += 1;
 
             bytesUsed -= used;
             countUsed -= 1;
+            bytesFreed += used;
+            countFreed += 1;
         }
         rec = prev;
     }
@@ -664,45 +793,261 @@ void SkScaledImageCache::dump() const {
              fDiscardableFactory ? "discardable" : "malloc");
 }
 
+void SkScaledImageCache::getUsage(size_t* allocated, size_t* purgeable) const {
+    this->validate();
+
+    for (const Rec* rec = fHead; rec; rec = rec->fNext) {
+        const size_t bytes = rec->bytesUsed();
+        *allocated += bytes;
+        if (0 == rec->fLockCount) {
+            *purgeable += bytes;
+        }
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "SkLazyPtr.h"
+#include "SkMemoryDump.h"
 #include "SkThread.h"
 
-SK_DECLARE_STATIC_MUTEX(gMutex);
-static SkScaledImageCache* gScaledImageCache = NULL;
-static void cleanup_gScaledImageCache() {
-    // We'll clean this up in our own tests, but disable for clients.
-    // Chrome seems to have funky multi-process things going on in unit tests that
-    // makes this unsafe to delete when the main process atexit()s.
-    // SkLazyPtr does the same sort of thing.
-#if SK_DEVELOPER
-    SkDELETE(gScaledImageCache);
-#endif
-}
+namespace {
 
-/** Must hold gMutex when calling. */
-static SkScaledImageCache* get_cache() {
-    // gMutex is always held when this is called, so we don't need to be fancy in here.
-    gMutex.assertHeld();
-    if (NULL == gScaledImageCache) {
+/**
+ *  The global cache, split into shards by pixel generation ID. Each shard is
+ *  an SkScaledImageCache with its own mutex and LRU list, so threads working
+ *  on different images rarely contend. The shards never purge on their own
+ *  account; the byte (or, for discardable memory, count) budget is for all of
+ *  them together, and when it is exceeded we purge a share from the tail of
+ *  each shard in turn, holding one shard's mutex at a time.
+ */
+class ShardedCache : SkNoncopyable {
+public:
+    enum {
+        kShardCount = 8
+    };
+
+    ShardedCache() : fNextPurgeShard(0) {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gScaledImageCache = SkNEW_ARGS(SkScaledImageCache, (SkDiscardableMemory::Create));
+        fDiscardable = true;
+        fByteLimit = 0;
 #else
-        gScaledImageCache = SkNEW_ARGS(SkScaledImageCache, (SK_DEFAULT_IMAGE_CACHE_LIMIT));
+        fDiscardable = false;
+        fByteLimit = SK_DEFAULT_IMAGE_CACHE_LIMIT;
 #endif
-        atexit(cleanup_gScaledImageCache);
+        for (int i = 0; i < kShardCount; ++i) {
+            if (fDiscardable) {
+                fShards[i].fCache = SkNEW_ARGS(SkScaledImageCache, (SkDiscardableMemory::Create));
+            } else {
+                fShards[i].fCache = SkNEW_ARGS(SkScaledImageCache, (~(size_t)0));
+            }
+            fShards[i].fBytesUsed = 0;
+            fShards[i].fCount = 0;
+        }
     }
-    return gScaledImageCache;
-}
 
+    ~ShardedCache() {
+        for (int i = 0; i < kShardCount; ++i) {
+            SkDELETE(fShards[i].fCache);
+        }
+    }
+
+    class AutoLock : SkNoncopyable {
+    public:
+        AutoLock(ShardedCache* owner, uint32_t genID)
+            : fOwner(owner), fShard(owner->shardFor(genID)) {
+            fOwner->fShards[fShard].fMutex.acquire();
+        }
+
+        // Updates the shard's totals, and purges if we are now over budget.
+        ~AutoLock() {
+            Shard& shard = fOwner->fShards[fShard];
+            shard.update();
+            shard.fMutex.release();
+            fOwner->purgeAsNeeded();
+        }
+
+        SkScaledImageCache* cache() const { return fOwner->fShards[fShard].fCache; }
+
+    private:
+        ShardedCache*   fOwner;
+        int             fShard;
+    };
+
+    size_t getBytesUsed() const {
+        size_t bytesUsed = 0;
+        for (int i = 0; i < kShardCount; ++i) {
+            bytesUsed += sk_acquire_load(&fShards[i].fBytesUsed);
+        }
+        return bytesUsed;
+    }
+
+    int getCount() const {
+        int count = 0;
+        for (int i = 0; i < kShardCount; ++i) {
+            count += sk_acquire_load(&fShards[i].fCount);
+        }
+        return count;
+    }
+
+    size_t getByteLimit() const { return sk_acquire_load(&fByteLimit); }
+
+    size_t setByteLimit(size_t newLimit) {
+        if (fDiscardable) {
+            // discardable memory has no byte budget
+            return 0;
+        }
+        size_t prevLimit = this->getByteLimit();
+        sk_release_store(&fByteLimit, newLimit);
+        if (newLimit < prevLimit) {
+            this->purgeAsNeeded();
+        }
+        return prevLimit;
+    }
+
+    void purgeForMemoryPressure(bool critical) {
+        for (int i = 0; i < kShardCount; ++i) {
+            SkAutoMutexAcquire am(fShards[i].fMutex);
+            SkScaledImageCache* cache = fShards[i].fCache;
+            if (critical) {
+                cache->purge(cache->getBytesUsed(), cache->getCount());
+            } else {
+                cache->purge(cache->getBytesUsed() / 2, cache->getCount() / 2);
+            }
+            fShards[i].update();
+        }
+    }
+
+    // All the shards use the same kind of allocator.
+    SkBitmap::Allocator* allocator() const { return fShards[0].fCache->allocator(); }
+    SkScaledImageCache::DiscardableFactory discardableFactory() const {
+        return fShards[0].fCache->discardableFactory();
+    }
+
+    void dump() {
+        for (int i = 0; i < kShardCount; ++i) {
+            SkAutoMutexAcquire am(fShards[i].fMutex);
+            fShards[i].fCache->dump();
+        }
+    }
+
+    void getUsage(size_t* allocated, size_t* purgeable) {
+        for (int i = 0; i < kShardCount; ++i) {
+            SkAutoMutexAcquire am(fShards[i].fMutex);
+            fShards[i].fCache->getUsage(allocated, purgeable);
+        }
+    }
+
+    void getCounters(SkCacheCounters* counters) {
+        *counters = SkCacheCounters();
+        for (int i = 0; i < kShardCount; ++i) {
+            SkAutoMutexAcquire am(fShards[i].fMutex);
+            const SkCacheCounters& shard = fShards[i].fCache->counters();
+            counters->fHits += shard.fHits;
+            counters->fMisses += shard.fMisses;
+            counters->fEvictions += shard.fEvictions;
+        }
+    }
+
+private:
+    struct Shard {
+        SkMutex             fMutex;
+        SkScaledImageCache* fCache;
+        // Copies of fCache's totals, so the budget can be checked without
+        // taking every shard's mutex. Only written with fMutex held.
+        size_t              fBytesUsed;
+        int                 fCount;
+
+        void update() {
+            sk_release_store(&fBytesUsed, fCache->getBytesUsed());
+            sk_release_store(&fCount, fCache->getCount());
+        }
+    };
+
+    Shard   fShards[kShardCount];
+    bool    fDiscardable;
+    size_t  fByteLimit;
+    int32_t fNextPurgeShard;
+
+    static int shardFor(uint32_t genID) {
+        // Generation IDs are sequential; mix them so images made together
+        // spread over the shards.
+        genID ^= genID >> 16;
+        genID *= 0x85ebca6b;
+        genID ^= genID >> 13;
+        return genID % kShardCount;
+    }
+
+    // Must be called with no shard mutex held.
+    void purgeAsNeeded() {
+        size_t byteLimit;
+        int    countLimit;
+        if (fDiscardable) {
+            countLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
+            byteLimit = SK_MaxU32;  // no limit based on bytes
+        } else {
+            countLimit = SK_MaxS32; // no limit based on count
+            byteLimit = this->getByteLimit();
+        }
+
+        const size_t bytesUsed = this->getBytesUsed();
+        const int    countUsed = this->getCount();
+        // As SkScaledImageCache does, purge until we are under both limits.
+        const size_t bytesNeeded = bytesUsed >= byteLimit ? bytesUsed - byteLimit + 1 : 0;
+        const int    countNeeded = countUsed >= countLimit ? countUsed - countLimit + 1 : 0;
+        if (!bytesNeeded && !countNeeded) {
+            return;
+        }
+
+        size_t bytesFreed = 0;
+        int    countFreed = 0;
+        const int first = sk_atomic_inc(&fNextPurgeShard);
+
+        // First give each shard an equal share of what is left to free, then
+        // go round once more in case some shards were too small (or too
+        // locked) for their share.
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int i = 0; i < kShardCount; ++i) {
+                if (bytesFreed >= bytesNeeded && countFreed >= countNeeded) {
+                    return;
+                }
+                const int remaining = (0 == pass) ? kShardCount - i : 1;
+                size_t bytesShare = 0;
+                if (bytesFreed < bytesNeeded) {
+                    bytesShare = (bytesNeeded - bytesFreed + remaining - 1) / remaining;
+                }
+                int countShare = 0;
+                if (countFreed < countNeeded) {
+                    countShare = (countNeeded - countFreed + remaining - 1) / remaining;
+                }
+
+                Shard& shard = fShards[(uint32_t)(first + i) % kShardCount];
+                SkAutoMutexAcquire am(shard.fMutex);
+                const size_t bytesBefore = shard.fCache->getBytesUsed();
+                const int    countBefore = shard.fCache->getCount();
+                shard.fCache->purge(bytesShare, countShare);
+                bytesFreed += bytesBefore - shard.fCache->getBytesUsed();
+                countFreed += countBefore - shard.fCache->getCount();
+                shard.update();
+            }
+        }
+    }
+};
+
+}  // namespace
+
+static ShardedCache* get_cache() {
+    SK_DECLARE_STATIC_LAZY_PTR(ShardedCache, cache);
+    return cache.get();
+}
 
 SkScaledImageCache::ID* SkScaledImageCache::FindAndLock(
                                 uint32_t pixelGenerationID,
                                 int32_t width,
                                 int32_t height,
                                 SkBitmap* scaled) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->findAndLock(pixelGenerationID, width, height, scaled);
+    ShardedCache::AutoLock al(get_cache(), pixelGenerationID);
+    return al.cache()->findAndLock(pixelGenerationID, width, height, scaled);
 }
 
 SkScaledImageCache::ID* SkScaledImageCache::AddAndLock(
@@ -710,8 +1055,8 @@ SkScaledImageCache::ID* SkScaledImageCache::AddAndLock(
                                int32_t width,
                                int32_t height,
                                const SkBitmap& scaled) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->addAndLock(pixelGenerationID, width, height, scaled);
+    ShardedCache::AutoLock al(get_cache(), pixelGenerationID);
+    return al.cache()->addAndLock(pixelGenerationID, width, height, scaled);
 }
 
 
@@ -719,62 +1064,125 @@ SkScaledImageCache::ID* SkScaledImageCache::FindAndLock(const SkBitmap& orig,
                                                         SkScalar scaleX,
                                                         SkScalar scaleY,
                                                         SkBitmap* scaled) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->findAndLock(orig, scaleX, scaleY, scaled);
+    ShardedCache::AutoLock al(get_cache(), orig.getGenerationID());
+    return al.cache()->findAndLock(orig, scaleX, scaleY, scaled);
 }
 
 SkScaledImageCache::ID* SkScaledImageCache::FindAndLockMip(const SkBitmap& orig,
                                                        SkMipMap const ** mip) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->findAndLockMip(orig, mip);
+    ShardedCache::AutoLock al(get_cache(), orig.getGenerationID());
+    return al.cache()->findAndLockMip(orig, mip);
 }
 
 SkScaledImageCache::ID* SkScaledImageCache::AddAndLock(const SkBitmap& orig,
                                                        SkScalar scaleX,
                                                        SkScalar scaleY,
                                                        const SkBitmap& scaled) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->addAndLock(orig, scaleX, scaleY, scaled);
+    ShardedCache::AutoLock al(get_cache(), orig.getGenerationID());
+    return al.cache()->addAndLock(orig, scaleX, scaleY, scaled);
+}
+
+SkScaledImageCache::ID* SkScaledImageCache::FindAndLockPicture(uint32_t pictureID,
+                                                               SkScalar scaleX,
+                                                               SkScalar scaleY,
+                                                               const SkIRect& tile,
+                                                               SkBitmap* bitmap) {
+    ShardedCache::AutoLock al(get_cache(), pictureID);
+    return al.cache()->findAndLockPicture(pictureID, scaleX, scaleY, tile, bitmap);
+}
+
+SkScaledImageCache::ID* SkScaledImageCache::AddAndLockPicture(uint32_t pictureID,
+                                                              SkScalar scaleX,
+                                                              SkScalar scaleY,
+                                                              const SkIRect& tile,
+                                                              const SkBitmap& bitmap) {
+    ShardedCache::AutoLock al(get_cache(), pictureID);
+    return al.cache()->addAndLockPicture(pictureID, scaleX, scaleY, tile, bitmap);
+}
+
+SkScaledImageCache::ID* SkScaledImageCache::FindAndLockShaderTile(uint32_t shaderID,
+                                                                  const SkIRect& tile,
+                                                                  SkBitmap* bitmap) {
+    ShardedCache::AutoLock al(get_cache(), shaderID);
+    return al.cache()->findAndLockShaderTile(shaderID, tile, bitmap);
+}
+
+SkScaledImageCache::ID* SkScaledImageCache::AddAndLockShaderTile(uint32_t shaderID,
+                                                                 const SkIRect& tile,
+                                                                 const SkBitmap& bitmap) {
+    ShardedCache::AutoLock al(get_cache(), shaderID);
+    return al.cache()->addAndLockShaderTile(shaderID, tile, bitmap);
+}
+
+SkScaledImageCache::ID* SkScaledImageCache::FindAndLockTiled(const SkBitmap& orig,
+                                                             SkShader::TileMode tileX,
+                                                             SkShader::TileMode tileY,
+                                                             SkBitmap* bitmap) {
+    ShardedCache::AutoLock al(get_cache(), orig.getGenerationID());
+    return al.cache()->findAndLockTiled(orig, tileX, tileY, bitmap);
+}
+
+SkScaledImageCache::ID* SkScaledImageCache::AddAndLockTiled(const SkBitmap& orig,
+                                                            SkShader::TileMode tileX,
+                                                            SkShader::TileMode tileY,
+                                                            const SkBitmap& bitmap) {
+    ShardedCache::AutoLock al(get_cache(), orig.getGenerationID());
+    return al.cache()->addAndLockTiled(orig, tileX, tileY, bitmap);
 }
 
 SkScaledImageCache::ID* SkScaledImageCache::AddAndLockMip(const SkBitmap& orig,
                                                           const SkMipMap* mip) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->addAndLockMip(orig, mip);
+    ShardedCache::AutoLock al(get_cache(), orig.getGenerationID());
+    return al.cache()->addAndLockMip(orig, mip);
 }
 
 void SkScaledImageCache::Unlock(SkScaledImageCache::ID* id) {
-    SkAutoMutexAcquire am(gMutex);
-    get_cache()->unlock(id);
+    // The caller still holds the lock on the rec, so its key can't change
+    // or go away under us.
+    ShardedCache::AutoLock al(get_cache(), id_to_rec(id)->fKey.fGenID);
+    al.cache()->unlock(id);
 
 //    get_cache()->dump();
 }
 
 size_t SkScaledImageCache::GetBytesUsed() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getBytesUsed();
 }
 
 size_t SkScaledImageCache::GetByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getByteLimit();
 }
 
 size_t SkScaledImageCache::SetByteLimit(size_t newLimit) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->setByteLimit(newLimit);
 }
 
+void SkScaledImageCache::PurgeForMemoryPressure(bool critical) {
+    get_cache()->purgeForMemoryPressure(critical);
+}
+
 SkBitmap::Allocator* SkScaledImageCache::GetAllocator() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->allocator();
 }
 
+SkScaledImageCache::DiscardableFactory SkScaledImageCache::GetDiscardableFactory() {
+    return get_cache()->discardableFactory();
+}
+
 void SkScaledImageCache::Dump() {
-    SkAutoMutexAcquire am(gMutex);
     get_cache()->dump();
 }
 
+void SkScaledImageCache::DumpMemoryStatistics(SkMemoryDump* dump) {
+    size_t allocated = 0, purgeable = 0;
+    get_cache()->getUsage(&allocated, &purgeable);
+    dump->dumpCache("skia/image_cache", allocated, purgeable);
+}
+
+void SkScaledImageCache::GetCounters(SkCacheCounters* counters) {
+    get_cache()->getCounters(counters);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SkGraphics.h"
@@ -790,3 +1198,7 @@ size_t SkGraphics::GetImageCacheByteLimit() {
 size_t SkGraphics::SetImageCacheByteLimit(size_t newLimit) {
     return SkScaledImageCache::SetByteLimit(newLimit);
 }
+
+void SkGraphics::GetImageCacheCounters(SkCacheCounters* counters) {
+    SkScaledImageCache::GetCounters(counters);
+}
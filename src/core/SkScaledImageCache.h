@@ -9,8 +9,12 @@
 #define SkScaledImageCache_DEFINED
 
 #include "SkBitmap.h"
+#include "SkCacheCounters.h"
+#include "SkRect.h"
+#include "SkShader.h"
 
 class SkDiscardableMemory;
+class SkMemoryDump;
 class SkMipMap;
 
 /**
@@ -22,6 +26,9 @@ class SkMipMap;
  *
  *  As a convenience, a global instance is also defined, which can be safely
  *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  It is split into several independently locked caches by generation ID,
+ *  sharing one budget, so that threads using different images do not
+ *  serialize on a single mutex.
  */
 class SkScaledImageCache {
 public:
@@ -58,19 +65,57 @@ public:
                           SkScalar scaleY, const SkBitmap& bitmap);
     static ID* AddAndLockMip(const SkBitmap& original, const SkMipMap* mipMap);
 
+    static ID* FindAndLockPicture(uint32_t pictureID, SkScalar scaleX, SkScalar scaleY,
+                                  const SkIRect& tile, SkBitmap* returnedBitmap);
+    static ID* AddAndLockPicture(uint32_t pictureID, SkScalar scaleX, SkScalar scaleY,
+                                 const SkIRect& tile, const SkBitmap& bitmap);
+
+    static ID* FindAndLockShaderTile(uint32_t shaderID, const SkIRect& tile,
+                                     SkBitmap* returnedBitmap);
+    static ID* AddAndLockShaderTile(uint32_t shaderID, const SkIRect& tile,
+                                    const SkBitmap& bitmap);
+
+    static ID* FindAndLockTiled(const SkBitmap& original, SkShader::TileMode tileX,
+                                SkShader::TileMode tileY, SkBitmap* returnedBitmap);
+    static ID* AddAndLockTiled(const SkBitmap& original, SkShader::TileMode tileX,
+                               SkShader::TileMode tileY, const SkBitmap& bitmap);
+
     static void Unlock(ID*);
 
     static size_t GetBytesUsed();
     static size_t GetByteLimit();
     static size_t SetByteLimit(size_t newLimit);
 
+    /**
+     *  Purges the least recently used half of the unlocked entries' bytes, or
+     *  all unlocked entries if 'critical' is true.
+     */
+    static void PurgeForMemoryPressure(bool critical);
+
     static SkBitmap::Allocator* GetAllocator();
 
+    /**
+     *  Returns the factory the cache allocates its pixels with, or NULL if it
+     *  uses malloc. Mipmaps built for the cache store their levels with it.
+     */
+    static DiscardableFactory GetDiscardableFactory();
+
     /**
      *  Call SkDebugf() with diagnostic information about the state of the cache
      */
     static void Dump();
 
+    /**
+     *  Report the bytes held by the global cache, and how many of them are
+     *  unlocked, as "skia/image_cache".
+     */
+    static void DumpMemoryStatistics(SkMemoryDump*);
+
+    /**
+     *  Lookups in the global cache, and entries purged from it.
+     */
+    static void GetCounters(SkCacheCounters*);
+
     ///////////////////////////////////////////////////////////////////////////
 
     /**
@@ -122,6 +167,29 @@ public:
     ID* findAndLockMip(const SkBitmap& original,
                        SkMipMap const** returnedMipMap);
 
+    /**
+     *  Search the cache for a rasterization of the picture with the given
+     *  uniqueID, drawn scaled by (scaleX, scaleY) and covering 'tile' of the
+     *  scaled picture. Behaves like the findAndLock calls above.
+     */
+    ID* findAndLockPicture(uint32_t pictureID, SkScalar scaleX, SkScalar scaleY,
+                           const SkIRect& tile, SkBitmap* returnedBitmap);
+
+    /**
+     *  Search the cache for the pixels a shader with the given uniqueID
+     *  generated over 'tile' of its own space. Behaves like the findAndLock
+     *  calls above.
+     */
+    ID* findAndLockShaderTile(uint32_t shaderID, const SkIRect& tile, SkBitmap* returnedBitmap);
+
+    /**
+     *  Search the cache for original already repeated (or mirrored) along
+     *  each axis by a bitmap shader with the given tile modes. Behaves like
+     *  the findAndLock calls above.
+     */
+    ID* findAndLockTiled(const SkBitmap& original, SkShader::TileMode tileX,
+                         SkShader::TileMode tileY, SkBitmap* returnedBitmap);
+
     /**
      *  To add a new bitmap (or mipMap) to the cache, call
      *  AddAndLock. Use the returned ptr to unlock the cache when you
@@ -135,6 +203,11 @@ public:
     ID* addAndLock(const SkBitmap& original, SkScalar scaleX,
                    SkScalar scaleY, const SkBitmap& bitmap);
     ID* addAndLockMip(const SkBitmap& original, const SkMipMap* mipMap);
+    ID* addAndLockPicture(uint32_t pictureID, SkScalar scaleX, SkScalar scaleY,
+                          const SkIRect& tile, const SkBitmap& bitmap);
+    ID* addAndLockShaderTile(uint32_t shaderID, const SkIRect& tile, const SkBitmap& bitmap);
+    ID* addAndLockTiled(const SkBitmap& original, SkShader::TileMode tileX,
+                        SkShader::TileMode tileY, const SkBitmap& bitmap);
 
     /**
      *  Given a non-null ID ptr returned by either findAndLock or addAndLock,
@@ -146,6 +219,7 @@ public:
 
     size_t getBytesUsed() const { return fBytesUsed; }
     size_t getByteLimit() const { return fByteLimit; }
+    int getCount() const { return fCount; }
 
     /**
      *  Set the maximum number of bytes available to this cache. If the current
@@ -154,13 +228,29 @@ public:
      */
     size_t setByteLimit(size_t newLimit);
 
+    /**
+     *  Purge unlocked entries, least recently used first, until at least
+     *  bytesNeeded bytes and countNeeded entries have been freed, or there is
+     *  nothing unlocked left. This ignores the cache's own limits.
+     */
+    void purge(size_t bytesNeeded, int countNeeded);
+
     SkBitmap::Allocator* allocator() const { return fAllocator; };
+    DiscardableFactory discardableFactory() const { return fDiscardableFactory; }
 
     /**
      *  Call SkDebugf() with diagnostic information about the state of the cache
      */
     void dump() const;
 
+    /**
+     *  Add the bytes of all entries to 'allocated', and of the unlocked ones
+     *  to 'purgeable'. Unlike getBytesUsed(), this counts discardable entries.
+     */
+    void getUsage(size_t* allocated, size_t* purgeable) const;
+
+    const SkCacheCounters& counters() const { return fCounters; }
+
 public:
     struct Rec;
     struct Key;
@@ -178,10 +268,12 @@ private:
     size_t  fBytesUsed;
     size_t  fByteLimit;
     int     fCount;
+    SkCacheCounters fCounters;
 
     Rec* findAndLock(uint32_t generationID, SkScalar sx, SkScalar sy,
                      const SkIRect& bounds);
-    Rec* findAndLock(const Key& key);
+    // addAndLock() looks for an existing entry too, but that is not counted as a lookup.
+    Rec* findAndLock(const Key& key, bool countLookup = true);
     ID* addAndLock(Rec* rec);
 
     void purgeRec(Rec*);
@@ -13,6 +13,7 @@
 #include "SkDraw.h"
 #include "SkFontHost.h"
 #include "SkGlyph.h"
+#include "SkLCDFilter.h"
 #include "SkMaskFilter.h"
 #include "SkMaskGamma.h"
 #include "SkReadBuffer.h"
@@ -426,75 +427,42 @@ static void applyLUTToA8Mask(const SkMask& mask, const uint8_t* lut) {
 template<bool APPLY_PREBLEND>
 static void pack4xHToLCD16(const SkBitmap& src, const SkMask& dst,
                            const SkMaskGamma::PreBlend& maskPreBlend) {
-#define SAMPLES_PER_PIXEL 4
-#define LCD_PER_PIXEL 3
     SkASSERT(kAlpha_8_SkColorType == src.colorType());
     SkASSERT(SkMask::kLCD16_Format == dst.fFormat);
 
     const int sample_width = src.width();
     const int height = src.height();
+    // One pixel for every 4 samples, and one more on each side for the filter's spread.
+    const int width = (sample_width + 8 + 3) / 4;
+    SkASSERT(width <= dst.fBounds.width());
 
     uint16_t* dstP = (uint16_t*)dst.fImage;
     size_t dstRB = dst.fRowBytes;
-    // An N tap FIR is defined by
-    // out[n] = coeff[0]*x[n] + coeff[1]*x[n-1] + ... + coeff[N]*x[n-N]
-    // or
-    // out[n] = sum(i, 0, N, coeff[i]*x[n-i])
-
-    // The strategy is to use one FIR (different coefficients) for each of r, g, and b.
-    // This means using every 4th FIR output value of each FIR and discarding the rest.
-    // The FIRs are aligned, and the coefficients reach 5 samples to each side of their 'center'.
-    // (For r and b this is technically incorrect, but the coeffs outside round to zero anyway.)
-
-    // These are in some fixed point repesentation.
-    // Adding up to more than one simulates ink spread.
-    // For implementation reasons, these should never add up to more than two.
-
-    // Coefficients determined by a gausian where 5 samples = 3 std deviations (0x110 'contrast').
-    // Calculated using tools/generate_fir_coeff.py
-    // With this one almost no fringing is ever seen, but it is imperceptibly blurry.
-    // The lcd smoothed text is almost imperceptibly different from gray,
-    // but is still sharper on small stems and small rounded corners than gray.
-    // This also seems to be about as wide as one can get and only have a three pixel kernel.
-    // TODO: caculate these at runtime so parameters can be adjusted (esp contrast).
-    static const unsigned int coefficients[LCD_PER_PIXEL][SAMPLES_PER_PIXEL*3] = {
-        //The red subpixel is centered inside the first sample (at 1/6 pixel), and is shifted.
-        { 0x03, 0x0b, 0x1c, 0x33,  0x40, 0x39, 0x24, 0x10,  0x05, 0x01, 0x00, 0x00, },
-        //The green subpixel is centered between two samples (at 1/2 pixel), so is symetric
-        { 0x00, 0x02, 0x08, 0x16,  0x2b, 0x3d, 0x3d, 0x2b,  0x16, 0x08, 0x02, 0x00, },
-        //The blue subpixel is centered inside the last sample (at 5/6 pixel), and is shifted.
-        { 0x00, 0x00, 0x01, 0x05,  0x10, 0x24, 0x39, 0x40,  0x33, 0x1c, 0x0b, 0x03, },
-    };
 
-    for (int y = 0; y < height; ++y) {
-        const uint8_t* srcP = src.getAddr8(0, y);
-
-        // TODO: this fir filter implementation is straight forward, but slow.
-        // It should be possible to make it much faster.
-        for (int sample_x = -4, pixel_x = 0; sample_x < sample_width + 4; sample_x += 4, ++pixel_x) {
-            int fir[LCD_PER_PIXEL] = { 0 };
-            for (int sample_index = SkMax32(0, sample_x - 4), coeff_index = sample_index - (sample_x - 4)
-                ; sample_index < SkMin32(sample_x + 8, sample_width)
-                ; ++sample_index, ++coeff_index)
-            {
-                int sample_value = srcP[sample_index];
-                for (int subpxl_index = 0; subpxl_index < LCD_PER_PIXEL; ++subpxl_index) {
-                    fir[subpxl_index] += coefficients[subpxl_index][coeff_index] * sample_value;
-                }
-            }
-            for (int subpxl_index = 0; subpxl_index < LCD_PER_PIXEL; ++subpxl_index) {
-                fir[subpxl_index] /= 0x100;
-                fir[subpxl_index] = SkMin32(fir[subpxl_index], 255);
-            }
+    // Each row is copied between zeros, so the filter has no edges to check for.
+    const int paddedCount = SkLCDFilter::PaddedSampleCount(width);
+    SkAutoSTMalloc<512, uint8_t> storage(paddedCount + 3 * width);
+    uint8_t* padded = storage.get();
+    uint8_t* r = padded + paddedCount;
+    uint8_t* g = r + width;
+    uint8_t* b = g + width;
+    sk_bzero(padded, paddedCount);
 
-            U8CPU r = sk_apply_lut_if<APPLY_PREBLEND>(fir[0], maskPreBlend.fR);
-            U8CPU g = sk_apply_lut_if<APPLY_PREBLEND>(fir[1], maskPreBlend.fG);
-            U8CPU b = sk_apply_lut_if<APPLY_PREBLEND>(fir[2], maskPreBlend.fB);
+    const SkLCDFilter filter;
+    for (int y = 0; y < height; ++y) {
+        memcpy(padded + 8, src.getAddr8(0, y), sample_width);
+        filter.filterRow(padded, width, r, g, b);
+        if (APPLY_PREBLEND) {
+            SkLCDFilter::ApplyLUT(r, width, maskPreBlend.fR);
+            SkLCDFilter::ApplyLUT(g, width, maskPreBlend.fG);
+            SkLCDFilter::ApplyLUT(b, width, maskPreBlend.fB);
+        }
 #if SK_SHOW_TEXT_BLIT_COVERAGE
-            r = SkMax32(r, 10); g = SkMax32(g, 10); b = SkMax32(b, 10);
-#endif
-            dstP[pixel_x] = SkPack888ToRGB16(r, g, b);
+        for (int x = 0; x < width; ++x) {
+            r[x] = SkMax32(r[x], 10); g[x] = SkMax32(g[x], 10); b[x] = SkMax32(b[x], 10);
         }
+#endif
+        filter.packRow(r, g, b, dstP, width);
         dstP = (uint16_t*)((char*)dstP + dstRB);
     }
 }
@@ -184,6 +184,15 @@ public:
     void        getPath(const SkGlyph&, SkPath*);
     void        getFontMetrics(SkPaint::FontMetrics*);
 
+    /** Returns a new context for the same strike (desc must be the descriptor
+        this context was made from) that shares no mutable state with this one,
+        so the two may generate glyphs on different threads at once. Returns
+        NULL if the port cannot do that. The caller owns the new context.
+    */
+    virtual SkScalerContext* createIndependentContext(const SkDescriptor* desc) const {
+        return NULL;
+    }
+
     /** Return the size in bytes of the associated gamma lookup table
      */
     static size_t GetGammaLUTSize(SkScalar contrast, SkScalar paintGamma, SkScalar deviceGamma,
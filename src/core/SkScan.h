@@ -16,6 +16,7 @@ class SkRasterClip;
 class SkRegion;
 class SkBlitter;
 class SkPath;
+class SkRRect;
 
 /** Defines a fixed-point rectangle, identical to the integer SkIRect, but its
     coordinates are treated as SkFixed rather than int32_t.
@@ -36,6 +37,11 @@ public:
     static void AntiFillXRect(const SkXRect&, const SkRasterClip&, SkBlitter*);
     static void FillPath(const SkPath&, const SkRasterClip&, SkBlitter*);
     static void AntiFillPath(const SkPath&, const SkRasterClip&, SkBlitter*);
+    /** Returns true if AntiFillRRect can draw the rrect: an oval or a simple
+        rrect, with radii of at least half a pixel.
+     */
+    static bool CanAntiFillRRect(const SkRRect&);
+    static void AntiFillRRect(const SkRRect&, const SkRasterClip&, SkBlitter*);
     static void FrameRect(const SkRect&, const SkPoint& strokeSize,
                           const SkRasterClip&, SkBlitter*);
     static void AntiFrameRect(const SkRect&, const SkPoint& strokeSize,
@@ -49,6 +55,18 @@ public:
     static void AntiHairRect(const SkRect&, const SkRasterClip&, SkBlitter*);
     static void HairPath(const SkPath&, const SkRasterClip&, SkBlitter*);
     static void AntiHairPath(const SkPath&, const SkRasterClip&, SkBlitter*);
+    /** Draw count/2 separate hairlines, pts[0] to pts[1], pts[2] to pts[3], ...,
+        deciding how to clip them just once.
+     */
+    static void HairLines(const SkPoint pts[], int count, const SkRasterClip&, SkBlitter*);
+    static void AntiHairLines(const SkPoint pts[], int count, const SkRasterClip&,
+                              SkBlitter*);
+    /** Draw the count-1 connected hairlines pts[0] to pts[1], pts[1] to pts[2], ...,
+        deciding how to clip them just once.
+     */
+    static void HairPolyline(const SkPoint pts[], int count, const SkRasterClip&, SkBlitter*);
+    static void AntiHairPolyline(const SkPoint pts[], int count, const SkRasterClip&,
+                                 SkBlitter*);
 
 private:
     friend class SkAAClip;
@@ -62,6 +80,7 @@ private:
     static void FillPath(const SkPath&, const SkRegion& clip, SkBlitter*);
     static void AntiFillPath(const SkPath&, const SkRegion& clip, SkBlitter*,
                              bool forceRLE = false);
+    static void AntiFillRRect(const SkRRect&, const SkRegion* clip, SkBlitter*);
     static void FillTriangle(const SkPoint pts[], const SkRegion*, SkBlitter*);
 
     static void AntiFrameRect(const SkRect&, const SkPoint& strokeSize,
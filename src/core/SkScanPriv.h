@@ -33,6 +33,11 @@ void sk_fill_path(const SkPath& path, const SkIRect* clipRect,
                   SkBlitter* blitter, int start_y, int stop_y, int shiftEdgesUp,
                   const SkRegion& clipRgn);
 
+// Antialias the path by computing the exact area of each pixel it covers, for
+// the pixels in bounds. bounds must already be clipped, and blitter wrapped,
+// so that everything in bounds may be blitted. See SkScan_AnalyticPath.cpp.
+void sk_fill_path_analytic(const SkPath& path, const SkIRect& bounds, SkBlitter* blitter);
+
 // blit the rects above and below avoid, clipped to clip
 void sk_blit_above(SkBlitter*, const SkIRect& avoid, const SkRegion& clip);
 void sk_blit_below(SkBlitter*, const SkIRect& avoid, const SkRegion& clip);
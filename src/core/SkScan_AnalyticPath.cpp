@@ -0,0 +1,348 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkScanPriv.h"
+#include "SkBlitter.h"
+#include "SkEdgeBuilder.h"
+#include "SkGeometry.h"
+#include "SkLineClipper.h"
+#include "SkPath.h"
+#include "SkTDArray.h"
+#include "SkTSort.h"
+#include "SkTemplates.h"
+
+/** @file
+    Antialiased path filling by exact area coverage.
+
+    The path is flattened into lines, which are clipped to the bounds being
+    scanned (anything left or right of the bounds becomes a vertical line on
+    that side, see SkLineClipper). Then, one pixel row at a time, every line
+    crossing the row deposits into an accumulation buffer
+    - the signed area it covers in each pixel it passes through, and
+    - the remainder of its signed height in the pixel just to its right,
+    so that a running sum along the row yields the winding-weighted area of
+    each pixel that lies inside the path. That sum is the exact coverage
+    wherever edges of the same sub-path do not overlap within a pixel; where
+    they do it is clamped (winding fill) or folded (even-odd fill).
+
+    Unlike the supersampler in SkScan_AntiPath.cpp, this visits each pixel row
+    once, however fine the coverage.
+ */
+
+namespace {
+
+// A line, oriented so that it runs down: fY0 < fY1.
+struct Line {
+    SkScalar fX0;
+    SkScalar fY0;
+    SkScalar fY1;
+    SkScalar fDXDY;
+    SkScalar fWinding;  // +1 if the path runs down along this line, -1 if up.
+
+    bool operator<(const Line& other) const { return fY0 < other.fY0; }
+};
+
+// Maximum distance, in pixels, between a curve and the lines we replace it with.
+static const SkScalar kFlattenTolerance = SK_Scalar1 / 8;
+// Only curves thousands of pixels across need this many.
+static const int kMaxCurveSegments = 1024;
+
+class LineBuilder {
+public:
+    // clip is in device space; the lines come out relative to its left edge.
+    explicit LineBuilder(const SkRect& clip) : fClip(clip) {}
+
+    void addLine(const SkPoint pts[2]) {
+        SkPoint lines[SkLineClipper::kMaxPoints];
+        int count = SkLineClipper::ClipLine(pts, fClip, lines);
+        for (int i = 0; i < count; ++i) {
+            this->addClippedLine(lines[i], lines[i + 1]);
+        }
+    }
+
+    void addQuad(const SkPoint pts[3]) {
+        if (this->addOffscreenCurve(pts, 3)) {
+            return;
+        }
+        SkPoint line[kMaxCurveSegments + 1];
+        int n = SkQuadSubdivisionCount(pts, kFlattenTolerance, kMaxCurveSegments);
+        line[0] = pts[0];
+        SkEvalQuadUniform(pts, n, line + 1);
+        this->addPolyline(line, n);
+    }
+
+    void addCubic(const SkPoint pts[4]) {
+        if (this->addOffscreenCurve(pts, 4)) {
+            return;
+        }
+        SkPoint line[kMaxCurveSegments + 1];
+        int n = SkCubicSubdivisionCount(pts, kFlattenTolerance, kMaxCurveSegments);
+        line[0] = pts[0];
+        SkEvalCubicUniform(pts, n, line + 1);
+        this->addPolyline(line, n);
+    }
+
+    const SkRect& clip() const { return fClip; }
+    SkTDArray<Line>& lines() { return fLines; }
+
+private:
+    // A curve wholly above or below the clip covers nothing in it, and one
+    // wholly left or right of it adds what the line between its ends does.
+    // Neither needs flattening; returns true if the curve was one of them.
+    bool addOffscreenCurve(const SkPoint pts[], int count) {
+        SkRect bounds;
+        bounds.set(pts, count);
+        if (bounds.fBottom <= fClip.fTop || bounds.fTop >= fClip.fBottom) {
+            return true;
+        }
+        if (bounds.fRight <= fClip.fLeft || bounds.fLeft >= fClip.fRight) {
+            const SkPoint ends[2] = { pts[0], pts[count - 1] };
+            this->addLine(ends);
+            return true;
+        }
+        return false;
+    }
+
+    void addPolyline(const SkPoint pts[], int lineCount) {
+        for (int i = 0; i < lineCount; ++i) {
+            this->addLine(&pts[i]);
+        }
+    }
+
+    void addClippedLine(const SkPoint& p0, const SkPoint& p1) {
+        if (p0.fY == p1.fY) {
+            return;  // Horizontal lines cover nothing.
+        }
+        const SkPoint& top = p0.fY < p1.fY ? p0 : p1;
+        const SkPoint& bottom = p0.fY < p1.fY ? p1 : p0;
+
+        Line* line = fLines.append();
+        line->fX0 = top.fX - fClip.fLeft;
+        line->fY0 = top.fY;
+        line->fY1 = bottom.fY;
+        line->fDXDY = (bottom.fX - top.fX) / (bottom.fY - top.fY);
+        line->fWinding = p0.fY < p1.fY ? SK_Scalar1 : -SK_Scalar1;
+    }
+
+    const SkRect    fClip;
+    SkTDArray<Line> fLines;
+};
+
+static void build_lines(const SkPath& path, LineBuilder* builder) {
+    SkTDArray<bool> visible;
+    SkEdgeBuilder::FindVisibleContours(path, builder->clip(), &visible);
+    int contour = -1;
+    bool skipContour = false;
+
+    SkPath::Iter iter(path, true);
+    SkPoint pts[4];
+    SkPath::Verb verb;
+    while ((verb = iter.next(pts, false)) != SkPath::kDone_Verb) {
+        if (SkPath::kMove_Verb == verb) {
+            SkASSERT(contour + 1 < visible.count());
+            skipContour = !visible[++contour];
+        }
+        if (skipContour) {
+            continue;
+        }
+        switch (verb) {
+            case SkPath::kLine_Verb:
+                builder->addLine(pts);
+                break;
+            case SkPath::kQuad_Verb:
+                builder->addQuad(pts);
+                break;
+            case SkPath::kConic_Verb: {
+                SkAutoConicToQuads converter;
+                const SkPoint* quadPts = converter.computeQuads(pts, iter.conicWeight(),
+                                                                kFlattenTolerance);
+                for (int i = 0; i < converter.countQuads(); ++i) {
+                    builder->addQuad(&quadPts[2 * i]);
+                }
+                break;
+            }
+            case SkPath::kCubic_Verb:
+                builder->addCubic(pts);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/*  Add the coverage of the part of line between y = top and y = bottom, which
+    must lie within one pixel row, to acc[]. acc[] is one row of the scanned
+    bounds, plus two entries so that lines at the right edge need no special
+    casing. Grows [*minX, *maxX) to include every entry written.
+ */
+static void accumulate_line(const Line& line, SkScalar top, SkScalar bottom, SkScalar width,
+                            SkScalar acc[], int* minX, int* maxX) {
+    top = SkMaxScalar(top, line.fY0);
+    bottom = SkMinScalar(bottom, line.fY1);
+    if (bottom <= top) {
+        return;
+    }
+    SkScalar xa = line.fX0 + (top - line.fY0) * line.fDXDY;
+    SkScalar xb = line.fX0 + (bottom - line.fY0) * line.fDXDY;
+    // Evaluating at the row boundaries can step a hair outside the clip.
+    SkScalar x0 = SkScalarPin(SkMinScalar(xa, xb), 0, width);
+    SkScalar x1 = SkScalarPin(SkMaxScalar(xa, xb), 0, width);
+    SkScalar d = (bottom - top) * line.fWinding;
+
+    SkScalar x0floor = SkScalarFloorToScalar(x0);
+    SkScalar x1ceil = SkScalarCeilToScalar(x1);
+    int x0i = (int)x0floor;
+    int x1i = (int)x1ceil;
+
+    if (x1i <= x0i + 1) {
+        // The line stays within one pixel: it covers the area to the right of
+        // its midpoint, and the rest of its height spills into the next pixel.
+        SkScalar xmf = SkScalarHalf(x0 + x1) - x0floor;
+        acc[x0i] += d - d * xmf;
+        acc[x0i + 1] += d * xmf;
+        *minX = SkMin32(*minX, x0i);
+        *maxX = SkMax32(*maxX, x0i + 2);
+        return;
+    }
+
+    // The line crosses several pixels. s is the change in its height per pixel.
+    SkScalar s = SkScalarInvert(x1 - x0);
+    SkScalar x0f = x0 - x0floor;
+    SkScalar a0 = SkScalarHalf(s) * (1 - x0f) * (1 - x0f);     // triangle in the first pixel
+    SkScalar x1f = x1 - x1ceil + 1;
+    SkScalar am = SkScalarHalf(s) * x1f * x1f;                // triangle in the last pixel
+    acc[x0i] += d * a0;
+    if (x1i == x0i + 2) {
+        acc[x0i + 1] += d * (1 - a0 - am);
+    } else {
+        SkScalar a1 = s * (1.5f - x0f);
+        acc[x0i + 1] += d * (a1 - a0);
+        SkScalar ds = d * s;
+        for (int x = x0i + 2; x < x1i - 1; ++x) {
+            acc[x] += ds;
+        }
+        SkScalar a2 = a1 + (x1i - x0i - 3) * s;
+        acc[x1i - 1] += d * (1 - a2 - am);
+    }
+    acc[x1i] += d * am;
+    *minX = SkMin32(*minX, x0i);
+    *maxX = SkMax32(*maxX, x1i + 1);
+}
+
+static inline U8CPU coverage_to_alpha(SkScalar winding, bool evenOdd, bool inverse) {
+    SkScalar coverage = SkScalarAbs(winding);
+    if (evenOdd) {
+        coverage -= 2 * SkScalarFloorToScalar(SkScalarHalf(coverage));
+        if (coverage > 1) {
+            coverage = 2 - coverage;
+        }
+    } else if (coverage > 1) {
+        coverage = 1;
+    }
+    if (inverse) {
+        coverage = 1 - coverage;
+    }
+    return (int)(coverage * 255 + SK_ScalarHalf);
+}
+
+}  // namespace
+
+void sk_fill_path_analytic(const SkPath& path, const SkIRect& bounds, SkBlitter* blitter) {
+    SkASSERT(!bounds.isEmpty());
+    SkASSERT(bounds.width() <= 32767);  // the runs[] uses int16_t
+
+    const bool inverse = path.isInverseFillType();
+    const bool evenOdd = SkPath::kEvenOdd_FillType == path.getFillType() ||
+                         SkPath::kInverseEvenOdd_FillType == path.getFillType();
+
+    LineBuilder builder(SkRect::Make(bounds));
+    build_lines(path, &builder);
+    SkTDArray<Line>& lines = builder.lines();
+    if (lines.isEmpty() && !inverse) {
+        return;
+    }
+    if (lines.count() > 1) {
+        SkTQSort(lines.begin(), lines.end() - 1);
+    }
+
+    const int width = bounds.width();
+    const SkScalar scalarWidth = SkIntToScalar(width);
+    SkAutoSTMalloc<256, SkScalar> acc(width + 2);
+    SkAutoSTMalloc<256, int16_t>  runs(width + 1);
+    SkAutoSTMalloc<256, SkAlpha>  alpha(width + 1);
+    sk_bzero(acc.get(), (width + 2) * sizeof(SkScalar));
+
+    SkTDArray<const Line*> active;
+    int nextLine = 0;
+    for (int y = bounds.fTop; y < bounds.fBottom; ++y) {
+        const SkScalar top = SkIntToScalar(y);
+        const SkScalar bottom = top + 1;
+
+        // Retire the lines that ended above this row, and pick up those starting in it.
+        int keep = 0;
+        for (int i = 0; i < active.count(); ++i) {
+            if (active[i]->fY1 > top) {
+                active[keep++] = active[i];
+            }
+        }
+        active.setCount(keep);
+        while (nextLine < lines.count() && lines[nextLine].fY0 < bottom) {
+            *active.append() = &lines[nextLine++];
+        }
+
+        if (active.isEmpty()) {
+            if (inverse) {
+                blitter->blitH(bounds.fLeft, y, width);
+            } else if (nextLine < lines.count()) {
+                // Skip ahead to the row where the next line starts.
+                y = SkTMax(y, SkScalarFloorToInt(lines[nextLine].fY0) - 1);
+            } else {
+                break;
+            }
+            continue;
+        }
+
+        int minX = width + 2;
+        int maxX = 0;
+        for (int i = 0; i < active.count(); ++i) {
+            accumulate_line(*active[i], top, bottom, scalarWidth, acc.get(), &minX, &maxX);
+        }
+        if (maxX <= minX) {
+            // Every active line ended at or above this row.
+            if (inverse) {
+                blitter->blitH(bounds.fLeft, y, width);
+            }
+            continue;
+        }
+
+        // Left of minX nothing is covered; right of maxX the winding stays constant.
+        const int start = inverse ? 0 : minX;
+        const int stop = inverse ? width : SkMin32(maxX, width);
+        SkScalar winding = 0;
+        for (int x = start; x < stop; ++x) {
+            winding += acc[x];
+            alpha[x - start] = coverage_to_alpha(winding, evenOdd, inverse);
+        }
+        sk_bzero(&acc[minX], (maxX - minX) * sizeof(SkScalar));
+
+        // Run-length encode alpha[] in place for blitAntiH.
+        const int count = stop - start;
+        if (count <= 0) {
+            continue;
+        }
+        for (int i = 0; i < count;) {
+            int j = i + 1;
+            while (j < count && alpha[j] == alpha[i]) {
+                ++j;
+            }
+            runs[i] = SkToS16(j - i);
+            i = j;
+        }
+        runs[count] = 0;
+        blitter->blitAntiH(bounds.fLeft + start, y, alpha.get(), runs.get());
+    }
+}
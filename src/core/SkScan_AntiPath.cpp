@@ -33,11 +33,16 @@
     Enabling SK_USE_LEGACY_AA_COVERAGE keeps the aa coverage calculations as
     they were before the fix that unified the output of the RLE and MASK
     supersamplers.
+
+    AntiFillPath no longer supersamples: it computes exact coverage with
+    sk_fill_path_analytic() (SkScan_AnalyticPath.cpp) instead. Enabling
+    SK_SUPPORT_LEGACY_SUPERSAMPLED_AA goes back to the supersamplers.
  */
 
 //#define FORCE_SUPERMASK
 //#define FORCE_RLE
 //#define SK_USE_LEGACY_AA_COVERAGE
+//#define SK_SUPPORT_LEGACY_SUPERSAMPLED_AA
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -674,6 +679,18 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
         sk_blit_above(blitter, ir, *clipRgn);
     }
 
+#ifndef SK_SUPPORT_LEGACY_SUPERSAMPLED_AA
+    // An inverse fill covers the full width of the clip in the rows of the path.
+    SkIRect aaBounds = ir;
+    if (path.isInverseFillType()) {
+        aaBounds.fLeft = clipRgn->getBounds().fLeft;
+        aaBounds.fRight = clipRgn->getBounds().fRight;
+    }
+    if (aaBounds.intersect(clipRgn->getBounds())) {
+        sk_fill_path_analytic(path, aaBounds, blitter);
+    }
+    (void)forceRLE;
+#else
     SkIRect superRect, *superClipRect = NULL;
 
     if (clipRect) {
@@ -694,6 +711,7 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
         SuperBlitter    superBlit(blitter, ir, *clipRgn);
         sk_fill_path(path, superClipRect, &superBlit, ir.fTop, ir.fBottom, SHIFT, *clipRgn);
     }
+#endif
 
     if (path.isInverseFillType()) {
         sk_blit_below(blitter, ir, *clipRgn);
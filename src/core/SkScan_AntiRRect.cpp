@@ -0,0 +1,288 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkScanPriv.h"
+#include "SkBlitter.h"
+#include "SkRasterClip.h"
+#include "SkRRect.h"
+#include "SkTemplates.h"
+
+/** @file
+    Antialiased filling of ovals and simple rrects from their implicit function.
+
+    Each pixel's coverage is its overlap with the bounding rect, reduced in the
+    corners by the signed distance d from the pixel center to the corner's
+    ellipse: exact for circles, and the first order estimate f / |grad f| for
+    ellipses, as GrOvalRenderer and GrRRectEffect compute on the GPU. Rather
+    than the GPU's 0.5 - d ramp, the pixel's area inside the tangent line at
+    that distance is used, which keeps diagonal edges as smooth as the path
+    rasterizer draws them.
+
+    Along a row, coverage only grows from either end of the shape towards its
+    middle, so each row is walked in from both ends until it reaches the row's
+    full coverage, and everything in between is a single run.
+ */
+
+namespace {
+
+class RRectCoverage {
+public:
+    explicit RRectCoverage(const SkRRect& rrect) {
+        const SkRect& r = rrect.rect();
+        const SkVector& radii = rrect.getSimpleRadii();
+        fL = r.fLeft;
+        fT = r.fTop;
+        fR = r.fRight;
+        fB = r.fBottom;
+        fRX = radii.fX;
+        fRY = radii.fY;
+        fCL = fL + fRX;
+        fCT = fT + fRY;
+        fCR = fR - fRX;
+        fCB = fB - fRY;
+        fCircle = fRX == fRY;
+        fInvRX2 = SkScalarInvert(fRX * fRX);
+        fInvRY2 = SkScalarInvert(fRY * fRY);
+    }
+
+    // Sets up row y, returning its coverage where it is not cut by a side or corner.
+    SkScalar setRow(int y) {
+        const SkScalar top = SkIntToScalar(y);
+        const SkScalar cy = top + SK_ScalarHalf;
+        fRowCoverage = SkTMin(top + 1, fB) - SkTMax(top, fT);
+        if (cy < fCT) {
+            fDY = cy - fCT;
+        } else if (cy > fCB) {
+            fDY = cy - fCB;
+        } else {
+            fDY = 0;
+        }
+        return fRowCoverage;
+    }
+
+    // Returns the x range [*left, *right) of row pixels that may have any coverage.
+    void rowExtent(int y, int* left, int* right) const {
+        if (0 == fDY) {
+            *left = SkScalarFloorToInt(fL);
+            *right = SkScalarCeilToInt(fR);
+            return;
+        }
+        // The row is widest at its edge nearest the corner centers. Outset the
+        // ellipse by a pixel to contain the whole antialiasing ramp.
+        const SkScalar a = fRX + 1;
+        const SkScalar b = fRY + 1;
+        const SkScalar dy = SkTMax(SkScalarAbs(fDY) - SK_ScalarHalf, 0.0f) / b;
+        const SkScalar halfWidth = dy < 1 ? a * SkScalarSqrt(1 - dy * dy) : 0;
+        *left = SkScalarFloorToInt(fCL - halfWidth);
+        *right = SkScalarCeilToInt(fCR + halfWidth);
+    }
+
+    U8CPU alpha(int x) const {
+        const SkScalar left = SkIntToScalar(x);
+        const SkScalar cx = left + SK_ScalarHalf;
+        SkScalar coverage = (SkTMin(left + 1, fR) - SkTMax(left, fL)) * fRowCoverage;
+        if (0 != fDY && (cx < fCL || cx > fCR)) {
+            coverage = SkTMin(coverage, this->cornerCoverage(cx < fCL ? cx - fCL : cx - fCR));
+        }
+        return coverage_to_alpha(coverage);
+    }
+
+    static U8CPU coverage_to_alpha(SkScalar coverage) {
+        if (coverage <= 0) {
+            return 0;
+        }
+        if (coverage >= 1) {
+            return 0xFF;
+        }
+        return (int)(coverage * 255 + SK_ScalarHalf);
+    }
+
+private:
+    SkScalar cornerCoverage(SkScalar dx) const {
+        SkScalar d, nx, ny;
+        if (fCircle) {
+            const SkScalar len = SkScalarSqrt(dx * dx + fDY * fDY);
+            if (0 == len) {
+                return SK_Scalar1;  // At the center.
+            }
+            d = len - fRX;
+            nx = dx / len;
+            ny = fDY / len;
+        } else {
+            // f(x, y) = x^2/a^2 + y^2/b^2 - 1, and grad f is twice g.
+            const SkScalar f = dx * dx * fInvRX2 + fDY * fDY * fInvRY2 - 1;
+            const SkScalar gx = dx * fInvRX2;
+            const SkScalar gy = fDY * fInvRY2;
+            const SkScalar len = SkScalarSqrt(gx * gx + gy * gy);
+            if (0 == len) {
+                return SK_Scalar1;
+            }
+            d = f / (2 * len);
+            nx = gx / len;
+            ny = gy / len;
+        }
+        return edge_coverage(d, nx, ny);
+    }
+
+    // Returns the area of the pixel inside an edge at signed distance d from
+    // its center, with unit normal (nx, ny). Where the edge is axis aligned
+    // this is 0.5 - d, as on the GPU; at other angles the corners of the pixel
+    // cross the edge one after the other.
+    static SkScalar edge_coverage(SkScalar d, SkScalar nx, SkScalar ny) {
+        SkScalar a = SkScalarAbs(nx);
+        SkScalar b = SkScalarAbs(ny);
+        if (a < b) {
+            SkTSwap(a, b);
+        }
+        const SkScalar outer = SkScalarHalf(a + b);
+        const SkScalar inner = SkScalarHalf(a - b);
+        if (d >= outer) {
+            return 0;
+        }
+        if (d <= -outer) {
+            return SK_Scalar1;
+        }
+        if (SkScalarAbs(d) <= inner) {
+            return SK_ScalarHalf - d / a;
+        }
+        const SkScalar t = outer - SkScalarAbs(d);
+        const SkScalar corner = t * t / (2 * a * b);
+        return d > 0 ? corner : SK_Scalar1 - corner;
+    }
+
+    SkScalar fL, fT, fR, fB;
+    SkScalar fRX, fRY;
+    SkScalar fCL, fCT, fCR, fCB;    // corner ellipse centers
+    SkScalar fInvRX2, fInvRY2;
+    SkScalar fRowCoverage;
+    SkScalar fDY;                   // row center's offset from the corner centers, or 0
+    bool     fCircle;
+};
+
+}  // namespace
+
+// bounds must already be clipped, and blitter wrapped, so that everything in
+// bounds may be blitted.
+static void fill_rrect(const SkRRect& rrect, const SkIRect& bounds, SkBlitter* blitter) {
+    SkASSERT(bounds.width() <= 32767);  // the runs[] uses int16_t
+
+    RRectCoverage coverage(rrect);
+    const int width = bounds.width();
+    SkAutoSTMalloc<256, int16_t> runs(width + 1);
+    SkAutoSTMalloc<256, SkAlpha> alpha(width + 1);
+
+    for (int y = bounds.fTop; y < bounds.fBottom; ++y) {
+        const U8CPU rowAlpha = RRectCoverage::coverage_to_alpha(coverage.setRow(y));
+        if (0 == rowAlpha) {
+            continue;
+        }
+        int left, right;
+        coverage.rowExtent(y, &left, &right);
+        left = SkMax32(left, bounds.fLeft);
+        right = SkMin32(right, bounds.fRight);
+        if (left >= right) {
+            continue;
+        }
+
+        // Walk in from the left until a pixel gets the full coverage of the row...
+        int x = left;
+        for (; x < right; ++x) {
+            U8CPU a = coverage.alpha(x);
+            alpha[x - bounds.fLeft] = a;
+            if (a == rowAlpha) {
+                break;
+            }
+        }
+        const int middle = x;
+        // ...and in from the right, to the same.
+        for (x = right - 1; x > middle; --x) {
+            U8CPU a = coverage.alpha(x);
+            alpha[x - bounds.fLeft] = a;
+            if (a == rowAlpha) {
+                break;
+            }
+        }
+        const int middleEnd = x + 1;
+
+        // Trim off the uncovered pixels at either end.
+        while (left < right && 0 == alpha[left - bounds.fLeft]) {
+            ++left;
+        }
+        while (right > left && 0 == alpha[right - 1 - bounds.fLeft]) {
+            --right;
+        }
+        if (left >= right) {
+            continue;
+        }
+
+        // One run per pixel at either end, and a single run in the middle.
+        SkAlpha* aa = alpha.get() + (left - bounds.fLeft);
+        int16_t* rr = runs.get() + (left - bounds.fLeft);
+        for (x = left; x < right;) {
+            const int i = x - left;
+            if (x == middle && middle < middleEnd) {
+                aa[i] = SkToU8(rowAlpha);
+                rr[i] = SkToS16(middleEnd - middle);
+                x = middleEnd;
+            } else {
+                rr[i] = 1;
+                ++x;
+            }
+        }
+        rr[right - left] = 0;
+        blitter->blitAntiH(left, y, aa, rr);
+    }
+}
+
+bool SkScan::CanAntiFillRRect(const SkRRect& rrect) {
+    if (!rrect.isOval() && !rrect.isSimple()) {
+        return false;
+    }
+    // The distance estimate breaks down where the ellipse bends more tightly
+    // than the pixel grid, at the ends of its major axis (radius of curvature
+    // minor^2 / major). Leave those, and corners under half a pixel, to the
+    // path rasterizer.
+    const SkVector& radii = rrect.getSimpleRadii();
+    const SkScalar minor = SkTMin(radii.fX, radii.fY);
+    const SkScalar major = SkTMax(radii.fX, radii.fY);
+    return minor * minor >= SK_ScalarHalf * major;
+}
+
+void SkScan::AntiFillRRect(const SkRRect& rrect, const SkRegion* clip, SkBlitter* blitter) {
+    SkASSERT(CanAntiFillRRect(rrect));
+
+    SkIRect ir;
+    rrect.getBounds().roundOut(&ir);
+    if (ir.isEmpty() || !ir.intersect(clip->getBounds())) {
+        return;
+    }
+
+    // The runs[] uses int16_t, so only 32767 pixels fit in a row.
+    if (ir.width() > 32767) {
+        ir.fRight = ir.fLeft + 32767;
+    }
+
+    SkScanClipper clipper(blitter, clip, ir);
+    if (NULL == clipper.getBlitter()) {
+        return;
+    }
+    fill_rrect(rrect, ir, clipper.getBlitter());
+}
+
+void SkScan::AntiFillRRect(const SkRRect& rrect, const SkRasterClip& clip,
+                           SkBlitter* blitter) {
+    if (clip.isEmpty()) {
+        return;
+    }
+
+    if (clip.isBW()) {
+        AntiFillRRect(rrect, &clip.bwRgn(), blitter);
+    } else {
+        SkAAClipBlitterWrapper wrap(clip, blitter);
+        AntiFillRRect(rrect, &wrap.getRgn(), wrap.getBlitter());
+    }
+}
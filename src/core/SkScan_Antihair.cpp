@@ -189,37 +189,44 @@ public:
     virtual SkFixed drawLine(int x, int stopx, SkFixed fy, SkFixed dy) SK_OVERRIDE {
         SkASSERT(x < stopx);
 
-        int16_t runs[2];
-        uint8_t  aa[1];
-
-        runs[0] = 1;
-        runs[1] = 0;
+        // A shallow line straddles the same two rows for many columns in a
+        // row, so gather each such stretch into one span per row rather than
+        // blitting it a pixel at a time.
+        int16_t runs[HLINE_STACK_BUFFER + 1];
+        uint8_t  lower[HLINE_STACK_BUFFER];
+        uint8_t  upper[HLINE_STACK_BUFFER];
 
         fy += SK_Fixed1/2;
         SkBlitter* blitter = this->getBlitter();
         do {
-            int lower_y = fy >> 16;
-            uint8_t  a = (uint8_t)(fy >> 8);
-            if (a) {
-                aa[0] = a;
-                blitter->blitAntiH(x, lower_y, aa, runs);
-                // the clipping blitters might edit runs, but should not affect us
-                SkASSERT(runs[0] == 1);
-                SkASSERT(runs[1] == 0);
-            }
-            a = 255 - a;
-            if (a) {
-                aa[0] = a;
-                blitter->blitAntiH(x, lower_y - 1, aa, runs);
-                // the clipping blitters might edit runs, but should not affect us
-                SkASSERT(runs[0] == 1);
-                SkASSERT(runs[1] == 0);
-            }
-            fy += dy;
-        } while (++x < stopx);
+            const int lower_y = fy >> 16;
+            const int start_x = x;
+            int n = 0;
+            do {
+                uint8_t  a = (uint8_t)(fy >> 8);
+                lower[n] = a;
+                upper[n] = 255 - a;
+                n += 1;
+                fy += dy;
+            } while (++x < stopx && n < HLINE_STACK_BUFFER && (fy >> 16) == lower_y);
+
+            // the clipping blitters might edit runs, so we set them up for each blit
+            set_unit_runs(runs, n);
+            blitter->blitAntiH(start_x, lower_y, lower, runs);
+            set_unit_runs(runs, n);
+            blitter->blitAntiH(start_x, lower_y - 1, upper, runs);
+        } while (x < stopx);
 
         return fy - SK_Fixed1/2;
     }
+
+private:
+    static void set_unit_runs(int16_t runs[], int n) {
+        for (int i = 0; i < n; ++i) {
+            runs[i] = 1;
+        }
+        runs[n] = 0;
+    }
 };
 
 class VLine_SkAntiHairBlitter : public SkAntiHairBlitter {
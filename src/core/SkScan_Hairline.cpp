@@ -257,6 +257,33 @@ static int compute_quad_level(const SkPoint pts[3]) {
     return level;
 }
 
+/*  Choose the region that hairlines within bounds must be clipped to, leaving
+    *clip NULL if they need no clipping. Returns false if they are entirely
+    clipped out.
+ */
+static bool init_hair_clip(const SkRect& bounds, const SkRasterClip& rclip,
+                           SkAAClipBlitterWrapper* wrap, SkBlitter** blitter,
+                           const SkRegion** clip) {
+    SkIRect ibounds;
+    bounds.roundOut(&ibounds);
+    ibounds.inset(-1, -1);
+
+    if (rclip.quickReject(ibounds)) {
+        return false;
+    }
+    *clip = NULL;
+    if (!rclip.quickContains(ibounds)) {
+        if (rclip.isBW()) {
+            *clip = &rclip.bwRgn();
+        } else {
+            wrap->init(rclip, *blitter);
+            *blitter = wrap->getBlitter();
+            *clip = &wrap->getRgn();
+        }
+    }
+    return true;
+}
+
 static void hair_path(const SkPath& path, const SkRasterClip& rclip,
                       SkBlitter* blitter, LineProc lineproc) {
     if (path.isEmpty()) {
@@ -264,25 +291,9 @@ static void hair_path(const SkPath& path, const SkRasterClip& rclip,
     }
 
     SkAAClipBlitterWrapper wrap;
-    const SkRegion* clip = NULL;
-
-    {
-        SkIRect ibounds;
-        path.getBounds().roundOut(&ibounds);
-        ibounds.inset(-1, -1);
-
-        if (rclip.quickReject(ibounds)) {
-            return;
-        }
-        if (!rclip.quickContains(ibounds)) {
-            if (rclip.isBW()) {
-                clip = &rclip.bwRgn();
-            } else {
-                wrap.init(rclip, blitter);
-                blitter = wrap.getBlitter();
-                clip = &wrap.getRgn();
-            }
-        }
+    const SkRegion* clip;
+    if (!init_hair_clip(path.getBounds(), rclip, &wrap, &blitter, &clip)) {
+        return;
     }
 
     SkPath::Iter    iter(path, false);
@@ -333,6 +344,47 @@ void SkScan::AntiHairPath(const SkPath& path, const SkRasterClip& clip,
     hair_path(path, clip, blitter, SkScan::AntiHairLineRgn);
 }
 
+// Draws the segments pts[i] to pts[i + 1] for i = 0, step, 2 * step, ...,
+// deciding how to clip them just once, from the bounds of all of pts.
+static void hair_lines(const SkPoint pts[], int count, int step, const SkRasterClip& rclip,
+                       SkBlitter* blitter, LineProc lineproc) {
+    if (count < 2) {
+        return;
+    }
+
+    SkRect bounds;
+    bounds.set(pts, count);
+    SkAAClipBlitterWrapper wrap;
+    const SkRegion* clip;
+    if (!init_hair_clip(bounds, rclip, &wrap, &blitter, &clip)) {
+        return;
+    }
+
+    for (int i = 0; i + 1 < count; i += step) {
+        lineproc(pts[i], pts[i + 1], clip, blitter);
+    }
+}
+
+void SkScan::HairLines(const SkPoint pts[], int count, const SkRasterClip& clip,
+                       SkBlitter* blitter) {
+    hair_lines(pts, count, 2, clip, blitter, SkScan::HairLineRgn);
+}
+
+void SkScan::AntiHairLines(const SkPoint pts[], int count, const SkRasterClip& clip,
+                           SkBlitter* blitter) {
+    hair_lines(pts, count, 2, clip, blitter, SkScan::AntiHairLineRgn);
+}
+
+void SkScan::HairPolyline(const SkPoint pts[], int count, const SkRasterClip& clip,
+                          SkBlitter* blitter) {
+    hair_lines(pts, count, 1, clip, blitter, SkScan::HairLineRgn);
+}
+
+void SkScan::AntiHairPolyline(const SkPoint pts[], int count, const SkRasterClip& clip,
+                              SkBlitter* blitter) {
+    hair_lines(pts, count, 1, clip, blitter, SkScan::AntiHairLineRgn);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkScan::FrameRect(const SkRect& r, const SkPoint& strokeSize,
@@ -68,21 +68,24 @@ public:
         SkSafeRef(fColorFilter);
 
         fXfermode = paint.getXfermode();
+        if (SkXfermode::IsMode(fXfermode, SkXfermode::kSrcOver_Mode)) {
+            // the blit row procs are faster at src-over than xfer32
+            fXfermode = NULL;
+        }
         SkSafeRef(fXfermode);
 
         fBufferSize = 0;
         fBuffer = NULL;
 
-        unsigned flags32 = 0;
-        if (255 != paint.getAlpha()) {
-            flags32 |= SkBlitRow::kGlobalAlpha_Flag32;
-        }
-        if (!source.isOpaque()) {
-            flags32 |= SkBlitRow::kSrcPixelAlpha_Flag32;
-        }
-
-        fProc32 = SkBlitRow::Factory32(flags32);
+        // The paint's alpha is applied to the source before the filter and
+        // xfermode see it, as a shader would, so fProc32 only blends.
         fAlpha = paint.getAlpha();
+        bool opaque = source.isOpaque() && 255 == fAlpha;
+        if (NULL != fColorFilter &&
+            !(fColorFilter->getFlags() & SkColorFilter::kAlphaUnchanged_Flag)) {
+            opaque = false;
+        }
+        fProc32 = SkBlitRow::Factory32(opaque ? 0 : SkBlitRow::kSrcPixelAlpha_Flag32);
     }
 
     virtual ~Sprite_D32_XferFilter() {
@@ -104,6 +107,27 @@ public:
     }
 
 protected:
+    // Applies the paint's alpha, color filter and xfermode to a row of source
+    // colors, which may be fBuffer, and blends them into dst.
+    void xferRow(SkPMColor* SK_RESTRICT dst, const SkPMColor* src, int width) {
+        if (255 != fAlpha) {
+            const unsigned scale = SkAlpha255To256(fAlpha);
+            for (int i = 0; i < width; ++i) {
+                fBuffer[i] = SkAlphaMulQ(src[i], scale);
+            }
+            src = fBuffer;
+        }
+        if (NULL != fColorFilter) {
+            fColorFilter->filterSpan(src, width, fBuffer);
+            src = fBuffer;
+        }
+        if (NULL != fXfermode) {
+            fXfermode->xfer32(dst, src, width, NULL);
+        } else {
+            fProc32(dst, src, width, 255);
+        }
+    }
+
     SkColorFilter*      fColorFilter;
     SkXfermode*         fXfermode;
     int                 fBufferSize;
@@ -129,22 +153,9 @@ public:
                                                              y - fTop);
         size_t dstRB = fDevice->rowBytes();
         size_t srcRB = fSource->rowBytes();
-        SkColorFilter* colorFilter = fColorFilter;
-        SkXfermode* xfermode = fXfermode;
 
         do {
-            const SkPMColor* tmp = src;
-
-            if (NULL != colorFilter) {
-                colorFilter->filterSpan(src, width, fBuffer);
-                tmp = fBuffer;
-            }
-
-            if (NULL != xfermode) {
-                xfermode->xfer32(dst, tmp, width, NULL);
-            } else {
-                fProc32(dst, tmp, width, fAlpha);
-            }
+            this->xferRow(dst, src, width);
 
             dst = (uint32_t* SK_RESTRICT)((char*)dst + dstRB);
             src = (const uint32_t* SK_RESTRICT)((const char*)src + srcRB);
@@ -177,20 +188,10 @@ public:
         size_t dstRB = fDevice->rowBytes();
         size_t srcRB = fSource->rowBytes();
         SkPMColor* SK_RESTRICT buffer = fBuffer;
-        SkColorFilter* colorFilter = fColorFilter;
-        SkXfermode* xfermode = fXfermode;
 
         do {
             fillbuffer(buffer, src, width);
-
-            if (NULL != colorFilter) {
-                colorFilter->filterSpan(buffer, width, buffer);
-            }
-            if (NULL != xfermode) {
-                xfermode->xfer32(dst, buffer, width, NULL);
-            } else {
-                fProc32(dst, buffer, width, fAlpha);
-            }
+            this->xferRow(dst, buffer, width);
 
             dst = (SkPMColor* SK_RESTRICT)((char*)dst + dstRB);
             src = (const SkPMColor16* SK_RESTRICT)((const char*)src + srcRB);
@@ -276,12 +277,13 @@ SkSpriteBlitter* SkSpriteBlitter::ChooseD32(const SkBitmap& source, const SkPain
     SkColorFilter* filter = paint.getColorFilter();
     SkSpriteBlitter* blitter = NULL;
 
+    if (SkXfermode::IsMode(xfermode, SkXfermode::kSrcOver_Mode)) {
+        xfermode = NULL;
+    }
+
     switch (source.colorType()) {
         case kARGB_4444_SkColorType:
-            if (alpha != 0xFF) {
-                return NULL;    // we only have opaque sprites
-            }
-            if (xfermode || filter) {
+            if (xfermode || filter || alpha != 0xFF) {
                 blitter = allocator->createT<Sprite_D32_S4444_XferFilter>(source, paint);
             } else if (source.isOpaque()) {
                 blitter = allocator->createT<Sprite_D32_S4444_Opaque>(source);
@@ -291,10 +293,8 @@ SkSpriteBlitter* SkSpriteBlitter::ChooseD32(const SkBitmap& source, const SkPain
             break;
         case kN32_SkColorType:
             if (xfermode || filter) {
-                if (255 == alpha) {
-                    // this can handle xfermode or filter, but not alpha
-                    blitter = allocator->createT<Sprite_D32_S32A_XferFilter>(source, paint);
-                }
+                // this can handle alpha, xfermode and filter, a row at a time
+                blitter = allocator->createT<Sprite_D32_S32A_XferFilter>(source, paint);
             } else {
                 // this can handle alpha, but not xfermode or filter
                 blitter = allocator->createT<Sprite_D32_S32>(source, alpha);
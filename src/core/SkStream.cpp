@@ -216,6 +216,7 @@ SkFILEStream::~SkFILEStream() {
 
 void SkFILEStream::setPath(const char path[]) {
     fName.set(path);
+    fData.reset(NULL);
     if (fFILE) {
         sk_fclose(fFILE);
         fFILE = NULL;
@@ -264,13 +265,19 @@ SkStreamAsset* SkFILEStream::duplicate() const {
         }
     }
 
-    fData.reset(SkData::NewFromFILE(fFILE));
-    if (NULL == fData.get()) {
+    if (NULL == this->mapData()) {
         return NULL;
     }
     return new SkMemoryStream(fData);
 }
 
+SkData* SkFILEStream::mapData() const {
+    if (NULL == fData.get() && NULL != fFILE) {
+        fData.reset(SkData::NewFromFILE(fFILE));
+    }
+    return fData.get();
+}
+
 size_t SkFILEStream::getPosition() const {
     return sk_ftell(fFILE);
 }
@@ -294,10 +301,11 @@ size_t SkFILEStream::getLength() const {
 }
 
 const void* SkFILEStream::getMemoryBase() {
-    if (NULL == fData.get()) {
+    SkData* data = this->mapData();
+    if (NULL == data) {
         return NULL;
     }
-    return fData->data();
+    return data->data();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -8,6 +8,8 @@
 #include "SkStrokerPriv.h"
 #include "SkGeometry.h"
 #include "SkPath.h"
+#include "SkStrokeCache.h"
+#include "SkTLS.h"
 
 #define kMaxQuadSubdivide   5
 #define kMaxCubicSubdivide  7
@@ -68,11 +70,17 @@ static bool set_normal_unitnormal(const SkVector& vec,
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/*  Each thread keeps one SkPathStroker (see get_stroker()), so its working
+    paths keep their storage from one stroke to the next.
+ */
 class SkPathStroker {
 public:
-    SkPathStroker(const SkPath& src,
-                  SkScalar radius, SkScalar miterLimit, SkPaint::Cap cap,
-                  SkPaint::Join join);
+    SkPathStroker() {}
+
+    /** Prepare to stroke src, keeping the storage of any previous stroke. */
+    void init(const SkPath& src,
+              SkScalar radius, SkScalar miterLimit, SkPaint::Cap cap,
+              SkPaint::Join join);
 
     void moveTo(const SkPoint&);
     void lineTo(const SkPoint&);
@@ -83,6 +91,8 @@ public:
     void done(SkPath* dst, bool isLine) {
         this->finishContour(false, isLine);
         fOuter.addPath(fExtra);
+        fExtra.rewind();
+        // dst's previous storage is left in fOuter, for the next stroke.
         dst->swap(fOuter);
     }
 
@@ -187,10 +197,10 @@ void SkPathStroker::finishContour(bool close, bool currIsLine) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-SkPathStroker::SkPathStroker(const SkPath& src,
-                             SkScalar radius, SkScalar miterLimit,
-                             SkPaint::Cap cap, SkPaint::Join join)
-        : fRadius(radius) {
+void SkPathStroker::init(const SkPath& src,
+                         SkScalar radius, SkScalar miterLimit,
+                         SkPaint::Cap cap, SkPaint::Join join) {
+    fRadius = radius;
 
     /*  This is only used when join is miter_join, but we initialize it here
         so that it is always defined, to fis valgrind warnings.
@@ -215,6 +225,9 @@ SkPathStroker::SkPathStroker(const SkPath& src,
     //
     // 3x for result == inner + outer + join (swag)
     // 1x for inner == 'wag' (worst contour length would be better guess)
+    fOuter.rewind();
+    fInner.rewind();
+    fExtra.rewind();
     fOuter.incReserve(src.countPoints() * 3);
     fInner.incReserve(src.countPoints());
 }
@@ -519,6 +532,18 @@ void SkStroke::setJoin(SkPaint::Join join) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static void* create_stroker() {
+    return SkNEW(SkPathStroker);
+}
+
+static void delete_stroker(void* stroker) {
+    SkDELETE(reinterpret_cast<SkPathStroker*>(stroker));
+}
+
+static SkPathStroker* get_stroker() {
+    return reinterpret_cast<SkPathStroker*>(SkTLS::Get(create_stroker, delete_stroker));
+}
+
 // If src==dst, then we use a tmp path to record the stroke, and then swap
 // its contents with src when we're done.
 class AutoTmpPath {
@@ -528,7 +553,8 @@ public:
             *dst = &fTmpDst;
             fSwapWithSrc = true;
         } else {
-            (*dst)->reset();
+            // rewind rather than reset, so the stroker can reuse dst's storage.
+            (*dst)->rewind();
             fSwapWithSrc = false;
         }
     }
@@ -548,6 +574,12 @@ private:
 void SkStroke::strokePath(const SkPath& src, SkPath* dst) const {
     SkASSERT(&src != NULL && dst != NULL);
 
+    if (!SkStrokeCache::Find(src, *this, dst)) {
+        this->strokePathUncached(src, dst);
+    }
+}
+
+void SkStroke::strokePathUncached(const SkPath& src, SkPath* dst) const {
     SkScalar radius = SkScalarHalf(fWidth);
 
     AutoTmpPath tmp(src, &dst);
@@ -574,8 +606,8 @@ void SkStroke::strokePath(const SkPath& src, SkPath* dst) const {
     SkAutoConicToQuads converter;
     const SkScalar conicTol = SK_Scalar1 / 4;
 
-    SkPathStroker   stroker(src, radius, fMiterLimit, this->getCap(),
-                            this->getJoin());
+    SkPathStroker&  stroker = *get_stroker();
+    stroker.init(src, radius, fMiterLimit, this->getCap(), this->getJoin());
     SkPath::Iter    iter(src, false);
     SkPath::Verb    lastSegment = SkPath::kMove_Verb;
 
@@ -30,7 +30,10 @@ public:
     SkPaint::Join   getJoin() const { return (SkPaint::Join)fJoin; }
     void        setJoin(SkPaint::Join);
 
+    SkScalar getMiterLimit() const { return fMiterLimit; }
     void    setMiterLimit(SkScalar);
+
+    SkScalar getWidth() const { return fWidth; }
     void    setWidth(SkScalar);
 
     bool    getDoFill() const { return SkToBool(fDoFill); }
@@ -41,6 +44,10 @@ public:
      */
     void    strokeRect(const SkRect& rect, SkPath* result,
                        SkPath::Direction = SkPath::kCW_Direction) const;
+    /**
+     *  Stroke the specified path. The outline may come from SkStrokeCache if
+     *  the same path was recently stroked with the same parameters.
+     */
     void    strokePath(const SkPath& path, SkPath*) const;
 
     ////////////////////////////////////////////////////////////////
@@ -50,7 +57,10 @@ private:
     uint8_t     fCap, fJoin;
     SkBool8     fDoFill;
 
+    void    strokePathUncached(const SkPath& path, SkPath*) const;
+
     friend class SkPaint;
+    friend class SkStrokeCache;
 };
 
 #endif
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkStrokeCache.h"
+#include "SkChecksum.h"
+#include "SkPath.h"
+#include "SkStroke.h"
+#include "SkThread.h"
+#include "SkTLRUByteCache.h"
+
+#ifndef SK_DEFAULT_STROKE_CACHE_LIMIT
+    #define SK_DEFAULT_STROKE_CACHE_LIMIT     (1024 * 1024)
+#endif
+
+// Paths simpler than this are about as cheap to stroke as to look up.
+static const int kMinVerbsToCache = 16;
+
+namespace {
+
+struct Key {
+    Key(const SkPath& path, const SkStroke& stroke) {
+        // Zero everything first, so padding compares equal.
+        sk_bzero(this, sizeof(*this));
+        fGenID = path.getGenerationID();
+        fFlags = path.getFillType() | (stroke.getCap() << 2) | (stroke.getJoin() << 4) |
+                 (stroke.getDoFill() << 6);
+        fWidth = stroke.getWidth();
+        fMiterLimit = stroke.getMiterLimit();
+        fHash = SkChecksum::Murmur3(&fGenID, sizeof(*this) - sizeof(fHash));
+    }
+
+    bool operator==(const Key& other) const {
+        return 0 == memcmp(this, &other, sizeof(*this));
+    }
+
+    uint32_t fHash;
+    uint32_t fGenID;
+    uint32_t fFlags;
+    SkScalar fWidth;
+    SkScalar fMiterLimit;
+};
+
+struct Rec {
+    Rec(const Key& key, const SkPath& path)
+        : fKey(key)
+        , fPath(path)
+        // Conic weights are not counted; strokes rarely have many.
+        , fBytesUsed(sizeof(Rec) + path.countPoints() * sizeof(SkPoint) + path.countVerbs()) {}
+
+    static const Key& GetKey(const Rec& rec) { return rec.fKey; }
+    static uint32_t Hash(const Key& key) { return key.fHash; }
+
+    size_t bytesUsed() const { return fBytesUsed; }
+
+    const Key       fKey;
+    const SkPath    fPath;
+    const size_t    fBytesUsed;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Rec);
+};
+
+typedef SkTLRUByteCache<Rec, Key> Cache;
+
+}  // namespace
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+static Cache* gStrokeCache = NULL;
+static void cleanup_gStrokeCache() {
+#if SK_DEVELOPER
+    SkDELETE(gStrokeCache);
+#endif
+}
+
+/** Must hold gMutex when calling. */
+static Cache* get_cache() {
+    gMutex.assertHeld();
+    if (NULL == gStrokeCache) {
+        gStrokeCache = SkNEW_ARGS(Cache, (SK_DEFAULT_STROKE_CACHE_LIMIT,
+                                           Cache::kSecondSighting_AdmitPolicy));
+        atexit(cleanup_gStrokeCache);
+    }
+    return gStrokeCache;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool SkStrokeCache::Find(const SkPath& path, const SkStroke& stroke, SkPath* result) {
+    if (stroke.getWidth() <= 0 || path.countVerbs() < kMinVerbsToCache) {
+        return false;
+    }
+
+    const Key key(path, stroke);
+    {
+        SkAutoMutexAcquire am(gMutex);
+        Rec* rec = get_cache()->find(key);
+        if (NULL != rec) {
+            *result = rec->fPath;
+            return true;
+        }
+        if (!get_cache()->admit(key)) {
+            return false;
+        }
+    }
+
+    // Stroke the path without holding the lock.
+    SkPath stroked;
+    stroke.strokePathUncached(path, &stroked);
+    // Copies share stroked's SkPathRef, so compute its lazy bounds and
+    // generation ID before other threads can see it.
+    stroked.updateBoundsCache();
+    (void)stroked.getGenerationID();
+
+    {
+        SkAutoMutexAcquire am(gMutex);
+        // Another thread may have stroked it too while we were.
+        if (NULL == get_cache()->find(key)) {
+            get_cache()->add(SkNEW_ARGS(Rec, (key, stroked)));
+        }
+    }
+    result->swap(stroked);
+    return true;
+}
+
+size_t SkStrokeCache::GetBytesUsed() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->bytesUsed();
+}
+
+size_t SkStrokeCache::GetByteLimit() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->byteLimit();
+}
+
+size_t SkStrokeCache::SetByteLimit(size_t newLimit) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->setByteLimit(newLimit);
+}
+
+void SkStrokeCache::Purge() {
+    SkAutoMutexAcquire am(gMutex);
+    get_cache()->purgeAll();
+}
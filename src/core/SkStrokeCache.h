@@ -0,0 +1,45 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkStrokeCache_DEFINED
+#define SkStrokeCache_DEFINED
+
+#include "SkTypes.h"
+
+class SkPath;
+class SkStroke;
+
+/**
+ *  A global, size-bounded cache of stroked outlines, so that a path stroked
+ *  again with the same parameters (e.g. a chart's polylines, every frame) is
+ *  copied rather than re-stroked. The copy shares the cached path's storage.
+ *
+ *  Entries are keyed on the path's generation ID and fill type, and the
+ *  stroker's width, miter limit, cap, join and fill flag. A path is only
+ *  stroked into the cache the second time it is seen, so paths that are
+ *  stroked once cost no more than a lookup.
+ *
+ *  The static methods are thread-safe.
+ */
+class SkStrokeCache {
+public:
+    /**
+     *  If stroking path with stroke can be served from the cache, set result to
+     *  the stroked outline and return true (result may be the same object as
+     *  path). Otherwise return false, and the caller should stroke the path.
+     */
+    static bool Find(const SkPath& path, const SkStroke& stroke, SkPath* result);
+
+    static size_t GetBytesUsed();
+    static size_t GetByteLimit();
+    static size_t SetByteLimit(size_t newLimit);
+
+    /** Remove every entry from the cache. */
+    static void Purge();
+};
+
+#endif
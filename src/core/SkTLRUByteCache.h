@@ -0,0 +1,193 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTLRUByteCache_DEFINED
+#define SkTLRUByteCache_DEFINED
+
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
+#include "SkTypes.h"
+
+// T requires:
+//   static const Key& GetKey(const T&) { ... }
+//   static uint32_t Hash(const Key&) { ... }
+//   size_t bytesUsed() const { ... }
+//   SK_DECLARE_INTERNAL_LLIST_INTERFACE(T);
+//
+// A cache of Ts, found by their keys, that deletes the least recently used ones once their
+// bytesUsed() adds up to more than a limit. Pinned Ts don't count towards the limit and stay
+// until purgeAll(). The cache owns the Ts added to it. It is not thread-safe; the process-wide
+// caches built on it guard their instances with mutexes, and delete them at exit only in
+// SK_DEVELOPER builds: a client's other threads may still be drawing while its process exits.
+template <typename T, typename Key>
+class SkTLRUByteCache : SkNoncopyable {
+public:
+    enum AdmitPolicy {
+        // Any T may be built and added.
+        kAlways_AdmitPolicy,
+        // A T is worth building only once its key has been asked for twice. Most paths, say, are
+        // drawn once, and the cache would only churn with their Ts.
+        kSecondSighting_AdmitPolicy,
+    };
+
+    explicit SkTLRUByteCache(size_t byteLimit, AdmitPolicy policy = kAlways_AdmitPolicy)
+        : fPolicy(policy), fBytesUsed(0), fSightingBytes(0), fByteLimit(byteLimit) {}
+
+    ~SkTLRUByteCache() {
+        this->purgeAll();
+    }
+
+    // Returns the T for key and marks it most recently used, or NULL.
+    T* find(const Key& key) {
+        T* rec = fHash.find(key);
+        if (NULL != rec) {
+            fLRU.remove(rec);
+            fLRU.addToHead(rec);
+            return rec;
+        }
+        return fPinnedHash.find(key);
+    }
+
+    // Call when find(key) misses, before building a T for key. Returns whether to build and add it.
+    // Under kSecondSighting_AdmitPolicy, the first call for a key only remembers the key, and
+    // returns false. Remembered keys count towards the limit, but take up at most a quarter of it.
+    bool admit(const Key& key) {
+        if (kAlways_AdmitPolicy == fPolicy) {
+            return true;
+        }
+        Sighting* sighting = fSightings.find(key);
+        if (NULL != sighting) {
+            this->removeSighting(sighting);
+            return true;
+        }
+        sighting = SkNEW_ARGS(Sighting, (key));
+        fSightings.add(sighting);
+        fSightingLRU.addToHead(sighting);
+        fBytesUsed += sizeof(Sighting);
+        fSightingBytes += sizeof(Sighting);
+        this->purgeToLimit();
+        return false;
+    }
+
+    // Takes ownership of rec, whose key must not be in the cache. Over the limit, this may delete
+    // rec itself unless it is pinned.
+    void add(T* rec, bool pin = false) {
+        const Key& key = T::GetKey(*rec);
+        SkASSERT(NULL == fHash.find(key) && NULL == fPinnedHash.find(key));
+        if (pin) {
+            fPinnedHash.add(rec);
+            fPinned.addToHead(rec);
+        } else {
+            fHash.add(rec);
+            fLRU.addToHead(rec);
+            fBytesUsed += rec->bytesUsed();
+            this->purgeToLimit();
+        }
+    }
+
+    // Pins rec, which is in the cache, if it isn't already.
+    void pin(T* rec) {
+        const Key& key = T::GetKey(*rec);
+        if (NULL != fPinnedHash.find(key)) {
+            return;
+        }
+        SkASSERT(rec == fHash.find(key));
+        fBytesUsed -= rec->bytesUsed();
+        fLRU.remove(rec);
+        fHash.remove(key);
+        fPinnedHash.add(rec);
+        fPinned.addToHead(rec);
+    }
+
+    // Call after changing rec, which is in the cache, in a way that changes its bytesUsed().
+    // prevBytes is what bytesUsed() returned before. Over the limit, this may delete rec.
+    void resized(T* rec, size_t prevBytes) {
+        if (NULL != fPinnedHash.find(T::GetKey(*rec))) {
+            return;
+        }
+        SkASSERT(rec == fHash.find(T::GetKey(*rec)));
+        fBytesUsed = fBytesUsed - prevBytes + rec->bytesUsed();
+        this->purgeToLimit();
+    }
+
+    size_t bytesUsed() const { return fBytesUsed; }
+    size_t byteLimit() const { return fByteLimit; }
+
+    size_t setByteLimit(size_t newLimit) {
+        size_t prevLimit = fByteLimit;
+        fByteLimit = newLimit;
+        this->purgeToLimit();
+        return prevLimit;
+    }
+
+    // Deletes every T, pinned or not, and forgets every key admit() has seen.
+    void purgeAll() {
+        while (NULL != fSightingLRU.tail()) {
+            this->removeSighting(fSightingLRU.tail());
+        }
+        while (NULL != fLRU.tail()) {
+            this->remove(fLRU.tail());
+        }
+        while (NULL != fPinned.tail()) {
+            T* rec = fPinned.tail();
+            fPinned.remove(rec);
+            fPinnedHash.remove(T::GetKey(*rec));
+            SkDELETE(rec);
+        }
+    }
+
+private:
+    // A key admit() has seen once.
+    struct Sighting {
+        explicit Sighting(const Key& key) : fKey(key) {}
+
+        static const Key& GetKey(const Sighting& sighting) { return sighting.fKey; }
+        static uint32_t Hash(const Key& key) { return T::Hash(key); }
+
+        const Key fKey;
+
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Sighting);
+    };
+
+    void removeSighting(Sighting* sighting) {
+        fBytesUsed -= sizeof(Sighting);
+        fSightingBytes -= sizeof(Sighting);
+        fSightingLRU.remove(sighting);
+        fSightings.remove(sighting->fKey);
+        SkDELETE(sighting);
+    }
+
+    void remove(T* rec) {
+        fBytesUsed -= rec->bytesUsed();
+        fLRU.remove(rec);
+        fHash.remove(T::GetKey(*rec));
+        SkDELETE(rec);
+    }
+
+    void purgeToLimit() {
+        while (fSightingBytes > fByteLimit / 4 && NULL != fSightingLRU.tail()) {
+            this->removeSighting(fSightingLRU.tail());
+        }
+        while (fBytesUsed > fByteLimit && NULL != fLRU.tail()) {
+            this->remove(fLRU.tail());
+        }
+    }
+
+    const AdmitPolicy               fPolicy;
+    SkTDynamicHash<T, Key>          fHash;
+    SkTInternalLList<T>             fLRU;
+    // Pinned Ts are kept apart, so the LRU list only holds Ts that may be purged.
+    SkTDynamicHash<T, Key>          fPinnedHash;
+    SkTInternalLList<T>             fPinned;
+    SkTDynamicHash<Sighting, Key>   fSightings;
+    SkTInternalLList<Sighting>      fSightingLRU;
+    size_t                          fBytesUsed;     // Includes fSightingBytes.
+    size_t                          fSightingBytes;
+    size_t                          fByteLimit;
+};
+
+#endif
@@ -0,0 +1,276 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTextBlob.h"
+
+#include "SkReadBuffer.h"
+#include "SkThread.h"
+#include "SkWriteBuffer.h"
+
+// The paint flags that are part of a run's font, rather than of the draw.
+static const uint32_t kTextFlagsMask = SkPaint::kAntiAlias_Flag |
+                                       SkPaint::kFakeBoldText_Flag |
+                                       SkPaint::kLinearText_Flag |
+                                       SkPaint::kSubpixelText_Flag |
+                                       SkPaint::kDevKernText_Flag |
+                                       SkPaint::kLCDRenderText_Flag |
+                                       SkPaint::kEmbeddedBitmapText_Flag |
+                                       SkPaint::kAutoHinting_Flag |
+                                       SkPaint::kVerticalText_Flag |
+                                       SkPaint::kGenA8FromLCD_Flag |
+                                       SkPaint::kDistanceFieldTextTEMP_Flag;
+
+static int scalars_per_glyph(SkTextBlob::GlyphPositioning positioning) {
+    // kDefault_Positioning, kHorizontal_Positioning, kFull_Positioning
+    static const int kScalarsPerGlyph[] = { 0, 1, 2 };
+    SkASSERT((unsigned)positioning < SK_ARRAY_COUNT(kScalarsPerGlyph));
+    return kScalarsPerGlyph[positioning];
+}
+
+static void copy_font(const SkPaint& src, SkPaint* dst) {
+    dst->setTypeface(src.getTypeface());
+    dst->setTextSize(src.getTextSize());
+    dst->setTextScaleX(src.getTextScaleX());
+    dst->setTextSkewX(src.getTextSkewX());
+    dst->setHinting(src.getHinting());
+    dst->setFlags((dst->getFlags() & ~kTextFlagsMask) | (src.getFlags() & kTextFlagsMask));
+    // Runs are positioned by their left edge, whatever the draw's paint says.
+    dst->setTextAlign(SkPaint::kLeft_Align);
+    dst->setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+}
+
+static uint32_t next_text_blob_id() {
+    static int32_t gTextBlobID;
+    int32_t id;
+    do {
+        id = sk_atomic_inc(&gTextBlobID) + 1;
+    } while (0 == id);
+    return id;
+}
+
+SkTextBlob::SkTextBlob() : fUniqueID(next_text_blob_id()) {
+    fBounds.setEmpty();
+}
+
+SkTextBlob::~SkTextBlob() {}
+
+void SkTextBlob::flatten(SkWriteBuffer& buffer) const {
+    buffer.writeInt(fRuns.count());
+    buffer.writeRect(fBounds);
+    for (int i = 0; i < fRuns.count(); ++i) {
+        const Run& run = fRuns[i];
+        buffer.writeUInt(run.fPositioning);
+        buffer.writeInt(run.fCount);
+        buffer.writePoint(run.fOffset);
+
+        buffer.writeTypeface(run.fFont.getTypeface());
+        buffer.writeScalar(run.fFont.getTextSize());
+        buffer.writeScalar(run.fFont.getTextScaleX());
+        buffer.writeScalar(run.fFont.getTextSkewX());
+        buffer.writeUInt(run.fFont.getFlags() & kTextFlagsMask);
+        buffer.writeUInt(run.fFont.getHinting());
+
+        buffer.writeByteArray(fGlyphs.begin() + run.fGlyphStart, run.fCount * sizeof(uint16_t));
+        buffer.writeScalarArray(fPos.begin() + run.fPosStart,
+                                run.fCount * scalars_per_glyph(run.fPositioning));
+    }
+}
+
+const SkTextBlob* SkTextBlob::CreateFromBuffer(SkReadBuffer& buffer) {
+    const int runCount = buffer.readInt();
+    if (!buffer.validate(runCount >= 0)) {
+        return NULL;
+    }
+
+    SkAutoTUnref<SkTextBlob> blob(SkNEW(SkTextBlob));
+    buffer.readRect(&blob->fBounds);
+    for (int i = 0; i < runCount; ++i) {
+        const uint32_t positioning = buffer.readUInt();
+        const int count = buffer.readInt();
+        if (!buffer.validate(positioning <= kFull_Positioning && count >= 0 && count < (1 << 24))) {
+            return NULL;
+        }
+
+        Run& run = blob->fRuns.push_back();
+        run.fPositioning = (GlyphPositioning)positioning;
+        run.fCount = count;
+        run.fGlyphStart = blob->fGlyphs.count();
+        run.fPosStart = blob->fPos.count();
+        buffer.readPoint(&run.fOffset);
+
+        run.fFont.setTypeface(buffer.readTypeface());
+        run.fFont.setTextSize(buffer.readScalar());
+        run.fFont.setTextScaleX(buffer.readScalar());
+        run.fFont.setTextSkewX(buffer.readScalar());
+        run.fFont.setFlags(buffer.readUInt() & kTextFlagsMask);
+        const uint32_t hinting = buffer.readUInt();
+        if (!buffer.validate(hinting <= SkPaint::kFull_Hinting)) {
+            return NULL;
+        }
+        run.fFont.setHinting((SkPaint::Hinting)hinting);
+        run.fFont.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+
+        const int posCount = count * scalars_per_glyph(run.fPositioning);
+        if (!buffer.readByteArray(blob->fGlyphs.append(count), count * sizeof(uint16_t)) ||
+            !buffer.readScalarArray(blob->fPos.append(posCount), posCount)) {
+            return NULL;
+        }
+    }
+    return buffer.isValid() ? blob.detach() : NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkTextBlob::RunIterator::RunIterator(const SkTextBlob* blob) : fBlob(blob), fIndex(0) {
+    SkASSERT(NULL != blob);
+}
+
+int SkTextBlob::RunIterator::glyphCount() const {
+    SkASSERT(!this->done());
+    return fBlob->fRuns[fIndex].fCount;
+}
+
+const uint16_t* SkTextBlob::RunIterator::glyphs() const {
+    SkASSERT(!this->done());
+    return fBlob->fGlyphs.begin() + fBlob->fRuns[fIndex].fGlyphStart;
+}
+
+const SkScalar* SkTextBlob::RunIterator::pos() const {
+    SkASSERT(!this->done());
+    const Run& run = fBlob->fRuns[fIndex];
+    return kDefault_Positioning == run.fPositioning ? NULL : fBlob->fPos.begin() + run.fPosStart;
+}
+
+const SkPoint& SkTextBlob::RunIterator::offset() const {
+    SkASSERT(!this->done());
+    return fBlob->fRuns[fIndex].fOffset;
+}
+
+SkTextBlob::GlyphPositioning SkTextBlob::RunIterator::positioning() const {
+    SkASSERT(!this->done());
+    return fBlob->fRuns[fIndex].fPositioning;
+}
+
+void SkTextBlob::RunIterator::applyFontToPaint(SkPaint* paint) const {
+    SkASSERT(!this->done());
+    copy_font(fBlob->fRuns[fIndex].fFont, paint);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkTextBlobBuilder::SkTextBlobBuilder() : fBlob(NULL), fDeferredBounds(false) {
+    fBounds.setEmpty();
+}
+
+SkTextBlobBuilder::~SkTextBlobBuilder() {
+    SkSafeUnref(fBlob);
+}
+
+const SkTextBlobBuilder::RunBuffer& SkTextBlobBuilder::allocRun(const SkPaint& font, int count,
+                                                                SkScalar x, SkScalar y,
+                                                                const SkRect* bounds) {
+    return this->allocInternal(font, count, SkPoint::Make(x, y),
+                               SkTextBlob::kDefault_Positioning, bounds);
+}
+
+const SkTextBlobBuilder::RunBuffer& SkTextBlobBuilder::allocRunPosH(const SkPaint& font,
+                                                                    int count, SkScalar y,
+                                                                    const SkRect* bounds) {
+    return this->allocInternal(font, count, SkPoint::Make(0, y),
+                               SkTextBlob::kHorizontal_Positioning, bounds);
+}
+
+const SkTextBlobBuilder::RunBuffer& SkTextBlobBuilder::allocRunPos(const SkPaint& font,
+                                                                   int count,
+                                                                   const SkRect* bounds) {
+    return this->allocInternal(font, count, SkPoint::Make(0, 0),
+                               SkTextBlob::kFull_Positioning, bounds);
+}
+
+const SkTextBlobBuilder::RunBuffer& SkTextBlobBuilder::allocInternal(
+        const SkPaint& font, int count, SkPoint offset,
+        SkTextBlob::GlyphPositioning positioning, const SkRect* bounds) {
+    SkASSERT(count >= 0);
+    this->updateDeferredBounds();
+
+    if (NULL == fBlob) {
+        fBlob = SkNEW(SkTextBlob);
+    }
+
+    SkTextBlob::Run& run = fBlob->fRuns.push_back();
+    copy_font(font, &run.fFont);
+    run.fCount = count;
+    run.fGlyphStart = fBlob->fGlyphs.count();
+    run.fPosStart = fBlob->fPos.count();
+    run.fOffset = offset;
+    run.fPositioning = positioning;
+
+    fCurrentRunBuffer.glyphs = fBlob->fGlyphs.append(count);
+    fCurrentRunBuffer.pos = fBlob->fPos.append(count * scalars_per_glyph(positioning));
+
+    if (NULL != bounds) {
+        fBounds.join(*bounds);
+    } else {
+        // The glyphs are not filled in yet.
+        fDeferredBounds = true;
+    }
+    return fCurrentRunBuffer;
+}
+
+void SkTextBlobBuilder::updateDeferredBounds() {
+    if (!fDeferredBounds) {
+        return;
+    }
+    fDeferredBounds = false;
+
+    SkASSERT(NULL != fBlob && fBlob->fRuns.count() > 0);
+    SkTextBlob::RunIterator it(fBlob);
+    for (int i = 1; i < fBlob->fRuns.count(); ++i) {
+        it.next();
+    }
+    const int count = it.glyphCount();
+    if (0 == count) {
+        return;
+    }
+
+    SkPaint font;
+    it.applyFontToPaint(&font);
+    const uint16_t* glyphs = it.glyphs();
+
+    if (SkTextBlob::kDefault_Positioning == it.positioning()) {
+        SkRect bounds;
+        font.measureText(glyphs, count * sizeof(uint16_t), &bounds);
+        bounds.offset(it.offset());
+        fBounds.join(bounds);
+        return;
+    }
+
+    SkAutoSTMalloc<64, SkRect> glyphBounds(count);
+    font.getTextWidths(glyphs, count * sizeof(uint16_t), NULL, glyphBounds.get());
+    const SkScalar* pos = it.pos();
+    const bool horizontal = SkTextBlob::kHorizontal_Positioning == it.positioning();
+    for (int i = 0; i < count; ++i) {
+        SkRect bounds = glyphBounds[i];
+        if (horizontal) {
+            bounds.offset(pos[i], it.offset().fY);
+        } else {
+            bounds.offset(pos[2 * i], pos[2 * i + 1]);
+        }
+        fBounds.join(bounds);
+    }
+}
+
+const SkTextBlob* SkTextBlobBuilder::build() {
+    this->updateDeferredBounds();
+
+    SkTextBlob* blob = NULL != fBlob ? fBlob : SkNEW(SkTextBlob);
+    blob->fBounds = fBounds;
+
+    fBlob = NULL;
+    fBounds.setEmpty();
+    return blob;
+}
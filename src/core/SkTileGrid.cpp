@@ -7,9 +7,13 @@
  */
 
 #include "SkTileGrid.h"
+#include "SkTSort.h"
 
-SkTileGrid::SkTileGrid(int xTileCount, int yTileCount, const SkTileGridFactory::TileGridInfo& info,
-                       SkTileGridNextDatumFunctionPtr nextDatumFunction) {
+// Queries spanning up to this many tiles merge their buckets head by head. Larger ones sort.
+static const int kMaxMergeTiles = 4;
+
+SkTileGrid::SkTileGrid(int xTileCount, int yTileCount,
+                       const SkTileGridFactory::TileGridInfo& info) {
     fXTileCount = xTileCount;
     fYTileCount = yTileCount;
     fInfo = info;
@@ -21,51 +25,114 @@ SkTileGrid::SkTileGrid(int xTileCount, int yTileCount, const SkTileGridFactory::
     fInsertionCount = 0;
     fGridBounds = SkIRect::MakeXYWH(0, 0, fInfo.fTileInterval.width() * fXTileCount,
         fInfo.fTileInterval.height() * fYTileCount);
-    fNextDatumFunction = nextDatumFunction;
-    fTileData = SkNEW_ARRAY(SkTDArray<void *>, fTileCount);
+    fTilesDirty = true;
 }
 
 SkTileGrid::~SkTileGrid() {
-    SkDELETE_ARRAY(fTileData);
 }
 
 int SkTileGrid::tileCount(int x, int y) {
-    return this->tile(x, y).count();
-}
-
-SkTDArray<void *>& SkTileGrid::tile(int x, int y) {
-    return fTileData[y * fXTileCount + x];
+    this->buildTiles();
+    return SkToInt(this->tileEnd(x, y) - this->tileBegin(x, y));
 }
 
-void SkTileGrid::insert(void* data, const SkIRect& bounds, bool) {
-    SkASSERT(!bounds.isEmpty());
+bool SkTileGrid::getTileRange(const SkIRect& bounds, SkIRect* tiles) const {
     SkIRect dilatedBounds = bounds;
     dilatedBounds.outset(fInfo.fMargin.width(), fInfo.fMargin.height());
     dilatedBounds.offset(fInfo.fOffset);
     if (!SkIRect::Intersects(dilatedBounds, fGridBounds)) {
-        return;
+        return false;
     }
 
     // Note: SkIRects are non-inclusive of the right() column and bottom() row,
     // hence the "-1"s in the computations of maxTileX and maxTileY.
-    int minTileX = SkMax32(SkMin32(dilatedBounds.left() / fInfo.fTileInterval.width(),
+    tiles->fLeft = SkMax32(SkMin32(dilatedBounds.left() / fInfo.fTileInterval.width(),
         fXTileCount - 1), 0);
-    int maxTileX = SkMax32(SkMin32((dilatedBounds.right() - 1) / fInfo.fTileInterval.width(),
+    tiles->fRight = SkMax32(SkMin32((dilatedBounds.right() - 1) / fInfo.fTileInterval.width(),
         fXTileCount - 1), 0);
-    int minTileY = SkMax32(SkMin32(dilatedBounds.top() / fInfo.fTileInterval.height(),
+    tiles->fTop = SkMax32(SkMin32(dilatedBounds.top() / fInfo.fTileInterval.height(),
         fYTileCount -1), 0);
-    int maxTileY = SkMax32(SkMin32((dilatedBounds.bottom() -1) / fInfo.fTileInterval.height(),
+    tiles->fBottom = SkMax32(SkMin32((dilatedBounds.bottom() -1) / fInfo.fTileInterval.height(),
         fYTileCount -1), 0);
+    return true;
+}
 
-    for (int x = minTileX; x <= maxTileX; x++) {
-        for (int y = minTileY; y <= maxTileY; y++) {
-            this->tile(x, y).push(data);
-        }
+void SkTileGrid::insert(void* data, const SkIRect& bounds, bool) {
+    SkASSERT(!bounds.isEmpty());
+    SkIRect tiles;
+    if (!this->getTileRange(bounds, &tiles)) {
+        return;
     }
+
+    Entry* entry = fEntries.append();
+    entry->fData = data;
+    entry->fTiles = tiles;
     fInsertionCount++;
+    fTilesDirty = true;
+}
+
+bool SkTileGrid::remove(void* data, const SkIRect& bounds) {
+    SkIRect tiles;
+    if (bounds.isEmpty() || !this->getTileRange(bounds, &tiles)) {
+        return false;
+    }
+
+    for (int i = 0; i < fEntries.count(); ++i) {
+        Entry& entry = fEntries[i];
+        if (entry.fData == data && entry.fTiles == tiles) {
+            // Leave the entry in place, so that the later ones keep their indices.
+            entry.fTiles.fLeft = -1;
+            fInsertionCount--;
+            fTilesDirty = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SkTileGrid::flushDeferredInserts() {
+    this->buildTiles();
+}
+
+void SkTileGrid::buildTiles() {
+    if (!fTilesDirty) {
+        return;
+    }
+    fTilesDirty = false;
+
+    // Count the entries of each tile one slot along, so that summing the counts in place
+    // leaves each tile's start in its own slot.
+    fTileStarts.setCount(fTileCount + 1);
+    sk_bzero(fTileStarts.begin(), fTileStarts.bytes());
+    for (int i = 0; i < fEntries.count(); ++i) {
+        const SkIRect& tiles = fEntries[i].fTiles;
+        for (int y = tiles.fTop; tiles.fLeft >= 0 && y <= tiles.fBottom; y++) {
+            for (int x = tiles.fLeft; x <= tiles.fRight; x++) {
+                fTileStarts[y * fXTileCount + x + 1]++;
+            }
+        }
+    }
+    for (int t = 0; t < fTileCount; t++) {
+        fTileStarts[t + 1] += fTileStarts[t];
+    }
+
+    // Filling the tiles in insertion order leaves each one's indices ascending.
+    fTileEntries.setCount(fTileStarts[fTileCount]);
+    SkAutoTMalloc<uint32_t> next(fTileCount);
+    memcpy(next.get(), fTileStarts.begin(), fTileCount * sizeof(uint32_t));
+    for (int i = 0; i < fEntries.count(); ++i) {
+        const SkIRect& tiles = fEntries[i].fTiles;
+        for (int y = tiles.fTop; tiles.fLeft >= 0 && y <= tiles.fBottom; y++) {
+            for (int x = tiles.fLeft; x <= tiles.fRight; x++) {
+                fTileEntries[next[y * fXTileCount + x]++] = i;
+            }
+        }
+    }
 }
 
 void SkTileGrid::search(const SkIRect& query, SkTDArray<void*>* results) {
+    this->buildTiles();
+
     SkIRect adjustedQuery = query;
     // The inset is to counteract the outset that was applied in 'insert'
     // The outset/inset is to optimize for lookups of size
@@ -90,32 +157,71 @@ void SkTileGrid::search(const SkIRect& query, SkTDArray<void*>* results) {
 
     int queryTileCount = (tileEndX - tileStartX) * (tileEndY - tileStartY);
     SkASSERT(queryTileCount);
+    results->rewind();
     if (queryTileCount == 1) {
-        *results = this->tile(tileStartX, tileStartY);
+        const uint32_t* begin = this->tileBegin(tileStartX, tileStartY);
+        const uint32_t* end = this->tileEnd(tileStartX, tileStartY);
+        results->setCount(SkToInt(end - begin));
+        void** out = results->begin();
+        for (const uint32_t* index = begin; index < end; ++index) {
+            *out++ = fEntries[*index].fData;
+        }
+    } else if (queryTileCount <= kMaxMergeTiles) {
+        // Take the smallest index at the head of any tile until they are all done. An entry in
+        // several of the tiles is at the head of each of them at once.
+        const uint32_t* heads[kMaxMergeTiles];
+        const uint32_t* ends[kMaxMergeTiles];
+        int live = 0;
+        for (int y = tileStartY; y < tileEndY; ++y) {
+            for (int x = tileStartX; x < tileEndX; ++x) {
+                if (this->tileBegin(x, y) < this->tileEnd(x, y)) {
+                    heads[live] = this->tileBegin(x, y);
+                    ends[live] = this->tileEnd(x, y);
+                    live++;
+                }
+            }
+        }
+        while (live > 0) {
+            uint32_t next = *heads[0];
+            for (int t = 1; t < live; ++t) {
+                next = SkTMin(next, *heads[t]);
+            }
+            *results->append() = fEntries[next].fData;
+            for (int t = 0; t < live;) {
+                if (*heads[t] == next && ++heads[t] == ends[t]) {
+                    --live;
+                    heads[t] = heads[live];
+                    ends[t] = ends[live];
+                } else {
+                    ++t;
+                }
+            }
+        }
     } else {
-        results->reset();
-        SkAutoSTArray<kStackAllocationTileCount, int> curPositions(queryTileCount);
-        SkAutoSTArray<kStackAllocationTileCount, SkTDArray<void *>*> storage(queryTileCount);
-        SkTDArray<void *>** tileRange = storage.get();
-        int tile = 0;
-        for (int x = tileStartX; x < tileEndX; ++x) {
-            for (int y = tileStartY; y < tileEndY; ++y) {
-                tileRange[tile] = &this->tile(x, y);
-                curPositions[tile] = tileRange[tile]->count() ? 0 : kTileFinished;
-                ++tile;
+        SkTDArray<uint32_t> indices;
+        for (int y = tileStartY; y < tileEndY; ++y) {
+            for (int x = tileStartX; x < tileEndX; ++x) {
+                const uint32_t* begin = this->tileBegin(x, y);
+                indices.append(SkToInt(this->tileEnd(x, y) - begin), begin);
             }
         }
-        void *nextElement;
-        while(NULL != (nextElement = fNextDatumFunction(tileRange, curPositions))) {
-            results->push(nextElement);
+        if (indices.isEmpty()) {
+            return;
+        }
+        SkTQSort(indices.begin(), indices.end() - 1);
+        results->setReserve(indices.count());
+        for (int i = 0; i < indices.count(); ++i) {
+            if (0 == i || indices[i] != indices[i - 1]) {
+                *results->append() = fEntries[indices[i]].fData;
+            }
         }
     }
 }
 
 void SkTileGrid::clear() {
-    for (int i = 0; i < fTileCount; i++) {
-        fTileData[i].reset();
-    }
+    fEntries.reset();
+    fInsertionCount = 0;
+    fTilesDirty = true;
 }
 
 int SkTileGrid::getCount() const {
@@ -124,9 +230,15 @@ int SkTileGrid::getCount() const {
 
 void SkTileGrid::rewindInserts() {
     SkASSERT(fClient);
-    for (int i = 0; i < fTileCount; ++i) {
-        while (!fTileData[i].isEmpty() && fClient->shouldRewind(fTileData[i].top())) {
-            fTileData[i].pop();
+    while (!fEntries.isEmpty()) {
+        const Entry& entry = fEntries.top();
+        if (entry.fTiles.fLeft >= 0) {
+            if (!fClient->shouldRewind(entry.fData)) {
+                break;
+            }
+            fInsertionCount--;
         }
+        fEntries.pop();
+        fTilesDirty = true;
     }
 }
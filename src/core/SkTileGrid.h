@@ -11,7 +11,6 @@
 
 #include "SkBBHFactory.h"
 #include "SkBBoxHierarchy.h"
-#include "SkPictureStateTree.h"
 
 /**
  * Subclass of SkBBoxHierarchy that stores elements in buckets that correspond
@@ -19,24 +18,17 @@
  * structure that will be use in search() calls is known prior to insertion.
  * Calls to search will return in constant time.
  *
- * Note: Current implementation of search() only supports looking-up regions
- * that are an exact match to a single tile.  Implementation could be augmented
- * to support arbitrary rectangles, but performance would be sub-optimal.
+ * The buckets are kept compactly: each insertion gets a uint32_t index, in insertion order, and
+ * the indices of all the tiles live in one flat array, each tile's in ascending order, with an
+ * array of offsets marking where each tile starts. That array is built at the first search
+ * after any change, so inserting or removing in between searches costs a rebuild.
+ *
+ * Note: search() is fastest for regions that are an exact match to a single tile. Regions
+ * spanning several tiles merge their buckets, keeping insertion order.
  */
 class SkTileGrid : public SkBBoxHierarchy {
 public:
-    enum {
-        // Number of tiles for which data is allocated on the stack in
-        // SkTileGrid::search. If malloc becomes a bottleneck, we may consider
-        // increasing this number. Typical large web page, say 2k x 16k, would
-        // require 512 tiles of size 256 x 256 pixels.
-        kStackAllocationTileCount = 1024
-    };
-
-    typedef void* (*SkTileGridNextDatumFunctionPtr)(SkTDArray<void*>** tileData, SkAutoSTArray<kStackAllocationTileCount, int>& tileIndices);
-
-    SkTileGrid(int xTileCount, int yTileCount, const SkTileGridFactory::TileGridInfo& info,
-        SkTileGridNextDatumFunctionPtr nextDatumFunction);
+    SkTileGrid(int xTileCount, int yTileCount, const SkTileGridFactory::TileGridInfo& info);
 
     virtual ~SkTileGrid();
 
@@ -44,15 +36,21 @@ public:
      * Insert a data pointer and corresponding bounding box
      * @param data The data pointer, may be NULL
      * @param bounds The bounding box, should not be empty
-     * @param defer Ignored, TileArray does not defer insertions
+     * @param defer Ignored, as every insert is held until the next search
      */
     virtual void insert(void* data, const SkIRect& bounds, bool) SK_OVERRIDE;
 
-    virtual void flushDeferredInserts() SK_OVERRIDE {};
+    /**
+     * Data inserted after a removal still go after everything already in their tiles, so
+     * inserting data that must come earlier than existing data breaks search() ordering.
+     */
+    virtual bool remove(void* data, const SkIRect& bounds) SK_OVERRIDE;
+
+    virtual void flushDeferredInserts() SK_OVERRIDE;
 
     /**
-     * Populate 'results' with data pointers corresponding to bounding boxes that intersect 'query'
-     * The query argument is expected to be an exact match to a tile of the grid
+     * Populate 'results' with data pointers corresponding to bounding boxes that intersect
+     * 'query', in the order they were inserted.
      */
     virtual void search(const SkIRect& query, SkTDArray<void*>* results) SK_OVERRIDE;
 
@@ -67,76 +65,39 @@ public:
 
     virtual void rewindInserts() SK_OVERRIDE;
 
-    // Used by search() and in SkTileGridHelper implementations
-    enum {
-        kTileFinished = -1,
-    };
-
     int tileCount(int x, int y);  // For testing only.
 
 private:
-    SkTDArray<void*>& tile(int x, int y);
+    struct Entry {
+        void*   fData;
+        SkIRect fTiles;     // The inclusive range of tiles it went in. fLeft is -1 once removed.
+    };
+
+    // Finds the inclusive range of tiles that bounds touches, returning false if none.
+    bool getTileRange(const SkIRect& bounds, SkIRect* tiles) const;
+
+    // Rebuilds fTileStarts and fTileEntries from fEntries, if they are out of date.
+    void buildTiles();
+
+    // The tile's span of fTileEntries.
+    const uint32_t* tileBegin(int x, int y) const {
+        return fTileEntries.begin() + fTileStarts[y * fXTileCount + x];
+    }
+    const uint32_t* tileEnd(int x, int y) const {
+        return fTileEntries.begin() + fTileStarts[y * fXTileCount + x + 1];
+    }
 
     int fXTileCount, fYTileCount, fTileCount;
     SkTileGridFactory::TileGridInfo fInfo;
-    SkTDArray<void*>* fTileData;
     int fInsertionCount;
     SkIRect fGridBounds;
-    SkTileGridNextDatumFunctionPtr fNextDatumFunction;
+
+    SkTDArray<Entry>    fEntries;       // Indexed by insertion.
+    SkTDArray<uint32_t> fTileStarts;    // fTileCount + 1 offsets into fTileEntries.
+    SkTDArray<uint32_t> fTileEntries;   // Indices into fEntries, tile by tile.
+    bool                fTilesDirty;
 
     typedef SkBBoxHierarchy INHERITED;
 };
 
-/**
- * Generic implementation for SkTileGridNextDatumFunctionPtr. user code may instantiate
- * this template to get a valid SkTileGridNextDatumFunction implementation
- *
- * Returns the next element of tileData[i][tileIndices[i]] for all i and advances
- * tileIndices[] past them. The order in which data are returned by successive
- * calls to this method must reflect the order in which the were originally
- * recorded into the tile grid.
- *
- * \param tileData array of pointers to arrays of tile data
- * \param tileIndices per-tile data indices, indices are incremented for tiles that contain
- *     the next datum.
- * \tparam T a type to which it is safe to cast a datum and that has an operator <
- *     such that 'a < b' is true if 'a' was inserted into the tile grid before 'b'.
- */
-template <typename T>
-void* SkTileGridNextDatum(SkTDArray<void*>** tileData, SkAutoSTArray<SkTileGrid::kStackAllocationTileCount, int>& tileIndices) {
-    T* minVal = NULL;
-    int tileCount = tileIndices.count();
-    int minIndex = tileCount;
-    int maxIndex = 0;
-    // Find the next Datum; track where it's found so we reduce the size of the second loop.
-    for (int tile = 0; tile < tileCount; ++tile) {
-        int pos = tileIndices[tile];
-        if (pos != SkTileGrid::kTileFinished) {
-            T* candidate = (T*)(*tileData[tile])[pos];
-            if (NULL == minVal || (*candidate) < (*minVal)) {
-                minVal = candidate;
-                minIndex = tile;
-                maxIndex = tile;
-            } else if (!((*minVal) < (*candidate))) {
-                // We don't require operator==; if !(candidate<minVal) && !(minVal<candidate),
-                // candidate==minVal and we have to add this tile to the range searched.
-                maxIndex = tile;
-            }
-        }
-    }
-    // Increment indices past the next datum
-    if (minVal != NULL) {
-        for (int tile = minIndex; tile <= maxIndex; ++tile) {
-            int pos = tileIndices[tile];
-            if (pos != SkTileGrid::kTileFinished && (*tileData[tile])[pos] == minVal) {
-                if (++(tileIndices[tile]) >= tileData[tile]->count()) {
-                    tileIndices[tile] = SkTileGrid::kTileFinished;
-                }
-            }
-        }
-        return minVal;
-    }
-    return NULL;
-}
-
 #endif
@@ -6,6 +6,8 @@
  */
 
 #include "SkAdvancedTypefaceMetrics.h"
+#include "SkData.h"
+#include "SkFontDataCache.h"
 #include "SkFontDescriptor.h"
 #include "SkFontHost.h"
 #include "SkLazyPtr.h"
@@ -169,11 +171,11 @@ SkTypeface* SkTypeface::Deserialize(SkStream* stream) {
     if (length > 0) {
         void* addr = sk_malloc_flags(length, 0);
         if (addr) {
-            SkAutoTUnref<SkMemoryStream> localStream(SkNEW(SkMemoryStream));
-            localStream->setMemoryOwned(addr, length);
+            SkAutoTUnref<SkData> data(SkData::NewFromMalloc(addr, length));
 
             if (stream->read(addr, length) == length) {
-                return SkTypeface::CreateFromStream(localStream.get());
+                // Share one typeface, and so one glyph cache, among all the copies of this font.
+                return SkFontDataCache::FindOrCreate(data.get());
             } else {
                 // Failed to read the full font data, so fall through and try to create from name.
                 // If this is because of EOF, all subsequent reads from the stream will be EOF.
@@ -9,34 +9,56 @@
 
 
 #include "SkTypefaceCache.h"
+#include "SkChecksum.h"
 #include "SkThread.h"
 
 #define TYPEFACE_CACHE_LIMIT    1024
 
+// Past this, a typeface's extra names are not recorded; lookups for them fall
+// back to the port's (slower) matching. This bounds the cache when many
+// unknown names all resolve to the same fallback typeface.
+static const int kMaxNamesPerTypeface = 16;
+
+SkTypefaceCache::NameKey::NameKey(const char familyName[], SkTypeface::Style style)
+    : fFamilyName(familyName)
+    , fStyle(style) {
+    // Murmur3 wants whole words; copy the name so the padding is zero.
+    size_t words = (fFamilyName.size() + 3) >> 2;
+    SkAutoSTMalloc<64, uint32_t> storage(words);
+    sk_bzero(storage.get(), words << 2);
+    memcpy(storage.get(), fFamilyName.c_str(), fFamilyName.size());
+    fHash = SkChecksum::Murmur3(storage.get(), words << 2, fStyle);
+}
+
 SkTypefaceCache::SkTypefaceCache() {}
 
 SkTypefaceCache::~SkTypefaceCache() {
-    const Rec* curr = fArray.begin();
-    const Rec* stop = fArray.end();
-    while (curr < stop) {
-        if (curr->fStrong) {
-            curr->fFace->unref();
-        } else {
-            curr->fFace->weak_unref();
-        }
-        curr += 1;
+    while (fArray.count() > 0) {
+        this->remove(fArray.count() - 1);
     }
 }
 
 void SkTypefaceCache::add(SkTypeface* face,
                           SkTypeface::Style requestedStyle,
                           bool strong) {
+    Rec* rec = fIDHash.find(face->uniqueID());
+    if (NULL != rec) {
+        // Already cached; just make sure we hold the kind of ref asked for.
+        if (strong && !rec->fStrong) {
+            face->ref();
+            face->weak_unref();
+            rec->fStrong = true;
+        }
+        return;
+    }
+
     if (fArray.count() >= TYPEFACE_CACHE_LIMIT) {
         this->purge(TYPEFACE_CACHE_LIMIT >> 2);
     }
 
-    Rec* rec = fArray.append();
+    rec = SkNEW(Rec);
     rec->fFace = face;
+    rec->fFontID = face->uniqueID();
     rec->fRequestedStyle = requestedStyle;
     rec->fStrong = strong;
     if (strong) {
@@ -44,53 +66,94 @@ void SkTypefaceCache::add(SkTypeface* face,
     } else {
         face->weak_ref();
     }
+    *fArray.append() = rec;
+    fIDHash.add(rec);
+}
+
+void SkTypefaceCache::addName(SkTypeface* face, const char familyName[],
+                              SkTypeface::Style requestedStyle) {
+    Rec* rec = fIDHash.find(face->uniqueID());
+    SkASSERT(NULL != rec);
+    if (NULL == rec || NULL == familyName || rec->fNames.count() >= kMaxNamesPerTypeface) {
+        return;
+    }
+
+    NameKey key(familyName, requestedStyle);
+    NameRec* nameRec = fNameHash.find(key);
+    if (NULL != nameRec) {
+        // First come, first served, as with findByProcAndRef().
+        return;
+    }
+    nameRec = SkNEW_ARGS(NameRec, (key, rec));
+    *rec->fNames.append() = nameRec;
+    fNameHash.add(nameRec);
 }
 
 SkTypeface* SkTypefaceCache::findByID(SkFontID fontID) const {
-    const Rec* curr = fArray.begin();
-    const Rec* stop = fArray.end();
-    while (curr < stop) {
-        if (curr->fFace->uniqueID() == fontID) {
-            return curr->fFace;
-        }
-        curr += 1;
+    const Rec* rec = fIDHash.find(fontID);
+    return NULL != rec ? rec->fFace : NULL;
+}
+
+SkTypeface* SkTypefaceCache::refRec(const Rec* rec) const {
+    SkTypeface* face = rec->fFace;
+    if (rec->fStrong) {
+        face->ref();
+        return face;
     }
-    return NULL;
+    return face->try_ref() ? face : NULL;
 }
 
 SkTypeface* SkTypefaceCache::findByProcAndRef(FindProc proc, void* ctx) const {
-    const Rec* curr = fArray.begin();
-    const Rec* stop = fArray.end();
+    Rec* const* curr = fArray.begin();
+    Rec* const* stop = fArray.end();
     while (curr < stop) {
-        SkTypeface* currFace = curr->fFace;
-        if (proc(currFace, curr->fRequestedStyle, ctx)) {
-            if (curr->fStrong) {
-                currFace->ref();
-                return currFace;
-            } else if (currFace->try_ref()) {
-                return currFace;
-            } else {
-                //remove currFace from fArray?
+        const Rec* rec = *curr;
+        if (proc(rec->fFace, rec->fRequestedStyle, ctx)) {
+            SkTypeface* face = this->refRec(rec);
+            if (NULL != face) {
+                return face;
             }
+            //remove currFace from fArray?
         }
         curr += 1;
     }
     return NULL;
 }
 
+SkTypeface* SkTypefaceCache::findByNameAndRef(const char familyName[],
+                                              SkTypeface::Style requestedStyle) const {
+    if (NULL == familyName) {
+        return NULL;
+    }
+    const NameRec* nameRec = fNameHash.find(NameKey(familyName, requestedStyle));
+    return NULL != nameRec ? this->refRec(nameRec->fRec) : NULL;
+}
+
+void SkTypefaceCache::remove(int index) {
+    Rec* rec = fArray[index];
+    for (int i = 0; i < rec->fNames.count(); ++i) {
+        fNameHash.remove(rec->fNames[i]->fKey);
+        SkDELETE(rec->fNames[i]);
+    }
+    fIDHash.remove(rec->fFontID);
+    fArray.remove(index);
+
+    if (rec->fStrong) {
+        rec->fFace->unref();
+    } else {
+        rec->fFace->weak_unref();
+    }
+    SkDELETE(rec);
+}
+
 void SkTypefaceCache::purge(int numToPurge) {
     int count = fArray.count();
     int i = 0;
     while (i < count) {
-        SkTypeface* face = fArray[i].fFace;
-        bool strong = fArray[i].fStrong;
+        SkTypeface* face = fArray[i]->fFace;
+        bool strong = fArray[i]->fStrong;
         if ((strong && face->unique()) || (!strong && face->weak_expired())) {
-            if (strong) {
-                face->unref();
-            } else {
-                face->weak_unref();
-            }
-            fArray.remove(i);
+            this->remove(i);
             --count;
             if (--numToPurge == 0) {
                 return;
@@ -137,6 +200,18 @@ SkTypeface* SkTypefaceCache::FindByProcAndRef(FindProc proc, void* ctx) {
     return typeface;
 }
 
+void SkTypefaceCache::AddName(SkTypeface* face, const char familyName[],
+                              SkTypeface::Style requestedStyle) {
+    SkAutoMutexAcquire ama(gMutex);
+    Get().addName(face, familyName, requestedStyle);
+}
+
+SkTypeface* SkTypefaceCache::FindByNameAndRef(const char familyName[],
+                                              SkTypeface::Style requestedStyle) {
+    SkAutoMutexAcquire ama(gMutex);
+    return Get().findByNameAndRef(familyName, requestedStyle);
+}
+
 void SkTypefaceCache::PurgeAll() {
     SkAutoMutexAcquire ama(gMutex);
     Get().purgeAll();
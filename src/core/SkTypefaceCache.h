@@ -11,14 +11,15 @@
 #ifndef SkTypefaceCache_DEFINED
 #define SkTypefaceCache_DEFINED
 
-#include "SkTypeface.h"
+#include "SkString.h"
 #include "SkTDArray.h"
+#include "SkTDynamicHash.h"
+#include "SkTypeface.h"
 
-/*  TODO
- *  Provide std way to cache name+requestedStyle aliases to the same typeface.
- *
- *  The current mechanism ends up create a diff typeface for each one, even if
- *  they map to the same internal obj (e.g. CTFontRef on the mac)
+/*  Typefaces are indexed by fontID, and by any number of name+requestedStyle
+ *  aliases registered with addName(), so that the common lookups are hashed.
+ *  findByProcAndRef() still visits every typeface, for ports that match on
+ *  something else.
  */
 
 class SkTypefaceCache {
@@ -41,6 +42,14 @@ public:
      */
     void add(SkTypeface*, SkTypeface::Style requested, bool strong = true);
 
+    /**
+     *  Records that familyName+requested resolves to the given typeface, which
+     *  must already have been added. A typeface may have several such names
+     *  (e.g. the name that was asked for and the one it was matched to), up
+     *  to a small limit past which further names are ignored.
+     */
+    void addName(SkTypeface*, const char familyName[], SkTypeface::Style requested);
+
     /**
      *  Search the cache for a typeface with the specified fontID (uniqueID).
      *  If one is found, return it (its reference count is unmodified). If none
@@ -56,6 +65,12 @@ public:
      */
     SkTypeface* findByProcAndRef(FindProc proc, void* ctx) const;
 
+    /**
+     *  Returns the typeface recorded with addName() for familyName+requested,
+     *  ref()ed, or NULL if there is none (or it has since been deleted).
+     */
+    SkTypeface* findByNameAndRef(const char familyName[], SkTypeface::Style requested) const;
+
     /**
      *  This will unref all of the typefaces in the cache for which the cache
      *  is the only owner. Normally this is handled automatically as needed.
@@ -77,6 +92,8 @@ public:
                     bool strong = true);
     static SkTypeface* FindByID(SkFontID fontID);
     static SkTypeface* FindByProcAndRef(FindProc proc, void* ctx);
+    static void AddName(SkTypeface*, const char familyName[], SkTypeface::Style requested);
+    static SkTypeface* FindByNameAndRef(const char familyName[], SkTypeface::Style requested);
     static void PurgeAll();
 
     /**
@@ -89,12 +106,48 @@ private:
 
     void purge(int count);
 
+    struct NameRec;
+
     struct Rec {
+        static const SkFontID& GetKey(const Rec& rec) { return rec.fFontID; }
+        static uint32_t Hash(const SkFontID& fontID) { return fontID; }
+
         SkTypeface*         fFace;
+        SkFontID            fFontID;
         bool                fStrong;
         SkTypeface::Style   fRequestedStyle;
+        SkTDArray<NameRec*> fNames;
     };
-    SkTDArray<Rec> fArray;
+
+    struct NameKey {
+        NameKey(const char familyName[], SkTypeface::Style style);
+
+        bool operator==(const NameKey& other) const {
+            return fHash == other.fHash && fStyle == other.fStyle &&
+                   fFamilyName == other.fFamilyName;
+        }
+
+        SkString            fFamilyName;
+        SkTypeface::Style   fStyle;
+        uint32_t            fHash;
+    };
+
+    struct NameRec {
+        NameRec(const NameKey& key, Rec* rec) : fKey(key), fRec(rec) {}
+
+        static const NameKey& GetKey(const NameRec& rec) { return rec.fKey; }
+        static uint32_t Hash(const NameKey& key) { return key.fHash; }
+
+        const NameKey   fKey;
+        Rec*            fRec;
+    };
+
+    SkTypeface* refRec(const Rec*) const;
+    void remove(int index);
+
+    SkTDArray<Rec*>                     fArray;     // in the order added
+    SkTDynamicHash<Rec, SkFontID>       fIDHash;
+    SkTDynamicHash<NameRec, NameKey>    fNameHash;
 };
 
 #endif
@@ -54,11 +54,14 @@ const void* SkValidatingReadBuffer::skip(size_t size) {
 // followed by a memcpy. So we've got all our validation in readInt(), readScalar() and skip();
 // if they fail they'll return a zero value or skip nothing, respectively, and set fError to
 // true, which the caller should check to see if an error occurred during the read operation.
+// On the success path readInt() and readScalar() check inline and skip the virtual validate().
 
 bool SkValidatingReadBuffer::readBool() {
     uint32_t value = this->readInt();
     // Boolean value should be either 0 or 1
-    this->validate(!(value & ~1));
+    if (value & ~1) {
+        this->validate(false);
+    }
     return value != 0;
 }
 
@@ -71,15 +74,19 @@ SkFixed SkValidatingReadBuffer::readFixed() {
 }
 
 int32_t SkValidatingReadBuffer::readInt() {
-    const size_t inc = sizeof(int32_t);
-    this->validate(IsPtrAlign4(fReader.peek()) && fReader.isAvailable(inc));
-    return fError ? 0 : fReader.readInt();
+    if (IsPtrAlign4(fReader.peek()) && fReader.isAvailable(sizeof(int32_t))) {
+        return fReader.readInt();
+    }
+    this->validate(false);
+    return 0;
 }
 
 SkScalar SkValidatingReadBuffer::readScalar() {
-    const size_t inc = sizeof(SkScalar);
-    this->validate(IsPtrAlign4(fReader.peek()) && fReader.isAvailable(inc));
-    return fError ? 0 : fReader.readScalar();
+    if (IsPtrAlign4(fReader.peek()) && fReader.isAvailable(sizeof(SkScalar))) {
+        return fReader.readScalar();
+    }
+    this->validate(false);
+    return 0;
 }
 
 uint32_t SkValidatingReadBuffer::readUInt() {
@@ -120,8 +127,12 @@ void* SkValidatingReadBuffer::readEncodedString(size_t* length, SkPaint::TextEnc
 }
 
 void SkValidatingReadBuffer::readPoint(SkPoint* point) {
-    point->fX = this->readScalar();
-    point->fY = this->readScalar();
+    const void* ptr = this->skip(sizeof(SkPoint));
+    if (!fError) {
+        memcpy(point, ptr, sizeof(SkPoint));
+    } else {
+        point->set(0, 0);
+    }
 }
 
 void SkValidatingReadBuffer::readMatrix(SkMatrix* matrix) {
@@ -205,8 +216,7 @@ bool SkValidatingReadBuffer::readScalarArray(SkScalar* values, size_t size) {
 }
 
 uint32_t SkValidatingReadBuffer::getArrayCount() {
-    const size_t inc = sizeof(uint32_t);
-    fError = fError || !IsPtrAlign4(fReader.peek()) || !fReader.isAvailable(inc);
+    this->validate(IsPtrAlign4(fReader.peek()) && fReader.isAvailable(sizeof(uint32_t)));
     return fError ? 0 : *(uint32_t*)fReader.peek();
 }
 
@@ -241,7 +251,11 @@ SkFlattenable* SkValidatingReadBuffer::readFlattenable(SkFlattenable::Type type)
     // if we get here, factory may still be null, but if that is the case, the
     // failure was ours, not the writer.
     SkFlattenable* obj = NULL;
+    // Check the recorded size up front, so truncated data is rejected before the factory runs.
     uint32_t sizeRecorded = this->readUInt();
+    if (!this->validate(SkIsAlign4(sizeRecorded) && fReader.isAvailable(sizeRecorded))) {
+        return NULL;
+    }
     if (factory) {
         size_t offset = fReader.offset();
         obj = (*factory)(*this);
@@ -63,21 +63,154 @@ size_t SkWriter32::WriteStringSize(const char* str, size_t len) {
     return SkAlign4(lenBytes + len + 1);
 }
 
-void SkWriter32::growToAtLeast(size_t size) {
-    const bool wasExternal = (fExternal != NULL) && (fData == fExternal);
+SkWriter32::~SkWriter32() {
+    for (int i = 0; i < fSegments.count(); ++i) {
+        if (this->isOwned(fSegments[i])) {
+            sk_free(fSegments[i].fData);
+        }
+    }
+    sk_free(fSpare);
+}
 
-    fCapacity = 4096 + SkTMax(size, fCapacity + (fCapacity / 2));
-    fInternal.realloc(fCapacity);
-    fData = fInternal.get();
+void SkWriter32::reset(void* external, size_t externalBytes) {
+    SkASSERT(SkIsAlign4((uintptr_t)external));
+    SkASSERT(SkIsAlign4(externalBytes));
 
-    if (wasExternal) {
-        // we were external, so copy in the data
-        memcpy(fData, fExternal, fUsed);
+    fSnapshot.reset(NULL);
+    for (int i = 0; i < fSegments.count(); ++i) {
+        if (this->isOwned(fSegments[i])) {
+            this->recycle(fSegments[i]);
+        }
     }
+    fSegments.rewind();
+    fExternal = external;
+    if (external != NULL) {
+        Segment* segment = fSegments.append();
+        segment->fData = (uint8_t*)external;
+        segment->fOffset = 0;
+        segment->fCapacity = externalBytes;
+    }
+    fUsed = 0;
+    this->setCurrentSegment();
+}
+
+void SkWriter32::setCurrentSegment() {
+    if (fSegments.isEmpty()) {
+        fData = NULL;
+        fDataOffset = 0;
+        fCapacity = 0;
+    } else {
+        fData = fSegments.top().fData;
+        fDataOffset = fSegments.top().fOffset;
+        fCapacity = fSegments.top().fCapacity;
+    }
+}
+
+void SkWriter32::recycle(const Segment& segment) {
+    SkASSERT(this->isOwned(segment));
+    // Keep the largest, so that a writer that is reset and refilled stops allocating.
+    if (segment.fCapacity > fSpareCapacity) {
+        sk_free(fSpare);
+        fSpare = segment.fData;
+        fSpareCapacity = segment.fCapacity;
+    } else {
+        sk_free(segment.fData);
+    }
+}
+
+void SkWriter32::growToAtLeast(size_t size) {
+    // An empty segment would only be in the way of lookups.
+    if (!fSegments.isEmpty() && fUsed == fDataOffset) {
+        if (this->isOwned(fSegments.top())) {
+            this->recycle(fSegments.top());
+        }
+        fSegments.pop();
+    }
+
+    // Each segment is about half of what came before it, so there are O(log n) of them, and
+    // nothing already written is copied.
+    const size_t capacity = SkTMax(size, 4096 + fUsed / 2);
+    Segment* segment = fSegments.append();
+    segment->fOffset = fUsed;
+    if (fSpare != NULL && fSpareCapacity >= capacity) {
+        segment->fData = fSpare;
+        segment->fCapacity = fSpareCapacity;
+        fSpare = NULL;
+        fSpareCapacity = 0;
+    } else {
+        segment->fData = (uint8_t*)sk_malloc_throw(capacity);
+        segment->fCapacity = capacity;
+    }
+    this->setCurrentSegment();
+
     // Invalidate the snapshot, we know it is no longer useful.
     fSnapshot.reset(NULL);
 }
 
+uint8_t* SkWriter32::findInSegments(size_t offset, size_t size) const {
+    // Find the last segment that starts at or before offset.
+    int lo = 0;
+    int hi = fSegments.count() - 1;
+    while (lo < hi) {
+        const int mid = (lo + hi + 1) >> 1;
+        if (fSegments[mid].fOffset <= offset) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    const Segment& segment = fSegments[lo];
+    SkASSERT(offset + size <= segment.fOffset + this->segmentBytes(lo));
+    return segment.fData + (offset - segment.fOffset);
+}
+
+void SkWriter32::dropSegmentsAfter(size_t offset) {
+    while (fSegments.count() > 1 && fSegments.top().fOffset >= offset) {
+        if (this->isOwned(fSegments.top())) {
+            this->recycle(fSegments.top());
+        }
+        fSegments.pop();
+    }
+    this->setCurrentSegment();
+}
+
+void SkWriter32::joinSegments() {
+    SkASSERT(fSegments.count() > 1);
+    const Segment& first = fSegments[0];
+    uint8_t* data;
+    if (this->isOwned(first)) {
+        // Where the allocator can grow the first segment in place, it is not copied at all.
+        data = (uint8_t*)sk_realloc_throw(first.fData, fUsed);
+    } else {
+        data = (uint8_t*)sk_malloc_throw(fUsed);
+        memcpy(data, first.fData, this->segmentBytes(0));
+    }
+    // Free the rest as we go, so the data is held twice only one segment at a time.
+    for (int i = 1; i < fSegments.count(); ++i) {
+        memcpy(data + fSegments[i].fOffset, fSegments[i].fData, this->segmentBytes(i));
+        sk_free(fSegments[i].fData);
+    }
+    fSegments.setCount(1);
+    fSegments[0].fData = data;
+    fSegments[0].fCapacity = fUsed;
+    this->setCurrentSegment();
+}
+
+void SkWriter32::flatten(void* dst) const {
+    for (int i = 0; i < fSegments.count(); ++i) {
+        memcpy((uint8_t*)dst + fSegments[i].fOffset, fSegments[i].fData, this->segmentBytes(i));
+    }
+}
+
+bool SkWriter32::writeToStream(SkWStream* stream) const {
+    for (int i = 0; i < fSegments.count(); ++i) {
+        if (!stream->write(fSegments[i].fData, this->segmentBytes(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
 SkData* SkWriter32::snapshotAsData() const {
     // get a non const version of this, we are only conceptually const
     SkWriter32& mutable_this = *const_cast<SkWriter32*>(this);
@@ -86,18 +219,23 @@ SkData* SkWriter32::snapshotAsData() const {
         mutable_this.fSnapshot.reset(NULL);
     }
     if (fSnapshot.get() == NULL) {
+        if (fSegments.count() > 1) {
+            mutable_this.joinSegments();
+        }
         uint8_t* buffer = NULL;
-        if ((fExternal != NULL) && (fData == fExternal)) {
+        if (fSegments.isEmpty() || !this->isOwned(fSegments[0])) {
             // We need to copy to an allocated buffer before returning.
             buffer = (uint8_t*)sk_malloc_throw(fUsed);
-            memcpy(buffer, fData, fUsed);
+            if (fUsed > 0) {
+                memcpy(buffer, fData, fUsed);
+            }
         } else {
-            buffer = mutable_this.fInternal.detach();
+            buffer = fSegments[0].fData;
             // prepare us to do copy on write, by pretending the data buffer
             // is external and size limited
-            mutable_this.fData = buffer;
-            mutable_this.fCapacity = fUsed;
+            mutable_this.fSegments[0].fCapacity = fUsed;
             mutable_this.fExternal = buffer;
+            mutable_this.setCurrentSegment();
         }
         mutable_this.fSnapshot.reset(SkData::NewFromMalloc(buffer, fUsed));
     }
@@ -17,7 +17,7 @@ public:
             : SkDocument(stream, doneProc)
             , fEncoder(encoder)
             , fRasterDpi(rasterDpi) {
-        fDoc = SkNEW(SkPDFDocument);
+        fDoc = SkNEW_ARGS(SkPDFDocument, (stream));
         fCanvas = NULL;
         fDevice = NULL;
     }
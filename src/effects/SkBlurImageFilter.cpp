@@ -7,8 +7,11 @@
 
 #include "SkBitmap.h"
 #include "SkBlurImageFilter.h"
+#include "SkBlurMask.h"
 #include "SkColorPriv.h"
+#include "SkGraphics.h"
 #include "SkReadBuffer.h"
+#include "SkTaskGroup.h"
 #include "SkWriteBuffer.h"
 #include "SkGpuBlurUtils.h"
 #include "SkBlurImage_opts.h"
@@ -140,6 +143,132 @@ static void getBox3Params(SkScalar s, int *kernelSize, int* kernelSize3, int *lo
     }
 }
 
+// Smaller images are blurred on the calling thread, where handing bands to other threads would
+// cost more than it saves.
+static const int kMinThreadedBlurPixels = 256 * 256;
+
+// The rows in each band of a threaded pass. A band transposed into dst fills one cache line
+// of each dst row it touches.
+static const int kBandRows = 16;
+
+// Copies the rows x width block src into dst transposed, with the rows of dst dstStride
+// apart. Goes through a few columns of src at a time so that the dst rows being written
+// stay in cache.
+static void transpose_block(const SkPMColor* src, int width, int rows,
+                            SkPMColor* dst, int dstStride) {
+    static const int kTileWidth = 16;
+    for (int left = 0; left < width; left += kTileWidth) {
+        int right = SkMin32(left + kTileWidth, width);
+        for (int y = 0; y < rows; ++y) {
+            const SkPMColor* sptr = src + y * width;
+            SkPMColor* dptr = dst + y;
+            for (int x = left; x < right; ++x) {
+                dptr[x * dstStride] = sptr[x];
+            }
+        }
+    }
+}
+
+namespace {
+
+/**
+ * The bands of one threaded pass. srcRowStep is the distance between the rows the pass reads:
+ * the stride when it reads rows of src, 1 when it reads columns.
+ */
+class BoxBlurBands : public SkParallelForBody {
+public:
+    BoxBlurBands(SkBoxBlurProc proc, const SkPMColor* src, int srcStride, int srcRowStep,
+                 SkPMColor* dst, int kernelSize, int leftOffset, int rightOffset,
+                 int width, int height, bool transpose)
+        : fProc(proc), fSrc(src), fSrcStride(srcStride), fSrcRowStep(srcRowStep), fDst(dst)
+        , fKernelSize(kernelSize), fLeftOffset(leftOffset), fRightOffset(rightOffset)
+        , fWidth(width), fHeight(height), fTranspose(transpose) {}
+
+    virtual void run(int band) SK_OVERRIDE {
+        const int top = band * kBandRows;
+        const int rows = SkMin32(kBandRows, fHeight - top);
+        const SkPMColor* src = fSrc + top * fSrcRowStep;
+        if (fTranspose) {
+            SkAutoTMalloc<SkPMColor> block(fWidth * rows);
+            fProc(src, fSrcStride, block.get(), fKernelSize, fLeftOffset, fRightOffset,
+                  fWidth, rows);
+            transpose_block(block.get(), fWidth, rows, fDst + top, fHeight);
+        } else {
+            fProc(src, fSrcStride, fDst + top * fWidth, fKernelSize, fLeftOffset, fRightOffset,
+                  fWidth, rows);
+        }
+    }
+
+private:
+    SkBoxBlurProc    fProc;
+    const SkPMColor* fSrc;
+    int              fSrcStride;
+    int              fSrcRowStep;
+    SkPMColor*       fDst;
+    int              fKernelSize;
+    int              fLeftOffset;
+    int              fRightOffset;
+    int              fWidth;
+    int              fHeight;
+    bool             fTranspose;
+};
+
+/**
+ * Runs the passes of a blur on the calling thread when group is NULL, and otherwise split
+ * into bands of rows on the group, one pass after the other. The procs can only transpose a
+ * whole image, so a threaded X to Y pass blurs each band in X into a block of its own and
+ * transposes that.
+ */
+class BoxBlurPasses {
+public:
+    BoxBlurPasses(SkTaskGroup* group, SkBoxBlurProc boxBlurX, SkBoxBlurProc boxBlurXY,
+                  SkBoxBlurProc boxBlurYX)
+        : fGroup(group), fBoxBlurX(boxBlurX), fBoxBlurXY(boxBlurXY), fBoxBlurYX(boxBlurYX) {}
+
+    void blurX(const SkPMColor* src, int srcStride, SkPMColor* dst, int kernelSize,
+               int leftOffset, int rightOffset, int width, int height) {
+        this->blur(fBoxBlurX, srcStride, false,
+                   src, srcStride, dst, kernelSize, leftOffset, rightOffset, width, height);
+    }
+
+    void blurXY(const SkPMColor* src, int srcStride, SkPMColor* dst, int kernelSize,
+                int leftOffset, int rightOffset, int width, int height) {
+        if (NULL == fGroup) {
+            fBoxBlurXY(src, srcStride, dst, kernelSize, leftOffset, rightOffset, width, height);
+            return;
+        }
+        this->blur(fBoxBlurX, srcStride, true,
+                   src, srcStride, dst, kernelSize, leftOffset, rightOffset, width, height);
+    }
+
+    void blurYX(const SkPMColor* src, int srcStride, SkPMColor* dst, int kernelSize,
+                int leftOffset, int rightOffset, int width, int height) {
+        this->blur(fBoxBlurYX, 1, false,
+                   src, srcStride, dst, kernelSize, leftOffset, rightOffset, width, height);
+    }
+
+private:
+    void blur(SkBoxBlurProc proc, int srcRowStep, bool transpose,
+              const SkPMColor* src, int srcStride, SkPMColor* dst, int kernelSize,
+              int leftOffset, int rightOffset, int width, int height) {
+        if (NULL == fGroup) {
+            proc(src, srcStride, dst, kernelSize, leftOffset, rightOffset, width, height);
+            return;
+        }
+        BoxBlurBands bands(proc, src, srcStride, srcRowStep, dst, kernelSize,
+                           leftOffset, rightOffset, width, height, transpose);
+        fGroup->parallelFor(0, (height + kBandRows - 1) / kBandRows, &bands);
+        fGroup->wait();
+    }
+
+    SkTaskGroup*  fGroup;
+    SkBoxBlurProc fBoxBlurX;
+    SkBoxBlurProc fBoxBlurXY;
+    SkBoxBlurProc fBoxBlurYX;
+};
+
+}  // namespace
+
 bool SkBlurImageFilter::onFilterImage(Proxy* proxy,
                                       const SkBitmap& source, const Context& ctx,
                                       SkBitmap* dst, SkIPoint* offset) const {
@@ -210,21 +339,28 @@ bool SkBlurImageFilter::onFilterImage(Proxy* proxy,
         boxBlurYX = boxBlur<kY, kX>;
     }
 
+    SkAutoTDelete<SkTaskGroup> group;
+    const int threadCount = SkGraphics::GetBlurThreadCount();
+    if ((threadCount < 0 || threadCount > 1) && w * h >= kMinThreadedBlurPixels) {
+        group.reset(SkNEW_ARGS(SkTaskGroup, (SkBlurMask::GetThreadPool())));
+    }
+    BoxBlurPasses passes(group.get(), boxBlurX, boxBlurXY, boxBlurYX);
+
     if (kernelSizeX > 0 && kernelSizeY > 0) {
-        boxBlurX(s,  sw, t, kernelSizeX,  lowOffsetX,  highOffsetX, w, h);
-        boxBlurX(t,  w,  d, kernelSizeX,  highOffsetX, lowOffsetX,  w, h);
-        boxBlurXY(d, w,  t, kernelSizeX3, highOffsetX, highOffsetX, w, h);
-        boxBlurX(t,  h,  d, kernelSizeY,  lowOffsetY,  highOffsetY, h, w);
-        boxBlurX(d,  h,  t, kernelSizeY,  highOffsetY, lowOffsetY,  h, w);
-        boxBlurXY(t, h,  d, kernelSizeY3, highOffsetY, highOffsetY, h, w);
+        passes.blurX(s,  sw, t, kernelSizeX,  lowOffsetX,  highOffsetX, w, h);
+        passes.blurX(t,  w,  d, kernelSizeX,  highOffsetX, lowOffsetX,  w, h);
+        passes.blurXY(d, w,  t, kernelSizeX3, highOffsetX, highOffsetX, w, h);
+        passes.blurX(t,  h,  d, kernelSizeY,  lowOffsetY,  highOffsetY, h, w);
+        passes.blurX(d,  h,  t, kernelSizeY,  highOffsetY, lowOffsetY,  h, w);
+        passes.blurXY(t, h,  d, kernelSizeY3, highOffsetY, highOffsetY, h, w);
     } else if (kernelSizeX > 0) {
-        boxBlurX(s,  sw, d, kernelSizeX,  lowOffsetX,  highOffsetX, w, h);
-        boxBlurX(d,  w,  t, kernelSizeX,  highOffsetX, lowOffsetX,  w, h);
-        boxBlurX(t,  w,  d, kernelSizeX3, highOffsetX, highOffsetX, w, h);
+        passes.blurX(s,  sw, d, kernelSizeX,  lowOffsetX,  highOffsetX, w, h);
+        passes.blurX(d,  w,  t, kernelSizeX,  highOffsetX, lowOffsetX,  w, h);
+        passes.blurX(t,  w,  d, kernelSizeX3, highOffsetX, highOffsetX, w, h);
     } else if (kernelSizeY > 0) {
-        boxBlurYX(s, sw, d, kernelSizeY,  lowOffsetY,  highOffsetY, h, w);
-        boxBlurX(d,  h,  t, kernelSizeY,  highOffsetY, lowOffsetY,  h, w);
-        boxBlurXY(t, h,  d, kernelSizeY3, highOffsetY, highOffsetY, h, w);
+        passes.blurYX(s, sw, d, kernelSizeY,  lowOffsetY,  highOffsetY, h, w);
+        passes.blurX(d,  h,  t, kernelSizeY,  highOffsetY, lowOffsetY,  h, w);
+        passes.blurXY(t, h,  d, kernelSizeY3, highOffsetY, highOffsetY, h, w);
     }
     return true;
 }
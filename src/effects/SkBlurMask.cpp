@@ -8,7 +8,10 @@
 
 
 #include "SkBlurMask.h"
+#include "SkGraphics.h"
+#include "SkLazyPtr.h"
 #include "SkMath.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkEndian.h"
 
@@ -406,6 +409,124 @@ static int boxBlurInterp(const uint8_t* src, int src_y_stride, uint8_t* dst,
     return new_width;
 }
 
+// Smaller masks are blurred on the calling thread, where handing bands to other
+// threads would cost more than it saves.
+static const int kMinThreadedBlurPixels = 512 * 512;
+
+static SkThreadPool* create_thread_pool() {
+    return SkNEW_ARGS(SkThreadPool, (SkGraphics::GetBlurThreadCount()));
+}
+
+SkThreadPool* SkBlurMask::GetThreadPool() {
+    SK_DECLARE_STATIC_LAZY_PTR(SkThreadPool, pool, create_thread_pool);
+    return pool.get();
+}
+
+// The rows in each band of a threaded pass. A band transposed into dst fills one
+// cache line of each dst row it touches.
+static const int kBandRows = 64;
+
+// Copies the rows x width block src into dst transposed, with the rows of dst
+// dstStride apart. Goes through a few columns of src at a time so that the dst
+// rows being written stay in cache.
+static void transpose_block(const uint8_t* src, int width, int rows,
+                            uint8_t* dst, int dstStride) {
+    static const int kTileWidth = 16;
+    for (int left = 0; left < width; left += kTileWidth) {
+        int right = SkMin32(left + kTileWidth, width);
+        for (int y = 0; y < rows; ++y) {
+            const uint8_t* sptr = src + y * width;
+            uint8_t* dptr = dst + y;
+            for (int x = left; x < right; ++x) {
+                dptr[x * dstStride] = sptr[x];
+            }
+        }
+    }
+}
+
+namespace {
+
+/**
+ * Runs the passes of BoxBlur() with boxBlur(), or with boxBlurInterp() when
+ * outerWeight is below 255, in which case leftRadius is the radius. With a task
+ * group each pass is split into bands of rows, one pass after the other. The
+ * blurs can only transpose a whole mask, so a threaded transposing pass blurs
+ * each band into a block of its own and transposes that.
+ */
+class BoxBlurPasses : public SkParallelForBody {
+public:
+    BoxBlurPasses(SkTaskGroup* group, int outerWeight)
+        : fGroup(group), fOuterWeight(outerWeight) {}
+
+    int blur(const uint8_t* src, int src_y_stride, uint8_t* dst,
+             int leftRadius, int rightRadius, int width, int height,
+             bool transpose) {
+        if (NULL == fGroup) {
+            return this->blurRows(src, src_y_stride, dst, leftRadius, rightRadius,
+                                  width, height, transpose);
+        }
+        fSrc = src;
+        fSrcRowBytes = src_y_stride;
+        fDst = dst;
+        fLeftRadius = leftRadius;
+        fRightRadius = rightRadius;
+        fWidth = width;
+        fHeight = height;
+        fTranspose = transpose;
+        fGroup->parallelFor(0, (height + kBandRows - 1) / kBandRows, this);
+        fGroup->wait();
+        return this->newWidth(width, leftRadius, rightRadius);
+    }
+
+    virtual void run(int band) SK_OVERRIDE {
+        const int top = band * kBandRows;
+        const int rows = SkMin32(kBandRows, fHeight - top);
+        const uint8_t* src = fSrc + top * fSrcRowBytes;
+        const int newWidth = this->newWidth(fWidth, fLeftRadius, fRightRadius);
+        if (fTranspose) {
+            SkAutoTMalloc<uint8_t> block(newWidth * rows);
+            this->blurRows(src, fSrcRowBytes, block.get(), fLeftRadius, fRightRadius,
+                           fWidth, rows, false);
+            transpose_block(block.get(), newWidth, rows, fDst + top, fHeight);
+        } else {
+            this->blurRows(src, fSrcRowBytes, fDst + top * newWidth, fLeftRadius,
+                           fRightRadius, fWidth, rows, false);
+        }
+    }
+
+private:
+    int newWidth(int width, int leftRadius, int rightRadius) const {
+        return 255 == fOuterWeight ? width + SkMax32(leftRadius, rightRadius) * 2
+                                   : width + leftRadius * 2;
+    }
+
+    int blurRows(const uint8_t* src, int src_y_stride, uint8_t* dst,
+                 int leftRadius, int rightRadius, int width, int height,
+                 bool transpose) const {
+        if (255 == fOuterWeight) {
+            return boxBlur(src, src_y_stride, dst, leftRadius, rightRadius,
+                           width, height, transpose);
+        }
+        return boxBlurInterp(src, src_y_stride, dst, leftRadius, width, height,
+                             transpose, fOuterWeight);
+    }
+
+    SkTaskGroup*   fGroup;
+    int            fOuterWeight;
+
+    // The pass being run on fGroup.
+    const uint8_t* fSrc;
+    int            fSrcRowBytes;
+    uint8_t*       fDst;
+    int            fLeftRadius;
+    int            fRightRadius;
+    int            fWidth;
+    int            fHeight;
+    bool           fTranspose;
+};
+
+}  // namespace
+
 static void get_adjusted_radii(SkScalar passRadius, int *loRadius, int *hiRadius)
 {
     *loRadius = *hiRadius = SkScalarCeilToInt(passRadius);
@@ -549,36 +670,29 @@ bool SkBlurMask::BoxBlur(SkMask* dst, const SkMask& src,
         uint8_t*                tp = tmpBuffer.get();
         int w = sw, h = sh;
 
-        if (outerWeight == 255) {
-            int loRadius, hiRadius;
-            get_adjusted_radii(passRadius, &loRadius, &hiRadius);
-            if (kHigh_SkBlurQuality == quality) {
-                // Do three X blurs, with a transpose on the final one.
-                w = boxBlur(sp, src.fRowBytes, tp, loRadius, hiRadius, w, h, false);
-                w = boxBlur(tp, w,             dp, hiRadius, loRadius, w, h, false);
-                w = boxBlur(dp, w,             tp, hiRadius, hiRadius, w, h, true);
-                // Do three Y blurs, with a transpose on the final one.
-                h = boxBlur(tp, h,             dp, loRadius, hiRadius, h, w, false);
-                h = boxBlur(dp, h,             tp, hiRadius, loRadius, h, w, false);
-                h = boxBlur(tp, h,             dp, hiRadius, hiRadius, h, w, true);
-            } else {
-                w = boxBlur(sp, src.fRowBytes, tp, rx, rx, w, h, true);
-                h = boxBlur(tp, h,             dp, ry, ry, h, w, true);
+        SkAutoTDelete<SkTaskGroup> group;
+        const int threadCount = SkGraphics::GetBlurThreadCount();
+        if ((threadCount < 0 || threadCount > 1) && sw * sh >= kMinThreadedBlurPixels) {
+            group.reset(SkNEW_ARGS(SkTaskGroup, (GetThreadPool())));
+        }
+        BoxBlurPasses passes(group.get(), outerWeight);
+
+        if (kHigh_SkBlurQuality == quality) {
+            int loRadius = rx, hiRadius = rx;
+            if (outerWeight == 255) {
+                get_adjusted_radii(passRadius, &loRadius, &hiRadius);
             }
+            // Do three X blurs, with a transpose on the final one.
+            w = passes.blur(sp, src.fRowBytes, tp, loRadius, hiRadius, w, h, false);
+            w = passes.blur(tp, w,             dp, hiRadius, loRadius, w, h, false);
+            w = passes.blur(dp, w,             tp, hiRadius, hiRadius, w, h, true);
+            // Do three Y blurs, with a transpose on the final one.
+            h = passes.blur(tp, h,             dp, loRadius, hiRadius, h, w, false);
+            h = passes.blur(dp, h,             tp, hiRadius, loRadius, h, w, false);
+            h = passes.blur(tp, h,             dp, hiRadius, hiRadius, h, w, true);
         } else {
-            if (kHigh_SkBlurQuality == quality) {
-                // Do three X blurs, with a transpose on the final one.
-                w = boxBlurInterp(sp, src.fRowBytes, tp, rx, w, h, false, outerWeight);
-                w = boxBlurInterp(tp, w,             dp, rx, w, h, false, outerWeight);
-                w = boxBlurInterp(dp, w,             tp, rx, w, h, true, outerWeight);
-                // Do three Y blurs, with a transpose on the final one.
-                h = boxBlurInterp(tp, h,             dp, ry, h, w, false, outerWeight);
-                h = boxBlurInterp(dp, h,             tp, ry, h, w, false, outerWeight);
-                h = boxBlurInterp(tp, h,             dp, ry, h, w, true, outerWeight);
-            } else {
-                w = boxBlurInterp(sp, src.fRowBytes, tp, rx, w, h, true, outerWeight);
-                h = boxBlurInterp(tp, h,             dp, ry, h, w, true, outerWeight);
-            }
+            w = passes.blur(sp, src.fRowBytes, tp, rx, rx, w, h, true);
+            h = passes.blur(tp, h,             dp, ry, ry, h, w, true);
         }
 
         dst->fImage = dp;
@@ -12,6 +12,7 @@
 #include "SkShader.h"
 #include "SkMask.h"
 #include "SkRRect.h"
+#include "SkThreadPool.h"
 
 class SkBlurMask {
 public:
@@ -39,6 +40,10 @@ public:
     static bool BlurGroundTruth(SkScalar sigma, SkMask* dst, const SkMask& src, SkBlurStyle,
                                 SkIPoint* margin = NULL);
 
+    // The threads that large raster blurs split their passes across, started by the first such
+    // blur with SkGraphics::GetBlurThreadCount() threads and shared by every later one.
+    static SkThreadPool* GetThreadPool();
+
     // If radius > 0, return the corresponding sigma, else return 0
     static SkScalar ConvertRadiusToSigma(SkScalar radius);
     // If sigma > 0.5, return the corresponding radius, else return 0
@@ -11,6 +11,7 @@
 #include "SkGpuBlurUtils.h"
 #include "SkReadBuffer.h"
 #include "SkWriteBuffer.h"
+#include "SkMaskCache.h"
 #include "SkMaskFilter.h"
 #include "SkRRect.h"
 #include "SkRTConf.h"
@@ -254,6 +255,73 @@ static bool rect_exceeds(const SkRect& r, SkScalar v) {
            r.width() > v || r.height() > v;
 }
 
+namespace {
+
+/**
+ *  Identifies a blurred nine-patch in SkMaskCache: the blur, whether it was made analytically,
+ *  and the small rects or round rect it was made from. Rects are relative to the integer part
+ *  of the first one's top-left, since any integer translation of them gives the same mask.
+ */
+struct NinePatchKey {
+    NinePatchKey(SkScalar sigma, SkBlurStyle style, SkBlurQuality quality, bool analytic) {
+        // Zero everything first, so unused geometry compares equal.
+        sk_bzero(this, sizeof(*this));
+        fTag = SkSetFourByteTag('b', 'l', 'u', 'r');
+        fSigma = sigma;
+        fFlags = style | (quality << 4) | (analytic << 8);
+    }
+
+    void setRects(const SkRect rects[], int count) {
+        const SkScalar x = SkScalarFloorToScalar(rects[0].fLeft);
+        const SkScalar y = SkScalarFloorToScalar(rects[0].fTop);
+        for (int i = 0; i < count; ++i) {
+            fGeometry[4 * i + 0] = rects[i].fLeft - x;
+            fGeometry[4 * i + 1] = rects[i].fTop - y;
+            fGeometry[4 * i + 2] = rects[i].fRight - x;
+            fGeometry[4 * i + 3] = rects[i].fBottom - y;
+        }
+        fFlags |= count << 12;
+    }
+
+    // The round rect's rect must be at the origin.
+    void setRRect(const SkRRect& rrect) {
+        SkASSERT(0 == rrect.rect().fLeft && 0 == rrect.rect().fTop);
+        fGeometry[0] = rrect.width();
+        fGeometry[1] = rrect.height();
+        for (int i = 0; i < 4; ++i) {
+            const SkVector& radii = rrect.radii((SkRRect::Corner) i);
+            fGeometry[2 + 2 * i] = radii.fX;
+            fGeometry[3 + 2 * i] = radii.fY;
+        }
+        fFlags |= 1 << 15;
+    }
+
+    uint32_t fTag;
+    SkScalar fSigma;
+    uint32_t fFlags;
+    SkScalar fGeometry[10];
+};
+
+}  // namespace
+
+// Points mask at the cached nine-patch for key and returns its entry, or returns NULL.
+static const SkMaskCache::Entry* find_nine_patch(const NinePatchKey& key, SkMask* mask) {
+    const SkMaskCache::Entry* entry = SkMaskCache::Find(&key, sizeof(key));
+    if (NULL != entry) {
+        *mask = entry->mask();
+    }
+    return entry;
+}
+
+// Hands mask over to the cache if it will take it, pointing mask at the cached copy.
+static const SkMaskCache::Entry* add_nine_patch(const NinePatchKey& key, SkMask* mask) {
+    const SkMaskCache::Entry* entry = SkMaskCache::Add(&key, sizeof(key), *mask);
+    if (NULL != entry) {
+        *mask = entry->mask();
+    }
+    return entry;
+}
+
 #ifdef SK_IGNORE_FAST_RRECT_BLUR
 SK_CONF_DECLARE( bool, c_analyticBlurRRect, "mask.filter.blur.analyticblurrrect", false, "Use the faster analytic blur approach for ninepatch rects" );
 #else
@@ -365,26 +433,34 @@ SkBlurMaskFilterImpl::filterRRectToNine(const SkRRect& rrect, const SkMatrix& ma
     radii[SkRRect::kLowerLeft_Corner] = LL;
     smallRR.setRectRadii(smallR, radii);
 
-    bool analyticBlurWorked = false;
-    if (c_analyticBlurRRect) {
-        analyticBlurWorked =
-            this->filterRRectMask(&patch->fMask, smallRR, matrix, &margin,
-                                  SkMask::kComputeBoundsAndRenderImage_CreateMode);
-    }
-
-    if (!analyticBlurWorked) {
-        if (!draw_rrect_into_mask(smallRR, &srcM)) {
-            return kFalse_FilterReturn;
+    NinePatchKey key(this->computeXformedSigma(matrix), fBlurStyle, this->getQuality(),
+                     c_analyticBlurRRect);
+    key.setRRect(smallRR);
+    patch->fCache = find_nine_patch(key, &patch->fMask);
+    if (NULL == patch->fCache) {
+        bool analyticBlurWorked = false;
+        if (c_analyticBlurRRect) {
+            analyticBlurWorked =
+                this->filterRRectMask(&patch->fMask, smallRR, matrix, &margin,
+                                      SkMask::kComputeBoundsAndRenderImage_CreateMode);
         }
 
-        SkAutoMaskFreeImage amf(srcM.fImage);
+        if (!analyticBlurWorked) {
+            if (!draw_rrect_into_mask(smallRR, &srcM)) {
+                return kFalse_FilterReturn;
+            }
 
-        if (!this->filterMask(&patch->fMask, srcM, matrix, &margin)) {
-            return kFalse_FilterReturn;
+            SkAutoMaskFreeImage amf(srcM.fImage);
+
+            if (!this->filterMask(&patch->fMask, srcM, matrix, &margin)) {
+                return kFalse_FilterReturn;
+            }
         }
+
+        patch->fMask.fBounds.offsetTo(0, 0);
+        patch->fCache = add_nine_patch(key, &patch->fMask);
     }
 
-    patch->fMask.fBounds.offsetTo(0, 0);
     patch->fOuterRect = dstM.fBounds;
     patch->fCenter.fX = SkScalarCeilToInt(leftUnstretched) + 1;
     patch->fCenter.fY = SkScalarCeilToInt(topUnstretched) + 1;
@@ -491,23 +567,31 @@ SkBlurMaskFilterImpl::filterRectsToNine(const SkRect rects[], int count,
         SkASSERT(!smallR[1].isEmpty());
     }
 
-    if (count > 1 || !c_analyticBlurNinepatch) {
-        if (!draw_rects_into_mask(smallR, count, &srcM)) {
-            return kFalse_FilterReturn;
-        }
-
-        SkAutoMaskFreeImage amf(srcM.fImage);
-
-        if (!this->filterMask(&patch->fMask, srcM, matrix, &margin)) {
-            return kFalse_FilterReturn;
-        }
-    } else {
-        if (!this->filterRectMask(&patch->fMask, smallR[0], matrix, &margin,
-                                  SkMask::kComputeBoundsAndRenderImage_CreateMode)) {
-            return kFalse_FilterReturn;
+    const bool analytic = 1 == count && c_analyticBlurNinepatch;
+    NinePatchKey key(this->computeXformedSigma(matrix), fBlurStyle, this->getQuality(),
+                     analytic);
+    key.setRects(smallR, count);
+    patch->fCache = find_nine_patch(key, &patch->fMask);
+    if (NULL == patch->fCache) {
+        if (!analytic) {
+            if (!draw_rects_into_mask(smallR, count, &srcM)) {
+                return kFalse_FilterReturn;
+            }
+
+            SkAutoMaskFreeImage amf(srcM.fImage);
+
+            if (!this->filterMask(&patch->fMask, srcM, matrix, &margin)) {
+                return kFalse_FilterReturn;
+            }
+        } else {
+            if (!this->filterRectMask(&patch->fMask, smallR[0], matrix, &margin,
+                                      SkMask::kComputeBoundsAndRenderImage_CreateMode)) {
+                return kFalse_FilterReturn;
+            }
         }
+        patch->fMask.fBounds.offsetTo(0, 0);
+        patch->fCache = add_nine_patch(key, &patch->fMask);
     }
-    patch->fMask.fBounds.offsetTo(0, 0);
     patch->fOuterRect = dstM.fBounds;
     patch->fCenter = center;
     return kTrue_FilterReturn;
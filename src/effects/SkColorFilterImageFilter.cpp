@@ -8,68 +8,59 @@
 #include "SkColorFilterImageFilter.h"
 #include "SkBitmap.h"
 #include "SkCanvas.h"
-#include "SkColorMatrixFilter.h"
 #include "SkDevice.h"
 #include "SkColorFilter.h"
 #include "SkReadBuffer.h"
+#include "SkTDArray.h"
 #include "SkWriteBuffer.h"
 
 namespace {
 
-void mult_color_matrix(SkScalar a[20], SkScalar b[20], SkScalar out[20]) {
-    for (int j = 0; j < 4; ++j) {
-        for (int i = 0; i < 5; ++i) {
-            out[i+j*5] = 4 == i ? a[4+j*5] : 0;
-            for (int k = 0; k < 4; ++k)
-                out[i+j*5] += SkScalarMul(a[k+j*5], b[i+k*5]);
+// The color filters of a chain of uncropped SkColorFilterImageFilters,
+// outermost first.
+class ColorFilterChain : SkNoncopyable {
+public:
+    ~ColorFilterChain() { fFilters.unrefAll(); }
+
+    // Adds the filters of input and its inputs, and returns the first input
+    // that isn't one of them.
+    SkImageFilter* addInputs(SkImageFilter* input) {
+        SkColorFilter* inputColorFilter;
+        while (NULL != input && input->asColorFilter(&inputColorFilter)) {
+            if (NULL == inputColorFilter) {
+                break;
+            }
+            *fFilters.append() = inputColorFilter;
+            input = input->getInput(0);
         }
+        return input;
     }
-}
 
-// To detect if we need to apply clamping after applying a matrix, we check if
-// any output component might go outside of [0, 255] for any combination of
-// input components in [0..255].
-// Each output component is an affine transformation of the input component, so
-// the minimum and maximum values are for any combination of minimum or maximum
-// values of input components (i.e. 0 or 255).
-// E.g. if R' = x*R + y*G + z*B + w*A + t
-// Then the maximum value will be for R=255 if x>0 or R=0 if x<0, and the
-// minimum value will be for R=0 if x>0 or R=255 if x<0.
-// Same goes for all components.
-bool component_needs_clamping(SkScalar row[5]) {
-    SkScalar maxValue = row[4] / 255;
-    SkScalar minValue = row[4] / 255;
-    for (int i = 0; i < 4; ++i) {
-        if (row[i] > 0)
-            maxValue += row[i];
-        else
-            minValue += row[i];
+    int count() const { return fFilters.count(); }
+
+    // Applies the filters in turn, innermost first.
+    void filterSpan(const SkPMColor src[], int count, SkPMColor dst[]) const {
+        const SkPMColor* span = src;
+        for (int i = fFilters.count() - 1; i >= 0; --i) {
+            fFilters[i]->filterSpan(span, count, dst);
+            span = dst;
+        }
     }
-    return (maxValue > 1) || (minValue < 0);
-}
 
-bool matrix_needs_clamping(SkScalar matrix[20]) {
-    return component_needs_clamping(matrix)
-        || component_needs_clamping(matrix+5)
-        || component_needs_clamping(matrix+10)
-        || component_needs_clamping(matrix+15);
-}
+    SkTDArray<SkColorFilter*> fFilters;
+};
 
 };
 
 SkColorFilterImageFilter* SkColorFilterImageFilter::Create(SkColorFilter* cf,
         SkImageFilter* input, const CropRect* cropRect) {
     SkASSERT(cf);
-    SkScalar colorMatrix[20], inputMatrix[20];
     SkColorFilter* inputColorFilter;
-    if (input && cf->asColorMatrix(colorMatrix)
-              && input->asColorFilter(&inputColorFilter)
+    if (input && input->asColorFilter(&inputColorFilter)
               && (NULL != inputColorFilter)) {
         SkAutoUnref autoUnref(inputColorFilter);
-        if (inputColorFilter->asColorMatrix(inputMatrix) && !matrix_needs_clamping(inputMatrix)) {
-            SkScalar combinedMatrix[20];
-            mult_color_matrix(inputMatrix, colorMatrix, combinedMatrix);
-            SkAutoTUnref<SkColorFilter> newCF(SkColorMatrixFilter::Create(combinedMatrix));
+        SkAutoTUnref<SkColorFilter> newCF(cf->newComposed(inputColorFilter));
+        if (NULL != newCF.get()) {
             return SkNEW_ARGS(SkColorFilterImageFilter, (newCF, input->getInput(0), cropRect));
         }
     }
@@ -102,11 +93,28 @@ bool SkColorFilterImageFilter::onFilterImage(Proxy* proxy, const SkBitmap& sourc
                                              const Context& ctx,
                                              SkBitmap* result,
                                              SkIPoint* offset) const {
+    // Create() folds what it can of a chain of color filters into one filter.
+    // What's left of the chain is run here in one pass over the pixels, rather
+    // than with a layer between each filter, where those are in memory.
+    ColorFilterChain chain;
+    *chain.fFilters.append() = SkRef(fColorFilter);
+    SkImageFilter* input = chain.addInputs(getInput(0));
+
     SkBitmap src = source;
     SkIPoint srcOffset = SkIPoint::Make(0, 0);
-    if (getInput(0) && !getInput(0)->filterImage(proxy, source, ctx, &src, &srcOffset)) {
+    if (input && !input->filterImage(proxy, source, ctx, &src, &srcOffset)) {
         return false;
     }
+    const bool onePass = chain.count() > 1 && NULL == src.getTexture() &&
+                         kN32_SkColorType == src.colorType();
+    if (chain.count() > 1 && !onePass) {
+        // Each filter becomes its own effect on the GPU, so filter in turn.
+        src = source;
+        srcOffset = SkIPoint::Make(0, 0);
+        if (!getInput(0)->filterImage(proxy, source, ctx, &src, &srcOffset)) {
+            return false;
+        }
+    }
 
     SkIRect bounds;
     if (!this->applyCropRect(ctx, src, srcOffset, &bounds)) {
@@ -117,12 +125,32 @@ bool SkColorFilterImageFilter::onFilterImage(Proxy* proxy, const SkBitmap& sourc
     if (NULL == device.get()) {
         return false;
     }
-    SkCanvas canvas(device.get());
-    SkPaint paint;
 
-    paint.setXfermodeMode(SkXfermode::kSrc_Mode);
-    paint.setColorFilter(fColorFilter);
-    canvas.drawSprite(src, srcOffset.fX - bounds.fLeft, srcOffset.fY - bounds.fTop, &paint);
+    if (onePass) {
+        // As drawing src with kSrc_Mode would, filter where src is, and leave
+        // the rest of the device clear.
+        SkBitmap dst = device.get()->accessBitmap(true);
+        SkAutoLockPixels alpSrc(src), alpDst(dst);
+        if (NULL == src.getPixels() || NULL == dst.getPixels()) {
+            return false;
+        }
+        SkIRect rows = SkIRect::MakeXYWH(srcOffset.fX, srcOffset.fY, src.width(), src.height());
+        if (rows.intersect(bounds)) {
+            for (int y = rows.fTop; y < rows.fBottom; ++y) {
+                chain.filterSpan(src.getAddr32(rows.fLeft - srcOffset.fX, y - srcOffset.fY),
+                                 rows.width(),
+                                 dst.getAddr32(rows.fLeft - bounds.fLeft, y - bounds.fTop));
+            }
+        }
+        dst.notifyPixelsChanged();
+    } else {
+        SkCanvas canvas(device.get());
+        SkPaint paint;
+
+        paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+        paint.setColorFilter(fColorFilter);
+        canvas.drawSprite(src, srcOffset.fX - bounds.fLeft, srcOffset.fY - bounds.fTop, &paint);
+    }
 
     *result = device.get()->accessBitmap(false);
     offset->fX = bounds.fLeft;
@@ -323,6 +323,47 @@ bool SkColorMatrixFilter::asColorMatrix(SkScalar matrix[20]) const {
     return true;
 }
 
+// To detect if we need to apply clamping after applying a matrix, we check if
+// any output component might go outside of [0, 255] for any combination of
+// input components in [0..255].
+// Each output component is an affine transformation of the input component, so
+// the minimum and maximum values are for any combination of minimum or maximum
+// values of input components (i.e. 0 or 255).
+// E.g. if R' = x*R + y*G + z*B + w*A + t
+// Then the maximum value will be for R=255 if x>0 or R=0 if x<0, and the
+// minimum value will be for R=0 if x>0 or R=255 if x<0.
+// Same goes for all components.
+static bool component_needs_clamping(const SkScalar row[5]) {
+    SkScalar maxValue = row[4] / 255;
+    SkScalar minValue = row[4] / 255;
+    for (int i = 0; i < 4; ++i) {
+        if (row[i] > 0)
+            maxValue += row[i];
+        else
+            minValue += row[i];
+    }
+    return (maxValue > 1) || (minValue < 0);
+}
+
+static bool matrix_needs_clamping(const SkScalar matrix[20]) {
+    return component_needs_clamping(matrix)
+        || component_needs_clamping(matrix+5)
+        || component_needs_clamping(matrix+10)
+        || component_needs_clamping(matrix+15);
+}
+
+SkColorFilter* SkColorMatrixFilter::newComposed(const SkColorFilter* inner) const {
+    // The product is only the same as the two matrices in turn if the inner
+    // one never clamps.
+    SkColorMatrix innerMatrix;
+    if (!inner->asColorMatrix(innerMatrix.fMat) || matrix_needs_clamping(innerMatrix.fMat)) {
+        return NULL;
+    }
+    SkColorMatrix composed;
+    composed.setConcat(fMatrix, innerMatrix);
+    return SkColorMatrixFilter::Create(composed);
+}
+
 #if SK_SUPPORT_GPU
 #include "GrEffect.h"
 #include "GrTBackendEffectFactory.h"
@@ -10,6 +10,7 @@
 #include "SkWriteBuffer.h"
 #include "SkUnPreMultiply.h"
 #include "SkColorPriv.h"
+#include "SkDisplacementMap_opts.h"
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
 #include "GrCoordTransform.h"
@@ -47,6 +48,19 @@ template<> uint32_t getValue<SkDisplacementMapEffect::kA_ChannelSelectorType>(
     return SkGetPackedA32(l);
 }
 
+int getShift(SkDisplacementMapEffect::ChannelSelectorType type) {
+    switch (type) {
+      case SkDisplacementMapEffect::kR_ChannelSelectorType:
+        return SK_R32_SHIFT;
+      case SkDisplacementMapEffect::kG_ChannelSelectorType:
+        return SK_G32_SHIFT;
+      case SkDisplacementMapEffect::kB_ChannelSelectorType:
+        return SK_B32_SHIFT;
+      default:
+        return SK_A32_SHIFT;
+    }
+}
+
 template<SkDisplacementMapEffect::ChannelSelectorType typeX,
          SkDisplacementMapEffect::ChannelSelectorType typeY>
 void computeDisplacement(const SkVector& scale, SkBitmap* dst,
@@ -63,10 +77,34 @@ void computeDisplacement(const SkVector& scale, SkBitmap* dst,
                                              SK_ScalarHalf - SkScalarMul(scale.fY, SK_ScalarHalf));
     const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
     SkPMColor* dstPtr = dst->getAddr32(0, 0);
+
+    // The platform proc displaces what it can of each row, and we finish the row.
+    SkDisplacementProc proc = SkDisplacementGetPlatformProc();
+    SkDisplacementParams params;
+    params.fSrc = src->getAddr32(0, 0);
+    params.fSrcRowPixels = src->rowBytesAsPixels();
+    params.fSrcWidth = srcW;
+    params.fSrcHeight = srcH;
+    params.fScale[0] = scaleForColor.fX;
+    params.fScale[1] = scaleForColor.fY;
+    params.fAdjust[0] = scaleAdj.fX;
+    params.fAdjust[1] = scaleAdj.fY;
+    params.fShift[0] = getShift(typeX);
+    params.fShift[1] = getShift(typeY);
+    params.fUnpremul[0] = typeX != SkDisplacementMapEffect::kA_ChannelSelectorType;
+    params.fUnpremul[1] = typeY != SkDisplacementMapEffect::kA_ChannelSelectorType;
+
     for (int y = bounds.top(); y < bounds.bottom(); ++y) {
         const SkPMColor* displPtr = displ->getAddr32(bounds.left() + offset.fX,
                                                      y + offset.fY);
-        for (int x = bounds.left(); x < bounds.right(); ++x, ++displPtr) {
+        int x = bounds.left();
+        if (proc) {
+            int done = proc(params, displPtr, dstPtr, x, y, bounds.width());
+            x += done;
+            displPtr += done;
+            dstPtr += done;
+        }
+        for (; x < bounds.right(); ++x, ++displPtr) {
             const SkScalar displX = SkScalarMul(scaleForColor.fX,
                 SkIntToScalar(getValue<typeX>(*displPtr, table))) + scaleAdj.fX;
             const SkScalar displY = SkScalarMul(scaleForColor.fY,
@@ -54,8 +54,11 @@ static void convolve_gaussian_pass(GrContext* context,
                                    float bounds[2]) {
     GrPaint paint;
     paint.reset();
-    SkAutoTUnref<GrEffectRef> conv(GrConvolutionEffect::CreateGaussian(
-        texture, direction, radius, sigma, useBounds, bounds));
+    // The passes draw whole texels 1:1, so without bounds to apply each lookup can read a pair
+    // of texels through bilinear filtering.
+    SkAutoTUnref<GrEffectRef> conv(useBounds ?
+        GrConvolutionEffect::CreateGaussian(texture, direction, radius, sigma, true, bounds) :
+        GrConvolutionEffect::CreateGaussianBilerp(texture, direction, radius, sigma));
     paint.reset();
     paint.addColorEffect(conv);
     context->drawRectToRect(paint, dstRect, srcRect);
@@ -16,6 +16,8 @@
 #include "SkPaint.h"
 #include "SkPath.h"
 #include "SkPathEffect.h"
+#include "SkTArray.h"
+#include "SkTemplates.h"
 #include "../core/SkRasterClip.h"
 #include "SkXfermode.h"
 #include <new>
@@ -102,6 +104,115 @@ static bool compute_bounds(const SkDeque& layers, const SkPath& path,
     return true;
 }
 
+// Returns true if the two paints turn a path into the same coverage, so that layers drawn with
+// them can share one rasterization of it and differ only in how it is blended.
+static bool same_coverage(const SkPaint& a, const SkPaint& b) {
+    return a.getStyle() == b.getStyle() &&
+           a.getStrokeWidth() == b.getStrokeWidth() &&
+           a.getStrokeMiter() == b.getStrokeMiter() &&
+           a.getStrokeCap() == b.getStrokeCap() &&
+           a.getStrokeJoin() == b.getStrokeJoin() &&
+           a.isAntiAlias() == b.isAntiAlias() &&
+           a.getPathEffect() == b.getPathEffect() &&
+           a.getMaskFilter() == b.getMaskFilter() &&
+           a.getRasterizer() == b.getRasterizer();
+}
+
+// Layers with shaders aren't shared, as their coverage is blitted in device space.
+static bool can_share_coverage(const SkPaint& paint) {
+    return NULL == paint.getShader() && NULL == paint.getRasterizer();
+}
+
+// Sets delta to how far apart the two offsets are in device space, if that is whole pixels.
+static bool device_delta(const SkMatrix& matrix, const SkVector& from, const SkVector& to,
+                         SkIPoint* delta) {
+    if (matrix.hasPerspective()) {
+        return false;
+    }
+    SkVector v = to - from;
+    matrix.mapVectors(&v, 1);
+    int dx = SkScalarRoundToInt(v.fX);
+    int dy = SkScalarRoundToInt(v.fY);
+    static const SkScalar kTolerance = SK_Scalar1 / 1024;
+    if (SkScalarAbs(v.fX - dx) > kTolerance || SkScalarAbs(v.fY - dy) > kTolerance) {
+        return false;
+    }
+    delta->set(dx, dy);
+    return true;
+}
+
+// Rasterizes the coverage of path drawn with rec's paint into an A8 mask covering needed.
+static void rasterize_coverage(const SkLayerRasterizer_Rec& rec, const SkPath& path,
+                               const SkMatrix& matrix, const SkIRect& needed, SkMask* coverage) {
+    coverage->fImage = NULL;
+    coverage->fBounds.setEmpty();
+
+    const SkPaint&  paint = rec.fPaint;
+    SkPath          fillPath, devPath;
+    const SkPath*   p = &path;
+    if (paint.getPathEffect() || paint.getStyle() != SkPaint::kFill_Style) {
+        paint.getFillPath(path, &fillPath);
+        p = &fillPath;
+    }
+    if (p->isEmpty()) {
+        return;
+    }
+    SkMatrix m = matrix;
+    m.preTranslate(rec.fOffset.fX, rec.fOffset.fY);
+    p->transform(m, &devPath);
+    // Unlike the bounds of the whole mask, this has to include everything the mask filter spreads
+    // the coverage to, as it may be blitted further over than the layer that rasterized it.
+    SkRect pathBounds = devPath.getBounds();
+    pathBounds.inset(-SK_ScalarHalf, -SK_ScalarHalf);
+    pathBounds.roundOut(&coverage->fBounds);
+    if (paint.getMaskFilter()) {
+        SkMask srcM, dstM;
+        srcM.fBounds = coverage->fBounds;
+        srcM.fFormat = SkMask::kA8_Format;
+        srcM.fImage = NULL;
+        if (!paint.getMaskFilter()->filterMask(&dstM, srcM, matrix, NULL)) {
+            coverage->fBounds.setEmpty();
+            return;
+        }
+        coverage->fBounds = dstM.fBounds;
+    }
+    if (!coverage->fBounds.intersect(needed)) {
+        coverage->fBounds.setEmpty();
+        return;
+    }
+    coverage->fFormat = SkMask::kA8_Format;
+    coverage->fRowBytes = coverage->fBounds.width();
+    size_t size = coverage->computeImageSize();
+    if (0 == size) {
+        coverage->fBounds.setEmpty();
+        return;
+    }
+    coverage->fImage = SkMask::AllocImage(size);
+    memset(coverage->fImage, 0, size);
+
+    SkBitmap        device;
+    SkRasterClip    rectClip;
+    SkDraw          draw;
+    SkMatrix        drawMatrix = m;
+
+    rectClip.setRect(SkIRect::MakeWH(coverage->fBounds.width(), coverage->fBounds.height()));
+    drawMatrix.postTranslate(-SkIntToScalar(coverage->fBounds.fLeft),
+                             -SkIntToScalar(coverage->fBounds.fTop));
+    device.installMaskPixels(*coverage);
+
+    draw.fBitmap    = &device;
+    draw.fMatrix    = &drawMatrix;
+    draw.fRC        = &rectClip;
+    draw.fClip      = &rectClip.bwRgn();
+
+    // Opaque black over nothing leaves just the coverage.
+    SkPaint coveragePaint(paint);
+    coveragePaint.setColor(SK_ColorBLACK);
+    coveragePaint.setColorFilter(NULL);
+    coveragePaint.setXfermode(NULL);
+    draw.drawPath(path, coveragePaint);
+}
+
 bool SkLayerRasterizer::onRasterize(const SkPath& path, const SkMatrix& matrix,
                                     const SkIRect* clipBounds,
                                     SkMask* mask, SkMask::CreateMode mode) const {
@@ -149,11 +260,78 @@ bool SkLayerRasterizer::onRasterize(const SkPath& path, const SkMatrix& matrix,
 
         SkDeque::F2BIter        iter(*fLayers);
         SkLayerRasterizer_Rec*  rec;
-
+        SkSTArray<8, const SkLayerRasterizer_Rec*, true> recs;
         while ((rec = (SkLayerRasterizer_Rec*)iter.next()) != NULL) {
-            drawMatrix = translatedMatrix;
-            drawMatrix.preTranslate(rec->fOffset.fX, rec->fOffset.fY);
-            draw.drawPath(path, rec->fPaint);
+            recs.push_back(rec);
+        }
+
+        // Find the layers that can reuse the coverage of an earlier one, whole pixels away. The
+        // layers are still blended in order; only the rasterization is shared.
+        const int count = recs.count();
+        SkAutoSTMalloc<8, int>      shareWith(count);
+        SkAutoSTMalloc<8, int>      sharers(count);
+        SkAutoSTMalloc<8, SkIPoint> delta(count);
+        for (int i = 0; i < count; ++i) {
+            shareWith[i] = i;
+            sharers[i] = 0;
+            delta[i].set(0, 0);
+            if (!can_share_coverage(recs[i]->fPaint)) {
+                continue;
+            }
+            for (int j = 0; j < i; ++j) {
+                if (shareWith[j] == j && can_share_coverage(recs[j]->fPaint) &&
+                    same_coverage(recs[i]->fPaint, recs[j]->fPaint) &&
+                    device_delta(matrix, recs[j]->fOffset, recs[i]->fOffset, &delta[i])) {
+                    shareWith[i] = j;
+                    ++sharers[j];
+                    break;
+                }
+            }
+        }
+
+        SkAutoSTMalloc<8, SkMask> coverage(count);
+        for (int i = 0; i < count; ++i) {
+            coverage[i].fImage = NULL;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int leader = shareWith[i];
+            if (0 == sharers[leader]) {
+                drawMatrix = translatedMatrix;
+                drawMatrix.preTranslate(recs[i]->fOffset.fX, recs[i]->fOffset.fY);
+                draw.drawPath(path, recs[i]->fPaint);
+                continue;
+            }
+
+            if (leader == i) {
+                // Rasterize as much of the coverage as any of the sharing layers will use.
+                SkIRect needed = mask->fBounds;
+                for (int j = i + 1; j < count; ++j) {
+                    if (shareWith[j] == i) {
+                        needed.join(mask->fBounds.makeOffset(-delta[j].fX, -delta[j].fY));
+                    }
+                }
+                rasterize_coverage(*recs[i], path, matrix, needed, &coverage[i]);
+            }
+            const SkMask& shared = coverage[leader];
+            if (NULL == shared.fImage) {
+                continue;
+            }
+
+            SkBitmap coverageBitmap;
+            coverageBitmap.installMaskPixels(shared);
+            SkPaint blitPaint(recs[i]->fPaint);
+            blitPaint.setStyle(SkPaint::kFill_Style);
+            blitPaint.setPathEffect(NULL);
+            blitPaint.setMaskFilter(NULL);
+            drawMatrix.setTranslate(
+                    SkIntToScalar(shared.fBounds.fLeft + delta[i].fX - mask->fBounds.fLeft),
+                    SkIntToScalar(shared.fBounds.fTop + delta[i].fY - mask->fBounds.fTop));
+            draw.drawBitmap(coverageBitmap, SkMatrix::I(), blitPaint);
+        }
+
+        for (int i = 0; i < count; ++i) {
+            SkMask::FreeImage(coverage[i].fImage);
         }
     }
     return true;
@@ -8,6 +8,7 @@
 #include "SkLightingImageFilter.h"
 #include "SkBitmap.h"
 #include "SkColorPriv.h"
+#include "SkLighting_opts.h"
 #include "SkReadBuffer.h"
 #include "SkWriteBuffer.h"
 #include "SkReadBuffer.h"
@@ -161,7 +162,8 @@ inline SkPoint3 bottomRightNormal(int m[9], SkScalar surfaceScale) {
                          surfaceScale);
 }
 
-template <class LightingType, class LightType> void lightBitmap(const LightingType& lightingType, const SkLight* light, const SkBitmap& src, SkBitmap* dst, SkScalar surfaceScale, const SkIRect& bounds) {
+// If proc is not NULL, it lights what it can of the interior of each row, with params.
+template <class LightingType, class LightType> void lightBitmap(const LightingType& lightingType, const SkLight* light, const SkBitmap& src, SkBitmap* dst, SkScalar surfaceScale, const SkIRect& bounds, SkLightingProc proc, const SkLightingParams& params) {
     SkASSERT(dst->width() == bounds.width() && dst->height() == bounds.height());
     const LightType* l = static_cast<const LightType*>(light);
     int left = bounds.left(), right = bounds.right();
@@ -206,7 +208,23 @@ template <class LightingType, class LightType> void lightBitmap(const LightingTy
         m[8] = SkGetPackedA32(*row2++);
         SkPoint3 surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
         *dptr++ = lightingType.light(leftNormal(m, surfaceScale), surfaceToLight, l->lightColor(surfaceToLight));
-        for (++x; x < right - 1; ++x) {
+        ++x;
+        if (NULL != proc) {
+            const SkPMColor* const rows[3] = { row0 - 1, row1 - 1, row2 - 1 };
+            int done = proc(params, rows, dptr, x, y, right - 1 - x);
+            x += done;
+            dptr += done;
+            row0 += done;
+            row1 += done;
+            row2 += done;
+            m[1] = SkGetPackedA32(row0[-2]);
+            m[2] = SkGetPackedA32(row0[-1]);
+            m[4] = SkGetPackedA32(row1[-2]);
+            m[5] = SkGetPackedA32(row1[-1]);
+            m[7] = SkGetPackedA32(row2[-2]);
+            m[8] = SkGetPackedA32(row2[-1]);
+        }
+        for (; x < right - 1; ++x) {
             shiftMatrixLeft(m);
             m[2] = SkGetPackedA32(*row0++);
             m[5] = SkGetPackedA32(*row1++);
@@ -803,6 +821,36 @@ private:
 const SkScalar SkSpotLight::kSpecularExponentMin = 1.0f;
 const SkScalar SkSpotLight::kSpecularExponentMax = 128.0f;
 
+// Returns the platform proc for lighting from light, having filled in the light's
+// half of params, or NULL if there is none.
+static SkLightingProc get_platform_proc(const SkLight* light, bool specular,
+                                        SkLightingParams* params) {
+    SkPoint3 position;
+    SkLightingProcType type;
+    switch (light->type()) {
+        case SkLight::kDistant_LightType:
+            position = static_cast<const SkDistantLight*>(light)->direction();
+            type = specular ? kSpecularDistant_SkLightingProcType
+                            : kDiffuseDistant_SkLightingProcType;
+            break;
+        case SkLight::kPoint_LightType:
+            position = static_cast<const SkPointLight*>(light)->location();
+            type = specular ? kSpecularPoint_SkLightingProcType
+                            : kDiffusePoint_SkLightingProcType;
+            break;
+        default:
+            // Spot lights, with their cones, are only lit by lightBitmap().
+            return NULL;
+    }
+    params->fLight[0] = position.fX;
+    params->fLight[1] = position.fY;
+    params->fLight[2] = position.fZ;
+    params->fColor[0] = light->color().fX;
+    params->fColor[1] = light->color().fY;
+    params->fColor[2] = light->color().fZ;
+    return SkLightingGetPlatformProc(type);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkLight::flattenLight(SkWriteBuffer& buffer) const {
@@ -909,6 +957,18 @@ void SkLightingImageFilter::flatten(SkWriteBuffer& buffer) const {
     buffer.writeScalar(fSurfaceScale);
 }
 
+bool SkLightingImageFilter::onFilterBounds(const SkIRect& src, const SkMatrix& ctm,
+                                           SkIRect* dst) const {
+    SkIRect bounds = src;
+    if (getInput(0) && !getInput(0)->filterBounds(src, ctm, &bounds)) {
+        return false;
+    }
+    // The surface normals come from the 3x3 neighborhood of each pixel.
+    bounds.outset(1, 1);
+    *dst = bounds;
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SkDiffuseLightingImageFilter::SkDiffuseLightingImageFilter(SkLight* light, SkScalar surfaceScale, SkScalar kd, SkImageFilter* input, const CropRect* cropRect = NULL)
@@ -967,18 +1027,23 @@ bool SkDiffuseLightingImageFilter::onFilterImage(Proxy* proxy,
     SkAutoTUnref<SkLight> transformedLight(light()->transform(ctx.ctm()));
 
     DiffuseLightingType lightingType(fKD);
+    SkLightingParams params;
+    params.fSurfaceScale = surfaceScale();
+    params.fK = fKD;
+    params.fShininess = 0;
+    SkLightingProc proc = get_platform_proc(transformedLight, false, &params);
     offset->fX = bounds.left();
     offset->fY = bounds.top();
     bounds.offset(-srcOffset);
     switch (transformedLight->type()) {
         case SkLight::kDistant_LightType:
-            lightBitmap<DiffuseLightingType, SkDistantLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds);
+            lightBitmap<DiffuseLightingType, SkDistantLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds, proc, params);
             break;
         case SkLight::kPoint_LightType:
-            lightBitmap<DiffuseLightingType, SkPointLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds);
+            lightBitmap<DiffuseLightingType, SkPointLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds, proc, params);
             break;
         case SkLight::kSpot_LightType:
-            lightBitmap<DiffuseLightingType, SkSpotLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds);
+            lightBitmap<DiffuseLightingType, SkSpotLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds, proc, params);
             break;
     }
 
@@ -1060,15 +1125,20 @@ bool SkSpecularLightingImageFilter::onFilterImage(Proxy* proxy,
     offset->fY = bounds.top();
     bounds.offset(-srcOffset);
     SkAutoTUnref<SkLight> transformedLight(light()->transform(ctx.ctm()));
+    SkLightingParams params;
+    params.fSurfaceScale = surfaceScale();
+    params.fK = fKS;
+    params.fShininess = fShininess;
+    SkLightingProc proc = get_platform_proc(transformedLight, true, &params);
     switch (transformedLight->type()) {
         case SkLight::kDistant_LightType:
-            lightBitmap<SpecularLightingType, SkDistantLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds);
+            lightBitmap<SpecularLightingType, SkDistantLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds, proc, params);
             break;
         case SkLight::kPoint_LightType:
-            lightBitmap<SpecularLightingType, SkPointLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds);
+            lightBitmap<SpecularLightingType, SkPointLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds, proc, params);
             break;
         case SkLight::kSpot_LightType:
-            lightBitmap<SpecularLightingType, SkSpotLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds);
+            lightBitmap<SpecularLightingType, SkSpotLight>(lightingType, transformedLight, src, dst, surfaceScale(), bounds, proc, params);
             break;
     }
     return true;
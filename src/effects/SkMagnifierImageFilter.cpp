@@ -9,9 +9,14 @@
 #include "SkMagnifierImageFilter.h"
 #include "SkColorPriv.h"
 #include "SkReadBuffer.h"
+#include "SkTemplates.h"
 #include "SkWriteBuffer.h"
 #include "SkValidationUtils.h"
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 #if SK_SUPPORT_GPU
 #include "effects/GrSingleTextureEffect.h"
@@ -246,6 +251,122 @@ SkMagnifierImageFilter::SkMagnifierImageFilter(SkReadBuffer& buffer)
                     (fSrcRect.fLeft >= 0) && (fSrcRect.fTop >= 0));
 }
 
+namespace {
+
+static const SkScalar kScalar2 = SkScalar(2);
+
+// How far column or row i is from the nearer edge of size pixels, in insets.
+inline SkScalar edge_distance(int i, int size, SkScalar inv_inset) {
+    return SkMin32(i, size - i - 1) * inv_inset;
+}
+
+// How far the lens moves the pixel at x_dist, y_dist from the edges toward its
+// zoomed position, from 0 at the edges to 1 inside the inset.
+inline SkScalar lens_weight(SkScalar x_dist, SkScalar y_dist) {
+    // To create a smooth curve at the corners, we need to work on
+    // a square twice the size of the inset.
+    if (x_dist < kScalar2 && y_dist < kScalar2) {
+        x_dist = kScalar2 - x_dist;
+        y_dist = kScalar2 - y_dist;
+
+        SkScalar dist = SkScalarSqrt(SkScalarSquare(x_dist) +
+                                     SkScalarSquare(y_dist));
+        dist = SkMaxScalar(kScalar2 - dist, 0);
+        return SkMinScalar(SkScalarSquare(dist), SK_Scalar1);
+    }
+    SkScalar sqDist = SkMinScalar(SkScalarSquare(x_dist),
+                                  SkScalarSquare(y_dist));
+    return SkMinScalar(sqDist, SK_Scalar1);
+}
+
+// Whether lens_weight(x_dist, y_dist) is 1 outside the corners.
+inline bool inside_inset(SkScalar x_dist, SkScalar y_dist) {
+    return !(x_dist < kScalar2 && y_dist < kScalar2) &&
+           SkMinScalar(SkScalarSquare(x_dist), SkScalarSquare(y_dist)) >= SK_Scalar1;
+}
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+// lens_weight() for four pixels; SSE2 computes both branches and selects.
+inline __m128 lens_weight(__m128 x_dist, __m128 y_dist) {
+    const __m128 two = _mm_set1_ps(kScalar2);
+    const __m128 one = _mm_set1_ps(SK_Scalar1);
+    __m128 corner = _mm_and_ps(_mm_cmplt_ps(x_dist, two), _mm_cmplt_ps(y_dist, two));
+    __m128 cx = _mm_sub_ps(two, x_dist);
+    __m128 cy = _mm_sub_ps(two, y_dist);
+    __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)));
+    dist = _mm_max_ps(_mm_sub_ps(two, dist), _mm_setzero_ps());
+    __m128 cornerWeight = _mm_min_ps(_mm_mul_ps(dist, dist), one);
+    __m128 edgeWeight = _mm_min_ps(_mm_min_ps(_mm_mul_ps(x_dist, x_dist),
+                                              _mm_mul_ps(y_dist, y_dist)), one);
+    return _mm_or_ps(_mm_and_ps(corner, cornerWeight), _mm_andnot_ps(corner, edgeWeight));
+}
+
+// SkPin32(SkScalarFloorToInt(v), 0, max) for four values.
+inline __m128i floor_and_pin(__m128 v, __m128i max) {
+    __m128i i = _mm_cvttps_epi32(v);
+    // Truncation rounds negative values up; step those down.
+    i = _mm_add_epi32(i, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(i), v)));
+    i = _mm_and_si128(i, _mm_cmpgt_epi32(i, _mm_set1_epi32(-1)));
+    __m128i over = _mm_cmpgt_epi32(i, max);
+    return _mm_or_si128(_mm_and_si128(over, max), _mm_andnot_si128(over, i));
+}
+#endif
+
+// The magnifier for pixels that may be within the inset of the edges.
+struct LensSpan {
+    const SkColor* fSrc;
+    int fWidth, fHeight;
+    SkScalar fSrcX, fSrcY;
+    SkScalar fInvInset, fInvXZoom, fInvYZoom;
+
+    // Magnifies pixels [x, end) of row y into dst[x, end).
+    void magnify(int x, int end, int y, SkColor* dst) const {
+        SkScalar y_dist = edge_distance(y, fHeight, fInvInset);
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        const __m128 invInset = _mm_set1_ps(fInvInset);
+        const __m128 yDist = _mm_set1_ps(y_dist);
+        const __m128 yf = _mm_set1_ps(SkIntToScalar(y));
+        const __m128 yZoomed = _mm_set1_ps(fSrcY + y * fInvYZoom);
+        const __m128i maxX = _mm_set1_epi32(fWidth - 1);
+        const __m128i maxY = _mm_set1_epi32(fHeight - 1);
+        for (; x + 4 <= end; x += 4) {
+            __m128i xi = _mm_setr_epi32(x, x + 1, x + 2, x + 3);
+            __m128 xf = _mm_cvtepi32_ps(xi);
+            __m128 fromRight = _mm_cvtepi32_ps(_mm_sub_epi32(maxX, xi));
+            __m128 xDist = _mm_mul_ps(_mm_min_ps(xf, fromRight), invInset);
+            __m128 weight = lens_weight(xDist, yDist);
+            __m128 unweight = _mm_sub_ps(_mm_set1_ps(SK_Scalar1), weight);
+            __m128 xZoomed = _mm_add_ps(_mm_set1_ps(fSrcX),
+                                        _mm_mul_ps(xf, _mm_set1_ps(fInvXZoom)));
+            __m128 xInterp = _mm_add_ps(_mm_mul_ps(weight, xZoomed), _mm_mul_ps(unweight, xf));
+            __m128 yInterp = _mm_add_ps(_mm_mul_ps(weight, yZoomed), _mm_mul_ps(unweight, yf));
+
+            int32_t xs[4], ys[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(xs), floor_and_pin(xInterp, maxX));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(ys), floor_and_pin(yInterp, maxY));
+            for (int i = 0; i < 4; ++i) {
+                dst[x + i] = fSrc[ys[i] * fWidth + xs[i]];
+            }
+        }
+#endif
+        for (; x < end; ++x) {
+            SkScalar weight = lens_weight(edge_distance(x, fWidth, fInvInset), y_dist);
+
+            SkScalar x_interp = SkScalarMul(weight, (fSrcX + x * fInvXZoom)) +
+                           (SK_Scalar1 - weight) * x;
+            SkScalar y_interp = SkScalarMul(weight, (fSrcY + y * fInvYZoom)) +
+                           (SK_Scalar1 - weight) * y;
+
+            int x_val = SkPin32(SkScalarFloorToInt(x_interp), 0, fWidth - 1);
+            int y_val = SkPin32(SkScalarFloorToInt(y_interp), 0, fHeight - 1);
+
+            dst[x] = fSrc[y_val * fWidth + x_val];
+        }
+    }
+};
+
+}  // namespace
+
 // FIXME:  implement single-input semantics
 SkMagnifierImageFilter::SkMagnifierImageFilter(const SkRect& srcRect, SkScalar inset)
     : INHERITED(0), fSrcRect(srcRect), fInset(inset) {
@@ -307,44 +428,43 @@ bool SkMagnifierImageFilter::onFilterImage(Proxy*, const SkBitmap& src,
     SkScalar inv_x_zoom = fSrcRect.width() / src.width();
     SkScalar inv_y_zoom = fSrcRect.height() / src.height();
 
-    SkColor* sptr = src.getAddr32(0, 0);
+    const SkColor* sptr = src.getAddr32(0, 0);
     SkColor* dptr = dst->getAddr32(0, 0);
     int width = src.width(), height = src.height();
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            SkScalar x_dist = SkMin32(x, width - x - 1) * inv_inset;
-            SkScalar y_dist = SkMin32(y, height - y - 1) * inv_inset;
-            SkScalar weight = 0;
-
-            static const SkScalar kScalar2 = SkScalar(2);
-
-            // To create a smooth curve at the corners, we need to work on
-            // a square twice the size of the inset.
-            if (x_dist < kScalar2 && y_dist < kScalar2) {
-                x_dist = kScalar2 - x_dist;
-                y_dist = kScalar2 - y_dist;
-
-                SkScalar dist = SkScalarSqrt(SkScalarSquare(x_dist) +
-                                             SkScalarSquare(y_dist));
-                dist = SkMaxScalar(kScalar2 - dist, 0);
-                weight = SkMinScalar(SkScalarSquare(dist), SK_Scalar1);
-            } else {
-                SkScalar sqDist = SkMinScalar(SkScalarSquare(x_dist),
-                                              SkScalarSquare(y_dist));
-                weight = SkMinScalar(sqDist, SK_Scalar1);
-            }
 
-            SkScalar x_interp = SkScalarMul(weight, (fSrcRect.x() + x * inv_x_zoom)) +
-                           (SK_Scalar1 - weight) * x;
-            SkScalar y_interp = SkScalarMul(weight, (fSrcRect.y() + y * inv_y_zoom)) +
-                           (SK_Scalar1 - weight) * y;
+    // Inside the inset the lens weight is 1, so a pixel there reads from the
+    // zoomed column of its column and the zoomed row of its row.
+    SkAutoTMalloc<int> zoomedX(width);
+    for (int x = 0; x < width; ++x) {
+        zoomedX[x] = SkPin32(SkScalarFloorToInt(fSrcRect.x() + x * inv_x_zoom), 0, width - 1);
+    }
 
-            int x_val = SkPin32(SkScalarFloorToInt(x_interp), 0, width - 1);
-            int y_val = SkPin32(SkScalarFloorToInt(y_interp), 0, height - 1);
+    LensSpan span = { sptr, width, height, fSrcRect.x(), fSrcRect.y(),
+                      inv_inset, inv_x_zoom, inv_y_zoom };
+    for (int y = 0; y < height; ++y) {
+        SkScalar y_dist = edge_distance(y, height, inv_inset);
+        // Columns [left, right) are inside the inset.
+        int left = width, right = width;
+        if (SkScalarSquare(y_dist) >= SK_Scalar1) {
+            left = 0;
+            while (left < width && !inside_inset(edge_distance(left, width, inv_inset), y_dist)) {
+                ++left;
+            }
+            right = width;
+            while (right > left &&
+                   !inside_inset(edge_distance(right - 1, width, inv_inset), y_dist)) {
+                --right;
+            }
+        }
 
-            *dptr = sptr[y_val * width + x_val];
-            dptr++;
+        span.magnify(0, left, y, dptr);
+        int y_val = SkPin32(SkScalarFloorToInt(fSrcRect.y() + y * inv_y_zoom), 0, height - 1);
+        const SkColor* zoomedRow = sptr + y_val * width;
+        for (int x = left; x < right; ++x) {
+            dptr[x] = zoomedRow[zoomedX[x]];
         }
+        span.magnify(right, width, y, dptr);
+        dptr += width;
     }
     return true;
 }
@@ -8,6 +8,7 @@
 #include "SkMatrixConvolutionImageFilter.h"
 #include "SkBitmap.h"
 #include "SkColorPriv.h"
+#include "SkMatrixConvolution_opts.h"
 #include "SkReadBuffer.h"
 #include "SkWriteBuffer.h"
 #include "SkRect.h"
@@ -108,13 +109,6 @@ SkMatrixConvolutionImageFilter::~SkMatrixConvolutionImageFilter() {
     delete[] fKernel;
 }
 
-class UncheckedPixelFetcher {
-public:
-    static inline SkPMColor fetch(const SkBitmap& src, int x, int y, const SkIRect& bounds) {
-        return *src.getAddr32(x, y);
-    }
-};
-
 class ClampPixelFetcher {
 public:
     static inline SkPMColor fetch(const SkBitmap& src, int x, int y, const SkIRect& bounds) {
@@ -206,11 +200,151 @@ void SkMatrixConvolutionImageFilter::filterPixels(const SkBitmap& src,
     }
 }
 
+namespace {
+
+// Portable versions of SkConvolvePixelsProc and SkSumRowsProc.
+void convolve_pixels(const SkPMColor* src, int srcStride,
+                     const SkScalar* kernel, int kernelWidth, int kernelHeight,
+                     SkScalar* sums, int count) {
+    for (int i = 0; i < count; ++i) {
+        SkScalar sum[4] = { 0, 0, 0, 0 };
+        const SkPMColor* row = src + i;
+        const SkScalar* k = kernel;
+        for (int cy = 0; cy < kernelHeight; ++cy) {
+            for (int cx = 0; cx < kernelWidth; ++cx) {
+                for (int c = 0; c < 4; ++c) {
+                    sum[c] += SkScalarMul(SkIntToScalar((row[cx] >> (8 * c)) & 0xFF), *k);
+                }
+                ++k;
+            }
+            row += srcStride;
+        }
+        memcpy(sums + 4 * i, sum, sizeof(sum));
+    }
+}
+
+void sum_rows(const SkScalar* const rows[], const SkScalar* weights,
+              int rowCount, SkScalar* dst, int count) {
+    for (int i = 0; i < count; ++i) {
+        SkScalar sum = 0;
+        for (int j = 0; j < rowCount; ++j) {
+            sum += SkScalarMul(rows[j][i], weights[j]);
+        }
+        dst[i] = sum;
+    }
+}
+
+// If kernel is the product of a column and a row, to within rounding, sets
+// kernelX to the row and kernelY to the column and returns true.
+bool separate_kernel(const SkScalar* kernel, int width, int height,
+                     SkScalar* kernelX, SkScalar* kernelY) {
+    // Factor through the largest weight, then check every weight.
+    int pivot = 0;
+    for (int i = 1; i < width * height; ++i) {
+        if (SkScalarAbs(kernel[i]) > SkScalarAbs(kernel[pivot])) {
+            pivot = i;
+        }
+    }
+    if (0 == kernel[pivot]) {
+        return false;
+    }
+    int pivotX = pivot % width, pivotY = pivot / width;
+    for (int x = 0; x < width; ++x) {
+        kernelX[x] = kernel[pivotY * width + x];
+    }
+    for (int y = 0; y < height; ++y) {
+        kernelY[y] = SkScalarDiv(kernel[y * width + pivotX], kernel[pivot]);
+    }
+    const SkScalar tolerance = SkScalarAbs(kernel[pivot]) * 1e-6f;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (SkScalarAbs(SkScalarMul(kernelY[y], kernelX[x]) - kernel[y * width + x]) >
+                tolerance) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+inline int scale_sum(SkScalar sum, SkScalar gain, SkScalar bias, int max) {
+    return SkClampMax(SkScalarFloorToInt(SkScalarMul(sum, gain) + bias), max);
+}
+
+// Writes count pixels from their channel sums, as filterPixels() does. Without
+// convolveAlpha, their alpha is that of src.
+void write_pixels(const SkScalar* sums, SkScalar gain, SkScalar bias, bool convolveAlpha,
+                  const SkPMColor* src, SkPMColor* dst, int count) {
+    for (int i = 0; i < count; ++i, sums += 4) {
+        int a = convolveAlpha ? scale_sum(sums[SK_A32_SHIFT / 8], gain, bias, 255) : 255;
+        int r = scale_sum(sums[SK_R32_SHIFT / 8], gain, bias, a);
+        int g = scale_sum(sums[SK_G32_SHIFT / 8], gain, bias, a);
+        int b = scale_sum(sums[SK_B32_SHIFT / 8], gain, bias, a);
+        if (!convolveAlpha) {
+            a = SkGetPackedA32(src[i]);
+            dst[i] = SkPreMultiplyARGB(a, r, g, b);
+        } else {
+            dst[i] = SkPackARGB32(a, r, g, b);
+        }
+    }
+}
+
+}  // namespace
+
 void SkMatrixConvolutionImageFilter::filterInteriorPixels(const SkBitmap& src,
                                                           SkBitmap* result,
-                                                          const SkIRect& rect,
+                                                          const SkIRect& r,
                                                           const SkIRect& bounds) const {
-    filterPixels<UncheckedPixelFetcher>(src, result, rect, bounds);
+    SkIRect rect(r);
+    if (!rect.intersect(bounds)) {
+        return;
+    }
+    SkConvolvePixelsProc convolvePixels;
+    SkSumRowsProc sumRows;
+    if (!SkMatrixConvolutionGetPlatformProcs(&convolvePixels, &sumRows)) {
+        convolvePixels = convolve_pixels;
+        sumRows = sum_rows;
+    }
+
+    const int kernelWidth = fKernelSize.width();
+    const int kernelHeight = fKernelSize.height();
+    const int width = rect.width();
+    const int srcStride = src.rowBytesAsPixels();
+    SkAutoTMalloc<SkScalar> sums(4 * width);
+    SkAutoSTMalloc<16, SkScalar> kernelX(kernelWidth);
+    SkAutoSTMalloc<16, SkScalar> kernelY(kernelHeight);
+    const bool worthSeparating = kernelWidth > 1 && kernelHeight > 1 &&
+                                 kernelWidth * kernelHeight > kernelWidth + kernelHeight;
+    if (worthSeparating &&
+        separate_kernel(fKernel, kernelWidth, kernelHeight, kernelX.get(), kernelY.get())) {
+        // Convolve each source row with kernelX once, keeping the last
+        // kernelHeight of them; each output row then sums those with kernelY.
+        const int rowSize = 4 * width;
+        SkAutoTMalloc<SkScalar> rowSums(rowSize * kernelHeight);
+        SkAutoSTMalloc<16, const SkScalar*> rows(kernelHeight);
+        for (int y = rect.fTop; y < rect.fBottom; ++y) {
+            const int top = y - fKernelOffset.fY;
+            const int firstNewRow = y == rect.fTop ? top : top + kernelHeight - 1;
+            for (int sy = firstNewRow; sy < top + kernelHeight; ++sy) {
+                convolvePixels(src.getAddr32(rect.fLeft - fKernelOffset.fX, sy), srcStride,
+                               kernelX.get(), kernelWidth, 1,
+                               rowSums.get() + rowSize * (sy % kernelHeight), width);
+            }
+            for (int j = 0; j < kernelHeight; ++j) {
+                rows[j] = rowSums.get() + rowSize * ((top + j) % kernelHeight);
+            }
+            sumRows(rows.get(), kernelY.get(), kernelHeight, sums.get(), rowSize);
+            write_pixels(sums.get(), fGain, fBias, fConvolveAlpha, src.getAddr32(rect.fLeft, y),
+                         result->getAddr32(rect.fLeft - bounds.fLeft, y - bounds.fTop), width);
+        }
+    } else {
+        for (int y = rect.fTop; y < rect.fBottom; ++y) {
+            convolvePixels(src.getAddr32(rect.fLeft - fKernelOffset.fX, y - fKernelOffset.fY),
+                           srcStride, fKernel, kernelWidth, kernelHeight, sums.get(), width);
+            write_pixels(sums.get(), fGain, fBias, fConvolveAlpha, src.getAddr32(rect.fLeft, y),
+                         result->getAddr32(rect.fLeft - bounds.fLeft, y - bounds.fTop), width);
+        }
+    }
 }
 
 void SkMatrixConvolutionImageFilter::filterBorderPixels(const SkBitmap& src,
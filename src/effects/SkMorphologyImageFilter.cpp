@@ -11,6 +11,7 @@
 #include "SkReadBuffer.h"
 #include "SkWriteBuffer.h"
 #include "SkRect.h"
+#include "SkTemplates.h"
 #include "SkMorphology_opts.h"
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
@@ -18,6 +19,7 @@
 #include "GrTBackendEffectFactory.h"
 #include "gl/GrGLEffect.h"
 #include "effects/Gr1DKernelEffect.h"
+#include "SkTArray.h"
 #endif
 
 SkMorphologyImageFilter::SkMorphologyImageFilter(SkReadBuffer& buffer)
@@ -42,12 +44,34 @@ void SkMorphologyImageFilter::flatten(SkWriteBuffer& buffer) const {
     buffer.writeInt(fRadius.fHeight);
 }
 
+enum MorphType {
+    kDilate, kErode
+};
+
 enum MorphDirection {
     kX, kY
 };
 
-template<MorphDirection direction>
-static void erode(const SkPMColor* src, SkPMColor* dst,
+template<MorphType type>
+static inline SkPMColor morph_pixels(SkPMColor c0, SkPMColor c1) {
+    int a0 = SkGetPackedA32(c0), a1 = SkGetPackedA32(c1);
+    int r0 = SkGetPackedR32(c0), r1 = SkGetPackedR32(c1);
+    int g0 = SkGetPackedG32(c0), g1 = SkGetPackedG32(c1);
+    int b0 = SkGetPackedB32(c0), b1 = SkGetPackedB32(c1);
+    if (type == kDilate) {
+        return SkPackARGB32(SkMax32(a0, a1), SkMax32(r0, r1), SkMax32(g0, g1), SkMax32(b0, b1));
+    }
+    return SkPackARGB32(SkMin32(a0, a1), SkMin32(r0, r1), SkMin32(g0, g1), SkMin32(b0, b1));
+}
+
+/* The van Herk/Gil-Werman algorithm, whose cost per pixel doesn't depend on
+ * the radius. Each line is padded by radius pixels that don't change the
+ * result, and split into blocks as wide as the window. Every window then spans
+ * the end of one block and the start of the next, so it is the min or max of
+ * a suffix of one and a prefix of the other, both running mins or maxes.
+ */
+template<MorphType type, MorphDirection direction>
+static void morph(const SkPMColor* src, SkPMColor* dst,
                   int radius, int width, int height,
                   int srcStride, int dstStride)
 {
@@ -56,69 +80,42 @@ static void erode(const SkPMColor* src, SkPMColor* dst,
     const int srcStrideY = direction == kX ? srcStride : 1;
     const int dstStrideY = direction == kX ? dstStride : 1;
     radius = SkMin32(radius, width - 1);
-    const SkPMColor* upperSrc = src + radius * srcStrideX;
-    for (int x = 0; x < width; ++x) {
-        const SkPMColor* lp = src;
-        const SkPMColor* up = upperSrc;
-        SkPMColor* dptr = dst;
-        for (int y = 0; y < height; ++y) {
-            int minB = 255, minG = 255, minR = 255, minA = 255;
-            for (const SkPMColor* p = lp; p <= up; p += srcStrideX) {
-                int b = SkGetPackedB32(*p);
-                int g = SkGetPackedG32(*p);
-                int r = SkGetPackedR32(*p);
-                int a = SkGetPackedA32(*p);
-                if (b < minB) minB = b;
-                if (g < minG) minG = g;
-                if (r < minR) minR = r;
-                if (a < minA) minA = a;
+    const int window = 2 * radius + 1;
+    const int padded = width + 2 * radius;
+    const SkPMColor identity = type == kDilate ? 0 : 0xFFFFFFFF;
+
+    // prefix[i] and suffix[i] are the min or max from the start of i's block
+    // to i, and from i to the end of its block.
+    SkAutoTMalloc<SkPMColor> storage(2 * padded);
+    SkPMColor* prefix = storage.get();
+    SkPMColor* suffix = prefix + padded;
+    for (int y = 0; y < height; ++y) {
+        for (int i = 0, block = 0; i < padded; ++i, ++block) {
+            SkPMColor c = identity;
+            if (i >= radius && i < radius + width) {
+                c = src[(i - radius) * srcStrideX];
             }
-            *dptr = SkPackARGB32(minA, minR, minG, minB);
-            dptr += dstStrideY;
-            lp += srcStrideY;
-            up += srcStrideY;
+            if (block == window) {
+                block = 0;
+            }
+            prefix[i] = block ? morph_pixels<type>(prefix[i - 1], c) : c;
+            suffix[i] = c;
         }
-        if (x >= radius) src += srcStrideX;
-        if (x + radius < width - 1) upperSrc += srcStrideX;
-        dst += dstStrideX;
-    }
-}
-
-template<MorphDirection direction>
-static void dilate(const SkPMColor* src, SkPMColor* dst,
-                   int radius, int width, int height,
-                   int srcStride, int dstStride)
-{
-    const int srcStrideX = direction == kX ? 1 : srcStride;
-    const int dstStrideX = direction == kX ? 1 : dstStride;
-    const int srcStrideY = direction == kX ? srcStride : 1;
-    const int dstStrideY = direction == kX ? dstStride : 1;
-    radius = SkMin32(radius, width - 1);
-    const SkPMColor* upperSrc = src + radius * srcStrideX;
-    for (int x = 0; x < width; ++x) {
-        const SkPMColor* lp = src;
-        const SkPMColor* up = upperSrc;
-        SkPMColor* dptr = dst;
-        for (int y = 0; y < height; ++y) {
-            int maxB = 0, maxG = 0, maxR = 0, maxA = 0;
-            for (const SkPMColor* p = lp; p <= up; p += srcStrideX) {
-                int b = SkGetPackedB32(*p);
-                int g = SkGetPackedG32(*p);
-                int r = SkGetPackedR32(*p);
-                int a = SkGetPackedA32(*p);
-                if (b > maxB) maxB = b;
-                if (g > maxG) maxG = g;
-                if (r > maxR) maxR = r;
-                if (a > maxA) maxA = a;
+        for (int i = padded - 2, block = (padded - 2) % window; i >= 0; --i, --block) {
+            if (block < 0) {
+                block = window - 1;
             }
-            *dptr = SkPackARGB32(maxA, maxR, maxG, maxB);
-            dptr += dstStrideY;
-            lp += srcStrideY;
-            up += srcStrideY;
+            if (block != window - 1) {
+                suffix[i] = morph_pixels<type>(suffix[i], suffix[i + 1]);
+            }
+        }
+        SkPMColor* dptr = dst;
+        for (int x = 0; x < width; ++x) {
+            *dptr = morph_pixels<type>(suffix[x], prefix[x + 2 * radius]);
+            dptr += dstStrideX;
         }
-        if (x >= radius) src += srcStrideX;
-        if (x + radius < width - 1) upperSrc += srcStrideX;
-        dst += dstStrideX;
+        src += srcStrideY;
+        dst += dstStrideY;
     }
 }
 
@@ -211,11 +208,11 @@ bool SkErodeImageFilter::onFilterImage(Proxy* proxy,
                                        SkBitmap* dst, SkIPoint* offset) const {
     Proc erodeXProc = SkMorphologyGetPlatformProc(kErodeX_SkMorphologyProcType);
     if (!erodeXProc) {
-        erodeXProc = erode<kX>;
+        erodeXProc = morph<kErode, kX>;
     }
     Proc erodeYProc = SkMorphologyGetPlatformProc(kErodeY_SkMorphologyProcType);
     if (!erodeYProc) {
-        erodeYProc = erode<kY>;
+        erodeYProc = morph<kErode, kY>;
     }
     return this->filterImageGeneric(erodeXProc, erodeYProc, proxy, source, ctx, dst, offset);
 }
@@ -225,11 +222,11 @@ bool SkDilateImageFilter::onFilterImage(Proxy* proxy,
                                         SkBitmap* dst, SkIPoint* offset) const {
     Proc dilateXProc = SkMorphologyGetPlatformProc(kDilateX_SkMorphologyProcType);
     if (!dilateXProc) {
-        dilateXProc = dilate<kX>;
+        dilateXProc = morph<kDilate, kX>;
     }
     Proc dilateYProc = SkMorphologyGetPlatformProc(kDilateY_SkMorphologyProcType);
     if (!dilateYProc) {
-        dilateYProc = dilate<kY>;
+        dilateYProc = morph<kDilate, kY>;
     }
     return this->filterImageGeneric(dilateXProc, dilateYProc, proxy, source, ctx, dst, offset);
 }
@@ -267,7 +264,8 @@ class GrGLMorphologyEffect;
  * Morphology effects. Depending upon the type of morphology, either the
  * component-wise min (Erode_Type) or max (Dilate_Type) of all pixels in the
  * kernel is selected as the new color. The new color is modulated by the input
- * color.
+ * color. The kernel's texels are step texels apart, so that a pass can combine
+ * the results of an earlier one.
  */
 class GrMorphologyEffect : public Gr1DKernelEffect {
 
@@ -278,14 +276,16 @@ public:
         kDilate_MorphologyType,
     };
 
-    static GrEffectRef* Create(GrTexture* tex, Direction dir, int radius, MorphologyType type) {
-        AutoEffectUnref effect(SkNEW_ARGS(GrMorphologyEffect, (tex, dir, radius, type)));
+    static GrEffectRef* Create(GrTexture* tex, Direction dir, int radius, int step,
+                               MorphologyType type) {
+        AutoEffectUnref effect(SkNEW_ARGS(GrMorphologyEffect, (tex, dir, radius, step, type)));
         return CreateEffectRef(effect);
     }
 
     virtual ~GrMorphologyEffect();
 
     MorphologyType type() const { return fType; }
+    int step() const { return fStep; }
 
     static const char* Name() { return "Morphology"; }
 
@@ -297,11 +297,12 @@ public:
 protected:
 
     MorphologyType fType;
+    int            fStep;
 
 private:
     virtual bool onIsEqual(const GrEffect&) const SK_OVERRIDE;
 
-    GrMorphologyEffect(GrTexture*, Direction, int radius, MorphologyType);
+    GrMorphologyEffect(GrTexture*, Direction, int radius, int step, MorphologyType);
 
     GR_DECLARE_EFFECT_TEST;
 
@@ -394,17 +395,17 @@ GrGLEffect::EffectKey GrGLMorphologyEffect::GenKey(const GrDrawEffect& drawEffec
 
 void GrGLMorphologyEffect::setData(const GrGLUniformManager& uman,
                                    const GrDrawEffect& drawEffect) {
-    const Gr1DKernelEffect& kern = drawEffect.castEffect<Gr1DKernelEffect>();
+    const GrMorphologyEffect& kern = drawEffect.castEffect<GrMorphologyEffect>();
     GrTexture& texture = *kern.texture(0);
     // the code we generated was for a specific kernel radius
     SkASSERT(kern.radius() == fRadius);
     float imageIncrement[2] = { 0 };
     switch (kern.direction()) {
         case Gr1DKernelEffect::kX_Direction:
-            imageIncrement[0] = 1.0f / texture.width();
+            imageIncrement[0] = SkIntToScalar(kern.step()) / texture.width();
             break;
         case Gr1DKernelEffect::kY_Direction:
-            imageIncrement[1] = 1.0f / texture.height();
+            imageIncrement[1] = SkIntToScalar(kern.step()) / texture.height();
             break;
         default:
             SkFAIL("Unknown filter direction.");
@@ -417,9 +418,11 @@ void GrGLMorphologyEffect::setData(const GrGLUniformManager& uman,
 GrMorphologyEffect::GrMorphologyEffect(GrTexture* texture,
                                        Direction direction,
                                        int radius,
+                                       int step,
                                        MorphologyType type)
     : Gr1DKernelEffect(texture, direction, radius)
-    , fType(type) {
+    , fType(type)
+    , fStep(step) {
 }
 
 GrMorphologyEffect::~GrMorphologyEffect() {
@@ -434,6 +437,7 @@ bool GrMorphologyEffect::onIsEqual(const GrEffect& sBase) const {
     return (this->texture(0) == s.texture(0) &&
             this->radius() == s.radius() &&
             this->direction() == s.direction() &&
+            this->step() == s.step() &&
             this->type() == s.type());
 }
 
@@ -456,25 +460,72 @@ GrEffectRef* GrMorphologyEffect::TestCreate(SkRandom* random,
     Direction dir = random->nextBool() ? kX_Direction : kY_Direction;
     static const int kMaxRadius = 10;
     int radius = random->nextRangeU(1, kMaxRadius);
+    int step = random->nextRangeU(1, kMaxRadius);
     MorphologyType type = random->nextBool() ? GrMorphologyEffect::kErode_MorphologyType :
                                                GrMorphologyEffect::kDilate_MorphologyType;
 
-    return GrMorphologyEffect::Create(textures[texIdx], dir, radius, type);
+    return GrMorphologyEffect::Create(textures[texIdx], dir, radius, step, type);
 }
 
 namespace {
 
+// Kernels up to this radius are read in one pass. Wider ones are split into
+// passes of kPassRadius, then of radius 1, each reading the texels the one
+// before combined, and a last pass of radius 1 that spans what's left.
+const int kMaxSinglePassRadius = 8;
+const int kPassRadius = 4;
+
+struct MorphologyPass {
+    int                         fRadius;
+    int                         fStep;
+    Gr1DKernelEffect::Direction fDirection;
+};
+
+// Appends passes whose kernels together span 2 * radius + 1 texels. As min and
+// max don't mind reading a texel twice, the last pass may overlap the ones
+// before, so any radius splits into about log(radius) passes.
+void add_morphology_passes(int radius, Gr1DKernelEffect::Direction direction,
+                           SkTArray<MorphologyPass, true>* passes) {
+    if (radius <= 0) {
+        return;
+    }
+    if (radius <= kMaxSinglePassRadius) {
+        MorphologyPass pass = { radius, 1, direction };
+        passes->push_back(pass);
+        return;
+    }
+    const int width = Gr1DKernelEffect::WidthFromRadius(radius);
+    const int passWidth = Gr1DKernelEffect::WidthFromRadius(kPassRadius);
+    // How many texels the passes so far span.
+    int spanned = 1;
+    while (spanned * passWidth * 3 <= width) {
+        MorphologyPass pass = { kPassRadius, spanned, direction };
+        passes->push_back(pass);
+        spanned *= passWidth;
+    }
+    while (spanned * 3 <= width) {
+        MorphologyPass pass = { 1, spanned, direction };
+        passes->push_back(pass);
+        spanned *= 3;
+    }
+    if (spanned < width) {
+        // spanned > width / 3, so the three reads' spans meet or overlap.
+        MorphologyPass pass = { 1, (width - spanned) / 2, direction };
+        passes->push_back(pass);
+    }
+}
+
 void apply_morphology_pass(GrContext* context,
                            GrTexture* texture,
                            const SkIRect& srcRect,
                            const SkIRect& dstRect,
-                           int radius,
-                           GrMorphologyEffect::MorphologyType morphType,
-                           Gr1DKernelEffect::Direction direction) {
+                           const MorphologyPass& pass,
+                           GrMorphologyEffect::MorphologyType morphType) {
     GrPaint paint;
     paint.addColorEffect(GrMorphologyEffect::Create(texture,
-                                                    direction,
-                                                    radius,
+                                                    pass.fDirection,
+                                                    pass.fRadius,
+                                                    pass.fStep,
                                                     morphType))->unref();
     context->drawRectToRect(paint, SkRect::Make(dstRect), SkRect::Make(srcRect));
 }
@@ -504,26 +555,28 @@ bool apply_morphology(const SkBitmap& input,
     desc.fConfig = kSkia8888_GrPixelConfig;
     SkIRect srcRect = rect;
 
-    if (radius.fWidth > 0) {
+    SkSTArray<8, MorphologyPass, true> passes;
+    add_morphology_passes(radius.fWidth, Gr1DKernelEffect::kX_Direction, &passes);
+    add_morphology_passes(radius.fHeight, Gr1DKernelEffect::kY_Direction, &passes);
+    for (int i = 0; i < passes.count(); ++i) {
         GrAutoScratchTexture ast(context, desc);
         GrContext::AutoRenderTarget art(context, ast.texture()->asRenderTarget());
-        apply_morphology_pass(context, src, srcRect, dstRect, radius.fWidth,
-                              morphType, Gr1DKernelEffect::kX_Direction);
-        SkIRect clearRect = SkIRect::MakeXYWH(dstRect.fLeft, dstRect.fBottom,
-                                              dstRect.width(), radius.fHeight);
-        context->clear(&clearRect, GrMorphologyEffect::kErode_MorphologyType == morphType ?
-                                   SK_ColorWHITE :
-                                   SK_ColorTRANSPARENT, false);
+        apply_morphology_pass(context, src, srcRect, dstRect, passes[i], morphType);
+        if (i + 1 < passes.count()) {
+            // The scratch texture may be larger than dstRect. Whatever the next
+            // pass reads beyond it must leave the result alone.
+            const MorphologyPass& next = passes[i + 1];
+            int reach = next.fRadius * next.fStep;
+            SkIRect clearRect = Gr1DKernelEffect::kX_Direction == next.fDirection ?
+                SkIRect::MakeXYWH(dstRect.fRight, dstRect.fTop, reach, dstRect.height()) :
+                SkIRect::MakeXYWH(dstRect.fLeft, dstRect.fBottom, dstRect.width(), reach);
+            context->clear(&clearRect, GrMorphologyEffect::kErode_MorphologyType == morphType ?
+                                       SK_ColorWHITE :
+                                       SK_ColorTRANSPARENT, false);
+        }
         src.reset(ast.detach());
         srcRect = dstRect;
     }
-    if (radius.fHeight > 0) {
-        GrAutoScratchTexture ast(context, desc);
-        GrContext::AutoRenderTarget art(context, ast.texture()->asRenderTarget());
-        apply_morphology_pass(context, src, srcRect, dstRect, radius.fHeight,
-                              morphType, Gr1DKernelEffect::kY_Direction);
-        src.reset(ast.detach());
-    }
     SkImageFilter::WrapTexture(src, rect.width(), rect.height(), dst);
     return true;
 }
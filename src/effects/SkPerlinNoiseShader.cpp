@@ -9,11 +9,19 @@
 #include "SkPerlinNoiseShader.h"
 #include "SkColorFilter.h"
 #include "SkReadBuffer.h"
+#include "SkScaledImageCache.h"
 #include "SkWriteBuffer.h"
 #include "SkShader.h"
+#include "SkThread.h"
 #include "SkUnPreMultiply.h"
 #include "SkString.h"
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+    #include <arm_neon.h>
+#endif
+
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
 #include "GrCoordTransform.h"
@@ -26,6 +34,8 @@ static const int kBlockSize = 256;
 static const int kBlockMask = kBlockSize - 1;
 static const int kPerlinNoise = 4096;
 static const int kRandMaximum = SK_MaxS32; // 2**31 - 1
+// Larger stitched tiles are generated as they are drawn rather than cached.
+static const int kMaxCachedTileArea = 1024 * 1024;
 
 namespace {
 
@@ -54,6 +64,38 @@ bool perlin_noise_type_is_valid(SkPerlinNoiseShader::Type type) {
            (SkPerlinNoiseShader::kTurbulence_Type == type);
 }
 
+uint32_t next_perlin_noise_unique_id() {
+    static int32_t gPerlinNoiseUniqueID;
+
+    // Never return 0.
+    int32_t id;
+    do {
+        id = sk_atomic_inc(&gPerlinNoiseUniqueID) + 1;
+    } while (0 == id);
+    return id;
+}
+
+// The four channels' gradients dotted with (fx, fy), and interpolations between
+// them, in the same order of operations as SkPoint::dot() and SkScalarInterp().
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+inline __m128 dot_SSE2(const SkScalar gx[4], const SkScalar gy[4], __m128 fx, __m128 fy) {
+    return _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(gx), fx), _mm_mul_ps(_mm_loadu_ps(gy), fy));
+}
+
+inline __m128 interp_SSE2(__m128 a, __m128 b, __m128 t) {
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+#elif defined(__ARM_NEON__)
+inline float32x4_t dot_neon(const SkScalar gx[4], const SkScalar gy[4],
+                            float32x4_t fx, float32x4_t fy) {
+    return vaddq_f32(vmulq_f32(vld1q_f32(gx), fx), vmulq_f32(vld1q_f32(gy), fy));
+}
+
+inline float32x4_t interp_neon(float32x4_t a, float32x4_t b, float32x4_t t) {
+    return vaddq_f32(a, vmulq_f32(vsubq_f32(b, a), t));
+}
+#endif
+
 } // end namespace
 
 struct SkPerlinNoiseShader::StitchData {
@@ -100,7 +142,10 @@ struct SkPerlinNoiseShader::PaintingData {
     int         fSeed;
     uint8_t     fLatticeSelector[kBlockSize];
     uint16_t    fNoise[4][kBlockSize][2];
-    SkPoint     fGradient[4][kBlockSize];
+    // The normalized gradients, with the four channels side by side so that
+    // noise2D() can evaluate them together.
+    SkScalar    fGradientX[kBlockSize][4];
+    SkScalar    fGradientY[kBlockSize][4];
     SkISize     fTileSize;
     SkVector    fBaseFrequency;
     StitchData  fStitchDataInit;
@@ -181,17 +226,19 @@ private:
         // Compute gradients from permutated noise data
         for (int channel = 0; channel < 4; ++channel) {
             for (int i = 0; i < kBlockSize; ++i) {
-                fGradient[channel][i] = SkPoint::Make(
+                SkPoint gradient = SkPoint::Make(
                     SkScalarMul(SkIntToScalar(fNoise[channel][i][0] - kBlockSize),
                                 gInvBlockSizef),
                     SkScalarMul(SkIntToScalar(fNoise[channel][i][1] - kBlockSize),
                                 gInvBlockSizef));
-                fGradient[channel][i].normalize();
+                gradient.normalize();
+                fGradientX[i][channel] = gradient.fX;
+                fGradientY[i][channel] = gradient.fY;
                 // Put the normalized gradient back into the noise data
                 fNoise[channel][i][0] = SkScalarRoundToInt(SkScalarMul(
-                    fGradient[channel][i].fX + SK_Scalar1, gHalfMax16bits));
+                    gradient.fX + SK_Scalar1, gHalfMax16bits));
                 fNoise[channel][i][1] = SkScalarRoundToInt(SkScalarMul(
-                    fGradient[channel][i].fY + SK_Scalar1, gHalfMax16bits));
+                    gradient.fY + SK_Scalar1, gHalfMax16bits));
             }
         }
     }
@@ -273,6 +320,7 @@ SkPerlinNoiseShader::SkPerlinNoiseShader(SkPerlinNoiseShader::Type type,
   , fSeed(seed)
   , fTileSize(NULL == tileSize ? SkISize::Make(0, 0) : *tileSize)
   , fStitchTiles(!fTileSize.isEmpty())
+  , fUniqueID(next_perlin_noise_unique_id())
 {
     SkASSERT(numOctaves >= 0 && numOctaves < 256);
     fPaintingData = SkNEW_ARGS(PaintingData, (fTileSize, fSeed, fBaseFrequencyX, fBaseFrequencyY));
@@ -289,6 +337,7 @@ SkPerlinNoiseShader::SkPerlinNoiseShader(SkReadBuffer& buffer)
     fStitchTiles    = buffer.readBool();
     fTileSize.fWidth  = buffer.readInt();
     fTileSize.fHeight = buffer.readInt();
+    fUniqueID = next_perlin_noise_unique_id();
     fPaintingData = SkNEW_ARGS(PaintingData, (fTileSize, fSeed, fBaseFrequencyX, fBaseFrequencyY));
     buffer.validate(perlin_noise_type_is_valid(fType) &&
                     (fNumOctaves >= 0) && (fNumOctaves <= 255) &&
@@ -312,9 +361,9 @@ void SkPerlinNoiseShader::flatten(SkWriteBuffer& buffer) const {
     buffer.writeInt(fTileSize.fHeight);
 }
 
-SkScalar SkPerlinNoiseShader::PerlinNoiseShaderContext::noise2D(
-        int channel, const PaintingData& paintingData,
-        const StitchData& stitchData, const SkPoint& noiseVector) const {
+void SkPerlinNoiseShader::PerlinNoiseShaderContext::noise2D(
+        const PaintingData& paintingData, const StitchData& stitchData,
+        const SkPoint& noiseVector, SkScalar noise[4]) const {
     struct Noise {
         int noisePositionIntegerValue;
         int nextNoisePositionIntegerValue;
@@ -329,7 +378,6 @@ SkScalar SkPerlinNoiseShader::PerlinNoiseShaderContext::noise2D(
     };
     Noise noiseX(noiseVector.x());
     Noise noiseY(noiseVector.y());
-    SkScalar u, v;
     const SkPerlinNoiseShader& perlinNoiseShader = static_cast<const SkPerlinNoiseShader&>(fShader);
     // If stitching, adjust lattice points accordingly.
     if (perlinNoiseShader.fStitchTiles) {
@@ -357,36 +405,73 @@ SkScalar SkPerlinNoiseShader::PerlinNoiseShaderContext::noise2D(
     SkScalar sx = smoothCurve(noiseX.noisePositionFractionValue);
     SkScalar sy = smoothCurve(noiseY.noisePositionFractionValue);
     // This is taken 1:1 from SVG spec: http://www.w3.org/TR/SVG11/filters.html#feTurbulenceElement
-    SkPoint fractionValue = SkPoint::Make(noiseX.noisePositionFractionValue,
-                                          noiseY.noisePositionFractionValue); // Offset (0,0)
-    u = paintingData.fGradient[channel][b00].dot(fractionValue);
-    fractionValue.fX -= SK_Scalar1; // Offset (-1,0)
-    v = paintingData.fGradient[channel][b10].dot(fractionValue);
-    SkScalar a = SkScalarInterp(u, v, sx);
-    fractionValue.fY -= SK_Scalar1; // Offset (-1,-1)
-    v = paintingData.fGradient[channel][b11].dot(fractionValue);
-    fractionValue.fX = noiseX.noisePositionFractionValue; // Offset (0,-1)
-    u = paintingData.fGradient[channel][b01].dot(fractionValue);
-    SkScalar b = SkScalarInterp(u, v, sx);
-    return SkScalarInterp(a, b, sy);
+    // The lattice is the same for every channel, so they are evaluated together.
+    SkScalar fx = noiseX.noisePositionFractionValue;
+    SkScalar fy = noiseY.noisePositionFractionValue;
+    const SkScalar (*gradientX)[4] = paintingData.fGradientX;
+    const SkScalar (*gradientY)[4] = paintingData.fGradientY;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 fx0 = _mm_set1_ps(fx), fx1 = _mm_set1_ps(fx - SK_Scalar1);
+    const __m128 fy0 = _mm_set1_ps(fy), fy1 = _mm_set1_ps(fy - SK_Scalar1);
+    const __m128 sx4 = _mm_set1_ps(sx);
+    __m128 u = dot_SSE2(gradientX[b00], gradientY[b00], fx0, fy0); // Offset (0,0)
+    __m128 v = dot_SSE2(gradientX[b10], gradientY[b10], fx1, fy0); // Offset (-1,0)
+    __m128 a = interp_SSE2(u, v, sx4);
+    v = dot_SSE2(gradientX[b11], gradientY[b11], fx1, fy1); // Offset (-1,-1)
+    u = dot_SSE2(gradientX[b01], gradientY[b01], fx0, fy1); // Offset (0,-1)
+    __m128 b = interp_SSE2(u, v, sx4);
+    _mm_storeu_ps(noise, interp_SSE2(a, b, _mm_set1_ps(sy)));
+#elif defined(__ARM_NEON__)
+    const float32x4_t fx0 = vdupq_n_f32(fx), fx1 = vdupq_n_f32(fx - SK_Scalar1);
+    const float32x4_t fy0 = vdupq_n_f32(fy), fy1 = vdupq_n_f32(fy - SK_Scalar1);
+    const float32x4_t sx4 = vdupq_n_f32(sx);
+    float32x4_t u = dot_neon(gradientX[b00], gradientY[b00], fx0, fy0); // Offset (0,0)
+    float32x4_t v = dot_neon(gradientX[b10], gradientY[b10], fx1, fy0); // Offset (-1,0)
+    float32x4_t a = interp_neon(u, v, sx4);
+    v = dot_neon(gradientX[b11], gradientY[b11], fx1, fy1); // Offset (-1,-1)
+    u = dot_neon(gradientX[b01], gradientY[b01], fx0, fy1); // Offset (0,-1)
+    float32x4_t b = interp_neon(u, v, sx4);
+    vst1q_f32(noise, interp_neon(a, b, vdupq_n_f32(sy)));
+#else
+    for (int channel = 0; channel < 4; ++channel) {
+        SkPoint fractionValue = SkPoint::Make(fx, fy); // Offset (0,0)
+        SkScalar u = fractionValue.dot(SkPoint::Make(gradientX[b00][channel],
+                                                     gradientY[b00][channel]));
+        fractionValue.fX -= SK_Scalar1; // Offset (-1,0)
+        SkScalar v = fractionValue.dot(SkPoint::Make(gradientX[b10][channel],
+                                                     gradientY[b10][channel]));
+        SkScalar a = SkScalarInterp(u, v, sx);
+        fractionValue.fY -= SK_Scalar1; // Offset (-1,-1)
+        v = fractionValue.dot(SkPoint::Make(gradientX[b11][channel], gradientY[b11][channel]));
+        fractionValue.fX = fx; // Offset (0,-1)
+        u = fractionValue.dot(SkPoint::Make(gradientX[b01][channel], gradientY[b01][channel]));
+        SkScalar b = SkScalarInterp(u, v, sx);
+        noise[channel] = SkScalarInterp(a, b, sy);
+    }
+#endif
 }
 
-SkScalar SkPerlinNoiseShader::PerlinNoiseShaderContext::calculateTurbulenceValueForPoint(
-        int channel, const PaintingData& paintingData,
-        StitchData& stitchData, const SkPoint& point) const {
+void SkPerlinNoiseShader::PerlinNoiseShaderContext::calculateTurbulenceValuesForPoint(
+        const PaintingData& paintingData, StitchData& stitchData,
+        const SkPoint& point, SkScalar values[4]) const {
     const SkPerlinNoiseShader& perlinNoiseShader = static_cast<const SkPerlinNoiseShader&>(fShader);
     if (perlinNoiseShader.fStitchTiles) {
         // Set up TurbulenceInitial stitch values.
         stitchData = paintingData.fStitchDataInit;
     }
-    SkScalar turbulenceFunctionResult = 0;
+    SkScalar turbulenceFunctionResult[4] = { 0, 0, 0, 0 };
     SkPoint noiseVector(SkPoint::Make(SkScalarMul(point.x(), paintingData.fBaseFrequency.fX),
                                       SkScalarMul(point.y(), paintingData.fBaseFrequency.fY)));
     SkScalar ratio = SK_Scalar1;
     for (int octave = 0; octave < perlinNoiseShader.fNumOctaves; ++octave) {
-        SkScalar noise = noise2D(channel, paintingData, stitchData, noiseVector);
-        turbulenceFunctionResult += SkScalarDiv(
-            (perlinNoiseShader.fType == kFractalNoise_Type) ? noise : SkScalarAbs(noise), ratio);
+        SkScalar noise[4];
+        noise2D(paintingData, stitchData, noiseVector, noise);
+        for (int channel = 0; channel < 4; ++channel) {
+            turbulenceFunctionResult[channel] += SkScalarDiv(
+                (perlinNoiseShader.fType == kFractalNoise_Type) ? noise[channel]
+                                                                : SkScalarAbs(noise[channel]),
+                ratio);
+        }
         noiseVector.fX *= 2;
         noiseVector.fY *= 2;
         ratio *= 2;
@@ -399,35 +484,49 @@ SkScalar SkPerlinNoiseShader::PerlinNoiseShaderContext::calculateTurbulenceValue
         }
     }
 
-    // The value of turbulenceFunctionResult comes from ((turbulenceFunctionResult) + 1) / 2
-    // by fractalNoise and (turbulenceFunctionResult) by turbulence.
-    if (perlinNoiseShader.fType == kFractalNoise_Type) {
-        turbulenceFunctionResult =
-            SkScalarMul(turbulenceFunctionResult, SK_ScalarHalf) + SK_ScalarHalf;
-    }
+    for (int channel = 0; channel < 4; ++channel) {
+        SkScalar result = turbulenceFunctionResult[channel];
+        // The value of turbulenceFunctionResult comes from ((turbulenceFunctionResult) + 1) / 2
+        // by fractalNoise and (turbulenceFunctionResult) by turbulence.
+        if (perlinNoiseShader.fType == kFractalNoise_Type) {
+            result = SkScalarMul(result, SK_ScalarHalf) + SK_ScalarHalf;
+        }
 
-    if (channel == 3) { // Scale alpha by paint value
-        turbulenceFunctionResult = SkScalarMul(turbulenceFunctionResult,
-            SkScalarDiv(SkIntToScalar(getPaintAlpha()), SkIntToScalar(255)));
-    }
+        if (channel == 3) { // Scale alpha by paint value
+            result = SkScalarMul(result,
+                SkScalarDiv(SkIntToScalar(getPaintAlpha()), SkIntToScalar(255)));
+        }
 
-    // Clamp result
-    return SkScalarPin(turbulenceFunctionResult, 0, SK_Scalar1);
+        // Clamp result
+        values[channel] = SkScalarPin(result, 0, SK_Scalar1);
+    }
 }
 
 SkPMColor SkPerlinNoiseShader::PerlinNoiseShaderContext::shade(
         const SkPoint& point, StitchData& stitchData) const {
-    const SkPerlinNoiseShader& perlinNoiseShader = static_cast<const SkPerlinNoiseShader&>(fShader);
     SkPoint newPoint;
     fMatrix.mapPoints(&newPoint, &point, 1);
     newPoint.fX = SkScalarRoundToScalar(newPoint.fX);
     newPoint.fY = SkScalarRoundToScalar(newPoint.fY);
 
+    if (newPoint.fX >= 0 && newPoint.fX < SkIntToScalar(fTile.width()) &&
+        newPoint.fY >= 0 && newPoint.fY < SkIntToScalar(fTile.height())) {
+        return *fTile.getAddr32(SkScalarTruncToInt(newPoint.fX),
+                                SkScalarTruncToInt(newPoint.fY));
+    }
+    return this->generate(newPoint, stitchData);
+}
+
+SkPMColor SkPerlinNoiseShader::PerlinNoiseShaderContext::generate(
+        const SkPoint& patternPoint, StitchData& stitchData) const {
+    const SkPerlinNoiseShader& perlinNoiseShader = static_cast<const SkPerlinNoiseShader&>(fShader);
+    SkScalar values[4];
+    calculateTurbulenceValuesForPoint(*perlinNoiseShader.fPaintingData, stitchData,
+                                      patternPoint, values);
+
     U8CPU rgba[4];
     for (int channel = 3; channel >= 0; --channel) {
-        rgba[channel] = SkScalarFloorToInt(255 *
-            calculateTurbulenceValueForPoint(channel, *perlinNoiseShader.fPaintingData,
-                                             stitchData, newPoint));
+        rgba[channel] = SkScalarFloorToInt(255 * values[channel]);
     }
     return SkPreMultiplyARGB(rgba[3], rgba[0], rgba[1], rgba[2]);
 }
@@ -460,6 +559,61 @@ SkPerlinNoiseShader::PerlinNoiseShaderContext::PerlinNoiseShaderContext(
     newMatrix.postConcat(invMatrix);
     newMatrix.postConcat(invMatrix);
     fMatrix = newMatrix;
+
+    if (shader.fStitchTiles && 0xFF == this->getPaintAlpha()) {
+        this->lockTile();
+    }
+}
+
+void SkPerlinNoiseShader::PerlinNoiseShaderContext::lockTile() {
+    const SkPerlinNoiseShader& perlinNoiseShader = static_cast<const SkPerlinNoiseShader&>(fShader);
+    // The pattern points a tile's pixels land on run from 0 to the tile size
+    // inclusive, because of the (1,1) translation above.
+    SkIRect tile = SkIRect::MakeWH(perlinNoiseShader.fTileSize.width() + 1,
+                                   perlinNoiseShader.fTileSize.height() + 1);
+    if (sk_64_mul(tile.width(), tile.height()) > kMaxCachedTileArea) {
+        return;
+    }
+
+    SkBitmap bm;
+    SkScaledImageCache::ID* id =
+        SkScaledImageCache::FindAndLockShaderTile(perlinNoiseShader.fUniqueID, tile, &bm);
+    if (NULL != id) {
+        bm.lockPixels();
+        if (NULL == bm.getPixels()) {
+            // Its (discardable) pixels were purged; generate the tile again.
+            bm.unlockPixels();
+            SkScaledImageCache::Unlock(id);
+            id = NULL;
+        }
+    }
+
+    if (NULL == id) {
+        bm.reset();
+        bm.setInfo(SkImageInfo::MakeN32Premul(tile.width(), tile.height()));
+        if (!bm.allocPixels(SkScaledImageCache::GetAllocator(), NULL)) {
+            return;
+        }
+        StitchData stitchData;
+        for (int y = 0; y < tile.height(); ++y) {
+            SkPMColor* row = bm.getAddr32(0, y);
+            for (int x = 0; x < tile.width(); ++x) {
+                row[x] = this->generate(SkPoint::Make(SkIntToScalar(x), SkIntToScalar(y)),
+                                        stitchData);
+            }
+        }
+        bm.setImmutable();
+
+        // If the cache won't take it, we can still use the tile ourselves.
+        id = SkScaledImageCache::AddAndLockShaderTile(perlinNoiseShader.fUniqueID, tile, bm);
+    }
+    if (NULL != id) {
+        SkScaledImageCache::Unlock(id);
+    }
+
+    // bm is still locked here, so the pixels survive until fTile locks them too.
+    fTile = bm;
+    fTile.lockPixels();
 }
 
 void SkPerlinNoiseShader::PerlinNoiseShaderContext::shadeSpan(
@@ -41,6 +41,7 @@ public:
     }
 
     virtual bool asComponentTable(SkBitmap* table) const SK_OVERRIDE;
+    virtual SkColorFilter* newComposed(const SkColorFilter* inner) const SK_OVERRIDE;
 
 #if SK_SUPPORT_GPU
     virtual GrEffectRef* asNewEffect(GrContext* context) const SK_OVERRIDE;
@@ -65,6 +66,9 @@ protected:
     virtual void flatten(SkWriteBuffer&) const SK_OVERRIDE;
 
 private:
+    // The A, R, G and B tables, identity where there is none.
+    void getTables(const uint8_t* tables[4]) const;
+
     mutable const SkBitmap* fBitmap; // lazily allocated
 
     uint8_t fStorage[256 * 4];
@@ -108,25 +112,27 @@ static const uint8_t gIdentityTable[] = {
     0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
 };
 
-void SkTable_ColorFilter::filterSpan(const SkPMColor src[], int count,
-                                     SkPMColor dst[]) const {
+void SkTable_ColorFilter::getTables(const uint8_t* tables[4]) const {
+    static const unsigned kFlags[] = { kA_Flag, kR_Flag, kG_Flag, kB_Flag };
     const uint8_t* table = fStorage;
-    const uint8_t* tableA = gIdentityTable;
-    const uint8_t* tableR = gIdentityTable;
-    const uint8_t* tableG = gIdentityTable;
-    const uint8_t* tableB = gIdentityTable;
-    if (fFlags & kA_Flag) {
-        tableA = table; table += 256;
-    }
-    if (fFlags & kR_Flag) {
-        tableR = table; table += 256;
-    }
-    if (fFlags & kG_Flag) {
-        tableG = table; table += 256;
-    }
-    if (fFlags & kB_Flag) {
-        tableB = table;
+    for (int i = 0; i < 4; ++i) {
+        if (fFlags & kFlags[i]) {
+            tables[i] = table;
+            table += 256;
+        } else {
+            tables[i] = gIdentityTable;
+        }
     }
+}
+
+void SkTable_ColorFilter::filterSpan(const SkPMColor src[], int count,
+                                     SkPMColor dst[]) const {
+    const uint8_t* tables[4];
+    this->getTables(tables);
+    const uint8_t* tableA = tables[0];
+    const uint8_t* tableR = tables[1];
+    const uint8_t* tableG = tables[2];
+    const uint8_t* tableB = tables[3];
 
     const SkUnPreMultiply::Scale* scaleTable = SkUnPreMultiply::GetScaleTable();
     for (int i = 0; i < count; ++i) {
@@ -225,10 +231,44 @@ bool SkTable_ColorFilter::asComponentTable(SkBitmap* table) const {
     return true;
 }
 
+SkColorFilter* SkTable_ColorFilter::newComposed(const SkColorFilter* inner) const {
+    SkBitmap innerTable;
+    if (!inner->asComponentTable(&innerTable)) {
+        return NULL;
+    }
+    SkAutoLockPixels alp(innerTable);
+    const uint8_t* innerTables[4];
+    for (int i = 0; i < 4; ++i) {
+        innerTables[i] = innerTable.getAddr8(0, i);
+    }
+    // Where inner makes a color transparent, premultiplying zeroes the rest of
+    // it before this filter sees it, which one table can't do.
+    for (int a = 1; a < 256; ++a) {
+        if (0 == innerTables[0][a]) {
+            return NULL;
+        }
+    }
+    if (0 == innerTables[0][0] &&
+        (innerTables[1][0] || innerTables[2][0] || innerTables[3][0])) {
+        return NULL;
+    }
+
+    const uint8_t* tables[4];
+    this->getTables(tables);
+    uint8_t composed[4][256];
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 256; ++j) {
+            composed[i][j] = tables[i][innerTables[i][j]];
+        }
+    }
+    return SkTableColorFilter::CreateARGB(composed[0], composed[1], composed[2], composed[3]);
+}
+
 #if SK_SUPPORT_GPU
 
 #include "GrEffect.h"
 #include "GrTBackendEffectFactory.h"
+#include "effects/GrTextureStripAtlas.h"
 #include "gl/GrGLEffect.h"
 #include "SkGr.h"
 
@@ -236,13 +276,15 @@ class GLColorTableEffect;
 
 class ColorTableEffect : public GrEffect {
 public:
-    static GrEffectRef* Create(GrTexture* texture, unsigned flags) {
-        AutoEffectUnref effect(SkNEW_ARGS(ColorTableEffect, (texture, flags)));
-        return CreateEffectRef(effect);
-    }
+    static GrEffectRef* Create(GrContext* context, const SkBitmap& bitmap, unsigned flags);
 
     virtual ~ColorTableEffect();
 
+    // With an atlas, the tables are four rows of the atlas's texture, starting at atlasRow().
+    // Otherwise they are the whole of the texture.
+    GrTextureStripAtlas* atlas() const { return fAtlas; }
+    int atlasRow() const { return fRow; }
+
     static const char* Name() { return "ColorTable"; }
     virtual const GrBackendEffectFactory& getFactory() const SK_OVERRIDE;
 
@@ -253,11 +295,14 @@ public:
 private:
     virtual bool onIsEqual(const GrEffect&) const SK_OVERRIDE;
 
-    explicit ColorTableEffect(GrTexture* texture, unsigned flags);
+    ColorTableEffect(GrTexture* texture, GrTextureStripAtlas* atlas, int row, unsigned flags);
 
     GR_DECLARE_EFFECT_TEST;
 
     GrTextureAccess fTextureAccess;
+    // Tables are locked into a row of the atlas for the lifetime of the effect.
+    GrTextureStripAtlas* fAtlas;
+    int             fRow;
     unsigned        fFlags; // currently not used in shader code, just to assist
                             // getConstantColorComponents().
 
@@ -276,11 +321,13 @@ public:
                           const TransformedCoordsArray&,
                           const TextureSamplerArray&) SK_OVERRIDE;
 
-    virtual void setData(const GrGLUniformManager&, const GrDrawEffect&) SK_OVERRIDE {}
+    virtual void setData(const GrGLUniformManager&, const GrDrawEffect&) SK_OVERRIDE;
 
     static EffectKey GenKey(const GrDrawEffect&, const GrGLCaps&);
 
 private:
+    // The y texture coordinates of the alpha, red, green and blue tables.
+    GrGLUniformManager::UniformHandle fRowsUni;
 
     typedef GrGLEffect INHERITED;
 };
@@ -314,38 +361,94 @@ void GLColorTableEffect::emitCode(GrGLShaderBuilder* builder,
                               kColorOffsetFactor, kColorOffsetFactor);
     }
 
-    builder->fsCodeAppendf("\t\t%s.a = ", outputColor);
-    builder->fsAppendTextureLookup(samplers[0], "vec2(coord.a, 0.125)");
-    builder->fsCodeAppend(";\n");
-
-    builder->fsCodeAppendf("\t\t%s.r = ", outputColor);
-    builder->fsAppendTextureLookup(samplers[0], "vec2(coord.r, 0.375)");
-    builder->fsCodeAppend(";\n");
-
-    builder->fsCodeAppendf("\t\t%s.g = ", outputColor);
-    builder->fsAppendTextureLookup(samplers[0], "vec2(coord.g, 0.625)");
-    builder->fsCodeAppend(";\n");
-
-    builder->fsCodeAppendf("\t\t%s.b = ", outputColor);
-    builder->fsAppendTextureLookup(samplers[0], "vec2(coord.b, 0.875)");
-    builder->fsCodeAppend(";\n");
+    fRowsUni = builder->addUniform(GrGLShaderBuilder::kFragment_Visibility,
+                                   kVec4f_GrSLType, "Rows");
+    const char* rows = builder->getUniformCStr(fRowsUni);
+    static const char kChannels[] = "argb";
+    for (int i = 0; i < 4; ++i) {
+        SkString lookup;
+        lookup.printf("vec2(coord.%c, %s[%d])", kChannels[i], rows, i);
+        builder->fsCodeAppendf("\t\t%s.%c = ", outputColor, kChannels[i]);
+        builder->fsAppendTextureLookup(samplers[0], lookup.c_str());
+        builder->fsCodeAppend(";\n");
+    }
 
     builder->fsCodeAppendf("\t\t%s.rgb *= %s.a;\n", outputColor, outputColor);
 }
 
+void GLColorTableEffect::setData(const GrGLUniformManager& uman, const GrDrawEffect& drawEffect) {
+    const ColorTableEffect& effect = drawEffect.castEffect<ColorTableEffect>();
+    // The center of each table's row.
+    float rows[4];
+    if (NULL != effect.atlas()) {
+        const float texelHeight = 1.0f / effect.texture(0)->height();
+        const float top = SkScalarToFloat(effect.atlas()->getYOffset(effect.atlasRow()));
+        for (int i = 0; i < 4; ++i) {
+            rows[i] = top + (i + 0.5f) * texelHeight;
+        }
+    } else {
+        for (int i = 0; i < 4; ++i) {
+            rows[i] = (i + 0.5f) / 4;
+        }
+    }
+    uman.set4fv(fRowsUni, 1, rows);
+}
+
 GrGLEffect::EffectKey GLColorTableEffect::GenKey(const GrDrawEffect&, const GrGLCaps&) {
     return 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-ColorTableEffect::ColorTableEffect(GrTexture* texture, unsigned flags)
+GrEffectRef* ColorTableEffect::Create(GrContext* context, const SkBitmap& bitmap,
+                                      unsigned flags) {
+    // Tables are small and many filters share them, so they go in an atlas, where identical
+    // tables from separately created filters share a row.
+    GrTextureStripAtlas::Desc desc;
+    desc.fWidth  = bitmap.width();
+    desc.fHeight = 128;
+    desc.fRowHeight = bitmap.height();
+    desc.fContext = context;
+    desc.fConfig = SkImageInfo2GrPixelConfig(bitmap.info());
+    GrTextureStripAtlas* atlas = GrTextureStripAtlas::GetAtlas(desc);
+    int row = atlas->lockRow(bitmap);
+
+    GrTexture* texture;
+    if (-1 != row) {
+        texture = atlas->getTexture();
+    } else {
+        atlas = NULL;
+        // passing NULL because this effect does no tiling or filtering.
+        texture = GrLockAndRefCachedBitmapTexture(context, bitmap, NULL);
+        if (NULL == texture) {
+            return NULL;
+        }
+    }
+
+    AutoEffectUnref effect(SkNEW_ARGS(ColorTableEffect, (texture, atlas, row, flags)));
+
+    if (NULL == atlas) {
+        // Unlock immediately, this is not great, but we don't have a way of
+        // knowing when else to unlock it currently. TODO: Remove this when
+        // unref becomes the unlock replacement for all types of textures.
+        GrUnlockAndUnrefCachedBitmapTexture(texture);
+    }
+    return CreateEffectRef(effect);
+}
+
+ColorTableEffect::ColorTableEffect(GrTexture* texture, GrTextureStripAtlas* atlas, int row,
+                                   unsigned flags)
     : fTextureAccess(texture, "a")
+    , fAtlas(atlas)
+    , fRow(row)
     , fFlags(flags) {
     this->addTextureAccess(&fTextureAccess);
 }
 
 ColorTableEffect::~ColorTableEffect() {
+    if (NULL != fAtlas) {
+        fAtlas->unlockRow(fRow);
+    }
 }
 
 const GrBackendEffectFactory&  ColorTableEffect::getFactory() const {
@@ -353,7 +456,8 @@ const GrBackendEffectFactory&  ColorTableEffect::getFactory() const {
 }
 
 bool ColorTableEffect::onIsEqual(const GrEffect& sBase) const {
-    return this->texture(0) == sBase.texture(0);
+    const ColorTableEffect& s = CastEffect<ColorTableEffect>(sBase);
+    return this->texture(0) == s.texture(0) && fAtlas == s.fAtlas && fRow == s.fRow;
 }
 
 void ColorTableEffect::getConstantColorComponents(GrColor* color, uint32_t* validFlags) const {
@@ -384,24 +488,16 @@ GrEffectRef* ColorTableEffect::TestCreate(SkRandom* random,
                                           GrTexture* textures[]) {
     static unsigned kAllFlags = SkTable_ColorFilter::kR_Flag | SkTable_ColorFilter::kG_Flag |
                                 SkTable_ColorFilter::kB_Flag | SkTable_ColorFilter::kA_Flag;
-    return ColorTableEffect::Create(textures[GrEffectUnitTest::kAlphaTextureIdx], kAllFlags);
+    AutoEffectUnref effect(SkNEW_ARGS(ColorTableEffect,
+                                      (textures[GrEffectUnitTest::kAlphaTextureIdx], NULL, -1,
+                                       kAllFlags)));
+    return CreateEffectRef(effect);
 }
 
 GrEffectRef* SkTable_ColorFilter::asNewEffect(GrContext* context) const {
     SkBitmap bitmap;
-    GrEffectRef* effect = NULL;
     this->asComponentTable(&bitmap);
-    // passing NULL because this effect does no tiling or filtering.
-    GrTexture* texture = GrLockAndRefCachedBitmapTexture(context, bitmap, NULL);
-    if (NULL != texture) {
-        effect = ColorTableEffect::Create(texture, fFlags);
-
-        // Unlock immediately, this is not great, but we don't have a way of
-        // knowing when else to unlock it currently. TODO: Remove this when
-        // unref becomes the unlock replacement for all types of textures.
-        GrUnlockAndUnrefCachedBitmapTexture(texture);
-    }
-    return effect;
+    return ColorTableEffect::Create(context, bitmap, fFlags);
 }
 
 #endif // SK_SUPPORT_GPU
@@ -8,6 +8,7 @@
 
 
 #include "SkBitmapCache.h"
+#include "SkPixelRef.h"
 
 struct SkBitmapCache::Entry {
     Entry*      fPrev;
@@ -51,6 +52,20 @@ SkBitmapCache::~SkBitmapCache() {
     }
 }
 
+void SkBitmapCache::getUsage(size_t* allocated, size_t* purgeable) const {
+    AutoValidate av(this);
+
+    *allocated = *purgeable = 0;
+    for (const Entry* entry = fHead; entry; entry = entry->fNext) {
+        const size_t bytes = sizeof(Entry) + entry->fSize + entry->fBitmap.getSize();
+        *allocated += bytes;
+        const SkPixelRef* pr = entry->fBitmap.pixelRef();
+        if (NULL == pr || pr->unique()) {
+            *purgeable += bytes;
+        }
+    }
+}
+
 SkBitmapCache::Entry* SkBitmapCache::detach(Entry* entry) const {
     if (entry->fPrev) {
         SkASSERT(fHead != entry);
@@ -20,6 +20,12 @@ public:
     bool find(const void* buffer, size_t len, SkBitmap*) const;
     void add(const void* buffer, size_t len, const SkBitmap&);
 
+    /**
+     *  Sets 'allocated' to the bytes of all the entries, and 'purgeable' to
+     *  those of the entries whose pixels no one else holds a ref to.
+     */
+    void getUsage(size_t* allocated, size_t* purgeable) const;
+
 private:
     int fEntryCount;
     const int fMaxEntries;
@@ -6,12 +6,22 @@
  */
 
 #include "SkGradientShaderPriv.h"
+#include "SkChecksum.h"
 #include "SkLinearGradient.h"
+#include "SkMemoryDump.h"
 #include "SkRadialGradient.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
 #include "SkTwoPointRadialGradient.h"
 #include "SkTwoPointConicalGradient.h"
 #include "SkSweepGradient.h"
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+    #include <arm_neon.h>
+#endif
+
 SkGradientShaderBase::SkGradientShaderBase(const Descriptor& desc, const SkMatrix* localMatrix)
     : INHERITED(localMatrix)
 {
@@ -280,7 +290,10 @@ SkGradientShaderBase::GradientShaderBaseContext::GradientShaderBaseContext(
 SkGradientShaderBase::GradientShaderCache::GradientShaderCache(
         U8CPU alpha, const SkGradientShaderBase& shader)
     : fCacheAlpha(alpha)
-    , fShader(shader)
+    , fColors(shader.fColorCount)
+    , fPos(shader.fColorCount)
+    , fColorCount(shader.fColorCount)
+    , fGradFlags(shader.fGradFlags)
     , fCache16Inited(false)
     , fCache32Inited(false)
 {
@@ -289,6 +302,14 @@ SkGradientShaderBase::GradientShaderCache::GradientShaderCache(
     fCache32 = NULL;
     fCache16Storage = NULL;
     fCache32PixelRef = NULL;
+
+    for (int i = 0; i < fColorCount; ++i) {
+        fColors[i] = shader.fOrigColors[i];
+        if (fColorCount > 2) {
+            fPos[i] = shader.fRecs[i].fPos;
+        }
+    }
+    this->initIntervals();
 }
 
 SkGradientShaderBase::GradientShaderCache::~GradientShaderCache() {
@@ -499,19 +520,19 @@ void SkGradientShaderBase::GradientShaderCache::initCache16(GradientShaderCache*
     SkASSERT(NULL == cache->fCache16Storage);
     cache->fCache16Storage = (uint16_t*)sk_malloc_throw(allocSize);
     cache->fCache16 = cache->fCache16Storage;
-    if (cache->fShader.fColorCount == 2) {
-        Build16bitCache(cache->fCache16, cache->fShader.fOrigColors[0],
-                        cache->fShader.fOrigColors[1], kCache16Count);
+    if (cache->fColorCount == 2) {
+        Build16bitCache(cache->fCache16, cache->fColors[0],
+                        cache->fColors[1], kCache16Count);
     } else {
-        Rec* rec = cache->fShader.fRecs;
+        const SkFixed* pos = cache->fPos.get();
         int prevIndex = 0;
-        for (int i = 1; i < cache->fShader.fColorCount; i++) {
-            int nextIndex = SkFixedToFFFF(rec[i].fPos) >> kCache16Shift;
+        for (int i = 1; i < cache->fColorCount; i++) {
+            int nextIndex = SkFixedToFFFF(pos[i]) >> kCache16Shift;
             SkASSERT(nextIndex < kCache16Count);
 
             if (nextIndex > prevIndex)
-                Build16bitCache(cache->fCache16 + prevIndex, cache->fShader.fOrigColors[i-1],
-                                cache->fShader.fOrigColors[i], nextIndex - prevIndex + 1);
+                Build16bitCache(cache->fCache16 + prevIndex, cache->fColors[i-1],
+                                cache->fColors[i], nextIndex - prevIndex + 1);
             prevIndex = nextIndex;
         }
     }
@@ -534,34 +555,426 @@ void SkGradientShaderBase::GradientShaderCache::initCache32(GradientShaderCache*
     SkASSERT(NULL == cache->fCache32PixelRef);
     cache->fCache32PixelRef = SkMallocPixelRef::NewAllocate(info, 0, NULL);
     cache->fCache32 = (SkPMColor*)cache->fCache32PixelRef->getAddr();
-    if (cache->fShader.fColorCount == 2) {
-        Build32bitCache(cache->fCache32, cache->fShader.fOrigColors[0],
-                        cache->fShader.fOrigColors[1], kCache32Count, cache->fCacheAlpha,
-                        cache->fShader.fGradFlags);
+    if (cache->fColorCount == 2) {
+        Build32bitCache(cache->fCache32, cache->fColors[0],
+                        cache->fColors[1], kCache32Count, cache->fCacheAlpha,
+                        cache->fGradFlags);
     } else {
-        Rec* rec = cache->fShader.fRecs;
+        const SkFixed* pos = cache->fPos.get();
         int prevIndex = 0;
-        for (int i = 1; i < cache->fShader.fColorCount; i++) {
-            int nextIndex = SkFixedToFFFF(rec[i].fPos) >> kCache32Shift;
+        for (int i = 1; i < cache->fColorCount; i++) {
+            int nextIndex = SkFixedToFFFF(pos[i]) >> kCache32Shift;
             SkASSERT(nextIndex < kCache32Count);
 
             if (nextIndex > prevIndex)
-                Build32bitCache(cache->fCache32 + prevIndex, cache->fShader.fOrigColors[i-1],
-                                cache->fShader.fOrigColors[i], nextIndex - prevIndex + 1,
-                                cache->fCacheAlpha, cache->fShader.fGradFlags);
+                Build32bitCache(cache->fCache32 + prevIndex, cache->fColors[i-1],
+                                cache->fColors[i], nextIndex - prevIndex + 1,
+                                cache->fCacheAlpha, cache->fGradFlags);
             prevIndex = nextIndex;
         }
     }
 }
 
+// The byte of SkPMColor a channel's shift selects.
+#define SK_A32_BYTE     (SK_A32_SHIFT / 8)
+#define SK_R32_BYTE     (SK_R32_SHIFT / 8)
+#define SK_G32_BYTE     (SK_G32_SHIFT / 8)
+#define SK_B32_BYTE     (SK_B32_SHIFT / 8)
+
+void SkGradientShaderBase::GradientShaderCache::initIntervals() {
+    fIntervals.reset(fColorCount - 1);
+    fIntervalCount = 0;
+
+    const bool interpInPremul = SkToBool(fGradFlags &
+                                         SkGradientShader::kInterpolateColorsInPremul_Flag);
+    const SkScalar alphaScale = SkIntToScalar(fCacheAlpha) / 255;
+    SkScalar prevPos = 0;
+    for (int i = 1; i < fColorCount; ++i) {
+        SkScalar pos = 2 == fColorCount ? SK_Scalar1 : SkFixedToScalar(fPos[i]);
+        if (pos < prevPos) {
+            // Out of order stops overwrite the earlier ones in the tables, which
+            // intervals can't express; shadePositions() will use the table.
+            fIntervalCount = 0;
+            return;
+        }
+        if (pos == prevPos) {
+            continue;   // a hard stop
+        }
+
+        SkScalar colors[2][4];
+        for (int j = 0; j < 2; ++j) {
+            SkColor c = fColors[i - 1 + j];
+            SkScalar a = SkColorGetA(c) * alphaScale;
+            SkScalar premul = interpInPremul ? a / 255 : SK_Scalar1;
+            colors[j][SK_A32_BYTE] = a;
+            colors[j][SK_R32_BYTE] = SkColorGetR(c) * premul;
+            colors[j][SK_G32_BYTE] = SkColorGetG(c) * premul;
+            colors[j][SK_B32_BYTE] = SkColorGetB(c) * premul;
+        }
+        Interval& interval = fIntervals[fIntervalCount++];
+        interval.fStart = prevPos;
+        interval.fEnd = pos;
+        for (int k = 0; k < 4; ++k) {
+            interval.fColor[k] = colors[0][k];
+            interval.fSlope[k] = (colors[1][k] - colors[0][k]) / (pos - prevPos);
+        }
+        prevPos = pos;
+    }
+    // So that the last interval takes position 1 too.
+    fIntervals[fIntervalCount - 1].fEnd = SK_ScalarMax;
+}
+
+namespace {
+
+// Tiles t into [0, 1]. NaN, from degenerate matrices, becomes 0.
+inline SkScalar tile_position(SkShader::TileMode tileMode, SkScalar t) {
+    if (SkShader::kRepeat_TileMode == tileMode) {
+        t -= SkScalarFloorToScalar(t);
+    } else if (SkShader::kMirror_TileMode == tileMode) {
+        t -= 2 * SkScalarFloorToScalar(t * SK_ScalarHalf);
+        if (t > SK_Scalar1) {
+            t = 2 - t;
+        }
+    }
+    return t > 0 ? (t < SK_Scalar1 ? t : SK_Scalar1) : 0;
+}
+
+// The 32-bit table's dither offsets, in units of a color step, for each cell of
+// the 2x2 dither pattern; see Build32bitCache().
+const SkScalar gDitherOffsets[4] = { 0.125f, 0.625f, 0.875f, 0.375f };
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+inline __m128 floor_SSE2(__m128 t) {
+    // Truncation rounds negatives up; step those down. Out of range t comes
+    // out wrong, and is caught by the caller's interval test.
+    __m128 f = _mm_cvtepi32_ps(_mm_cvttps_epi32(t));
+    return _mm_sub_ps(f, _mm_and_ps(_mm_cmpgt_ps(f, t), _mm_set1_ps(SK_Scalar1)));
+}
+
+// tile_position() for four positions, except that NaN may stay NaN.
+inline __m128 tile_positions_SSE2(SkShader::TileMode tileMode, __m128 t) {
+    if (SkShader::kRepeat_TileMode == tileMode) {
+        t = _mm_sub_ps(t, floor_SSE2(t));
+    } else if (SkShader::kMirror_TileMode == tileMode) {
+        __m128 two = _mm_set1_ps(2);
+        t = _mm_sub_ps(t, _mm_mul_ps(two, floor_SSE2(_mm_mul_ps(t, _mm_set1_ps(SK_ScalarHalf)))));
+        t = _mm_min_ps(t, _mm_sub_ps(two, t));
+    }
+    return _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(SK_Scalar1));
+}
+#elif defined(__ARM_NEON__)
+inline float32x4_t floor_neon(float32x4_t t) {
+    float32x4_t f = vcvtq_f32_s32(vcvtq_s32_f32(t));
+    return vsubq_f32(f, vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(f, t),
+                                                        vreinterpretq_u32_f32(vdupq_n_f32(1)))));
+}
+
+inline float32x4_t tile_positions_neon(SkShader::TileMode tileMode, float32x4_t t) {
+    if (SkShader::kRepeat_TileMode == tileMode) {
+        t = vsubq_f32(t, floor_neon(t));
+    } else if (SkShader::kMirror_TileMode == tileMode) {
+        float32x4_t two = vdupq_n_f32(2);
+        t = vsubq_f32(t, vmulq_f32(two, floor_neon(vmulq_f32(t, vdupq_n_f32(0.5f)))));
+        t = vminq_f32(t, vsubq_f32(two, t));
+    }
+    return vminq_f32(vmaxq_f32(t, vdupq_n_f32(0)), vdupq_n_f32(1));
+}
+#endif
+
+}  // namespace
+
+SkPMColor SkGradientShaderBase::GradientShaderCache::shadePosition(
+        SkScalar t, SkScalar dither, bool premulEachColor, int* index) const {
+    const Interval* intervals = fIntervals.get();
+    int i = *index;
+    while (t < intervals[i].fStart) {
+        --i;
+    }
+    while (t >= intervals[i].fEnd) {
+        ++i;
+    }
+    *index = i;
+    const Interval& interval = intervals[i];
+    SkScalar dt = t - interval.fStart;
+
+    SkScalar c[4];
+    for (int k = 0; k < 4; ++k) {
+        c[k] = interval.fColor[k] + interval.fSlope[k] * dt;
+    }
+    SkScalar a = c[SK_A32_BYTE];
+    SkPMColor result = 0;
+    for (int k = 0; k < 4; ++k) {
+        // Premultiplied channels are held to alpha, which float error could
+        // otherwise exceed.
+        if (premulEachColor && k != SK_A32_BYTE) {
+            c[k] *= a * (SK_Scalar1 / 255);
+        }
+        SkScalar v = SkTMin(c[k], a) + dither;
+        result |= (SkPMColor)SkClampMax(v > 0 ? (int)v : 0, 255) << (8 * k);
+    }
+    return result;
+}
+
+void SkGradientShaderBase::GradientShaderCache::shadePositions(
+        SkShader::TileMode tileMode, const SkScalar pos[], int x, int y,
+        SkPMColor dstC[], int count) {
+    int toggle = init_dither_toggle(x, y);
+    if (0 == fIntervalCount) {
+        const SkPMColor* cache = this->getCache32();
+        for (int i = 0; i < count; ++i) {
+            SkFixed fi = SkScalarToFixed(tile_position(tileMode, pos[i]));
+            dstC[i] = cache[toggle + (SkClampMax(fi, 0xFFFF) >> kCache32Shift)];
+            toggle = next_dither_toggle(toggle);
+        }
+        return;
+    }
+
+    const bool premulEachColor =
+        !(fGradFlags & SkGradientShader::kInterpolateColorsInPremul_Flag);
+    const Interval* intervals = fIntervals.get();
+    int index = 0;
+    int i = 0;
+
+    // Four pixels at a time, with a vector per channel, while they are all in
+    // the same interval. The dither offsets alternate along the row.
+    const SkScalar ditherOffsets[4] = {
+        gDitherOffsets[toggle / kDitherStride32],
+        gDitherOffsets[next_dither_toggle(toggle) / kDitherStride32],
+        gDitherOffsets[toggle / kDitherStride32],
+        gDitherOffsets[next_dither_toggle(toggle) / kDitherStride32]
+    };
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 dither = _mm_loadu_ps(ditherOffsets);
+    for (; i + 4 <= count; i += 4) {
+        __m128 t = tile_positions_SSE2(tileMode, _mm_loadu_ps(pos + i));
+        const Interval* interval = &intervals[index];
+        __m128 inside = _mm_and_ps(_mm_cmpge_ps(t, _mm_set1_ps(interval->fStart)),
+                                   _mm_cmplt_ps(t, _mm_set1_ps(interval->fEnd)));
+        if (0xF != _mm_movemask_ps(inside)) {
+            // These cross a stop, or left the interval; shade them one at a
+            // time, which also finds the interval of the next four.
+            for (int j = 0; j < 4; ++j) {
+                dstC[i + j] = this->shadePosition(tile_position(tileMode, pos[i + j]),
+                                                  ditherOffsets[j], premulEachColor, &index);
+            }
+            continue;
+        }
+        __m128 dt = _mm_sub_ps(t, _mm_set1_ps(interval->fStart));
+        __m128 c[4];
+        for (int k = 0; k < 4; ++k) {
+            c[k] = _mm_add_ps(_mm_set1_ps(interval->fColor[k]),
+                              _mm_mul_ps(_mm_set1_ps(interval->fSlope[k]), dt));
+        }
+        const __m128 a = c[SK_A32_BYTE];
+        const __m128 scale = _mm_mul_ps(a, _mm_set1_ps(1.0f / 255));
+        __m128i result = _mm_setzero_si128();
+        for (int k = 0; k < 4; ++k) {
+            if (premulEachColor && k != SK_A32_BYTE) {
+                c[k] = _mm_mul_ps(c[k], scale);
+            }
+            c[k] = _mm_add_ps(_mm_min_ps(c[k], a), dither);
+            result = _mm_or_si128(result, _mm_slli_epi32(_mm_cvttps_epi32(c[k]), 8 * k));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstC + i), result);
+    }
+#elif defined(__ARM_NEON__)
+    const float32x4_t dither = vld1q_f32(ditherOffsets);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t t = tile_positions_neon(tileMode, vld1q_f32(pos + i));
+        const Interval* interval = &intervals[index];
+        uint32x4_t inside = vandq_u32(vcgeq_f32(t, vdupq_n_f32(interval->fStart)),
+                                      vcltq_f32(t, vdupq_n_f32(interval->fEnd)));
+        uint32x2_t halves = vand_u32(vget_low_u32(inside), vget_high_u32(inside));
+        if (0xFFFFFFFF != (vget_lane_u32(halves, 0) & vget_lane_u32(halves, 1))) {
+            // These cross a stop, or left the interval; shade them one at a
+            // time, which also finds the interval of the next four.
+            for (int j = 0; j < 4; ++j) {
+                dstC[i + j] = this->shadePosition(tile_position(tileMode, pos[i + j]),
+                                                  ditherOffsets[j], premulEachColor, &index);
+            }
+            continue;
+        }
+        float32x4_t dt = vsubq_f32(t, vdupq_n_f32(interval->fStart));
+        float32x4_t c[4];
+        for (int k = 0; k < 4; ++k) {
+            c[k] = vaddq_f32(vdupq_n_f32(interval->fColor[k]),
+                             vmulq_f32(vdupq_n_f32(interval->fSlope[k]), dt));
+        }
+        const float32x4_t a = c[SK_A32_BYTE];
+        const float32x4_t scale = vmulq_f32(a, vdupq_n_f32(1.0f / 255));
+        uint32x4_t result = vdupq_n_u32(0);
+        for (int k = 0; k < 4; ++k) {
+            if (premulEachColor && k != SK_A32_BYTE) {
+                c[k] = vmulq_f32(c[k], scale);
+            }
+            c[k] = vaddq_f32(vminq_f32(c[k], a), dither);
+            // Converting to unsigned saturates negatives to 0.
+            result = vorrq_u32(result, vshlq_u32(vcvtq_u32_f32(c[k]), vdupq_n_s32(8 * k)));
+        }
+        vst1q_u32(dstC + i, result);
+    }
+#endif
+
+    // One pixel at a time, for the rest.
+    for (; i < count; ++i) {
+        dstC[i] = this->shadePosition(tile_position(tileMode, pos[i]),
+                                      gDitherOffsets[toggle / kDitherStride32],
+                                      premulEachColor, &index);
+        toggle = next_dither_toggle(toggle);
+    }
+}
+
+int SkGradientShaderBase::writeStopsKey(int32_t key[]) const {
+    // [numColors + colors[] + {positions[]} + flags ]
+    int count = 1 + fColorCount + 1;
+    if (fColorCount > 2) {
+        count += fColorCount - 1;    // fRecs[].fPos
+    }
+    if (NULL == key) {
+        return count;
+    }
+
+    int32_t* buffer = key;
+    *buffer++ = fColorCount;
+    memcpy(buffer, fOrigColors, fColorCount * sizeof(SkColor));
+    buffer += fColorCount;
+    if (fColorCount > 2) {
+        for (int i = 1; i < fColorCount; i++) {
+            *buffer++ = fRecs[i].fPos;
+        }
+    }
+    *buffer++ = fGradFlags;
+    SkASSERT(buffer - key == count);
+    return count;
+}
+
+namespace {
+
+typedef SkGradientShaderBase::GradientShaderCache GradientShaderCache;
+
+// Refers to the caller's ints for lookups, and to a CacheRec's own copy once added.
+struct CacheKey {
+    CacheKey(const int32_t* data, int count)
+        : fData(data)
+        , fCount(count)
+        , fHash(SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(data),
+                                    count * sizeof(int32_t))) {}
+
+    bool operator==(const CacheKey& other) const {
+        return fHash == other.fHash && fCount == other.fCount &&
+               0 == memcmp(fData, other.fData, fCount * sizeof(int32_t));
+    }
+
+    const int32_t* fData;
+    int            fCount;
+    uint32_t       fHash;
+};
+
+struct CacheRec {
+    CacheRec(const CacheKey& key, GradientShaderCache* cache)
+        : fStorage(key.fCount)
+        , fKey(key)
+        , fCache(SkRef(cache)) {
+        memcpy(fStorage.get(), key.fData, key.fCount * sizeof(int32_t));
+        fKey.fData = fStorage.get();
+    }
+
+    static const CacheKey& GetKey(const CacheRec& rec) { return rec.fKey; }
+    static uint32_t Hash(const CacheKey& key) { return key.fHash; }
+
+    SkAutoTMalloc<int32_t>               fStorage;
+    CacheKey                             fKey;
+    SkAutoTUnref<GradientShaderCache>    fCache;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(CacheRec);
+};
+
+// The most recently used caches, by alpha and stops, so that gradients with
+// the same colors share their tables instead of each building them.
+// Not thread-safe; guarded by gSharedCachesMutex.
+class SharedCaches {
+public:
+    // Each holds at least its intervals, and up to 5K of tables once built.
+    static const int kMaxCount = 128;
+
+    SharedCaches() : fCount(0) {}
+
+    ~SharedCaches() {
+        while (NULL != fLRU.head()) {
+            this->remove(fLRU.head());
+        }
+    }
+
+    GradientShaderCache* find(const CacheKey& key) {
+        CacheRec* rec = fHash.find(key);
+        if (NULL == rec) {
+            return NULL;
+        }
+        fLRU.remove(rec);
+        fLRU.addToHead(rec);
+        return rec->fCache.get();
+    }
+
+    void add(const CacheKey& key, GradientShaderCache* cache) {
+        SkASSERT(NULL == fHash.find(key));
+        CacheRec* rec = SkNEW_ARGS(CacheRec, (key, cache));
+        fHash.add(rec);
+        fLRU.addToHead(rec);
+        if (++fCount > kMaxCount) {
+            this->remove(fLRU.tail());
+        }
+    }
+
+private:
+    void remove(CacheRec* rec) {
+        fLRU.remove(rec);
+        fHash.remove(rec->fKey);
+        SkDELETE(rec);
+        --fCount;
+    }
+
+    SkTDynamicHash<CacheRec, CacheKey> fHash;
+    SkTInternalLList<CacheRec>         fLRU;
+    int                                fCount;
+};
+
+SK_DECLARE_STATIC_MUTEX(gSharedCachesMutex);
+SharedCaches* gSharedCaches = NULL;
+void cleanup_gSharedCaches() {
+#if SK_DEVELOPER
+    SkDELETE(gSharedCaches);
+#endif
+}
+
+}  // namespace
+
 /*
  *  The gradient holds a cache for the most recent value of alpha. Successive
- *  callers with the same alpha value will share the same cache.
+ *  callers with the same alpha value will share the same cache, and so will
+ *  other gradients with the same stops, through gSharedCaches.
  */
 SkGradientShaderBase::GradientShaderCache* SkGradientShaderBase::refCache(U8CPU alpha) const {
     SkAutoMutexAcquire ama(fCacheMutex);
     if (!fCache || fCache->getAlpha() != alpha) {
-        fCache.reset(SkNEW_ARGS(GradientShaderCache, (alpha, *this)));
+        // [alpha + stops key]
+        const int count = 1 + this->writeStopsKey(NULL);
+        SkAutoSTMalloc<16, int32_t> storage(count);
+        storage[0] = alpha;
+        this->writeStopsKey(storage.get() + 1);
+        const CacheKey key(storage.get(), count);
+
+        SkAutoMutexAcquire amShared(gSharedCachesMutex);
+        if (NULL == gSharedCaches) {
+            gSharedCaches = SkNEW(SharedCaches);
+            atexit(cleanup_gSharedCaches);
+        }
+        GradientShaderCache* cache = gSharedCaches->find(key);
+        if (NULL == cache) {
+            cache = SkNEW_ARGS(GradientShaderCache, (alpha, *this));
+            gSharedCaches->add(key, cache);
+            cache->unref();     // gSharedCaches holds it now
+        }
+        fCache.reset(SkRef(cache));
     }
     // Increment the ref counter inside the mutex to ensure the returned pointer is still valid.
     // Otherwise, the pointer may have been overwritten on a different thread before the object's
@@ -570,6 +983,20 @@ SkGradientShaderBase::GradientShaderCache* SkGradientShaderBase::refCache(U8CPU
     return fCache;
 }
 
+SK_DECLARE_STATIC_MUTEX(gGradientCacheMutex);
+static SkBitmapCache* gGradientCache;
+// each cache cost 1K of RAM, since each bitmap will be 1x256 at 32bpp
+static const int MAX_NUM_CACHED_GRADIENT_BITMAPS = 32;
+
+static void dump_gradient_cache(SkMemoryDump* dump) {
+    size_t allocated, purgeable;
+    {
+        SkAutoMutexAcquire ama(gGradientCacheMutex);
+        gGradientCache->getUsage(&allocated, &purgeable);
+    }
+    dump->dumpCache("skia/gradient_cache", allocated, purgeable);
+}
+
 /*
  *  Because our caller might rebuild the same (logically the same) gradient
  *  over and over, we'd like to return exactly the same "bitmap" if possible,
@@ -584,45 +1011,27 @@ void SkGradientShaderBase::getGradientTableBitmap(SkBitmap* bitmap) const {
     SkAutoTUnref<GradientShaderCache> cache(this->refCache(0xFF));
 
     // build our key: [numColors + colors[] + {positions[]} + flags ]
-    int count = 1 + fColorCount + 1;
-    if (fColorCount > 2) {
-        count += fColorCount - 1;    // fRecs[].fPos
-    }
-
+    int count = this->writeStopsKey(NULL);
     SkAutoSTMalloc<16, int32_t> storage(count);
-    int32_t* buffer = storage.get();
-
-    *buffer++ = fColorCount;
-    memcpy(buffer, fOrigColors, fColorCount * sizeof(SkColor));
-    buffer += fColorCount;
-    if (fColorCount > 2) {
-        for (int i = 1; i < fColorCount; i++) {
-            *buffer++ = fRecs[i].fPos;
-        }
-    }
-    *buffer++ = fGradFlags;
-    SkASSERT(buffer - storage.get() == count);
+    this->writeStopsKey(storage.get());
 
     ///////////////////////////////////
 
-    SK_DECLARE_STATIC_MUTEX(gMutex);
-    static SkBitmapCache* gCache;
-    // each cache cost 1K of RAM, since each bitmap will be 1x256 at 32bpp
-    static const int MAX_NUM_CACHED_GRADIENT_BITMAPS = 32;
-    SkAutoMutexAcquire ama(gMutex);
+    SkAutoMutexAcquire ama(gGradientCacheMutex);
 
-    if (NULL == gCache) {
-        gCache = SkNEW_ARGS(SkBitmapCache, (MAX_NUM_CACHED_GRADIENT_BITMAPS));
+    if (NULL == gGradientCache) {
+        gGradientCache = SkNEW_ARGS(SkBitmapCache, (MAX_NUM_CACHED_GRADIENT_BITMAPS));
+        SkMemoryDump::RegisterGlobalProc(dump_gradient_cache);
     }
     size_t size = count * sizeof(int32_t);
 
-    if (!gCache->find(storage.get(), size, bitmap)) {
+    if (!gGradientCache->find(storage.get(), size, bitmap)) {
         // force our cahce32pixelref to be built
         (void)cache->getCache32();
         bitmap->setInfo(SkImageInfo::MakeN32Premul(kCache32Count, 1));
         bitmap->setPixelRef(cache->getCache32PixelRef());
 
-        gCache->add(storage.get(), size, *bitmap);
+        gGradientCache->add(storage.get(), size, *bitmap);
     }
 }
 
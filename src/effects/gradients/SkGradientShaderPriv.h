@@ -100,7 +100,9 @@ public:
     SkGradientShaderBase(const Descriptor& desc, const SkMatrix* localMatrix);
     virtual ~SkGradientShaderBase();
 
-    // The cache is initialized on-demand when getCache16/32 is called.
+    // The tables are initialized on-demand when getCache16/32 is called. A cache
+    // copies the shader's stops, so shaders with the same stops share one (see
+    // refCache()).
     class GradientShaderCache : public SkRefCnt {
     public:
         GradientShaderCache(U8CPU alpha, const SkGradientShaderBase& shader);
@@ -113,7 +115,32 @@ public:
 
         unsigned getAlpha() const { return fCacheAlpha; }
 
+        /**
+         *  Writes the colors at count gradient positions, for the pixels from
+         *  (x, y) rightwards, interpolating the stops in float rather than
+         *  looking up the 32-bit table. The positions are tiled by tileMode
+         *  first, and the colors are dithered as the table's are.
+         */
+        void shadePositions(SkShader::TileMode tileMode, const SkScalar pos[],
+                            int x, int y, SkPMColor dstC[], int count);
+
     private:
+        // The gradient between two stops, by byte of SkPMColor. Colors are
+        // premultiplied already if the shader interpolates in premul, and
+        // their alpha is scaled by fCacheAlpha.
+        struct Interval {
+            SkScalar fStart;
+            SkScalar fEnd;          // SK_ScalarMax for the last interval
+            SkScalar fColor[4];     // at fStart
+            SkScalar fSlope[4];     // per unit of position
+        };
+
+        void initIntervals();
+        // The color at one tiled position t, starting the interval search at
+        // *index and leaving it at t's interval.
+        SkPMColor shadePosition(SkScalar t, SkScalar dither, bool premulEachColor,
+                                int* index) const;
+
         // Working pointers. If either is NULL, we need to recompute the corresponding cache values.
         uint16_t*   fCache16;
         SkPMColor*  fCache32;
@@ -124,7 +151,14 @@ public:
                                               // Larger than 8bits so we can store uninitialized
                                               // value.
 
-        const SkGradientShaderBase& fShader;
+        // The shader's colors, stop positions (when more than two) and flags.
+        SkAutoSTMalloc<4, SkColor>  fColors;
+        SkAutoSTMalloc<4, SkFixed>  fPos;
+        int                         fColorCount;
+        uint32_t                    fGradFlags;
+
+        SkAutoSTMalloc<3, Interval> fIntervals;
+        int                         fIntervalCount;
 
         // Make sure we only initialize the caches once.
         bool    fCache16Inited, fCache32Inited;
@@ -179,6 +213,9 @@ public:
         /// if dithering is disabled.
         kDitherStride32 = kCache32Count,
         kDitherStride16 = kCache16Count,
+
+        /// How many positions shadeSpan() hands to shadePositions() at a time.
+        kPositionBatchCount = 64,
     };
 
     enum GpuColorType {
@@ -239,6 +276,10 @@ private:
     SkColor*    fOrigColors; // original colors, before modulation by paint in context.
     bool        fColorsAreOpaque;
 
+    // Writes the colors, positions and flags that decide the gradient's colors
+    // to key, if not NULL, and returns how many ints that takes.
+    int writeStopsKey(int32_t key[]) const;
+
     GradientShaderCache* refCache(U8CPU alpha) const;
     mutable SkMutex                           fCacheMutex;
     mutable SkAutoTUnref<GradientShaderCache> fCache;
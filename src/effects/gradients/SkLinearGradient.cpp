@@ -11,10 +11,6 @@ static inline int repeat_bits(int x, const int bits) {
     return x & ((1 << bits) - 1);
 }
 
-static inline int repeat_8bits(int x) {
-    return x & 0xFF;
-}
-
 // Visual Studio 2010 (MSC_VER=1600) optimizes bit-shift code incorrectly.
 // See http://code.google.com/p/skia/issues/detail?id=472
 #if defined(_MSC_VER) && (_MSC_VER >= 1600)
@@ -28,13 +24,6 @@ static inline int mirror_bits(int x, const int bits) {
     return x & ((1 << bits) - 1);
 }
 
-static inline int mirror_8bits(int x) {
-    if (x & 256) {
-        x = ~x;
-    }
-    return x & 255;
-}
-
 #if defined(_MSC_VER) && (_MSC_VER >= 1600)
 #pragma optimize("", on)
 #endif
@@ -96,112 +85,6 @@ SkLinearGradient::LinearGradientContext::LinearGradientContext(
     }
 }
 
-#define NO_CHECK_ITER               \
-    do {                            \
-    unsigned fi = fx >> SkGradientShaderBase::kCache32Shift; \
-    SkASSERT(fi <= 0xFF);           \
-    fx += dx;                       \
-    *dstC++ = cache[toggle + fi];   \
-    toggle = next_dither_toggle(toggle); \
-    } while (0)
-
-namespace {
-
-typedef void (*LinearShadeProc)(TileProc proc, SkFixed dx, SkFixed fx,
-                                SkPMColor* dstC, const SkPMColor* cache,
-                                int toggle, int count);
-
-// Linear interpolation (lerp) is unnecessary if there are no sharp
-// discontinuities in the gradient - which must be true if there are
-// only 2 colors - but it's cheap.
-void shadeSpan_linear_vertical_lerp(TileProc proc, SkFixed dx, SkFixed fx,
-                                    SkPMColor* SK_RESTRICT dstC,
-                                    const SkPMColor* SK_RESTRICT cache,
-                                    int toggle, int count) {
-    // We're a vertical gradient, so no change in a span.
-    // If colors change sharply across the gradient, dithering is
-    // insufficient (it subsamples the color space) and we need to lerp.
-    unsigned fullIndex = proc(fx);
-    unsigned fi = fullIndex >> SkGradientShaderBase::kCache32Shift;
-    unsigned remainder = fullIndex & ((1 << SkGradientShaderBase::kCache32Shift) - 1);
-
-    int index0 = fi + toggle;
-    int index1 = index0;
-    if (fi < SkGradientShaderBase::kCache32Count - 1) {
-        index1 += 1;
-    }
-    SkPMColor lerp = SkFastFourByteInterp(cache[index1], cache[index0], remainder);
-    index0 ^= SkGradientShaderBase::kDitherStride32;
-    index1 ^= SkGradientShaderBase::kDitherStride32;
-    SkPMColor dlerp = SkFastFourByteInterp(cache[index1], cache[index0], remainder);
-    sk_memset32_dither(dstC, lerp, dlerp, count);
-}
-
-void shadeSpan_linear_clamp(TileProc proc, SkFixed dx, SkFixed fx,
-                            SkPMColor* SK_RESTRICT dstC,
-                            const SkPMColor* SK_RESTRICT cache,
-                            int toggle, int count) {
-    SkClampRange range;
-    range.init(fx, dx, count, 0, SkGradientShaderBase::kCache32Count - 1);
-
-    if ((count = range.fCount0) > 0) {
-        sk_memset32_dither(dstC,
-            cache[toggle + range.fV0],
-            cache[next_dither_toggle(toggle) + range.fV0],
-            count);
-        dstC += count;
-    }
-    if ((count = range.fCount1) > 0) {
-        int unroll = count >> 3;
-        fx = range.fFx1;
-        for (int i = 0; i < unroll; i++) {
-            NO_CHECK_ITER;  NO_CHECK_ITER;
-            NO_CHECK_ITER;  NO_CHECK_ITER;
-            NO_CHECK_ITER;  NO_CHECK_ITER;
-            NO_CHECK_ITER;  NO_CHECK_ITER;
-        }
-        if ((count &= 7) > 0) {
-            do {
-                NO_CHECK_ITER;
-            } while (--count != 0);
-        }
-    }
-    if ((count = range.fCount2) > 0) {
-        sk_memset32_dither(dstC,
-            cache[toggle + range.fV1],
-            cache[next_dither_toggle(toggle) + range.fV1],
-            count);
-    }
-}
-
-void shadeSpan_linear_mirror(TileProc proc, SkFixed dx, SkFixed fx,
-                             SkPMColor* SK_RESTRICT dstC,
-                             const SkPMColor* SK_RESTRICT cache,
-                             int toggle, int count) {
-    do {
-        unsigned fi = mirror_8bits(fx >> 8);
-        SkASSERT(fi <= 0xFF);
-        fx += dx;
-        *dstC++ = cache[toggle + fi];
-        toggle = next_dither_toggle(toggle);
-    } while (--count != 0);
-}
-
-void shadeSpan_linear_repeat(TileProc proc, SkFixed dx, SkFixed fx,
-        SkPMColor* SK_RESTRICT dstC,
-        const SkPMColor* SK_RESTRICT cache,
-        int toggle, int count) {
-    do {
-        unsigned fi = repeat_8bits(fx >> 8);
-        SkASSERT(fi <= 0xFF);
-        fx += dx;
-        *dstC++ = cache[toggle + fi];
-        toggle = next_dither_toggle(toggle);
-    } while (--count != 0);
-}
-
-}
-
 void SkLinearGradient::LinearGradientContext::shadeSpan(int x, int y, SkPMColor* SK_RESTRICT dstC,
                                                         int count) {
     SkASSERT(count > 0);
@@ -210,46 +93,41 @@ void SkLinearGradient::LinearGradientContext::shadeSpan(int x, int y, SkPMColor*
 
     SkPoint             srcPt;
     SkMatrix::MapXYProc dstProc = fDstToIndexProc;
-    TileProc            proc = linearGradient.fTileProc;
-    const SkPMColor* SK_RESTRICT cache = fCache->getCache32();
-    int                 toggle = init_dither_toggle(x, y);
+    SkScalar            pos[kPositionBatchCount];
 
     if (fDstToIndexClass != kPerspective_MatrixClass) {
         dstProc(fDstToIndex, SkIntToScalar(x) + SK_ScalarHalf,
                              SkIntToScalar(y) + SK_ScalarHalf, &srcPt);
-        SkFixed dx, fx = SkScalarToFixed(srcPt.fX);
+        SkScalar dx, fx = srcPt.fX;
 
         if (fDstToIndexClass == kFixedStepInX_MatrixClass) {
             SkFixed dxStorage[1];
             (void)fDstToIndex.fixedStepInX(SkIntToScalar(y), dxStorage, NULL);
-            dx = dxStorage[0];
+            dx = SkFixedToScalar(dxStorage[0]);
         } else {
             SkASSERT(fDstToIndexClass == kLinear_MatrixClass);
-            dx = SkScalarToFixed(fDstToIndex.getScaleX());
+            dx = fDstToIndex.getScaleX();
         }
 
-        LinearShadeProc shadeProc = shadeSpan_linear_repeat;
-        if (0 == dx) {
-            shadeProc = shadeSpan_linear_vertical_lerp;
-        } else if (SkShader::kClamp_TileMode == linearGradient.fTileMode) {
-            shadeProc = shadeSpan_linear_clamp;
-        } else if (SkShader::kMirror_TileMode == linearGradient.fTileMode) {
-            shadeProc = shadeSpan_linear_mirror;
-        } else {
-            SkASSERT(SkShader::kRepeat_TileMode == linearGradient.fTileMode);
+        for (int done = 0; done < count; done += kPositionBatchCount) {
+            int n = SkMin32(count - done, kPositionBatchCount);
+            for (int i = 0; i < n; ++i) {
+                pos[i] = fx + SkIntToScalar(done + i) * dx;
+            }
+            fCache->shadePositions(linearGradient.fTileMode, pos, x + done, y, dstC + done, n);
         }
-        (*shadeProc)(proc, dx, fx, dstC, cache, toggle, count);
     } else {
         SkScalar    dstX = SkIntToScalar(x);
         SkScalar    dstY = SkIntToScalar(y);
-        do {
-            dstProc(fDstToIndex, dstX, dstY, &srcPt);
-            unsigned fi = proc(SkScalarToFixed(srcPt.fX));
-            SkASSERT(fi <= 0xFFFF);
-            *dstC++ = cache[toggle + (fi >> kCache32Shift)];
-            toggle = next_dither_toggle(toggle);
-            dstX += SK_Scalar1;
-        } while (--count != 0);
+        for (int done = 0; done < count; done += kPositionBatchCount) {
+            int n = SkMin32(count - done, kPositionBatchCount);
+            for (int i = 0; i < n; ++i) {
+                dstProc(fDstToIndex, dstX, dstY, &srcPt);
+                pos[i] = srcPt.fX;
+                dstX += SK_Scalar1;
+            }
+            fCache->shadePositions(linearGradient.fTileMode, pos, x + done, y, dstC + done, n);
+        }
     }
 }
 
@@ -8,6 +8,10 @@
 
 #include "SkSweepGradient.h"
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
+
 SkSweepGradient::SkSweepGradient(SkScalar cx, SkScalar cy,
                                  const Descriptor& desc, const SkMatrix* localMatrix)
     : SkGradientShaderBase(desc, localMatrix)
@@ -81,6 +85,69 @@ static unsigned SkATan2_255(float y, float x) {
     return ir;
 }
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+static inline __m128 select_ps(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// SkATan2_255() of four points. The angle comes from a polynomial (Cephes' atanf), within about
+// 5e-7 radians of atan2. That only matters when the angle lands next to the boundary between two
+// indices, and those points, along with the axes and non-finite points, go to SkATan2_255().
+static void SkATan2_255_x4(const float y[4], const float x[4], int indices[4]) {
+    static const float g255Over2PI = 40.584510488433314f;
+    // How near an index boundary a point must be to be computed by SkATan2_255(), far more than
+    // the error of the polynomial, at a cost of one in a few hundred points.
+    static const float kNearBoundary = 1.0f / 1024;
+
+    const __m128 vy = _mm_loadu_ps(y);
+    const __m128 vx = _mm_loadu_ps(x);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1);
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 ax = _mm_andnot_ps(signMask, vx);
+    const __m128 ay = _mm_andnot_ps(signMask, vy);
+
+    // atan of the ratio in [0, 1], reduced to [0, tan(pi/8)] around 0 or pi/4.
+    __m128 z = _mm_div_ps(_mm_min_ps(ax, ay), _mm_max_ps(ax, ay));
+    const __m128 aboveTanPIOver8 = _mm_cmpgt_ps(z, _mm_set1_ps(0.4142135623730950f));
+    z = select_ps(aboveTanPIOver8, _mm_div_ps(_mm_sub_ps(z, one), _mm_add_ps(z, one)), z);
+    const __m128 z2 = _mm_mul_ps(z, z);
+    __m128 p = _mm_set1_ps(8.05374449538e-2f);
+    p = _mm_sub_ps(_mm_mul_ps(p, z2), _mm_set1_ps(1.38776856032e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(1.99777106478e-1f));
+    p = _mm_sub_ps(_mm_mul_ps(p, z2), _mm_set1_ps(3.33329491539e-1f));
+    __m128 angle = _mm_add_ps(_mm_and_ps(aboveTanPIOver8, _mm_set1_ps(SK_ScalarPI / 4)),
+                              _mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, z2), z), z));
+
+    // Unfold the octant into [0, 2pi).
+    angle = select_ps(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(SK_ScalarPI / 2), angle), angle);
+    angle = select_ps(_mm_cmplt_ps(vx, zero), _mm_sub_ps(_mm_set1_ps(SK_ScalarPI), angle), angle);
+    angle = select_ps(_mm_cmplt_ps(vy, zero), _mm_sub_ps(_mm_set1_ps(2 * SK_ScalarPI), angle),
+                      angle);
+
+    const __m128 scaled = _mm_mul_ps(angle, _mm_set1_ps(g255Over2PI));
+    const __m128i truncated = _mm_cvttps_epi32(scaled);
+    const __m128 fraction = _mm_sub_ps(scaled, _mm_cvtepi32_ps(truncated));
+    const __m128 infinity = _mm_set1_ps(SK_FloatInfinity);
+    // False for NaNs too.
+    const __m128 fine = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(ax, zero), _mm_cmpgt_ps(ay, zero)),
+                                   _mm_and_ps(_mm_cmplt_ps(ax, infinity),
+                                              _mm_cmplt_ps(ay, infinity)));
+    const __m128 clear = _mm_and_ps(_mm_cmpgt_ps(fraction, _mm_set1_ps(kNearBoundary)),
+                                    _mm_cmplt_ps(fraction, _mm_set1_ps(1 - kNearBoundary)));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), truncated);
+    const int exact = _mm_movemask_ps(_mm_and_ps(fine, clear));
+    if (0xF != exact) {
+        for (int i = 0; i < 4; ++i) {
+            if (!(exact & (1 << i))) {
+                indices[i] = SkATan2_255(y[i], x[i]);
+            }
+        }
+    }
+}
+#endif
+
 void SkSweepGradient::SweepGradientContext::shadeSpan(int x, int y, SkPMColor* SK_RESTRICT dstC,
                                                       int count) {
     SkMatrix::MapXYProc proc = fDstToIndexProc;
@@ -107,6 +174,23 @@ void SkSweepGradient::SweepGradientContext::shadeSpan(int x, int y, SkPMColor* S
             dy = matrix.getSkewY();
         }
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        for (; count >= 4; count -= 4) {
+            float xs[4], ys[4];
+            for (int i = 0; i < 4; ++i) {
+                xs[i] = fx;
+                ys[i] = fy;
+                fx += dx;
+                fy += dy;
+            }
+            int indices[4];
+            SkATan2_255_x4(ys, xs, indices);
+            for (int i = 0; i < 4; ++i) {
+                *dstC++ = cache[toggle + indices[i]];
+                toggle = next_dither_toggle(toggle);
+            }
+        }
+#endif
         for (; count > 0; --count) {
             *dstC++ = cache[toggle + SkATan2_255(fy, fx)];
             fx += dx;
@@ -149,6 +233,23 @@ void SkSweepGradient::SweepGradientContext::shadeSpan16(int x, int y, uint16_t*
             dy = matrix.getSkewY();
         }
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        for (; count >= 4; count -= 4) {
+            float xs[4], ys[4];
+            for (int i = 0; i < 4; ++i) {
+                xs[i] = fx;
+                ys[i] = fy;
+                fx += dx;
+                fy += dy;
+            }
+            int indices[4];
+            SkATan2_255_x4(ys, xs, indices);
+            for (int i = 0; i < 4; ++i) {
+                *dstC++ = cache[toggle + (indices[i] >> (8 - kCache16Bits))];
+                toggle = next_dither_toggle16(toggle);
+            }
+        }
+#endif
         for (; count > 0; --count) {
             int index = SkATan2_255(fy, fx) >> (8 - kCache16Bits);
             *dstC++ = cache[toggle + index];
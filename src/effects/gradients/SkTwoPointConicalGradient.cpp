@@ -8,6 +8,10 @@
 #include "SkTwoPointConicalGradient.h"
 #include "SkTwoPointConicalGradient_gpu.h"
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
+
 struct TwoPtRadialContext {
     const TwoPtRadial&  fRec;
     float               fRelX, fRelY;
@@ -18,6 +22,9 @@ struct TwoPtRadialContext {
     TwoPtRadialContext(const TwoPtRadial& rec, SkScalar fx, SkScalar fy,
                        SkScalar dfx, SkScalar dfy);
     SkFixed nextT();
+    // Writes the next t values to t[], up to four of them but no more than count, and returns
+    // how many it wrote. The values are the same as nextT()'s.
+    int nextTs(SkFixed t[4], int count);
 };
 
 static int valid_divide(float numer, float denom, float* ratio) {
@@ -132,57 +139,146 @@ SkFixed TwoPtRadialContext::nextT() {
     return SkFloatToFixed(t);
 }
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+static inline __m128 select_ps(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// nextT() for four pixels at once. Each step mirrors the float operations of find_quad_roots()
+// and nextT(), branches becoming selects, so the results are the same. Requires rec.fA != 0.
+static void next_t4(const TwoPtRadial& rec, const float relX[4], const float relY[4],
+                    const float b[4], SkFixed t[4]) {
+    SkASSERT(0 != rec.fA);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 x = _mm_loadu_ps(relX);
+    const __m128 y = _mm_loadu_ps(relY);
+    const __m128 B = _mm_loadu_ps(b);
+    const __m128 A = _mm_set1_ps(rec.fA);
+
+    __m128 C = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                          _mm_set1_ps(rec.fRadius2));
+    __m128 R = _mm_sub_ps(_mm_mul_ps(B, B), _mm_mul_ps(_mm_set1_ps(4 * rec.fA), C));
+    const __m128 noRoots = _mm_cmplt_ps(R, zero);
+    R = _mm_sqrt_ps(R);
+
+    __m128 Q = select_ps(_mm_cmplt_ps(B, zero), _mm_sub_ps(B, R), _mm_add_ps(B, R));
+    Q = _mm_mul_ps(Q, _mm_set1_ps(-0.5f));
+    const __m128 r0 = _mm_div_ps(Q, A);
+    const __m128 r1 = _mm_div_ps(C, Q);
+    // min and max return their second operand for NaNs, as the ternaries do.
+    const __m128 lo = _mm_min_ps(r0, r1);
+    const __m128 hi = _mm_max_ps(r0, r1);
+    // A single root of 0 when Q is.
+    const __m128 oneRoot = _mm_cmpeq_ps(Q, zero);
+    __m128 first = _mm_andnot_ps(oneRoot, rec.fFlipped ? lo : hi);
+    __m128 second = _mm_andnot_ps(oneRoot, rec.fFlipped ? hi : lo);
+
+    // Prefer the first t if it gives a radius(t) > 0.
+    const __m128 radius = _mm_set1_ps(rec.fRadius);
+    const __m128 dRadius = _mm_set1_ps(rec.fDRadius);
+    const __m128 useSecond = _mm_cmple_ps(_mm_add_ps(radius, _mm_mul_ps(first, dRadius)), zero);
+    const __m128 tf = select_ps(useSecond, second, first);
+    const __m128 dontDraw = _mm_or_ps(noRoots,
+                                      _mm_cmple_ps(_mm_add_ps(radius, _mm_mul_ps(tf, dRadius)),
+                                                   zero));
+
+    __m128i fixed = _mm_cvttps_epi32(_mm_mul_ps(tf, _mm_set1_ps(SK_Fixed1)));
+    const __m128i dontDrawT = _mm_set1_epi32(TwoPtRadial::kDontDrawT);
+    const __m128i dontDrawMask = _mm_castps_si128(dontDraw);
+    fixed = _mm_or_si128(_mm_and_si128(dontDrawMask, dontDrawT),
+                         _mm_andnot_si128(dontDrawMask, fixed));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(t), fixed);
+}
+#endif
+
+int TwoPtRadialContext::nextTs(SkFixed t[4], int count) {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    // A == 0 has a single linear root; that rare case stays scalar.
+    if (count >= 4 && 0 != fRec.fA) {
+        // Step the same way nextT() does, so that the inputs match it exactly.
+        float relX[4], relY[4], b[4];
+        for (int i = 0; i < 4; ++i) {
+            relX[i] = fRelX;
+            relY[i] = fRelY;
+            b[i] = fB;
+            fRelX += fIncX;
+            fRelY += fIncY;
+            fB += fDB;
+        }
+        next_t4(fRec, relX, relY, b, t);
+        return 4;
+    }
+#endif
+    t[0] = this->nextT();
+    return 1;
+}
+
 typedef void (*TwoPointConicalProc)(TwoPtRadialContext* rec, SkPMColor* dstC,
                                     const SkPMColor* cache, int toggle, int count);
 
 static void twopoint_clamp(TwoPtRadialContext* rec, SkPMColor* SK_RESTRICT dstC,
                            const SkPMColor* SK_RESTRICT cache, int toggle,
                            int count) {
-    for (; count > 0; --count) {
-        SkFixed t = rec->nextT();
-        if (TwoPtRadial::DontDrawT(t)) {
-            *dstC++ = 0;
-        } else {
-            SkFixed index = SkClampMax(t, 0xFFFF);
-            SkASSERT(index <= 0xFFFF);
-            *dstC++ = cache[toggle +
-                            (index >> SkGradientShaderBase::kCache32Shift)];
+    SkFixed ts[4];
+    while (count > 0) {
+        const int n = rec->nextTs(ts, count);
+        for (int i = 0; i < n; ++i) {
+            SkFixed t = ts[i];
+            if (TwoPtRadial::DontDrawT(t)) {
+                *dstC++ = 0;
+            } else {
+                SkFixed index = SkClampMax(t, 0xFFFF);
+                SkASSERT(index <= 0xFFFF);
+                *dstC++ = cache[toggle +
+                                (index >> SkGradientShaderBase::kCache32Shift)];
+            }
+            toggle = next_dither_toggle(toggle);
         }
-        toggle = next_dither_toggle(toggle);
+        count -= n;
     }
 }
 
 static void twopoint_repeat(TwoPtRadialContext* rec, SkPMColor* SK_RESTRICT dstC,
                             const SkPMColor* SK_RESTRICT cache, int toggle,
                             int count) {
-    for (; count > 0; --count) {
-        SkFixed t = rec->nextT();
-        if (TwoPtRadial::DontDrawT(t)) {
-            *dstC++ = 0;
-        } else {
-            SkFixed index = repeat_tileproc(t);
-            SkASSERT(index <= 0xFFFF);
-            *dstC++ = cache[toggle +
-                            (index >> SkGradientShaderBase::kCache32Shift)];
+    SkFixed ts[4];
+    while (count > 0) {
+        const int n = rec->nextTs(ts, count);
+        for (int i = 0; i < n; ++i) {
+            SkFixed t = ts[i];
+            if (TwoPtRadial::DontDrawT(t)) {
+                *dstC++ = 0;
+            } else {
+                SkFixed index = repeat_tileproc(t);
+                SkASSERT(index <= 0xFFFF);
+                *dstC++ = cache[toggle +
+                                (index >> SkGradientShaderBase::kCache32Shift)];
+            }
+            toggle = next_dither_toggle(toggle);
         }
-        toggle = next_dither_toggle(toggle);
+        count -= n;
     }
 }
 
 static void twopoint_mirror(TwoPtRadialContext* rec, SkPMColor* SK_RESTRICT dstC,
                             const SkPMColor* SK_RESTRICT cache, int toggle,
                             int count) {
-    for (; count > 0; --count) {
-        SkFixed t = rec->nextT();
-        if (TwoPtRadial::DontDrawT(t)) {
-            *dstC++ = 0;
-        } else {
-            SkFixed index = mirror_tileproc(t);
-            SkASSERT(index <= 0xFFFF);
-            *dstC++ = cache[toggle +
-                            (index >> SkGradientShaderBase::kCache32Shift)];
+    SkFixed ts[4];
+    while (count > 0) {
+        const int n = rec->nextTs(ts, count);
+        for (int i = 0; i < n; ++i) {
+            SkFixed t = ts[i];
+            if (TwoPtRadial::DontDrawT(t)) {
+                *dstC++ = 0;
+            } else {
+                SkFixed index = mirror_tileproc(t);
+                SkASSERT(index <= 0xFFFF);
+                *dstC++ = cache[toggle +
+                                (index >> SkGradientShaderBase::kCache32Shift)];
+            }
+            toggle = next_dither_toggle(toggle);
         }
-        toggle = next_dither_toggle(toggle);
+        count -= n;
     }
 }
 
@@ -54,6 +54,7 @@ private:
 // Defined in SkFontHost_FreeType.cpp
 bool find_name_and_attributes(SkStream* stream, SkString* name,
                               SkTypeface::Style* style, bool* isFixedWidth);
+SkStream* open_shared_font_file(const char path[]);
 
 // borrow this global from SkFontHost_fontconfig. eventually that file should
 // go away, and be replaced with this one.
@@ -316,7 +317,7 @@ protected:
     }
 
     virtual SkTypeface* onCreateFromFile(const char path[], int ttcIndex) const SK_OVERRIDE {
-        SkAutoTUnref<SkStream> stream(SkStream::NewFromFile(path));
+        SkAutoTUnref<SkStream> stream(open_shared_font_file(path));
         return stream.get() ? this->createFromStream(stream, ttcIndex) : NULL;
     }
 
@@ -5,10 +5,13 @@
  * found in the LICENSE file.
  */
 
+use gl_rasterization_context;
 use skia;
 
 use euclid::Size2D;
 use gleam::gl;
+use libc;
+use std::cell::RefCell;
 use std::ptr;
 use std::rc::Rc;
 use std::sync::Arc;
@@ -35,18 +38,56 @@ pub use gl_context_wgl::GLPlatformContext;
 #[cfg(target_os="windows")]
 pub use gl_context_wgl::PlatformDisplayData;
 
+// Framebuffers are allocated in size classes, each dimension rounded up to a power of two no
+// smaller than this, so that tiles of similar sizes can reuse each other's framebuffers.
+const MIN_FRAMEBUFFER_SIZE: i32 = 64;
+
+// Released framebuffers beyond this many are destroyed, least recently released first.
+const MAX_POOLED_FRAMEBUFFERS: usize = 8;
+
+// A framebuffer object with a color texture and depth-stencil buffer, owned by a GLContext.
+// Its size is that of its size class, which may be larger than the tile drawn into it; the tile
+// occupies the bottom left corner.
+pub struct PooledFramebuffer {
+    pub framebuffer_id: gl::GLuint,
+    pub texture_id: gl::GLuint,
+    pub depth_stencil_renderbuffer_id: gl::GLuint,
+    pub size: Size2D<i32>,
+}
+
+fn framebuffer_size_class(size: Size2D<i32>) -> Size2D<i32> {
+    fn round_up(length: i32) -> i32 {
+        let mut class = MIN_FRAMEBUFFER_SIZE;
+        while class < length {
+            class *= 2;
+        }
+        class
+    }
+    Size2D::new(round_up(size.width), round_up(size.height))
+}
+
 pub struct GLContext {
     gl: Rc<gl::Gl>,
     pub platform_context: GLPlatformContext,
     pub gr_context: skia::SkiaGrContextRef,
     pub gl_interface: skia::SkiaGrGLInterfaceRef,
     pub size: Size2D<i32>,
+
+    // Released framebuffers, least recently released first.
+    framebuffer_pool: RefCell<Vec<PooledFramebuffer>>,
 }
 
 impl Drop for GLContext {
     fn drop(&mut self) {
         self.platform_context.make_current();
 
+        for framebuffer in self.framebuffer_pool.borrow_mut().drain(..) {
+            gl_rasterization_context::destroy_framebuffer(&*self.gl,
+                                                          framebuffer.framebuffer_id,
+                                                          framebuffer.texture_id,
+                                                          framebuffer.depth_stencil_renderbuffer_id);
+        }
+
         unsafe {
             skia::SkiaGrContextRelease(self.gr_context);
             skia::SkiaGrGLInterfaceRelease(self.gl_interface);
@@ -89,6 +130,7 @@ impl GLContext {
                 gr_context: gr_context,
                 gl_interface: gl_interface,
                 size: size,
+                framebuffer_pool: RefCell::new(Vec::new()),
             }))
         }
    }
@@ -109,4 +151,116 @@ impl GLContext {
     pub fn drop_current_context(&self) {
         self.platform_context.drop_current_context();
     }
+
+    // The GPU resource cache limits of the GrContext, as the maximum number of resources and
+    // of bytes. Resources beyond them are purged, least recently used first.
+    pub fn resource_cache_limits(&self) -> (i32, usize) {
+        let (mut max_resources, mut max_bytes): (i32, libc::size_t) = (0, 0);
+        unsafe {
+            skia::SkiaGrContextGetResourceCacheLimits(self.gr_context,
+                                                      &mut max_resources,
+                                                      &mut max_bytes);
+        }
+        (max_resources, max_bytes as usize)
+    }
+
+    pub fn set_resource_cache_limits(&self, max_resources: i32, max_bytes: usize) {
+        self.make_current();
+        unsafe {
+            skia::SkiaGrContextSetResourceCacheLimits(self.gr_context,
+                                                      max_resources,
+                                                      max_bytes as libc::size_t);
+        }
+    }
+
+    // How many resources the GrContext's cache holds and how many bytes of them.
+    pub fn resource_cache_usage(&self) -> (i32, usize) {
+        let (mut count, mut bytes): (i32, libc::size_t) = (0, 0);
+        unsafe {
+            skia::SkiaGrContextGetResourceCacheUsage(self.gr_context, &mut count, &mut bytes);
+        }
+        (count, bytes as usize)
+    }
+
+    // For memory pressure: purges unused resources until the cache holds no more than max_bytes,
+    // leaving its limits as they are. Pass 0 to purge all that can be.
+    pub fn purge_unlocked_resources(&self, max_bytes: usize) {
+        self.make_current();
+        unsafe {
+            skia::SkiaGrContextPurgeUnlockedResources(self.gr_context, max_bytes as libc::size_t);
+        }
+    }
+
+    // For when the content is in the background: frees every GPU resource the GrContext can,
+    // its font and layer caches included, and the pooled framebuffers.
+    pub fn free_gpu_resources(&self) {
+        self.make_current();
+        for framebuffer in self.framebuffer_pool.borrow_mut().drain(..) {
+            gl_rasterization_context::destroy_framebuffer(&*self.gl,
+                                                          framebuffer.framebuffer_id,
+                                                          framebuffer.texture_id,
+                                                          framebuffer.depth_stencil_renderbuffer_id);
+        }
+        unsafe {
+            skia::SkiaGrContextFreeGpuResources(self.gr_context);
+            skia::SkiaGrContextResetContext(self.gr_context);
+        }
+    }
+
+    // Returns a framebuffer at least as large as the size, reusing a released one of the same
+    // size class if there is one. All of them share this context's GrContext.
+    pub fn acquire_framebuffer(&self, size: Size2D<i32>) -> Option<PooledFramebuffer> {
+        let size_class = framebuffer_size_class(size);
+        {
+            let mut pool = self.framebuffer_pool.borrow_mut();
+            if let Some(index) = pool.iter().rposition(|framebuffer| framebuffer.size == size_class) {
+                return Some(pool.remove(index));
+            }
+        }
+
+        self.make_current();
+        let gl = &*self.gl;
+        let ids = gl_rasterization_context::setup_framebuffer(gl,
+                                                              gl::TEXTURE_2D,
+                                                              size_class,
+                                                              self.gl_interface,
+                                                              || {
+            gl.tex_image_2d(gl::TEXTURE_2D, 0,
+                            gl::RGBA as gl::GLint,
+                            size_class.width, size_class.height, 0,
+                            gl::RGBA, gl::UNSIGNED_BYTE, None);
+        });
+        let framebuffer = ids.map(|(framebuffer_id, texture_id, depth_stencil_renderbuffer_id)| {
+            PooledFramebuffer {
+                framebuffer_id: framebuffer_id,
+                texture_id: texture_id,
+                depth_stencil_renderbuffer_id: depth_stencil_renderbuffer_id,
+                size: size_class,
+            }
+        });
+
+        // The GrContext caches GL bindings, which setting up the framebuffer changed.
+        unsafe {
+            skia::SkiaGrContextResetContext(self.gr_context);
+        }
+        framebuffer
+    }
+
+    // Returns a framebuffer from acquire_framebuffer() to the pool. Its contents are kept, but
+    // the next tile to use it will draw over them.
+    pub fn release_framebuffer(&self, framebuffer: PooledFramebuffer) {
+        let mut pool = self.framebuffer_pool.borrow_mut();
+        pool.push(framebuffer);
+        if pool.len() > MAX_POOLED_FRAMEBUFFERS {
+            let oldest = pool.remove(0);
+            self.make_current();
+            gl_rasterization_context::destroy_framebuffer(&*self.gl,
+                                                          oldest.framebuffer_id,
+                                                          oldest.texture_id,
+                                                          oldest.depth_stencil_renderbuffer_id);
+            unsafe {
+                skia::SkiaGrContextResetContext(self.gr_context);
+            }
+        }
+    }
 }
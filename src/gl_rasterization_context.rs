@@ -20,6 +20,20 @@ pub use gl_rasterization_context_android::GLRasterizationContext;
 #[cfg(target_os="windows")]
 pub use gl_rasterization_context_wgl::GLRasterizationContext;
 
+// Flushes the commands issued on the context so far and waits until the GPU has executed them,
+// so that the surface can be handed to its consumer. Waiting on a fence (ARB_sync) only waits
+// for this work, where glFinish() would stall until the whole GPU is idle. Contexts without
+// fences fall back to glFinish().
+pub fn wait_for_gpu(gr_context: skia::SkiaGrContextRef) {
+    unsafe {
+        let fence = skia::SkiaGrContextFlushWithFence(gr_context);
+        if fence != 0 {
+            skia::SkiaGrContextWaitFence(gr_context, fence);
+            skia::SkiaGrContextDeleteFence(gr_context, fence);
+        }
+    }
+}
+
 fn clear_gl_errors(gl: &gl::Gl) {
     let mut error = gl.get_error();
     while error != gl::NO_ERROR {
@@ -83,8 +83,11 @@ impl GLRasterizationContext {
         self.gl_context.gl().flush();
     }
 
+    // Skia draws straight into the texture behind the EGLImage, so there is nothing to copy;
+    // the consumer only needs the drawing to have landed.
     pub fn flush_to_surface(&self) {
         self.gl_context.gl().bind_framebuffer(0x8CA8 as gl::GLenum, self.framebuffer_id);
         self.gl_context.gl().framebuffer_texture_2d(gl::FRAMEBUFFER, gl::COLOR_ATTACHMENT0, gl::TEXTURE_2D, 0, 0);
+        gl_rasterization_context::wait_for_gpu(self.gl_context.gr_context);
     }
 }
@@ -55,7 +55,10 @@ impl GLRasterizationContext {
         self.gl_context.gl().flush();
     }
 
+    // Skia draws straight into the IOSurface, so there is nothing to copy; the consumer only
+    // needs the drawing to have landed.
     pub fn flush_to_surface(&self) {
         self.gl_context.gl().bind_framebuffer(gl::FRAMEBUFFER, self.framebuffer_id);
+        gl_rasterization_context::wait_for_gpu(self.gl_context.gr_context);
     }
 }
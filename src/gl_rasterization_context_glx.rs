@@ -5,11 +5,12 @@
  * found in the LICENSE file.
  */
 
-use gl_context::GLContext;
+use gl_context::{GLContext, PooledFramebuffer};
+use gl_rasterization_context;
 
 use euclid::Size2D;
 use gleam::gl;
-use std::ptr;
+use glx;
 use std::sync::Arc;
 use x11::xlib;
 
@@ -18,7 +19,22 @@ pub struct GLRasterizationContext {
     pub size: Size2D<i32>,
     pub framebuffer_id: gl::GLuint,
 
-    pixmap: xlib::XID,
+    framebuffer: Option<PooledFramebuffer>,
+    // The target pixmap, wrapped so that the GLContext can draw into it directly.
+    glx_pixmap: xlib::XID,
+}
+
+impl Drop for GLRasterizationContext {
+    fn drop(&mut self) {
+        if let Some(framebuffer) = self.framebuffer.take() {
+            self.gl_context.release_framebuffer(framebuffer);
+        }
+        self.gl_context.drop_current_context();
+        unsafe {
+            let glx_display = self.gl_context.platform_context.display as *mut glx::types::Display;
+            glx::DestroyGLXPixmap(glx_display, self.glx_pixmap);
+        }
+    }
 }
 
 impl GLRasterizationContext {
@@ -26,16 +42,47 @@ impl GLRasterizationContext {
                pixmap: xlib::Pixmap,
                size: Size2D<i32>)
                -> Option<GLRasterizationContext> {
+        // The pixmap must have been created with the GLContext's visual.
+        let glx_pixmap = unsafe {
+            let platform_context = &gl_context.platform_context;
+            glx::CreateGLXPixmap(platform_context.display as *mut glx::types::Display,
+                                 platform_context.visual_info as *mut glx::types::XVisualInfo,
+                                 pixmap)
+        };
+        if glx_pixmap == 0 {
+            return None;
+        }
+
+        let framebuffer = match gl_context.acquire_framebuffer(size) {
+            Some(framebuffer) => framebuffer,
+            None => {
+                unsafe {
+                    glx::DestroyGLXPixmap(gl_context.platform_context.display as
+                                              *mut glx::types::Display,
+                                          glx_pixmap);
+                }
+                return None;
+            }
+        };
+
         Some(GLRasterizationContext {
             gl_context: gl_context.clone(),
             size: size,
-            framebuffer_id: gl_context.platform_context.framebuffer_id,
-            pixmap: pixmap,
+            framebuffer_id: framebuffer.framebuffer_id,
+            framebuffer: Some(framebuffer),
+            glx_pixmap: glx_pixmap as xlib::XID,
         })
     }
 
+    // Skia draws into the pooled framebuffer object whatever the drawable, so the
+    // target pixmap is bound as the default framebuffer for flush_to_surface() to blit into.
     pub fn make_current(&self) {
-        self.gl_context.make_current();
+        let platform_context = &self.gl_context.platform_context;
+        unsafe {
+            glx::MakeCurrent(platform_context.display as *mut glx::types::Display,
+                             self.glx_pixmap,
+                             platform_context.glx_context as glx::types::GLXContext);
+        }
     }
 
     pub fn flush(&self) {
@@ -44,32 +91,20 @@ impl GLRasterizationContext {
     }
 
     pub fn flush_to_surface(&self) {
+        self.make_current();
         self.gl_context.gl().bind_framebuffer(gl::READ_FRAMEBUFFER, self.framebuffer_id);
         self.gl_context.gl().bind_framebuffer(gl::DRAW_FRAMEBUFFER, 0);
 
+        // The tile is in the bottom left corner of the pooled framebuffer, which may be larger.
+        // The pixmap is exactly the tile's size, so GL's bottom left origin lines up with its
+        // bottom left corner and the whole of it is covered.
         self.gl_context.gl().blit_framebuffer(0, 0,
                                               self.size.width, self.size.height,
                                               0, 0,
                                               self.size.width, self.size.height,
                                               gl::COLOR_BUFFER_BIT, gl::NEAREST);
 
-        self.gl_context.gl().finish();
+        gl_rasterization_context::wait_for_gpu(self.gl_context.gr_context);
         self.gl_context.drop_current_context();
-
-        // Since the GLRasterizationContext renders to a Pixmap that is owned by the
-        // GLContext, we now need to copy the results to the target Pixmap. This means
-        // we do an extra hardware copy, but allows us to reuse the same GLContext.
-        let display = self.gl_context.platform_context.display;
-        let source_pixmap = self.gl_context.platform_context.pixmap;
-        unsafe {
-            let gc = xlib::XCreateGC(display, self.pixmap, 0, ptr::null_mut());
-            xlib::XCopyArea(display, source_pixmap,
-                            self.pixmap,
-                            gc,
-                            0, (self.gl_context.size.height - self.size.height),
-                            self.size.width as u32, self.size.height as u32,
-                            0, 0);
-            xlib::XFreeGC(display, gc);
-        }
     }
 }
@@ -50,5 +50,6 @@ impl GLRasterizationContext {
     pub fn flush_to_surface(&self) {
         self.gl_context.gl().bind_framebuffer(gl::READ_FRAMEBUFFER, self.framebuffer_id);
         self.gl_context.gl().framebuffer_texture_2d(gl::FRAMEBUFFER, gl::COLOR_ATTACHMENT0, gl::TEXTURE_2D, 0, 0);
+        gl_rasterization_context::wait_for_gpu(self.gl_context.gr_context);
     }
 }
@@ -24,7 +24,8 @@
 
 #include "effects/GrVertexEffect.h"
 
-GrAAConvexPathRenderer::GrAAConvexPathRenderer() {
+GrAAConvexPathRenderer::GrAAConvexPathRenderer(GrContext* context)
+    : fContext(context) {
 }
 
 struct Segment {
@@ -623,6 +624,68 @@ extern const GrVertexAttrib gPathAttribs[] = {
 
 };
 
+GrTessellatedPath* GrAAConvexPathRenderer::findOrCreateCachedGeom(const SkPath& path,
+                                                                  const SkMatrix& viewMatrix) {
+    // The geometry is tessellated in device space, so we can only reuse it when the scale is
+    // unchanged. We don't bother with rotations and skews.
+    static const SkMatrix::TypeMask kScaleTranslateMask = static_cast<SkMatrix::TypeMask>(
+        SkMatrix::kScale_Mask | SkMatrix::kTranslate_Mask);
+    if ((viewMatrix.getType() & ~kScaleTranslateMask) ||
+        !fRecentGenIDs.checkAndAdd(path.getGenerationID())) {
+        return NULL;
+    }
+
+    static const GrCacheID::Domain gDomain = GrCacheID::GenerateDomain();
+    const uint32_t params[3] = {
+        static_cast<uint32_t>(SkFloat2Bits(SkScalarToFloat(viewMatrix.getScaleX()))),
+        static_cast<uint32_t>(SkFloat2Bits(SkScalarToFloat(viewMatrix.getScaleY()))),
+        0
+    };
+    GrResourceKey key = GrTessellatedPath::ComputeKey(gDomain, path.getGenerationID(), params);
+
+    GrTessellatedPath* geom =
+        static_cast<GrTessellatedPath*>(fContext->findAndRefCachedResource(key));
+    if (NULL != geom) {
+        return geom;
+    }
+
+    SkMatrix untranslated = viewMatrix;
+    untranslated.setTranslateX(0);
+    untranslated.setTranslateY(0);
+
+    int vCount;
+    int iCount;
+    SkSTArray<512 / sizeof(Segment), Segment, true> segments;
+    SkPoint fanPt;
+    SkRect devBounds;
+    if (!get_segments(path, untranslated, &segments, &fanPt, &vCount, &iCount, &devBounds)) {
+        return NULL;
+    }
+    devBounds.outset(SK_Scalar1, SK_Scalar1);
+
+    SkAutoTMalloc<QuadVertex> verts(vCount);
+    SkAutoTMalloc<uint16_t> idxs(iCount);
+    SkSTArray<4, Draw, true> draws;
+    create_vertices(segments, fanPt, &draws, verts.get(), idxs.get());
+
+    SkSTArray<4, GrTessellatedPath::Draw, true> geomDraws;
+    for (int i = 0; i < draws.count(); ++i) {
+        GrTessellatedPath::Draw& draw = geomDraws.push_back();
+        draw.fVertexCnt = draws[i].fVertexCnt;
+        draw.fIndexCnt = draws[i].fIndexCnt;
+    }
+    geom = GrTessellatedPath::Create(fContext->getGpu(),
+                                     verts.get(), sizeof(QuadVertex), vCount,
+                                     idxs.get(), iCount,
+                                     geomDraws.begin(), geomDraws.count(),
+                                     kTriangles_GrPrimitiveType,
+                                     devBounds);
+    if (NULL != geom) {
+        fContext->addResourceToCache(key, geom);
+    }
+    return geom;
+}
+
 bool GrAAConvexPathRenderer::onDrawPath(const SkPath& origPath,
                                         const SkStrokeRec&,
                                         GrDrawTarget* target,
@@ -661,45 +724,65 @@ bool GrAAConvexPathRenderer::onDrawPath(const SkPath& origPath,
     };
     SkSTArray<kPreallocSegmentCnt, Segment, true> segments;
     SkPoint fanPt;
-
-    // We can't simply use the path bounds because we may degenerate cubics to quads which produces
-    // new control points outside the original convex hull.
+    SkSTArray<kPreallocDrawCnt, Draw, true> draws;
     SkRect devBounds;
-    if (!get_segments(*path, viewMatrix, &segments, &fanPt, &vCount, &iCount, &devBounds)) {
-        return false;
-    }
-
-    // Our computed verts should all be within one pixel of the segment control points.
-    devBounds.outset(SK_Scalar1, SK_Scalar1);
 
     drawState->setVertexAttribs<gPathAttribs>(SK_ARRAY_COUNT(gPathAttribs));
 
     static const int kEdgeAttrIndex = 1;
     GrEffectRef* quadEffect = QuadEdgeEffect::Create();
     drawState->addCoverageEffect(quadEffect, kEdgeAttrIndex)->unref();
-
-    GrDrawTarget::AutoReleaseGeometry arg(target, vCount, iCount);
-    if (!arg.succeeded()) {
-        return false;
-    }
     SkASSERT(sizeof(QuadVertex) == drawState->getVertexSize());
-    verts = reinterpret_cast<QuadVertex*>(arg.vertices());
-    idxs = reinterpret_cast<uint16_t*>(arg.indices());
 
-    SkSTArray<kPreallocDrawCnt, Draw, true> draws;
-    create_vertices(segments, fanPt, &draws, verts, idxs);
+    GrDrawTarget::AutoReleaseGeometry arg;
+    GrTessellatedPath::AutoGeometrySrc ags;
+    GrDrawState::AutoViewMatrixRestore avmr;
+    SkAutoTUnref<GrTessellatedPath> cachedGeom(this->findOrCreateCachedGeom(*path, viewMatrix));
+    if (NULL != cachedGeom.get()) {
+        ags.set(target, cachedGeom);
+        // The cached geometry has yet to be translated into device space.
+        SkScalar tx = viewMatrix.getTranslateX();
+        SkScalar ty = viewMatrix.getTranslateY();
+        SkMatrix translate;
+        translate.setTranslate(tx, ty);
+        avmr.set(drawState, translate);
+        devBounds = cachedGeom->bounds();
+        devBounds.offset(tx, ty);
+        for (int i = 0; i < cachedGeom->drawCount(); ++i) {
+            Draw& draw = draws.push_back();
+            draw.fVertexCnt = cachedGeom->draw(i).fVertexCnt;
+            draw.fIndexCnt = cachedGeom->draw(i).fIndexCnt;
+        }
+    } else {
+        // We can't simply use the path bounds because we may degenerate cubics to quads which
+        // produces new control points outside the original convex hull.
+        if (!get_segments(*path, viewMatrix, &segments, &fanPt, &vCount, &iCount, &devBounds)) {
+            return false;
+        }
+
+        // Our computed verts should all be within one pixel of the segment control points.
+        devBounds.outset(SK_Scalar1, SK_Scalar1);
+
+        if (!arg.set(target, vCount, iCount)) {
+            return false;
+        }
+        verts = reinterpret_cast<QuadVertex*>(arg.vertices());
+        idxs = reinterpret_cast<uint16_t*>(arg.indices());
+
+        create_vertices(segments, fanPt, &draws, verts, idxs);
 
-    // Check devBounds
+        // Check devBounds
 #ifdef SK_DEBUG
-    SkRect tolDevBounds = devBounds;
-    tolDevBounds.outset(SK_Scalar1 / 10000, SK_Scalar1 / 10000);
-    SkRect actualBounds;
-    actualBounds.set(verts[0].fPos, verts[1].fPos);
-    for (int i = 2; i < vCount; ++i) {
-        actualBounds.growToInclude(verts[i].fPos.fX, verts[i].fPos.fY);
-    }
-    SkASSERT(tolDevBounds.contains(actualBounds));
+        SkRect tolDevBounds = devBounds;
+        tolDevBounds.outset(SK_Scalar1 / 10000, SK_Scalar1 / 10000);
+        SkRect actualBounds;
+        actualBounds.set(verts[0].fPos, verts[1].fPos);
+        for (int i = 2; i < vCount; ++i) {
+            actualBounds.growToInclude(verts[i].fPos.fX, verts[i].fPos.fY);
+        }
+        SkASSERT(tolDevBounds.contains(actualBounds));
 #endif
+    }
 
     int vOffset = 0;
     for (int i = 0; i < draws.count(); ++i) {
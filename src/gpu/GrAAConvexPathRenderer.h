@@ -7,11 +7,12 @@
  */
 
 #include "GrPathRenderer.h"
+#include "GrTessellatedPath.h"
 
 
 class GrAAConvexPathRenderer : public GrPathRenderer {
 public:
-    GrAAConvexPathRenderer();
+    GrAAConvexPathRenderer(GrContext* context);
 
     virtual bool canDrawPath(const SkPath& path,
                              const SkStrokeRec& stroke,
@@ -23,4 +24,13 @@ protected:
                             const SkStrokeRec& stroke,
                             GrDrawTarget* target,
                             bool antiAlias) SK_OVERRIDE;
+
+private:
+    // Returns the path's device space geometry, less the view matrix's translation, in static
+    // buffers from the resource cache. The geometry is created if the path has been drawn
+    // recently. Returns NULL if the geometry should be streamed instead.
+    GrTessellatedPath* findOrCreateCachedGeom(const SkPath&, const SkMatrix& viewMatrix);
+
+    GrContext*                      fContext;
+    GrTessellatedPath::RecentGenIDs fRecentGenIDs;
 };
@@ -7,6 +7,7 @@
 
 #include "GrAARectRenderer.h"
 #include "GrGpu.h"
+#include "GrVertexBuffer.h"
 #include "gl/GrGLEffect.h"
 #include "gl/GrGLVertexEffect.h"
 #include "GrTBackendEffectFactory.h"
@@ -257,6 +258,113 @@ GrEffectRef* GrRectEffect::TestCreate(SkRandom* random,
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Places the vertices of a hardware instanced AA rect and computes their coverage. Each instance
+ * supplies the rect as:
+ *      Center of the rect in device space
+ *      The device space vectors from the center to the middle of the right and bottom edges
+ * The unit geometry is the AA fill rect's outer and inner rings of corners, with the corner's
+ * direction (-1 or 1) in each component. Outer corners are scaled by 2 to tell them apart.
+ */
+class GrInstancedRectEffect : public GrVertexEffect {
+public:
+    static GrEffectRef* Create() {
+        GR_CREATE_STATIC_EFFECT(gInstancedRectEffect, GrInstancedRectEffect, ());
+        gInstancedRectEffect->ref();
+        return gInstancedRectEffect;
+    }
+
+    virtual ~GrInstancedRectEffect() {}
+
+    static const char* Name() { return "InstancedRect"; }
+
+    virtual void getConstantColorComponents(GrColor* color,
+                                            uint32_t* validFlags) const SK_OVERRIDE {
+        *validFlags = 0;
+    }
+
+    virtual const GrBackendEffectFactory& getFactory() const SK_OVERRIDE {
+        return GrTBackendEffectFactory<GrInstancedRectEffect>::getInstance();
+    }
+
+    class GLEffect : public GrGLVertexEffect {
+    public:
+        GLEffect(const GrBackendEffectFactory& factory, const GrDrawEffect&)
+        : INHERITED (factory) {}
+
+        virtual void emitCode(GrGLFullShaderBuilder* builder,
+                              const GrDrawEffect& drawEffect,
+                              EffectKey key,
+                              const char* outputColor,
+                              const char* inputColor,
+                              const TransformedCoordsArray&,
+                              const TextureSamplerArray& samplers) SK_OVERRIDE {
+            const char* unitPos = builder->positionAttribute().c_str();
+            const SkString* centerName =
+                builder->getEffectAttributeName(drawEffect.getVertexAttribIndices()[0]);
+            const SkString* axesName =
+                builder->getEffectAttributeName(drawEffect.getVertexAttribIndices()[1]);
+
+            builder->vsCodeAppendf("\tvec2 corner = sign(%s);\n", unitPos);
+            builder->vsCodeAppendf("\tfloat outer = abs(%s.x) - 1.0;\n", unitPos);
+            // This matches the geometry of GrAARectRenderer::geometryFillAARect: the outer ring is
+            // outset by half a pixel and the inner ring is inset by up to half a pixel, less for
+            // rects that are thinner than a pixel.
+            builder->vsCodeAppendf("\tvec2 devSize = 2.0 * vec2(length(%s.xy), length(%s.zw));\n",
+                                   axesName->c_str(), axesName->c_str());
+            builder->vsCodeAppend("\tfloat inset = 0.5 * min(min(devSize.x, devSize.y), 1.0);\n");
+            builder->vsCodeAppend("\tfloat offset = mix(-inset, 0.5, outer);\n");
+            builder->vsCodeAppendf("\tvec2 devPos = %s + "
+                                   "corner.x * (%s.xy + offset * normalize(%s.xy)) + "
+                                   "corner.y * (%s.zw + offset * normalize(%s.zw));\n",
+                                   centerName->c_str(),
+                                   axesName->c_str(), axesName->c_str(),
+                                   axesName->c_str(), axesName->c_str());
+            builder->setPosition("devPos");
+
+            const char *vsCoverageName, *fsCoverageName;
+            builder->addVarying(kFloat_GrSLType, "Coverage", &vsCoverageName, &fsCoverageName);
+            builder->vsCodeAppendf("\t%s = (1.0 - outer) * min(1.0, 2.0 * inset / (inset + 0.5));\n",
+                                   vsCoverageName);
+
+            builder->fsCodeAppendf("\t%s = %s;\n", outputColor,
+                                   (GrGLSLExpr4(inputColor) * GrGLSLExpr1(fsCoverageName)).c_str());
+        }
+
+        static inline EffectKey GenKey(const GrDrawEffect& drawEffect, const GrGLCaps&) {
+            return 0;
+        }
+
+        virtual void setData(const GrGLUniformManager& uman, const GrDrawEffect&) SK_OVERRIDE {}
+
+    private:
+        typedef GrGLVertexEffect INHERITED;
+    };
+
+private:
+    GrInstancedRectEffect() : GrVertexEffect() {
+        this->addVertexAttrib(kVec2f_GrSLType);
+        this->addVertexAttrib(kVec4f_GrSLType);
+    }
+
+    virtual bool onIsEqual(const GrEffect&) const SK_OVERRIDE { return true; }
+
+    GR_DECLARE_EFFECT_TEST;
+
+    typedef GrVertexEffect INHERITED;
+};
+
+GR_DEFINE_EFFECT_TEST(GrInstancedRectEffect);
+
+GrEffectRef* GrInstancedRectEffect::TestCreate(SkRandom* random,
+                                               GrContext* context,
+                                               const GrDrawTargetCaps&,
+                                               GrTexture* textures[]) {
+    return GrInstancedRectEffect::Create();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 namespace {
 
 extern const GrVertexAttrib gAARectCoverageAttribs[] = {
@@ -289,6 +397,7 @@ void GrAARectRenderer::reset() {
     SkSafeSetNull(fAAFillRectIndexBuffer);
     SkSafeSetNull(fAAMiterStrokeRectIndexBuffer);
     SkSafeSetNull(fAABevelStrokeRectIndexBuffer);
+    SkSafeSetNull(fAAFillRectUnitGeometry);
 }
 
 static const uint16_t gFillAARectIdx[] = {
@@ -339,6 +448,26 @@ GrIndexBuffer* GrAARectRenderer::aaFillRectIndexBuffer(GrGpu* gpu) {
     return fAAFillRectIndexBuffer;
 }
 
+GrVertexBuffer* GrAARectRenderer::aaFillRectUnitGeometry(GrGpu* gpu) {
+    if (NULL == fAAFillRectUnitGeometry) {
+        // The corners in the same order as set_inset_fan, outer ring first.
+        static const SkPoint kCorners[kVertsPerAAFillRect] = {
+            { -2, -2 }, { -2, 2 }, { 2, 2 }, { 2, -2 },
+            { -1, -1 }, { -1, 1 }, { 1, 1 }, { 1, -1 },
+        };
+        SkPoint verts[kIndicesPerAAFillRect];
+        for (int i = 0; i < kIndicesPerAAFillRect; ++i) {
+            verts[i] = kCorners[gFillAARectIdx[i]];
+        }
+        fAAFillRectUnitGeometry = gpu->createVertexBuffer(sizeof(verts), false);
+        if (NULL != fAAFillRectUnitGeometry &&
+            !fAAFillRectUnitGeometry->updateData(verts, sizeof(verts))) {
+            SkSafeSetNull(fAAFillRectUnitGeometry);
+        }
+    }
+    return fAAFillRectUnitGeometry;
+}
+
 static const uint16_t gMiterStrokeAARectIdx[] = {
     0 + 0, 1 + 0, 5 + 0, 5 + 0, 4 + 0, 0 + 0,
     1 + 0, 2 + 0, 6 + 0, 6 + 0, 5 + 0, 1 + 0,
@@ -569,6 +698,93 @@ void GrAARectRenderer::geometryFillAARect(GrGpu* gpu,
 
 namespace {
 
+struct AAFillRectInstance {
+    SkPoint  fUnused;       // the position attribute's slot, positions come from the unit geometry
+    SkPoint  fCenter;
+    SkVector fAxes[2];
+    GrColor  fColor;
+};
+
+extern const GrVertexAttrib gAAFillRectInstanceAttribs[] = {
+    { kVec2f_GrVertexAttribType,  0,                   kPosition_GrVertexAttribBinding },
+    { kVec2f_GrVertexAttribType,  sizeof(SkPoint),     kEffect_GrVertexAttribBinding },
+    { kVec4f_GrVertexAttribType,  2 * sizeof(SkPoint), kEffect_GrVertexAttribBinding },
+    { kVec4ub_GrVertexAttribType, 4 * sizeof(SkPoint), kColor_GrVertexAttribBinding },
+};
+
+};
+
+bool GrAARectRenderer::instancedFillAARect(GrGpu* gpu,
+                                           GrDrawTarget* target,
+                                           const SkRect& rect,
+                                           const SkMatrix& combinedMatrix,
+                                           const SkRect& devRect,
+                                           bool useVertexCoverage) {
+    if (!target->canDrawHWInstances() || combinedMatrix.hasPerspective()) {
+        return false;
+    }
+
+    SkRect sorted = rect;
+    sorted.sort();
+    SkVector axes[2] = {
+        { combinedMatrix[SkMatrix::kMScaleX], combinedMatrix[SkMatrix::kMSkewY] },
+        { combinedMatrix[SkMatrix::kMSkewX],  combinedMatrix[SkMatrix::kMScaleY] }
+    };
+    axes[0].scale(SkScalarHalf(sorted.width()));
+    axes[1].scale(SkScalarHalf(sorted.height()));
+    // The shader normalizes the axes.
+    if (SkScalarNearlyZero(axes[0].length()) || SkScalarNearlyZero(axes[1].length())) {
+        return false;
+    }
+
+    GrVertexBuffer* unitGeometry = this->aaFillRectUnitGeometry(gpu);
+    if (NULL == unitGeometry) {
+        return false;
+    }
+
+    GrDrawState* drawState = target->drawState();
+    GrColor color = drawState->getColor();
+
+    drawState->setVertexAttribs<gAAFillRectInstanceAttribs>(
+        SK_ARRAY_COUNT(gAAFillRectInstanceAttribs));
+    SkASSERT(sizeof(AAFillRectInstance) == drawState->getVertexSize());
+
+    GrDrawTarget::AutoReleaseGeometry geo(target, 1, 0);
+    if (!geo.succeeded()) {
+        GrPrintf("Failed to get space for vertices!\n");
+        return true;
+    }
+
+    AAFillRectInstance* instance = reinterpret_cast<AAFillRectInstance*>(geo.vertices());
+    instance->fUnused.set(0, 0);
+    instance->fCenter.set(sorted.centerX(), sorted.centerY());
+    combinedMatrix.mapPoints(&instance->fCenter, 1);
+    instance->fAxes[0] = axes[0];
+    instance->fAxes[1] = axes[1];
+    instance->fColor = color;
+
+    // The color comes from the instance, so a constant draw state color lets rects of different
+    // colors share a draw. When coverage can't be applied separately it is folded into the color
+    // just as geometryFillAARect does.
+    GrDrawState::AutoColorRestore acr(drawState, GrColorPackRGBA(0xff, 0xff, 0xff, 0xff));
+    GrEffectRef* effect = GrInstancedRectEffect::Create();
+    static const int kCenterAttrIndex = 1;
+    static const int kAxesAttrIndex = 2;
+    if (useVertexCoverage) {
+        drawState->addCoverageEffect(effect, kCenterAttrIndex, kAxesAttrIndex)->unref();
+    } else {
+        drawState->addColorEffect(effect, kCenterAttrIndex, kAxesAttrIndex)->unref();
+    }
+
+    SkRect devBounds = devRect;
+    devBounds.outset(SK_ScalarHalf, SK_ScalarHalf);
+    target->drawHWInstances(kTriangles_GrPrimitiveType, unitGeometry, kIndicesPerAAFillRect, 1,
+                            &devBounds);
+    return true;
+}
+
+namespace {
+
 // Rotated
 struct RectVertex {
     SkPoint fPos;
@@ -16,6 +16,7 @@
 class GrGpu;
 class GrDrawTarget;
 class GrIndexBuffer;
+class GrVertexBuffer;
 
 /*
  * This class wraps helper functions that draw AA rects (filled & stroked)
@@ -27,7 +28,8 @@ public:
     GrAARectRenderer()
     : fAAFillRectIndexBuffer(NULL)
     , fAAMiterStrokeRectIndexBuffer(NULL)
-    , fAABevelStrokeRectIndexBuffer(NULL) {
+    , fAABevelStrokeRectIndexBuffer(NULL)
+    , fAAFillRectUnitGeometry(NULL) {
     }
 
     void reset();
@@ -54,9 +56,13 @@ public:
                                    rect, combinedMatrix);
         }
 #else
-        this->geometryFillAARect(gpu, target,
-                                 rect, combinedMatrix,
-                                 devRect, useVertexCoverage);
+        if (!this->instancedFillAARect(gpu, target,
+                                       rect, combinedMatrix,
+                                       devRect, useVertexCoverage)) {
+            this->geometryFillAARect(gpu, target,
+                                     rect, combinedMatrix,
+                                     devRect, useVertexCoverage);
+        }
 #endif
     }
 
@@ -79,8 +85,10 @@ private:
     GrIndexBuffer*              fAAFillRectIndexBuffer;
     GrIndexBuffer*              fAAMiterStrokeRectIndexBuffer;
     GrIndexBuffer*              fAABevelStrokeRectIndexBuffer;
+    GrVertexBuffer*             fAAFillRectUnitGeometry;
 
     GrIndexBuffer* aaFillRectIndexBuffer(GrGpu* gpu);
+    GrVertexBuffer* aaFillRectUnitGeometry(GrGpu* gpu);
 
     static int aaStrokeRectIndexCount(bool miterStroke);
     GrIndexBuffer* aaStrokeRectIndexBuffer(GrGpu* gpu, bool miterStroke);
@@ -94,6 +102,16 @@ private:
                             const SkRect& devRect,
                             bool useVertexCoverage);
 
+    // Draws the rect with GrDrawTarget::drawHWInstances so that consecutive rects, even of
+    // different colors and matrices, are batched into one draw. Returns false if the draw can't
+    // be done this way, e.g. because instancing isn't supported or the paint has effects.
+    bool instancedFillAARect(GrGpu* gpu,
+                             GrDrawTarget* target,
+                             const SkRect& rect,
+                             const SkMatrix& combinedMatrix,
+                             const SkRect& devRect,
+                             bool useVertexCoverage);
+
     void shaderFillAARect(GrGpu* gpu,
                           GrDrawTarget* target,
                           const SkRect& rect,
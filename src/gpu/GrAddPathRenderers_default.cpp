@@ -10,6 +10,7 @@
 #include "GrStencilAndCoverPathRenderer.h"
 #include "GrAAHairLinePathRenderer.h"
 #include "GrAAConvexPathRenderer.h"
+#include "GrMSAAPathRenderer.h"
 #if GR_STROKE_PATH_RENDERING
 #include "../../experimental/StrokePathRenderer/GrStrokePathRenderer.h"
 #endif
@@ -30,5 +31,8 @@ void GrPathRenderer::AddPathRenderers(GrContext* ctx, GrPathRendererChain* chain
     if (GrPathRenderer* pr = GrAAHairLinePathRenderer::Create(ctx)) {
         chain->addPathRenderer(pr)->unref();
     }
-    chain->addPathRenderer(SkNEW(GrAAConvexPathRenderer))->unref();
+    chain->addPathRenderer(SkNEW_ARGS(GrAAConvexPathRenderer, (ctx)))->unref();
+    if (GrPathRenderer* pr = GrMSAAPathRenderer::Create(ctx)) {
+        chain->addPathRenderer(pr)->unref();
+    }
 }
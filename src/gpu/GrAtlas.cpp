@@ -10,6 +10,7 @@
 #include "GrContext.h"
 #include "GrGpu.h"
 #include "GrRectanizer.h"
+#include "GrRectanizer_maxrects.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -23,6 +24,7 @@ GrPlot::GrPlot() : fDrawToken(NULL, 0)
                  , fTexture(NULL)
                  , fRects(NULL)
                  , fAtlasMgr(NULL)
+                 , fPage(0)
                  , fBytesPerPixel(1)
                  , fDirty(false)
                  , fBatchUploads(false)
@@ -36,10 +38,15 @@ GrPlot::~GrPlot() {
     delete fRects;
 }
 
-void GrPlot::init(GrAtlasMgr* mgr, int offX, int offY, int width, int height, size_t bpp,
-                  bool batchUploads) {
-    fRects = GrRectanizer::Factory(width, height);
+void GrPlot::init(GrAtlasMgr* mgr, int page, int offX, int offY, int width, int height,
+                  size_t bpp, bool batchUploads, bool freeSubImages) {
+    if (freeSubImages) {
+        fRects = SkNEW_ARGS(GrRectanizerMaxRects, (width, height));
+    } else {
+        fRects = GrRectanizer::Factory(width, height);
+    }
     fAtlasMgr = mgr;
+    fPage = page;
     fOffset.set(offX * width, offY * height);
     fBytesPerPixel = bpp;
     fPlotData = NULL;
@@ -60,6 +67,13 @@ bool GrPlot::addSubImage(int width, int height, const void* image,
         return false;
     }
 
+    // nothing to upload when only reserving space
+    if (NULL == image) {
+        SkASSERT(!fBatchUploads);
+        adjust_for_offset(loc, fOffset);
+        return true;
+    }
+
     // if batching uploads, create backing memory on first use
     // once the plot is nearly full we will revert to uploading each subimage individually
     int plotWidth = fRects->width();
@@ -103,6 +117,12 @@ bool GrPlot::addSubImage(int width, int height, const void* image,
     return true;
 }
 
+bool GrPlot::freeSubImage(int width, int height, const SkIPoint16& loc) {
+    SkIPoint16 plotLoc;
+    plotLoc.set(loc.fX - fOffset.fX, loc.fY - fOffset.fY);
+    return fRects->freeRect(plotLoc, width, height);
+}
+
 void GrPlot::uploadToTexture() {
     static const float kNearlyFullTolerance = 0.85f;
 
@@ -136,6 +156,11 @@ void GrPlot::uploadToTexture() {
     }
 }
 
+void GrPlot::setDrawToken(GrDrawTarget::DrawToken draw) {
+    fDrawToken = draw;
+    fAtlasMgr->moveToHead(this);
+}
+
 void GrPlot::resetRects() {
     SkASSERT(NULL != fRects);
     fRects->reset();
@@ -145,14 +170,21 @@ void GrPlot::resetRects() {
 
 GrAtlasMgr::GrAtlasMgr(GrGpu* gpu, GrPixelConfig config,
                        const SkISize& backingTextureSize,
-                       int numPlotsX, int numPlotsY, bool batchUploads) {
+                       int numPlotsX, int numPlotsY, bool batchUploads, int maxPages,
+                       GrTextureFlags textureFlags, bool freeSubImages) {
+    SkASSERT(maxPages > 0);
     fGpu = SkRef(gpu);
     fPixelConfig = config;
+    fTextureFlags = textureFlags;
     fBackingTextureSize = backingTextureSize;
     fNumPlotsX = numPlotsX;
     fNumPlotsY = numPlotsY;
+    fMaxPages = maxPages;
     fBatchUploads = batchUploads;
-    fTexture = NULL;
+    fTextures = SkNEW_ARRAY(GrTexture*, maxPages);
+    for (int page = 0; page < maxPages; ++page) {
+        fTextures[page] = NULL;
+    }
 
     int textureWidth = fBackingTextureSize.width();
     int textureHeight = fBackingTextureSize.height();
@@ -168,22 +200,29 @@ GrAtlasMgr::GrAtlasMgr(GrGpu* gpu, GrPixelConfig config,
 
     // set up allocated plots
     size_t bpp = GrBytesPerPixel(fPixelConfig);
-    fPlotArray = SkNEW_ARRAY(GrPlot, (fNumPlotsX*fNumPlotsY));
+    fPlotArray = SkNEW_ARRAY(GrPlot, (fNumPlotsX*fNumPlotsY*fMaxPages));
 
+    // Later pages go to the tail of the LRU list so the first page's plots are tried first.
     GrPlot* currPlot = fPlotArray;
-    for (int y = numPlotsY-1; y >= 0; --y) {
-        for (int x = numPlotsX-1; x >= 0; --x) {
-            currPlot->init(this, x, y, plotWidth, plotHeight, bpp, batchUploads);
-
-            // build LRU list
-            fPlotList.addToHead(currPlot);
-            ++currPlot;
+    for (int page = fMaxPages-1; page >= 0; --page) {
+        for (int y = numPlotsY-1; y >= 0; --y) {
+            for (int x = numPlotsX-1; x >= 0; --x) {
+                currPlot->init(this, page, x, y, plotWidth, plotHeight, bpp, batchUploads,
+                               freeSubImages);
+
+                // build LRU list
+                fPlotList.addToHead(currPlot);
+                ++currPlot;
+            }
         }
     }
 }
 
 GrAtlasMgr::~GrAtlasMgr() {
-    SkSafeUnref(fTexture);
+    for (int page = 0; page < fMaxPages; ++page) {
+        SkSafeUnref(fTextures[page]);
+    }
+    SkDELETE_ARRAY(fTextures);
     SkDELETE_ARRAY(fPlotArray);
 
     fGpu->unref();
@@ -214,41 +253,68 @@ GrPlot* GrAtlasMgr::addToAtlas(GrAtlas* atlas,
         }
     }
 
-    // before we get a new plot, make sure we have a backing texture
-    if (NULL == fTexture) {
-        // TODO: Update this to use the cache rather than directly creating a texture.
-        GrTextureDesc desc;
-        desc.fFlags = kDynamicUpdate_GrTextureFlagBit;
-        desc.fWidth = fBackingTextureSize.width();
-        desc.fHeight = fBackingTextureSize.height();
-        desc.fConfig = fPixelConfig;
-
-        fTexture = fGpu->createTexture(desc, NULL, 0);
-        if (NULL == fTexture) {
-            return NULL;
-        }
+    // a subimage larger than a plot can never be placed
+    if (width > fBackingTextureSize.width() / fNumPlotsX ||
+        height > fBackingTextureSize.height() / fNumPlotsY) {
+        return NULL;
     }
 
-    // now look through all allocated plots for one we can share, in MRU order
+    // now look through all allocated plots for one we can share, in MRU order. Plots on pages
+    // without a backing texture are only used when no allocated plot has room.
+    GrPlot* firstUnallocated = NULL;
     GrPlotList::Iter plotIter;
     plotIter.init(fPlotList, GrPlotList::Iter::kHead_IterStart);
     GrPlot* plot;
     while (NULL != (plot = plotIter.get())) {
-        // make sure texture is set for quick lookup
-        plot->fTexture = fTexture;
+        plotIter.next();
+        if (NULL == plot->fTexture) {
+            if (NULL == firstUnallocated) {
+                firstUnallocated = plot;
+            }
+            continue;
+        }
         if (plot->addSubImage(width, height, image, loc)) {
             this->moveToHead(plot);
             // new plot for atlas, put at end of array
             *(atlas->fPlots.append()) = plot;
             return plot;
         }
-        plotIter.next();
     }
 
-    // If the above fails, then the current plot list has no room
+    // If the above fails, then start a new page if we are allowed one
+    if (NULL != firstUnallocated && this->createPage(firstUnallocated->fPage) &&
+        firstUnallocated->addSubImage(width, height, image, loc)) {
+        this->moveToHead(firstUnallocated);
+        *(atlas->fPlots.append()) = firstUnallocated;
+        return firstUnallocated;
+    }
     return NULL;
 }
 
+bool GrAtlasMgr::createPage(int page) {
+    SkASSERT(NULL == fTextures[page]);
+    // TODO: Update this to use the cache rather than directly creating a texture.
+    GrTextureDesc desc;
+    desc.fFlags = fTextureFlags;
+    desc.fWidth = fBackingTextureSize.width();
+    desc.fHeight = fBackingTextureSize.height();
+    desc.fConfig = fPixelConfig;
+
+    fTextures[page] = fGpu->createTexture(desc, NULL, 0);
+    if (NULL == fTextures[page]) {
+        return false;
+    }
+
+    // make sure texture is set for quick lookup
+    int plotsPerPage = fNumPlotsX*fNumPlotsY;
+    for (int i = 0; i < plotsPerPage*fMaxPages; ++i) {
+        if (page == fPlotArray[i].fPage) {
+            fPlotArray[i].fTexture = fTextures[page];
+        }
+    }
+    return true;
+}
+
 bool GrAtlasMgr::removePlot(GrAtlas* atlas, const GrPlot* plot) {
     // iterate through plot list for this atlas
     int count = atlas->fPlots.count();
@@ -288,3 +354,13 @@ void GrAtlasMgr::uploadPlotsToTexture() {
         }
     }
 }
+
+size_t GrAtlasMgr::gpuMemorySize() const {
+    size_t bytes = 0;
+    for (int page = 0; page < fMaxPages; ++page) {
+        if (NULL != fTextures[page]) {
+            bytes += fTextures[page]->gpuMemorySize();
+        }
+    }
+    return bytes;
+}
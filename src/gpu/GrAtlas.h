@@ -25,9 +25,13 @@ class GrAtlas;
 // GrPlot is "full" (i.e. there is no room for the new subimage according to the GrRectanizer), the
 // GrAtlas can request a new GrPlot via GrAtlasMgr::addToAtlas().
 //
+// A GrAtlasMgr may be allowed more than one backing texture ("page"). Pages are only created
+// when none of the plots on the existing pages has room.
+//
 // If all GrPlots are allocated, the replacement strategy is up to the client. The drawToken is
-// available to ensure that all draw calls are finished for that particular GrPlot.
-// GrAtlasMgr::removeUnusedPlots() will free up any finished plots for a given GrAtlas.
+// available to ensure that all draw calls are finished for that particular GrPlot. Setting it
+// also marks the plot as the most recently used. GrAtlasMgr::getUnusedPlot() returns the least
+// recently used plot whose draws are finished.
 
 class GrPlot {
 public:
@@ -35,10 +39,15 @@ public:
 
     GrTexture* texture() const { return fTexture; }
 
+    // The image may be NULL to only reserve the space, e.g. when the GPU renders the contents.
     bool addSubImage(int width, int height, const void*, SkIPoint16*);
 
+    // Returns the space of a subimage added at 'loc' (relative to the backing texture) to the
+    // plot. Returns false if the plot can't free individual subimages, see GrAtlasMgr.
+    bool freeSubImage(int width, int height, const SkIPoint16& loc);
+
     GrDrawTarget::DrawToken drawToken() const { return fDrawToken; }
-    void setDrawToken(GrDrawTarget::DrawToken draw) { fDrawToken = draw; }
+    void setDrawToken(GrDrawTarget::DrawToken draw);
 
     void uploadToTexture();
 
@@ -47,8 +56,8 @@ public:
 private:
     GrPlot();
     ~GrPlot(); // does not try to delete the fNext field
-    void init(GrAtlasMgr* mgr, int offX, int offY, int width, int height, size_t bpp,
-              bool batchUploads);
+    void init(GrAtlasMgr* mgr, int page, int offX, int offY, int width, int height, size_t bpp,
+              bool batchUploads, bool freeSubImages);
 
     // for recycling
     GrDrawTarget::DrawToken fDrawToken;
@@ -57,6 +66,7 @@ private:
     GrTexture*              fTexture;
     GrRectanizer*           fRects;
     GrAtlasMgr*             fAtlasMgr;
+    int                     fPage;          // index of the backing texture
     SkIPoint16              fOffset;        // the offset of the plot in the backing texture
     size_t                  fBytesPerPixel;
     SkIRect                 fDirtyRect;
@@ -70,12 +80,18 @@ typedef SkTInternalLList<GrPlot> GrPlotList;
 
 class GrAtlasMgr {
 public:
+    // If freeSubImages is set the plots can free individual subimages, which suits clients that
+    // keep entries around for long and drop them one at a time. Otherwise the plots pack tighter
+    // but only get their space back by being reset as a whole.
     GrAtlasMgr(GrGpu*, GrPixelConfig, const SkISize& backingTextureSize,
-               int numPlotsX, int numPlotsY, bool batchUploads);
+               int numPlotsX, int numPlotsY, bool batchUploads, int maxPages = 1,
+               GrTextureFlags textureFlags = kDynamicUpdate_GrTextureFlagBit,
+               bool freeSubImages = false);
     ~GrAtlasMgr();
 
     // add subimage of width, height dimensions to atlas
     // returns the containing GrPlot and location relative to the backing texture
+    // the image may be NULL, see GrPlot::addSubImage()
     GrPlot* addToAtlas(GrAtlas*, int width, int height, const void*, SkIPoint16*);
 
     // remove reference to this plot
@@ -85,27 +101,39 @@ public:
     // this allows us to overwrite this plot without flushing
     GrPlot* getUnusedPlot();
 
-    GrTexture* getTexture() const {
-        return fTexture;
+    int maxPages() const { return fMaxPages; }
+
+    // returns NULL if the page has not been needed yet
+    GrTexture* getTexture(int page) const {
+        SkASSERT(page >= 0 && page < fMaxPages);
+        return fTextures[page];
     }
 
     void uploadPlotsToTexture();
 
+    // the bytes of the backing textures of the pages created so far
+    size_t gpuMemorySize() const;
+
 private:
     void moveToHead(GrPlot* plot);
+    bool createPage(int page);
 
     GrGpu*        fGpu;
     GrPixelConfig fPixelConfig;
-    GrTexture*    fTexture;
+    GrTextureFlags fTextureFlags;
+    GrTexture**   fTextures;
     SkISize       fBackingTextureSize;
     int           fNumPlotsX;
     int           fNumPlotsY;
+    int           fMaxPages;
     bool          fBatchUploads;
 
     // allocated array of GrPlots
     GrPlot*       fPlotArray;
     // LRU list of GrPlots
     GrPlotList    fPlotList;
+
+    friend class GrPlot;
 };
 
 class GrAtlas {
@@ -115,6 +143,9 @@ public:
 
     bool isEmpty() { return 0 == fPlots.count(); }
 
+    int numPlots() const { return fPlots.count(); }
+    GrPlot* plot(int index) { return fPlots[index]; }
+
 private:
     SkTDArray<GrPlot*> fPlots;
 
@@ -13,6 +13,7 @@
 #include "GrStrokeInfo.h"
 #include "GrTextStrike.h"
 #include "GrTextStrike_impl.h"
+#include "GrTracing.h"
 #include "SkColorPriv.h"
 #include "SkPath.h"
 #include "SkRTConf.h"
@@ -82,6 +83,7 @@ void GrBitmapTextContext::flushGlyphs() {
     if (NULL == fDrawTarget) {
         return;
     }
+    GR_CREATE_TRACE_MARKER("GrBitmapTextContext::flushGlyphs", fDrawTarget);
 
     GrDrawState* drawState = fDrawTarget->drawState();
     GrDrawState::AutoRestoreEffects are(drawState);
@@ -1,4 +1,3 @@
-
 /*
  * Copyright 2010 Google Inc.
  *
@@ -23,6 +22,11 @@
 // page size
 #define GrBufferAllocPool_MIN_BLOCK_SIZE ((size_t)1 << 12)
 
+// A streaming pool carves blocks of this many preallocated buffers' worth from its ring, and the
+// ring holds this many such blocks, so that we rarely have to wait on the GPU to reuse it.
+#define GrBufferAllocPool_RING_BLOCK_BUFFERS 4
+#define GrBufferAllocPool_RING_BLOCKS 4
+
 GrBufferAllocPool::GrBufferAllocPool(GrGpu* gpu,
                                      BufferType bufferType,
                                      bool frequentResetHint,
@@ -42,12 +46,26 @@ GrBufferAllocPool::GrBufferAllocPool(GrGpu* gpu,
 
     fBytesInUse = 0;
 
+    // Pools that see many makeSpace calls between resets stream through a single ring buffer
+    // when the GPU has fences, rather than mapping a separate preallocated buffer per block.
+    fRingBuffer = NULL;
+    fRingBlockSize = 0;
+    fRingAllocated = 0;
+    fRingReleased = 0;
+    if (!frequentResetHint && fGpu->caps()->streamingBufferSupport()) {
+        fRingBlockSize = fMinBlockSize * SkTMax(GrBufferAllocPool_RING_BLOCK_BUFFERS,
+                                                preallocBufferCnt);
+        fRingBuffer = this->createBuffer(fRingBlockSize * GrBufferAllocPool_RING_BLOCKS, true);
+    }
+
     fPreallocBuffersInUse = 0;
     fPreallocBufferStartIdx = 0;
-    for (int i = 0; i < preallocBufferCnt; ++i) {
-        GrGeometryBuffer* buffer = this->createBuffer(fMinBlockSize);
-        if (NULL != buffer) {
-            *fPreallocBuffers.append() = buffer;
+    if (NULL == fRingBuffer) {
+        for (int i = 0; i < preallocBufferCnt; ++i) {
+            GrGeometryBuffer* buffer = this->createBuffer(fMinBlockSize);
+            if (NULL != buffer) {
+                *fPreallocBuffers.append() = buffer;
+            }
         }
     }
 }
@@ -64,6 +82,16 @@ GrBufferAllocPool::~GrBufferAllocPool() {
         destroyBlock();
     }
     fPreallocBuffers.unrefAll();
+    if (NULL != fRingBuffer) {
+        // Once the ring has been released or abandoned the context may be gone, and its fences
+        // with it.
+        if (!fRingBuffer->wasDestroyed()) {
+            for (int i = 0; i < fRingFences.count(); ++i) {
+                fGpu->deleteFence(fRingFences[i].fFence);
+            }
+        }
+        fRingBuffer->unref();
+    }
     releaseGpuRef();
 }
 
@@ -78,9 +106,10 @@ void GrBufferAllocPool::reset() {
     VALIDATE();
     fBytesInUse = 0;
     if (fBlocks.count()) {
-        GrGeometryBuffer* buffer = fBlocks.back().fBuffer;
-        if (buffer->isMapped()) {
-            buffer->unmap();
+        BufferBlock& block = fBlocks.back();
+        if (block.fBuffer->isMapped()) {
+            this->trimRingBlock(&block);
+            block.fBuffer->unmap();
         }
     }
     // fPreallocBuffersInUse will be decremented down to zero in the while loop
@@ -94,6 +123,9 @@ void GrBufferAllocPool::reset() {
                                    preallocBuffersInUse) %
                                   fPreallocBuffers.count();
     }
+    if (NULL != fRingBuffer) {
+        this->fenceRing();
+    }
     // we may have created a large cpu mirror of a large VB. Reset the size
     // to match our pre-allocated VBs.
     fCpuData.reset(fMinBlockSize);
@@ -105,14 +137,7 @@ void GrBufferAllocPool::unmap() {
     VALIDATE();
 
     if (NULL != fBufferPtr) {
-        BufferBlock& block = fBlocks.back();
-        if (block.fBuffer->isMapped()) {
-            block.fBuffer->unmap();
-        } else {
-            size_t flushSize = block.fBuffer->gpuMemorySize() - block.fBytesFree;
-            this->flushCpuData(fBlocks.back().fBuffer, flushSize);
-        }
-        fBufferPtr = NULL;
+        this->closeBackBlock();
     }
     VALIDATE();
 }
@@ -121,9 +146,11 @@ void GrBufferAllocPool::unmap() {
 void GrBufferAllocPool::validate(bool unusedBlockAllowed) const {
     if (NULL != fBufferPtr) {
         SkASSERT(!fBlocks.empty());
-        if (fBlocks.back().fBuffer->isMapped()) {
-            GrGeometryBuffer* buf = fBlocks.back().fBuffer;
-            SkASSERT(buf->mapPtr() == fBufferPtr);
+        const BufferBlock& back = fBlocks.back();
+        if (back.fBuffer->isMapped()) {
+            GrGeometryBuffer* buf = back.fBuffer;
+            SkASSERT(reinterpret_cast<intptr_t>(buf->mapPtr()) + back.fOffset ==
+                     reinterpret_cast<intptr_t>(fBufferPtr));
         } else {
             SkASSERT(fCpuData.get() == fBufferPtr);
         }
@@ -132,12 +159,13 @@ void GrBufferAllocPool::validate(bool unusedBlockAllowed) const {
     }
     size_t bytesInUse = 0;
     for (int i = 0; i < fBlocks.count() - 1; ++i) {
-        SkASSERT(!fBlocks[i].fBuffer->isMapped());
+        SkASSERT(!fBlocks[i].fBuffer->isMapped() || fBlocks[i].fBuffer == fRingBuffer);
     }
     for (int i = 0; i < fBlocks.count(); ++i) {
-        size_t bytes = fBlocks[i].fBuffer->gpuMemorySize() - fBlocks[i].fBytesFree;
+        size_t bytes = fBlocks[i].fSize - fBlocks[i].fBytesFree;
         bytesInUse += bytes;
         SkASSERT(bytes || unusedBlockAllowed);
+        SkASSERT(fBlocks[i].fOffset + fBlocks[i].fSize <= fBlocks[i].fBuffer->gpuMemorySize());
     }
 
     SkASSERT(bytesInUse == fBytesInUse);
@@ -147,6 +175,18 @@ void GrBufferAllocPool::validate(bool unusedBlockAllowed) const {
     } else {
         SkASSERT((0 == fBytesInUse) == fBlocks.empty());
     }
+
+    if (NULL != fRingBuffer) {
+        SkASSERT(fRingReleased <= fRingAllocated);
+        SkASSERT(fRingAllocated - fRingReleased <= fRingBuffer->gpuMemorySize());
+        for (int i = 0; i < fRingFences.count(); ++i) {
+            SkASSERT(fRingFences[i].fRingAllocated > (i ? fRingFences[i - 1].fRingAllocated :
+                                                          fRingReleased));
+            SkASSERT(fRingFences[i].fRingAllocated <= fRingAllocated);
+        }
+    } else {
+        SkASSERT(fRingFences.isEmpty());
+    }
 }
 #endif
 
@@ -161,12 +201,12 @@ void* GrBufferAllocPool::makeSpace(size_t size,
 
     if (NULL != fBufferPtr) {
         BufferBlock& back = fBlocks.back();
-        size_t usedBytes = back.fBuffer->gpuMemorySize() - back.fBytesFree;
-        size_t pad = GrSizeAlignUpPad(usedBytes,
+        size_t usedBytes = back.fSize - back.fBytesFree;
+        size_t pad = GrSizeAlignUpPad(back.fOffset + usedBytes,
                                       alignment);
         if ((size + pad) <= back.fBytesFree) {
             usedBytes += pad;
-            *offset = usedBytes;
+            *offset = back.fOffset + usedBytes;
             *buffer = back.fBuffer;
             back.fBytesFree -= size + pad;
             fBytesInUse += size + pad;
@@ -183,13 +223,15 @@ void* GrBufferAllocPool::makeSpace(size_t size,
     // updateData() if the amount of data passed is less than the full buffer
     // size.
 
-    if (!createBlock(size)) {
+    if (!createBlock(size, alignment)) {
         return NULL;
     }
     SkASSERT(NULL != fBufferPtr);
 
-    *offset = 0;
     BufferBlock& back = fBlocks.back();
+    // blocks always start at a suitably aligned offset
+    SkASSERT(0 == back.fOffset % alignment);
+    *offset = back.fOffset;
     *buffer = back.fBuffer;
     back.fBytesFree -= size;
     fBytesInUse += size;
@@ -201,11 +243,17 @@ int GrBufferAllocPool::currentBufferItems(size_t itemSize) const {
     VALIDATE();
     if (NULL != fBufferPtr) {
         const BufferBlock& back = fBlocks.back();
-        size_t usedBytes = back.fBuffer->gpuMemorySize() - back.fBytesFree;
-        size_t pad = GrSizeAlignUpPad(usedBytes, itemSize);
+        size_t usedBytes = back.fSize - back.fBytesFree;
+        size_t pad = GrSizeAlignUpPad(back.fOffset + usedBytes, itemSize);
+        if (pad > back.fBytesFree) {
+            return 0;
+        }
         return static_cast<int>((back.fBytesFree - pad) / itemSize);
     } else if (fPreallocBuffersInUse < fPreallocBuffers.count()) {
         return static_cast<int>(fMinBlockSize / itemSize);
+    } else if (NULL != fRingBuffer) {
+        // a new block typically comes out of the ring without waiting
+        return static_cast<int>(fMinBlockSize / itemSize);
     }
     return 0;
 }
@@ -231,7 +279,7 @@ void GrBufferAllocPool::putBack(size_t bytes) {
         // caller shouldnt try to put back more than they've taken
         SkASSERT(!fBlocks.empty());
         BufferBlock& block = fBlocks.back();
-        size_t bytesUsed = block.fBuffer->gpuMemorySize() - block.fBytesFree;
+        size_t bytesUsed = block.fSize - block.fBytesFree;
         if (bytes >= bytesUsed) {
             bytes -= bytesUsed;
             fBytesInUse -= bytesUsed;
@@ -240,6 +288,10 @@ void GrBufferAllocPool::putBack(size_t bytes) {
             if (block.fBuffer->isMapped()) {
                 block.fBuffer->unmap();
             }
+            // give the block back to the ring if nothing was carved after it
+            if (block.fBuffer == fRingBuffer && block.fRingEnd == fRingAllocated) {
+                fRingAllocated = block.fRingStart;
+            }
             this->destroyBlock();
         } else {
             block.fBytesFree += bytes;
@@ -256,14 +308,41 @@ void GrBufferAllocPool::putBack(size_t bytes) {
     VALIDATE();
 }
 
-bool GrBufferAllocPool::createBlock(size_t requestSize) {
+bool GrBufferAllocPool::createBlock(size_t requestSize, size_t alignment) {
 
     size_t size = SkTMax(requestSize, fMinBlockSize);
     SkASSERT(size >= GrBufferAllocPool_MIN_BLOCK_SIZE);
 
     VALIDATE();
 
+    // The current block is finished before the new one is made, so that a ring block can give
+    // back its unused space first.
+    if (NULL != fBufferPtr) {
+        this->closeBackBlock();
+    }
+
+    SkASSERT(NULL == fBufferPtr);
+
     BufferBlock& block = fBlocks.push_back();
+    block.fOffset = 0;
+    block.fRingStart = 0;
+    block.fRingEnd = 0;
+
+    if (NULL != fRingBuffer && this->carveRingBlock(requestSize, alignment, &block)) {
+        fBufferPtr = block.fBuffer->map();
+        if (NULL != fBufferPtr) {
+            fBufferPtr = (void*)(reinterpret_cast<intptr_t>(fBufferPtr) + block.fOffset);
+            block.fBytesFree = block.fSize;
+            VALIDATE(true);
+            return true;
+        }
+        // The ring can't be written, so fall back to a regular block.
+        fRingAllocated = block.fRingStart;
+        block.fBuffer->unref();
+        block.fOffset = 0;
+        block.fRingStart = 0;
+        block.fRingEnd = 0;
+    }
 
     if (size == fMinBlockSize &&
         fPreallocBuffersInUse < fPreallocBuffers.count()) {
@@ -282,20 +361,8 @@ bool GrBufferAllocPool::createBlock(size_t requestSize) {
         }
     }
 
+    block.fSize = size;
     block.fBytesFree = size;
-    if (NULL != fBufferPtr) {
-        SkASSERT(fBlocks.count() > 1);
-        BufferBlock& prev = fBlocks.fromBack(1);
-        if (prev.fBuffer->isMapped()) {
-            prev.fBuffer->unmap();
-        } else {
-            flushCpuData(prev.fBuffer,
-                         prev.fBuffer->gpuMemorySize() - prev.fBytesFree);
-        }
-        fBufferPtr = NULL;
-    }
-
-    SkASSERT(NULL == fBufferPtr);
 
     // If the buffer is CPU-backed we map it because it is free to do so and saves a copy.
     // Otherwise when buffer mapping is supported:
@@ -324,6 +391,89 @@ bool GrBufferAllocPool::createBlock(size_t requestSize) {
     return true;
 }
 
+bool GrBufferAllocPool::carveRingBlock(size_t requestSize, size_t alignment,
+                                       BufferBlock* block) {
+    SkASSERT(NULL != fRingBuffer);
+    const uint64_t ringSize = fRingBuffer->gpuMemorySize();
+
+    // Prefer a large block, which will be trimmed to what is used, but settle for the request
+    // rather than wait on the GPU.
+    size_t size = SkTMax(requestSize, fRingBlockSize);
+    size_t skip = 0;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (size > ringSize) {
+            return false;
+        }
+        size_t head = static_cast<size_t>(fRingAllocated % ringSize);
+        skip = GrSizeAlignUpPad(head, alignment);
+        if (head + skip + size > ringSize) {
+            // doesn't fit before the end of the ring so start again at the beginning
+            skip = static_cast<size_t>(ringSize - head);
+        }
+        if (ringSize - (fRingAllocated - fRingReleased) >= skip + size ||
+            size == requestSize) {
+            break;
+        }
+        size = requestSize;
+    }
+
+    // Wait for the GPU to finish with data from earlier flushes until there is room.
+    while (ringSize - (fRingAllocated - fRingReleased) < skip + size) {
+        if (fRingFences.isEmpty() || !fGpu->waitFence(fRingFences[0].fFence)) {
+            return false;
+        }
+        fRingReleased = fRingFences[0].fRingAllocated;
+        fGpu->deleteFence(fRingFences[0].fFence);
+        fRingFences.remove(0);
+    }
+
+    block->fBuffer = fRingBuffer;
+    block->fBuffer->ref();
+    block->fRingStart = fRingAllocated;
+    fRingAllocated += skip + size;
+    block->fRingEnd = fRingAllocated;
+    block->fOffset = static_cast<size_t>((block->fRingEnd - size) % ringSize);
+    block->fSize = size;
+    return true;
+}
+
+void GrBufferAllocPool::trimRingBlock(BufferBlock* block) {
+    // Only the most recent block can give its unused space back.
+    if (block->fBuffer == fRingBuffer && block->fRingEnd == fRingAllocated) {
+        fRingAllocated -= block->fBytesFree;
+        block->fRingEnd = fRingAllocated;
+        block->fSize -= block->fBytesFree;
+        block->fBytesFree = 0;
+    }
+}
+
+void GrBufferAllocPool::fenceRing() {
+    SkASSERT(NULL != fRingBuffer);
+    uint64_t fenced = fRingFences.isEmpty() ? fRingReleased : fRingFences.top().fRingAllocated;
+    if (fRingAllocated == fenced) {
+        return;
+    }
+    // If we fail to get a fence the space is covered by the next one instead.
+    GrFence fence = fGpu->insertFence();
+    if (0 != fence) {
+        RingFence* ringFence = fRingFences.append();
+        ringFence->fFence = fence;
+        ringFence->fRingAllocated = fRingAllocated;
+    }
+}
+
+void GrBufferAllocPool::closeBackBlock() {
+    SkASSERT(NULL != fBufferPtr);
+    BufferBlock& block = fBlocks.back();
+    if (block.fBuffer->isMapped()) {
+        this->trimRingBlock(&block);
+        block.fBuffer->unmap();
+    } else {
+        this->flushCpuData(block.fBuffer, block.fSize - block.fBytesFree);
+    }
+    fBufferPtr = NULL;
+}
+
 void GrBufferAllocPool::destroyBlock() {
     SkASSERT(!fBlocks.empty());
 
@@ -364,12 +514,12 @@ void GrBufferAllocPool::flushCpuData(GrGeometryBuffer* buffer,
     VALIDATE(true);
 }
 
-GrGeometryBuffer* GrBufferAllocPool::createBuffer(size_t size) {
+GrGeometryBuffer* GrBufferAllocPool::createBuffer(size_t size, bool streaming) {
     if (kIndex_BufferType == fBufferType) {
-        return fGpu->createIndexBuffer(size, true);
+        return fGpu->createIndexBuffer(size, true, streaming);
     } else {
         SkASSERT(kVertex_BufferType == fBufferType);
-        return fGpu->createVertexBuffer(size, true);
+        return fGpu->createVertexBuffer(size, true, streaming);
     }
 }
 
@@ -8,6 +8,7 @@
 #ifndef GrBufferAllocPool_DEFINED
 #define GrBufferAllocPool_DEFINED
 
+#include "GrTypes.h"
 #include "SkTArray.h"
 #include "SkTDArray.h"
 #include "SkTypes.h"
@@ -26,6 +27,11 @@ class GrGpu;
  * At creation time a minimum per-buffer size can be specified. Additionally,
  * a number of buffers to preallocate can be specified. These will
  * be allocated at the min size and kept around until the pool is destroyed.
+ *
+ * When the GPU supports streaming buffers, a pool that isn't expecting
+ * frequent resets instead carves its blocks out of a single ring buffer that
+ * stays mapped. A fence is inserted at each reset, and the pool only waits
+ * on the GPU when the ring wraps around onto data it may still be reading.
  */
 class GrBufferAllocPool : SkNoncopyable {
 public:
@@ -140,7 +146,7 @@ protected:
      */
     int currentBufferItems(size_t itemSize) const;
 
-    GrGeometryBuffer* createBuffer(size_t size);
+    GrGeometryBuffer* createBuffer(size_t size, bool streaming = false);
 
 private:
 
@@ -151,9 +157,23 @@ private:
     struct BufferBlock {
         size_t              fBytesFree;
         GrGeometryBuffer*   fBuffer;
+        size_t              fOffset;        // start of the block in fBuffer
+        size_t              fSize;
+        // For blocks carved from the ring, the value of fRingAllocated before and after.
+        uint64_t            fRingStart;
+        uint64_t            fRingEnd;
+    };
+
+    struct RingFence {
+        GrFence             fFence;
+        uint64_t            fRingAllocated; // ring space the GPU is done with once signaled
     };
 
-    bool createBlock(size_t requestSize);
+    bool createBlock(size_t requestSize, size_t alignment);
+    bool carveRingBlock(size_t requestSize, size_t alignment, BufferBlock* block);
+    void trimRingBlock(BufferBlock* block);
+    void fenceRing();
+    void closeBackBlock();
     void destroyBlock();
     void flushCpuData(GrGeometryBuffer* buffer, size_t flushSize);
 #ifdef SK_DEBUG
@@ -176,6 +196,14 @@ private:
     int                             fPreallocBufferStartIdx;
     SkAutoMalloc                    fCpuData;
     void*                           fBufferPtr;
+
+    // Streaming through a ring buffer. The counters only ever increase, and
+    // include space skipped at the end of the ring when a block wraps around.
+    GrGeometryBuffer*               fRingBuffer;
+    size_t                          fRingBlockSize;
+    uint64_t                        fRingAllocated;
+    uint64_t                        fRingReleased;
+    SkTDArray<RingFence>            fRingFences;
 };
 
 class GrVertexBuffer;
@@ -1,4 +1,3 @@
-
 /*
  * Copyright 2012 Google Inc.
  *
@@ -7,15 +6,146 @@
  */
 
 #include "GrClipMaskCache.h"
+#include "GrRectanizer_maxrects.h"
 
 GrClipMaskCache::GrClipMaskCache()
     : fContext(NULL)
-    , fStack(sizeof(GrClipStackFrame)) {
-    // We need an initial frame to capture the clip state prior to
-    // any pushes
-    SkNEW_PLACEMENT(fStack.push_back(), GrClipStackFrame);
+    , fCount(0)
+    , fAtlasedCount(0) {
+}
+
+GrClipMaskCache::~GrClipMaskCache() {
+    this->releaseResources();
 }
 
-void GrClipMaskCache::push() {
-    SkNEW_PLACEMENT(fStack.push_back(), GrClipStackFrame);
+GrClipMaskCache::Entry* GrClipMaskCache::find(int32_t clipGenID, const SkIRect& bound) {
+    SkASSERT(clipGenID != SkClipStack::kWideOpenGenID);
+    SkASSERT(clipGenID != SkClipStack::kEmptyGenID);
+
+    EntryList::Iter iter;
+    Entry* entry = iter.init(fEntries, EntryList::Iter::kHead_IterStart);
+    for (; NULL != entry; entry = iter.next()) {
+        // We could reuse the mask if bound is a subset of the entry's bound. We'd have to
+        // communicate an offset to the caller.
+        if (entry->fClipGenID == clipGenID && entry->fBound == bound) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+GrTexture* GrClipMaskCache::findMask(int32_t clipGenID, const SkIRect& bound,
+                                     SkIPoint* maskOffset) {
+    Entry* entry = this->find(clipGenID, bound);
+    if (NULL == entry) {
+        return NULL;
+    }
+
+    fEntries.remove(entry);
+    fEntries.addToHead(entry);
+    *maskOffset = entry->fAtlasOffset;
+    return entry->texture(fAtlas.texture());
+}
+
+GrTexture* GrClipMaskCache::acquireMask(int32_t clipGenID,
+                                        const GrTextureDesc& desc,
+                                        const SkIRect& bound,
+                                        SkIPoint* maskOffset) {
+    SkASSERT(NULL != fContext);
+    SkASSERT(desc.fWidth == bound.width() && desc.fHeight == bound.height());
+
+    Entry* entry = this->find(clipGenID, bound);
+    if (NULL != entry) {
+        this->removeEntry(entry);
+    }
+    while (fCount >= kMaxEntries) {
+        this->removeEntry(fEntries.tail());
+    }
+
+    entry = SkNEW_ARGS(Entry, (clipGenID, bound));
+
+    bool atlasable = SkToBool(desc.fFlags & kRenderTarget_GrTextureFlagBit) &&
+                     kAlpha_8_GrPixelConfig == desc.fConfig &&
+                     desc.fWidth <= kMaxAtlasedMaskSize &&
+                     desc.fHeight <= kMaxAtlasedMaskSize;
+    if (!atlasable || !this->allocateInAtlas(entry)) {
+        entry->fMask.set(fContext, desc);
+        if (NULL == entry->fMask.texture()) {
+            SkDELETE(entry);
+            return NULL;
+        }
+    }
+
+    fEntries.addToHead(entry);
+    ++fCount;
+    *maskOffset = entry->fAtlasOffset;
+    return entry->texture(fAtlas.texture());
+}
+
+bool GrClipMaskCache::allocateInAtlas(Entry* entry) {
+    if (NULL == fAtlas.texture()) {
+        GrTextureDesc desc;
+        desc.fFlags = kRenderTarget_GrTextureFlagBit;
+        desc.fWidth = kAtlasSize;
+        desc.fHeight = kAtlasSize;
+        desc.fConfig = kAlpha_8_GrPixelConfig;
+
+        fAtlas.set(fContext, desc, GrContext::kExact_ScratchTexMatch);
+        if (NULL == fAtlas.texture()) {
+            return false;
+        }
+        fAtlasRects.reset(SkNEW_ARGS(GrRectanizerMaxRects, (kAtlasSize, kAtlasSize)));
+    }
+
+    SkIPoint16 loc;
+    int width = entry->fBound.width();
+    int height = entry->fBound.height();
+    while (!fAtlasRects->addRect(width, height, &loc)) {
+        // Make room by dropping the least recently used atlased mask.
+        EntryList::Iter iter;
+        Entry* victim = iter.init(fEntries, EntryList::Iter::kTail_IterStart);
+        while (NULL != victim && !victim->fAtlased) {
+            victim = iter.prev();
+        }
+        if (NULL == victim) {
+            return false;
+        }
+        this->removeEntry(victim);
+    }
+
+    entry->fAtlased = true;
+    entry->fAtlasOffset.set(loc.fX, loc.fY);
+    ++fAtlasedCount;
+    return true;
+}
+
+void GrClipMaskCache::removeMask(int32_t clipGenID, const SkIRect& bound) {
+    Entry* entry = this->find(clipGenID, bound);
+    if (NULL != entry) {
+        this->removeEntry(entry);
+    }
+}
+
+void GrClipMaskCache::removeEntry(Entry* entry) {
+    if (entry->fAtlased) {
+        SkASSERT(fAtlasedCount > 0);
+        --fAtlasedCount;
+        SkIPoint16 loc;
+        loc.set(entry->fAtlasOffset.fX, entry->fAtlasOffset.fY);
+        SkAssertResult(fAtlasRects->freeRect(loc, entry->fBound.width(),
+                                             entry->fBound.height()));
+    }
+    fEntries.remove(entry);
+    --fCount;
+    SkDELETE(entry);
+}
+
+void GrClipMaskCache::releaseResources() {
+    while (NULL != fEntries.head()) {
+        this->removeEntry(fEntries.head());
+    }
+    SkASSERT(0 == fCount && 0 == fAtlasedCount);
+
+    fAtlas.reset();
+    fAtlasRects.free();
 }
@@ -10,166 +10,56 @@
 
 #include "GrContext.h"
 #include "SkClipStack.h"
+#include "SkTInternalLList.h"
 #include "SkTypes.h"
 
+class GrRectanizer;
 class GrTexture;
 
 /**
  * The stencil buffer stores the last clip path - providing a single entry
- * "cache". This class provides similar functionality for AA clip paths
+ * "cache". This class provides similar functionality for AA clip paths, but
+ * remembers the last several masks so that draws which alternate between a
+ * few clips don't re-render their masks each time.
+ *
+ * Masks are keyed by the gen ID of the reduced clip's elements and the mask's
+ * bounds in clip space. Masks rendered on the GPU that are small enough share
+ * a single render target atlas. Larger masks and masks uploaded from software
+ * get a scratch texture of their own. When a new mask doesn't fit in the
+ * atlas, the least recently used atlased masks are dropped one at a time
+ * until it does. Masks are only ever read by draws the GrGpu has already
+ * issued, so the atlas can be overwritten right away.
  */
 class GrClipMaskCache : SkNoncopyable {
 public:
     GrClipMaskCache();
-
-    ~GrClipMaskCache() {
-
-        while (!fStack.empty()) {
-            GrClipStackFrame* temp = (GrClipStackFrame*) fStack.back();
-            temp->~GrClipStackFrame();
-            fStack.pop_back();
-        }
-    }
-
-    bool canReuse(int32_t clipGenID, const SkIRect& bounds) {
-
-        SkASSERT(clipGenID != SkClipStack::kWideOpenGenID);
-        SkASSERT(clipGenID != SkClipStack::kEmptyGenID);
-
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
-
-        // We could reuse the mask if bounds is a subset of last bounds. We'd have to communicate
-        // an offset to the caller.
-        if (back->fLastMask.texture() &&
-            back->fLastBound == bounds &&
-            back->fLastClipGenID == clipGenID) {
-            return true;
-        }
-
-        return false;
-    }
-
-    void reset() {
-        if (fStack.empty()) {
-//            SkASSERT(false);
-            return;
-        }
-
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
-
-        back->reset();
-    }
+    ~GrClipMaskCache();
 
     /**
-     * After a "push" the clip state is entirely open. Currently, the
-     * entire clip stack will be re-rendered into a new clip mask.
-     * TODO: can we take advantage of the nested nature of the clips to
-     * reduce the mask creation cost?
+     * Returns the texture holding the mask for the clip and stores the mask's
+     * top left corner in the texture in maskOffset. Returns NULL if the mask
+     * isn't cached. A found mask becomes the most recently used one.
      */
-    void push();
-
-    void pop() {
-        //SkASSERT(!fStack.empty());
-
-        if (!fStack.empty()) {
-            GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
-
-            back->~GrClipStackFrame();
-            fStack.pop_back();
-        }
-    }
-
-    int32_t getLastClipGenID() const {
-
-        if (fStack.empty()) {
-            return SkClipStack::kInvalidGenID;
-        }
-
-        return ((GrClipStackFrame*) fStack.back())->fLastClipGenID;
-    }
-
-    GrTexture* getLastMask() {
-
-        if (fStack.empty()) {
-            SkASSERT(false);
-            return NULL;
-        }
-
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
-
-        return back->fLastMask.texture();
-    }
-
-    const GrTexture* getLastMask() const {
-
-        if (fStack.empty()) {
-            SkASSERT(false);
-            return NULL;
-        }
-
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
-
-        return back->fLastMask.texture();
-    }
+    GrTexture* findMask(int32_t clipGenID, const SkIRect& bound, SkIPoint* maskOffset);
 
-    void acquireMask(int32_t clipGenID,
-                     const GrTextureDesc& desc,
-                     const SkIRect& bound) {
-
-        if (fStack.empty()) {
-            SkASSERT(false);
-            return;
-        }
-
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
-
-        back->acquireMask(fContext, clipGenID, desc, bound);
-    }
-
-    int getLastMaskWidth() const {
-
-        if (fStack.empty()) {
-            SkASSERT(false);
-            return -1;
-        }
-
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
-
-        if (NULL == back->fLastMask.texture()) {
-            return -1;
-        }
-
-        return back->fLastMask.texture()->width();
-    }
-
-    int getLastMaskHeight() const {
-
-        if (fStack.empty()) {
-            SkASSERT(false);
-            return -1;
-        }
-
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
-
-        if (NULL == back->fLastMask.texture()) {
-            return -1;
-        }
-
-        return back->fLastMask.texture()->height();
-    }
-
-    void getLastBound(SkIRect* bound) const {
-
-        if (fStack.empty()) {
-            SkASSERT(false);
-            bound->setEmpty();
-            return;
-        }
+    /**
+     * Makes room for a new mask the size of bound, evicting the least recently
+     * used masks as needed. desc describes the texture the mask would get if
+     * it is not atlased. The caller must fill in the bound-sized rect at
+     * maskOffset in the returned texture. Returns NULL if no texture could be
+     * had.
+     */
+    GrTexture* acquireMask(int32_t clipGenID,
+                           const GrTextureDesc& desc,
+                           const SkIRect& bound,
+                           SkIPoint* maskOffset);
 
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
+    /**
+     * Drops the mask for the clip, e.g. because rendering it failed.
+     */
+    void removeMask(int32_t clipGenID, const SkIRect& bound);
 
-        *bound = back->fLastBound;
-    }
+    int count() const { return fCount; }
 
     void setContext(GrContext* context) {
         fContext = context;
@@ -179,55 +69,51 @@ public:
         return fContext;
     }
 
-    void releaseResources() {
-
-        SkDeque::F2BIter iter(fStack);
-        for (GrClipStackFrame* frame = (GrClipStackFrame*) iter.next();
-                frame != NULL;
-                frame = (GrClipStackFrame*) iter.next()) {
-            frame->reset();
-        }
-    }
+    void releaseResources();
 
 private:
-    struct GrClipStackFrame {
+    struct Entry {
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
 
-        GrClipStackFrame() {
-            this->reset();
+        Entry(int32_t clipGenID, const SkIRect& bound)
+            : fClipGenID(clipGenID)
+            , fBound(bound)
+            , fAtlased(false) {
+            fAtlasOffset.set(0, 0);
         }
 
-        void acquireMask(GrContext* context,
-                         int32_t clipGenID,
-                         const GrTextureDesc& desc,
-                         const SkIRect& bound) {
-
-            fLastClipGenID = clipGenID;
-
-            fLastMask.set(context, desc);
-
-            fLastBound = bound;
+        GrTexture* texture(GrTexture* atlas) {
+            return fAtlased ? atlas : fMask.texture();
         }
 
-        void reset () {
-            fLastClipGenID = SkClipStack::kInvalidGenID;
+        int32_t                 fClipGenID;
+        // fBound stores the bounding box of the clip mask in clip-stack space. GrClipMaskManager
+        // uses it to position a rect and compute texture coords for the mask.
+        SkIRect                 fBound;
+        // Masks that are not atlased keep a scratch texture of their own.
+        GrAutoScratchTexture    fMask;
+        bool                    fAtlased;
+        SkIPoint                fAtlasOffset;   // only valid if fAtlased
+    };
 
-            GrTextureDesc desc;
+    typedef SkTInternalLList<Entry> EntryList;
 
-            fLastMask.set(NULL, desc);
-            fLastBound.setEmpty();
-        }
+    static const int kMaxEntries = 8;
+    static const int kAtlasSize = 1024;
+    // Larger masks would leave too little room for others.
+    static const int kMaxAtlasedMaskSize = kAtlasSize / 2;
 
-        int32_t                 fLastClipGenID;
-        // The mask's width & height values are used by GrClipMaskManager to correctly scale the
-        // texture coords for the geometry drawn with this mask.
-        GrAutoScratchTexture    fLastMask;
-        // fLastBound stores the bounding box of the clip mask in clip-stack space. This rect is
-        // used by GrClipMaskManager to position a rect and compute texture coords for the mask.
-        SkIRect                 fLastBound;
-    };
+    Entry* find(int32_t clipGenID, const SkIRect& bound);
+    void removeEntry(Entry* entry);
+    bool allocateInAtlas(Entry* entry);
+
+    GrContext*                  fContext;
+    EntryList                   fEntries;       // most recently used first
+    int                         fCount;
 
-    GrContext*   fContext;
-    SkDeque      fStack;
+    GrAutoScratchTexture        fAtlas;
+    SkAutoTDelete<GrRectanizer> fAtlasRects;
+    int                         fAtlasedCount;
 
     typedef SkNoncopyable INHERITED;
 };
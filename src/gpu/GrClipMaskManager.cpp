@@ -17,6 +17,7 @@
 #include "GrRenderTarget.h"
 #include "GrStencilBuffer.h"
 #include "GrSWMaskHelper.h"
+#include "GrTracing.h"
 #include "effects/GrTextureDomain.h"
 #include "effects/GrConvexPolyEffect.h"
 #include "effects/GrRRectEffect.h"
@@ -36,20 +37,24 @@ namespace {
 // stage matrix this also alters the vertex layout
 void setup_drawstate_aaclip(GrGpu* gpu,
                             GrTexture* result,
+                            const SkIPoint& maskOffset,
                             const SkIRect &devBound) {
     GrDrawState* drawState = gpu->drawState();
     SkASSERT(drawState);
 
     SkMatrix mat;
     // We want to use device coords to compute the texture coordinates. We set our matrix to be
-    // equal to the view matrix followed by an offset to the devBound, and then a scaling matrix to
-    // normalized coords. We apply this matrix to the vertex positions rather than local coords.
+    // equal to the view matrix followed by an offset from the devBound to the mask's position in
+    // the texture, and then a scaling matrix to normalized coords. We apply this matrix to the
+    // vertex positions rather than local coords.
     mat.setIDiv(result->width(), result->height());
-    mat.preTranslate(SkIntToScalar(-devBound.fLeft),
-                     SkIntToScalar(-devBound.fTop));
+    mat.preTranslate(SkIntToScalar(maskOffset.fX - devBound.fLeft),
+                     SkIntToScalar(maskOffset.fY - devBound.fTop));
     mat.preConcat(drawState->getViewMatrix());
 
-    SkIRect domainTexels = SkIRect::MakeWH(devBound.width(), devBound.height());
+    // The texture may hold other masks around this one.
+    SkIRect domainTexels = SkIRect::MakeXYWH(maskOffset.fX, maskOffset.fY,
+                                             devBound.width(), devBound.height());
     // This could be a long-lived effect that is cached with the alpha-mask.
     drawState->addCoverageEffect(
         GrTextureDomainEffect::Create(result,
@@ -284,6 +289,7 @@ bool GrClipMaskManager::setupClipping(const GrClipData* clipDataIn,
     // If MSAA is enabled we can do everything in the stencil buffer.
     if (0 == rt->numSamples() && requiresAA) {
         GrTexture* result = NULL;
+        SkIPoint maskOffset;
 
         if (this->useSWOnlyPath(elements)) {
             // The clip geometry is complex enough that it will be more efficient to create it
@@ -291,12 +297,14 @@ bool GrClipMaskManager::setupClipping(const GrClipData* clipDataIn,
             result = this->createSoftwareClipMask(genID,
                                                   initialState,
                                                   elements,
-                                                  clipSpaceIBounds);
+                                                  clipSpaceIBounds,
+                                                  &maskOffset);
         } else {
             result = this->createAlphaClipMask(genID,
                                                initialState,
                                                elements,
-                                               clipSpaceIBounds);
+                                               clipSpaceIBounds,
+                                               &maskOffset);
         }
 
         if (NULL != result) {
@@ -305,7 +313,7 @@ bool GrClipMaskManager::setupClipping(const GrClipData* clipDataIn,
             SkIRect rtSpaceMaskBounds = clipSpaceIBounds;
             rtSpaceMaskBounds.offset(-clipDataIn->fOrigin);
             are->set(fGpu->drawState());
-            setup_drawstate_aaclip(fGpu, result, rtSpaceMaskBounds);
+            setup_drawstate_aaclip(fGpu, result, maskOffset, rtSpaceMaskBounds);
             fGpu->disableScissor();
             this->setGpuStencil();
             return true;
@@ -315,11 +323,7 @@ bool GrClipMaskManager::setupClipping(const GrClipData* clipDataIn,
 #endif // GR_AA_CLIP
 
     // Either a hard (stencil buffer) clip was explicitly requested or an anti-aliased clip couldn't
-    // be created. In either case, free up the texture in the anti-aliased mask cache.
-    // TODO: this may require more investigation. Ganesh performs a lot of utility draws (e.g.,
-    // clears, InOrderDrawBuffer playbacks) that hit the stencil buffer path. These may be
-    // "incorrectly" clearing the AA cache.
-    fAACache.reset();
+    // be created. The masks in the anti-aliased mask cache are kept for later draws.
 
     // use the stencil clip if we can't represent the clip as a rectangle.
     SkIPoint clipSpaceToStencilSpaceOffset = -clipDataIn->fOrigin;
@@ -502,27 +506,20 @@ void GrClipMaskManager::getTemp(int width, int height, GrAutoScratchTexture* tem
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Return the texture currently in the cache if it exists. Otherwise, return NULL
+// Return the texture in the cache holding the mask if it exists. Otherwise, return NULL
 GrTexture* GrClipMaskManager::getCachedMaskTexture(int32_t elementsGenID,
-                                                   const SkIRect& clipSpaceIBounds) {
-    bool cached = fAACache.canReuse(elementsGenID, clipSpaceIBounds);
-    if (!cached) {
-        return NULL;
-    }
-
-    return fAACache.getLastMask();
+                                                   const SkIRect& clipSpaceIBounds,
+                                                   SkIPoint* maskOffset) {
+    return fAACache.findMask(elementsGenID, clipSpaceIBounds, maskOffset);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Allocate a texture in the texture cache. This function returns the texture
-// allocated (or NULL on error).
+// Allocate space for the mask in the mask cache. This function returns the texture
+// the mask goes in (or NULL on error).
 GrTexture* GrClipMaskManager::allocMaskTexture(int32_t elementsGenID,
                                                const SkIRect& clipSpaceIBounds,
-                                               bool willUpload) {
-    // Since we are setting up the cache we should free up the
-    // currently cached mask so it can be reused.
-    fAACache.reset();
-
+                                               bool willUpload,
+                                               SkIPoint* maskOffset) {
     GrTextureDesc desc;
     desc.fFlags = willUpload ? kNone_GrTextureFlags : kRenderTarget_GrTextureFlagBit;
     desc.fWidth = clipSpaceIBounds.width();
@@ -533,8 +530,7 @@ GrTexture* GrClipMaskManager::allocMaskTexture(int32_t elementsGenID,
         desc.fConfig = kAlpha_8_GrPixelConfig;
     }
 
-    fAACache.acquireMask(elementsGenID, desc, clipSpaceIBounds);
-    return fAACache.getLastMask();
+    return fAACache.acquireMask(elementsGenID, desc, clipSpaceIBounds, maskOffset);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -542,31 +538,35 @@ GrTexture* GrClipMaskManager::allocMaskTexture(int32_t elementsGenID,
 GrTexture* GrClipMaskManager::createAlphaClipMask(int32_t elementsGenID,
                                                   InitialState initialState,
                                                   const ElementList& elements,
-                                                  const SkIRect& clipSpaceIBounds) {
+                                                  const SkIRect& clipSpaceIBounds,
+                                                  SkIPoint* maskOffset) {
     SkASSERT(kNone_ClipMaskType == fCurrClipMaskType);
 
     // First, check for cached texture
-    GrTexture* result = this->getCachedMaskTexture(elementsGenID, clipSpaceIBounds);
+    GrTexture* result = this->getCachedMaskTexture(elementsGenID, clipSpaceIBounds, maskOffset);
     if (NULL != result) {
         fCurrClipMaskType = kAlpha_ClipMaskType;
         return result;
     }
+    GR_CREATE_TRACE_MARKER("GrClipMaskManager::createAlphaClipMask", fGpu);
 
     // There's no texture in the cache. Let's try to allocate it then.
-    result = this->allocMaskTexture(elementsGenID, clipSpaceIBounds, false);
+    result = this->allocMaskTexture(elementsGenID, clipSpaceIBounds, false, maskOffset);
     if (NULL == result) {
-        fAACache.reset();
         return NULL;
     }
 
-    // The top-left of the mask corresponds to the top-left corner of the bounds.
+    // The top-left of the mask corresponds to the top-left corner of the bounds, placed at the
+    // mask's offset in the texture.
     SkVector clipToMaskOffset = {
-        SkIntToScalar(-clipSpaceIBounds.fLeft),
-        SkIntToScalar(-clipSpaceIBounds.fTop)
+        SkIntToScalar(maskOffset->fX - clipSpaceIBounds.fLeft),
+        SkIntToScalar(maskOffset->fY - clipSpaceIBounds.fTop)
     };
-    // The texture may be larger than necessary, this rect represents the part of the texture
-    // we populate with a rasterization of the clip.
-    SkIRect maskSpaceIBounds = SkIRect::MakeWH(clipSpaceIBounds.width(), clipSpaceIBounds.height());
+    // The texture may be larger than necessary or shared with other masks, this rect represents
+    // the part of the texture we populate with a rasterization of the clip.
+    SkIRect maskSpaceIBounds = SkIRect::MakeXYWH(maskOffset->fX, maskOffset->fY,
+                                                 clipSpaceIBounds.width(),
+                                                 clipSpaceIBounds.height());
 
     // Set the matrix so that rendered clip elements are transformed to mask space from clip space.
     SkMatrix translate;
@@ -578,8 +578,8 @@ GrTexture* GrClipMaskManager::createAlphaClipMask(int32_t elementsGenID,
     // We're drawing a coverage mask and want coverage to be run through the blend function.
     drawState->enableState(GrDrawState::kCoverageDrawing_StateBit);
 
-    // The scratch texture that we are drawing into can be substantially larger than the mask. Only
-    // clear the part that we care about.
+    // The texture that we are drawing into can be substantially larger than the mask. Only clear
+    // the part that we care about.
     fGpu->clear(&maskSpaceIBounds,
                 kAllIn_InitialState == initialState ? 0xffffffff : 0x00000000,
                 true,
@@ -620,7 +620,7 @@ GrTexture* GrClipMaskManager::createAlphaClipMask(int32_t elementsGenID,
 
                 this->getTemp(maskSpaceIBounds.fRight, maskSpaceIBounds.fBottom, &temp);
                 if (NULL == temp.texture()) {
-                    fAACache.reset();
+                    fAACache.removeMask(elementsGenID, clipSpaceIBounds);
                     return NULL;
                 }
                 dst = temp.texture();
@@ -649,7 +649,7 @@ GrTexture* GrClipMaskManager::createAlphaClipMask(int32_t elementsGenID,
             drawState->setAlpha(invert ? 0x00 : 0xff);
 
             if (!this->drawElement(dst, element, pr)) {
-                fAACache.reset();
+                fAACache.removeMask(elementsGenID, clipSpaceIBounds);
                 return NULL;
             }
 
@@ -697,6 +697,7 @@ bool GrClipMaskManager::createStencilClipMask(int32_t elementsGenID,
                                               const SkIPoint& clipSpaceToStencilOffset) {
 
     SkASSERT(kNone_ClipMaskType == fCurrClipMaskType);
+    GR_CREATE_TRACE_MARKER("GrClipMaskManager::createStencilClipMask", fGpu);
 
     GrDrawState* drawState = fGpu->drawState();
     SkASSERT(drawState->isClipState());
@@ -1042,13 +1043,15 @@ void GrClipMaskManager::adjustStencilParams(GrStencilSettings* settings,
 GrTexture* GrClipMaskManager::createSoftwareClipMask(int32_t elementsGenID,
                                                      GrReducedClip::InitialState initialState,
                                                      const GrReducedClip::ElementList& elements,
-                                                     const SkIRect& clipSpaceIBounds) {
+                                                     const SkIRect& clipSpaceIBounds,
+                                                     SkIPoint* maskOffset) {
     SkASSERT(kNone_ClipMaskType == fCurrClipMaskType);
 
-    GrTexture* result = this->getCachedMaskTexture(elementsGenID, clipSpaceIBounds);
+    GrTexture* result = this->getCachedMaskTexture(elementsGenID, clipSpaceIBounds, maskOffset);
     if (NULL != result) {
         return result;
     }
+    GR_CREATE_TRACE_MARKER("GrClipMaskManager::createSoftwareClipMask", fGpu);
 
     // The mask texture may be larger than necessary. We round out the clip space bounds and pin
     // the top left corner of the resulting rect to the top left of the texture.
@@ -1100,12 +1103,12 @@ GrTexture* GrClipMaskManager::createSoftwareClipMask(int32_t elementsGenID,
         }
     }
 
-    // Allocate clip mask texture
-    result = this->allocMaskTexture(elementsGenID, clipSpaceIBounds, true);
+    // Allocate clip mask texture. Uploaded masks always get a texture of their own.
+    result = this->allocMaskTexture(elementsGenID, clipSpaceIBounds, true, maskOffset);
     if (NULL == result) {
-        fAACache.reset();
         return NULL;
     }
+    SkASSERT(0 == maskOffset->fX && 0 == maskOffset->fY);
     helper.toTexture(result);
 
     fCurrClipMaskType = kAlpha_ClipMaskType;
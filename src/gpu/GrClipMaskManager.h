@@ -103,7 +103,7 @@ private:
         kAlpha_ClipMaskType,
     } fCurrClipMaskType;
 
-    GrClipMaskCache fAACache;       // cache for the AA path
+    GrClipMaskCache fAACache;       // cache of recent masks for the AA path
 
     // Attempts to install a series of coverage effects to implement the clip. Return indicates
     // whether the element list was successfully converted to effects.
@@ -119,27 +119,33 @@ private:
                                const SkIRect& clipSpaceIBounds,
                                const SkIPoint& clipSpaceToStencilOffset);
     // Creates an alpha mask of the clip. The mask is a rasterization of elements through the
-    // rect specified by clipSpaceIBounds.
+    // rect specified by clipSpaceIBounds. The mask's top left corner in the returned texture is
+    // stored in maskOffset.
     GrTexture* createAlphaClipMask(int32_t elementsGenID,
                                    GrReducedClip::InitialState initialState,
                                    const GrReducedClip::ElementList& elements,
-                                   const SkIRect& clipSpaceIBounds);
+                                   const SkIRect& clipSpaceIBounds,
+                                   SkIPoint* maskOffset);
     // Similar to createAlphaClipMask but it rasterizes in SW and uploads to the result texture.
     GrTexture* createSoftwareClipMask(int32_t elementsGenID,
                                       GrReducedClip::InitialState initialState,
                                       const GrReducedClip::ElementList& elements,
-                                      const SkIRect& clipSpaceIBounds);
+                                      const SkIRect& clipSpaceIBounds,
+                                      SkIPoint* maskOffset);
 
-    // Returns the cached mask texture if it matches the elementsGenID and the clipSpaceIBounds.
-    // Returns NULL if not found.
-    GrTexture* getCachedMaskTexture(int32_t elementsGenID, const SkIRect& clipSpaceIBounds);
+    // Returns the texture holding the cached mask that matches the elementsGenID and the
+    // clipSpaceIBounds, and the mask's offset in it. Returns NULL if not found.
+    GrTexture* getCachedMaskTexture(int32_t elementsGenID,
+                                    const SkIRect& clipSpaceIBounds,
+                                    SkIPoint* maskOffset);
 
 
     // Handles allocation (if needed) of a clip alpha-mask texture for both the sw-upload
-    // or gpu-rendered cases.
+    // or gpu-rendered cases. GPU-rendered masks may be placed in the cache's atlas.
     GrTexture* allocMaskTexture(int32_t elementsGenID,
                                 const SkIRect& clipSpaceIBounds,
-                                bool willUpload);
+                                bool willUpload,
+                                SkIPoint* maskOffset);
 
     bool useSWOnlyPath(const GrReducedClip::ElementList& elements);
 
@@ -23,6 +23,7 @@
 #include "GrOvalRenderer.h"
 #include "GrPathRenderer.h"
 #include "GrPathUtils.h"
+#include "GrPixelReadback.h"
 #include "GrResourceCache.h"
 #include "GrSoftwarePathRenderer.h"
 #include "GrStencilBuffer.h"
@@ -30,6 +31,7 @@
 #include "GrTextStrike.h"
 #include "GrTracing.h"
 #include "SkDashPathPriv.h"
+#include "SkMemoryDump.h"
 #include "SkGr.h"
 #include "SkRTConf.h"
 #include "SkRRect.h"
@@ -81,9 +83,11 @@ private:
     GrContext* fContext;
 };
 
-GrContext* GrContext::Create(GrBackend backend, GrBackendContext backendContext) {
+GrContext* GrContext::Create(GrBackend backend,
+                             GrBackendContext backendContext,
+                             GrContextShareGroup* shareGroup) {
     GrContext* context = SkNEW(GrContext);
-    if (context->init(backend, backendContext)) {
+    if (context->init(backend, backendContext, shareGroup)) {
         return context;
     } else {
         context->unref();
@@ -108,15 +112,20 @@ GrContext::GrContext() {
     fViewMatrix.reset();
     fMaxTextureSizeOverride = 1 << 20;
     fGpuTracingEnabled = false;
+    fGpuTimingEnabled = false;
+    fLastReadToken = 0;
 }
 
-bool GrContext::init(GrBackend backend, GrBackendContext backendContext) {
+bool GrContext::init(GrBackend backend,
+                     GrBackendContext backendContext,
+                     GrContextShareGroup* shareGroup) {
     SkASSERT(NULL == fGpu);
 
     fGpu = GrGpu::Create(backend, backendContext, this);
     if (NULL == fGpu) {
         return false;
     }
+    fGpu->setShareGroup(shareGroup);
 
     fDrawState = SkNEW(GrDrawState);
     fGpu->setDrawState(fDrawState);
@@ -152,6 +161,10 @@ GrContext::~GrContext() {
         (*fCleanUpData[i].fFunc)(this, fCleanUpData[i].fInfo);
     }
 
+    for (int i = 0; i < fPendingReads.count(); ++i) {
+        this->deletePendingRead(fPendingReads[i]);
+    }
+
     // Since the gpu can hold scratch textures, give it a chance to let go
     // of them before freeing the texture cache
     fGpu->purgeResources();
@@ -226,6 +239,16 @@ void GrContext::freeGpuResources() {
     SkSafeSetNull(fSoftwarePathRenderer);
 }
 
+void GrContext::performDeferredCleanup() {
+    fResourceCache->performDeferredCleanup();
+}
+
+void GrContext::purgeUnlockedResources(size_t maxResourceBytes) {
+    // Pending draws hold on to their resources.
+    this->flush();
+    fResourceCache->purgeToBytes(maxResourceBytes);
+}
+
 void GrContext::getResourceCacheUsage(int* resourceCount, size_t* resourceBytes) const {
   if (NULL != resourceCount) {
     *resourceCount = fResourceCache->getCachedResourceCount();
@@ -235,6 +258,28 @@ void GrContext::getResourceCacheUsage(int* resourceCount, size_t* resourceBytes)
   }
 }
 
+void GrContext::dumpMemoryStatistics(SkMemoryDump* dump) const {
+    dump->dumpCache("skia/gpu/resource_cache", fResourceCache->getCachedResourceBytes(),
+                    fResourceCache->getPurgeableResourceBytes());
+    // The atlases are only freed along with everything else, by freeGpuResources().
+    dump->dumpCache("skia/gpu/font_cache", fFontCache->gpuMemorySize(), 0);
+    dump->dumpCache("skia/gpu/layer_cache", fLayerCache->gpuMemorySize(), 0);
+}
+
+void GrContext::getResourceCacheCounters(SkCacheCounters* counters) const {
+    *counters = fResourceCache->counters();
+}
+
+void GrContext::getScratchTextureCounters(SkCacheCounters* counters) const {
+    *counters = fScratchCounters;
+    counters->fEvictions = fResourceCache->scratchEvictions();
+}
+
+void GrContext::getProgramCacheCounters(SkCacheCounters* counters) const {
+    *counters = SkCacheCounters();
+    fGpu->getProgramCacheCounters(counters);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 GrTexture* GrContext::findAndRefTexture(const GrTextureDesc& desc,
@@ -242,7 +287,10 @@ GrTexture* GrContext::findAndRefTexture(const GrTextureDesc& desc,
                                         const GrTextureParams* params) {
     GrResourceKey resourceKey = GrTextureImpl::ComputeKey(fGpu, params, desc, cacheID);
     GrCacheable* resource = fResourceCache->find(resourceKey);
-    SkSafeRef(resource);
+    if (NULL == resource) {
+        return this->refSharedTexture(resourceKey);
+    }
+    resource->ref();
     return static_cast<GrTexture*>(resource);
 }
 
@@ -250,7 +298,64 @@ bool GrContext::isTextureInCache(const GrTextureDesc& desc,
                                  const GrCacheID& cacheID,
                                  const GrTextureParams* params) const {
     GrResourceKey resourceKey = GrTextureImpl::ComputeKey(fGpu, params, desc, cacheID);
-    return fResourceCache->hasKey(resourceKey);
+    if (fResourceCache->hasKey(resourceKey)) {
+        return true;
+    }
+    GrContextShareGroup* shareGroup = fGpu->getShareGroup();
+    return NULL != shareGroup && shareGroup->hasTexture(resourceKey);
+}
+
+GrTexture* GrContext::refSharedTexture(const GrResourceKey& resourceKey) {
+    GrContextShareGroup* shareGroup = fGpu->getShareGroup();
+    GrBackendTextureDesc backendDesc;
+    GrFence fence;
+    if (NULL == shareGroup || !shareGroup->refTexture(resourceKey, &backendDesc, &fence)) {
+        return NULL;
+    }
+
+    // The upload was submitted by another context, wait for it to land before sampling.
+    if (0 != fence) {
+        fGpu->waitFence(fence);
+    }
+
+    GrTexture* texture = fGpu->wrapBackendTexture(backendDesc);
+    // The texture was created by a context with the same backend, so it can always be wrapped.
+    SkASSERT(NULL != texture);
+    if (NULL == texture) {
+        GrFence lastFence;
+        SkAssertResult(!shareGroup->unrefTexture(backendDesc.fTextureHandle, &lastFence));
+        return NULL;
+    }
+    texture->impl()->setFlag((GrTextureFlags) GrTextureImpl::kSharedContent_FlagBit);
+
+    fResourceCache->purgeAsNeeded(1, texture->gpuMemorySize());
+    fResourceCache->addResource(resourceKey, texture);
+    return texture;
+}
+
+void GrContext::shareTexture(const GrResourceKey& resourceKey, GrTexture* texture) {
+    GrContextShareGroup* shareGroup = fGpu->getShareGroup();
+    // Render targets are left out, their framebuffer objects can't be shared.
+    if (NULL == shareGroup || NULL != texture->asRenderTarget()) {
+        return;
+    }
+
+    GrBackendTextureDesc backendDesc;
+    backendDesc.fFlags = kNone_GrBackendTextureFlag;
+    backendDesc.fOrigin = texture->origin();
+    backendDesc.fWidth = texture->width();
+    backendDesc.fHeight = texture->height();
+    backendDesc.fConfig = texture->config();
+    backendDesc.fSampleCnt = 0;
+    backendDesc.fTextureHandle = texture->getTextureHandle();
+
+    GrFence fence = fGpu->flushForSharing();
+    if (shareGroup->addTexture(resourceKey, backendDesc, fence)) {
+        texture->impl()->setFlag((GrTextureFlags) GrTextureImpl::kSharedContent_FlagBit);
+    } else if (0 != fence) {
+        // Another context published the same content first. Keep ours private.
+        fGpu->deleteFence(fence);
+    }
 }
 
 void GrContext::addStencilBuffer(GrStencilBuffer* sb) {
@@ -406,6 +511,7 @@ GrTexture* GrContext::createTexture(const GrTextureParams* params,
         // necessary space before adding it.
         fResourceCache->purgeAsNeeded(1, texture->gpuMemorySize());
         fResourceCache->addResource(resourceKey, texture);
+        this->shareTexture(resourceKey, texture);
 
         if (NULL != cacheKey) {
             *cacheKey = resourceKey;
@@ -430,6 +536,24 @@ static GrTexture* create_scratch_texture(GrGpu* gpu,
     return texture;
 }
 
+// Approximate scratch textures are binned by size so that requests of similar sizes share
+// textures. Where NPOT textures tile, each power of two is split at its midpoint, so that a
+// texture is at most 1.5x the size asked for in each dimension rather than 2x.
+static int scratch_size_class(int size, bool npot) {
+    static const int kMinSize = 16;
+    if (size <= kMinSize) {
+        return kMinSize;
+    }
+    int pow2 = GrNextPow2(size);
+    if (npot) {
+        int mid = pow2 / 2 + pow2 / 4;
+        if (size <= mid) {
+            return mid;
+        }
+    }
+    return pow2;
+}
+
 GrTexture* GrContext::lockAndRefScratchTexture(const GrTextureDesc& inDesc, ScratchTexMatch match) {
 
     SkASSERT((inDesc.fFlags & kRenderTarget_GrTextureFlagBit) ||
@@ -443,54 +567,40 @@ GrTexture* GrContext::lockAndRefScratchTexture(const GrTextureDesc& inDesc, Scra
     if (!fGpu->caps()->reuseScratchTextures() &&
         !(inDesc.fFlags & kRenderTarget_GrTextureFlagBit)) {
         // If we're never recycling this texture we can always make it the right size
+        fScratchCounters.fMisses += 1;
         return create_scratch_texture(fGpu, fResourceCache, inDesc);
     }
 
     GrTextureDesc desc = inDesc;
 
     if (kApprox_ScratchTexMatch == match) {
-        // bin by pow2 with a reasonable min
-        static const int MIN_SIZE = 16;
-        desc.fWidth  = SkTMax(MIN_SIZE, GrNextPow2(desc.fWidth));
-        desc.fHeight = SkTMax(MIN_SIZE, GrNextPow2(desc.fHeight));
-    }
-
-    GrCacheable* resource = NULL;
-    int origWidth = desc.fWidth;
-    int origHeight = desc.fHeight;
-
-    do {
-        GrResourceKey key = GrTextureImpl::ComputeScratchKey(desc);
-        // Ensure we have exclusive access to the texture so future 'find' calls don't return it
-        resource = fResourceCache->find(key, GrResourceCache::kHide_OwnershipFlag);
-        if (NULL != resource) {
-            resource->ref();
-            break;
-        }
-        if (kExact_ScratchTexMatch == match) {
-            break;
-        }
-        // We had a cache miss and we are in approx mode, relax the fit of the flags.
-
-        // We no longer try to reuse textures that were previously used as render targets in
-        // situations where no RT is needed; doing otherwise can confuse the video driver and
-        // cause significant performance problems in some cases.
-        if (desc.fFlags & kNoStencil_GrTextureFlagBit) {
-            desc.fFlags = desc.fFlags & ~kNoStencil_GrTextureFlagBit;
-        } else {
-            break;
-        }
-
-    } while (true);
+        const bool npot = fGpu->caps()->npotTextureTileSupport();
+        desc.fWidth  = scratch_size_class(desc.fWidth, npot);
+        desc.fHeight = scratch_size_class(desc.fHeight, npot);
+    }
 
-    if (NULL == resource) {
-        desc.fFlags = inDesc.fFlags;
-        desc.fWidth = origWidth;
-        desc.fHeight = origHeight;
-        resource = create_scratch_texture(fGpu, fResourceCache, desc);
+    // Ensure we have exclusive access to the texture so future 'find' calls don't return it
+    GrCacheable* resource = fResourceCache->find(GrTextureImpl::ComputeScratchKey(desc),
+                                                 GrResourceCache::kHide_OwnershipFlag);
+    // On a miss in approx mode, relax the fit of the flags: a render target without a stencil
+    // can make do with one that has a stencil. We no longer try to reuse textures that were
+    // previously used as render targets in situations where no RT is needed; doing otherwise can
+    // confuse the video driver and cause significant performance problems in some cases.
+    if (NULL == resource && kApprox_ScratchTexMatch == match &&
+        (desc.fFlags & kNoStencil_GrTextureFlagBit)) {
+        GrTextureDesc stencilDesc = desc;
+        stencilDesc.fFlags = stencilDesc.fFlags & ~kNoStencil_GrTextureFlagBit;
+        resource = fResourceCache->find(GrTextureImpl::ComputeScratchKey(stencilDesc),
+                                        GrResourceCache::kHide_OwnershipFlag);
     }
 
-    return static_cast<GrTexture*>(resource);
+    if (NULL != resource) {
+        resource->ref();
+        fScratchCounters.fHits += 1;
+        return static_cast<GrTexture*>(resource);
+    }
+    fScratchCounters.fMisses += 1;
+    return create_scratch_texture(fGpu, fResourceCache, desc);
 }
 
 void GrContext::addExistingTextureToCache(GrTexture* texture) {
@@ -1312,6 +1422,29 @@ void GrContext::flush(int flagsBitfield) {
     fFlushToReduceCacheSize = false;
 }
 
+GrFence GrContext::flushWithFence() {
+    return fGpu->flushForSharing();
+}
+
+bool GrContext::waitFence(GrFence fence) {
+    SkASSERT(0 != fence);
+    return fGpu->waitFence(fence);
+}
+
+void GrContext::deleteFence(GrFence fence) {
+    SkASSERT(0 != fence);
+    fGpu->deleteFence(fence);
+}
+
+void GrContext::endGpuTimingFrame() {
+    this->flush();
+    fGpu->endTimingFrame();
+}
+
+bool GrContext::getGpuFrameTimes(SkTArray<GpuScopeTime>* times) const {
+    return fGpu->getTimingFrame(times);
+}
+
 bool GrContext::writeTexturePixels(GrTexture* texture,
                                    int left, int top, int width, int height,
                                    GrPixelConfig config, const void* buffer, size_t rowBytes,
@@ -1386,6 +1519,29 @@ static SkColorType toggle_colortype32(SkColorType ct) {
     }
 }
 
+// Swaps R and B and/or unpremultiplies pixels read back in place, where the GPU didn't.
+static bool convert_read_pixels(GrPixelConfig dstConfig, bool swapRAndB, bool unpremul,
+                                void* buffer, size_t rowBytes, int width, int height) {
+    if (!unpremul && !swapRAndB) {
+        return true;
+    }
+    SkDstPixelInfo dstPI;
+    if (!GrPixelConfig2ColorType(dstConfig, &dstPI.fColorType)) {
+        return false;
+    }
+    dstPI.fAlphaType = kUnpremul_SkAlphaType;
+    dstPI.fPixels = buffer;
+    dstPI.fRowBytes = rowBytes;
+
+    SkSrcPixelInfo srcPI;
+    srcPI.fColorType = swapRAndB ? toggle_colortype32(dstPI.fColorType) : dstPI.fColorType;
+    srcPI.fAlphaType = kPremul_SkAlphaType;
+    srcPI.fPixels = buffer;
+    srcPI.fRowBytes = rowBytes;
+
+    return srcPI.convertPixelsTo(&dstPI, width, height);
+}
+
 bool GrContext::readRenderTargetPixels(GrRenderTarget* target,
                                        int left, int top, int width, int height,
                                        GrPixelConfig dstConfig, void* buffer, size_t rowBytes,
@@ -1431,77 +1587,16 @@ bool GrContext::readRenderTargetPixels(GrRenderTarget* target,
     }
 
     // If the src is a texture and we would have to do conversions after read pixels, we instead
-    // do the conversions by drawing the src to a scratch texture. If we handle any of the
-    // conversions in the draw we set the corresponding bool to false so that we don't reapply it
-    // on the read back pixels.
-    GrTexture* src = target->asTexture();
+    // do the conversions by drawing the src to a scratch texture.
     GrAutoScratchTexture ast;
-    if (NULL != src && (swapRAndB || unpremul || flipY)) {
-        // Make the scratch a render target because we don't have a robust readTexturePixels as of
-        // yet. It calls this function.
-        GrTextureDesc desc;
-        desc.fFlags = kRenderTarget_GrTextureFlagBit;
-        desc.fWidth = width;
-        desc.fHeight = height;
-        desc.fConfig = readConfig;
-        desc.fOrigin = kTopLeft_GrSurfaceOrigin;
-
-        // When a full read back is faster than a partial we could always make the scratch exactly
-        // match the passed rect. However, if we see many different size rectangles we will trash
-        // our texture cache and pay the cost of creating and destroying many textures. So, we only
-        // request an exact match when the caller is reading an entire RT.
-        ScratchTexMatch match = kApprox_ScratchTexMatch;
-        if (0 == left &&
-            0 == top &&
-            target->width() == width &&
-            target->height() == height &&
-            fGpu->fullReadPixelsIsFasterThanPartial()) {
-            match = kExact_ScratchTexMatch;
-        }
-        ast.set(this, desc, match);
-        GrTexture* texture = ast.texture();
-        if (texture) {
-            // compute a matrix to perform the draw
-            SkMatrix textureMatrix;
-            textureMatrix.setTranslate(SK_Scalar1 *left, SK_Scalar1 *top);
-            textureMatrix.postIDiv(src->width(), src->height());
-
-            SkAutoTUnref<const GrEffectRef> effect;
-            if (unpremul) {
-                effect.reset(this->createPMToUPMEffect(src, swapRAndB, textureMatrix));
-                if (NULL != effect) {
-                    unpremul = false; // we no longer need to do this on CPU after the read back.
-                }
-            }
-            // If we failed to create a PM->UPM effect and have no other conversions to perform then
-            // there is no longer any point to using the scratch.
-            if (NULL != effect || flipY || swapRAndB) {
-                if (!effect) {
-                    effect.reset(GrConfigConversionEffect::Create(
-                                                    src,
-                                                    swapRAndB,
-                                                    GrConfigConversionEffect::kNone_PMConversion,
-                                                    textureMatrix));
-                }
-                swapRAndB = false; // we will handle the swap in the draw.
-
-                // We protect the existing geometry here since it may not be
-                // clear to the caller that a draw operation (i.e., drawSimpleRect)
-                // can be invoked in this method
-                GrDrawTarget::AutoGeometryAndStatePush agasp(fGpu, GrDrawTarget::kReset_ASRInit);
-                GrDrawState* drawState = fGpu->drawState();
-                SkASSERT(effect);
-                drawState->addColorEffect(effect);
-
-                drawState->setRenderTarget(texture->asRenderTarget());
-                SkRect rect = SkRect::MakeWH(SkIntToScalar(width), SkIntToScalar(height));
-                fGpu->drawSimpleRect(rect, NULL);
-                // we want to read back from the scratch's origin
-                left = 0;
-                top = 0;
-                target = texture->asRenderTarget();
-            }
-        }
+    GrRenderTarget* scratch = this->drawForReadPixels(target, left, top, width, height,
+                                                      readConfig, flipY,
+                                                      &swapRAndB, &unpremul, &ast);
+    if (NULL != scratch) {
+        // we want to read back from the scratch's origin
+        left = 0;
+        top = 0;
+        target = scratch;
     }
     if (!fGpu->readPixels(target,
                           left, top, width, height,
@@ -1509,24 +1604,212 @@ bool GrContext::readRenderTargetPixels(GrRenderTarget* target,
         return false;
     }
     // Perform any conversions we weren't able to perform using a scratch texture.
-    if (unpremul || swapRAndB) {
-        SkDstPixelInfo dstPI;
-        if (!GrPixelConfig2ColorType(dstConfig, &dstPI.fColorType)) {
-            return false;
+    return convert_read_pixels(dstConfig, swapRAndB, unpremul, buffer, rowBytes, width, height);
+}
+
+GrRenderTarget* GrContext::drawForReadPixels(GrRenderTarget* target,
+                                             int left, int top, int width, int height,
+                                             GrPixelConfig readConfig, bool flipY,
+                                             bool* swapRAndB, bool* unpremul,
+                                             GrAutoScratchTexture* ast) {
+    GrTexture* src = target->asTexture();
+    if (NULL == src || !(*swapRAndB || *unpremul || flipY)) {
+        return NULL;
+    }
+
+    // Make the scratch a render target because we don't have a robust readTexturePixels as of
+    // yet. It calls readRenderTargetPixels.
+    GrTextureDesc desc;
+    desc.fFlags = kRenderTarget_GrTextureFlagBit;
+    desc.fWidth = width;
+    desc.fHeight = height;
+    desc.fConfig = readConfig;
+    desc.fOrigin = kTopLeft_GrSurfaceOrigin;
+
+    // When a full read back is faster than a partial we could always make the scratch exactly
+    // match the passed rect. However, if we see many different size rectangles we will trash
+    // our texture cache and pay the cost of creating and destroying many textures. So, we only
+    // request an exact match when the caller is reading an entire RT.
+    ScratchTexMatch match = kApprox_ScratchTexMatch;
+    if (0 == left &&
+        0 == top &&
+        target->width() == width &&
+        target->height() == height &&
+        fGpu->fullReadPixelsIsFasterThanPartial()) {
+        match = kExact_ScratchTexMatch;
+    }
+    ast->set(this, desc, match);
+    GrTexture* texture = ast->texture();
+    if (NULL == texture) {
+        return NULL;
+    }
+
+    // compute a matrix to perform the draw
+    SkMatrix textureMatrix;
+    textureMatrix.setTranslate(SK_Scalar1 *left, SK_Scalar1 *top);
+    textureMatrix.postIDiv(src->width(), src->height());
+
+    // If we handle any of the conversions in the draw we set the corresponding bool to false so
+    // that we don't reapply it on the read back pixels.
+    SkAutoTUnref<const GrEffectRef> effect;
+    if (*unpremul) {
+        effect.reset(this->createPMToUPMEffect(src, *swapRAndB, textureMatrix));
+        if (NULL != effect) {
+            *unpremul = false; // we no longer need to do this on CPU after the read back.
         }
-        dstPI.fAlphaType = kUnpremul_SkAlphaType;
-        dstPI.fPixels = buffer;
-        dstPI.fRowBytes = rowBytes;
+    }
+    // If we failed to create a PM->UPM effect and have no other conversions to perform then
+    // there is no longer any point to using the scratch.
+    if (NULL == effect && !flipY && !*swapRAndB) {
+        return NULL;
+    }
+    if (!effect) {
+        effect.reset(GrConfigConversionEffect::Create(src,
+                                                      *swapRAndB,
+                                                      GrConfigConversionEffect::kNone_PMConversion,
+                                                      textureMatrix));
+    }
+    *swapRAndB = false; // we will handle the swap in the draw.
 
-        SkSrcPixelInfo srcPI;
-        srcPI.fColorType = swapRAndB ? toggle_colortype32(dstPI.fColorType) : dstPI.fColorType;
-        srcPI.fAlphaType = kPremul_SkAlphaType;
-        srcPI.fPixels = buffer;
-        srcPI.fRowBytes = rowBytes;
+    // We protect the existing geometry here since it may not be
+    // clear to the caller that a draw operation (i.e., drawSimpleRect)
+    // can be invoked in this method
+    GrDrawTarget::AutoGeometryAndStatePush agasp(fGpu, GrDrawTarget::kReset_ASRInit);
+    GrDrawState* drawState = fGpu->drawState();
+    SkASSERT(effect);
+    drawState->addColorEffect(effect);
+
+    drawState->setRenderTarget(texture->asRenderTarget());
+    SkRect rect = SkRect::MakeWH(SkIntToScalar(width), SkIntToScalar(height));
+    fGpu->drawSimpleRect(rect, NULL);
+    return texture->asRenderTarget();
+}
+
+uint32_t GrContext::beginReadRenderTargetPixels(GrRenderTarget* target,
+                                                int left, int top, int width, int height,
+                                                GrPixelConfig dstConfig, uint32_t flags) {
+    ASSERT_OWNED_RESOURCE(target);
 
-        return srcPI.convertPixelsTo(&dstPI, width, height);
+    if (NULL == target) {
+        target = fRenderTarget.get();
+        if (NULL == target) {
+            return 0;
+        }
     }
-    return true;
+    if (left < 0 || top < 0 || width <= 0 || height <= 0 ||
+        left + width > target->width() || top + height > target->height()) {
+        return 0;
+    }
+
+    bool unpremul = SkToBool(kUnpremul_PixelOpsFlag & flags);
+    if (unpremul && !GrPixelConfigIs8888(dstConfig)) {
+        // The unpremul flag is only allowed for these two configs.
+        return 0;
+    }
+
+    if (!(kDontFlush_PixelOpsFlag & flags)) {
+        this->flush();
+    }
+
+    // The same R/B swap as readRenderTargetPixels(). There's no y-flip to weigh up, an upside down
+    // read is turned the right way up as it's copied out, for free.
+    GrPixelConfig readConfig = dstConfig;
+    bool swapRAndB = false;
+    if (GrPixelConfigSwapRAndB(dstConfig) ==
+        fGpu->preferredReadPixelsConfig(dstConfig, target->config())) {
+        readConfig = GrPixelConfigSwapRAndB(readConfig);
+        swapRAndB = true;
+    }
+
+    // The scratch only needs to outlive the read being issued.
+    GrAutoScratchTexture ast;
+    GrRenderTarget* scratch = this->drawForReadPixels(target, left, top, width, height,
+                                                      readConfig, false,
+                                                      &swapRAndB, &unpremul, &ast);
+    if (NULL != scratch) {
+        left = 0;
+        top = 0;
+        target = scratch;
+    }
+
+    PendingRead read;
+    read.fWidth = width;
+    read.fHeight = height;
+    read.fConfig = dstConfig;
+    read.fSwapRAndB = swapRAndB;
+    read.fUnpremul = unpremul;
+    read.fReadback = fGpu->beginReadPixels(target, left, top, width, height, readConfig);
+    read.fPixels = NULL;
+    if (NULL == read.fReadback) {
+        // The backend can't read asynchronously, so read now and hold on to the pixels.
+        read.fPixels = sk_malloc_flags(width * height * GrBytesPerPixel(readConfig), 0);
+        if (NULL == read.fPixels ||
+            !fGpu->readPixels(target, left, top, width, height, readConfig, read.fPixels, 0)) {
+            sk_free(read.fPixels);
+            return 0;
+        }
+    }
+
+    if (0 == ++fLastReadToken) {
+        ++fLastReadToken;
+    }
+    read.fToken = fLastReadToken;
+    *fPendingReads.append() = read;
+    return read.fToken;
+}
+
+int GrContext::findPendingRead(uint32_t token) const {
+    for (int i = 0; i < fPendingReads.count(); ++i) {
+        if (fPendingReads[i].fToken == token) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool GrContext::isReadRenderTargetPixelsReady(uint32_t token) {
+    int index = this->findPendingRead(token);
+    if (index < 0) {
+        return false;
+    }
+    const PendingRead& read = fPendingReads[index];
+    return NULL == read.fReadback || read.fReadback->isReady();
+}
+
+bool GrContext::finishReadRenderTargetPixels(uint32_t token, void* buffer, size_t rowBytes) {
+    int index = this->findPendingRead(token);
+    if (index < 0) {
+        return false;
+    }
+    const PendingRead read = fPendingReads[index];
+    fPendingReads.removeShuffle(index);
+
+    const size_t tightRowBytes = read.fWidth * GrBytesPerPixel(read.fConfig);
+    if (0 == rowBytes) {
+        rowBytes = tightRowBytes;
+    }
+    bool success;
+    if (NULL != read.fReadback) {
+        success = read.fReadback->readPixels(buffer, rowBytes);
+    } else {
+        const char* src = reinterpret_cast<const char*>(read.fPixels);
+        char* dst = reinterpret_cast<char*>(buffer);
+        for (int y = 0; y < read.fHeight; ++y) {
+            memcpy(dst, src, tightRowBytes);
+            src += tightRowBytes;
+            dst += rowBytes;
+        }
+        success = true;
+    }
+    this->deletePendingRead(read);
+
+    return success && convert_read_pixels(read.fConfig, read.fSwapRAndB, read.fUnpremul,
+                                          buffer, rowBytes, read.fWidth, read.fHeight);
+}
+
+void GrContext::deletePendingRead(const PendingRead& read) {
+    SkSafeUnref(read.fReadback);
+    sk_free(read.fPixels);
 }
 
 void GrContext::resolveRenderTarget(GrRenderTarget* target) {
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrContextShareGroup.h"
+#include "GrResourceCache.h"
+
+struct GrContextShareGroup::Texture {
+    GrResourceKey           fKey;
+    GrBackendTextureDesc    fDesc;
+    GrFence                 fFence;
+    int                     fRefCnt;
+};
+
+GrContextShareGroup::GrContextShareGroup() {
+}
+
+GrContextShareGroup::~GrContextShareGroup() {
+    // Every context using the group holds a ref on it, so they have all released their textures.
+    SkASSERT(0 == fTextures.count());
+    fTextures.deleteAll();
+}
+
+int GrContextShareGroup::getSharedTextureCount() const {
+    SkAutoMutexAcquire ama(fMutex);
+    return fTextures.count();
+}
+
+int GrContextShareGroup::findTexture(const GrResourceKey& key) const {
+    for (int i = 0; i < fTextures.count(); ++i) {
+        if (fTextures[i]->fKey == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool GrContextShareGroup::addTexture(const GrResourceKey& key,
+                                     const GrBackendTextureDesc& desc,
+                                     GrFence fence) {
+    SkAutoMutexAcquire ama(fMutex);
+    if (-1 != this->findTexture(key)) {
+        return false;
+    }
+    Texture* texture = SkNEW(Texture);
+    texture->fKey = key;
+    texture->fDesc = desc;
+    texture->fFence = fence;
+    texture->fRefCnt = 1;
+    *fTextures.append() = texture;
+    return true;
+}
+
+bool GrContextShareGroup::refTexture(const GrResourceKey& key,
+                                     GrBackendTextureDesc* desc,
+                                     GrFence* fence) {
+    SkAutoMutexAcquire ama(fMutex);
+    int index = this->findTexture(key);
+    if (-1 == index) {
+        return false;
+    }
+    Texture* texture = fTextures[index];
+    ++texture->fRefCnt;
+    *desc = texture->fDesc;
+    *fence = texture->fFence;
+    return true;
+}
+
+bool GrContextShareGroup::hasTexture(const GrResourceKey& key) const {
+    SkAutoMutexAcquire ama(fMutex);
+    return -1 != this->findTexture(key);
+}
+
+bool GrContextShareGroup::unrefTexture(GrBackendObject handle, GrFence* fence) {
+    SkAutoMutexAcquire ama(fMutex);
+    for (int i = 0; i < fTextures.count(); ++i) {
+        Texture* texture = fTextures[i];
+        if (texture->fDesc.fTextureHandle != handle) {
+            continue;
+        }
+        SkASSERT(texture->fRefCnt > 0);
+        if (0 != --texture->fRefCnt) {
+            return false;
+        }
+        *fence = texture->fFence;
+        fTextures.removeShuffle(i);
+        SkDELETE(texture);
+        return true;
+    }
+    SkDEBUGFAIL("Texture is not in the share group.");
+    return false;
+}
@@ -10,15 +10,18 @@
 #include "GrContext.h"
 #include "GrDrawState.h"
 #include "GrPathUtils.h"
+#include "GrTessellatedPath.h"
 #include "SkString.h"
 #include "SkStrokeRec.h"
 #include "SkTLazy.h"
 #include "SkTraceEvent.h"
 
 
-GrDefaultPathRenderer::GrDefaultPathRenderer(bool separateStencilSupport,
+GrDefaultPathRenderer::GrDefaultPathRenderer(GrContext* context,
+                                             bool separateStencilSupport,
                                              bool stencilWrapOpsSupport)
-    : fSeparateStencil(separateStencilSupport)
+    : fContext(context)
+    , fSeparateStencil(separateStencilSupport)
     , fStencilWrapOps(stencilWrapOpsSupport) {
 }
 
@@ -187,59 +190,60 @@ static inline void append_countour_edge_indices(bool hairLine,
     *((*indices)++) = edgeV0Idx + 1;
 }
 
-bool GrDefaultPathRenderer::createGeom(const SkPath& path,
-                                       const SkStrokeRec& stroke,
-                                       SkScalar srcSpaceTol,
-                                       GrDrawTarget* target,
-                                       GrPrimitiveType* primType,
-                                       int* vertexCnt,
-                                       int* indexCnt,
-                                       GrDrawTarget::AutoReleaseGeometry* arg) {
-    {
-    SkScalar srcSpaceTolSqd = SkScalarMul(srcSpaceTol, srcSpaceTol);
+// Computes the primitive type and an upper bound on the vertex and index counts for the path's
+// geometry at the given tolerance. Returns false if the path can't be drawn.
+static bool get_geom_sizes(const SkPath& path,
+                           bool isHairline,
+                           SkScalar srcSpaceTol,
+                           GrPrimitiveType* primType,
+                           int* maxPts,
+                           int* maxIdxs) {
     int contourCnt;
-    int maxPts = GrPathUtils::worstCasePointCount(path, &contourCnt,
-                                                  srcSpaceTol);
+    *maxPts = GrPathUtils::worstCasePointCount(path, &contourCnt, srcSpaceTol);
 
-    if (maxPts <= 0) {
+    if (*maxPts <= 0) {
         return false;
     }
-    if (maxPts > ((int)SK_MaxU16 + 1)) {
-        GrPrintf("Path not rendered, too many verts (%d)\n", maxPts);
+    if (*maxPts > ((int)SK_MaxU16 + 1)) {
+        GrPrintf("Path not rendered, too many verts (%d)\n", *maxPts);
         return false;
     }
 
     bool indexed = contourCnt > 1;
 
-    const bool isHairline = stroke.isHairlineStyle();
-
-    int maxIdxs = 0;
+    *maxIdxs = 0;
     if (isHairline) {
         if (indexed) {
-            maxIdxs = 2 * maxPts;
+            *maxIdxs = 2 * *maxPts;
             *primType = kLines_GrPrimitiveType;
         } else {
             *primType = kLineStrip_GrPrimitiveType;
         }
     } else {
         if (indexed) {
-            maxIdxs = 3 * maxPts;
+            *maxIdxs = 3 * *maxPts;
             *primType = kTriangles_GrPrimitiveType;
         } else {
             *primType = kTriangleFan_GrPrimitiveType;
         }
     }
+    return true;
+}
 
-    target->drawState()->setDefaultVertexAttribs();
-    if (!arg->set(target, maxPts, maxIdxs)) {
-        return false;
-    }
+// Writes the path's vertices to base and, if indexed, its indices to idxBase.
+static void tessellate_path(const SkPath& path,
+                            bool isHairline,
+                            bool indexed,
+                            SkScalar srcSpaceTol,
+                            SkPoint* base,
+                            uint16_t* idxBase,
+                            int* vertexCnt,
+                            int* indexCnt) {
+    SkScalar srcSpaceTolSqd = SkScalarMul(srcSpaceTol, srcSpaceTol);
 
-    uint16_t* idxBase = reinterpret_cast<uint16_t*>(arg->indices());
     uint16_t* idx = idxBase;
     uint16_t subpathIdxStart = 0;
 
-    SkPoint* base = reinterpret_cast<SkPoint*>(arg->vertices());
     SkASSERT(NULL != base);
     SkPoint* vert = base;
 
@@ -313,16 +317,92 @@ bool GrDefaultPathRenderer::createGeom(const SkPath& path,
         first = false;
     }
 FINISHED:
-    SkASSERT((vert - base) <= maxPts);
-    SkASSERT((idx - idxBase) <= maxIdxs);
-
     *vertexCnt = static_cast<int>(vert - base);
     *indexCnt = static_cast<int>(idx - idxBase);
+}
+
+bool GrDefaultPathRenderer::createGeom(const SkPath& path,
+                                       const SkStrokeRec& stroke,
+                                       SkScalar srcSpaceTol,
+                                       GrDrawTarget* target,
+                                       GrPrimitiveType* primType,
+                                       int* vertexCnt,
+                                       int* indexCnt,
+                                       GrDrawTarget::AutoReleaseGeometry* arg) {
+    const bool isHairline = stroke.isHairlineStyle();
 
+    int maxPts;
+    int maxIdxs;
+    if (!get_geom_sizes(path, isHairline, srcSpaceTol, primType, &maxPts, &maxIdxs)) {
+        return false;
     }
+
+    target->drawState()->setDefaultVertexAttribs();
+    if (!arg->set(target, maxPts, maxIdxs)) {
+        return false;
+    }
+
+    tessellate_path(path, isHairline, maxIdxs > 0, srcSpaceTol,
+                    reinterpret_cast<SkPoint*>(arg->vertices()),
+                    reinterpret_cast<uint16_t*>(arg->indices()),
+                    vertexCnt, indexCnt);
+    SkASSERT(*vertexCnt <= maxPts);
+    SkASSERT(*indexCnt <= maxIdxs);
     return true;
 }
 
+GrTessellatedPath* GrDefaultPathRenderer::findOrCreateCachedGeom(const SkPath& path,
+                                                                 const SkStrokeRec& stroke,
+                                                                 SkScalar srcSpaceTol) {
+    if (!fRecentGenIDs.checkAndAdd(path.getGenerationID())) {
+        return NULL;
+    }
+
+    // The geometry doesn't depend on the view matrix except through the tolerance, so it is
+    // cached per power of two of the tolerance. We tessellate at the fine end of the range so the
+    // geometry is good for any scale that maps to the same range, including the one we started
+    // with.
+    int tolExp;
+    frexp(SkScalarToDouble(srcSpaceTol), &tolExp);
+    SkScalar cacheTol = SkDoubleToScalar(ldexp(1.0, tolExp - 1));
+    const bool isHairline = stroke.isHairlineStyle();
+
+    static const GrCacheID::Domain gDomain = GrCacheID::GenerateDomain();
+    const uint32_t params[3] = { static_cast<uint32_t>(tolExp), isHairline, 0 };
+    GrResourceKey key = GrTessellatedPath::ComputeKey(gDomain, path.getGenerationID(), params);
+
+    GrTessellatedPath* geom =
+        static_cast<GrTessellatedPath*>(fContext->findAndRefCachedResource(key));
+    if (NULL != geom) {
+        return geom;
+    }
+
+    GrPrimitiveType primType;
+    int maxPts;
+    int maxIdxs;
+    if (!get_geom_sizes(path, isHairline, cacheTol, &primType, &maxPts, &maxIdxs)) {
+        return NULL;
+    }
+    SkAutoTMalloc<SkPoint> verts(maxPts);
+    SkAutoTMalloc<uint16_t> idxs(maxIdxs);
+    GrTessellatedPath::Draw draw;
+    tessellate_path(path, isHairline, maxIdxs > 0, cacheTol, verts.get(), idxs.get(),
+                    &draw.fVertexCnt, &draw.fIndexCnt);
+    if (0 == draw.fVertexCnt) {
+        return NULL;
+    }
+    geom = GrTessellatedPath::Create(fContext->getGpu(),
+                                     verts.get(), sizeof(SkPoint), draw.fVertexCnt,
+                                     idxs.get(), draw.fIndexCnt,
+                                     &draw, 1,
+                                     primType,
+                                     path.getBounds());
+    if (NULL != geom) {
+        fContext->addResourceToCache(key, geom);
+    }
+    return geom;
+}
+
 bool GrDefaultPathRenderer::internalDrawPath(const SkPath& path,
                                              const SkStrokeRec& origStroke,
                                              GrDrawTarget* target,
@@ -350,14 +430,22 @@ bool GrDefaultPathRenderer::internalDrawPath(const SkPath& path,
     int indexCnt;
     GrPrimitiveType primType;
     GrDrawTarget::AutoReleaseGeometry arg;
-    if (!this->createGeom(path,
-                          *stroke,
-                          tol,
-                          target,
-                          &primType,
-                          &vertexCnt,
-                          &indexCnt,
-                          &arg)) {
+    GrTessellatedPath::AutoGeometrySrc ags;
+    SkAutoTUnref<GrTessellatedPath> cachedGeom(this->findOrCreateCachedGeom(path, *stroke, tol));
+    if (NULL != cachedGeom.get()) {
+        target->drawState()->setDefaultVertexAttribs();
+        ags.set(target, cachedGeom);
+        primType = cachedGeom->primitiveType();
+        vertexCnt = cachedGeom->draw(0).fVertexCnt;
+        indexCnt = cachedGeom->draw(0).fIndexCnt;
+    } else if (!this->createGeom(path,
+                                 *stroke,
+                                 tol,
+                                 target,
+                                 &primType,
+                                 &vertexCnt,
+                                 &indexCnt,
+                                 &arg)) {
         return false;
     }
 
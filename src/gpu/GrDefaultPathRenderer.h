@@ -9,6 +9,7 @@
 #define GrDefaultPathRenderer_DEFINED
 
 #include "GrPathRenderer.h"
+#include "GrTessellatedPath.h"
 #include "SkTemplates.h"
 
 /**
@@ -17,7 +18,9 @@
  */
 class SK_API GrDefaultPathRenderer : public GrPathRenderer {
 public:
-    GrDefaultPathRenderer(bool separateStencilSupport, bool stencilWrapOpsSupport);
+    GrDefaultPathRenderer(GrContext* context,
+                          bool separateStencilSupport,
+                          bool stencilWrapOpsSupport);
 
     virtual bool canDrawPath(const SkPath&,
                              const SkStrokeRec&,
@@ -53,8 +56,16 @@ private:
                     int* indexCnt,
                     GrDrawTarget::AutoReleaseGeometry*);
 
-    bool    fSeparateStencil;
-    bool    fStencilWrapOps;
+    // Returns the path's geometry in static buffers from the resource cache, creating it if the
+    // path has been drawn recently. Returns NULL if the geometry should be streamed instead.
+    GrTessellatedPath* findOrCreateCachedGeom(const SkPath&,
+                                              const SkStrokeRec&,
+                                              SkScalar srcSpaceTol);
+
+    GrContext*                      fContext;
+    bool                            fSeparateStencil;
+    bool                            fStencilWrapOps;
+    GrTessellatedPath::RecentGenIDs fRecentGenIDs;
 
     typedef GrPathRenderer INHERITED;
 };
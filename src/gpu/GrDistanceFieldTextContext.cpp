@@ -17,6 +17,7 @@
 #include "GrStrokeInfo.h"
 #include "GrTextStrike.h"
 #include "GrTextStrike_impl.h"
+#include "GrTracing.h"
 #include "SkDistanceFieldGen.h"
 #include "SkDraw.h"
 #include "SkGpuDevice.h"
@@ -100,6 +101,7 @@ void GrDistanceFieldTextContext::flushGlyphs() {
     if (NULL == fDrawTarget) {
         return;
     }
+    GR_CREATE_TRACE_MARKER("GrDistanceFieldTextContext::flushGlyphs", fDrawTarget);
 
     GrDrawState* drawState = fDrawTarget->drawState();
     GrDrawState::AutoRestoreEffects are(drawState);
@@ -58,6 +58,7 @@ void GrDrawState::setFromPaint(const GrPaint& paint, const SkMatrix& vm, GrRende
     this->setState(GrDrawState::kHWAntialias_StateBit, paint.isAntiAlias());
 
     this->setBlendFunc(paint.getSrcBlendCoeff(), paint.getDstBlendCoeff());
+    this->setBlendEquation(paint.getBlendEquation());
     this->setCoverage(paint.getCoverage());
 }
 
@@ -330,6 +331,12 @@ GrDrawState::BlendOptFlags GrDrawState::getBlendOpts(bool forceCoverage,
                        this->hasCoverageVertexAttribute() ||
                        fCoverageStages.count() > 0;
 
+    if (GrBlendEquationIsAdvanced(this->getBlendEquation()) && !this->isColorWriteDisabled()) {
+        // The coeffs don't apply. The advanced equations are linear in the src color and alpha so
+        // scaling the src by coverage lerps between the dst and the fully covered result.
+        return hasCoverage ? kCoverageAsAlpha_BlendOptFlag : kNone_BlendOpt;
+    }
+
     // if we don't have coverage we can check whether the dst
     // has to read at all. If not, we'll disable blending.
     if (!hasCoverage) {
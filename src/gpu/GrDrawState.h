@@ -490,6 +490,13 @@ public:
      */
     GrColor getBlendConstant() const { return fCommon.fBlendConstant; }
 
+    /**
+     * Sets the blend equation. The advanced equations replace the blend coefficients. Coverage is
+     * applied to them by scaling the src color, which lerps between dst and the blended color.
+     */
+    void setBlendEquation(GrBlendEquation equation) { fCommon.fBlendEquation = equation; }
+    GrBlendEquation getBlendEquation() const { return fCommon.fBlendEquation; }
+
     /**
      * Determines whether multiplying the computed per-pixel color by the pixel's fractional
      * coverage before the blend will give the correct final destination color. In general it
@@ -896,6 +903,7 @@ private:
         fCommon.fSrcBlend = kOne_GrBlendCoeff;
         fCommon.fDstBlend = kZero_GrBlendCoeff;
         fCommon.fBlendConstant = 0x0;
+        fCommon.fBlendEquation = kAdd_GrBlendEquation;
         fCommon.fFlagBits = 0x0;
         fCommon.fStencilSettings.setDisabled();
         fCommon.fCoverage = 0xffffffff;
@@ -910,6 +918,7 @@ private:
         GrBlendCoeff          fSrcBlend;
         GrBlendCoeff          fDstBlend;
         GrColor               fBlendConstant;
+        GrBlendEquation       fBlendEquation;
         uint32_t              fFlagBits;
         const GrVertexAttrib* fVAPtr;
         int                   fVACount;
@@ -927,6 +936,7 @@ private:
                           fSrcBlend == other.fSrcBlend &&
                           fDstBlend == other.fDstBlend &&
                           fBlendConstant == other.fBlendConstant &&
+                          fBlendEquation == other.fBlendEquation &&
                           fFlagBits == other.fFlagBits &&
                           fVACount == other.fVACount &&
                           !memcmp(fVAPtr, other.fVAPtr, fVACount * sizeof(GrVertexAttrib)) &&
@@ -31,6 +31,9 @@ GrDrawTarget::DrawInfo& GrDrawTarget::DrawInfo::operator =(const DrawInfo& di) {
     fVerticesPerInstance    = di.fVerticesPerInstance;
     fIndicesPerInstance     = di.fIndicesPerInstance;
 
+    fUnitGeometry           = di.fUnitGeometry;
+    fUnitVertexCount        = di.fUnitVertexCount;
+
     if (NULL != di.fDevBounds) {
         SkASSERT(di.fDevBounds == &di.fDevBoundsStorage);
         fDevBoundsStorage = di.fDevBoundsStorage;
@@ -70,6 +73,12 @@ void GrDrawTarget::DrawInfo::adjustInstanceCount(int instanceOffset) {
     fIndexCount = fIndicesPerInstance * fInstanceCount;
 }
 
+void GrDrawTarget::DrawInfo::adjustHWInstanceCount(int instanceOffset) {
+    SkASSERT(this->isHWInstanced());
+    SkASSERT(instanceOffset + fVertexCount >= 0);
+    fVertexCount += instanceOffset;
+}
+
 void GrDrawTarget::DrawInfo::adjustStartVertex(int vertexOffset) {
     fStartVertex += vertexOffset;
     SkASSERT(fStartVertex >= 0);
@@ -437,6 +446,12 @@ bool GrDrawTarget::setupDstReadIfNecessary(GrDeviceCoordTexture* dstCopy, const
 #endif
     }
 
+    return this->onSetupDstCopy(rt, copyRect, dstCopy);
+}
+
+bool GrDrawTarget::onSetupDstCopy(GrRenderTarget* rt,
+                                  const SkIRect& copyRect,
+                                  GrDeviceCoordTexture* dstCopy) {
     // MSAA consideration: When there is support for reading MSAA samples in the shader we could
     // have per-sample dst values by making the copy multisampled.
     GrTextureDesc desc;
@@ -579,19 +594,19 @@ void GrDrawTarget::drawPaths(int pathCount, const GrPath** paths,
 }
 
 void GrDrawTarget::addGpuTraceMarker(GrGpuTraceMarker* marker) {
-    if (this->caps()->gpuTracingSupport()) {
+    if (this->caps()->gpuTracingSupport() || this->caps()->timerQuerySupport()) {
         SkASSERT(fGpuTraceMarkerCount >= 0);
         this->fActiveTraceMarkers.add(*marker);
-        this->didAddGpuTraceMarker();
+        this->didAddGpuTraceMarker(*marker);
         ++fGpuTraceMarkerCount;
     }
 }
 
 void GrDrawTarget::removeGpuTraceMarker(GrGpuTraceMarker* marker) {
-    if (this->caps()->gpuTracingSupport()) {
+    if (this->caps()->gpuTracingSupport() || this->caps()->timerQuerySupport()) {
         SkASSERT(fGpuTraceMarkerCount >= 1);
         this->fActiveTraceMarkers.remove(*marker);
-        this->didRemoveGpuTraceMarker();
+        this->didRemoveGpuTraceMarker(*marker);
         --fGpuTraceMarkerCount;
     }
 }
@@ -667,6 +682,53 @@ void GrDrawTarget::drawIndexedInstances(GrPrimitiveType type,
     }
 }
 
+bool GrDrawTarget::canDrawHWInstances() const {
+    return this->caps()->instancedDrawingSupport() &&
+           0 == this->getDrawState().numTotalStages();
+}
+
+void GrDrawTarget::drawHWInstances(GrPrimitiveType type,
+                                   const GrVertexBuffer* unitGeometry,
+                                   int unitVertexCount,
+                                   int instanceCount,
+                                   const SkRect* devBounds) {
+    SkASSERT(this->caps()->instancedDrawingSupport());
+    SkASSERT(NULL != unitGeometry);
+    if (unitVertexCount <= 0 || instanceCount <= 0 ||
+        !this->checkDraw(type, 0, -1, instanceCount, -1)) {
+        return;
+    }
+#ifdef SK_DEBUG
+    const GrDrawState& drawState = this->getDrawState();
+    const GrVertexAttrib& position = drawState.getVertexAttribs()[drawState.positionAttributeIndex()];
+    SkASSERT(unitGeometry->gpuMemorySize() >=
+             unitVertexCount * GrVertexAttribTypeSize(position.fType));
+#endif
+
+    DrawInfo info;
+    info.fPrimitiveType = type;
+    info.fStartVertex   = 0;
+    info.fStartIndex    = 0;
+    info.fVertexCount   = instanceCount;
+    info.fIndexCount    = 0;
+
+    info.fInstanceCount         = 0;
+    info.fVerticesPerInstance   = 0;
+    info.fIndicesPerInstance    = 0;
+
+    info.fUnitGeometry      = unitGeometry;
+    info.fUnitVertexCount   = unitVertexCount;
+
+    if (NULL != devBounds) {
+        info.setDevBounds(*devBounds);
+    }
+    // TODO: We should continue with incorrect blending.
+    if (!this->setupDstReadIfNecessary(&info)) {
+        return;
+    }
+    this->onDraw(info);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace {
@@ -1020,6 +1082,10 @@ void GrDrawTargetCaps::reset() {
     fDiscardRenderTargetSupport = false;
     fReuseScratchTextures = true;
     fGpuTracingSupport = false;
+    fTimerQuerySupport = false;
+    fStreamingBufferSupport = false;
+    fInstancedDrawingSupport = false;
+    fAdvancedBlendEquationSupport = false;
 
     fMapBufferFlags = kNone_MapFlags;
 
@@ -1045,6 +1111,10 @@ GrDrawTargetCaps& GrDrawTargetCaps::operator=(const GrDrawTargetCaps& other) {
     fDiscardRenderTargetSupport = other.fDiscardRenderTargetSupport;
     fReuseScratchTextures = other.fReuseScratchTextures;
     fGpuTracingSupport = other.fGpuTracingSupport;
+    fTimerQuerySupport = other.fTimerQuerySupport;
+    fStreamingBufferSupport = other.fStreamingBufferSupport;
+    fInstancedDrawingSupport = other.fInstancedDrawingSupport;
+    fAdvancedBlendEquationSupport = other.fAdvancedBlendEquationSupport;
 
     fMapBufferFlags = other.fMapBufferFlags;
 
@@ -1094,11 +1164,15 @@ SkString GrDrawTargetCaps::dump() const {
     r.appendf("Discard Render Target Support: %s\n", gNY[fDiscardRenderTargetSupport]);
     r.appendf("Reuse Scratch Textures       : %s\n", gNY[fReuseScratchTextures]);
     r.appendf("Gpu Tracing Support          : %s\n", gNY[fGpuTracingSupport]);
+    r.appendf("Timer Query Support          : %s\n", gNY[fTimerQuerySupport]);
     r.appendf("Max Texture Size             : %d\n", fMaxTextureSize);
     r.appendf("Max Render Target Size       : %d\n", fMaxRenderTargetSize);
     r.appendf("Max Sample Count             : %d\n", fMaxSampleCount);
 
     r.appendf("Map Buffer Support           : %s\n", map_flags_to_string(fMapBufferFlags).c_str());
+    r.appendf("Streaming Buffer Support     : %s\n", gNY[fStreamingBufferSupport]);
+    r.appendf("Instanced Drawing Support    : %s\n", gNY[fInstancedDrawingSupport]);
+    r.appendf("Advanced Blend Equations     : %s\n", gNY[fAdvancedBlendEquationSupport]);
 
     static const char* kConfigNames[] = {
         "Unknown",  // kUnknown_GrPixelConfig
@@ -1110,6 +1184,7 @@ SkString GrDrawTargetCaps::dump() const {
         "BGRA8888", // kBGRA_8888_GrPixelConfig,
         "ETC1",     // kETC1_GrPixelConfig,
         "LATC",     // kLATC_GrPixelConfig,
+        "R11EAC",   // kR11_EAC_GrPixelConfig,
     };
     GR_STATIC_ASSERT(0 == kUnknown_GrPixelConfig);
     GR_STATIC_ASSERT(1 == kAlpha_8_GrPixelConfig);
@@ -1120,6 +1195,7 @@ SkString GrDrawTargetCaps::dump() const {
     GR_STATIC_ASSERT(6 == kBGRA_8888_GrPixelConfig);
     GR_STATIC_ASSERT(7 == kETC1_GrPixelConfig);
     GR_STATIC_ASSERT(8 == kLATC_GrPixelConfig);
+    GR_STATIC_ASSERT(9 == kR11_EAC_GrPixelConfig);
     GR_STATIC_ASSERT(SK_ARRAY_COUNT(kConfigNames) == kGrPixelConfigCnt);
 
     SkASSERT(!fConfigRenderSupport[kUnknown_GrPixelConfig][0]);
@@ -426,6 +426,36 @@ public:
                               int indicesPerInstance,
                               const SkRect* devBounds = NULL);
 
+    /**
+     * Draws instanceCount copies of a unit geometry using hardware instancing. The unit geometry
+     * buffer holds unitVertexCount values of the position attribute, tightly packed, and is the
+     * only source of the position attribute. All other attributes come from the current vertex
+     * source, which holds one vertex per instance starting at vertex 0 and advances once per
+     * instance. The position attribute's slot in those vertices is unused. Typically a vertex
+     * effect combines the unit position with the per-instance attributes to place each vertex.
+     * Consecutive calls that use the same unit geometry and draw state may be batched into a
+     * single GPU draw. Requires caps()->instancedDrawingSupport() and a non-indexed draw.
+     *
+     * @param type            the type of primitives to draw for each instance
+     * @param unitGeometry    positions of the vertices of one instance
+     * @param unitVertexCount the number of vertices in each instance
+     * @param instanceCount   the number of instances to draw
+     * @param devBounds       optional bounds hint. This is a promise from the caller,
+     *                        not a request for clipping.
+     */
+    void drawHWInstances(GrPrimitiveType type,
+                         const GrVertexBuffer* unitGeometry,
+                         int unitVertexCount,
+                         int instanceCount,
+                         const SkRect* devBounds = NULL);
+
+    /**
+     * Returns true if drawHWInstances() is supported and the draw state has no effects installed.
+     * Instanced draws place their vertices in a vertex effect, and effects installed before that
+     * one would compute their position based coords from the unit geometry.
+     */
+    bool canDrawHWInstances() const;
+
     /**
      * Clear the current render target if one isn't passed in. Ignores the
      * clip and all other draw state (blend mode, stages, etc). Clears the
@@ -513,7 +543,8 @@ public:
     }
 
     inline bool isGpuTracingEnabled() const {
-        return this->getContext()->isGpuTracingEnabled();
+        return this->getContext()->isGpuTracingEnabled() ||
+               this->getContext()->isGpuTimingEnabled();
     }
 
     ////////////////////////////////////////////////////////////////////////////
@@ -768,6 +799,14 @@ protected:
                                   const SkIRect& srcRect,
                                   const SkIPoint& dstPoint);
 
+    // Called by setupDstReadIfNecessary to copy copyRect of the render target into a texture for
+    // a draw to read the dst from. copyRect is within the clip bounds. The default implementation
+    // makes a new copy for each draw. Subclasses that defer draws may keep a copy around for later
+    // draws to share.
+    virtual bool onSetupDstCopy(GrRenderTarget* rt,
+                                const SkIRect& copyRect,
+                                GrDeviceCoordTexture* dstCopy);
+
     GrContext* getContext() { return fContext; }
     const GrContext* getContext() const { return fContext; }
 
@@ -811,6 +850,12 @@ protected:
         int indicesPerInstance() const { return fIndicesPerInstance; }
         int instanceCount() const { return fInstanceCount; }
 
+        // Non-NULL for draws made by drawHWInstances(). In that case vertexCount() is the number
+        // of instances, i.e. the number of vertices read from the vertex source.
+        const GrVertexBuffer* unitGeometry() const { return fUnitGeometry; }
+        int unitVertexCount() const { return fUnitVertexCount; }
+        bool isHWInstanced() const { return NULL != fUnitGeometry; }
+
         bool isIndexed() const { return fIndexCount > 0; }
 #ifdef SK_DEBUG
         bool isInstanced() const; // this version is longer because of asserts
@@ -820,6 +865,8 @@ protected:
 
         // adds or remove instances
         void adjustInstanceCount(int instanceOffset);
+        // adds or removes instances of a hardware instanced draw
+        void adjustHWInstanceCount(int instanceOffset);
         // shifts the start vertex
         void adjustStartVertex(int vertexOffset);
         // shifts the start index
@@ -830,6 +877,15 @@ protected:
             fDevBounds = &fDevBoundsStorage;
         }
         const SkRect* getDevBounds() const { return fDevBounds; }
+        // grows the bounds to cover another draw merged into this one; if that draw has no
+        // bounds, neither does this one
+        void joinDevBounds(const SkRect* bounds) {
+            if (NULL == bounds) {
+                fDevBounds = NULL;
+            } else if (NULL != fDevBounds) {
+                fDevBoundsStorage.join(*bounds);
+            }
+        }
 
         // NULL if no copy of the dst is needed for the draw.
         const GrDeviceCoordTexture* getDstCopy() const {
@@ -841,7 +897,7 @@ protected:
         }
 
     private:
-        DrawInfo() { fDevBounds = NULL; }
+        DrawInfo() : fUnitGeometry(NULL), fUnitVertexCount(0) { fDevBounds = NULL; }
 
         friend class GrDrawTarget;
 
@@ -856,6 +912,9 @@ protected:
         int                     fVerticesPerInstance;
         int                     fIndicesPerInstance;
 
+        const GrVertexBuffer*   fUnitGeometry;
+        int                     fUnitVertexCount;
+
         SkRect                  fDevBoundsStorage;
         SkRect*                 fDevBounds;
 
@@ -902,8 +961,8 @@ private:
                              SkPath::FillType, SkStrokeRec::Style,
                              const GrDeviceCoordTexture* dstCopy) = 0;
 
-    virtual void didAddGpuTraceMarker() = 0;
-    virtual void didRemoveGpuTraceMarker() = 0;
+    virtual void didAddGpuTraceMarker(const GrGpuTraceMarker&) = 0;
+    virtual void didRemoveGpuTraceMarker(const GrGpuTraceMarker&) = 0;
 
     // helpers for reserving vertex and index space.
     bool reserveVertexSpace(size_t vertexSize,
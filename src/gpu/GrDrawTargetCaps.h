@@ -40,6 +40,8 @@ public:
     bool dstReadInShaderSupport() const { return fDstReadInShaderSupport; }
     bool discardRenderTargetSupport() const { return fDiscardRenderTargetSupport; }
     bool gpuTracingSupport() const { return fGpuTracingSupport; }
+    /** Whether the GPU can time trace marker scopes, see GrContext::enableGpuTiming(). */
+    bool timerQuerySupport() const { return fTimerQuerySupport; }
 
     /**
      * Indicates whether GPU->CPU memory mapping for GPU resources such as vertex buffers and
@@ -55,6 +57,25 @@ public:
 
     uint32_t mapBufferFlags() const { return fMapBufferFlags; }
 
+    /**
+     * Indicates whether streaming vertex and index buffers can be created. These stay mapped
+     * across draws and can be written while the GPU reads earlier parts of them, with fences
+     * telling when those parts may be overwritten.
+     */
+    bool streamingBufferSupport() const { return fStreamingBufferSupport; }
+
+    /**
+     * Indicates whether GrDrawTarget::drawHWInstances() is supported, i.e. whether vertex
+     * attributes can be advanced once per instance rather than once per vertex.
+     */
+    bool instancedDrawingSupport() const { return fInstancedDrawingSupport; }
+
+    /**
+     * Indicates whether a GrDrawState's advanced GrBlendEquation can be done by the blend unit,
+     * i.e. without reading the dst in the shader.
+     */
+    bool advancedBlendEquationSupport() const { return fAdvancedBlendEquationSupport; }
+
     // Scratch textures not being reused means that those scratch textures
     // that we upload to (i.e., don't have a render target) will not be
     // recycled in the texture cache. This is to prevent ghosting by drivers
@@ -90,6 +111,10 @@ protected:
     bool fDiscardRenderTargetSupport: 1;
     bool fReuseScratchTextures      : 1;
     bool fGpuTracingSupport         : 1;
+    bool fTimerQuerySupport         : 1;
+    bool fStreamingBufferSupport    : 1;
+    bool fInstancedDrawingSupport   : 1;
+    bool fAdvancedBlendEquationSupport : 1;
 
     uint32_t fMapBufferFlags;
 
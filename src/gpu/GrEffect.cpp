@@ -9,7 +9,7 @@
 #include "GrBackendEffectFactory.h"
 #include "GrContext.h"
 #include "GrCoordTransform.h"
-#include "GrMemoryPool.h"
+#include "GrSlabPool.h"
 #include "SkTLS.h"
 
 #if SK_ALLOW_STATIC_GLOBAL_INITIALIZERS
@@ -41,17 +41,19 @@ const SkMatrix& TestMatrix(SkRandom* random) {
 
 class GrEffect_Globals {
 public:
-    static GrMemoryPool* GetTLS() {
-        return (GrMemoryPool*)SkTLS::Get(CreateTLS, DeleteTLS);
+    // Effects may be released on a different thread than the one that created them, which
+    // GrSlabPool hands back to the creating thread's pool.
+    static GrSlabPool* GetTLS() {
+        return (GrSlabPool*)SkTLS::Get(CreateTLS, DeleteTLS);
     }
 
 private:
     static void* CreateTLS() {
-        return SkNEW_ARGS(GrMemoryPool, (4096, 4096));
+        return SkNEW_ARGS(GrSlabPool, (4096));
     }
 
     static void DeleteTLS(void* pool) {
-        SkDELETE(reinterpret_cast<GrMemoryPool*>(pool));
+        SkDELETE(reinterpret_cast<GrSlabPool*>(pool));
     }
 };
 
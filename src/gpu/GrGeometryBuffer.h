@@ -48,6 +48,10 @@ public:
      * Note that buffer mapping does not go through GrContext and therefore is
      * not serialized with other operations.
      *
+     * Streaming buffers (see GrGpu::createVertexBuffer()) are the exception:
+     * their content is preserved, and map() does not wait for the GPU to stop
+     * reading it.
+     *
      * @return a pointer to the data or NULL if the map fails.
      */
      void* map() { return (fMapPtr = this->onMap()); }
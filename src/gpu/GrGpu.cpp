@@ -202,14 +202,16 @@ GrRenderTarget* GrGpu::wrapBackendRenderTarget(const GrBackendRenderTargetDesc&
     return this->onWrapBackendRenderTarget(desc);
 }
 
-GrVertexBuffer* GrGpu::createVertexBuffer(size_t size, bool dynamic) {
+GrVertexBuffer* GrGpu::createVertexBuffer(size_t size, bool dynamic, bool streaming) {
+    SkASSERT(!streaming || this->caps()->streamingBufferSupport());
     this->handleDirtyContext();
-    return this->onCreateVertexBuffer(size, dynamic);
+    return this->onCreateVertexBuffer(size, dynamic, streaming);
 }
 
-GrIndexBuffer* GrGpu::createIndexBuffer(size_t size, bool dynamic) {
+GrIndexBuffer* GrGpu::createIndexBuffer(size_t size, bool dynamic, bool streaming) {
+    SkASSERT(!streaming || this->caps()->streamingBufferSupport());
     this->handleDirtyContext();
-    return this->onCreateIndexBuffer(size, dynamic);
+    return this->onCreateIndexBuffer(size, dynamic, streaming);
 }
 
 GrPath* GrGpu::createPath(const SkPath& path, const SkStrokeRec& stroke) {
@@ -243,6 +245,15 @@ bool GrGpu::readPixels(GrRenderTarget* target,
                               config, buffer, rowBytes);
 }
 
+GrPixelReadback* GrGpu::beginReadPixels(GrRenderTarget* target,
+                                        int left, int top, int width, int height,
+                                        GrPixelConfig config) {
+    SkASSERT(SkIRect::MakeWH(target->width(), target->height()).contains(
+             SkIRect::MakeXYWH(left, top, width, height)));
+    this->handleDirtyContext();
+    return this->onBeginReadPixels(target, left, top, width, height, config);
+}
+
 bool GrGpu::writeTexturePixels(GrTexture* texture,
                                int left, int top, int width, int height,
                                GrPixelConfig config, const void* buffer,
@@ -10,6 +10,7 @@
 
 #include "GrDrawTarget.h"
 #include "GrClipMaskManager.h"
+#include "GrContextShareGroup.h"
 #include "SkPath.h"
 
 class GrContext;
@@ -18,6 +19,7 @@ class GrIndexBufferAllocPool;
 class GrPath;
 class GrPathRenderer;
 class GrPathRendererChain;
+class GrPixelReadback;
 class GrStencilBuffer;
 class GrVertexBufferAllocPool;
 
@@ -54,6 +56,15 @@ public:
     GrContext* getContext() { return this->INHERITED::getContext(); }
     const GrContext* getContext() const { return this->INHERITED::getContext(); }
 
+    /**
+     * The group of contexts this GrGpu's context shares textures with, if any. Shared textures
+     * are released through the group, so it is kept alive until all of them are gone.
+     */
+    GrContextShareGroup* getShareGroup() const { return fShareGroup.get(); }
+    void setShareGroup(GrContextShareGroup* shareGroup) {
+        fShareGroup.reset(SkSafeRef(shareGroup));
+    }
+
     /**
      * The GrGpu object normally assumes that no outsider is setting state
      * within the underlying 3D API's context/device/whatever. This call informs
@@ -110,26 +121,32 @@ public:
     /**
      * Creates a vertex buffer.
      *
-     * @param size    size in bytes of the vertex buffer
-     * @param dynamic hints whether the data will be frequently changed
-     *                by either GrVertexBuffer::map() or
-     *                GrVertexBuffer::updateData().
+     * @param size      size in bytes of the vertex buffer
+     * @param dynamic   hints whether the data will be frequently changed
+     *                  by either GrVertexBuffer::map() or
+     *                  GrVertexBuffer::updateData().
+     * @param streaming if true the buffer is for streaming data through as a
+     *                  ring: map() does not invalidate or wait on the buffer,
+     *                  and is cheap to repeat. The caller must use fences to
+     *                  avoid overwriting data the GPU has yet to read. Only
+     *                  valid if caps()->streamingBufferSupport().
      *
      * @return    The vertex buffer if successful, otherwise NULL.
      */
-    GrVertexBuffer* createVertexBuffer(size_t size, bool dynamic);
+    GrVertexBuffer* createVertexBuffer(size_t size, bool dynamic, bool streaming = false);
 
     /**
      * Creates an index buffer.
      *
-     * @param size    size in bytes of the index buffer
-     * @param dynamic hints whether the data will be frequently changed
-     *                by either GrIndexBuffer::map() or
-     *                GrIndexBuffer::updateData().
+     * @param size      size in bytes of the index buffer
+     * @param dynamic   hints whether the data will be frequently changed
+     *                  by either GrIndexBuffer::map() or
+     *                  GrIndexBuffer::updateData().
+     * @param streaming see createVertexBuffer().
      *
      * @return The index buffer if successful, otherwise NULL.
      */
-    GrIndexBuffer* createIndexBuffer(size_t size, bool dynamic);
+    GrIndexBuffer* createIndexBuffer(size_t size, bool dynamic, bool streaming = false);
 
     /**
      * Creates a path object that can be stenciled using stencilPath(). It is
@@ -151,6 +168,42 @@ public:
      */
     void resolveRenderTarget(GrRenderTarget* target);
 
+    /**
+     * Fences mark a point in the 3D API command stream, so that the CPU can tell when the GPU
+     * has finished with everything issued before it. Only valid if
+     * caps()->streamingBufferSupport().
+     *
+     * insertFence() returns 0 if the fence could not be created. waitFence() blocks until the
+     * fence is reached and returns false if that can't be determined. Every fence must be
+     * passed to deleteFence().
+     */
+    virtual GrFence insertFence() = 0;
+    virtual bool waitFence(GrFence) = 0;
+    virtual void deleteFence(GrFence) = 0;
+
+    /**
+     * Submits everything issued so far so that other contexts in the share group can use its
+     * results. Returns a fence that they must wait on first, or 0 if the work was already
+     * finished because fences aren't supported. Unlike insertFence() this is always valid.
+     */
+    virtual GrFence flushForSharing() = 0;
+
+    /**
+     * Times the work issued between beginTimedScope() and endTimedScope() against every marker
+     * in the set, when caps()->timerQuerySupport(). Scopes may nest. endTimingFrame() closes the
+     * current frame; its times become available from getTimingFrame() a few frames later, once
+     * the GPU has caught up. getTimingFrame() returns false if no frame has completed yet.
+     */
+    virtual void beginTimedScope(const GrTraceMarkerSet&) {}
+    virtual void endTimedScope() {}
+    virtual void endTimingFrame() {}
+    virtual bool getTimingFrame(SkTArray<GrContext::GpuScopeTime>*) const { return false; }
+
+    /**
+     * Fills in the counters of the backend's cache of compiled programs, if it has one.
+     */
+    virtual void getProgramCacheCounters(SkCacheCounters*) const {}
+
     /**
      * Gets a preferred 8888 config to use for writing/reading pixel data to/from a surface with
      * config surfaceConfig. The returned config must have at least as many bits per channel as the
@@ -224,6 +277,15 @@ public:
                     int left, int top, int width, int height,
                     GrPixelConfig config, void* buffer, size_t rowBytes);
 
+    /**
+     * Starts reading a rectangle of a render target without waiting for the GPU to get to it.
+     * The rectangle must lie within the target. Returns NULL if the backend can't read
+     * asynchronously, in which case readPixels() is the way.
+     */
+    GrPixelReadback* beginReadPixels(GrRenderTarget* renderTarget,
+                                     int left, int top, int width, int height,
+                                     GrPixelConfig config);
+
     /**
      * Updates the pixels in a rectangle of a texture.
      *
@@ -429,8 +491,8 @@ private:
                                                  const void* srcData) = 0;
     virtual GrTexture* onWrapBackendTexture(const GrBackendTextureDesc&) = 0;
     virtual GrRenderTarget* onWrapBackendRenderTarget(const GrBackendRenderTargetDesc&) = 0;
-    virtual GrVertexBuffer* onCreateVertexBuffer(size_t size, bool dynamic) = 0;
-    virtual GrIndexBuffer* onCreateIndexBuffer(size_t size, bool dynamic) = 0;
+    virtual GrVertexBuffer* onCreateVertexBuffer(size_t size, bool dynamic, bool streaming) = 0;
+    virtual GrIndexBuffer* onCreateIndexBuffer(size_t size, bool dynamic, bool streaming) = 0;
     virtual GrPath* onCreatePath(const SkPath& path, const SkStrokeRec&) = 0;
 
     // overridden by backend-specific derived class to perform the clear and
@@ -454,6 +516,13 @@ private:
                               void* buffer,
                               size_t rowBytes) = 0;
 
+    // overridden by backend-specific derived classes that can read pixels asynchronously.
+    virtual GrPixelReadback* onBeginReadPixels(GrRenderTarget*,
+                                               int left, int top, int width, int height,
+                                               GrPixelConfig) {
+        return NULL;
+    }
+
     // overridden by backend-specific derived class to perform the texture update
     virtual bool onWriteTexturePixels(GrTexture* texture,
                                       int left, int top, int width, int height,
@@ -529,6 +598,7 @@ private:
     // Used to abandon/release all resources created by this GrGpu. TODO: Move this
     // functionality to GrResourceCache.
     ObjectList                                                          fObjectList;
+    SkAutoTUnref<GrContextShareGroup>                                   fShareGroup;
 
     typedef GrDrawTarget INHERITED;
 };
@@ -16,6 +16,7 @@
 #include "GrTemplates.h"
 #include "GrTexture.h"
 #include "GrVertexBuffer.h"
+#include "SkTraceEvent.h"
 
 GrInOrderDrawBuffer::GrInOrderDrawBuffer(GrGpu* gpu,
                                          GrVertexBufferAllocPool* vertexPool,
@@ -134,6 +135,26 @@ static bool cmd_has_trace_marker(uint8_t cmd) {
     return SkToBool(cmd & kTraceCmdBit);
 }
 
+// How many recorded states recordState() compares against for an equal one, and how many
+// batches back flush() will move a draw.
+static const int kStateKeyLookback = 16;
+static const int kBatchLookback = 16;
+
+namespace {
+
+// A run of draws that flush() plays back under a single state. The draws form a list threaded
+// through the command indices.
+struct DrawBatch {
+    int     fStateCmd;
+    int     fKey;
+    int     fFirstDraw;
+    int     fLastDraw;
+    bool    fBounded;
+    SkRect  fBounds;
+};
+
+}
+
 void GrInOrderDrawBuffer::onDrawRect(const SkRect& rect,
                                      const SkMatrix* matrix,
                                      const SkRect* localRect,
@@ -307,6 +328,11 @@ int GrInOrderDrawBuffer::concatInstancedDraw(const DrawInfo& info) {
     poolState.fUsedPoolVertexBytes = SkTMax(poolState.fUsedPoolVertexBytes, vertexBytes);
 
     draw->adjustInstanceCount(instancesToConcat);
+    // orderCommands() moves draws past this one by its bounds, so they must cover the new
+    // instances too.
+    if (instancesToConcat > 0) {
+        draw->joinDevBounds(info.getDevBounds());
+    }
 
     // update last fGpuCmdMarkers to include any additional trace markers that have been added
     if (this->getActiveTraceMarkers().count() > 0) {
@@ -321,6 +347,50 @@ int GrInOrderDrawBuffer::concatInstancedDraw(const DrawInfo& info) {
     return instancesToConcat;
 }
 
+bool GrInOrderDrawBuffer::concatHWInstancedDraw(const DrawInfo& info) {
+    SkASSERT(info.isHWInstanced());
+
+    // As above, only instances written to reserved space are concatenated, since those are known
+    // not to change between the draws.
+    if (kReserved_GeometrySrcType != this->getGeomSrc().fVertexSrc ||
+        kDraw_Cmd != strip_trace_bit(fCmds.back())) {
+        return false;
+    }
+
+    DrawRecord* draw = &fDraws.back();
+    GeometryPoolState& poolState = fGeoPoolStateStack.back();
+
+    if (!draw->isHWInstanced() ||
+        draw->unitGeometry() != info.unitGeometry() ||
+        draw->unitVertexCount() != info.unitVertexCount() ||
+        draw->primitiveType() != info.primitiveType() ||
+        draw->fVertexBuffer != poolState.fPoolVertexBuffer) {
+        return false;
+    }
+    int adjustedStartVertex = poolState.fPoolStartVertex + info.startVertex();
+    if (draw->startVertex() + draw->vertexCount() != adjustedStartVertex) {
+        return false;
+    }
+
+    size_t vertexBytes = (info.startVertex() + info.vertexCount()) *
+                         this->getDrawState().getVertexSize();
+    poolState.fUsedPoolVertexBytes = SkTMax(poolState.fUsedPoolVertexBytes, vertexBytes);
+
+    draw->adjustHWInstanceCount(info.vertexCount());
+    // As in concatInstancedDraw(), the bounds must cover the new instances.
+    draw->joinDevBounds(info.getDevBounds());
+
+    if (this->getActiveTraceMarkers().count() > 0) {
+        if (cmd_has_trace_marker(fCmds.back())) {
+            fGpuCmdMarkers.back().addSet(this->getActiveTraceMarkers());
+        } else {
+            fGpuCmdMarkers.push_back(this->getActiveTraceMarkers());
+            fCmds.back() = add_trace_bit(fCmds.back());
+        }
+    }
+    return true;
+}
+
 class AutoClipReenable {
 public:
     AutoClipReenable() : fDrawState(NULL) {}
@@ -345,6 +415,8 @@ void GrInOrderDrawBuffer::onDraw(const DrawInfo& info) {
     const GrDrawState& drawState = this->getDrawState();
     AutoClipReenable acr;
 
+    this->markDstCopyDirty(drawState.getRenderTarget(), info.getDevBounds());
+
     if (drawState.isClipState() &&
         NULL != info.getDevBounds() &&
         this->quickInsideClip(*info.getDevBounds())) {
@@ -367,6 +439,12 @@ void GrInOrderDrawBuffer::onDraw(const DrawInfo& info) {
         } else {
             return;
         }
+    } else if (info.isHWInstanced()) {
+        if (this->concatHWInstancedDraw(info)) {
+            return;
+        }
+        draw = this->recordDraw(info);
+        draw->unitGeometry()->ref();
     } else {
         draw = this->recordDraw(info);
     }
@@ -447,6 +525,7 @@ void GrInOrderDrawBuffer::onDrawPath(const GrPath* path,
     if (this->needsNewState()) {
         this->recordState();
     }
+    this->markDstCopyDirty(this->getDrawState().getRenderTarget(), NULL);
     DrawPath* cp = this->recordDrawPath();
     cp->fPath.reset(path);
     path->ref();
@@ -469,6 +548,7 @@ void GrInOrderDrawBuffer::onDrawPaths(int pathCount, const GrPath** paths,
     if (this->needsNewState()) {
         this->recordState();
     }
+    this->markDstCopyDirty(this->getDrawState().getRenderTarget(), NULL);
     DrawPaths* dp = this->recordDrawPaths();
     dp->fPathCount = pathCount;
     dp->fPaths = SkNEW_ARRAY(const GrPath*, pathCount);
@@ -502,6 +582,7 @@ void GrInOrderDrawBuffer::clear(const SkIRect* rect, GrColor color,
         r.setLTRB(0, 0, renderTarget->width(), renderTarget->height());
         rect = &r;
     }
+    this->markDstCopyDirty(renderTarget, *rect);
     Clear* clr = this->recordClear();
     GrColorIsPMAssert(color);
     clr->fColor = color;
@@ -519,6 +600,7 @@ void GrInOrderDrawBuffer::discard(GrRenderTarget* renderTarget) {
         renderTarget = this->drawState()->getRenderTarget();
         SkASSERT(NULL != renderTarget);
     }
+    this->markDstCopyDirty(renderTarget, NULL);
     Clear* clr = this->recordClear();
     clr->fColor = GrColor_ILLEGAL;
     clr->fRenderTarget = renderTarget;
@@ -535,6 +617,7 @@ void GrInOrderDrawBuffer::reset() {
         SkASSERT(NULL != fDraws[d].fVertexBuffer);
         fDraws[d].fVertexBuffer->unref();
         SkSafeUnref(fDraws[d].fIndexBuffer);
+        SkSafeUnref(fDraws[d].unitGeometry());
     }
     fCmds.reset();
     fDraws.reset();
@@ -542,6 +625,7 @@ void GrInOrderDrawBuffer::reset() {
     fDrawPath.reset();
     fDrawPaths.reset();
     fStates.reset();
+    fStateKeys.rewind();
     fClears.reset();
     fVertexPool.reset();
     fIndexPool.reset();
@@ -550,6 +634,132 @@ void GrInOrderDrawBuffer::reset() {
     fCopySurfaces.reset();
     fGpuCmdMarkers.reset();
     fClipSet = true;
+    this->releaseDstCopy();
+}
+
+void GrInOrderDrawBuffer::orderCommands(SkTDArray<int>* items, SkTDArray<int>* order) {
+    int numCmds = fCmds.count();
+    items->setCount(numCmds);
+    order->setReserve(numCmds);
+
+    // Trace markers are attached to commands in recorded order.
+    bool reorder = fGpuCmdMarkers.empty();
+
+    int counts[kDrawPaths_Cmd + 1];
+    sk_bzero(counts, sizeof(counts));
+
+    SkTDArray<DrawBatch> batches;
+    SkTDArray<int> nextDraw;
+    nextDraw.setCount(numCmds);
+    int stateCmd = -1;
+    int playbackKey = -1;
+
+    // The pass runs one past the last command to emit the final batches.
+    for (int c = 0; c <= numCmds; ++c) {
+        int cmd = 0;
+        if (c < numCmds) {
+            cmd = strip_trace_bit(fCmds[c]);
+            (*items)[c] = counts[cmd]++;
+            if (!reorder) {
+                *order->append() = c;
+                continue;
+            }
+        }
+
+        if (kDraw_Cmd == cmd) {
+            int key = -1;
+            const SkRect* bounds = NULL;
+            if (stateCmd >= 0) {
+                const StateKey& stateKey = fStateKeys[(*items)[stateCmd]];
+                key = stateKey.fKey;
+                if (stateKey.fCanReorder) {
+                    bounds = fDraws[(*items)[c]].getDevBounds();
+                }
+            }
+
+            // A draw may move back past batches it doesn't overlap into one with an equal
+            // state. Draws without bounds stay at the end.
+            int target = -1;
+            if (!batches.isEmpty() && batches.top().fKey == key) {
+                target = batches.count() - 1;
+            } else if (NULL != bounds) {
+                int stop = SkTMax(0, batches.count() - kBatchLookback);
+                for (int b = batches.count() - 1; b >= stop; --b) {
+                    if (batches[b].fKey == key) {
+                        target = b;
+                        break;
+                    }
+                    if (!batches[b].fBounded || SkRect::Intersects(batches[b].fBounds, *bounds)) {
+                        break;
+                    }
+                }
+            }
+
+            DrawBatch* batch;
+            if (target < 0) {
+                batch = batches.append();
+                batch->fStateCmd = stateCmd;
+                batch->fKey = key;
+                batch->fFirstDraw = c;
+                batch->fBounded = NULL != bounds;
+                if (NULL != bounds) {
+                    batch->fBounds = *bounds;
+                }
+            } else {
+                batch = &batches[target];
+                nextDraw[batch->fLastDraw] = c;
+                if (NULL == bounds) {
+                    batch->fBounded = false;
+                } else if (batch->fBounded) {
+                    batch->fBounds.join(*bounds);
+                }
+            }
+            batch->fLastDraw = c;
+            nextDraw[c] = -1;
+            continue;
+        }
+
+        // Anything other than a state change keeps its place, as does a switch of render target.
+        bool barrier = kSetState_Cmd != cmd ||
+                       (stateCmd >= 0 && fStateKeys[(*items)[stateCmd]].fRenderTarget !=
+                                         fStateKeys[(*items)[c]].fRenderTarget);
+        if (barrier) {
+            for (int b = 0; b < batches.count(); ++b) {
+                const DrawBatch& batch = batches[b];
+                if (batch.fStateCmd >= 0 && batch.fKey != playbackKey) {
+                    *order->append() = batch.fStateCmd;
+                    playbackKey = batch.fKey;
+                }
+                for (int d = batch.fFirstDraw; d >= 0; d = nextDraw[d]) {
+                    *order->append() = d;
+                }
+            }
+            batches.rewind();
+        }
+
+        if (c == numCmds) {
+            break;
+        }
+        if (kSetState_Cmd == cmd) {
+            stateCmd = c;
+            continue;
+        }
+        // Stencil and path commands use the state in effect when they were recorded.
+        if (stateCmd >= 0 && fStateKeys[(*items)[stateCmd]].fKey != playbackKey) {
+            *order->append() = stateCmd;
+            playbackKey = fStateKeys[(*items)[stateCmd]].fKey;
+        }
+        *order->append() = c;
+    }
+
+    // we should have visited all the states, clips, etc.
+    SkASSERT(fStates.count() == counts[kSetState_Cmd]);
+    SkASSERT(fStateKeys.count() == counts[kSetState_Cmd]);
+    SkASSERT(fClips.count() == counts[kSetClip_Cmd]);
+    SkASSERT(fClipOrigins.count() == counts[kSetClip_Cmd]);
+    SkASSERT(fClears.count() == counts[kClear_Cmd]);
+    SkASSERT(fDraws.count() == counts[kDraw_Cmd]);
+    SkASSERT(fCopySurfaces.count() == counts[kCopySurface_Cmd]);
 }
 
 void GrInOrderDrawBuffer::flush() {
@@ -565,6 +775,7 @@ void GrInOrderDrawBuffer::flush() {
         return;
     }
 
+    TRACE_EVENT1("skia.gpu", "GrInOrderDrawBuffer::flush", "numCmds", numCmds);
     GrAutoTRestore<bool> flushRestore(&fFlushing);
     fFlushing = true;
 
@@ -581,98 +792,88 @@ void GrInOrderDrawBuffer::flush() {
 
     GrClipData clipData;
 
-    int currState       = 0;
-    int currClip        = 0;
-    int currClear       = 0;
-    int currDraw        = 0;
-    int currStencilPath = 0;
-    int currDrawPath    = 0;
-    int currDrawPaths   = 0;
-    int currCopySurface = 0;
+    SkTDArray<int> items;
+    SkTDArray<int> order;
+    this->orderCommands(&items, &order);
+
     int currCmdMarker   = 0;
+    bool timing = this->getContext()->isGpuTimingEnabled();
 
-    for (int c = 0; c < numCmds; ++c) {
+    for (int i = 0; i < order.count(); ++i) {
+        int c = order[i];
+        int item = items[c];
         GrGpuTraceMarker newMarker("", -1);
         if (cmd_has_trace_marker(fCmds[c])) {
             SkString traceString = fGpuCmdMarkers[currCmdMarker].toString();
             newMarker.fMarker = traceString.c_str();
             fDstGpu->addGpuTraceMarker(&newMarker);
+            if (timing) {
+                fDstGpu->beginTimedScope(fGpuCmdMarkers[currCmdMarker]);
+            }
             ++currCmdMarker;
         }
         switch (strip_trace_bit(fCmds[c])) {
             case kDraw_Cmd: {
-                const DrawRecord& draw = fDraws[currDraw];
+                const DrawRecord& draw = fDraws[item];
                 fDstGpu->setVertexSourceToBuffer(draw.fVertexBuffer);
                 if (draw.isIndexed()) {
                     fDstGpu->setIndexSourceToBuffer(draw.fIndexBuffer);
                 }
                 fDstGpu->executeDraw(draw);
-                ++currDraw;
                 break;
             }
             case kStencilPath_Cmd: {
-                const StencilPath& sp = fStencilPaths[currStencilPath];
+                const StencilPath& sp = fStencilPaths[item];
                 fDstGpu->stencilPath(sp.fPath.get(), sp.fFill);
-                ++currStencilPath;
                 break;
             }
             case kDrawPath_Cmd: {
-                const DrawPath& cp = fDrawPath[currDrawPath];
+                const DrawPath& cp = fDrawPath[item];
                 fDstGpu->executeDrawPath(cp.fPath.get(), cp.fFill,
                                          NULL != cp.fDstCopy.texture() ? &cp.fDstCopy : NULL);
-                ++currDrawPath;
                 break;
             }
             case kDrawPaths_Cmd: {
-                DrawPaths& dp = fDrawPaths[currDrawPaths];
+                DrawPaths& dp = fDrawPaths[item];
                 const GrDeviceCoordTexture* dstCopy =
                     NULL != dp.fDstCopy.texture() ? &dp.fDstCopy : NULL;
                 fDstGpu->executeDrawPaths(dp.fPathCount, dp.fPaths,
                                           dp.fTransforms, dp.fFill, dp.fStroke,
                                           dstCopy);
-                ++currDrawPaths;
                 break;
             }
             case kSetState_Cmd:
-                fStates[currState].restoreTo(&playbackState);
-                ++currState;
+                fStates[item].restoreTo(&playbackState);
                 break;
             case kSetClip_Cmd:
-                clipData.fClipStack = &fClips[currClip];
-                clipData.fOrigin = fClipOrigins[currClip];
+                clipData.fClipStack = &fClips[item];
+                clipData.fOrigin = fClipOrigins[item];
                 fDstGpu->setClip(&clipData);
-                ++currClip;
                 break;
             case kClear_Cmd:
-                if (GrColor_ILLEGAL == fClears[currClear].fColor) {
-                    fDstGpu->discard(fClears[currClear].fRenderTarget);
+                if (GrColor_ILLEGAL == fClears[item].fColor) {
+                    fDstGpu->discard(fClears[item].fRenderTarget);
                 } else {
-                    fDstGpu->clear(&fClears[currClear].fRect,
-                                   fClears[currClear].fColor,
-                                   fClears[currClear].fCanIgnoreRect,
-                                   fClears[currClear].fRenderTarget);
+                    fDstGpu->clear(&fClears[item].fRect,
+                                   fClears[item].fColor,
+                                   fClears[item].fCanIgnoreRect,
+                                   fClears[item].fRenderTarget);
                 }
-                ++currClear;
                 break;
             case kCopySurface_Cmd:
-                fDstGpu->copySurface(fCopySurfaces[currCopySurface].fDst.get(),
-                                     fCopySurfaces[currCopySurface].fSrc.get(),
-                                     fCopySurfaces[currCopySurface].fSrcRect,
-                                     fCopySurfaces[currCopySurface].fDstPoint);
-                ++currCopySurface;
+                fDstGpu->copySurface(fCopySurfaces[item].fDst.get(),
+                                     fCopySurfaces[item].fSrc.get(),
+                                     fCopySurfaces[item].fSrcRect,
+                                     fCopySurfaces[item].fDstPoint);
                 break;
         }
         if (cmd_has_trace_marker(fCmds[c])) {
+            if (timing) {
+                fDstGpu->endTimedScope();
+            }
             fDstGpu->removeGpuTraceMarker(&newMarker);
         }
     }
-    // we should have consumed all the states, clips, etc.
-    SkASSERT(fStates.count() == currState);
-    SkASSERT(fClips.count() == currClip);
-    SkASSERT(fClipOrigins.count() == currClip);
-    SkASSERT(fClears.count() == currClear);
-    SkASSERT(fDraws.count()  == currDraw);
-    SkASSERT(fCopySurfaces.count() == currCopySurface);
     SkASSERT(fGpuCmdMarkers.count() == currCmdMarker);
 
     fDstGpu->setDrawState(prevDrawState);
@@ -686,6 +887,9 @@ bool GrInOrderDrawBuffer::onCopySurface(GrSurface* dst,
                                         const SkIRect& srcRect,
                                         const SkIPoint& dstPoint) {
     if (fDstGpu->canCopySurface(dst, src, srcRect, dstPoint)) {
+        this->markDstCopyDirty(dst->asRenderTarget(),
+                               SkIRect::MakeXYWH(dstPoint.fX, dstPoint.fY,
+                                                 srcRect.width(), srcRect.height()));
         CopySurface* cs = this->recordCopySurface();
         cs->fDst.reset(SkRef(dst));
         cs->fSrc.reset(SkRef(src));
@@ -704,6 +908,77 @@ bool GrInOrderDrawBuffer::onCanCopySurface(GrSurface* dst,
     return fDstGpu->canCopySurface(dst, src, srcRect, dstPoint);
 }
 
+bool GrInOrderDrawBuffer::onSetupDstCopy(GrRenderTarget* rt,
+                                         const SkIRect& copyRect,
+                                         GrDeviceCoordTexture* dstCopy) {
+    if (NULL == fDstCopy.texture() || fDstCopyRT.get() != rt ||
+        !fDstCopyBounds.contains(copyRect)) {
+        this->releaseDstCopy();
+
+        // Copy all that later draws under the same clip could read.
+        SkIRect bounds;
+        this->getClip()->getConservativeBounds(rt, &bounds);
+        SkASSERT(bounds.contains(copyRect));
+
+        GrTextureDesc desc;
+        this->initCopySurfaceDstDesc(rt, &desc);
+        desc.fWidth = bounds.width();
+        desc.fHeight = bounds.height();
+        fDstCopy.set(this->getContext(), desc, GrContext::kApprox_ScratchTexMatch);
+        if (NULL == fDstCopy.texture()) {
+            return INHERITED::onSetupDstCopy(rt, copyRect, dstCopy);
+        }
+        SkIPoint dstPoint = {0, 0};
+        if (!this->copySurface(fDstCopy.texture(), rt, bounds, dstPoint)) {
+            this->releaseDstCopy();
+            return false;
+        }
+        fDstCopyRT.reset(SkRef(rt));
+        fDstCopyBounds = bounds;
+    } else if (SkIRect::Intersects(fDstCopyDirty, copyRect)) {
+        // Bring the whole copy up to date so that the dirty area can start over.
+        SkIRect dirty = fDstCopyDirty;
+        SkAssertResult(dirty.intersect(fDstCopyBounds));
+        SkIPoint dstPoint = {dirty.fLeft - fDstCopyBounds.fLeft,
+                             dirty.fTop - fDstCopyBounds.fTop};
+        if (!this->copySurface(fDstCopy.texture(), rt, dirty, dstPoint)) {
+            this->releaseDstCopy();
+            return false;
+        }
+        fDstCopyDirty.setEmpty();
+    }
+
+    dstCopy->setTexture(fDstCopy.texture());
+    dstCopy->setOffset(fDstCopyBounds.fLeft, fDstCopyBounds.fTop);
+    return true;
+}
+
+void GrInOrderDrawBuffer::releaseDstCopy() {
+    fDstCopy.reset();
+    fDstCopyRT.reset(NULL);
+    fDstCopyBounds.setEmpty();
+    fDstCopyDirty.setEmpty();
+}
+
+void GrInOrderDrawBuffer::markDstCopyDirty(const GrRenderTarget* rt, const SkIRect& rect) {
+    if (NULL != rt && rt == fDstCopyRT.get()) {
+        fDstCopyDirty.join(rect);
+    }
+}
+
+void GrInOrderDrawBuffer::markDstCopyDirty(const GrRenderTarget* rt, const SkRect* devBounds) {
+    if (NULL == devBounds) {
+        // Assume the whole render target was touched.
+        if (NULL != rt) {
+            this->markDstCopyDirty(rt, SkIRect::MakeWH(rt->width(), rt->height()));
+        }
+    } else {
+        SkIRect rect;
+        devBounds->roundOut(&rect);
+        this->markDstCopyDirty(rt, rect);
+    }
+}
+
 void GrInOrderDrawBuffer::initCopySurfaceDstDesc(const GrSurface* src, GrTextureDesc* desc) {
     fDstGpu->initCopySurfaceDstDesc(src, desc);
 }
@@ -948,7 +1223,20 @@ void GrInOrderDrawBuffer::recordClip() {
 }
 
 void GrInOrderDrawBuffer::recordState() {
-    fStates.push_back().saveFrom(this->getDrawState());
+    const GrDrawState& drawState = this->getDrawState();
+    StateKey* key = fStateKeys.append();
+    key->fKey = fStates.count();
+    key->fRenderTarget = drawState.getRenderTarget();
+    key->fCanReorder = drawState.getStencil().isDisabled();
+    // Look for a recent state we could share a batch with when flushing.
+    int stop = SkTMax(0, fStates.count() - kStateKeyLookback);
+    for (int s = fStates.count() - 1; s >= stop; --s) {
+        if (fStates[s].isEqual(drawState)) {
+            key->fKey = fStateKeys[s].fKey;
+            break;
+        }
+    }
+    fStates.push_back().saveFrom(drawState);
     this->addToCmdBuffer(kSetState_Cmd);
 }
 
@@ -14,6 +14,7 @@
 #include "GrPath.h"
 
 #include "SkClipStack.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
 #include "SkTypes.h"
 
@@ -184,21 +185,33 @@ private:
                                   GrSurface* src,
                                   const SkIRect& srcRect,
                                   const SkIPoint& dstPoint) SK_OVERRIDE;
+    virtual bool onSetupDstCopy(GrRenderTarget* rt,
+                                const SkIRect& copyRect,
+                                GrDeviceCoordTexture* dstCopy) SK_OVERRIDE;
 
     bool quickInsideClip(const SkRect& devBounds);
 
-    virtual void didAddGpuTraceMarker() SK_OVERRIDE {}
-    virtual void didRemoveGpuTraceMarker() SK_OVERRIDE {}
+    virtual void didAddGpuTraceMarker(const GrGpuTraceMarker&) SK_OVERRIDE {}
+    virtual void didRemoveGpuTraceMarker(const GrGpuTraceMarker&) SK_OVERRIDE {}
 
     // Attempts to concat instances from info onto the previous draw. info must represent an
     // instanced draw. The caller must have already recorded a new draw state and clip if necessary.
     int concatInstancedDraw(const DrawInfo& info);
+    // Attempts to append the instances of a hardware instanced draw to the previous draw. Returns
+    // true if it did, in which case info needs no draw of its own.
+    bool concatHWInstancedDraw(const DrawInfo& info);
 
     // we lazily record state and clip changes in order to skip clips and states that have no
     // effect.
     bool needsNewState() const;
     bool needsNewClip() const;
 
+    // Fills items with the index of each command's record in its allocator and order with the
+    // commands to play back. Runs of draws and state changes are regrouped so that a draw whose
+    // device bounds don't overlap any draw it is moved past joins an earlier draw with an equal
+    // state. Other commands are kept in place.
+    void orderCommands(SkTDArray<int>* items, SkTDArray<int>* order);
+
     // these functions record a command
     void            recordState();
     void            recordClip();
@@ -235,7 +248,28 @@ private:
     GrSTAllocator<kClipPreallocCnt, SkIPoint>                          fClipOrigins;
     SkTArray<GrTraceMarkerSet, false>                                  fGpuCmdMarkers;
 
-    GrDrawTarget*                   fDstGpu;
+    // Parallel to fStates. States that compare equal when recorded share a key. Draws that
+    // touch the stencil buffer are never reordered.
+    struct StateKey {
+        int                     fKey;
+        const GrRenderTarget*   fRenderTarget;
+        bool                    fCanReorder;
+    };
+    SkTDArray<StateKey>                                                fStateKeys;
+
+    GrGpu*                          fDstGpu;
+
+    // Draws that read the dst share one copy of the render target's clip bounds until the buffer
+    // is flushed. Before a draw reads it, the parts of the render target that were drawn to since
+    // it was last brought up to date are copied again.
+    void releaseDstCopy();
+    void markDstCopyDirty(const GrRenderTarget* rt, const SkIRect& rect);
+    void markDstCopyDirty(const GrRenderTarget* rt, const SkRect* devBounds);
+
+    SkAutoTUnref<GrRenderTarget>    fDstCopyRT;
+    GrAutoScratchTexture            fDstCopy;
+    SkIRect                         fDstCopyBounds; // area of fDstCopyRT that fDstCopy holds
+    SkIRect                         fDstCopyDirty;  // area of fDstCopyRT drawn since last copied
 
     bool                            fClipSet;
 
@@ -271,6 +305,8 @@ private:
     bool                            fFlushing;
     uint32_t                        fDrawID;
 
+    friend class GrInOrderDrawBufferTester; // for unit testing
+
     typedef GrDrawTarget INHERITED;
 };
 
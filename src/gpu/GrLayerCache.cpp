@@ -6,6 +6,7 @@
  */
 
 #include "GrAtlas.h"
+#include "GrContext.h"
 #include "GrGpu.h"
 #include "GrLayerCache.h"
 
@@ -42,11 +43,11 @@ private:
 };
 
 GrLayerCache::GrLayerCache(GrGpu* gpu)
-    : fGpu(SkRef(gpu))
-    , fLayerPool(16) {      // TODO: may need to increase this later
+    : fGpu(SkRef(gpu)) {
 }
 
 GrLayerCache::~GrLayerCache() {
+    this->freeAll();
 }
 
 void GrLayerCache::init() {
@@ -55,22 +56,23 @@ void GrLayerCache::init() {
 
     SkASSERT(NULL == fAtlasMgr.get());
 
-    // The layer cache only gets 1 plot
+    // The layer cache only gets 1 plot. The layers are rendered straight into it. Layers come
+    // and go with their pictures so the plot frees their space individually.
     SkISize textureSize = SkISize::Make(kAtlasTextureWidth, kAtlasTextureHeight);
     fAtlasMgr.reset(SkNEW_ARGS(GrAtlasMgr, (fGpu, kSkia8888_GrPixelConfig,
-                                            textureSize, 1, 1, false)));
+                                            textureSize, 1, 1, false, 1,
+                                            kRenderTarget_GrTextureFlagBit, true)));
 }
 
 void GrLayerCache::freeAll() {
     fLayerHash.deleteAll();
     fAtlasMgr.free();
+    fPlotUsage = GrAtlas();
 }
 
 GrCachedLayer* GrLayerCache::createLayer(const SkPicture* picture, int layerID) {
-    GrCachedLayer* layer = fLayerPool.alloc();
-
     SkASSERT(picture->uniqueID() != SK_InvalidGenID);
-    layer->init(picture->uniqueID(), layerID);
+    GrCachedLayer* layer = SkNEW_ARGS(GrCachedLayer, (picture->uniqueID(), layerID));
     fLayerHash.insert(PictureLayerKey(picture->uniqueID(), layerID), layer);
     return layer;
 }
@@ -84,3 +86,99 @@ GrCachedLayer* GrLayerCache::findLayerOrCreate(const SkPicture* picture, int lay
     }
     return layer;
 }
+
+bool GrLayerCache::allocateInAtlas(GrCachedLayer* layer, const GrTextureDesc& desc) {
+    if (NULL == fAtlasMgr.get()) {
+        this->init();
+    }
+
+    SkIPoint16 loc;
+    GrPlot* plot = fAtlasMgr->addToAtlas(&fPlotUsage, desc.fWidth, desc.fHeight, NULL, &loc);
+    if (NULL == plot) {
+        return false;
+    }
+
+    GrIRect16 bounds;
+    bounds.set(SkIRect::MakeXYWH(loc.fX, loc.fY, desc.fWidth, desc.fHeight));
+    layer->setLocation(plot, bounds);
+    layer->setTexture(SkRef(plot->texture()),
+                      SkIRect::MakeXYWH(loc.fX, loc.fY, desc.fWidth, desc.fHeight));
+    return true;
+}
+
+static GrCacheID layer_cache_id(uint32_t pictureID, int layerID) {
+    static const GrCacheID::Domain gLayerDomain = GrCacheID::GenerateDomain();
+
+    GrCacheID::Key key;
+    memset(&key, 0, sizeof(key));
+    key.fData32[0] = pictureID;
+    key.fData32[1] = layerID;
+    return GrCacheID(gLayerDomain, key);
+}
+
+bool GrLayerCache::lock(GrCachedLayer* layer, const GrTextureDesc& desc, bool allowAtlas) {
+    if (layer->isAtlased()) {
+        // the contents were rendered when the space was allocated
+        return true;
+    }
+
+    if (allowAtlas && this->allocateInAtlas(layer, desc)) {
+        return false;
+    }
+
+    GrContext* context = fGpu->getContext();
+    GrCacheID cacheID = layer_cache_id(layer->pictureID(), layer->layerID());
+    SkIRect rect = SkIRect::MakeWH(desc.fWidth, desc.fHeight);
+
+    GrTexture* texture = context->findAndRefTexture(desc, cacheID, NULL);
+    if (NULL != texture) {
+        layer->setTexture(texture, rect);
+        return true;
+    }
+
+    // The contents will be rendered straight away and the texture can be found again
+    // on the next draw unless the resource cache purges it in the meantime.
+    texture = context->createTexture(NULL, desc, cacheID, NULL, 0);
+    layer->setTexture(texture, NULL != texture ? rect : SkIRect::MakeEmpty());
+    return false;
+}
+
+void GrLayerCache::unlock(GrCachedLayer* layer) {
+    if (!layer->isAtlased()) {
+        layer->setTexture(NULL, SkIRect::MakeEmpty());
+    }
+}
+
+void GrLayerCache::freeAtlasLocation(GrCachedLayer* layer) {
+    SkASSERT(layer->isAtlased());
+
+    const GrAtlasLocation& location = layer->location();
+    for (int i = 0; i < fPlotUsage.numPlots(); ++i) {
+        GrPlot* plot = fPlotUsage.plot(i);
+        if (plot == location.plot()) {
+            SkIPoint16 loc;
+            loc.set(location.bounds().fLeft, location.bounds().fTop);
+            SkAssertResult(plot->freeSubImage(location.bounds().width(),
+                                              location.bounds().height(),
+                                              loc));
+            break;
+        }
+    }
+    layer->setLocation(NULL, GrIRect16::MakeEmpty());
+}
+
+void GrLayerCache::purge(const SkPicture* picture) {
+    SkTDArray<GrCachedLayer*>& layers = fLayerHash.getArray();
+
+    for (int i = layers.count() - 1; i >= 0; --i) {
+        GrCachedLayer* layer = layers[i];
+        if (layer->pictureID() != picture->uniqueID()) {
+            continue;
+        }
+        if (layer->isAtlased()) {
+            this->freeAtlasLocation(layer);
+        }
+        fLayerHash.remove(PictureLayerKey(layer->pictureID(), layer->layerID()), layer);
+        SkDELETE(layer);
+    }
+}
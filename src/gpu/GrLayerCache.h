@@ -8,14 +8,12 @@
 #ifndef GrLayerCache_DEFINED
 #define GrLayerCache_DEFINED
 
-#include "GrAllocPool.h"
+#include "GrAtlas.h"
 #include "GrTHashTable.h"
 #include "GrPictureUtils.h"
 #include "GrRect.h"
 
-class GrAtlasMgr;
 class GrGpu;
-class GrPlot;
 class SkPicture;
 
 // GrAtlasLocation captures an atlased item's position in the atlas. This
@@ -46,44 +44,59 @@ private:
 // GrCachedLayer encapsulates the caching information for a single saveLayer.
 //
 // Atlased layers get a ref to their atlas GrTexture and their GrAtlasLocation
-// is filled in.
+// is filled in. Their contents stay in the atlas until the layer is purged.
 // In this case GrCachedLayer is roughly equivalent to a GrGlyph in the font
 // caching system.
 //
-// Non-atlased layers get a ref to the GrTexture in which they reside.
-// TODO: can we easily reuse the empty space in the non-atlased GrTexture's?
+// Non-atlased layers are kept in a GrTexture of their own that lives in the
+// resource cache under a key made from the layer's IDs, so they are found
+// again on later draws unless the cache purged them in the meantime. The
+// layer only holds a ref to that texture while it is locked.
 struct GrCachedLayer {
 public:
-    uint32_t pictureID() const { return fPictureID; }
-    int layerID() const { return fLayerID; }
+    GrCachedLayer(uint32_t pictureID, int layerID)
+        : fPictureID(pictureID)
+        , fLayerID(layerID)
+        , fTexture(NULL) {
+        fRect.setEmpty();
+    }
 
-    void init(uint32_t pictureID, int layerID) {
-        fPictureID = pictureID;
-        fLayerID   = layerID;
-        fTexture   = NULL;
-        fLocation.set(NULL, GrIRect16::MakeEmpty());
+    ~GrCachedLayer() {
+        SkSafeUnref(fTexture);
     }
 
+    uint32_t pictureID() const { return fPictureID; }
+    int layerID() const { return fLayerID; }
+
     // This call takes over the caller's ref
-    void setTexture(GrTexture* texture) {
+    void setTexture(GrTexture* texture, const SkIRect& rect) {
         if (NULL != fTexture) {
             fTexture->unref();
         }
 
         fTexture = texture; // just take over caller's ref
+        fRect = rect;
     }
     GrTexture* getTexture() { return fTexture; }
 
+    // The bounds of the layer's contents in its texture.
+    const SkIRect& rect() const { return fRect; }
+
+    void setLocation(GrPlot* plot, const GrIRect16& bounds) { fLocation.set(plot, bounds); }
+    const GrAtlasLocation& location() const { return fLocation; }
+    bool isAtlased() const { return NULL != fLocation.plot(); }
+
 private:
     uint32_t        fPictureID;
     // fLayerID is only valid when fPicture != kInvalidGenID in which case it
     // is the index of this layer in the picture (one of 0 .. #layers).
     int             fLayerID;
 
-    // fTexture is a ref on the atlasing texture for atlased layers and a
-    // ref on a GrTexture for non-atlased textures. In both cases, if this is
-    // non-NULL, that means that the texture is locked in the texture cache.
+    // fTexture is a ref on the atlasing texture for atlased layers and,
+    // while the layer is locked, a ref on the layer's own GrTexture for
+    // non-atlased layers.
     GrTexture*      fTexture;
+    SkIRect         fRect;
 
     GrAtlasLocation fLocation;       // only valid if the layer is atlased
 };
@@ -104,16 +117,39 @@ public:
 
     GrCachedLayer* findLayerOrCreate(const SkPicture* picture, int id);
 
+    // Gives the layer a texture to draw from. The layer goes in the atlas if
+    // allowAtlas is set and it fits, and in a texture of its own otherwise.
+    // Returns true if the texture already holds the layer's contents from an
+    // earlier draw. Returns false if the caller has to render the contents
+    // into layer->rect() of layer->getTexture(), or if no texture could be
+    // had, in which case layer->getTexture() is NULL.
+    bool lock(GrCachedLayer* layer, const GrTextureDesc& desc, bool allowAtlas);
+
+    // Releases the layer's ref on a texture of its own, leaving the texture
+    // in the resource cache for later draws. Atlased layers keep their place.
+    void unlock(GrCachedLayer* layer);
+
+    // Drops all of the picture's layers, freeing their atlas space.
+    void purge(const SkPicture* picture);
+
+    // The bytes of the atlas texture. Layers with textures of their own keep
+    // them in the resource cache.
+    size_t gpuMemorySize() const {
+        return NULL != fAtlasMgr.get() ? fAtlasMgr->gpuMemorySize() : 0;
+    }
+
 private:
     SkAutoTUnref<GrGpu>       fGpu;
     SkAutoTDelete<GrAtlasMgr> fAtlasMgr; // TODO: could lazily allocate
+    GrAtlas                   fPlotUsage;
 
     class PictureLayerKey;
     GrTHashTable<GrCachedLayer, PictureLayerKey, 7> fLayerHash;
-    GrTAllocPool<GrCachedLayer> fLayerPool;
 
     void init();
     GrCachedLayer* createLayer(const SkPicture* picture, int id);
+    bool allocateInAtlas(GrCachedLayer* layer, const GrTextureDesc& desc);
+    void freeAtlasLocation(GrCachedLayer* layer);
 
 };
 
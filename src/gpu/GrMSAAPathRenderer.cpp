@@ -0,0 +1,140 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrMSAAPathRenderer.h"
+#include "GrContext.h"
+#include "GrDefaultPathRenderer.h"
+#include "GrDrawTargetCaps.h"
+#include "GrGpu.h"
+#include "GrSWMaskHelper.h"
+#include "SkStrokeRec.h"
+
+// Fewer samples than this don't give acceptable AA quality.
+static const int kMaskSampleCnt = 4;
+
+GrPathRenderer* GrMSAAPathRenderer::Create(GrContext* context) {
+    SkASSERT(NULL != context);
+    SkASSERT(NULL != context->getGpu());
+    if (context->getGpu()->caps()->maxSampleCount() < kMaskSampleCnt) {
+        return NULL;
+    }
+    // We would always like A8 but it isn't supported on all platforms
+    if (context->isConfigRenderable(kAlpha_8_GrPixelConfig, true)) {
+        return SkNEW_ARGS(GrMSAAPathRenderer, (context, kAlpha_8_GrPixelConfig));
+    } else if (context->isConfigRenderable(kSkia8888_GrPixelConfig, true)) {
+        return SkNEW_ARGS(GrMSAAPathRenderer, (context, kSkia8888_GrPixelConfig));
+    }
+    return NULL;
+}
+
+GrMSAAPathRenderer::GrMSAAPathRenderer(GrContext* context, GrPixelConfig maskConfig)
+    : fContext(context)
+    , fMaskConfig(maskConfig) {
+    const GrDrawTargetCaps* caps = context->getGpu()->caps();
+    fDefaultRenderer = SkNEW_ARGS(GrDefaultPathRenderer, (context,
+                                                          caps->twoSidedStencilSupport(),
+                                                          caps->stencilWrapOpsSupport()));
+}
+
+GrMSAAPathRenderer::~GrMSAAPathRenderer() {
+    fDefaultRenderer->unref();
+}
+
+bool GrMSAAPathRenderer::canDrawPath(const SkPath& path,
+                                     const SkStrokeRec& stroke,
+                                     const GrDrawTarget* target,
+                                     bool antiAlias) const {
+    // Strokes get here again as fills once the chain has found no one to draw them. Inverse fills
+    // are left to the software renderer.
+    return antiAlias &&
+           stroke.isFillStyle() &&
+           !path.isInverseFillType() &&
+           !target->getDrawState().getRenderTarget()->isMultisampled();
+}
+
+GrPathRenderer::StencilSupport GrMSAAPathRenderer::onGetStencilSupport(
+                                                        const SkPath&,
+                                                        const SkStrokeRec&,
+                                                        const GrDrawTarget*) const {
+    return GrPathRenderer::kNoSupport_StencilSupport;
+}
+
+namespace {
+
+// Gets the device bounds of the path that can be affected by the draw, i.e. limited to the
+// render target and the clip. Returns false if they are empty.
+bool get_path_dev_bounds(const GrDrawTarget* target,
+                         const SkPath& path,
+                         const SkMatrix& matrix,
+                         SkIRect* devPathBounds) {
+    const GrRenderTarget* rt = target->getDrawState().getRenderTarget();
+    if (NULL == rt) {
+        return false;
+    }
+
+    // getConservativeBounds already intersects with the render target's bounds
+    target->getClip()->getConservativeBounds(rt, devPathBounds);
+
+    SkRect pathSBounds;
+    matrix.mapRect(&pathSBounds, path.getBounds());
+    SkIRect pathIBounds;
+    pathSBounds.roundOut(&pathIBounds);
+    return devPathBounds->intersect(pathIBounds);
+}
+
+}
+
+bool GrMSAAPathRenderer::onDrawPath(const SkPath& path,
+                                    const SkStrokeRec& stroke,
+                                    GrDrawTarget* target,
+                                    bool antiAlias) {
+    SkMatrix vm = target->getDrawState().getViewMatrix();
+
+    SkIRect devPathBounds;
+    if (!get_path_dev_bounds(target, path, vm, &devPathBounds)) {
+        // nothing to draw
+        return true;
+    }
+
+    GrTextureDesc desc;
+    desc.fFlags = kRenderTarget_GrTextureFlagBit;
+    desc.fWidth = devPathBounds.width();
+    desc.fHeight = devPathBounds.height();
+    desc.fConfig = fMaskConfig;
+    desc.fSampleCnt = kMaskSampleCnt;
+
+    GrAutoScratchTexture ast(fContext, desc);
+    // The target may only draw with the mask after we return, keep it locked until it is done.
+    SkAutoTUnref<GrTexture> mask(ast.detach());
+    if (NULL == mask) {
+        return false;
+    }
+
+    {
+        // Render the path so that the top-left of its device bounds lands on the mask's origin.
+        SkMatrix maskMatrix;
+        maskMatrix.setTranslate(SkIntToScalar(-devPathBounds.fLeft),
+                                SkIntToScalar(-devPathBounds.fTop));
+        maskMatrix.preConcat(vm);
+
+        // The reset state has no clip, no stencil and draws opaque white with full coverage.
+        GrDrawTarget::AutoStateRestore asr(target, GrDrawTarget::kReset_ASRInit, &maskMatrix);
+        GrRenderTarget* maskRT = mask->asRenderTarget();
+        target->drawState()->setRenderTarget(maskRT);
+
+        target->clear(NULL, 0x00000000, true, maskRT);
+
+        SkASSERT(fDefaultRenderer->canDrawPath(path, stroke, target, false));
+        if (!fDefaultRenderer->drawPath(path, stroke, target, false)) {
+            return false;
+        }
+    }
+
+    // Sampling the mask resolves it.
+    GrSWMaskHelper::DrawToTargetWithPathMask(mask, target, devPathBounds);
+    return true;
+}
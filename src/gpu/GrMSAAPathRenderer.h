@@ -0,0 +1,57 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrMSAAPathRenderer_DEFINED
+#define GrMSAAPathRenderer_DEFINED
+
+#include "GrPathRenderer.h"
+
+class GrContext;
+class GrDefaultPathRenderer;
+
+/**
+ * Anti-aliases paths that no coverage AA renderer can draw (e.g. concave fills) without going
+ * through GrSoftwarePathRenderer. The path is stenciled and covered by GrDefaultPathRenderer into a
+ * multisampled mask texture. Resolving the mask turns the samples each pixel has covered into its
+ * coverage, and the mask is then applied to the draw like a software mask. Only used when the
+ * target itself isn't multisampled, otherwise GrDefaultPathRenderer draws to it directly.
+ */
+class GrMSAAPathRenderer : public GrPathRenderer {
+public:
+    /**
+     * Returns NULL if the GPU can't render to a multisampled mask texture.
+     */
+    static GrPathRenderer* Create(GrContext*);
+
+    virtual ~GrMSAAPathRenderer();
+
+    virtual bool canDrawPath(const SkPath&,
+                             const SkStrokeRec&,
+                             const GrDrawTarget*,
+                             bool antiAlias) const SK_OVERRIDE;
+
+protected:
+    virtual StencilSupport onGetStencilSupport(const SkPath&,
+                                               const SkStrokeRec&,
+                                               const GrDrawTarget*) const SK_OVERRIDE;
+
+    virtual bool onDrawPath(const SkPath&,
+                            const SkStrokeRec&,
+                            GrDrawTarget*,
+                            bool antiAlias) SK_OVERRIDE;
+
+private:
+    GrMSAAPathRenderer(GrContext*, GrPixelConfig maskConfig);
+
+    GrContext*              fContext;
+    GrPixelConfig           fMaskConfig;
+    GrDefaultPathRenderer*  fDefaultRenderer;
+
+    typedef GrPathRenderer INHERITED;
+};
+
+#endif
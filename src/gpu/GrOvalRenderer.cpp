@@ -16,6 +16,7 @@
 #include "GrDrawState.h"
 #include "GrDrawTarget.h"
 #include "GrGpu.h"
+#include "GrVertexBuffer.h"
 
 #include "SkRRect.h"
 #include "SkStrokeRec.h"
@@ -40,6 +41,15 @@ struct EllipseVertex {
     SkPoint  fInnerRadii;
 };
 
+struct EllipseInstance {
+    SkPoint  fUnused;       // the position attribute's slot, positions come from the unit geometry
+    SkPoint  fCenter;
+    SkPoint  fRadii;
+    GrColor  fColor;
+};
+
+static const int kVertsPerInstancedEllipse = 4;
+
 struct DIEllipseVertex {
     SkPoint  fPos;
     SkPoint  fOuterOffset;
@@ -449,11 +459,116 @@ GrEffectRef* DIEllipseEdgeEffect::TestCreate(SkRandom* random,
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Draws a filled, axis-aligned ellipse from a unit quad drawn with hardware instancing. The
+ * per-instance attribute holds the ellipse's device space center and radii; the vertex shader
+ * scales the unit quad to cover the ellipse and the coverage is computed as in EllipseEdgeEffect.
+ */
+
+class InstancedEllipseEffect : public GrVertexEffect {
+public:
+    static GrEffectRef* Create() {
+        GR_CREATE_STATIC_EFFECT(gInstancedEllipse, InstancedEllipseEffect, ());
+        gInstancedEllipse->ref();
+        return gInstancedEllipse;
+    }
+
+    virtual void getConstantColorComponents(GrColor* color,
+                                            uint32_t* validFlags) const SK_OVERRIDE {
+        *validFlags = 0;
+    }
+
+    virtual const GrBackendEffectFactory& getFactory() const SK_OVERRIDE {
+        return GrTBackendEffectFactory<InstancedEllipseEffect>::getInstance();
+    }
+
+    virtual ~InstancedEllipseEffect() {}
+
+    static const char* Name() { return "InstancedEllipse"; }
+
+    class GLEffect : public GrGLVertexEffect {
+    public:
+        GLEffect(const GrBackendEffectFactory& factory, const GrDrawEffect&)
+        : INHERITED (factory) {}
+
+        virtual void emitCode(GrGLFullShaderBuilder* builder,
+                              const GrDrawEffect& drawEffect,
+                              EffectKey key,
+                              const char* outputColor,
+                              const char* inputColor,
+                              const TransformedCoordsArray&,
+                              const TextureSamplerArray& samplers) SK_OVERRIDE {
+            const char* unitPos = builder->positionAttribute().c_str();
+            const SkString* ellipseName =
+                builder->getEffectAttributeName(drawEffect.getVertexAttribIndices()[0]);
+
+            const char *vsOffsetName, *fsOffsetName;
+            const char *vsRadiiName, *fsRadiiName;
+
+            // The quad is outset by half a pixel to capture all the partially covered pixels.
+            builder->addVarying(kVec2f_GrSLType, "EllipseOffsets", &vsOffsetName, &fsOffsetName);
+            builder->vsCodeAppendf("\t%s = %s * (%s.zw + 0.5);\n",
+                                   vsOffsetName, unitPos, ellipseName->c_str());
+            builder->vsCodeAppendf("\tvec2 devPos = %s.xy + %s;\n",
+                                   ellipseName->c_str(), vsOffsetName);
+            builder->setPosition("devPos");
+
+            builder->addVarying(kVec2f_GrSLType, "EllipseRadii", &vsRadiiName, &fsRadiiName);
+            builder->vsCodeAppendf("\t%s = 1.0 / %s.zw;\n", vsRadiiName, ellipseName->c_str());
+
+            builder->fsCodeAppendf("\tvec2 scaledOffset = %s*%s;\n", fsOffsetName, fsRadiiName);
+            builder->fsCodeAppend("\tfloat test = dot(scaledOffset, scaledOffset) - 1.0;\n");
+            builder->fsCodeAppendf("\tvec2 grad = 2.0*scaledOffset*%s;\n", fsRadiiName);
+            builder->fsCodeAppend("\tfloat grad_dot = dot(grad, grad);\n");
+            // avoid calling inversesqrt on zero.
+            builder->fsCodeAppend("\tgrad_dot = max(grad_dot, 1.0e-4);\n");
+            builder->fsCodeAppend("\tfloat invlen = inversesqrt(grad_dot);\n");
+            builder->fsCodeAppend("\tfloat edgeAlpha = clamp(0.5-test*invlen, 0.0, 1.0);\n");
+
+            builder->fsCodeAppendf("\t%s = %s;\n", outputColor,
+                                   (GrGLSLExpr4(inputColor) * GrGLSLExpr1("edgeAlpha")).c_str());
+        }
+
+        static inline EffectKey GenKey(const GrDrawEffect& drawEffect, const GrGLCaps&) {
+            return 0;
+        }
+
+        virtual void setData(const GrGLUniformManager&, const GrDrawEffect&) SK_OVERRIDE {
+        }
+
+    private:
+        typedef GrGLVertexEffect INHERITED;
+    };
+
+private:
+    InstancedEllipseEffect() : GrVertexEffect() {
+        this->addVertexAttrib(kVec4f_GrSLType);
+    }
+
+    virtual bool onIsEqual(const GrEffect& other) const SK_OVERRIDE { return true; }
+
+    GR_DECLARE_EFFECT_TEST;
+
+    typedef GrVertexEffect INHERITED;
+};
+
+GR_DEFINE_EFFECT_TEST(InstancedEllipseEffect);
+
+GrEffectRef* InstancedEllipseEffect::TestCreate(SkRandom* random,
+                                                GrContext* context,
+                                                const GrDrawTargetCaps&,
+                                                GrTexture* textures[]) {
+    return InstancedEllipseEffect::Create();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 void GrOvalRenderer::reset() {
     SkSafeSetNull(fRRectIndexBuffer);
+    SkSafeSetNull(fEllipseUnitGeometry);
 }
 
-bool GrOvalRenderer::drawOval(GrDrawTarget* target, const GrContext* context, bool useAA,
+bool GrOvalRenderer::drawOval(GrDrawTarget* target, GrContext* context, bool useAA,
                               const SkRect& oval, const SkStrokeRec& stroke)
 {
     bool useCoverageAA = useAA &&
@@ -466,6 +581,12 @@ bool GrOvalRenderer::drawOval(GrDrawTarget* target, const GrContext* context, bo
 
     const SkMatrix& vm = context->getMatrix();
 
+    // filled circles and axis-aligned ellipses batch when the target can instance them
+    if (stroke.isFillStyle() && vm.rectStaysRect() &&
+        this->instancedFillEllipse(context->getGpu(), target, oval)) {
+        return true;
+    }
+
     // we can draw circles
     if (SkScalarNearlyEqual(oval.width(), oval.height())
         && circle_stays_circle(vm)) {
@@ -485,6 +606,99 @@ bool GrOvalRenderer::drawOval(GrDrawTarget* target, const GrContext* context, bo
 
 ///////////////////////////////////////////////////////////////////////////////
 
+GrVertexBuffer* GrOvalRenderer::ellipseUnitGeometry(GrGpu* gpu) {
+    static const SkPoint gUnitQuad[kVertsPerInstancedEllipse] = {
+        { -1, -1 }, { 1, -1 }, { -1, 1 }, { 1, 1 }
+    };
+
+    if (NULL == fEllipseUnitGeometry) {
+        fEllipseUnitGeometry = gpu->createVertexBuffer(sizeof(gUnitQuad), false);
+        if (NULL != fEllipseUnitGeometry &&
+            !fEllipseUnitGeometry->updateData(gUnitQuad, sizeof(gUnitQuad))) {
+            SkSafeSetNull(fEllipseUnitGeometry);
+        }
+    }
+    return fEllipseUnitGeometry;
+}
+
+// unused position + center and radii + color
+extern const GrVertexAttrib gEllipseInstanceAttribs[] = {
+    {kVec2f_GrVertexAttribType,  0,                 kPosition_GrVertexAttribBinding},
+    {kVec4f_GrVertexAttribType,  sizeof(SkPoint),   kEffect_GrVertexAttribBinding},
+    {kVec4ub_GrVertexAttribType, 3*sizeof(SkPoint), kColor_GrVertexAttribBinding}
+};
+
+bool GrOvalRenderer::instancedFillEllipse(GrGpu* gpu,
+                                          GrDrawTarget* target,
+                                          const SkRect& ellipse)
+{
+    if (!target->canDrawHWInstances()) {
+        return false;
+    }
+
+    GrDrawState* drawState = target->drawState();
+    const SkMatrix& vm = drawState->getViewMatrix();
+    SkASSERT(vm.rectStaysRect());
+
+    SkPoint center = SkPoint::Make(ellipse.centerX(), ellipse.centerY());
+    vm.mapPoints(&center, 1);
+    SkScalar ellipseXRadius = SkScalarHalf(ellipse.width());
+    SkScalar ellipseYRadius = SkScalarHalf(ellipse.height());
+    SkScalar xRadius = SkScalarAbs(vm[SkMatrix::kMScaleX]*ellipseXRadius +
+                                   vm[SkMatrix::kMSkewY]*ellipseYRadius);
+    SkScalar yRadius = SkScalarAbs(vm[SkMatrix::kMSkewX]*ellipseXRadius +
+                                   vm[SkMatrix::kMScaleY]*ellipseYRadius);
+    // the shader takes the reciprocals of the radii
+    if (SkScalarNearlyZero(xRadius) || SkScalarNearlyZero(yRadius)) {
+        return false;
+    }
+
+    GrVertexBuffer* unitGeometry = this->ellipseUnitGeometry(gpu);
+    if (NULL == unitGeometry) {
+        return false;
+    }
+
+    GrColor color = drawState->getColor();
+
+    GrDrawState::AutoViewMatrixRestore avmr;
+    if (!avmr.setIdentity(drawState)) {
+        return false;
+    }
+
+    drawState->setVertexAttribs<gEllipseInstanceAttribs>(SK_ARRAY_COUNT(gEllipseInstanceAttribs));
+    SkASSERT(sizeof(EllipseInstance) == drawState->getVertexSize());
+
+    GrDrawTarget::AutoReleaseGeometry geo(target, 1, 0);
+    if (!geo.succeeded()) {
+        GrPrintf("Failed to get space for vertices!\n");
+        return false;
+    }
+
+    EllipseInstance* instance = reinterpret_cast<EllipseInstance*>(geo.vertices());
+    instance->fUnused.set(0, 0);
+    instance->fCenter = center;
+    instance->fRadii.set(xRadius, yRadius);
+    instance->fColor = color;
+
+    // The color comes from the instance so that ovals of different colors can share a draw.
+    GrDrawState::AutoColorRestore acr(drawState, GrColorPackRGBA(0xff, 0xff, 0xff, 0xff));
+    static const int kEllipseAttrIndex = 1;
+    drawState->addCoverageEffect(InstancedEllipseEffect::Create(), kEllipseAttrIndex)->unref();
+
+    SkRect bounds = SkRect::MakeLTRB(
+        center.fX - xRadius - SK_ScalarHalf,
+        center.fY - yRadius - SK_ScalarHalf,
+        center.fX + xRadius + SK_ScalarHalf,
+        center.fY + yRadius + SK_ScalarHalf
+    );
+
+    target->drawHWInstances(kTriangleStrip_GrPrimitiveType, unitGeometry,
+                            kVertsPerInstancedEllipse, 1, &bounds);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 // position + edge
 extern const GrVertexAttrib gCircleVertexAttribs[] = {
     {kVec2f_GrVertexAttribType, 0,               kPosition_GrVertexAttribBinding},
@@ -14,6 +14,7 @@
 class GrContext;
 class GrDrawTarget;
 class GrPaint;
+class GrVertexBuffer;
 struct SkRect;
 class SkStrokeRec;
 
@@ -24,14 +25,14 @@ class GrOvalRenderer : public SkRefCnt {
 public:
     SK_DECLARE_INST_COUNT(GrOvalRenderer)
 
-    GrOvalRenderer() : fRRectIndexBuffer(NULL) {}
+    GrOvalRenderer() : fRRectIndexBuffer(NULL), fEllipseUnitGeometry(NULL) {}
     ~GrOvalRenderer() {
         this->reset();
     }
 
     void reset();
 
-    bool drawOval(GrDrawTarget* target, const GrContext* context, bool useAA,
+    bool drawOval(GrDrawTarget* target, GrContext* context, bool useAA,
                   const SkRect& oval, const SkStrokeRec& stroke);
     bool drawRRect(GrDrawTarget* target, GrContext* context, bool useAA,
                    const SkRRect& rrect, const SkStrokeRec& stroke);
@@ -48,10 +49,16 @@ private:
     void drawCircle(GrDrawTarget* target, bool useCoverageAA,
                     const SkRect& circle,
                     const SkStrokeRec& stroke);
+    // Draws a filled, axis-aligned ellipse as one instance of a static unit quad so that
+    // consecutive ovals batch into a single draw. Returns false if the target can't draw it this
+    // way.
+    bool instancedFillEllipse(GrGpu* gpu, GrDrawTarget* target, const SkRect& ellipse);
 
     GrIndexBuffer* rRectIndexBuffer(GrGpu* gpu);
+    GrVertexBuffer* ellipseUnitGeometry(GrGpu* gpu);
 
     GrIndexBuffer* fRRectIndexBuffer;
+    GrVertexBuffer* fEllipseUnitGeometry;
 
     typedef SkRefCnt INHERITED;
 };
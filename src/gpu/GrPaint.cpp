@@ -56,6 +56,11 @@ bool GrPaint::getOpaqueAndKnownColor(GrColor* solidColor,
 
     // TODO: Share this implementation with GrDrawState
 
+    // The advanced equations always combine the src with the dst.
+    if (GrBlendEquationIsAdvanced(fBlendEquation)) {
+        return false;
+    }
+
     GrColor coverage = GrColorPackRGBA(fCoverage, fCoverage, fCoverage, fCoverage);
     uint32_t coverageComps = kRGBA_GrColorComponentFlags;
     int count = fCoverageStages.count();
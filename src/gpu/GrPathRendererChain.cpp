@@ -82,6 +82,6 @@ void GrPathRendererChain::init() {
     bool wrapOp = gpu->caps()->stencilWrapOpsSupport();
     GrPathRenderer::AddPathRenderers(fOwner, this);
     this->addPathRenderer(SkNEW_ARGS(GrDefaultPathRenderer,
-                                     (twoSided, wrapOp)))->unref();
+                                     (fOwner, twoSided, wrapOp)))->unref();
     fInit = true;
 }
@@ -33,9 +33,12 @@ SkScalar GrPathUtils::scaleToleranceToSrc(SkScalar devTol,
     return srcTol;
 }
 
-static const int MAX_POINTS_PER_CURVE = 1 << 10;
+// Curves are never flattened into more than 1 << kMaxPointsPerCurveShift lines.
+static const int kMaxPointsPerCurveShift = 10;
 static const SkScalar gMinCurveTol = 0.0001f;
 
+// The counts come from the same Wang's formula bound the software rasterizer
+// uses (see SkQuadSubdivisionShift), so both backends facet curves alike.
 uint32_t GrPathUtils::quadraticPointCount(const SkPoint points[],
                                           SkScalar tol) {
     if (tol < gMinCurveTol) {
@@ -43,24 +46,7 @@ uint32_t GrPathUtils::quadraticPointCount(const SkPoint points[],
     }
     SkASSERT(tol > 0);
 
-    SkScalar d = points[1].distanceToLineSegmentBetween(points[0], points[2]);
-    if (d <= tol) {
-        return 1;
-    } else {
-        // Each time we subdivide, d should be cut in 4. So we need to
-        // subdivide x = log4(d/tol) times. x subdivisions creates 2^(x)
-        // points.
-        // 2^(log4(x)) = sqrt(x);
-        int temp = SkScalarCeilToInt(SkScalarSqrt(SkScalarDiv(d, tol)));
-        int pow2 = GrNextPow2(temp);
-        // Because of NaNs & INFs we can wind up with a degenerate temp
-        // such that pow2 comes out negative. Also, our point generator
-        // will always output at least one pt.
-        if (pow2 < 1) {
-            pow2 = 1;
-        }
-        return SkTMin(pow2, MAX_POINTS_PER_CURVE);
-    }
+    return 1 << SkQuadSubdivisionShift(points, tol, kMaxPointsPerCurveShift);
 }
 
 uint32_t GrPathUtils::generateQuadraticPoints(const SkPoint& p0,
@@ -76,16 +62,10 @@ uint32_t GrPathUtils::generateQuadraticPoints(const SkPoint& p0,
         return 1;
     }
 
-    SkPoint q[] = {
-        { SkScalarAve(p0.fX, p1.fX), SkScalarAve(p0.fY, p1.fY) },
-        { SkScalarAve(p1.fX, p2.fX), SkScalarAve(p1.fY, p2.fY) },
-    };
-    SkPoint r = { SkScalarAve(q[0].fX, q[1].fX), SkScalarAve(q[0].fY, q[1].fY) };
-
-    pointsLeft >>= 1;
-    uint32_t a = generateQuadraticPoints(p0, q[0], r, tolSqd, points, pointsLeft);
-    uint32_t b = generateQuadraticPoints(r, q[1], p2, tolSqd, points, pointsLeft);
-    return a + b;
+    const SkPoint pts[] = { p0, p1, p2 };
+    SkEvalQuadUniform(pts, pointsLeft, *points);
+    *points += pointsLeft;
+    return pointsLeft;
 }
 
 uint32_t GrPathUtils::cubicPointCount(const SkPoint points[],
@@ -95,23 +75,7 @@ uint32_t GrPathUtils::cubicPointCount(const SkPoint points[],
     }
     SkASSERT(tol > 0);
 
-    SkScalar d = SkTMax(
-        points[1].distanceToLineSegmentBetweenSqd(points[0], points[3]),
-        points[2].distanceToLineSegmentBetweenSqd(points[0], points[3]));
-    d = SkScalarSqrt(d);
-    if (d <= tol) {
-        return 1;
-    } else {
-        int temp = SkScalarCeilToInt(SkScalarSqrt(SkScalarDiv(d, tol)));
-        int pow2 = GrNextPow2(temp);
-        // Because of NaNs & INFs we can wind up with a degenerate temp
-        // such that pow2 comes out negative. Also, our point generator
-        // will always output at least one pt.
-        if (pow2 < 1) {
-            pow2 = 1;
-        }
-        return SkTMin(pow2, MAX_POINTS_PER_CURVE);
-    }
+    return 1 << SkCubicSubdivisionShift(points, tol, kMaxPointsPerCurveShift);
 }
 
 uint32_t GrPathUtils::generateCubicPoints(const SkPoint& p0,
@@ -128,20 +92,11 @@ uint32_t GrPathUtils::generateCubicPoints(const SkPoint& p0,
             *points += 1;
             return 1;
         }
-    SkPoint q[] = {
-        { SkScalarAve(p0.fX, p1.fX), SkScalarAve(p0.fY, p1.fY) },
-        { SkScalarAve(p1.fX, p2.fX), SkScalarAve(p1.fY, p2.fY) },
-        { SkScalarAve(p2.fX, p3.fX), SkScalarAve(p2.fY, p3.fY) }
-    };
-    SkPoint r[] = {
-        { SkScalarAve(q[0].fX, q[1].fX), SkScalarAve(q[0].fY, q[1].fY) },
-        { SkScalarAve(q[1].fX, q[2].fX), SkScalarAve(q[1].fY, q[2].fY) }
-    };
-    SkPoint s = { SkScalarAve(r[0].fX, r[1].fX), SkScalarAve(r[0].fY, r[1].fY) };
-    pointsLeft >>= 1;
-    uint32_t a = generateCubicPoints(p0, q[0], r[0], s, tolSqd, points, pointsLeft);
-    uint32_t b = generateCubicPoints(s, r[1], q[2], p3, tolSqd, points, pointsLeft);
-    return a + b;
+
+    const SkPoint pts[] = { p0, p1, p2, p3 };
+    SkEvalCubicUniform(pts, pointsLeft, *points);
+    *points += pointsLeft;
+    return pointsLeft;
 }
 
 int GrPathUtils::worstCasePointCount(const SkPath& path, int* subpaths,
@@ -32,6 +32,8 @@ namespace GrPathUtils {
     /// very small tolerances will be increased to gMinCurveTol.
     uint32_t quadraticPointCount(const SkPoint points[], SkScalar tol);
 
+    /// Appends pointsLeft points along the quad, equally spaced in t (or just p2
+    /// if the quad is within sqrt(tolSqd) of a line), and returns the count.
     uint32_t generateQuadraticPoints(const SkPoint& p0,
                                      const SkPoint& p1,
                                      const SkPoint& p2,
@@ -43,6 +45,7 @@ namespace GrPathUtils {
     /// very small tolerances will be increased to gMinCurveTol.
     uint32_t cubicPointCount(const SkPoint points[], SkScalar tol);
 
+    /// Appends pointsLeft points along the cubic, as generateQuadraticPoints.
     uint32_t generateCubicPoints(const SkPoint& p0,
                                  const SkPoint& p1,
                                  const SkPoint& p2,
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrPixelReadback_DEFINED
+#define GrPixelReadback_DEFINED
+
+#include "GrGpuObject.h"
+#include "GrTypes.h"
+
+/**
+ * A rectangle of a render target on its way back from the GPU, made by GrGpu::beginReadPixels().
+ * The read has been issued, but the GPU may not have done it yet. isReady() tells whether it has
+ * without blocking, and readPixels() copies the pixels out, waiting for the GPU if need be.
+ */
+class GrPixelReadback : public GrGpuObject {
+public:
+    int width() const { return fWidth; }
+    int height() const { return fHeight; }
+    GrPixelConfig config() const { return fConfig; }
+
+    /**
+     * Returns true once readPixels() won't have to wait for the GPU.
+     */
+    virtual bool isReady() = 0;
+
+    /**
+     * Copies the pixels into buffer, top row first, waiting for the GPU if it hasn't finished.
+     * rowBytes must be at least width() pixels. Returns false if the pixels are lost, e.g.
+     * because the context was.
+     */
+    virtual bool readPixels(void* buffer, size_t rowBytes) = 0;
+
+    virtual size_t gpuMemorySize() const SK_OVERRIDE {
+        return fWidth * fHeight * GrBytesPerPixel(fConfig);
+    }
+
+protected:
+    GrPixelReadback(GrGpu* gpu, int width, int height, GrPixelConfig config)
+        : INHERITED(gpu, false)
+        , fWidth(width)
+        , fHeight(height)
+        , fConfig(config) {
+    }
+
+private:
+    int             fWidth;
+    int             fHeight;
+    GrPixelConfig   fConfig;
+
+    typedef GrGpuObject INHERITED;
+};
+
+#endif
@@ -29,6 +29,11 @@ public:
     // Attempt to add a rect. Return true on success; false on failure. If
     // successful the position in the atlas is returned in 'loc'.
     virtual bool addRect(int width, int height, SkIPoint16* loc) = 0;
+
+    // Return the space of a rect previously added at 'loc' so it can be reused. Return false if
+    // this rectanizer can't free individual rects, in which case only reset() reclaims space.
+    virtual bool freeRect(const SkIPoint16& loc, int width, int height) { return false; }
+
     virtual float percentFull() const = 0;
 
     /**
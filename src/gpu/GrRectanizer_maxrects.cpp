@@ -0,0 +1,192 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrRectanizer_maxrects.h"
+#include "SkPoint.h"
+
+bool GrRectanizerMaxRects::addRect(int width, int height, SkIPoint16* loc) {
+    if ((unsigned)width > (unsigned)this->width() ||
+        (unsigned)height > (unsigned)this->height()) {
+        return false;
+    }
+
+    int index = this->findFreeRect(width, height);
+    if (-1 == index && fFreedArea >= width*height) {
+        this->rebuildFreeRects();
+        index = this->findFreeRect(width, height);
+    }
+
+    if (-1 == index) {
+        loc->fX = 0;
+        loc->fY = 0;
+        return false;
+    }
+
+    SkIRect used = SkIRect::MakeXYWH(fFreeRects[index].fLeft, fFreeRects[index].fTop,
+                                     width, height);
+    this->pruneFreeRects(this->splitFreeRects(used));
+    fUsedRects.push(used);
+
+    loc->fX = used.fLeft;
+    loc->fY = used.fTop;
+
+    fAreaSoFar += width*height;
+    return true;
+}
+
+bool GrRectanizerMaxRects::freeRect(const SkIPoint16& loc, int width, int height) {
+    SkIRect freed = SkIRect::MakeXYWH(loc.fX, loc.fY, width, height);
+
+    int usedIndex = -1;
+    for (int i = 0; i < fUsedRects.count(); ++i) {
+        if (fUsedRects[i] == freed) {
+            usedIndex = i;
+            break;
+        }
+    }
+    SkASSERT(-1 != usedIndex);
+    if (-1 == usedIndex) {
+        return false;
+    }
+    fUsedRects.removeShuffle(usedIndex);
+
+    fAreaSoFar -= width*height;
+    if (fUsedRects.isEmpty()) {
+        SkASSERT(0 == fAreaSoFar);
+        this->reset();
+        return true;
+    }
+
+    // Grow the freed rect by the free rects it shares a whole edge with. The free rects it
+    // swallows are pruned below.
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < fFreeRects.count(); ++i) {
+            const SkIRect& freeRect = fFreeRects[i];
+            bool sameRows = freeRect.fTop == freed.fTop && freeRect.fBottom == freed.fBottom &&
+                            (freeRect.fRight == freed.fLeft || freeRect.fLeft == freed.fRight);
+            bool sameColumns = freeRect.fLeft == freed.fLeft && freeRect.fRight == freed.fRight &&
+                               (freeRect.fBottom == freed.fTop || freeRect.fTop == freed.fBottom);
+            if (sameRows || sameColumns) {
+                freed.join(freeRect);
+                merged = true;
+            }
+        }
+    }
+
+    fFreeRects.push(freed);
+    this->pruneFreeRects(fFreeRects.count() - 1);
+    fFreedArea += width*height;
+    return true;
+}
+
+int GrRectanizerMaxRects::findFreeRect(int width, int height) const {
+    int bestShortSide = SK_MaxS32;
+    int bestLongSide = SK_MaxS32;
+    int bestIndex = -1;
+    for (int i = 0; i < fFreeRects.count(); ++i) {
+        const SkIRect& freeRect = fFreeRects[i];
+        if (freeRect.width() < width || freeRect.height() < height) {
+            continue;
+        }
+        int leftoverX = freeRect.width() - width;
+        int leftoverY = freeRect.height() - height;
+        int shortSide = SkMin32(leftoverX, leftoverY);
+        int longSide = SkMax32(leftoverX, leftoverY);
+        // minimize the shorter leftover side first, then the longer one
+        if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide)) {
+            bestIndex = i;
+            bestShortSide = shortSide;
+            bestLongSide = longSide;
+        }
+    }
+    return bestIndex;
+}
+
+void GrRectanizerMaxRects::rebuildFreeRects() {
+    fFreeRects.reset();
+    fFreeRects.push(SkIRect::MakeWH(this->width(), this->height()));
+    for (int i = 0; i < fUsedRects.count(); ++i) {
+        this->pruneFreeRects(this->splitFreeRects(fUsedRects[i]));
+    }
+    fFreedArea = 0;
+}
+
+int GrRectanizerMaxRects::splitFreeRects(const SkIRect& used) {
+    SkTDArray<SkIRect> split;
+    split.setReserve(fFreeRects.count() + 4);
+    int overlapCount = 0;
+    for (int i = 0; i < fFreeRects.count(); ++i) {
+        if (SkIRect::Intersects(fFreeRects[i], used)) {
+            ++overlapCount;
+        } else {
+            split.push(fFreeRects[i]);
+        }
+    }
+    int firstNew = split.count();
+    if (0 == overlapCount) {
+        return firstNew;
+    }
+
+    for (int i = 0; i < fFreeRects.count(); ++i) {
+        const SkIRect& freeRect = fFreeRects[i];
+        if (!SkIRect::Intersects(freeRect, used)) {
+            continue;
+        }
+
+        // keep the maximal rects left, right, above and below the used rect
+        if (used.fLeft > freeRect.fLeft) {
+            split.push(SkIRect::MakeLTRB(freeRect.fLeft, freeRect.fTop,
+                                         used.fLeft, freeRect.fBottom));
+        }
+        if (used.fRight < freeRect.fRight) {
+            split.push(SkIRect::MakeLTRB(used.fRight, freeRect.fTop,
+                                         freeRect.fRight, freeRect.fBottom));
+        }
+        if (used.fTop > freeRect.fTop) {
+            split.push(SkIRect::MakeLTRB(freeRect.fLeft, freeRect.fTop,
+                                         freeRect.fRight, used.fTop));
+        }
+        if (used.fBottom < freeRect.fBottom) {
+            split.push(SkIRect::MakeLTRB(freeRect.fLeft, used.fBottom,
+                                         freeRect.fRight, freeRect.fBottom));
+        }
+    }
+    fFreeRects.swap(split);
+    return firstNew;
+}
+
+void GrRectanizerMaxRects::pruneFreeRects(int firstNew) {
+    // Only the new rects can contain or be contained in another rect. Removing rects keeps the
+    // order of the others so that the old ones stay in front.
+    for (int i = firstNew; i < fFreeRects.count(); ++i) {
+        bool contained = false;
+        for (int j = 0; j < fFreeRects.count(); ++j) {
+            if (i == j) {
+                continue;
+            }
+            if (fFreeRects[j].contains(fFreeRects[i])) {
+                contained = true;
+                break;
+            }
+        }
+        if (contained) {
+            fFreeRects.remove(i);
+            --i;
+            continue;
+        }
+        for (int j = 0; j < firstNew; ++j) {
+            if (fFreeRects[i].contains(fFreeRects[j])) {
+                fFreeRects.remove(j);
+                --firstNew;
+                --i;
+                --j;
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrRectanizer_maxrects_DEFINED
+#define GrRectanizer_maxrects_DEFINED
+
+#include "GrRectanizer.h"
+#include "SkRect.h"
+#include "SkTDArray.h"
+
+// Pack rectangles into a list of maximal free rectangles, which may overlap. New rects go in the
+// free rectangle that leaves the shortest side over (best short side fit). Unlike the skyline
+// and pow2 rectanizers this one can free individual rects, so long-lived atlases don't have to be
+// reset as a whole to reclaim the space of entries that went away. Freed rects are merged with
+// free neighbors they share an edge with. That leaves the free space fragmented over time, so
+// once a rect doesn't fit after at least its area was freed, the free rects are rebuilt from the
+// rects still in use and the rect is tried again.
+// Based, in part, on Jukka Jylanki's work at http://clb.demon.fi
+class GrRectanizerMaxRects : public GrRectanizer {
+public:
+    GrRectanizerMaxRects(int w, int h) : INHERITED(w, h) {
+        this->reset();
+    }
+
+    virtual ~GrRectanizerMaxRects() { }
+
+    virtual void reset() SK_OVERRIDE {
+        fAreaSoFar = 0;
+        fUsedRects.reset();
+        fFreeRects.reset();
+        fFreeRects.push(SkIRect::MakeWH(this->width(), this->height()));
+        fFreedArea = 0;
+    }
+
+    virtual bool addRect(int w, int h, SkIPoint16* loc) SK_OVERRIDE;
+
+    virtual bool freeRect(const SkIPoint16& loc, int w, int h) SK_OVERRIDE;
+
+    virtual float percentFull() const SK_OVERRIDE {
+        return fAreaSoFar / ((float)this->width() * this->height());
+    }
+
+private:
+    SkTDArray<SkIRect> fUsedRects;
+    SkTDArray<SkIRect> fFreeRects;
+
+    int32_t fAreaSoFar;
+    // The area freed since the free rects were last rebuilt.
+    int32_t fFreedArea;
+
+    // Return the index of the free rect a width x height rect fits best, or -1.
+    int findFreeRect(int width, int height) const;
+    // Recompute the maximal free rects from the used ones.
+    void rebuildFreeRects();
+    // Replace the free rects that overlap 'used' with their parts outside of it, which go at the
+    // end of the list. Return the index of the first new free rect.
+    int splitFreeRects(const SkIRect& used);
+    // Remove the free rects that are contained in another one. The ones before 'firstNew' are
+    // known not to contain each other.
+    void pruneFreeRects(int firstNew);
+
+    typedef GrRectanizer INHERITED;
+};
+
+#endif
@@ -43,7 +43,9 @@ GrResourceCacheEntry::GrResourceCacheEntry(GrResourceCache* resourceCache,
           fKey(key),
           fResource(resource),
           fCachedSize(resource->gpuMemorySize()),
-          fIsExclusive(false) {
+          fIsExclusive(false),
+          fPriority(key.isScratch() ? GrResourceCache::kScratch_Priority
+                                    : GrResourceCache::kContent_Priority) {
     // we assume ownership of the resource, and will unref it when we die
     SkASSERT(resource);
     resource->ref();
@@ -64,6 +66,10 @@ void GrResourceCacheEntry::validate() const {
 }
 #endif
 
+void GrResourceCacheEntry::setPriority(int priority) {
+    fResourceCache->setPriority(this, priority);
+}
+
 void GrResourceCacheEntry::didChangeResourceSize() {
     size_t oldSize = fCachedSize;
     fCachedSize = fResource->gpuMemorySize();
@@ -76,9 +82,21 @@ void GrResourceCacheEntry::didChangeResourceSize() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static int hard_max_count(int maxCount) {
+    return maxCount > SK_MaxS32 / GrResourceCache::kHardBudgetScale ?
+           SK_MaxS32 : maxCount * GrResourceCache::kHardBudgetScale;
+}
+
+static size_t hard_max_bytes(size_t maxBytes) {
+    return maxBytes > SIZE_MAX / GrResourceCache::kHardBudgetScale ?
+           SIZE_MAX : maxBytes * GrResourceCache::kHardBudgetScale;
+}
+
 GrResourceCache::GrResourceCache(int maxCount, size_t maxBytes) :
         fMaxCount(maxCount),
-        fMaxBytes(maxBytes) {
+        fMaxBytes(maxBytes),
+        fHardMaxCount(hard_max_count(maxCount)),
+        fHardMaxBytes(hard_max_bytes(maxBytes)) {
 #if GR_CACHE_STATS
     fHighWaterEntryCount          = 0;
     fHighWaterEntryBytes          = 0;
@@ -90,6 +108,7 @@ GrResourceCache::GrResourceCache(int maxCount, size_t maxBytes) :
     fEntryBytes                   = 0;
     fClientDetachedCount          = 0;
     fClientDetachedBytes          = 0;
+    fScratchEvictions             = 0;
 
     fPurging                      = false;
 
@@ -103,16 +122,18 @@ GrResourceCache::~GrResourceCache() {
     EntryList::Iter iter;
 
     // Unlike the removeAll, here we really remove everything, including locked resources.
-    while (GrResourceCacheEntry* entry = fList.head()) {
-        GrAutoResourceCacheValidate atcv(this);
+    for (int p = 0; p < kPriorityCount; ++p) {
+        while (GrResourceCacheEntry* entry = fLists[p].head()) {
+            GrAutoResourceCacheValidate atcv(this);
 
-        // remove from our cache
-        fCache.remove(entry->fKey, entry);
+            // remove from our cache
+            fCache.remove(entry->fKey, entry);
 
-        // remove from our llist
-        this->internalDetach(entry);
+            // remove from our llist
+            this->internalDetach(entry);
 
-        delete entry;
+            delete entry;
+        }
     }
 }
 
@@ -130,15 +151,18 @@ void GrResourceCache::setLimits(int maxResources, size_t maxResourceBytes) {
 
     fMaxCount = maxResources;
     fMaxBytes = maxResourceBytes;
+    fHardMaxCount = hard_max_count(maxResources);
+    fHardMaxBytes = hard_max_bytes(maxResourceBytes);
 
+    // The client asked for the smaller budget so purge to it right away.
     if (smaller) {
-        this->purgeAsNeeded();
+        this->performDeferredCleanup();
     }
 }
 
 void GrResourceCache::internalDetach(GrResourceCacheEntry* entry,
                                      BudgetBehaviors behavior) {
-    fList.remove(entry);
+    fLists[entry->fPriority].remove(entry);
 
     // update our stats
     if (kIgnore_BudgetBehavior == behavior) {
@@ -164,7 +188,7 @@ void GrResourceCache::internalDetach(GrResourceCacheEntry* entry,
 
 void GrResourceCache::attachToHead(GrResourceCacheEntry* entry,
                                    BudgetBehaviors behavior) {
-    fList.addToHead(entry);
+    fLists[entry->fPriority].addToHead(entry);
 
     // update our stats
     if (kIgnore_BudgetBehavior == behavior) {
@@ -211,8 +235,10 @@ GrCacheable* GrResourceCache::find(const GrResourceKey& key, uint32_t ownershipF
     }
 
     if (NULL == entry) {
+        fCounters.fMisses += 1;
         return NULL;
     }
+    fCounters.fHits += 1;
 
     if (ownershipFlags & kHide_OwnershipFlag) {
         this->makeExclusive(entry);
@@ -248,6 +274,20 @@ void GrResourceCache::addResource(const GrResourceKey& key,
 
 }
 
+void GrResourceCache::setPriority(GrResourceCacheEntry* entry, int priority) {
+    GrAutoResourceCacheValidate atcv(this);
+
+    SkASSERT(priority >= 0 && priority < kPriorityCount);
+    if (entry->fIsExclusive) {
+        // it joins its new list when it is made non-exclusive
+        entry->fPriority = priority;
+    } else {
+        fLists[entry->fPriority].remove(entry);
+        entry->fPriority = priority;
+        fLists[priority].addToHead(entry);
+    }
+}
+
 void GrResourceCache::makeExclusive(GrResourceCacheEntry* entry) {
     GrAutoResourceCacheValidate atcv(this);
 
@@ -332,6 +372,19 @@ void GrResourceCache::didDecreaseResourceSize(const GrResourceCacheEntry* entry,
  * 10 textures).
  */
 void GrResourceCache::purgeAsNeeded(int extraCount, size_t extraBytes) {
+    this->purgeToBudget(fHardMaxCount, fHardMaxBytes, extraCount, extraBytes);
+}
+
+void GrResourceCache::performDeferredCleanup() {
+    this->purgeToBudget(fMaxCount, fMaxBytes, 0, 0);
+}
+
+void GrResourceCache::purgeToBytes(size_t maxBytes) {
+    this->purgeToBudget(fMaxCount, SkTMin(maxBytes, fMaxBytes), 0, 0);
+}
+
+void GrResourceCache::purgeToBudget(int maxCount, size_t maxBytes,
+                                    int extraCount, size_t extraBytes) {
     if (fPurging) {
         return;
     }
@@ -340,14 +393,14 @@ void GrResourceCache::purgeAsNeeded(int extraCount, size_t extraBytes) {
 
     this->purgeInvalidated();
 
-    this->internalPurge(extraCount, extraBytes);
-    if (((fEntryCount+extraCount) > fMaxCount ||
-        (fEntryBytes+extraBytes) > fMaxBytes) &&
+    this->internalPurge(maxCount, maxBytes, extraCount, extraBytes);
+    if (((fEntryCount+extraCount) > maxCount ||
+        (fEntryBytes+extraBytes) > maxBytes) &&
         NULL != fOverbudgetCB) {
         // Despite the purge we're still over budget. See if Ganesh can
         // release some resources and purge again.
         if ((*fOverbudgetCB)(fOverbudgetData)) {
-            this->internalPurge(extraCount, extraBytes);
+            this->internalPurge(maxCount, maxBytes, extraCount, extraBytes);
         }
     }
 
@@ -367,11 +420,19 @@ void GrResourceCache::purgeInvalidated() {
         // This is complicated and confusing.  May try this in the future.  For
         // now, these resources are just LRU'd as if we never got the message.
         while (GrResourceCacheEntry* entry = fCache.find(invalidated[i].key, GrTFindUnreffedFunctor())) {
+            this->countEviction(entry);
             this->deleteResource(entry);
         }
     }
 }
 
+void GrResourceCache::countEviction(const GrResourceCacheEntry* entry) {
+    fCounters.fEvictions += 1;
+    if (entry->key().isScratch()) {
+        fScratchEvictions += 1;
+    }
+}
+
 void GrResourceCache::deleteResource(GrResourceCacheEntry* entry) {
     SkASSERT(1 == entry->fResource->getRefCnt());
 
@@ -383,7 +444,8 @@ void GrResourceCache::deleteResource(GrResourceCacheEntry* entry) {
     delete entry;
 }
 
-void GrResourceCache::internalPurge(int extraCount, size_t extraBytes) {
+void GrResourceCache::internalPurge(int maxCount, size_t maxBytes,
+                                    int extraCount, size_t extraBytes) {
     SkASSERT(fPurging);
 
     bool withinBudget = false;
@@ -396,29 +458,49 @@ void GrResourceCache::internalPurge(int extraCount, size_t extraBytes) {
 
         changed = false;
 
-        // Note: the following code relies on the fact that the
-        // doubly linked list doesn't invalidate its data/pointers
-        // outside of the specific area where a deletion occurs (e.g.,
-        // in internalDetach)
-        GrResourceCacheEntry* entry = iter.init(fList, EntryList::Iter::kTail_IterStart);
-
-        while (NULL != entry) {
-            GrAutoResourceCacheValidate atcv(this);
-
-            if ((fEntryCount+extraCount) <= fMaxCount &&
-                (fEntryBytes+extraBytes) <= fMaxBytes) {
-                withinBudget = true;
-                break;
+        // Lower priority classes are emptied of unlocked entries before
+        // anything is purged from the higher ones.
+        for (int p = 0; p < kPriorityCount && !withinBudget; ++p) {
+            // Note: the following code relies on the fact that the
+            // doubly linked list doesn't invalidate its data/pointers
+            // outside of the specific area where a deletion occurs (e.g.,
+            // in internalDetach)
+            GrResourceCacheEntry* entry = iter.init(fLists[p], EntryList::Iter::kTail_IterStart);
+
+            while (NULL != entry) {
+                GrAutoResourceCacheValidate atcv(this);
+
+                if ((fEntryCount+extraCount) <= maxCount &&
+                    (fEntryBytes+extraBytes) <= maxBytes) {
+                    withinBudget = true;
+                    break;
+                }
+
+                GrResourceCacheEntry* prev = iter.prev();
+                if (entry->fResource->unique()) {
+                    changed = true;
+                    this->countEviction(entry);
+                    this->deleteResource(entry);
+                }
+                entry = prev;
             }
+        }
+    } while (!withinBudget && changed);
+}
 
-            GrResourceCacheEntry* prev = iter.prev();
-            if (entry->fResource->unique()) {
-                changed = true;
-                this->deleteResource(entry);
+size_t GrResourceCache::getPurgeableResourceBytes() const {
+    size_t bytes = 0;
+    for (int p = 0; p < kPriorityCount; ++p) {
+        EntryList::Iter iter;
+        const GrResourceCacheEntry* entry = iter.init(const_cast<EntryList&>(fLists[p]),
+                                                      EntryList::Iter::kHead_IterStart);
+        for ( ; NULL != entry; entry = iter.next()) {
+            if (entry->resource()->unique()) {
+                bytes += entry->fCachedSize;
             }
-            entry = prev;
         }
-    } while (!withinBudget && changed);
+    }
+    return bytes;
 }
 
 void GrResourceCache::purgeAllUnlocked() {
@@ -426,13 +508,8 @@ void GrResourceCache::purgeAllUnlocked() {
 
     // we can have one GrCacheable holding a lock on another
     // so we don't want to just do a simple loop kicking each
-    // entry out. Instead change the budget and purge.
-
-    size_t savedMaxBytes = fMaxBytes;
-    int savedMaxCount = fMaxCount;
-    fMaxBytes = (size_t) -1;
-    fMaxCount = 0;
-    this->purgeAsNeeded();
+    // entry out. Instead purge to an empty budget.
+    this->purgeToBudget(0, (size_t) -1, 0, 0);
 
 #ifdef SK_DEBUG
     SkASSERT(fExclusiveList.countEntries() == fClientDetachedCount);
@@ -443,12 +520,11 @@ void GrResourceCache::purgeAllUnlocked() {
         // them.
         SkASSERT(fEntryCount == fClientDetachedCount);
         SkASSERT(fEntryBytes == fClientDetachedBytes);
-        SkASSERT(fList.isEmpty());
+        for (int p = 0; p < kPriorityCount; ++p) {
+            SkASSERT(fLists[p].isEmpty());
+        }
     }
 #endif
-
-    fMaxBytes = savedMaxBytes;
-    fMaxCount = savedMaxCount;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -473,7 +549,9 @@ static bool both_zero_or_nonzero(int count, size_t bytes) {
 }
 
 void GrResourceCache::validate() const {
-    fList.validate();
+    for (int p = 0; p < kPriorityCount; ++p) {
+        fLists[p].validate();
+    }
     fExclusiveList.validate();
     SkASSERT(both_zero_or_nonzero(fEntryCount, fEntryBytes));
     SkASSERT(both_zero_or_nonzero(fClientDetachedCount, fClientDetachedBytes));
@@ -492,24 +570,25 @@ void GrResourceCache::validate() const {
     }
 
     // check that the shareable entries are okay
-    entry = iter.init(const_cast<EntryList&>(fList), EntryList::Iter::kHead_IterStart);
-
     int count = 0;
-    for ( ; NULL != entry; entry = iter.next()) {
-        entry->validate();
-        SkASSERT(fCache.find(entry->key()));
-        count += 1;
+    size_t bytes = 0;
+    for (int p = 0; p < kPriorityCount; ++p) {
+        entry = iter.init(const_cast<EntryList&>(fLists[p]), EntryList::Iter::kHead_IterStart);
+
+        for ( ; NULL != entry; entry = iter.next()) {
+            entry->validate();
+            SkASSERT(entry->fPriority == p);
+            SkASSERT(fCache.find(entry->key()));
+            count += 1;
+        }
+        bytes += countBytes(fLists[p]);
     }
     SkASSERT(count == fEntryCount - fClientDetachedCount);
-
-    size_t bytes = countBytes(fList);
     SkASSERT(bytes == fEntryBytes  - fClientDetachedBytes);
 
     bytes = countBytes(fExclusiveList);
     SkASSERT(bytes == fClientDetachedBytes);
 
-    SkASSERT(fList.countEntries() == fEntryCount - fClientDetachedCount);
-
     SkASSERT(fExclusiveList.countEntries() == fClientDetachedCount);
 }
 #endif // SK_DEBUG
@@ -521,15 +600,18 @@ void GrResourceCache::printStats() {
 
     EntryList::Iter iter;
 
-    GrResourceCacheEntry* entry = iter.init(fList, EntryList::Iter::kTail_IterStart);
+    for (int p = 0; p < kPriorityCount; ++p) {
+        GrResourceCacheEntry* entry = iter.init(fLists[p], EntryList::Iter::kTail_IterStart);
 
-    for ( ; NULL != entry; entry = iter.prev()) {
-        if (entry->fResource->getRefCnt() > 1) {
-            ++locked;
+        for ( ; NULL != entry; entry = iter.prev()) {
+            if (entry->fResource->getRefCnt() > 1) {
+                ++locked;
+            }
         }
     }
 
     SkDebugf("Budget: %d items %d bytes\n", fMaxCount, fMaxBytes);
+    SkDebugf("Hard Budget: %d items %d bytes\n", fHardMaxCount, fHardMaxBytes);
     SkDebugf("\t\tEntry Count: current %d (%d locked) high %d\n",
                 fEntryCount, locked, fHighWaterEntryCount);
     SkDebugf("\t\tEntry Bytes: current %d high %d\n",
@@ -15,6 +15,7 @@
 #include "GrTypes.h"
 #include "GrTMultiMap.h"
 #include "GrBinHashKey.h"
+#include "SkCacheCounters.h"
 #include "SkMessageBus.h"
 #include "SkTInternalLList.h"
 
@@ -121,6 +122,13 @@ public:
     GrCacheable* resource() const { return fResource; }
     const GrResourceKey& key() const { return fKey; }
 
+    /**
+     *  The priority class the entry is purged in. Entries added with a scratch key start out as
+     *  kScratch_Priority and all others as kContent_Priority.
+     */
+    int priority() const { return fPriority; }
+    void setPriority(int priority);
+
     static const GrResourceKey& GetKey(const GrResourceCacheEntry& e) { return e.key(); }
     static uint32_t Hash(const GrResourceKey& key) { return key.getHash(); }
 #ifdef SK_DEBUG
@@ -147,6 +155,7 @@ private:
     GrCacheable*     fResource;
     size_t           fCachedSize;
     bool             fIsExclusive;
+    int              fPriority;
 
     // Linked list for the LRU ordering.
     SK_DECLARE_INTERNAL_LLIST_INTERFACE(GrResourceCacheEntry);
@@ -162,10 +171,19 @@ private:
  *  These have a corresponding GrResourceKey, built from 128bits identifying the
  *  resource. Multiple resources can map to same GrResourceKey.
  *
- *  The cache stores the entries in a double-linked list, which is its LRU.
- *  When an entry is "locked" (i.e. given to the caller), it is moved to the
- *  head of the list. If/when we must purge some of the entries, we walk the
- *  list backwards from the tail, since those are the least recently used.
+ *  The cache stores the entries in double-linked lists, one LRU per priority
+ *  class. When an entry is "locked" (i.e. given to the caller), it is moved to
+ *  the head of its list. If/when we must purge some of the entries, we walk the
+ *  lists backwards from the tail, since those are the least recently used,
+ *  starting with the lowest priority class. A content entry is only purged once
+ *  no scratch entry can be, and an atlas only once no content entry can be.
+ *
+ *  The cache has two budgets. The soft budget is the one set by setLimits(); it
+ *  is enforced by performDeferredCleanup(), which the owner calls at a point
+ *  where purging is cheap to absorb, such as a frame boundary. Purges triggered
+ *  inline by adding or growing resources only enforce the hard budget, a
+ *  multiple of the soft one, so that a draw doesn't pay for evicting resources
+ *  unless the cache is really out of room.
  *
  *  For fast searches, we maintain a hash map based on the GrResourceKey.
  *
@@ -175,11 +193,20 @@ private:
  */
 class GrResourceCache {
 public:
+    enum Priority {
+        kScratch_Priority,
+        kContent_Priority,
+        kAtlas_Priority,
+
+        kLast_Priority = kAtlas_Priority
+    };
+    static const int kPriorityCount = kLast_Priority + 1;
+
     GrResourceCache(int maxCount, size_t maxBytes);
     ~GrResourceCache();
 
     /**
-     *  Return the current resource cache limits.
+     *  Return the current resource cache limits, i.e. the soft budget.
      *
      *  @param maxResource If non-null, returns maximum number of resources
      *                     that can be held in the cache.
@@ -189,8 +216,10 @@ public:
     void getLimits(int* maxResources, size_t* maxBytes) const;
 
     /**
-     *  Specify the resource cache limits. If the current cache exceeds either
-     *  of these, it will be purged (LRU) to keep the cache within these limits.
+     *  Specify the resource cache limits, i.e. the soft budget. The hard budget
+     *  follows at kHardBudgetScale times these. If the current cache exceeds
+     *  either of these, it will be purged (LRU) to keep the cache within these
+     *  limits.
      *
      *  @param maxResources The maximum number of resources that can be held in
      *                      the cache.
@@ -199,6 +228,11 @@ public:
      */
     void setLimits(int maxResources, size_t maxResourceBytes);
 
+    /**
+     *  How many times larger than the soft budget the hard budget is.
+     */
+    static const int kHardBudgetScale = 2;
+
     /**
      *  The callback function used by the cache when it is still over budget
      *  after a purge. The passed in 'data' is the same 'data' handed to
@@ -228,6 +262,22 @@ public:
      */
     int getCachedResourceCount() const { return fEntryCount; }
 
+    /**
+     * Returns the number of bytes consumed by cached resources that no one
+     * else holds a ref to, which purgeAllUnlocked() would free.
+     */
+    size_t getPurgeableResourceBytes() const;
+
+    /**
+     * Lookups by find(), and entries purged by the cache itself.
+     */
+    const SkCacheCounters& counters() const { return fCounters; }
+
+    /**
+     * The number of the purged entries that had scratch keys.
+     */
+    int scratchEvictions() const { return fScratchEvictions; }
+
     // For a found or added resource to be completely exclusive to the caller
     // both the kNoOtherOwners and kHide flags need to be specified
     enum OwnershipFlags {
@@ -270,6 +320,12 @@ public:
      */
     bool hasKey(const GrResourceKey& key) const { return NULL != fCache.find(key); }
 
+    /**
+     * Move 'entry' to a different priority class. It keeps its place as the
+     * most recently used entry of the new class.
+     */
+    void setPriority(GrResourceCacheEntry* entry, int priority);
+
     /**
      * Hide 'entry' so that future searches will not find it. Such
      * hidden entries will not be purged. The entry still counts against
@@ -301,7 +357,7 @@ public:
     void purgeAllUnlocked();
 
     /**
-     * Allow cache to purge unused resources to obey resource limitations
+     * Allow cache to purge unused resources to obey the hard budget.
      * Note: this entry point will be hidden (again) once totally ref-driven
      * cache maintenance is implemented. Note that the overbudget callback
      * will be called if the initial purge doesn't get the cache under
@@ -313,6 +369,18 @@ public:
      */
     void purgeAsNeeded(int extraCount = 0, size_t extraBytes = 0);
 
+    /**
+     * Purges unused resources to bring the cache within its soft budget. The
+     * overbudget callback is called if that can't be done.
+     */
+    void performDeferredCleanup();
+
+    /**
+     * Purges unused resources until the cache holds no more than maxBytes, or is within its soft
+     * budget if that is smaller. The budget itself is unchanged.
+     */
+    void purgeToBytes(size_t maxBytes);
+
 #ifdef SK_DEBUG
     void validate() const;
 #else
@@ -333,21 +401,25 @@ private:
     void attachToHead(GrResourceCacheEntry*, BudgetBehaviors behavior = kAccountFor_BudgetBehavior);
 
     void removeInvalidResource(GrResourceCacheEntry* entry);
+    void countEviction(const GrResourceCacheEntry* entry);
 
     GrTMultiMap<GrResourceCacheEntry, GrResourceKey> fCache;
 
-    // We're an internal doubly linked list
+    // We're internal doubly linked lists, one per priority class
     typedef SkTInternalLList<GrResourceCacheEntry> EntryList;
-    EntryList      fList;
+    EntryList      fLists[kPriorityCount];
 
 #ifdef SK_DEBUG
     // These objects cannot be returned by a search
     EntryList      fExclusiveList;
 #endif
 
-    // our budget, used in purgeAsNeeded()
+    // our soft budget, used in performDeferredCleanup()
     int            fMaxCount;
     size_t         fMaxBytes;
+    // our hard budget, used in purgeAsNeeded()
+    int            fHardMaxCount;
+    size_t         fHardMaxBytes;
 
     // our current stats, related to our budget
 #if GR_CACHE_STATS
@@ -362,13 +434,17 @@ private:
     int            fClientDetachedCount;
     size_t         fClientDetachedBytes;
 
+    SkCacheCounters fCounters;
+    int            fScratchEvictions;
+
     // prevents recursive purging
     bool           fPurging;
 
     PFOverbudgetCB fOverbudgetCB;
     void*          fOverbudgetData;
 
-    void internalPurge(int extraCount, size_t extraBytes);
+    void purgeToBudget(int maxCount, size_t maxBytes, int extraCount, size_t extraBytes);
+    void internalPurge(int maxCount, size_t maxBytes, int extraCount, size_t extraBytes);
 
     // Listen for messages that a resource has been invalidated and purge cached junk proactively.
     SkMessageBus<GrResourceInvalidatedMessage>::Inbox fInvalidationInbox;
@@ -11,6 +11,7 @@
 #include "GrDrawTargetCaps.h"
 #include "GrGpu.h"
 
+#include "SkCoverageMask.h"
 #include "SkData.h"
 #include "SkStrokeRec.h"
 #include "SkTextureCompressor.h"
@@ -63,6 +64,21 @@ void GrSWMaskHelper::draw(const SkRect& rect, SkRegion::Op op,
 void GrSWMaskHelper::draw(const SkPath& path, const SkStrokeRec& stroke, SkRegion::Op op,
                           bool antiAlias, uint8_t alpha) {
 
+    // Opaque fills only need coverage, so skip the paint and blitter machinery.
+    if (stroke.isFillStyle() && 0xFF == alpha &&
+        (SkRegion::kReplace_Op == op || SkRegion::kUnion_Op == op)) {
+        SkMask mask;
+        mask.fImage = static_cast<uint8_t*>(fBM.getPixels());
+        mask.fBounds.set(0, 0, fBM.width(), fBM.height());
+        mask.fRowBytes = SkToU32(fBM.rowBytes());
+        mask.fFormat = SkMask::kA8_Format;
+        SkCoverageMask::Fill(path, fMatrix, mask.fBounds, antiAlias,
+                             SkRegion::kReplace_Op == op ? SkCoverageMask::kReplace_Op :
+                                                           SkCoverageMask::kUnion_Op,
+                             mask);
+        return;
+    }
+
     SkPaint paint;
     if (stroke.isHairlineStyle()) {
         paint.setStyle(SkPaint::kStroke_Style);
@@ -126,14 +142,18 @@ bool GrSWMaskHelper::getTexture(GrAutoScratchTexture* texture) {
     desc.fWidth = fBM.width();
     desc.fHeight = fBM.height();
 
+    desc.fConfig = kAlpha_8_GrPixelConfig;
+
 #if GR_COMPRESS_ALPHA_MASK
-    static const int kLATCBlockSize = 4;
-    if (desc.fWidth % kLATCBlockSize == 0 && desc.fHeight % kLATCBlockSize == 0) {
-        desc.fConfig = kLATC_GrPixelConfig;
-    } else {
-#endif
-        desc.fConfig = kAlpha_8_GrPixelConfig;
-#if GR_COMPRESS_ALPHA_MASK
+    // Both compressed alpha formats use 4x4 blocks. LATC is preferred since it encodes faster.
+    static const int kCompressedBlockSize = 4;
+    if (desc.fWidth % kCompressedBlockSize == 0 && desc.fHeight % kCompressedBlockSize == 0) {
+        const GrDrawTargetCaps* caps = fContext->getGpu()->caps();
+        if (caps->isConfigTexturable(kLATC_GrPixelConfig)) {
+            desc.fConfig = kLATC_GrPixelConfig;
+        } else if (caps->isConfigTexturable(kR11_EAC_GrPixelConfig)) {
+            desc.fConfig = kR11_EAC_GrPixelConfig;
+        }
     }
 #endif
 
@@ -168,12 +188,16 @@ void GrSWMaskHelper::toTexture(GrTexture *texture) {
     desc.fConfig = texture->config();
         
     // First see if we should compress this texture before uploading.
-    if (texture->config() == kLATC_GrPixelConfig) {
-        SkTextureCompressor::Format format = SkTextureCompressor::kLATC_Format;
-        SkAutoDataUnref latcData(SkTextureCompressor::CompressBitmapToFormat(fBM, format));
-        SkASSERT(NULL != latcData);
-
-        this->sendTextureData(texture, desc, latcData->data(), 0);
+    if (GrPixelConfigIsCompressed(texture->config())) {
+        SkTextureCompressor::Format format = kLATC_GrPixelConfig == texture->config() ?
+                                             SkTextureCompressor::kLATC_Format :
+                                             SkTextureCompressor::kR11_EAC_Format;
+        SkASSERT(kLATC_GrPixelConfig == texture->config() ||
+                 kR11_EAC_GrPixelConfig == texture->config());
+        SkAutoDataUnref compressedData(SkTextureCompressor::CompressBitmapToFormat(fBM, format));
+        SkASSERT(NULL != compressedData);
+
+        this->sendTextureData(texture, desc, compressedData->data(), 0);
     } else {
         // Looks like we have to send a full A8 texture. 
         this->sendTextureData(texture, desc, fBM.getPixels(), fBM.rowBytes());
@@ -0,0 +1,281 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrSlabPool.h"
+#include "SkThread.h"
+
+#ifdef SK_DEBUG
+    #define VALIDATE this->validate()
+#else
+    #define VALIDATE
+#endif
+
+// The slots of a slab are laid out after its header. Each starts with a pointer back to the slab,
+// and while it is free the space after that holds the offset of the next free slot. Slots are
+// identified by their offset from the start of the slab rather than an index, which saves a
+// division on each release.
+struct GrSlabPool::Slab {
+    GrSlabPool* fPool;
+    Slab*       fPrev;
+    Slab*       fNext;
+    int         fSizeClass;
+    int         fSlotSize;
+    int32_t     fUnusedOffset;      ///< first slot that has never been handed out
+    int32_t     fEndOffset;         ///< end of the last slot
+    int         fLiveCount;         ///< outstanding allocations, including remote releases that
+                                    ///< have not been taken back yet
+    int32_t     fFreeHead;          ///< first slot released through the owning pool, or -1
+    int32_t     fRemoteFreeHead;    ///< first slot released through other pools, or -1. Only
+                                    ///< changed with sk_atomic_cas.
+
+    static size_t HeaderSize() { return GR_CT_ALIGN_UP(sizeof(Slab), kAlignment); }
+
+    char* slot(int32_t offset) {
+        return reinterpret_cast<char*>(this) + offset;
+    }
+
+    int32_t* nextFree(int32_t offset) {
+        return reinterpret_cast<int32_t*>(this->slot(offset) + kPerAllocPad);
+    }
+
+    int32_t offsetOf(void* p) {
+        return static_cast<int32_t>(reinterpret_cast<char*>(p) - kPerAllocPad -
+                                    reinterpret_cast<char*>(this));
+    }
+
+    // Returns a slot released through the owning pool, or a slot that was never used, or NULL.
+    void* take() {
+        int32_t offset;
+        if (fFreeHead >= 0) {
+            offset = fFreeHead;
+            fFreeHead = *this->nextFree(offset);
+        } else if (fUnusedOffset < fEndOffset) {
+            offset = fUnusedOffset;
+            fUnusedOffset += fSlotSize;
+            *reinterpret_cast<Slab**>(this->slot(offset)) = this;
+        } else {
+            return NULL;
+        }
+        ++fLiveCount;
+        return this->slot(offset) + kPerAllocPad;
+    }
+
+    void releaseLocal(void* p) {
+        int32_t offset = this->offsetOf(p);
+        *this->nextFree(offset) = fFreeHead;
+        fFreeHead = offset;
+        --fLiveCount;
+    }
+
+    // This only ever pushes onto the list, and the owner only ever takes the whole list, so
+    // the compare and swap can't be fooled by the head being popped and pushed back in between.
+    void releaseRemote(void* p) {
+        int32_t offset = this->offsetOf(p);
+        int32_t head;
+        do {
+            head = fRemoteFreeHead;
+            *this->nextFree(offset) = head;
+        } while (!sk_atomic_cas(&fRemoteFreeHead, head, offset));
+    }
+
+    // Moves the remote releases onto the local free list and returns how many there were.
+    int takeRemoteReleases() {
+        int32_t head;
+        do {
+            head = fRemoteFreeHead;
+            if (head < 0) {
+                return 0;
+            }
+        } while (!sk_atomic_cas(&fRemoteFreeHead, head, -1));
+        int count = 1;
+        int32_t tail = head;
+        while (*this->nextFree(tail) >= 0) {
+            tail = *this->nextFree(tail);
+            ++count;
+        }
+        *this->nextFree(tail) = fFreeHead;
+        fFreeHead = head;
+        fLiveCount -= count;
+        return count;
+    }
+};
+
+static inline bool is_large(const void* header) {
+    return SkToBool(reinterpret_cast<intptr_t>(header) & 1);
+}
+
+GrSlabPool::GrSlabPool(size_t slabSize) {
+    // Each slab should hold at least a few of the largest slots.
+    size_t minSlabSize = Slab::HeaderSize() + 4 * (kPerAllocPad + kMaxSlotSize);
+    fSlabSize = GrSizeAlignUp(SkTMax(slabSize, minSlabSize), kAlignment);
+    for (int i = 0; i < kSizeClassCnt; ++i) {
+        fSlabs[i] = NULL;
+    }
+    fLiveCount = 0;
+    fLargeLiveCount = 0;
+    VALIDATE;
+}
+
+GrSlabPool::~GrSlabPool() {
+    SkDEBUGCODE(bool empty = this->isEmpty();)
+    SkASSERT(empty);
+    for (int i = 0; i < kSizeClassCnt; ++i) {
+        Slab* slab = fSlabs[i];
+        while (NULL != slab) {
+            Slab* next = slab->fNext;
+            slab->takeRemoteReleases();
+            // A slab with outstanding allocations may still be written to by release(), so it
+            // is leaked rather than freed.
+            if (0 == slab->fLiveCount) {
+                sk_free(slab);
+            }
+            slab = next;
+        }
+    }
+}
+
+void* GrSlabPool::allocate(size_t size) {
+    VALIDATE;
+    if (size > kMaxSlotSize) {
+        void* header = sk_malloc_throw(kPerAllocPad + size);
+        // Tag the pool pointer so release() can tell this apart from a slot.
+        *reinterpret_cast<intptr_t*>(header) = reinterpret_cast<intptr_t>(this) | 1;
+        sk_atomic_inc(&fLargeLiveCount);
+        return reinterpret_cast<char*>(header) + kPerAllocPad;
+    }
+
+    int sizeClass = 0 == size ? 0 : static_cast<int>((size - 1) / kSizeClassStep);
+    void* p = NULL;
+    if (NULL != fSlabs[sizeClass]) {
+        p = fSlabs[sizeClass]->take();
+    }
+    if (NULL == p) {
+        p = this->allocateFromSlabs(sizeClass);
+    }
+    ++fLiveCount;
+    VALIDATE;
+    return p;
+}
+
+void* GrSlabPool::allocateFromSlabs(int sizeClass) {
+    Slab* slab = fSlabs[sizeClass];
+    void* p = NULL;
+    for (; NULL != slab; slab = slab->fNext) {
+        fLiveCount -= slab->takeRemoteReleases();
+        if (NULL != (p = slab->take())) {
+            break;
+        }
+    }
+    if (NULL == slab) {
+        slab = this->createSlab(sizeClass);
+        p = slab->take();
+    } else if (slab != fSlabs[sizeClass]) {
+        // Allocate from this one until it fills up too.
+        slab->fPrev->fNext = slab->fNext;
+        if (NULL != slab->fNext) {
+            slab->fNext->fPrev = slab->fPrev;
+        }
+        slab->fPrev = NULL;
+        slab->fNext = fSlabs[sizeClass];
+        fSlabs[sizeClass]->fPrev = slab;
+        fSlabs[sizeClass] = slab;
+    }
+    SkASSERT(NULL != p);
+    return p;
+}
+
+void GrSlabPool::release(void* p) {
+    VALIDATE;
+    void* header = *reinterpret_cast<void**>(reinterpret_cast<char*>(p) - kPerAllocPad);
+    if (is_large(header)) {
+        GrSlabPool* pool = reinterpret_cast<GrSlabPool*>(reinterpret_cast<intptr_t>(header) & ~1);
+        sk_atomic_dec(&pool->fLargeLiveCount);
+        sk_free(reinterpret_cast<char*>(p) - kPerAllocPad);
+        return;
+    }
+
+    Slab* slab = reinterpret_cast<Slab*>(header);
+    if (slab->fPool != this) {
+        slab->releaseRemote(p);
+        return;
+    }
+    slab->releaseLocal(p);
+    --fLiveCount;
+    // Empty slabs are freed, except for the one being allocated from.
+    if (0 == slab->fLiveCount && slab != fSlabs[slab->fSizeClass]) {
+        this->deleteSlab(slab);
+    }
+    VALIDATE;
+}
+
+bool GrSlabPool::isEmpty() {
+    for (int i = 0; i < kSizeClassCnt; ++i) {
+        for (Slab* slab = fSlabs[i]; NULL != slab; slab = slab->fNext) {
+            fLiveCount -= slab->takeRemoteReleases();
+        }
+    }
+    VALIDATE;
+    return 0 == fLiveCount && 0 == sk_atomic_add(&fLargeLiveCount, 0);
+}
+
+GrSlabPool::Slab* GrSlabPool::createSlab(int sizeClass) {
+    Slab* slab = reinterpret_cast<Slab*>(sk_malloc_throw(fSlabSize));
+    // we assume malloc gives us aligned memory
+    SkASSERT(!(reinterpret_cast<intptr_t>(slab) % kAlignment));
+    slab->fPool = this;
+    slab->fSizeClass = sizeClass;
+    slab->fSlotSize = kPerAllocPad + (sizeClass + 1) * kSizeClassStep;
+    size_t slotCount = (fSlabSize - Slab::HeaderSize()) / slab->fSlotSize;
+    slab->fUnusedOffset = static_cast<int32_t>(Slab::HeaderSize());
+    slab->fEndOffset = static_cast<int32_t>(Slab::HeaderSize() + slotCount * slab->fSlotSize);
+    slab->fLiveCount = 0;
+    slab->fFreeHead = -1;
+    slab->fRemoteFreeHead = -1;
+
+    slab->fPrev = NULL;
+    slab->fNext = fSlabs[sizeClass];
+    if (NULL != slab->fNext) {
+        slab->fNext->fPrev = slab;
+    }
+    fSlabs[sizeClass] = slab;
+    return slab;
+}
+
+void GrSlabPool::deleteSlab(Slab* slab) {
+    SkASSERT(0 == slab->fLiveCount);
+    if (NULL != slab->fPrev) {
+        slab->fPrev->fNext = slab->fNext;
+    } else {
+        SkASSERT(fSlabs[slab->fSizeClass] == slab);
+        fSlabs[slab->fSizeClass] = slab->fNext;
+    }
+    if (NULL != slab->fNext) {
+        slab->fNext->fPrev = slab->fPrev;
+    }
+    sk_free(slab);
+}
+
+void GrSlabPool::validate() const {
+#ifdef SK_DEBUG
+    int liveCount = 0;
+    for (int i = 0; i < kSizeClassCnt; ++i) {
+        const Slab* prev = NULL;
+        for (const Slab* slab = fSlabs[i]; NULL != slab; slab = slab->fNext) {
+            SkASSERT(this == slab->fPool);
+            SkASSERT(i == slab->fSizeClass);
+            SkASSERT(prev == slab->fPrev);
+            SkASSERT(!(slab->fSlotSize % kAlignment));
+            SkASSERT(slab->fUnusedOffset <= slab->fEndOffset);
+            SkASSERT(slab->fLiveCount >= 0 && slab->fLiveCount * slab->fSlotSize <=
+                     slab->fUnusedOffset - static_cast<int32_t>(Slab::HeaderSize()));
+            liveCount += slab->fLiveCount;
+            prev = slab;
+        }
+    }
+    SkASSERT(liveCount == fLiveCount);
+#endif
+}
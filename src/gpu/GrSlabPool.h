@@ -0,0 +1,86 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrSlabPool_DEFINED
+#define GrSlabPool_DEFINED
+
+#include "GrTypes.h"
+
+/**
+ * Allocates small objects from slabs that each hold slots of a single size class, and recycles
+ * released slots for later allocations of the same class. Larger requests go straight to the heap.
+ * Like GrMemoryPool, the interface is designed to be used to implement operator new and delete
+ * overrides, and allocations will be 8-byte aligned.
+ *
+ * A pool must only be used by one thread at a time, typically by keeping one per thread in TLS.
+ * However, release() accepts memory allocated by any pool: memory from another pool is handed back
+ * to its own slab without locking, and that pool reuses it once its own slabs run out of space.
+ * All allocations are expected to be released before the pool's destructor is called; slabs that
+ * still hold allocations at that point are leaked rather than freed.
+ */
+class GrSlabPool {
+public:
+    /**
+     * Slab size is the amount of memory allocated at a time for each size class in use. It is
+     * raised if needed to hold a few of the largest slots.
+     */
+    explicit GrSlabPool(size_t slabSize = kDefaultSlabSize);
+
+    ~GrSlabPool();
+
+    /**
+     * Allocates memory. The memory must be freed with release().
+     */
+    void* allocate(size_t size);
+
+    /**
+     * p must have been returned by allocate() on this or any other GrSlabPool.
+     */
+    void release(void* p);
+
+    /**
+     * Returns true if there are no unreleased allocations. This first takes back any memory
+     * released through other pools.
+     */
+    bool isEmpty();
+
+    enum {
+        kDefaultSlabSize = 16 * 1024,
+        // Requests larger than this are not pooled.
+        kMaxSlotSize     = 256,
+    };
+
+private:
+    struct Slab;
+
+    enum {
+        kAlignment      = 8,
+        kSizeClassStep  = 16,
+        kSizeClassCnt   = kMaxSlotSize / kSizeClassStep,
+        // Each allocation is preceded by a pointer to its slab.
+        kPerAllocPad    = GR_CT_ALIGN_UP(sizeof(Slab*), kAlignment),
+    };
+
+    Slab* createSlab(int sizeClass);
+
+    void deleteSlab(Slab* slab);
+
+    // Returns a slot from the class's slabs, taking back remote releases if the slabs are
+    // otherwise full, or NULL if all are in use.
+    void* allocateFromSlabs(int sizeClass);
+
+    void validate() const;
+
+    size_t  fSlabSize;
+    // The slabs of each size class. The first one is allocated from until it is full.
+    Slab*   fSlabs[kSizeClassCnt];
+    int     fLiveCount;
+    // Unpooled allocations may be released through other pools, so this is changed atomically.
+    int32_t fLargeLiveCount;
+};
+
+#endif
@@ -0,0 +1,188 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrStencilAndCoverTextContext.h"
+#include "GrContext.h"
+#include "GrDrawTarget.h"
+#include "GrDrawTargetCaps.h"
+#include "GrGpu.h"
+#include "GrPath.h"
+#include "GrTracing.h"
+#include "SkStrokeRec.h"
+#include "SkTextToPathIter.h"
+
+GrStencilAndCoverTextContext::GrStencilAndCoverTextContext(GrContext* context,
+                                                           const SkDeviceProperties& properties)
+    : GrTextContext(context, properties)
+    , fFillType(SkPath::kWinding_FillType) {
+}
+
+GrStencilAndCoverTextContext::~GrStencilAndCoverTextContext() {
+    this->flushGlyphs();
+}
+
+bool GrStencilAndCoverTextContext::canDraw(const SkPaint& paint) {
+    if (!fContext->getGpu()->caps()->pathRenderingSupport()) {
+        return false;
+    }
+
+    // The outlines are shared between sizes, so anything that changes them per draw is out.
+    if (paint.getRasterizer() || paint.getMaskFilter() || paint.getPathEffect()) {
+        return false;
+    }
+
+    // TODO: add stroking support, with the stroke scaled to the canonical size.
+    if (paint.getStyle() != SkPaint::kFill_Style || paint.isVerticalText()) {
+        return false;
+    }
+
+    // Path rendering has no per-path antialiasing; it relies on multisampling.
+    const GrRenderTarget* rt = fContext->getRenderTarget();
+    if (NULL == rt || NULL == rt->getStencilBuffer() ||
+        (paint.isAntiAlias() && !rt->isMultisampled())) {
+        return false;
+    }
+
+    const SkMatrix& ctm = fContext->getMatrix();
+    if (ctm.hasPerspective()) {
+        return true;
+    }
+    SkMatrix textM;
+    paint.setTextMatrix(&textM);
+    textM.postConcat(ctm);
+    return textM.getMaxScale() >= kMinDeviceTextSize;
+}
+
+void GrStencilAndCoverTextContext::drawText(const GrPaint& paint, const SkPaint& skPaint,
+                                            const char text[], size_t byteLength,
+                                            SkScalar x, SkScalar y) {
+    SkASSERT(byteLength == 0 || text != NULL);
+
+    if (text == NULL || byteLength == 0) {
+        return;
+    }
+
+    this->init(paint, skPaint);
+
+    // The iterator handles alignment and kerning, and gives the canonical-size outlines.
+    SkTextToPathIter iter(text, byteLength, skPaint, false);
+    const SkScalar scale = iter.getPathScale();
+
+    const SkPath* path;
+    SkScalar xpos;
+    while (iter.next(&path, &xpos)) {
+        if (NULL != path) {
+            SkMatrix transform;
+            transform.setScale(scale, scale);
+            transform.postTranslate(x + xpos, y);
+            this->appendGlyph(*path, transform);
+        }
+    }
+
+    this->finish();
+}
+
+void GrStencilAndCoverTextContext::drawPosText(const GrPaint& paint, const SkPaint& skPaint,
+                                               const char text[], size_t byteLength,
+                                               const SkScalar pos[], SkScalar constY,
+                                               int scalarsPerPosition) {
+    SkASSERT(byteLength == 0 || text != NULL);
+    SkASSERT(1 == scalarsPerPosition || 2 == scalarsPerPosition);
+
+    // nothing to draw
+    if (text == NULL || byteLength == 0) {
+        return;
+    }
+
+    this->init(paint, skPaint);
+
+    // Each glyph is placed by its position, so only the iterator's outlines are used. It is
+    // given a left aligned paint, and other alignments are applied here from the advances.
+    SkPaint leftPaint(skPaint);
+    leftPaint.setTextAlign(SkPaint::kLeft_Align);
+    SkTextToPathIter iter(text, byteLength, leftPaint, false);
+    const SkScalar scale = iter.getPathScale();
+
+    SkAutoSTMalloc<64, SkScalar> widths;
+    SkScalar alignScale = 0;
+    if (SkPaint::kLeft_Align != skPaint.getTextAlign()) {
+        widths.reset(skPaint.textToGlyphs(text, byteLength, NULL));
+        skPaint.getTextWidths(text, byteLength, widths.get());
+        alignScale = SkPaint::kCenter_Align == skPaint.getTextAlign() ? -SK_ScalarHalf
+                                                                       : -SK_Scalar1;
+    }
+
+    const SkPath* path;
+    int index = 0;
+    while (iter.next(&path, NULL)) {
+        if (NULL != path) {
+            SkScalar px = pos[index * scalarsPerPosition];
+            SkScalar py = 2 == scalarsPerPosition ? pos[index * 2 + 1] : constY;
+            if (0 != alignScale) {
+                px += SkScalarMul(widths[index], alignScale);
+            }
+            SkMatrix transform;
+            transform.setScale(scale, scale);
+            transform.postTranslate(px, py);
+            this->appendGlyph(*path, transform);
+        }
+        ++index;
+    }
+
+    this->finish();
+}
+
+void GrStencilAndCoverTextContext::appendGlyph(const SkPath& path, const SkMatrix& transform) {
+    // One drawPaths() call has a single fill type; glyphs almost always share it.
+    if (fPaths.count() > 0 && path.getFillType() != fFillType) {
+        this->flushGlyphs();
+    }
+    fFillType = path.getFillType();
+
+    // The glyph's outline lives in the canonical strike, so its generation ID (and the
+    // GrPath cached for it) is the same at every size.
+    SkStrokeRec stroke(SkStrokeRec::kFill_InitStyle);
+    *fPaths.append() = fContext->createPath(path, stroke);
+    *fTransforms.append() = transform;
+}
+
+void GrStencilAndCoverTextContext::flushGlyphs() {
+    if (0 == fPaths.count()) {
+        return;
+    }
+    SkASSERT(NULL != fDrawTarget);
+    GR_CREATE_TRACE_MARKER("GrStencilAndCoverTextContext::flushGlyphs", fDrawTarget);
+
+    GrDrawState* drawState = fDrawTarget->drawState();
+    GrDrawState::AutoRestoreEffects are(drawState);
+    drawState->setFromPaint(fPaint, fContext->getMatrix(), fContext->getRenderTarget());
+
+    GR_STATIC_CONST_SAME_STENCIL(kStencilPass,
+        kZero_StencilOp,
+        kZero_StencilOp,
+        kNotEqual_StencilFunc,
+        0xffff,
+        0x0000,
+        0xffff);
+
+    *drawState->stencil() = kStencilPass;
+    fDrawTarget->drawPaths(fPaths.count(), fPaths.begin(), fTransforms.begin(), fFillType,
+                           SkStrokeRec::kFill_Style);
+    drawState->stencil()->setDisabled();
+
+    // The draw target holds its own refs.
+    for (int i = 0; i < fPaths.count(); ++i) {
+        fPaths[i]->unref();
+    }
+    fPaths.rewind();
+    fTransforms.rewind();
+}
+
+void GrStencilAndCoverTextContext::finish() {
+    this->flushGlyphs();
+    GrTextContext::finish();
+}
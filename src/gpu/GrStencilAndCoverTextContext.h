@@ -0,0 +1,53 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrStencilAndCoverTextContext_DEFINED
+#define GrStencilAndCoverTextContext_DEFINED
+
+#include "GrTextContext.h"
+#include "SkPath.h"
+#include "SkTDArray.h"
+
+class GrPath;
+
+/*
+ * This class implements GrTextContext for large glyphs by drawing their outlines with path
+ * rendering (stencil-and-cover), instead of rasterizing a mask per glyph per size. Outlines are
+ * taken from the canonical-size path strike, so each glyph's GrPath is created once and reused
+ * for every size and transform; a whole run is drawn with one drawPaths() call.
+ */
+class GrStencilAndCoverTextContext : public GrTextContext {
+public:
+    GrStencilAndCoverTextContext(GrContext*, const SkDeviceProperties&);
+    virtual ~GrStencilAndCoverTextContext();
+
+    virtual void drawText(const GrPaint&, const SkPaint&, const char text[], size_t byteLength,
+                          SkScalar x, SkScalar y) SK_OVERRIDE;
+    virtual void drawPosText(const GrPaint&, const SkPaint&,
+                             const char text[], size_t byteLength,
+                             const SkScalar pos[], SkScalar constY,
+                             int scalarsPerPosition) SK_OVERRIDE;
+
+    virtual bool canDraw(const SkPaint& paint) SK_OVERRIDE;
+
+private:
+    enum {
+        // Device text sizes from here up are drawn as paths. Their masks would each take
+        // a good part of an atlas plot, or not fit at all.
+        kMinDeviceTextSize = 128,
+    };
+
+    void appendGlyph(const SkPath&, const SkMatrix& transform);
+    void flushGlyphs();
+    void finish();
+
+    SkTDArray<const GrPath*> fPaths;     // each holds a ref
+    SkTDArray<SkMatrix>      fTransforms;
+    SkPath::FillType         fFillType;
+};
+
+#endif
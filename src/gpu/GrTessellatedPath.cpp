@@ -0,0 +1,80 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrTessellatedPath.h"
+#include "GrGpu.h"
+
+GrResourceKey GrTessellatedPath::ComputeKey(GrCacheID::Domain domain,
+                                            uint32_t genID,
+                                            const uint32_t params[3]) {
+    static const GrResourceKey::ResourceType gTessellatedPathResourceType =
+        GrResourceKey::GenerateResourceType();
+
+    GrCacheID::Key key;
+    uint32_t* keyData = key.fData32;
+    keyData[0] = genID;
+    keyData[1] = params[0];
+    keyData[2] = params[1];
+    keyData[3] = params[2];
+
+    return GrResourceKey(GrCacheID(domain, key), gTessellatedPathResourceType, 0);
+}
+
+GrTessellatedPath* GrTessellatedPath::Create(GrGpu* gpu,
+                                             const void* vertices, size_t vertexSize,
+                                             int vertexCnt,
+                                             const uint16_t* indices, int indexCnt,
+                                             const Draw draws[], int drawCnt,
+                                             GrPrimitiveType primType,
+                                             const SkRect& bounds) {
+    SkASSERT(vertexCnt > 0 && drawCnt > 0);
+    SkASSERT(NULL != indices || 0 == indexCnt);
+
+    size_t vertexBytes = vertexSize * vertexCnt;
+    SkAutoTUnref<GrVertexBuffer> vb(gpu->createVertexBuffer(vertexBytes, false));
+    if (NULL == vb.get() || !vb->updateData(vertices, vertexBytes)) {
+        return NULL;
+    }
+    SkAutoTUnref<GrIndexBuffer> ib;
+    if (indexCnt > 0) {
+        size_t indexBytes = sizeof(uint16_t) * indexCnt;
+        ib.reset(gpu->createIndexBuffer(indexBytes, false));
+        if (NULL == ib.get() || !ib->updateData(indices, indexBytes)) {
+            return NULL;
+        }
+    }
+    return SkNEW_ARGS(GrTessellatedPath, (vb.detach(), ib.detach(), draws, drawCnt,
+                                          primType, bounds));
+}
+
+GrTessellatedPath::GrTessellatedPath(GrVertexBuffer* vb, GrIndexBuffer* ib,
+                                     const Draw draws[], int drawCnt,
+                                     GrPrimitiveType primType, const SkRect& bounds)
+    : fVertexBuffer(vb)
+    , fIndexBuffer(ib)
+    , fPrimitiveType(primType)
+    , fBounds(bounds) {
+    fDraws.append(drawCnt, draws);
+}
+
+GrTessellatedPath::~GrTessellatedPath() {
+    fVertexBuffer->unref();
+    SkSafeUnref(fIndexBuffer);
+}
+
+size_t GrTessellatedPath::gpuMemorySize() const {
+    size_t size = fVertexBuffer->gpuMemorySize();
+    if (NULL != fIndexBuffer) {
+        size += fIndexBuffer->gpuMemorySize();
+    }
+    return size;
+}
+
+bool GrTessellatedPath::isValidOnGpu() const {
+    return fVertexBuffer->isValidOnGpu() &&
+           (NULL == fIndexBuffer || fIndexBuffer->isValidOnGpu());
+}
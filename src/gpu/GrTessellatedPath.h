@@ -0,0 +1,146 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrTessellatedPath_DEFINED
+#define GrTessellatedPath_DEFINED
+
+#include "GrCacheable.h"
+#include "GrDrawTarget.h"
+#include "GrIndexBuffer.h"
+#include "GrResourceCache.h"
+#include "GrVertexBuffer.h"
+#include "SkRect.h"
+#include "SkTDArray.h"
+
+class GrGpu;
+
+/**
+ * Vertices and indices that a path renderer generated for a path, kept in static buffers so that
+ * the path can be drawn again without re-tessellating it or streaming the geometry through the
+ * draw target's pools. Entries live in the GrResourceCache under a key made from the path's
+ * generation ID and whatever else the renderer's tessellation depends on.
+ */
+class GrTessellatedPath : public GrCacheable {
+public:
+    SK_DECLARE_INST_COUNT(GrTessellatedPath);
+
+    /** A run of vertices and indices drawn with one draw call. The runs are consecutive. */
+    struct Draw {
+        int fVertexCnt;
+        int fIndexCnt;
+    };
+
+    /**
+     * The domain distinguishes the path renderers. params are the renderer's own tessellation
+     * parameters; they must fit the remaining three words of the key.
+     */
+    static GrResourceKey ComputeKey(GrCacheID::Domain domain,
+                                    uint32_t genID,
+                                    const uint32_t params[3]);
+
+    /**
+     * Uploads the geometry to new static buffers. indices may be NULL if indexCnt is zero. Returns
+     * NULL if the buffers could not be created.
+     */
+    static GrTessellatedPath* Create(GrGpu* gpu,
+                                     const void* vertices, size_t vertexSize, int vertexCnt,
+                                     const uint16_t* indices, int indexCnt,
+                                     const Draw draws[], int drawCnt,
+                                     GrPrimitiveType primType,
+                                     const SkRect& bounds);
+
+    virtual ~GrTessellatedPath();
+
+    const GrVertexBuffer* vertexBuffer() const { return fVertexBuffer; }
+    /** NULL when the geometry is not indexed. */
+    const GrIndexBuffer* indexBuffer() const { return fIndexBuffer; }
+
+    GrPrimitiveType primitiveType() const { return fPrimitiveType; }
+    int drawCount() const { return fDraws.count(); }
+    const Draw& draw(int i) const { return fDraws[i]; }
+
+    /** Bounds of the vertex positions, in the space the renderer tessellated in. */
+    const SkRect& bounds() const { return fBounds; }
+
+    virtual size_t gpuMemorySize() const SK_OVERRIDE;
+    virtual bool isValidOnGpu() const SK_OVERRIDE;
+
+    /**
+     * Sets a target's vertex and index sources to the cached buffers, and resets them in the
+     * destructor.
+     */
+    class AutoGeometrySrc : public ::SkNoncopyable {
+    public:
+        AutoGeometrySrc() : fTarget(NULL), fIndexed(false) {}
+        ~AutoGeometrySrc() { this->reset(); }
+
+        void set(GrDrawTarget* target, const GrTessellatedPath* geom) {
+            this->reset();
+            fTarget = target;
+            fIndexed = NULL != geom->indexBuffer();
+            target->setVertexSourceToBuffer(geom->vertexBuffer());
+            if (fIndexed) {
+                target->setIndexSourceToBuffer(geom->indexBuffer());
+            }
+        }
+
+        void reset() {
+            if (NULL != fTarget) {
+                fTarget->resetVertexSource();
+                if (fIndexed) {
+                    fTarget->resetIndexSource();
+                }
+                fTarget = NULL;
+            }
+        }
+
+    private:
+        GrDrawTarget*   fTarget;
+        bool            fIndexed;
+    };
+
+    /**
+     * Remembers the generation IDs of the last few paths a renderer drew. Renderers only cache a
+     * path's geometry once they have seen it twice, so that paths which are built for a single
+     * draw don't fill the cache.
+     */
+    class RecentGenIDs {
+    public:
+        RecentGenIDs() : fNext(0) { memset(fIDs, 0, sizeof(fIDs)); }
+
+        /** Returns true if genID was already among the recent IDs, and records it if not. */
+        bool checkAndAdd(uint32_t genID) {
+            for (int i = 0; i < kCount; ++i) {
+                if (fIDs[i] == genID) {
+                    return true;
+                }
+            }
+            fIDs[fNext] = genID;
+            fNext = (fNext + 1) % kCount;
+            return false;
+        }
+
+    private:
+        static const int kCount = 32;
+        uint32_t    fIDs[kCount];
+        int         fNext;
+    };
+
+private:
+    GrTessellatedPath(GrVertexBuffer*, GrIndexBuffer*, const Draw draws[], int drawCnt,
+                      GrPrimitiveType, const SkRect& bounds);
+
+    GrVertexBuffer*     fVertexBuffer;
+    GrIndexBuffer*      fIndexBuffer;
+    SkTDArray<Draw>     fDraws;
+    GrPrimitiveType     fPrimitiveType;
+    SkRect              fBounds;
+
+    typedef GrCacheable INHERITED;
+};
+
+#endif
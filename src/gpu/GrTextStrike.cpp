@@ -24,6 +24,11 @@
 #define GR_NUM_PLOTS_X   (GR_ATLAS_TEXTURE_WIDTH / GR_PLOT_WIDTH)
 #define GR_NUM_PLOTS_Y   (GR_ATLAS_TEXTURE_HEIGHT / GR_PLOT_HEIGHT)
 
+// Further atlas textures are only allocated once the previous ones are full. A8 glyphs get the
+// most pages since scripts with large glyph sets mostly render through them.
+#define GR_A8_ATLAS_MAX_PAGES    4
+#define GR_COLOR_ATLAS_MAX_PAGES 2
+
 #define FONT_CACHE_STATS 0
 #if FONT_CACHE_STATS
 static int g_PurgeCount = 0;
@@ -74,6 +79,11 @@ static int mask_format_to_atlas_index(GrMaskFormat format) {
     return sAtlasIndices[format];
 }
 
+static int atlas_index_to_max_pages(int atlasIndex) {
+    return GrFontCache::kA8_AtlasType == atlasIndex ? GR_A8_ATLAS_MAX_PAGES
+                                                    : GR_COLOR_ATLAS_MAX_PAGES;
+}
+
 GrTextStrike* GrFontCache::generateStrike(GrFontScaler* scaler,
                                           const Key& key) {
     GrMaskFormat format = scaler->getMaskFormat();
@@ -86,7 +96,8 @@ GrTextStrike* GrFontCache::generateStrike(GrFontScaler* scaler,
                                                         textureSize,
                                                         GR_NUM_PLOTS_X,
                                                         GR_NUM_PLOTS_Y,
-                                                        true));
+                                                        true,
+                                                        atlas_index_to_max_pages(atlasIndex)));
     }
     GrTextStrike* strike = SkNEW_ARGS(GrTextStrike,
                                       (this, scaler->getKey(), format, fAtlasMgr[atlasIndex]));
@@ -190,14 +201,17 @@ void GrFontCache::validate() const {
 void GrFontCache::dump() const {
     static int gDumpCount = 0;
     for (int i = 0; i < kAtlasCount; ++i) {
-        if (NULL != fAtlasMgr[i]) {
-            GrTexture* texture = fAtlasMgr[i]->getTexture();
+        if (NULL == fAtlasMgr[i]) {
+            continue;
+        }
+        for (int page = 0; page < fAtlasMgr[i]->maxPages(); ++page) {
+            GrTexture* texture = fAtlasMgr[i]->getTexture(page);
             if (NULL != texture) {
                 SkString filename;
 #ifdef SK_BUILD_FOR_ANDROID
-                filename.printf("/sdcard/fontcache_%d%d.png", gDumpCount, i);
+                filename.printf("/sdcard/fontcache_%d%d_%d.png", gDumpCount, i, page);
 #else
-                filename.printf("fontcache_%d%d.png", gDumpCount, i);
+                filename.printf("fontcache_%d%d_%d.png", gDumpCount, i, page);
 #endif
                 texture->savePixels(filename.c_str());
             }
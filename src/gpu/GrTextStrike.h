@@ -97,6 +97,17 @@ public:
         }
     }
 
+    // the bytes of the atlas textures, which are kept until freeAll()
+    size_t gpuMemorySize() const {
+        size_t bytes = 0;
+        for (int i = 0; i < kAtlasCount; ++i) {
+            if (fAtlasMgr[i]) {
+                bytes += fAtlasMgr[i]->gpuMemorySize();
+            }
+        }
+        return bytes;
+    }
+
 #ifdef SK_DEBUG
     void validate() const;
 #else
@@ -19,6 +19,7 @@ GrTexture::~GrTexture() {
     if (NULL != fRenderTarget.get()) {
         fRenderTarget.get()->owningTextureDestroyed();
     }
+    this->invokeReleaseProc();
 }
 
 /**
@@ -64,21 +65,7 @@ size_t GrTexture::gpuMemorySize() const {
                                    GrBytesPerPixel(fDesc.fConfig);
 
     if (GrPixelConfigIsCompressed(fDesc.fConfig)) {
-        // Figure out the width and height corresponding to the data...
-
-        // Both of the available formats (ETC1 and LATC) have 4x4
-        // blocks that compress down to 8 bytes.
-        switch(fDesc.fConfig) {
-            case kETC1_GrPixelConfig:
-            case kLATC_GrPixelConfig:
-                SkASSERT((fDesc.fWidth & 3) == 0);
-                SkASSERT((fDesc.fHeight & 3) == 0);
-                textureSize = (fDesc.fWidth >> 2) * (fDesc.fHeight >> 2) * 8;
-                break;
-
-            default:
-                SkFAIL("Unknown compressed config");
-        }
+        textureSize = GrCompressedFormatDataSize(fDesc.fConfig, fDesc.fWidth, fDesc.fHeight);
     }
 
     if (this->impl()->hasMipMaps()) {
@@ -119,6 +106,7 @@ void GrTexture::writePixels(int left, int top, int width, int height,
 
 void GrTexture::onRelease() {
     SkASSERT(!this->impl()->isSetFlag((GrTextureFlags) GrTextureImpl::kReturnToCache_FlagBit));
+    this->invokeReleaseProc();
     INHERITED::onRelease();
 }
 
@@ -126,9 +114,18 @@ void GrTexture::onAbandon() {
     if (NULL != fRenderTarget.get()) {
         fRenderTarget->abandon();
     }
+    this->invokeReleaseProc();
     INHERITED::onAbandon();
 }
 
+void GrTexture::invokeReleaseProc() {
+    if (NULL != fReleaseProc) {
+        ReleaseProc proc = fReleaseProc;
+        fReleaseProc = NULL;
+        proc(fReleaseContext);
+    }
+}
+
 void GrTexture::validateDesc() const {
     if (NULL != this->asRenderTarget()) {
         // This texture has a render target
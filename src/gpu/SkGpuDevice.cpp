@@ -15,9 +15,12 @@
 #include "GrContext.h"
 #include "GrBitmapTextContext.h"
 #include "GrDistanceFieldTextContext.h"
+#include "GrGpu.h"
+#include "GrStencilAndCoverTextContext.h"
 #include "GrLayerCache.h"
 #include "GrPictureUtils.h"
 #include "GrStrokeInfo.h"
+#include "GrTracing.h"
 
 #include "SkGrTexturePixelRef.h"
 
@@ -29,6 +32,7 @@
 #include "SkPathEffect.h"
 #include "SkPicture.h"
 #include "SkPicturePlayback.h"
+#include "SkRasterClip.h"
 #include "SkRRect.h"
 #include "SkStroke.h"
 #include "SkSurface.h"
@@ -169,6 +173,10 @@ void SkGpuDevice::initFromRenderTarget(GrContext* context,
     bool useDFFonts = !!(flags & kDFFonts_Flag);
     fMainTextContext = SkNEW_ARGS(GrDistanceFieldTextContext, (fContext, fLeakyProperties,
                                                                useDFFonts));
+    fPathTextContext = NULL;
+    if (fContext->getGpu()->caps()->pathRenderingSupport()) {
+        fPathTextContext = SkNEW_ARGS(GrStencilAndCoverTextContext, (fContext, fLeakyProperties));
+    }
     fFallbackTextContext = SkNEW_ARGS(GrBitmapTextContext, (fContext, fLeakyProperties));
 
     fRenderTarget = NULL;
@@ -233,6 +241,7 @@ SkGpuDevice::~SkGpuDevice() {
     }
 
     delete fMainTextContext;
+    delete fPathTextContext;
     delete fFallbackTextContext;
 
     // The GrContext takes a ref on the target. We don't want to cause the render
@@ -856,22 +865,20 @@ static inline int get_tile_count(const SkIRect& srcRect, int tileSize)  {
     return tilesX * tilesY;
 }
 
-static int determine_tile_size(const SkBitmap& bitmap, const SkIRect& src, int maxTileSize) {
-    if (maxTileSize <= kBmpSmallTileSize) {
-        return maxTileSize;
-    }
-
-    size_t maxTileTotalTileSize = get_tile_count(src, maxTileSize);
-    size_t smallTotalTileSize = get_tile_count(src, kBmpSmallTileSize);
-
-    maxTileTotalTileSize *= maxTileSize * maxTileSize;
-    smallTotalTileSize *= kBmpSmallTileSize * kBmpSmallTileSize;
+// Tiles are drawn on a fixed grid of this size, so that a tile's texture doesn't depend on how
+// much of the bitmap is visible and can be found in the cache again as the view changes.
+static int determine_tile_size(int maxTileSize) {
+    return SkTMin(maxTileSize, kBmpSmallTileSize);
+}
 
-    if (maxTileTotalTileSize > 2 * smallTotalTileSize) {
-        return kBmpSmallTileSize;
-    } else {
-        return maxTileSize;
-    }
+// Returns the bounds of the texture for the tile at cell: the cell, plus the texels within reach
+// of the filter across its edges, within the bitmap. These depend on neither the src rect nor the
+// clip, so that the texture cached for the tile is reused by later draws of the bitmap.
+static bool tile_texture_bounds(const SkIRect& cell, int outset, const SkIRect& bmpBounds,
+                                SkIRect* bounds) {
+    *bounds = cell;
+    bounds->outset(outset, outset);
+    return bounds->intersect(bmpBounds);
 }
 
 // Given a bitmap, an optional src rect, and a context with a clip and matrix determine what
@@ -918,7 +925,7 @@ bool SkGpuDevice::shouldTileBitmap(const SkBitmap& bitmap,
     // if it's larger than the max tile size, then we have no choice but tiling.
     if (bitmap.width() > maxTileSize || bitmap.height() > maxTileSize) {
         determine_clipped_src_rect(fContext, bitmap, srcRectPtr, clippedSrcRect);
-        *tileSize = determine_tile_size(bitmap, *clippedSrcRect, maxTileSize);
+        *tileSize = determine_tile_size(maxTileSize);
         return true;
     }
 
@@ -947,7 +954,7 @@ bool SkGpuDevice::shouldTileBitmap(const SkBitmap& bitmap,
 
     // Figure out how much of the src we will need based on the src rect and clipping.
     determine_clipped_src_rect(fContext, bitmap, srcRectPtr, clippedSrcRect);
-    *tileSize = kBmpSmallTileSize; // already know whole bitmap fits in one max sized tile.
+    *tileSize = determine_tile_size(maxTileSize);
     size_t usedTileBytes = get_tile_count(*clippedSrcRect, kBmpSmallTileSize) *
                            kBmpSmallTileSize * kBmpSmallTileSize;
 
@@ -967,39 +974,6 @@ void SkGpuDevice::drawBitmap(const SkDraw& origDraw,
     this->drawBitmapCommon(*draw, bitmap, NULL, NULL, paint, SkCanvas::kNone_DrawBitmapRectFlag);
 }
 
-// This method outsets 'iRect' by 'outset' all around and then clamps its extents to
-// 'clamp'. 'offset' is adjusted to remain positioned over the top-left corner
-// of 'iRect' for all possible outsets/clamps.
-static inline void clamped_outset_with_offset(SkIRect* iRect,
-                                              int outset,
-                                              SkPoint* offset,
-                                              const SkIRect& clamp) {
-    iRect->outset(outset, outset);
-
-    int leftClampDelta = clamp.fLeft - iRect->fLeft;
-    if (leftClampDelta > 0) {
-        offset->fX -= outset - leftClampDelta;
-        iRect->fLeft = clamp.fLeft;
-    } else {
-        offset->fX -= outset;
-    }
-
-    int topClampDelta = clamp.fTop - iRect->fTop;
-    if (topClampDelta > 0) {
-        offset->fY -= outset - topClampDelta;
-        iRect->fTop = clamp.fTop;
-    } else {
-        offset->fY -= outset;
-    }
-
-    if (iRect->fRight > clamp.fRight) {
-        iRect->fRight = clamp.fRight;
-    }
-    if (iRect->fBottom > clamp.fBottom) {
-        iRect->fBottom = clamp.fBottom;
-    }
-}
-
 static bool has_aligned_samples(const SkRect& srcRect,
                                 const SkRect& transformedRect) {
     // detect pixel disalignment
@@ -1217,6 +1191,63 @@ void SkGpuDevice::drawBitmapCommon(const SkDraw& draw,
     }
 }
 
+// The most tiles uploaded ahead of being drawn, per draw.
+static const int kMaxPrefetchTiles = 2;
+
+// Uploads the textures of tiles that are within half a tile of the visible part of the bitmap,
+// but not yet visible, so that they are already in the cache when a pan or scroll reveals them.
+// This only uses space the cache has to spare.
+static void prefetch_tiles(GrContext* context,
+                           const SkBitmap& bitmap,
+                           const SkRect& srcRect,
+                           const SkIRect& clippedSrcIRect,
+                           const GrTextureParams& params,
+                           int tileSize,
+                           int outset) {
+    if (bitmap.isVolatile() || clippedSrcIRect.isEmpty()) {
+        return;
+    }
+    SkIRect bmpBounds = SkIRect::MakeWH(bitmap.width(), bitmap.height());
+    SkIRect nearby = clippedSrcIRect;
+    nearby.outset(tileSize / 2, tileSize / 2);
+    SkIRect iSrcRect;
+    srcRect.roundOut(&iSrcRect);
+    if (!nearby.intersect(iSrcRect) || !nearby.intersect(bmpBounds)) {
+        return;
+    }
+
+    size_t maxBytes, usedBytes;
+    context->getResourceCacheLimits(NULL, &maxBytes);
+    context->getResourceCacheUsage(NULL, &usedBytes);
+    size_t tileBytes = (tileSize + 2 * outset) * (tileSize + 2 * outset) * bitmap.bytesPerPixel();
+
+    int prefetched = 0;
+    for (int y = nearby.fTop / tileSize; y <= (nearby.fBottom - 1) / tileSize; ++y) {
+        for (int x = nearby.fLeft / tileSize; x <= (nearby.fRight - 1) / tileSize; ++x) {
+            if (prefetched >= kMaxPrefetchTiles || usedBytes + tileBytes > maxBytes) {
+                return;
+            }
+            SkIRect cell = SkIRect::MakeXYWH(x * tileSize, y * tileSize, tileSize, tileSize);
+            if (SkIRect::Intersects(cell, clippedSrcIRect)) {
+                continue;   // already drawn
+            }
+            SkIRect iTileR;
+            SkBitmap tmpB;
+            if (!tile_texture_bounds(cell, outset, bmpBounds, &iTileR) ||
+                !bitmap.extractSubset(&tmpB, iTileR) ||
+                GrIsBitmapInCache(context, tmpB, &params)) {
+                continue;
+            }
+            GrTexture* texture = GrLockAndRefCachedBitmapTexture(context, tmpB, &params);
+            if (NULL != texture) {
+                GrUnlockAndUnrefCachedBitmapTexture(texture);
+                usedBytes += tileBytes;
+            }
+            ++prefetched;
+        }
+    }
+}
+
 // Break 'bitmap' into several tiles to draw it since it has already
 // been determined to be too large to fit in VRAM
 void SkGpuDevice::drawTiledBitmap(const SkBitmap& bitmap,
@@ -1233,16 +1264,19 @@ void SkGpuDevice::drawTiledBitmap(const SkBitmap& bitmap,
     // is larger than the limit of the discardable memory pool.
     SkAutoLockPixels alp(bitmap);
     SkRect clippedSrcRect = SkRect::Make(clippedSrcIRect);
+    SkIRect bmpBounds = SkIRect::MakeWH(bitmap.width(), bitmap.height());
+
+    int outset = 0;
+    if (SkPaint::kNone_FilterLevel != paint.getFilterLevel() || bicubic) {
+        outset = bicubic ? GrBicubicEffect::kFilterTexelPad : 1;
+    }
 
     int nx = bitmap.width() / tileSize;
     int ny = bitmap.height() / tileSize;
     for (int x = 0; x <= nx; x++) {
         for (int y = 0; y <= ny; y++) {
-            SkRect tileR;
-            tileR.set(SkIntToScalar(x * tileSize),
-                      SkIntToScalar(y * tileSize),
-                      SkIntToScalar((x + 1) * tileSize),
-                      SkIntToScalar((y + 1) * tileSize));
+            SkIRect cell = SkIRect::MakeXYWH(x * tileSize, y * tileSize, tileSize, tileSize);
+            SkRect tileR = SkRect::Make(cell);
 
             if (!SkRect::Intersects(tileR, clippedSrcRect)) {
                 continue;
@@ -1252,38 +1286,28 @@ void SkGpuDevice::drawTiledBitmap(const SkBitmap& bitmap,
                 continue;
             }
 
-            SkBitmap tmpB;
             SkIRect iTileR;
-            tileR.roundOut(&iTileR);
+            if (!tile_texture_bounds(cell, outset, bmpBounds, &iTileR)) {
+                continue;
+            }
             SkPoint offset = SkPoint::Make(SkIntToScalar(iTileR.fLeft),
                                            SkIntToScalar(iTileR.fTop));
 
             // Adjust the context matrix to draw at the right x,y in device space
             SkMatrix tmpM;
             GrContext::AutoMatrix am;
-            tmpM.setTranslate(offset.fX - srcRect.fLeft, offset.fY - srcRect.fTop);
+            tmpM.setTranslate(tileR.fLeft - srcRect.fLeft, tileR.fTop - srcRect.fTop);
             am.setPreConcat(fContext, tmpM);
 
-            if (SkPaint::kNone_FilterLevel != paint.getFilterLevel() || bicubic) {
-                SkIRect iClampRect;
-
-                if (SkCanvas::kBleed_DrawBitmapRectFlag & flags) {
-                    // In bleed mode we want to always expand the tile on all edges
-                    // but stay within the bitmap bounds
-                    iClampRect = SkIRect::MakeWH(bitmap.width(), bitmap.height());
-                } else {
-                    // In texture-domain/clamp mode we only want to expand the
-                    // tile on edges interior to "srcRect" (i.e., we want to
-                    // not bleed across the original clamped edges)
-                    srcRect.roundOut(&iClampRect);
-                }
-                int outset = bicubic ? GrBicubicEffect::kFilterTexelPad : 1;
-                clamped_outset_with_offset(&iTileR, outset, &offset, iClampRect);
-            }
-
+            SkBitmap tmpB;
             if (bitmap.extractSubset(&tmpB, iTileR)) {
                 // now offset it to make it "local" to our tmp bitmap
                 tileR.offset(-offset.fX, -offset.fY);
+                // The texture may reach past the src rect, which the filter must not sample
+                // unless in bleed mode.
+                SkRect domainR = SkRect::Make(iTileR);
+                SkAssertResult(domainR.intersect(srcRect));
+                domainR.offset(-offset.fX, -offset.fY);
                 GrTextureParams paramsTemp = params;
                 bool needsTextureDomain = needs_texture_domain(bitmap,
                                                                srcRect,
@@ -1296,12 +1320,14 @@ void SkGpuDevice::drawTiledBitmap(const SkBitmap& bitmap,
                                          paint,
                                          flags,
                                          bicubic,
-                                         needsTextureDomain);
+                                         needsTextureDomain,
+                                         &domainR);
             }
         }
     }
-}
 
+    prefetch_tiles(fContext, bitmap, srcRect, clippedSrcIRect, params, tileSize, outset);
+}
 
 /*
  *  This is called by drawBitmap(), which has to handle images that may be too
@@ -1316,7 +1342,8 @@ void SkGpuDevice::internalDrawBitmap(const SkBitmap& bitmap,
                                      const SkPaint& paint,
                                      SkCanvas::DrawBitmapRectFlags flags,
                                      bool bicubic,
-                                     bool needsTextureDomain) {
+                                     bool needsTextureDomain,
+                                     const SkRect* domainRect) {
     SkASSERT(bitmap.width() <= fContext->getMaxTextureSize() &&
              bitmap.height() <= fContext->getMaxTextureSize());
 
@@ -1339,20 +1366,28 @@ void SkGpuDevice::internalDrawBitmap(const SkBitmap& bitmap,
     SkAutoTUnref<GrEffectRef> effect;
     if (needsTextureDomain && !(flags & SkCanvas::kBleed_DrawBitmapRectFlag)) {
         // Use a constrained texture domain to avoid color bleeding
+        if (NULL == domainRect) {
+            domainRect = &srcRect;
+        }
+        SkRect domainTexRect;
+        domainTexRect.setLTRB(SkScalarMul(domainRect->fLeft,   wInv),
+                              SkScalarMul(domainRect->fTop,    hInv),
+                              SkScalarMul(domainRect->fRight,  wInv),
+                              SkScalarMul(domainRect->fBottom, hInv));
         SkScalar left, top, right, bottom;
-        if (srcRect.width() > SK_Scalar1) {
+        if (domainRect->width() > SK_Scalar1) {
             SkScalar border = SK_ScalarHalf / texture->width();
-            left = paintRect.left() + border;
-            right = paintRect.right() - border;
+            left = domainTexRect.left() + border;
+            right = domainTexRect.right() - border;
         } else {
-            left = right = SkScalarHalf(paintRect.left() + paintRect.right());
+            left = right = SkScalarHalf(domainTexRect.left() + domainTexRect.right());
         }
-        if (srcRect.height() > SK_Scalar1) {
+        if (domainRect->height() > SK_Scalar1) {
             SkScalar border = SK_ScalarHalf / texture->height();
-            top = paintRect.top() + border;
-            bottom = paintRect.bottom() - border;
+            top = domainTexRect.top() + border;
+            bottom = domainTexRect.bottom() - border;
         } else {
-            top = bottom = SkScalarHalf(paintRect.top() + paintRect.bottom());
+            top = bottom = SkScalarHalf(domainTexRect.top() + domainTexRect.bottom());
         }
         textureDomain.setLTRB(left, top, right, bottom);
         if (bicubic) {
@@ -1392,6 +1427,9 @@ static bool filter_texture(SkBaseDevice* device, GrContext* context,
     SkDeviceImageFilterProxy proxy(device);
 
     if (filter->canFilterImageGPU()) {
+        // The filter's draws are buffered, so that is where they are marked.
+        GrDrawTarget* target = context->getTextTarget();
+        GR_CREATE_TRACE_MARKER("SkGpuDevice::filterTexture", target);
         // Save the render target and set it to NULL, so we don't accidentally draw to it in the
         // filter.  Also set the clip wide open and the matrix to identity.
         GrContext::AutoWideOpenIdentityDraw awo(context, NULL);
@@ -1426,7 +1464,14 @@ void SkGpuDevice::drawSprite(const SkDraw& draw, const SkBitmap& bitmap,
         SkIPoint offset = SkIPoint::Make(0, 0);
         SkMatrix matrix(*draw.fMatrix);
         matrix.postTranslate(SkIntToScalar(-left), SkIntToScalar(-top));
-        SkIRect clipBounds = SkIRect::MakeWH(bitmap.width(), bitmap.height());
+        // Only filter what is needed for the part of the result inside the clip.
+        SkIRect visible = draw.fRC->getBounds();
+        visible.offset(-left, -top);
+        SkIRect clipBounds;
+        if (!filter->computeClipBounds(visible, SkIRect::MakeWH(bitmap.width(), bitmap.height()),
+                                       matrix, &clipBounds)) {
+            return;
+        }
         SkImageFilter::Cache* cache = SkImageFilter::Cache::Create();
         SkAutoUnref aur(cache);
         SkImageFilter::Context ctx(matrix, clipBounds, cache);
@@ -1535,7 +1580,13 @@ void SkGpuDevice::drawDevice(const SkDraw& draw, SkBaseDevice* device,
         SkIPoint offset = SkIPoint::Make(0, 0);
         SkMatrix matrix(*draw.fMatrix);
         matrix.postTranslate(SkIntToScalar(-x), SkIntToScalar(-y));
-        SkIRect clipBounds = SkIRect::MakeWH(devTex->width(), devTex->height());
+        SkIRect visible = draw.fRC->getBounds();
+        visible.offset(-x, -y);
+        SkIRect clipBounds;
+        if (!filter->computeClipBounds(visible, SkIRect::MakeWH(devTex->width(), devTex->height()),
+                                       matrix, &clipBounds)) {
+            return;
+        }
         SkImageFilter::Cache* cache = SkImageFilter::Cache::Create();
         SkAutoUnref aur(cache);
         SkImageFilter::Context ctx(matrix, clipBounds, cache);
@@ -1694,6 +1745,13 @@ void SkGpuDevice::drawText(const SkDraw& draw, const void* text,
         SkDEBUGCODE(this->validate();)
 
         fMainTextContext->drawText(grPaint, paint, (const char *)text, byteLength, x, y);
+    } else if (fPathTextContext && fPathTextContext->canDraw(paint)) {
+        GrPaint grPaint;
+        SkPaint2GrPaintShader(this->context(), paint, true, &grPaint);
+
+        SkDEBUGCODE(this->validate();)
+
+        fPathTextContext->drawText(grPaint, paint, (const char *)text, byteLength, x, y);
     } else if (fFallbackTextContext && fFallbackTextContext->canDraw(paint)) {
         GrPaint grPaint;
         SkPaint2GrPaintShader(this->context(), paint, true, &grPaint);
@@ -1721,6 +1779,14 @@ void SkGpuDevice::drawPosText(const SkDraw& draw, const void* text,
 
         fMainTextContext->drawPosText(grPaint, paint, (const char *)text, byteLength, pos,
                                       constY, scalarsPerPos);
+    } else if (fPathTextContext && fPathTextContext->canDraw(paint)) {
+        GrPaint grPaint;
+        SkPaint2GrPaintShader(this->context(), paint, true, &grPaint);
+
+        SkDEBUGCODE(this->validate();)
+
+        fPathTextContext->drawPosText(grPaint, paint, (const char *)text, byteLength, pos,
+                                      constY, scalarsPerPos);
     } else if (fFallbackTextContext && fFallbackTextContext->canDraw(paint)) {
         GrPaint grPaint;
         SkPaint2GrPaintShader(this->context(), paint, true, &grPaint);
@@ -1834,11 +1900,17 @@ static void wrap_texture(GrTexture* texture, int width, int height, SkBitmap* re
 }
 
 void SkGpuDevice::EXPERIMENTAL_purge(const SkPicture* picture) {
-
+    fContext->getLayerCache()->purge(picture);
 }
 
 bool SkGpuDevice::EXPERIMENTAL_drawPicture(SkCanvas* canvas, const SkPicture* picture) {
 
+    if (NULL == picture->fPlayback) {
+        // Layer hoisting replays ranges of SkPicturePlayback ops; SkRecord-backed
+        // pictures are drawn normally.
+        return false;
+    }
+
     SkPicture::AccelData::Key key = GPUAccelData::ComputeAccelDataKey();
 
     const SkPicture::AccelData* data = picture->EXPERIMENTAL_getAccelData(key);
@@ -1934,61 +2006,66 @@ bool SkGpuDevice::EXPERIMENTAL_drawPicture(SkCanvas* canvas, const SkPicture* pi
     }
 
     SkPicturePlayback::PlaybackReplacements replacements;
+    GrLayerCache* layerCache = fContext->getLayerCache();
 
     for (int i = 0; i < gpuData->numSaveLayers(); ++i) {
         if (pullForward[i]) {
-            GrCachedLayer* layer = fContext->getLayerCache()->findLayerOrCreate(picture, i);
+            GrCachedLayer* layer = layerCache->findLayerOrCreate(picture, i);
 
             const GPUAccelData::SaveLayerInfo& info = gpuData->saveLayerInfo(i);
 
-            if (NULL != picture->fPlayback) {
-                SkPicturePlayback::PlaybackReplacements::ReplacementInfo* layerInfo =
-                                                                        replacements.push();
-                layerInfo->fStart = info.fSaveLayerOpID;
-                layerInfo->fStop = info.fRestoreOpID;
-                layerInfo->fPos = info.fOffset;
-
-                GrTextureDesc desc;
-                desc.fFlags = kRenderTarget_GrTextureFlagBit;
-                desc.fWidth = info.fSize.fWidth;
-                desc.fHeight = info.fSize.fHeight;
-                desc.fConfig = kSkia8888_GrPixelConfig;
-                // TODO: need to deal with sample count
-
-                bool bNeedsRendering = true;
-
-                // This just uses scratch textures and doesn't cache the texture.
-                // This can yield a lot of re-rendering
-                if (NULL == layer->getTexture()) {
-                    layer->setTexture(fContext->lockAndRefScratchTexture(desc,
-                                                        GrContext::kApprox_ScratchTexMatch));
-                    if (NULL == layer->getTexture()) {
-                        continue;
-                    }
-                } else {
-                    bNeedsRendering = false;
-                }
+            GrTextureDesc desc;
+            desc.fFlags = kRenderTarget_GrTextureFlagBit;
+            desc.fWidth = info.fSize.fWidth;
+            desc.fHeight = info.fSize.fHeight;
+            desc.fConfig = kSkia8888_GrPixelConfig;
+            // TODO: need to deal with sample count
+
+            SkASSERT(info.fPaint);
+
+            // The layer's contents only depend on the picture, so once rendered they are
+            // reused by later draws until the layer is purged. Layers whose paint has an
+            // image filter are kept out of the atlas since filtered bitmaps can't be drawn
+            // from a part of a texture.
+            bool allowAtlas = NULL == info.fPaint->getImageFilter();
+            bool needsRendering = !layerCache->lock(layer, desc, allowAtlas);
+            GrTexture* texture = layer->getTexture();
+            if (NULL == texture) {
+                continue;
+            }
 
-                layerInfo->fBM = SkNEW(SkBitmap);
-                wrap_texture(layer->getTexture(), desc.fWidth, desc.fHeight, layerInfo->fBM);
+            SkPicturePlayback::PlaybackReplacements::ReplacementInfo* layerInfo =
+                                                                    replacements.push();
+            layerInfo->fStart = info.fSaveLayerOpID;
+            layerInfo->fStop = info.fRestoreOpID;
+            layerInfo->fPos = info.fOffset;
 
-                SkASSERT(info.fPaint);
-                layerInfo->fPaint = info.fPaint;
+            layerInfo->fBM = SkNEW(SkBitmap);
+            wrap_texture(texture, texture->width(), texture->height(), layerInfo->fBM);
+            layerInfo->fSrcRect = layer->rect();
 
-                if (bNeedsRendering) {
-                    SkAutoTUnref<SkSurface> surface(SkSurface::NewRenderTargetDirect(
-                                                        layer->getTexture()->asRenderTarget()));
+            layerInfo->fPaint = info.fPaint;
 
-                    SkCanvas* canvas = surface->getCanvas();
+            if (needsRendering) {
+                const SkIRect& rect = layer->rect();
 
-                    canvas->setMatrix(info.fCTM);
-                    canvas->clear(SK_ColorTRANSPARENT);
+                // The texture may be the atlas so only its part of it is cleared and drawn to.
+                fContext->clear(&rect, 0x0, false, texture->asRenderTarget());
 
-                    picture->fPlayback->setDrawLimits(info.fSaveLayerOpID, info.fRestoreOpID);
-                    picture->fPlayback->draw(*canvas, NULL);
-                    picture->fPlayback->setDrawLimits(0, 0);
-                    canvas->flush();
-                }
+                SkAutoTUnref<SkSurface> surface(SkSurface::NewRenderTargetDirect(
+                                                    texture->asRenderTarget()));
+
+                SkCanvas* canvas = surface->getCanvas();
+
+                canvas->clipRect(SkRect::Make(rect));
+                SkMatrix ctm = info.fCTM;
+                ctm.postTranslate(SkIntToScalar(rect.fLeft), SkIntToScalar(rect.fTop));
+                canvas->setMatrix(ctm);
+
+                picture->fPlayback->setDrawLimits(info.fSaveLayerOpID, info.fRestoreOpID);
+                picture->fPlayback->draw(*canvas, NULL);
+                picture->fPlayback->setDrawLimits(0, 0);
+                canvas->flush();
             }
         }
     }
@@ -1999,11 +2076,8 @@ bool SkGpuDevice::EXPERIMENTAL_drawPicture(SkCanvas* canvas, const SkPicture* pi
     picture->fPlayback->setReplacements(NULL);
 
     for (int i = 0; i < gpuData->numSaveLayers(); ++i) {
-        GrCachedLayer* layer = fContext->getLayerCache()->findLayerOrCreate(picture, i);
-
-        if (NULL != layer->getTexture()) {
-            fContext->unlockScratchTexture(layer->getTexture());
-            layer->setTexture(NULL);
+        if (pullForward[i]) {
+            layerCache->unlock(layerCache->findLayerOrCreate(picture, i));
         }
     }
 
@@ -14,6 +14,7 @@
 #include "GrResourceCache.h"
 #include "GrGpu.h"
 #include "GrDrawTargetCaps.h"
+#include "effects/GrYUVtoRGBEffect.h"
 
 #ifndef SK_IGNORE_ETC1_SUPPORT
 #  include "ktx.h"
@@ -183,6 +184,13 @@ static GrTexture *load_etc1_texture(GrContext* ctx,
     GrCacheID cacheID;
     generate_bitmap_cache_id(bm, &cacheID);
 
+    // Compressed data can't be stretched to a power of two for tiling, so leave that to the
+    // decoded pixels.
+    if (GrTextureImpl::NeedsResizing(GrTextureImpl::ComputeKey(ctx->getGpu(), params, desc,
+                                                               cacheID))) {
+        return NULL;
+    }
+
     GrResourceKey key;
     GrTexture* result = ctx->createTexture(params, desc, cacheID, bytes, 0, &key);
     if (NULL != result) {
@@ -192,6 +200,89 @@ static GrTexture *load_etc1_texture(GrContext* ctx,
 }
 #endif   // SK_IGNORE_ETC1_SUPPORT
 
+static GrTexture* load_yuv_texture(GrContext* ctx, const GrTextureParams* params,
+                                   const SkBitmap& bm, const GrTextureDesc& desc) {
+    SkPixelRef* pixelRef = bm.pixelRef();
+    SkISize yuvSizes[3];
+    if (NULL == pixelRef || !pixelRef->getYUV8Planes(yuvSizes, NULL, NULL)) {
+        return NULL;
+    }
+
+    // The luma plane is drawn 1:1 into the texture, so it has to be all of the bitmap.
+    if (bm.pixelRefOrigin() != SkIPoint::Make(0, 0) ||
+        yuvSizes[0].width() != bm.width() || yuvSizes[0].height() != bm.height()) {
+        return NULL;
+    }
+
+    GrTextureDesc rtDesc = desc;
+    rtDesc.fFlags = rtDesc.fFlags |
+                    kRenderTarget_GrTextureFlagBit |
+                    kNoStencil_GrTextureFlagBit;
+
+    GrCacheID cacheID;
+    generate_bitmap_cache_id(bm, &cacheID);
+
+    // Stretching an npot texture for tiling starts from pixels on the CPU.
+    if (GrTextureImpl::NeedsResizing(GrTextureImpl::ComputeKey(ctx->getGpu(), params, rtDesc,
+                                                               cacheID))) {
+        return NULL;
+    }
+
+    size_t totalSize = 0;
+    for (int i = 0; i < 3; ++i) {
+        totalSize += yuvSizes[i].width() * yuvSizes[i].height();
+    }
+    SkAutoMalloc storage(totalSize);
+    void* planes[3];
+    size_t rowBytes[3];
+    planes[0] = storage.get();
+    for (int i = 0; i < 3; ++i) {
+        rowBytes[i] = yuvSizes[i].width();
+        if (i > 0) {
+            planes[i] = (uint8_t*) planes[i - 1] + rowBytes[i - 1] * yuvSizes[i - 1].height();
+        }
+    }
+    if (!pixelRef->getYUV8Planes(yuvSizes, planes, rowBytes)) {
+        return NULL;
+    }
+
+    // Each plane goes up as A8, a quarter of the RGBA upload or less.
+    GrTextureDesc yuvDesc;
+    yuvDesc.fConfig = kAlpha_8_GrPixelConfig;
+    GrAutoScratchTexture yuvTextures[3];
+    for (int i = 0; i < 3; ++i) {
+        yuvDesc.fWidth  = yuvSizes[i].width();
+        yuvDesc.fHeight = yuvSizes[i].height();
+        // Exact, since the effect samples all three planes at the same normalized coordinates.
+        if (NULL == yuvTextures[i].set(ctx, yuvDesc, GrContext::kExact_ScratchTexMatch) ||
+            !ctx->writeTexturePixels(yuvTextures[i].texture(),
+                                     0, 0, yuvDesc.fWidth, yuvDesc.fHeight,
+                                     yuvDesc.fConfig, planes[i], rowBytes[i])) {
+            return NULL;
+        }
+    }
+
+    GrResourceKey key;
+    GrTexture* result = ctx->createTexture(params, rtDesc, cacheID, NULL, 0, &key);
+    GrRenderTarget* renderTarget = NULL != result ? result->asRenderTarget() : NULL;
+    if (NULL == renderTarget) {
+        SkSafeUnref(result);
+        return NULL;
+    }
+    add_genID_listener(key, pixelRef);
+
+    SkAutoTUnref<GrEffectRef> yuvToRgbEffect(GrYUVtoRGBEffect::Create(
+            yuvTextures[0].texture(), yuvTextures[1].texture(), yuvTextures[2].texture()));
+    GrPaint paint;
+    paint.addColorEffect(yuvToRgbEffect);
+    SkRect r = SkRect::MakeWH(SkIntToScalar(yuvSizes[0].width()),
+                              SkIntToScalar(yuvSizes[0].height()));
+    GrContext::AutoWideOpenIdentityDraw awoid(ctx, renderTarget);
+    ctx->drawRect(paint, r);
+
+    return result;
+}
+
 static GrTexture* sk_gr_create_bitmap_texture(GrContext* ctx,
                                               bool cache,
                                               const GrTextureParams* params,
@@ -263,6 +354,15 @@ static GrTexture* sk_gr_create_bitmap_texture(GrContext* ctx,
     }
 #endif   // SK_IGNORE_ETC1_SUPPORT
 
+    // Can the pixelRef hand us its YUV planes, e.g. of a JPEG not decoded yet? Then upload
+    // those and convert them on the GPU rather than decoding to RGB on the CPU.
+    if (cache && !bitmap->readyToDraw()) {
+        GrTexture* texture = load_yuv_texture(ctx, params, *bitmap, desc);
+        if (NULL != texture) {
+            return texture;
+        }
+    }
+
     SkAutoLockPixels alp(*bitmap);
     if (!bitmap->readyToDraw()) {
         return NULL;
@@ -416,6 +516,28 @@ bool GrPixelConfig2ColorType(GrPixelConfig config, SkColorType* ctOut) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Maps the modes that can't be done with blend coeffs to the blend equations that do them in
+// hardware. Returns false for the coeff modes and for modes without an equation.
+static bool sk_mode_to_grequation(SkXfermode::Mode mode, GrBlendEquation* equation) {
+    switch (mode) {
+        case SkXfermode::kOverlay_Mode:    *equation = kOverlay_GrBlendEquation;       return true;
+        case SkXfermode::kDarken_Mode:     *equation = kDarken_GrBlendEquation;        return true;
+        case SkXfermode::kLighten_Mode:    *equation = kLighten_GrBlendEquation;       return true;
+        case SkXfermode::kColorDodge_Mode: *equation = kColorDodge_GrBlendEquation;    return true;
+        case SkXfermode::kColorBurn_Mode:  *equation = kColorBurn_GrBlendEquation;     return true;
+        case SkXfermode::kHardLight_Mode:  *equation = kHardLight_GrBlendEquation;     return true;
+        case SkXfermode::kSoftLight_Mode:  *equation = kSoftLight_GrBlendEquation;     return true;
+        case SkXfermode::kDifference_Mode: *equation = kDifference_GrBlendEquation;    return true;
+        case SkXfermode::kExclusion_Mode:  *equation = kExclusion_GrBlendEquation;     return true;
+        case SkXfermode::kMultiply_Mode:   *equation = kMultiply_GrBlendEquation;      return true;
+        case SkXfermode::kHue_Mode:        *equation = kHSLHue_GrBlendEquation;        return true;
+        case SkXfermode::kSaturation_Mode: *equation = kHSLSaturation_GrBlendEquation; return true;
+        case SkXfermode::kColor_Mode:      *equation = kHSLColor_GrBlendEquation;      return true;
+        case SkXfermode::kLuminosity_Mode: *equation = kHSLLuminosity_GrBlendEquation; return true;
+        default:                                                                       return false;
+    }
+}
+
 void SkPaint2GrPaintNoShader(GrContext* context, const SkPaint& skPaint, GrColor grColor,
                              bool constantColor, GrPaint* grPaint) {
 
@@ -427,7 +549,16 @@ void SkPaint2GrPaintNoShader(GrContext* context, const SkPaint& skPaint, GrColor
 
     SkXfermode* mode = skPaint.getXfermode();
     GrEffectRef* xferEffect = NULL;
-    if (SkXfermode::AsNewEffectOrCoeff(mode, &xferEffect, &sm, &dm)) {
+    SkXfermode::Mode skMode;
+    GrBlendEquation equation;
+    if (context->getGpu()->caps()->advancedBlendEquationSupport() &&
+        SkXfermode::AsMode(mode, &skMode) &&
+        sk_mode_to_grequation(skMode, &equation)) {
+        // The blend unit does the mode, no need for the effect to read the dst.
+        grPaint->setBlendEquation(equation);
+        sm = SkXfermode::kOne_Coeff;
+        dm = SkXfermode::kISA_Coeff;
+    } else if (SkXfermode::AsNewEffectOrCoeff(mode, &xferEffect, &sm, &dm)) {
         if (NULL != xferEffect) {
             grPaint->addColorEffect(xferEffect)->unref();
             sm = SkXfermode::kOne_Coeff;
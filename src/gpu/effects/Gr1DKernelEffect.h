@@ -30,8 +30,9 @@ public:
 
     Gr1DKernelEffect(GrTexture* texture,
                      Direction direction,
-                     int radius)
-        : GrSingleTextureEffect(texture, MakeDivByTextureWHMatrix(texture))
+                     int radius,
+                     GrTextureParams::FilterMode filterMode = GrTextureParams::kNone_FilterMode)
+        : GrSingleTextureEffect(texture, MakeDivByTextureWHMatrix(texture), filterMode)
         , fDirection(direction)
         , fRadius(radius) {}
 
@@ -32,13 +32,16 @@ public:
 
 private:
     int width() const { return Gr1DKernelEffect::WidthFromRadius(fRadius); }
+    int tapCount() const { return GrConvolutionEffect::TapCount(fRadius, fBilerpTaps); }
     bool useBounds() const { return fUseBounds; }
     Gr1DKernelEffect::Direction direction() const { return fDirection; }
 
     int                 fRadius;
     bool                fUseBounds;
+    bool                fBilerpTaps;
     Gr1DKernelEffect::Direction    fDirection;
     UniformHandle       fKernelUni;
+    UniformHandle       fTapOffsetsUni;
     UniformHandle       fImageIncrementUni;
     UniformHandle       fBoundsUni;
 
@@ -51,6 +54,7 @@ GrGLConvolutionEffect::GrGLConvolutionEffect(const GrBackendEffectFactory& facto
     const GrConvolutionEffect& c = drawEffect.castEffect<GrConvolutionEffect>();
     fRadius = c.radius();
     fUseBounds = c.useBounds();
+    fBilerpTaps = c.bilerpTaps();
     fDirection = c.direction();
 }
 
@@ -69,32 +73,55 @@ void GrGLConvolutionEffect::emitCode(GrGLShaderBuilder* builder,
                                          kVec2f_GrSLType, "Bounds");
     }
     fKernelUni = builder->addUniformArray(GrGLShaderBuilder::kFragment_Visibility,
-                                          kFloat_GrSLType, "Kernel", this->width());
+                                          kFloat_GrSLType, "Kernel", this->tapCount());
 
     builder->fsCodeAppendf("\t\t%s = vec4(0, 0, 0, 0);\n", outputColor);
 
-    int width = this->width();
     const GrGLShaderVar& kernel = builder->getUniformVariable(fKernelUni);
     const char* imgInc = builder->getUniformCStr(fImageIncrementUni);
 
-    builder->fsCodeAppendf("\t\tvec2 coord = %s - %d.0 * %s;\n", coords2D.c_str(), fRadius, imgInc);
+    if (fBilerpTaps) {
+        fTapOffsetsUni = builder->addUniformArray(GrGLShaderBuilder::kFragment_Visibility,
+                                                  kFloat_GrSLType, "TapOffsets",
+                                                  this->tapCount());
+        const GrGLShaderVar& offsets = builder->getUniformVariable(fTapOffsetsUni);
+        builder->fsCodeAppend("\t\tvec2 coord;\n");
+        for (int i = 0; i < this->tapCount(); i++) {
+            SkString index;
+            SkString kernelIndex;
+            SkString offsetIndex;
+            index.appendS32(i);
+            kernel.appendArrayAccess(index.c_str(), &kernelIndex);
+            offsets.appendArrayAccess(index.c_str(), &offsetIndex);
+            builder->fsCodeAppendf("\t\tcoord = %s + %s * %s;\n",
+                                   coords2D.c_str(), offsetIndex.c_str(), imgInc);
+            builder->fsCodeAppendf("\t\t%s += ", outputColor);
+            builder->fsAppendTextureLookup(samplers[0], "coord");
+            builder->fsCodeAppendf(" * %s;\n", kernelIndex.c_str());
+        }
+    } else {
+        int width = this->width();
+        builder->fsCodeAppendf("\t\tvec2 coord = %s - %d.0 * %s;\n",
+                               coords2D.c_str(), fRadius, imgInc);
 
-    // Manually unroll loop because some drivers don't; yields 20-30% speedup.
-    for (int i = 0; i < width; i++) {
-        SkString index;
-        SkString kernelIndex;
-        index.appendS32(i);
-        kernel.appendArrayAccess(index.c_str(), &kernelIndex);
-        builder->fsCodeAppendf("\t\t%s += ", outputColor);
-        builder->fsAppendTextureLookup(samplers[0], "coord");
-        if (this->useBounds()) {
-            const char* bounds = builder->getUniformCStr(fBoundsUni);
-            const char* component = this->direction() == Gr1DKernelEffect::kY_Direction ? "y" : "x";
-            builder->fsCodeAppendf(" * float(coord.%s >= %s.x && coord.%s <= %s.y)",
-                component, bounds, component, bounds);
+        // Manually unroll loop because some drivers don't; yields 20-30% speedup.
+        for (int i = 0; i < width; i++) {
+            SkString index;
+            SkString kernelIndex;
+            index.appendS32(i);
+            kernel.appendArrayAccess(index.c_str(), &kernelIndex);
+            builder->fsCodeAppendf("\t\t%s += ", outputColor);
+            builder->fsAppendTextureLookup(samplers[0], "coord");
+            if (this->useBounds()) {
+                const char* bounds = builder->getUniformCStr(fBoundsUni);
+                const char* component =
+                        this->direction() == Gr1DKernelEffect::kY_Direction ? "y" : "x";
+                builder->fsCodeAppendf(" * float(coord.%s >= %s.x && coord.%s <= %s.y)",
+                    component, bounds, component, bounds);
+            }
+            builder->fsCodeAppendf(" * %s;\n", kernelIndex.c_str());
+            builder->fsCodeAppendf("\t\tcoord += %s;\n", imgInc);
         }
-        builder->fsCodeAppendf(" * %s;\n", kernelIndex.c_str());
-        builder->fsCodeAppendf("\t\tcoord += %s;\n", imgInc);
     }
 
     SkString modulate;
@@ -130,14 +157,20 @@ void GrGLConvolutionEffect::setData(const GrGLUniformManager& uman,
             uman.set2f(fBoundsUni, bounds[0], bounds[1]);
         }
     }
-    uman.set1fv(fKernelUni, this->width(), conv.kernel());
+    uman.set1fv(fKernelUni, this->tapCount(), conv.kernel());
+    if (fBilerpTaps) {
+        uman.set1fv(fTapOffsetsUni, this->tapCount(), conv.tapOffsets());
+    }
 }
 
 GrGLEffect::EffectKey GrGLConvolutionEffect::GenKey(const GrDrawEffect& drawEffect,
                                                     const GrGLCaps&) {
     const GrConvolutionEffect& conv = drawEffect.castEffect<GrConvolutionEffect>();
     EffectKey key = conv.radius();
-    key <<= 2;
+    key <<= 3;
+    if (conv.bilerpTaps()) {
+        key |= 0x4;
+    }
     if (conv.useBounds()) {
         key |= 0x2;
         key |= GrConvolutionEffect::kY_Direction == conv.direction() ? 0x1 : 0x0;
@@ -153,7 +186,9 @@ GrConvolutionEffect::GrConvolutionEffect(GrTexture* texture,
                                          const float* kernel,
                                          bool useBounds,
                                          float bounds[2])
-    : Gr1DKernelEffect(texture, direction, radius), fUseBounds(useBounds) {
+    : Gr1DKernelEffect(texture, direction, radius)
+    , fUseBounds(useBounds)
+    , fBilerpTaps(false) {
     SkASSERT(radius <= kMaxKernelRadius);
     SkASSERT(NULL != kernel);
     int width = this->width();
@@ -169,8 +204,48 @@ GrConvolutionEffect::GrConvolutionEffect(GrTexture* texture,
                                          float gaussianSigma,
                                          bool useBounds,
                                          float bounds[2])
-    : Gr1DKernelEffect(texture, direction, radius), fUseBounds(useBounds) {
+    : Gr1DKernelEffect(texture, direction, radius)
+    , fUseBounds(useBounds)
+    , fBilerpTaps(false) {
+    SkASSERT(radius <= kMaxKernelRadius);
+    this->setGaussianKernel(gaussianSigma);
+    memcpy(fBounds, bounds, sizeof(fBounds));
+}
+
+GrConvolutionEffect::GrConvolutionEffect(GrTexture* texture,
+                                         Direction direction,
+                                         int radius,
+                                         float gaussianSigma)
+    : Gr1DKernelEffect(texture, direction, radius, GrTextureParams::kBilerp_FilterMode)
+    , fUseBounds(false)
+    , fBilerpTaps(true) {
     SkASSERT(radius <= kMaxKernelRadius);
+    sk_bzero(fBounds, sizeof(fBounds));
+
+    float texels[kMaxKernelWidth];
+    this->setGaussianKernel(gaussianSigma);
+    memcpy(texels, fKernel, this->width() * sizeof(float));
+
+    // Each pair of texels on either side of the center becomes one lookup between them, placed
+    // so that bilinear filtering blends them in the kernel's proportions. With an odd radius
+    // the outermost texel has no partner and gets a lookup of its own.
+    const int taps = this->tapCount();
+    const int center = taps / 2;
+    fKernel[center] = texels[radius];
+    fTapOffsets[center] = 0;
+    for (int i = 1; i <= center; ++i) {
+        const int near = 2 * i - 1;
+        const float nearWeight = texels[radius + near];
+        const float farWeight = near < radius ? texels[radius + near + 1] : 0;
+        const float weight = nearWeight + farWeight;
+        const float offset = near + farWeight / weight;
+        fKernel[center + i] = fKernel[center - i] = weight;
+        fTapOffsets[center + i] = offset;
+        fTapOffsets[center - i] = -offset;
+    }
+}
+
+void GrConvolutionEffect::setGaussianKernel(float gaussianSigma) {
     int width = this->width();
 
     float sum = 0.0f;
@@ -187,7 +262,6 @@ GrConvolutionEffect::GrConvolutionEffect(GrTexture* texture,
     for (int i = 0; i < width; ++i) {
         fKernel[i] *= scale;
     }
-    memcpy(fBounds, bounds, sizeof(fBounds));
 }
 
 GrConvolutionEffect::~GrConvolutionEffect() {
@@ -203,8 +277,11 @@ bool GrConvolutionEffect::onIsEqual(const GrEffect& sBase) const {
             this->radius() == s.radius() &&
             this->direction() == s.direction() &&
             this->useBounds() == s.useBounds() &&
+            this->bilerpTaps() == s.bilerpTaps() &&
             0 == memcmp(fBounds, s.fBounds, sizeof(fBounds)) &&
-            0 == memcmp(fKernel, s.fKernel, this->width() * sizeof(float)));
+            0 == memcmp(fKernel, s.fKernel, this->tapCount() * sizeof(float)) &&
+            (!fBilerpTaps ||
+             0 == memcmp(fTapOffsets, s.fTapOffsets, this->tapCount() * sizeof(float))));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -228,6 +305,13 @@ GrEffectRef* GrConvolutionEffect::TestCreate(SkRandom* random,
         bounds[i] = random->nextF();
     }
 
+    if (random->nextBool()) {
+        return GrConvolutionEffect::CreateGaussianBilerp(textures[texIdx],
+                                                         dir,
+                                                         radius,
+                                                         random->nextRangeF(0.5f, 4.0f));
+    }
+
     bool useBounds = random->nextBool();
     return GrConvolutionEffect::Create(textures[texIdx],
                                        dir,
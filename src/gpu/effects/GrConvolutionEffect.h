@@ -53,9 +53,37 @@ public:
         return CreateEffectRef(effect);
     }
 
+    /**
+     * Convolve with a Gaussian kernel, reading two texels per texture lookup with bilinear
+     * filtering, so that it takes about half the lookups. The draw must put texel centers at
+     * pixel centers across the direction of the kernel, as a 1:1 draw of whole texels does.
+     */
+    static GrEffectRef* CreateGaussianBilerp(GrTexture* tex,
+                                             Direction dir,
+                                             int halfWidth,
+                                             float gaussianSigma) {
+        AutoEffectUnref effect(SkNEW_ARGS(GrConvolutionEffect, (tex,
+                                                                dir,
+                                                                halfWidth,
+                                                                gaussianSigma)));
+        return CreateEffectRef(effect);
+    }
+
     virtual ~GrConvolutionEffect();
 
+    /**
+     * With bilerp taps the kernel holds a weight per texture lookup, and tapOffsets() says
+     * where each lookup is, in texels from the center. Otherwise there is a lookup per texel.
+     */
     const float* kernel() const { return fKernel; }
+    bool bilerpTaps() const { return fBilerpTaps; }
+    const float* tapOffsets() const { return fTapOffsets; }
+    int tapCount() const { return TapCount(this->radius(), fBilerpTaps); }
+
+    static int TapCount(int radius, bool bilerpTaps) {
+        // The center texel, and a lookup per pair of texels on either side of it.
+        return bilerpTaps ? 2 * ((radius + 1) / 2) + 1 : WidthFromRadius(radius);
+    }
 
     const float* bounds() const { return fBounds; }
     bool useBounds() const { return fUseBounds; }
@@ -88,6 +116,8 @@ protected:
     float fKernel[kMaxKernelWidth];
     bool fUseBounds;
     float fBounds[2];
+    bool fBilerpTaps;
+    float fTapOffsets[kMaxKernelWidth];
 
 private:
     GrConvolutionEffect(GrTexture*, Direction,
@@ -103,6 +133,13 @@ private:
                         bool useBounds,
                         float bounds[2]);
 
+    /// Convolve with a Gaussian kernel, with bilerp taps
+    GrConvolutionEffect(GrTexture*, Direction,
+                        int halfWidth,
+                        float gaussianSigma);
+
+    void setGaussianKernel(float gaussianSigma);
+
     virtual bool onIsEqual(const GrEffect&) const SK_OVERRIDE;
 
     GR_DECLARE_EFFECT_TEST;
@@ -7,8 +7,10 @@
  */
 
 #include "GrTextureStripAtlas.h"
+#include "SkChecksum.h"
 #include "SkPixelRef.h"
-#include "SkTSearch.h"
+#include "SkThread.h"
+#include "GrResourceCache.h"
 #include "GrTexture.h"
 
 #ifdef SK_DEBUG
@@ -19,6 +21,9 @@
 
 int32_t GrTextureStripAtlas::gCacheCount = 0;
 
+// Each atlas belongs to one context, but the cache of them is shared by contexts on all threads.
+SK_DECLARE_STATIC_MUTEX(gAtlasCacheMutex);
+
 GrTHashTable<GrTextureStripAtlas::AtlasEntry,
                 GrTextureStripAtlas::AtlasHashKey, 8>*
                             GrTextureStripAtlas::gAtlasCache = NULL;
@@ -39,6 +44,7 @@ void GrTextureStripAtlas::CleanUp(const GrContext*, void* info) {
 
     AtlasEntry* entry = static_cast<AtlasEntry*>(info);
 
+    SkAutoMutexAcquire ama(gAtlasCacheMutex);
     // remove the cache entry
     GetCache()->remove(entry->fKey, entry);
 
@@ -54,6 +60,7 @@ void GrTextureStripAtlas::CleanUp(const GrContext*, void* info) {
 GrTextureStripAtlas* GrTextureStripAtlas::GetAtlas(const GrTextureStripAtlas::Desc& desc) {
     AtlasHashKey key;
     key.setKeyData(desc.asKey());
+    SkAutoMutexAcquire ama(gAtlasCacheMutex);
     AtlasEntry* entry = GetCache()->find(key);
     if (NULL == entry) {
         entry = SkNEW(AtlasEntry);
@@ -87,19 +94,91 @@ GrTextureStripAtlas::~GrTextureStripAtlas() {
     SkDELETE_ARRAY(fRows);
 }
 
+uint32_t GrTextureStripAtlas::GenIDTraits::Hash(const uint32_t& key) {
+    return SkChecksum::Murmur3(&key, sizeof(key));
+}
+
+// Hashes the pixels of a bitmap, row by row to skip any padding. Returns false if a row isn't a
+// whole number of words, which Murmur3 needs.
+static bool hash_pixels(const SkBitmap& data, uint32_t* hash) {
+    const size_t bytes = data.width() * data.bytesPerPixel();
+    if (NULL == data.getPixels() || !SkIsAlign4(bytes)) {
+        return false;
+    }
+    *hash = 0;
+    for (int y = 0; y < data.height(); ++y) {
+        *hash = SkChecksum::Murmur3(static_cast<const uint32_t*>(data.getAddr(0, y)), bytes,
+                                    *hash);
+    }
+    return true;
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    if (a.info() != b.info()) {
+        return false;
+    }
+    SkAutoLockPixels lockA(a), lockB(b);
+    if (NULL == a.getPixels() || NULL == b.getPixels()) {
+        return false;
+    }
+    const size_t bytes = a.width() * a.bytesPerPixel();
+    for (int y = 0; y < a.height(); ++y) {
+        if (0 != memcmp(a.getAddr(0, y), b.getAddr(0, y), bytes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+GrTextureStripAtlas::AtlasRow* GrTextureStripAtlas::findByContent(const SkBitmap& data,
+                                                                   uint32_t* contentHash,
+                                                                   bool* hashed) {
+    SkAutoLockPixels lock(data);
+    *hashed = hash_pixels(data, contentHash);
+    if (!*hashed) {
+        return NULL;
+    }
+    AtlasRow* row = fContentTable.find(*contentHash);
+    if (NULL == row || !same_pixels(row->fData, data)) {
+        return NULL;
+    }
+    // The bitmap most recently locked is the likeliest to be locked again.
+    fKeyTable.remove(row->fKey);
+    row->fKey = data.getGenerationID();
+    row->fData = data;
+    fKeyTable.add(row);
+    return row;
+}
+
+void GrTextureStripAtlas::clearRow(AtlasRow* row) {
+    if (kEmptyAtlasRowKey != row->fKey) {
+        fKeyTable.remove(row->fKey);
+        if (row->fInContentTable) {
+            fContentTable.remove(row->fContentHash);
+        }
+    }
+    row->fKey = kEmptyAtlasRowKey;
+    row->fInContentTable = false;
+    row->fData.reset();
+}
+
 int GrTextureStripAtlas::lockRow(const SkBitmap& data) {
     VALIDATE;
     if (0 == fLockedRows) {
         this->lockTexture();
     }
 
-    int key = data.getGenerationID();
+    uint32_t key = data.getGenerationID();
     int rowNumber = -1;
-    int index = this->searchByKey(key);
+    uint32_t contentHash = 0;
+    bool hashed = false;
+    AtlasRow* row = fKeyTable.find(key);
+    if (NULL == row) {
+        row = this->findByContent(data, &contentHash, &hashed);
+    }
 
-    if (index >= 0) {
+    if (NULL != row) {
         // We already have the data in a row, so we can just return that row
-        AtlasRow* row = fKeyTable[index];
         if (0 == row->fLocks) {
             this->removeFromLRU(row);
         }
@@ -110,11 +189,8 @@ int GrTextureStripAtlas::lockRow(const SkBitmap& data) {
         // required for storing row numbers and just compute it with some pointer arithmetic
         rowNumber = static_cast<int>(row - fRows);
     } else {
-        // ~index is the index where we will insert the new key to keep things sorted
-        index = ~index;
-
         // We don't have this data cached, so pick the least recently used row to copy into
-        AtlasRow* row = this->getLRU();
+        row = this->getLRU();
 
         ++fLockedRows;
 
@@ -130,25 +206,20 @@ int GrTextureStripAtlas::lockRow(const SkBitmap& data) {
 
         this->removeFromLRU(row);
 
-        uint32_t oldKey = row->fKey;
-
         // If we are writing into a row that already held bitmap data, we need to remove the
-        // reference to that genID which is stored in our sorted table of key values.
-        if (oldKey != kEmptyAtlasRowKey) {
-
-            // Find the entry in the list; if it's before the index where we plan on adding the new
-            // entry, we decrement since it will shift elements ahead of it back by one.
-            int oldIndex = this->searchByKey(oldKey);
-            if (oldIndex < index) {
-                --index;
-            }
-
-            fKeyTable.remove(oldIndex);
-        }
+        // references to it from our tables.
+        this->clearRow(row);
 
         row->fKey = key;
         row->fLocks = 1;
-        fKeyTable.insert(index, 1, &row);
+        row->fData = data;
+        row->fContentHash = contentHash;
+        // Rows whose pixels hash alike but differ are only found by their generation ID.
+        row->fInContentTable = hashed && NULL == fContentTable.find(contentHash);
+        fKeyTable.add(row);
+        if (row->fInContentTable) {
+            fContentTable.add(row);
+        }
         rowNumber = static_cast<int>(row - fRows);
 
         SkAutoLockPixels lock(data);
@@ -205,9 +276,12 @@ void GrTextureStripAtlas::lockTexture() {
     fTexture = fDesc.fContext->findAndRefTexture(texDesc, cacheID, &params);
     if (NULL == fTexture) {
         fTexture = fDesc.fContext->createTexture(&params, texDesc, cacheID, NULL, 0);
+        // Losing the atlas loses every row in it, so purge other resources first.
+        if (NULL != fTexture && NULL != fTexture->getCacheEntry()) {
+            fTexture->getCacheEntry()->setPriority(GrResourceCache::kAtlas_Priority);
+        }
         // This is a new texture, so all of our cache info is now invalid
         this->initLRU();
-        fKeyTable.rewind();
     }
     SkASSERT(NULL != fTexture);
 }
@@ -224,7 +298,7 @@ void GrTextureStripAtlas::initLRU() {
     fLRUBack = NULL;
     // Initially all the rows are in the LRU list
     for (int i = 0; i < fNumRows; ++i) {
-        fRows[i].fKey = kEmptyAtlasRowKey;
+        this->clearRow(fRows + i);
         fRows[i].fNext = NULL;
         fRows[i].fPrev = NULL;
         this->appendLRU(fRows + i);
@@ -270,27 +344,9 @@ void GrTextureStripAtlas::removeFromLRU(AtlasRow* row) {
     row->fPrev = NULL;
 }
 
-int GrTextureStripAtlas::searchByKey(uint32_t key) {
-    AtlasRow target;
-    target.fKey = key;
-    return SkTSearch<const AtlasRow,
-                     GrTextureStripAtlas::KeyLess>((const AtlasRow**)fKeyTable.begin(),
-                                                   fKeyTable.count(),
-                                                   &target,
-                                                   sizeof(AtlasRow*));
-}
-
 #ifdef SK_DEBUG
 void GrTextureStripAtlas::validate() {
 
-    // Our key table should be sorted
-    uint32_t prev = 1 > fKeyTable.count() ? 0 : fKeyTable[0]->fKey;
-    for (int i = 1; i < fKeyTable.count(); ++i) {
-        SkASSERT(prev < fKeyTable[i]->fKey);
-        SkASSERT(fKeyTable[i]->fKey != kEmptyAtlasRowKey);
-        prev = fKeyTable[i]->fKey;
-    }
-
     int lruCount = 0;
     // Validate LRU pointers, and count LRU entries
     SkASSERT(NULL == fLRUFront || NULL == fLRUFront->fPrev);
@@ -306,6 +362,8 @@ void GrTextureStripAtlas::validate() {
 
     int rowLocks = 0;
     int freeRows = 0;
+    int keyedRows = 0;
+    int contentRows = 0;
 
     for (int i = 0; i < fNumRows; ++i) {
         rowLocks += fRows[i].fLocks;
@@ -326,8 +384,16 @@ void GrTextureStripAtlas::validate() {
         }
 
         // If we have a key != kEmptyAtlasRowKey, it should be in the key table
-        SkASSERT(fRows[i].fKey == kEmptyAtlasRowKey || this->searchByKey(fRows[i].fKey) >= 0);
+        if (kEmptyAtlasRowKey != fRows[i].fKey) {
+            ++keyedRows;
+            SkASSERT(fKeyTable.find(fRows[i].fKey) == &fRows[i]);
+            SkASSERT(!fRows[i].fInContentTable ||
+                     fContentTable.find(fRows[i].fContentHash) == &fRows[i]);
+            contentRows += fRows[i].fInContentTable;
+        }
     }
+    SkASSERT(keyedRows == fKeyTable.count());
+    SkASSERT(contentRows == fContentTable.count());
 
     // Our count of locks should equal the sum of row locks, unless we ran out of rows and flushed,
     // in which case we'll have one more lock than recorded in the rows (to represent the pending
@@ -12,7 +12,7 @@
 #include "GrTHashTable.h"
 #include "SkBitmap.h"
 #include "SkGr.h"
-#include "SkTDArray.h"
+#include "SkTDynamicHash.h"
 #include "SkTypes.h"
 
 /**
@@ -40,7 +40,8 @@ public:
     ~GrTextureStripAtlas();
 
     /**
-     * Add a texture to the atlas
+     * Add a texture to the atlas. Bitmaps are matched to rows by generation ID, and failing that
+     * by their pixels, so that identical data from separately created bitmaps shares a row.
      *  @param data Bitmap data to copy into the row
      *  @return The row index we inserted into, or -1 if we failed to find an open row. The caller
      *      is responsible for calling unlockRow() with this row index when it's done with it.
@@ -80,9 +81,20 @@ private:
      * together to represent LRU status
      */
     struct AtlasRow : SkNoncopyable {
-        AtlasRow() : fKey(kEmptyAtlasRowKey), fLocks(0), fNext(NULL), fPrev(NULL) { }
+        AtlasRow()
+            : fKey(kEmptyAtlasRowKey)
+            , fContentHash(0)
+            , fInContentTable(false)
+            , fLocks(0)
+            , fNext(NULL)
+            , fPrev(NULL) { }
         // GenerationID of the bitmap that is represented by this row, 0xffffffff means "empty"
         uint32_t fKey;
+        // Hash of the row's pixels, and whether the row is the one fContentTable finds for it
+        uint32_t fContentHash;
+        bool fInContentTable;
+        // The bitmap the row was filled from, to compare the pixels of others against
+        SkBitmap fData;
         // How many times this has been locked (0 == unlocked)
         int32_t fLocks;
         // We maintain an LRU linked list between unlocked nodes with these pointers
@@ -112,17 +124,24 @@ private:
     void removeFromLRU(AtlasRow* row);
 
     /**
-     * Searches the key table for a key and returns the index if found; if not found, it returns
-     * the bitwise not of the index at which we could insert the key to maintain a sorted list.
-     **/
-    int searchByKey(uint32_t key);
+     * Finds a row already holding the same pixels as data, if any, and rekeys it to data's
+     * generation ID. Returns false in *hashed if the pixels can't be hashed.
+     */
+    AtlasRow* findByContent(const SkBitmap& data, uint32_t* contentHash, bool* hashed);
 
     /**
-     * Compare two atlas rows by key, so we can sort/search by key
+     * Forgets the data the row holds.
      */
-    static bool KeyLess(const AtlasRow& lhs, const AtlasRow& rhs) {
-        return lhs.fKey < rhs.fKey;
-    }
+    void clearRow(AtlasRow* row);
+
+    struct GenIDTraits {
+        static const uint32_t& GetKey(const AtlasRow& row) { return row.fKey; }
+        static uint32_t Hash(const uint32_t& key);
+    };
+    struct ContentTraits {
+        static const uint32_t& GetKey(const AtlasRow& row) { return row.fContentHash; }
+        static uint32_t Hash(const uint32_t& key) { return key; }
+    };
 
 #ifdef SK_DEBUG
     void validate();
@@ -177,8 +196,9 @@ private:
     AtlasRow* fLRUFront;
     AtlasRow* fLRUBack;
 
-    // A list of pointers to AtlasRows that currently contain cached images, sorted by key
-    SkTDArray<AtlasRow*> fKeyTable;
+    // The AtlasRows that currently contain cached images, by key and by content hash
+    SkTDynamicHash<AtlasRow, uint32_t, GenIDTraits> fKeyTable;
+    SkTDynamicHash<AtlasRow, uint32_t, ContentTraits> fContentTable;
 };
 
 inline bool GrTextureStripAtlas::AtlasHashKey::Equals(const AtlasEntry& entry,
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrYUVtoRGBEffect.h"
+#include "GrTBackendEffectFactory.h"
+#include "gl/GrGLEffect.h"
+#include "gl/GrGLSL.h"
+
+class GrGLYUVtoRGBEffect : public GrGLEffect {
+public:
+    GrGLYUVtoRGBEffect(const GrBackendEffectFactory& factory, const GrDrawEffect&)
+        : INHERITED(factory) {
+    }
+
+    virtual void emitCode(GrGLShaderBuilder* builder,
+                          const GrDrawEffect&,
+                          EffectKey,
+                          const char* outputColor,
+                          const char* inputColor,
+                          const TransformedCoordsArray& coords,
+                          const TextureSamplerArray& samplers) SK_OVERRIDE {
+        // The columns apply to Y, U, V and the offset of U and V from 0.5:
+        // R = Y + 1.402 V', G = Y - 0.344136 U' - 0.714136 V', B = Y + 1.772 U'.
+        builder->fsCodeAppendf("\t%s = mat4(1.0, 1.0, 1.0, 0.0, "
+                               "0.0, -0.344136, 1.772, 0.0, "
+                               "1.402, -0.714136, 0.0, 0.0, "
+                               "-0.701, 0.529136, -0.886, 1.0) * vec4(", outputColor);
+        for (int i = 0; i < 3; ++i) {
+            builder->fsAppendTextureLookup(samplers[i], coords[0].c_str(), coords[0].type());
+            builder->fsCodeAppend(", ");
+        }
+        builder->fsCodeAppend("1.0);\n");
+        SkString modulate;
+        GrGLSLMulVarBy4f(&modulate, 1, outputColor, inputColor);
+        builder->fsCodeAppend(modulate.c_str());
+    }
+
+private:
+    typedef GrGLEffect INHERITED;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+GrYUVtoRGBEffect::GrYUVtoRGBEffect(GrTexture* yTexture, GrTexture* uTexture,
+                                   GrTexture* vTexture)
+    : fCoordTransform(kLocal_GrCoordSet, MakeDivByTextureWHMatrix(yTexture), yTexture)
+    // Each plane is read as a single float.
+    , fYAccess(yTexture, "a", GrTextureParams::kBilerp_FilterMode)
+    , fUAccess(uTexture, "a", GrTextureParams::kBilerp_FilterMode)
+    , fVAccess(vTexture, "a", GrTextureParams::kBilerp_FilterMode) {
+    SkASSERT(kAlpha_8_GrPixelConfig == yTexture->config());
+    SkASSERT(kAlpha_8_GrPixelConfig == uTexture->config());
+    SkASSERT(kAlpha_8_GrPixelConfig == vTexture->config());
+    this->addCoordTransform(&fCoordTransform);
+    this->addTextureAccess(&fYAccess);
+    this->addTextureAccess(&fUAccess);
+    this->addTextureAccess(&fVAccess);
+}
+
+GrEffectRef* GrYUVtoRGBEffect::Create(GrTexture* yTexture, GrTexture* uTexture,
+                                      GrTexture* vTexture) {
+    AutoEffectUnref effect(SkNEW_ARGS(GrYUVtoRGBEffect, (yTexture, uTexture, vTexture)));
+    return CreateEffectRef(effect);
+}
+
+const GrBackendEffectFactory& GrYUVtoRGBEffect::getFactory() const {
+    return GrTBackendEffectFactory<GrYUVtoRGBEffect>::getInstance();
+}
+
+bool GrYUVtoRGBEffect::onIsEqual(const GrEffect& sBase) const {
+    const GrYUVtoRGBEffect& s = CastEffect<GrYUVtoRGBEffect>(sBase);
+    return fYAccess.getTexture() == s.fYAccess.getTexture() &&
+           fUAccess.getTexture() == s.fUAccess.getTexture() &&
+           fVAccess.getTexture() == s.fVAccess.getTexture();
+}
+
+void GrYUVtoRGBEffect::getConstantColorComponents(GrColor* color, uint32_t* validFlags) const {
+    // The converted color is opaque, so the output alpha is the input alpha.
+    *validFlags &= kA_GrColorComponentFlag;
+}
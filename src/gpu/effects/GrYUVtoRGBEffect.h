@@ -0,0 +1,47 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrYUVtoRGBEffect_DEFINED
+#define GrYUVtoRGBEffect_DEFINED
+
+#include "GrEffect.h"
+#include "GrCoordTransform.h"
+
+class GrGLYUVtoRGBEffect;
+
+/**
+ * Converts the luma (Y) and chroma (U, V) planes of an image, each in its own A8 texture, to
+ * opaque RGB, using the full range BT.601 coefficients of JPEG. The chroma planes may be smaller
+ * than the luma plane, as with subsampled JPEGs; all three are sampled at the same normalized
+ * coordinates. The local coords are in the texels of the luma texture.
+ */
+class GrYUVtoRGBEffect : public GrEffect {
+public:
+    static GrEffectRef* Create(GrTexture* yTexture, GrTexture* uTexture, GrTexture* vTexture);
+
+    static const char* Name() { return "YUV to RGB"; }
+
+    typedef GrGLYUVtoRGBEffect GLEffect;
+
+    virtual const GrBackendEffectFactory& getFactory() const SK_OVERRIDE;
+
+    virtual void getConstantColorComponents(GrColor* color, uint32_t* validFlags) const SK_OVERRIDE;
+
+private:
+    GrYUVtoRGBEffect(GrTexture* yTexture, GrTexture* uTexture, GrTexture* vTexture);
+
+    virtual bool onIsEqual(const GrEffect&) const SK_OVERRIDE;
+
+    GrCoordTransform fCoordTransform;
+    GrTextureAccess  fYAccess;
+    GrTextureAccess  fUAccess;
+    GrTextureAccess  fVAccess;
+
+    typedef GrEffect INHERITED;
+};
+
+#endif
@@ -56,6 +56,14 @@ const GrGLInterface* GrGLAssembleGLInterface(void* ctx, GrGLGetProc get) {
         extensions.has("GL_EXT_blend_color")) {
         GET_PROC(BlendColor);
     }
+    if (glVer >= GR_GL_VER(1,4) || extensions.has("GL_ARB_imaging")) {
+        GET_PROC(BlendEquation);
+    }
+    if (extensions.has("GL_KHR_blend_equation_advanced")) {
+        GET_PROC_SUFFIX(BlendBarrier, KHR);
+    } else if (extensions.has("GL_NV_blend_equation_advanced")) {
+        GET_PROC_SUFFIX(BlendBarrier, NV);
+    }
 
     GET_PROC(BufferData);
     GET_PROC(BufferSubData);
@@ -288,6 +296,36 @@ const GrGLInterface* GrGLAssembleGLInterface(void* ctx, GrGLGetProc get) {
         GET_PROC(InvalidateTexSubImage);
     }
 
+    if (glVer >= GR_GL_VER(4,1) || extensions.has("GL_ARB_get_program_binary")) {
+        GET_PROC(GetProgramBinary);
+        GET_PROC(ProgramBinary);
+        GET_PROC(ProgramParameteri);
+    }
+
+    if (glVer >= GR_GL_VER(3,2) || extensions.has("GL_ARB_sync")) {
+        GET_PROC(FenceSync);
+        GET_PROC(ClientWaitSync);
+        GET_PROC(DeleteSync);
+    }
+
+    if (glVer >= GR_GL_VER(4,4) || extensions.has("GL_ARB_buffer_storage")) {
+        GET_PROC(BufferStorage);
+    }
+
+    if (glVer >= GR_GL_VER(3,3)) {
+        GET_PROC(DrawArraysInstanced);
+        GET_PROC(VertexAttribDivisor);
+    } else if (extensions.has("GL_ARB_instanced_arrays")) {
+        GET_PROC_SUFFIX(DrawArraysInstanced, ARB);
+        GET_PROC_SUFFIX(VertexAttribDivisor, ARB);
+    }
+
+    if (extensions.has("GL_KHR_parallel_shader_compile")) {
+        GET_PROC_SUFFIX(MaxShaderCompilerThreads, KHR);
+    } else if (extensions.has("GL_ARB_parallel_shader_compile")) {
+        GET_PROC_SUFFIX(MaxShaderCompilerThreads, ARB);
+    }
+
     interface->fStandard = kGL_GrGLStandard;
     interface->fExtensions.swap(&extensions);
 
@@ -23,7 +23,8 @@
 GrGLBufferImpl::GrGLBufferImpl(GrGpuGL* gpu, const Desc& desc, GrGLenum bufferType)
     : fDesc(desc)
     , fBufferType(bufferType)
-    , fMapPtr(NULL) {
+    , fMapPtr(NULL)
+    , fPersistentMapPtr(NULL) {
     if (0 == desc.fID) {
         fCPUData = sk_malloc_flags(desc.fSizeInBytes, SK_MALLOC_THROW);
         fGLSizeInBytes = 0;
@@ -53,6 +54,7 @@ void GrGLBufferImpl::release(GrGpuGL* gpu) {
         fGLSizeInBytes = 0;
     }
     fMapPtr = NULL;
+    fPersistentMapPtr = NULL;
     VALIDATE();
 }
 
@@ -60,6 +62,7 @@ void GrGLBufferImpl::abandon() {
     fDesc.fID = 0;
     fGLSizeInBytes = 0;
     fMapPtr = NULL;
+    fPersistentMapPtr = NULL;
     sk_free(fCPUData);
     fCPUData = NULL;
     VALIDATE();
@@ -81,6 +84,29 @@ void* GrGLBufferImpl::map(GrGpuGL* gpu) {
     SkASSERT(!this->isMapped());
     if (0 == fDesc.fID) {
         fMapPtr = fCPUData;
+    } else if (fDesc.fStreaming) {
+        // The client writes streaming buffers around data the GPU may still be reading, so we
+        // neither invalidate nor synchronize. With buffer storage the mapping is made once and
+        // kept for the life of the buffer.
+        SkASSERT(GrGLCaps::kMapBufferRange_MapBufferType == gpu->glCaps().mapBufferType());
+        if (NULL != fPersistentMapPtr) {
+            fMapPtr = fPersistentMapPtr;
+        } else {
+            this->bind(gpu);
+            bool persistent = gpu->glCaps().bufferStorageSupport();
+            GrGLbitfield access = GR_GL_MAP_WRITE_BIT;
+            if (persistent) {
+                access |= GR_GL_MAP_PERSISTENT_BIT | GR_GL_MAP_COHERENT_BIT;
+            } else {
+                access |= GR_GL_MAP_UNSYNCHRONIZED_BIT;
+            }
+            GR_GL_CALL_RET(gpu->glInterface(),
+                           fMapPtr,
+                           MapBufferRange(fBufferType, 0, fGLSizeInBytes, access));
+            if (persistent) {
+                fPersistentMapPtr = fMapPtr;
+            }
+        }
     } else {
         switch (gpu->glCaps().mapBufferType()) {
             case GrGLCaps::kNone_MapBufferType:
@@ -136,7 +162,9 @@ void* GrGLBufferImpl::map(GrGpuGL* gpu) {
 void GrGLBufferImpl::unmap(GrGpuGL* gpu) {
     VALIDATE();
     SkASSERT(this->isMapped());
-    if (0 != fDesc.fID) {
+    if (NULL != fPersistentMapPtr) {
+        // stays mapped, and coherent mappings need no flush
+    } else if (0 != fDesc.fID) {
         switch (gpu->glCaps().mapBufferType()) {
             case GrGLCaps::kNone_MapBufferType:
                 SkDEBUGFAIL("Shouldn't get here.");
@@ -163,7 +191,8 @@ bool GrGLBufferImpl::isMapped() const {
 bool GrGLBufferImpl::updateData(GrGpuGL* gpu, const void* src, size_t srcSizeInBytes) {
     SkASSERT(!this->isMapped());
     VALIDATE();
-    if (srcSizeInBytes > fDesc.fSizeInBytes) {
+    // streaming buffers may have immutable storage, and are only ever written through map()
+    if (srcSizeInBytes > fDesc.fSizeInBytes || fDesc.fStreaming) {
         return false;
     }
     if (0 == fDesc.fID) {
@@ -223,4 +252,6 @@ void GrGLBufferImpl::validate() const {
     SkASSERT(NULL == fCPUData || 0 == fGLSizeInBytes);
     SkASSERT(NULL == fMapPtr || NULL != fCPUData || fGLSizeInBytes == fDesc.fSizeInBytes);
     SkASSERT(NULL == fCPUData || NULL == fMapPtr || fCPUData == fMapPtr);
+    SkASSERT(NULL == fPersistentMapPtr || fDesc.fStreaming);
+    SkASSERT(NULL == fMapPtr || NULL == fPersistentMapPtr || fPersistentMapPtr == fMapPtr);
 }
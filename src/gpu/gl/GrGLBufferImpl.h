@@ -24,6 +24,7 @@ public:
         GrGLuint    fID;            // set to 0 to indicate buffer is CPU-backed and not a VBO.
         size_t      fSizeInBytes;
         bool        fDynamic;
+        bool        fStreaming;     // see GrGpu::createVertexBuffer()
     };
 
     GrGLBufferImpl(GrGpuGL*, const Desc&, GrGLenum bufferType);
@@ -52,6 +53,7 @@ private:
     GrGLenum     fBufferType; // GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
     void*        fCPUData;
     void*        fMapPtr;
+    void*        fPersistentMapPtr;  // non-NULL for a streaming buffer that stays mapped
     size_t       fGLSizeInBytes;     // In certain cases we make the size of the GL buffer object
                                      // smaller or larger than the size in fDesc.
 
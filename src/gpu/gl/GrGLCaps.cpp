@@ -23,6 +23,7 @@ void GrGLCaps::reset() {
     fStencilVerifiedColorConfigs.reset();
     fMSFBOType = kNone_MSFBOType;
     fFBFetchType = kNone_FBFetchType;
+    fBlendEquationSupport = kBasic_BlendEquationSupport;
     fInvalidateFBType = kNone_InvalidateFBType;
     fLATCAlias = kLATC_LATCAlias;
     fMapBufferType = kNone_MapBufferType;
@@ -48,6 +49,10 @@ void GrGLCaps::reset() {
     fIsCoreProfile = false;
     fFullClearIsFree = false;
     fDropsTileOnZeroDivide = false;
+    fProgramBinarySupport = false;
+    fFenceSyncSupport = false;
+    fBufferStorageSupport = false;
+    fPixelBufferSupport = false;
 }
 
 GrGLCaps::GrGLCaps(const GrGLCaps& caps) : GrDrawTargetCaps() {
@@ -66,6 +71,7 @@ GrGLCaps& GrGLCaps::operator= (const GrGLCaps& caps) {
     fMaxFixedFunctionTextureCoords = caps.fMaxFixedFunctionTextureCoords;
     fMSFBOType = caps.fMSFBOType;
     fFBFetchType = caps.fFBFetchType;
+    fBlendEquationSupport = caps.fBlendEquationSupport;
     fInvalidateFBType = caps.fInvalidateFBType;
     fMapBufferType = caps.fMapBufferType;
     fRGBA8RenderbufferSupport = caps.fRGBA8RenderbufferSupport;
@@ -86,6 +92,10 @@ GrGLCaps& GrGLCaps::operator= (const GrGLCaps& caps) {
     fIsCoreProfile = caps.fIsCoreProfile;
     fFullClearIsFree = caps.fFullClearIsFree;
     fDropsTileOnZeroDivide = caps.fDropsTileOnZeroDivide;
+    fProgramBinarySupport = caps.fProgramBinarySupport;
+    fFenceSyncSupport = caps.fFenceSyncSupport;
+    fBufferStorageSupport = caps.fBufferStorageSupport;
+    fPixelBufferSupport = caps.fPixelBufferSupport;
 
     return *this;
 }
@@ -204,7 +214,9 @@ bool GrGLCaps::init(const GrGLContextInfo& ctxInfo, const GrGLInterface* gli) {
     // frequently changing VBOs. We've measured a performance increase using non-VBO vertex
     // data for dynamic content on these GPUs. Perhaps we should read the renderer string and
     // limit this decision to specific GPU families rather than basing it on the vendor alone.
+    // GrGLCreateThreadedInterface's calls execute after the client-side arrays may be gone.
     if (!GR_GL_MUST_USE_VBO &&
+        !ctxInfo.hasExtension("GL_SKIA_threaded_interface") &&
         (kARM_GrGLVendor == ctxInfo.vendor() || kImagination_GrGLVendor == ctxInfo.vendor())) {
         fUseNonVBOVertexAndIndexDynamicData = true;
     }
@@ -239,9 +251,38 @@ bool GrGLCaps::init(const GrGLContextInfo& ctxInfo, const GrGLInterface* gli) {
         }
     }
 
+    // The advanced equations do the separable and non-separable xfermodes in the blend unit, so
+    // they need neither a dst copy nor framebuffer fetch.
+    if (NULL != gli->fFunctions.fBlendEquation) {
+        if (ctxInfo.hasExtension("GL_KHR_blend_equation_advanced_coherent") ||
+            ctxInfo.hasExtension("GL_NV_blend_equation_advanced_coherent")) {
+            fBlendEquationSupport = kAdvancedCoherent_BlendEquationSupport;
+        } else if ((ctxInfo.hasExtension("GL_KHR_blend_equation_advanced") ||
+                    ctxInfo.hasExtension("GL_NV_blend_equation_advanced")) &&
+                   NULL != gli->fFunctions.fBlendBarrier) {
+            fBlendEquationSupport = kAdvanced_BlendEquationSupport;
+        }
+    }
+
     // Adreno GPUs have a tendency to drop tiles when there is a divide-by-zero in a shader
     fDropsTileOnZeroDivide = kQualcomm_GrGLVendor == ctxInfo.vendor();
 
+    if (kGL_GrGLStandard == standard) {
+        fProgramBinarySupport = version >= GR_GL_VER(4, 1) ||
+                                ctxInfo.hasExtension("GL_ARB_get_program_binary");
+    } else {
+        fProgramBinarySupport = version >= GR_GL_VER(3, 0) ||
+                                ctxInfo.hasExtension("GL_OES_get_program_binary");
+    }
+    if (fProgramBinarySupport) {
+        // Some drivers expose the entry points but no binary formats to use with them.
+        GrGLint formatCount = 0;
+        GR_GL_GetIntegerv(gli, GR_GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        fProgramBinarySupport = formatCount > 0 &&
+                                NULL != gli->fFunctions.fGetProgramBinary &&
+                                NULL != gli->fFunctions.fProgramBinary;
+    }
+
     this->initFSAASupport(ctxInfo, gli);
     this->initStencilFormats(ctxInfo);
 
@@ -286,6 +327,45 @@ bool GrGLCaps::init(const GrGLContextInfo& ctxInfo, const GrGLInterface* gli) {
         }
     }
 
+    if (kGL_GrGLStandard == standard) {
+        fFenceSyncSupport = version >= GR_GL_VER(3, 2) || ctxInfo.hasExtension("GL_ARB_sync");
+        fBufferStorageSupport = version >= GR_GL_VER(4, 4) ||
+                                ctxInfo.hasExtension("GL_ARB_buffer_storage");
+    } else {
+        fFenceSyncSupport = version >= GR_GL_VER(3, 0);
+        fBufferStorageSupport = ctxInfo.hasExtension("GL_EXT_buffer_storage");
+    }
+    fFenceSyncSupport = fFenceSyncSupport &&
+                        NULL != gli->fFunctions.fFenceSync &&
+                        NULL != gli->fFunctions.fClientWaitSync &&
+                        NULL != gli->fFunctions.fDeleteSync;
+    fBufferStorageSupport = fBufferStorageSupport &&
+                            kMapBufferRange_MapBufferType == fMapBufferType &&
+                            NULL != gli->fFunctions.fBufferStorage;
+    // A streaming buffer is either a persistently mapped buffer or one we map unsynchronized;
+    // either way we need fences to know when the GPU is done with the data.
+    fStreamingBufferSupport = fFenceSyncSupport &&
+                              !fUseNonVBOVertexAndIndexDynamicData &&
+                              kMapBufferRange_MapBufferType == fMapBufferType;
+
+    if (kGL_GrGLStandard == standard) {
+        fInstancedDrawingSupport = version >= GR_GL_VER(3, 3) ||
+                                   ctxInfo.hasExtension("GL_ARB_instanced_arrays");
+    } else {
+        fInstancedDrawingSupport = version >= GR_GL_VER(3, 0);
+    }
+    fInstancedDrawingSupport = fInstancedDrawingSupport &&
+                               NULL != gli->fFunctions.fDrawArraysInstanced &&
+                               NULL != gli->fFunctions.fVertexAttribDivisor;
+
+    if (kGL_GrGLStandard == standard) {
+        fPixelBufferSupport = version >= GR_GL_VER(2, 1) ||
+                              ctxInfo.hasExtension("GL_ARB_pixel_buffer_object");
+    } else {
+        fPixelBufferSupport = version >= GR_GL_VER(3, 0) ||
+                              ctxInfo.hasExtension("GL_NV_pixel_buffer_object");
+    }
+
     if (kGL_GrGLStandard == standard) {
         SkASSERT(ctxInfo.version() >= GR_GL_VER(2,0) ||
                  ctxInfo.hasExtension("GL_ARB_texture_non_power_of_two"));
@@ -316,7 +396,16 @@ bool GrGLCaps::init(const GrGLContextInfo& ctxInfo, const GrGLInterface* gli) {
 
     fGpuTracingSupport = ctxInfo.hasExtension("GL_EXT_debug_marker");
 
+    // Scopes are timed with timestamp queries, which unlike time elapsed queries may nest.
+    if (kGL_GrGLStandard == standard) {
+        fTimerQuerySupport = version >= GR_GL_VER(3,3) ||
+                             ctxInfo.hasExtension("GL_ARB_timer_query");
+    } else {
+        fTimerQuerySupport = ctxInfo.hasExtension("GL_EXT_disjoint_timer_query");
+    }
+
     fDstReadInShaderSupport = kNone_FBFetchType != fFBFetchType;
+    fAdvancedBlendEquationSupport = kBasic_BlendEquationSupport != fBlendEquationSupport;
 
     // Disable scratch texture reuse on Mali and Adreno devices
     fReuseScratchTextures = kARM_GrGLVendor != ctxInfo.vendor() &&
@@ -531,6 +620,17 @@ void GrGLCaps::initConfigTexturableTable(const GrGLContextInfo& ctxInfo, const G
 
     fConfigTextureSupport[kLATC_GrPixelConfig] = hasLATC;
     fLATCAlias = alias;
+
+    // Check for R11 EAC. It is core in ES 3.0 and comes with the ES3 compatibility on desktop GL.
+    // It is sampled from the red channel, so we also need red texture support to treat it as alpha.
+    bool hasR11 = hasCompressTex2D && fTextureRedSupport;
+    if (kGL_GrGLStandard == standard) {
+        hasR11 = hasR11 &&
+            (version >= GR_GL_VER(4, 3) || ctxInfo.hasExtension("GL_ARB_ES3_compatibility"));
+    } else {
+        hasR11 = hasR11 && version >= GR_GL_VER(3, 0);
+    }
+    fConfigTextureSupport[kR11_EAC_GrPixelConfig] = hasR11;
 }
 
 bool GrGLCaps::readPixelsSupported(const GrGLInterface* intf,
@@ -735,6 +835,16 @@ SkString GrGLCaps::dump() const {
     GR_STATIC_ASSERT(2 == kNV_FBFetchType);
     GR_STATIC_ASSERT(SK_ARRAY_COUNT(kFBFetchTypeStr) == kLast_FBFetchType + 1);
 
+    static const char* kBlendEquationSupportStr[] = {
+        "Basic",
+        "Advanced",
+        "Advanced Coherent",
+    };
+    GR_STATIC_ASSERT(0 == kBasic_BlendEquationSupport);
+    GR_STATIC_ASSERT(1 == kAdvanced_BlendEquationSupport);
+    GR_STATIC_ASSERT(2 == kAdvancedCoherent_BlendEquationSupport);
+    GR_STATIC_ASSERT(SK_ARRAY_COUNT(kBlendEquationSupportStr) == kLast_BlendEquationSupport + 1);
+
     static const char* kInvalidateFBTypeStr[] = {
         "None",
         "Discard",
@@ -760,6 +870,8 @@ SkString GrGLCaps::dump() const {
     r.appendf("Core Profile: %s\n", (fIsCoreProfile ? "YES" : "NO"));
     r.appendf("MSAA Type: %s\n", kMSFBOExtStr[fMSFBOType]);
     r.appendf("FB Fetch Type: %s\n", kFBFetchTypeStr[fFBFetchType]);
+    r.appendf("Blend Equation Support: %s\n",
+              kBlendEquationSupportStr[fBlendEquationSupport]);
     r.appendf("Invalidate FB Type: %s\n", kInvalidateFBTypeStr[fInvalidateFBType]);
     r.appendf("Map Buffer Type: %s\n", kMapBufferTypeStr[fMapBufferType]);
     r.appendf("Max FS Uniform Vectors: %d\n", fMaxFragmentUniformVectors);
@@ -788,5 +900,9 @@ SkString GrGLCaps::dump() const {
              (fUseNonVBOVertexAndIndexDynamicData ? "YES" : "NO"));
     r.appendf("Full screen clear is free: %s\n", (fFullClearIsFree ? "YES" : "NO"));
     r.appendf("Drops tile on zero divide: %s\n", (fDropsTileOnZeroDivide ? "YES" : "NO"));
+    r.appendf("Program binary support: %s\n", (fProgramBinarySupport ? "YES" : "NO"));
+    r.appendf("Fence sync support: %s\n", (fFenceSyncSupport ? "YES" : "NO"));
+    r.appendf("Buffer storage support: %s\n", (fBufferStorageSupport ? "YES" : "NO"));
+    r.appendf("Pixel buffer support: %s\n", (fPixelBufferSupport ? "YES" : "NO"));
     return r;
 }
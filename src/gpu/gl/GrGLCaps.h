@@ -78,6 +78,17 @@ public:
         kLast_FBFetchType = kNV_FBFetchType
     };
 
+    enum BlendEquationSupport {
+        /** Only the coefficient blend equations. */
+        kBasic_BlendEquationSupport,
+        /** GL_KHR/NV_blend_equation_advanced, needs a glBlendBarrier() between overlapping draws. */
+        kAdvanced_BlendEquationSupport,
+        /** GL_KHR/NV_blend_equation_advanced_coherent */
+        kAdvancedCoherent_BlendEquationSupport,
+
+        kLast_BlendEquationSupport = kAdvancedCoherent_BlendEquationSupport
+    };
+
     enum InvalidateFBType {
         kNone_InvalidateFBType,
         kDiscard_InvalidateFBType,       //<! glDiscardFramebuffer()
@@ -176,6 +187,8 @@ public:
 
     FBFetchType fbFetchType() const { return fFBFetchType; }
 
+    BlendEquationSupport blendEquationSupport() const { return fBlendEquationSupport; }
+
     InvalidateFBType invalidateFBType() const { return fInvalidateFBType; }
 
     /// What type of buffer mapping is supported?
@@ -262,6 +275,18 @@ public:
 
     bool dropsTileOnZeroDivide() const { return fDropsTileOnZeroDivide; }
 
+    /// Can linked programs be saved with glGetProgramBinary and reloaded with glProgramBinary?
+    bool programBinarySupport() const { return fProgramBinarySupport; }
+
+    /// Are sync objects (glFenceSync/glClientWaitSync) supported?
+    bool fenceSyncSupport() const { return fFenceSyncSupport; }
+
+    /// Can buffers be allocated with immutable storage and mapped persistently?
+    bool bufferStorageSupport() const { return fBufferStorageSupport; }
+
+    /// Can textures be uploaded from a buffer bound to GL_PIXEL_UNPACK_BUFFER?
+    bool pixelBufferSupport() const { return fPixelBufferSupport; }
+
     /**
      * Returns a string containing the caps info.
      */
@@ -341,6 +366,7 @@ private:
 
     MSFBOType           fMSFBOType;
     FBFetchType         fFBFetchType;
+    BlendEquationSupport fBlendEquationSupport;
     InvalidateFBType    fInvalidateFBType;
     MapBufferType       fMapBufferType;
     LATCAlias           fLATCAlias;
@@ -363,6 +389,10 @@ private:
     bool fIsCoreProfile : 1;
     bool fFullClearIsFree : 1;
     bool fDropsTileOnZeroDivide : 1;
+    bool fProgramBinarySupport : 1;
+    bool fFenceSyncSupport : 1;
+    bool fBufferStorageSupport : 1;
+    bool fPixelBufferSupport : 1;
 
     typedef GrDrawTargetCaps INHERITED;
 };
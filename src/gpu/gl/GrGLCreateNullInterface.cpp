@@ -9,6 +9,7 @@
 #include "gl/GrGLInterface.h"
 #include "GrGLDefines.h"
 #include "SkTDArray.h"
+#include "SkTLS.h"
 #include "GrGLNoOpInterface.h"
 
 // Functions not declared in GrGLBogusInterface.h (not common with the Debug GL interface).
@@ -47,59 +48,90 @@ private:
 
 // In debug builds we do asserts that ensure we agree with GL about when a buffer
 // is mapped.
-static SkTDArray<GrBufferObj*> gBuffers;  // slot 0 is reserved for head of free list
-static GrGLuint gCurrArrayBuffer;
-static GrGLuint gCurrElementArrayBuffer;
+// The buffers and call counts are kept per thread, so that null contexts on different threads
+// don't race. A null context must be used on the thread that created it.
+struct NullState {
+    NullState() : fCurrArrayBuffer(0), fCurrElementArrayBuffer(0) {
+        sk_bzero(&fCallCounts, sizeof(fCallCounts));
+    }
+
+    SkTDArray<GrBufferObj*> fBuffers;  // slot 0 is reserved for head of free list
+    GrGLuint                fCurrArrayBuffer;
+    GrGLuint                fCurrElementArrayBuffer;
+    GrGLCallCounts          fCallCounts;
+};
+
+static void* create_null_state() { return SkNEW(NullState); }
+static void delete_null_state(void* state) { SkDELETE(static_cast<NullState*>(state)); }
+
+static NullState* null_state() {
+    return static_cast<NullState*>(SkTLS::Get(create_null_state, delete_null_state));
+}
+
+static void count_call(GrGLCallCounts::Kind kind) {
+    ++null_state()->fCallCounts.fCounts[kind];
+}
 
 static GrBufferObj* look_up(GrGLuint id) {
-    GrBufferObj* buffer = gBuffers[id];
+    GrBufferObj* buffer = null_state()->fBuffers[id];
     SkASSERT(NULL != buffer && buffer->id() == id);
     return buffer;
 }
 
 static GrBufferObj* create_buffer() {
-    if (0 == gBuffers.count()) {
+    SkTDArray<GrBufferObj*>& buffers = null_state()->fBuffers;
+    if (0 == buffers.count()) {
         // slot zero is reserved for the head of the free list
-        *gBuffers.append() = NULL;
+        *buffers.append() = NULL;
     }
 
     GrGLuint id;
     GrBufferObj* buffer;
 
-    if (NULL == gBuffers[0]) {
+    if (NULL == buffers[0]) {
         // no free slots - create a new one
-        id = gBuffers.count();
+        id = buffers.count();
         buffer = SkNEW_ARGS(GrBufferObj, (id));
-        gBuffers.append(1, &buffer);
+        buffers.append(1, &buffer);
     } else {
         // recycle a slot from the free list
-        id = SkTCast<GrGLuint>(gBuffers[0]);
-        gBuffers[0] = gBuffers[id];
+        id = SkTCast<GrGLuint>(buffers[0]);
+        buffers[0] = buffers[id];
 
         buffer = SkNEW_ARGS(GrBufferObj, (id));
-        gBuffers[id] = buffer;
+        buffers[id] = buffer;
     }
 
     return buffer;
 }
 
 static void delete_buffer(GrBufferObj* buffer) {
-    SkASSERT(gBuffers.count() > 0);
+    SkTDArray<GrBufferObj*>& buffers = null_state()->fBuffers;
+    SkASSERT(buffers.count() > 0);
 
     GrGLuint id = buffer->id();
     SkDELETE(buffer);
 
     // Add this slot to the free list
-    gBuffers[id] = gBuffers[0];
-    gBuffers[0] = SkTCast<GrBufferObj*>((const void*)(intptr_t)id);
+    buffers[id] = buffers[0];
+    buffers[0] = SkTCast<GrBufferObj*>((const void*)(intptr_t)id);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLActiveTexture(GrGLenum texture) {
+    count_call(GrGLCallCounts::kState_Kind);
 }
 
-GrGLvoid GR_GL_FUNCTION_TYPE nullGLActiveTexture(GrGLenum texture) {}
 GrGLvoid GR_GL_FUNCTION_TYPE nullGLAttachShader(GrGLuint program, GrGLuint shader) {}
 GrGLvoid GR_GL_FUNCTION_TYPE nullGLBeginQuery(GrGLenum target, GrGLuint id) {}
 GrGLvoid GR_GL_FUNCTION_TYPE nullGLBindAttribLocation(GrGLuint program, GrGLuint index, const char* name) {}
-GrGLvoid GR_GL_FUNCTION_TYPE nullGLBindTexture(GrGLenum target, GrGLuint texture) {}
-GrGLvoid GR_GL_FUNCTION_TYPE nullGLBindVertexArray(GrGLuint id) {}
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLBindTexture(GrGLenum target, GrGLuint texture) {
+    count_call(GrGLCallCounts::kBindTexture_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLBindVertexArray(GrGLuint id) {
+    count_call(GrGLCallCounts::kBindVertexArray_Kind);
+}
+
 
 GrGLvoid GR_GL_FUNCTION_TYPE nullGLGenBuffers(GrGLsizei n, GrGLuint* ids) {
 
@@ -115,14 +147,15 @@ GrGLvoid GR_GL_FUNCTION_TYPE nullGLBufferData(GrGLenum target,
                                               GrGLsizeiptr size,
                                               const GrGLvoid* data,
                                               GrGLenum usage) {
+    count_call(GrGLCallCounts::kBufferData_Kind);
     GrGLuint id = 0;
 
     switch (target) {
     case GR_GL_ARRAY_BUFFER:
-        id = gCurrArrayBuffer;
+        id = null_state()->fCurrArrayBuffer;
         break;
     case GR_GL_ELEMENT_ARRAY_BUFFER:
-        id = gCurrElementArrayBuffer;
+        id = null_state()->fCurrElementArrayBuffer;
         break;
     default:
         SkFAIL("Unexpected target to nullGLBufferData");
@@ -135,12 +168,27 @@ GrGLvoid GR_GL_FUNCTION_TYPE nullGLBufferData(GrGLenum target,
     }
 }
 
-GrGLvoid GR_GL_FUNCTION_TYPE nullGLPixelStorei(GrGLenum pname, GrGLint param) {}
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLPixelStorei(GrGLenum pname, GrGLint param) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
 GrGLvoid GR_GL_FUNCTION_TYPE nullGLReadPixels(GrGLint x, GrGLint y, GrGLsizei width, GrGLsizei height, GrGLenum format, GrGLenum type, GrGLvoid* pixels) {}
-GrGLvoid GR_GL_FUNCTION_TYPE nullGLUseProgram(GrGLuint program) {}
-GrGLvoid GR_GL_FUNCTION_TYPE nullGLViewport(GrGLint x, GrGLint y, GrGLsizei width, GrGLsizei height) {}
-GrGLvoid GR_GL_FUNCTION_TYPE nullGLBindFramebuffer(GrGLenum target, GrGLuint framebuffer) {}
-GrGLvoid GR_GL_FUNCTION_TYPE nullGLBindRenderbuffer(GrGLenum target, GrGLuint renderbuffer) {}
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUseProgram(GrGLuint program) {
+    count_call(GrGLCallCounts::kUseProgram_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLViewport(GrGLint x, GrGLint y, GrGLsizei width, GrGLsizei height) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLBindFramebuffer(GrGLenum target, GrGLuint framebuffer) {
+    count_call(GrGLCallCounts::kBindFramebuffer_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLBindRenderbuffer(GrGLenum target, GrGLuint renderbuffer) {
+    count_call(GrGLCallCounts::kBindFramebuffer_Kind);
+}
+
 GrGLvoid GR_GL_FUNCTION_TYPE nullGLDeleteFramebuffers(GrGLsizei n, const GrGLuint *framebuffers) {}
 GrGLvoid GR_GL_FUNCTION_TYPE nullGLDeleteRenderbuffers(GrGLsizei n, const GrGLuint *renderbuffers) {}
 GrGLvoid GR_GL_FUNCTION_TYPE nullGLFramebufferRenderbuffer(GrGLenum target, GrGLenum attachment, GrGLenum renderbuffertarget, GrGLuint renderbuffer) {}
@@ -161,24 +209,26 @@ GrGLvoid GR_GL_FUNCTION_TYPE nullGLDelete(GrGLuint program) {
 }
 
 GrGLvoid GR_GL_FUNCTION_TYPE nullGLBindBuffer(GrGLenum target, GrGLuint buffer) {
+    count_call(GrGLCallCounts::kBindBuffer_Kind);
     switch (target) {
     case GR_GL_ARRAY_BUFFER:
-        gCurrArrayBuffer = buffer;
+        null_state()->fCurrArrayBuffer = buffer;
         break;
     case GR_GL_ELEMENT_ARRAY_BUFFER:
-        gCurrElementArrayBuffer = buffer;
+        null_state()->fCurrElementArrayBuffer = buffer;
         break;
     }
 }
 
 // deleting a bound buffer has the side effect of binding 0
 GrGLvoid GR_GL_FUNCTION_TYPE nullGLDeleteBuffers(GrGLsizei n, const GrGLuint* ids) {
+    NullState* state = null_state();
     for (int i = 0; i < n; ++i) {
-        if (ids[i] == gCurrArrayBuffer) {
-            gCurrArrayBuffer = 0;
+        if (ids[i] == state->fCurrArrayBuffer) {
+            state->fCurrArrayBuffer = 0;
         }
-        if (ids[i] == gCurrElementArrayBuffer) {
-            gCurrElementArrayBuffer = 0;
+        if (ids[i] == state->fCurrElementArrayBuffer) {
+            state->fCurrElementArrayBuffer = 0;
         }
 
         GrBufferObj* buffer = look_up(ids[i]);
@@ -188,13 +238,14 @@ GrGLvoid GR_GL_FUNCTION_TYPE nullGLDeleteBuffers(GrGLsizei n, const GrGLuint* id
 
 GrGLvoid* GR_GL_FUNCTION_TYPE nullGLMapBufferRange(GrGLenum target, GrGLintptr offset,
                                                    GrGLsizeiptr length, GrGLbitfield access) {
+    count_call(GrGLCallCounts::kMapBuffer_Kind);
     GrGLuint id = 0;
     switch (target) {
         case GR_GL_ARRAY_BUFFER:
-            id = gCurrArrayBuffer;
+            id = null_state()->fCurrArrayBuffer;
             break;
         case GR_GL_ELEMENT_ARRAY_BUFFER:
-            id = gCurrElementArrayBuffer;
+            id = null_state()->fCurrElementArrayBuffer;
             break;
     }
 
@@ -209,13 +260,14 @@ GrGLvoid* GR_GL_FUNCTION_TYPE nullGLMapBufferRange(GrGLenum target, GrGLintptr o
 }
 
 GrGLvoid* GR_GL_FUNCTION_TYPE nullGLMapBuffer(GrGLenum target, GrGLenum access) {
+    count_call(GrGLCallCounts::kMapBuffer_Kind);
     GrGLuint id = 0;
     switch (target) {
         case GR_GL_ARRAY_BUFFER:
-            id = gCurrArrayBuffer;
+            id = null_state()->fCurrArrayBuffer;
             break;
         case GR_GL_ELEMENT_ARRAY_BUFFER:
-            id = gCurrElementArrayBuffer;
+            id = null_state()->fCurrElementArrayBuffer;
             break;
     }
 
@@ -232,17 +284,20 @@ GrGLvoid* GR_GL_FUNCTION_TYPE nullGLMapBuffer(GrGLenum target, GrGLenum access)
 
 GrGLvoid GR_GL_FUNCTION_TYPE nullGLFlushMappedBufferRange(GrGLenum target,
                                                           GrGLintptr offset,
-                                                          GrGLsizeiptr length) {}
+                                                          GrGLsizeiptr length) {
+    count_call(GrGLCallCounts::kMapBuffer_Kind);
+}
 
 
 GrGLboolean GR_GL_FUNCTION_TYPE nullGLUnmapBuffer(GrGLenum target) {
+    count_call(GrGLCallCounts::kMapBuffer_Kind);
     GrGLuint id = 0;
     switch (target) {
     case GR_GL_ARRAY_BUFFER:
-        id = gCurrArrayBuffer;
+        id = null_state()->fCurrArrayBuffer;
         break;
     case GR_GL_ELEMENT_ARRAY_BUFFER:
-        id = gCurrElementArrayBuffer;
+        id = null_state()->fCurrElementArrayBuffer;
         break;
     }
     if (id > 0) {
@@ -263,10 +318,10 @@ GrGLvoid GR_GL_FUNCTION_TYPE nullGLGetBufferParameteriv(GrGLenum target, GrGLenu
             GrGLuint id = 0;
             switch (target) {
                 case GR_GL_ARRAY_BUFFER:
-                    id = gCurrArrayBuffer;
+                    id = null_state()->fCurrArrayBuffer;
                     break;
                 case GR_GL_ELEMENT_ARRAY_BUFFER:
-                    id = gCurrElementArrayBuffer;
+                    id = null_state()->fCurrElementArrayBuffer;
                     break;
             }
             if (id > 0) {
@@ -282,6 +337,241 @@ GrGLvoid GR_GL_FUNCTION_TYPE nullGLGetBufferParameteriv(GrGLenum target, GrGLenu
     }
 };
 
+// Functions that do nothing but count the call.
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLDrawArrays(GrGLenum mode, GrGLint first, GrGLsizei count) {
+    count_call(GrGLCallCounts::kDraw_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLDrawElements(GrGLenum mode, GrGLsizei count, GrGLenum type,
+                                                const GrGLvoid* indices) {
+    count_call(GrGLCallCounts::kDraw_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLClear(GrGLbitfield mask) {
+    count_call(GrGLCallCounts::kClear_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform1f(GrGLint location, GrGLfloat v0) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform1i(GrGLint location, GrGLint v0) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform1fv(GrGLint location, GrGLsizei count,
+                                              const GrGLfloat* v) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform1iv(GrGLint location, GrGLsizei count, const GrGLint* v) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform2f(GrGLint location, GrGLfloat v0, GrGLfloat v1) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform2i(GrGLint location, GrGLint v0, GrGLint v1) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform2fv(GrGLint location, GrGLsizei count,
+                                              const GrGLfloat* v) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform2iv(GrGLint location, GrGLsizei count, const GrGLint* v) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform3f(GrGLint location, GrGLfloat v0, GrGLfloat v1,
+                                             GrGLfloat v2) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform3i(GrGLint location, GrGLint v0, GrGLint v1, GrGLint v2) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform3fv(GrGLint location, GrGLsizei count,
+                                              const GrGLfloat* v) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform3iv(GrGLint location, GrGLsizei count, const GrGLint* v) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform4f(GrGLint location, GrGLfloat v0, GrGLfloat v1,
+                                             GrGLfloat v2, GrGLfloat v3) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform4i(GrGLint location, GrGLint v0, GrGLint v1, GrGLint v2,
+                                             GrGLint v3) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform4fv(GrGLint location, GrGLsizei count,
+                                              const GrGLfloat* v) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniform4iv(GrGLint location, GrGLsizei count, const GrGLint* v) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniformMatrix2fv(GrGLint location, GrGLsizei count,
+                                                    GrGLboolean transpose, const GrGLfloat* value) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniformMatrix3fv(GrGLint location, GrGLsizei count,
+                                                    GrGLboolean transpose, const GrGLfloat* value) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLUniformMatrix4fv(GrGLint location, GrGLsizei count,
+                                                    GrGLboolean transpose, const GrGLfloat* value) {
+    count_call(GrGLCallCounts::kUniform_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLBufferSubData(GrGLenum target, GrGLintptr offset,
+                                                 GrGLsizeiptr size, const GrGLvoid* data) {
+    count_call(GrGLCallCounts::kBufferData_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLTexImage2D(GrGLenum target, GrGLint level,
+                                              GrGLint internalformat, GrGLsizei width,
+                                              GrGLsizei height, GrGLint border, GrGLenum format,
+                                              GrGLenum type, const GrGLvoid* pixels) {
+    count_call(GrGLCallCounts::kTexUpload_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLTexSubImage2D(GrGLenum target, GrGLint level, GrGLint xoffset,
+                                                 GrGLint yoffset, GrGLsizei width, GrGLsizei height,
+                                                 GrGLenum format, GrGLenum type,
+                                                 const GrGLvoid* pixels) {
+    count_call(GrGLCallCounts::kTexUpload_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLCompressedTexImage2D(GrGLenum target, GrGLint level,
+                                                        GrGLenum internalformat, GrGLsizei width,
+                                                        GrGLsizei height, GrGLint border,
+                                                        GrGLsizei imageSize, const GrGLvoid* data) {
+    count_call(GrGLCallCounts::kTexUpload_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLCompressedTexSubImage2D(GrGLenum target, GrGLint level,
+                                                           GrGLint xoffset, GrGLint yoffset,
+                                                           GrGLsizei width, GrGLsizei height,
+                                                           GrGLenum format, GrGLsizei imageSize,
+                                                           const GrGLvoid* data) {
+    count_call(GrGLCallCounts::kTexUpload_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLEnable(GrGLenum cap) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLDisable(GrGLenum cap) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLBlendColor(GrGLclampf red, GrGLclampf green, GrGLclampf blue,
+                                              GrGLclampf alpha) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLBlendEquation(GrGLenum mode) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLBlendFunc(GrGLenum sfactor, GrGLenum dfactor) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLColorMask(GrGLboolean red, GrGLboolean green, GrGLboolean blue,
+                                             GrGLboolean alpha) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLCullFace(GrGLenum mode) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLFrontFace(GrGLenum mode) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLDepthMask(GrGLboolean flag) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLLineWidth(GrGLfloat width) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLScissor(GrGLint x, GrGLint y, GrGLsizei width,
+                                           GrGLsizei height) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLStencilFunc(GrGLenum func, GrGLint ref, GrGLuint mask) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLStencilFuncSeparate(GrGLenum face, GrGLenum func, GrGLint ref,
+                                                       GrGLuint mask) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLStencilMask(GrGLuint mask) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLStencilMaskSeparate(GrGLenum face, GrGLuint mask) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLStencilOp(GrGLenum fail, GrGLenum zfail, GrGLenum zpass) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLStencilOpSeparate(GrGLenum face, GrGLenum fail, GrGLenum zfail,
+                                                     GrGLenum zpass) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLTexParameteri(GrGLenum target, GrGLenum pname, GrGLint param) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLTexParameteriv(GrGLenum target, GrGLenum pname,
+                                                  const GrGLint* params) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLEnableVertexAttribArray(GrGLuint index) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLDisableVertexAttribArray(GrGLuint index) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLVertexAttrib4fv(GrGLuint indx, const GrGLfloat* values) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE nullGLVertexAttribPointer(GrGLuint indx, GrGLint size, GrGLenum type,
+                                                       GrGLboolean normalized, GrGLsizei stride,
+                                                       const GrGLvoid* ptr) {
+    count_call(GrGLCallCounts::kState_Kind);
+}
+
 } // end anonymous namespace
 
 const GrGLInterface* GrGLCreateNullInterface() {
@@ -298,41 +588,42 @@ const GrGLInterface* GrGLCreateNullInterface() {
     functions->fBindFragDataLocation = noOpGLBindFragDataLocation;
     functions->fBindTexture = nullGLBindTexture;
     functions->fBindVertexArray = nullGLBindVertexArray;
-    functions->fBlendColor = noOpGLBlendColor;
-    functions->fBlendFunc = noOpGLBlendFunc;
+    functions->fBlendColor = nullGLBlendColor;
+    functions->fBlendEquation = nullGLBlendEquation;
+    functions->fBlendFunc = nullGLBlendFunc;
     functions->fBufferData = nullGLBufferData;
-    functions->fBufferSubData = noOpGLBufferSubData;
-    functions->fClear = noOpGLClear;
+    functions->fBufferSubData = nullGLBufferSubData;
+    functions->fClear = nullGLClear;
     functions->fClearColor = noOpGLClearColor;
     functions->fClearStencil = noOpGLClearStencil;
-    functions->fColorMask = noOpGLColorMask;
+    functions->fColorMask = nullGLColorMask;
     functions->fCompileShader = noOpGLCompileShader;
-    functions->fCompressedTexImage2D = noOpGLCompressedTexImage2D;
-    functions->fCompressedTexSubImage2D = noOpGLCompressedTexSubImage2D;
+    functions->fCompressedTexImage2D = nullGLCompressedTexImage2D;
+    functions->fCompressedTexSubImage2D = nullGLCompressedTexSubImage2D;
     functions->fCopyTexSubImage2D = noOpGLCopyTexSubImage2D;
     functions->fCreateProgram = nullGLCreateProgram;
     functions->fCreateShader = nullGLCreateShader;
-    functions->fCullFace = noOpGLCullFace;
+    functions->fCullFace = nullGLCullFace;
     functions->fDeleteBuffers = nullGLDeleteBuffers;
     functions->fDeleteProgram = nullGLDelete;
     functions->fDeleteQueries = noOpGLDeleteIds;
     functions->fDeleteShader = nullGLDelete;
     functions->fDeleteTextures = noOpGLDeleteIds;
     functions->fDeleteVertexArrays = noOpGLDeleteIds;
-    functions->fDepthMask = noOpGLDepthMask;
-    functions->fDisable = noOpGLDisable;
-    functions->fDisableVertexAttribArray = noOpGLDisableVertexAttribArray;
-    functions->fDrawArrays = noOpGLDrawArrays;
+    functions->fDepthMask = nullGLDepthMask;
+    functions->fDisable = nullGLDisable;
+    functions->fDisableVertexAttribArray = nullGLDisableVertexAttribArray;
+    functions->fDrawArrays = nullGLDrawArrays;
     functions->fDrawBuffer = noOpGLDrawBuffer;
     functions->fDrawBuffers = noOpGLDrawBuffers;
-    functions->fDrawElements = noOpGLDrawElements;
-    functions->fEnable = noOpGLEnable;
-    functions->fEnableVertexAttribArray = noOpGLEnableVertexAttribArray;
+    functions->fDrawElements = nullGLDrawElements;
+    functions->fEnable = nullGLEnable;
+    functions->fEnableVertexAttribArray = nullGLEnableVertexAttribArray;
     functions->fEndQuery = noOpGLEndQuery;
     functions->fFinish = noOpGLFinish;
     functions->fFlush = noOpGLFlush;
     functions->fFlushMappedBufferRange = nullGLFlushMappedBufferRange;
-    functions->fFrontFace = noOpGLFrontFace;
+    functions->fFrontFace = nullGLFrontFace;
     functions->fGenBuffers = nullGLGenBuffers;
     functions->fGenerateMipmap = nullGLGenerateMipmap;
     functions->fGenQueries = noOpGLGenIds;
@@ -355,7 +646,7 @@ const GrGLInterface* GrGLCreateNullInterface() {
     functions->fGetTexLevelParameteriv = noOpGLGetTexLevelParameteriv;
     functions->fGetUniformLocation = noOpGLGetUniformLocation;
     functions->fInsertEventMarker = noOpGLInsertEventMarker;
-    functions->fLineWidth = noOpGLLineWidth;
+    functions->fLineWidth = nullGLLineWidth;
     functions->fLinkProgram = noOpGLLinkProgram;
     functions->fMapBuffer = nullGLMapBuffer;
     functions->fMapBufferRange = nullGLMapBufferRange;
@@ -365,43 +656,43 @@ const GrGLInterface* GrGLCreateNullInterface() {
     functions->fQueryCounter = noOpGLQueryCounter;
     functions->fReadBuffer = noOpGLReadBuffer;
     functions->fReadPixels = nullGLReadPixels;
-    functions->fScissor = noOpGLScissor;
+    functions->fScissor = nullGLScissor;
     functions->fShaderSource = noOpGLShaderSource;
-    functions->fStencilFunc = noOpGLStencilFunc;
-    functions->fStencilFuncSeparate = noOpGLStencilFuncSeparate;
-    functions->fStencilMask = noOpGLStencilMask;
-    functions->fStencilMaskSeparate = noOpGLStencilMaskSeparate;
-    functions->fStencilOp = noOpGLStencilOp;
-    functions->fStencilOpSeparate = noOpGLStencilOpSeparate;
-    functions->fTexImage2D = noOpGLTexImage2D;
-    functions->fTexParameteri = noOpGLTexParameteri;
-    functions->fTexParameteriv = noOpGLTexParameteriv;
-    functions->fTexSubImage2D = noOpGLTexSubImage2D;
+    functions->fStencilFunc = nullGLStencilFunc;
+    functions->fStencilFuncSeparate = nullGLStencilFuncSeparate;
+    functions->fStencilMask = nullGLStencilMask;
+    functions->fStencilMaskSeparate = nullGLStencilMaskSeparate;
+    functions->fStencilOp = nullGLStencilOp;
+    functions->fStencilOpSeparate = nullGLStencilOpSeparate;
+    functions->fTexImage2D = nullGLTexImage2D;
+    functions->fTexParameteri = nullGLTexParameteri;
+    functions->fTexParameteriv = nullGLTexParameteriv;
+    functions->fTexSubImage2D = nullGLTexSubImage2D;
     functions->fTexStorage2D = noOpGLTexStorage2D;
     functions->fDiscardFramebuffer = noOpGLDiscardFramebuffer;
-    functions->fUniform1f = noOpGLUniform1f;
-    functions->fUniform1i = noOpGLUniform1i;
-    functions->fUniform1fv = noOpGLUniform1fv;
-    functions->fUniform1iv = noOpGLUniform1iv;
-    functions->fUniform2f = noOpGLUniform2f;
-    functions->fUniform2i = noOpGLUniform2i;
-    functions->fUniform2fv = noOpGLUniform2fv;
-    functions->fUniform2iv = noOpGLUniform2iv;
-    functions->fUniform3f = noOpGLUniform3f;
-    functions->fUniform3i = noOpGLUniform3i;
-    functions->fUniform3fv = noOpGLUniform3fv;
-    functions->fUniform3iv = noOpGLUniform3iv;
-    functions->fUniform4f = noOpGLUniform4f;
-    functions->fUniform4i = noOpGLUniform4i;
-    functions->fUniform4fv = noOpGLUniform4fv;
-    functions->fUniform4iv = noOpGLUniform4iv;
-    functions->fUniformMatrix2fv = noOpGLUniformMatrix2fv;
-    functions->fUniformMatrix3fv = noOpGLUniformMatrix3fv;
-    functions->fUniformMatrix4fv = noOpGLUniformMatrix4fv;
+    functions->fUniform1f = nullGLUniform1f;
+    functions->fUniform1i = nullGLUniform1i;
+    functions->fUniform1fv = nullGLUniform1fv;
+    functions->fUniform1iv = nullGLUniform1iv;
+    functions->fUniform2f = nullGLUniform2f;
+    functions->fUniform2i = nullGLUniform2i;
+    functions->fUniform2fv = nullGLUniform2fv;
+    functions->fUniform2iv = nullGLUniform2iv;
+    functions->fUniform3f = nullGLUniform3f;
+    functions->fUniform3i = nullGLUniform3i;
+    functions->fUniform3fv = nullGLUniform3fv;
+    functions->fUniform3iv = nullGLUniform3iv;
+    functions->fUniform4f = nullGLUniform4f;
+    functions->fUniform4i = nullGLUniform4i;
+    functions->fUniform4fv = nullGLUniform4fv;
+    functions->fUniform4iv = nullGLUniform4iv;
+    functions->fUniformMatrix2fv = nullGLUniformMatrix2fv;
+    functions->fUniformMatrix3fv = nullGLUniformMatrix3fv;
+    functions->fUniformMatrix4fv = nullGLUniformMatrix4fv;
     functions->fUnmapBuffer = nullGLUnmapBuffer;
     functions->fUseProgram = nullGLUseProgram;
-    functions->fVertexAttrib4fv = noOpGLVertexAttrib4fv;
-    functions->fVertexAttribPointer = noOpGLVertexAttribPointer;
+    functions->fVertexAttrib4fv = nullGLVertexAttrib4fv;
+    functions->fVertexAttribPointer = nullGLVertexAttribPointer;
     functions->fViewport = nullGLViewport;
     functions->fBindFramebuffer = nullGLBindFramebuffer;
     functions->fBindRenderbuffer = nullGLBindRenderbuffer;
@@ -426,3 +717,70 @@ const GrGLInterface* GrGLCreateNullInterface() {
                                 functions->fGetIntegerv);
     return interface;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+static const char* gCallKindNames[] = {
+    "draw",
+    "clear",
+    "use_program",
+    "uniform",
+    "bind_buffer",
+    "bind_texture",
+    "bind_framebuffer",
+    "bind_vertex_array",
+    "buffer_data",
+    "map_buffer",
+    "tex_upload",
+    "state",
+};
+SK_COMPILE_ASSERT(SK_ARRAY_COUNT(gCallKindNames) == GrGLCallCounts::kKindCount,
+                  call_kind_names_mismatch);
+
+// Rough costs in microseconds. What matters is their ratio: draws validate all the bound state
+// and framebuffer binds may flush, while uniforms and simple state are cheap.
+static const double gCallKindCosts[] = {
+    5.0,    // draw
+    3.0,    // clear
+    1.0,    // use_program
+    0.1,    // uniform
+    0.2,    // bind_buffer
+    0.3,    // bind_texture
+    5.0,    // bind_framebuffer
+    0.5,    // bind_vertex_array
+    2.0,    // buffer_data
+    2.0,    // map_buffer
+    10.0,   // tex_upload
+    0.1,    // state
+};
+SK_COMPILE_ASSERT(SK_ARRAY_COUNT(gCallKindCosts) == GrGLCallCounts::kKindCount,
+                  call_kind_costs_mismatch);
+
+const char* GrGLCallCounts::Name(Kind kind) {
+    SkASSERT((unsigned)kind < (unsigned)kKindCount);
+    return gCallKindNames[kind];
+}
+
+int GrGLCallCounts::total() const {
+    int total = 0;
+    for (int i = 0; i < kKindCount; ++i) {
+        total += fCounts[i];
+    }
+    return total;
+}
+
+double GrGLCallCounts::modeledDriverMicroseconds() const {
+    double us = 0;
+    for (int i = 0; i < kKindCount; ++i) {
+        us += fCounts[i] * gCallKindCosts[i];
+    }
+    return us;
+}
+
+void GrGLGetNullCallCounts(GrGLCallCounts* counts) {
+    *counts = null_state()->fCallCounts;
+}
+
+void GrGLResetNullCallCounts() {
+    sk_bzero(&null_state()->fCallCounts, sizeof(GrGLCallCounts));
+}
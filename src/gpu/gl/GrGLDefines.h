@@ -83,13 +83,39 @@
 #define GR_GL_ONE_MINUS_CONSTANT_ALPHA       0x8004
 #define GR_GL_BLEND_COLOR                    0x8005
 
+/* Blend Equations */
+#define GR_GL_FUNC_ADD                       0x8006
+
+/* KHR_blend_equation_advanced */
+#define GR_GL_MULTIPLY                       0x9294
+#define GR_GL_SCREEN                         0x9295
+#define GR_GL_OVERLAY                        0x9296
+#define GR_GL_DARKEN                         0x9297
+#define GR_GL_LIGHTEN                        0x9298
+#define GR_GL_COLORDODGE                     0x9299
+#define GR_GL_COLORBURN                      0x929A
+#define GR_GL_HARDLIGHT                      0x929B
+#define GR_GL_SOFTLIGHT                      0x929C
+#define GR_GL_DIFFERENCE                     0x929E
+#define GR_GL_EXCLUSION                      0x92A0
+#define GR_GL_HSL_HUE                        0x92AD
+#define GR_GL_HSL_SATURATION                 0x92AE
+#define GR_GL_HSL_COLOR                      0x92AF
+#define GR_GL_HSL_LUMINOSITY                 0x92B0
+
+/* KHR_blend_equation_advanced_coherent */
+#define GR_GL_BLEND_ADVANCED_COHERENT        0x9285
+
 /* Buffer Objects */
 #define GR_GL_ARRAY_BUFFER                   0x8892
 #define GR_GL_ELEMENT_ARRAY_BUFFER           0x8893
 #define GR_GL_ARRAY_BUFFER_BINDING           0x8894
 #define GR_GL_ELEMENT_ARRAY_BUFFER_BINDING   0x8895
+#define GR_GL_PIXEL_PACK_BUFFER              0x88EB
+#define GR_GL_PIXEL_UNPACK_BUFFER            0x88EC
 
 #define GR_GL_STREAM_DRAW                    0x88E0
+#define GR_GL_STREAM_READ                    0x88E1
 #define GR_GL_STATIC_DRAW                    0x88E4
 #define GR_GL_DYNAMIC_DRAW                   0x88E8
 
@@ -408,6 +434,12 @@
 #define GR_GL_ACTIVE_ATTRIBUTE_MAX_LENGTH      0x8B8A
 #define GR_GL_SHADING_LANGUAGE_VERSION         0x8B8C
 #define GR_GL_CURRENT_PROGRAM                  0x8B8D
+
+/* Program Binaries */
+#define GR_GL_PROGRAM_BINARY_RETRIEVABLE_HINT  0x8257
+#define GR_GL_PROGRAM_BINARY_LENGTH            0x8741
+#define GR_GL_NUM_PROGRAM_BINARY_FORMATS       0x87FE
+#define GR_GL_PROGRAM_BINARY_FORMATS           0x87FF
 #define GR_GL_MAX_FRAGMENT_UNIFORM_COMPONENTS  0x8B49
 #define GR_GL_MAX_VERTEX_UNIFORM_COMPONENTS    0x8B4A
 
@@ -675,6 +707,7 @@
 #define GR_GL_T4F_C4F_N3F_V4F                    0x2A2D
 
 /* Vertex Buffer Object */
+#define GR_GL_READ_ONLY                          0x88B8
 #define GR_GL_WRITE_ONLY                         0x88B9
 #define GR_GL_BUFFER_MAPPED                      0x88BC
 
@@ -684,6 +717,17 @@
 #define GR_GL_MAP_INVALIDATE_BUFFER_BIT          0x0008
 #define GR_GL_MAP_FLUSH_EXPLICIT_BIT             0x0010
 #define GR_GL_MAP_UNSYNCHRONIZED_BIT             0x0020
+#define GR_GL_MAP_PERSISTENT_BIT                 0x0040
+#define GR_GL_MAP_COHERENT_BIT                   0x0080
+#define GR_GL_DYNAMIC_STORAGE_BIT                0x0100
+
+/* Sync Objects */
+#define GR_GL_SYNC_GPU_COMMANDS_COMPLETE         0x9117
+#define GR_GL_SYNC_FLUSH_COMMANDS_BIT            0x00000001
+#define GR_GL_ALREADY_SIGNALED                   0x911A
+#define GR_GL_TIMEOUT_EXPIRED                    0x911B
+#define GR_GL_CONDITION_SATISFIED                0x911C
+#define GR_GL_WAIT_FAILED                        0x911D
 
 /* Read Format */
 #define GR_GL_IMPLEMENTATION_COLOR_READ_TYPE   0x8B9A
@@ -716,6 +760,7 @@
 #define GR_GL_ANY_SAMPLES_PASSED             0x8C2F
 #define GR_GL_TIME_ELAPSED                   0x88BF
 #define GR_GL_TIMESTAMP                      0x8E28
+#define GR_GL_GPU_DISJOINT                   0x8FBB
 #define GR_GL_PRIMITIVES_GENERATED           0x8C87
 #define GR_GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN 0x8C88
 
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrGLGpuTimer.h"
+#include "GrGpuGL.h"
+#include "GrTraceMarker.h"
+
+#define GL_CALL(X) GR_GL_CALL(this->getGpuGL()->glInterface(), X)
+
+// Frames still waiting on the GPU beyond this many are dropped rather than waited for.
+static const int kMaxPendingFrames = 4;
+
+GrGLGpuTimer::GrGLGpuTimer(GrGpuGL* gpu)
+    : INHERITED(gpu, false)
+    , fCurrFrame(SkNEW(Frame))
+    , fHasLastFrame(false) {
+    SkASSERT(gpu->caps()->timerQuerySupport());
+}
+
+GrGLGpuTimer::~GrGLGpuTimer() {
+    this->release();
+    SkDELETE(fCurrFrame);
+}
+
+GrGLuint GrGLGpuTimer::timestamp() {
+    GrGLuint query;
+    if (fFreeQueries.isEmpty()) {
+        GL_CALL(GenQueries(1, &query));
+    } else {
+        fFreeQueries.pop(&query);
+    }
+    GL_CALL(QueryCounter(query, GR_GL_TIMESTAMP));
+    fCurrFrame->fLastQuery = query;
+    return query;
+}
+
+void GrGLGpuTimer::pushScope(Scope* scope) {
+    scope->fBeginQuery = this->timestamp();
+    scope->fEndQuery = 0;
+    *fOpenScopes.append() = fCurrFrame->fScopes.count() - 1;
+}
+
+void GrGLGpuTimer::beginScope(const char* name) {
+    Scope* scope = fCurrFrame->fScopes.append();
+    scope->fFirstName = fCurrFrame->fNames.count();
+    scope->fNameCount = 1;
+    *fCurrFrame->fNames.append() = name;
+    this->pushScope(scope);
+}
+
+void GrGLGpuTimer::beginScope(const GrTraceMarkerSet& markers) {
+    Scope* scope = fCurrFrame->fScopes.append();
+    scope->fFirstName = fCurrFrame->fNames.count();
+    // A set holds each instance of a marker, but a scope counts once towards each name.
+    for (GrTraceMarkerSet::Iter iter = markers.begin(); iter != markers.end(); ++iter) {
+        const char* name = (*iter).fMarker;
+        bool found = false;
+        for (int i = scope->fFirstName; i < fCurrFrame->fNames.count() && !found; ++i) {
+            found = 0 == strcmp(fCurrFrame->fNames[i], name);
+        }
+        if (!found) {
+            *fCurrFrame->fNames.append() = name;
+        }
+    }
+    scope->fNameCount = fCurrFrame->fNames.count() - scope->fFirstName;
+    this->pushScope(scope);
+}
+
+void GrGLGpuTimer::endScope() {
+    if (fOpenScopes.isEmpty()) {
+        return;
+    }
+    int index;
+    fOpenScopes.pop(&index);
+    fCurrFrame->fScopes[index].fEndQuery = this->timestamp();
+}
+
+bool GrGLGpuTimer::isAvailable(GrGLuint query) const {
+    GrGLint available = 0;
+    GL_CALL(GetQueryObjectiv(query, GR_GL_QUERY_RESULT_AVAILABLE, &available));
+    return 0 != available;
+}
+
+void GrGLGpuTimer::endFrame() {
+    if (this->wasDestroyed() || !fOpenScopes.isEmpty()) {
+        return;
+    }
+    *fPendingFrames.append() = fCurrFrame;
+    fCurrFrame = SkNEW(Frame);
+
+    // On ES the timer can be thrown off, e.g. by a change of GPU frequency, and the queries that
+    // spanned it hold garbage. Checking clears the flag.
+    if (kGLES_GrGLStandard == this->getGpuGL()->glStandard()) {
+        GrGLint disjoint = 0;
+        GL_CALL(GetIntegerv(GR_GL_GPU_DISJOINT, &disjoint));
+        if (0 != disjoint) {
+            for (int i = 0; i < fPendingFrames.count(); ++i) {
+                this->recycle(fPendingFrames[i]);
+            }
+            fPendingFrames.reset();
+        }
+    }
+
+    // The queries of a frame complete in order, so the frame is done once its last one is.
+    int resolved = 0;
+    for (; resolved < fPendingFrames.count(); ++resolved) {
+        Frame* frame = fPendingFrames[resolved];
+        if (0 != frame->fLastQuery && !this->isAvailable(frame->fLastQuery)) {
+            break;
+        }
+        this->resolve(frame);
+        this->recycle(frame);
+    }
+    fPendingFrames.remove(0, resolved);
+
+    while (fPendingFrames.count() > kMaxPendingFrames) {
+        this->recycle(fPendingFrames[0]);
+        fPendingFrames.remove(0);
+    }
+}
+
+void GrGLGpuTimer::resolve(Frame* frame) {
+    fLastFrameTimes.reset();
+    fHasLastFrame = true;
+    for (int i = 0; i < frame->fScopes.count(); ++i) {
+        const Scope& scope = frame->fScopes[i];
+        GrGLuint64 begin = 0, end = 0;
+        GL_CALL(GetQueryObjectui64v(scope.fBeginQuery, GR_GL_QUERY_RESULT, &begin));
+        GL_CALL(GetQueryObjectui64v(scope.fEndQuery, GR_GL_QUERY_RESULT, &end));
+        double ms = end > begin ? (end - begin) / 1e6 : 0;
+
+        for (int n = scope.fFirstName; n < scope.fFirstName + scope.fNameCount; ++n) {
+            const char* name = frame->fNames[n];
+            GrContext::GpuScopeTime* time = NULL;
+            for (int t = 0; t < fLastFrameTimes.count() && NULL == time; ++t) {
+                if (0 == strcmp(fLastFrameTimes[t].fName, name)) {
+                    time = &fLastFrameTimes[t];
+                }
+            }
+            if (NULL == time) {
+                time = &fLastFrameTimes.push_back();
+                time->fName = name;
+                time->fCount = 0;
+                time->fMs = 0;
+            }
+            ++time->fCount;
+            time->fMs += ms;
+        }
+    }
+}
+
+// Returns the frame's queries to the free list and deletes the frame.
+void GrGLGpuTimer::recycle(Frame* frame) {
+    for (int i = 0; i < frame->fScopes.count(); ++i) {
+        *fFreeQueries.append() = frame->fScopes[i].fBeginQuery;
+        *fFreeQueries.append() = frame->fScopes[i].fEndQuery;
+    }
+    SkDELETE(frame);
+}
+
+bool GrGLGpuTimer::getFrame(SkTArray<GrContext::GpuScopeTime>* times) const {
+    if (!fHasLastFrame) {
+        return false;
+    }
+    times->reset();
+    times->push_back_n(fLastFrameTimes.count(), fLastFrameTimes.begin());
+    return true;
+}
+
+void GrGLGpuTimer::deleteQueries() {
+    for (int i = 0; i < fPendingFrames.count(); ++i) {
+        this->recycle(fPendingFrames[i]);
+    }
+    fPendingFrames.reset();
+    // Scopes that are still open have no end query yet.
+    for (int i = 0; i < fCurrFrame->fScopes.count(); ++i) {
+        *fFreeQueries.append() = fCurrFrame->fScopes[i].fBeginQuery;
+        if (0 != fCurrFrame->fScopes[i].fEndQuery) {
+            *fFreeQueries.append() = fCurrFrame->fScopes[i].fEndQuery;
+        }
+    }
+    fCurrFrame->fScopes.reset();
+    fCurrFrame->fNames.reset();
+    fCurrFrame->fLastQuery = 0;
+    fOpenScopes.reset();
+    if (!fFreeQueries.isEmpty()) {
+        GL_CALL(DeleteQueries(fFreeQueries.count(), fFreeQueries.begin()));
+    }
+    fFreeQueries.reset();
+}
+
+void GrGLGpuTimer::onRelease() {
+    if (!this->wasDestroyed()) {
+        this->deleteQueries();
+    }
+    INHERITED::onRelease();
+}
+
+void GrGLGpuTimer::onAbandon() {
+    for (int i = 0; i < fPendingFrames.count(); ++i) {
+        SkDELETE(fPendingFrames[i]);
+    }
+    fPendingFrames.reset();
+    fCurrFrame->fScopes.reset();
+    fCurrFrame->fNames.reset();
+    fCurrFrame->fLastQuery = 0;
+    fOpenScopes.reset();
+    fFreeQueries.reset();
+    INHERITED::onAbandon();
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrGLGpuTimer_DEFINED
+#define GrGLGpuTimer_DEFINED
+
+#include "GrContext.h"
+#include "GrGpuObject.h"
+#include "gl/GrGLFunctions.h"
+#include "SkTArray.h"
+#include "SkTDArray.h"
+
+class GrGpuGL;
+class GrTraceMarkerSet;
+
+/**
+ * Times trace marker scopes on the GPU. A GL_TIMESTAMP query is issued when a scope begins and
+ * another when it ends, so scopes may nest, unlike with GL_TIME_ELAPSED queries. The queries of
+ * a frame are read back a few frames after endFrame(), once the GPU has caught up, so reading
+ * them never stalls.
+ *
+ * A scope is named by every marker that was active when it began. The time of a scope counts
+ * towards each of its names, so a name's time includes that of the scopes nested within it.
+ */
+class GrGLGpuTimer : public GrGpuObject {
+public:
+    /**
+     * Requires GrDrawTargetCaps::timerQuerySupport().
+     */
+    GrGLGpuTimer(GrGpuGL*);
+    virtual ~GrGLGpuTimer();
+
+    // The name must be a literal, as trace marker names are.
+    void beginScope(const char* name);
+    void beginScope(const GrTraceMarkerSet&);
+    void endScope();
+
+    /**
+     * Closes the current frame and resolves any earlier frames whose queries have completed.
+     * Does nothing while a scope is open.
+     */
+    void endFrame();
+
+    /**
+     * The times of the most recently resolved frame, one entry per marker name. Returns false
+     * if no frame has been resolved yet.
+     */
+    bool getFrame(SkTArray<GrContext::GpuScopeTime>*) const;
+
+    virtual size_t gpuMemorySize() const SK_OVERRIDE { return 0; }
+
+protected:
+    virtual void onRelease() SK_OVERRIDE;
+    virtual void onAbandon() SK_OVERRIDE;
+
+private:
+    struct Scope {
+        GrGLuint            fBeginQuery;
+        GrGLuint            fEndQuery;
+        int                 fFirstName;
+        int                 fNameCount;
+    };
+
+    struct Frame {
+        Frame() : fLastQuery(0) {}
+
+        SkTDArray<Scope>        fScopes;
+        SkTDArray<const char*>  fNames;
+        GrGLuint                fLastQuery;
+    };
+
+    GrGpuGL* getGpuGL() const { return (GrGpuGL*)this->getGpu(); }
+    GrGLuint timestamp();
+    void pushScope(Scope*);
+    bool isAvailable(GrGLuint query) const;
+    void resolve(Frame*);
+    void recycle(Frame*);
+    void deleteQueries();
+
+    Frame*                  fCurrFrame;
+    // Frames waiting for the GPU, oldest first.
+    SkTDArray<Frame*>       fPendingFrames;
+    // Indices into fCurrFrame->fScopes of the scopes that have begun but not ended.
+    SkTDArray<int>          fOpenScopes;
+    SkTDArray<GrGLuint>     fFreeQueries;
+
+    SkTArray<GrContext::GpuScopeTime, true> fLastFrameTimes;
+    bool                                    fHasLastFrame;
+
+    typedef GrGpuObject INHERITED;
+};
+
+#endif
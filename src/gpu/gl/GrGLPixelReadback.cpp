@@ -0,0 +1,148 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrGLPixelReadback.h"
+#include "GrGLIRect.h"
+#include "GrGpuGL.h"
+
+#define GL_CALL(X) GR_GL_CALL(this->getGpuGL()->glInterface(), X)
+#define GL_CALL_RET(RET, X) GR_GL_CALL_RET(this->getGpuGL()->glInterface(), RET, X)
+
+GrGLPixelReadback::GrGLPixelReadback(GrGpuGL* gpu, int width, int height, GrPixelConfig config,
+                                     bool flipY)
+    : INHERITED(gpu, width, height, config)
+    , fBufferID(0)
+    , fRowBytes(SkAlign4(width * GrBytesPerPixel(config)))
+    , fFlipY(flipY)
+    , fFence(0) {
+    SkASSERT(gpu->glCaps().pixelBufferSupport());
+    SkASSERT(gpu->glCaps().fenceSyncSupport());
+
+    GL_CALL(GenBuffers(1, &fBufferID));
+    if (0 == fBufferID) {
+        return;
+    }
+    this->bind(fBufferID);
+    GrGLClearErr(gpu->glInterface());
+    GR_GL_CALL_NOERRCHECK(gpu->glInterface(),
+                          BufferData(GR_GL_PIXEL_PACK_BUFFER,
+                                     (GrGLsizeiptr) (fRowBytes * height),
+                                     NULL,  // data ptr
+                                     GR_GL_STREAM_READ));
+    if (GR_GL_GET_ERROR(gpu->glInterface()) != GR_GL_NO_ERROR) {
+        GL_CALL(DeleteBuffers(1, &fBufferID));
+        fBufferID = 0;
+    }
+    this->bind(0);
+}
+
+GrGLPixelReadback::~GrGLPixelReadback() {
+    this->release();
+}
+
+void GrGLPixelReadback::bind(GrGLuint id) const {
+    GL_CALL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, id));
+}
+
+void GrGLPixelReadback::issue(const GrGLIRect& readRect, GrGLenum format, GrGLenum type) {
+    SkASSERT(this->isValid());
+    SkASSERT(0 == fFence);
+    SkASSERT(readRect.fWidth == this->width() && readRect.fHeight == this->height());
+
+    this->bind(fBufferID);
+    GL_CALL(ReadPixels(readRect.fLeft, readRect.fBottom,
+                       readRect.fWidth, readRect.fHeight,
+                       format, type, NULL));  // offset into the buffer
+    this->bind(0);
+    // Without a fence mapping the buffer still waits for the read, it just can't be polled.
+    fFence = this->getGpuGL()->insertFence();
+    // Get the GPU started on the read, so that it may be done by the time it's polled.
+    GL_CALL(Flush());
+}
+
+bool GrGLPixelReadback::isReady() {
+    if (this->wasDestroyed() || 0 == fFence) {
+        return true;
+    }
+    GrGLenum result;
+    GL_CALL_RET(result, ClientWaitSync((GrGLsync)(intptr_t)fFence, 0, 0));
+    return GR_GL_TIMEOUT_EXPIRED != result;
+}
+
+bool GrGLPixelReadback::readPixels(void* buffer, size_t rowBytes) {
+    if (this->wasDestroyed() || !this->isValid()) {
+        return false;
+    }
+    const size_t tightRowBytes = this->width() * GrBytesPerPixel(this->config());
+    SkASSERT(rowBytes >= tightRowBytes);
+
+    if (0 != fFence) {
+        bool signaled = this->getGpuGL()->waitFence(fFence);
+        this->deleteFence();
+        if (!signaled) {
+            return false;
+        }
+    }
+
+    const size_t size = fRowBytes * this->height();
+    const void* mapped;
+    this->bind(fBufferID);
+    if (GrGLCaps::kMapBufferRange_MapBufferType == this->getGpuGL()->glCaps().mapBufferType()) {
+        GL_CALL_RET(mapped, MapBufferRange(GR_GL_PIXEL_PACK_BUFFER, 0, size, GR_GL_MAP_READ_BIT));
+    } else {
+        GL_CALL_RET(mapped, MapBuffer(GR_GL_PIXEL_PACK_BUFFER, GR_GL_READ_ONLY));
+    }
+    if (NULL == mapped) {
+        this->bind(0);
+        return false;
+    }
+
+    // GL's rows run bottom to top unless the target's origin is top left.
+    const char* src = reinterpret_cast<const char*>(mapped);
+    char* dst = reinterpret_cast<char*>(buffer);
+    if (fFlipY) {
+        dst += (this->height() - 1) * rowBytes;
+    }
+    for (int y = 0; y < this->height(); ++y) {
+        memcpy(dst, src, tightRowBytes);
+        src += fRowBytes;
+        if (fFlipY) {
+            dst -= rowBytes;
+        } else {
+            dst += rowBytes;
+        }
+    }
+
+    GrGLboolean unmapped;
+    GL_CALL_RET(unmapped, UnmapBuffer(GR_GL_PIXEL_PACK_BUFFER));
+    this->bind(0);
+    // The data store can be lost while mapped, e.g. when the screen mode changes.
+    return GR_GL_TRUE == unmapped;
+}
+
+void GrGLPixelReadback::deleteFence() {
+    if (0 != fFence) {
+        this->getGpuGL()->deleteFence(fFence);
+        fFence = 0;
+    }
+}
+
+void GrGLPixelReadback::onRelease() {
+    if (!this->wasDestroyed() && 0 != fBufferID) {
+        this->deleteFence();
+        GL_CALL(DeleteBuffers(1, &fBufferID));
+    }
+    fBufferID = 0;
+    fFence = 0;
+    INHERITED::onRelease();
+}
+
+void GrGLPixelReadback::onAbandon() {
+    fBufferID = 0;
+    fFence = 0;
+    INHERITED::onAbandon();
+}
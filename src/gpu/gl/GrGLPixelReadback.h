@@ -0,0 +1,59 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrGLPixelReadback_DEFINED
+#define GrGLPixelReadback_DEFINED
+
+#include "GrPixelReadback.h"
+#include "gl/GrGLFunctions.h"
+
+class GrGLIRect;
+class GrGpuGL;
+
+/**
+ * Reads pixels into a pixel pack buffer, so that glReadPixels returns without waiting for the
+ * GPU, and fences the read. The buffer is mapped and copied out once the fence has signaled.
+ * Requires GrGLCaps::pixelBufferSupport(), fenceSyncSupport() and a map buffer type that can
+ * map for reading.
+ */
+class GrGLPixelReadback : public GrPixelReadback {
+public:
+    /**
+     * Creates the buffer. Check isValid() before use, the buffer may have failed to allocate.
+     * flipY says that GL will return the rows bottom to top.
+     */
+    GrGLPixelReadback(GrGpuGL*, int width, int height, GrPixelConfig, bool flipY);
+    virtual ~GrGLPixelReadback();
+
+    bool isValid() const { return 0 != fBufferID; }
+
+    /**
+     * Reads readRect, relative to the bound read framebuffer, into the buffer and fences it.
+     */
+    void issue(const GrGLIRect& readRect, GrGLenum format, GrGLenum type);
+
+    virtual bool isReady() SK_OVERRIDE;
+    virtual bool readPixels(void* buffer, size_t rowBytes) SK_OVERRIDE;
+
+protected:
+    virtual void onRelease() SK_OVERRIDE;
+    virtual void onAbandon() SK_OVERRIDE;
+
+private:
+    GrGpuGL* getGpuGL() const { return (GrGpuGL*)this->getGpu(); }
+    void bind(GrGLuint id) const;
+    void deleteFence();
+
+    GrGLuint    fBufferID;
+    size_t      fRowBytes;      // GL's, each row padded to the default pack alignment of 4
+    bool        fFlipY;
+    GrFence     fFence;
+
+    typedef GrPixelReadback INHERITED;
+};
+
+#endif
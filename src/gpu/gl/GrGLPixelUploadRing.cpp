@@ -0,0 +1,169 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrGLPixelUploadRing.h"
+#include "GrGpuGL.h"
+
+#define GL_CALL(X) GR_GL_CALL(this->getGpuGL()->glInterface(), X)
+#define GL_CALL_RET(RET, X) GR_GL_CALL_RET(this->getGpuGL()->glInterface(), RET, X)
+
+GrGLPixelUploadRing::GrGLPixelUploadRing(GrGpuGL* gpu, size_t size)
+    : INHERITED(gpu, false)
+    , fBufferID(0)
+    , fSize(size)
+    , fPersistentMapPtr(NULL)
+    , fMapped(false)
+    , fAllocated(0)
+    , fReleased(0) {
+    SkASSERT(gpu->glCaps().pixelBufferSupport());
+    SkASSERT(gpu->caps()->streamingBufferSupport());
+
+    GL_CALL(GenBuffers(1, &fBufferID));
+    if (0 == fBufferID) {
+        return;
+    }
+    this->bind(fBufferID);
+    // The ring is made once, so always check that the driver could allocate it.
+    GrGLClearErr(gpu->glInterface());
+    bool persistent = gpu->glCaps().bufferStorageSupport();
+    if (persistent) {
+        GR_GL_CALL_NOERRCHECK(gpu->glInterface(),
+                              BufferStorage(GR_GL_PIXEL_UNPACK_BUFFER,
+                                            (GrGLsizeiptr) fSize,
+                                            NULL,  // data ptr
+                                            GR_GL_MAP_WRITE_BIT |
+                                            GR_GL_MAP_PERSISTENT_BIT |
+                                            GR_GL_MAP_COHERENT_BIT));
+    } else {
+        GR_GL_CALL_NOERRCHECK(gpu->glInterface(),
+                              BufferData(GR_GL_PIXEL_UNPACK_BUFFER,
+                                         (GrGLsizeiptr) fSize,
+                                         NULL,  // data ptr
+                                         GR_GL_STREAM_DRAW));
+    }
+    if (GR_GL_GET_ERROR(gpu->glInterface()) != GR_GL_NO_ERROR) {
+        this->bind(0);
+        GL_CALL(DeleteBuffers(1, &fBufferID));
+        fBufferID = 0;
+        return;
+    }
+    if (persistent) {
+        GL_CALL_RET(fPersistentMapPtr,
+                    MapBufferRange(GR_GL_PIXEL_UNPACK_BUFFER, 0, fSize,
+                                   GR_GL_MAP_WRITE_BIT |
+                                   GR_GL_MAP_PERSISTENT_BIT |
+                                   GR_GL_MAP_COHERENT_BIT));
+        if (NULL == fPersistentMapPtr) {
+            this->bind(0);
+            GL_CALL(DeleteBuffers(1, &fBufferID));
+            fBufferID = 0;
+            return;
+        }
+    }
+    this->bind(0);
+}
+
+GrGLPixelUploadRing::~GrGLPixelUploadRing() {
+    this->release();
+}
+
+void GrGLPixelUploadRing::bind(GrGLuint id) const {
+    GL_CALL(BindBuffer(GR_GL_PIXEL_UNPACK_BUFFER, id));
+}
+
+void* GrGLPixelUploadRing::map(size_t size, size_t alignment, size_t* offset) {
+    SkASSERT(this->isValid());
+    SkASSERT(!fMapped);
+    SkASSERT(NULL != offset);
+
+    if (this->wasDestroyed() || 0 == size || size > fSize) {
+        return NULL;
+    }
+
+    size_t head = static_cast<size_t>(fAllocated % fSize);
+    size_t skip = GrSizeAlignUpPad(head, alignment);
+    if (head + skip + size > fSize) {
+        // doesn't fit before the end of the ring so start again at the beginning
+        skip = fSize - head;
+    }
+
+    // Wait for the GPU to finish earlier uploads until there is room.
+    while (fSize - (fAllocated - fReleased) < skip + size) {
+        if (fFences.isEmpty() || !this->getGpuGL()->waitFence(fFences[0].fFence)) {
+            return NULL;
+        }
+        fReleased = fFences[0].fAllocated;
+        this->getGpuGL()->deleteFence(fFences[0].fFence);
+        fFences.remove(0);
+    }
+
+    *offset = static_cast<size_t>((fAllocated + skip) % fSize);
+
+    void* ptr;
+    this->bind(fBufferID);
+    if (NULL != fPersistentMapPtr) {
+        ptr = reinterpret_cast<char*>(fPersistentMapPtr) + *offset;
+    } else {
+        // The range is known to be free of pending uploads so there is nothing to sync with.
+        GL_CALL_RET(ptr, MapBufferRange(GR_GL_PIXEL_UNPACK_BUFFER, *offset, size,
+                                        GR_GL_MAP_WRITE_BIT |
+                                        GR_GL_MAP_INVALIDATE_RANGE_BIT |
+                                        GR_GL_MAP_UNSYNCHRONIZED_BIT));
+        if (NULL == ptr) {
+            this->bind(0);
+            return NULL;
+        }
+    }
+    fAllocated += skip + size;
+    fMapped = true;
+    return ptr;
+}
+
+void GrGLPixelUploadRing::unmap() {
+    SkASSERT(fMapped);
+    if (NULL == fPersistentMapPtr) {
+        GL_CALL(UnmapBuffer(GR_GL_PIXEL_UNPACK_BUFFER));
+    }
+    fMapped = false;
+}
+
+void GrGLPixelUploadRing::endUpload() {
+    SkASSERT(!fMapped);
+    this->bind(0);
+    // If we fail to get a fence the space is covered by the next one instead.
+    GrFence fence = this->getGpuGL()->insertFence();
+    if (0 != fence) {
+        UploadFence* uploadFence = fFences.append();
+        uploadFence->fFence = fence;
+        uploadFence->fAllocated = fAllocated;
+    }
+}
+
+void GrGLPixelUploadRing::deleteFences() {
+    for (int i = 0; i < fFences.count(); ++i) {
+        this->getGpuGL()->deleteFence(fFences[i].fFence);
+    }
+    fFences.reset();
+}
+
+void GrGLPixelUploadRing::onRelease() {
+    if (!this->wasDestroyed() && 0 != fBufferID) {
+        this->deleteFences();
+        // Deleting the buffer also unmaps it.
+        GL_CALL(DeleteBuffers(1, &fBufferID));
+    }
+    fBufferID = 0;
+    fPersistentMapPtr = NULL;
+    INHERITED::onRelease();
+}
+
+void GrGLPixelUploadRing::onAbandon() {
+    fFences.reset();
+    fBufferID = 0;
+    fPersistentMapPtr = NULL;
+    INHERITED::onAbandon();
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrGLPixelUploadRing_DEFINED
+#define GrGLPixelUploadRing_DEFINED
+
+#include "GrGpuObject.h"
+#include "gl/GrGLFunctions.h"
+#include "SkTDArray.h"
+
+class GrGpuGL;
+
+/**
+ * A pixel unpack buffer that texture uploads are staged through. Each upload copies its pixels
+ * into the next free range of the ring and sources glTex(Sub)Image2D from there, so the driver
+ * can return without copying the client's memory and transfer the data to the texture
+ * asynchronously. A fence follows every upload, and the ring only waits on the GPU when it wraps
+ * around onto a range whose upload has yet to complete.
+ *
+ * Usage is map(), write the pixels, unmap(), issue the GL texture call(s) with the returned offset
+ * as the data pointer, then endUpload(). The buffer stays bound to GL_PIXEL_UNPACK_BUFFER from
+ * map() until endUpload().
+ */
+class GrGLPixelUploadRing : public GrGpuObject {
+public:
+    /**
+     * Creates the ring's buffer. Check isValid() before use, the buffer may have failed to
+     * allocate. Requires GrGLCaps::pixelBufferSupport() and GrDrawTargetCaps::
+     * streamingBufferSupport().
+     */
+    GrGLPixelUploadRing(GrGpuGL*, size_t size);
+    virtual ~GrGLPixelUploadRing();
+
+    bool isValid() const { return 0 != fBufferID; }
+
+    /**
+     * Reserves size bytes starting at an offset that is a multiple of alignment. Returns a pointer
+     * to write the data to and the offset to pass to GL in place of a client pointer, or NULL if
+     * the space can't be had (e.g. the request is larger than the ring). On failure nothing is
+     * left bound.
+     */
+    void* map(size_t size, size_t alignment, size_t* offset);
+    void unmap();
+    void endUpload();
+
+    virtual size_t gpuMemorySize() const SK_OVERRIDE { return fSize; }
+
+protected:
+    virtual void onRelease() SK_OVERRIDE;
+    virtual void onAbandon() SK_OVERRIDE;
+
+private:
+    struct UploadFence {
+        GrFence             fFence;
+        uint64_t            fAllocated;     // ring space the GPU is done with once signaled
+    };
+
+    GrGpuGL* getGpuGL() const { return (GrGpuGL*)this->getGpu(); }
+    void bind(GrGLuint id) const;
+    void deleteFences();
+
+    GrGLuint                fBufferID;
+    size_t                  fSize;
+    void*                   fPersistentMapPtr;  // non-NULL when the buffer stays mapped
+    bool                    fMapped;
+    // These only ever increase, and include space skipped at the end of the ring when an upload
+    // wraps around.
+    uint64_t                fAllocated;
+    uint64_t                fReleased;
+    SkTDArray<UploadFence>  fFences;
+
+    typedef GrGpuObject INHERITED;
+};
+
+#endif
@@ -368,7 +368,7 @@ void GrGLVertexProgramEffects::emitTransforms(GrGLFullShaderBuilder* builder,
         builder->addVarying(varyingType, varyingName, &vsVaryingName, &fsVaryingName);
 
         const GrGLShaderVar& coords = kPosition_GrCoordSet == get_source_coords(totalKey, t) ?
-                                          builder->positionAttribute() :
+                                          builder->position() :
                                           builder->localCoordsAttribute();
         // varying = matrix * coords (logically)
         switch (transforms[t].fType) {
@@ -8,10 +8,12 @@
 #include "gl/GrGLShaderBuilder.h"
 #include "gl/GrGLProgram.h"
 #include "gl/GrGLUniformHandle.h"
+#include "GrContext.h"
 #include "GrCoordTransform.h"
 #include "GrDrawEffect.h"
 #include "GrGpuGL.h"
 #include "GrTexture.h"
+#include "SkData.h"
 #include "SkRTConf.h"
 #include "SkTraceEvent.h"
 
@@ -657,16 +659,130 @@ const char* GrGLShaderBuilder::enableSecondaryOutput() {
     return dual_source_output_name();
 }
 
+// Prints the source and info log of any of the shaders that failed to compile.
+static void print_shader_logs(const GrGLInterface* gli,
+                              const SkTDArray<GrGLuint>& shaderIds,
+                              const SkTArray<SkString>& shaderSrcs) {
+    SkASSERT(shaderIds.count() == shaderSrcs.count());
+    for (int i = 0; i < shaderIds.count(); ++i) {
+        GrGLint compiled = GR_GL_INIT_ZERO;
+        GR_GL_CALL(gli, GetShaderiv(shaderIds[i], GR_GL_COMPILE_STATUS, &compiled));
+        if (compiled) {
+            continue;
+        }
+        GrGLint infoLen = GR_GL_INIT_ZERO;
+        GR_GL_CALL(gli, GetShaderiv(shaderIds[i], GR_GL_INFO_LOG_LENGTH, &infoLen));
+        SkAutoMalloc log(sizeof(char)*(infoLen+1)); // outside if for debugger
+        if (infoLen > 0) {
+            // retrieve length even though we don't need it to workaround bug in Chromium cmd
+            // buffer param validation.
+            GrGLsizei length = GR_GL_INIT_ZERO;
+            GR_GL_CALL(gli, GetShaderInfoLog(shaderIds[i], infoLen+1,
+                                             &length, (char*)log.get()));
+            GrPrintf(shaderSrcs[i].c_str());
+            GrPrintf("\n%s", log.get());
+        }
+    }
+}
+
+// The generated shader code is a function of the program descriptor. The driver strings make
+// sure a binary is only handed back to the driver that produced it.
+static SkData* create_program_binary_key(const GrGLInterface* gli, const GrGLProgramDesc& desc) {
+    static const GrGLenum kStrings[] = { GR_GL_VENDOR, GR_GL_RENDERER, GR_GL_VERSION };
+    SkString driver;
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kStrings); ++i) {
+        const GrGLubyte* str;
+        GR_GL_CALL_RET(gli, str, GetString(kStrings[i]));
+        if (NULL != str) {
+            driver.append(reinterpret_cast<const char*>(str));
+        }
+        driver.append("\n");
+    }
+    size_t size = driver.size() + desc.keyLength();
+    char* key = static_cast<char*>(sk_malloc_throw(size));
+    memcpy(key, driver.c_str(), driver.size());
+    memcpy(key + driver.size(), desc.asKey(), desc.keyLength());
+    return SkData::NewFromMalloc(key, size);
+}
+
+// A stored binary is its GL binary format followed by the bytes from glGetProgramBinary.
+// Returns a linked program or 0 if the driver rejected the binary.
+static GrGLuint load_program_binary(const GrGLInterface* gli, const SkData& binary) {
+    if (binary.size() <= sizeof(GrGLenum)) {
+        return 0;
+    }
+    GrGLenum format;
+    memcpy(&format, binary.data(), sizeof(GrGLenum));
+
+    GrGLuint programID;
+    GR_GL_CALL_RET(gli, programID, CreateProgram());
+    if (0 == programID) {
+        return 0;
+    }
+    GR_GL_CALL(gli, ProgramBinary(programID, format, binary.bytes() + sizeof(GrGLenum),
+                                  static_cast<GrGLsizei>(binary.size() - sizeof(GrGLenum))));
+    // Drivers reject binaries from other versions, so this is checked even in release builds.
+    GrGLint linked = GR_GL_INIT_ZERO;
+    GR_GL_CALL(gli, GetProgramiv(programID, GR_GL_LINK_STATUS, &linked));
+    if (!linked) {
+        GR_GL_CALL(gli, DeleteProgram(programID));
+        return 0;
+    }
+    return programID;
+}
+
+static void store_program_binary(const GrGLInterface* gli, GrGLuint programID,
+                                 GrContext::PersistentCache* cache, const SkData& key) {
+    GrGLint length = GR_GL_INIT_ZERO;
+    GR_GL_CALL(gli, GetProgramiv(programID, GR_GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0) {
+        return;
+    }
+    size_t size = sizeof(GrGLenum) + length;
+    char* binary = static_cast<char*>(sk_malloc_throw(size));
+    GrGLenum format = 0;
+    GrGLsizei written = 0;
+    GR_GL_CALL(gli, GetProgramBinary(programID, length, &written, &format,
+                                     binary + sizeof(GrGLenum)));
+    if (written <= 0) {
+        sk_free(binary);
+        return;
+    }
+    memcpy(binary, &format, sizeof(GrGLenum));
+    SkAutoTUnref<SkData> data(SkData::NewFromMalloc(binary, sizeof(GrGLenum) + written));
+    cache->store(key, *data);
+}
+
 bool GrGLShaderBuilder::finish() {
     SkASSERT(0 == fOutput.fProgramID);
+
+    // Uniform locations bound before linking are not restored along with a program binary.
+    GrContext::PersistentCache* cache = NULL;
+    SkAutoTUnref<SkData> binaryKey;
+    if (fGpu->glCaps().programBinarySupport() && !fUniformManager->isUsingBindUniform()) {
+        cache = fGpu->getContext()->getPersistentCache();
+    }
+    if (NULL != cache) {
+        binaryKey.reset(create_program_binary_key(fGpu->glInterface(), fDesc));
+        SkAutoTUnref<SkData> binary(cache->load(*binaryKey));
+        if (NULL != binary.get()) {
+            fOutput.fProgramID = load_program_binary(fGpu->glInterface(), *binary);
+            if (0 != fOutput.fProgramID) {
+                fUniformManager->getUniformLocations(fOutput.fProgramID, fUniforms);
+                return true;
+            }
+        }
+    }
+
     GL_CALL_RET(fOutput.fProgramID, CreateProgram());
     if (!fOutput.fProgramID) {
         return false;
     }
 
     SkTDArray<GrGLuint> shadersToDelete;
+    SkTArray<SkString> shaderSrcs;
 
-    if (!this->compileAndAttachShaders(fOutput.fProgramID, &shadersToDelete)) {
+    if (!this->compileAndAttachShaders(fOutput.fProgramID, &shadersToDelete, &shaderSrcs)) {
         GL_CALL(DeleteProgram(fOutput.fProgramID));
         return false;
     }
@@ -676,7 +792,14 @@ bool GrGLShaderBuilder::finish() {
         fUniformManager->getUniformLocations(fOutput.fProgramID, fUniforms);
     }
 
+    if (NULL != cache && NULL != fGpu->glInterface()->fFunctions.fProgramParameteri) {
+        GL_CALL(ProgramParameteri(fOutput.fProgramID, GR_GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                  GR_GL_TRUE));
+    }
     GL_CALL(LinkProgram(fOutput.fProgramID));
+    // TODO: With GL_KHR_parallel_shader_compile the link could run in the background, polled with
+    // GL_COMPLETION_STATUS_KHR, if draws had a program to fall back on until it is done. Until
+    // then, the status query below and the uniform lookups after it wait for the link.
 
     // Calling GetProgramiv is expensive in Chromium. Assume success in release builds.
     bool checkLinked = !fGpu->ctxInfo().isChromium();
@@ -687,6 +810,7 @@ bool GrGLShaderBuilder::finish() {
         GrGLint linked = GR_GL_INIT_ZERO;
         GL_CALL(GetProgramiv(fOutput.fProgramID, GR_GL_LINK_STATUS, &linked));
         if (!linked) {
+            print_shader_logs(fGpu->glInterface(), shadersToDelete, shaderSrcs);
             GrGLint infoLen = GR_GL_INIT_ZERO;
             GL_CALL(GetProgramiv(fOutput.fProgramID, GR_GL_INFO_LOG_LENGTH, &infoLen));
             SkAutoMalloc log(sizeof(char)*(infoLen+1));  // outside if for debugger
@@ -715,11 +839,18 @@ bool GrGLShaderBuilder::finish() {
       GL_CALL(DeleteShader(shadersToDelete[i]));
     }
 
+    if (NULL != cache) {
+        store_program_binary(fGpu->glInterface(), fOutput.fProgramID, cache, *binaryKey);
+    }
+
     return true;
 }
 
-// Compiles a GL shader and attaches it to a program. Returns the shader ID if
-// successful, or 0 if not.
+// Starts compiling a GL shader and attaches it to a program. Returns the shader ID if
+// successful, or 0 if not. The compile status is not queried here: that would wait for this
+// compile to finish before the next shader's could start. finish() still waits for the link, and
+// so for all of the program's shaders at once; compile errors are reported by print_shader_logs()
+// when linking fails.
 static GrGLuint attach_shader(const GrGLContext& glCtx,
                               GrGLuint programId,
                               GrGLenum type,
@@ -737,33 +868,6 @@ static GrGLuint attach_shader(const GrGLContext& glCtx,
     GR_GL_CALL(gli, ShaderSource(shaderId, 1, &sourceStr, &sourceLength));
     GR_GL_CALL(gli, CompileShader(shaderId));
 
-    // Calling GetShaderiv in Chromium is quite expensive. Assume success in release builds.
-    bool checkCompiled = !glCtx.isChromium();
-#ifdef SK_DEBUG
-    checkCompiled = true;
-#endif
-    if (checkCompiled) {
-        GrGLint compiled = GR_GL_INIT_ZERO;
-        GR_GL_CALL(gli, GetShaderiv(shaderId, GR_GL_COMPILE_STATUS, &compiled));
-
-        if (!compiled) {
-            GrGLint infoLen = GR_GL_INIT_ZERO;
-            GR_GL_CALL(gli, GetShaderiv(shaderId, GR_GL_INFO_LOG_LENGTH, &infoLen));
-            SkAutoMalloc log(sizeof(char)*(infoLen+1)); // outside if for debugger
-            if (infoLen > 0) {
-                // retrieve length even though we don't need it to workaround bug in Chromium cmd
-                // buffer param validation.
-                GrGLsizei length = GR_GL_INIT_ZERO;
-                GR_GL_CALL(gli, GetShaderInfoLog(shaderId, infoLen+1,
-                                                 &length, (char*)log.get()));
-                GrPrintf(shaderSrc.c_str());
-                GrPrintf("\n%s", log.get());
-            }
-            SkDEBUGFAIL("Shader compilation failed!");
-            GR_GL_CALL(gli, DeleteShader(shaderId));
-            return 0;
-        }
-    }
     if (c_PrintShaders) {
         GrPrintf(shaderSrc.c_str());
         GrPrintf("\n");
@@ -778,7 +882,9 @@ static GrGLuint attach_shader(const GrGLContext& glCtx,
     return shaderId;
 }
 
-bool GrGLShaderBuilder::compileAndAttachShaders(GrGLuint programId, SkTDArray<GrGLuint>* shaderIds) const {
+bool GrGLShaderBuilder::compileAndAttachShaders(GrGLuint programId,
+                                                SkTDArray<GrGLuint>* shaderIds,
+                                                SkTArray<SkString>* shaderSrcs) const {
     SkString fragShaderSrc(GrGetGLSLVersionDecl(this->ctxInfo()));
     fragShaderSrc.append(fFSExtensions);
     append_default_precision_qualifier(kDefaultFragmentPrecision,
@@ -800,6 +906,7 @@ bool GrGLShaderBuilder::compileAndAttachShaders(GrGLuint programId, SkTDArray<Gr
     }
 
     *shaderIds->append() = fragShaderId;
+    shaderSrcs->push_back(fragShaderSrc);
 
     return true;
 }
@@ -844,6 +951,7 @@ void GrGLFullShaderBuilder::emitCodeBeforeEffects(GrGLSLExpr4* color, GrGLSLExpr
     } else {
         fLocalCoordsVar = fPositionVar;
     }
+    fCurrPositionVar = fPositionVar;
 
     const char* viewMName;
     fOutput.fUniformHandles.fViewMatrixUni =
@@ -892,6 +1000,20 @@ void GrGLFullShaderBuilder::emitCodeAfterEffects() {
         rtAdjustName, rtAdjustName);
 }
 
+void GrGLFullShaderBuilder::setPosition(const char* position) {
+    if (fCurrPositionVar != &fPositionOverrideVar) {
+        // This is declared at global scope since effect code is enclosed in a block.
+        fPositionOverrideVar.set(kVec2f_GrSLType, GrGLShaderVar::kNone_TypeModifier, "");
+        this->nameVariable(fPositionOverrideVar.accessName(), '\0', "position");
+        fCurrPositionVar = &fPositionOverrideVar;
+    }
+
+    this->vsCodeAppendf("\t%s = %s;\n", fPositionOverrideVar.c_str(), position);
+    this->vsCodeAppendf("\tpos3 = %s * vec3(%s, 1);\n",
+                        this->getUniformCStr(fOutput.fUniformHandles.fViewMatrixUni),
+                        fPositionOverrideVar.c_str());
+}
+
 bool GrGLFullShaderBuilder::addAttribute(GrSLType type, const char* name) {
     for (int i = 0; i < fVSAttrs.count(); ++i) {
         const GrGLShaderVar& attr = fVSAttrs[i];
@@ -984,12 +1106,17 @@ GrGLProgramEffects* GrGLFullShaderBuilder::createAndEmitEffects(
 }
 
 bool GrGLFullShaderBuilder::compileAndAttachShaders(GrGLuint programId,
-                                                    SkTDArray<GrGLuint>* shaderIds) const {
+                                                    SkTDArray<GrGLuint>* shaderIds,
+                                                    SkTArray<SkString>* shaderSrcs) const {
     const GrGLContext& glCtx = this->gpu()->glContext();
     SkString vertShaderSrc(GrGetGLSLVersionDecl(this->ctxInfo()));
     this->appendUniformDecls(kVertex_Visibility, &vertShaderSrc);
     this->appendDecls(fVSAttrs, &vertShaderSrc);
     this->appendDecls(fVSOutputs, &vertShaderSrc);
+    if (fCurrPositionVar == &fPositionOverrideVar) {
+        fPositionOverrideVar.appendDecl(this->ctxInfo(), &vertShaderSrc);
+        vertShaderSrc.append(";\n");
+    }
     vertShaderSrc.append("void main() {\n");
     vertShaderSrc.append(fVSCode);
     vertShaderSrc.append("}\n");
@@ -998,6 +1125,7 @@ bool GrGLFullShaderBuilder::compileAndAttachShaders(GrGLuint programId,
         return false;
     }
     *shaderIds->append() = vertShaderId;
+    shaderSrcs->push_back(vertShaderSrc);
 
 #if GR_GL_EXPERIMENTAL_GS
     if (this->desc().getHeader().fExperimentalGS) {
@@ -1028,10 +1156,11 @@ bool GrGLFullShaderBuilder::compileAndAttachShaders(GrGLuint programId,
             return false;
         }
         *shaderIds->append() = geomShaderId;
+        shaderSrcs->push_back(geomShaderSrc);
     }
 #endif
 
-    return this->INHERITED::compileAndAttachShaders(programId, shaderIds);
+    return this->INHERITED::compileAndAttachShaders(programId, shaderIds, shaderSrcs);
 }
 
 void GrGLFullShaderBuilder::bindProgramLocations(GrGLuint programId) const {
@@ -262,7 +262,10 @@ protected:
     // generating stage code.
     void nameVariable(SkString* out, char prefix, const char* name);
 
-    virtual bool compileAndAttachShaders(GrGLuint programId, SkTDArray<GrGLuint>* shaderIds) const;
+    // Appends the ID and source of each shader it attaches to shaderIds and shaderSrcs.
+    virtual bool compileAndAttachShaders(GrGLuint programId,
+                                         SkTDArray<GrGLuint>* shaderIds,
+                                         SkTArray<SkString>* shaderSrcs) const;
 
     virtual void bindProgramLocations(GrGLuint programId) const;
 
@@ -448,6 +451,18 @@ public:
       */
     const GrGLShaderVar& positionAttribute() const { return *fPositionVar; }
 
+    /** Returns the variable that holds the pre-matrix vertex position in the VS. This is
+        positionAttribute() unless a vertex effect has called setPosition().
+      */
+    const GrGLShaderVar& position() const { return *fCurrPositionVar; }
+
+    /** Lets a vertex effect compute the pre-matrix vertex position itself, e.g. from per-instance
+        attributes. The position is transformed by the view matrix in place of positionAttribute()
+        and position() refers to it from here on, so effects emitted later compute their position
+        based coords from it. Effects emitted earlier still see positionAttribute().
+      */
+    void setPosition(const char* position);
+
     /** Returns a vertex attribute that represents the local coords in the VS. This may be the same
         as positionAttribute() or it may not be. It depends upon whether the rendering code
         specified explicit local coords or not in the GrDrawState. */
@@ -472,7 +487,8 @@ private:
     virtual void emitCodeAfterEffects() SK_OVERRIDE;
 
     virtual bool compileAndAttachShaders(GrGLuint programId,
-                                         SkTDArray<GrGLuint>* shaderIds) const SK_OVERRIDE;
+                                         SkTDArray<GrGLuint>* shaderIds,
+                                         SkTArray<SkString>* shaderSrcs) const SK_OVERRIDE;
 
     virtual void bindProgramLocations(GrGLuint programId) const SK_OVERRIDE;
 
@@ -494,6 +510,8 @@ private:
 
     GrGLShaderVar*                      fPositionVar;
     GrGLShaderVar*                      fLocalCoordsVar;
+    GrGLShaderVar*                      fCurrPositionVar;
+    GrGLShaderVar                       fPositionOverrideVar;
 
     typedef GrGLShaderBuilder INHERITED;
 };
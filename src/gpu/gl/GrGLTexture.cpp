@@ -50,11 +50,27 @@ GrGLTexture::GrGLTexture(GrGpuGL* gpu,
 
 void GrGLTexture::onRelease() {
     GPUGL->notifyTextureDelete(this);
+    if (this->isSetFlag((GrTextureFlags) kSharedContent_FlagBit) && NULL != fTexIDObj.get()) {
+        // The group owns the texture. The last context to let go of it deletes it.
+        GrFence fence = 0;
+        if (GPUGL->getShareGroup()->unrefTexture(this->getTextureHandle(), &fence)) {
+            GrGLuint textureID = fTexIDObj->id();
+            GL_CALL(DeleteTextures(1, &textureID));
+            if (0 != fence) {
+                GPUGL->deleteFence(fence);
+            }
+        }
+        fTexIDObj->abandon();
+    }
     fTexIDObj.reset(NULL);
     INHERITED::onRelease();
 }
 
 void GrGLTexture::onAbandon() {
+    if (this->isSetFlag((GrTextureFlags) kSharedContent_FlagBit) && NULL != fTexIDObj.get()) {
+        GrFence fence;
+        GPUGL->getShareGroup()->unrefTexture(this->getTextureHandle(), &fence);
+    }
     if (NULL != fTexIDObj.get()) {
         fTexIDObj->abandon();
         fTexIDObj.reset(NULL);
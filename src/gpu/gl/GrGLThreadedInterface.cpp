@@ -0,0 +1,1817 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "gl/GrGLInterface.h"
+#include "GrGLDefines.h"
+#include "SkCondVar.h"
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+#include "SkThreadUtils.h"
+#include "SkTLS.h"
+
+/**
+ * GrGLCreateThreadedInterface() returns an interface whose functions record the GL calls into
+ * command lists instead of making them. The lists are submitted to a thread that owns the real
+ * GL context and plays them back through the real interface, so the thread using the GrContext
+ * can generate the next frame while GL works through the previous one.
+ *
+ * Calls that return something, or that write through a pointer, wait for the submission thread to
+ * catch up (e.g. GetError, GetIntegerv, ReadPixels). Data that a call reads through a pointer is
+ * copied into the command list. Names are generated in batches so that creating a resource doesn't
+ * usually have to wait. Mapped buffers are backed by client memory that is uploaded when the
+ * buffer is unmapped.
+ *
+ * The stubs can't tell which interface they were called through, so each thread has a current
+ * recorder: the one the last threaded interface created on that thread made.
+ */
+
+namespace { // added to suppress 'no previous prototype' warning
+
+typedef void (*ExecProc)(const GrGLInterface* gl, const void* cmd);
+
+/**
+ * A list of recorded GL calls. Each record is a header followed by the call's command struct and
+ * the data copied for it, each 8 byte aligned.
+ */
+class CommandList : SkNoncopyable {
+public:
+    void* append(ExecProc exec, size_t size) {
+        SkASSERT(SkIsAlign8(size));
+        size_t recordSize = kHeaderSize + size;
+        Header* header = reinterpret_cast<Header*>(fData.append(SkToInt(recordSize)));
+        header->fExec = exec;
+        header->fSize = SkToU32(recordSize);
+        return reinterpret_cast<char*>(header) + kHeaderSize;
+    }
+
+    void execute(const GrGLInterface* gl) const {
+        const char* record = fData.begin();
+        while (record < fData.end()) {
+            const Header* header = reinterpret_cast<const Header*>(record);
+            header->fExec(gl, record + kHeaderSize);
+            record += header->fSize;
+        }
+    }
+
+    void reset() { fData.rewind(); }
+
+    size_t bytes() const { return fData.count(); }
+
+private:
+    struct Header {
+        ExecProc    fExec;
+        uint32_t    fSize;  // including the header
+    };
+    static const size_t kHeaderSize = SkAlign8(sizeof(Header));
+
+    SkTDArray<char> fData;
+};
+
+template <typename T> char* payload(T* cmd) {
+    return reinterpret_cast<char*>(cmd) + SkAlign8(sizeof(T));
+}
+
+template <typename T> const char* payload(const T* cmd) {
+    return reinterpret_cast<const char*>(cmd) + SkAlign8(sizeof(T));
+}
+
+enum NameKind {
+    kBuffer_NameKind,
+    kFramebuffer_NameKind,
+    kQuery_NameKind,
+    kRenderbuffer_NameKind,
+    kTexture_NameKind,
+    kVertexArray_NameKind,
+
+    kNameKindCnt
+};
+
+// All of the Gen* and Delete* functions share these signatures.
+typedef GrGLGenBuffersProc GenNamesProc;
+typedef GrGLDeleteBuffersProc DeleteNamesProc;
+
+struct GenNamesCmd {
+    GenNamesProc    fProc;
+    GrGLsizei       fN;
+    GrGLuint*       fNames;
+    static void Exec(const GrGLInterface*, const void* cmd) {
+        const GenNamesCmd* c = static_cast<const GenNamesCmd*>(cmd);
+        c->fProc(c->fN, c->fNames);
+    }
+};
+
+struct DeleteNamesCmd {
+    DeleteNamesProc fProc;
+    GrGLsizei       fN;
+    static void Exec(const GrGLInterface*, const void* cmd) {
+        const DeleteNamesCmd* c = static_cast<const DeleteNamesCmd*>(cmd);
+        c->fProc(c->fN, reinterpret_cast<const GrGLuint*>(payload(c)));
+    }
+};
+
+struct SubmitProcCmd {
+    GrGLSubmitProc  fProc;
+    void*           fData;
+    static void Exec(const GrGLInterface*, const void* cmd) {
+        const SubmitProcCmd* c = static_cast<const SubmitProcCmd*>(cmd);
+        c->fProc(c->fData);
+    }
+};
+
+class Recorder;
+
+struct CurrentRecorder {
+    Recorder* fRecorder;
+};
+
+void* create_current_recorder() {
+    CurrentRecorder* current = SkNEW(CurrentRecorder);
+    current->fRecorder = NULL;
+    return current;
+}
+
+void delete_current_recorder(void* current) {
+    SkDELETE(static_cast<CurrentRecorder*>(current));
+}
+
+/**
+ * Records the calls made through the threaded interface and runs the submission thread.
+ */
+class Recorder : SkNoncopyable {
+public:
+    /** A client memory mapping of a buffer or a texture rect, uploaded at unmap. */
+    struct Mapping {
+        enum Kind {
+            kBuffer_Kind,           // MapBuffer or MapBufferRange
+            kBufferSubData_Kind,    // MapBufferSubData
+            kTexSubImage_Kind,      // MapTexSubImage2D
+        };
+        Kind        fKind;
+        void*       fMem;
+        GrGLenum    fTarget;
+        GrGLintptr  fOffset;
+        GrGLsizeiptr fSize;
+        // for kTexSubImage_Kind
+        GrGLint     fLevel;
+        GrGLint     fX;
+        GrGLint     fY;
+        GrGLsizei   fWidth;
+        GrGLsizei   fHeight;
+        GrGLenum    fFormat;
+        GrGLenum    fType;
+    };
+
+    Recorder(const GrGLInterface* gl, GrGLSubmitProc makeCurrent, void* makeCurrentData)
+        : fUnpackAlignment(4)
+        , fUnpackRowLength(0)
+        , fUnpackBuffer(0)
+        , fGL(SkRef(gl))
+        , fMakeCurrent(makeCurrent)
+        , fMakeCurrentData(makeCurrentData)
+        , fThread(ThreadMain, this)
+        , fStarted(false)
+        , fQuit(false) {
+        fCurrent = SkNEW(CommandList);
+
+        const GrGLInterface::Functions& functions = gl->fFunctions;
+        fNamePools[kBuffer_NameKind].set(functions.fGenBuffers, functions.fDeleteBuffers);
+        fNamePools[kFramebuffer_NameKind].set(functions.fGenFramebuffers,
+                                              functions.fDeleteFramebuffers);
+        fNamePools[kQuery_NameKind].set(functions.fGenQueries, functions.fDeleteQueries);
+        fNamePools[kRenderbuffer_NameKind].set(functions.fGenRenderbuffers,
+                                               functions.fDeleteRenderbuffers);
+        fNamePools[kTexture_NameKind].set(functions.fGenTextures, functions.fDeleteTextures);
+        fNamePools[kVertexArray_NameKind].set(functions.fGenVertexArrays,
+                                              functions.fDeleteVertexArrays);
+
+        CurrentRecorder* current = static_cast<CurrentRecorder*>(
+            SkTLS::Get(create_current_recorder, delete_current_recorder));
+        current->fRecorder = this;
+    }
+
+    ~Recorder() {
+        if (fStarted) {
+            // Give back the names we generated but never handed out.
+            for (int i = 0; i < kNameKindCnt; ++i) {
+                NamePool& pool = fNamePools[i];
+                if (pool.fNames.count() > 0) {
+                    this->deleteNames(pool.fDelete, pool.fNames.count(), pool.fNames.begin());
+                }
+            }
+            this->finish();
+
+            fCondVar.lock();
+            fQuit = true;
+            fCondVar.broadcast();
+            fCondVar.unlock();
+            fThread.join();
+        }
+
+        for (int i = 0; i < fMappings.count(); ++i) {
+            sk_free(fMappings[i].fMem);
+        }
+        SkDELETE(fCurrent);
+        fFreeLists.deleteAll();
+        SkASSERT(0 == fQueue.count());
+
+        CurrentRecorder* current = static_cast<CurrentRecorder*>(
+            SkTLS::Find(create_current_recorder));
+        if (NULL != current && this == current->fRecorder) {
+            current->fRecorder = NULL;
+        }
+        fGL->unref();
+    }
+
+    bool start() {
+        fStarted = fThread.start();
+        return fStarted;
+    }
+
+    static Recorder* Current() {
+        CurrentRecorder* current = static_cast<CurrentRecorder*>(
+            SkTLS::Find(create_current_recorder));
+        SkASSERT(NULL != current && NULL != current->fRecorder);
+        return current->fRecorder;
+    }
+
+    const GrGLInterface* gl() const { return fGL; }
+
+    /**
+     * Appends a command to the current list and returns it for the caller to fill in, followed by
+     * payloadSize bytes of space for the data it copies.
+     */
+    template <typename T> T* record(size_t payloadSize = 0) {
+        if (fCurrent->bytes() >= kMaxListBytes) {
+            this->submit();
+        }
+        return static_cast<T*>(fCurrent->append(T::Exec,
+                                                SkAlign8(sizeof(T)) + SkAlign8(payloadSize)));
+    }
+
+    /** Hands the current list to the submission thread. Blocks if it is too far behind. */
+    void submit() {
+        if (0 == fCurrent->bytes()) {
+            return;
+        }
+        CommandList* next = NULL;
+        fCondVar.lock();
+        while (fQueue.count() >= kMaxQueuedLists) {
+            fCondVar.wait();
+        }
+        *fQueue.append() = fCurrent;
+        if (fFreeLists.count() > 0) {
+            fFreeLists.pop(&next);
+        }
+        fCondVar.broadcast();
+        fCondVar.unlock();
+        fCurrent = NULL != next ? next : SkNEW(CommandList);
+    }
+
+    /** Submits the current list and waits for everything recorded so far to execute. */
+    void finish() {
+        this->submit();
+        fCondVar.lock();
+        while (fQueue.count() > 0) {
+            fCondVar.wait();
+        }
+        fCondVar.unlock();
+    }
+
+    void submitProc(GrGLSubmitProc proc, void* data) {
+        SubmitProcCmd* c = this->record<SubmitProcCmd>();
+        c->fProc = proc;
+        c->fData = data;
+        this->submit();
+    }
+
+    void genNames(NameKind kind, GrGLsizei n, GrGLuint* names) {
+        NamePool& pool = fNamePools[kind];
+        SkASSERT(NULL != pool.fGen);
+        if (pool.fNames.count() < n) {
+            GrGLsizei genCnt = SkTMax<GrGLsizei>(n, kNameBatchSize);
+            GenNamesCmd* c = this->record<GenNamesCmd>();
+            c->fProc = pool.fGen;
+            c->fN = genCnt;
+            c->fNames = pool.fNames.append(genCnt);
+            this->finish();
+        }
+        int remaining = pool.fNames.count() - n;
+        memcpy(names, pool.fNames.begin() + remaining, n * sizeof(GrGLuint));
+        pool.fNames.setCount(remaining);
+    }
+
+    void deleteNames(DeleteNamesProc proc, GrGLsizei n, const GrGLuint* names) {
+        DeleteNamesCmd* c = this->record<DeleteNamesCmd>(n * sizeof(GrGLuint));
+        c->fProc = proc;
+        c->fN = n;
+        memcpy(payload(c), names, n * sizeof(GrGLuint));
+    }
+
+    void addMapping(const Mapping& mapping) { *fMappings.append() = mapping; }
+
+    /**
+     * Finds and forgets the mapping of a buffer target (mem is NULL) or of a memory block. Returns
+     * false if there is none.
+     */
+    bool removeMapping(Mapping::Kind kind, GrGLenum target, const void* mem, Mapping* mapping) {
+        for (int i = 0; i < fMappings.count(); ++i) {
+            const Mapping& m = fMappings[i];
+            if (m.fKind == kind && (NULL != mem ? m.fMem == mem : m.fTarget == target)) {
+                *mapping = m;
+                fMappings.removeShuffle(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Unpack state that the size of the client data passed to TexImage2D etc. depends on.
+    GrGLint     fUnpackAlignment;
+    GrGLint     fUnpackRowLength;
+    GrGLuint    fUnpackBuffer;
+
+private:
+    // Most of a frame's calls should fit in one list. Larger lists are submitted early to keep
+    // the submission thread busy.
+    static const size_t kMaxListBytes = 1 << 20;
+    // The number of lists the recording thread can be ahead of the submission thread.
+    static const int kMaxQueuedLists = 2;
+    static const GrGLsizei kNameBatchSize = 32;
+
+    struct NamePool {
+        NamePool() : fGen(NULL), fDelete(NULL) {}
+        void set(GenNamesProc gen, DeleteNamesProc del) {
+            fGen = gen;
+            fDelete = del;
+        }
+        GenNamesProc        fGen;
+        DeleteNamesProc     fDelete;
+        SkTDArray<GrGLuint> fNames;
+    };
+
+    static void ThreadMain(void* recorder) {
+        static_cast<Recorder*>(recorder)->run();
+    }
+
+    void run() {
+        if (NULL != fMakeCurrent) {
+            fMakeCurrent(fMakeCurrentData);
+        }
+        fCondVar.lock();
+        for (;;) {
+            while (0 == fQueue.count() && !fQuit) {
+                fCondVar.wait();
+            }
+            if (0 == fQueue.count()) {
+                break;
+            }
+            // The list stays in the queue until it has executed so finish() can wait on it.
+            CommandList* list = fQueue[0];
+            fCondVar.unlock();
+
+            list->execute(fGL);
+            list->reset();
+
+            fCondVar.lock();
+            fQueue.remove(0);
+            *fFreeLists.append() = list;
+            fCondVar.broadcast();
+        }
+        fCondVar.unlock();
+    }
+
+    const GrGLInterface*        fGL;
+    GrGLSubmitProc              fMakeCurrent;
+    void*                       fMakeCurrentData;
+    SkThread                    fThread;
+    bool                        fStarted;
+
+    // Only touched by the recording thread.
+    CommandList*                fCurrent;
+    NamePool                    fNamePools[kNameKindCnt];
+    SkTDArray<Mapping>          fMappings;
+
+    // Protected by fCondVar.
+    SkCondVar                   fCondVar;
+    SkTDArray<CommandList*>     fQueue;
+    SkTDArray<CommandList*>     fFreeLists;
+    bool                        fQuit;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Calls that take their arguments by value. Pointer arguments are passed on as is, so the "SYNC"
+// calls that write through them must wait for the call to execute.
+
+#define GR_GL_RECORD_0(NAME, SYNC)                                                               \
+    struct NAME##Cmd {                                                                           \
+        static void Exec(const GrGLInterface* gl, const void*) {                                 \
+            gl->fFunctions.f##NAME();                                                            \
+        }                                                                                        \
+    };                                                                                           \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME() {                                              \
+        Recorder* r = Recorder::Current();                                                       \
+        r->record<NAME##Cmd>();                                                                  \
+        if (SYNC) { r->finish(); }                                                               \
+    }
+
+#define GR_GL_RECORD_1(NAME, SYNC, T0)                                                           \
+    struct NAME##Cmd {                                                                           \
+        T0 f0;                                                                                   \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            gl->fFunctions.f##NAME(c->f0);                                                       \
+        }                                                                                        \
+    };                                                                                           \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME(T0 a0) {                                         \
+        Recorder* r = Recorder::Current();                                                       \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->f0 = a0;                                                                              \
+        if (SYNC) { r->finish(); }                                                               \
+    }
+
+#define GR_GL_RECORD_2(NAME, SYNC, T0, T1)                                                       \
+    struct NAME##Cmd {                                                                           \
+        T0 f0; T1 f1;                                                                            \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            gl->fFunctions.f##NAME(c->f0, c->f1);                                                \
+        }                                                                                        \
+    };                                                                                           \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME(T0 a0, T1 a1) {                                  \
+        Recorder* r = Recorder::Current();                                                       \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->f0 = a0; c->f1 = a1;                                                                  \
+        if (SYNC) { r->finish(); }                                                               \
+    }
+
+#define GR_GL_RECORD_3(NAME, SYNC, T0, T1, T2)                                                   \
+    struct NAME##Cmd {                                                                           \
+        T0 f0; T1 f1; T2 f2;                                                                     \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            gl->fFunctions.f##NAME(c->f0, c->f1, c->f2);                                         \
+        }                                                                                        \
+    };                                                                                           \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME(T0 a0, T1 a1, T2 a2) {                           \
+        Recorder* r = Recorder::Current();                                                       \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->f0 = a0; c->f1 = a1; c->f2 = a2;                                                      \
+        if (SYNC) { r->finish(); }                                                               \
+    }
+
+#define GR_GL_RECORD_4(NAME, SYNC, T0, T1, T2, T3)                                               \
+    struct NAME##Cmd {                                                                           \
+        T0 f0; T1 f1; T2 f2; T3 f3;                                                              \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            gl->fFunctions.f##NAME(c->f0, c->f1, c->f2, c->f3);                                  \
+        }                                                                                        \
+    };                                                                                           \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME(T0 a0, T1 a1, T2 a2, T3 a3) {                    \
+        Recorder* r = Recorder::Current();                                                       \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->f0 = a0; c->f1 = a1; c->f2 = a2; c->f3 = a3;                                          \
+        if (SYNC) { r->finish(); }                                                               \
+    }
+
+#define GR_GL_RECORD_5(NAME, SYNC, T0, T1, T2, T3, T4)                                           \
+    struct NAME##Cmd {                                                                           \
+        T0 f0; T1 f1; T2 f2; T3 f3; T4 f4;                                                       \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            gl->fFunctions.f##NAME(c->f0, c->f1, c->f2, c->f3, c->f4);                           \
+        }                                                                                        \
+    };                                                                                           \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME(T0 a0, T1 a1, T2 a2, T3 a3, T4 a4) {             \
+        Recorder* r = Recorder::Current();                                                       \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->f0 = a0; c->f1 = a1; c->f2 = a2; c->f3 = a3; c->f4 = a4;                              \
+        if (SYNC) { r->finish(); }                                                               \
+    }
+
+#define GR_GL_RECORD_6(NAME, SYNC, T0, T1, T2, T3, T4, T5)                                       \
+    struct NAME##Cmd {                                                                           \
+        T0 f0; T1 f1; T2 f2; T3 f3; T4 f4; T5 f5;                                                \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            gl->fFunctions.f##NAME(c->f0, c->f1, c->f2, c->f3, c->f4, c->f5);                    \
+        }                                                                                        \
+    };                                                                                           \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME(T0 a0, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) {      \
+        Recorder* r = Recorder::Current();                                                       \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->f0 = a0; c->f1 = a1; c->f2 = a2; c->f3 = a3; c->f4 = a4; c->f5 = a5;                  \
+        if (SYNC) { r->finish(); }                                                               \
+    }
+
+#define GR_GL_RECORD_7(NAME, SYNC, T0, T1, T2, T3, T4, T5, T6)                                   \
+    struct NAME##Cmd {                                                                           \
+        T0 f0; T1 f1; T2 f2; T3 f3; T4 f4; T5 f5; T6 f6;                                         \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            gl->fFunctions.f##NAME(c->f0, c->f1, c->f2, c->f3, c->f4, c->f5, c->f6);             \
+        }                                                                                        \
+    };                                                                                           \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME(T0 a0, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5,        \
+                                                T6 a6) {                                         \
+        Recorder* r = Recorder::Current();                                                       \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->f0 = a0; c->f1 = a1; c->f2 = a2; c->f3 = a3; c->f4 = a4; c->f5 = a5; c->f6 = a6;      \
+        if (SYNC) { r->finish(); }                                                               \
+    }
+
+#define GR_GL_RECORD_8(NAME, SYNC, T0, T1, T2, T3, T4, T5, T6, T7)                               \
+    struct NAME##Cmd {                                                                           \
+        T0 f0; T1 f1; T2 f2; T3 f3; T4 f4; T5 f5; T6 f6; T7 f7;                                  \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            gl->fFunctions.f##NAME(c->f0, c->f1, c->f2, c->f3, c->f4, c->f5, c->f6, c->f7);      \
+        }                                                                                        \
+    };                                                                                           \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME(T0 a0, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5,        \
+                                                T6 a6, T7 a7) {                                  \
+        Recorder* r = Recorder::Current();                                                       \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->f0 = a0; c->f1 = a1; c->f2 = a2; c->f3 = a3; c->f4 = a4; c->f5 = a5; c->f6 = a6;      \
+        c->f7 = a7;                                                                              \
+        if (SYNC) { r->finish(); }                                                               \
+    }
+
+#define GR_GL_RECORD_10(NAME, SYNC, T0, T1, T2, T3, T4, T5, T6, T7, T8, T9)                      \
+    struct NAME##Cmd {                                                                           \
+        T0 f0; T1 f1; T2 f2; T3 f3; T4 f4; T5 f5; T6 f6; T7 f7; T8 f8; T9 f9;                    \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            gl->fFunctions.f##NAME(c->f0, c->f1, c->f2, c->f3, c->f4, c->f5, c->f6, c->f7,       \
+                                   c->f8, c->f9);                                                \
+        }                                                                                        \
+    };                                                                                           \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME(T0 a0, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5,        \
+                                                T6 a6, T7 a7, T8 a8, T9 a9) {                    \
+        Recorder* r = Recorder::Current();                                                       \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->f0 = a0; c->f1 = a1; c->f2 = a2; c->f3 = a3; c->f4 = a4; c->f5 = a5; c->f6 = a6;      \
+        c->f7 = a7; c->f8 = a8; c->f9 = a9;                                                      \
+        if (SYNC) { r->finish(); }                                                               \
+    }
+
+// Calls that return a value always wait for it.
+#define GR_GL_RECORD_RET_0(R, NAME)                                                              \
+    struct NAME##Cmd {                                                                           \
+        R* fRet;                                                                                 \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            *c->fRet = gl->fFunctions.f##NAME();                                                 \
+        }                                                                                        \
+    };                                                                                           \
+    R GR_GL_FUNCTION_TYPE threaded##NAME() {                                                     \
+        Recorder* r = Recorder::Current();                                                       \
+        R ret;                                                                                   \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->fRet = &ret;                                                                          \
+        r->finish();                                                                             \
+        return ret;                                                                              \
+    }
+
+#define GR_GL_RECORD_RET_1(R, NAME, T0)                                                          \
+    struct NAME##Cmd {                                                                           \
+        R* fRet; T0 f0;                                                                          \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            *c->fRet = gl->fFunctions.f##NAME(c->f0);                                            \
+        }                                                                                        \
+    };                                                                                           \
+    R GR_GL_FUNCTION_TYPE threaded##NAME(T0 a0) {                                                \
+        Recorder* r = Recorder::Current();                                                       \
+        R ret;                                                                                   \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->fRet = &ret; c->f0 = a0;                                                              \
+        r->finish();                                                                             \
+        return ret;                                                                              \
+    }
+
+#define GR_GL_RECORD_RET_2(R, NAME, T0, T1)                                                      \
+    struct NAME##Cmd {                                                                           \
+        R* fRet; T0 f0; T1 f1;                                                                   \
+        static void Exec(const GrGLInterface* gl, const void* cmd) {                             \
+            const NAME##Cmd* c = static_cast<const NAME##Cmd*>(cmd);                             \
+            *c->fRet = gl->fFunctions.f##NAME(c->f0, c->f1);                                     \
+        }                                                                                        \
+    };                                                                                           \
+    R GR_GL_FUNCTION_TYPE threaded##NAME(T0 a0, T1 a1) {                                         \
+        Recorder* r = Recorder::Current();                                                       \
+        R ret;                                                                                   \
+        NAME##Cmd* c = r->record<NAME##Cmd>();                                                   \
+        c->fRet = &ret; c->f0 = a0; c->f1 = a1;                                                  \
+        r->finish();                                                                             \
+        return ret;                                                                              \
+    }
+
+GR_GL_RECORD_1(ActiveTexture, false, GrGLenum)
+GR_GL_RECORD_2(AttachShader, false, GrGLuint, GrGLuint)
+GR_GL_RECORD_2(BeginQuery, false, GrGLenum, GrGLuint)
+GR_GL_RECORD_2(BindFramebuffer, false, GrGLenum, GrGLuint)
+GR_GL_RECORD_2(BindRenderbuffer, false, GrGLenum, GrGLuint)
+GR_GL_RECORD_2(BindTexture, false, GrGLenum, GrGLuint)
+GR_GL_RECORD_1(BindVertexArray, false, GrGLuint)
+GR_GL_RECORD_0(BlendBarrier, false)
+GR_GL_RECORD_4(BlendColor, false, GrGLclampf, GrGLclampf, GrGLclampf, GrGLclampf)
+GR_GL_RECORD_1(BlendEquation, false, GrGLenum)
+GR_GL_RECORD_2(BlendFunc, false, GrGLenum, GrGLenum)
+GR_GL_RECORD_10(BlitFramebuffer, false, GrGLint, GrGLint, GrGLint, GrGLint,
+                GrGLint, GrGLint, GrGLint, GrGLint, GrGLbitfield, GrGLenum)
+GR_GL_RECORD_RET_1(GrGLenum, CheckFramebufferStatus, GrGLenum)
+GR_GL_RECORD_1(Clear, false, GrGLbitfield)
+GR_GL_RECORD_4(ClearColor, false, GrGLclampf, GrGLclampf, GrGLclampf, GrGLclampf)
+GR_GL_RECORD_1(ClearStencil, false, GrGLint)
+GR_GL_RECORD_4(ColorMask, false, GrGLboolean, GrGLboolean, GrGLboolean, GrGLboolean)
+GR_GL_RECORD_1(CompileShader, false, GrGLuint)
+GR_GL_RECORD_8(CopyTexSubImage2D, false, GrGLenum, GrGLint, GrGLint, GrGLint,
+               GrGLint, GrGLint, GrGLsizei, GrGLsizei)
+GR_GL_RECORD_RET_0(GrGLuint, CreateProgram)
+GR_GL_RECORD_RET_1(GrGLuint, CreateShader, GrGLenum)
+GR_GL_RECORD_1(CullFace, false, GrGLenum)
+GR_GL_RECORD_1(DeleteProgram, false, GrGLuint)
+GR_GL_RECORD_1(DeleteShader, false, GrGLuint)
+GR_GL_RECORD_1(DepthMask, false, GrGLboolean)
+GR_GL_RECORD_1(Disable, false, GrGLenum)
+GR_GL_RECORD_1(DisableVertexAttribArray, false, GrGLuint)
+GR_GL_RECORD_3(DrawArrays, false, GrGLenum, GrGLint, GrGLsizei)
+GR_GL_RECORD_4(DrawArraysInstanced, false, GrGLenum, GrGLint, GrGLsizei, GrGLsizei)
+GR_GL_RECORD_1(DrawBuffer, false, GrGLenum)
+// The indices are an offset into the bound index buffer, see GrGLCreateThreadedInterface().
+GR_GL_RECORD_4(DrawElements, false, GrGLenum, GrGLsizei, GrGLenum, const GrGLvoid*)
+GR_GL_RECORD_1(Enable, false, GrGLenum)
+GR_GL_RECORD_1(EnableVertexAttribArray, false, GrGLuint)
+GR_GL_RECORD_1(EndQuery, false, GrGLenum)
+GR_GL_RECORD_0(Finish, true)
+GR_GL_RECORD_4(FramebufferRenderbuffer, false, GrGLenum, GrGLenum, GrGLenum, GrGLuint)
+GR_GL_RECORD_5(FramebufferTexture2D, false, GrGLenum, GrGLenum, GrGLenum, GrGLuint, GrGLint)
+GR_GL_RECORD_6(FramebufferTexture2DMultisample, false, GrGLenum, GrGLenum, GrGLenum, GrGLuint,
+               GrGLint, GrGLsizei)
+GR_GL_RECORD_1(FrontFace, false, GrGLenum)
+GR_GL_RECORD_1(GenerateMipmap, false, GrGLenum)
+GR_GL_RECORD_3(GetBufferParameteriv, true, GrGLenum, GrGLenum, GrGLint*)
+GR_GL_RECORD_RET_0(GrGLenum, GetError)
+GR_GL_RECORD_4(GetFramebufferAttachmentParameteriv, true, GrGLenum, GrGLenum, GrGLenum, GrGLint*)
+GR_GL_RECORD_2(GetIntegerv, true, GrGLenum, GrGLint*)
+GR_GL_RECORD_3(GetQueryObjecti64v, true, GrGLuint, GrGLenum, GrGLint64*)
+GR_GL_RECORD_3(GetQueryObjectiv, true, GrGLuint, GrGLenum, GrGLint*)
+GR_GL_RECORD_3(GetQueryObjectui64v, true, GrGLuint, GrGLenum, GrGLuint64*)
+GR_GL_RECORD_3(GetQueryObjectuiv, true, GrGLuint, GrGLenum, GrGLuint*)
+GR_GL_RECORD_3(GetQueryiv, true, GrGLenum, GrGLenum, GrGLint*)
+GR_GL_RECORD_5(GetProgramBinary, true, GrGLuint, GrGLsizei, GrGLsizei*, GrGLenum*, GrGLvoid*)
+GR_GL_RECORD_4(GetProgramInfoLog, true, GrGLuint, GrGLsizei, GrGLsizei*, char*)
+GR_GL_RECORD_3(GetProgramiv, true, GrGLuint, GrGLenum, GrGLint*)
+GR_GL_RECORD_3(GetRenderbufferParameteriv, true, GrGLenum, GrGLenum, GrGLint*)
+GR_GL_RECORD_4(GetShaderInfoLog, true, GrGLuint, GrGLsizei, GrGLsizei*, char*)
+GR_GL_RECORD_3(GetShaderiv, true, GrGLuint, GrGLenum, GrGLint*)
+GR_GL_RECORD_RET_1(const GrGLubyte*, GetString, GrGLenum)
+GR_GL_RECORD_RET_2(const GrGLubyte*, GetStringi, GrGLenum, GrGLuint)
+GR_GL_RECORD_4(GetTexLevelParameteriv, true, GrGLenum, GrGLint, GrGLenum, GrGLint*)
+GR_GL_RECORD_RET_2(GrGLint, GetUniformLocation, GrGLuint, const char*)
+GR_GL_RECORD_1(InvalidateBufferData, false, GrGLuint)
+GR_GL_RECORD_3(InvalidateBufferSubData, false, GrGLuint, GrGLintptr, GrGLsizeiptr)
+GR_GL_RECORD_2(InvalidateTexImage, false, GrGLuint, GrGLint)
+GR_GL_RECORD_8(InvalidateTexSubImage, false, GrGLuint, GrGLint, GrGLint, GrGLint, GrGLint,
+               GrGLsizei, GrGLsizei, GrGLsizei)
+GR_GL_RECORD_1(LineWidth, false, GrGLfloat)
+GR_GL_RECORD_1(LinkProgram, false, GrGLuint)
+GR_GL_RECORD_1(MatrixLoadIdentity, false, GrGLenum)
+GR_GL_RECORD_1(MaxShaderCompilerThreads, false, GrGLuint)
+GR_GL_RECORD_0(PopGroupMarker, false)
+GR_GL_RECORD_3(ProgramParameteri, false, GrGLuint, GrGLenum, GrGLint)
+GR_GL_RECORD_2(QueryCounter, false, GrGLuint, GrGLenum)
+GR_GL_RECORD_1(ReadBuffer, false, GrGLenum)
+GR_GL_RECORD_7(ReadPixels, true, GrGLint, GrGLint, GrGLsizei, GrGLsizei, GrGLenum, GrGLenum,
+               GrGLvoid*)
+GR_GL_RECORD_4(RenderbufferStorage, false, GrGLenum, GrGLenum, GrGLsizei, GrGLsizei)
+GR_GL_RECORD_5(RenderbufferStorageMultisampleES2EXT, false, GrGLenum, GrGLsizei, GrGLenum,
+               GrGLsizei, GrGLsizei)
+GR_GL_RECORD_5(RenderbufferStorageMultisampleES2APPLE, false, GrGLenum, GrGLsizei, GrGLenum,
+               GrGLsizei, GrGLsizei)
+GR_GL_RECORD_5(RenderbufferStorageMultisample, false, GrGLenum, GrGLsizei, GrGLenum, GrGLsizei,
+               GrGLsizei)
+GR_GL_RECORD_0(ResolveMultisampleFramebuffer, false)
+GR_GL_RECORD_4(Scissor, false, GrGLint, GrGLint, GrGLsizei, GrGLsizei)
+GR_GL_RECORD_3(StencilFunc, false, GrGLenum, GrGLint, GrGLuint)
+GR_GL_RECORD_4(StencilFuncSeparate, false, GrGLenum, GrGLenum, GrGLint, GrGLuint)
+GR_GL_RECORD_1(StencilMask, false, GrGLuint)
+GR_GL_RECORD_2(StencilMaskSeparate, false, GrGLenum, GrGLuint)
+GR_GL_RECORD_3(StencilOp, false, GrGLenum, GrGLenum, GrGLenum)
+GR_GL_RECORD_4(StencilOpSeparate, false, GrGLenum, GrGLenum, GrGLenum, GrGLenum)
+GR_GL_RECORD_3(TexParameteri, false, GrGLenum, GrGLenum, GrGLint)
+GR_GL_RECORD_5(TexStorage2D, false, GrGLenum, GrGLsizei, GrGLenum, GrGLsizei, GrGLsizei)
+GR_GL_RECORD_2(Uniform1f, false, GrGLint, GrGLfloat)
+GR_GL_RECORD_2(Uniform1i, false, GrGLint, GrGLint)
+GR_GL_RECORD_3(Uniform2f, false, GrGLint, GrGLfloat, GrGLfloat)
+GR_GL_RECORD_3(Uniform2i, false, GrGLint, GrGLint, GrGLint)
+GR_GL_RECORD_4(Uniform3f, false, GrGLint, GrGLfloat, GrGLfloat, GrGLfloat)
+GR_GL_RECORD_4(Uniform3i, false, GrGLint, GrGLint, GrGLint, GrGLint)
+GR_GL_RECORD_5(Uniform4f, false, GrGLint, GrGLfloat, GrGLfloat, GrGLfloat, GrGLfloat)
+GR_GL_RECORD_5(Uniform4i, false, GrGLint, GrGLint, GrGLint, GrGLint, GrGLint)
+GR_GL_RECORD_1(UseProgram, false, GrGLuint)
+GR_GL_RECORD_2(VertexAttribDivisor, false, GrGLuint, GrGLuint)
+// The pointer is an offset into the bound vertex buffer, see GrGLCreateThreadedInterface().
+GR_GL_RECORD_6(VertexAttribPointer, false, GrGLuint, GrGLint, GrGLenum, GrGLboolean, GrGLsizei,
+               const GrGLvoid*)
+GR_GL_RECORD_4(Viewport, false, GrGLint, GrGLint, GrGLsizei, GrGLsizei)
+
+////////////////////////////////////////////////////////////////////////////////
+// Calls that update state the recorder tracks.
+
+struct BindBufferCmd {
+    GrGLenum fTarget;
+    GrGLuint fBuffer;
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const BindBufferCmd* c = static_cast<const BindBufferCmd*>(cmd);
+        gl->fFunctions.fBindBuffer(c->fTarget, c->fBuffer);
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedBindBuffer(GrGLenum target, GrGLuint buffer) {
+    Recorder* r = Recorder::Current();
+    if (GR_GL_PIXEL_UNPACK_BUFFER == target) {
+        r->fUnpackBuffer = buffer;
+    }
+    BindBufferCmd* c = r->record<BindBufferCmd>();
+    c->fTarget = target;
+    c->fBuffer = buffer;
+}
+
+struct PixelStoreiCmd {
+    GrGLenum fPName;
+    GrGLint  fParam;
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const PixelStoreiCmd* c = static_cast<const PixelStoreiCmd*>(cmd);
+        gl->fFunctions.fPixelStorei(c->fPName, c->fParam);
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedPixelStorei(GrGLenum pname, GrGLint param) {
+    Recorder* r = Recorder::Current();
+    if (GR_GL_UNPACK_ALIGNMENT == pname) {
+        r->fUnpackAlignment = param;
+    } else if (GR_GL_UNPACK_ROW_LENGTH == pname) {
+        r->fUnpackRowLength = param;
+    }
+    PixelStoreiCmd* c = r->record<PixelStoreiCmd>();
+    c->fPName = pname;
+    c->fParam = param;
+}
+
+struct FlushCmd {
+    static void Exec(const GrGLInterface* gl, const void*) {
+        gl->fFunctions.fFlush();
+    }
+};
+
+// A flush is a good point to hand the calls so far to the submission thread.
+GrGLvoid GR_GL_FUNCTION_TYPE threadedFlush() {
+    Recorder* r = Recorder::Current();
+    r->record<FlushCmd>();
+    r->submit();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Names
+
+#define GR_GL_GEN_NAMES(NAME, KIND)                                                              \
+    GrGLvoid GR_GL_FUNCTION_TYPE threadedGen##NAME(GrGLsizei n, GrGLuint* names) {               \
+        Recorder::Current()->genNames(KIND, n, names);                                           \
+    }                                                                                            \
+    GrGLvoid GR_GL_FUNCTION_TYPE threadedDelete##NAME(GrGLsizei n, const GrGLuint* names) {      \
+        Recorder* r = Recorder::Current();                                                       \
+        r->deleteNames(r->gl()->fFunctions.fDelete##NAME, n, names);                             \
+    }
+
+GR_GL_GEN_NAMES(Buffers, kBuffer_NameKind)
+GR_GL_GEN_NAMES(Framebuffers, kFramebuffer_NameKind)
+GR_GL_GEN_NAMES(Queries, kQuery_NameKind)
+GR_GL_GEN_NAMES(Renderbuffers, kRenderbuffer_NameKind)
+GR_GL_GEN_NAMES(Textures, kTexture_NameKind)
+GR_GL_GEN_NAMES(VertexArrays, kVertexArray_NameKind)
+
+////////////////////////////////////////////////////////////////////////////////
+// Calls that read data through pointers. The data is copied into the command list.
+
+size_t string_size(const char* str) {
+    return strlen(str) + 1;
+}
+
+// BindAttribLocation and BindFragDataLocation
+struct BindLocationCmd {
+    GrGLBindAttribLocationProc  fProc;
+    GrGLuint                    fProgram;
+    GrGLuint                    fIndex;
+    static void Exec(const GrGLInterface*, const void* cmd) {
+        const BindLocationCmd* c = static_cast<const BindLocationCmd*>(cmd);
+        c->fProc(c->fProgram, c->fIndex, payload(c));
+    }
+};
+
+void record_bind_location(GrGLBindAttribLocationProc proc, GrGLuint program, GrGLuint index,
+                          const char* name) {
+    size_t size = string_size(name);
+    BindLocationCmd* c = Recorder::Current()->record<BindLocationCmd>(size);
+    c->fProc = proc;
+    c->fProgram = program;
+    c->fIndex = index;
+    memcpy(payload(c), name, size);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedBindAttribLocation(GrGLuint program, GrGLuint index,
+                                                        const char* name) {
+    record_bind_location(Recorder::Current()->gl()->fFunctions.fBindAttribLocation,
+                         program, index, name);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedBindFragDataLocation(GrGLuint program, GrGLuint colorNumber,
+                                                          const GrGLchar* name) {
+    record_bind_location(Recorder::Current()->gl()->fFunctions.fBindFragDataLocation,
+                         program, colorNumber, name);
+}
+
+struct BindFragDataLocationIndexedCmd {
+    GrGLuint fProgram;
+    GrGLuint fColorNumber;
+    GrGLuint fIndex;
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const BindFragDataLocationIndexedCmd* c =
+            static_cast<const BindFragDataLocationIndexedCmd*>(cmd);
+        gl->fFunctions.fBindFragDataLocationIndexed(c->fProgram, c->fColorNumber, c->fIndex,
+                                                    payload(c));
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedBindFragDataLocationIndexed(GrGLuint program,
+                                                                 GrGLuint colorNumber,
+                                                                 GrGLuint index,
+                                                                 const GrGLchar* name) {
+    size_t size = string_size(name);
+    BindFragDataLocationIndexedCmd* c =
+        Recorder::Current()->record<BindFragDataLocationIndexedCmd>(size);
+    c->fProgram = program;
+    c->fColorNumber = colorNumber;
+    c->fIndex = index;
+    memcpy(payload(c), name, size);
+}
+
+struct BindUniformLocationCmd {
+    GrGLuint fProgram;
+    GrGLint  fLocation;
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const BindUniformLocationCmd* c = static_cast<const BindUniformLocationCmd*>(cmd);
+        gl->fFunctions.fBindUniformLocation(c->fProgram, c->fLocation, payload(c));
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedBindUniformLocation(GrGLuint program, GrGLint location,
+                                                         const char* name) {
+    size_t size = string_size(name);
+    BindUniformLocationCmd* c = Recorder::Current()->record<BindUniformLocationCmd>(size);
+    c->fProgram = program;
+    c->fLocation = location;
+    memcpy(payload(c), name, size);
+}
+
+struct BufferDataCmd {
+    GrGLenum        fTarget;
+    GrGLsizeiptr    fSize;
+    GrGLenum        fUsage;
+    bool            fHasData;
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const BufferDataCmd* c = static_cast<const BufferDataCmd*>(cmd);
+        gl->fFunctions.fBufferData(c->fTarget, c->fSize, c->fHasData ? payload(c) : NULL,
+                                   c->fUsage);
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedBufferData(GrGLenum target, GrGLsizeiptr size,
+                                                const GrGLvoid* data, GrGLenum usage) {
+    bool hasData = NULL != data;
+    BufferDataCmd* c = Recorder::Current()->record<BufferDataCmd>(hasData ? size : 0);
+    c->fTarget = target;
+    c->fSize = size;
+    c->fUsage = usage;
+    c->fHasData = hasData;
+    if (hasData) {
+        memcpy(payload(c), data, size);
+    }
+}
+
+// Either copies the data or, for the unmapping of a buffer, takes ownership of its client memory.
+struct BufferSubDataCmd {
+    GrGLenum        fTarget;
+    GrGLintptr      fOffset;
+    GrGLsizeiptr    fSize;
+    void*           fOwnedData;
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const BufferSubDataCmd* c = static_cast<const BufferSubDataCmd*>(cmd);
+        if (NULL != c->fOwnedData) {
+            gl->fFunctions.fBufferSubData(c->fTarget, c->fOffset, c->fSize, c->fOwnedData);
+            sk_free(c->fOwnedData);
+        } else {
+            gl->fFunctions.fBufferSubData(c->fTarget, c->fOffset, c->fSize, payload(c));
+        }
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedBufferSubData(GrGLenum target, GrGLintptr offset,
+                                                   GrGLsizeiptr size, const GrGLvoid* data) {
+    BufferSubDataCmd* c = Recorder::Current()->record<BufferSubDataCmd>(size);
+    c->fTarget = target;
+    c->fOffset = offset;
+    c->fSize = size;
+    c->fOwnedData = NULL;
+    memcpy(payload(c), data, size);
+}
+
+// Compressed data can't be read from client memory while an unpack buffer is bound.
+bool should_copy_pixels(const Recorder* r, const GrGLvoid* pixels) {
+    return NULL != pixels && 0 == r->fUnpackBuffer;
+}
+
+struct CompressedTexImage2DCmd {
+    GrGLenum        fTarget;
+    GrGLint         fLevel;
+    GrGLenum        fInternalFormat;
+    GrGLsizei       fWidth;
+    GrGLsizei       fHeight;
+    GrGLint         fBorder;
+    GrGLsizei       fImageSize;
+    const GrGLvoid* fData;      // NULL if copied
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const CompressedTexImage2DCmd* c = static_cast<const CompressedTexImage2DCmd*>(cmd);
+        gl->fFunctions.fCompressedTexImage2D(c->fTarget, c->fLevel, c->fInternalFormat,
+                                             c->fWidth, c->fHeight, c->fBorder, c->fImageSize,
+                                             NULL != c->fData ? c->fData : payload(c));
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedCompressedTexImage2D(GrGLenum target, GrGLint level,
+                                                          GrGLenum internalformat,
+                                                          GrGLsizei width, GrGLsizei height,
+                                                          GrGLint border, GrGLsizei imageSize,
+                                                          const GrGLvoid* data) {
+    Recorder* r = Recorder::Current();
+    bool copy = should_copy_pixels(r, data);
+    CompressedTexImage2DCmd* c = r->record<CompressedTexImage2DCmd>(copy ? imageSize : 0);
+    c->fTarget = target;
+    c->fLevel = level;
+    c->fInternalFormat = internalformat;
+    c->fWidth = width;
+    c->fHeight = height;
+    c->fBorder = border;
+    c->fImageSize = imageSize;
+    c->fData = copy ? NULL : data;
+    if (copy) {
+        memcpy(payload(c), data, imageSize);
+    }
+}
+
+struct CompressedTexSubImage2DCmd {
+    GrGLenum        fTarget;
+    GrGLint         fLevel;
+    GrGLint         fX;
+    GrGLint         fY;
+    GrGLsizei       fWidth;
+    GrGLsizei       fHeight;
+    GrGLenum        fFormat;
+    GrGLsizei       fImageSize;
+    const GrGLvoid* fData;      // NULL if copied
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const CompressedTexSubImage2DCmd* c = static_cast<const CompressedTexSubImage2DCmd*>(cmd);
+        gl->fFunctions.fCompressedTexSubImage2D(c->fTarget, c->fLevel, c->fX, c->fY,
+                                                c->fWidth, c->fHeight, c->fFormat, c->fImageSize,
+                                                NULL != c->fData ? c->fData : payload(c));
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedCompressedTexSubImage2D(GrGLenum target, GrGLint level,
+                                                             GrGLint xoffset, GrGLint yoffset,
+                                                             GrGLsizei width, GrGLsizei height,
+                                                             GrGLenum format, GrGLsizei imageSize,
+                                                             const GrGLvoid* data) {
+    Recorder* r = Recorder::Current();
+    bool copy = should_copy_pixels(r, data);
+    CompressedTexSubImage2DCmd* c = r->record<CompressedTexSubImage2DCmd>(copy ? imageSize : 0);
+    c->fTarget = target;
+    c->fLevel = level;
+    c->fX = xoffset;
+    c->fY = yoffset;
+    c->fWidth = width;
+    c->fHeight = height;
+    c->fFormat = format;
+    c->fImageSize = imageSize;
+    c->fData = copy ? NULL : data;
+    if (copy) {
+        memcpy(payload(c), data, imageSize);
+    }
+}
+
+struct DrawBuffersCmd {
+    GrGLsizei fN;
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const DrawBuffersCmd* c = static_cast<const DrawBuffersCmd*>(cmd);
+        gl->fFunctions.fDrawBuffers(c->fN, reinterpret_cast<const GrGLenum*>(payload(c)));
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedDrawBuffers(GrGLsizei n, const GrGLenum* bufs) {
+    DrawBuffersCmd* c = Recorder::Current()->record<DrawBuffersCmd>(n * sizeof(GrGLenum));
+    c->fN = n;
+    memcpy(payload(c), bufs, n * sizeof(GrGLenum));
+}
+
+// DiscardFramebuffer and InvalidateFramebuffer
+struct AttachmentsCmd {
+    GrGLDiscardFramebufferProc  fProc;
+    GrGLenum                    fTarget;
+    GrGLsizei                   fNumAttachments;
+    static void Exec(const GrGLInterface*, const void* cmd) {
+        const AttachmentsCmd* c = static_cast<const AttachmentsCmd*>(cmd);
+        c->fProc(c->fTarget, c->fNumAttachments, reinterpret_cast<const GrGLenum*>(payload(c)));
+    }
+};
+
+void record_attachments(GrGLDiscardFramebufferProc proc, GrGLenum target,
+                        GrGLsizei numAttachments, const GrGLenum* attachments) {
+    size_t size = numAttachments * sizeof(GrGLenum);
+    AttachmentsCmd* c = Recorder::Current()->record<AttachmentsCmd>(size);
+    c->fProc = proc;
+    c->fTarget = target;
+    c->fNumAttachments = numAttachments;
+    memcpy(payload(c), attachments, size);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedDiscardFramebuffer(GrGLenum target, GrGLsizei numAttachments,
+                                                        const GrGLenum* attachments) {
+    record_attachments(Recorder::Current()->gl()->fFunctions.fDiscardFramebuffer,
+                       target, numAttachments, attachments);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedInvalidateFramebuffer(GrGLenum target,
+                                                           GrGLsizei numAttachments,
+                                                           const GrGLenum* attachments) {
+    record_attachments(Recorder::Current()->gl()->fFunctions.fInvalidateFramebuffer,
+                       target, numAttachments, attachments);
+}
+
+struct InvalidateSubFramebufferCmd {
+    GrGLenum    fTarget;
+    GrGLsizei   fNumAttachments;
+    GrGLint     fX;
+    GrGLint     fY;
+    GrGLsizei   fWidth;
+    GrGLsizei   fHeight;
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const InvalidateSubFramebufferCmd* c =
+            static_cast<const InvalidateSubFramebufferCmd*>(cmd);
+        gl->fFunctions.fInvalidateSubFramebuffer(c->fTarget, c->fNumAttachments,
+                                                 reinterpret_cast<const GrGLenum*>(payload(c)),
+                                                 c->fX, c->fY, c->fWidth, c->fHeight);
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedInvalidateSubFramebuffer(GrGLenum target,
+                                                              GrGLsizei numAttachments,
+                                                              const GrGLenum* attachments,
+                                                              GrGLint x, GrGLint y,
+                                                              GrGLsizei width, GrGLsizei height) {
+    size_t size = numAttachments * sizeof(GrGLenum);
+    InvalidateSubFramebufferCmd* c =
+        Recorder::Current()->record<InvalidateSubFramebufferCmd>(size);
+    c->fTarget = target;
+    c->fNumAttachments = numAttachments;
+    c->fX = x;
+    c->fY = y;
+    c->fWidth = width;
+    c->fHeight = height;
+    memcpy(payload(c), attachments, size);
+}
+
+// InsertEventMarker and PushGroupMarker. A length of 0 means the marker is null terminated.
+struct MarkerCmd {
+    GrGLInsertEventMarkerProc   fProc;
+    GrGLsizei                   fLength;
+    static void Exec(const GrGLInterface*, const void* cmd) {
+        const MarkerCmd* c = static_cast<const MarkerCmd*>(cmd);
+        c->fProc(c->fLength, payload(c));
+    }
+};
+
+void record_marker(GrGLInsertEventMarkerProc proc, GrGLsizei length, const char* marker) {
+    size_t size = 0 == length ? string_size(marker) : length;
+    MarkerCmd* c = Recorder::Current()->record<MarkerCmd>(size);
+    c->fProc = proc;
+    c->fLength = length;
+    memcpy(payload(c), marker, size);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedInsertEventMarker(GrGLsizei length, const char* marker) {
+    record_marker(Recorder::Current()->gl()->fFunctions.fInsertEventMarker, length, marker);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedPushGroupMarker(GrGLsizei length, const char* marker) {
+    record_marker(Recorder::Current()->gl()->fFunctions.fPushGroupMarker, length, marker);
+}
+
+struct MatrixLoadfCmd {
+    GrGLenum    fMatrixMode;
+    GrGLfloat   fM[16];
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const MatrixLoadfCmd* c = static_cast<const MatrixLoadfCmd*>(cmd);
+        gl->fFunctions.fMatrixLoadf(c->fMatrixMode, c->fM);
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedMatrixLoadf(GrGLenum matrixMode, const GrGLfloat* m) {
+    MatrixLoadfCmd* c = Recorder::Current()->record<MatrixLoadfCmd>();
+    c->fMatrixMode = matrixMode;
+    memcpy(c->fM, m, sizeof(c->fM));
+}
+
+struct ProgramBinaryCmd {
+    GrGLuint    fProgram;
+    GrGLenum    fBinaryFormat;
+    GrGLsizei   fLength;
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const ProgramBinaryCmd* c = static_cast<const ProgramBinaryCmd*>(cmd);
+        gl->fFunctions.fProgramBinary(c->fProgram, c->fBinaryFormat, payload(c), c->fLength);
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedProgramBinary(GrGLuint program, GrGLenum binaryFormat,
+                                                   const GrGLvoid* binary, GrGLsizei length) {
+    ProgramBinaryCmd* c = Recorder::Current()->record<ProgramBinaryCmd>(length);
+    c->fProgram = program;
+    c->fBinaryFormat = binaryFormat;
+    c->fLength = length;
+    memcpy(payload(c), binary, length);
+}
+
+// The payload is the lengths of the strings followed by the strings.
+struct ShaderSourceCmd {
+    GrGLuint    fShader;
+    GrGLsizei   fCount;
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const ShaderSourceCmd* c = static_cast<const ShaderSourceCmd*>(cmd);
+        const GrGLint* lengths = reinterpret_cast<const GrGLint*>(payload(c));
+        const char* str = reinterpret_cast<const char*>(lengths + c->fCount);
+        SkAutoSTMalloc<8, const char*> strings(c->fCount);
+        for (int i = 0; i < c->fCount; ++i) {
+            strings[i] = str;
+            str += lengths[i];
+        }
+        gl->fFunctions.fShaderSource(c->fShader, c->fCount, strings.get(), lengths);
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedShaderSource(GrGLuint shader,
+                                                  GrGLsizei count,
+#if GR_GL_USE_NEW_SHADER_SOURCE_SIGNATURE
+                                                  const char* const * str,
+#else
+                                                  const char** str,
+#endif
+                                                  const GrGLint* length) {
+    SkAutoSTMalloc<8, GrGLint> lengths(count);
+    size_t size = count * sizeof(GrGLint);
+    for (int i = 0; i < count; ++i) {
+        lengths[i] = (NULL != length && length[i] >= 0) ? length[i] : SkToS32(strlen(str[i]));
+        size += lengths[i];
+    }
+    ShaderSourceCmd* c = Recorder::Current()->record<ShaderSourceCmd>(size);
+    c->fShader = shader;
+    c->fCount = count;
+    char* dst = payload(c);
+    memcpy(dst, lengths.get(), count * sizeof(GrGLint));
+    dst += count * sizeof(GrGLint);
+    for (int i = 0; i < count; ++i) {
+        memcpy(dst, str[i], lengths[i]);
+        dst += lengths[i];
+    }
+}
+
+struct TexParameterivCmd {
+    GrGLenum    fTarget;
+    GrGLenum    fPName;
+    GrGLint     fParams[4];
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const TexParameterivCmd* c = static_cast<const TexParameterivCmd*>(cmd);
+        gl->fFunctions.fTexParameteriv(c->fTarget, c->fPName, c->fParams);
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedTexParameteriv(GrGLenum target, GrGLenum pname,
+                                                    const GrGLint* params) {
+    TexParameterivCmd* c = Recorder::Current()->record<TexParameterivCmd>();
+    c->fTarget = target;
+    c->fPName = pname;
+    // The swizzle is the only parameter we set that has more than one value.
+    int count = GR_GL_TEXTURE_SWIZZLE_RGBA == pname ? 4 : 1;
+    memcpy(c->fParams, params, count * sizeof(GrGLint));
+}
+
+// Uniform*fv, Uniform*iv and UniformMatrix*fv. The proc is called with the same arguments the
+// stub was, only with the values copied.
+template <typename PROC, typename T> struct UniformvCmd {
+    PROC        fProc;
+    GrGLint     fLocation;
+    GrGLsizei   fCount;
+    static void Exec(const GrGLInterface*, const void* cmd) {
+        const UniformvCmd* c = static_cast<const UniformvCmd*>(cmd);
+        c->fProc(c->fLocation, c->fCount, reinterpret_cast<const T*>(payload(c)));
+    }
+};
+
+template <typename PROC, typename T> struct UniformMatrixvCmd {
+    PROC        fProc;
+    GrGLint     fLocation;
+    GrGLsizei   fCount;
+    GrGLboolean fTranspose;
+    static void Exec(const GrGLInterface*, const void* cmd) {
+        const UniformMatrixvCmd* c = static_cast<const UniformMatrixvCmd*>(cmd);
+        c->fProc(c->fLocation, c->fCount, c->fTranspose, reinterpret_cast<const T*>(payload(c)));
+    }
+};
+
+#define GR_GL_RECORD_UNIFORMV(NAME, T, N)                                                        \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME(GrGLint location, GrGLsizei count, const T* v) { \
+        typedef UniformvCmd<GrGL##NAME##Proc, T> Cmd;                                            \
+        Recorder* r = Recorder::Current();                                                       \
+        size_t size = count * N * sizeof(T);                                                     \
+        Cmd* c = r->record<Cmd>(size);                                                           \
+        c->fProc = r->gl()->fFunctions.f##NAME;                                                  \
+        c->fLocation = location;                                                                 \
+        c->fCount = count;                                                                       \
+        memcpy(payload(c), v, size);                                                             \
+    }
+
+#define GR_GL_RECORD_UNIFORM_MATRIXV(NAME, N)                                                    \
+    GrGLvoid GR_GL_FUNCTION_TYPE threaded##NAME(GrGLint location, GrGLsizei count,               \
+                                                GrGLboolean transpose, const GrGLfloat* v) {     \
+        typedef UniformMatrixvCmd<GrGL##NAME##Proc, GrGLfloat> Cmd;                              \
+        Recorder* r = Recorder::Current();                                                       \
+        size_t size = count * N * N * sizeof(GrGLfloat);                                         \
+        Cmd* c = r->record<Cmd>(size);                                                           \
+        c->fProc = r->gl()->fFunctions.f##NAME;                                                  \
+        c->fLocation = location;                                                                 \
+        c->fCount = count;                                                                       \
+        c->fTranspose = transpose;                                                               \
+        memcpy(payload(c), v, size);                                                             \
+    }
+
+GR_GL_RECORD_UNIFORMV(Uniform1fv, GrGLfloat, 1)
+GR_GL_RECORD_UNIFORMV(Uniform1iv, GrGLint, 1)
+GR_GL_RECORD_UNIFORMV(Uniform2fv, GrGLfloat, 2)
+GR_GL_RECORD_UNIFORMV(Uniform2iv, GrGLint, 2)
+GR_GL_RECORD_UNIFORMV(Uniform3fv, GrGLfloat, 3)
+GR_GL_RECORD_UNIFORMV(Uniform3iv, GrGLint, 3)
+GR_GL_RECORD_UNIFORMV(Uniform4fv, GrGLfloat, 4)
+GR_GL_RECORD_UNIFORMV(Uniform4iv, GrGLint, 4)
+GR_GL_RECORD_UNIFORM_MATRIXV(UniformMatrix2fv, 2)
+GR_GL_RECORD_UNIFORM_MATRIXV(UniformMatrix3fv, 3)
+GR_GL_RECORD_UNIFORM_MATRIXV(UniformMatrix4fv, 4)
+
+struct VertexAttrib4fvCmd {
+    GrGLuint    fIndex;
+    GrGLfloat   fValues[4];
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const VertexAttrib4fvCmd* c = static_cast<const VertexAttrib4fvCmd*>(cmd);
+        gl->fFunctions.fVertexAttrib4fv(c->fIndex, c->fValues);
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedVertexAttrib4fv(GrGLuint indx, const GrGLfloat* values) {
+    VertexAttrib4fvCmd* c = Recorder::Current()->record<VertexAttrib4fvCmd>();
+    c->fIndex = indx;
+    memcpy(c->fValues, values, sizeof(c->fValues));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Texture uploads
+
+// Gets the size of a pixel in client memory. Returns false for formats we don't know.
+bool bytes_per_pixel(GrGLenum format, GrGLenum type, size_t* bpp) {
+    switch (type) {
+        case GR_GL_UNSIGNED_SHORT_5_6_5:
+        case GR_GL_UNSIGNED_SHORT_4_4_4_4:
+        case GR_GL_UNSIGNED_SHORT_5_5_5_1:
+            *bpp = 2;
+            return true;
+        case GR_GL_UNSIGNED_BYTE:
+        case GR_GL_BYTE:
+            *bpp = 1;
+            break;
+        case GR_GL_UNSIGNED_SHORT:
+        case GR_GL_SHORT:
+            *bpp = 2;
+            break;
+        case GR_GL_UNSIGNED_INT:
+        case GR_GL_INT:
+        case GR_GL_FLOAT:
+            *bpp = 4;
+            break;
+        default:
+            return false;
+    }
+    switch (format) {
+        case GR_GL_RGBA:
+        case GR_GL_BGRA:
+            *bpp *= 4;
+            return true;
+        case GR_GL_RGB:
+            *bpp *= 3;
+            return true;
+        case GR_GL_LUMINANCE_ALPHA:
+            *bpp *= 2;
+            return true;
+        case GR_GL_ALPHA:
+        case GR_GL_LUMINANCE:
+        case GR_GL_RED:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Gets the number of bytes TexSubImage2D etc. read from client memory given the current unpack
+// state. Returns false if it can't tell.
+bool unpacked_image_size(const Recorder* r, GrGLsizei width, GrGLsizei height,
+                         GrGLenum format, GrGLenum type, size_t* size) {
+    size_t bpp;
+    if (!bytes_per_pixel(format, type, &bpp)) {
+        return false;
+    }
+    if (width <= 0 || height <= 0) {
+        *size = 0;
+        return true;
+    }
+    size_t alignment = r->fUnpackAlignment;
+    size_t rowPixels = r->fUnpackRowLength > 0 ? r->fUnpackRowLength : width;
+    size_t rowBytes = (rowPixels * bpp + alignment - 1) / alignment * alignment;
+    *size = (height - 1) * rowBytes + width * bpp;
+    return true;
+}
+
+struct TexImage2DCmd {
+    GrGLenum        fTarget;
+    GrGLint         fLevel;
+    GrGLint         fInternalFormat;
+    GrGLsizei       fWidth;
+    GrGLsizei       fHeight;
+    GrGLint         fBorder;
+    GrGLenum        fFormat;
+    GrGLenum        fType;
+    const GrGLvoid* fPixels;    // NULL if copied
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const TexImage2DCmd* c = static_cast<const TexImage2DCmd*>(cmd);
+        gl->fFunctions.fTexImage2D(c->fTarget, c->fLevel, c->fInternalFormat,
+                                   c->fWidth, c->fHeight, c->fBorder, c->fFormat, c->fType,
+                                   NULL != c->fPixels ? c->fPixels : payload(c));
+    }
+};
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedTexImage2D(GrGLenum target, GrGLint level,
+                                                GrGLint internalformat,
+                                                GrGLsizei width, GrGLsizei height,
+                                                GrGLint border, GrGLenum format, GrGLenum type,
+                                                const GrGLvoid* pixels) {
+    Recorder* r = Recorder::Current();
+    size_t size = 0;
+    bool copy = should_copy_pixels(r, pixels);
+    // If we can't tell how much to copy we have to wait for GL to read the pixels.
+    bool sync = copy && !unpacked_image_size(r, width, height, format, type, &size);
+    copy = copy && !sync;
+    TexImage2DCmd* c = r->record<TexImage2DCmd>(copy ? size : 0);
+    c->fTarget = target;
+    c->fLevel = level;
+    c->fInternalFormat = internalformat;
+    c->fWidth = width;
+    c->fHeight = height;
+    c->fBorder = border;
+    c->fFormat = format;
+    c->fType = type;
+    c->fPixels = copy ? NULL : pixels;
+    if (copy) {
+        memcpy(payload(c), pixels, size);
+    }
+    if (sync) {
+        r->finish();
+    }
+}
+
+// Either copies the pixels or, for the unmapping of a texture rect, takes ownership of its client
+// memory.
+struct TexSubImage2DCmd {
+    GrGLenum        fTarget;
+    GrGLint         fLevel;
+    GrGLint         fX;
+    GrGLint         fY;
+    GrGLsizei       fWidth;
+    GrGLsizei       fHeight;
+    GrGLenum        fFormat;
+    GrGLenum        fType;
+    const GrGLvoid* fPixels;    // NULL if copied
+    void*           fOwnedPixels;
+    static void Exec(const GrGLInterface* gl, const void* cmd) {
+        const TexSubImage2DCmd* c = static_cast<const TexSubImage2DCmd*>(cmd);
+        const GrGLvoid* pixels = c->fPixels;
+        if (NULL != c->fOwnedPixels) {
+            pixels = c->fOwnedPixels;
+        } else if (NULL == pixels) {
+            pixels = payload(c);
+        }
+        gl->fFunctions.fTexSubImage2D(c->fTarget, c->fLevel, c->fX, c->fY,
+                                      c->fWidth, c->fHeight, c->fFormat, c->fType, pixels);
+        sk_free(c->fOwnedPixels);
+    }
+};
+
+TexSubImage2DCmd* record_tex_sub_image(Recorder* r, size_t payloadSize,
+                                       GrGLenum target, GrGLint level,
+                                       GrGLint xoffset, GrGLint yoffset,
+                                       GrGLsizei width, GrGLsizei height,
+                                       GrGLenum format, GrGLenum type) {
+    TexSubImage2DCmd* c = r->record<TexSubImage2DCmd>(payloadSize);
+    c->fTarget = target;
+    c->fLevel = level;
+    c->fX = xoffset;
+    c->fY = yoffset;
+    c->fWidth = width;
+    c->fHeight = height;
+    c->fFormat = format;
+    c->fType = type;
+    c->fPixels = NULL;
+    c->fOwnedPixels = NULL;
+    return c;
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedTexSubImage2D(GrGLenum target, GrGLint level,
+                                                   GrGLint xoffset, GrGLint yoffset,
+                                                   GrGLsizei width, GrGLsizei height,
+                                                   GrGLenum format, GrGLenum type,
+                                                   const GrGLvoid* pixels) {
+    Recorder* r = Recorder::Current();
+    size_t size = 0;
+    bool copy = should_copy_pixels(r, pixels);
+    // If we can't tell how much to copy we have to wait for GL to read the pixels.
+    bool sync = copy && !unpacked_image_size(r, width, height, format, type, &size);
+    copy = copy && !sync;
+    TexSubImage2DCmd* c = record_tex_sub_image(r, copy ? size : 0, target, level,
+                                               xoffset, yoffset, width, height, format, type);
+    if (copy) {
+        memcpy(payload(c), pixels, size);
+    } else {
+        c->fPixels = pixels;
+    }
+    if (sync) {
+        r->finish();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Mapping. The client writes to memory of our own which is uploaded with BufferSubData or
+// TexSubImage2D at unmap. Like an invalidating map, the memory starts out undefined.
+
+typedef Recorder::Mapping Mapping;
+
+void* map_buffer(Mapping::Kind kind, GrGLenum target, GrGLintptr offset, GrGLsizeiptr size) {
+    if (size <= 0) {
+        return NULL;
+    }
+    void* mem = sk_malloc_flags(size, 0);
+    if (NULL == mem) {
+        return NULL;
+    }
+    Mapping mapping;
+    memset(&mapping, 0, sizeof(Mapping));
+    mapping.fKind = kind;
+    mapping.fMem = mem;
+    mapping.fTarget = target;
+    mapping.fOffset = offset;
+    mapping.fSize = size;
+    Recorder::Current()->addMapping(mapping);
+    return mem;
+}
+
+void record_buffer_upload(const Mapping& mapping) {
+    BufferSubDataCmd* c = Recorder::Current()->record<BufferSubDataCmd>();
+    c->fTarget = mapping.fTarget;
+    c->fOffset = mapping.fOffset;
+    c->fSize = mapping.fSize;
+    c->fOwnedData = mapping.fMem;
+}
+
+GrGLvoid* GR_GL_FUNCTION_TYPE threadedMapBuffer(GrGLenum target, GrGLenum access) {
+    GrGLint size = 0;
+    threadedGetBufferParameteriv(target, GR_GL_BUFFER_SIZE, &size);
+    return map_buffer(Mapping::kBuffer_Kind, target, 0, size);
+}
+
+GrGLvoid* GR_GL_FUNCTION_TYPE threadedMapBufferRange(GrGLenum target, GrGLintptr offset,
+                                                     GrGLsizeiptr length, GrGLbitfield access) {
+    return map_buffer(Mapping::kBuffer_Kind, target, offset, length);
+}
+
+// The whole mapped range is uploaded at unmap.
+GrGLvoid GR_GL_FUNCTION_TYPE threadedFlushMappedBufferRange(GrGLenum target, GrGLintptr offset,
+                                                            GrGLsizeiptr length) {
+}
+
+GrGLboolean GR_GL_FUNCTION_TYPE threadedUnmapBuffer(GrGLenum target) {
+    Mapping mapping;
+    if (!Recorder::Current()->removeMapping(Mapping::kBuffer_Kind, target, NULL, &mapping)) {
+        return GR_GL_FALSE;
+    }
+    record_buffer_upload(mapping);
+    return GR_GL_TRUE;
+}
+
+GrGLvoid* GR_GL_FUNCTION_TYPE threadedMapBufferSubData(GrGLuint target, GrGLintptr offset,
+                                                       GrGLsizeiptr size, GrGLenum access) {
+    return map_buffer(Mapping::kBufferSubData_Kind, target, offset, size);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedUnmapBufferSubData(const GrGLvoid* mem) {
+    Mapping mapping;
+    if (Recorder::Current()->removeMapping(Mapping::kBufferSubData_Kind, 0, mem, &mapping)) {
+        record_buffer_upload(mapping);
+    }
+}
+
+GrGLvoid* GR_GL_FUNCTION_TYPE threadedMapTexSubImage2D(GrGLenum target, GrGLint level,
+                                                       GrGLint xoffset, GrGLint yoffset,
+                                                       GrGLsizei width, GrGLsizei height,
+                                                       GrGLenum format, GrGLenum type,
+                                                       GrGLenum access) {
+    Recorder* r = Recorder::Current();
+    size_t size;
+    if (!unpacked_image_size(r, width, height, format, type, &size) || 0 == size) {
+        return NULL;
+    }
+    void* mem = sk_malloc_flags(size, 0);
+    if (NULL == mem) {
+        return NULL;
+    }
+    Mapping mapping;
+    memset(&mapping, 0, sizeof(Mapping));
+    mapping.fKind = Mapping::kTexSubImage_Kind;
+    mapping.fMem = mem;
+    mapping.fTarget = target;
+    mapping.fLevel = level;
+    mapping.fX = xoffset;
+    mapping.fY = yoffset;
+    mapping.fWidth = width;
+    mapping.fHeight = height;
+    mapping.fFormat = format;
+    mapping.fType = type;
+    r->addMapping(mapping);
+    return mem;
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE threadedUnmapTexSubImage2D(const GrGLvoid* mem) {
+    Recorder* r = Recorder::Current();
+    Mapping m;
+    if (r->removeMapping(Mapping::kTexSubImage_Kind, 0, mem, &m)) {
+        TexSubImage2DCmd* c = record_tex_sub_image(r, 0, m.fTarget, m.fLevel, m.fX, m.fY,
+                                                   m.fWidth, m.fHeight, m.fFormat, m.fType);
+        c->fOwnedPixels = m.fMem;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+class GrGLThreadedInterface : public GrGLInterface {
+public:
+    GrGLThreadedInterface(Recorder* recorder) : fRecorder(recorder) {}
+
+    virtual ~GrGLThreadedInterface() {
+        SkDELETE(fRecorder);
+    }
+
+    Recorder* recorder() const { return fRecorder; }
+
+private:
+    Recorder* fRecorder;
+
+    typedef GrGLInterface INHERITED;
+};
+
+const char kThreadedInterfaceExtension[] = "GL_SKIA_threaded_interface";
+
+Recorder* get_recorder(const GrGLInterface* interface) {
+    SkASSERT(interface->hasExtension(kThreadedInterfaceExtension));
+    Recorder* recorder = static_cast<const GrGLThreadedInterface*>(interface)->recorder();
+    SkASSERT(Recorder::Current() == recorder);
+    return recorder;
+}
+
+} // end anonymous namespace
+
+const GrGLInterface* GrGLCreateThreadedInterface(const GrGLInterface* gl,
+                                                 GrGLSubmitProc makeCurrent,
+                                                 void* makeCurrentData) {
+    SkASSERT(NULL != gl);
+    SkASSERT(NULL != makeCurrent);
+
+    Recorder* recorder = SkNEW_ARGS(Recorder, (gl, makeCurrent, makeCurrentData));
+    if (!recorder->start()) {
+        SkDELETE(recorder);
+        return NULL;
+    }
+
+    GrGLThreadedInterface* interface = SkNEW_ARGS(GrGLThreadedInterface, (recorder));
+    interface->fStandard = gl->fStandard;
+    interface->fExtensions = gl->fExtensions;
+    // Path rendering needs too many calls that return values to be worth deferring.
+    interface->fExtensions.remove("GL_NV_path_rendering");
+    interface->fExtensions.add(kThreadedInterfaceExtension);
+#if GR_GL_PER_GL_FUNC_CALLBACK
+    interface->fCallback = gl->fCallback;
+    interface->fCallbackData = gl->fCallbackData;
+#endif
+
+    // Fences, and so streaming buffers, don't work when the calls are deferred. Buffer storage is
+    // only used for streaming. All of them are left NULL.
+    const GrGLInterface::Functions& glFunctions = gl->fFunctions;
+    GrGLInterface::Functions* functions = &interface->fFunctions;
+#define GR_GL_INSTALL(NAME)                                                                      \
+    if (NULL != glFunctions.f##NAME) {                                                           \
+        functions->f##NAME = threaded##NAME;                                                     \
+    }
+
+    GR_GL_INSTALL(ActiveTexture);
+    GR_GL_INSTALL(AttachShader);
+    GR_GL_INSTALL(BeginQuery);
+    GR_GL_INSTALL(BindAttribLocation);
+    GR_GL_INSTALL(BindBuffer);
+    GR_GL_INSTALL(BindFragDataLocation);
+    GR_GL_INSTALL(BindFragDataLocationIndexed);
+    GR_GL_INSTALL(BindFramebuffer);
+    GR_GL_INSTALL(BindRenderbuffer);
+    GR_GL_INSTALL(BindTexture);
+    GR_GL_INSTALL(BindVertexArray);
+    GR_GL_INSTALL(BlendBarrier);
+    GR_GL_INSTALL(BlendColor);
+    GR_GL_INSTALL(BlendEquation);
+    GR_GL_INSTALL(BlendFunc);
+    GR_GL_INSTALL(BlitFramebuffer);
+    GR_GL_INSTALL(BufferData);
+    GR_GL_INSTALL(BufferSubData);
+    GR_GL_INSTALL(CheckFramebufferStatus);
+    GR_GL_INSTALL(Clear);
+    GR_GL_INSTALL(ClearColor);
+    GR_GL_INSTALL(ClearStencil);
+    GR_GL_INSTALL(ColorMask);
+    GR_GL_INSTALL(CompileShader);
+    GR_GL_INSTALL(CompressedTexImage2D);
+    GR_GL_INSTALL(CompressedTexSubImage2D);
+    GR_GL_INSTALL(CopyTexSubImage2D);
+    GR_GL_INSTALL(CreateProgram);
+    GR_GL_INSTALL(CreateShader);
+    GR_GL_INSTALL(CullFace);
+    GR_GL_INSTALL(DeleteBuffers);
+    GR_GL_INSTALL(DeleteFramebuffers);
+    GR_GL_INSTALL(DeleteProgram);
+    GR_GL_INSTALL(DeleteQueries);
+    GR_GL_INSTALL(DeleteRenderbuffers);
+    GR_GL_INSTALL(DeleteShader);
+    GR_GL_INSTALL(DeleteTextures);
+    GR_GL_INSTALL(DeleteVertexArrays);
+    GR_GL_INSTALL(DepthMask);
+    GR_GL_INSTALL(Disable);
+    GR_GL_INSTALL(DisableVertexAttribArray);
+    GR_GL_INSTALL(DrawArrays);
+    GR_GL_INSTALL(DrawArraysInstanced);
+    GR_GL_INSTALL(DrawBuffer);
+    GR_GL_INSTALL(DrawBuffers);
+    GR_GL_INSTALL(DrawElements);
+    GR_GL_INSTALL(Enable);
+    GR_GL_INSTALL(EnableVertexAttribArray);
+    GR_GL_INSTALL(EndQuery);
+    GR_GL_INSTALL(Finish);
+    GR_GL_INSTALL(Flush);
+    GR_GL_INSTALL(FlushMappedBufferRange);
+    GR_GL_INSTALL(FramebufferRenderbuffer);
+    GR_GL_INSTALL(FramebufferTexture2D);
+    GR_GL_INSTALL(FramebufferTexture2DMultisample);
+    GR_GL_INSTALL(FrontFace);
+    GR_GL_INSTALL(GenBuffers);
+    GR_GL_INSTALL(GenFramebuffers);
+    GR_GL_INSTALL(GenerateMipmap);
+    GR_GL_INSTALL(GenQueries);
+    GR_GL_INSTALL(GenRenderbuffers);
+    GR_GL_INSTALL(GenTextures);
+    GR_GL_INSTALL(GenVertexArrays);
+    GR_GL_INSTALL(GetBufferParameteriv);
+    GR_GL_INSTALL(GetError);
+    GR_GL_INSTALL(GetFramebufferAttachmentParameteriv);
+    GR_GL_INSTALL(GetIntegerv);
+    GR_GL_INSTALL(GetQueryObjecti64v);
+    GR_GL_INSTALL(GetQueryObjectiv);
+    GR_GL_INSTALL(GetQueryObjectui64v);
+    GR_GL_INSTALL(GetQueryObjectuiv);
+    GR_GL_INSTALL(GetQueryiv);
+    GR_GL_INSTALL(GetProgramBinary);
+    GR_GL_INSTALL(GetProgramInfoLog);
+    GR_GL_INSTALL(GetProgramiv);
+    GR_GL_INSTALL(GetRenderbufferParameteriv);
+    GR_GL_INSTALL(GetShaderInfoLog);
+    GR_GL_INSTALL(GetShaderiv);
+    GR_GL_INSTALL(GetString);
+    GR_GL_INSTALL(GetStringi);
+    GR_GL_INSTALL(GetTexLevelParameteriv);
+    GR_GL_INSTALL(GetUniformLocation);
+    GR_GL_INSTALL(InsertEventMarker);
+    GR_GL_INSTALL(InvalidateBufferData);
+    GR_GL_INSTALL(InvalidateBufferSubData);
+    GR_GL_INSTALL(InvalidateFramebuffer);
+    GR_GL_INSTALL(InvalidateSubFramebuffer);
+    GR_GL_INSTALL(InvalidateTexImage);
+    GR_GL_INSTALL(InvalidateTexSubImage);
+    GR_GL_INSTALL(LineWidth);
+    GR_GL_INSTALL(LinkProgram);
+    GR_GL_INSTALL(MapBuffer);
+    GR_GL_INSTALL(MapBufferRange);
+    GR_GL_INSTALL(MapBufferSubData);
+    GR_GL_INSTALL(MapTexSubImage2D);
+    GR_GL_INSTALL(MatrixLoadf);
+    GR_GL_INSTALL(MatrixLoadIdentity);
+    GR_GL_INSTALL(MaxShaderCompilerThreads);
+    GR_GL_INSTALL(PixelStorei);
+    GR_GL_INSTALL(PopGroupMarker);
+    GR_GL_INSTALL(ProgramBinary);
+    GR_GL_INSTALL(ProgramParameteri);
+    GR_GL_INSTALL(PushGroupMarker);
+    GR_GL_INSTALL(QueryCounter);
+    GR_GL_INSTALL(ReadBuffer);
+    GR_GL_INSTALL(ReadPixels);
+    GR_GL_INSTALL(RenderbufferStorage);
+    GR_GL_INSTALL(RenderbufferStorageMultisampleES2EXT);
+    GR_GL_INSTALL(RenderbufferStorageMultisampleES2APPLE);
+    GR_GL_INSTALL(RenderbufferStorageMultisample);
+    GR_GL_INSTALL(BindUniformLocation);
+    GR_GL_INSTALL(ResolveMultisampleFramebuffer);
+    GR_GL_INSTALL(Scissor);
+    GR_GL_INSTALL(ShaderSource);
+    GR_GL_INSTALL(StencilFunc);
+    GR_GL_INSTALL(StencilFuncSeparate);
+    GR_GL_INSTALL(StencilMask);
+    GR_GL_INSTALL(StencilMaskSeparate);
+    GR_GL_INSTALL(StencilOp);
+    GR_GL_INSTALL(StencilOpSeparate);
+    GR_GL_INSTALL(TexImage2D);
+    GR_GL_INSTALL(TexParameteri);
+    GR_GL_INSTALL(TexParameteriv);
+    GR_GL_INSTALL(TexSubImage2D);
+    GR_GL_INSTALL(TexStorage2D);
+    GR_GL_INSTALL(DiscardFramebuffer);
+    GR_GL_INSTALL(Uniform1f);
+    GR_GL_INSTALL(Uniform1i);
+    GR_GL_INSTALL(Uniform1fv);
+    GR_GL_INSTALL(Uniform1iv);
+    GR_GL_INSTALL(Uniform2f);
+    GR_GL_INSTALL(Uniform2i);
+    GR_GL_INSTALL(Uniform2fv);
+    GR_GL_INSTALL(Uniform2iv);
+    GR_GL_INSTALL(Uniform3f);
+    GR_GL_INSTALL(Uniform3i);
+    GR_GL_INSTALL(Uniform3fv);
+    GR_GL_INSTALL(Uniform3iv);
+    GR_GL_INSTALL(Uniform4f);
+    GR_GL_INSTALL(Uniform4i);
+    GR_GL_INSTALL(Uniform4fv);
+    GR_GL_INSTALL(Uniform4iv);
+    GR_GL_INSTALL(UniformMatrix2fv);
+    GR_GL_INSTALL(UniformMatrix3fv);
+    GR_GL_INSTALL(UniformMatrix4fv);
+    GR_GL_INSTALL(UnmapBuffer);
+    GR_GL_INSTALL(UnmapBufferSubData);
+    GR_GL_INSTALL(UnmapTexSubImage2D);
+    GR_GL_INSTALL(UseProgram);
+    GR_GL_INSTALL(VertexAttrib4fv);
+    GR_GL_INSTALL(VertexAttribDivisor);
+    GR_GL_INSTALL(VertexAttribPointer);
+    GR_GL_INSTALL(Viewport);
+
+#undef GR_GL_INSTALL
+
+    return interface;
+}
+
+void GrGLThreadedInterfaceSubmit(const GrGLInterface* interface,
+                                 GrGLSubmitProc proc,
+                                 void* data) {
+    get_recorder(interface)->submitProc(proc, data);
+}
+
+void GrGLThreadedInterfaceFinish(const GrGLInterface* interface) {
+    get_recorder(interface)->finish();
+}
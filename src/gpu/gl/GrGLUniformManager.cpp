@@ -15,6 +15,23 @@
          SkASSERT(arrayCount <= uni.fArrayCount || \
                   (1 == arrayCount && GrGLShaderVar::kNonArray == uni.fArrayCount))
 
+namespace {
+// The number of GrGLfloats or GrGLints in a uniform of the type, or in one element of an array.
+int sl_type_word_count(GrSLType type) {
+    switch (type) {
+        case kMat33f_GrSLType:
+            return 9;
+        case kMat44f_GrSLType:
+            return 16;
+        case kSampler2D_GrSLType:
+            return 1;
+        default:
+            SkASSERT(GrSLTypeVectorCount(type) > 0);
+            return GrSLTypeVectorCount(type);
+    }
+}
+}
+
 GrGLUniformManager::GrGLUniformManager(GrGpuGL* gpu) : fGpu(gpu) {
     // skbug.com/2056
     fUsingBindUniform = fGpu->glInterface()->fFunctions.fBindUniformLocation != NULL;
@@ -28,9 +45,31 @@ GrGLUniformManager::UniformHandle GrGLUniformManager::appendUniform(GrSLType typ
     uni.fType = type;
     uni.fVSLocation = kUnusedUniform;
     uni.fFSLocation = kUnusedUniform;
+    uni.fShadowOffset = fShadowValues.count();
+    int wordCount = sl_type_word_count(type);
+    if (GrGLShaderVar::kNonArray != arrayCount) {
+        wordCount *= arrayCount;
+    }
+    fShadowValues.append(wordCount);
+    *fShadowValidCounts.append() = 0;
     return GrGLUniformManager::UniformHandle::CreateFromUniformIndex(idx);
 }
 
+bool GrGLUniformManager::updateShadow(UniformHandle u, const void* values, int wordCount) const {
+    GR_STATIC_ASSERT(sizeof(GrGLfloat) == sizeof(uint32_t));
+    GR_STATIC_ASSERT(sizeof(GrGLint) == sizeof(uint32_t));
+    int idx = u.toUniformIndex();
+    uint32_t* shadow = fShadowValues.begin() + fUniforms[idx].fShadowOffset;
+    size_t size = wordCount * sizeof(uint32_t);
+    if (wordCount <= fShadowValidCounts[idx] && 0 == memcmp(shadow, values, size)) {
+        return false;
+    }
+    memcpy(shadow, values, size);
+    // A shorter upload to an array leaves the values past it as they were.
+    fShadowValidCounts[idx] = SkTMax(fShadowValidCounts[idx], wordCount);
+    return true;
+}
+
 void GrGLUniformManager::setSampler(UniformHandle u, GrGLint texUnit) const {
     const Uniform& uni = fUniforms[u.toUniformIndex()];
     SkASSERT(uni.fType == kSampler2D_GrSLType);
@@ -39,6 +78,9 @@ void GrGLUniformManager::setSampler(UniformHandle u, GrGLint texUnit) const {
     // reference the sampler then the compiler may have optimized it out. Uncomment this assert
     // once stages insert their own samplers.
     // SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(u, &texUnit, 1)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform1i(uni.fFSLocation, texUnit));
     }
@@ -52,6 +94,9 @@ void GrGLUniformManager::set1f(UniformHandle u, GrGLfloat v0) const {
     SkASSERT(uni.fType == kFloat_GrSLType);
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(u, &v0, 1)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform1f(uni.fFSLocation, v0));
     }
@@ -71,6 +116,9 @@ void GrGLUniformManager::set1fv(UniformHandle u,
     // Once the uniform manager is responsible for inserting the duplicate uniform
     // arrays in VS and FS driver bug workaround, this can be enabled.
     //SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(u, v, arrayCount)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform1fv(uni.fFSLocation, arrayCount, v));
     }
@@ -84,6 +132,10 @@ void GrGLUniformManager::set2f(UniformHandle u, GrGLfloat v0, GrGLfloat v1) cons
     SkASSERT(uni.fType == kVec2f_GrSLType);
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    GrGLfloat v[] = { v0, v1 };
+    if (!this->updateShadow(u, v, 2)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform2f(uni.fFSLocation, v0, v1));
     }
@@ -100,6 +152,9 @@ void GrGLUniformManager::set2fv(UniformHandle u,
     SkASSERT(arrayCount > 0);
     ASSERT_ARRAY_UPLOAD_IN_BOUNDS(uni, arrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(u, v, 2 * arrayCount)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform2fv(uni.fFSLocation, arrayCount, v));
     }
@@ -113,6 +168,10 @@ void GrGLUniformManager::set3f(UniformHandle u, GrGLfloat v0, GrGLfloat v1, GrGL
     SkASSERT(uni.fType == kVec3f_GrSLType);
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    GrGLfloat v[] = { v0, v1, v2 };
+    if (!this->updateShadow(u, v, 3)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform3f(uni.fFSLocation, v0, v1, v2));
     }
@@ -129,6 +188,9 @@ void GrGLUniformManager::set3fv(UniformHandle u,
     SkASSERT(arrayCount > 0);
     ASSERT_ARRAY_UPLOAD_IN_BOUNDS(uni, arrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(u, v, 3 * arrayCount)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform3fv(uni.fFSLocation, arrayCount, v));
     }
@@ -146,6 +208,10 @@ void GrGLUniformManager::set4f(UniformHandle u,
     SkASSERT(uni.fType == kVec4f_GrSLType);
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    GrGLfloat v[] = { v0, v1, v2, v3 };
+    if (!this->updateShadow(u, v, 4)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform4f(uni.fFSLocation, v0, v1, v2, v3));
     }
@@ -162,6 +228,9 @@ void GrGLUniformManager::set4fv(UniformHandle u,
     SkASSERT(arrayCount > 0);
     ASSERT_ARRAY_UPLOAD_IN_BOUNDS(uni, arrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(u, v, 4 * arrayCount)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform4fv(uni.fFSLocation, arrayCount, v));
     }
@@ -176,6 +245,9 @@ void GrGLUniformManager::setMatrix3f(UniformHandle u, const GrGLfloat matrix[])
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     // TODO: Re-enable this assert once texture matrices aren't forced on all effects
     // SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(u, matrix, 9)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), UniformMatrix3fv(uni.fFSLocation, 1, false, matrix));
     }
@@ -189,6 +261,9 @@ void GrGLUniformManager::setMatrix4f(UniformHandle u, const GrGLfloat matrix[])
     SkASSERT(uni.fType == kMat44f_GrSLType);
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(u, matrix, 16)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), UniformMatrix4fv(uni.fFSLocation, 1, false, matrix));
     }
@@ -205,6 +280,9 @@ void GrGLUniformManager::setMatrix3fv(UniformHandle u,
     SkASSERT(arrayCount > 0);
     ASSERT_ARRAY_UPLOAD_IN_BOUNDS(uni, arrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(u, matrices, 9 * arrayCount)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(),
                    UniformMatrix3fv(uni.fFSLocation, arrayCount, false, matrices));
@@ -223,6 +301,9 @@ void GrGLUniformManager::setMatrix4fv(UniformHandle u,
     SkASSERT(arrayCount > 0);
     ASSERT_ARRAY_UPLOAD_IN_BOUNDS(uni, arrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(u, matrices, 16 * arrayCount)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(),
                    UniformMatrix4fv(uni.fFSLocation, arrayCount, false, matrices));
@@ -13,11 +13,13 @@
 #include "GrAllocator.h"
 
 #include "SkTArray.h"
+#include "SkTDArray.h"
 
 class GrGpuGL;
 class SkMatrix;
 
-/** Manages a program's uniforms.
+/** Manages a program's uniforms. Uniform values are program state, so the manager keeps a copy of
+    the values it last uploaded to each uniform and skips uploads that wouldn't change them.
 */
 class GrGLUniformManager : public SkRefCnt {
 public:
@@ -51,7 +53,8 @@ public:
     UniformHandle appendUniform(GrSLType type, int arrayCount = GrGLShaderVar::kNonArray);
 
     /** Functions for uploading uniform values. The varities ending in v can be used to upload to an
-     *  array of uniforms. arrayCount must be <= the array count of the uniform.
+     *  array of uniforms. arrayCount must be <= the array count of the uniform. Values that equal
+     *  the ones last set are not uploaded again.
      */
     void setSampler(UniformHandle, GrGLint texUnit) const;
     void set1f(UniformHandle, GrGLfloat v0) const;
@@ -108,10 +111,21 @@ private:
         GrGLint     fFSLocation;
         GrSLType    fType;
         int         fArrayCount;
+        int         fShadowOffset;  // index of the uniform's first value in fShadowValues
     };
 
+    /**
+     * Returns false if the first wordCount values of the uniform are already set to values.
+     * Otherwise records them and returns true.
+     */
+    bool updateShadow(UniformHandle, const void* values, int wordCount) const;
+
     bool fUsingBindUniform;
     SkTArray<Uniform, true> fUniforms;
+    // The values last uploaded to each uniform, as raw 32 bit words, and for each uniform the
+    // number of its leading words that have been uploaded.
+    mutable SkTDArray<uint32_t> fShadowValues;
+    mutable SkTDArray<int> fShadowValidCounts;
     GrGpuGL* fGpu;
 
     typedef SkRefCnt INHERITED;
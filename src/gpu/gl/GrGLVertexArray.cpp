@@ -18,7 +18,8 @@ void GrGLAttribArrayState::set(const GrGpuGL* gpu,
                                GrGLenum type,
                                GrGLboolean normalized,
                                GrGLsizei stride,
-                               GrGLvoid* offset) {
+                               GrGLvoid* offset,
+                               GrGLuint divisor) {
     SkASSERT(index >= 0 && index < fAttribArrayStates.count());
     AttribArrayState* array = &fAttribArrayStates[index];
     if (!array->fEnableIsValid || !array->fEnabled) {
@@ -47,6 +48,15 @@ void GrGLAttribArrayState::set(const GrGpuGL* gpu,
         array->fStride = stride;
         array->fOffset = offset;
     }
+    // The divisor is only ever changed from zero when instancing is supported, so there is no
+    // need to track it otherwise.
+    if (gpu->caps()->instancedDrawingSupport() &&
+        (!array->fDivisorIsValid || array->fDivisor != divisor)) {
+        GR_GL_CALL(gpu->glInterface(), VertexAttribDivisor(index, divisor));
+        array->fDivisorIsValid = true;
+        array->fDivisor = divisor;
+    }
+    SkASSERT(0 == divisor || gpu->caps()->instancedDrawingSupport());
 }
 
 void GrGLAttribArrayState::disableUnusedArrays(const GrGpuGL* gpu, uint64_t usedMask) {
@@ -68,11 +78,15 @@ void GrGLAttribArrayState::disableUnusedArrays(const GrGpuGL* gpu, uint64_t used
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-GrGLVertexArray::GrGLVertexArray(GrGpuGL* gpu, GrGLint id, int attribCount)
+GrGLVertexArray::GrGLVertexArray(GrGpuGL* gpu, GrGLint id, int attribCount,
+                                 const GrGLVertexArrayKey& key)
     : INHERITED(gpu, false)
     , fID(id)
     , fAttribArrays(attribCount)
-    , fIndexBufferIDIsValid(false) {
+    , fIndexBufferIDIsValid(false)
+    , fKey(key)
+    , fAttribsVertexOffset(0)
+    , fAttribsAreSet(false) {
 }
 
 void GrGLVertexArray::onAbandon() {
@@ -119,4 +133,5 @@ void GrGLVertexArray::notifyIndexBufferDelete(GrGLuint bufferID) {
 void GrGLVertexArray::invalidateCachedState() {
     fAttribArrays.invalidate();
     fIndexBufferIDIsValid = false;
+    fAttribsAreSet = false;
 }
@@ -8,6 +8,7 @@
 #ifndef GrGLVertexArray_DEFINED
 #define GrGLVertexArray_DEFINED
 
+#include "GrDrawState.h"
 #include "GrGpuObject.h"
 #include "GrTypesPriv.h"
 #include "gl/GrGLDefines.h"
@@ -63,7 +64,8 @@ public:
     /**
      * This function enables and sets vertex attrib state for the specified attrib index. It is
      * assumed that the GrGLAttribArrayState is tracking the state of the currently bound vertex
-     * array object.
+     * array object. A non-zero divisor advances the attribute once per that many instances rather
+     * than once per vertex and requires instanced drawing support.
      */
     void set(const GrGpuGL*,
              int index,
@@ -72,7 +74,8 @@ public:
              GrGLenum type,
              GrGLboolean normalized,
              GrGLsizei stride,
-             GrGLvoid* offset);
+             GrGLvoid* offset,
+             GrGLuint divisor);
 
     /**
      * This function disables vertex attribs not present in the mask. It is assumed that the
@@ -110,10 +113,12 @@ private:
             void invalidate() {
                 fEnableIsValid = false;
                 fAttribPointerIsValid = false;
+                fDivisorIsValid = false;
             }
 
             bool        fEnableIsValid;
             bool        fAttribPointerIsValid;
+            bool        fDivisorIsValid;
             bool        fEnabled;
             GrGLuint    fVertexBufferID;
             GrGLint     fSize;
@@ -121,18 +126,78 @@ private:
             GrGLboolean fNormalized;
             GrGLsizei   fStride;
             GrGLvoid*   fOffset;
+            GrGLuint    fDivisor;
     };
 
     SkSTArray<16, AttribArrayState, true> fAttribArrayStates;
 };
 
+/**
+ * Identifies the geometry a vertex array object is set up to draw: the buffers it sources from and
+ * the layout of the vertex attribs within them. The program is not part of the key because attribs
+ * are always bound to the location of their index in the layout. The vertex offset is not part of
+ * it either, so that geometry drawn from different places in the same buffer shares one array.
+ */
+struct GrGLVertexArrayKey {
+    // Zeroes the padding too, so that keys can be compared with memcmp.
+    GrGLVertexArrayKey() { memset(this, 0, sizeof(*this)); }
+
+    /**
+     * Sets the key for drawing attribs from vertexBufferID with the given stride. If
+     * unitBufferID is not 0 the attrib at positionAttribIndex is sourced from it instead.
+     */
+    void set(GrGLuint vertexBufferID,
+             GrGLuint indexBufferID,
+             GrGLuint unitBufferID,
+             int positionAttribIndex,
+             GrGLuint divisor,
+             GrGLsizei stride,
+             const GrVertexAttrib* attribs,
+             int attribCount) {
+        SkASSERT(attribCount <= kMaxAttribCnt);
+        fVertexBufferID = vertexBufferID;
+        fIndexBufferID = indexBufferID;
+        fUnitBufferID = unitBufferID;
+        fPositionAttribIndex = 0 != unitBufferID ? positionAttribIndex : -1;
+        fDivisor = divisor;
+        fStride = stride;
+        fAttribCount = attribCount;
+        for (int i = 0; i < attribCount; ++i) {
+            fAttribTypes[i] = attribs[i].fType;
+            fAttribOffsets[i] = static_cast<uint32_t>(attribs[i].fOffset);
+        }
+    }
+
+    bool usesBuffer(GrGLuint bufferID) const {
+        return bufferID == fVertexBufferID || bufferID == fUnitBufferID;
+    }
+
+    bool operator==(const GrGLVertexArrayKey& other) const {
+        return 0 == memcmp(this, &other, sizeof(*this));
+    }
+
+    enum {
+        kMaxAttribCnt = GrDrawState::kMaxVertexAttribCnt,
+    };
+
+    GrGLuint    fVertexBufferID;
+    GrGLuint    fIndexBufferID;         // 0 if the draws are not indexed
+    GrGLuint    fUnitBufferID;          // 0 if the draws are not hardware instanced
+    int         fPositionAttribIndex;   // -1 if fUnitBufferID is 0
+    GrGLuint    fDivisor;
+    GrGLsizei   fStride;
+    int         fAttribCount;
+    uint32_t    fAttribTypes[kMaxAttribCnt];
+    uint32_t    fAttribOffsets[kMaxAttribCnt];
+};
+
 /**
  * This class represents an OpenGL vertex array object. It manages the lifetime of the vertex array
  * and is used to track the state of the vertex array to avoid redundant GL calls.
  */
 class GrGLVertexArray : public GrGpuObject {
 public:
-    GrGLVertexArray(GrGpuGL* gpu, GrGLint id, int attribCount);
+    GrGLVertexArray(GrGpuGL* gpu, GrGLint id, int attribCount, const GrGLVertexArrayKey& key);
 
     /**
      * Binds this vertex array. If the ID has been deleted or abandoned then NULL is returned.
@@ -151,10 +216,30 @@ public:
 
     void notifyVertexBufferDelete(GrGLuint id) {
         fAttribArrays.notifyVertexBufferDelete(id);
+        fAttribsAreSet = false;
     }
 
     GrGLuint arrayID() const { return fID; }
 
+    const GrGLVertexArrayKey& key() const { return fKey; }
+
+    /**
+     * Returns true if the attribs described by the key have already been set on this vertex array
+     * for vertices starting at vertexOffset, in which case there is nothing to do before drawing.
+     */
+    bool attribsAreSetAt(size_t vertexOffset) const {
+        return fAttribsAreSet && vertexOffset == fAttribsVertexOffset;
+    }
+
+    /**
+     * Records that the attribs described by the key were set for vertices starting at
+     * vertexOffset.
+     */
+    void setAttribsAreSetAt(size_t vertexOffset) {
+        fAttribsAreSet = true;
+        fAttribsVertexOffset = vertexOffset;
+    }
+
     void invalidateCachedState();
 
     virtual size_t gpuMemorySize() const SK_OVERRIDE { return 0; }
@@ -169,6 +254,9 @@ private:
     GrGLAttribArrayState    fAttribArrays;
     GrGLuint                fIndexBufferID;
     bool                    fIndexBufferIDIsValid;
+    GrGLVertexArrayKey      fKey;
+    size_t                  fAttribsVertexOffset;
+    bool                    fAttribsAreSet;
 
     typedef GrGpuObject INHERITED;
 };
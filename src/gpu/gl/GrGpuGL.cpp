@@ -7,9 +7,12 @@
 
 
 #include "GrGpuGL.h"
+#include "GrGLGpuTimer.h"
 #include "GrGLNameAllocator.h"
 #include "GrGLStencilBuffer.h"
 #include "GrGLPath.h"
+#include "GrGLPixelReadback.h"
+#include "GrGLPixelUploadRing.h"
 #include "GrGLShaderBuilder.h"
 #include "GrTemplates.h"
 #include "GrTypes.h"
@@ -21,6 +24,11 @@
 
 #define SKIP_CACHE_CHECK    true
 
+// Uploads at least this large are staged through a pixel unpack buffer of the given size, when
+// the GL supports it.
+#define GR_GL_MIN_STAGED_UPLOAD_SIZE        ((size_t)1 << 16)
+#define GR_GL_PIXEL_UPLOAD_RING_SIZE        ((size_t)1 << 23)
+
 #if GR_GL_CHECK_ALLOC_WITH_GET_ERROR
     #define CLEAR_ERROR_BEFORE_ALLOC(iface)   GrGLClearErr(iface)
     #define GL_ALLOC_CALL(iface, call)        GR_GL_CALL_NOERRCHECK(iface, call)
@@ -144,6 +152,12 @@ GrGpuGL::GrGpuGL(const GrGLContext& ctx, GrContext* context)
         GrPrintf(this->glCaps().dump().c_str());
     }
 
+    if (NULL != fGLContext.interface()->fFunctions.fMaxShaderCompilerThreads) {
+        // Let the driver pick how many threads compile our shaders. We still wait for each
+        // program's link before drawing with it.
+        GL_CALL(MaxShaderCompilerThreads(0xFFFFFFFF));
+    }
+
     fProgramCache = SkNEW_ARGS(ProgramCache, (this));
 
     SkASSERT(this->glCaps().maxVertexAttributes() >= GrDrawState::kMaxVertexAttribCnt);
@@ -331,6 +345,10 @@ void GrGpuGL::onResetContext(uint32_t resetBits) {
         if (this->glCaps().packFlipYSupport()) {
             GL_CALL(PixelStorei(GR_GL_PACK_REVERSE_ROW_ORDER, GR_GL_FALSE));
         }
+        if (this->glCaps().pixelBufferSupport()) {
+            // uploads from client memory require that no unpack buffer is bound
+            GL_CALL(BindBuffer(GR_GL_PIXEL_UNPACK_BUFFER, 0));
+        }
     }
 
     if (resetBits & kProgram_GrGLBackendState) {
@@ -590,6 +608,24 @@ bool GrGpuGL::uploadTexData(const GrGLTexture::Desc& desc,
         return false;
     }
 
+    /*
+     *  Large uploads are copied into the pixel upload ring and GL reads them
+     *  from there, so it can return without copying the client's memory.
+     */
+    GrGLPixelUploadRing* uploadRing = NULL;
+    void* stagedData = NULL;
+    size_t stagedOffset = 0;
+    if (NULL != data && GR_GL_PALETTE8_RGBA8 != internalFormat &&
+        height * trimRowBytes >= GR_GL_MIN_STAGED_UPLOAD_SIZE) {
+        uploadRing = this->pixelUploadRing();
+        if (NULL != uploadRing) {
+            stagedData = uploadRing->map(height * trimRowBytes, bpp, &stagedOffset);
+            if (NULL == stagedData) {
+                uploadRing = NULL;
+            }
+        }
+    }
+
     /*
      *  check whether to allocate a temporary buffer for flipping y or
      *  because our srcData has extra bytes past each row. If so, we need
@@ -607,7 +643,26 @@ bool GrGpuGL::uploadTexData(const GrGLTexture::Desc& desc,
                 swFlipY = true;
             }
         }
-        if (this->glCaps().unpackRowLengthSupport() && !swFlipY) {
+        if (NULL != stagedData) {
+            // The copy into the ring trims and flips the rows as needed.
+            const char* src = (const char*)data;
+            if (swFlipY) {
+                src += (height - 1) * rowBytes;
+            }
+            char* dst = (char*)stagedData;
+            for (int y = 0; y < height; y++) {
+                memcpy(dst, src, trimRowBytes);
+                if (swFlipY) {
+                    src -= rowBytes;
+                } else {
+                    src += rowBytes;
+                }
+                dst += trimRowBytes;
+            }
+            uploadRing->unmap();
+            // GL treats the data pointer as an offset into the bound unpack buffer.
+            data = reinterpret_cast<const void*>(stagedOffset);
+        } else if (this->glCaps().unpackRowLengthSupport() && !swFlipY) {
             // can't use this for flipping, only non-neg values allowed. :(
             if (rowBytes != trimRowBytes) {
                 GrGLint rowLength = static_cast<GrGLint>(rowBytes / bpp);
@@ -702,6 +757,9 @@ bool GrGpuGL::uploadTexData(const GrGLTexture::Desc& desc,
                               externalFormat, externalType, data));
     }
 
+    if (NULL != uploadRing) {
+        uploadRing->endUpload();
+    }
     if (restoreGLRowLength) {
         SkASSERT(this->glCaps().unpackRowLengthSupport());
         GL_CALL(PixelStorei(GR_GL_UNPACK_ROW_LENGTH, 0));
@@ -712,6 +770,18 @@ bool GrGpuGL::uploadTexData(const GrGLTexture::Desc& desc,
     return succeeded;
 }
 
+GrGLPixelUploadRing* GrGpuGL::pixelUploadRing() {
+    if (!this->glCaps().pixelBufferSupport() || !this->caps()->streamingBufferSupport()) {
+        return NULL;
+    }
+    // The ring is destroyed along with the other GPU objects when the context is abandoned.
+    if (NULL == fPixelUploadRing.get() || fPixelUploadRing->wasDestroyed()) {
+        fPixelUploadRing.reset(SkNEW_ARGS(GrGLPixelUploadRing,
+                                          (this, GR_GL_PIXEL_UPLOAD_RING_SIZE)));
+    }
+    return fPixelUploadRing->isValid() ? fPixelUploadRing.get() : NULL;
+}
+
 // TODO: This function is using a lot of wonky semantics like, if width == -1
 // then set width = desc.fWdith ... blah. A better way to do it might be to 
 // create a CompressedTexData struct that takes a desc/ptr and figures out
@@ -1291,9 +1361,10 @@ bool GrGpuGL::attachStencilBufferToRenderTarget(GrStencilBuffer* sb, GrRenderTar
 
 ////////////////////////////////////////////////////////////////////////////////
 
-GrVertexBuffer* GrGpuGL::onCreateVertexBuffer(size_t size, bool dynamic) {
+GrVertexBuffer* GrGpuGL::onCreateVertexBuffer(size_t size, bool dynamic, bool streaming) {
     GrGLVertexBuffer::Desc desc;
     desc.fDynamic = dynamic;
+    desc.fStreaming = streaming;
     desc.fSizeInBytes = size;
     desc.fIsWrapped = false;
 
@@ -1307,11 +1378,22 @@ GrVertexBuffer* GrGpuGL::onCreateVertexBuffer(size_t size, bool dynamic) {
             fHWGeometryState.setVertexBufferID(this, desc.fID);
             CLEAR_ERROR_BEFORE_ALLOC(this->glInterface());
             // make sure driver can allocate memory for this buffer
-            GL_ALLOC_CALL(this->glInterface(),
-                          BufferData(GR_GL_ARRAY_BUFFER,
-                                     (GrGLsizeiptr) desc.fSizeInBytes,
-                                     NULL,   // data ptr
-                                     desc.fDynamic ? GR_GL_DYNAMIC_DRAW : GR_GL_STATIC_DRAW));
+            if (desc.fStreaming && this->glCaps().bufferStorageSupport()) {
+                // immutable storage that stays mapped, see GrGLBufferImpl::map()
+                GL_ALLOC_CALL(this->glInterface(),
+                              BufferStorage(GR_GL_ARRAY_BUFFER,
+                                            (GrGLsizeiptr) desc.fSizeInBytes,
+                                            NULL,  // data ptr
+                                            GR_GL_MAP_WRITE_BIT |
+                                            GR_GL_MAP_PERSISTENT_BIT |
+                                            GR_GL_MAP_COHERENT_BIT));
+            } else {
+                GL_ALLOC_CALL(this->glInterface(),
+                              BufferData(GR_GL_ARRAY_BUFFER,
+                                         (GrGLsizeiptr) desc.fSizeInBytes,
+                                         NULL,  // data ptr
+                                         desc.fDynamic ? GR_GL_DYNAMIC_DRAW : GR_GL_STATIC_DRAW));
+            }
             if (CHECK_ALLOC_ERROR(this->glInterface()) != GR_GL_NO_ERROR) {
                 GL_CALL(DeleteBuffers(1, &desc.fID));
                 this->notifyVertexBufferDelete(desc.fID);
@@ -1324,9 +1406,10 @@ GrVertexBuffer* GrGpuGL::onCreateVertexBuffer(size_t size, bool dynamic) {
     }
 }
 
-GrIndexBuffer* GrGpuGL::onCreateIndexBuffer(size_t size, bool dynamic) {
+GrIndexBuffer* GrGpuGL::onCreateIndexBuffer(size_t size, bool dynamic, bool streaming) {
     GrGLIndexBuffer::Desc desc;
     desc.fDynamic = dynamic;
+    desc.fStreaming = streaming;
     desc.fSizeInBytes = size;
     desc.fIsWrapped = false;
 
@@ -1340,11 +1423,22 @@ GrIndexBuffer* GrGpuGL::onCreateIndexBuffer(size_t size, bool dynamic) {
             fHWGeometryState.setIndexBufferIDOnDefaultVertexArray(this, desc.fID);
             CLEAR_ERROR_BEFORE_ALLOC(this->glInterface());
             // make sure driver can allocate memory for this buffer
-            GL_ALLOC_CALL(this->glInterface(),
-                          BufferData(GR_GL_ELEMENT_ARRAY_BUFFER,
-                                     (GrGLsizeiptr) desc.fSizeInBytes,
-                                     NULL,  // data ptr
-                                     desc.fDynamic ? GR_GL_DYNAMIC_DRAW : GR_GL_STATIC_DRAW));
+            if (desc.fStreaming && this->glCaps().bufferStorageSupport()) {
+                // immutable storage that stays mapped, see GrGLBufferImpl::map()
+                GL_ALLOC_CALL(this->glInterface(),
+                              BufferStorage(GR_GL_ELEMENT_ARRAY_BUFFER,
+                                            (GrGLsizeiptr) desc.fSizeInBytes,
+                                            NULL,  // data ptr
+                                            GR_GL_MAP_WRITE_BIT |
+                                            GR_GL_MAP_PERSISTENT_BIT |
+                                            GR_GL_MAP_COHERENT_BIT));
+            } else {
+                GL_ALLOC_CALL(this->glInterface(),
+                              BufferData(GR_GL_ELEMENT_ARRAY_BUFFER,
+                                         (GrGLsizeiptr) desc.fSizeInBytes,
+                                         NULL,  // data ptr
+                                         desc.fDynamic ? GR_GL_DYNAMIC_DRAW : GR_GL_STATIC_DRAW));
+            }
             if (CHECK_ALLOC_ERROR(this->glInterface()) != GR_GL_NO_ERROR) {
                 GL_CALL(DeleteBuffers(1, &desc.fID));
                 this->notifyIndexBufferDelete(desc.fID);
@@ -1357,6 +1451,82 @@ GrIndexBuffer* GrGpuGL::onCreateIndexBuffer(size_t size, bool dynamic) {
     }
 }
 
+GrFence GrGpuGL::insertFence() {
+    SkASSERT(this->glCaps().fenceSyncSupport());
+    GrGLsync sync;
+    GL_CALL_RET(sync, FenceSync(GR_GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    GR_STATIC_ASSERT(sizeof(GrGLsync) <= sizeof(GrFence));
+    return (GrFence)(intptr_t)sync;
+}
+
+bool GrGpuGL::waitFence(GrFence fence) {
+    SkASSERT(0 != fence);
+    // Wait in one second steps. The first wait flushes so that the fence is sure to be reached.
+    static const GrGLuint64 kTimeoutNs = 1000 * 1000 * 1000;
+    GrGLbitfield flags = GR_GL_SYNC_FLUSH_COMMANDS_BIT;
+    GrGLenum result;
+    do {
+        GL_CALL_RET(result, ClientWaitSync((GrGLsync)(intptr_t)fence, flags, kTimeoutNs));
+        flags = 0;
+    } while (GR_GL_TIMEOUT_EXPIRED == result);
+    return GR_GL_WAIT_FAILED != result;
+}
+
+void GrGpuGL::deleteFence(GrFence fence) {
+    GL_CALL(DeleteSync((GrGLsync)(intptr_t)fence));
+}
+
+GrFence GrGpuGL::flushForSharing() {
+    if (this->glCaps().fenceSyncSupport()) {
+        GrFence fence = this->insertFence();
+        if (0 != fence) {
+            // The fence must be flushed for waits in other contexts to ever see it signaled.
+            GL_CALL(Flush());
+            return fence;
+        }
+    }
+    GL_CALL(Finish());
+    return 0;
+}
+
+GrGLGpuTimer* GrGpuGL::gpuTimer() {
+    if (!this->caps()->timerQuerySupport()) {
+        return NULL;
+    }
+    // Like the upload ring, the timer is destroyed when the context is abandoned.
+    if (NULL == fGpuTimer.get() || fGpuTimer->wasDestroyed()) {
+        fGpuTimer.reset(SkNEW_ARGS(GrGLGpuTimer, (this)));
+    }
+    return fGpuTimer.get();
+}
+
+void GrGpuGL::beginTimedScope(const GrTraceMarkerSet& markers) {
+    GrGLGpuTimer* timer = this->gpuTimer();
+    if (NULL != timer) {
+        timer->beginScope(markers);
+    }
+}
+
+void GrGpuGL::endTimedScope() {
+    if (NULL != fGpuTimer.get() && !fGpuTimer->wasDestroyed()) {
+        fGpuTimer->endScope();
+    }
+}
+
+void GrGpuGL::endTimingFrame() {
+    if (NULL != fGpuTimer.get()) {
+        fGpuTimer->endFrame();
+    }
+}
+
+bool GrGpuGL::getTimingFrame(SkTArray<GrContext::GpuScopeTime>* times) const {
+    return NULL != fGpuTimer.get() && fGpuTimer->getFrame(times);
+}
+
+void GrGpuGL::getProgramCacheCounters(SkCacheCounters* counters) const {
+    *counters = fProgramCache->counters();
+}
+
 GrPath* GrGpuGL::onCreatePath(const SkPath& inPath, const SkStrokeRec& stroke) {
     SkASSERT(this->caps()->pathRenderingSupport());
     return SkNEW_ARGS(GrGLPath, (this, inPath, stroke));
@@ -1614,21 +1784,8 @@ bool GrGpuGL::onReadPixels(GrRenderTarget* target,
     // resolve the render target if necessary
     GrGLRenderTarget* tgt = static_cast<GrGLRenderTarget*>(target);
     GrDrawState::AutoRenderTargetRestore artr;
-    switch (tgt->getResolveType()) {
-        case GrGLRenderTarget::kCantResolve_ResolveType:
-            return false;
-        case GrGLRenderTarget::kAutoResolves_ResolveType:
-            artr.set(this->drawState(), target);
-            this->flushRenderTarget(&SkIRect::EmptyIRect());
-            break;
-        case GrGLRenderTarget::kCanResolve_ResolveType:
-            this->onResolveRenderTarget(tgt);
-            // we don't track the state of the READ FBO ID.
-            GL_CALL(BindFramebuffer(GR_GL_READ_FRAMEBUFFER,
-                                    tgt->textureFBOID()));
-            break;
-        default:
-            SkFAIL("Unknown resolve type");
+    if (!this->bindReadRenderTarget(tgt, &artr)) {
+        return false;
     }
 
     const GrGLIRect& glvp = tgt->getViewport();
@@ -1715,6 +1872,64 @@ bool GrGpuGL::onReadPixels(GrRenderTarget* target,
     return true;
 }
 
+GrPixelReadback* GrGpuGL::onBeginReadPixels(GrRenderTarget* target,
+                                            int left, int top,
+                                            int width, int height,
+                                            GrPixelConfig config) {
+    // Reading the buffer back needs a map that can read, which ES only has with map buffer range.
+    const GrGLCaps::MapBufferType mapType = this->glCaps().mapBufferType();
+    if (!this->glCaps().pixelBufferSupport() || !this->glCaps().fenceSyncSupport() ||
+        !(GrGLCaps::kMapBufferRange_MapBufferType == mapType ||
+          (GrGLCaps::kMapBuffer_MapBufferType == mapType && kGL_GrGLStandard == this->glStandard())) ||
+        GrPixelConfigIsCompressed(config)) {
+        return NULL;
+    }
+    GrGLenum format = 0;
+    GrGLenum type = 0;
+    if (!this->configToGLFormats(config, false, NULL, &format, &type)) {
+        return NULL;
+    }
+
+    GrGLRenderTarget* tgt = static_cast<GrGLRenderTarget*>(target);
+    SkAutoTUnref<GrGLPixelReadback> readback(
+        SkNEW_ARGS(GrGLPixelReadback, (this, width, height, config,
+                                       kBottomLeft_GrSurfaceOrigin == target->origin())));
+    if (!readback->isValid()) {
+        return NULL;
+    }
+    GrDrawState::AutoRenderTargetRestore artr;
+    if (!this->bindReadRenderTarget(tgt, &artr)) {
+        return NULL;
+    }
+
+    // the read rect is viewport-relative
+    GrGLIRect readRect;
+    readRect.setRelativeTo(tgt->getViewport(), left, top, width, height, target->origin());
+    readback->issue(readRect, format, type);
+    return readback.detach();
+}
+
+bool GrGpuGL::bindReadRenderTarget(GrGLRenderTarget* tgt,
+                                   GrDrawState::AutoRenderTargetRestore* artr) {
+    switch (tgt->getResolveType()) {
+        case GrGLRenderTarget::kCantResolve_ResolveType:
+            return false;
+        case GrGLRenderTarget::kAutoResolves_ResolveType:
+            artr->set(this->drawState(), tgt);
+            this->flushRenderTarget(&SkIRect::EmptyIRect());
+            break;
+        case GrGLRenderTarget::kCanResolve_ResolveType:
+            this->onResolveRenderTarget(tgt);
+            // we don't track the state of the READ FBO ID.
+            GL_CALL(BindFramebuffer(GR_GL_READ_FRAMEBUFFER,
+                                    tgt->textureFBOID()));
+            break;
+        default:
+            SkFAIL("Unknown resolve type");
+    }
+    return true;
+}
+
 void GrGpuGL::flushRenderTarget(const SkIRect* bound) {
 
     GrGLRenderTarget* rt =
@@ -1790,7 +2005,13 @@ void GrGpuGL::onGpuDraw(const DrawInfo& info) {
 
     SkASSERT((size_t)info.primitiveType() < SK_ARRAY_COUNT(gPrimitiveType2GLMode));
 
-    if (info.isIndexed()) {
+    if (info.isHWInstanced()) {
+        // The instance attributes were offset by setupGeometry to start at info.startVertex().
+        GL_CALL(DrawArraysInstanced(gPrimitiveType2GLMode[info.primitiveType()],
+                                    0,
+                                    info.unitVertexCount(),
+                                    info.vertexCount()));
+    } else if (info.isIndexed()) {
         GrGLvoid* indices =
             reinterpret_cast<GrGLvoid*>(indexOffsetInBytes + sizeof(uint16_t) * info.startIndex());
         // info.startVertex() was accounted for by setupGeometry.
@@ -2228,6 +2449,7 @@ void GrGpuGL::flushBlend(bool isLines,
             GL_CALL(Enable(GR_GL_BLEND));
             fHWBlendState.fEnabled = kYes_TriState;
         }
+        this->flushBlendEquation(kAdd_GrBlendEquation);
         if (kSA_GrBlendCoeff != fHWBlendState.fSrcCoeff ||
             kISA_GrBlendCoeff != fHWBlendState.fDstCoeff) {
             GL_CALL(BlendFunc(gXfermodeCoeff2Blend[kSA_GrBlendCoeff],
@@ -2235,6 +2457,19 @@ void GrGpuGL::flushBlend(bool isLines,
             fHWBlendState.fSrcCoeff = kSA_GrBlendCoeff;
             fHWBlendState.fDstCoeff = kISA_GrBlendCoeff;
         }
+    } else if (GrBlendEquationIsAdvanced(this->getDrawState().getBlendEquation()) &&
+               !this->getDrawState().isColorWriteDisabled()) {
+        // The advanced equations ignore the coeffs.
+        if (kYes_TriState != fHWBlendState.fEnabled) {
+            GL_CALL(Enable(GR_GL_BLEND));
+            fHWBlendState.fEnabled = kYes_TriState;
+        }
+        this->flushBlendEquation(this->getDrawState().getBlendEquation());
+        // Without coherent blending the results of overlapping draws are undefined unless each
+        // draw is separated from the previous ones by a barrier.
+        if (GrGLCaps::kAdvanced_BlendEquationSupport == this->glCaps().blendEquationSupport()) {
+            GL_CALL(BlendBarrier());
+        }
     } else {
         // any optimization to disable blending should
         // have already been applied and tweaked the coeffs
@@ -2251,6 +2486,7 @@ void GrGpuGL::flushBlend(bool isLines,
                 GL_CALL(Enable(GR_GL_BLEND));
                 fHWBlendState.fEnabled = kYes_TriState;
             }
+            this->flushBlendEquation(kAdd_GrBlendEquation);
             if (fHWBlendState.fSrcCoeff != srcCoeff ||
                 fHWBlendState.fDstCoeff != dstCoeff) {
                 GL_CALL(BlendFunc(gXfermodeCoeff2Blend[srcCoeff],
@@ -2273,6 +2509,45 @@ void GrGpuGL::flushBlend(bool isLines,
     }
 }
 
+void GrGpuGL::flushBlendEquation(GrBlendEquation equation) {
+    static const GrGLenum gEquation2GL[] = {
+        GR_GL_FUNC_ADD,
+        GR_GL_MULTIPLY,
+        GR_GL_SCREEN,
+        GR_GL_OVERLAY,
+        GR_GL_DARKEN,
+        GR_GL_LIGHTEN,
+        GR_GL_COLORDODGE,
+        GR_GL_COLORBURN,
+        GR_GL_HARDLIGHT,
+        GR_GL_SOFTLIGHT,
+        GR_GL_DIFFERENCE,
+        GR_GL_EXCLUSION,
+        GR_GL_HSL_HUE,
+        GR_GL_HSL_SATURATION,
+        GR_GL_HSL_COLOR,
+        GR_GL_HSL_LUMINOSITY,
+    };
+    GR_STATIC_ASSERT(0 == kAdd_GrBlendEquation);
+    GR_STATIC_ASSERT(1 == kMultiply_GrBlendEquation);
+    GR_STATIC_ASSERT(10 == kDifference_GrBlendEquation);
+    GR_STATIC_ASSERT(15 == kHSLLuminosity_GrBlendEquation);
+    GR_STATIC_ASSERT(SK_ARRAY_COUNT(gEquation2GL) == kGrBlendEquationCnt);
+
+    if (fHWBlendState.fEquationValid && fHWBlendState.fEquation == equation) {
+        return;
+    }
+    // Contexts without blend equation support can only be in the default state.
+    if (NULL == this->glInterface()->fFunctions.fBlendEquation) {
+        SkASSERT(kAdd_GrBlendEquation == equation);
+        return;
+    }
+    SkASSERT(!GrBlendEquationIsAdvanced(equation) || this->caps()->advancedBlendEquationSupport());
+    GL_CALL(BlendEquation(gEquation2GL[equation]));
+    fHWBlendState.fEquation = equation;
+    fHWBlendState.fEquationValid = true;
+}
+
 static inline GrGLenum tile_to_gl_wrap(SkShader::TileMode tm) {
     static const GrGLenum gWrapModes[] = {
         GR_GL_CLAMP_TO_EDGE,
@@ -2305,7 +2580,9 @@ void GrGpuGL::bindTexture(int unitIdx, const GrTextureParams& params, GrGLTextur
 
     ResetTimestamp timestamp;
     const GrGLTexture::TexParams& oldTexParams = texture->getCachedTexParams(&timestamp);
-    bool setAll = timestamp < this->getResetTimestamp();
+    // The parameters of a shared texture can be changed by the other contexts using it.
+    bool setAll = timestamp < this->getResetTimestamp() ||
+                  texture->isSetFlag((GrTextureFlags) GrTextureImpl::kSharedContent_FlagBit);
     GrGLTexture::TexParams newTexParams;
 
     static GrGLenum glMinFilterModes[] = {
@@ -2322,11 +2599,16 @@ void GrGpuGL::bindTexture(int unitIdx, const GrTextureParams& params, GrGLTextur
     if (!this->caps()->mipMapSupport() && GrTextureParams::kMipMap_FilterMode == filterMode) {
         filterMode = GrTextureParams::kBilerp_FilterMode;
     }
+    // We can't generate the levels of a compressed texture, and sampling a texture without them
+    // with a mipmap filter reads black.
+    if (GrPixelConfigIsCompressed(texture->config()) &&
+        GrTextureParams::kMipMap_FilterMode == filterMode) {
+        filterMode = GrTextureParams::kBilerp_FilterMode;
+    }
     newTexParams.fMinFilter = glMinFilterModes[filterMode];
     newTexParams.fMagFilter = glMagFilterModes[filterMode];
 
-    if (GrTextureParams::kMipMap_FilterMode == filterMode &&
-        texture->mipMapsAreDirty() && !GrPixelConfigIsCompressed(texture->config())) {
+    if (GrTextureParams::kMipMap_FilterMode == filterMode && texture->mipMapsAreDirty()) {
         GL_CALL(GenerateMipmap(GR_GL_TEXTURE_2D));
         texture->dirtyMipMaps(false);
     }
@@ -2694,6 +2976,9 @@ bool GrGpuGL::configToGLFormats(GrPixelConfig config,
                     break;
             }
             break;
+        case kR11_EAC_GrPixelConfig:
+            *internalFormat = GR_GL_COMPRESSED_R11;
+            break;
         default:
             return false;
     }
@@ -2976,38 +3261,77 @@ bool GrGpuGL::onCanCopySurface(GrSurface* dst,
     return INHERITED::onCanCopySurface(dst, src, srcRect, dstPoint);
 }
 
-void GrGpuGL::didAddGpuTraceMarker() {
+void GrGpuGL::didAddGpuTraceMarker(const GrGpuTraceMarker& marker) {
     if (this->caps()->gpuTracingSupport()) {
         const GrTraceMarkerSet& markerArray = this->getActiveTraceMarkers();
         SkString markerString = markerArray.toString();
         GL_CALL(PushGroupMarker(0, markerString.c_str()));
     }
+    // Markers with a negative ID are the ones GrInOrderDrawBuffer replays its commands under,
+    // which it times with beginTimedScope() instead.
+    if (marker.fID >= 0 && this->getContext()->isGpuTimingEnabled()) {
+        GrGLGpuTimer* timer = this->gpuTimer();
+        if (NULL != timer) {
+            timer->beginScope(marker.fMarker);
+        }
+    }
 }
 
-void GrGpuGL::didRemoveGpuTraceMarker() {
+void GrGpuGL::didRemoveGpuTraceMarker(const GrGpuTraceMarker& marker) {
     if (this->caps()->gpuTracingSupport()) {
         GL_CALL(PopGroupMarker());
     }
+    if (marker.fID >= 0 && this->getContext()->isGpuTimingEnabled()) {
+        this->endTimedScope();
+    }
 }
 ///////////////////////////////////////////////////////////////////////////////
 
 GrGLAttribArrayState* GrGpuGL::HWGeometryState::bindArrayAndBuffersToDraw(
                                                 GrGpuGL* gpu,
+                                                const GrGLVertexArrayKey& key,
                                                 const GrGLVertexBuffer* vbuffer,
-                                                const GrGLIndexBuffer* ibuffer) {
+                                                const GrGLVertexBuffer* unitBuffer,
+                                                const GrGLIndexBuffer* ibuffer,
+                                                GrGLVertexArray** vertexArray) {
     SkASSERT(NULL != vbuffer);
+    SkASSERT(NULL != vertexArray);
     GrGLAttribArrayState* attribState;
 
-    // We use a vertex array if we're on a core profile and the verts are in a VBO.
-    if (gpu->glCaps().isCoreProfile() && !vbuffer->isCPUBacked()) {
-        if (NULL == fVBOVertexArray || fVBOVertexArray->wasDestroyed()) {
-            SkSafeUnref(fVBOVertexArray);
+    // We use a vertex array if they are supported and the verts are in VBOs.
+    if (gpu->glCaps().vertexArrayObjectSupport() && !vbuffer->isCPUBacked() &&
+        (NULL == unitBuffer || !unitBuffer->isCPUBacked())) {
+        GrGLVertexArray* array = NULL;
+        int index = 0;
+        for (; index < fVertexArrays.count(); ++index) {
+            if (fVertexArrays[index]->key() == key) {
+                array = fVertexArrays[index];
+                break;
+            }
+        }
+        if (NULL != array && array->wasDestroyed()) {
+            fVertexArrays.remove(index);
+            array->unref();
+            array = NULL;
+        }
+        if (NULL == array) {
+            if (fVertexArrays.count() >= kMaxVertexArrays) {
+                GrGLVertexArray* oldest;
+                fVertexArrays.pop(&oldest);
+                oldest->release();
+                oldest->unref();
+            }
             GrGLuint arrayID;
             GR_GL_CALL(gpu->glInterface(), GenVertexArrays(1, &arrayID));
             int attrCount = gpu->glCaps().maxVertexAttributes();
-            fVBOVertexArray = SkNEW_ARGS(GrGLVertexArray, (gpu, arrayID, attrCount));
-        }
-        attribState = fVBOVertexArray->bindWithIndexBuffer(ibuffer);
+            array = SkNEW_ARGS(GrGLVertexArray, (gpu, arrayID, attrCount, key));
+            *fVertexArrays.insert(0) = array;
+        } else if (index > 0) {
+            fVertexArrays.remove(index);
+            *fVertexArrays.insert(0) = array;
+        }
+        attribState = array->bindWithIndexBuffer(ibuffer);
+        *vertexArray = array;
     } else {
         if (NULL != ibuffer) {
             this->setIndexBufferIDOnDefaultVertexArray(gpu, ibuffer->bufferID());
@@ -3019,6 +3343,22 @@ GrGLAttribArrayState* GrGpuGL::HWGeometryState::bindArrayAndBuffersToDraw(
             fDefaultVertexArrayAttribState.resize(attrCount);
         }
         attribState = &fDefaultVertexArrayAttribState;
+        *vertexArray = NULL;
     }
     return attribState;
 }
+
+void GrGpuGL::HWGeometryState::purgeVertexArrays(GrGLuint bufferID, bool isIndexBuffer) {
+    // The deleted ID may be handed out again for a new buffer, so arrays that still refer to it
+    // must not be found by a later key.
+    for (int i = fVertexArrays.count() - 1; i >= 0; --i) {
+        GrGLVertexArray* array = fVertexArrays[i];
+        const GrGLVertexArrayKey& key = array->key();
+        if (isIndexBuffer ? bufferID == key.fIndexBufferID : key.usesBuffer(bufferID)) {
+            // Remove it before releasing, which calls back into notifyVertexArrayDelete.
+            fVertexArrays.remove(i);
+            array->release();
+            array->unref();
+        }
+    }
+}
@@ -20,13 +20,17 @@
 #include "GrGLVertexBuffer.h"
 #include "GrGpu.h"
 #include "GrTHashTable.h"
+#include "SkCacheCounters.h"
+#include "SkTDArray.h"
 #include "SkTypes.h"
 
 #ifdef SK_DEVELOPER
 #define PROGRAM_CACHE_STATS
 #endif
 
+class GrGLGpuTimer;
 class GrGLNameAllocator;
+class GrGLPixelUploadRing;
 
 class GrGpuGL : public GrGpu {
 public:
@@ -82,6 +86,17 @@ public:
 
     virtual void abandonResources() SK_OVERRIDE;
 
+    virtual GrFence insertFence() SK_OVERRIDE;
+    virtual bool waitFence(GrFence) SK_OVERRIDE;
+    virtual void deleteFence(GrFence) SK_OVERRIDE;
+    virtual GrFence flushForSharing() SK_OVERRIDE;
+
+    virtual void beginTimedScope(const GrTraceMarkerSet&) SK_OVERRIDE;
+    virtual void endTimedScope() SK_OVERRIDE;
+    virtual void endTimingFrame() SK_OVERRIDE;
+    virtual bool getTimingFrame(SkTArray<GrContext::GpuScopeTime>*) const SK_OVERRIDE;
+    virtual void getProgramCacheCounters(SkCacheCounters*) const SK_OVERRIDE;
+
     // These functions should be used to bind GL objects. They track the GL state and skip redundant
     // bindings. Making the equivalent glBind calls directly will confuse the state tracking.
     void bindVertexArray(GrGLuint id) {
@@ -133,8 +148,12 @@ private:
                                        size_t rowBytes) SK_OVERRIDE;
     virtual GrTexture* onCreateCompressedTexture(const GrTextureDesc& desc,
                                                  const void* srcData) SK_OVERRIDE;
-    virtual GrVertexBuffer* onCreateVertexBuffer(size_t size, bool dynamic) SK_OVERRIDE;
-    virtual GrIndexBuffer* onCreateIndexBuffer(size_t size, bool dynamic) SK_OVERRIDE;
+    virtual GrVertexBuffer* onCreateVertexBuffer(size_t size,
+                                                 bool dynamic,
+                                                 bool streaming) SK_OVERRIDE;
+    virtual GrIndexBuffer* onCreateIndexBuffer(size_t size,
+                                               bool dynamic,
+                                               bool streaming) SK_OVERRIDE;
     virtual GrPath* onCreatePath(const SkPath&, const SkStrokeRec&) SK_OVERRIDE;
     virtual GrTexture* onWrapBackendTexture(const GrBackendTextureDesc&) SK_OVERRIDE;
     virtual GrRenderTarget* onWrapBackendRenderTarget(const GrBackendRenderTargetDesc&) SK_OVERRIDE;
@@ -154,6 +173,11 @@ private:
                               void* buffer,
                               size_t rowBytes) SK_OVERRIDE;
 
+    virtual GrPixelReadback* onBeginReadPixels(GrRenderTarget* target,
+                                               int left, int top,
+                                               int width, int height,
+                                               GrPixelConfig) SK_OVERRIDE;
+
     virtual bool onWriteTexturePixels(GrTexture* texture,
                                       int left, int top, int width, int height,
                                       GrPixelConfig config, const void* buffer,
@@ -175,8 +199,8 @@ private:
     virtual bool flushGraphicsState(DrawType, const GrDeviceCoordTexture* dstCopy) SK_OVERRIDE;
 
     // GrDrawTarget ovverides
-    virtual void didAddGpuTraceMarker() SK_OVERRIDE;
-    virtual void didRemoveGpuTraceMarker() SK_OVERRIDE;
+    virtual void didAddGpuTraceMarker(const GrGpuTraceMarker&) SK_OVERRIDE;
+    virtual void didRemoveGpuTraceMarker(const GrGpuTraceMarker&) SK_OVERRIDE;
 
     // binds texture unit in GL
     void setTextureUnit(int unitIdx);
@@ -191,6 +215,7 @@ private:
     // (after any blending optimizations or dual source blending considerations
     // have been accounted for).
     void flushBlend(bool isLines, GrBlendCoeff srcCoeff, GrBlendCoeff dstCoeff);
+    void flushBlendEquation(GrBlendEquation equation);
 
     bool hasExtension(const char* ext) const { return fGLContext.hasExtension(ext); }
 
@@ -206,6 +231,8 @@ private:
                                 const GrEffectStage* colorStages[],
                                 const GrEffectStage* coverageStages[]);
 
+        const SkCacheCounters& counters() const { return fCounters; }
+
     private:
         enum {
             // We may actually have kMaxEntries+1 shaders in the GL context because we create a new
@@ -231,9 +258,8 @@ private:
         int                         fCount;
         unsigned int                fCurrLRUStamp;
         GrGpuGL*                    fGpu;
+        SkCacheCounters             fCounters;
 #ifdef PROGRAM_CACHE_STATS
-        int                         fTotalRequests;
-        int                         fCacheMisses;
         int                         fHashMisses; // cache hit but hash table missed
 #endif
     };
@@ -257,6 +283,10 @@ private:
     // bound is region that may be modified and therefore has to be resolved.
     // NULL means whole target. Can be an empty rect.
     void flushRenderTarget(const SkIRect* bound);
+
+    // Binds the render target for reading, resolving it first if need be. Returns false if it
+    // can't be read.
+    bool bindReadRenderTarget(GrGLRenderTarget*, GrDrawState::AutoRenderTargetRestore*);
     void flushStencil(DrawType);
     void flushAAState(DrawType);
     void flushPathStencilSettings(SkPath::FillType fill);
@@ -274,6 +304,13 @@ private:
                        const void* data,
                        size_t rowBytes);
 
+    // Returns the ring that uploadTexData stages large uploads through, or NULL if the GL can't
+    // upload from buffers (or we failed to allocate one).
+    GrGLPixelUploadRing* pixelUploadRing();
+
+    // Returns the timer for trace marker scopes, or NULL if the GL has no timer queries.
+    GrGLGpuTimer* gpuTimer();
+
     // helper for onCreateCompressedTexture. If width and height are
     // set to -1, then this function will use desc.fWidth and desc.fHeight
     // for the size of the data. The isNewTexture flag should be set to true
@@ -327,9 +364,9 @@ private:
      */
     class HWGeometryState {
     public:
-        HWGeometryState() { fVBOVertexArray = NULL; this->invalidate(); }
+        HWGeometryState() { this->invalidate(); }
 
-        ~HWGeometryState() { SkSafeUnref(fVBOVertexArray); }
+        ~HWGeometryState() { fVertexArrays.unrefAll(); }
 
         void invalidate() {
             fBoundVertexArrayIDIsValid = false;
@@ -337,8 +374,8 @@ private:
             fDefaultVertexArrayBoundIndexBufferID = false;
             fDefaultVertexArrayBoundIndexBufferIDIsValid = false;
             fDefaultVertexArrayAttribState.invalidate();
-            if (NULL != fVBOVertexArray) {
-                fVBOVertexArray->invalidateCachedState();
+            for (int i = 0; i < fVertexArrays.count(); ++i) {
+                fVertexArrays[i]->invalidateCachedState();
             }
         }
 
@@ -365,9 +402,7 @@ private:
             if (fBoundVertexBufferIDIsValid && id == fBoundVertexBufferID) {
                 fBoundVertexBufferID = 0;
             }
-            if (NULL != fVBOVertexArray) {
-                fVBOVertexArray->notifyVertexBufferDelete(id);
-            }
+            this->purgeVertexArrays(id, false);
             fDefaultVertexArrayAttribState.notifyVertexBufferDelete(id);
         }
 
@@ -376,9 +411,7 @@ private:
                 id == fDefaultVertexArrayBoundIndexBufferID) {
                 fDefaultVertexArrayBoundIndexBufferID = 0;
             }
-            if (NULL != fVBOVertexArray) {
-                fVBOVertexArray->notifyIndexBufferDelete(id);
-            }
+            this->purgeVertexArrays(id, true);
         }
 
         void setVertexBufferID(GrGpuGL* gpu, GrGLuint id) {
@@ -408,12 +441,23 @@ private:
          * The vertex array is bound and its attrib array state object is returned. The vertex
          * buffer is bound. The index buffer (if non-NULL) is bound to the vertex array. The
          * returned GrGLAttribArrayState should be used to set vertex attribute arrays.
+         *
+         * When vertex array objects are supported and the vertices are in VBOs, a vertex array is
+         * kept for each key and returned in vertexArray, so that repeated draws of the same
+         * geometry can skip setting up the attribs. Otherwise vertexArray is set to NULL and
+         * vertex array 0 is used.
          */
         GrGLAttribArrayState* bindArrayAndBuffersToDraw(GrGpuGL* gpu,
+                                                        const GrGLVertexArrayKey& key,
                                                         const GrGLVertexBuffer* vbuffer,
-                                                        const GrGLIndexBuffer* ibuffer);
+                                                        const GrGLVertexBuffer* unitBuffer,
+                                                        const GrGLIndexBuffer* ibuffer,
+                                                        GrGLVertexArray** vertexArray);
 
     private:
+        // Deletes the cached vertex arrays that draw from the buffer.
+        void purgeVertexArrays(GrGLuint bufferID, bool isIndexBuffer);
+
         GrGLuint                fBoundVertexArrayID;
         GrGLuint                fBoundVertexBufferID;
         bool                    fBoundVertexArrayIDIsValid;
@@ -426,11 +470,17 @@ private:
         // GrGpuGL.
         GrGLAttribArrayState    fDefaultVertexArrayAttribState;
 
-        // This is used when we're using a core profile and the vertices are in a VBO.
-        GrGLVertexArray*        fVBOVertexArray;
+        // These are used when vertex array objects are supported and the vertices are in VBOs,
+        // most recently used first. Bound to kMaxVertexArrays, dropping the least recently used.
+        enum {
+            kMaxVertexArrays = 16,
+        };
+        SkTDArray<GrGLVertexArray*> fVertexArrays;
     } fHWGeometryState;
 
     struct {
+        GrBlendEquation fEquation;
+        bool            fEquationValid;
         GrBlendCoeff    fSrcCoeff;
         GrBlendCoeff    fDstCoeff;
         GrColor         fConstColor;
@@ -438,6 +488,7 @@ private:
         TriState        fEnabled;
 
         void invalidate() {
+            fEquationValid = false;
             fSrcCoeff = kInvalid_GrBlendCoeff;
             fDstCoeff = kInvalid_GrBlendCoeff;
             fConstColorValid = false;
@@ -482,6 +533,10 @@ private:
 
     SkAutoTDelete<GrGLNameAllocator> fPathNameAllocator;
 
+    SkAutoTUnref<GrGLPixelUploadRing> fPixelUploadRing;
+
+    SkAutoTUnref<GrGLGpuTimer> fGpuTimer;
+
     typedef GrGpu INHERITED;
 };
 
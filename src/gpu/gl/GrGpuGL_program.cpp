@@ -45,8 +45,6 @@ GrGpuGL::ProgramCache::ProgramCache(GrGpuGL* gpu)
     , fCurrLRUStamp(0)
     , fGpu(gpu)
 #ifdef PROGRAM_CACHE_STATS
-    , fTotalRequests(0)
-    , fCacheMisses(0)
     , fHashMisses(0)
 #endif
 {
@@ -62,14 +60,16 @@ GrGpuGL::ProgramCache::~ProgramCache() {
     // dump stats
 #ifdef PROGRAM_CACHE_STATS
     if (c_DisplayCache) {
+        const int totalRequests = fCounters.fHits + fCounters.fMisses;
         SkDebugf("--- Program Cache ---\n");
-        SkDebugf("Total requests: %d\n", fTotalRequests);
-        SkDebugf("Cache misses: %d\n", fCacheMisses);
-        SkDebugf("Cache miss %%: %f\n", (fTotalRequests > 0) ?
-                                            100.f * fCacheMisses / fTotalRequests :
+        SkDebugf("Total requests: %d\n", totalRequests);
+        SkDebugf("Cache misses: %d\n", fCounters.fMisses);
+        SkDebugf("Cache miss %%: %f\n", (totalRequests > 0) ?
+                                            100.f * fCounters.fMisses / totalRequests :
                                             0.f);
-        int cacheHits = fTotalRequests - fCacheMisses;
-        SkDebugf("Hash miss %%: %f\n", (cacheHits > 0) ? 100.f * fHashMisses / cacheHits : 0.f);
+        SkDebugf("Evictions: %d\n", fCounters.fEvictions);
+        SkDebugf("Hash miss %%: %f\n", (fCounters.fHits > 0) ?
+                                           100.f * fHashMisses / fCounters.fHits : 0.f);
         SkDebugf("---------------------\n");
     }
 #endif
@@ -92,10 +92,6 @@ int GrGpuGL::ProgramCache::search(const GrGLProgramDesc& desc) const {
 GrGLProgram* GrGpuGL::ProgramCache::getProgram(const GrGLProgramDesc& desc,
                                                const GrEffectStage* colorStages[],
                                                const GrEffectStage* coverageStages[]) {
-#ifdef PROGRAM_CACHE_STATS
-    ++fTotalRequests;
-#endif
-
     Entry* entry = NULL;
 
     uint32_t hashIdx = desc.getChecksum();
@@ -123,9 +119,7 @@ GrGLProgram* GrGpuGL::ProgramCache::getProgram(const GrGLProgramDesc& desc,
 
     if (NULL == entry) {
         // We have a cache miss
-#ifdef PROGRAM_CACHE_STATS
-        ++fCacheMisses;
-#endif
+        fCounters.fMisses += 1;
         GrGLProgram* program = GrGLProgram::Create(fGpu, desc, colorStages, coverageStages);
         if (NULL == program) {
             return NULL;
@@ -144,6 +138,7 @@ GrGLProgram* GrGpuGL::ProgramCache::getProgram(const GrGLProgramDesc& desc,
                 }
             }
             entry = fEntries[purgeIdx];
+            fCounters.fEvictions += 1;
             int purgedHashIdx = entry->fProgram->getDesc().getChecksum() & ((1 << kHashBits) - 1);
             if (fHashTable[purgedHashIdx] == entry) {
                 fHashTable[purgedHashIdx] = NULL;
@@ -182,6 +177,8 @@ GrGLProgram* GrGpuGL::ProgramCache::getProgram(const GrGLProgramDesc& desc,
             SkASSERT(!GrGLProgramDesc::Less(b, a));
         }
 #endif
+    } else {
+        fCounters.fHits += 1;
     }
 
     fHashTable[hashIdx] = entry;
@@ -342,11 +339,35 @@ void GrGpuGL::setupGeometry(const DrawInfo& info, size_t* indexOffsetInBytes) {
         SkASSERT(!ibuf->isMapped());
         *indexOffsetInBytes += ibuf->baseOffset();
     }
+
+    // For hardware instanced draws the position comes from the unit geometry and everything
+    // else advances once per instance.
+    int positionAttribIndex = this->getDrawState().positionAttributeIndex();
+    GrGLVertexBuffer* unitBuf = (GrGLVertexBuffer*) info.unitGeometry();
+    SkASSERT(NULL == unitBuf || !unitBuf->isMapped());
+    GrGLuint divisor = info.isHWInstanced() ? 1 : 0;
+
+    int vertexAttribCount = this->getDrawState().getVertexAttribCount();
+    GrGLVertexArrayKey key;
+    key.set(vbuf->bufferID(),
+            NULL != ibuf ? ibuf->bufferID() : 0,
+            NULL != unitBuf ? unitBuf->bufferID() : 0,
+            positionAttribIndex,
+            divisor,
+            stride,
+            this->getDrawState().getVertexAttribs(),
+            vertexAttribCount);
+
+    GrGLVertexArray* vertexArray;
     GrGLAttribArrayState* attribState =
-        fHWGeometryState.bindArrayAndBuffersToDraw(this, vbuf, ibuf);
+        fHWGeometryState.bindArrayAndBuffersToDraw(this, key, vbuf, unitBuf, ibuf, &vertexArray);
+
+    // A vertex array that last drew this key from the same offset needs no further setup.
+    if (NULL != vertexArray && vertexArray->attribsAreSetAt(vertexOffsetInBytes)) {
+        return;
+    }
 
     if (fCurrentProgram->hasVertexShader()) {
-        int vertexAttribCount = this->getDrawState().getVertexAttribCount();
         uint32_t usedAttribArraysMask = 0;
         const GrVertexAttrib* vertexAttrib = this->getDrawState().getVertexAttribs();
 
@@ -355,6 +376,18 @@ void GrGpuGL::setupGeometry(const DrawInfo& info, size_t* indexOffsetInBytes) {
 
             usedAttribArraysMask |= (1 << vertexAttribIndex);
             GrVertexAttribType attribType = vertexAttrib->fType;
+            if (NULL != unitBuf && positionAttribIndex == vertexAttribIndex) {
+                attribState->set(this,
+                                 vertexAttribIndex,
+                                 unitBuf,
+                                 GrGLAttribTypeToLayout(attribType).fCount,
+                                 GrGLAttribTypeToLayout(attribType).fType,
+                                 GrGLAttribTypeToLayout(attribType).fNormalized,
+                                 static_cast<GrGLsizei>(GrVertexAttribTypeSize(attribType)),
+                                 reinterpret_cast<GrGLvoid*>(unitBuf->baseOffset()),
+                                 0);
+                continue;
+            }
             attribState->set(this,
                              vertexAttribIndex,
                              vbuf,
@@ -363,8 +396,12 @@ void GrGpuGL::setupGeometry(const DrawInfo& info, size_t* indexOffsetInBytes) {
                              GrGLAttribTypeToLayout(attribType).fNormalized,
                              stride,
                              reinterpret_cast<GrGLvoid*>(
-                                 vertexOffsetInBytes + vertexAttrib->fOffset));
+                                 vertexOffsetInBytes + vertexAttrib->fOffset),
+                             divisor);
         }
         attribState->disableUnusedArrays(this, usedAttribArraysMask);
+        if (NULL != vertexArray) {
+            vertexArray->setAttribsAreSetAt(vertexOffsetInBytes);
+        }
     }
 }
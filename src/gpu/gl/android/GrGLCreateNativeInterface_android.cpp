@@ -35,6 +35,7 @@ static GrGLInterface* create_es_interface(GrGLVersion version,
     functions->fBindTexture = glBindTexture;
     functions->fBindVertexArray = glBindVertexArrayOES;
     functions->fBlendColor = glBlendColor;
+    functions->fBlendEquation = glBlendEquation;
     functions->fBlendFunc = glBlendFunc;
     functions->fBufferData = glBufferData;
     functions->fBufferSubData = glBufferSubData;
@@ -225,6 +226,21 @@ static GrGLInterface* create_es_interface(GrGLVersion version,
         }
     }
 
+    if (extensions->has("GL_EXT_disjoint_timer_query")) {
+        functions->fGenQueries = (GrGLGenQueriesProc) eglGetProcAddress("glGenQueriesEXT");
+        functions->fDeleteQueries = (GrGLDeleteQueriesProc) eglGetProcAddress("glDeleteQueriesEXT");
+        functions->fQueryCounter = (GrGLQueryCounterProc) eglGetProcAddress("glQueryCounterEXT");
+        functions->fGetQueryObjectiv = (GrGLGetQueryObjectivProc) eglGetProcAddress("glGetQueryObjectivEXT");
+        functions->fGetQueryObjectui64v = (GrGLGetQueryObjectui64vProc) eglGetProcAddress("glGetQueryObjectui64vEXT");
+        if (NULL == functions->fGenQueries ||
+            NULL == functions->fDeleteQueries ||
+            NULL == functions->fQueryCounter ||
+            NULL == functions->fGetQueryObjectiv ||
+            NULL == functions->fGetQueryObjectui64v) {
+            extensions->remove("GL_EXT_disjoint_timer_query");
+        }
+    }
+
 #if GL_ES_VERSION_3_0
     functions->fInvalidateFramebuffer = glInvalidateFramebuffer;
     functions->fInvalidateSubFramebuffer = glInvalidateSubFramebuffer;
@@ -237,6 +253,40 @@ static GrGLInterface* create_es_interface(GrGLVersion version,
     functions->fInvalidateTexImage = (GrGLInvalidateTexImageProc) eglGetProcAddress("glInvalidateTexImage");
     functions->fInvalidateTexSubImage = (GrGLInvalidateTexSubImageProc) eglGetProcAddress("glInvalidateTexSubImage");
 
+    if (version >= GR_GL_VER(3,0)) {
+        functions->fGetProgramBinary = (GrGLGetProgramBinaryProc) eglGetProcAddress("glGetProgramBinary");
+        functions->fProgramBinary = (GrGLProgramBinaryProc) eglGetProcAddress("glProgramBinary");
+        functions->fProgramParameteri = (GrGLProgramParameteriProc) eglGetProcAddress("glProgramParameteri");
+    } else if (extensions->has("GL_OES_get_program_binary")) {
+        functions->fGetProgramBinary = (GrGLGetProgramBinaryProc) eglGetProcAddress("glGetProgramBinaryOES");
+        functions->fProgramBinary = (GrGLProgramBinaryProc) eglGetProcAddress("glProgramBinaryOES");
+    }
+
+    if (version >= GR_GL_VER(3,0)) {
+        functions->fFenceSync = (GrGLFenceSyncProc) eglGetProcAddress("glFenceSync");
+        functions->fClientWaitSync = (GrGLClientWaitSyncProc) eglGetProcAddress("glClientWaitSync");
+        functions->fDeleteSync = (GrGLDeleteSyncProc) eglGetProcAddress("glDeleteSync");
+    }
+
+    if (extensions->has("GL_EXT_buffer_storage")) {
+        functions->fBufferStorage = (GrGLBufferStorageProc) eglGetProcAddress("glBufferStorageEXT");
+    }
+
+    if (version >= GR_GL_VER(3,0)) {
+        functions->fDrawArraysInstanced = (GrGLDrawArraysInstancedProc) eglGetProcAddress("glDrawArraysInstanced");
+        functions->fVertexAttribDivisor = (GrGLVertexAttribDivisorProc) eglGetProcAddress("glVertexAttribDivisor");
+    }
+
+    if (extensions->has("GL_KHR_blend_equation_advanced")) {
+        functions->fBlendBarrier = (GrGLBlendBarrierProc) eglGetProcAddress("glBlendBarrierKHR");
+    } else if (extensions->has("GL_NV_blend_equation_advanced")) {
+        functions->fBlendBarrier = (GrGLBlendBarrierProc) eglGetProcAddress("glBlendBarrierNV");
+    }
+
+    if (extensions->has("GL_KHR_parallel_shader_compile")) {
+        functions->fMaxShaderCompilerThreads = (GrGLMaxShaderCompilerThreadsProc) eglGetProcAddress("glMaxShaderCompilerThreadsKHR");
+    }
+
     return interface;
 }
 
@@ -183,5 +183,10 @@ const GrGLInterface* GrGLCreateANGLEInterface() {
                                 functions->fGetString,
                                 functions->fGetStringi,
                                 functions->fGetIntegerv);
+
+    if (interface->fExtensions.has("GL_KHR_parallel_shader_compile")) {
+        functions->fMaxShaderCompilerThreads = (GrGLMaxShaderCompilerThreadsProc) eglGetProcAddress("glMaxShaderCompilerThreadsKHR");
+    }
+
     return interface;
 }
@@ -15,9 +15,8 @@
 #include "GrProgramObj.h"
 #include "GrTextureUnitObj.h"
 #include "GrVertexArrayObj.h"
+#include "SkTLS.h"
 
-GrDebugGL* GrDebugGL::gObj = NULL;
-int GrDebugGL::gStaticRefCount = 0;
 GrDebugGL::Create GrDebugGL::gFactoryFunc[kObjTypeCount] = {
     GrTextureObj::createGrTextureObj,
     GrBufferObj::createGrBufferObj,
@@ -29,6 +28,50 @@ GrDebugGL::Create GrDebugGL::gFactoryFunc[kObjTypeCount] = {
     GrVertexArrayObj::createGrVertexArrayObj,
 };
 
+namespace {
+
+struct ThreadInstance {
+    ThreadInstance() : fObj(NULL), fRefCount(0) {}
+
+    GrDebugGL*  fObj;
+    int         fRefCount;
+};
+
+void* create_thread_instance() { return SkNEW(ThreadInstance); }
+void delete_thread_instance(void* instance) { SkDELETE(static_cast<ThreadInstance*>(instance)); }
+
+ThreadInstance* thread_instance() {
+    return static_cast<ThreadInstance*>(SkTLS::Get(create_thread_instance,
+                                                   delete_thread_instance));
+}
+
+}  // namespace
+
+GrDebugGL* GrDebugGL::getInstance() {
+    ThreadInstance* instance = thread_instance();
+    // someone should admit to actually using this class
+    SkASSERT(0 < instance->fRefCount);
+
+    if (NULL == instance->fObj) {
+        instance->fObj = SkNEW(GrDebugGL);
+    }
+
+    return instance->fObj;
+}
+
+void GrDebugGL::staticRef() {
+    thread_instance()->fRefCount++;
+}
+
+void GrDebugGL::staticUnRef() {
+    ThreadInstance* instance = thread_instance();
+    SkASSERT(instance->fRefCount > 0);
+    instance->fRefCount--;
+    if (0 == instance->fRefCount) {
+        SkDELETE(instance->fObj);
+        instance->fObj = NULL;
+    }
+}
 
 GrDebugGL::GrDebugGL()
     : fPackRowLength(0)
@@ -88,31 +88,14 @@ public:
     }
     GrGLint getUnPackRowLength() const { return fUnPackRowLength; }
 
-    static GrDebugGL *getInstance() {
-        // someone should admit to actually using this class
-        SkASSERT(0 < gStaticRefCount);
-
-        if (NULL == gObj) {
-            gObj = SkNEW(GrDebugGL);
-        }
-
-        return gObj;
-    }
+    // Each thread has its own instance, so debug contexts on different threads don't share GL
+    // state. A debug context must be used on the thread that created it.
+    static GrDebugGL *getInstance();
 
     void report() const;
 
-    static void staticRef() {
-        gStaticRefCount++;
-    }
-
-    static void staticUnRef() {
-        SkASSERT(gStaticRefCount > 0);
-        gStaticRefCount--;
-        if (0 == gStaticRefCount) {
-            SkDELETE(gObj);
-            gObj = NULL;
-        }
-    }
+    static void staticRef();
+    static void staticUnRef();
 
 protected:
 
@@ -136,8 +119,6 @@ private:
 
     static Create gFactoryFunc[kObjTypeCount];
 
-    static GrDebugGL* gObj;
-    static int gStaticRefCount;
 
     // global store of all objects
     SkTArray<GrFakeRefObj *> fObjects;
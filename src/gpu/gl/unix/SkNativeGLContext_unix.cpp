@@ -6,6 +6,7 @@
  * found in the LICENSE file.
  */
 #include "gl/SkNativeGLContext.h"
+#include "SkThread.h"
 
 #include <GL/glu.h>
 
@@ -25,6 +26,8 @@ SkNativeGLContext::AutoContextRestore::~AutoContextRestore() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Guards the X error handler and ctxErrorOccurred while a context is created.
+SK_DECLARE_STATIC_MUTEX(gCreateContextMutex);
 static bool ctxErrorOccurred = false;
 static int ctxErrorHandler(Display *dpy, XErrorEvent *ev) {
     ctxErrorOccurred = true;
@@ -178,7 +181,9 @@ const GrGLInterface* SkNativeGLContext::createGLContext() {
     // Note this error handler is global.
     // All display connections in all threads of a process use the same
     // error handler, so be sure to guard against other threads issuing
-    // X commands while this code is running.
+    // X commands while this code is running. Contexts created on other
+    // threads wait until this one is done.
+    SkAutoMutexAcquire ama(gCreateContextMutex);
     ctxErrorOccurred = false;
     int (*oldHandler)(Display*, XErrorEvent*) =
         XSetErrorHandler(&ctxErrorHandler);
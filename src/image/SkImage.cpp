@@ -78,6 +78,14 @@ GrTexture* SkImage::getTexture() {
     return as_IB(this)->onGetTexture();
 }
 
+SkShader* SkImage::newShaderClamp() const {
+    return this->newShader(SkShader::kClamp_TileMode, SkShader::kClamp_TileMode);
+}
+
+SkShader* SkImage::newShader(SkShader::TileMode tileX, SkShader::TileMode tileY) const {
+    return as_IB(this)->onNewShader(tileX, tileY);
+}
+
 SkData* SkImage::encode(SkImageEncoder::Type type, int quality) const {
     SkBitmap bm;
     if (as_IB(this)->getROPixels(&bm)) {
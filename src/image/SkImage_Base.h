@@ -27,6 +27,9 @@ public:
 
     virtual GrTexture* onGetTexture() { return NULL; }
 
+    // Return a shader that draws the image's pixels in place, or NULL if it has none yet.
+    virtual SkShader* onNewShader(SkShader::TileMode, SkShader::TileMode) const { return NULL; }
+
     // return a read-only copy of the pixels. We promise to not modify them,
     // but only inspect them (or encode them).
     virtual bool getROPixels(SkBitmap*) const { return false; }
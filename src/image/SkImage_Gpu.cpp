@@ -11,6 +11,7 @@
 #include "SkCanvas.h"
 #include "GrContext.h"
 #include "GrTexture.h"
+#include "SkGr.h"
 #include "SkGrPixelRef.h"
 
 class SkImage_Gpu : public SkImage_Base {
@@ -23,6 +24,7 @@ public:
     virtual void onDraw(SkCanvas*, SkScalar x, SkScalar y, const SkPaint*) SK_OVERRIDE;
     virtual void onDrawRectToRect(SkCanvas*, const SkRect* src, const SkRect& dst, const SkPaint*) SK_OVERRIDE;
     virtual GrTexture* onGetTexture() SK_OVERRIDE;
+    virtual SkShader* onNewShader(SkShader::TileMode, SkShader::TileMode) const SK_OVERRIDE;
     virtual bool getROPixels(SkBitmap*) const SK_OVERRIDE;
 
     GrTexture* getTexture() { return fBitmap.getTexture(); }
@@ -58,6 +60,10 @@ GrTexture* SkImage_Gpu::onGetTexture() {
     return fBitmap.getTexture();
 }
 
+SkShader* SkImage_Gpu::onNewShader(SkShader::TileMode tileX, SkShader::TileMode tileY) const {
+    return SkShader::CreateBitmapShader(fBitmap, tileX, tileY);
+}
+
 bool SkImage_Gpu::getROPixels(SkBitmap* dst) const {
     return fBitmap.copyTo(dst, kN32_SkColorType);
 }
@@ -72,6 +78,33 @@ SkImage* SkImage::NewTexture(const SkBitmap& bitmap) {
     return SkNEW_ARGS(SkImage_Gpu, (bitmap));
 }
 
+SkImage* SkImage::NewFromTexture(GrContext* context, const GrBackendTextureDesc& desc,
+                                 SkAlphaType alphaType, TextureReleaseProc releaseProc,
+                                 void* releaseContext) {
+    SkColorType colorType;
+    GrTexture* texture = NULL;
+    if (NULL != context && desc.fWidth > 0 && desc.fHeight > 0 &&
+        GrPixelConfig2ColorType(desc.fConfig, &colorType)) {
+        texture = context->wrapBackendTexture(desc);
+    }
+    if (NULL == texture) {
+        if (NULL != releaseProc) {
+            releaseProc(releaseContext);
+        }
+        return NULL;
+    }
+    SkAutoTUnref<GrTexture> autoUnref(texture);
+    texture->setRelease(releaseProc, releaseContext);
+
+    const SkImageInfo info = SkImageInfo::Make(desc.fWidth, desc.fHeight, colorType, alphaType);
+    SkBitmap bitmap;
+    bitmap.setInfo(info);
+    bitmap.setPixelRef(SkNEW_ARGS(SkGrPixelRef, (info, texture)))->unref();
+    // Pictures deep copy mutable bitmaps, which for a texture means reading it back.
+    bitmap.setImmutable();
+    return SkNEW_ARGS(SkImage_Gpu, (bitmap));
+}
+
 GrTexture* SkTextureImageGetTexture(SkImage* image) {
     return ((SkImage_Gpu*)image)->getTexture();
 }
@@ -57,6 +57,7 @@ public:
     virtual void onDrawRectToRect(SkCanvas*, const SkRect*, const SkRect&, const SkPaint*) SK_OVERRIDE;
     virtual bool onReadPixels(SkBitmap*, const SkIRect&) const SK_OVERRIDE;
     virtual const void* onPeekPixels(SkImageInfo*, size_t* /*rowBytes*/) const SK_OVERRIDE;
+    virtual SkShader* onNewShader(SkShader::TileMode, SkShader::TileMode) const SK_OVERRIDE;
     virtual bool getROPixels(SkBitmap*) const SK_OVERRIDE;
 
     // exposed for SkSurface_Raster via SkNewImageFromPixelRef
@@ -143,6 +144,11 @@ const void* SkImage_Raster::onPeekPixels(SkImageInfo* infoPtr,
     return fBitmap.getPixels();
 }
 
+SkShader* SkImage_Raster::onNewShader(SkShader::TileMode tileX,
+                                      SkShader::TileMode tileY) const {
+    return SkShader::CreateBitmapShader(fBitmap, tileX, tileY);
+}
+
 bool SkImage_Raster::getROPixels(SkBitmap* dst) const {
     *dst = fBitmap;
     return true;
@@ -189,6 +195,44 @@ SkImage* SkImage::NewRasterData(const SkImageInfo& info, SkData* data, size_t ro
     return SkNEW_ARGS(SkImage_Raster, (info, data, rowBytes));
 }
 
+namespace {
+struct RasterRelease {
+    SkImage::RasterReleaseProc  fProc;
+    void*                       fContext;
+};
+}
+
+static void release_raster(const void* pixels, size_t, void* context) {
+    RasterRelease* release = static_cast<RasterRelease*>(context);
+    release->fProc(pixels, release->fContext);
+    SkDELETE(release);
+}
+
+SkImage* SkImage::NewFromPixels(const SkImageInfo& info, const void* pixels, size_t rowBytes,
+                                RasterReleaseProc releaseProc, void* releaseContext) {
+    const bool valid = SkImage_Raster::ValidArgs(info, rowBytes);
+    const bool empty = 0 == info.fWidth && 0 == info.fHeight;
+    if (!valid || empty || NULL == pixels) {
+        if (NULL != releaseProc) {
+            releaseProc(pixels, releaseContext);
+        }
+        return valid && empty ? SkImage_Raster::NewEmpty() : NULL;
+    }
+
+    // The data only wraps the caller's pixels, and lets the image (and any bitmap drawn from
+    // it) keep them alive the way it keeps any other SkData alive.
+    SkData::ReleaseProc proc = NULL;
+    RasterRelease* release = NULL;
+    if (NULL != releaseProc) {
+        proc = release_raster;
+        release = SkNEW(RasterRelease);
+        release->fProc = releaseProc;
+        release->fContext = releaseContext;
+    }
+    SkAutoDataUnref data(SkData::NewWithProc(pixels, info.fHeight * rowBytes, proc, release));
+    return SkNEW_ARGS(SkImage_Raster, (info, data, rowBytes));
+}
+
 SkImage* SkNewImageFromPixelRef(const SkImageInfo& info, SkPixelRef* pr,
                                 size_t rowBytes) {
     return SkNEW_ARGS(SkImage_Raster, (info, pr, rowBytes));
@@ -11,14 +11,20 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Past this many intervals, the damage is simplified to its bounds. Presenting a few more
+// pixels is cheaper than unioning into, and presenting, a region of many small rects.
+static const int kMaxDamageComplexity = 32;
+
 SkSurface_Base::SkSurface_Base(int width, int height) : INHERITED(width, height) {
     fCachedCanvas = NULL;
     fCachedImage = NULL;
+    fTracksDamage = false;
 }
 
 SkSurface_Base::SkSurface_Base(const SkImageInfo& info) : INHERITED(info) {
     fCachedCanvas = NULL;
     fCachedImage = NULL;
+    fTracksDamage = false;
 }
 
 SkSurface_Base::~SkSurface_Base() {
@@ -40,9 +46,32 @@ void SkSurface_Base::onDraw(SkCanvas* canvas, SkScalar x, SkScalar y,
     }
 }
 
-void SkSurface_Base::aboutToDraw(ContentChangeMode mode) {
+const void* SkSurface_Base::onPeekPixels(SkImageInfo* info, size_t* rowBytes) {
+    return this->getCachedCanvas()->peekPixels(info, rowBytes);
+}
+
+void SkSurface_Base::addDamage(const SkIRect* dirtyBounds) {
+    SkIRect damage = SkIRect::MakeWH(this->width(), this->height());
+    if (NULL != dirtyBounds && !damage.intersect(*dirtyBounds)) {
+        return;
+    }
+    // Repeated draws into the same area, like a blinking cursor, are the common case.
+    if (fDamage.contains(damage)) {
+        return;
+    }
+    fDamage.op(damage, SkRegion::kUnion_Op);
+    if (fDamage.computeRegionComplexity() > kMaxDamageComplexity) {
+        fDamage.setRect(fDamage.getBounds());
+    }
+}
+
+void SkSurface_Base::aboutToDraw(ContentChangeMode mode, const SkIRect* dirtyBounds) {
     this->dirtyGenerationID();
 
+    if (fTracksDamage) {
+        this->addDamage(dirtyBounds);
+    }
+
     SkASSERT(!fCachedCanvas || fCachedCanvas->getSurfaceBase() == this);
 
     if (NULL != fCachedImage) {
@@ -60,6 +89,8 @@ void SkSurface_Base::aboutToDraw(ContentChangeMode mode) {
     } else if (kDiscard_ContentChangeMode == mode) {
         this->onDiscard();
     }
+
+    this->onAboutToDraw(mode, dirtyBounds);
 }
 
 uint32_t SkSurface_Base::newGenerationID() {
@@ -72,6 +103,10 @@ static SkSurface_Base* asSB(SkSurface* surface) {
     return static_cast<SkSurface_Base*>(surface);
 }
 
+static const SkSurface_Base* asSB(const SkSurface* surface) {
+    return static_cast<const SkSurface_Base*>(surface);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SkSurface::SkSurface(int width, int height) : fWidth(width), fHeight(height) {
@@ -120,5 +155,22 @@ void SkSurface::draw(SkCanvas* canvas, SkScalar x, SkScalar y,
 }
 
 const void* SkSurface::peekPixels(SkImageInfo* info, size_t* rowBytes) {
-    return this->getCanvas()->peekPixels(info, rowBytes);
+    return asSB(this)->onPeekPixels(info, rowBytes);
+}
+
+void SkSurface::setTracksDamage(bool tracksDamage) {
+    asSB(this)->fTracksDamage = tracksDamage;
+    asSB(this)->fDamage.setEmpty();
+}
+
+bool SkSurface::tracksDamage() const {
+    return asSB(this)->fTracksDamage;
+}
+
+const SkRegion& SkSurface::damage() const {
+    return asSB(this)->fDamage;
+}
+
+void SkSurface::resetDamage() {
+    asSB(this)->fDamage.setEmpty();
 }
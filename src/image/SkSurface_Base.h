@@ -10,6 +10,8 @@
 
 #include "SkSurface.h"
 #include "SkCanvas.h"
+#include "SkImage.h"
+#include "SkRegion.h"
 
 class SkSurface_Base : public SkSurface {
 public:
@@ -46,6 +48,13 @@ public:
      */
     virtual void onDraw(SkCanvas*, SkScalar x, SkScalar y, const SkPaint*);
 
+    /**
+     *  Default implementation returns the pixels of the cached canvas, if any.
+     *  Surfaces whose canvas does not draw directly into their pixels override
+     *  this.
+     */
+    virtual const void* onPeekPixels(SkImageInfo*, size_t* rowBytes);
+
     /**
      * Called as a performance hint when the Surface is allowed to make it's contents
      * undefined.
@@ -59,17 +68,42 @@ public:
      */
     virtual void onCopyOnWrite(ContentChangeMode) = 0;
 
+    /**
+     *  Called on every draw, after any copy-on-write, with the bounds of the
+     *  pixels the draw may change, or NULL if it may change any of them.
+     *  Surfaces that copy-on-write lazily copy those pixels here, unless the
+     *  mode is kDiscard_ContentChangeMode.
+     */
+    virtual void onAboutToDraw(ContentChangeMode, const SkIRect* dirtyBounds) {}
+
+    /**
+     *  Called before the surface's pixels are read or handed out through its
+     *  canvas, so that lazily copied pixels can be completed.
+     */
+    virtual void onAboutToRead() {}
+
     inline SkCanvas* getCachedCanvas();
     inline SkImage* getCachedImage();
 
     // called by SkSurface to compute a new genID
     uint32_t newGenerationID();
 
+    // True if someone other than us holds on to the image of our current
+    // contents, so that drawing would copy-on-write.
+    bool outstandingImageSnapshot() const {
+        return NULL != fCachedImage && !fCachedImage->unique();
+    }
+
 private:
     SkCanvas*   fCachedCanvas;
     SkImage*    fCachedImage;
 
-    void aboutToDraw(ContentChangeMode mode);
+    bool        fTracksDamage;
+    SkRegion    fDamage;
+
+    void addDamage(const SkIRect* dirtyBounds);
+    void aboutToDraw(ContentChangeMode mode, const SkIRect* dirtyBounds = NULL);
+    void aboutToRead() { this->onAboutToRead(); }
     friend class SkCanvas;
     friend class SkSurface;
 
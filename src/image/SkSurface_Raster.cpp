@@ -10,9 +10,13 @@
 #include "SkCanvas.h"
 #include "SkDevice.h"
 #include "SkMallocPixelRef.h"
+#include "SkTDArray.h"
 
 static const size_t kIgnoreRowBytesValue = (size_t)~0;
 
+// The size of the squares in which a copy-on-write copies the pixels the surface forked from.
+static const int kCopyTileSize = 64;
+
 class SkSurface_Raster : public SkSurface_Base {
 public:
     static bool Valid(const SkImageInfo&, size_t rb = kIgnoreRowBytesValue);
@@ -26,11 +30,26 @@ public:
     virtual void onDraw(SkCanvas*, SkScalar x, SkScalar y,
                         const SkPaint*) SK_OVERRIDE;
     virtual void onCopyOnWrite(ContentChangeMode) SK_OVERRIDE;
+    virtual void onAboutToDraw(ContentChangeMode, const SkIRect* dirtyBounds) SK_OVERRIDE;
+    virtual void onAboutToRead() SK_OVERRIDE;
 
 private:
     SkBitmap    fBitmap;
     bool        fWeOwnThePixels;
 
+    // A copy-on-write gives the surface new pixels without copying anything into them. The
+    // contents it forked from, still held by the snapshot, are copied a tile at a time as draws
+    // first touch them, and all at once before anyone else looks at fBitmap. Draws that replace
+    // all of the contents (kDiscard_ContentChangeMode) skip whatever is left to copy.
+    SkBitmap            fCopySource;        // empty unless tiles are left to copy
+    SkTDArray<bool>     fTileNeedsCopy;
+    int                 fTileColumns;
+    int                 fTilesLeftToCopy;
+
+    void copyTiles(const SkIRect& bounds);
+    void copyAllTiles();
+    void dropTilesLeftToCopy();
+
     typedef SkSurface_Base INHERITED;
 };
 
@@ -81,6 +100,8 @@ SkSurface_Raster::SkSurface_Raster(const SkImageInfo& info, void* pixels, size_t
 {
     fBitmap.installPixels(info, pixels, rb);
     fWeOwnThePixels = false;    // We are "Direct"
+    fTileColumns = 0;
+    fTilesLeftToCopy = 0;
 }
 
 SkSurface_Raster::SkSurface_Raster(SkPixelRef* pr)
@@ -91,6 +112,8 @@ SkSurface_Raster::SkSurface_Raster(SkPixelRef* pr)
     fBitmap.setInfo(info, info.minRowBytes());
     fBitmap.setPixelRef(pr);
     fWeOwnThePixels = true;
+    fTileColumns = 0;
+    fTilesLeftToCopy = 0;
 
     if (!info.isOpaque()) {
         fBitmap.eraseColor(SK_ColorTRANSPARENT);
@@ -107,10 +130,12 @@ SkSurface* SkSurface_Raster::onNewSurface(const SkImageInfo& info) {
 
 void SkSurface_Raster::onDraw(SkCanvas* canvas, SkScalar x, SkScalar y,
                               const SkPaint* paint) {
+    this->copyAllTiles();
     canvas->drawBitmap(fBitmap, x, y, paint);
 }
 
 SkImage* SkSurface_Raster::onNewImageSnapshot() {
+    this->copyAllTiles();
     return SkNewImageFromBitmap(fBitmap, fWeOwnThePixels);
 }
 
@@ -119,21 +144,92 @@ void SkSurface_Raster::onCopyOnWrite(ContentChangeMode mode) {
     SkASSERT(NULL != this->getCachedImage());
     if (SkBitmapImageGetPixelRef(this->getCachedImage()) == fBitmap.pixelRef()) {
         SkASSERT(fWeOwnThePixels);
-        if (kDiscard_ContentChangeMode == mode) {
-            fBitmap.setPixelRef(NULL);
-            fBitmap.allocPixels();
-        } else {
-            SkBitmap prev(fBitmap);
+        // The snapshot was taken of complete contents.
+        SkASSERT(0 == fTilesLeftToCopy);
+        SkBitmap prev(fBitmap);
+        fBitmap.setPixelRef(NULL);
+        if (!fBitmap.allocPixels()) {
+            // Fall back to a plain copy, which may still find the memory.
             prev.deepCopyTo(&fBitmap);
+        } else if (kRetain_ContentChangeMode == mode) {
+            // The snapshot keeps prev's pixels alive and unchanged, so they can be copied later,
+            // see onAboutToDraw().
+            fCopySource = prev;
+            fCopySource.lockPixels();
+            fTileColumns = (fBitmap.width() + kCopyTileSize - 1) / kCopyTileSize;
+            fTilesLeftToCopy = fTileColumns *
+                               ((fBitmap.height() + kCopyTileSize - 1) / kCopyTileSize);
+            fTileNeedsCopy.setCount(fTilesLeftToCopy);
+            for (int i = 0; i < fTilesLeftToCopy; ++i) {
+                fTileNeedsCopy[i] = true;
+            }
         }
-        // Now fBitmap is a deep copy of itself (and therefore different from
-        // what is being used by the image. Next we update the canvas to use
-        // this as its backend, so we can't modify the image's pixels anymore.
+        // Now fBitmap is different from what is being used by the image. Next
+        // we update the canvas to use this as its backend, so we can't modify
+        // the image's pixels anymore.
         SkASSERT(NULL != this->getCachedCanvas());
         this->getCachedCanvas()->getDevice()->replaceBitmapBackendForRasterSurface(fBitmap);
     }
 }
 
+void SkSurface_Raster::onAboutToDraw(ContentChangeMode mode, const SkIRect* dirtyBounds) {
+    if (0 == fTilesLeftToCopy) {
+        return;
+    }
+    if (kDiscard_ContentChangeMode == mode) {
+        this->dropTilesLeftToCopy();
+    } else if (NULL != dirtyBounds) {
+        this->copyTiles(*dirtyBounds);
+    } else {
+        this->copyAllTiles();
+    }
+}
+
+void SkSurface_Raster::onAboutToRead() {
+    this->copyAllTiles();
+}
+
+void SkSurface_Raster::copyTiles(const SkIRect& bounds) {
+    SkIRect area = bounds;
+    if (0 == fTilesLeftToCopy || !area.intersect(0, 0, fBitmap.width(), fBitmap.height())) {
+        return;
+    }
+
+    const size_t bytesPerPixel = fBitmap.bytesPerPixel();
+    for (int ty = area.fTop / kCopyTileSize; ty <= (area.fBottom - 1) / kCopyTileSize; ++ty) {
+        for (int tx = area.fLeft / kCopyTileSize; tx <= (area.fRight - 1) / kCopyTileSize; ++tx) {
+            bool& needsCopy = fTileNeedsCopy[ty * fTileColumns + tx];
+            if (!needsCopy) {
+                continue;
+            }
+            needsCopy = false;
+
+            SkIRect tile = SkIRect::MakeXYWH(tx * kCopyTileSize, ty * kCopyTileSize,
+                                             kCopyTileSize, kCopyTileSize);
+            SkAssertResult(tile.intersect(0, 0, fBitmap.width(), fBitmap.height()));
+            for (int y = tile.fTop; y < tile.fBottom; ++y) {
+                memcpy(fBitmap.getAddr(tile.fLeft, y), fCopySource.getAddr(tile.fLeft, y),
+                       tile.width() * bytesPerPixel);
+            }
+            --fTilesLeftToCopy;
+        }
+    }
+
+    if (0 == fTilesLeftToCopy) {
+        this->dropTilesLeftToCopy();
+    }
+}
+
+void SkSurface_Raster::copyAllTiles() {
+    this->copyTiles(SkIRect::MakeWH(fBitmap.width(), fBitmap.height()));
+}
+
+void SkSurface_Raster::dropTilesLeftToCopy() {
+    fCopySource.reset();
+    fTileNeedsCopy.reset();
+    fTilesLeftToCopy = 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SkSurface* SkSurface::NewRasterDirect(const SkImageInfo& info, void* pixels, size_t rowBytes) {
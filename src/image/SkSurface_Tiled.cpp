@@ -0,0 +1,329 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkSurface_Base.h"
+#include "SkCanvas.h"
+#include "SkDevice.h"
+#include "SkImagePriv.h"
+#include "SkMallocPixelRef.h"
+#include "SkRecord.h"
+#include "SkRecordDraw.h"
+#include "SkRecorder.h"
+#include "SkTaskGroup.h"
+#include "SkTemplates.h"
+#include "SkThreadPool.h"
+
+namespace {
+
+// Fills in what the record's paths otherwise compute lazily, the first time they are drawn.
+// The tiles draw the same paths at once on different threads, so this must happen first.
+class FreezePaths {
+public:
+    template <typename T> void operator()(const T&) {}
+
+    void operator()(const SkRecords::DrawPath& r) { freeze(r.path); }
+    void operator()(const SkRecords::ClipPath& r) { freeze(r.path); }
+    void operator()(const SkRecords::DrawTextOnPath& r) { freeze(r.path); }
+
+private:
+    static void freeze(const SkPath& path) {
+        path.updateBoundsCache();
+        (void)path.getConvexity();
+        (void)path.getGenerationID();
+    }
+};
+
+// What a tile must do with an op.
+enum OpRole {
+    kDraw_OpRole,     // Draws; only tiles it may touch need it.
+    kState_OpRole,    // Changes the matrix, clip or save stack; every tile needs it.
+    kHint_OpRole,     // Draws nothing; no tile needs it.
+};
+
+class GetRole {
+public:
+    template <typename T> OpRole operator()(const T&) { return kDraw_OpRole; }
+
+    OpRole operator()(const SkRecords::Save&)          { return kState_OpRole; }
+    OpRole operator()(const SkRecords::SaveLayer&)     { return kState_OpRole; }
+    OpRole operator()(const SkRecords::Restore&)       { return kState_OpRole; }
+    OpRole operator()(const SkRecords::Concat&)        { return kState_OpRole; }
+    OpRole operator()(const SkRecords::SetMatrix&)     { return kState_OpRole; }
+    OpRole operator()(const SkRecords::ClipPath&)      { return kState_OpRole; }
+    OpRole operator()(const SkRecords::ClipRRect&)     { return kState_OpRole; }
+    OpRole operator()(const SkRecords::ClipRect&)      { return kState_OpRole; }
+    OpRole operator()(const SkRecords::ClipRegion&)    { return kState_OpRole; }
+
+    OpRole operator()(const SkRecords::NoOp&)           { return kHint_OpRole; }
+    OpRole operator()(const SkRecords::PushCull&)       { return kHint_OpRole; }
+    OpRole operator()(const SkRecords::PopCull&)        { return kHint_OpRole; }
+    OpRole operator()(const SkRecords::PairedPushCull&) { return kHint_OpRole; }
+};
+
+// One tile of the surface.  Each tile keeps its own canvas alive between flushes, so the
+// matrix, clip and save stack recorded so far are still in place when the next batch of
+// commands is replayed into it.
+class Tile : SkNoncopyable {
+public:
+    Tile(const SkBitmap& surfaceBitmap, const SkIRect& bounds) : fBounds(bounds) {
+        SkBitmap subset;
+        surfaceBitmap.extractSubset(&subset, fBounds);
+        fCanvas.reset(SkNEW_ARGS(SkCanvas, (subset)));
+        fCanvas->translate(-SkIntToScalar(fBounds.fLeft), -SkIntToScalar(fBounds.fTop));
+        fInitialCTM = fCanvas->getTotalMatrix();
+    }
+
+    const SkIRect& bounds() const { return fBounds; }
+    SkBaseDevice* device() const { return fCanvas->getDevice(); }
+
+    // The ops, in record order, the next draw() plays.
+    SkTDArray<unsigned>* ops() { return &fOps; }
+
+    void draw(const SkRecord& record) {
+        SkRecords::Draw draw(fCanvas.get(), fInitialCTM);
+        for (int i = 0; i < fOps.count(); i++) {
+            record.visit<void>(fOps[i], draw);
+        }
+        fOps.rewind();
+    }
+
+private:
+    const SkIRect          fBounds;
+    SkAutoTUnref<SkCanvas> fCanvas;
+    SkMatrix               fInitialCTM;
+    SkTDArray<unsigned>    fOps;
+};
+
+// Plays one SkRecord into each of a set of tiles.
+class DrawTiles : public SkParallelForBody {
+public:
+    DrawTiles(const SkRecord& record, const SkTDArray<Tile*>& tiles)
+        : fRecord(record), fTiles(tiles) {}
+
+    virtual void run(int index) SK_OVERRIDE { fTiles[index]->draw(fRecord); }
+
+private:
+    const SkRecord&         fRecord;
+    const SkTDArray<Tile*>& fTiles;
+};
+
+}  // namespace
+
+class SkSurface_Tiled : public SkSurface_Base {
+public:
+    static bool Valid(const SkImageInfo&, int tileWidth, int tileHeight);
+
+    SkSurface_Tiled(SkPixelRef*, int tileWidth, int tileHeight, int threadCount);
+    virtual ~SkSurface_Tiled();
+
+    virtual SkCanvas* onNewCanvas() SK_OVERRIDE;
+    virtual SkSurface* onNewSurface(const SkImageInfo&) SK_OVERRIDE;
+    virtual SkImage* onNewImageSnapshot() SK_OVERRIDE;
+    virtual void onDraw(SkCanvas*, SkScalar x, SkScalar y,
+                        const SkPaint*) SK_OVERRIDE;
+    virtual const void* onPeekPixels(SkImageInfo*, size_t* rowBytes) SK_OVERRIDE;
+    virtual void onCopyOnWrite(ContentChangeMode) SK_OVERRIDE;
+
+private:
+    // Rasterize every command recorded since the last flush into the tiles.
+    void flush();
+    // Hands each tile the ops of record it needs to draw.
+    void cullOps(const SkRecord& record);
+
+    SkBitmap                fBitmap;
+    const int               fTileWidth;
+    const int               fTileHeight;
+    int                     fTileColumns;
+    SkTDArray<Tile*>        fTiles;
+    // Follows the matrix, clip and save stack every tile is left with by the last flush.
+    SkAutoTUnref<SkCanvas>  fState;
+    SkAutoTDelete<SkRecord> fRecord;
+    SkRecorder*             fRecorder;  // Unowned; this is our cached canvas.
+    SkThreadPool            fThreadPool;
+
+    typedef SkSurface_Base INHERITED;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool SkSurface_Tiled::Valid(const SkImageInfo& info, int tileWidth, int tileHeight) {
+    static const int64_t kMaxTotalSize = SK_MaxS32;
+
+    switch (info.fColorType) {
+        case kAlpha_8_SkColorType:
+        case kRGB_565_SkColorType:
+        case kN32_SkColorType:
+            break;
+        default:
+            return false;
+    }
+    if (tileWidth <= 0 || tileHeight <= 0) {
+        return false;
+    }
+    return info.getSafeSize64(info.minRowBytes()) <= kMaxTotalSize;
+}
+
+SkSurface_Tiled::SkSurface_Tiled(SkPixelRef* pr, int tileWidth, int tileHeight, int threadCount)
+    : INHERITED(pr->info().fWidth, pr->info().fHeight)
+    , fTileWidth(tileWidth)
+    , fTileHeight(tileHeight)
+    , fTileColumns((pr->info().fWidth + tileWidth - 1) / tileWidth)
+    , fState(SkNEW_ARGS(SkCanvas, (pr->info().fWidth, pr->info().fHeight)))
+    , fRecord(SkNEW(SkRecord))
+    , fRecorder(NULL)
+    , fThreadPool(threadCount) {
+    const SkImageInfo& info = pr->info();
+
+    fBitmap.setInfo(info, info.minRowBytes());
+    fBitmap.setPixelRef(pr);
+    if (!info.isOpaque()) {
+        fBitmap.eraseColor(SK_ColorTRANSPARENT);
+    }
+
+    for (int y = 0; y < info.fHeight; y += fTileHeight) {
+        for (int x = 0; x < info.fWidth; x += fTileWidth) {
+            SkIRect bounds = SkIRect::MakeXYWH(x, y, fTileWidth, fTileHeight);
+            bounds.intersect(0, 0, info.fWidth, info.fHeight);
+            *fTiles.append() = SkNEW_ARGS(Tile, (fBitmap, bounds));
+        }
+    }
+}
+
+SkSurface_Tiled::~SkSurface_Tiled() {
+    // Our canvas may outlive us, but our SkRecord will not.
+    if (NULL != fRecorder) {
+        fRecorder->forgetRecord();
+    }
+    fTiles.deleteAll();
+}
+
+SkCanvas* SkSurface_Tiled::onNewCanvas() {
+    SkASSERT(NULL == fRecorder);
+    fRecorder = SkNEW_ARGS(SkRecorder, (fRecord.get(), this->width(), this->height()));
+    return fRecorder;
+}
+
+SkSurface* SkSurface_Tiled::onNewSurface(const SkImageInfo& info) {
+    return SkSurface::NewRasterTiled(info, fTileWidth, fTileHeight);
+}
+
+void SkSurface_Tiled::flush() {
+    if (0 == fRecord->count()) {
+        return;
+    }
+
+    // Keep recording into a fresh SkRecord while we play back the commands we have.
+    SkAutoTDelete<SkRecord> pending(fRecord.detach());
+    fRecord.reset(SkNEW(SkRecord));
+    if (NULL != fRecorder) {
+        fRecorder->setRecord(fRecord.get());
+    }
+
+    // This also fills in everything the tiles would otherwise race to fill in lazily.
+    this->cullOps(*pending);
+    DrawTiles body(*pending, fTiles);
+    SkTaskGroup group(&fThreadPool);
+    group.parallelFor(0, fTiles.count(), &body);
+    group.wait();
+}
+
+void SkSurface_Tiled::cullOps(const SkRecord& record) {
+    SkAutoTMalloc<SkIRect> bounds(record.count());
+    for (unsigned i = 0; i < record.count(); i++) {
+        bounds[i].setEmpty();
+    }
+
+    FreezePaths freeze;
+    GetRole getRole;
+    SkRecords::FillBounds fill(fState.get(), bounds.get());
+    for (unsigned i = 0; i < record.count(); i++) {
+        record.visit<void>(i, freeze);
+        fill.setCurrentOp(i);
+        record.visit<void>(i, fill);
+
+        switch (record.visit<OpRole>(i, getRole)) {
+            case kState_OpRole:
+                for (int t = 0; t < fTiles.count(); t++) {
+                    *fTiles[t]->ops()->append() = i;
+                }
+                break;
+            case kDraw_OpRole:
+                // A draw's bounds are clipped to the surface, and the tiles are a grid over it.
+                if (!bounds[i].isEmpty()) {
+                    const int left   = bounds[i].fLeft         / fTileWidth,
+                              right  = (bounds[i].fRight - 1)  / fTileWidth,
+                              top    = bounds[i].fTop          / fTileHeight,
+                              bottom = (bounds[i].fBottom - 1) / fTileHeight;
+                    for (int y = top; y <= bottom; y++) {
+                        for (int x = left; x <= right; x++) {
+                            *fTiles[y * fTileColumns + x]->ops()->append() = i;
+                        }
+                    }
+                }
+                break;
+            case kHint_OpRole:
+                break;
+        }
+    }
+}
+
+void SkSurface_Tiled::onDraw(SkCanvas* canvas, SkScalar x, SkScalar y,
+                             const SkPaint* paint) {
+    this->flush();
+    canvas->drawBitmap(fBitmap, x, y, paint);
+}
+
+SkImage* SkSurface_Tiled::onNewImageSnapshot() {
+    this->flush();
+    return SkNewImageFromBitmap(fBitmap, true);
+}
+
+const void* SkSurface_Tiled::onPeekPixels(SkImageInfo* info, size_t* rowBytes) {
+    this->flush();
+    if (NULL != info) {
+        *info = fBitmap.info();
+    }
+    if (NULL != rowBytes) {
+        *rowBytes = fBitmap.rowBytes();
+    }
+    return fBitmap.getPixels();
+}
+
+void SkSurface_Tiled::onCopyOnWrite(ContentChangeMode mode) {
+    // are we sharing pixelrefs with the image?
+    SkASSERT(NULL != this->getCachedImage());
+    if (SkBitmapImageGetPixelRef(this->getCachedImage()) == fBitmap.pixelRef()) {
+        if (kDiscard_ContentChangeMode == mode) {
+            fBitmap.setPixelRef(NULL);
+            fBitmap.allocPixels();
+        } else {
+            SkBitmap prev(fBitmap);
+            prev.deepCopyTo(&fBitmap);
+        }
+        // Commands recorded from now on must land in the copy, not in the image's pixels.
+        for (int i = 0; i < fTiles.count(); i++) {
+            SkBitmap subset;
+            fBitmap.extractSubset(&subset, fTiles[i]->bounds());
+            fTiles[i]->device()->replaceBitmapBackendForRasterSurface(subset);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkSurface* SkSurface::NewRasterTiled(const SkImageInfo& info, int tileWidth, int tileHeight,
+                                     int threadCount) {
+    if (!SkSurface_Tiled::Valid(info, tileWidth, tileHeight)) {
+        return NULL;
+    }
+
+    SkAutoTUnref<SkPixelRef> pr(SkMallocPixelRef::NewAllocate(info, 0, NULL));
+    if (NULL == pr.get()) {
+        return NULL;
+    }
+    return SkNEW_ARGS(SkSurface_Tiled, (pr, tileWidth, tileHeight, threadCount));
+}
@@ -45,6 +45,10 @@ protected:
     virtual bool onGetPixels(const SkImageInfo& info,
                              void* pixels, size_t rowBytes,
                              SkPMColor ctable[], int* ctableCount) SK_OVERRIDE;
+    virtual bool onGetSubsetPixels(const SkIRect& subset, int sampleSize,
+                                   SkBitmap* bitmap) SK_OVERRIDE;
+    virtual bool onGetYUV8Planes(SkISize sizes[3], void* planes[3],
+                                 size_t rowBytes[3]) SK_OVERRIDE;
 
 private:
     typedef SkImageGenerator INHERITED;
@@ -209,6 +213,69 @@ bool DecodingImageGenerator::onGetPixels(const SkImageInfo& info,
     return true;
 }
 
+bool DecodingImageGenerator::onGetSubsetPixels(const SkIRect& subset, int sampleSize,
+                                               SkBitmap* bitmap) {
+    if (kIndex_8_SkColorType == fInfo.colorType()) {
+        return false;
+    }
+
+    // The tile index keeps a ref on the stream it was built from, so give it its own stream
+    // rather than fStream, which onGetPixels() rewinds.
+    SkAutoTUnref<SkData> data(this->onRefEncodedData());
+    if (NULL == data.get()) {
+        return false;
+    }
+    SkAutoTUnref<SkStreamRewindable> stream(SkNEW_ARGS(SkMemoryStream, (data)));
+    SkAutoTDelete<SkImageDecoder> decoder(SkImageDecoder::Factory(stream));
+    if (NULL == decoder.get()) {
+        return false;
+    }
+    int width, height;
+    if (!decoder->buildTileIndex(stream, &width, &height)) {
+        return false;
+    }
+    decoder->setDitherImage(fDitherImage);
+    decoder->setSampleSize(fSampleSize * sampleSize);
+    decoder->setRequireUnpremultipliedColors(fInfo.fAlphaType == kUnpremul_SkAlphaType);
+
+    // fInfo is already scaled down by fSampleSize, the tile index is not.
+    SkIRect encodedSubset = SkIRect::MakeLTRB(subset.fLeft * fSampleSize,
+                                              subset.fTop * fSampleSize,
+                                              subset.fRight * fSampleSize,
+                                              subset.fBottom * fSampleSize);
+    if (!encodedSubset.intersect(0, 0, width, height)) {
+        return false;
+    }
+
+    SkBitmap decoded;
+    if (!decoder->decodeSubset(&decoded, encodedSubset, fInfo.colorType())) {
+        return false;
+    }
+    if (decoded.colorType() == fInfo.colorType()) {
+        bitmap->swap(decoded);
+        return true;
+    }
+    return decoded.copyTo(bitmap, fInfo.colorType());
+}
+
+bool DecodingImageGenerator::onGetYUV8Planes(SkISize sizes[3], void* planes[3],
+                                             size_t rowBytes[3]) {
+    // The planes stand in for the pixels of fInfo, so only offer them when those would be
+    // full color.
+    if (kN32_SkColorType != fInfo.colorType()) {
+        return false;
+    }
+    if (!fStream->rewind()) {
+        return false;
+    }
+    SkAutoTDelete<SkImageDecoder> decoder(SkImageDecoder::Factory(fStream));
+    if (NULL == decoder.get()) {
+        return false;
+    }
+    decoder->setSampleSize(fSampleSize);
+    return decoder->decodeYUV8Planes(fStream, sizes, planes, rowBytes);
+}
+
 // A contructor-type function that returns NULL on failure.  This
 // prevents the returned SkImageGenerator from ever being in a bad
 // state.  Called by both Create() functions
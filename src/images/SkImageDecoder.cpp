@@ -12,6 +12,7 @@
 #include "SkPixelRef.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
+#include "SkTraceEvent.h"
 #include "SkCanvas.h"
 
 SkImageDecoder::SkImageDecoder()
@@ -21,6 +22,7 @@ SkImageDecoder::SkImageDecoder()
 #endif
     , fAllocator(NULL)
     , fSampleSize(1)
+    , fTargetSize(SkISize::Make(0, 0))
     , fDefaultPref(kUnknown_SkColorType)
     , fDitherImage(true)
     , fUsePrefTable(false)
@@ -47,6 +49,7 @@ void SkImageDecoder::copyFieldsToOther(SkImageDecoder* other) {
 #endif
     other->setAllocator(fAllocator);
     other->setSampleSize(fSampleSize);
+    other->setTargetSize(fTargetSize.width(), fTargetSize.height());
     if (fUsePrefTable) {
         other->setPrefConfigTable(fPrefTable);
     } else {
@@ -118,6 +121,13 @@ void SkImageDecoder::setSampleSize(int size) {
     fSampleSize = size;
 }
 
+void SkImageDecoder::setTargetSize(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        width = height = 0;
+    }
+    fTargetSize.set(width, height);
+}
+
 #ifdef SK_SUPPORT_LEGACY_IMAGEDECODER_CHOOSER
 // TODO: change Chooser virtual to take colorType, so we can stop calling SkColorTypeToBitmapConfig
 //
@@ -173,6 +183,7 @@ SkColorType SkImageDecoder::getPrefColorType(SrcDepth srcDepth, bool srcHasAlpha
 }
 
 bool SkImageDecoder::decode(SkStream* stream, SkBitmap* bm, SkColorType pref, Mode mode) {
+    TRACE_EVENT0("skia", "SkImageDecoder::decode");
     // we reset this to false before calling onDecode
     fShouldCancelDecode = false;
     // assign this, for use by getPrefColorType(), in case fUsePrefTable is false
@@ -197,6 +208,14 @@ bool SkImageDecoder::decodeSubset(SkBitmap* bm, const SkIRect& rect, SkColorType
     return this->onDecodeSubset(bm, rect);
 }
 
+bool SkImageDecoder::decodeYUV8Planes(SkStream* stream, SkISize componentSizes[3],
+                                      void* planes[3], size_t rowBytes[3]) {
+    // we reset this to false before calling onDecodeYUV8Planes
+    fShouldCancelDecode = false;
+
+    return this->onDecodeYUV8Planes(stream, componentSizes, planes, rowBytes);
+}
+
 bool SkImageDecoder::buildTileIndex(SkStreamRewindable* stream, int *width, int *height) {
     // we reset this to false before calling onBuildTileIndex
     fShouldCancelDecode = false;
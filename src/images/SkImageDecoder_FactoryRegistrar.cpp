@@ -7,6 +7,7 @@
 
 #include "SkErrorInternals.h"
 #include "SkImageDecoder.h"
+#include "SkIncrementalImageDecoder.h"
 #include "SkStream.h"
 #include "SkTRegistry.h"
 
@@ -61,3 +62,22 @@ SkImageDecoder::Format SkImageDecoder::GetStreamFormat(SkStreamRewindable* strea
     }
     return kUnknown_Format;
 }
+
+template SkIncrementalImageDecoder_Reg* SkIncrementalImageDecoder_Reg::gHead;
+
+SkIncrementalImageDecoder* SkIncrementalImageDecoder::Create(const void* data, size_t length) {
+    SkMemoryStream stream(data, length, false);
+    SkImageDecoder::Format format = SkImageDecoder::GetStreamFormat(&stream);
+    if (SkImageDecoder::kUnknown_Format == format) {
+        return NULL;
+    }
+    const SkIncrementalImageDecoder_Reg* curr = SkIncrementalImageDecoder_Reg::Head();
+    while (curr != NULL) {
+        SkIncrementalImageDecoder* decoder = curr->factory()(format);
+        if (decoder != NULL) {
+            return decoder;
+        }
+        curr = curr->next();
+    }
+    return NULL;
+}
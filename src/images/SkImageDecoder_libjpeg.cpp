@@ -11,6 +11,7 @@
 #include "SkJpegUtility.h"
 #include "SkColorPriv.h"
 #include "SkDither.h"
+#include "SkIncrementalImageDecoder.h"
 #include "SkScaledBitmapSampler.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
@@ -80,7 +81,7 @@ static void do_nothing_output_message(j_common_ptr) {
     /* do nothing */
 }
 
-static void initialize_info(jpeg_decompress_struct* cinfo, skjpeg_source_mgr* src_mgr) {
+static void initialize_info(jpeg_decompress_struct* cinfo, jpeg_source_mgr* src_mgr) {
     SkASSERT(cinfo != NULL);
     SkASSERT(src_mgr != NULL);
     jpeg_create_decompress(cinfo);
@@ -217,35 +218,45 @@ private:
 
 class SkJPEGImageDecoder : public SkImageDecoder {
 public:
-#ifdef SK_BUILD_FOR_ANDROID
     SkJPEGImageDecoder() {
+#ifdef SK_BUILD_FOR_ANDROID
         fImageIndex = NULL;
+#else
+        fIndexStream = NULL;
+#endif
         fImageWidth = 0;
         fImageHeight = 0;
     }
 
     virtual ~SkJPEGImageDecoder() {
+#ifdef SK_BUILD_FOR_ANDROID
         SkDELETE(fImageIndex);
-    }
+#else
+        SkSafeUnref(fIndexStream);
 #endif
+    }
 
     virtual Format getFormat() const {
         return kJPEG_Format;
     }
 
 protected:
-#ifdef SK_BUILD_FOR_ANDROID
     virtual bool onBuildTileIndex(SkStreamRewindable *stream, int *width, int *height) SK_OVERRIDE;
     virtual bool onDecodeSubset(SkBitmap* bitmap, const SkIRect& rect) SK_OVERRIDE;
-#endif
     virtual bool onDecode(SkStream* stream, SkBitmap* bm, Mode) SK_OVERRIDE;
+    virtual bool onDecodeYUV8Planes(SkStream* stream, SkISize componentSizes[3],
+                                    void* planes[3], size_t rowBytes[3]) SK_OVERRIDE;
 
 private:
 #ifdef SK_BUILD_FOR_ANDROID
     SkJPEGImageIndex* fImageIndex;
+#else
+    // Without the huffman index of Android's libjpeg a subset is decoded by streaming the
+    // scanlines from the top of the image, so the "index" is just the stream.
+    SkStreamRewindable* fIndexStream;
+#endif
     int fImageWidth;
     int fImageHeight;
-#endif
 
     /**
      *  Determine the appropriate bitmap colortype and out_color_space based on
@@ -562,6 +573,20 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
     */
     int sampleSize = this->getSampleSize();
 
+    const SkColorType colorType = this->getBitmapColorType(&cinfo);
+    const SkAlphaType alphaType = kAlpha_8_SkColorType == colorType ?
+                                      kPremul_SkAlphaType : kOpaque_SkAlphaType;
+
+    /*  With a target size, let jpeg scale down as far as it can without going
+        below the target, and box filter the rest of the way in the sampler.
+    */
+    const bool filter = SkScaledBitmapSampler::ShouldFilter(*this, colorType);
+    if (filter) {
+        const SkISize& target = this->getTargetSize();
+        sampleSize = SkMax32(1, SkMin32(cinfo.image_width / target.width(),
+                                        cinfo.image_height / target.height()));
+    }
+
     set_dct_method(*this, &cinfo);
 
     SkASSERT(1 == cinfo.scale_num);
@@ -569,13 +594,9 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
 
     turn_off_visual_optimizations(&cinfo);
 
-    const SkColorType colorType = this->getBitmapColorType(&cinfo);
-    const SkAlphaType alphaType = kAlpha_8_SkColorType == colorType ?
-                                      kPremul_SkAlphaType : kOpaque_SkAlphaType;
-
     adjust_out_color_space_and_dither(&cinfo, colorType, *this);
 
-    if (1 == sampleSize && SkImageDecoder::kDecodeBounds_Mode == mode) {
+    if (1 == sampleSize && !filter && SkImageDecoder::kDecodeBounds_Mode == mode) {
         // Assume an A8 bitmap is not opaque to avoid the check of each
         // individual pixel. It is very unlikely to be opaque, since
         // an opaque A8 bitmap would not be very interesting.
@@ -599,8 +620,11 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
             computed very early, which is why this special check can pay off.
          */
         if (SkImageDecoder::kDecodeBounds_Mode == mode && valid_output_dimensions(cinfo)) {
-            SkScaledBitmapSampler smpl(cinfo.output_width, cinfo.output_height,
-                                       recompute_sampleSize(sampleSize, cinfo));
+            SkScaledBitmapSampler smpl = filter ?
+                    SkScaledBitmapSampler(cinfo.output_width, cinfo.output_height,
+                                          this->getTargetSize()) :
+                    SkScaledBitmapSampler(cinfo.output_width, cinfo.output_height,
+                                          recompute_sampleSize(sampleSize, cinfo));
             // Assume an A8 bitmap is not opaque to avoid the check of each
             // individual pixel. It is very unlikely to be opaque, since
             // an opaque A8 bitmap would not be very interesting.
@@ -620,7 +644,10 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
     }
 #endif
 
-    SkScaledBitmapSampler sampler(cinfo.output_width, cinfo.output_height, sampleSize);
+    SkScaledBitmapSampler sampler = filter ?
+            SkScaledBitmapSampler(cinfo.output_width, cinfo.output_height,
+                                  this->getTargetSize()) :
+            SkScaledBitmapSampler(cinfo.output_width, cinfo.output_height, sampleSize);
     // Assume an A8 bitmap is not opaque to avoid the check of each
     // individual pixel. It is very unlikely to be opaque, since
     // an opaque A8 bitmap would not be very interesting.
@@ -640,7 +667,7 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
     /* short-circuit the SkScaledBitmapSampler when possible, as this gives
        a significant performance boost.
     */
-    if (sampleSize == 1 &&
+    if (sampleSize == 1 && !sampler.isBoxFiltering() &&
         ((kN32_SkColorType == colorType && cinfo.out_color_space == JCS_RGBA_8888) ||
          (kRGB_565_SkColorType == colorType && cinfo.out_color_space == JCS_RGB_565)))
     {
@@ -686,14 +713,14 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
         return return_false(cinfo, *bm, "skip rows");
     }
 
-    // now loop through scanlines until y == bm->height() - 1
+    // now loop through scanlines until y == sampler.srcRowCount() - 1
     for (int y = 0;; y++) {
         JSAMPLE* rowptr = (JSAMPLE*)srcRow;
         int row_count = jpeg_read_scanlines(&cinfo, &rowptr, 1);
         if (0 == row_count) {
             // if row_count == 0, then we didn't get a scanline,
             // so return early.  We will return a partial image.
-            fill_below_level(y, bm);
+            fill_below_level(sampler.dstRowsWritten(), bm);
             cinfo.output_scanline = cinfo.output_height;
             break;  // Skip to jpeg_finish_decompress()
         }
@@ -706,7 +733,7 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
         }
 
         sampler.next(srcRow);
-        if (bm->height() - 1 == y) {
+        if (sampler.srcRowCount() - 1 == y) {
             // we're done
             break;
         }
@@ -726,6 +753,124 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
     return true;
 }
 
+/**
+ *  The YUV planes can describe a YCbCr image whose luma is at full resolution and whose two
+ *  chroma components are subsampled alike, which covers the usual 4:4:4, 4:2:2 and 4:2:0.
+ *  Must be called after jpeg_read_header.
+ */
+static bool is_yuv_supported(const jpeg_decompress_struct& cinfo) {
+    const jpeg_component_info* comp = cinfo.comp_info;
+    return JCS_YCbCr == cinfo.jpeg_color_space && 3 == cinfo.num_components &&
+           comp[0].h_samp_factor == cinfo.max_h_samp_factor &&
+           comp[0].v_samp_factor == cinfo.max_v_samp_factor &&
+           comp[1].h_samp_factor == comp[2].h_samp_factor &&
+           comp[1].v_samp_factor == comp[2].v_samp_factor;
+}
+
+bool SkJPEGImageDecoder::onDecodeYUV8Planes(SkStream* stream, SkISize componentSizes[3],
+                                            void* planes[3], size_t rowBytes[3]) {
+#ifdef TIME_DECODE
+    SkAutoTime atm("JPEG YUV8 Decode");
+#endif
+
+    if (this->getSampleSize() != 1) {
+        return false;   // the planes are only available at full size
+    }
+
+    JPEGAutoClean autoClean;
+
+    jpeg_decompress_struct  cinfo;
+    skjpeg_source_mgr       srcManager(stream, this);
+
+    skjpeg_error_mgr errorManager;
+    set_error_mgr(&cinfo, &errorManager);
+
+    // All objects need to be instantiated before this setjmp call so that
+    // they will be cleaned up properly if an error occurs.
+    if (setjmp(errorManager.fJmpBuf)) {
+        return return_false(cinfo, SkBitmap(), "setjmp YUV8");
+    }
+
+    initialize_info(&cinfo, &srcManager);
+    autoClean.set(&cinfo);
+
+    if (JPEG_HEADER_OK != jpeg_read_header(&cinfo, true)) {
+        return return_false(cinfo, SkBitmap(), "read_header YUV8");
+    }
+    if (!is_yuv_supported(cinfo)) {
+        return false;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        const jpeg_component_info& comp = cinfo.comp_info[i];
+        componentSizes[i].set(
+            SkToS32((cinfo.image_width * comp.h_samp_factor + cinfo.max_h_samp_factor - 1) /
+                    cinfo.max_h_samp_factor),
+            SkToS32((cinfo.image_height * comp.v_samp_factor + cinfo.max_v_samp_factor - 1) /
+                    cinfo.max_v_samp_factor));
+    }
+    if (NULL == planes || NULL == rowBytes) {
+        return true;
+    }
+
+    // Skip the color conversion and upsampling altogether.
+    cinfo.raw_data_out = TRUE;
+    set_dct_method(*this, &cinfo);
+
+    if (!jpeg_start_decompress(&cinfo)) {
+        return return_false(cinfo, SkBitmap(), "start_decompress YUV8");
+    }
+
+    // libjpeg returns whole rows of blocks, which may overhang the planes on the right and at
+    // the bottom, so read each band into scratch rows and copy out what is inside the planes.
+    int bandHeights[3];
+    size_t bandWidths[3];
+    int totalRows = 0;
+    size_t totalSize = 0;
+    for (int i = 0; i < 3; ++i) {
+        const jpeg_component_info& comp = cinfo.comp_info[i];
+        bandHeights[i] = comp.v_samp_factor * DCTSIZE;
+        bandWidths[i] = comp.width_in_blocks * DCTSIZE;
+        totalRows += bandHeights[i];
+        totalSize += bandWidths[i] * bandHeights[i];
+    }
+    SkAutoTMalloc<JSAMPROW> rowStorage(totalRows);
+    SkAutoMalloc sampleStorage(totalSize);
+
+    JSAMPARRAY bands[3];
+    JSAMPROW* row = rowStorage.get();
+    JSAMPLE* samples = static_cast<JSAMPLE*>(sampleStorage.get());
+    for (int i = 0; i < 3; ++i) {
+        bands[i] = row;
+        for (int y = 0; y < bandHeights[i]; ++y) {
+            *row++ = samples;
+            samples += bandWidths[i];
+        }
+    }
+
+    const JDIMENSION lumaRowsPerBand = cinfo.max_v_samp_factor * DCTSIZE;
+    for (int band = 0; cinfo.output_scanline < cinfo.output_height; ++band) {
+        if (0 == jpeg_read_raw_data(&cinfo, bands, lumaRowsPerBand)) {
+            return return_false(cinfo, SkBitmap(), "read_raw_data");
+        }
+        if (this->shouldCancelDecode()) {
+            return return_false(cinfo, SkBitmap(), "shouldCancelDecode");
+        }
+        for (int i = 0; i < 3; ++i) {
+            const int top = band * bandHeights[i];
+            const int count = SkTMin(bandHeights[i], componentSizes[i].height() - top);
+            uint8_t* dst = static_cast<uint8_t*>(planes[i]) + top * rowBytes[i];
+            for (int y = 0; y < count; ++y) {
+                memcpy(dst, bands[i][y], componentSizes[i].width());
+                dst += rowBytes[i];
+            }
+        }
+    }
+    jpeg_finish_decompress(&cinfo);
+
+    return true;
+}
+
 #ifdef SK_BUILD_FOR_ANDROID
 bool SkJPEGImageDecoder::onBuildTileIndex(SkStreamRewindable* stream, int *width, int *height) {
 
@@ -955,6 +1100,186 @@ bool SkJPEGImageDecoder::onDecodeSubset(SkBitmap* bm, const SkIRect& region) {
     }
     return true;
 }
+#else
+bool SkJPEGImageDecoder::onBuildTileIndex(SkStreamRewindable* stream, int *width, int *height) {
+    JPEGAutoClean autoClean;
+
+    jpeg_decompress_struct  cinfo;
+    skjpeg_source_mgr       srcManager(stream, this);
+
+    skjpeg_error_mgr errorManager;
+    set_error_mgr(&cinfo, &errorManager);
+
+    // All objects need to be instantiated before this setjmp call so that
+    // they will be cleaned up properly if an error occurs.
+    if (setjmp(errorManager.fJmpBuf)) {
+        return false;
+    }
+
+    initialize_info(&cinfo, &srcManager);
+    autoClean.set(&cinfo);
+
+    if (JPEG_HEADER_OK != jpeg_read_header(&cinfo, true)) {
+        return false;
+    }
+
+    fImageWidth = cinfo.image_width;
+    fImageHeight = cinfo.image_height;
+    if (width) {
+        *width = fImageWidth;
+    }
+    if (height) {
+        *height = fImageHeight;
+    }
+
+    SkRefCnt_SafeAssign(fIndexStream, stream);
+    return true;
+}
+
+bool SkJPEGImageDecoder::onDecodeSubset(SkBitmap* bm, const SkIRect& region) {
+    if (NULL == fIndexStream) {
+        return false;
+    }
+
+    SkIRect rect = SkIRect::MakeWH(fImageWidth, fImageHeight);
+    if (!rect.intersect(region)) {
+        // If the requested region is entirely outside the image return false
+        return false;
+    }
+
+    if (!fIndexStream->rewind()) {
+        return false;
+    }
+
+    JPEGAutoClean autoClean;
+
+    jpeg_decompress_struct  cinfo;
+    skjpeg_source_mgr       srcManager(fIndexStream, this);
+
+    skjpeg_error_mgr errorManager;
+    set_error_mgr(&cinfo, &errorManager);
+
+    // All objects need to be instantiated before this setjmp call so that
+    // they will be cleaned up properly if an error occurs.
+    if (setjmp(errorManager.fJmpBuf)) {
+        return return_false(cinfo, *bm, "setjmp");
+    }
+
+    initialize_info(&cinfo, &srcManager);
+    autoClean.set(&cinfo);
+
+    if (JPEG_HEADER_OK != jpeg_read_header(&cinfo, true)) {
+        return return_false(cinfo, *bm, "read_header");
+    }
+
+    int requestedSampleSize = this->getSampleSize();
+    SkASSERT(1 == cinfo.scale_num);
+    cinfo.scale_denom = requestedSampleSize;
+
+    set_dct_method(*this, &cinfo);
+    turn_off_visual_optimizations(&cinfo);
+
+    const SkColorType colorType = this->getBitmapColorType(&cinfo);
+    adjust_out_color_space_and_dither(&cinfo, colorType, *this);
+
+    if (!jpeg_start_decompress(&cinfo)) {
+        return return_false(cinfo, *bm, "start_decompress");
+    }
+
+    // Map the subset to the rows and columns libjpeg outputs at the DCT scale it picked. The
+    // sampler does the rest of the requested sample size.
+    int skiaSampleSize = recompute_sampleSize(requestedSampleSize, cinfo);
+    int actualSampleSize = skiaSampleSize * cinfo.image_width / cinfo.output_width;
+    const int64_t outWidth = cinfo.output_width;
+    const int64_t outHeight = cinfo.output_height;
+    SkIRect outRect = SkIRect::MakeLTRB(
+            (int)(rect.fLeft * outWidth / fImageWidth),
+            (int)(rect.fTop * outHeight / fImageHeight),
+            (int)((rect.fRight * outWidth + fImageWidth - 1) / fImageWidth),
+            (int)((rect.fBottom * outHeight + fImageHeight - 1) / fImageHeight));
+
+    SkScaledBitmapSampler sampler(outRect.width(), outRect.height(), skiaSampleSize);
+
+    SkBitmap bitmap;
+    // Assume an A8 bitmap is not opaque to avoid the check of each
+    // individual pixel. It is very unlikely to be opaque, since
+    // an opaque A8 bitmap would not be very interesting.
+    // Otherwise, a jpeg image is opaque.
+    bitmap.setInfo(SkImageInfo::Make(sampler.scaledWidth(), sampler.scaledHeight(), colorType,
+                                     kAlpha_8_SkColorType == colorType ?
+                                         kPremul_SkAlphaType : kOpaque_SkAlphaType));
+
+    // Decode straight into the caller's bitmap when the region is inside the image.
+    bool swapOnly = (rect == region) && bm->isNull();
+    if (swapOnly) {
+        if (!this->allocPixelRef(&bitmap, NULL)) {
+            return return_false(cinfo, bitmap, "allocPixelRef");
+        }
+    } else {
+        if (!bitmap.allocPixels()) {
+            return return_false(cinfo, bitmap, "allocPixels");
+        }
+    }
+
+    SkAutoLockPixels alp(bitmap);
+
+    // check for supported formats
+    SkScaledBitmapSampler::SrcConfig sc;
+    int srcBytesPerPixel;
+
+    if (!get_src_config(cinfo, &sc, &srcBytesPerPixel)) {
+        return return_false(cinfo, *bm, "jpeg colorspace");
+    }
+
+    if (!sampler.begin(&bitmap, sc, *this)) {
+        return return_false(cinfo, bitmap, "sampler.begin");
+    }
+
+    SkAutoMalloc srcStorage(cinfo.output_width * srcBytesPerPixel);
+    uint8_t* srcRow = (uint8_t*)srcStorage.get();
+    uint8_t* subsetRow = srcRow + outRect.fLeft * srcBytesPerPixel;
+
+    // The rows above the subset still go through the entropy decoder, but only at the DCT
+    // scale. The ones below it are never read.
+    if (!skip_src_rows(&cinfo, srcRow, outRect.fTop + sampler.srcY0())) {
+        return return_false(cinfo, bitmap, "skip rows");
+    }
+
+    // now loop through scanlines until y == bitmap->height() - 1
+    for (int y = 0;; y++) {
+        JSAMPLE* rowptr = (JSAMPLE*)srcRow;
+        int row_count = jpeg_read_scanlines(&cinfo, &rowptr, 1);
+        if (0 == row_count) {
+            return return_false(cinfo, bitmap, "read_scanlines");
+        }
+        if (this->shouldCancelDecode()) {
+            return return_false(cinfo, bitmap, "shouldCancelDecode");
+        }
+
+        if (JCS_CMYK == cinfo.out_color_space) {
+            convert_CMYK_to_RGB(subsetRow, outRect.width());
+        }
+
+        sampler.next(subsetRow);
+        if (bitmap.height() - 1 == y) {
+            // we're done
+            break;
+        }
+
+        if (!skip_src_rows(&cinfo, srcRow, sampler.srcDY() - 1)) {
+            return return_false(cinfo, bitmap, "skip rows");
+        }
+    }
+    jpeg_abort_decompress(&cinfo);
+
+    if (swapOnly) {
+        bm->swap(bitmap);
+    } else {
+        cropBitmap(bm, &bitmap, actualSampleSize, region.x(), region.y(),
+                   region.width(), region.height(), rect.fLeft, rect.fTop);
+    }
+    return true;
+}
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1202,6 +1527,162 @@ DEFINE_DECODER_CREATOR(JPEGImageDecoder);
 DEFINE_ENCODER_CREATOR(JPEGImageEncoder);
 ///////////////////////////////////////////////////////////////////////////////
 
+// Decodes JPEGs pushed a chunk at a time, suspending libjpeg when it runs out
+// of data. Progressive JPEGs are decoded in buffered-image mode, and every
+// scan that has arrived is output over the whole image, so the image sharpens
+// as the scans come in.
+class SkJPEGIncrementalDecoder : public SkIncrementalImageDecoder {
+public:
+    SkJPEGIncrementalDecoder()
+        : fState(kInit_State)
+        , fLastOutputScan(0) {
+        set_error_mgr(&fCInfo, &fErrorManager);
+    }
+
+    virtual ~SkJPEGIncrementalDecoder() {
+        if (kInit_State != fState) {
+            jpeg_destroy_decompress(&fCInfo);
+        }
+    }
+
+    virtual SkImageDecoder::Format getFormat() const SK_OVERRIDE {
+        return SkImageDecoder::kJPEG_Format;
+    }
+
+protected:
+    virtual Status onAppend(const void* data, size_t length) SK_OVERRIDE {
+        fSrcManager.append(data, length);
+        if (setjmp(fErrorManager.fJmpBuf)) {
+            // skjpeg_error_exit has already destroyed fCInfo.
+            fState = kInit_State;
+            return kError_Status;
+        }
+        return this->decode() ? kComplete_Status : kNeedMoreData_Status;
+    }
+
+private:
+    enum State {
+        kInit_State,
+        kHeader_State,
+        kStartDecompress_State,
+        kStartOutput_State,
+        kScanlines_State,
+        kFinishOutput_State,
+        kFinishDecompress_State,
+    };
+
+    // Decodes as far as the data allows. Returns true once the image is complete.
+    bool decode() {
+        for (;;) {
+            switch (fState) {
+                case kInit_State:
+                    initialize_info(&fCInfo, &fSrcManager);
+                    fState = kHeader_State;
+                    break;
+                case kHeader_State:
+                    if (JPEG_SUSPENDED == jpeg_read_header(&fCInfo, TRUE)) {
+                        return false;
+                    }
+                    this->onHeader();
+                    fState = kStartDecompress_State;
+                    break;
+                case kStartDecompress_State:
+                    if (!jpeg_start_decompress(&fCInfo)) {
+                        return false;
+                    }
+                    fState = fCInfo.buffered_image ? kStartOutput_State : kScanlines_State;
+                    break;
+                case kStartOutput_State: {
+                    // Take in all the data there is, to output the latest scan.
+                    int status;
+                    do {
+                        status = jpeg_consume_input(&fCInfo);
+                    } while (JPEG_SUSPENDED != status && JPEG_REACHED_EOI != status);
+                    if (fLastOutputScan == fCInfo.input_scan_number) {
+                        // That scan is shown already.
+                        return false;
+                    }
+                    if (!jpeg_start_output(&fCInfo, fCInfo.input_scan_number)) {
+                        return false;
+                    }
+                    fLastOutputScan = fCInfo.output_scan_number;
+                    fState = kScanlines_State;
+                    break;
+                }
+                case kScanlines_State:
+                    if (!this->readScanlines()) {
+                        return false;
+                    }
+                    fState = fCInfo.buffered_image ? kFinishOutput_State : kFinishDecompress_State;
+                    break;
+                case kFinishOutput_State:
+                    if (!jpeg_finish_output(&fCInfo)) {
+                        return false;
+                    }
+                    fState = jpeg_input_complete(&fCInfo) &&
+                             fCInfo.output_scan_number == fCInfo.input_scan_number ?
+                             kFinishDecompress_State : kStartOutput_State;
+                    break;
+                case kFinishDecompress_State:
+                    return SkToBool(jpeg_finish_decompress(&fCInfo));
+            }
+        }
+    }
+
+    void onHeader() {
+        switch (fCInfo.jpeg_color_space) {
+            case JCS_CMYK:
+                // Fall through.
+            case JCS_YCCK:
+                // libjpeg cannot convert from CMYK or YCCK to RGB, so we get
+                // CMYK samples and convert them ourselves.
+                fCInfo.out_color_space = JCS_CMYK;
+                break;
+            default:
+                fCInfo.out_color_space = JCS_RGB;
+                break;
+        }
+        turn_off_visual_optimizations(&fCInfo);
+        fCInfo.buffered_image = jpeg_has_multiple_scans(&fCInfo);
+
+        if (!this->setInfo(fCInfo.image_width, fCInfo.image_height, kOpaque_SkAlphaType)) {
+            ERREXIT(&fCInfo, JERR_OUT_OF_MEMORY);
+        }
+        fRowStorage.reset(fCInfo.image_width * (JCS_CMYK == fCInfo.out_color_space ? 4 : 3));
+    }
+
+    // Returns false if the decoder suspended before the last scanline.
+    bool readScanlines() {
+        const int bytesPerPixel = JCS_CMYK == fCInfo.out_color_space ? 4 : 3;
+        while (fCInfo.output_scanline < fCInfo.output_height) {
+            JSAMPLE* rowPtr = (JSAMPLE*)fRowStorage.get();
+            if (0 == jpeg_read_scanlines(&fCInfo, &rowPtr, 1)) {
+                return false;
+            }
+            if (JCS_CMYK == fCInfo.out_color_space) {
+                convert_CMYK_to_RGB(rowPtr, fCInfo.output_width);
+            }
+            SkPMColor* dst = this->getRow(fCInfo.output_scanline - 1);
+            for (JDIMENSION x = 0; x < fCInfo.output_width; ++x, rowPtr += bytesPerPixel) {
+                dst[x] = SkPackARGB32(0xFF, rowPtr[0], rowPtr[1], rowPtr[2]);
+            }
+            this->markRowsDecoded(fCInfo.output_scanline);
+        }
+        return true;
+    }
+
+    jpeg_decompress_struct          fCInfo;
+    skjpeg_error_mgr                fErrorManager;
+    skjpeg_incremental_source_mgr   fSrcManager;
+    SkAutoMalloc                    fRowStorage;
+    State                           fState;
+    int                             fLastOutputScan;
+
+    typedef SkIncrementalImageDecoder INHERITED;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 static bool is_jpeg(SkStreamRewindable* stream) {
     static const unsigned char gHeader[] = { 0xFF, 0xD8, 0xFF };
     static const size_t HEADER_SIZE = sizeof(gHeader);
@@ -1237,6 +1718,11 @@ static SkImageEncoder* sk_libjpeg_efactory(SkImageEncoder::Type t) {
     return (SkImageEncoder::kJPEG_Type == t) ? SkNEW(SkJPEGImageEncoder) : NULL;
 }
 
+static SkIncrementalImageDecoder* sk_libjpeg_ifactory(SkImageDecoder::Format format) {
+    return (SkImageDecoder::kJPEG_Format == format) ? SkNEW(SkJPEGIncrementalDecoder) : NULL;
+}
+
 static SkImageDecoder_DecodeReg gDReg(sk_libjpeg_dfactory);
 static SkImageDecoder_FormatReg gFormatReg(get_format_jpeg);
 static SkImageEncoder_EncodeReg gEReg(sk_libjpeg_efactory);
+static SkIncrementalImageDecoder_Reg gIReg(sk_libjpeg_ifactory);
@@ -10,15 +10,23 @@
 #include "SkColor.h"
 #include "SkColorPriv.h"
 #include "SkDither.h"
+#include "SkIncrementalImageDecoder.h"
 #include "SkMath.h"
 #include "SkRTConf.h"
 #include "SkScaledBitmapSampler.h"
+#include "SkScaledBitmapSampler_opts.h"
 #include "SkStream.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
 #include "transform_scanline.h"
 extern "C" {
 #include "png.h"
+#include "zlib.h"
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
 }
 
 /* These were dropped in libpng >= 1.4 */
@@ -328,7 +336,9 @@ bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
     SkAlphaType alphaType = this->getRequireUnpremultipliedColors() ?
                                 kUnpremul_SkAlphaType : kPremul_SkAlphaType;
     const int sampleSize = this->getSampleSize();
-    SkScaledBitmapSampler sampler(origWidth, origHeight, sampleSize);
+    SkScaledBitmapSampler sampler = SkScaledBitmapSampler::ShouldFilter(*this, colorType) ?
+            SkScaledBitmapSampler(origWidth, origHeight, this->getTargetSize()) :
+            SkScaledBitmapSampler(origWidth, origHeight, sampleSize);
     decodedBitmap->setInfo(SkImageInfo::Make(sampler.scaledWidth(), sampler.scaledHeight(),
                                              colorType, alphaType));
 
@@ -412,7 +422,7 @@ bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
         if (!sampler.begin(decodedBitmap, sc, *this, ctLock.colors())) {
             return false;
         }
-        const int height = decodedBitmap->height();
+        const int rowCount = sampler.srcRowCount();
 
         if (number_passes > 1) {
             SkAutoMalloc storage(origWidth * origHeight * srcBytesPerPixel);
@@ -429,7 +439,7 @@ bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
             }
             // now sample it
             base += sampler.srcY0() * rowBytes;
-            for (int y = 0; y < height; y++) {
+            for (int y = 0; y < rowCount; y++) {
                 reallyHasAlpha |= sampler.next(base);
                 base += sampler.srcDY() * rowBytes;
             }
@@ -438,17 +448,17 @@ bool SkPNGImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* decodedBitmap,
             uint8_t* srcRow = (uint8_t*)storage.get();
             skip_src_rows(png_ptr, srcRow, sampler.srcY0());
 
-            for (int y = 0; y < height; y++) {
+            for (int y = 0; y < rowCount; y++) {
                 uint8_t* tmp = srcRow;
                 png_read_rows(png_ptr, &tmp, png_bytepp_NULL, 1);
                 reallyHasAlpha |= sampler.next(srcRow);
-                if (y < height - 1) {
+                if (y < rowCount - 1) {
                     skip_src_rows(png_ptr, srcRow, sampler.srcDY() - 1);
                 }
             }
 
             // skip the rest of the rows (if any)
-            png_uint_32 read = (height - 1) * sampler.srcDY() +
+            png_uint_32 read = (rowCount - 1) * sampler.srcDY() +
                                sampler.srcY0() + 1;
             SkASSERT(read <= origHeight);
             skip_src_rows(png_ptr, srcRow, origHeight - read);
@@ -1100,6 +1110,309 @@ static inline int pack_palette(SkColorTable* ctable,
     return num_trans;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Encoding with several threads splits the rows into strips that are filtered and deflated on
+// their own, pigz style. Every strip but the last ends with a sync flush, so that the raw deflate
+// streams can be concatenated, and takes the last 32K of the data before it as its dictionary,
+// so the output is barely bigger than that of a single stream. Each strip goes into its own IDAT.
+
+// How much filtered data goes into each strip.
+static const size_t kPNGStripSize = 128 * 1024;
+// How much of the previous strip a strip can refer back to.
+static const size_t kDeflateWindowSize = 32 * 1024;
+
+enum PNGFilter {
+    kNone_PNGFilter,
+    kSub_PNGFilter,
+    kUp_PNGFilter,
+    kAvg_PNGFilter,
+    kPaeth_PNGFilter,
+
+    kPNGFilterCount
+};
+
+static inline int paeth_predictor(int a, int b, int c) {
+    int pa = SkAbs32(b - c);
+    int pb = SkAbs32(a - c);
+    int pc = SkAbs32(a + b - 2 * c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Filters count bytes of row, given the unfiltered row above it in prev, into dst. The loops
+// only read the unfiltered rows, so that the compiler can vectorize them.
+static void filter_png_row(PNGFilter filter, const uint8_t* row, const uint8_t* prev, int bpp,
+                           int count, uint8_t* dst) {
+    switch (filter) {
+        case kNone_PNGFilter:
+            memcpy(dst, row, count);
+            break;
+        case kSub_PNGFilter:
+            memcpy(dst, row, bpp);
+            for (int i = bpp; i < count; ++i) {
+                dst[i] = row[i] - row[i - bpp];
+            }
+            break;
+        case kUp_PNGFilter:
+            for (int i = 0; i < count; ++i) {
+                dst[i] = row[i] - prev[i];
+            }
+            break;
+        case kAvg_PNGFilter:
+            for (int i = 0; i < bpp; ++i) {
+                dst[i] = row[i] - (prev[i] >> 1);
+            }
+            for (int i = bpp; i < count; ++i) {
+                dst[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1);
+            }
+            break;
+        case kPaeth_PNGFilter:
+            for (int i = 0; i < bpp; ++i) {
+                dst[i] = row[i] - prev[i];
+            }
+            for (int i = bpp; i < count; ++i) {
+                dst[i] = row[i] - paeth_predictor(row[i - bpp], prev[i], prev[i - bpp]);
+            }
+            break;
+        default:
+            SkASSERT(false);
+            break;
+    }
+}
+
+// The sum of the filtered bytes taken as signed, which libpng minimizes to pick a filter.
+static uint32_t png_row_cost(const uint8_t* row, int count) {
+    uint32_t cost = 0;
+    int i = 0;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sums = zero;
+    for (; i + 16 <= count; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        // As unsigned bytes, |b| is the smaller of b and -b.
+        __m128i abs = _mm_min_epu8(bytes, _mm_sub_epi8(zero, bytes));
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(abs, zero));
+    }
+    cost = _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+#endif
+    for (; i < count; ++i) {
+        cost += SkAbs32(static_cast<int8_t>(row[i]));
+    }
+    return cost;
+}
+
+namespace {
+
+struct PNGStrip {
+    PNGStrip() : fSize(0), fAdler(0), fSuccess(false) {}
+
+    SkAutoMalloc fStorage;
+    size_t       fSize;
+    uLong        fAdler;
+    bool         fSuccess;
+};
+
+// Transforms and filters the rows of each strip into the filtered image data.
+class PNGStripFilter : public SkParallelForBody {
+public:
+    PNGStripFilter(const SkBitmap& bitmap, transform_scanline_proc proc, int bpp,
+                   int rowsPerStrip, uint8_t* filtered)
+        : fBitmap(bitmap)
+        , fProc(proc)
+        , fBpp(bpp)
+        , fRowsPerStrip(rowsPerStrip)
+        , fFiltered(filtered) {}
+
+    virtual void run(int strip) SK_OVERRIDE {
+        const int rowBytes = fBitmap.width() * fBpp;
+        const int top = strip * fRowsPerStrip;
+        const int bottom = SkMin32(top + fRowsPerStrip, fBitmap.height());
+
+        SkAutoMalloc storage(4 * rowBytes);
+        uint8_t* prev = static_cast<uint8_t*>(storage.get());
+        uint8_t* row = prev + rowBytes;
+        uint8_t* best = row + rowBytes;
+        uint8_t* candidate = best + rowBytes;
+
+        if (top > 0) {
+            fProc(this->srcRow(top - 1), fBitmap.width(), reinterpret_cast<char*>(prev));
+        } else {
+            memset(prev, 0, rowBytes);
+        }
+        for (int y = top; y < bottom; ++y) {
+            fProc(this->srcRow(y), fBitmap.width(), reinterpret_cast<char*>(row));
+            PNGFilter bestFilter = kNone_PNGFilter;
+            uint32_t bestCost = SK_MaxU32;
+            for (int f = 0; f < kPNGFilterCount; ++f) {
+                filter_png_row((PNGFilter) f, row, prev, fBpp, rowBytes, candidate);
+                uint32_t cost = png_row_cost(candidate, rowBytes);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestFilter = (PNGFilter) f;
+                    SkTSwap(best, candidate);
+                }
+            }
+            uint8_t* dst = fFiltered + (size_t) y * (rowBytes + 1);
+            dst[0] = bestFilter;
+            memcpy(dst + 1, best, rowBytes);
+            SkTSwap(prev, row);
+        }
+    }
+
+private:
+    const char* srcRow(int y) const {
+        return static_cast<const char*>(fBitmap.getPixels()) + y * fBitmap.rowBytes();
+    }
+
+    const SkBitmap&               fBitmap;
+    const transform_scanline_proc fProc;
+    const int                     fBpp;
+    const int                     fRowsPerStrip;
+    uint8_t*                      fFiltered;
+};
+
+// Deflates the filtered data of each strip into its PNGStrip. The first strip leaves room for
+// the zlib header and the last for the adler32 trailer.
+class PNGStripDeflater : public SkParallelForBody {
+public:
+    PNGStripDeflater(const uint8_t* filtered, size_t stripSize, size_t totalSize,
+                     PNGStrip* strips, int stripCount)
+        : fFiltered(filtered)
+        , fStripSize(stripSize)
+        , fTotalSize(totalSize)
+        , fStrips(strips)
+        , fStripCount(stripCount) {}
+
+    virtual void run(int index) SK_OVERRIDE {
+        PNGStrip& strip = fStrips[index];
+        const bool last = fStripCount - 1 == index;
+        const size_t start = index * fStripSize;
+        const size_t length = last ? fTotalSize - start : fStripSize;
+        const uint8_t* data = fFiltered + start;
+        strip.fAdler = adler32(adler32(0L, Z_NULL, 0), data, length);
+
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        // Negative window bits for a raw stream, without zlib header or trailer.
+        if (Z_OK != deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_FILTERED)) {
+            return;
+        }
+        if (start > 0) {
+            const size_t dictSize = SkTMin(start, kDeflateWindowSize);
+            deflateSetDictionary(&zs, data - dictSize, dictSize);
+        }
+        // Room for the header, the sync flush marker and the trailer.
+        const size_t capacity = deflateBound(&zs, length) + 16;
+        uint8_t* out = static_cast<uint8_t*>(strip.fStorage.reset(capacity));
+        const size_t headerSize = 0 == index ? 2 : 0;
+        zs.next_in = const_cast<Bytef*>(data);
+        zs.avail_in = length;
+        zs.next_out = out + headerSize;
+        zs.avail_out = capacity - headerSize - 4;
+        int result = deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+        strip.fSuccess = last ? Z_STREAM_END == result
+                              : Z_OK == result && 0 == zs.avail_in && zs.avail_out > 0;
+        strip.fSize = headerSize + zs.total_out;
+        deflateEnd(&zs);
+    }
+
+private:
+    const uint8_t* fFiltered;
+    const size_t   fStripSize;
+    const size_t   fTotalSize;
+    PNGStrip*      fStrips;
+    const int      fStripCount;
+};
+
+}  // namespace
+
+static void write_be32(uint8_t* dst, uint32_t value) {
+    dst[0] = value >> 24;
+    dst[1] = value >> 16;
+    dst[2] = value >> 8;
+    dst[3] = value;
+}
+
+static bool write_png_chunk(SkWStream* stream, const char type[4], const void* data,
+                            size_t length) {
+    uint8_t header[8];
+    write_be32(header, SkToU32(length));
+    memcpy(header + 4, type, 4);
+    uLong crc = crc32(crc32(0L, Z_NULL, 0), header + 4, 4);
+    if (length > 0) {
+        // Careful, crc32() starts over when handed NULL.
+        crc = crc32(crc, static_cast<const Bytef*>(data), length);
+    }
+    uint8_t trailer[4];
+    write_be32(trailer, crc);
+    return stream->write(header, sizeof(header)) &&
+           (0 == length || stream->write(data, length)) &&
+           stream->write(trailer, sizeof(trailer));
+}
+
+/**
+ *  Writes the IDAT and IEND chunks of an 8-bit RGB or RGBA image with threadCount threads, after
+ *  libpng has written the chunks before them. If this fails before anything was written, e.g.
+ *  for lack of memory for the filtered image, wroteData is false and libpng can still take over.
+ */
+static bool write_png_image_data_in_parallel(SkWStream* stream, const SkBitmap& bitmap,
+                                             transform_scanline_proc proc, int bpp,
+                                             int rowsPerStrip, int threadCount,
+                                             bool* wroteData) {
+    *wroteData = false;
+    const size_t filteredRowBytes = bitmap.width() * bpp + 1;
+    const size_t stripSize = rowsPerStrip * filteredRowBytes;
+    const size_t totalSize = bitmap.height() * filteredRowBytes;
+    const int stripCount = (bitmap.height() + rowsPerStrip - 1) / rowsPerStrip;
+
+    SkAutoFree filteredStorage(sk_malloc_flags(totalSize, 0));
+    uint8_t* filtered = static_cast<uint8_t*>(filteredStorage.get());
+    if (NULL == filtered) {
+        return false;
+    }
+    SkAutoTArray<PNGStrip> strips(stripCount);
+    {
+        SkThreadPool pool(threadCount);
+        SkTaskGroup group(&pool);
+        PNGStripFilter filter(bitmap, proc, bpp, rowsPerStrip, filtered);
+        group.parallelFor(0, stripCount, &filter);
+        group.wait();
+        PNGStripDeflater deflater(filtered, stripSize, totalSize, strips.get(), stripCount);
+        group.parallelFor(0, stripCount, &deflater);
+        group.wait();
+    }
+
+    uLong adler = strips[0].fAdler;
+    for (int i = 0; i < stripCount; ++i) {
+        if (!strips[i].fSuccess) {
+            return false;
+        }
+        if (i > 0) {
+            const size_t length = i == stripCount - 1 ? totalSize - i * stripSize : stripSize;
+            adler = adler32_combine(adler, strips[i].fAdler, length);
+        }
+    }
+
+    uint8_t* first = static_cast<uint8_t*>(strips[0].fStorage.get());
+    // A 32K window and the default compression level.
+    first[0] = 0x78;
+    first[1] = 0x9C;
+    PNGStrip& last = strips[stripCount - 1];
+    write_be32(static_cast<uint8_t*>(last.fStorage.get()) + last.fSize, adler);
+    last.fSize += 4;
+
+    *wroteData = true;
+    for (int i = 0; i < stripCount; ++i) {
+        if (!write_png_chunk(stream, "IDAT", strips[i].fStorage.get(), strips[i].fSize)) {
+            return false;
+        }
+    }
+    return write_png_chunk(stream, "IEND", NULL, 0);
+}
+
 class SkPNGImageEncoder : public SkImageEncoder {
 protected:
     virtual bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) SK_OVERRIDE;
@@ -1233,10 +1546,26 @@ bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
     png_set_sBIT(png_ptr, info_ptr, &sig_bit);
     png_write_info(png_ptr, info_ptr);
 
+    transform_scanline_proc proc = choose_proc(ct, hasAlpha);
+
+    // Splitting the image pays off once there are a few strips to go around.
+    const int bpp = hasAlpha ? 4 : 3;
+    const int rowsPerStrip = SkMax32(1, SkToInt(kPNGStripSize / (bitmap.width() * bpp + 1)));
+    if (this->getThreadCount() > 1 && 8 == bitDepth &&
+        !(colorType & PNG_COLOR_MASK_PALETTE) && bitmap.height() >= 2 * rowsPerStrip) {
+        bool wroteData;
+        bool success = write_png_image_data_in_parallel(stream, bitmap, proc, bpp, rowsPerStrip,
+                                                        this->getThreadCount(), &wroteData);
+        if (wroteData) {
+            // libpng has nothing left to write, the IEND chunk is already out.
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            return success;
+        }
+    }
+
     const char* srcImage = (const char*)bitmap.getPixels();
     SkAutoSMalloc<1024> rowStorage(bitmap.width() << 2);
     char* storage = (char*)rowStorage.get();
-    transform_scanline_proc proc = choose_proc(ct, hasAlpha);
 
     for (int y = 0; y < bitmap.height(); y++) {
         png_bytep row_ptr = (png_bytep)storage;
@@ -1252,6 +1581,148 @@ bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
     return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Decodes PNGs pushed a chunk at a time through libpng's progressive reader.
+// Every row is expanded to 8-bit RGBA by libpng and then premultiplied into
+// the N32 pixels.
+class SkPNGIncrementalDecoder : public SkIncrementalImageDecoder {
+public:
+    SkPNGIncrementalDecoder()
+        : fPng_ptr(NULL)
+        , fInfo_ptr(NULL)
+        , fRowProc(NULL)
+        , fInterlaced(false)
+        , fComplete(false) {
+        fPng_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, sk_error_fn,
+                                          c_suppressPNGImageDecoderWarnings ?
+                                          &do_nothing_warning_fn : NULL);
+        if (NULL != fPng_ptr) {
+            fInfo_ptr = png_create_info_struct(fPng_ptr);
+            png_set_progressive_read_fn(fPng_ptr, this, info_callback, row_callback,
+                                        end_callback);
+        }
+    }
+
+    virtual ~SkPNGIncrementalDecoder() {
+        png_destroy_read_struct(&fPng_ptr, &fInfo_ptr, png_infopp_NULL);
+    }
+
+    virtual SkImageDecoder::Format getFormat() const SK_OVERRIDE {
+        return SkImageDecoder::kPNG_Format;
+    }
+
+protected:
+    virtual Status onAppend(const void* data, size_t length) SK_OVERRIDE {
+        if (NULL == fInfo_ptr) {
+            return kError_Status;
+        }
+        if (setjmp(png_jmpbuf(fPng_ptr))) {
+            return kError_Status;
+        }
+        png_process_data(fPng_ptr, fInfo_ptr, (png_bytep)data, length);
+        return fComplete ? kComplete_Status : kNeedMoreData_Status;
+    }
+
+private:
+    static SkPNGIncrementalDecoder* Get(png_structp png_ptr) {
+        return (SkPNGIncrementalDecoder*)png_get_progressive_ptr(png_ptr);
+    }
+
+    static void info_callback(png_structp png_ptr, png_infop info_ptr) {
+        Get(png_ptr)->onInfo(info_ptr);
+    }
+
+    static void row_callback(png_structp png_ptr, png_bytep row, png_uint_32 y, int) {
+        Get(png_ptr)->onRow(row, y);
+    }
+
+    static void end_callback(png_structp png_ptr, png_infop) {
+        Get(png_ptr)->fComplete = true;
+    }
+
+    void onInfo(png_infop info_ptr) {
+        png_uint_32 width, height;
+        int bitDepth, pngColorType, interlaceType;
+        png_get_IHDR(fPng_ptr, info_ptr, &width, &height, &bitDepth, &pngColorType,
+                     &interlaceType, int_p_NULL, int_p_NULL);
+
+        // Have libpng hand out 8-bit RGBA rows whatever the source format.
+        if (16 == bitDepth) {
+            png_set_strip_16(fPng_ptr);
+        }
+        if (PNG_COLOR_TYPE_PALETTE == pngColorType) {
+            png_set_palette_to_rgb(fPng_ptr);
+        }
+        if (PNG_COLOR_TYPE_GRAY == pngColorType && bitDepth < 8) {
+            png_set_expand_gray_1_2_4_to_8(fPng_ptr);
+        }
+        bool hasAlpha = SkToBool(pngColorType & PNG_COLOR_MASK_ALPHA);
+        if (png_get_valid(fPng_ptr, info_ptr, PNG_INFO_tRNS)) {
+            png_set_tRNS_to_alpha(fPng_ptr);
+            hasAlpha = true;
+        }
+        if (!(pngColorType & PNG_COLOR_MASK_COLOR)) {
+            png_set_gray_to_rgb(fPng_ptr);
+        }
+        if (!hasAlpha) {
+            png_set_filler(fPng_ptr, 0xFF, PNG_FILLER_AFTER);
+        }
+        fInterlaced = PNG_INTERLACE_NONE != interlaceType;
+        if (fInterlaced) {
+            png_set_interlace_handling(fPng_ptr);
+        }
+        png_read_update_info(fPng_ptr, info_ptr);
+
+        if (png_get_rowbytes(fPng_ptr, info_ptr) != width * 4 ||
+            !this->setInfo(width, height, hasAlpha ? kPremul_SkAlphaType : kOpaque_SkAlphaType)) {
+            png_error(fPng_ptr, "cannot allocate incremental pixels");
+        }
+        // Later passes of an interlaced image are combined with the RGBA rows of the earlier
+        // ones, so those have to be kept around.
+        if (fInterlaced) {
+            fInterlacedRows.reset(height * width * 4);
+        }
+
+        fRowProc = SkSampleRowGetPlatformProc(kRGBA_D8888_SkSampleRowProcType);
+    }
+
+    void onRow(png_bytep row, png_uint_32 y) {
+        if (NULL == row) {
+            // Nothing new for this row in this pass.
+            return;
+        }
+        SkPMColor* dst = this->getRow(y);
+        int width = this->getRowWidth();
+        if (fInterlaced) {
+            png_bytep combined = (png_bytep)fInterlacedRows.get() + y * width * 4;
+            png_progressive_combine_row(fPng_ptr, combined, row);
+            row = combined;
+        }
+        if (NULL != fRowProc) {
+            fRowProc(dst, row, width, 4, y, NULL);
+        } else {
+            for (int x = 0; x < width; ++x, row += 4) {
+                dst[x] = SkPreMultiplyARGB(row[3], row[0], row[1], row[2]);
+            }
+        }
+        this->markRowsDecoded(y + 1);
+    }
+
+    int getRowWidth() const {
+        return png_get_image_width(fPng_ptr, fInfo_ptr);
+    }
+
+    png_structp     fPng_ptr;
+    png_infop       fInfo_ptr;
+    SkSampleRowProc fRowProc;
+    SkAutoMalloc    fInterlacedRows;
+    bool            fInterlaced;
+    bool            fComplete;
+
+    typedef SkIncrementalImageDecoder INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 DEFINE_DECODER_CREATOR(PNGImageDecoder);
 DEFINE_ENCODER_CREATOR(PNGImageEncoder);
@@ -1284,6 +1755,11 @@ SkImageEncoder* sk_libpng_efactory(SkImageEncoder::Type t) {
     return (SkImageEncoder::kPNG_Type == t) ? SkNEW(SkPNGImageEncoder) : NULL;
 }
 
+static SkIncrementalImageDecoder* sk_libpng_ifactory(SkImageDecoder::Format format) {
+    return (SkImageDecoder::kPNG_Format == format) ? SkNEW(SkPNGIncrementalDecoder) : NULL;
+}
+
 static SkImageDecoder_DecodeReg gDReg(sk_libpng_dfactory);
 static SkImageDecoder_FormatReg gFormatReg(get_format_png);
 static SkImageEncoder_EncodeReg gEReg(sk_libpng_efactory);
+static SkIncrementalImageDecoder_Reg gIReg(sk_libpng_ifactory);
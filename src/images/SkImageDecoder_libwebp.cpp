@@ -17,6 +17,7 @@
 #include "SkImageDecoder.h"
 #include "SkImageEncoder.h"
 #include "SkColorPriv.h"
+#include "SkIncrementalImageDecoder.h"
 #include "SkScaledBitmapSampler.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
@@ -654,6 +655,97 @@ bool SkWEBPImageEncoder::onEncode(SkWStream* stream, const SkBitmap& bm,
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Decodes WebPs pushed a chunk at a time through libwebp's incremental
+// decoder, which writes straight into the N32 pixels.
+class SkWEBPIncrementalDecoder : public SkIncrementalImageDecoder {
+public:
+    SkWEBPIncrementalDecoder() : fIDec(NULL) {}
+
+    virtual ~SkWEBPIncrementalDecoder() {
+        if (NULL != fIDec) {
+            WebPIDelete(fIDec);
+            WebPFreeDecBuffer(&fConfig.output);
+        }
+    }
+
+    virtual SkImageDecoder::Format getFormat() const SK_OVERRIDE {
+        return SkImageDecoder::kWEBP_Format;
+    }
+
+protected:
+    virtual Status onAppend(const void* data, size_t length) SK_OVERRIDE {
+        if (NULL == fIDec) {
+            // Hold on to the data until the header is complete.
+            fHeader.append(SkToInt(length), (const uint8_t*)data);
+            WebPBitstreamFeatures features;
+            VP8StatusCode status = WebPGetFeatures(fHeader.begin(), fHeader.count(), &features);
+            if (VP8_STATUS_NOT_ENOUGH_DATA == status) {
+                return kNeedMoreData_Status;
+            }
+            if (VP8_STATUS_OK != status || !this->startDecode(features)) {
+                return kError_Status;
+            }
+            data = fHeader.begin();
+            length = fHeader.count();
+        }
+
+        VP8StatusCode status = WebPIAppend(fIDec, (const uint8_t*)data, length);
+        fHeader.reset();
+
+        int lastY;
+        if (NULL != WebPIDecGetRGB(fIDec, &lastY, NULL, NULL, NULL)) {
+            this->markRowsDecoded(lastY);
+        }
+        switch (status) {
+            case VP8_STATUS_OK:
+                return kComplete_Status;
+            case VP8_STATUS_SUSPENDED:
+                return kNeedMoreData_Status;
+            default:
+                return kError_Status;
+        }
+    }
+
+private:
+    bool startDecode(const WebPBitstreamFeatures& features) {
+        int64_t size = sk_64_mul(features.width, features.height);
+        if (!sk_64_isS32(size) || sk_64_asS32(size) > (0x7FFFFFFF >> 2)) {
+            return false;
+        }
+        const bool hasAlpha = SkToBool(features.has_alpha);
+        if (!this->setInfo(features.width, features.height,
+                           hasAlpha ? kPremul_SkAlphaType : kOpaque_SkAlphaType)) {
+            return false;
+        }
+        if (0 == WebPInitDecoderConfig(&fConfig)) {
+            return false;
+        }
+        // libwebp keeps pointers to the config, so it lives as long as fIDec.
+        #if SK_PMCOLOR_BYTE_ORDER(B,G,R,A)
+            fConfig.output.colorspace = hasAlpha ? MODE_bgrA : MODE_BGRA;
+        #elif SK_PMCOLOR_BYTE_ORDER(R,G,B,A)
+            fConfig.output.colorspace = hasAlpha ? MODE_rgbA : MODE_RGBA;
+        #else
+            #error "Skia uses BGRA or RGBA byte order"
+        #endif
+        fConfig.output.u.RGBA.rgba = (uint8_t*)this->getRow(0);
+        fConfig.output.u.RGBA.stride = features.width * 4;
+        fConfig.output.u.RGBA.size = features.width * features.height * 4;
+        fConfig.output.is_external_memory = 1;
+
+        fIDec = WebPIDecode(NULL, 0, &fConfig);
+        return NULL != fIDec;
+    }
+
+    SkTDArray<uint8_t>  fHeader;
+    WebPDecoderConfig   fConfig;
+    WebPIDecoder*       fIDec;
+
+    typedef SkIncrementalImageDecoder INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 DEFINE_DECODER_CREATOR(WEBPImageDecoder);
 DEFINE_ENCODER_CREATOR(WEBPImageEncoder);
@@ -681,6 +773,11 @@ static SkImageEncoder* sk_libwebp_efactory(SkImageEncoder::Type t) {
       return (SkImageEncoder::kWEBP_Type == t) ? SkNEW(SkWEBPImageEncoder) : NULL;
 }
 
+static SkIncrementalImageDecoder* sk_libwebp_ifactory(SkImageDecoder::Format format) {
+    return (SkImageDecoder::kWEBP_Format == format) ? SkNEW(SkWEBPIncrementalDecoder) : NULL;
+}
+
 static SkImageDecoder_DecodeReg gDReg(sk_libwebp_dfactory);
 static SkImageDecoder_FormatReg gFormatReg(get_format_webp);
 static SkImageEncoder_EncodeReg gEReg(sk_libwebp_efactory);
+static SkIncrementalImageDecoder_Reg gIReg(sk_libwebp_ifactory);
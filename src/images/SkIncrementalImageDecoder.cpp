@@ -0,0 +1,101 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkIncrementalImageDecoder.h"
+
+SkIncrementalImageDecoder::SkIncrementalImageDecoder()
+    : fStatus(kNeedMoreData_Status)
+    , fDecodedRowCount(0) {
+}
+
+SkIncrementalImageDecoder::~SkIncrementalImageDecoder() {
+}
+
+SkIncrementalImageDecoder::Status SkIncrementalImageDecoder::append(const void* data,
+                                                                    size_t length) {
+    SkAutoMutexAcquire ama(fMutex);
+    if (kNeedMoreData_Status == fStatus && length > 0) {
+        fStatus = this->onAppend(data, length);
+    }
+    return fStatus;
+}
+
+SkIncrementalImageDecoder::Status SkIncrementalImageDecoder::getStatus() const {
+    SkAutoMutexAcquire ama(fMutex);
+    return fStatus;
+}
+
+bool SkIncrementalImageDecoder::getInfo(SkImageInfo* info) const {
+    SkAutoMutexAcquire ama(fMutex);
+    if (NULL == fBitmap.getPixels()) {
+        return false;
+    }
+    *info = fBitmap.info();
+    return true;
+}
+
+int SkIncrementalImageDecoder::getDecodedRowCount() const {
+    SkAutoMutexAcquire ama(fMutex);
+    return fDecodedRowCount;
+}
+
+bool SkIncrementalImageDecoder::readPixels(const SkImageInfo& info, void* pixels,
+                                           size_t rowBytes) const {
+    SkAutoMutexAcquire ama(fMutex);
+    if (NULL == fBitmap.getPixels() || info != fBitmap.info()) {
+        return false;
+    }
+    return fBitmap.copyPixelsTo(pixels, rowBytes * info.height(), rowBytes);
+}
+
+bool SkIncrementalImageDecoder::setInfo(int width, int height, SkAlphaType alphaType) {
+    SkASSERT(NULL == fBitmap.getPixels());
+    if (!fBitmap.allocPixels(SkImageInfo::MakeN32(width, height, alphaType))) {
+        return false;
+    }
+    fBitmap.eraseColor(SK_ColorTRANSPARENT);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+class IncrementalImageGenerator : public SkImageGenerator {
+public:
+    IncrementalImageGenerator(SkIncrementalImageDecoder* decoder, const SkImageInfo& info)
+        : fDecoder(SkRef(decoder))
+        , fInfo(info) {
+    }
+
+protected:
+    virtual bool onGetInfo(SkImageInfo* info) SK_OVERRIDE {
+        *info = fInfo;
+        return true;
+    }
+
+    virtual bool onGetPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                             SkPMColor ctable[], int* ctableCount) SK_OVERRIDE {
+        return fDecoder->readPixels(info, pixels, rowBytes);
+    }
+
+private:
+    SkAutoTUnref<SkIncrementalImageDecoder> fDecoder;
+    const SkImageInfo                       fInfo;
+
+    typedef SkImageGenerator INHERITED;
+};
+
+}  // namespace
+
+SkImageGenerator* SkIncrementalImageDecoder::newGenerator() {
+    SkImageInfo info;
+    if (!this->getInfo(&info)) {
+        return NULL;
+    }
+    return SkNEW_ARGS(IncrementalImageGenerator, (this, info));
+}
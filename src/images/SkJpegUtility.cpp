@@ -116,6 +116,58 @@ skjpeg_source_mgr::~skjpeg_source_mgr() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static void sk_init_incremental_source(j_decompress_ptr /*cinfo*/) {}
+
+static boolean sk_fill_incremental_input_buffer(j_decompress_ptr /*cinfo*/) {
+    // Suspend until more data is appended.
+    return FALSE;
+}
+
+static void sk_skip_incremental_input_data(j_decompress_ptr cinfo, long num_bytes) {
+    skjpeg_incremental_source_mgr* src = (skjpeg_incremental_source_mgr*)cinfo->src;
+
+    if (num_bytes <= 0) {
+        return;
+    }
+    if (num_bytes > (long)src->bytes_in_buffer) {
+        src->fSkipBytes += num_bytes - src->bytes_in_buffer;
+        src->next_input_byte += src->bytes_in_buffer;
+        src->bytes_in_buffer = 0;
+    } else {
+        src->next_input_byte += num_bytes;
+        src->bytes_in_buffer -= num_bytes;
+    }
+}
+
+skjpeg_incremental_source_mgr::skjpeg_incremental_source_mgr()
+    : fSkipBytes(0) {
+    init_source = sk_init_incremental_source;
+    fill_input_buffer = sk_fill_incremental_input_buffer;
+    skip_input_data = sk_skip_incremental_input_data;
+    resync_to_restart = jpeg_resync_to_restart;
+    term_source = sk_term_source;
+#ifdef SK_BUILD_FOR_ANDROID
+    seek_input_data = NULL;
+#endif
+    next_input_byte = NULL;
+    bytes_in_buffer = 0;
+}
+
+void skjpeg_incremental_source_mgr::append(const void* data, size_t length) {
+    // Drop what the decoder has consumed. After a suspension it resumes at
+    // next_input_byte, so the unconsumed bytes are the last ones of fBuffer.
+    fBuffer.remove(0, fBuffer.count() - SkToInt(bytes_in_buffer));
+
+    size_t skip = SkTMin(fSkipBytes, length);
+    fSkipBytes -= skip;
+    fBuffer.append(SkToInt(length - skip), (const uint8_t*)data + skip);
+
+    next_input_byte = (const JOCTET*)fBuffer.begin();
+    bytes_in_buffer = fBuffer.count();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 static void sk_init_destination(j_compress_ptr cinfo) {
     skjpeg_destination_mgr* dest = (skjpeg_destination_mgr*)cinfo->dest;
 
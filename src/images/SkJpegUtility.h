@@ -12,6 +12,7 @@
 
 #include "SkImageDecoder.h"
 #include "SkStream.h"
+#include "SkTDArray.h"
 
 extern "C" {
     #include "jpeglib.h"
@@ -48,6 +49,21 @@ struct skjpeg_source_mgr : jpeg_source_mgr {
     char    fBuffer[kBufferSize];
 };
 
+/* Our source struct for decoding data that is pushed to us a chunk at a time.
+ * When it runs out of the data appended so far, it suspends the decoder,
+ * which then returns JPEG_SUSPENDED or FALSE to the caller.
+ */
+struct skjpeg_incremental_source_mgr : jpeg_source_mgr {
+    skjpeg_incremental_source_mgr();
+
+    // Appends data after the bytes the decoder hasn't consumed yet.
+    void append(const void* data, size_t length);
+
+    SkTDArray<uint8_t>  fBuffer;
+    // Bytes the decoder asked to skip past the end of fBuffer.
+    size_t              fSkipBytes;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 /* Our destination struct for directing decompressed pixels to our stream
  * object.
@@ -80,6 +80,11 @@ const SkBitmap& SkMovie::bitmap()
     return fBitmap;
 }
 
+void SkMovie::setDecodeAheadPool(SkThreadPool* pool)
+{
+    this->onSetDecodeAheadPool(pool);
+}
+
 ////////////////////////////////////////////////////////////////////
 
 #include "SkStream.h"
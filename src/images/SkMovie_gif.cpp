@@ -10,12 +10,24 @@
 #include "SkMovie.h"
 #include "SkColor.h"
 #include "SkColorPriv.h"
+#include "SkDiscardableMemory.h"
+#include "SkRunnable.h"
 #include "SkStream.h"
+#include "SkTaskGroup.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
+#include "SkThread.h"
 #include "SkUtils.h"
 
 #include "gif_lib.h"
 
+// Composited frames are kept in discardable memory, up to this many bytes per
+// movie, so that seeking and looping can start from the closest cached frame
+// instead of compositing every frame from the first one again.
+#ifndef SK_DEFAULT_GIF_MOVIE_FRAME_CACHE_LIMIT
+    #define SK_DEFAULT_GIF_MOVIE_FRAME_CACHE_LIMIT  (4 * 1024 * 1024)
+#endif
+
 class SkGIFMovie : public SkMovie {
 public:
     SkGIFMovie(SkStream* stream);
@@ -25,12 +37,34 @@ protected:
     virtual bool onGetInfo(Info*);
     virtual bool onSetTime(SkMSec);
     virtual bool onGetBitmap(SkBitmap*);
+    virtual void onSetDecodeAheadPool(SkThreadPool*);
 
 private:
+    class DecodeAheadTask;
+
+    struct CachedFrame {
+        int                     fIndex;
+        SkDiscardableMemory*    fPixels;
+    };
+
+    void compositeFrame(int index, SkBitmap* bm, SkBitmap* backup, int* drawnIndex);
+    int readClosestCachedFrame(int after, int index, SkBitmap* bm);
+    bool hasCachedFrame(int index);
+    void cacheFrame(int index, const SkBitmap& bm);
+    void decodeAhead(int index);
+
     GifFileType* fGIF;
     int fCurrIndex;
     int fLastDrawIndex;
     SkBitmap fBackup;
+    SkColor fPaintingColor;
+
+    SkMutex fCacheMutex;
+    // Guarded by fCacheMutex, oldest first.
+    SkTDArray<CachedFrame> fCache;
+    // The frame being decoded ahead, or -1. Guarded by fCacheMutex.
+    int fDecodeAheadIndex;
+    SkAutoTDelete<SkTaskGroup> fDecodeAheadTasks;
 };
 
 static int Decode(GifFileType* fileType, GifByteType* out, int size) {
@@ -38,8 +72,15 @@ static int Decode(GifFileType* fileType, GifByteType* out, int size) {
     return (int) stream->read(out, size);
 }
 
+static void getTransparencyAndDisposalMethod(const SavedImage* frame, bool* trans, int* disposal);
+
 SkGIFMovie::SkGIFMovie(SkStream* stream)
 {
+    fCurrIndex = -1;
+    fLastDrawIndex = -1;
+    fPaintingColor = SK_ColorTRANSPARENT;
+    fDecodeAheadIndex = -1;
+
 #if GIFLIB_MAJOR < 5
     fGIF = DGifOpen( stream, Decode );
 #else
@@ -52,13 +93,28 @@ SkGIFMovie::SkGIFMovie(SkStream* stream)
     {
         DGifCloseFile(fGIF);
         fGIF = NULL;
+        return;
+    }
+
+    // The color the first frame is drawn on.
+    if (fGIF->ImageCount > 0 && fGIF->SColorMap != NULL) {
+        bool trans;
+        int disposal;
+        getTransparencyAndDisposalMethod(&fGIF->SavedImages[0], &trans, &disposal);
+        if (!trans) {
+            const GifColorType& col = fGIF->SColorMap->Colors[fGIF->SBackGroundColor];
+            fPaintingColor = SkColorSetARGB(0xFF, col.Red, col.Green, col.Blue);
+        }
     }
-    fCurrIndex = -1;
-    fLastDrawIndex = -1;
 }
 
 SkGIFMovie::~SkGIFMovie()
 {
+    // Wait for the frames being decoded ahead before letting go of the GIF.
+    fDecodeAheadTasks.free();
+    for (int i = 0; i < fCache.count(); i++) {
+        SkDELETE(fCache[i].fPixels);
+    }
     if (fGIF)
         DGifCloseFile(fGIF);
 }
@@ -336,6 +392,156 @@ static void disposeFrameIfNeeded(SkBitmap* bm, const SavedImage* cur, const Save
     }
 }
 
+// Composites frame 'index' into bm. bm holds frame *drawnIndex, or nothing if
+// that is -1, and backup holds what frames that restore to the previous one
+// restore to. On return *drawnIndex is 'index'.
+void SkGIFMovie::compositeFrame(int index, SkBitmap* bm, SkBitmap* backup, int* drawnIndex)
+{
+    if (*drawnIndex > index) {
+        // rewind to 1st frame for repeat
+        *drawnIndex = -1;
+    }
+
+    // Start from the cached frame closest to 'index', if it is closer than the
+    // frame already drawn.
+    int cachedIndex = this->readClosestCachedFrame(*drawnIndex, index, bm);
+    if (cachedIndex >= 0) {
+        *drawnIndex = cachedIndex;
+    }
+
+    // draw each frames - not intelligent way
+    for (int i = *drawnIndex + 1; i <= index; i++) {
+        const SavedImage* cur = &fGIF->SavedImages[i];
+        if (i == 0) {
+            bm->eraseColor(fPaintingColor);
+            backup->eraseColor(fPaintingColor);
+        } else {
+            // Dispose previous frame before move to next frame.
+            const SavedImage* prev = &fGIF->SavedImages[i-1];
+            disposeFrameIfNeeded(bm, prev, cur, backup, fPaintingColor);
+        }
+
+        // Draw frame
+        // We can skip this process if this index is not last and disposal
+        // method == 2 or method == 3
+        if (i == index || !checkIfWillBeCleared(cur)) {
+            drawFrame(bm, cur, fGIF->SColorMap);
+        }
+    }
+    *drawnIndex = index;
+}
+
+// Copies the cached frame in (after, index] closest to 'index' into bm, and
+// returns its index, or -1 if there is none.
+int SkGIFMovie::readClosestCachedFrame(int after, int index, SkBitmap* bm)
+{
+    SkAutoMutexAcquire ama(fCacheMutex);
+    for (;;) {
+        int closest = -1;
+        for (int i = 0; i < fCache.count(); i++) {
+            const int cachedIndex = fCache[i].fIndex;
+            if (cachedIndex <= after || cachedIndex > index ||
+                (closest >= 0 && cachedIndex < fCache[closest].fIndex)) {
+                continue;
+            }
+            // Going on from a frame that restores to the previous one would
+            // need that previous frame too.
+            bool trans;
+            int disposal;
+            getTransparencyAndDisposalMethod(&fGIF->SavedImages[cachedIndex], &trans, &disposal);
+            if (cachedIndex == index || disposal != 3) {
+                closest = i;
+            }
+        }
+        if (closest < 0) {
+            return -1;
+        }
+
+        SkDiscardableMemory* pixels = fCache[closest].fPixels;
+        if (pixels->lock()) {
+            memcpy(bm->getPixels(), pixels->data(), bm->getSize());
+            pixels->unlock();
+            return fCache[closest].fIndex;
+        }
+        // Purged, look for another one.
+        SkDELETE(pixels);
+        fCache.remove(closest);
+    }
+}
+
+bool SkGIFMovie::hasCachedFrame(int index)
+{
+    for (int i = 0; i < fCache.count(); i++) {
+        if (fCache[i].fIndex == index) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SkGIFMovie::cacheFrame(int index, const SkBitmap& bm)
+{
+    const size_t size = bm.getSize();
+    if (fGIF->ImageCount < 2 || size > SK_DEFAULT_GIF_MOVIE_FRAME_CACHE_LIMIT) {
+        return;
+    }
+
+    SkAutoMutexAcquire ama(fCacheMutex);
+    if (this->hasCachedFrame(index)) {
+        return;
+    }
+    // Returned locked.
+    SkDiscardableMemory* pixels = SkDiscardableMemory::Create(size);
+    if (NULL == pixels) {
+        return;
+    }
+    memcpy(pixels->data(), bm.getPixels(), size);
+    pixels->unlock();
+
+    CachedFrame* frame = fCache.append();
+    frame->fIndex = index;
+    frame->fPixels = pixels;
+    while (fCache.count() * size > SK_DEFAULT_GIF_MOVIE_FRAME_CACHE_LIMIT) {
+        SkDELETE(fCache[0].fPixels);
+        fCache.remove(0);
+    }
+}
+
+// Composites a frame into the cache on a pool thread. Deletes itself.
+class SkGIFMovie::DecodeAheadTask : public SkRunnable {
+public:
+    DecodeAheadTask(SkGIFMovie* movie, int index) : fMovie(movie), fIndex(index) {}
+
+    virtual void run() SK_OVERRIDE {
+        fMovie->decodeAhead(fIndex);
+        SkDELETE(this);
+    }
+
+private:
+    SkGIFMovie* fMovie;
+    int         fIndex;
+};
+
+void SkGIFMovie::decodeAhead(int index)
+{
+    SkImageInfo info = SkImageInfo::MakeN32Premul(fGIF->SWidth, fGIF->SHeight);
+    SkBitmap bm, backup;
+    if (bm.allocPixels(info) && backup.allocPixels(info)) {
+        int drawnIndex = -1;
+        this->compositeFrame(index, &bm, &backup, &drawnIndex);
+        this->cacheFrame(index, bm);
+    }
+
+    SkAutoMutexAcquire ama(fCacheMutex);
+    fDecodeAheadIndex = -1;
+}
+
+void SkGIFMovie::onSetDecodeAheadPool(SkThreadPool* pool)
+{
+    // The old group waits for its tasks when it is deleted.
+    fDecodeAheadTasks.reset(NULL != pool ? SkNEW_ARGS(SkTaskGroup, (pool)) : NULL);
+}
+
 bool SkGIFMovie::onGetBitmap(SkBitmap* bm)
 {
     const GifFileType* gif = fGIF;
@@ -357,12 +563,9 @@ bool SkGIFMovie::onGetBitmap(SkBitmap* bm)
         return true;
     }
 
-    int startIndex = fLastDrawIndex + 1;
     if (fLastDrawIndex < 0 || !bm->readyToDraw()) {
         // first time
 
-        startIndex = 0;
-
         // create bitmap
         if (!bm->allocPixels(SkImageInfo::MakeN32Premul(width, height))) {
             return false;
@@ -371,9 +574,7 @@ bool SkGIFMovie::onGetBitmap(SkBitmap* bm)
         if (!fBackup.allocPixels(SkImageInfo::MakeN32Premul(width, height))) {
             return false;
         }
-    } else if (startIndex > fCurrIndex) {
-        // rewind to 1st frame for repeat
-        startIndex = 0;
+        fLastDrawIndex = -1;
     }
 
     int lastIndex = fCurrIndex;
@@ -385,44 +586,18 @@ bool SkGIFMovie::onGetBitmap(SkBitmap* bm)
         lastIndex = fGIF->ImageCount - 1;
     }
 
-    SkColor bgColor = SkPackARGB32(0, 0, 0, 0);
-    if (gif->SColorMap != NULL) {
-        const GifColorType& col = gif->SColorMap->Colors[fGIF->SBackGroundColor];
-        bgColor = SkColorSetARGB(0xFF, col.Red, col.Green, col.Blue);
-    }
+    this->compositeFrame(lastIndex, bm, &fBackup, &fLastDrawIndex);
+    this->cacheFrame(lastIndex, *bm);
 
-    static SkColor paintingColor = SkPackARGB32(0, 0, 0, 0);
-    // draw each frames - not intelligent way
-    for (int i = startIndex; i <= lastIndex; i++) {
-        const SavedImage* cur = &fGIF->SavedImages[i];
-        if (i == 0) {
-            bool trans;
-            int disposal;
-            getTransparencyAndDisposalMethod(cur, &trans, &disposal);
-            if (!trans && gif->SColorMap != NULL) {
-                paintingColor = bgColor;
-            } else {
-                paintingColor = SkColorSetARGB(0, 0, 0, 0);
-            }
-
-            bm->eraseColor(paintingColor);
-            fBackup.eraseColor(paintingColor);
-        } else {
-            // Dispose previous frame before move to next frame.
-            const SavedImage* prev = &fGIF->SavedImages[i-1];
-            disposeFrameIfNeeded(bm, prev, cur, &fBackup, paintingColor);
-        }
-
-        // Draw frame
-        // We can skip this process if this index is not last and disposal
-        // method == 2 or method == 3
-        if (i == lastIndex || !checkIfWillBeCleared(cur)) {
-            drawFrame(bm, cur, gif->SColorMap);
+    // Get the next frame ready while this one is shown.
+    if (fDecodeAheadTasks.get() != NULL && gif->ImageCount > 1) {
+        const int nextIndex = (lastIndex + 1) % gif->ImageCount;
+        SkAutoMutexAcquire ama(fCacheMutex);
+        if (-1 == fDecodeAheadIndex && !this->hasCachedFrame(nextIndex)) {
+            fDecodeAheadIndex = nextIndex;
+            fDecodeAheadTasks->add(SkNEW_ARGS(DecodeAheadTask, (this, nextIndex)));
         }
     }
-
-    // save index
-    fLastDrawIndex = lastIndex;
     return true;
 }
 
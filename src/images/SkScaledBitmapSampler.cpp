@@ -10,6 +10,7 @@
 #include "SkBitmap.h"
 #include "SkColorPriv.h"
 #include "SkDither.h"
+#include "SkScaledBitmapSampler_opts.h"
 #include "SkTypes.h"
 
 // 8888
@@ -45,6 +46,10 @@ static bool Sample_RGBx_D8888(void* SK_RESTRICT dstRow,
 static SkScaledBitmapSampler::RowProc
 get_RGBx_to_8888_proc(const SkScaledBitmapSampler::Options& opts) {
     // Dither, unpremul, and skipZeroes have no effect
+    SkSampleRowProc platformProc = SkSampleRowGetPlatformProc(kRGBx_D8888_SkSampleRowProcType);
+    if (NULL != platformProc) {
+        return platformProc;
+    }
     return Sample_RGBx_D8888;
 }
 
@@ -106,6 +111,10 @@ get_RGBA_to_8888_proc(const SkScaledBitmapSampler::Options& opts) {
     if (opts.fSkipZeros) {
         return Sample_RGBA_D8888_SkipZ;
     }
+    SkSampleRowProc platformProc = SkSampleRowGetPlatformProc(kRGBA_D8888_SkSampleRowProcType);
+    if (NULL != platformProc) {
+        return platformProc;
+    }
     return Sample_RGBA_D8888;
 }
 
@@ -587,12 +596,16 @@ SkScaledBitmapSampler::SkScaledBitmapSampler(int width, int height,
     fCTable = NULL;
     fDstRow = NULL;
     fRowProc = NULL;
+    fBoxFilter = false;
+    fCurrY = 0;
 
     if (width <= 0 || height <= 0) {
         sk_throw();
     }
 
     SkDEBUGCODE(fSampleMode = kUninitialized_SampleMode);
+    fSrcWidth = width;
+    fSrcHeight = height;
 
     if (sampleSize <= 1) {
         fScaledWidth = width;
@@ -624,6 +637,34 @@ SkScaledBitmapSampler::SkScaledBitmapSampler(int width, int height,
     SkASSERT(fDY > 0 && (fY0 + fDY * (fScaledHeight - 1)) < height);
 }
 
+SkScaledBitmapSampler::SkScaledBitmapSampler(int width, int height,
+                                             const SkISize& dstSize) {
+    fCTable = NULL;
+    fDstRow = NULL;
+    fRowProc = NULL;
+    fCurrY = 0;
+
+    if (width <= 0 || height <= 0) {
+        sk_throw();
+    }
+
+    SkDEBUGCODE(fSampleMode = kUninitialized_SampleMode);
+    fSrcWidth = width;
+    fSrcHeight = height;
+    fScaledWidth = SkMin32(SkMax32(dstSize.width(), 1), width);
+    fScaledHeight = SkMin32(SkMax32(dstSize.height(), 1), height);
+    fX0 = fY0 = 0;
+    fDX = fDY = 1;
+    fBoxFilter = fScaledWidth < width || fScaledHeight < height;
+}
+
+bool SkScaledBitmapSampler::ShouldFilter(const SkImageDecoder& decoder,
+                                         SkColorType colorType) {
+    return !decoder.getTargetSize().isEmpty() &&
+           kN32_SkColorType == colorType &&
+           !decoder.getRequireUnpremultipliedColors();
+}
+
 bool SkScaledBitmapSampler::begin(SkBitmap* dst, SrcConfig sc,
                                   const Options& opts,
                                   const SkPMColor ctable[]) {
@@ -717,7 +758,23 @@ bool SkScaledBitmapSampler::begin(SkBitmap* dst, SrcConfig sc,
     }
 
     RowProcChooser chooser = gProcChoosers[index];
-    if (NULL == chooser) {
+    if (fBoxFilter) {
+        // The src rows are converted to premultiplied 8888 whole, and averaged from there.
+        if (kN32_SkColorType != dst->colorType() || !opts.fPremultiplyAlpha) {
+            return false;
+        }
+        Options filterOpts = opts;
+        filterOpts.fDither = false;
+        filterOpts.fSkipZeros = false;
+        fRowProc = NULL == chooser ? NULL : chooser(filterOpts);
+
+        fYOffset = 0;
+        fInvArea = 1.0f / ((float) fSrcWidth * (float) fSrcHeight);
+        fSrcPMRow.setCount(fSrcWidth);
+        fRowSums.setCount(4 * fScaledWidth);
+        fColumnSums.setCount(4 * fScaledWidth);
+        sk_bzero(fColumnSums.begin(), fColumnSums.bytes());
+    } else if (NULL == chooser) {
         fRowProc = NULL;
     } else {
         fRowProc = chooser(opts);
@@ -737,6 +794,9 @@ bool SkScaledBitmapSampler::begin(SkBitmap* dst, SrcConfig sc,
 bool SkScaledBitmapSampler::next(const uint8_t* SK_RESTRICT src) {
     SkASSERT(kInterlaced_SampleMode != fSampleMode);
     SkDEBUGCODE(fSampleMode = kConsecutive_SampleMode);
+    if (fBoxFilter) {
+        return this->boxFilterNext(src);
+    }
     SkASSERT((unsigned)fCurrY < (unsigned)fScaledHeight);
 
     bool hadAlpha = fRowProc(fDstRow, src + fX0 * fSrcPixelSize, fScaledWidth,
@@ -746,8 +806,84 @@ bool SkScaledBitmapSampler::next(const uint8_t* SK_RESTRICT src) {
     return hadAlpha;
 }
 
+static inline void add_weighted(uint32_t* SK_RESTRICT sums, SkPMColor c, uint32_t weight) {
+    sums[0] += SkGetPackedA32(c) * weight;
+    sums[1] += SkGetPackedR32(c) * weight;
+    sums[2] += SkGetPackedG32(c) * weight;
+    sums[3] += SkGetPackedB32(c) * weight;
+}
+
+bool SkScaledBitmapSampler::boxFilterNext(const uint8_t* SK_RESTRICT src) {
+    SkPMColor* SK_RESTRICT srcRow = fSrcPMRow.begin();
+    bool hadAlpha = fRowProc(srcRow, src, fSrcWidth, fSrcPixelSize, 0, fCTable);
+
+    // A dst pixel is wider than a src pixel, so each src pixel lands in one dst pixel or
+    // straddles two.
+    uint32_t* SK_RESTRICT sums = fRowSums.begin();
+    sk_bzero(sums, fRowSums.bytes());
+    const int srcWidth = fSrcWidth;
+    const int dstWidth = fScaledWidth;
+    int offset = 0;
+    for (int x = 0; x < srcWidth; x++) {
+        offset += dstWidth;
+        if (offset < srcWidth) {
+            add_weighted(sums, srcRow[x], dstWidth);
+        } else {
+            offset -= srcWidth;
+            add_weighted(sums, srcRow[x], dstWidth - offset);
+            sums += 4;
+            if (offset > 0) {
+                add_weighted(sums, srcRow[x], offset);
+            }
+        }
+    }
+
+    // Likewise for the rows.
+    fYOffset += fScaledHeight;
+    if (fYOffset < fSrcHeight) {
+        this->addRowSums(fScaledHeight);
+    } else {
+        fYOffset -= fSrcHeight;
+        this->addRowSums(fScaledHeight - fYOffset);
+        this->writeFilteredRow();
+        if (fYOffset > 0) {
+            this->addRowSums(fYOffset);
+        }
+    }
+    return hadAlpha;
+}
+
+void SkScaledBitmapSampler::addRowSums(int weight) {
+    const float scale = weight * fInvArea;
+    const uint32_t* SK_RESTRICT sums = fRowSums.begin();
+    float* SK_RESTRICT columns = fColumnSums.begin();
+    const int count = fColumnSums.count();
+    for (int i = 0; i < count; i++) {
+        columns[i] += sums[i] * scale;
+    }
+}
+
+void SkScaledBitmapSampler::writeFilteredRow() {
+    SkASSERT((unsigned)fCurrY < (unsigned)fScaledHeight);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)fDstRow;
+    const float* SK_RESTRICT columns = fColumnSums.begin();
+    for (int x = 0; x < fScaledWidth; x++) {
+        // Rounding could leave a color a bit above its alpha, which isn't premultiplied.
+        unsigned a = SkMin32((int)(columns[0] + 0.5f), 255);
+        unsigned r = SkMin32((int)(columns[1] + 0.5f), a);
+        unsigned g = SkMin32((int)(columns[2] + 0.5f), a);
+        unsigned b = SkMin32((int)(columns[3] + 0.5f), a);
+        dst[x] = SkPackARGB32(a, r, g, b);
+        columns += 4;
+    }
+    sk_bzero(fColumnSums.begin(), fColumnSums.bytes());
+    fDstRow += fDstRowBytes;
+    fCurrY += 1;
+}
+
 bool SkScaledBitmapSampler::sampleInterlaced(const uint8_t* SK_RESTRICT src, int srcY) {
     SkASSERT(kConsecutive_SampleMode != fSampleMode);
+    SkASSERT(!fBoxFilter);
     SkDEBUGCODE(fSampleMode = kInterlaced_SampleMode);
     // Any line that should be a part of the destination can be created by the formula:
     // fY0 + (some multiplier) * fDY
@@ -11,6 +11,7 @@
 #include "SkTypes.h"
 #include "SkColor.h"
 #include "SkImageDecoder.h"
+#include "SkTDArray.h"
 
 class SkBitmap;
 
@@ -18,6 +19,15 @@ class SkScaledBitmapSampler {
 public:
     SkScaledBitmapSampler(int origWidth, int origHeight, int cellSize);
 
+    // Box filters the src down to dstSize (clamped to the original size) as its rows are
+    // passed to next(), rather than skipping src pixels. Every src row is needed, and only
+    // one dst row is held at a time. Only writes premultiplied N32 pixels; see ShouldFilter().
+    SkScaledBitmapSampler(int origWidth, int origHeight, const SkISize& dstSize);
+
+    // Whether a decode by 'decoder' into 'colorType' should use the filtering constructor
+    // with the decoder's target size, rather than sample by its sample size.
+    static bool ShouldFilter(const SkImageDecoder& decoder, SkColorType colorType);
+
     int scaledWidth() const { return fScaledWidth; }
     int scaledHeight() const { return fScaledHeight; }
 
@@ -25,6 +35,13 @@ public:
     int srcDX() const { return fDX; }
     int srcDY() const { return fDY; }
 
+    bool isBoxFiltering() const { return fBoxFilter; }
+    // The number of src rows to pass to next(): all of them when filtering, and one per dst
+    // row (starting at srcY0() and stepping by srcDY()) otherwise.
+    int srcRowCount() const { return fBoxFilter ? fSrcHeight : fScaledHeight; }
+    // The number of dst rows next() has written so far.
+    int dstRowsWritten() const { return fCurrY; }
+
     enum SrcConfig {
         kGray,  // 1 byte per pixel
         kIndex, // 1 byte per pixel
@@ -52,14 +69,14 @@ public:
                const SkPMColor* = NULL);
     bool begin(SkBitmap* dst, SrcConfig sc, const Options& opts,
                const SkPMColor* = NULL);
-    // call with row of src pixels, for y = 0...scaledHeight-1.
+    // call with row of src pixels, for y = 0...srcRowCount()-1.
     // returns true if the row had non-opaque alpha in it
     bool next(const uint8_t* SK_RESTRICT src);
 
     // Like next(), but specifies the y value of the source row, so the
     // rows can come in any order. If the row is not part of the output
     // sample, it will be skipped. Only sampleInterlaced OR next should
-    // be called for one SkScaledBitmapSampler.
+    // be called for one SkScaledBitmapSampler, and not when box filtering.
     bool sampleInterlaced(const uint8_t* SK_RESTRICT src, int srcY);
 
     typedef bool (*RowProc)(void* SK_RESTRICT dstRow,
@@ -98,6 +115,21 @@ private:
     // optional reference to the src colors if the src is a palette model
     const SkPMColor* fCTable;
 
+    // box filtering state. A src pixel is fScaledWidth units wide and a dst pixel fSrcWidth,
+    // so that the weights are whole numbers, and likewise for rows.
+    bool    fBoxFilter;
+    int     fSrcWidth;
+    int     fSrcHeight;
+    int     fYOffset;   // where the next src row starts in the current dst row, in units
+    float   fInvArea;   // 1 / the area of a dst pixel in units
+    SkTDArray<SkPMColor> fSrcPMRow;    // the src row converted by fRowProc
+    SkTDArray<uint32_t>  fRowSums;     // weighted A, R, G, B of the src row per dst pixel
+    SkTDArray<float>     fColumnSums;  // normalized A, R, G, B of the dst row so far
+
+    bool boxFilterNext(const uint8_t* SK_RESTRICT src);
+    void addRowSums(int weight);
+    void writeFilteredRow();
+
 #ifdef SK_DEBUG
     // Helper class allowing a test to have access to fRowProc.
     friend class RowProcTester;
@@ -48,6 +48,10 @@ protected:
     virtual SkData* onRefEncodedData() SK_OVERRIDE {
         return fImageGenerator->refEncodedData();
     }
+    virtual bool onGetYUV8Planes(SkISize sizes[3], void* planes[3],
+                                 size_t rowBytes[3]) SK_OVERRIDE {
+        return fImageGenerator->getYUV8Planes(sizes, planes, rowBytes);
+    }
     // No need to flatten this object. When flattening an SkBitmap,
     // SkWriteBuffer will check the encoded data and write that
     // instead.
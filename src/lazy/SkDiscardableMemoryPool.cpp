@@ -7,7 +7,11 @@
 
 #include "SkDiscardableMemory.h"
 #include "SkDiscardableMemoryPool.h"
+#include "SkGlyphCache.h"
 #include "SkLazyPtr.h"
+#include "SkMemoryDump.h"
+#include "SkScaledImageCache.h"
+#include "SkTDArray.h"
 #include "SkTInternalLList.h"
 #include "SkThread.h"
 
@@ -31,33 +35,61 @@ public:
     DiscardableMemoryPool(size_t budget, SkBaseMutex* mutex = NULL);
     virtual ~DiscardableMemoryPool();
 
-    virtual SkDiscardableMemory* create(size_t bytes) SK_OVERRIDE;
+    virtual SkDiscardableMemory* create(size_t bytes) SK_OVERRIDE {
+        return this->createForClient(bytes, NULL);
+    }
+    virtual SkDiscardableMemory* createForClient(size_t bytes,
+                                                 const char client[]) SK_OVERRIDE;
+    virtual size_t getClientRAMUsed(const char client[]) SK_OVERRIDE;
 
     virtual size_t getRAMUsed() SK_OVERRIDE;
+    virtual size_t getRAMPurgeable() SK_OVERRIDE;
     virtual void setRAMBudget(size_t budget) SK_OVERRIDE;
     virtual size_t getRAMBudget() SK_OVERRIDE { return fBudget; }
 
     /** purges all unlocked DMs */
     virtual void dumpPool() SK_OVERRIDE;
 
+    virtual void handleMemoryPressure(MemoryPressure pressure) SK_OVERRIDE;
+    virtual void addPurgeCallback(PurgeCallback callback, void* context) SK_OVERRIDE;
+    virtual void removePurgeCallback(PurgeCallback callback, void* context) SK_OVERRIDE;
+
     #if SK_LAZY_CACHE_STATS  // Defined in SkDiscardableMemoryPool.h
     virtual int getCacheHits() SK_OVERRIDE { return fCacheHits; }
     virtual int getCacheMisses() SK_OVERRIDE { return fCacheMisses; }
+    virtual int getCachePurges() SK_OVERRIDE { return fCachePurges; }
     virtual void resetCacheHitsAndMisses() SK_OVERRIDE {
-        fCacheHits = fCacheMisses = 0;
+        fCacheHits = fCacheMisses = fCachePurges = 0;
     }
     int          fCacheHits;
     int          fCacheMisses;
+    int          fCachePurges;
     #endif  // SK_LAZY_CACHE_STATS
 
 private:
+    struct Client {
+        const char* fName;
+        size_t      fUsed;
+    };
+
+    struct Callback {
+        PurgeCallback fProc;
+        void*         fContext;
+    };
+
     SkBaseMutex* fMutex;
     size_t       fBudget;
     size_t       fUsed;
     SkTInternalLList<PoolDiscardableMemory> fList;
+    SkTDArray<Client>   fClients;
+    SkTDArray<Callback> fCallbacks;
 
     /** Function called to free memory if needed */
     void dumpDownTo(size_t budget);
+    /** Returns the entry for 'client', creating it if 'create' is true. */
+    Client* findClient(const char client[], bool create);
+    /** Takes the memory of a DM that is being freed or purged out of the totals. */
+    void release(PoolDiscardableMemory* dm);
     /** called by DiscardableMemoryPool upon destruction */
     void free(PoolDiscardableMemory* dm);
     /** called by DiscardableMemoryPool::lock() */
@@ -77,7 +109,7 @@ private:
 class PoolDiscardableMemory : public SkDiscardableMemory {
 public:
     PoolDiscardableMemory(DiscardableMemoryPool* pool,
-                            void* pointer, size_t bytes);
+                          void* pointer, size_t bytes, const char client[]);
     virtual ~PoolDiscardableMemory();
     virtual bool lock() SK_OVERRIDE;
     virtual void* data() SK_OVERRIDE;
@@ -89,15 +121,18 @@ private:
     bool                         fLocked;
     void*                        fPointer;
     const size_t                 fBytes;
+    const char* const            fClient;
 };
 
 PoolDiscardableMemory::PoolDiscardableMemory(DiscardableMemoryPool* pool,
                                              void* pointer,
-                                             size_t bytes)
+                                             size_t bytes,
+                                             const char client[])
     : fPool(pool)
     , fLocked(true)
     , fPointer(pointer)
-    , fBytes(bytes) {
+    , fBytes(bytes)
+    , fClient(client) {
     SkASSERT(fPool != NULL);
     SkASSERT(fPointer != NULL);
     SkASSERT(fBytes > 0);
@@ -135,6 +170,7 @@ DiscardableMemoryPool::DiscardableMemoryPool(size_t budget,
     #if SK_LAZY_CACHE_STATS
     fCacheHits = 0;
     fCacheMisses = 0;
+    fCachePurges = 0;
     #endif  // SK_LAZY_CACHE_STATS
 }
 DiscardableMemoryPool::~DiscardableMemoryPool() {
@@ -157,44 +193,81 @@ void DiscardableMemoryPool::dumpDownTo(size_t budget) {
     while ((fUsed > budget) && (NULL != cur)) {
         if (!cur->fLocked) {
             PoolDiscardableMemory* dm = cur;
-            SkASSERT(dm->fPointer != NULL);
-            sk_free(dm->fPointer);
-            dm->fPointer = NULL;
-            SkASSERT(fUsed >= dm->fBytes);
-            fUsed -= dm->fBytes;
             cur = iter.prev();
             // Purged DMs are taken out of the list.  This saves times
             // looking them up.  Purged DMs are NOT deleted.
-            fList.remove(dm);
+            this->release(dm);
+            #if SK_LAZY_CACHE_STATS
+            ++fCachePurges;
+            #endif  // SK_LAZY_CACHE_STATS
         } else {
             cur = iter.prev();
         }
     }
 }
 
-SkDiscardableMemory* DiscardableMemoryPool::create(size_t bytes) {
+DiscardableMemoryPool::Client* DiscardableMemoryPool::findClient(const char client[],
+                                                                 bool create) {
+    if (fMutex != NULL) {
+        fMutex->assertHeld();
+    }
+    for (int i = 0; i < fClients.count(); ++i) {
+        const char* name = fClients[i].fName;
+        if (name == client || (NULL != name && NULL != client && 0 == strcmp(name, client))) {
+            return &fClients[i];
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+    Client* entry = fClients.append();
+    entry->fName = client;
+    entry->fUsed = 0;
+    return entry;
+}
+
+void DiscardableMemoryPool::release(PoolDiscardableMemory* dm) {
+    if (fMutex != NULL) {
+        fMutex->assertHeld();
+    }
+    SkASSERT(dm->fPointer != NULL);
+    sk_free(dm->fPointer);
+    dm->fPointer = NULL;
+    SkASSERT(fUsed >= dm->fBytes);
+    fUsed -= dm->fBytes;
+    Client* client = this->findClient(dm->fClient, false);
+    SkASSERT(NULL != client && client->fUsed >= dm->fBytes);
+    client->fUsed -= dm->fBytes;
+    fList.remove(dm);
+}
+
+SkDiscardableMemory* DiscardableMemoryPool::createForClient(size_t bytes,
+                                                            const char client[]) {
     void* addr = sk_malloc_flags(bytes, 0);
     if (NULL == addr) {
         return NULL;
     }
     PoolDiscardableMemory* dm = SkNEW_ARGS(PoolDiscardableMemory,
-                                             (this, addr, bytes));
+                                             (this, addr, bytes, client));
     SkAutoMutexAcquire autoMutexAcquire(fMutex);
     fList.addToHead(dm);
     fUsed += bytes;
+    this->findClient(client, true)->fUsed += bytes;
     this->dumpDownTo(fBudget);
     return dm;
 }
 
+size_t DiscardableMemoryPool::getClientRAMUsed(const char client[]) {
+    SkAutoMutexAcquire autoMutexAcquire(fMutex);
+    const Client* entry = this->findClient(client, false);
+    return NULL != entry ? entry->fUsed : 0;
+}
+
 void DiscardableMemoryPool::free(PoolDiscardableMemory* dm) {
     // This is called by dm's destructor.
     if (dm->fPointer != NULL) {
         SkAutoMutexAcquire autoMutexAcquire(fMutex);
-        sk_free(dm->fPointer);
-        dm->fPointer = NULL;
-        SkASSERT(fUsed >= dm->fBytes);
-        fUsed -= dm->fBytes;
-        fList.remove(dm);
+        this->release(dm);
     } else {
         SkASSERT(!fList.isInList(dm));
     }
@@ -236,6 +309,19 @@ void DiscardableMemoryPool::unlock(PoolDiscardableMemory* dm) {
 size_t DiscardableMemoryPool::getRAMUsed() {
     return fUsed;
 }
+size_t DiscardableMemoryPool::getRAMPurgeable() {
+    SkAutoMutexAcquire autoMutexAcquire(fMutex);
+    typedef SkTInternalLList<PoolDiscardableMemory>::Iter Iter;
+    Iter iter;
+    size_t purgeable = 0;
+    for (PoolDiscardableMemory* cur = iter.init(fList, Iter::kHead_IterStart);
+         NULL != cur; cur = iter.next()) {
+        if (!cur->fLocked) {
+            purgeable += cur->fBytes;
+        }
+    }
+    return purgeable;
+}
 void DiscardableMemoryPool::setRAMBudget(size_t budget) {
     SkAutoMutexAcquire autoMutexAcquire(fMutex);
     fBudget = budget;
@@ -246,11 +332,64 @@ void DiscardableMemoryPool::dumpPool() {
     this->dumpDownTo(0);
 }
 
+void DiscardableMemoryPool::handleMemoryPressure(MemoryPressure pressure) {
+    SkTDArray<Callback> callbacks;
+    {
+        SkAutoMutexAcquire autoMutexAcquire(fMutex);
+        this->dumpDownTo(kCritical_MemoryPressure == pressure ? 0 : fUsed / 2);
+        callbacks = fCallbacks;
+    }
+    // The callbacks may free DMs of this pool, so don't hold its lock.
+    for (int i = 0; i < callbacks.count(); ++i) {
+        callbacks[i].fProc(pressure, callbacks[i].fContext);
+    }
+}
+
+void DiscardableMemoryPool::addPurgeCallback(PurgeCallback callback, void* context) {
+    SkAutoMutexAcquire autoMutexAcquire(fMutex);
+    Callback* entry = fCallbacks.append();
+    entry->fProc = callback;
+    entry->fContext = context;
+}
+
+void DiscardableMemoryPool::removePurgeCallback(PurgeCallback callback, void* context) {
+    SkAutoMutexAcquire autoMutexAcquire(fMutex);
+    for (int i = 0; i < fCallbacks.count(); ++i) {
+        if (fCallbacks[i].fProc == callback && fCallbacks[i].fContext == context) {
+            fCallbacks.remove(i);
+            return;
+        }
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 SK_DECLARE_STATIC_MUTEX(gMutex);
+
+void purge_image_cache(SkDiscardableMemoryPool::MemoryPressure pressure, void*) {
+    SkScaledImageCache::PurgeForMemoryPressure(
+            SkDiscardableMemoryPool::kCritical_MemoryPressure == pressure);
+}
+
+void purge_glyph_cache(SkDiscardableMemoryPool::MemoryPressure pressure, void*) {
+    SkGlyphCache::PurgeForMemoryPressure(
+            SkDiscardableMemoryPool::kCritical_MemoryPressure == pressure);
+}
+
+void dump_global_pool(SkMemoryDump* dump);
+
 SkDiscardableMemoryPool* create_global_pool() {
-    return SkDiscardableMemoryPool::Create(SK_DEFAULT_GLOBAL_DISCARDABLE_MEMORY_POOL_SIZE,
-                                           &gMutex);
+    SkDiscardableMemoryPool* pool =
+            SkDiscardableMemoryPool::Create(SK_DEFAULT_GLOBAL_DISCARDABLE_MEMORY_POOL_SIZE,
+                                            &gMutex);
+    pool->addPurgeCallback(purge_image_cache, NULL);
+    pool->addPurgeCallback(purge_glyph_cache, NULL);
+    SkMemoryDump::RegisterGlobalProc(dump_global_pool);
+    return pool;
+}
+
+void dump_global_pool(SkMemoryDump* dump) {
+    SkDiscardableMemoryPool* pool = SkGetGlobalDiscardableMemoryPool();
+    dump->dumpCache("skia/discardable_pool", pool->getRAMUsed(), pool->getRAMPurgeable());
 }
 
 }  // namespace
@@ -268,4 +407,12 @@ SkDiscardableMemoryPool* SkGetGlobalDiscardableMemoryPool() {
 void SkPurgeGlobalDiscardableMemoryPool() {
     SkGetGlobalDiscardableMemoryPool()->dumpPool();
 }
+
+#include "SkGraphics.h"
+
+void SkGraphics::PurgeForMemoryPressure(bool critical) {
+    SkGetGlobalDiscardableMemoryPool()->handleMemoryPressure(
+            critical ? SkDiscardableMemoryPool::kCritical_MemoryPressure
+                     : SkDiscardableMemoryPool::kModerate_MemoryPressure);
+}
 ////////////////////////////////////////////////////////////////////////////////
@@ -29,12 +29,48 @@ public:
     virtual ~SkDiscardableMemoryPool() { }
 
     virtual size_t getRAMUsed() = 0;
+    /** Returns the bytes of unlocked memory, which a purge could free. */
+    virtual size_t getRAMPurgeable() = 0;
     virtual void setRAMBudget(size_t budget) = 0;
     virtual size_t getRAMBudget() = 0;
 
     /** purges all unlocked DMs */
     virtual void dumpPool() = 0;
 
+    /**
+     *  Like create(), but counts the memory against 'client', which names the
+     *  subsystem allocating it for getClientRAMUsed(). The string is not
+     *  copied, so it must outlive the memory (e.g. a string literal).
+     *  create() counts against the NULL client.
+     */
+    virtual SkDiscardableMemory* createForClient(size_t bytes, const char client[]) = 0;
+
+    /** Returns the bytes currently allocated, locked or not, for 'client'. */
+    virtual size_t getClientRAMUsed(const char client[]) = 0;
+
+    enum MemoryPressure {
+        /** Purge the least recently used half of the unlocked memory. */
+        kModerate_MemoryPressure,
+        /** Purge all unlocked memory. */
+        kCritical_MemoryPressure,
+    };
+
+    /**
+     *  Called when the system runs low on memory, independently of the
+     *  budget. Purges according to 'pressure', then calls the purge callbacks
+     *  so that caches outside of the pool can shrink along with it.
+     */
+    virtual void handleMemoryPressure(MemoryPressure pressure) = 0;
+
+    typedef void (*PurgeCallback)(MemoryPressure, void* context);
+
+    /**
+     *  Registers 'callback' to be called from handleMemoryPressure(), with
+     *  no lock held by the pool.
+     */
+    virtual void addPurgeCallback(PurgeCallback callback, void* context) = 0;
+    virtual void removePurgeCallback(PurgeCallback callback, void* context) = 0;
+
     #if SK_LAZY_CACHE_STATS
     /**
      * These two values are a count of the number of successful and
@@ -43,6 +79,12 @@ public:
      */
     virtual int getCacheHits() = 0;
     virtual int getCacheMisses() = 0;
+    /**
+     * The number of DMs purged, either to stay in budget or because of
+     * dumpPool() or handleMemoryPressure().
+     */
+    virtual int getCachePurges() = 0;
+    /** Resets all three counts. */
     virtual void resetCacheHitsAndMisses() = 0;
     #endif
 
@@ -57,7 +99,8 @@ public:
 
 /**
  *  Returns (and creates if needed) a threadsafe global
- *  SkDiscardableMemoryPool.
+ *  SkDiscardableMemoryPool. Memory pressure on it also purges the scaled
+ *  image cache and the font cache.
  */
 SkDiscardableMemoryPool* SkGetGlobalDiscardableMemoryPool();
 
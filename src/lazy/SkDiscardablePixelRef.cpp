@@ -8,6 +8,7 @@
 #include "SkDiscardablePixelRef.h"
 #include "SkDiscardableMemory.h"
 #include "SkImageGenerator.h"
+#include "SkRect.h"
 
 SkDiscardablePixelRef::SkDiscardablePixelRef(const SkImageInfo& info,
                                              SkImageGenerator* generator,
@@ -96,6 +97,23 @@ void SkDiscardablePixelRef::onUnlockPixels() {
     fDiscardableMemory->unlock();
 }
 
+bool SkDiscardablePixelRef::onReadPixels(SkBitmap* dst, const SkIRect* subset) {
+    // Once the whole image was decoded, copying out of it is cheaper than decoding again. The
+    // caller falls back to locking the pixels when this fails.
+    if (NULL == subset || NULL != fDiscardableMemory) {
+        return false;
+    }
+    SkBitmap bitmap;
+    if (!fGenerator->getPixels(*subset, 1, &bitmap)) {
+        return false;
+    }
+    if (bitmap.width() != subset->width() || bitmap.height() != subset->height()) {
+        return false;
+    }
+    dst->swap(bitmap);
+    return true;
+}
+
 bool SkInstallDiscardablePixelRef(SkImageGenerator* generator, SkBitmap* dst,
                                   SkDiscardableMemory::Factory* factory) {
     SkImageInfo info;
@@ -34,6 +34,13 @@ protected:
         return fGenerator->refEncodedData();
     }
 
+    virtual bool onGetYUV8Planes(SkISize sizes[3], void* planes[3],
+                                 size_t rowBytes[3]) SK_OVERRIDE {
+        return fGenerator->getYUV8Planes(sizes, planes, rowBytes);
+    }
+
+    virtual bool onReadPixels(SkBitmap* dst, const SkIRect* subset) SK_OVERRIDE;
+
 private:
     SkImageGenerator* const fGenerator;
     SkDiscardableMemory::Factory* const fDMFactory;
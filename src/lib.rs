@@ -28,6 +28,7 @@ extern crate fontconfig_sys;
 pub use skia::{
     SkiaGrContextRef,
     SkiaGrGLInterfaceRef,
+    SkiaGrFence,
     SkiaGrGLCreateNativeInterface,
     SkiaGrGLInterfaceRetain,
     SkiaGrGLInterfaceRelease,
@@ -36,6 +37,39 @@ pub use skia::{
     SkiaGrContextCreate,
     SkiaGrContextRetain,
     SkiaGrContextRelease,
+    SkiaGrContextResetContext,
+    SkiaGrContextFlushWithFence,
+    SkiaGrContextWaitFence,
+    SkiaGrContextDeleteFence,
+    SkiaGrContextFlush,
+    SkiaGrContextGetResourceCacheLimits,
+    SkiaGrContextSetResourceCacheLimits,
+    SkiaGrContextGetResourceCacheUsage,
+    SkiaGrContextPerformDeferredCleanup,
+    SkiaGrContextPurgeUnlockedResources,
+    SkiaGrContextFreeGpuResources,
+    SkiaSkSurfaceRef,
+    SkiaSkCanvasRef,
+    SkiaSkPictureRecorderRef,
+    SkiaSkPictureRef,
+    SkiaCanvasCommand,
+    SkiaSkSurfaceCreateRaster,
+    SkiaSkSurfaceCreateRenderTarget,
+    SkiaSkSurfaceRetain,
+    SkiaSkSurfaceRelease,
+    SkiaSkSurfaceGetCanvas,
+    SkiaSkSurfaceDrawPicture,
+    SkiaSkSurfaceSetTracksDamage,
+    SkiaSkSurfaceGetDamage,
+    SkiaSkSurfaceResetDamage,
+    SkiaSkCanvasDrawCommands,
+    SkiaSkCanvasDrawPicture,
+    SkiaSkPictureRecorderCreate,
+    SkiaSkPictureRecorderDestroy,
+    SkiaSkPictureRecorderBeginRecording,
+    SkiaSkPictureRecorderEndRecording,
+    SkiaSkPictureRetain,
+    SkiaSkPictureRelease,
 };
 
 pub mod gl_context;
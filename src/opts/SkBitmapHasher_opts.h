@@ -0,0 +1,21 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBitmapHasher_opts_DEFINED
+#define SkBitmapHasher_opts_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  Hashes size bytes of data, starting from seed, for SkBitmapHasher::ComputeFastDigest().
+ *  Each row of pixels is hashed with the previous row's hash as its seed.
+ */
+typedef uint64_t (*SkBitmapHasherHashProc)(const void* data, size_t size, uint64_t seed);
+
+SkBitmapHasherHashProc SkBitmapHasherGetPlatformHashProc();
+
+#endif
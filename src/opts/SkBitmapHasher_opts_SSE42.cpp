@@ -0,0 +1,61 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <nmmintrin.h>
+#include "SkBitmapHasher_opts_SSE42.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    typedef uint64_t Word;
+    static inline uint32_t crc32c(uint32_t crc, Word w) {
+        return (uint32_t)_mm_crc32_u64(crc, w);
+    }
+#else
+    typedef uint32_t Word;
+    static inline uint32_t crc32c(uint32_t crc, Word w) {
+        return _mm_crc32_u32(crc, w);
+    }
+#endif
+
+static inline Word load(const uint8_t* p) {
+    Word w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+// Four CRC32C lanes take turns at the words of the data, so four crc32 instructions are in flight
+// at once. Each pair of lanes is folded into one half of the result, which is then mixed so that
+// every bit of it depends on every bit of both halves.
+uint64_t SkBitmapHasherHash_SSE42(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const size_t kStripeBytes = 4 * sizeof(Word);
+
+    uint32_t crc0 = (uint32_t)seed,
+             crc1 = (uint32_t)(seed >> 32),
+             crc2 = ~crc0,
+             crc3 = ~crc1;
+    size_t left = size;
+    for (; left >= kStripeBytes; left -= kStripeBytes, p += kStripeBytes) {
+        crc0 = crc32c(crc0, load(p));
+        crc1 = crc32c(crc1, load(p + 1 * sizeof(Word)));
+        crc2 = crc32c(crc2, load(p + 2 * sizeof(Word)));
+        crc3 = crc32c(crc3, load(p + 3 * sizeof(Word)));
+    }
+    for (; left >= sizeof(Word); left -= sizeof(Word), p += sizeof(Word)) {
+        crc0 = crc32c(crc0, load(p));
+    }
+    for (; left > 0; left--, p++) {
+        crc1 = _mm_crc32_u8(crc1, *p);
+    }
+
+    uint64_t h = ((uint64_t)_mm_crc32_u32(crc0, crc1) << 32 | _mm_crc32_u32(crc2, crc3)) ^ size;
+    h ^= h >> 33;
+    h *= 0xC2B2AE3D27D4EB4FULL;
+    h ^= h >> 29;
+    h *= 0x165667B19E3779F9ULL;
+    h ^= h >> 32;
+    return h;
+}
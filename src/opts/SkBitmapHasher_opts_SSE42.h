@@ -0,0 +1,15 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBitmapHasher_opts_SSE42_DEFINED
+#define SkBitmapHasher_opts_SSE42_DEFINED
+
+#include "SkBitmapHasher_opts.h"
+
+uint64_t SkBitmapHasherHash_SSE42(const void* data, size_t size, uint64_t seed);
+
+#endif
@@ -9,6 +9,7 @@
 #include "SkBitmapProcState_opts_SSE2.h"
 #include "SkColorPriv.h"
 #include "SkPaint.h"
+#include "SkPerspIter.h"
 #include "SkUtils.h"
 
 void S32_opaque_D32_filter_DX_SSE2(const SkBitmapProcState& s,
@@ -484,6 +485,184 @@ void ClampX_ClampY_nofilter_scale_SSE2(const SkBitmapProcState& s,
     }
 }
 
+static inline unsigned RepeatX_RepeatY_tile(SkFixed f, unsigned max) {
+    return ((unsigned)(f & 0xFFFF) * (max + 1)) >> 16;
+}
+
+static inline uint32_t RepeatX_RepeatY_pack_filter(SkFixed f, unsigned max,
+                                                   SkFixed one) {
+    // The index, and its low bits, are the top 20 bits of the product.
+    unsigned i = ((unsigned)(f & 0xFFFF) * (max + 1)) >> 12;
+    return (i << 14) | RepeatX_RepeatY_tile(f + one, max);
+}
+
+/*  Steps eight SkFractionalInts, two to a register, through fx, fx + dx, ...
+ *  Only the low 16 bits of their SkFractionalIntToFixed() pick the repeated
+ *  pixel, and those are the fraction of the normalized coordinate.
+ */
+class RepeatFractions {
+public:
+    RepeatFractions(SkFractionalInt fx, SkFractionalInt dx) {
+        SK_COMPILE_ASSERT(sizeof(SkFractionalInt) == 8, FractionalInt_is_SkFixed48);
+        for (int i = 0; i < 4; ++i) {
+            fFx[i] = _mm_set_epi64x(fx + dx * (2 * i + 1), fx + dx * (2 * i));
+        }
+        fDx8 = _mm_set1_epi64x(dx * 8);
+    }
+
+    // Returns the current eight fractions in 16 bit lanes, and steps past them.
+    __m128i next() {
+        // bits 32..63 of each lane are SkFractionalIntToFixed()
+        __m128i lo = _mm_unpacklo_epi64(_mm_shuffle_epi32(fFx[0], _MM_SHUFFLE(3, 1, 3, 1)),
+                                        _mm_shuffle_epi32(fFx[1], _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128i hi = _mm_unpacklo_epi64(_mm_shuffle_epi32(fFx[2], _MM_SHUFFLE(3, 1, 3, 1)),
+                                        _mm_shuffle_epi32(fFx[3], _MM_SHUFFLE(3, 1, 3, 1)));
+        // sign extend their low 16 bits, which _mm_packs_epi32 then keeps as is
+        lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+        hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+        for (int i = 0; i < 4; ++i) {
+            fFx[i] = _mm_add_epi64(fFx[i], fDx8);
+        }
+        return _mm_packs_epi32(lo, hi);
+    }
+
+private:
+    __m128i fFx[4];
+    __m128i fDx8;
+};
+
+/*  SSE version of RepeatX_RepeatY_filter_scale()
+ *  portable version is in core/SkBitmapProcState_matrix.h
+ *
+ *  The pixel a fraction picks is the high half of its product with the
+ *  width, and the 4 bits below it the filter's subpixel weight.
+ */
+void RepeatX_RepeatY_filter_scale_SSE2(const SkBitmapProcState& s, uint32_t xy[],
+                                       int count, int x, int y) {
+    SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
+                             SkMatrix::kScale_Mask)) == 0);
+    SkASSERT(s.fInvKy == 0);
+
+    const unsigned maxX = s.fBitmap->width() - 1;
+    const SkFixed one = s.fFilterOneX;
+    const SkFractionalInt dx = s.fInvSxFractionalInt;
+    SkFractionalInt fx;
+
+    {
+        SkPoint pt;
+        s.fInvProc(s.fInvMatrix, SkIntToScalar(x) + SK_ScalarHalf,
+                                 SkIntToScalar(y) + SK_ScalarHalf, &pt);
+        const SkFixed fy = SkScalarToFixed(pt.fY) - (s.fFilterOneY >> 1);
+        const unsigned maxY = s.fBitmap->height() - 1;
+        // compute our two Y values up front
+        *xy++ = RepeatX_RepeatY_pack_filter(fy, maxY, s.fFilterOneY);
+        // now initialize fx
+        fx = SkScalarToFractionalInt(pt.fX) - (SkFixedToFractionalInt(one) >> 1);
+    }
+
+    // Filtering limits the width to 14 bits, so the products fit in 30.
+    if (count >= 8) {
+        while (((size_t)xy & 0x0F) != 0) {
+            *xy++ = RepeatX_RepeatY_pack_filter(SkFractionalIntToFixed(fx), maxX, one);
+            fx += dx;
+            count--;
+        }
+
+        RepeatFractions fractions(fx, dx);
+        const __m128i wide_width = _mm_set1_epi16(maxX + 1);
+        const __m128i wide_one   = _mm_set1_epi16(one);
+
+        while (count >= 8) {
+            __m128i wide_fx  = fractions.next();
+            __m128i wide_fx1 = _mm_add_epi16(wide_fx, wide_one);
+
+            // the 32 bit products for fx, and the index fx + one picks
+            __m128i wide_lo = _mm_mullo_epi16(wide_fx, wide_width);
+            __m128i wide_hi = _mm_mulhi_epu16(wide_fx, wide_width);
+            __m128i wide_i1 = _mm_mulhi_epu16(wide_fx1, wide_width);
+
+            __m128i wide_p0 = _mm_unpacklo_epi16(wide_lo, wide_hi);
+            __m128i wide_p1 = _mm_unpackhi_epi16(wide_lo, wide_hi);
+            wide_p0 = _mm_slli_epi32(_mm_srli_epi32(wide_p0, 12), 14);
+            wide_p1 = _mm_slli_epi32(_mm_srli_epi32(wide_p1, 12), 14);
+
+            wide_p0 = _mm_or_si128(wide_p0,
+                                   _mm_unpacklo_epi16(wide_i1, _mm_setzero_si128()));
+            wide_p1 = _mm_or_si128(wide_p1,
+                                   _mm_unpackhi_epi16(wide_i1, _mm_setzero_si128()));
+            _mm_store_si128(reinterpret_cast<__m128i*>(xy), wide_p0);
+            _mm_store_si128(reinterpret_cast<__m128i*>(xy + 4), wide_p1);
+
+            fx += dx * 8;
+            xy += 8;
+            count -= 8;
+        }
+    }
+
+    while (count-- > 0) {
+        *xy++ = RepeatX_RepeatY_pack_filter(SkFractionalIntToFixed(fx), maxX, one);
+        fx += dx;
+    }
+}
+
+/*  SSE version of RepeatX_RepeatY_nofilter_scale()
+ *  portable version is in core/SkBitmapProcState_matrix_template.h
+ */
+void RepeatX_RepeatY_nofilter_scale_SSE2(const SkBitmapProcState& s,
+                                         uint32_t xy[], int count, int x, int y) {
+    SkASSERT((s.fInvType & ~(SkMatrix::kTranslate_Mask |
+                             SkMatrix::kScale_Mask)) == 0);
+
+    // we store y, x, x, x, x, x
+    const unsigned maxX = s.fBitmap->width() - 1;
+    SkFractionalInt fx;
+    {
+        SkPoint pt;
+        s.fInvProc(s.fInvMatrix, SkIntToScalar(x) + SK_ScalarHalf,
+                                 SkIntToScalar(y) + SK_ScalarHalf, &pt);
+        fx = SkScalarToFractionalInt(pt.fY);
+        const unsigned maxY = s.fBitmap->height() - 1;
+        *xy++ = RepeatX_RepeatY_tile(SkFractionalIntToFixed(fx), maxY);
+        fx = SkScalarToFractionalInt(pt.fX);
+    }
+
+    if (0 == maxX) {
+        // all of the following X values must be 0
+        memset(xy, 0, count * sizeof(uint16_t));
+        return;
+    }
+
+    const SkFractionalInt dx = s.fInvSxFractionalInt;
+
+    // The width must fit in an unsigned 16 bit lane.
+    if ((count >= 8) && (maxX < 0xFFFF)) {
+        while (((size_t)xy & 0x0F) != 0) {
+            unsigned a = RepeatX_RepeatY_tile(SkFractionalIntToFixed(fx), maxX);
+            unsigned b = RepeatX_RepeatY_tile(SkFractionalIntToFixed(fx + dx), maxX);
+            *xy++ = pack_two_shorts(a, b);
+            fx += 2 * dx;
+            count -= 2;
+        }
+
+        RepeatFractions fractions(fx, dx);
+        const __m128i wide_width = _mm_set1_epi16(maxX + 1);
+
+        while (count >= 8) {
+            _mm_store_si128(reinterpret_cast<__m128i*>(xy),
+                            _mm_mulhi_epu16(fractions.next(), wide_width));
+            xy += 4;
+            fx += dx * 8;
+            count -= 8;
+        }
+    }
+
+    uint16_t* xx = reinterpret_cast<uint16_t*>(xy);
+    while (count-- > 0) {
+        *xx++ = RepeatX_RepeatY_tile(SkFractionalIntToFixed(fx), maxX);
+        fx += dx;
+    }
+}
+
 /*  SSE version of ClampX_ClampY_filter_affine()
  *  portable version is in core/SkBitmapProcState_matrix.h
  */
@@ -633,6 +812,225 @@ void ClampX_ClampY_nofilter_affine_SSE2(const SkBitmapProcState& s,
     }
 }
 
+/*  SSE version of ClampX_ClampY_filter_persp()
+ *  portable version is in core/SkBitmapProcState_matrix.h
+ */
+void ClampX_ClampY_filter_persp_SSE2(const SkBitmapProcState& s,
+                                     uint32_t xy[], int count, int x, int y) {
+    SkASSERT(s.fInvType & SkMatrix::kPerspective_Mask);
+
+    const unsigned maxX = s.fBitmap->width() - 1;
+    const unsigned maxY = s.fBitmap->height() - 1;
+    const SkFixed oneX = s.fFilterOneX;
+    const SkFixed oneY = s.fFilterOneY;
+
+    // The clamps are done on signed 16 bit lanes, which saturate exactly.
+    const bool wide = maxX <= 0x7FFF && maxY <= 0x7FFF;
+
+    // Lanes are in (y, x, y, x) order, the order we write them in.
+    const __m128i wide_half = _mm_set_epi32(oneX >> 1, oneY >> 1, oneX >> 1, oneY >> 1);
+    const __m128i wide_one  = _mm_set_epi32(oneX, oneY, oneX, oneY);
+    const __m128i wide_max  = _mm_set_epi16(maxX, maxY, maxX, maxY, maxX, maxY, maxX, maxY);
+    const __m128i wide_mask = _mm_set1_epi32(0xF);
+    const __m128i zero      = _mm_setzero_si128();
+
+    SkPerspIter iter(s.fInvMatrix,
+                     SkIntToScalar(x) + SK_ScalarHalf,
+                     SkIntToScalar(y) + SK_ScalarHalf, count);
+
+    while ((count = iter.next()) != 0) {
+        const SkFixed* SK_RESTRICT srcXY = iter.getXY();
+
+        while (wide && count >= 4) {
+            // (x0, y0, x1, y1), (x2, y2, x3, y3) -> (y0, x0, y1, x1), (y2, x2, y3, x3)
+            __m128i f01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcXY));
+            __m128i f23 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcXY + 4));
+            f01 = _mm_shuffle_epi32(f01, _MM_SHUFFLE(2, 3, 0, 1));
+            f23 = _mm_shuffle_epi32(f23, _MM_SHUFFLE(2, 3, 0, 1));
+            f01 = _mm_sub_epi32(f01, wide_half);
+            f23 = _mm_sub_epi32(f23, wide_half);
+
+            // SkClampMax(f >> 16, max)
+            __m128i i = _mm_packs_epi32(_mm_srai_epi32(f01, 16), _mm_srai_epi32(f23, 16));
+            i = _mm_min_epi16(_mm_max_epi16(i, zero), wide_max);
+
+            // SkClampMax((f + one) >> 16, max)
+            __m128i i1 = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(f01, wide_one), 16),
+                                         _mm_srai_epi32(_mm_add_epi32(f23, wide_one), 16));
+            i1 = _mm_min_epi16(_mm_max_epi16(i1, zero), wide_max);
+
+            // ((i << 4 | (f >> 12) & 0xF) << 14) | i1
+            __m128i r01 = _mm_slli_epi32(_mm_unpacklo_epi16(i, zero), 4);
+            __m128i r23 = _mm_slli_epi32(_mm_unpackhi_epi16(i, zero), 4);
+            r01 = _mm_or_si128(r01, _mm_and_si128(_mm_srli_epi32(f01, 12), wide_mask));
+            r23 = _mm_or_si128(r23, _mm_and_si128(_mm_srli_epi32(f23, 12), wide_mask));
+            r01 = _mm_or_si128(_mm_slli_epi32(r01, 14), _mm_unpacklo_epi16(i1, zero));
+            r23 = _mm_or_si128(_mm_slli_epi32(r23, 14), _mm_unpackhi_epi16(i1, zero));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(xy), r01);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(xy + 4), r23);
+
+            srcXY += 8;
+            xy += 8;
+            count -= 4;
+        }
+
+        while (--count >= 0) {
+            // NB: we read x/y, we write y/x
+            *xy++ = ClampX_ClampY_pack_filter(srcXY[1] - (oneY >> 1), maxY, oneY);
+            *xy++ = ClampX_ClampY_pack_filter(srcXY[0] - (oneX >> 1), maxX, oneX);
+            srcXY += 2;
+        }
+    }
+}
+
+/*  SSE version of ClampX_ClampY_nofilter_persp()
+ *  portable version is in core/SkBitmapProcState_matrix_template.h
+ */
+void ClampX_ClampY_nofilter_persp_SSE2(const SkBitmapProcState& s,
+                                       uint32_t xy[], int count, int x, int y) {
+    SkASSERT(s.fInvType & SkMatrix::kPerspective_Mask);
+
+    const int maxX = s.fBitmap->width() - 1;
+    const int maxY = s.fBitmap->height() - 1;
+
+    const bool wide = maxX <= 0x7FFF && maxY <= 0x7FFF;
+
+    // (x, y) pairs of 16 bit lanes are the (y << 16 | x) we want.
+    const __m128i wide_max = _mm_set_epi16(maxY, maxX, maxY, maxX, maxY, maxX, maxY, maxX);
+    const __m128i zero     = _mm_setzero_si128();
+
+    SkPerspIter iter(s.fInvMatrix,
+                     SkIntToScalar(x) + SK_ScalarHalf,
+                     SkIntToScalar(y) + SK_ScalarHalf, count);
+
+    while ((count = iter.next()) != 0) {
+        const SkFixed* SK_RESTRICT srcXY = iter.getXY();
+
+        while (wide && count >= 4) {
+            __m128i f01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcXY));
+            __m128i f23 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcXY + 4));
+
+            // SkClampMax(f >> 16, max)
+            __m128i i = _mm_packs_epi32(_mm_srai_epi32(f01, 16), _mm_srai_epi32(f23, 16));
+            i = _mm_min_epi16(_mm_max_epi16(i, zero), wide_max);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(xy), i);
+
+            srcXY += 8;
+            xy += 4;
+            count -= 4;
+        }
+
+        while (--count >= 0) {
+            *xy++ = (SkClampMax(srcXY[1] >> 16, maxY) << 16) |
+                     SkClampMax(srcXY[0] >> 16, maxX);
+            srcXY += 2;
+        }
+    }
+}
+
+namespace {
+
+// Bilinearly filter two pixels, given their packed (y, x) coordinates in xy[0..3].
+// Returns the first pixel's components in 16 bit lanes 0..3 and the second's in 4..7,
+// computed exactly as Filter_32_opaque() / Filter_32_alpha() do.
+template<bool has_alpha>
+inline __m128i FilterTwoPixelsDXDY(const char* srcAddr, size_t rb, const uint32_t* xy,
+                                   __m128i alpha) {
+    const uint32_t YY0 = xy[0], XX0 = xy[1], YY1 = xy[2], XX1 = xy[3];
+    const uint32_t* row00 = reinterpret_cast<const uint32_t*>(srcAddr + (YY0 >> 18) * rb);
+    const uint32_t* row01 = reinterpret_cast<const uint32_t*>(srcAddr + (YY0 & 0x3FFF) * rb);
+    const uint32_t* row10 = reinterpret_cast<const uint32_t*>(srcAddr + (YY1 >> 18) * rb);
+    const uint32_t* row11 = reinterpret_cast<const uint32_t*>(srcAddr + (YY1 & 0x3FFF) * rb);
+    const unsigned x00 = XX0 >> 18, x01 = XX0 & 0x3FFF;
+    const unsigned x10 = XX1 >> 18, x11 = XX1 & 0x3FFF;
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i sixteen = _mm_set1_epi16(16);
+
+    // (x1, x1, x1, x1, x0, x0, x0, x0) and likewise for y
+    const short subX0 = (XX0 >> 14) & 0xF, subX1 = (XX1 >> 14) & 0xF;
+    const short subY0 = (YY0 >> 14) & 0xF, subY1 = (YY1 >> 14) & 0xF;
+    const __m128i allX = _mm_set_epi16(subX1, subX1, subX1, subX1,
+                                       subX0, subX0, subX0, subX0);
+    const __m128i allY = _mm_set_epi16(subY1, subY1, subY1, subY1,
+                                       subY0, subY0, subY0, subY0);
+    const __m128i negX = _mm_sub_epi16(sixteen, allX);
+    const __m128i negY = _mm_sub_epi16(sixteen, allY);
+
+    // Load the 4 samples of each pixel and expand them to 16 bits per component.
+    __m128i a00 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(row00[x00]), _mm_cvtsi32_si128(row10[x10]));
+    __m128i a01 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(row00[x01]), _mm_cvtsi32_si128(row10[x11]));
+    __m128i a10 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(row01[x00]), _mm_cvtsi32_si128(row11[x10]));
+    __m128i a11 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(row01[x01]), _mm_cvtsi32_si128(row11[x11]));
+    a00 = _mm_unpacklo_epi8(a00, zero);
+    a01 = _mm_unpacklo_epi8(a01, zero);
+    a10 = _mm_unpacklo_epi8(a10, zero);
+    a11 = _mm_unpacklo_epi8(a11, zero);
+
+    // The weights sum to 256, so the sum of products fits in 16 unsigned bits.
+    __m128i sum = _mm_mullo_epi16(a00, _mm_mullo_epi16(negX, negY));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(a01, _mm_mullo_epi16(allX, negY)));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(a10, _mm_mullo_epi16(negX, allY)));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(a11, _mm_mullo_epi16(allX, allY)));
+
+    // Divide each 16 bit component by 256.
+    sum = _mm_srli_epi16(sum, 8);
+
+    if (has_alpha) {
+        sum = _mm_srli_epi16(_mm_mullo_epi16(sum, alpha), 8);
+    }
+    return sum;
+}
+
+template<bool has_alpha>
+void S32_generic_D32_filter_DXDY_SSE2(const SkBitmapProcState& s,
+                                      const uint32_t* xy,
+                                      int count, uint32_t* colors) {
+    SkASSERT(count > 0 && colors != NULL);
+    SkASSERT(s.fFilterLevel != SkPaint::kNone_FilterLevel);
+    SkASSERT(kN32_SkColorType == s.fBitmap->colorType());
+    if (has_alpha) {
+        SkASSERT(s.fAlphaScale < 256);
+    } else {
+        SkASSERT(s.fAlphaScale == 256);
+    }
+
+    const char* srcAddr = static_cast<const char*>(s.fBitmap->getPixels());
+    const size_t rb = s.fBitmap->rowBytes();
+    const __m128i alpha = _mm_set1_epi16(s.fAlphaScale);
+    const __m128i zero = _mm_setzero_si128();
+
+    while (count >= 2) {
+        __m128i sum = FilterTwoPixelsDXDY<has_alpha>(srcAddr, rb, xy, alpha);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(colors), _mm_packus_epi16(sum, zero));
+        xy += 4;
+        colors += 2;
+        count -= 2;
+    }
+
+    if (count > 0) {
+        // Filter the last pixel twice.
+        const uint32_t last[4] = { xy[0], xy[1], xy[0], xy[1] };
+        __m128i sum = FilterTwoPixelsDXDY<has_alpha>(srcAddr, rb, last, alpha);
+        *colors = _mm_cvtsi128_si32(_mm_packus_epi16(sum, zero));
+    }
+}
+
+}  // namespace
+
+void S32_opaque_D32_filter_DXDY_SSE2(const SkBitmapProcState& s,
+                                     const uint32_t* xy,
+                                     int count, uint32_t* colors) {
+    S32_generic_D32_filter_DXDY_SSE2<false>(s, xy, count, colors);
+}
+
+void S32_alpha_D32_filter_DXDY_SSE2(const SkBitmapProcState& s,
+                                    const uint32_t* xy,
+                                    int count, uint32_t* colors) {
+    S32_generic_D32_filter_DXDY_SSE2<true>(s, xy, count, colors);
+}
+
 /*  SSE version of S32_D16_filter_DX_SSE2
  *  Definition is in section of "D16 functions for SRC == 8888" in SkBitmapProcState.cpp
  *  It combines S32_opaque_D32_filter_DX_SSE2 and SkPixel32ToPixel16
@@ -0,0 +1,311 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <immintrin.h>
+#include "SkBitmapProcState_opts_SSE2.h"
+#include "SkBlitRow_opts_AVX2.h"
+#include "SkBlitRow_opts_SSE2.h"
+#include "SkColorPriv.h"
+#include "SkUtils.h"
+
+/* These are the SSE2 procs from SkBlitRow_opts_SSE2.cpp widened to 8 pixels
+ * per iteration. Every AVX2 integer op used here works independently on each
+ * 128-bit lane, so the arithmetic (and therefore the result) is exactly that
+ * of the SSE2 versions. Fewer than 8 trailing pixels are handed to the SSE2
+ * procs, which finish them 4 at a time and then one at a time.
+ */
+
+/* AVX2 version of S32_Blend_BlitRow32()
+ * portable version is in core/SkBlitRow_D32.cpp
+ */
+void S32_Blend_BlitRow32_AVX2(SkPMColor* SK_RESTRICT dst,
+                              const SkPMColor* SK_RESTRICT src,
+                              int count, U8CPU alpha) {
+    SkASSERT(alpha <= 255);
+    if (count <= 0) {
+        return;
+    }
+
+    uint32_t src_scale = SkAlpha255To256(alpha);
+    uint32_t dst_scale = 256 - src_scale;
+
+    if (count >= 8) {
+        SkASSERT(((size_t)dst & 0x03) == 0);
+        while (((size_t)dst & 0x1F) != 0) {
+            *dst = SkAlphaMulQ(*src, src_scale) + SkAlphaMulQ(*dst, dst_scale);
+            src++;
+            dst++;
+            count--;
+        }
+
+        const __m256i *s = reinterpret_cast<const __m256i*>(src);
+        __m256i *d = reinterpret_cast<__m256i*>(dst);
+        __m256i rb_mask = _mm256_set1_epi32(0x00FF00FF);
+        __m256i ag_mask = _mm256_set1_epi32(0xFF00FF00);
+
+        // Move scale factors to upper byte of word
+        __m256i src_scale_wide = _mm256_set1_epi16(src_scale << 8);
+        __m256i dst_scale_wide = _mm256_set1_epi16(dst_scale << 8);
+        while (count >= 8) {
+            // Load 8 pixels each of src and dest.
+            __m256i src_pixel = _mm256_loadu_si256(s);
+            __m256i dst_pixel = _mm256_load_si256(d);
+
+            // (8 x (0, rs.h, 0, bs.h)), see the SSE2 version for details.
+            __m256i src_rb = _mm256_and_si256(rb_mask, src_pixel);
+            src_rb = _mm256_mulhi_epu16(src_rb, src_scale_wide);
+            // (8 x (as.h, 0, gs.h, 0))
+            __m256i src_ag = _mm256_and_si256(ag_mask, src_pixel);
+            src_ag = _mm256_mulhi_epu16(src_ag, src_scale_wide);
+            src_ag = _mm256_and_si256(src_ag, ag_mask);
+
+            __m256i dst_rb = _mm256_and_si256(rb_mask, dst_pixel);
+            dst_rb = _mm256_mulhi_epu16(dst_rb, dst_scale_wide);
+            __m256i dst_ag = _mm256_and_si256(ag_mask, dst_pixel);
+            dst_ag = _mm256_mulhi_epu16(dst_ag, dst_scale_wide);
+            dst_ag = _mm256_and_si256(dst_ag, ag_mask);
+
+            // Combine back into RGBA.
+            src_pixel = _mm256_or_si256(src_rb, src_ag);
+            dst_pixel = _mm256_or_si256(dst_rb, dst_ag);
+
+            // Add result
+            __m256i result = _mm256_add_epi8(src_pixel, dst_pixel);
+            _mm256_store_si256(d, result);
+            s++;
+            d++;
+            count -= 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<SkPMColor*>(d);
+    }
+
+    S32_Blend_BlitRow32_SSE2(dst, src, count, alpha);
+}
+
+void S32A_Opaque_BlitRow32_AVX2(SkPMColor* SK_RESTRICT dst,
+                                const SkPMColor* SK_RESTRICT src,
+                                int count, U8CPU alpha) {
+    SkASSERT(alpha == 255);
+    if (count <= 0) {
+        return;
+    }
+
+    if (count >= 8) {
+        SkASSERT(((size_t)dst & 0x03) == 0);
+        while (((size_t)dst & 0x1F) != 0) {
+            *dst = SkPMSrcOver(*src, *dst);
+            src++;
+            dst++;
+            count--;
+        }
+
+        const __m256i *s = reinterpret_cast<const __m256i*>(src);
+        __m256i *d = reinterpret_cast<__m256i*>(dst);
+#ifdef SK_USE_ACCURATE_BLENDING
+        __m256i rb_mask = _mm256_set1_epi32(0x00FF00FF);
+        __m256i c_128 = _mm256_set1_epi16(128);  // 16 copies of 128 (16-bit)
+        __m256i c_255 = _mm256_set1_epi16(255);  // 16 copies of 255 (16-bit)
+        while (count >= 8) {
+            // Load 8 pixels
+            __m256i src_pixel = _mm256_loadu_si256(s);
+            __m256i dst_pixel = _mm256_load_si256(d);
+
+            __m256i dst_rb = _mm256_and_si256(rb_mask, dst_pixel);
+            __m256i dst_ag = _mm256_srli_epi16(dst_pixel, 8);
+
+            // Copy the 255 - alpha of each pixel into both of its words.
+            __m256i alpha = _mm256_srli_epi32(src_pixel, 24);
+            alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 16));
+            alpha = _mm256_sub_epi16(c_255, alpha);
+
+            dst_rb = _mm256_mullo_epi16(dst_rb, alpha);
+            dst_ag = _mm256_mullo_epi16(dst_ag, alpha);
+
+            // x = (x + (x >> 8) + 128) >> 8
+            __m256i dst_rb_low = _mm256_srli_epi16(dst_rb, 8);
+            __m256i dst_ag_low = _mm256_srli_epi16(dst_ag, 8);
+            dst_rb = _mm256_add_epi16(dst_rb, dst_rb_low);
+            dst_rb = _mm256_add_epi16(dst_rb, c_128);
+            dst_rb = _mm256_srli_epi16(dst_rb, 8);
+            dst_ag = _mm256_add_epi16(dst_ag, dst_ag_low);
+            dst_ag = _mm256_add_epi16(dst_ag, c_128);
+            dst_ag = _mm256_andnot_si256(rb_mask, dst_ag);
+
+            // Combine back into RGBA and add result.
+            dst_pixel = _mm256_or_si256(dst_rb, dst_ag);
+            __m256i result = _mm256_add_epi8(src_pixel, dst_pixel);
+            _mm256_store_si256(d, result);
+            s++;
+            d++;
+            count -= 8;
+        }
+#else
+        __m256i rb_mask = _mm256_set1_epi32(0x00FF00FF);
+        __m256i c_256 = _mm256_set1_epi16(0x0100);  // 16 copies of 256 (16-bit)
+        while (count >= 8) {
+            // Load 8 pixels
+            __m256i src_pixel = _mm256_loadu_si256(s);
+            __m256i dst_pixel = _mm256_load_si256(d);
+
+            __m256i dst_rb = _mm256_and_si256(rb_mask, dst_pixel);
+            __m256i dst_ag = _mm256_srli_epi16(dst_pixel, 8);
+
+            // (a0, a0, a1, a1, a2, a2, a3, a3) in each lane.
+            __m256i alpha = _mm256_srli_epi16(src_pixel, 8);
+            alpha = _mm256_shufflehi_epi16(alpha, 0xF5);
+            alpha = _mm256_shufflelo_epi16(alpha, 0xF5);
+
+            // Subtract alphas from 256, to get 1..256
+            alpha = _mm256_sub_epi16(c_256, alpha);
+
+            dst_rb = _mm256_mullo_epi16(dst_rb, alpha);
+            dst_ag = _mm256_mullo_epi16(dst_ag, alpha);
+
+            // Divide by 256, and mask out high bits of alpha and green.
+            dst_rb = _mm256_srli_epi16(dst_rb, 8);
+            dst_ag = _mm256_andnot_si256(rb_mask, dst_ag);
+
+            // Combine back into RGBA and add result.
+            dst_pixel = _mm256_or_si256(dst_rb, dst_ag);
+            __m256i result = _mm256_add_epi8(src_pixel, dst_pixel);
+            _mm256_store_si256(d, result);
+            s++;
+            d++;
+            count -= 8;
+        }
+#endif
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<SkPMColor*>(d);
+    }
+
+    S32A_Opaque_BlitRow32_SSE2(dst, src, count, alpha);
+}
+
+void S32A_Blend_BlitRow32_AVX2(SkPMColor* SK_RESTRICT dst,
+                               const SkPMColor* SK_RESTRICT src,
+                               int count, U8CPU alpha) {
+    SkASSERT(alpha <= 255);
+    if (count <= 0) {
+        return;
+    }
+
+    if (count >= 8) {
+        while (((size_t)dst & 0x1F) != 0) {
+            *dst = SkBlendARGB32(*src, *dst, alpha);
+            src++;
+            dst++;
+            count--;
+        }
+
+        uint32_t src_scale = SkAlpha255To256(alpha);
+
+        const __m256i *s = reinterpret_cast<const __m256i*>(src);
+        __m256i *d = reinterpret_cast<__m256i*>(dst);
+        __m256i src_scale_wide = _mm256_set1_epi16(src_scale << 8);
+        __m256i rb_mask = _mm256_set1_epi32(0x00FF00FF);
+        __m256i c_256 = _mm256_set1_epi16(256);  // 16 copies of 256 (16-bit)
+        while (count >= 8) {
+            // Load 8 pixels each of src and dest.
+            __m256i src_pixel = _mm256_loadu_si256(s);
+            __m256i dst_pixel = _mm256_load_si256(d);
+
+            __m256i dst_rb = _mm256_and_si256(rb_mask, dst_pixel);
+            __m256i src_rb = _mm256_and_si256(rb_mask, src_pixel);
+            __m256i dst_ag = _mm256_srli_epi16(dst_pixel, 8);
+            __m256i src_ag = _mm256_srli_epi16(src_pixel, 8);
+
+            // 256 - (src alpha * src_scale), in both words of each pixel.
+            __m256i dst_alpha = _mm256_shufflehi_epi16(src_ag, 0xF5);
+            dst_alpha = _mm256_shufflelo_epi16(dst_alpha, 0xF5);
+            dst_alpha = _mm256_mulhi_epu16(dst_alpha, src_scale_wide);
+            dst_alpha = _mm256_sub_epi16(c_256, dst_alpha);
+
+            // Scale dst by the per-pixel alpha and src by the global alpha.
+            dst_rb = _mm256_mullo_epi16(dst_rb, dst_alpha);
+            dst_ag = _mm256_mullo_epi16(dst_ag, dst_alpha);
+            src_rb = _mm256_mulhi_epu16(src_rb, src_scale_wide);
+            src_ag = _mm256_mulhi_epu16(src_ag, src_scale_wide);
+
+            dst_rb = _mm256_srli_epi16(dst_rb, 8);
+            dst_ag = _mm256_andnot_si256(rb_mask, dst_ag);
+            src_ag = _mm256_slli_epi16(src_ag, 8);
+
+            // Combine back into RGBA and add the two pixels.
+            dst_pixel = _mm256_or_si256(dst_rb, dst_ag);
+            src_pixel = _mm256_or_si256(src_rb, src_ag);
+            __m256i result = _mm256_add_epi8(src_pixel, dst_pixel);
+            _mm256_store_si256(d, result);
+            s++;
+            d++;
+            count -= 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<SkPMColor*>(d);
+    }
+
+    S32A_Blend_BlitRow32_SSE2(dst, src, count, alpha);
+}
+
+/* AVX2 version of Color32()
+ * portable version is in core/SkBlitRow_D32.cpp
+ */
+void Color32_AVX2(SkPMColor dst[], const SkPMColor src[], int count,
+                  SkPMColor color) {
+    if (count <= 0) {
+        return;
+    }
+
+    unsigned colorA = SkGetPackedA32(color);
+    if (0 == color || 255 == colorA) {
+        // Nothing to blend: this is a memcpy or a memset32.
+        Color32_SSE2(dst, src, count, color);
+        return;
+    }
+
+    unsigned scale = 256 - SkAlpha255To256(colorA);
+
+    if (count >= 8) {
+        SkASSERT(((size_t)dst & 0x03) == 0);
+        while (((size_t)dst & 0x1F) != 0) {
+            *dst = color + SkAlphaMulQ(*src, scale);
+            src++;
+            dst++;
+            count--;
+        }
+
+        const __m256i *s = reinterpret_cast<const __m256i*>(src);
+        __m256i *d = reinterpret_cast<__m256i*>(dst);
+        __m256i rb_mask = _mm256_set1_epi32(0x00FF00FF);
+        __m256i src_scale_wide = _mm256_set1_epi16(scale);
+        __m256i color_wide = _mm256_set1_epi32(color);
+        while (count >= 8) {
+            __m256i src_pixel = _mm256_loadu_si256(s);
+
+            __m256i src_rb = _mm256_and_si256(rb_mask, src_pixel);
+            __m256i src_ag = _mm256_srli_epi16(src_pixel, 8);
+
+            // Multiply by scale and divide by 256.
+            src_rb = _mm256_mullo_epi16(src_rb, src_scale_wide);
+            src_ag = _mm256_mullo_epi16(src_ag, src_scale_wide);
+            src_rb = _mm256_srli_epi16(src_rb, 8);
+            src_ag = _mm256_andnot_si256(rb_mask, src_ag);
+
+            // Combine back into RGBA and add color.
+            src_pixel = _mm256_or_si256(src_rb, src_ag);
+            __m256i result = _mm256_add_epi8(color_wide, src_pixel);
+            _mm256_store_si256(d, result);
+            s++;
+            d++;
+            count -= 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<SkPMColor*>(d);
+    }
+
+    Color32_SSE2(dst, src, count, color);
+}
@@ -11,6 +11,7 @@
 #include "SkColorPriv.h"
 #include "SkColor_opts_SSE2.h"
 #include "SkDither.h"
+#include "SkMathPriv.h"
 #include "SkUtils.h"
 
 /* SSE2 version of S32_Blend_BlitRow32()
@@ -512,6 +513,57 @@ void SkARGB32_A8_BlitMask_SSE2(void* device, size_t dstRB, const void* maskPtr,
     } while (--height != 0);
 }
 
+// Black text: dst = (aa << SK_A32_SHIFT) + SkAlphaMulQ(dst, 256 - aa), bit for
+// bit the same as the portable D32_A8_Black.
+void SkARGB32_A8_BlitMask_Black_SSE2(void* device, size_t dstRB, const void* maskPtr,
+                                     size_t maskRB, SkColor, int width, int height) {
+    SkPMColor* dst = (SkPMColor*)device;
+    const uint8_t* mask = (const uint8_t*)maskPtr;
+    const __m128i rb_mask = _mm_set1_epi32(0x00FF00FF);
+    const __m128i c_256 = _mm_set1_epi16(256);
+    const __m128i zero = _mm_setzero_si128();
+
+    dstRB -= (width << 2);
+    maskRB -= width;
+    do {
+        int count = width;
+        while (count >= 4) {
+            uint32_t aa4;
+            memcpy(&aa4, mask, sizeof(aa4));
+            if (0 != aa4) {
+                __m128i dst_pixel = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst));
+
+                // One coverage value per pixel, then per 16-bit lane.
+                __m128i aa = _mm_cvtsi32_si128(aa4);
+                aa = _mm_unpacklo_epi8(aa, zero);
+                aa = _mm_unpacklo_epi16(aa, zero);
+                __m128i scale = _mm_or_si128(aa, _mm_slli_epi32(aa, 16));
+                scale = _mm_sub_epi16(c_256, scale);
+
+                __m128i dst_rb = _mm_and_si128(rb_mask, dst_pixel);
+                __m128i dst_ag = _mm_srli_epi16(dst_pixel, 8);
+                dst_rb = _mm_srli_epi16(_mm_mullo_epi16(dst_rb, scale), 8);
+                dst_ag = _mm_andnot_si128(rb_mask, _mm_mullo_epi16(dst_ag, scale));
+
+                __m128i result = _mm_or_si128(dst_rb, dst_ag);
+                result = _mm_add_epi32(result, _mm_slli_epi32(aa, SK_A32_SHIFT));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), result);
+            }
+            mask += 4;
+            dst += 4;
+            count -= 4;
+        }
+        while (count > 0) {
+            unsigned aa = *mask++;
+            *dst = (aa << SK_A32_SHIFT) + SkAlphaMulQ(*dst, SkAlpha255To256(255 - aa));
+            dst += 1;
+            count -= 1;
+        }
+        dst = (SkPMColor*)((char*)dst + dstRB);
+        mask += maskRB;
+    } while (--height != 0);
+}
+
 // The following (left) shifts cause the top 5 bits of the mask components to
 // line up with the corresponding components in an SkPMColor.
 // Note that the mask's RGB16 order may differ from the SkPMColor order.
@@ -1359,3 +1411,359 @@ void S32A_D565_Opaque_Dither_SSE2(uint16_t* SK_RESTRICT dst,
         } while (--count != 0);
     }
 }
+
+// Extracts the 8-bit channel at shift from 8 pixels, into 16-bit lanes.
+static inline __m128i SkGetPacked32_SSE2(const __m128i& src_pixel1,
+                                         const __m128i& src_pixel2, int shift) {
+    __m128i c1 = _mm_srli_epi32(_mm_slli_epi32(src_pixel1, 24 - shift), 24);
+    __m128i c2 = _mm_srli_epi32(_mm_slli_epi32(src_pixel2, 24 - shift), 24);
+    return _mm_packs_epi32(c1, c2);
+}
+
+// The dither values for 8 pixels starting at x on row y. They repeat every 4
+// pixels, so they stay put as x advances by 8.
+static inline __m128i SkDitherValues565_SSE2(int x, int y) {
+    uint16_t dither_value[8];
+    DITHER_565_SCAN(y);
+    for (int i = 0; i < 4; ++i) {
+        dither_value[i] = dither_value[i + 4] = DITHER_VALUE(x + i);
+    }
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(dither_value));
+}
+
+/* SSE2 version of S32_D565_Blend()
+ * portable version is in core/SkBlitRow_D16.cpp
+ */
+void S32_D565_Blend_SSE2(uint16_t* SK_RESTRICT dst,
+                         const SkPMColor* SK_RESTRICT src, int count,
+                         U8CPU alpha, int /*x*/, int /*y*/) {
+    SkASSERT(255 > alpha);
+
+    if (count <= 0) {
+        return;
+    }
+
+    int scale = SkAlpha255To256(alpha);
+
+    if (count >= 8) {
+        const __m128i* s = reinterpret_cast<const __m128i*>(src);
+        __m128i* d = reinterpret_cast<__m128i*>(dst);
+        __m128i scale_wide = _mm_set1_epi16(scale);
+        __m128i r16_mask = _mm_set1_epi16(SK_R16_MASK);
+        __m128i g16_mask = _mm_set1_epi16(SK_G16_MASK);
+        __m128i b16_mask = _mm_set1_epi16(SK_B16_MASK);
+
+        while (count >= 8) {
+            __m128i src_pixel1 = _mm_loadu_si128(s++);
+            __m128i src_pixel2 = _mm_loadu_si128(s++);
+            __m128i dst_pixel = _mm_loadu_si128(d);
+
+            // Reduce src to 565.
+            __m128i sr = _mm_srli_epi16(SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_R32_SHIFT),
+                                        8 - SK_R16_BITS);
+            __m128i sg = _mm_srli_epi16(SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_G32_SHIFT),
+                                        8 - SK_G16_BITS);
+            __m128i sb = _mm_srli_epi16(SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_B32_SHIFT),
+                                        8 - SK_B16_BITS);
+
+            __m128i dr = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_R16_SHIFT), r16_mask);
+            __m128i dg = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_G16_SHIFT), g16_mask);
+            __m128i db = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_B16_SHIFT), b16_mask);
+
+            // SkAlphaBlend(s, d, scale) == d + ((s - d) * scale >> 8), signed.
+            dr = _mm_add_epi16(dr, _mm_srai_epi16(
+                    _mm_mullo_epi16(_mm_sub_epi16(sr, dr), scale_wide), 8));
+            dg = _mm_add_epi16(dg, _mm_srai_epi16(
+                    _mm_mullo_epi16(_mm_sub_epi16(sg, dg), scale_wide), 8));
+            db = _mm_add_epi16(db, _mm_srai_epi16(
+                    _mm_mullo_epi16(_mm_sub_epi16(sb, db), scale_wide), 8));
+
+            _mm_storeu_si128(d++, SkPackRGB16_SSE2(dr, dg, db));
+            count -= 8;
+        }
+
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<uint16_t*>(d);
+    }
+
+    while (count > 0) {
+        SkPMColor c = *src++;
+        SkPMColorAssert(c);
+        uint16_t d = *dst;
+        *dst++ = SkPackRGB16(
+                SkAlphaBlend(SkPacked32ToR16(c), SkGetPackedR16(d), scale),
+                SkAlphaBlend(SkPacked32ToG16(c), SkGetPackedG16(d), scale),
+                SkAlphaBlend(SkPacked32ToB16(c), SkGetPackedB16(d), scale));
+        count--;
+    }
+}
+
+// SkDiv255Round() on 16-bit lanes, for products of two bytes.
+static inline __m128i SkDiv255Round_SSE2(const __m128i& prod) {
+    __m128i v = _mm_add_epi16(prod, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+}
+
+/* SSE2 version of S32A_D565_Blend()
+ * portable version is in core/SkBlitRow_D16.cpp
+ */
+void S32A_D565_Blend_SSE2(uint16_t* SK_RESTRICT dst,
+                          const SkPMColor* SK_RESTRICT src, int count,
+                          U8CPU alpha, int /*x*/, int /*y*/) {
+    SkASSERT(255 > alpha);
+
+    if (count <= 0) {
+        return;
+    }
+
+    if (count >= 8) {
+        const __m128i* s = reinterpret_cast<const __m128i*>(src);
+        __m128i* d = reinterpret_cast<__m128i*>(dst);
+        __m128i alpha_wide = _mm_set1_epi16(alpha);
+        __m128i var255 = _mm_set1_epi16(255);
+        __m128i r16_mask = _mm_set1_epi16(SK_R16_MASK);
+        __m128i g16_mask = _mm_set1_epi16(SK_G16_MASK);
+        __m128i b16_mask = _mm_set1_epi16(SK_B16_MASK);
+
+        while (count >= 8) {
+            __m128i src_pixel1 = _mm_loadu_si128(s++);
+            __m128i src_pixel2 = _mm_loadu_si128(s++);
+            __m128i dst_pixel = _mm_loadu_si128(d);
+
+            // 255 - SkMulDiv255Round(sa, alpha). Transparent src leaves dst
+            // as it is, so needs no special case.
+            __m128i sa = SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_A32_SHIFT);
+            __m128i dst_scale = _mm_sub_epi16(var255,
+                                              SkMul16ShiftRound_SSE2(sa, alpha_wide, 8));
+
+            __m128i sr = _mm_srli_epi16(SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_R32_SHIFT),
+                                        8 - SK_R16_BITS);
+            __m128i sg = _mm_srli_epi16(SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_G32_SHIFT),
+                                        8 - SK_G16_BITS);
+            __m128i sb = _mm_srli_epi16(SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_B32_SHIFT),
+                                        8 - SK_B16_BITS);
+
+            __m128i dr = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_R16_SHIFT), r16_mask);
+            __m128i dg = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_G16_SHIFT), g16_mask);
+            __m128i db = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_B16_SHIFT), b16_mask);
+
+            // SkDiv255Round(s * alpha + d * dst_scale), which fits in 16 bits.
+            dr = _mm_add_epi16(_mm_mullo_epi16(sr, alpha_wide),
+                               _mm_mullo_epi16(dr, dst_scale));
+            dg = _mm_add_epi16(_mm_mullo_epi16(sg, alpha_wide),
+                               _mm_mullo_epi16(dg, dst_scale));
+            db = _mm_add_epi16(_mm_mullo_epi16(sb, alpha_wide),
+                               _mm_mullo_epi16(db, dst_scale));
+            dr = SkDiv255Round_SSE2(dr);
+            dg = SkDiv255Round_SSE2(dg);
+            db = SkDiv255Round_SSE2(db);
+
+            _mm_storeu_si128(d++, SkPackRGB16_SSE2(dr, dg, db));
+            count -= 8;
+        }
+
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<uint16_t*>(d);
+    }
+
+    while (count > 0) {
+        SkPMColor sc = *src++;
+        SkPMColorAssert(sc);
+        if (sc) {
+            uint16_t dc = *dst;
+            unsigned dst_scale = 255 - SkMulDiv255Round(SkGetPackedA32(sc), alpha);
+            unsigned dr = SkMulS16(SkPacked32ToR16(sc), alpha) +
+                          SkMulS16(SkGetPackedR16(dc), dst_scale);
+            unsigned dg = SkMulS16(SkPacked32ToG16(sc), alpha) +
+                          SkMulS16(SkGetPackedG16(dc), dst_scale);
+            unsigned db = SkMulS16(SkPacked32ToB16(sc), alpha) +
+                          SkMulS16(SkGetPackedB16(dc), dst_scale);
+            *dst = SkPackRGB16(SkDiv255Round(dr), SkDiv255Round(dg), SkDiv255Round(db));
+        }
+        dst += 1;
+        count--;
+    }
+}
+
+// SkDITHER_R32To565() and friends, on 8 channels in 16-bit lanes.
+static inline __m128i SkDitherR32To565_SSE2(const __m128i& r, const __m128i& dither) {
+    __m128i v = _mm_sub_epi16(_mm_add_epi16(r, dither), _mm_srli_epi16(r, 5));
+    return _mm_srli_epi16(v, SK_R32_BITS - SK_R16_BITS);
+}
+
+static inline __m128i SkDitherG32To565_SSE2(const __m128i& g, const __m128i& dither) {
+    __m128i v = _mm_sub_epi16(_mm_add_epi16(g, _mm_srli_epi16(dither, 1)),
+                              _mm_srli_epi16(g, 6));
+    return _mm_srli_epi16(v, SK_G32_BITS - SK_G16_BITS);
+}
+
+static inline __m128i SkDitherB32To565_SSE2(const __m128i& b, const __m128i& dither) {
+    __m128i v = _mm_sub_epi16(_mm_add_epi16(b, dither), _mm_srli_epi16(b, 5));
+    return _mm_srli_epi16(v, SK_B32_BITS - SK_B16_BITS);
+}
+
+/* SSE2 version of S32_D565_Blend_Dither()
+ * portable version is in core/SkBlitRow_D16.cpp
+ */
+void S32_D565_Blend_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                const SkPMColor* SK_RESTRICT src,
+                                int count, U8CPU alpha, int x, int y) {
+    SkASSERT(255 > alpha);
+
+    if (count <= 0) {
+        return;
+    }
+
+    int scale = SkAlpha255To256(alpha);
+
+    if (count >= 8) {
+        const __m128i* s = reinterpret_cast<const __m128i*>(src);
+        __m128i* d = reinterpret_cast<__m128i*>(dst);
+        __m128i dither = SkDitherValues565_SSE2(x, y);
+        __m128i scale_wide = _mm_set1_epi16(scale);
+        __m128i r16_mask = _mm_set1_epi16(SK_R16_MASK);
+        __m128i g16_mask = _mm_set1_epi16(SK_G16_MASK);
+        __m128i b16_mask = _mm_set1_epi16(SK_B16_MASK);
+
+        while (count >= 8) {
+            __m128i src_pixel1 = _mm_loadu_si128(s++);
+            __m128i src_pixel2 = _mm_loadu_si128(s++);
+            __m128i dst_pixel = _mm_loadu_si128(d);
+
+            __m128i sr = SkDitherR32To565_SSE2(
+                    SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_R32_SHIFT), dither);
+            __m128i sg = SkDitherG32To565_SSE2(
+                    SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_G32_SHIFT), dither);
+            __m128i sb = SkDitherB32To565_SSE2(
+                    SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_B32_SHIFT), dither);
+
+            __m128i dr = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_R16_SHIFT), r16_mask);
+            __m128i dg = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_G16_SHIFT), g16_mask);
+            __m128i db = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_B16_SHIFT), b16_mask);
+
+            dr = _mm_add_epi16(dr, _mm_srai_epi16(
+                    _mm_mullo_epi16(_mm_sub_epi16(sr, dr), scale_wide), 8));
+            dg = _mm_add_epi16(dg, _mm_srai_epi16(
+                    _mm_mullo_epi16(_mm_sub_epi16(sg, dg), scale_wide), 8));
+            db = _mm_add_epi16(db, _mm_srai_epi16(
+                    _mm_mullo_epi16(_mm_sub_epi16(sb, db), scale_wide), 8));
+
+            _mm_storeu_si128(d++, SkPackRGB16_SSE2(dr, dg, db));
+            count -= 8;
+            x += 8;
+        }
+
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<uint16_t*>(d);
+    }
+
+    if (count > 0) {
+        DITHER_565_SCAN(y);
+        do {
+            SkPMColor c = *src++;
+            SkPMColorAssert(c);
+
+            int dither = DITHER_VALUE(x);
+            int sr = SkDITHER_R32To565(SkGetPackedR32(c), dither);
+            int sg = SkDITHER_G32To565(SkGetPackedG32(c), dither);
+            int sb = SkDITHER_B32To565(SkGetPackedB32(c), dither);
+
+            uint16_t d = *dst;
+            *dst++ = SkPackRGB16(SkAlphaBlend(sr, SkGetPackedR16(d), scale),
+                                 SkAlphaBlend(sg, SkGetPackedG16(d), scale),
+                                 SkAlphaBlend(sb, SkGetPackedB16(d), scale));
+            DITHER_INC_X(x);
+        } while (--count != 0);
+    }
+}
+
+/* SSE2 version of S32A_D565_Blend_Dither()
+ * portable version is in core/SkBlitRow_D16.cpp
+ */
+void S32A_D565_Blend_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                 const SkPMColor* SK_RESTRICT src,
+                                 int count, U8CPU alpha, int x, int y) {
+    SkASSERT(255 > alpha);
+
+    if (count <= 0) {
+        return;
+    }
+
+    int src_scale = SkAlpha255To256(alpha);
+
+    if (count >= 8) {
+        const __m128i* s = reinterpret_cast<const __m128i*>(src);
+        __m128i* d = reinterpret_cast<__m128i*>(dst);
+        __m128i dither = SkDitherValues565_SSE2(x, y);
+        __m128i src_scale_wide = _mm_set1_epi16(src_scale);
+        __m128i var256 = _mm_set1_epi16(256);
+        __m128i r16_mask = _mm_set1_epi16(SK_R16_MASK);
+        __m128i g16_mask = _mm_set1_epi16(SK_G16_MASK);
+        __m128i b16_mask = _mm_set1_epi16(SK_B16_MASK);
+
+        while (count >= 8) {
+            __m128i src_pixel1 = _mm_loadu_si128(s++);
+            __m128i src_pixel2 = _mm_loadu_si128(s++);
+            __m128i dst_pixel = _mm_loadu_si128(d);
+
+            // SkAlpha255To256(255 - SkAlphaMul(sa, src_scale)). Transparent
+            // src dithers to 0 and leaves dst as it is, so needs no special
+            // case.
+            __m128i sa = SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_A32_SHIFT);
+            __m128i dst_scale = _mm_sub_epi16(var256, _mm_srli_epi16(
+                    _mm_mullo_epi16(sa, src_scale_wide), 8));
+
+            __m128i sr = SkDitherR32To565_SSE2(
+                    SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_R32_SHIFT), dither);
+            __m128i sg = SkDitherG32To565_SSE2(
+                    SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_G32_SHIFT), dither);
+            __m128i sb = SkDitherB32To565_SSE2(
+                    SkGetPacked32_SSE2(src_pixel1, src_pixel2, SK_B32_SHIFT), dither);
+
+            __m128i dr = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_R16_SHIFT), r16_mask);
+            __m128i dg = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_G16_SHIFT), g16_mask);
+            __m128i db = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_B16_SHIFT), b16_mask);
+
+            // (s * src_scale + d * dst_scale) >> 8, which fits in 16 bits.
+            dr = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(sr, src_scale_wide),
+                                              _mm_mullo_epi16(dr, dst_scale)), 8);
+            dg = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(sg, src_scale_wide),
+                                              _mm_mullo_epi16(dg, dst_scale)), 8);
+            db = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(sb, src_scale_wide),
+                                              _mm_mullo_epi16(db, dst_scale)), 8);
+
+            _mm_storeu_si128(d++, SkPackRGB16_SSE2(dr, dg, db));
+            count -= 8;
+            x += 8;
+        }
+
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<uint16_t*>(d);
+    }
+
+    if (count > 0) {
+        DITHER_565_SCAN(y);
+        do {
+            SkPMColor c = *src++;
+            SkPMColorAssert(c);
+            if (c) {
+                unsigned d = *dst;
+                int sa = SkGetPackedA32(c);
+                int dst_scale = SkAlpha255To256(255 - SkAlphaMul(sa, src_scale));
+                int dither = DITHER_VALUE(x);
+
+                int sr = SkDITHER_R32To565(SkGetPackedR32(c), dither);
+                int sg = SkDITHER_G32To565(SkGetPackedG32(c), dither);
+                int sb = SkDITHER_B32To565(SkGetPackedB32(c), dither);
+
+                int dr = (sr * src_scale + SkGetPackedR16(d) * dst_scale) >> 8;
+                int dg = (sg * src_scale + SkGetPackedG16(d) * dst_scale) >> 8;
+                int db = (sb * src_scale + SkGetPackedB16(d) * dst_scale) >> 8;
+
+                *dst = SkPackRGB16(dr, dg, db);
+            }
+            dst += 1;
+            DITHER_INC_X(x);
+        } while (--count != 0);
+    }
+}
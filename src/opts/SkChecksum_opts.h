@@ -0,0 +1,21 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkChecksum_opts_DEFINED
+#define SkChecksum_opts_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  Hashes size bytes (a multiple of 4) of 32-bit aligned data, for SkChecksum::HashKey().
+ *  Must return 0 for no data, and must change if any single word changes.
+ */
+typedef uint32_t (*SkChecksumHashProc)(const uint32_t* data, size_t size);
+
+SkChecksumHashProc SkChecksumGetPlatformHashProc();
+
+#endif
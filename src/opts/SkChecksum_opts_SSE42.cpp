@@ -0,0 +1,55 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <nmmintrin.h>
+#include "SkChecksum_opts_SSE42.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    typedef uint64_t Word;
+    static inline uint32_t crc32c(uint32_t crc, Word w) {
+        return (uint32_t)_mm_crc32_u64(crc, w);
+    }
+#else
+    typedef uint32_t Word;
+    static inline uint32_t crc32c(uint32_t crc, Word w) {
+        return _mm_crc32_u32(crc, w);
+    }
+#endif
+
+static inline Word load(const uint32_t* p) {
+    Word w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+// The crc32 instruction takes three cycles but can start one every cycle, so long keys go
+// through three CRCs at once, over interleaved words, which are then folded together.
+uint32_t SkChecksumHash_SSE42(const uint32_t* data, size_t size) {
+    SkASSERT(SkIsAlign4(size));
+    const size_t kWordsPerStep = 3 * sizeof(Word) / sizeof(uint32_t);
+
+    uint32_t crc = 0;
+    if (size >= 2 * kWordsPerStep * sizeof(uint32_t)) {
+        uint32_t crc0 = 0, crc1 = 0, crc2 = 0;
+        do {
+            crc0 = crc32c(crc0, load(data));
+            crc1 = crc32c(crc1, load(data + 1 * sizeof(Word) / sizeof(uint32_t)));
+            crc2 = crc32c(crc2, load(data + 2 * sizeof(Word) / sizeof(uint32_t)));
+            data += kWordsPerStep;
+            size -= kWordsPerStep * sizeof(uint32_t);
+        } while (size >= kWordsPerStep * sizeof(uint32_t));
+        crc = _mm_crc32_u32(_mm_crc32_u32(crc0, crc1), crc2);
+    }
+
+    for (; size >= sizeof(Word); size -= sizeof(Word), data += sizeof(Word) / sizeof(uint32_t)) {
+        crc = crc32c(crc, load(data));
+    }
+    if (size > 0) {
+        crc = _mm_crc32_u32(crc, *data);
+    }
+    return crc;
+}
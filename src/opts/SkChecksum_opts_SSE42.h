@@ -0,0 +1,15 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkChecksum_opts_SSE42_DEFINED
+#define SkChecksum_opts_SSE42_DEFINED
+
+#include "SkChecksum_opts.h"
+
+uint32_t SkChecksumHash_SSE42(const uint32_t* data, size_t size);
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkConfig8888_opts_DEFINED
+#define SkConfig8888_opts_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  Converts a row of count 32-bit RGBA or BGRA pixels. dst may be the same as src, but may not
+ *  overlap it otherwise. The results must match the portable rows in src/core/SkConfig8888.cpp
+ *  exactly, including SkUnPreMultiply's rounding.
+ */
+typedef void (*SkConvert8888RowProc)(uint32_t dst[], const uint32_t src[], int count);
+
+struct SkConvert8888Procs {
+    SkConvert8888RowProc fSwapRB;
+    SkConvert8888RowProc fPremul;
+    SkConvert8888RowProc fSwapRBPremul;
+    SkConvert8888RowProc fUnpremul;
+    SkConvert8888RowProc fSwapRBUnpremul;
+};
+
+/**
+ *  Fills in all the procs and returns true, or returns false if the platform has none.
+ */
+bool SkConvert8888GetPlatformProcs(SkConvert8888Procs*);
+
+#endif
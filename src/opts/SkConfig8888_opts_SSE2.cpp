@@ -0,0 +1,105 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <emmintrin.h>
+#include "SkColorPriv.h"
+#include "SkColor_opts_SSE2.h"
+#include "SkConfig8888_opts_SSE2.h"
+#include "SkUnPreMultiply.h"
+
+enum AlphaVerb {
+    kNothing_AlphaVerb,
+    kPremul_AlphaVerb,
+    kUnpremul_AlphaVerb,
+};
+
+// The SkGetPacked*32 shifts are used only to find the bytes. Alpha is in the same place in
+// RGBA and BGRA, and the other three are handled alike, so their order does not matter.
+
+static inline __m128i swizzle_rb(const __m128i& c) {
+    const __m128i rbMask = _mm_set1_epi32((0xFF << SK_R32_SHIFT) | (0xFF << SK_B32_SHIFT));
+    __m128i r = _mm_slli_epi32(SkGetPackedR32_SSE2(c), SK_B32_SHIFT);
+    __m128i b = _mm_slli_epi32(SkGetPackedB32_SSE2(c), SK_R32_SHIFT);
+    return _mm_or_si128(_mm_andnot_si128(rbMask, c), _mm_or_si128(r, b));
+}
+
+// Same as SkPreMultiplyARGB(): each channel is SkMulDiv255Round()ed with alpha.
+static inline __m128i premul(const __m128i& c) {
+    __m128i a = SkGetPackedA32_SSE2(c);
+    return SkPackARGB32_SSE2(a,
+                             SkAlphaMulAlpha_SSE2(a, SkGetPackedR32_SSE2(c)),
+                             SkAlphaMulAlpha_SSE2(a, SkGetPackedG32_SSE2(c)),
+                             SkAlphaMulAlpha_SSE2(a, SkGetPackedB32_SSE2(c)));
+}
+
+// Same as SkUnPreMultiply::ApplyScale(), which wraps at 32 bits for components larger than
+// alpha; Multiply32_SSE2() keeps the low 32 bits of the product too.
+static inline __m128i apply_scale(const __m128i& scale, const __m128i& component) {
+    __m128i prod = Multiply32_SSE2(scale, component);
+    return _mm_srli_epi32(_mm_add_epi32(prod, _mm_set1_epi32(1 << 23)), 24);
+}
+
+// Same as SkUnPreMultiply::UnPreMultiplyPreservingByteOrder(). The scales still come from
+// the table, but the multiplies are done four pixels at a time.
+static inline __m128i unpremul(const __m128i& c) {
+    __m128i a = SkGetPackedA32_SSE2(c);
+    const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+    __m128i scale = _mm_setr_epi32(table[_mm_cvtsi128_si32(a)],
+                                   table[_mm_cvtsi128_si32(_mm_srli_si128(a, 4))],
+                                   table[_mm_cvtsi128_si32(_mm_srli_si128(a, 8))],
+                                   table[_mm_cvtsi128_si32(_mm_srli_si128(a, 12))]);
+    return SkPackARGB32_SSE2(a,
+                             apply_scale(scale, SkGetPackedR32_SSE2(c)),
+                             apply_scale(scale, SkGetPackedG32_SSE2(c)),
+                             apply_scale(scale, SkGetPackedB32_SSE2(c)));
+}
+
+template <bool doSwapRB, AlphaVerb doAlpha>
+static inline __m128i convert4(__m128i c) {
+    if (doSwapRB) {
+        c = swizzle_rb(c);
+    }
+    switch (doAlpha) {
+        case kNothing_AlphaVerb:
+            break;
+        case kPremul_AlphaVerb:
+            c = premul(c);
+            break;
+        case kUnpremul_AlphaVerb:
+            c = unpremul(c);
+            break;
+    }
+    return c;
+}
+
+template <bool doSwapRB, AlphaVerb doAlpha>
+static void convert32_row_SSE2(uint32_t dst[], const uint32_t src[], int count) {
+    // Each group of four is loaded before it is stored, so src may be dst.
+    while (count >= 4) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), convert4<doSwapRB, doAlpha>(c));
+        src += 4;
+        dst += 4;
+        count -= 4;
+    }
+    // The last few go through a vector too, one at a time.
+    while (count > 0) {
+        __m128i c = _mm_cvtsi32_si128(*src);
+        *dst = _mm_cvtsi128_si32(convert4<doSwapRB, doAlpha>(c));
+        src += 1;
+        dst += 1;
+        count -= 1;
+    }
+}
+
+void SkConvert8888GetPlatformProcs_SSE2(SkConvert8888Procs* procs) {
+    procs->fSwapRB = convert32_row_SSE2<true, kNothing_AlphaVerb>;
+    procs->fPremul = convert32_row_SSE2<false, kPremul_AlphaVerb>;
+    procs->fSwapRBPremul = convert32_row_SSE2<true, kPremul_AlphaVerb>;
+    procs->fUnpremul = convert32_row_SSE2<false, kUnpremul_AlphaVerb>;
+    procs->fSwapRBUnpremul = convert32_row_SSE2<true, kUnpremul_AlphaVerb>;
+}
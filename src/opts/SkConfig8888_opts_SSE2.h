@@ -0,0 +1,15 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkConfig8888_opts_SSE2_DEFINED
+#define SkConfig8888_opts_SSE2_DEFINED
+
+#include "SkConfig8888_opts.h"
+
+void SkConvert8888GetPlatformProcs_SSE2(SkConvert8888Procs*);
+
+#endif
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkDisplacementMap_opts_DEFINED
+#define SkDisplacementMap_opts_DEFINED
+
+#include "SkColorPriv.h"
+
+/**
+ *  What the displacement procs need of SkDisplacementMapEffect, in the units of
+ *  computeDisplacement() in src/effects/SkDisplacementMapEffect.cpp.
+ */
+struct SkDisplacementParams {
+    const SkPMColor* fSrc;   // the color bitmap's pixels
+    int fSrcRowPixels;       // its rowBytes() / 4
+    int fSrcWidth;
+    int fSrcHeight;
+    SkScalar fScale[2];      // displacement in x and y per unit of channel value
+    SkScalar fAdjust[2];     // added to the displacement before it is truncated
+    int fShift[2];           // SK_*32_SHIFT of the channels that displace x and y
+    bool fUnpremul[2];       // whether those channels are unpremultiplied first
+};
+
+/**
+ *  Displaces pixels [x, x + count) of row y of the color bitmap into dst,
+ *  reading the displacement of pixel x + i from displ[i]. Pixels displaced
+ *  outside the color bitmap are transparent. A proc displaces as many of the
+ *  pixels as it can do a vector at a time, and returns how many; the caller
+ *  displaces the rest.
+ */
+typedef int (*SkDisplacementProc)(const SkDisplacementParams&, const SkPMColor* displ,
+                                  SkPMColor* dst, int x, int y, int count);
+
+SkDisplacementProc SkDisplacementGetPlatformProc();
+
+#endif
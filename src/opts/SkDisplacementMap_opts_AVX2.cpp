@@ -0,0 +1,79 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <immintrin.h>
+#include "SkDisplacementMap_opts_AVX2.h"
+#include "SkDisplacementMap_opts_SSE2.h"
+#include "SkUnPreMultiply.h"
+
+/* AVX2 version of the displacement map, eight pixels at a time. It is the SSE2
+ * version in SkDisplacementMap_opts_SSE2.cpp widened, with the unpremultiply
+ * scales and the displaced color pixels gathered rather than fetched one at a
+ * time; pixels displaced outside the color bitmap are masked out of the gather.
+ * Fewer than 8 trailing pixels are handed to the SSE2 version.
+ */
+
+namespace {
+
+// The channel at shift, unpremultiplied with scale as SkUnPreMultiply::ApplyScale() does.
+inline __m256i get_channel(__m256i pixels, __m256i scale, int shift, bool unpremul) {
+    __m256i c = _mm256_and_si256(_mm256_srl_epi32(pixels, _mm_cvtsi32_si128(shift)),
+                                 _mm256_set1_epi32(0xFF));
+    if (unpremul) {
+        c = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(scale, c),
+                                               _mm256_set1_epi32(1 << 23)), 24);
+    }
+    return c;
+}
+
+// The displacement for channel values c, truncated.
+inline __m256i displacement(__m256i c, SkScalar scale, SkScalar adjust) {
+    __m256 d = _mm256_mul_ps(_mm256_set1_ps(scale), _mm256_cvtepi32_ps(c));
+    return _mm256_cvttps_epi32(_mm256_add_ps(d, _mm256_set1_ps(adjust)));
+}
+
+}  // namespace
+
+int SkDisplace_AVX2(const SkDisplacementParams& params, const SkPMColor* displ,
+                    SkPMColor* dst, int x, int y, int count) {
+    const int* table = reinterpret_cast<const int*>(SkUnPreMultiply::GetScaleTable());
+    const int* src = reinterpret_cast<const int*>(params.fSrc);
+    const bool unpremul = params.fUnpremul[0] || params.fUnpremul[1];
+    const __m256i minusOne = _mm256_set1_epi32(-1);
+    const __m256i width = _mm256_set1_epi32(params.fSrcWidth);
+    const __m256i height = _mm256_set1_epi32(params.fSrcHeight);
+    const __m256i rowPixels = _mm256_set1_epi32(params.fSrcRowPixels);
+    const __m256i dstY = _mm256_set1_epi32(y);
+    __m256i dstX = _mm256_setr_epi32(x, x + 1, x + 2, x + 3, x + 4, x + 5, x + 6, x + 7);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(displ + i));
+        __m256i scale = _mm256_setzero_si256();
+        if (unpremul) {
+            __m256i alpha = _mm256_and_si256(_mm256_srli_epi32(pixels, SK_A32_SHIFT),
+                                             _mm256_set1_epi32(0xFF));
+            scale = _mm256_i32gather_epi32(table, alpha, 4);
+        }
+        __m256i srcX = _mm256_add_epi32(dstX, displacement(
+            get_channel(pixels, scale, params.fShift[0], params.fUnpremul[0]),
+            params.fScale[0], params.fAdjust[0]));
+        __m256i srcY = _mm256_add_epi32(dstY, displacement(
+            get_channel(pixels, scale, params.fShift[1], params.fUnpremul[1]),
+            params.fScale[1], params.fAdjust[1]));
+        __m256i inside = _mm256_and_si256(_mm256_cmpgt_epi32(srcX, minusOne),
+                                          _mm256_cmpgt_epi32(width, srcX));
+        inside = _mm256_and_si256(inside, _mm256_and_si256(_mm256_cmpgt_epi32(srcY, minusOne),
+                                                           _mm256_cmpgt_epi32(height, srcY)));
+        __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(srcY, rowPixels), srcX);
+        __m256i result = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), src, index,
+                                                     inside, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), result);
+        dstX = _mm256_add_epi32(dstX, _mm256_set1_epi32(8));
+    }
+    return i + SkDisplace_SSE2(params, displ + i, dst + i, x + i, y, count - i);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <emmintrin.h>
+#include "SkDisplacementMap_opts_SSE2.h"
+#include "SkUnPreMultiply.h"
+
+/* SSE2 version of the displacement map, four pixels at a time. The portable
+ * version is computeDisplacement() in src/effects/SkDisplacementMapEffect.cpp,
+ * whose arithmetic this follows exactly. SSE2 has no gather, so the
+ * unpremultiply scales and the displaced color pixels are fetched one at a
+ * time.
+ */
+
+namespace {
+
+// The low 32 bits of a * b in each lane, wrapping as uint32_t math does.
+inline __m128i mullo_epi32(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// The channel at shift, unpremultiplied with scale as SkUnPreMultiply::ApplyScale() does.
+inline __m128i get_channel(__m128i pixels, __m128i scale, int shift, bool unpremul) {
+    __m128i c = _mm_and_si128(_mm_srl_epi32(pixels, _mm_cvtsi32_si128(shift)),
+                              _mm_set1_epi32(0xFF));
+    if (unpremul) {
+        c = _mm_srli_epi32(_mm_add_epi32(mullo_epi32(scale, c), _mm_set1_epi32(1 << 23)), 24);
+    }
+    return c;
+}
+
+// The displacement for channel values c, truncated.
+inline __m128i displacement(__m128i c, SkScalar scale, SkScalar adjust) {
+    __m128 d = _mm_mul_ps(_mm_set1_ps(scale), _mm_cvtepi32_ps(c));
+    return _mm_cvttps_epi32(_mm_add_ps(d, _mm_set1_ps(adjust)));
+}
+
+}  // namespace
+
+int SkDisplace_SSE2(const SkDisplacementParams& params, const SkPMColor* displ,
+                    SkPMColor* dst, int x, int y, int count) {
+    const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+    const bool unpremul = params.fUnpremul[0] || params.fUnpremul[1];
+    const __m128i minusOne = _mm_set1_epi32(-1);
+    const __m128i width = _mm_set1_epi32(params.fSrcWidth);
+    const __m128i height = _mm_set1_epi32(params.fSrcHeight);
+    const __m128i dstY = _mm_set1_epi32(y);
+    __m128i dstX = _mm_setr_epi32(x, x + 1, x + 2, x + 3);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(displ + i));
+        __m128i scale = _mm_setzero_si128();
+        if (unpremul) {
+            scale = _mm_setr_epi32(table[SkGetPackedA32(displ[i])],
+                                   table[SkGetPackedA32(displ[i + 1])],
+                                   table[SkGetPackedA32(displ[i + 2])],
+                                   table[SkGetPackedA32(displ[i + 3])]);
+        }
+        __m128i srcX = _mm_add_epi32(dstX, displacement(
+            get_channel(pixels, scale, params.fShift[0], params.fUnpremul[0]),
+            params.fScale[0], params.fAdjust[0]));
+        __m128i srcY = _mm_add_epi32(dstY, displacement(
+            get_channel(pixels, scale, params.fShift[1], params.fUnpremul[1]),
+            params.fScale[1], params.fAdjust[1]));
+        __m128i inside = _mm_and_si128(_mm_cmpgt_epi32(srcX, minusOne),
+                                       _mm_cmplt_epi32(srcX, width));
+        inside = _mm_and_si128(inside, _mm_and_si128(_mm_cmpgt_epi32(srcY, minusOne),
+                                                     _mm_cmplt_epi32(srcY, height)));
+
+        int32_t xs[4], ys[4], in[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(xs), srcX);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(ys), srcY);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(in), inside);
+        for (int j = 0; j < 4; ++j) {
+            dst[i + j] = in[j] ? params.fSrc[ys[j] * params.fSrcRowPixels + xs[j]] : 0;
+        }
+        dstX = _mm_add_epi32(dstX, _mm_set1_epi32(4));
+    }
+    return i;
+}
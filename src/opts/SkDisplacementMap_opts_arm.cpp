@@ -0,0 +1,23 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDisplacementMap_opts.h"
+#include "SkDisplacementMap_opts_neon.h"
+#include "SkUtilsArm.h"
+
+SkDisplacementProc SkDisplacementGetPlatformProc() {
+#if SK_ARM_NEON_IS_NONE
+    return NULL;
+#else
+#if SK_ARM_NEON_IS_DYNAMIC
+    if (!sk_cpu_arm_has_neon()) {
+        return NULL;
+    }
+#endif
+    return SkDisplace_neon;
+#endif
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDisplacementMap_opts_neon.h"
+#include "SkUnPreMultiply.h"
+
+#include <arm_neon.h>
+
+/* neon version of the displacement map, four pixels at a time. The portable
+ * version is computeDisplacement() in src/effects/SkDisplacementMapEffect.cpp,
+ * whose arithmetic this follows. neon has no gather, so the unpremultiply
+ * scales and the displaced color pixels are fetched one at a time.
+ */
+
+namespace {
+
+// The channel at shift, unpremultiplied with scale as SkUnPreMultiply::ApplyScale() does.
+inline uint32x4_t get_channel(uint32x4_t pixels, uint32x4_t scale, int shift, bool unpremul) {
+    uint32x4_t c = vandq_u32(vshlq_u32(pixels, vdupq_n_s32(-shift)), vdupq_n_u32(0xFF));
+    if (unpremul) {
+        c = vshrq_n_u32(vaddq_u32(vmulq_u32(scale, c), vdupq_n_u32(1 << 23)), 24);
+    }
+    return c;
+}
+
+// The displacement for channel values c, truncated.
+inline int32x4_t displacement(uint32x4_t c, SkScalar scale, SkScalar adjust) {
+    float32x4_t d = vmulq_f32(vdupq_n_f32(scale), vcvtq_f32_u32(c));
+    return vcvtq_s32_f32(vaddq_f32(d, vdupq_n_f32(adjust)));
+}
+
+}  // namespace
+
+int SkDisplace_neon(const SkDisplacementParams& params, const SkPMColor* displ,
+                    SkPMColor* dst, int x, int y, int count) {
+    const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+    const bool unpremul = params.fUnpremul[0] || params.fUnpremul[1];
+    const int32x4_t zero = vdupq_n_s32(0);
+    const int32x4_t width = vdupq_n_s32(params.fSrcWidth);
+    const int32x4_t height = vdupq_n_s32(params.fSrcHeight);
+    const int32x4_t dstY = vdupq_n_s32(y);
+    const int32_t xs[4] = { x, x + 1, x + 2, x + 3 };
+    int32x4_t dstX = vld1q_s32(xs);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t pixels = vld1q_u32(displ + i);
+        uint32x4_t scale = vdupq_n_u32(0);
+        if (unpremul) {
+            const uint32_t scales[4] = { table[SkGetPackedA32(displ[i])],
+                                         table[SkGetPackedA32(displ[i + 1])],
+                                         table[SkGetPackedA32(displ[i + 2])],
+                                         table[SkGetPackedA32(displ[i + 3])] };
+            scale = vld1q_u32(scales);
+        }
+        int32x4_t srcX = vaddq_s32(dstX, displacement(
+            get_channel(pixels, scale, params.fShift[0], params.fUnpremul[0]),
+            params.fScale[0], params.fAdjust[0]));
+        int32x4_t srcY = vaddq_s32(dstY, displacement(
+            get_channel(pixels, scale, params.fShift[1], params.fUnpremul[1]),
+            params.fScale[1], params.fAdjust[1]));
+        uint32x4_t inside = vandq_u32(vcgeq_s32(srcX, zero), vcltq_s32(srcX, width));
+        inside = vandq_u32(inside, vandq_u32(vcgeq_s32(srcY, zero), vcltq_s32(srcY, height)));
+
+        int32_t sx[4], sy[4];
+        uint32_t in[4];
+        vst1q_s32(sx, srcX);
+        vst1q_s32(sy, srcY);
+        vst1q_u32(in, inside);
+        for (int j = 0; j < 4; ++j) {
+            dst[i + j] = in[j] ? params.fSrc[sy[j] * params.fSrcRowPixels + sx[j]] : 0;
+        }
+        dstX = vaddq_s32(dstX, vdupq_n_s32(4));
+    }
+    return i;
+}
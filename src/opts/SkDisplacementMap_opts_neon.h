@@ -0,0 +1,16 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkDisplacementMap_opts_neon_DEFINED
+#define SkDisplacementMap_opts_neon_DEFINED
+
+#include "SkDisplacementMap_opts.h"
+
+int SkDisplace_neon(const SkDisplacementParams&, const SkPMColor* displ,
+                    SkPMColor* dst, int x, int y, int count);
+
+#endif
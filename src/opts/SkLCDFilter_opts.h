@@ -0,0 +1,27 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkLCDFilter_opts_DEFINED
+#define SkLCDFilter_opts_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  See SkLCDFilter::FilterRow(). coefficients holds the 12 taps of the red,
+ *  green and blue filters, in that order.
+ */
+typedef void (*SkLCDFilterRowProc)(const uint8_t padded[], int pixelCount,
+                                   const uint8_t coefficients[3][12],
+                                   uint8_t r[], uint8_t g[], uint8_t b[]);
+
+/** See SkLCDFilter::PackRow(). */
+typedef void (*SkLCDPackRowProc)(const uint8_t r[], const uint8_t g[], const uint8_t b[],
+                                 uint16_t dst[], int count);
+
+bool SkLCDFilterGetPlatformProcs(SkLCDFilterRowProc* filterRow, SkLCDPackRowProc* packRow);
+
+#endif
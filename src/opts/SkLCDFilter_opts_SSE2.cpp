@@ -0,0 +1,88 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <emmintrin.h>
+#include "SkColorPriv.h"
+#include "SkLCDFilter_opts_SSE2.h"
+
+/* SSE2 versions of the LCD filter and packing row procs. The portable
+ * versions are in src/core/SkLCDFilter.cpp, and these give the same results.
+ */
+
+static inline __m128i load_coefficients(const uint8_t coefficients[12], int start) {
+    int16_t c[8];
+    for (int i = 0; i < 8; ++i) {
+        c[i] = start + i < 12 ? coefficients[start + i] : 0;
+    }
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(c));
+}
+
+static void SkLCDFilterRow_SSE2(const uint8_t padded[], int pixelCount,
+                                const uint8_t coefficients[3][12],
+                                uint8_t r[], uint8_t g[], uint8_t b[]) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rLo = load_coefficients(coefficients[0], 0);
+    const __m128i rHi = load_coefficients(coefficients[0], 8);
+    const __m128i gLo = load_coefficients(coefficients[1], 0);
+    const __m128i gHi = load_coefficients(coefficients[1], 8);
+    const __m128i bLo = load_coefficients(coefficients[2], 0);
+    const __m128i bHi = load_coefficients(coefficients[2], 8);
+
+    for (int i = 0; i < pixelCount; ++i) {
+        // The 12 samples under pixel i, and 4 more that have zero weight.
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(padded + 4 * i));
+        __m128i lo = _mm_unpacklo_epi8(samples, zero);
+        __m128i hi = _mm_unpackhi_epi8(samples, zero);
+
+        // Four partial sums per channel.
+        __m128i sumR = _mm_add_epi32(_mm_madd_epi16(lo, rLo), _mm_madd_epi16(hi, rHi));
+        __m128i sumG = _mm_add_epi32(_mm_madd_epi16(lo, gLo), _mm_madd_epi16(hi, gHi));
+        __m128i sumB = _mm_add_epi32(_mm_madd_epi16(lo, bLo), _mm_madd_epi16(hi, bHi));
+
+        // Transpose and add, to get r, g, b, 0.
+        __m128i rg = _mm_add_epi32(_mm_unpacklo_epi32(sumR, sumG),
+                                   _mm_unpackhi_epi32(sumR, sumG));
+        __m128i b0 = _mm_add_epi32(_mm_unpacklo_epi32(sumB, zero),
+                                   _mm_unpackhi_epi32(sumB, zero));
+        __m128i rgb = _mm_add_epi32(_mm_unpacklo_epi64(rg, b0), _mm_unpackhi_epi64(rg, b0));
+
+        // The sums are less than 2 * 255 * 256, so fit in 16 bits after the shift,
+        // and the unsigned pack clamps them to 255.
+        rgb = _mm_srli_epi32(rgb, 8);
+        rgb = _mm_packs_epi32(rgb, rgb);
+        rgb = _mm_packus_epi16(rgb, rgb);
+        uint32_t packed = _mm_cvtsi128_si32(rgb);
+        r[i] = packed & 0xFF;
+        g[i] = (packed >> 8) & 0xFF;
+        b[i] = (packed >> 16) & 0xFF;
+    }
+}
+
+static void SkLCDPackRow_SSE2(const uint8_t r[], const uint8_t g[], const uint8_t b[],
+                              uint16_t dst[], int count) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i r16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r + i)), zero);
+        __m128i g16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(g + i)), zero);
+        __m128i b16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(b + i)), zero);
+        r16 = _mm_slli_epi16(_mm_srli_epi16(r16, 8 - SK_R16_BITS), SK_R16_SHIFT);
+        g16 = _mm_slli_epi16(_mm_srli_epi16(g16, 8 - SK_G16_BITS), SK_G16_SHIFT);
+        b16 = _mm_slli_epi16(_mm_srli_epi16(b16, 8 - SK_B16_BITS), SK_B16_SHIFT);
+        __m128i rgb = _mm_or_si128(_mm_or_si128(r16, g16), b16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), rgb);
+    }
+    for (; i < count; ++i) {
+        dst[i] = SkPack888ToRGB16(r[i], g[i], b[i]);
+    }
+}
+
+bool SkLCDFilterGetPlatformProcs_SSE2(SkLCDFilterRowProc* filterRow, SkLCDPackRowProc* packRow) {
+    *filterRow = SkLCDFilterRow_SSE2;
+    *packRow = SkLCDPackRow_SSE2;
+    return true;
+}
@@ -0,0 +1,15 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkLCDFilter_opts_SSE2_DEFINED
+#define SkLCDFilter_opts_SSE2_DEFINED
+
+#include "SkLCDFilter_opts.h"
+
+bool SkLCDFilterGetPlatformProcs_SSE2(SkLCDFilterRowProc* filterRow, SkLCDPackRowProc* packRow);
+
+#endif
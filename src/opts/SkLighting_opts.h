@@ -0,0 +1,44 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkLighting_opts_DEFINED
+#define SkLighting_opts_DEFINED
+
+#include "SkColorPriv.h"
+
+enum SkLightingProcType {
+    kDiffuseDistant_SkLightingProcType,
+    kDiffusePoint_SkLightingProcType,
+    kSpecularDistant_SkLightingProcType,
+    kSpecularPoint_SkLightingProcType
+};
+
+/**
+ *  What the lighting procs need of SkLightingImageFilter and its light, in the
+ *  units of src/effects/SkLightingImageFilter.cpp.
+ */
+struct SkLightingParams {
+    SkScalar fSurfaceScale;  // per unit of alpha
+    SkScalar fLight[3];      // direction to a distant light, or a point light's location
+    SkScalar fColor[3];      // the light's color, 0..255
+    SkScalar fK;             // kd for diffuse, ks for specular
+    SkScalar fShininess;     // specular only
+};
+
+/**
+ *  Lights pixels [x, x + count) of row y, which must not be the first or last
+ *  row or column of the source. rows[] point at pixel x in the rows above, at,
+ *  and below y; the normals are read from alpha in rows[i][-1]..rows[i][count].
+ *  A proc lights as many of the pixels as it can do a vector at a time, and
+ *  returns how many; the caller lights the rest.
+ */
+typedef int (*SkLightingProc)(const SkLightingParams&, const SkPMColor* const rows[3],
+                              SkPMColor* dst, int x, int y, int count);
+
+SkLightingProc SkLightingGetPlatformProc(SkLightingProcType type);
+
+#endif
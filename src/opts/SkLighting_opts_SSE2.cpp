@@ -0,0 +1,189 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <emmintrin.h>
+#include "SkLighting_opts_SSE2.h"
+
+/* SSE2 version of diffuse and specular lighting from distant and point lights,
+ * four pixels at a time. The portable version is lightBitmap() in
+ * src/effects/SkLightingImageFilter.cpp, whose arithmetic this follows step for
+ * step, except that specular lighting raises to the shininess with fast_pow().
+ */
+
+namespace {
+
+// The alpha of the four pixels from p, as floats.
+inline __m128 load_alpha(const SkPMColor* p) {
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    c = _mm_and_si128(_mm_srli_epi32(c, SK_A32_SHIFT), _mm_set1_epi32(0xFF));
+    return _mm_cvtepi32_ps(c);
+}
+
+inline __m128 dot(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+// Scales (x, y, z) as SkPoint3::normalize() does.
+inline void normalize(__m128* x, __m128* y, __m128* z) {
+    __m128 length = _mm_sqrt_ps(dot(*x, *y, *z, *x, *y, *z));
+    __m128 scale = _mm_div_ps(_mm_set1_ps(SK_Scalar1),
+                              _mm_add_ps(length, _mm_set1_ps(SK_ScalarNearlyZero)));
+    *x = _mm_mul_ps(*x, scale);
+    *y = _mm_mul_ps(*y, scale);
+    *z = _mm_mul_ps(*z, scale);
+}
+
+// log2(x) for x >= 0: the exponent, plus a minimax polynomial for the log2 of
+// the mantissa m in [1, 2) that is exact at m = 1.
+inline __m128 fast_log2(__m128 x) {
+    __m128i bits = _mm_castps_si128(x);
+    __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)),
+                                             _mm_set1_epi32(0x3F800000)));
+    __m128 p = _mm_set1_ps(0.0596515482674574969533f);
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(-0.465725644288844778798f));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(1.48116647521213171641f));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(-2.52074962577807006663f));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(2.8882704548164776201f));
+    return _mm_add_ps(_mm_mul_ps(p, _mm_sub_ps(m, _mm_set1_ps(SK_Scalar1))), e);
+}
+
+// 2^x: two to the integer part, by building its float, times a minimax
+// polynomial for two to the fraction in [0, 1).
+inline __m128 fast_exp2(__m128 x) {
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+    // Rounding x - 1/2 to nearest is floor(x), or x - 1 when x is whole.
+    __m128i i = _mm_cvtps_epi32(_mm_sub_ps(x, _mm_set1_ps(0.5f)));
+    __m128 f = _mm_sub_ps(x, _mm_cvtepi32_ps(i));
+    __m128 pow2i = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(i, _mm_set1_epi32(127)), 23));
+    __m128 p = _mm_set1_ps(1.8775767e-3f);
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(8.9893397e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(5.5826318e-2f));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(2.4015361e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(6.9315308e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(9.9999994e-1f));
+    return _mm_mul_ps(p, pow2i);
+}
+
+// x^y, to about 1e-5 relative for the exponents lighting uses. Negative x
+// counts as 0.
+inline __m128 fast_pow(__m128 x, __m128 y) {
+    return fast_exp2(_mm_mul_ps(y, fast_log2(_mm_max_ps(x, _mm_setzero_ps()))));
+}
+
+// SkClampMax(SkScalarRoundToInt(c), 255).
+inline __m128i round_to_byte(__m128 c) {
+    c = _mm_add_ps(c, _mm_set1_ps(0.5f));
+    c = _mm_min_ps(_mm_max_ps(c, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+    return _mm_cvttps_epi32(c);
+}
+
+template <bool specular, bool pointLight>
+int light_SSE2(const SkLightingParams& params, const SkPMColor* const rows[3],
+               SkPMColor* dst, int x, int y, int count) {
+    const __m128 surfaceScale = _mm_set1_ps(params.fSurfaceScale);
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    const __m128 one = _mm_set1_ps(SK_Scalar1);
+    const __m128 k = _mm_set1_ps(params.fK);
+    const __m128 shininess = _mm_set1_ps(params.fShininess);
+    const __m128 colorR = _mm_set1_ps(params.fColor[0]);
+    const __m128 colorG = _mm_set1_ps(params.fColor[1]);
+    const __m128 colorB = _mm_set1_ps(params.fColor[2]);
+
+    // A distant light's direction, and the half vector to the eye at (0, 0, 1),
+    // are the same for every pixel.
+    __m128 lx = _mm_set1_ps(params.fLight[0]);
+    __m128 ly = _mm_set1_ps(params.fLight[1]);
+    __m128 lz = _mm_set1_ps(params.fLight[2]);
+    __m128 hx = lx, hy = ly, hz = _mm_add_ps(lz, one);
+    if (specular && !pointLight) {
+        normalize(&hx, &hy, &hz);
+    }
+    const __m128 lightY = _mm_sub_ps(ly, _mm_set1_ps(SkIntToScalar(y)));
+    __m128 lightX = _mm_sub_ps(lx, _mm_setr_ps(SkIntToScalar(x), SkIntToScalar(x + 1),
+                                               SkIntToScalar(x + 2), SkIntToScalar(x + 3)));
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // The 3x3 neighbourhoods of the four pixels, numbered as in interiorNormal().
+        __m128 m0 = load_alpha(rows[0] + i - 1);
+        __m128 m1 = load_alpha(rows[0] + i);
+        __m128 m2 = load_alpha(rows[0] + i + 1);
+        __m128 m3 = load_alpha(rows[1] + i - 1);
+        __m128 m4 = load_alpha(rows[1] + i);
+        __m128 m5 = load_alpha(rows[1] + i + 1);
+        __m128 m6 = load_alpha(rows[2] + i - 1);
+        __m128 m7 = load_alpha(rows[2] + i);
+        __m128 m8 = load_alpha(rows[2] + i + 1);
+
+        // -sobel(...) * surfaceScale for x and y, then the unit normal.
+        __m128 sx = _mm_add_ps(_mm_sub_ps(m5, m3), _mm_sub_ps(m5, m3));
+        sx = _mm_add_ps(_mm_add_ps(sx, _mm_sub_ps(m2, m0)), _mm_sub_ps(m8, m6));
+        __m128 sy = _mm_add_ps(_mm_sub_ps(m7, m1), _mm_sub_ps(m7, m1));
+        sy = _mm_add_ps(_mm_add_ps(sy, _mm_sub_ps(m6, m0)), _mm_sub_ps(m8, m2));
+        __m128 nx = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(sx, quarter)), surfaceScale);
+        __m128 ny = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(sy, quarter)), surfaceScale);
+        __m128 nz = one;
+        normalize(&nx, &ny, &nz);
+
+        if (pointLight) {
+            lx = lightX;
+            ly = lightY;
+            lz = _mm_sub_ps(_mm_set1_ps(params.fLight[2]), _mm_mul_ps(m4, surfaceScale));
+            normalize(&lx, &ly, &lz);
+            lightX = _mm_sub_ps(lightX, _mm_set1_ps(SkIntToScalar(4)));
+            if (specular) {
+                hx = lx;
+                hy = ly;
+                hz = _mm_add_ps(lz, one);
+                normalize(&hx, &hy, &hz);
+            }
+        }
+
+        __m128 scale;
+        if (specular) {
+            scale = _mm_mul_ps(k, fast_pow(dot(nx, ny, nz, hx, hy, hz), shininess));
+        } else {
+            scale = _mm_mul_ps(k, dot(nx, ny, nz, lx, ly, lz));
+        }
+        scale = _mm_min_ps(scale, one);
+
+        __m128 r = _mm_mul_ps(colorR, scale);
+        __m128 g = _mm_mul_ps(colorG, scale);
+        __m128 b = _mm_mul_ps(colorB, scale);
+        __m128i a = specular ? round_to_byte(_mm_max_ps(_mm_max_ps(r, g), b))
+                             : _mm_set1_epi32(0xFF);
+        __m128i c = _mm_slli_epi32(a, SK_A32_SHIFT);
+        c = _mm_or_si128(c, _mm_slli_epi32(round_to_byte(r), SK_R32_SHIFT));
+        c = _mm_or_si128(c, _mm_slli_epi32(round_to_byte(g), SK_G32_SHIFT));
+        c = _mm_or_si128(c, _mm_slli_epi32(round_to_byte(b), SK_B32_SHIFT));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), c);
+    }
+    return i;
+}
+
+}  // namespace
+
+int SkDiffuseDistant_SSE2(const SkLightingParams& params, const SkPMColor* const rows[3],
+                          SkPMColor* dst, int x, int y, int count) {
+    return light_SSE2<false, false>(params, rows, dst, x, y, count);
+}
+
+int SkDiffusePoint_SSE2(const SkLightingParams& params, const SkPMColor* const rows[3],
+                        SkPMColor* dst, int x, int y, int count) {
+    return light_SSE2<false, true>(params, rows, dst, x, y, count);
+}
+
+int SkSpecularDistant_SSE2(const SkLightingParams& params, const SkPMColor* const rows[3],
+                           SkPMColor* dst, int x, int y, int count) {
+    return light_SSE2<true, false>(params, rows, dst, x, y, count);
+}
+
+int SkSpecularPoint_SSE2(const SkLightingParams& params, const SkPMColor* const rows[3],
+                         SkPMColor* dst, int x, int y, int count) {
+    return light_SSE2<true, true>(params, rows, dst, x, y, count);
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkLighting_opts.h"
+#include "SkLighting_opts_neon.h"
+#include "SkUtilsArm.h"
+
+SkLightingProc SkLightingGetPlatformProc(SkLightingProcType type) {
+#if SK_ARM_NEON_IS_NONE
+    return NULL;
+#else
+#if SK_ARM_NEON_IS_DYNAMIC
+    if (!sk_cpu_arm_has_neon()) {
+        return NULL;
+    }
+#endif
+    switch (type) {
+        case kDiffuseDistant_SkLightingProcType:
+            return SkDiffuseDistant_neon;
+        case kDiffusePoint_SkLightingProcType:
+            return SkDiffusePoint_neon;
+        case kSpecularDistant_SkLightingProcType:
+            return SkSpecularDistant_neon;
+        case kSpecularPoint_SkLightingProcType:
+            return SkSpecularPoint_neon;
+        default:
+            return NULL;
+    }
+#endif
+}
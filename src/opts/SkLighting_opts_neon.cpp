@@ -0,0 +1,204 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkLighting_opts_neon.h"
+
+#include <arm_neon.h>
+
+/* neon version of diffuse and specular lighting from distant and point lights,
+ * four pixels at a time. The portable version is lightBitmap() in
+ * src/effects/SkLightingImageFilter.cpp. neon has no divide or square root, so
+ * normals and light vectors are scaled by estimates refined with two Newton
+ * steps, and specular lighting raises to the shininess with fast_pow().
+ */
+
+namespace {
+
+// The alpha of the four pixels from p, as floats.
+inline float32x4_t load_alpha(const SkPMColor* p) {
+    uint32x4_t c = vshlq_u32(vld1q_u32(p), vdupq_n_s32(-SK_A32_SHIFT));
+    return vcvtq_f32_u32(vandq_u32(c, vdupq_n_u32(0xFF)));
+}
+
+inline float32x4_t dot(float32x4_t ax, float32x4_t ay, float32x4_t az,
+                       float32x4_t bx, float32x4_t by, float32x4_t bz) {
+    return vaddq_f32(vaddq_f32(vmulq_f32(ax, bx), vmulq_f32(ay, by)), vmulq_f32(az, bz));
+}
+
+// Scales (x, y, z) as SkPoint3::normalize() does.
+inline void normalize(float32x4_t* x, float32x4_t* y, float32x4_t* z) {
+    float32x4_t lengthSq = dot(*x, *y, *z, *x, *y, *z);
+    // Keep a zero vector's length 0 rather than 0 * infinity.
+    float32x4_t d = vmaxq_f32(lengthSq, vdupq_n_f32(SK_ScalarNearlyZero * SK_ScalarNearlyZero));
+    float32x4_t rsqrt = vrsqrteq_f32(d);
+    rsqrt = vmulq_f32(rsqrt, vrsqrtsq_f32(vmulq_f32(d, rsqrt), rsqrt));
+    rsqrt = vmulq_f32(rsqrt, vrsqrtsq_f32(vmulq_f32(d, rsqrt), rsqrt));
+    float32x4_t v = vaddq_f32(vmulq_f32(lengthSq, rsqrt), vdupq_n_f32(SK_ScalarNearlyZero));
+    float32x4_t scale = vrecpeq_f32(v);
+    scale = vmulq_f32(scale, vrecpsq_f32(v, scale));
+    scale = vmulq_f32(scale, vrecpsq_f32(v, scale));
+    *x = vmulq_f32(*x, scale);
+    *y = vmulq_f32(*y, scale);
+    *z = vmulq_f32(*z, scale);
+}
+
+// log2(x) for x >= 0: the exponent, plus a minimax polynomial for the log2 of
+// the mantissa m in [1, 2) that is exact at m = 1.
+inline float32x4_t fast_log2(float32x4_t x) {
+    uint32x4_t bits = vreinterpretq_u32_f32(x);
+    int32x4_t exponent = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)),
+                                   vdupq_n_s32(127));
+    float32x4_t e = vcvtq_f32_s32(exponent);
+    float32x4_t m = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007FFFFF)),
+                                                    vdupq_n_u32(0x3F800000)));
+    float32x4_t p = vdupq_n_f32(0.0596515482674574969533f);
+    p = vaddq_f32(vmulq_f32(p, m), vdupq_n_f32(-0.465725644288844778798f));
+    p = vaddq_f32(vmulq_f32(p, m), vdupq_n_f32(1.48116647521213171641f));
+    p = vaddq_f32(vmulq_f32(p, m), vdupq_n_f32(-2.52074962577807006663f));
+    p = vaddq_f32(vmulq_f32(p, m), vdupq_n_f32(2.8882704548164776201f));
+    return vaddq_f32(vmulq_f32(p, vsubq_f32(m, vdupq_n_f32(SK_Scalar1))), e);
+}
+
+// 2^x: two to the integer part, by building its float, times a minimax
+// polynomial for two to the fraction in [0, 1).
+inline float32x4_t fast_exp2(float32x4_t x) {
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-126.0f)), vdupq_n_f32(127.0f));
+    // Conversion truncates; step down where that rounded up to get floor(x).
+    int32x4_t i = vcvtq_s32_f32(x);
+    uint32x4_t roundedUp = vcgtq_f32(vcvtq_f32_s32(i), x);
+    i = vaddq_s32(i, vreinterpretq_s32_u32(roundedUp));
+    float32x4_t f = vsubq_f32(x, vcvtq_f32_s32(i));
+    float32x4_t pow2i = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(i, vdupq_n_s32(127)), 23));
+    float32x4_t p = vdupq_n_f32(1.8775767e-3f);
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(8.9893397e-3f));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(5.5826318e-2f));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(2.4015361e-1f));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(6.9315308e-1f));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(9.9999994e-1f));
+    return vmulq_f32(p, pow2i);
+}
+
+// x^y, to about 1e-5 relative for the exponents lighting uses. Negative x
+// counts as 0.
+inline float32x4_t fast_pow(float32x4_t x, float32x4_t y) {
+    return fast_exp2(vmulq_f32(y, fast_log2(vmaxq_f32(x, vdupq_n_f32(0)))));
+}
+
+// SkClampMax(SkScalarRoundToInt(c), 255).
+inline uint32x4_t round_to_byte(float32x4_t c) {
+    c = vaddq_f32(c, vdupq_n_f32(0.5f));
+    c = vminq_f32(vmaxq_f32(c, vdupq_n_f32(0)), vdupq_n_f32(255.0f));
+    return vcvtq_u32_f32(c);
+}
+
+template <bool specular, bool pointLight>
+int light_neon(const SkLightingParams& params, const SkPMColor* const rows[3],
+               SkPMColor* dst, int x, int y, int count) {
+    const float32x4_t surfaceScale = vdupq_n_f32(params.fSurfaceScale);
+    const float32x4_t quarter = vdupq_n_f32(0.25f);
+    const float32x4_t zero = vdupq_n_f32(0);
+    const float32x4_t one = vdupq_n_f32(SK_Scalar1);
+    const float32x4_t k = vdupq_n_f32(params.fK);
+    const float32x4_t shininess = vdupq_n_f32(params.fShininess);
+    const float32x4_t colorR = vdupq_n_f32(params.fColor[0]);
+    const float32x4_t colorG = vdupq_n_f32(params.fColor[1]);
+    const float32x4_t colorB = vdupq_n_f32(params.fColor[2]);
+
+    // A distant light's direction, and the half vector to the eye at (0, 0, 1),
+    // are the same for every pixel.
+    float32x4_t lx = vdupq_n_f32(params.fLight[0]);
+    float32x4_t ly = vdupq_n_f32(params.fLight[1]);
+    float32x4_t lz = vdupq_n_f32(params.fLight[2]);
+    float32x4_t hx = lx, hy = ly, hz = vaddq_f32(lz, one);
+    if (specular && !pointLight) {
+        normalize(&hx, &hy, &hz);
+    }
+    const float32x4_t lightY = vsubq_f32(ly, vdupq_n_f32(SkIntToScalar(y)));
+    const float xs[4] = { SkIntToScalar(x), SkIntToScalar(x + 1),
+                          SkIntToScalar(x + 2), SkIntToScalar(x + 3) };
+    float32x4_t lightX = vsubq_f32(lx, vld1q_f32(xs));
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // The 3x3 neighbourhoods of the four pixels, numbered as in interiorNormal().
+        float32x4_t m0 = load_alpha(rows[0] + i - 1);
+        float32x4_t m1 = load_alpha(rows[0] + i);
+        float32x4_t m2 = load_alpha(rows[0] + i + 1);
+        float32x4_t m3 = load_alpha(rows[1] + i - 1);
+        float32x4_t m4 = load_alpha(rows[1] + i);
+        float32x4_t m5 = load_alpha(rows[1] + i + 1);
+        float32x4_t m6 = load_alpha(rows[2] + i - 1);
+        float32x4_t m7 = load_alpha(rows[2] + i);
+        float32x4_t m8 = load_alpha(rows[2] + i + 1);
+
+        // -sobel(...) * surfaceScale for x and y, then the unit normal.
+        float32x4_t sx = vaddq_f32(vsubq_f32(m5, m3), vsubq_f32(m5, m3));
+        sx = vaddq_f32(vaddq_f32(sx, vsubq_f32(m2, m0)), vsubq_f32(m8, m6));
+        float32x4_t sy = vaddq_f32(vsubq_f32(m7, m1), vsubq_f32(m7, m1));
+        sy = vaddq_f32(vaddq_f32(sy, vsubq_f32(m6, m0)), vsubq_f32(m8, m2));
+        float32x4_t nx = vmulq_f32(vsubq_f32(zero, vmulq_f32(sx, quarter)), surfaceScale);
+        float32x4_t ny = vmulq_f32(vsubq_f32(zero, vmulq_f32(sy, quarter)), surfaceScale);
+        float32x4_t nz = one;
+        normalize(&nx, &ny, &nz);
+
+        if (pointLight) {
+            lx = lightX;
+            ly = lightY;
+            lz = vsubq_f32(vdupq_n_f32(params.fLight[2]), vmulq_f32(m4, surfaceScale));
+            normalize(&lx, &ly, &lz);
+            lightX = vsubq_f32(lightX, vdupq_n_f32(SkIntToScalar(4)));
+            if (specular) {
+                hx = lx;
+                hy = ly;
+                hz = vaddq_f32(lz, one);
+                normalize(&hx, &hy, &hz);
+            }
+        }
+
+        float32x4_t scale;
+        if (specular) {
+            scale = vmulq_f32(k, fast_pow(dot(nx, ny, nz, hx, hy, hz), shininess));
+        } else {
+            scale = vmulq_f32(k, dot(nx, ny, nz, lx, ly, lz));
+        }
+        scale = vminq_f32(scale, one);
+
+        float32x4_t r = vmulq_f32(colorR, scale);
+        float32x4_t g = vmulq_f32(colorG, scale);
+        float32x4_t b = vmulq_f32(colorB, scale);
+        uint32x4_t a = specular ? round_to_byte(vmaxq_f32(vmaxq_f32(r, g), b))
+                                : vdupq_n_u32(0xFF);
+        uint32x4_t c = vshlq_n_u32(a, SK_A32_SHIFT);
+        c = vorrq_u32(c, vshlq_n_u32(round_to_byte(r), SK_R32_SHIFT));
+        c = vorrq_u32(c, vshlq_n_u32(round_to_byte(g), SK_G32_SHIFT));
+        c = vorrq_u32(c, vshlq_n_u32(round_to_byte(b), SK_B32_SHIFT));
+        vst1q_u32(dst + i, c);
+    }
+    return i;
+}
+
+}  // namespace
+
+int SkDiffuseDistant_neon(const SkLightingParams& params, const SkPMColor* const rows[3],
+                          SkPMColor* dst, int x, int y, int count) {
+    return light_neon<false, false>(params, rows, dst, x, y, count);
+}
+
+int SkDiffusePoint_neon(const SkLightingParams& params, const SkPMColor* const rows[3],
+                        SkPMColor* dst, int x, int y, int count) {
+    return light_neon<false, true>(params, rows, dst, x, y, count);
+}
+
+int SkSpecularDistant_neon(const SkLightingParams& params, const SkPMColor* const rows[3],
+                           SkPMColor* dst, int x, int y, int count) {
+    return light_neon<true, false>(params, rows, dst, x, y, count);
+}
+
+int SkSpecularPoint_neon(const SkLightingParams& params, const SkPMColor* const rows[3],
+                         SkPMColor* dst, int x, int y, int count) {
+    return light_neon<true, true>(params, rows, dst, x, y, count);
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkLighting_opts_neon_DEFINED
+#define SkLighting_opts_neon_DEFINED
+
+#include "SkLighting_opts.h"
+
+int SkDiffuseDistant_neon(const SkLightingParams&, const SkPMColor* const rows[3],
+                          SkPMColor* dst, int x, int y, int count);
+int SkDiffusePoint_neon(const SkLightingParams&, const SkPMColor* const rows[3],
+                        SkPMColor* dst, int x, int y, int count);
+int SkSpecularDistant_neon(const SkLightingParams&, const SkPMColor* const rows[3],
+                           SkPMColor* dst, int x, int y, int count);
+int SkSpecularPoint_neon(const SkLightingParams&, const SkPMColor* const rows[3],
+                         SkPMColor* dst, int x, int y, int count);
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMatrixConvolution_opts_DEFINED
+#define SkMatrixConvolution_opts_DEFINED
+
+#include "SkColorPriv.h"
+
+/**
+ *  For each of count pixels i, sets sums[4 * i + c] to the sum over the
+ *  kernelWidth x kernelHeight kernel of each weight times byte c of the pixel
+ *  under it, with the kernel's top left at src[i]. Rows of src are srcStride
+ *  pixels apart. The sums are accumulated in kernel order, a row at a time.
+ */
+typedef void (*SkConvolvePixelsProc)(const SkPMColor* src, int srcStride,
+                                     const SkScalar* kernel, int kernelWidth, int kernelHeight,
+                                     SkScalar* sums, int count);
+
+/**
+ *  Sets dst[i] to the sum over j < rowCount of weights[j] * rows[j][i], for
+ *  count scalars, count being a multiple of 4.
+ */
+typedef void (*SkSumRowsProc)(const SkScalar* const rows[], const SkScalar* weights,
+                              int rowCount, SkScalar* dst, int count);
+
+bool SkMatrixConvolutionGetPlatformProcs(SkConvolvePixelsProc* convolvePixels,
+                                         SkSumRowsProc* sumRows);
+
+#endif
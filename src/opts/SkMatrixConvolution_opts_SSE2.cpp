@@ -0,0 +1,54 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <emmintrin.h>
+#include "SkMatrixConvolution_opts_SSE2.h"
+
+/* SSE2 version of convolvePixels and sumRows, with the four channels of a
+ * pixel in one register. The portable versions are in
+ * src/effects/SkMatrixConvolutionImageFilter.cpp, and these add in the same
+ * order, so give the same sums.
+ */
+
+static void SkConvolvePixels_SSE2(const SkPMColor* src, int srcStride,
+                                  const SkScalar* kernel, int kernelWidth, int kernelHeight,
+                                  SkScalar* sums, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    for (int i = 0; i < count; ++i) {
+        __m128 sum = _mm_setzero_ps();
+        const SkPMColor* row = src + i;
+        const SkScalar* k = kernel;
+        for (int cy = 0; cy < kernelHeight; ++cy) {
+            for (int cx = 0; cx < kernelWidth; ++cx) {
+                __m128i c = _mm_cvtsi32_si128(row[cx]);
+                c = _mm_unpacklo_epi16(_mm_unpacklo_epi8(c, zero), zero);
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(c), _mm_set1_ps(*k++)));
+            }
+            row += srcStride;
+        }
+        _mm_storeu_ps(sums + 4 * i, sum);
+    }
+}
+
+static void SkSumRows_SSE2(const SkScalar* const rows[], const SkScalar* weights,
+                           int rowCount, SkScalar* dst, int count) {
+    SkASSERT(SkIsAlign4(count));
+    for (int i = 0; i < count; i += 4) {
+        __m128 sum = _mm_setzero_ps();
+        for (int j = 0; j < rowCount; ++j) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[j] + i), _mm_set1_ps(weights[j])));
+        }
+        _mm_storeu_ps(dst + i, sum);
+    }
+}
+
+bool SkMatrixConvolutionGetPlatformProcs_SSE2(SkConvolvePixelsProc* convolvePixels,
+                                              SkSumRowsProc* sumRows) {
+    *convolvePixels = SkConvolvePixels_SSE2;
+    *sumRows = SkSumRows_SSE2;
+    return true;
+}
@@ -0,0 +1,24 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMatrixConvolution_opts.h"
+#include "SkMatrixConvolution_opts_neon.h"
+#include "SkUtilsArm.h"
+
+bool SkMatrixConvolutionGetPlatformProcs(SkConvolvePixelsProc* convolvePixels,
+                                         SkSumRowsProc* sumRows) {
+#if SK_ARM_NEON_IS_NONE
+    return false;
+#else
+#if SK_ARM_NEON_IS_DYNAMIC
+    if (!sk_cpu_arm_has_neon()) {
+        return false;
+    }
+#endif
+    return SkMatrixConvolutionGetPlatformProcs_NEON(convolvePixels, sumRows);
+#endif
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMatrixConvolution_opts_neon.h"
+
+#include <arm_neon.h>
+
+/* neon version of convolvePixels and sumRows, with the four channels of a
+ * pixel in one register. The portable versions are in
+ * src/effects/SkMatrixConvolutionImageFilter.cpp, and these add in the same
+ * order, so give the same sums.
+ */
+
+static void SkConvolvePixels_neon(const SkPMColor* src, int srcStride,
+                                  const SkScalar* kernel, int kernelWidth, int kernelHeight,
+                                  SkScalar* sums, int count) {
+    for (int i = 0; i < count; ++i) {
+        float32x4_t sum = vdupq_n_f32(0);
+        const SkPMColor* row = src + i;
+        const SkScalar* k = kernel;
+        for (int cy = 0; cy < kernelHeight; ++cy) {
+            for (int cx = 0; cx < kernelWidth; ++cx) {
+                uint16x8_t c16 = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(row[cx])));
+                float32x4_t c = vcvtq_f32_u32(vmovl_u16(vget_low_u16(c16)));
+                sum = vaddq_f32(sum, vmulq_f32(c, vdupq_n_f32(*k++)));
+            }
+            row += srcStride;
+        }
+        vst1q_f32(sums + 4 * i, sum);
+    }
+}
+
+static void SkSumRows_neon(const SkScalar* const rows[], const SkScalar* weights,
+                           int rowCount, SkScalar* dst, int count) {
+    SkASSERT(SkIsAlign4(count));
+    for (int i = 0; i < count; i += 4) {
+        float32x4_t sum = vdupq_n_f32(0);
+        for (int j = 0; j < rowCount; ++j) {
+            sum = vaddq_f32(sum, vmulq_f32(vld1q_f32(rows[j] + i), vdupq_n_f32(weights[j])));
+        }
+        vst1q_f32(dst + i, sum);
+    }
+}
+
+bool SkMatrixConvolutionGetPlatformProcs_NEON(SkConvolvePixelsProc* convolvePixels,
+                                              SkSumRowsProc* sumRows) {
+    *convolvePixels = SkConvolvePixels_neon;
+    *sumRows = SkSumRows_neon;
+    return true;
+}
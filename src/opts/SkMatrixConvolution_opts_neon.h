@@ -0,0 +1,16 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMatrixConvolution_opts_neon_DEFINED
+#define SkMatrixConvolution_opts_neon_DEFINED
+
+#include "SkMatrixConvolution_opts.h"
+
+bool SkMatrixConvolutionGetPlatformProcs_NEON(SkConvolvePixelsProc* convolvePixels,
+                                              SkSumRowsProc* sumRows);
+
+#endif
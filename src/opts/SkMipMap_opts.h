@@ -0,0 +1,23 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMipMap_opts_DEFINED
+#define SkMipMap_opts_DEFINED
+
+#include "SkColorPriv.h"
+
+/**
+ *  Reduces two rows of 32-bit pixels to one of dstWidth pixels, each the average of a 2x2
+ *  block: dst[i] is made from src0[2i], src0[2i + 1], src1[2i] and src1[2i + 1]. Each
+ *  channel is the sum of the four shifted right by 2, as in src/core/SkMipMap.cpp.
+ */
+typedef void (*SkMipMapDownsample32Proc)(SkPMColor dst[], const SkPMColor src0[],
+                                         const SkPMColor src1[], int dstWidth);
+
+SkMipMapDownsample32Proc SkMipMapGetPlatformDownsample32Proc();
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <emmintrin.h>
+#include "SkMipMap_opts_SSE2.h"
+
+// Sums the columns of two rows of four pixels, and then adjacent pixels, into the 16-bit
+// channels of two pixels.
+static inline __m128i sum_2x2(const SkPMColor* src0, const SkPMColor* src1) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src0));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1));
+    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+    return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+}
+
+void SkMipMapDownsample32_SSE2(SkPMColor dst[], const SkPMColor src0[],
+                               const SkPMColor src1[], int dstWidth) {
+    int i = 0;
+    for (; i + 4 <= dstWidth; i += 4) {
+        __m128i sum01 = _mm_srli_epi16(sum_2x2(src0 + 2 * i, src1 + 2 * i), 2);
+        __m128i sum23 = _mm_srli_epi16(sum_2x2(src0 + 2 * i + 4, src1 + 2 * i + 4), 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(sum01, sum23));
+    }
+    for (; i < dstWidth; ++i) {
+        const SkPMColor* p0 = src0 + 2 * i;
+        const SkPMColor* p1 = src1 + 2 * i;
+        uint32_t ag = ((p0[0] >> 8) & 0xFF00FF) + ((p0[1] >> 8) & 0xFF00FF) +
+                      ((p1[0] >> 8) & 0xFF00FF) + ((p1[1] >> 8) & 0xFF00FF);
+        uint32_t rb = (p0[0] & 0xFF00FF) + (p0[1] & 0xFF00FF) +
+                      (p1[0] & 0xFF00FF) + (p1[1] & 0xFF00FF);
+        dst[i] = ((rb >> 2) & 0xFF00FF) | ((ag << 6) & 0xFF00FF00);
+    }
+}
@@ -0,0 +1,16 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMipMap_opts_SSE2_DEFINED
+#define SkMipMap_opts_SSE2_DEFINED
+
+#include "SkMipMap_opts.h"
+
+void SkMipMapDownsample32_SSE2(SkPMColor dst[], const SkPMColor src0[],
+                               const SkPMColor src1[], int dstWidth);
+
+#endif
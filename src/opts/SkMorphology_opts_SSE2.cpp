@@ -8,9 +8,11 @@
 #include <emmintrin.h>
 #include "SkColorPriv.h"
 #include "SkMorphology_opts_SSE2.h"
+#include "SkTemplates.h"
 
-/* SSE2 version of dilateX, dilateY, erodeX, erodeY.
- * portable versions are in src/effects/SkMorphologyImageFilter.cpp.
+/* SSE2 version of dilateX, dilateY, erodeX, erodeY, by the van Herk/Gil-Werman
+ * algorithm as the portable versions in src/effects/SkMorphologyImageFilter.cpp
+ * are, but four lines at a time, one to a lane.
  */
 
 enum MorphType {
@@ -21,6 +23,51 @@ enum MorphDirection {
     kX, kY
 };
 
+namespace {
+
+template<MorphType type>
+inline __m128i morph_pixels(__m128i c0, __m128i c1) {
+    return type == kDilate ? _mm_max_epu8(c0, c1) : _mm_min_epu8(c0, c1);
+}
+
+// Four pixels, one per line, from or to pixels that need not be 16-byte aligned.
+inline __m128i load4(const SkPMColor* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void store4(SkPMColor* p, __m128i c) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), c);
+}
+
+// The pixels at p in count lines stride apart, and identity in the other lanes.
+inline __m128i load_lines(const SkPMColor* p, int stride, int count, SkPMColor identity) {
+    if (4 == count) {
+        if (1 == stride) {
+            return load4(p);
+        }
+        return _mm_setr_epi32(p[0], p[stride], p[2 * stride], p[3 * stride]);
+    }
+    SkPMColor pixels[4] = { identity, identity, identity, identity };
+    for (int i = 0; i < count; ++i) {
+        pixels[i] = p[i * stride];
+    }
+    return load4(pixels);
+}
+
+inline void store_lines(SkPMColor* p, int stride, int count, __m128i c) {
+    if (4 == count && 1 == stride) {
+        store4(p, c);
+        return;
+    }
+    SkPMColor pixels[4];
+    store4(pixels, c);
+    for (int i = 0; i < count; ++i) {
+        p[i * stride] = pixels[i];
+    }
+}
+
+}  // namespace
+
 template<MorphType type, MorphDirection direction>
 static void SkMorph_SSE2(const SkPMColor* src, SkPMColor* dst, int radius,
                          int width, int height, int srcStride, int dstStride)
@@ -30,29 +77,45 @@ static void SkMorph_SSE2(const SkPMColor* src, SkPMColor* dst, int radius,
     const int srcStrideY = direction == kX ? srcStride : 1;
     const int dstStrideY = direction == kX ? dstStride : 1;
     radius = SkMin32(radius, width - 1);
-    const SkPMColor* upperSrc = src + radius * srcStrideX;
-    for (int x = 0; x < width; ++x) {
-        const SkPMColor* lp = src;
-        const SkPMColor* up = upperSrc;
-        SkPMColor* dptr = dst;
-        for (int y = 0; y < height; ++y) {
-            __m128i max = type == kDilate ? _mm_setzero_si128() : _mm_set1_epi32(0xFFFFFFFF);
-            for (const SkPMColor* p = lp; p <= up; p += srcStrideX) {
-                __m128i src_pixel = _mm_cvtsi32_si128(*p);
-                max = type == kDilate ? _mm_max_epu8(src_pixel, max) : _mm_min_epu8(src_pixel, max);
+    const int window = 2 * radius + 1;
+    const int padded = width + 2 * radius;
+    const SkPMColor identity = type == kDilate ? 0 : 0xFFFFFFFF;
+    const __m128i identities = _mm_set1_epi32(identity);
+
+    SkAutoTMalloc<SkPMColor> storage(8 * padded);
+    SkPMColor* prefix = storage.get();
+    SkPMColor* suffix = prefix + 4 * padded;
+    for (int y = 0; y < height; y += 4) {
+        const int lines = SkMin32(4, height - y);
+        for (int i = 0, block = 0; i < padded; ++i, ++block) {
+            __m128i c = identities;
+            if (i >= radius && i < radius + width) {
+                c = load_lines(src + (i - radius) * srcStrideX, srcStrideY, lines, identity);
+            }
+            if (block == window) {
+                block = 0;
             }
-            *dptr = _mm_cvtsi128_si32(max);
-            dptr += dstStrideY;
-            lp += srcStrideY;
-            up += srcStrideY;
+            store4(prefix + 4 * i, block ? morph_pixels<type>(load4(prefix + 4 * (i - 1)), c) : c);
+            store4(suffix + 4 * i, c);
         }
-        if (x >= radius) {
-            src += srcStrideX;
+        for (int i = padded - 2, block = (padded - 2) % window; i >= 0; --i, --block) {
+            if (block < 0) {
+                block = window - 1;
+            }
+            if (block != window - 1) {
+                store4(suffix + 4 * i, morph_pixels<type>(load4(suffix + 4 * i),
+                                                          load4(suffix + 4 * (i + 1))));
+            }
         }
-        if (x + radius < width - 1) {
-            upperSrc += srcStrideX;
+        SkPMColor* dptr = dst;
+        for (int x = 0; x < width; ++x) {
+            store_lines(dptr, dstStrideY, lines,
+                        morph_pixels<type>(load4(suffix + 4 * x),
+                                           load4(prefix + 4 * (x + 2 * radius))));
+            dptr += dstStrideX;
         }
-        dst += dstStrideX;
+        src += 4 * srcStrideY;
+        dst += 4 * dstStrideY;
     }
 }
 
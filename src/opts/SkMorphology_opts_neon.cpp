@@ -9,11 +9,13 @@
 #include "SkColorPriv.h"
 #include "SkMorphology_opts.h"
 #include "SkMorphology_opts_neon.h"
+#include "SkTemplates.h"
 
 #include <arm_neon.h>
 
-/* neon version of dilateX, dilateY, erodeX, erodeY.
- * portable versions are in src/effects/SkMorphologyImageFilter.cpp.
+/* neon version of dilateX, dilateY, erodeX, erodeY, by the van Herk/Gil-Werman
+ * algorithm as the portable versions in src/effects/SkMorphologyImageFilter.cpp
+ * are, but four lines at a time, one to a lane.
  */
 
 enum MorphType {
@@ -24,6 +26,40 @@ enum MorphDirection {
     kX, kY
 };
 
+namespace {
+
+template<MorphType type>
+inline uint32x4_t morph_pixels(uint32x4_t c0, uint32x4_t c1) {
+    uint8x16_t b0 = vreinterpretq_u8_u32(c0), b1 = vreinterpretq_u8_u32(c1);
+    return vreinterpretq_u32_u8(type == kDilate ? vmaxq_u8(b0, b1) : vminq_u8(b0, b1));
+}
+
+// The pixels at p in count lines stride apart, and identity in the other lanes.
+inline uint32x4_t load_lines(const SkPMColor* p, int stride, int count, SkPMColor identity) {
+    if (4 == count && 1 == stride) {
+        return vld1q_u32(p);
+    }
+    SkPMColor pixels[4] = { identity, identity, identity, identity };
+    for (int i = 0; i < count; ++i) {
+        pixels[i] = p[i * stride];
+    }
+    return vld1q_u32(pixels);
+}
+
+inline void store_lines(SkPMColor* p, int stride, int count, uint32x4_t c) {
+    if (4 == count && 1 == stride) {
+        vst1q_u32(p, c);
+        return;
+    }
+    SkPMColor pixels[4];
+    vst1q_u32(pixels, c);
+    for (int i = 0; i < count; ++i) {
+        p[i * stride] = pixels[i];
+    }
+}
+
+}  // namespace
+
 template<MorphType type, MorphDirection direction>
 static void SkMorph_neon(const SkPMColor* src, SkPMColor* dst, int radius,
                          int width, int height, int srcStride, int dstStride)
@@ -33,25 +69,47 @@ static void SkMorph_neon(const SkPMColor* src, SkPMColor* dst, int radius,
     const int srcStrideY = direction == kX ? srcStride : 1;
     const int dstStrideY = direction == kX ? dstStride : 1;
     radius = SkMin32(radius, width - 1);
-    const SkPMColor* upperSrc = src + radius * srcStrideX;
-    for (int x = 0; x < width; ++x) {
-        const SkPMColor* lp = src;
-        const SkPMColor* up = upperSrc;
-        SkPMColor* dptr = dst;
-        for (int y = 0; y < height; ++y) {
-            uint8x8_t max = vdup_n_u8(type == kDilate ? 0 : 255);
-            for (const SkPMColor* p = lp; p <= up; p += srcStrideX) {
-                uint8x8_t src_pixel = vreinterpret_u8_u32(vdup_n_u32(*p));
-                max = type == kDilate ? vmax_u8(src_pixel, max) : vmin_u8(src_pixel, max);
+    const int window = 2 * radius + 1;
+    const int padded = width + 2 * radius;
+    const SkPMColor identity = type == kDilate ? 0 : 0xFFFFFFFF;
+    const uint32x4_t identities = vdupq_n_u32(identity);
+
+    // Four pixels, one per line, for each position along the lines.
+    SkAutoTMalloc<SkPMColor> storage(8 * padded);
+    SkPMColor* prefix = storage.get();
+    SkPMColor* suffix = prefix + 4 * padded;
+    for (int y = 0; y < height; y += 4) {
+        const int lines = SkMin32(4, height - y);
+        for (int i = 0, block = 0; i < padded; ++i, ++block) {
+            uint32x4_t c = identities;
+            if (i >= radius && i < radius + width) {
+                c = load_lines(src + (i - radius) * srcStrideX, srcStrideY, lines, identity);
+            }
+            if (block == window) {
+                block = 0;
             }
-            *dptr = vget_lane_u32(vreinterpret_u32_u8(max), 0);
-            dptr += dstStrideY;
-            lp += srcStrideY;
-            up += srcStrideY;
+            vst1q_u32(prefix + 4 * i, block ? morph_pixels<type>(vld1q_u32(prefix + 4 * (i - 1)), c)
+                                            : c);
+            vst1q_u32(suffix + 4 * i, c);
+        }
+        for (int i = padded - 2, block = (padded - 2) % window; i >= 0; --i, --block) {
+            if (block < 0) {
+                block = window - 1;
+            }
+            if (block != window - 1) {
+                vst1q_u32(suffix + 4 * i, morph_pixels<type>(vld1q_u32(suffix + 4 * i),
+                                                             vld1q_u32(suffix + 4 * (i + 1))));
+            }
+        }
+        SkPMColor* dptr = dst;
+        for (int x = 0; x < width; ++x) {
+            store_lines(dptr, dstStrideY, lines,
+                        morph_pixels<type>(vld1q_u32(suffix + 4 * x),
+                                           vld1q_u32(prefix + 4 * (x + 2 * radius))));
+            dptr += dstStrideX;
         }
-        if (x >= radius) src += srcStrideX;
-        if (x + radius < width - 1) upperSrc += srcStrideX;
-        dst += dstStrideX;
+        src += 4 * srcStrideY;
+        dst += 4 * dstStrideY;
     }
 }
 
@@ -0,0 +1,26 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkScaledBitmapSampler_opts_DEFINED
+#define SkScaledBitmapSampler_opts_DEFINED
+
+#include "SkColor.h"
+
+// Same signature as SkScaledBitmapSampler::RowProc, which the opts can't see.
+typedef bool (*SkSampleRowProc)(void* SK_RESTRICT dstRow,
+                                const uint8_t* SK_RESTRICT src,
+                                int width, int deltaSrc, int y,
+                                const SkPMColor[]);
+
+enum SkSampleRowProcType {
+    kRGBx_D8888_SkSampleRowProcType,    // RGBX source to opaque N32
+    kRGBA_D8888_SkSampleRowProcType     // RGBA source to premultiplied N32
+};
+
+SkSampleRowProc SkSampleRowGetPlatformProc(SkSampleRowProcType type);
+
+#endif
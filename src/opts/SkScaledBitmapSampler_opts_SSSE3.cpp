@@ -0,0 +1,132 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkScaledBitmapSampler_opts_SSSE3.h"
+#include "SkColorPriv.h"
+
+/* As with SkBitmapProcState_opts_SSSE3.cpp, the Android framework may not build this file with
+ * -mssse3, in which case the procs are stubs that opts_check_x86.cpp never hands out.
+ */
+#if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+
+#include <tmmintrin.h>  // SSSE3
+
+// Index of the RGBA source byte that goes to byte 'k' of an N32 pixel.
+#define RGBA_BYTE_FOR_N32(k)   ((SK_R32_SHIFT / 8 == (k)) ? 0 : \
+                                (SK_G32_SHIFT / 8 == (k)) ? 1 : \
+                                (SK_B32_SHIFT / 8 == (k)) ? 2 : 3)
+#define RGBA_PIXEL_TO_N32(p)   (4*(p) + RGBA_BYTE_FOR_N32(0)), (4*(p) + RGBA_BYTE_FOR_N32(1)), \
+                               (4*(p) + RGBA_BYTE_FOR_N32(2)), (4*(p) + RGBA_BYTE_FOR_N32(3))
+#define N32_ALPHA_OF_PIXEL(p)  (4*(p) + SK_A32_SHIFT / 8), (4*(p) + SK_A32_SHIFT / 8), \
+                               (4*(p) + SK_A32_SHIFT / 8), (4*(p) + SK_A32_SHIFT / 8)
+
+namespace {
+
+// Shuffle mask reordering four RGBA pixels into N32 byte order.
+inline __m128i rgba_to_n32_mask() {
+    return _mm_setr_epi8(RGBA_PIXEL_TO_N32(0), RGBA_PIXEL_TO_N32(1),
+                         RGBA_PIXEL_TO_N32(2), RGBA_PIXEL_TO_N32(3));
+}
+
+// Shuffle mask copying the alpha of each of four N32 pixels into all of its bytes.
+inline __m128i n32_alpha_mask() {
+    return _mm_setr_epi8(N32_ALPHA_OF_PIXEL(0), N32_ALPHA_OF_PIXEL(1),
+                         N32_ALPHA_OF_PIXEL(2), N32_ALPHA_OF_PIXEL(3));
+}
+
+// Computes SkMulDiv255Round(c, a) on eight 16-bit lanes.
+inline __m128i mul_div_255_round(__m128i c, __m128i a) {
+    __m128i prod = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+}
+
+// Returns true if all four N32 pixels in 'pixels' are opaque.
+inline bool all_opaque(__m128i pixels, __m128i alphaLanes) {
+    __m128i alpha = _mm_and_si128(pixels, alphaLanes);
+    return 0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi8(alpha, alphaLanes));
+}
+
+}  // namespace
+
+bool Sample_RGBx_D8888_SSSE3(void* SK_RESTRICT dstRow,
+                             const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int, const SkPMColor[]) {
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    int x = 0;
+    if (4 == deltaSrc) {
+        const __m128i swizzle = rgba_to_n32_mask();
+        const __m128i alphaLanes = _mm_set1_epi32(0xFF << SK_A32_SHIFT);
+        for (; x + 4 <= width; x += 4) {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)src);
+            pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, swizzle), alphaLanes);
+            _mm_storeu_si128((__m128i*)(dst + x), pixels);
+            src += 16;
+        }
+    }
+    for (; x < width; x++) {
+        dst[x] = SkPackARGB32(0xFF, src[0], src[1], src[2]);
+        src += deltaSrc;
+    }
+    return false;
+}
+
+bool Sample_RGBA_D8888_SSSE3(void* SK_RESTRICT dstRow,
+                             const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int, const SkPMColor[]) {
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    bool hadAlpha = false;
+    int x = 0;
+    if (4 == deltaSrc) {
+        const __m128i swizzle = rgba_to_n32_mask();
+        const __m128i spreadAlpha = n32_alpha_mask();
+        const __m128i alphaLanes = _mm_set1_epi32(0xFF << SK_A32_SHIFT);
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 4 <= width; x += 4) {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)src);
+            pixels = _mm_shuffle_epi8(pixels, swizzle);
+            // Opaque runs are common and need no premultiplying.
+            if (!all_opaque(pixels, alphaLanes)) {
+                hadAlpha = true;
+                // Scale the alpha bytes by 255 so that they come out unchanged.
+                __m128i alpha = _mm_or_si128(_mm_shuffle_epi8(pixels, spreadAlpha), alphaLanes);
+                __m128i lo = mul_div_255_round(_mm_unpacklo_epi8(pixels, zero),
+                                               _mm_unpacklo_epi8(alpha, zero));
+                __m128i hi = mul_div_255_round(_mm_unpackhi_epi8(pixels, zero),
+                                               _mm_unpackhi_epi8(alpha, zero));
+                pixels = _mm_packus_epi16(lo, hi);
+            }
+            _mm_storeu_si128((__m128i*)(dst + x), pixels);
+            src += 16;
+        }
+    }
+    unsigned alphaMask = 0xFF;
+    for (; x < width; x++) {
+        unsigned alpha = src[3];
+        dst[x] = SkPreMultiplyARGB(alpha, src[0], src[1], src[2]);
+        src += deltaSrc;
+        alphaMask &= alpha;
+    }
+    return hadAlpha || alphaMask != 0xFF;
+}
+
+#else // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+
+bool Sample_RGBx_D8888_SSSE3(void* SK_RESTRICT dstRow,
+                             const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int, const SkPMColor[]) {
+    sk_throw();
+    return false;
+}
+
+bool Sample_RGBA_D8888_SSSE3(void* SK_RESTRICT dstRow,
+                             const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int, const SkPMColor[]) {
+    sk_throw();
+    return false;
+}
+
+#endif
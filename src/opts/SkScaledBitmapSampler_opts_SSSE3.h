@@ -0,0 +1,22 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkScaledBitmapSampler_opts_SSSE3_DEFINED
+#define SkScaledBitmapSampler_opts_SSSE3_DEFINED
+
+#include "SkColor.h"
+
+bool Sample_RGBx_D8888_SSSE3(void* SK_RESTRICT dstRow,
+                             const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int y,
+                             const SkPMColor[]);
+bool Sample_RGBA_D8888_SSSE3(void* SK_RESTRICT dstRow,
+                             const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int y,
+                             const SkPMColor[]);
+
+#endif
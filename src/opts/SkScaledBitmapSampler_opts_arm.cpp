@@ -0,0 +1,30 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkScaledBitmapSampler_opts.h"
+#include "SkScaledBitmapSampler_opts_neon.h"
+#include "SkUtilsArm.h"
+
+SkSampleRowProc SkSampleRowGetPlatformProc(SkSampleRowProcType type) {
+#if SK_ARM_NEON_IS_NONE
+    return NULL;
+#else
+#if SK_ARM_NEON_IS_DYNAMIC
+    if (!sk_cpu_arm_has_neon()) {
+        return NULL;
+    }
+#endif
+    switch (type) {
+        case kRGBx_D8888_SkSampleRowProcType:
+            return Sample_RGBx_D8888_neon;
+        case kRGBA_D8888_SkSampleRowProcType:
+            return Sample_RGBA_D8888_neon;
+        default:
+            return NULL;
+    }
+#endif
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkScaledBitmapSampler_opts_neon.h"
+#include "SkColorPriv.h"
+
+#include <arm_neon.h>
+
+// Computes SkMulDiv255Round(c, a) on eight lanes.
+static inline uint8x8_t mul_div_255_round(uint8x8_t c, uint8x8_t a) {
+    uint16x8_t prod = vaddq_u16(vmull_u8(c, a), vdupq_n_u16(128));
+    return vshrn_n_u16(vaddq_u16(prod, vshrq_n_u16(prod, 8)), 8);
+}
+
+bool Sample_RGBx_D8888_neon(void* SK_RESTRICT dstRow,
+                            const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    int x = 0;
+    if (4 == deltaSrc) {
+        for (; x + 8 <= width; x += 8) {
+            uint8x8x4_t rgbx = vld4_u8(src);
+            uint8x8x4_t n32;
+            n32.val[SK_R32_SHIFT / 8] = rgbx.val[0];
+            n32.val[SK_G32_SHIFT / 8] = rgbx.val[1];
+            n32.val[SK_B32_SHIFT / 8] = rgbx.val[2];
+            n32.val[SK_A32_SHIFT / 8] = vdup_n_u8(0xFF);
+            vst4_u8((uint8_t*)(dst + x), n32);
+            src += 32;
+        }
+    }
+    for (; x < width; x++) {
+        dst[x] = SkPackARGB32(0xFF, src[0], src[1], src[2]);
+        src += deltaSrc;
+    }
+    return false;
+}
+
+bool Sample_RGBA_D8888_neon(void* SK_RESTRICT dstRow,
+                            const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    uint8x8_t alphaAnd = vdup_n_u8(0xFF);
+    int x = 0;
+    if (4 == deltaSrc) {
+        for (; x + 8 <= width; x += 8) {
+            uint8x8x4_t rgba = vld4_u8(src);
+            uint8x8_t alpha = rgba.val[3];
+            uint8x8x4_t n32;
+            n32.val[SK_R32_SHIFT / 8] = mul_div_255_round(rgba.val[0], alpha);
+            n32.val[SK_G32_SHIFT / 8] = mul_div_255_round(rgba.val[1], alpha);
+            n32.val[SK_B32_SHIFT / 8] = mul_div_255_round(rgba.val[2], alpha);
+            n32.val[SK_A32_SHIFT / 8] = alpha;
+            vst4_u8((uint8_t*)(dst + x), n32);
+            alphaAnd = vand_u8(alphaAnd, alpha);
+            src += 32;
+        }
+    }
+    unsigned alphaMask = 0xFF;
+    for (; x < width; x++) {
+        unsigned alpha = src[3];
+        dst[x] = SkPreMultiplyARGB(alpha, src[0], src[1], src[2]);
+        src += deltaSrc;
+        alphaMask &= alpha;
+    }
+    uint64_t alphaAnd64 = vget_lane_u64(vreinterpret_u64_u8(alphaAnd), 0);
+    return alphaMask != 0xFF || alphaAnd64 != ~0ULL;
+}
@@ -0,0 +1,885 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <immintrin.h>
+#include "SkColorPriv.h"
+#include "SkXfermode.h"
+#include "SkXfermode_opts_AVX2.h"
+#include "SkXfermode_proccoeff.h"
+
+/* These are the SSE2 modeprocs from SkXfermode_opts_SSE2.cpp widened to 8
+ * pixels. Every AVX2 integer and float op used here works independently on
+ * each 128-bit lane, and the 32-bit multiplies keep the low 32 bits as
+ * Multiply32_SSE2() does, so the result is exactly that of the SSE2 versions.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// 8 pixels AVX2 version functions
+////////////////////////////////////////////////////////////////////////////////
+
+static inline __m256i SkDiv255Round_AVX2(const __m256i& a) {
+    __m256i prod = _mm256_add_epi32(a, _mm256_set1_epi32(128));    // prod += 128;
+    prod = _mm256_add_epi32(prod, _mm256_srli_epi32(prod, 8));     // prod + (prod >> 8)
+    prod = _mm256_srli_epi32(prod, 8);                             // >> 8
+
+    return prod;
+}
+
+static inline __m256i saturated_add_AVX2(const __m256i& a, const __m256i& b) {
+    __m256i sum = _mm256_add_epi32(a, b);
+    __m256i cmp = _mm256_cmpgt_epi32(sum, _mm256_set1_epi32(255));
+
+    sum = _mm256_or_si256(_mm256_and_si256(cmp, _mm256_set1_epi32(255)),
+                          _mm256_andnot_si256(cmp, sum));
+    return sum;
+}
+
+static inline __m256i clamp_signed_byte_AVX2(const __m256i& n) {
+    __m256i cmp1 = _mm256_cmpgt_epi32(_mm256_setzero_si256(), n);
+    __m256i cmp2 = _mm256_cmpgt_epi32(n, _mm256_set1_epi32(255));
+    __m256i ret = _mm256_and_si256(cmp2, _mm256_set1_epi32(255));
+
+    __m256i cmp = _mm256_or_si256(cmp1, cmp2);
+    ret = _mm256_or_si256(_mm256_and_si256(cmp, ret), _mm256_andnot_si256(cmp, n));
+
+    return ret;
+}
+
+static inline __m256i clamp_div255round_AVX2(const __m256i& prod) {
+    // test if > 0
+    __m256i cmp1 = _mm256_cmpgt_epi32(prod, _mm256_setzero_si256());
+    // test if < 255*255
+    __m256i cmp2 = _mm256_cmpgt_epi32(_mm256_set1_epi32(255*255), prod);
+
+    // if value >= 255*255, value = 255
+    __m256i ret = _mm256_andnot_si256(cmp2, _mm256_set1_epi32(255));
+
+    __m256i div = SkDiv255Round_AVX2(prod);
+
+    // test if > 0 && < 255*255
+    __m256i cmp = _mm256_and_si256(cmp1, cmp2);
+
+    ret = _mm256_or_si256(_mm256_and_si256(cmp, div), _mm256_andnot_si256(cmp, ret));
+
+    return ret;
+}
+
+static inline __m256i SkMin32_AVX2(const __m256i& a, const __m256i& b) {
+    __m256i cmp = _mm256_cmpgt_epi32(b, a);
+    return _mm256_or_si256(_mm256_and_si256(cmp, a), _mm256_andnot_si256(cmp, b));
+}
+
+// Same as shim_mm_div_epi32() in SkMath_opts_SSE2.h.
+static inline __m256i div_epi32_AVX2(const __m256i& a, const __m256i& b) {
+    __m256 x = _mm256_cvtepi32_ps(a);
+    __m256 y = _mm256_cvtepi32_ps(b);
+    return _mm256_cvttps_epi32(_mm256_div_ps(x, y));
+}
+
+// Same as SkSqrtBits_SSE2() in SkMath_opts_SSE2.h.
+static inline __m256i SkSqrtBits_AVX2(const __m256i& x, int count) {
+    __m256i root = _mm256_setzero_si256();
+    __m256i remHi = _mm256_setzero_si256();
+    __m256i remLo = x;
+    __m256i one256 = _mm256_set1_epi32(1);
+
+    do {
+        root = _mm256_slli_epi32(root, 1);
+
+        remHi = _mm256_or_si256(_mm256_slli_epi32(remHi, 2),
+                                _mm256_srli_epi32(remLo, 30));
+        remLo = _mm256_slli_epi32(remLo, 2);
+
+        __m256i testDiv = _mm256_slli_epi32(root, 1);
+        testDiv = _mm256_add_epi32(testDiv, one256);
+
+        __m256i cmp = _mm256_cmpgt_epi32(testDiv, remHi);
+        __m256i remHi1 = _mm256_and_si256(cmp, remHi);
+        __m256i root1 = _mm256_and_si256(cmp, root);
+        __m256i remHi2 = _mm256_andnot_si256(cmp, _mm256_sub_epi32(remHi, testDiv));
+        __m256i root2 = _mm256_andnot_si256(cmp, _mm256_add_epi32(root, one256));
+
+        remHi = _mm256_or_si256(remHi1, remHi2);
+        root = _mm256_or_si256(root1, root2);
+    } while (--count >= 0);
+
+    return root;
+}
+
+static inline __m256i SkAlpha255To256_AVX2(const __m256i& alpha) {
+    return _mm256_add_epi32(alpha, _mm256_set1_epi32(1));
+}
+
+// See SkAlphaMulAlpha_SSE2() in SkColor_opts_SSE2.h.
+static inline __m256i SkAlphaMulAlpha_AVX2(const __m256i& a, const __m256i& b) {
+    __m256i prod = _mm256_mullo_epi16(a, b);
+    prod = _mm256_add_epi32(prod, _mm256_set1_epi32(128));
+    prod = _mm256_add_epi32(prod, _mm256_srli_epi32(prod, 8));
+    prod = _mm256_srli_epi32(prod, 8);
+
+    return prod;
+}
+
+// Portable version SkAlphaMulQ is in SkColorPriv.h.
+static inline __m256i SkAlphaMulQ_AVX2(const __m256i& c, const __m256i& scale) {
+    __m256i mask = _mm256_set1_epi32(0xFF00FF);
+    __m256i s = _mm256_or_si256(_mm256_slli_epi32(scale, 16), scale);
+
+    // uint32_t rb = ((c & mask) * scale) >> 8
+    __m256i rb = _mm256_and_si256(mask, c);
+    rb = _mm256_mullo_epi16(rb, s);
+    rb = _mm256_srli_epi16(rb, 8);
+
+    // uint32_t ag = ((c >> 8) & mask) * scale
+    __m256i ag = _mm256_srli_epi16(c, 8);
+    ag = _mm256_and_si256(ag, mask);
+    ag = _mm256_mullo_epi16(ag, s);
+
+    // (rb & mask) | (ag & ~mask)
+    rb = _mm256_and_si256(mask, rb);
+    ag = _mm256_andnot_si256(mask, ag);
+    return _mm256_or_si256(rb, ag);
+}
+
+static inline __m256i SkGetPackedA32_AVX2(const __m256i& src) {
+    __m256i a = _mm256_slli_epi32(src, (24 - SK_A32_SHIFT));
+    return _mm256_srli_epi32(a, 24);
+}
+
+static inline __m256i SkGetPackedR32_AVX2(const __m256i& src) {
+    __m256i r = _mm256_slli_epi32(src, (24 - SK_R32_SHIFT));
+    return _mm256_srli_epi32(r, 24);
+}
+
+static inline __m256i SkGetPackedG32_AVX2(const __m256i& src) {
+    __m256i g = _mm256_slli_epi32(src, (24 - SK_G32_SHIFT));
+    return _mm256_srli_epi32(g, 24);
+}
+
+static inline __m256i SkGetPackedB32_AVX2(const __m256i& src) {
+    __m256i b = _mm256_slli_epi32(src, (24 - SK_B32_SHIFT));
+    return _mm256_srli_epi32(b, 24);
+}
+
+static inline __m256i SkPackARGB32_AVX2(const __m256i& a, const __m256i& r,
+                                        const __m256i& g, const __m256i& b) {
+    __m256i da = _mm256_slli_epi32(a, SK_A32_SHIFT);
+    __m256i dr = _mm256_slli_epi32(r, SK_R32_SHIFT);
+    __m256i dg = _mm256_slli_epi32(g, SK_G32_SHIFT);
+    __m256i db = _mm256_slli_epi32(b, SK_B32_SHIFT);
+
+    __m256i c = _mm256_or_si256(da, dr);
+    c = _mm256_or_si256(c, dg);
+    return _mm256_or_si256(c, db);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static __m256i srcover_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(256), SkGetPackedA32_AVX2(src));
+    return _mm256_add_epi32(src, SkAlphaMulQ_AVX2(dst, isa));
+}
+
+static __m256i dstover_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(256), SkGetPackedA32_AVX2(dst));
+    return _mm256_add_epi32(dst, SkAlphaMulQ_AVX2(src, ida));
+}
+
+static __m256i srcin_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i da = SkGetPackedA32_AVX2(dst);
+    return SkAlphaMulQ_AVX2(src, SkAlpha255To256_AVX2(da));
+}
+
+static __m256i dstin_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    return SkAlphaMulQ_AVX2(dst, SkAlpha255To256_AVX2(sa));
+}
+
+static __m256i srcout_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(256), SkGetPackedA32_AVX2(dst));
+    return SkAlphaMulQ_AVX2(src, ida);
+}
+
+static __m256i dstout_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(256), SkGetPackedA32_AVX2(src));
+    return SkAlphaMulQ_AVX2(dst, isa);
+}
+
+static __m256i srcatop_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(255), sa);
+
+    __m256i a = da;
+
+    __m256i r1 = SkAlphaMulAlpha_AVX2(da, SkGetPackedR32_AVX2(src));
+    __m256i r2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedR32_AVX2(dst));
+    __m256i r = _mm256_add_epi32(r1, r2);
+
+    __m256i g1 = SkAlphaMulAlpha_AVX2(da, SkGetPackedG32_AVX2(src));
+    __m256i g2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedG32_AVX2(dst));
+    __m256i g = _mm256_add_epi32(g1, g2);
+
+    __m256i b1 = SkAlphaMulAlpha_AVX2(da, SkGetPackedB32_AVX2(src));
+    __m256i b2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedB32_AVX2(dst));
+    __m256i b = _mm256_add_epi32(b1, b2);
+
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static __m256i dstatop_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(255), da);
+
+    __m256i a = sa;
+
+    __m256i r1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedR32_AVX2(src));
+    __m256i r2 = SkAlphaMulAlpha_AVX2(sa, SkGetPackedR32_AVX2(dst));
+    __m256i r = _mm256_add_epi32(r1, r2);
+
+    __m256i g1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedG32_AVX2(src));
+    __m256i g2 = SkAlphaMulAlpha_AVX2(sa, SkGetPackedG32_AVX2(dst));
+    __m256i g = _mm256_add_epi32(g1, g2);
+
+    __m256i b1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedB32_AVX2(src));
+    __m256i b2 = SkAlphaMulAlpha_AVX2(sa, SkGetPackedB32_AVX2(dst));
+    __m256i b = _mm256_add_epi32(b1, b2);
+
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static __m256i xor_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(255), sa);
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(255), da);
+
+    __m256i a1 = _mm256_add_epi32(sa, da);
+    __m256i a2 = SkAlphaMulAlpha_AVX2(sa, da);
+    a2 = _mm256_slli_epi32(a2, 1);
+    __m256i a = _mm256_sub_epi32(a1, a2);
+
+    __m256i r1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedR32_AVX2(src));
+    __m256i r2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedR32_AVX2(dst));
+    __m256i r = _mm256_add_epi32(r1, r2);
+
+    __m256i g1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedG32_AVX2(src));
+    __m256i g2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedG32_AVX2(dst));
+    __m256i g = _mm256_add_epi32(g1, g2);
+
+    __m256i b1 = SkAlphaMulAlpha_AVX2(ida, SkGetPackedB32_AVX2(src));
+    __m256i b2 = SkAlphaMulAlpha_AVX2(isa, SkGetPackedB32_AVX2(dst));
+    __m256i b = _mm256_add_epi32(b1, b2);
+
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static __m256i plus_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i b = saturated_add_AVX2(SkGetPackedB32_AVX2(src),
+                                   SkGetPackedB32_AVX2(dst));
+    __m256i g = saturated_add_AVX2(SkGetPackedG32_AVX2(src),
+                                   SkGetPackedG32_AVX2(dst));
+    __m256i r = saturated_add_AVX2(SkGetPackedR32_AVX2(src),
+                                   SkGetPackedR32_AVX2(dst));
+    __m256i a = saturated_add_AVX2(SkGetPackedA32_AVX2(src),
+                                   SkGetPackedA32_AVX2(dst));
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static __m256i modulate_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i a = SkAlphaMulAlpha_AVX2(SkGetPackedA32_AVX2(src),
+                                     SkGetPackedA32_AVX2(dst));
+    __m256i r = SkAlphaMulAlpha_AVX2(SkGetPackedR32_AVX2(src),
+                                     SkGetPackedR32_AVX2(dst));
+    __m256i g = SkAlphaMulAlpha_AVX2(SkGetPackedG32_AVX2(src),
+                                     SkGetPackedG32_AVX2(dst));
+    __m256i b = SkAlphaMulAlpha_AVX2(SkGetPackedB32_AVX2(src),
+                                     SkGetPackedB32_AVX2(dst));
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i srcover_byte_AVX2(const __m256i& a, const __m256i& b) {
+    // a + b - SkAlphaMulAlpha(a, b);
+    return _mm256_sub_epi32(_mm256_add_epi32(a, b), SkAlphaMulAlpha_AVX2(a, b));
+}
+
+static inline __m256i blendfunc_multiply_byte_AVX2(const __m256i& sc, const __m256i& dc,
+                                                   const __m256i& sa, const __m256i& da) {
+    // sc * (255 - da)
+    __m256i ret1 = _mm256_sub_epi32(_mm256_set1_epi32(255), da);
+    ret1 = _mm256_mullo_epi16(sc, ret1);
+
+    // dc * (255 - sa)
+    __m256i ret2 = _mm256_sub_epi32(_mm256_set1_epi32(255), sa);
+    ret2 = _mm256_mullo_epi16(dc, ret2);
+
+    // sc * dc
+    __m256i ret3 = _mm256_mullo_epi16(sc, dc);
+
+    __m256i ret = _mm256_add_epi32(ret1, ret2);
+    ret = _mm256_add_epi32(ret, ret3);
+
+    return clamp_div255round_AVX2(ret);
+}
+
+static __m256i multiply_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+    __m256i a = srcover_byte_AVX2(sa, da);
+
+    __m256i r = blendfunc_multiply_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                             SkGetPackedR32_AVX2(dst), sa, da);
+    __m256i g = blendfunc_multiply_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                             SkGetPackedG32_AVX2(dst), sa, da);
+    __m256i b = blendfunc_multiply_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                             SkGetPackedB32_AVX2(dst), sa, da);
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static __m256i screen_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i a = srcover_byte_AVX2(SkGetPackedA32_AVX2(src),
+                                  SkGetPackedA32_AVX2(dst));
+    __m256i r = srcover_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                  SkGetPackedR32_AVX2(dst));
+    __m256i g = srcover_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                  SkGetPackedG32_AVX2(dst));
+    __m256i b = srcover_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                  SkGetPackedB32_AVX2(dst));
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i overlay_byte_AVX2(const __m256i& sc, const __m256i& dc,
+                                        const __m256i& sa, const __m256i& da) {
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(255), da);
+    __m256i tmp1 = _mm256_mullo_epi16(sc, ida);
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(255), sa);
+    __m256i tmp2 = _mm256_mullo_epi16(dc, isa);
+    __m256i tmp = _mm256_add_epi32(tmp1, tmp2);
+
+    __m256i cmp = _mm256_cmpgt_epi32(_mm256_slli_epi32(dc, 1), da);
+    __m256i rc1 = _mm256_slli_epi32(sc, 1);                             // 2 * sc
+    rc1 = _mm256_mullo_epi32(rc1, dc);                                  // *dc
+
+    __m256i rc2 = _mm256_mullo_epi16(sa, da);                           // sa * da
+    __m256i tmp3 = _mm256_slli_epi32(_mm256_sub_epi32(da, dc), 1);      // 2 * (da - dc)
+    tmp3 = _mm256_mullo_epi32(tmp3, _mm256_sub_epi32(sa, sc));          // * (sa - sc)
+    rc2 = _mm256_sub_epi32(rc2, tmp3);
+
+    __m256i rc = _mm256_or_si256(_mm256_andnot_si256(cmp, rc1),
+                                 _mm256_and_si256(cmp, rc2));
+    return clamp_div255round_AVX2(_mm256_add_epi32(rc, tmp));
+}
+
+static __m256i overlay_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+
+    __m256i a = srcover_byte_AVX2(sa, da);
+    __m256i r = overlay_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                  SkGetPackedR32_AVX2(dst), sa, da);
+    __m256i g = overlay_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                  SkGetPackedG32_AVX2(dst), sa, da);
+    __m256i b = overlay_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                  SkGetPackedB32_AVX2(dst), sa, da);
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i darken_byte_AVX2(const __m256i& sc, const __m256i& dc,
+                                       const __m256i& sa, const __m256i& da) {
+    __m256i sd = _mm256_mullo_epi16(sc, da);
+    __m256i ds = _mm256_mullo_epi16(dc, sa);
+
+    __m256i cmp = _mm256_cmpgt_epi32(ds, sd);
+
+    __m256i tmp = _mm256_add_epi32(sc, dc);
+    __m256i ret1 = _mm256_sub_epi32(tmp, SkDiv255Round_AVX2(ds));
+    __m256i ret2 = _mm256_sub_epi32(tmp, SkDiv255Round_AVX2(sd));
+    __m256i ret = _mm256_or_si256(_mm256_and_si256(cmp, ret1),
+                                  _mm256_andnot_si256(cmp, ret2));
+    return ret;
+}
+
+static __m256i darken_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+
+    __m256i a = srcover_byte_AVX2(sa, da);
+    __m256i r = darken_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                 SkGetPackedR32_AVX2(dst), sa, da);
+    __m256i g = darken_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                 SkGetPackedG32_AVX2(dst), sa, da);
+    __m256i b = darken_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                 SkGetPackedB32_AVX2(dst), sa, da);
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i lighten_byte_AVX2(const __m256i& sc, const __m256i& dc,
+                                        const __m256i& sa, const __m256i& da) {
+    __m256i sd = _mm256_mullo_epi16(sc, da);
+    __m256i ds = _mm256_mullo_epi16(dc, sa);
+
+    __m256i cmp = _mm256_cmpgt_epi32(sd, ds);
+
+    __m256i tmp = _mm256_add_epi32(sc, dc);
+    __m256i ret1 = _mm256_sub_epi32(tmp, SkDiv255Round_AVX2(ds));
+    __m256i ret2 = _mm256_sub_epi32(tmp, SkDiv255Round_AVX2(sd));
+    __m256i ret = _mm256_or_si256(_mm256_and_si256(cmp, ret1),
+                                  _mm256_andnot_si256(cmp, ret2));
+    return ret;
+}
+
+static __m256i lighten_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+
+    __m256i a = srcover_byte_AVX2(sa, da);
+    __m256i r = lighten_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                  SkGetPackedR32_AVX2(dst), sa, da);
+    __m256i g = lighten_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                  SkGetPackedG32_AVX2(dst), sa, da);
+    __m256i b = lighten_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                  SkGetPackedB32_AVX2(dst), sa, da);
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i colordodge_byte_AVX2(const __m256i& sc, const __m256i& dc,
+                                           const __m256i& sa, const __m256i& da) {
+    __m256i diff = _mm256_sub_epi32(sa, sc);
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(255), da);
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(255), sa);
+
+    // if (0 == dc)
+    __m256i cmp1 = _mm256_cmpeq_epi32(dc, _mm256_setzero_si256());
+    __m256i rc1 = _mm256_and_si256(cmp1, SkAlphaMulAlpha_AVX2(sc, ida));
+
+    // else if (0 == diff)
+    __m256i cmp2 = _mm256_cmpeq_epi32(diff, _mm256_setzero_si256());
+    __m256i cmp = _mm256_andnot_si256(cmp1, cmp2);
+    __m256i tmp1 = _mm256_mullo_epi16(sa, da);
+    __m256i tmp2 = _mm256_mullo_epi16(sc, ida);
+    __m256i tmp3 = _mm256_mullo_epi16(dc, isa);
+    __m256i rc2 = _mm256_add_epi32(tmp1, tmp2);
+    rc2 = _mm256_add_epi32(rc2, tmp3);
+    rc2 = clamp_div255round_AVX2(rc2);
+    rc2 = _mm256_and_si256(cmp, rc2);
+
+    // else
+    __m256i cmp3 = _mm256_or_si256(cmp1, cmp2);
+    __m256i value = _mm256_mullo_epi16(dc, sa);
+    diff = div_epi32_AVX2(value, diff);
+
+    __m256i tmp4 = SkMin32_AVX2(da, diff);
+    tmp4 = _mm256_mullo_epi32(sa, tmp4);
+    __m256i rc3 = _mm256_add_epi32(tmp4, tmp2);
+    rc3 = _mm256_add_epi32(rc3, tmp3);
+    rc3 = clamp_div255round_AVX2(rc3);
+    rc3 = _mm256_andnot_si256(cmp3, rc3);
+
+    __m256i rc = _mm256_or_si256(rc1, rc2);
+    rc = _mm256_or_si256(rc, rc3);
+
+    return rc;
+}
+
+static __m256i colordodge_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+
+    __m256i a = srcover_byte_AVX2(sa, da);
+    __m256i r = colordodge_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                     SkGetPackedR32_AVX2(dst), sa, da);
+    __m256i g = colordodge_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                     SkGetPackedG32_AVX2(dst), sa, da);
+    __m256i b = colordodge_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                     SkGetPackedB32_AVX2(dst), sa, da);
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i colorburn_byte_AVX2(const __m256i& sc, const __m256i& dc,
+                                          const __m256i& sa, const __m256i& da) {
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(255), da);
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(255), sa);
+
+    // if (dc == da)
+    __m256i cmp1 = _mm256_cmpeq_epi32(dc, da);
+    __m256i tmp1 = _mm256_mullo_epi16(sa, da);
+    __m256i tmp2 = _mm256_mullo_epi16(sc, ida);
+    __m256i tmp3 = _mm256_mullo_epi16(dc, isa);
+    __m256i rc1 = _mm256_add_epi32(tmp1, tmp2);
+    rc1 = _mm256_add_epi32(rc1, tmp3);
+    rc1 = clamp_div255round_AVX2(rc1);
+    rc1 = _mm256_and_si256(cmp1, rc1);
+
+    // else if (0 == sc)
+    __m256i cmp2 = _mm256_cmpeq_epi32(sc, _mm256_setzero_si256());
+    __m256i rc2 = SkAlphaMulAlpha_AVX2(dc, isa);
+    __m256i cmp = _mm256_andnot_si256(cmp1, cmp2);
+    rc2 = _mm256_and_si256(cmp, rc2);
+
+    // else
+    __m256i cmp3 = _mm256_or_si256(cmp1, cmp2);
+    __m256i tmp4 = _mm256_sub_epi32(da, dc);
+    tmp4 = _mm256_mullo_epi32(tmp4, sa);
+    tmp4 = div_epi32_AVX2(tmp4, sc);
+
+    __m256i tmp5 = _mm256_sub_epi32(da, SkMin32_AVX2(da, tmp4));
+    tmp5 = _mm256_mullo_epi32(sa, tmp5);
+    __m256i rc3 = _mm256_add_epi32(tmp5, tmp2);
+    rc3 = _mm256_add_epi32(rc3, tmp3);
+    rc3 = clamp_div255round_AVX2(rc3);
+    rc3 = _mm256_andnot_si256(cmp3, rc3);
+
+    __m256i rc = _mm256_or_si256(rc1, rc2);
+    rc = _mm256_or_si256(rc, rc3);
+
+    return rc;
+}
+
+static __m256i colorburn_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+
+    __m256i a = srcover_byte_AVX2(sa, da);
+    __m256i r = colorburn_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                    SkGetPackedR32_AVX2(dst), sa, da);
+    __m256i g = colorburn_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                    SkGetPackedG32_AVX2(dst), sa, da);
+    __m256i b = colorburn_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                    SkGetPackedB32_AVX2(dst), sa, da);
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i hardlight_byte_AVX2(const __m256i& sc, const __m256i& dc,
+                                          const __m256i& sa, const __m256i& da) {
+    // if (2 * sc <= sa)
+    __m256i tmp1 = _mm256_slli_epi32(sc, 1);
+    __m256i cmp1 = _mm256_cmpgt_epi32(tmp1, sa);
+    __m256i rc1 = _mm256_mullo_epi16(sc, dc);                   // sc * dc;
+    rc1 = _mm256_slli_epi32(rc1, 1);                            // 2 * sc * dc
+    rc1 = _mm256_andnot_si256(cmp1, rc1);
+
+    // else
+    tmp1 = _mm256_mullo_epi16(sa, da);
+    __m256i tmp2 = _mm256_mullo_epi32(_mm256_sub_epi32(da, dc),
+                                      _mm256_sub_epi32(sa, sc));
+    tmp2 = _mm256_slli_epi32(tmp2, 1);
+    __m256i rc2 = _mm256_sub_epi32(tmp1, tmp2);
+    rc2 = _mm256_and_si256(cmp1, rc2);
+
+    __m256i rc = _mm256_or_si256(rc1, rc2);
+
+    __m256i ida = _mm256_sub_epi32(_mm256_set1_epi32(255), da);
+    tmp1 = _mm256_mullo_epi16(sc, ida);
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(255), sa);
+    tmp2 = _mm256_mullo_epi16(dc, isa);
+    rc = _mm256_add_epi32(rc, tmp1);
+    rc = _mm256_add_epi32(rc, tmp2);
+    return clamp_div255round_AVX2(rc);
+}
+
+static __m256i hardlight_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+
+    __m256i a = srcover_byte_AVX2(sa, da);
+    __m256i r = hardlight_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                    SkGetPackedR32_AVX2(dst), sa, da);
+    __m256i g = hardlight_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                    SkGetPackedG32_AVX2(dst), sa, da);
+    __m256i b = hardlight_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                    SkGetPackedB32_AVX2(dst), sa, da);
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i softlight_byte_AVX2(const __m256i& sc, const __m256i& dc,
+                                          const __m256i& sa, const __m256i& da) {
+    __m256i tmp1, tmp2, tmp3;
+
+    // int m = da ? dc * 256 / da : 0;
+    __m256i cmp = _mm256_cmpeq_epi32(da, _mm256_setzero_si256());
+    __m256i m = div_epi32_AVX2(_mm256_slli_epi32(dc, 8), da);
+    m = _mm256_andnot_si256(cmp, m);
+
+    // if (2 * sc <= sa)
+    tmp1 = _mm256_slli_epi32(sc, 1);                            // 2 * sc
+    __m256i cmp1 = _mm256_cmpgt_epi32(tmp1, sa);
+    tmp1 = _mm256_sub_epi32(tmp1, sa);                          // 2 * sc - sa
+    tmp2 = _mm256_sub_epi32(_mm256_set1_epi32(256), m);         // 256 - m
+    tmp1 = _mm256_mullo_epi32(tmp1, tmp2);
+    tmp1 = _mm256_srai_epi32(tmp1, 8);
+    tmp1 = _mm256_add_epi32(sa, tmp1);
+    tmp1 = _mm256_mullo_epi32(dc, tmp1);
+    __m256i rc1 = _mm256_andnot_si256(cmp1, tmp1);
+
+    // else if (4 * dc <= da)
+    tmp2 = _mm256_slli_epi32(dc, 2);                            // dc * 4
+    __m256i cmp2 = _mm256_cmpgt_epi32(tmp2, da);
+    __m256i i = _mm256_slli_epi32(m, 2);                        // 4 * m
+    __m256i j = _mm256_add_epi32(i, _mm256_set1_epi32(256));    // 4 * m + 256
+    __m256i k = _mm256_mullo_epi32(i, j);                       // 4 * m * (4 * m + 256)
+    __m256i t = _mm256_sub_epi32(m, _mm256_set1_epi32(256));    // m - 256
+    i = _mm256_mullo_epi32(k, t);                   // 4 * m * (4 * m + 256) * (m - 256)
+    i = _mm256_srai_epi32(i, 16);                               // >> 16
+    j = _mm256_mullo_epi32(_mm256_set1_epi32(7), m);            // 7 * m
+    tmp2 = _mm256_add_epi32(i, j);
+    i = _mm256_mullo_epi32(dc, sa);                             // dc * sa
+    j = _mm256_slli_epi32(sc, 1);                               // 2 * sc
+    j = _mm256_sub_epi32(j, sa);                                // 2 * sc - sa
+    j = _mm256_mullo_epi32(da, j);                              // da * (2 * sc - sa)
+    tmp2 = _mm256_mullo_epi32(j, tmp2);                         // * tmp
+    tmp2 = _mm256_srai_epi32(tmp2, 8);                          // >> 8
+    tmp2 = _mm256_add_epi32(i, tmp2);
+    cmp = _mm256_andnot_si256(cmp2, cmp1);
+    __m256i rc2 = _mm256_and_si256(cmp, tmp2);
+    __m256i rc = _mm256_or_si256(rc1, rc2);
+
+    // else
+    tmp3 = SkSqrtBits_AVX2(m, 15+4);
+    tmp3 = _mm256_sub_epi32(tmp3, m);
+    tmp3 = _mm256_mullo_epi32(j, tmp3);                         // j = da * (2 * sc - sa)
+    tmp3 = _mm256_srai_epi32(tmp3, 8);
+    tmp3 = _mm256_add_epi32(i, tmp3);                           // i = dc * sa
+    cmp = _mm256_and_si256(cmp1, cmp2);
+    __m256i rc3 = _mm256_and_si256(cmp, tmp3);
+    rc = _mm256_or_si256(rc, rc3);
+
+    tmp1 = _mm256_sub_epi32(_mm256_set1_epi32(255), da);        // 255 - da
+    tmp1 = _mm256_mullo_epi16(sc, tmp1);
+    tmp2 = _mm256_sub_epi32(_mm256_set1_epi32(255), sa);        // 255 - sa
+    tmp2 = _mm256_mullo_epi16(dc, tmp2);
+    rc = _mm256_add_epi32(rc, tmp1);
+    rc = _mm256_add_epi32(rc, tmp2);
+    return clamp_div255round_AVX2(rc);
+}
+
+static __m256i softlight_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+
+    __m256i a = srcover_byte_AVX2(sa, da);
+    __m256i r = softlight_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                    SkGetPackedR32_AVX2(dst), sa, da);
+    __m256i g = softlight_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                    SkGetPackedG32_AVX2(dst), sa, da);
+    __m256i b = softlight_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                    SkGetPackedB32_AVX2(dst), sa, da);
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i difference_byte_AVX2(const __m256i& sc, const __m256i& dc,
+                                           const __m256i& sa, const __m256i& da) {
+    __m256i tmp1 = _mm256_mullo_epi16(sc, da);
+    __m256i tmp2 = _mm256_mullo_epi16(dc, sa);
+    __m256i tmp = SkMin32_AVX2(tmp1, tmp2);
+
+    __m256i ret1 = _mm256_add_epi32(sc, dc);
+    __m256i ret2 = _mm256_slli_epi32(SkDiv255Round_AVX2(tmp), 1);
+    __m256i ret = _mm256_sub_epi32(ret1, ret2);
+
+    ret = clamp_signed_byte_AVX2(ret);
+    return ret;
+}
+
+static __m256i difference_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+
+    __m256i a = srcover_byte_AVX2(sa, da);
+    __m256i r = difference_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                     SkGetPackedR32_AVX2(dst), sa, da);
+    __m256i g = difference_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                     SkGetPackedG32_AVX2(dst), sa, da);
+    __m256i b = difference_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                     SkGetPackedB32_AVX2(dst), sa, da);
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i exclusion_byte_AVX2(const __m256i& sc, const __m256i& dc) {
+    __m256i tmp1 = _mm256_mullo_epi16(_mm256_set1_epi32(255), sc);  // 255 * sc
+    __m256i tmp2 = _mm256_mullo_epi16(_mm256_set1_epi32(255), dc);  // 255 * dc
+    tmp1 = _mm256_add_epi32(tmp1, tmp2);
+    tmp2 = _mm256_mullo_epi16(sc, dc);                              // sc * dc
+    tmp2 = _mm256_slli_epi32(tmp2, 1);                              // 2 * sc * dc
+
+    __m256i r = _mm256_sub_epi32(tmp1, tmp2);
+    return clamp_div255round_AVX2(r);
+}
+
+static __m256i exclusion_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i sa = SkGetPackedA32_AVX2(src);
+    __m256i da = SkGetPackedA32_AVX2(dst);
+
+    __m256i a = srcover_byte_AVX2(sa, da);
+    __m256i r = exclusion_byte_AVX2(SkGetPackedR32_AVX2(src), SkGetPackedR32_AVX2(dst));
+    __m256i g = exclusion_byte_AVX2(SkGetPackedG32_AVX2(src), SkGetPackedG32_AVX2(dst));
+    __m256i b = exclusion_byte_AVX2(SkGetPackedB32_AVX2(src), SkGetPackedB32_AVX2(dst));
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef __m256i (*SkXfermodeProcAVX2)(const __m256i& src, const __m256i& dst);
+
+// Expands 8 coverage bytes to 32-bit lanes.
+static inline __m256i load_coverage_AVX2(const SkAlpha aa[]) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(aa)));
+}
+
+// Same as alpha_blend_16_SSE2() in SkXfermode_opts_SSE2.cpp: SkAlphaBlend(src, dst, scale)
+// for 8-bit channels in 16-bit lanes.
+static inline __m256i alpha_blend_16_AVX2(const __m256i& src, const __m256i& dst,
+                                          const __m256i& scale) {
+    __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(src, scale),
+                                   _mm256_mullo_epi16(dst, _mm256_sub_epi16(
+                                                      _mm256_set1_epi16(256), scale)));
+    return _mm256_srli_epi16(sum, 8);
+}
+
+// Same as coverage_interp_SSE2() in SkXfermode_opts_SSE2.cpp for 8 pixels. The unpacks
+// work within each 128-bit lane, which holds 4 pixels and their coverage alike.
+static inline __m256i coverage_interp_AVX2(const __m256i& src, const __m256i& dst,
+                                           const __m256i& cov) {
+    const __m256i zero = _mm256_setzero_si256();
+    // The scale of each pixel, in all 4 of its 16-bit channels.
+    __m256i scale = SkAlpha255To256_AVX2(cov);
+    scale = _mm256_or_si256(scale, _mm256_slli_epi32(scale, 16));
+    __m256i scaleLo = _mm256_unpacklo_epi32(scale, scale);
+    __m256i scaleHi = _mm256_unpackhi_epi32(scale, scale);
+
+    __m256i lo = alpha_blend_16_AVX2(_mm256_unpacklo_epi8(src, zero),
+                                     _mm256_unpacklo_epi8(dst, zero), scaleLo);
+    __m256i hi = alpha_blend_16_AVX2(_mm256_unpackhi_epi8(src, zero),
+                                     _mm256_unpackhi_epi8(dst, zero), scaleHi);
+    __m256i result = _mm256_packus_epi16(lo, hi);
+
+    __m256i uncovered = _mm256_cmpeq_epi32(cov, zero);
+    return _mm256_or_si256(_mm256_and_si256(uncovered, dst),
+                           _mm256_andnot_si256(uncovered, result));
+}
+
+void SkAVX2ProcCoeffXfermode::xfer32(SkPMColor dst[], const SkPMColor src[],
+                                     int count, const SkAlpha aa[]) const {
+    SkASSERT(dst && src && count >= 0);
+
+    SkXfermodeProcAVX2 procAVX2 = reinterpret_cast<SkXfermodeProcAVX2>(fProcAVX2);
+    SkASSERT(procAVX2 != NULL);
+
+    while (count >= 8) {
+        __m256i src_pixel = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        __m256i dst_pixel = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst));
+
+        __m256i res = procAVX2(src_pixel, dst_pixel);
+        if (NULL != aa) {
+            res = coverage_interp_AVX2(res, dst_pixel, load_coverage_AVX2(aa));
+            aa += 8;
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), res);
+
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+
+    if (count > 0) {
+        this->INHERITED::xfer32(dst, src, count, aa);
+    }
+}
+
+void SkAVX2ProcCoeffXfermode::xferA8(SkAlpha dst[], const SkPMColor src[],
+                                     int count, const SkAlpha aa[]) const {
+    SkASSERT(dst && src && count >= 0);
+
+    SkXfermodeProcAVX2 procAVX2 = reinterpret_cast<SkXfermodeProcAVX2>(fProcAVX2);
+    SkASSERT(procAVX2 != NULL);
+
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i src_pixel = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        // The destination alphas, as pixels with no color.
+        __m256i dstA = load_coverage_AVX2(dst + i);
+        __m256i A = SkGetPackedA32_AVX2(procAVX2(src_pixel,
+                                                 _mm256_slli_epi32(dstA, SK_A32_SHIFT)));
+        if (NULL != aa) {
+            __m256i cov = load_coverage_AVX2(aa + i);
+            // Same as SkAlphaBlend(A, dstA, SkAlpha255To256(cov)), as xferA8() does it in
+            // SkXfermode_opts_SSE2.cpp.
+            __m256i scale = SkAlpha255To256_AVX2(cov);
+            __m256i blend = _mm256_add_epi32(_mm256_mullo_epi16(A, scale),
+                                             _mm256_mullo_epi16(dstA, _mm256_sub_epi32(
+                                                                _mm256_set1_epi32(256), scale)));
+            blend = _mm256_srli_epi32(blend, 8);
+            __m256i uncovered = _mm256_cmpeq_epi32(cov, zero);
+            A = _mm256_or_si256(_mm256_and_si256(uncovered, dstA),
+                                _mm256_andnot_si256(uncovered, blend));
+        }
+        // Each 128-bit lane packs its 4 alphas into its low 4 bytes.
+        A = _mm256_packus_epi16(_mm256_packs_epi32(A, zero), zero);
+        uint32_t packed[2] = {
+            static_cast<uint32_t>(_mm_cvtsi128_si32(_mm256_castsi256_si128(A))),
+            static_cast<uint32_t>(_mm_cvtsi128_si32(_mm256_extracti128_si256(A, 1))),
+        };
+        memcpy(dst + i, packed, 8);
+    }
+
+    if (i < count) {
+        this->INHERITED::xferA8(dst + i, src + i, count - i, NULL == aa ? NULL : aa + i);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// 8 pixels modeprocs with AVX2
+static const SkXfermodeProcAVX2 gAVX2XfermodeProcs[] = {
+    NULL, // kClear_Mode
+    NULL, // kSrc_Mode
+    NULL, // kDst_Mode
+    srcover_modeproc_AVX2,
+    dstover_modeproc_AVX2,
+    srcin_modeproc_AVX2,
+    dstin_modeproc_AVX2,
+    srcout_modeproc_AVX2,
+    dstout_modeproc_AVX2,
+    srcatop_modeproc_AVX2,
+    dstatop_modeproc_AVX2,
+    xor_modeproc_AVX2,
+    plus_modeproc_AVX2,
+    modulate_modeproc_AVX2,
+    screen_modeproc_AVX2,
+
+    overlay_modeproc_AVX2,
+    darken_modeproc_AVX2,
+    lighten_modeproc_AVX2,
+    colordodge_modeproc_AVX2,
+    colorburn_modeproc_AVX2,
+    hardlight_modeproc_AVX2,
+    softlight_modeproc_AVX2,
+    difference_modeproc_AVX2,
+    exclusion_modeproc_AVX2,
+    multiply_modeproc_AVX2,
+
+    NULL, // kHue_Mode
+    NULL, // kSaturation_Mode
+    NULL, // kColor_Mode
+    NULL, // kLuminosity_Mode
+};
+
+typedef __m128i (*SkXfermodeProcSIMD)(const __m128i& src, const __m128i& dst);
+
+extern SkXfermodeProcSIMD gSSE2XfermodeProcs[];
+
+SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_AVX2(const ProcCoeff& rec,
+                                                         SkXfermode::Mode mode) {
+    void* procSSE2 = reinterpret_cast<void*>(gSSE2XfermodeProcs[mode]);
+    void* procAVX2 = reinterpret_cast<void*>(gAVX2XfermodeProcs[mode]);
+
+    if (procSSE2 != NULL && procAVX2 != NULL) {
+        return SkNEW_ARGS(SkAVX2ProcCoeffXfermode, (rec, mode, procSSE2, procAVX2));
+    }
+    return NULL;
+}
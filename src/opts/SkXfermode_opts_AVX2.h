@@ -0,0 +1,35 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkXfermode_opts_AVX2_DEFINED
+#define SkXfermode_opts_AVX2_DEFINED
+
+#include "SkXfermode_opts_SSE2.h"
+
+// Blends 8 pixels at a time in xfer32 and xferA8, and hands what is left, and xfer16, to
+// SkSSE2ProcCoeffXfermode. It flattens as, and so reads back as, an SkSSE2ProcCoeffXfermode,
+// which any x86 reader can run.
+class SkAVX2ProcCoeffXfermode : public SkSSE2ProcCoeffXfermode {
+public:
+    SkAVX2ProcCoeffXfermode(const ProcCoeff& rec, SkXfermode::Mode mode,
+                            void* procSSE2, void* procAVX2)
+        : INHERITED(rec, mode, procSSE2), fProcAVX2(procAVX2) {}
+
+    virtual void xfer32(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]) const SK_OVERRIDE;
+    virtual void xferA8(SkAlpha dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]) const SK_OVERRIDE;
+
+private:
+    void* fProcAVX2;
+    typedef SkSSE2ProcCoeffXfermode INHERITED;
+};
+
+SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_AVX2(const ProcCoeff& rec,
+                                                         SkXfermode::Mode mode);
+
+#endif // SkXfermode_opts_AVX2_DEFINED
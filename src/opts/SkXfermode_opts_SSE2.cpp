@@ -641,6 +641,47 @@ typedef __m128i (*SkXfermodeProcSIMD)(const __m128i& src, const __m128i& dst);
 
 extern SkXfermodeProcSIMD gSSE2XfermodeProcs[];
 
+// Expands 4 coverage bytes to 32-bit lanes.
+static inline __m128i load_coverage_SSE2(const SkAlpha aa[]) {
+    uint32_t packed;
+    memcpy(&packed, aa, 4);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i cov = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+    return _mm_unpacklo_epi16(cov, zero);
+}
+
+// Same as SkAlphaBlend(src, dst, scale) for 8-bit channels in 16-bit lanes. Since dst * 256
+// is a multiple of 256, dst + ((src - dst) * scale >> 8) is
+// (src * scale + dst * (256 - scale)) >> 8, which stays unsigned and fits 16 bits.
+static inline __m128i alpha_blend_16_SSE2(const __m128i& src, const __m128i& dst,
+                                          const __m128i& scale) {
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(src, scale),
+                                _mm_mullo_epi16(dst, _mm_sub_epi16(_mm_set1_epi16(256),
+                                                                   scale)));
+    return _mm_srli_epi16(sum, 8);
+}
+
+// Same as SkFourByteInterp(src, dst, cov) for each of 4 pixels, except that pixels with no
+// coverage keep dst exactly, as the scalar loops do by skipping them.
+static inline __m128i coverage_interp_SSE2(const __m128i& src, const __m128i& dst,
+                                           const __m128i& cov) {
+    const __m128i zero = _mm_setzero_si128();
+    // The scale of each pixel, in all 4 of its 16-bit channels.
+    __m128i scale = SkAlpha255To256_SSE2(cov);
+    scale = _mm_or_si128(scale, _mm_slli_epi32(scale, 16));
+    __m128i scaleLo = _mm_unpacklo_epi32(scale, scale);
+    __m128i scaleHi = _mm_unpackhi_epi32(scale, scale);
+
+    __m128i lo = alpha_blend_16_SSE2(_mm_unpacklo_epi8(src, zero),
+                                     _mm_unpacklo_epi8(dst, zero), scaleLo);
+    __m128i hi = alpha_blend_16_SSE2(_mm_unpackhi_epi8(src, zero),
+                                     _mm_unpackhi_epi8(dst, zero), scaleHi);
+    __m128i result = _mm_packus_epi16(lo, hi);
+
+    __m128i uncovered = _mm_cmpeq_epi32(cov, zero);
+    return _mm_or_si128(_mm_and_si128(uncovered, dst), _mm_andnot_si128(uncovered, result));
+}
+
 SkSSE2ProcCoeffXfermode::SkSSE2ProcCoeffXfermode(SkReadBuffer& buffer)
     : INHERITED(buffer) {
     fProcSIMD = reinterpret_cast<void*>(gSSE2XfermodeProcs[this->getMode()]);
@@ -686,6 +727,20 @@ void SkSSE2ProcCoeffXfermode::xfer32(SkPMColor dst[], const SkPMColor src[],
             src++;
         }
     } else {
+        while (count >= 4) {
+            __m128i src_pixel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            __m128i dst_pixel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+
+            __m128i res = procSIMD(src_pixel, dst_pixel);
+            res = coverage_interp_SSE2(res, dst_pixel, load_coverage_SSE2(aa));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), res);
+
+            src += 4;
+            dst += 4;
+            aa += 4;
+            count -= 4;
+        }
+
         for (int i = count - 1; i >= 0; --i) {
             unsigned a = aa[i];
             if (0 != a) {
@@ -765,6 +820,43 @@ void SkSSE2ProcCoeffXfermode::xfer16(uint16_t dst[], const SkPMColor src[],
     }
 }
 
+void SkSSE2ProcCoeffXfermode::xferA8(SkAlpha dst[], const SkPMColor src[],
+                                     int count, const SkAlpha aa[]) const {
+    SkASSERT(dst && src && count >= 0);
+
+    SkXfermodeProcSIMD procSIMD = reinterpret_cast<SkXfermodeProcSIMD>(fProcSIMD);
+    SkASSERT(procSIMD != NULL);
+
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i src_pixel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // The destination alphas, as pixels with no color.
+        __m128i dstA = load_coverage_SSE2(dst + i);
+        __m128i A = SkGetPackedA32_SSE2(procSIMD(src_pixel,
+                                                 _mm_slli_epi32(dstA, SK_A32_SHIFT)));
+        if (NULL != aa) {
+            __m128i cov = load_coverage_SSE2(aa + i);
+            // Same as SkAlphaBlend(A, dstA, SkAlpha255To256(cov)), done as in
+            // alpha_blend_16_SSE2(). The products fit in the low halves of the lanes.
+            __m128i scale = SkAlpha255To256_SSE2(cov);
+            __m128i blend = _mm_add_epi32(_mm_mullo_epi16(A, scale),
+                                          _mm_mullo_epi16(dstA, _mm_sub_epi32(
+                                                          _mm_set1_epi32(256), scale)));
+            blend = _mm_srli_epi32(blend, 8);
+            __m128i uncovered = _mm_cmpeq_epi32(cov, zero);
+            A = _mm_or_si128(_mm_and_si128(uncovered, dstA), _mm_andnot_si128(uncovered, blend));
+        }
+        A = _mm_packus_epi16(_mm_packs_epi32(A, zero), zero);
+        uint32_t packed = _mm_cvtsi128_si32(A);
+        memcpy(dst + i, &packed, 4);
+    }
+
+    if (i < count) {
+        this->INHERITED::xferA8(dst + i, src + i, count - i, NULL == aa ? NULL : aa + i);
+    }
+}
+
 #ifndef SK_IGNORE_TO_STRING
 void SkSSE2ProcCoeffXfermode::toString(SkString* str) const {
     this->INHERITED::toString(str);
@@ -6,22 +6,41 @@
  */
 
 #include "SkBitmapFilter_opts_SSE2.h"
+#include "SkBitmapHasher_opts_SSE42.h"
 #include "SkBitmapProcState_opts_SSE2.h"
 #include "SkBitmapProcState_opts_SSSE3.h"
 #include "SkBlitMask.h"
 #include "SkBlitRect_opts_SSE2.h"
 #include "SkBlitRow.h"
+#include "SkBlitRow_opts_AVX2.h"
 #include "SkBlitRow_opts_SSE2.h"
 #include "SkBlurImage_opts_SSE2.h"
+#include "SkChecksum_opts.h"
+#include "SkChecksum_opts_SSE42.h"
+#include "SkConfig8888_opts.h"
+#include "SkConfig8888_opts_SSE2.h"
+#include "SkDisplacementMap_opts.h"
+#include "SkDisplacementMap_opts_AVX2.h"
+#include "SkDisplacementMap_opts_SSE2.h"
+#include "SkLCDFilter_opts.h"
+#include "SkLCDFilter_opts_SSE2.h"
+#include "SkLighting_opts.h"
+#include "SkLighting_opts_SSE2.h"
+#include "SkMatrixConvolution_opts.h"
+#include "SkMatrixConvolution_opts_SSE2.h"
+#include "SkMipMap_opts.h"
+#include "SkMipMap_opts_SSE2.h"
 #include "SkMorphology_opts.h"
 #include "SkMorphology_opts_SSE2.h"
 #include "SkRTConf.h"
+#include "SkScaledBitmapSampler_opts.h"
+#include "SkScaledBitmapSampler_opts_SSSE3.h"
 #include "SkUtils.h"
 #include "SkUtils_opts_SSE2.h"
 #include "SkXfermode.h"
 #include "SkXfermode_proccoeff.h"
 
-#if defined(_MSC_VER) && defined(_WIN64)
+#if defined(_MSC_VER)
 #include <intrin.h>
 #endif
 
@@ -34,12 +53,13 @@
 
 /* Function to get the CPU SSE-level in runtime, for different compilers. */
 #ifdef _MSC_VER
-static inline void getcpuid(int info_type, int info[4]) {
+static inline void getcpuid(int info_type, int info[4], int sub_type = 0) {
 #if defined(_WIN64)
-    __cpuid(info, info_type);
+    __cpuidex(info, info_type, sub_type);
 #else
     __asm {
         mov    eax, [info_type]
+        mov    ecx, [sub_type]
         cpuid
         mov    edi, [info]
         mov    [edi], eax
@@ -50,15 +70,15 @@ static inline void getcpuid(int info_type, int info[4]) {
 #endif
 }
 #elif defined(__x86_64__)
-static inline void getcpuid(int info_type, int info[4]) {
+static inline void getcpuid(int info_type, int info[4], int sub_type = 0) {
     asm volatile (
         "cpuid \n\t"
         : "=a"(info[0]), "=b"(info[1]), "=c"(info[2]), "=d"(info[3])
-        : "a"(info_type)
+        : "a"(info_type), "c"(sub_type)
     );
 }
 #else
-static inline void getcpuid(int info_type, int info[4]) {
+static inline void getcpuid(int info_type, int info[4], int sub_type = 0) {
     // We save and restore ebx, so this code can be compatible with -fPIC
     asm volatile (
         "pushl %%ebx      \n\t"
@@ -66,11 +86,31 @@ static inline void getcpuid(int info_type, int info[4]) {
         "movl %%ebx, %1   \n\t"
         "popl %%ebx       \n\t"
         : "=a"(info[0]), "=r"(info[1]), "=c"(info[2]), "=d"(info[3])
-        : "a"(info_type)
+        : "a"(info_type), "2"(sub_type)
     );
 }
 #endif
 
+/* Read the low word of an extended control register (XCR0 tells us which
+   register state the OS saves on a context switch). Only call this after
+   checking the OSXSAVE bit from cpuid. */
+#ifdef _MSC_VER
+static inline uint32_t getxcr(uint32_t xcr) {
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219
+    return (uint32_t)_xgetbv(xcr);
+#else
+    return 0;   // Too old to know about AVX; treat the OS as not saving it.
+#endif
+}
+#else
+static inline uint32_t getxcr(uint32_t xcr) {
+    uint32_t eax, edx;
+    // xgetbv, spelled out for assemblers that predate it.
+    asm volatile (".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(xcr));
+    return eax;
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 
 /* Fetch the SIMD level directly from the CPU, at run-time.
@@ -80,6 +120,20 @@ static int get_SIMD_level() {
     int cpu_info[4] = { 0 };
 
     getcpuid(1, cpu_info);
+    // AVX2 needs the CPU bit (leaf 7, ebx bit 5), plus AVX (ecx bit 28) and
+    // OSXSAVE (ecx bit 27) so that we can ask whether the OS saves the XMM and
+    // YMM registers for us (XCR0 bits 1 and 2).
+    const int kOSXSAVE_AVX = (1<<27) | (1<<28);
+    if ((cpu_info[2] & kOSXSAVE_AVX) == kOSXSAVE_AVX && (getxcr(0) & 0x6) == 0x6) {
+        int ext_info[4] = { 0 };
+        getcpuid(0, ext_info);
+        if (ext_info[0] >= 7) {
+            getcpuid(7, ext_info, 0);
+            if ((ext_info[1] & (1<<5)) != 0) {
+                return SK_CPU_SSE_LEVEL_AVX2;
+            }
+        }
+    }
     if ((cpu_info[2] & (1<<20)) != 0) {
         return SK_CPU_SSE_LEVEL_SSE42;
     } else if ((cpu_info[2] & (1<<9)) != 0) {
@@ -148,6 +202,8 @@ void SkBitmapProcState::platformProcs() {
     } else if (fSampleProc32 == S32_opaque_D32_filter_DXDY) {
         if (supports_simd(SK_CPU_SSE_LEVEL_SSSE3)) {
             fSampleProc32 = S32_opaque_D32_filter_DXDY_SSSE3;
+        } else {
+            fSampleProc32 = S32_opaque_D32_filter_DXDY_SSE2;
         }
     } else if (fSampleProc32 == S32_alpha_D32_filter_DX) {
         if (supports_simd(SK_CPU_SSE_LEVEL_SSSE3)) {
@@ -158,6 +214,8 @@ void SkBitmapProcState::platformProcs() {
     } else if (fSampleProc32 == S32_alpha_D32_filter_DXDY) {
         if (supports_simd(SK_CPU_SSE_LEVEL_SSSE3)) {
             fSampleProc32 = S32_alpha_D32_filter_DXDY_SSSE3;
+        } else {
+            fSampleProc32 = S32_alpha_D32_filter_DXDY_SSE2;
         }
     }
 
@@ -175,6 +233,14 @@ void SkBitmapProcState::platformProcs() {
         fMatrixProc = ClampX_ClampY_filter_affine_SSE2;
     } else if (fMatrixProc == ClampX_ClampY_nofilter_affine) {
         fMatrixProc = ClampX_ClampY_nofilter_affine_SSE2;
+    } else if (fMatrixProc == ClampX_ClampY_filter_persp) {
+        fMatrixProc = ClampX_ClampY_filter_persp_SSE2;
+    } else if (fMatrixProc == ClampX_ClampY_nofilter_persp) {
+        fMatrixProc = ClampX_ClampY_nofilter_persp_SSE2;
+    } else if (fMatrixProc == RepeatX_RepeatY_filter_scale) {
+        fMatrixProc = RepeatX_RepeatY_filter_scale_SSE2;
+    } else if (fMatrixProc == RepeatX_RepeatY_nofilter_scale) {
+        fMatrixProc = RepeatX_RepeatY_nofilter_scale_SSE2;
     }
 
     /* Check fShaderProc32 */
@@ -189,13 +255,13 @@ void SkBitmapProcState::platformProcs() {
 
 static SkBlitRow::Proc platform_16_procs[] = {
     S32_D565_Opaque_SSE2,               // S32_D565_Opaque
-    NULL,                               // S32_D565_Blend
+    S32_D565_Blend_SSE2,                // S32_D565_Blend
     S32A_D565_Opaque_SSE2,              // S32A_D565_Opaque
-    NULL,                               // S32A_D565_Blend
+    S32A_D565_Blend_SSE2,               // S32A_D565_Blend
     S32_D565_Opaque_Dither_SSE2,        // S32_D565_Opaque_Dither
-    NULL,                               // S32_D565_Blend_Dither
+    S32_D565_Blend_Dither_SSE2,         // S32_D565_Blend_Dither
     S32A_D565_Opaque_Dither_SSE2,       // S32A_D565_Opaque_Dither
-    NULL,                               // S32A_D565_Blend_Dither
+    S32A_D565_Blend_Dither_SSE2,        // S32A_D565_Blend_Dither
 };
 
 SkBlitRow::Proc SkBlitRow::PlatformProcs565(unsigned flags) {
@@ -213,8 +279,17 @@ static SkBlitRow::Proc32 platform_32_procs[] = {
     S32A_Blend_BlitRow32_SSE2,          // S32A_Blend,
 };
 
+static SkBlitRow::Proc32 platform_32_procs_AVX2[] = {
+    NULL,                               // S32_Opaque,
+    S32_Blend_BlitRow32_AVX2,           // S32_Blend,
+    S32A_Opaque_BlitRow32_AVX2,         // S32A_Opaque
+    S32A_Blend_BlitRow32_AVX2,          // S32A_Blend,
+};
+
 SkBlitRow::Proc32 SkBlitRow::PlatformProcs32(unsigned flags) {
-    if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
+    if (supports_simd(SK_CPU_SSE_LEVEL_AVX2)) {
+        return platform_32_procs_AVX2[flags];
+    } else if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
         return platform_32_procs[flags];
     } else {
         return NULL;
@@ -222,7 +297,9 @@ SkBlitRow::Proc32 SkBlitRow::PlatformProcs32(unsigned flags) {
 }
 
 SkBlitRow::ColorProc SkBlitRow::PlatformColorProc() {
-    if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
+    if (supports_simd(SK_CPU_SSE_LEVEL_AVX2)) {
+        return Color32_AVX2;
+    } else if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
         return Color32_SSE2;
     } else {
         return NULL;
@@ -255,9 +332,9 @@ SkBlitMask::ColorProc SkBlitMask::PlatformColorProcs(SkColorType dstCT,
     if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
         switch (dstCT) {
             case kN32_SkColorType:
-                // The SSE2 version is not (yet) faster for black, so we check
-                // for that.
-                if (SK_ColorBLACK != color) {
+                if (SK_ColorBLACK == color) {
+                    proc = SkARGB32_A8_BlitMask_Black_SSE2;
+                } else {
                     proc = SkARGB32_A8_BlitMask_SSE2;
                 }
                 break;
@@ -333,6 +410,42 @@ SkMorphologyImageFilter::Proc SkMorphologyGetPlatformProc(SkMorphologyProcType t
 
 ////////////////////////////////////////////////////////////////////////////////
 
+SkLightingProc SkLightingGetPlatformProc(SkLightingProcType type) {
+    if (!supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
+        return NULL;
+    }
+    switch (type) {
+        case kDiffuseDistant_SkLightingProcType:
+            return SkDiffuseDistant_SSE2;
+        case kDiffusePoint_SkLightingProcType:
+            return SkDiffusePoint_SSE2;
+        case kSpecularDistant_SkLightingProcType:
+            return SkSpecularDistant_SSE2;
+        case kSpecularPoint_SkLightingProcType:
+            return SkSpecularPoint_SSE2;
+        default:
+            return NULL;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SkSampleRowProc SkSampleRowGetPlatformProc(SkSampleRowProcType type) {
+    if (!supports_simd(SK_CPU_SSE_LEVEL_SSSE3)) {
+        return NULL;
+    }
+    switch (type) {
+        case kRGBx_D8888_SkSampleRowProcType:
+            return Sample_RGBx_D8888_SSSE3;
+        case kRGBA_D8888_SkSampleRowProcType:
+            return Sample_RGBA_D8888_SSSE3;
+        default:
+            return NULL;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 bool SkBoxBlurGetPlatformProcs(SkBoxBlurProc* boxBlurX,
                                SkBoxBlurProc* boxBlurY,
                                SkBoxBlurProc* boxBlurXY,
@@ -349,9 +462,78 @@ bool SkBoxBlurGetPlatformProcs(SkBoxBlurProc* boxBlurX,
 
 ////////////////////////////////////////////////////////////////////////////////
 
+SkDisplacementProc SkDisplacementGetPlatformProc() {
+    if (supports_simd(SK_CPU_SSE_LEVEL_AVX2)) {
+        return SkDisplace_AVX2;
+    }
+    if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
+        return SkDisplace_SSE2;
+    }
+    return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool SkLCDFilterGetPlatformProcs(SkLCDFilterRowProc* filterRow, SkLCDPackRowProc* packRow) {
+    if (!supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
+        return false;
+    }
+    return SkLCDFilterGetPlatformProcs_SSE2(filterRow, packRow);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool SkMatrixConvolutionGetPlatformProcs(SkConvolvePixelsProc* convolvePixels,
+                                         SkSumRowsProc* sumRows) {
+    if (!supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
+        return false;
+    }
+    return SkMatrixConvolutionGetPlatformProcs_SSE2(convolvePixels, sumRows);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SkChecksumHashProc SkChecksumGetPlatformHashProc() {
+    if (supports_simd(SK_CPU_SSE_LEVEL_SSE42)) {
+        return SkChecksumHash_SSE42;
+    }
+    return NULL;
+}
+
+SkBitmapHasherHashProc SkBitmapHasherGetPlatformHashProc() {
+    if (supports_simd(SK_CPU_SSE_LEVEL_SSE42)) {
+        return SkBitmapHasherHash_SSE42;
+    }
+    return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SkMipMapDownsample32Proc SkMipMapGetPlatformDownsample32Proc() {
+    if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
+        return SkMipMapDownsample32_SSE2;
+    }
+    return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool SkConvert8888GetPlatformProcs(SkConvert8888Procs* procs) {
+    if (!supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
+        return false;
+    }
+    SkConvert8888GetPlatformProcs_SSE2(procs);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 extern SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_SSE2(const ProcCoeff& rec,
                                                                 SkXfermode::Mode mode);
 
+extern SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_AVX2(const ProcCoeff& rec,
+                                                                SkXfermode::Mode mode);
+
 SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl(const ProcCoeff& rec,
                                                     SkXfermode::Mode mode);
 
@@ -365,6 +547,12 @@ SkProcCoeffXfermode* SkPlatformXfermodeFactory(const ProcCoeff& rec,
 
 SkProcCoeffXfermode* SkPlatformXfermodeFactory(const ProcCoeff& rec,
                                                SkXfermode::Mode mode) {
+    if (supports_simd(SK_CPU_SSE_LEVEL_AVX2)) {
+        SkProcCoeffXfermode* xfer = SkPlatformXfermodeFactory_impl_AVX2(rec, mode);
+        if (NULL != xfer) {
+            return xfer;
+        }
+    }
     if (supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
         return SkPlatformXfermodeFactory_impl_SSE2(rec, mode);
     } else {
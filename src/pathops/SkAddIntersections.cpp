@@ -6,6 +6,8 @@
  */
 #include "SkAddIntersections.h"
 #include "SkPathOpsBounds.h"
+#include "SkTDArray.h"
+#include "SkTSort.h"
 
 #if DEBUG_ADD_INTERSECTING_TS
 
@@ -174,6 +176,172 @@ static void debugShowCubicIntersection(int , const SkIntersectionHelper& ,
 }
 #endif
 
+// Buckets the segments of a contour by a uniform grid over its bounds, so that
+// a segment of another contour need only be tried against the segments in the
+// cells its bounds cover, rather than against all of them.
+class SkSegmentGrid {
+public:
+    // Returns false if the contour has too few segments, or bounds too
+    // degenerate, for a grid to help.
+    bool init(const SkOpContour& contour);
+
+    // Sets indices to the segments at or after firstIndex whose bounds may
+    // intersect bounds, in increasing order. These include every segment for
+    // which SkPathOpsBounds::Intersects() is true.
+    void find(const SkPathOpsBounds& bounds, int firstIndex, SkTDArray<int>* indices);
+
+private:
+    enum {
+        kMinSegments = 32,
+        kMaxCellsPerSegment = 16,
+        kMaxCellsPerSide = 1024
+    };
+
+    int column(SkScalar x) const {
+        SkScalar c = (x - fBounds.fLeft) * fInvCellWidth;
+        return c <= 0 ? 0 : c >= fColumns - 1 ? fColumns - 1 : SkScalarFloorToInt(c);
+    }
+
+    int row(SkScalar y) const {
+        SkScalar r = (y - fBounds.fTop) * fInvCellHeight;
+        return r <= 0 ? 0 : r >= fRows - 1 ? fRows - 1 : SkScalarFloorToInt(r);
+    }
+
+    void cells(const SkRect& bounds, SkIRect* cells) const {
+        cells->set(this->column(bounds.fLeft), this->row(bounds.fTop),
+                   this->column(bounds.fRight) + 1, this->row(bounds.fBottom) + 1);
+    }
+
+    const SkOpArray<SkOpSegment>* fSegments;
+    SkPathOpsBounds fBounds;
+    SkScalar fInvCellWidth;
+    SkScalar fInvCellHeight;
+    int fColumns;
+    int fRows;
+    SkTDArray<int> fCellStarts;  // cell i holds fCellSegments[fCellStarts[i]..fCellStarts[i + 1])
+    SkTDArray<int> fCellSegments;
+    SkTDArray<int> fLargeSegments;  // segments that would cover too many cells
+    SkTDArray<int> fFound;  // the last query that found each segment
+    int fQuery;
+};
+
+// Returns the number of cells along a side of length, for cellsAlong of them.
+static int cells_along(SkScalar length, SkScalar cellsAlong, int maxCells) {
+    if (!(length > 0)) {
+        return 1;
+    }
+    return cellsAlong >= maxCells ? maxCells : SkTMax(1, SkScalarCeilToInt(cellsAlong));
+}
+
+bool SkSegmentGrid::init(const SkOpContour& contour) {
+    fSegments = &contour.segments();
+    int count = fSegments->count();
+    fBounds = contour.bounds();
+    if (count < kMinSegments || !fBounds.isFinite()) {
+        return false;
+    }
+    SkScalar width = fBounds.width();
+    SkScalar height = fBounds.height();
+    if (!(width > 0) && !(height > 0)) {
+        return false;
+    }
+    // About one cell per segment, as square as the bounds allow.
+    int maxCells = SkTMin<int>(count, kMaxCellsPerSide);
+    SkScalar columns = width > 0 && height > 0 ? SkScalarSqrt(count * (width / height))
+                                               : SkIntToScalar(count);
+    fColumns = cells_along(width, columns, maxCells);
+    fRows = cells_along(height, SkIntToScalar(count / fColumns), maxCells);
+    fInvCellWidth = width > 0 ? fColumns / width : 0;
+    fInvCellHeight = height > 0 ? fRows / height : 0;
+
+    int cellCount = fColumns * fRows;
+    fCellStarts.setCount(cellCount + 1);
+    sk_bzero(fCellStarts.begin(), fCellStarts.count() * sizeof(int));
+    fLargeSegments.rewind();
+    SkIRect range;
+    for (int index = 0; index < count; ++index) {
+        const SkPathOpsBounds& bounds = (*fSegments)[index].bounds();
+        if (!bounds.isFinite()) {
+            return false;
+        }
+        this->cells(bounds, &range);
+        if (range.width() * range.height() > kMaxCellsPerSegment) {
+            *fLargeSegments.append() = index;
+            continue;
+        }
+        for (int y = range.fTop; y < range.fBottom; ++y) {
+            for (int x = range.fLeft; x < range.fRight; ++x) {
+                ++fCellStarts[y * fColumns + x + 1];
+            }
+        }
+    }
+    for (int cell = 0; cell < cellCount; ++cell) {
+        fCellStarts[cell + 1] += fCellStarts[cell];
+    }
+    fCellSegments.setCount(fCellStarts[cellCount]);
+    SkTDArray<int> fill;
+    fill.append(cellCount, fCellStarts.begin());
+    for (int index = 0, large = 0; index < count; ++index) {
+        if (large < fLargeSegments.count() && fLargeSegments[large] == index) {
+            ++large;
+            continue;
+        }
+        this->cells((*fSegments)[index].bounds(), &range);
+        for (int y = range.fTop; y < range.fBottom; ++y) {
+            for (int x = range.fLeft; x < range.fRight; ++x) {
+                fCellSegments[fill[y * fColumns + x]++] = index;
+            }
+        }
+    }
+    fFound.setCount(count);
+    sk_bzero(fFound.begin(), fFound.count() * sizeof(int));
+    fQuery = 0;
+    return true;
+}
+
+// How far SkPathOpsBounds::Intersects() may see past value: a few more ulps
+// than AlmostLessOrEqualUlps() allows, or its margin for denormalized values.
+static SkScalar intersects_margin(SkScalar value) {
+    return SkTMax(SkScalarAbs(value) * (SK_Scalar1 / (1 << 17)), FLT_EPSILON * 16);
+}
+
+void SkSegmentGrid::find(const SkPathOpsBounds& bounds, int firstIndex,
+                         SkTDArray<int>* indices) {
+    indices->rewind();
+    if (!bounds.isFinite()) {
+        return;
+    }
+    SkRect query = SkRect::MakeLTRB(bounds.fLeft - intersects_margin(bounds.fLeft),
+                                    bounds.fTop - intersects_margin(bounds.fTop),
+                                    bounds.fRight + intersects_margin(bounds.fRight),
+                                    bounds.fBottom + intersects_margin(bounds.fBottom));
+    ++fQuery;
+    SkIRect range;
+    this->cells(query, &range);
+    for (int y = range.fTop; y < range.fBottom; ++y) {
+        for (int x = range.fLeft; x < range.fRight; ++x) {
+            int cell = y * fColumns + x;
+            for (int entry = fCellStarts[cell]; entry < fCellStarts[cell + 1]; ++entry) {
+                int index = fCellSegments[entry];
+                if (index >= firstIndex && fFound[index] != fQuery) {
+                    fFound[index] = fQuery;
+                    *indices->append() = index;
+                }
+            }
+        }
+    }
+    for (int large = 0; large < fLargeSegments.count(); ++large) {
+        if (fLargeSegments[large] >= firstIndex) {
+            *indices->append() = fLargeSegments[large];
+        }
+    }
+    if (indices->count() > 1) {
+        SkTQSort<int>(indices->begin(), indices->end() - 1);
+    }
+}
+
+static const int kMinGridTestSegments = 8;
+
 bool AddIntersectTs(SkOpContour* test, SkOpContour* next) {
     if (test != next) {
         if (AlmostLessUlps(test->bounds().fBottom, next->bounds().fTop)) {
@@ -187,11 +355,25 @@ bool AddIntersectTs(SkOpContour* test, SkOpContour* next) {
     SkIntersectionHelper wt;
     wt.init(test);
     bool foundCommonContour = test == next;
+    // Between larger contours, try each segment of test against only the
+    // segments of next that the grid finds near it, in the same order as
+    // trying every segment would.
+    SkSegmentGrid grid;
+    bool useGrid = test->segments().count() >= kMinGridTestSegments && grid.init(*next);
+    SkTDArray<int> candidates;
     do {
         SkIntersectionHelper wn;
-        wn.init(next);
-        if (test == next && !wn.startAfter(wt)) {
-            continue;
+        if (useGrid) {
+            grid.find(wt.bounds(), test == next ? wt.index() + 1 : 0, &candidates);
+            if (candidates.isEmpty()) {
+                continue;
+            }
+            wn.init(next, candidates.begin(), candidates.count());
+        } else {
+            wn.init(next);
+            if (test == next && !wn.startAfter(wt)) {
+                continue;
+            }
         }
         do {
             if (!SkPathOpsBounds::Intersects(wt.bounds(), wn.bounds())) {
@@ -51,6 +51,13 @@ public:
     }
 
     bool advance() {
+        if (fCandidates) {
+            if (++fCandidate >= fCandidateCount) {
+                return false;
+            }
+            fIndex = fCandidates[fCandidate];
+            return true;
+        }
         return ++fIndex < fLast;
     }
 
@@ -62,10 +69,27 @@ public:
         return fContour->segments()[fIndex].bounds();
     }
 
+    int index() const {
+        return fIndex;
+    }
+
     void init(SkOpContour* contour) {
         fContour = contour;
         fIndex = 0;
         fLast = contour->segments().count();
+        fCandidates = NULL;
+    }
+
+    // Visits only the segments at candidates[0..count), which must be
+    // increasing, rather than every segment of the contour.
+    void init(SkOpContour* contour, const int* candidates, int count) {
+        SkASSERT(count > 0);
+        fContour = contour;
+        fIndex = candidates[0];
+        fLast = contour->segments().count();
+        fCandidates = candidates;
+        fCandidate = 0;
+        fCandidateCount = count;
     }
 
     bool isAdjacent(const SkIntersectionHelper& next) {
@@ -148,4 +172,7 @@ private:
     SkOpContour* fContour;
     int fIndex;
     int fLast;
+    const int* fCandidates;
+    int fCandidate;
+    int fCandidateCount;
 };
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#ifndef SkOpArray_DEFINED
+#define SkOpArray_DEFINED
+
+#include "SkChunkAlloc.h"
+#include "SkTypes.h"
+#include <new>
+
+/**
+ *  A growable array whose storage comes from the SkChunkAlloc that holds a path
+ *  operation's intermediate state. Growing copies the elements to a larger block
+ *  and leaves the old one to the allocator, so, as with SkTDArray, pointers to
+ *  elements are invalidated when the array grows. Elements are relocated with
+ *  memcpy and are never destroyed; everything is freed at once with the allocator.
+ */
+template <typename T>
+class SkOpArray {
+public:
+    SkOpArray()
+        : fArray(NULL)
+        , fCount(0)
+        , fReserve(0)
+        , fAllocator(NULL) {
+    }
+
+    explicit SkOpArray(SkChunkAlloc* allocator)
+        : fArray(NULL)
+        , fCount(0)
+        , fReserve(0)
+        , fAllocator(allocator) {
+    }
+
+    SkChunkAlloc* allocator() const { return fAllocator; }
+
+    void setAllocator(SkChunkAlloc* allocator) { fAllocator = allocator; }
+
+    int count() const { return fCount; }
+
+    T* begin() { return fArray; }
+    const T* begin() const { return fArray; }
+    T* end() { return fArray + fCount; }
+    const T* end() const { return fArray + fCount; }
+
+    T& operator[](int index) {
+        SkASSERT((unsigned) index < (unsigned) fCount);
+        return fArray[index];
+    }
+
+    const T& operator[](int index) const {
+        SkASSERT((unsigned) index < (unsigned) fCount);
+        return fArray[index];
+    }
+
+    T& front() { SkASSERT(fCount > 0); return fArray[0]; }
+    const T& front() const { SkASSERT(fCount > 0); return fArray[0]; }
+    T& back() { SkASSERT(fCount > 0); return fArray[fCount - 1]; }
+    const T& back() const { SkASSERT(fCount > 0); return fArray[fCount - 1]; }
+
+    /** Adds an uninitialized element to the end and returns it. */
+    T* append() {
+        return this->append_n(1);
+    }
+
+    /** Adds count uninitialized elements to the end and returns the first. */
+    T* append_n(int count) {
+        SkASSERT(count >= 0);
+        int oldCount = fCount;
+        this->growBy(count);
+        return fArray + oldCount;
+    }
+
+    /** Inserts an uninitialized element before index and returns it. */
+    T* insert(int index) {
+        SkASSERT((unsigned) index <= (unsigned) fCount);
+        int oldCount = fCount;
+        this->growBy(1);
+        T* elem = fArray + index;
+        memmove(elem + 1, elem, (oldCount - index) * sizeof(T));
+        return elem;
+    }
+
+    /** Adds a default constructed element to the end and returns it. */
+    T& push_back() {
+        return *SkNEW_PLACEMENT(this->append(), T);
+    }
+
+    void push_back(const T& elem) {
+        *this->append() = elem;
+    }
+
+    void push_back_n(int count, const T* elems) {
+        memcpy(this->append_n(count), elems, count * sizeof(T));
+    }
+
+    void pop_back() {
+        SkASSERT(fCount > 0);
+        --fCount;
+    }
+
+    /** Empties the array, keeping its storage for reuse. */
+    void reset() {
+        fCount = 0;
+    }
+
+    void setReserve(int reserve) {
+        if (reserve > fReserve) {
+            this->realloc(reserve);
+        }
+    }
+
+private:
+    void growBy(int extra) {
+        int count = fCount + extra;
+        if (count > fReserve) {
+            int space = count + 4;
+            this->realloc(space + space / 2);
+        }
+        fCount = count;
+    }
+
+    void realloc(int reserve) {
+        SkASSERT(fAllocator);
+        // Whole multiples of 8 bytes keep the doubles in spans aligned after other arrays.
+        T* array = static_cast<T*>(fAllocator->allocThrow(SkAlign8(reserve * sizeof(T))));
+        if (fCount) {
+            memcpy(array, fArray, fCount * sizeof(T));
+        }
+        fArray = array;
+        fReserve = reserve;
+    }
+
+    T* fArray;
+    int fCount;
+    int fReserve;
+    SkChunkAlloc* fAllocator;
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPathOps.h"
+
+void SkOpBuilder::add(const SkPath& path, SkPathOp op) {
+    if (0 == fOps.count() && op != kUnion_PathOp) {
+        fPathRefs.push_back() = SkPath();
+        *fOps.append() = kUnion_PathOp;
+    }
+    fPathRefs.push_back() = path;
+    *fOps.append() = op;
+}
+
+void SkOpBuilder::reset() {
+    fPathRefs.reset();
+    fOps.reset();
+}
+
+/* If every path is unioned and convex, the paths can all be turned to wind the
+   same way and simplified together: where they overlap their windings add up
+   rather than cancel. One Simplify() then finds every intersection at once,
+   instead of each Op() intersecting the next path with everything so far.
+ */
+bool SkOpBuilder::resolve(SkPath* result) {
+    int count = fOps.count();
+    bool allUnion = true;
+    bool haveDir = false;
+    SkPath::Direction firstDir = SkPath::kCW_Direction;
+    for (int index = 0; index < count; ++index) {
+        const SkPath& test = fPathRefs[index];
+        if (kUnion_PathOp != fOps[index] || test.isInverseFillType() || !test.isConvex()) {
+            allUnion = false;
+            break;
+        }
+        if (test.isEmpty()) {
+            continue;
+        }
+        SkPath::Direction dir;
+        if (!test.cheapComputeDirection(&dir)) {
+            allUnion = false;
+            break;
+        }
+        if (!haveDir) {
+            firstDir = dir;
+            haveDir = true;
+        }
+    }
+    if (!allUnion) {
+        SkPath sum = count ? fPathRefs[0] : SkPath();
+        for (int index = 1; index < count; ++index) {
+            if (!Op(sum, fPathRefs[index], fOps[index], &sum)) {
+                this->reset();
+                return false;
+            }
+        }
+        this->reset();
+        *result = sum;
+        return true;
+    }
+    SkPath sum;
+    for (int index = 0; index < count; ++index) {
+        const SkPath& path = fPathRefs[index];
+        SkPath::Direction dir;
+        if (path.isEmpty() || (path.cheapComputeDirection(&dir) && dir == firstDir)) {
+            sum.addPath(path);
+        } else {
+            sum.reverseAddPath(path);
+        }
+    }
+    this->reset();
+    return Simplify(sum, result);
+}
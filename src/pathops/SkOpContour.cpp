@@ -184,7 +184,7 @@ void SkOpContour::calcPartialCoincidentWinding() {
     }
 }
 
-void SkOpContour::joinCoincidence(const SkTArray<SkCoincidence, true>& coincidences, bool partial) {
+void SkOpContour::joinCoincidence(const SkOpArray<SkCoincidence>& coincidences, bool partial) {
     int count = coincidences.count();
 #if DEBUG_CONCIDENT
     if (count > 0) {
@@ -300,7 +300,7 @@ void SkOpContour::sortAngles() {
 
 void SkOpContour::sortSegments() {
     int segmentCount = fSegments.count();
-    fSortedSegments.push_back_n(segmentCount);
+    fSortedSegments.append_n(segmentCount);
     for (int test = 0; test < segmentCount; ++test) {
         fSortedSegments[test] = &fSegments[test];
     }
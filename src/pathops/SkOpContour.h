@@ -27,7 +27,8 @@ struct SkCoincidence {
 
 class SkOpContour {
 public:
-    SkOpContour() {
+    SkOpContour()
+        : fAllocator(NULL) {
         reset();
 #if defined(SK_DEBUG) || !FORCE_RELEASE
         fID = sk_atomic_inc(&SkPathOpsDebug::gContourID);
@@ -54,12 +55,12 @@ public:
     }
 
     void addCubic(const SkPoint pts[4]) {
-        fSegments.push_back().addCubic(pts, fOperand, fXor);
+        fSegments.push_back().addCubic(pts, fOperand, fXor, fAllocator);
         fContainsCurves = fContainsCubics = true;
     }
 
     int addLine(const SkPoint pts[2]) {
-        fSegments.push_back().addLine(pts, fOperand, fXor);
+        fSegments.push_back().addLine(pts, fOperand, fXor, fAllocator);
         return fSegments.count();
     }
 
@@ -71,7 +72,7 @@ public:
                        const SkIntersections& ts, int ptIndex, bool swap);
 
     int addQuad(const SkPoint pts[3]) {
-        fSegments.push_back().addQuad(pts, fOperand, fXor);
+        fSegments.push_back().addQuad(pts, fOperand, fXor, fAllocator);
         fContainsCurves = true;
         return fSegments.count();
     }
@@ -206,10 +207,24 @@ public:
         fContainsCurves = fContainsCubics = fContainsIntercepts = fDone = false;
     }
 
-    SkTArray<SkOpSegment>& segments() {
+    SkOpArray<SkOpSegment>& segments() {
         return fSegments;
     }
 
+    const SkOpArray<SkOpSegment>& segments() const {
+        return fSegments;
+    }
+
+    // The contour's segments, and their spans and angles, are allocated from allocator.
+    void setAllocator(SkChunkAlloc* allocator) {
+        fAllocator = allocator;
+        fSegments.setAllocator(allocator);
+        fSortedSegments.setAllocator(allocator);
+        fCoincidences.setAllocator(allocator);
+        fPartialCoincidences.setAllocator(allocator);
+        fCrosses.setAllocator(allocator);
+    }
+
     void setContainsIntercepts() {
         fContainsIntercepts = true;
     }
@@ -263,7 +278,7 @@ public:
     }
 
 #if DEBUG_TEST
-    SkTArray<SkOpSegment>& debugSegments() {
+    SkOpArray<SkOpSegment>& debugSegments() {
         return fSegments;
     }
 #endif
@@ -289,15 +304,16 @@ public:
 
 private:
     void calcCommonCoincidentWinding(const SkCoincidence& );
-    void joinCoincidence(const SkTArray<SkCoincidence, true>& , bool partial);
+    void joinCoincidence(const SkOpArray<SkCoincidence>& , bool partial);
     void setBounds();
 
-    SkTArray<SkOpSegment> fSegments;
-    SkTArray<SkOpSegment*, true> fSortedSegments;
+    SkChunkAlloc* fAllocator;
+    SkOpArray<SkOpSegment> fSegments;
+    SkOpArray<SkOpSegment*> fSortedSegments;
     int fFirstSorted;
-    SkTArray<SkCoincidence, true> fCoincidences;
-    SkTArray<SkCoincidence, true> fPartialCoincidences;
-    SkTArray<const SkOpContour*, true> fCrosses;
+    SkOpArray<SkCoincidence> fCoincidences;
+    SkOpArray<SkCoincidence> fPartialCoincidences;
+    SkOpArray<const SkOpContour*> fCrosses;
     SkPathOpsBounds fBounds;
     bool fContainsIntercepts;  // FIXME: is this used by anybody?
     bool fContainsCubics;
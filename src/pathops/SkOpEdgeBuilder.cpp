@@ -155,7 +155,8 @@ bool SkOpEdgeBuilder::walk() {
                     }
                 }
                 if (!fCurrentContour) {
-                    fCurrentContour = fContours.push_back_n(1);
+                    fCurrentContour = &fContours.push_back();
+                    fCurrentContour->setAllocator(fAllocator);
                     fCurrentContour->setOperand(fOperand);
                     fCurrentContour->setXor(fXorMask[fOperand] == kEvenOdd_PathOpsMask);
                 }
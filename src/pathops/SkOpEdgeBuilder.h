@@ -9,20 +9,26 @@
 
 #include "SkOpContour.h"
 #include "SkPathWriter.h"
-#include "SkTArray.h"
 
 class SkOpEdgeBuilder {
 public:
-    SkOpEdgeBuilder(const SkPathWriter& path, SkTArray<SkOpContour>& contours)
+    SkOpEdgeBuilder(const SkPathWriter& path, SkOpArray<SkOpContour>& contours,
+                    SkChunkAlloc* allocator)
         : fPath(path.nativePath())
+        , fPathPts(allocator)
+        , fPathVerbs(allocator)
         , fContours(contours)
+        , fAllocator(allocator)
         , fAllowOpenContours(true) {
         init();
     }
 
-    SkOpEdgeBuilder(const SkPath& path, SkTArray<SkOpContour>& contours)
+    SkOpEdgeBuilder(const SkPath& path, SkOpArray<SkOpContour>& contours, SkChunkAlloc* allocator)
         : fPath(&path)
+        , fPathPts(allocator)
+        , fPathVerbs(allocator)
         , fContours(contours)
+        , fAllocator(allocator)
         , fAllowOpenContours(false) {
         init();
     }
@@ -49,10 +55,11 @@ private:
     bool walk();
 
     const SkPath* fPath;
-    SkTArray<SkPoint, true> fPathPts;
-    SkTArray<uint8_t, true> fPathVerbs;
+    SkOpArray<SkPoint> fPathPts;
+    SkOpArray<uint8_t> fPathVerbs;
     SkOpContour* fCurrentContour;
-    SkTArray<SkOpContour>& fContours;
+    SkOpArray<SkOpContour>& fContours;
+    SkChunkAlloc* fAllocator;
     SkPathOpsMask fXorMask[2];
     int fSecondHalf;
     bool fOperand;
@@ -348,8 +348,9 @@ void SkOpSegment::addCoinOutsides(const SkPoint& startPt, const SkPoint& endPt,
     } while (endPt != nextPt);
 }
 
-void SkOpSegment::addCubic(const SkPoint pts[4], bool operand, bool evenOdd) {
-    init(pts, SkPath::kCubic_Verb, operand, evenOdd);
+void SkOpSegment::addCubic(const SkPoint pts[4], bool operand, bool evenOdd,
+        SkChunkAlloc* allocator) {
+    init(pts, SkPath::kCubic_Verb, operand, evenOdd, allocator);
     fBounds.setCubicBounds(pts);
 }
 
@@ -426,8 +427,9 @@ void SkOpSegment::setFromAngleIndex(int endIndex, int angleIndex) {
     } while (++endIndex < spanCount);
 }
 
-void SkOpSegment::addLine(const SkPoint pts[2], bool operand, bool evenOdd) {
-    init(pts, SkPath::kLine_Verb, operand, evenOdd);
+void SkOpSegment::addLine(const SkPoint pts[2], bool operand, bool evenOdd,
+        SkChunkAlloc* allocator) {
+    init(pts, SkPath::kLine_Verb, operand, evenOdd, allocator);
     fBounds.set(pts, 2);
 }
 
@@ -443,8 +445,9 @@ void SkOpSegment::addOtherT(int index, double otherT, int otherIndex) {
     span.fOtherIndex = otherIndex;
 }
 
-void SkOpSegment::addQuad(const SkPoint pts[3], bool operand, bool evenOdd) {
-    init(pts, SkPath::kQuad_Verb, operand, evenOdd);
+void SkOpSegment::addQuad(const SkPoint pts[3], bool operand, bool evenOdd,
+        SkChunkAlloc* allocator) {
+    init(pts, SkPath::kQuad_Verb, operand, evenOdd, allocator);
     fBounds.setQuadBounds(pts);
 }
 
@@ -2754,7 +2757,11 @@ void SkOpSegment::fixOtherTIndex() {
     }
 }
 
-void SkOpSegment::init(const SkPoint pts[], SkPath::Verb verb, bool operand, bool evenOdd) {
+void SkOpSegment::init(const SkPoint pts[], SkPath::Verb verb, bool operand, bool evenOdd,
+        SkChunkAlloc* allocator) {
+    fTs.setAllocator(allocator);
+    fSingletonAngles.setAllocator(allocator);
+    fAngles.setAllocator(allocator);
     fDoneSpans = 0;
     fOperand = operand;
     fXor = evenOdd;
@@ -8,6 +8,7 @@
 #define SkOpSegment_DEFINE
 
 #include "SkOpAngle.h"
+#include "SkOpArray.h"
 #include "SkOpSpan.h"
 #include "SkPathOpsBounds.h"
 #include "SkPathOpsCurve.h"
@@ -163,7 +164,7 @@ public:
     }
 
     void reset() {
-        init(NULL, (SkPath::Verb) -1, false, false);
+        init(NULL, (SkPath::Verb) -1, false, false, fTs.allocator());
         fBounds.set(SK_ScalarMax, SK_ScalarMax, SK_ScalarMax, SK_ScalarMax);
         fTs.reset();
     }
@@ -263,12 +264,12 @@ public:
     SkPoint activeLeftTop(int* firstT) const;
     bool activeOp(int index, int endIndex, int xorMiMask, int xorSuMask, SkPathOp op);
     bool activeWinding(int index, int endIndex);
-    void addCubic(const SkPoint pts[4], bool operand, bool evenOdd);
+    void addCubic(const SkPoint pts[4], bool operand, bool evenOdd, SkChunkAlloc* );
     void addCurveTo(int start, int end, SkPathWriter* path, bool active) const;
     void addEndSpan(int endIndex);
-    void addLine(const SkPoint pts[2], bool operand, bool evenOdd);
+    void addLine(const SkPoint pts[2], bool operand, bool evenOdd, SkChunkAlloc* );
     void addOtherT(int index, double otherT, int otherIndex);
-    void addQuad(const SkPoint pts[3], bool operand, bool evenOdd);
+    void addQuad(const SkPoint pts[3], bool operand, bool evenOdd, SkChunkAlloc* );
     void addSimpleAngle(int endIndex);
     int addSelfT(const SkPoint& pt, double newT);
     void addStartSpan(int endIndex);
@@ -355,7 +356,7 @@ public:
 #if DEBUG_SHOW_WINDING
     int debugShowWindingValues(int slotCount, int ofInterest) const;
 #endif
-    const SkTDArray<SkOpSpan>& debugSpans() const;
+    const SkOpArray<SkOpSpan>& debugSpans() const;
     void debugValidate() const;
     // available to testing only
     void dumpAngles() const;
@@ -412,7 +413,7 @@ private:
     int findStartSpan(int startIndex) const;
     int firstActive(int tIndex) const;
     const SkOpSpan& firstSpan(const SkOpSpan& thisSpan) const;
-    void init(const SkPoint pts[], SkPath::Verb verb, bool operand, bool evenOdd);
+    void init(const SkPoint pts[], SkPath::Verb verb, bool operand, bool evenOdd, SkChunkAlloc* );
     bool inLoop(const SkOpAngle* baseAngle, int spanCount, int* indexPtr) const;
     bool isSimple(int end) const;
     bool isTiny(int index) const;
@@ -498,20 +499,19 @@ private:
 #endif
     // available to testing only
     void debugConstruct();
-    void debugConstructCubic(SkPoint shortQuad[4]);
-    void debugConstructLine(SkPoint shortQuad[2]);
-    void debugConstructQuad(SkPoint shortQuad[3]);
+    void debugConstructCubic(SkPoint shortQuad[4], SkChunkAlloc* );
+    void debugConstructLine(SkPoint shortQuad[2], SkChunkAlloc* );
+    void debugConstructQuad(SkPoint shortQuad[3], SkChunkAlloc* );
     void debugReset();
     void dumpDPts() const;
     void dumpSpan(int index) const;
 
     const SkPoint* fPts;
     SkPathOpsBounds fBounds;
-    // FIXME: can't convert to SkTArray because it uses insert
-    SkTDArray<SkOpSpan> fTs;  // 2+ (always includes t=0 t=1) -- at least (number of spans) + 1
+    SkOpArray<SkOpSpan> fTs;  // 2+ (always includes t=0 t=1) -- at least (number of spans) + 1
 // FIXME: replace both with bucket storage that allows direct immovable pointers to angles
-    SkTArray<SkOpAngle, true> fSingletonAngles;  // 0 or 2 -- allocated for singletons
-    SkTArray<SkOpAngle, true> fAngles;  // 0 or 2+ -- (number of non-zero spans) * 2
+    SkOpArray<SkOpAngle> fSingletonAngles;  // 0 or 2 -- allocated for singletons
+    SkOpArray<SkOpAngle> fAngles;  // 0 or 2+ -- (number of non-zero spans) * 2
     // OPTIMIZATION: could pack donespans, verb, operand, xor into 1 int-sized value
     int fDoneSpans;  // quick check that segment is finished
     // OPTIMIZATION: force the following to be byte-sized
@@ -447,7 +447,7 @@ static void sortSegments(SkTArray<SkOpContour*, true>* contourList) {
     }
 }
 
-void MakeContourList(SkTArray<SkOpContour>& contours, SkTArray<SkOpContour*, true>& list,
+void MakeContourList(SkOpArray<SkOpContour>& contours, SkTArray<SkOpContour*, true>& list,
                      bool evenOdd, bool oppEvenOdd) {
     int count = contours.count();
     if (count == 0) {
@@ -481,8 +481,9 @@ void Assemble(const SkPathWriter& path, SkPathWriter* simple) {
 #if DEBUG_PATH_CONSTRUCTION
     SkDebugf("%s\n", __FUNCTION__);
 #endif
-    SkTArray<SkOpContour> contours;
-    SkOpEdgeBuilder builder(path, contours);
+    SkChunkAlloc allocator(kOpAllocatorBlockSize);
+    SkOpArray<SkOpContour> contours(&allocator);
+    SkOpEdgeBuilder builder(path, contours, &allocator);
     builder.finish();
     int count = contours.count();
     int outer;
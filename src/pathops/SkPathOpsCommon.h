@@ -13,6 +13,10 @@
 
 class SkPathWriter;
 
+// Size of the first block of the SkChunkAlloc that holds an operation's contours, segments,
+// spans and angles; later blocks grow from there.
+static const size_t kOpAllocatorBlockSize = 4096;
+
 void Assemble(const SkPathWriter& path, SkPathWriter* simple);
 // FIXME: find chase uses insert, so it can't be converted to SkTArray yet
 SkOpSegment* FindChase(SkTDArray<SkOpSpan*>* chase, int* tIndex, int* endIndex);
@@ -20,9 +24,12 @@ SkOpSegment* FindSortableTop(const SkTArray<SkOpContour*, true>& , SkOpAngle::In
                              bool* firstContour, int* index, int* endIndex, SkPoint* topLeft,
                              bool* unsortable, bool* done, bool firstPass);
 SkOpSegment* FindUndone(SkTArray<SkOpContour*, true>& contourList, int* start, int* end);
-void MakeContourList(SkTArray<SkOpContour>& contours, SkTArray<SkOpContour*, true>& list,
+void MakeContourList(SkOpArray<SkOpContour>& contours, SkTArray<SkOpContour*, true>& list,
                      bool evenOdd, bool oppEvenOdd);
 bool HandleCoincidence(SkTArray<SkOpContour*, true>* , int );
+// Op(), building its contours in allocator, which the caller frees or rewinds afterwards.
+bool OpWithAllocator(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result,
+                     SkChunkAlloc* allocator);
 
 #if DEBUG_ACTIVE_SPANS || DEBUG_ACTIVE_SPANS_FIRST_ONLY
 void DebugShowActiveSpans(SkTArray<SkOpContour*, true>& contourList);
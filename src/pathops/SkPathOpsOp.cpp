@@ -8,6 +8,7 @@
 #include "SkOpEdgeBuilder.h"
 #include "SkPathOpsCommon.h"
 #include "SkPathWriter.h"
+#include "SkThreadPool.h"
 
 static SkOpSegment* findChaseOp(SkTDArray<SkOpSpan*>& chase, int* tIndex, int* endIndex) {
     while (chase.count()) {
@@ -231,7 +232,8 @@ static const bool gOutInverse[kReverseDifference_PathOp + 1][2][2] = {
     {{ false, true }, { false, false }},  // rev diff
 };
 
-bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result) {
+bool OpWithAllocator(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result,
+        SkChunkAlloc* allocator) {
 #if DEBUG_SHOW_TEST_NAME
     char* debugName = DEBUG_FILENAME_STRING;
     if (debugName && debugName[0]) {
@@ -253,9 +255,9 @@ bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result) {
     SkPathOpsDebug::gSortCount = SkPathOpsDebug::gSortCountDefault;
 #endif
     // turn path into list of segments
-    SkTArray<SkOpContour> contours;
+    SkOpArray<SkOpContour> contours(allocator);
     // FIXME: add self-intersecting cubics' T values to segment
-    SkOpEdgeBuilder builder(*minuend, contours);
+    SkOpEdgeBuilder builder(*minuend, contours, allocator);
     const int xorMask = builder.xorMask();
     builder.addOperand(*subtrahend);
     if (!builder.finish()) {
@@ -307,3 +309,83 @@ bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result) {
     }
     return true;
 }
+
+bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result) {
+    // everything built from the paths is freed with allocator
+    SkChunkAlloc allocator(kOpAllocatorBlockSize);
+    return OpWithAllocator(one, two, op, result, &allocator);
+}
+
+namespace {
+
+// What each BatchOp() thread keeps from one pair to the next.
+struct BatchOpThread {
+    BatchOpThread() : fAllocator(kOpAllocatorBlockSize) {}
+
+    SkChunkAlloc fAllocator;
+};
+
+// Resolves the pairs [fStart, fEnd) of a BatchOp().
+class BatchOpChunk : public SkTRunnable<BatchOpThread> {
+public:
+    BatchOpChunk(const SkPath ones[], const SkPath twos[], SkPathOp op, SkPath results[],
+                 bool succeeded[], int start, int end)
+        : fOnes(ones), fTwos(twos), fOp(op), fResults(results), fSucceeded(succeeded)
+        , fStart(start), fEnd(end) {}
+
+    virtual void run(BatchOpThread& thread) SK_OVERRIDE {
+        for (int index = fStart; index < fEnd; ++index) {
+            fSucceeded[index] = OpWithAllocator(fOnes[index], fTwos[index], fOp,
+                                                &fResults[index], &thread.fAllocator);
+            thread.fAllocator.rewind();
+        }
+    }
+
+private:
+    const SkPath* fOnes;
+    const SkPath* fTwos;
+    SkPathOp fOp;
+    SkPath* fResults;
+    bool* fSucceeded;
+    int fStart;
+    int fEnd;
+};
+
+// Pairs per runnable: enough to amortize queueing it, few enough to balance the threads.
+const int kMaxBatchOpChunk = 16;
+
+}  // namespace
+
+bool BatchOp(const SkPath ones[], const SkPath twos[], int count, SkPathOp op,
+             SkPath results[], bool succeeded[], int threadCount) {
+    if (count <= 0) {
+        return true;
+    }
+    SkAutoTMalloc<bool> storage;
+    if (NULL == succeeded) {
+        storage.realloc(count);
+        succeeded = storage.get();
+    }
+    if (threadCount < 0) {
+        threadCount = num_cores();
+    }
+    threadCount = SkPin32(threadCount, 1, count);
+    const int chunkSize = SkPin32(count / (threadCount * 4), 1, kMaxBatchOpChunk);
+    const int chunkCount = (count + chunkSize - 1) / chunkSize;
+    SkTArray<BatchOpChunk> chunks(chunkCount);
+    {
+        // With no threads, the pool runs each chunk as it is added.
+        SkTThreadPool<BatchOpThread> pool(threadCount > 1 ? threadCount : 0);
+        for (int start = 0; start < count; start += chunkSize) {
+            chunks.push_back(BatchOpChunk(ones, twos, op, results, succeeded, start,
+                                          SkTMin(start + chunkSize, count)));
+            pool.add(&chunks.back());
+        }
+    }
+    for (int index = 0; index < count; ++index) {
+        if (!succeeded[index]) {
+            return false;
+        }
+    }
+    return true;
+}
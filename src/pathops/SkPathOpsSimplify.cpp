@@ -159,9 +159,10 @@ bool Simplify(const SkPath& path, SkPath* result) {
     SkPath::FillType fillType = path.isInverseFillType() ? SkPath::kInverseEvenOdd_FillType
             : SkPath::kEvenOdd_FillType;
 
-    // turn path into list of segments
-    SkTArray<SkOpContour> contours;
-    SkOpEdgeBuilder builder(path, contours);
+    // turn path into list of segments; everything built from them is freed with allocator
+    SkChunkAlloc allocator(kOpAllocatorBlockSize);
+    SkOpArray<SkOpContour> contours(&allocator);
+    SkOpEdgeBuilder builder(path, contours, &allocator);
     if (!builder.finish()) {
         return false;
     }
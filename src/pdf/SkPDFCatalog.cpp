@@ -8,6 +8,7 @@
 
 
 #include "SkPDFCatalog.h"
+#include "SkChecksum.h"
 #include "SkPDFTypes.h"
 #include "SkStream.h"
 #include "SkTypes.h"
@@ -16,18 +17,71 @@ SkPDFCatalog::SkPDFCatalog(SkPDFDocument::Flags flags)
     : fFirstPageCount(0),
       fNextObjNum(1),
       fNextFirstPageObjNum(0),
-      fDocumentFlags(flags) {
+      fDocumentFlags(flags),
+      fStream(NULL),
+      fStreamStart(0) {
 }
 
 SkPDFCatalog::~SkPDFCatalog() {
     fSubstituteResourcesRemaining.safeUnrefAll();
     fSubstituteResourcesFirstPage.safeUnrefAll();
+
+    SkTDynamicHash<IndexRec, SkPDFObject*>::Iter iter(&fIndices);
+    for (; !iter.done(); ++iter) {
+        SkDELETE(&(*iter));
+    }
+}
+
+uint32_t SkPDFCatalog::IndexRec::Hash(SkPDFObject* const& object) {
+    return SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(&object),
+                               sizeof(object));
+}
+
+void SkPDFCatalog::beginStreaming(SkWStream* stream) {
+    SkASSERT(NULL != stream);
+    SkASSERT(fCatalog.isEmpty());
+    fStream = stream;
+    fStreamStart = stream->bytesWritten();
+}
+
+off_t SkPDFCatalog::getStreamedOffset() const {
+    SkASSERT(NULL != fStream);
+    return fStream->bytesWritten() - fStreamStart;
+}
+
+void SkPDFCatalog::emitStreamed(SkPDFObject* obj) {
+    SkASSERT(NULL != fStream);
+    int objIndex = assignObjNum(obj) - 1;
+    SkASSERT(fCatalog[objIndex].fFileOffset == 0);
+    fCatalog[objIndex].fFileOffset = getStreamedOffset();
+    obj->emit(fStream, this, true);
+}
+
+void SkPDFCatalog::forgetObject(SkPDFObject* obj) {
+    SkASSERT(NULL != fStream);
+    IndexRec* rec = fIndices.find(obj);
+    if (NULL == rec) {
+        return;
+    }
+    // Its file offset must already be recorded for the xref table.
+    SkASSERT(fCatalog[rec->fIndex].fFileOffset > 0);
+    fCatalog[rec->fIndex].fObject = NULL;
+    fIndices.remove(obj);
+    SkDELETE(rec);
 }
 
 SkPDFObject* SkPDFCatalog::addObject(SkPDFObject* obj, bool onFirstPage) {
     if (findObjectIndex(obj) != -1) {  // object already added
         return obj;
     }
+    if (NULL != fStream) {
+        // Streamed objects are numbered in the order they are added.
+        struct Rec newEntry(obj, false);
+        newEntry.fObjNumAssigned = true;
+        fIndices.add(SkNEW_ARGS(IndexRec, (obj, fCatalog.count())));
+        fCatalog.append(1, &newEntry);
+        return obj;
+    }
     SkASSERT(fNextFirstPageObjNum == 0);
     if (onFirstPage) {
         fFirstPageCount++;
@@ -59,9 +113,16 @@ size_t SkPDFCatalog::getObjectNumberSize(SkPDFObject* obj) {
 }
 
 int SkPDFCatalog::findObjectIndex(SkPDFObject* obj) const {
-    for (int i = 0; i < fCatalog.count(); i++) {
-        if (fCatalog[i].fObject == obj) {
-            return i;
+    if (NULL != fStream) {
+        const IndexRec* rec = fIndices.find(obj);
+        if (NULL != rec) {
+            return rec->fIndex;
+        }
+    } else {
+        for (int i = 0; i < fCatalog.count(); i++) {
+            if (fCatalog[i].fObject == obj) {
+                return i;
+            }
         }
     }
     // If it's not in the main array, check if it's a substitute object.
@@ -80,6 +141,7 @@ int SkPDFCatalog::assignObjNum(SkPDFObject* obj) {
     SkASSERT(pos >= 0);
     uint32_t currentIndex = pos;
     if (fCatalog[currentIndex].fObjNumAssigned) {
+        // Always the case in streaming mode.
         return currentIndex + 1;
     }
 
@@ -205,7 +267,12 @@ off_t SkPDFCatalog::setSubstituteResourcesOffsets(off_t fileOffset,
 void SkPDFCatalog::emitSubstituteResources(SkWStream *stream, bool firstPage) {
     SkTSet<SkPDFObject*>* targetSet = getSubstituteList(firstPage);
     for (int i = 0; i < targetSet->count(); ++i) {
-        (*targetSet)[i]->emit(stream, this, true);
+        if (NULL != fStream) {
+            SkASSERT(stream == fStream);
+            emitStreamed((*targetSet)[i]);
+        } else {
+            (*targetSet)[i]->emit(stream, this, true);
+        }
     }
 }
 
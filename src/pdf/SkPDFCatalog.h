@@ -16,6 +16,7 @@
 #include "SkPDFTypes.h"
 #include "SkRefCnt.h"
 #include "SkTDArray.h"
+#include "SkTDynamicHash.h"
 
 /** \class SkPDFCatalog
 
@@ -29,6 +30,35 @@ public:
     explicit SkPDFCatalog(SkPDFDocument::Flags flags);
     ~SkPDFCatalog();
 
+    /** Put the catalog in streaming mode, where objects are written to
+     *  stream as they are finished instead of all at the end.  Objects are
+     *  numbered as they are added, and emitStreamed() records their file
+     *  offsets, relative to the stream's current position.  Must be called
+     *  before any object is added.
+     *  @param stream      The stream the document is written to.
+     */
+    void beginStreaming(SkWStream* stream);
+
+    /** Streaming mode only: write the object (or its substitute) to the
+     *  stream as an indirect object, and record its file offset.  The
+     *  object should already have been added to the catalog.
+     *  @param obj         The object to emit.
+     */
+    void emitStreamed(SkPDFObject* obj);
+
+    /** Streaming mode only: return the current offset in the output, from
+     *  the start of the document.
+     */
+    off_t getStreamedOffset() const;
+
+    /** Streaming mode only: forget an object that has been emitted and is
+     *  about to be deleted.  Its number and offset stay in the cross
+     *  reference table, but a new object at the same address will be given
+     *  a new number.
+     *  @param obj         The emitted object.
+     */
+    void forgetObject(SkPDFObject* obj);
+
     /** Add the passed object to the catalog.  Refs obj.
      *  @param obj         The object to add.
      *  @param onFirstPage Is the object on the first page.
@@ -110,8 +140,24 @@ private:
         SkPDFObject* fSubstitute;
     };
 
+    // In streaming mode, an object's index in fCatalog; objects are numbered
+    // as they are added, so indices never change.
+    struct IndexRec {
+        IndexRec(SkPDFObject* object, int index) : fObject(object), fIndex(index) {}
+
+        static SkPDFObject* const& GetKey(const IndexRec& rec) { return rec.fObject; }
+        static uint32_t Hash(SkPDFObject* const& object);
+
+        SkPDFObject* fObject;
+        int fIndex;
+    };
+
     // TODO(vandebo): Make this a hash if it's a performance problem.
     SkTDArray<struct Rec> fCatalog;
+    SkTDynamicHash<IndexRec, SkPDFObject*> fIndices;   // streaming mode only
+
+    SkWStream* fStream;         // NULL unless streaming
+    size_t fStreamStart;
 
     // TODO(arthurhsu): Make this a hash if it's a performance problem.
     SkTDArray<SubstituteMapping> fSubstituteMap;
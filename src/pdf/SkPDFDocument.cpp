@@ -15,6 +15,8 @@
 #include "SkPDFTypes.h"
 #include "SkStream.h"
 #include "SkTSet.h"
+#include "SkTaskGroup.h"
+#include "SkThreadPool.h"
 
 static void addResourcesToCatalog(bool firstPage,
                                   SkTSet<SkPDFObject*>* resourceSet,
@@ -24,32 +26,96 @@ static void addResourcesToCatalog(bool firstPage,
     }
 }
 
-static void perform_font_subsetting(SkPDFCatalog* catalog,
-                                    const SkTDArray<SkPDFPage*>& pages,
-                                    SkTDArray<SkPDFObject*>* substitutes) {
-    SkASSERT(catalog);
-    SkASSERT(substitutes);
-
-    SkPDFGlyphSetMap usage;
-    for (int i = 0; i < pages.count(); ++i) {
-        usage.merge(pages[i]->getFontGlyphUsage());
+static void count_font_types(const SkTDArray<SkPDFFont*>& fontResources,
+                             SkTDArray<uint32_t>* seenFonts,
+                             int counts[]) {
+    for (int font = 0; font < fontResources.count(); font++) {
+        SkFontID fontID = fontResources[font]->typeface()->uniqueID();
+        if (seenFonts->find(fontID) == -1) {
+            counts[fontResources[font]->getType()]++;
+            seenFonts->push(fontID);
+        }
     }
-    SkPDFGlyphSetMap::F2BIter iterator(usage);
-    const SkPDFGlyphSetMap::FontGlyphSetPair* entry = iterator.next();
-    while (entry) {
-        SkPDFFont* subsetFont =
-            entry->fFont->getFontSubset(entry->fGlyphSet);
-        if (subsetFont) {
-            catalog->setSubstitute(entry->fFont, subsetFont);
-            substitutes->push(subsetFont);  // Transfer ownership to substitutes
+}
+
+// Release the emitted resources that are only referenced by the set, so the
+// memory of finished pages does not build up.  Releasing one can leave the
+// resources it used unreferenced in turn.
+static void release_unused_resources(SkPDFCatalog* catalog,
+                                     SkTSet<SkPDFObject*>* resources) {
+    bool released;
+    do {
+        released = false;
+        SkTSet<SkPDFObject*> kept;
+        kept.setReserve(resources->count());
+        for (int i = 0; i < resources->count(); i++) {
+            SkPDFObject* resource = (*resources)[i];
+            if (resource->unique()) {
+                catalog->forgetObject(resource);
+                resource->unref();
+                released = true;
+            } else {
+                kept.add(resource);
+            }
         }
-        entry = iterator.next();
+        *resources = kept;
+    } while (released);
+}
+
+namespace {
+
+class PrepareObjects : public SkParallelForBody {
+public:
+    PrepareObjects(const SkTDArray<SkPDFObject*>& objects,
+                   SkPDFCatalog* catalog)
+        : fObjects(objects), fCatalog(catalog) {}
+
+    virtual void run(int index) SK_OVERRIDE {
+        fObjects[index]->prepareToEmit(fCatalog);
+    }
+
+private:
+    const SkTDArray<SkPDFObject*>& fObjects;
+    SkPDFCatalog* fCatalog;
+};
+
+class SubsetFonts : public SkParallelForBody {
+public:
+    SubsetFonts(const SkTDArray<const SkPDFGlyphSetMap::FontGlyphSetPair*>& entries,
+                SkPDFFont* subsets[])
+        : fEntries(entries), fSubsets(subsets) {}
+
+    virtual void run(int index) SK_OVERRIDE {
+        fSubsets[index] = fEntries[index]->fFont->getFontSubset(fEntries[index]->fGlyphSet);
+    }
+
+private:
+    const SkTDArray<const SkPDFGlyphSetMap::FontGlyphSetPair*>& fEntries;
+    SkPDFFont** fSubsets;
+};
+
+}  // namespace
+
+// Add the resources of the font subsets that aren't in known to resources.
+// Refs the added objects.
+static void get_substitute_resources(const SkTDArray<SkPDFObject*>& substitutes,
+                                     const SkTSet<SkPDFObject*>& known,
+                                     SkTSet<SkPDFObject*>* resources) {
+    for (int i = 0; i < substitutes.count(); i++) {
+        substitutes[i]->getResources(known, resources);
     }
 }
 
 SkPDFDocument::SkPDFDocument(Flags flags)
         : fXRefFileOffset(0),
-          fTrailerDict(NULL) {
+          fTrailerDict(NULL),
+          fThreadCount(1),
+          fThreadPool(NULL),
+          fStream(NULL),
+          fKids(NULL),
+          fDests(NULL),
+          fStreamedResources(NULL),
+          fDeferredResources(NULL) {
     fCatalog.reset(new SkPDFCatalog(flags));
     fDocCatalog = SkNEW_ARGS(SkPDFDict, ("Catalog"));
     fCatalog->addObject(fDocCatalog, true);
@@ -57,6 +123,38 @@ SkPDFDocument::SkPDFDocument(Flags flags)
     fOtherPageResources = NULL;
 }
 
+SkPDFDocument::SkPDFDocument(SkWStream* stream, Flags flags)
+        : fXRefFileOffset(0),
+          fTrailerDict(NULL),
+          fThreadCount(1),
+          fThreadPool(NULL),
+          fStream(stream) {
+    SkASSERT(NULL != stream);
+    fCatalog.reset(new SkPDFCatalog(flags));
+    fCatalog->beginStreaming(stream);
+    emitHeader(stream);
+
+    fDocCatalog = SkNEW_ARGS(SkPDFDict, ("Catalog"));
+    fCatalog->addObject(fDocCatalog, false);
+    fFirstPageResources = NULL;
+    fOtherPageResources = NULL;
+
+    // The pages are not known up front, so streamed documents use a page
+    // tree with a single node.
+    SkPDFDict* pageTreeRoot = SkNEW_ARGS(SkPDFDict, ("Pages"));
+    fPageTree.push(pageTreeRoot);
+    fCatalog->addObject(pageTreeRoot, false);
+    fDocCatalog->insert("Pages", SkNEW_ARGS(SkPDFObjRef, (pageTreeRoot)))->unref();
+    fKids = SkNEW(SkPDFArray);
+    pageTreeRoot->insert("Kids", fKids);
+
+    fDests = SkNEW(SkPDFDict);
+    fStreamedResources = SkNEW(SkTSet<SkPDFObject*>);
+    fDeferredResources = SkNEW(SkTSet<SkPDFObject*>);
+    fGlyphUsage.reset(SkNEW(SkPDFGlyphSetMap));
+    sk_bzero(fFontTypeCounts, sizeof(fFontTypeCounts));
+}
+
 SkPDFDocument::~SkPDFDocument() {
     fPages.safeUnrefAll();
 
@@ -76,8 +174,20 @@ SkPDFDocument::~SkPDFDocument() {
 
     fSubstitutes.safeUnrefAll();
 
+    if (fStreamedResources) {
+        fStreamedResources->safeUnrefAll();
+    }
+    if (fDeferredResources) {
+        fDeferredResources->safeUnrefAll();
+    }
+    SkSafeUnref(fKids);
+    SkSafeUnref(fDests);
+    SkDELETE(fStreamedResources);
+    SkDELETE(fDeferredResources);
+
     fDocCatalog->unref();
     SkSafeUnref(fTrailerDict);
+    SkDELETE(fThreadPool);
     SkDELETE(fFirstPageResources);
     SkDELETE(fOtherPageResources);
 }
@@ -86,6 +196,12 @@ bool SkPDFDocument::emitPDF(SkWStream* stream) {
     if (fPages.isEmpty()) {
         return false;
     }
+    if (NULL != fStream) {
+        if (stream != fStream || fXRefFileOffset != 0) {
+            return false;
+        }
+        return emitStreamedPDF();
+    }
     for (int i = 0; i < fPages.count(); i++) {
         if (fPages[i] == NULL) {
             return false;
@@ -122,6 +238,12 @@ bool SkPDFDocument::emitPDF(SkWStream* stream) {
          */
         SkTSet<SkPDFObject*> knownResources;
 
+        SkTDArray<SkPDFObject*> pages;
+        for (int i = 0; i < fPages.count(); i++) {
+            pages.push(fPages[i]);
+        }
+        prepareObjects(pages);
+
         // mergeInto returns the number of duplicates.
         // If there are duplicates, there is a bug and we mess ref counting.
         SkDEBUGCODE(int duplicates =) knownResources.mergeInto(*fFirstPageResources);
@@ -157,7 +279,19 @@ bool SkPDFDocument::emitPDF(SkWStream* stream) {
         }
 
         // Build font subsetting info before proceeding.
-        perform_font_subsetting(fCatalog.get(), fPages, &fSubstitutes);
+        SkPDFGlyphSetMap usage;
+        for (int i = 0; i < fPages.count(); ++i) {
+            usage.merge(fPages[i]->getFontGlyphUsage());
+        }
+        performFontSubsetting(usage);
+
+        // Compress the streams and images before they are sized.
+        SkTSet<SkPDFObject*> substituteResources;
+        get_substitute_resources(fSubstitutes, knownResources,
+                                 &substituteResources);
+        knownResources.mergeInto(substituteResources);
+        prepareObjects(knownResources.toArray());
+        substituteResources.unrefAll();
 
         // Figure out the size of things and inform the catalog of file offsets.
         off_t fileOffset = headerSize();
@@ -227,7 +361,7 @@ bool SkPDFDocument::emitPDF(SkWStream* stream) {
 }
 
 bool SkPDFDocument::setPage(int pageNumber, SkPDFDevice* pdfDevice) {
-    if (!fPageTree.isEmpty()) {
+    if (!fPageTree.isEmpty() || NULL != fStream) {
         return false;
     }
 
@@ -249,6 +383,15 @@ bool SkPDFDocument::setPage(int pageNumber, SkPDFDevice* pdfDevice) {
 }
 
 bool SkPDFDocument::appendPage(SkPDFDevice* pdfDevice) {
+    if (NULL != fStream) {
+        if (fXRefFileOffset != 0) {
+            return false;
+        }
+        SkPDFPage* page = new SkPDFPage(pdfDevice);
+        fPages.push(page);  // Reference from new passed to fPages.
+        streamPage(page);
+        return true;
+    }
     if (!fPageTree.isEmpty()) {
         return false;
     }
@@ -258,22 +401,161 @@ bool SkPDFDocument::appendPage(SkPDFDevice* pdfDevice) {
     return true;
 }
 
+void SkPDFDocument::streamPage(SkPDFPage* page) {
+    page->insert("Parent", SkNEW_ARGS(SkPDFObjRef, (fPageTree[0])))->unref();
+    fKids->append(SkNEW_ARGS(SkPDFObjRef, (page)))->unref();
+    fCatalog->addObject(page, false);
+
+    SkTSet<SkPDFObject*> knownResources;
+    knownResources.mergeInto(*fStreamedResources);
+    knownResources.mergeInto(*fDeferredResources);
+
+    SkTSet<SkPDFObject*> newResources;
+    page->finalizePage(fCatalog.get(), false, knownResources, &newResources);
+    page->appendDestinations(fDests);
+    fGlyphUsage->merge(page->getFontGlyphUsage());
+    count_font_types(page->getFontResources(), &fSeenFontIDs, fFontTypeCounts);
+
+    // Fonts are replaced by their subsets when the document is finished, so
+    // they (and their resources) can't be written out yet.
+    SkTSet<SkPDFObject*> fontResources;
+    SkPDFGlyphSetMap::F2BIter iterator(page->getFontGlyphUsage());
+    for (const SkPDFGlyphSetMap::FontGlyphSetPair* entry = iterator.next();
+         entry; entry = iterator.next()) {
+        SkPDFFont* font = entry->fFont;
+        if (newResources.contains(font) && !fontResources.contains(font)) {
+            fontResources.add(font);
+            font->ref();
+            font->getResources(knownResources, &fontResources);
+        }
+    }
+
+    // The references in newResources are transfered to fDeferredResources
+    // or fStreamedResources.
+    SkTDArray<SkPDFObject*> streamed;
+    for (int i = 0; i < newResources.count(); i++) {
+        SkPDFObject* resource = newResources[i];
+        fCatalog->addObject(resource, false);
+        if (fontResources.contains(resource)) {
+            fDeferredResources->add(resource);
+        } else {
+            fStreamedResources->add(resource);
+            streamed.push(resource);
+        }
+    }
+    fontResources.unrefAll();
+
+    streamed.push(page);
+    prepareObjects(streamed);
+    streamed.pop();
+
+    page->emitStreamed(fCatalog.get());
+    for (int i = 0; i < streamed.count(); i++) {
+        fCatalog->emitStreamed(streamed[i]);
+    }
+
+    release_unused_resources(fCatalog.get(), fStreamedResources);
+}
+
+bool SkPDFDocument::emitStreamedPDF() {
+    release_unused_resources(fCatalog.get(), fStreamedResources);
+    performFontSubsetting(*fGlyphUsage);
+
+    SkTSet<SkPDFObject*> substituteResources;
+    get_substitute_resources(fSubstitutes, *fDeferredResources,
+                             &substituteResources);
+    SkTSet<SkPDFObject*> toPrepare(*fDeferredResources);
+    toPrepare.mergeInto(substituteResources);
+    prepareObjects(toPrepare.toArray());
+    substituteResources.unrefAll();
+
+    SkPDFDict* pageTreeRoot = fPageTree[0];
+    pageTreeRoot->insertInt("Count", fPages.count());
+    fCatalog->emitStreamed(pageTreeRoot);
+    if (fDests->size() > 0) {
+        fCatalog->addObject(fDests, false);
+        fDocCatalog->insert("Dests", SkNEW_ARGS(SkPDFObjRef, (fDests)))->unref();
+        fCatalog->emitStreamed(fDests);
+    }
+    fCatalog->emitStreamed(fDocCatalog);
+
+    for (int i = 0; i < fDeferredResources->count(); i++) {
+        fCatalog->emitStreamed((*fDeferredResources)[i]);
+    }
+    fCatalog->emitSubstituteResources(fStream, false);
+
+    fXRefFileOffset = fCatalog->getStreamedOffset();
+    int64_t objCount = fCatalog->emitXrefTable(fStream, false);
+    emitFooter(fStream, objCount);
+    return true;
+}
+
+void SkPDFDocument::setThreadCount(int count) {
+    if (count != fThreadCount) {
+        SkDELETE(fThreadPool);
+        fThreadPool = NULL;
+        fThreadCount = count;
+    }
+}
+
+void SkPDFDocument::prepareObjects(const SkTDArray<SkPDFObject*>& objects) {
+    PrepareObjects body(objects, fCatalog.get());
+    this->parallelFor(objects.count(), &body);
+}
+
+void SkPDFDocument::performFontSubsetting(const SkPDFGlyphSetMap& usage) {
+    SkTDArray<const SkPDFGlyphSetMap::FontGlyphSetPair*> entries;
+    SkPDFGlyphSetMap::F2BIter iterator(usage);
+    for (const SkPDFGlyphSetMap::FontGlyphSetPair* entry = iterator.next();
+         entry;
+         entry = iterator.next()) {
+        entries.push(entry);
+    }
+
+    // Subsetting a font is independent of the others, but the substitutes
+    // are registered in order so the output doesn't depend on the threads.
+    SkAutoTMalloc<SkPDFFont*> subsets(entries.count());
+    SubsetFonts body(entries, subsets.get());
+    this->parallelFor(entries.count(), &body);
+    for (int i = 0; i < entries.count(); i++) {
+        if (subsets[i]) {
+            fCatalog->setSubstitute(entries[i]->fFont, subsets[i]);
+            fSubstitutes.push(subsets[i]);  // Transfer ownership to substitutes
+        }
+    }
+}
+
+void SkPDFDocument::parallelFor(int count, SkParallelForBody* body) {
+    if ((fThreadCount >= 0 && fThreadCount <= 1) || count < 2) {
+        for (int i = 0; i < count; i++) {
+            body->run(i);
+        }
+        return;
+    }
+
+    if (NULL == fThreadPool) {
+        fThreadPool = SkNEW_ARGS(SkThreadPool, (fThreadCount));
+    }
+    SkTaskGroup group(fThreadPool);
+    group.parallelFor(0, count, body);
+    group.wait();
+}
+
 void SkPDFDocument::getCountOfFontTypes(
         int counts[SkAdvancedTypefaceMetrics::kNotEmbeddable_Font + 1]) const {
+    if (NULL != fStream) {
+        // The pages have been released.
+        memcpy(counts, fFontTypeCounts, sizeof(fFontTypeCounts));
+        return;
+    }
+
     sk_bzero(counts, sizeof(int) *
                      (SkAdvancedTypefaceMetrics::kNotEmbeddable_Font + 1));
-    SkTDArray<SkFontID> seenFonts;
+    SkTDArray<uint32_t> seenFonts;
 
     for (int pageNumber = 0; pageNumber < fPages.count(); pageNumber++) {
-        const SkTDArray<SkPDFFont*>& fontResources =
-                fPages[pageNumber]->getFontResources();
-        for (int font = 0; font < fontResources.count(); font++) {
-            SkFontID fontID = fontResources[font]->typeface()->uniqueID();
-            if (seenFonts.find(fontID) == -1) {
-                counts[fontResources[font]->getType()]++;
-                seenFonts.push(fontID);
-            }
-        }
+        count_font_types(fPages[pageNumber]->getFontResources(), &seenFonts,
+                         counts);
     }
 }
 
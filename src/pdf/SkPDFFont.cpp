@@ -622,12 +622,17 @@ static size_t get_subset_font_stream(const char* fontName,
 // class SkPDFGlyphSet
 ///////////////////////////////////////////////////////////////////////////////
 
-SkPDFGlyphSet::SkPDFGlyphSet() : fBitSet(SK_MaxU16 + 1) {
+SkPDFGlyphSet::SkPDFGlyphSet()
+    : fBitSet(SK_MaxU16 + 1)
+    , fFirstGlyphID(SK_MaxU16 + 1)
+    , fLastGlyphID(-1) {
 }
 
 void SkPDFGlyphSet::set(const uint16_t* glyphIDs, int numGlyphs) {
     for (int i = 0; i < numGlyphs; ++i) {
         fBitSet.setBit(glyphIDs[i], true);
+        fFirstGlyphID = SkTMin<int>(fFirstGlyphID, glyphIDs[i]);
+        fLastGlyphID = SkTMax<int>(fLastGlyphID, glyphIDs[i]);
     }
 }
 
@@ -636,11 +641,18 @@ bool SkPDFGlyphSet::has(uint16_t glyphID) const {
 }
 
 void SkPDFGlyphSet::merge(const SkPDFGlyphSet& usage) {
-    fBitSet.orBits(usage.fBitSet);
+    if (usage.isEmpty()) {
+        return;
+    }
+    fBitSet.orBits(usage.fBitSet, usage.fFirstGlyphID, usage.fLastGlyphID);
+    fFirstGlyphID = SkTMin(fFirstGlyphID, usage.fFirstGlyphID);
+    fLastGlyphID = SkTMax(fLastGlyphID, usage.fLastGlyphID);
 }
 
 void SkPDFGlyphSet::exportTo(SkTDArray<unsigned int>* glyphIDs) const {
-    fBitSet.exportTo(glyphIDs);
+    if (!this->isEmpty()) {
+        fBitSet.exportTo(glyphIDs, fFirstGlyphID, fLastGlyphID);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -784,6 +796,64 @@ int SkPDFFont::glyphsToPDFFontEncoding(uint16_t* glyphIDs, int numGlyphs) {
     return numGlyphs;
 }
 
+// Getting the metrics of a whole font is expensive, and successive documents
+// usually use the same few fonts, so the most recently used are kept.  The
+// metrics are never changed after they are made, so they can be shared.
+struct FontMetricsRec {
+    uint32_t fFontID;
+    SkAdvancedTypefaceMetrics::PerGlyphInfo fInfo;
+    SkAdvancedTypefaceMetrics* fMetrics;  // Holds a ref, may be NULL.
+};
+
+static const int kMaxCachedFontMetrics = 16;
+
+static SkTDArray<FontMetricsRec>& font_metrics_cache() {
+    // This initialization is only thread safe with gcc.
+    static SkTDArray<FontMetricsRec> gFontMetrics;
+    return gFontMetrics;
+}
+
+static SkBaseMutex& font_metrics_mutex() {
+    SK_DECLARE_STATIC_MUTEX(gFontMetricsMutex);
+    return gFontMetricsMutex;
+}
+
+// Typeface IDs are never reused, so an entry for a deleted typeface just
+// ages out of the cache.
+// static
+SkAdvancedTypefaceMetrics* SkPDFFont::RefFontMetrics(
+        SkTypeface* typeface, SkAdvancedTypefaceMetrics::PerGlyphInfo info) {
+    const uint32_t fontID = typeface->uniqueID();
+    {
+        SkAutoMutexAcquire lock(font_metrics_mutex());
+        SkTDArray<FontMetricsRec>& cache = font_metrics_cache();
+        for (int i = cache.count() - 1; i >= 0; --i) {
+            if (cache[i].fFontID == fontID && cache[i].fInfo == info) {
+                // Keep the most recently used at the end.
+                FontMetricsRec rec = cache[i];
+                cache.remove(i);
+                cache.push(rec);
+                return SkSafeRef(rec.fMetrics);
+            }
+        }
+    }
+
+    SkAdvancedTypefaceMetrics* metrics =
+        typeface->getAdvancedTypefaceMetrics(info, NULL, 0);
+
+    SkAutoMutexAcquire lock(font_metrics_mutex());
+    SkTDArray<FontMetricsRec>& cache = font_metrics_cache();
+    if (cache.count() == kMaxCachedFontMetrics) {
+        SkSafeUnref(cache[0].fMetrics);
+        cache.remove(0);
+    }
+    FontMetricsRec* rec = cache.append();
+    rec->fFontID = fontID;
+    rec->fInfo = info;
+    rec->fMetrics = SkSafeRef(metrics);
+    return metrics;
+}
+
 // static
 SkPDFFont* SkPDFFont::GetFontResource(SkTypeface* typeface, uint16_t glyphID) {
     SkAutoMutexAcquire lock(CanonicalFontsMutex());
@@ -827,16 +897,14 @@ SkPDFFont* SkPDFFont::GetFontResource(SkTypeface* typeface, uint16_t glyphID) {
         info = SkTBitOr<SkAdvancedTypefaceMetrics::PerGlyphInfo>(
                   info, SkAdvancedTypefaceMetrics::kHAdvance_PerGlyphInfo);
 #endif
-        fontMetrics.reset(
-            typeface->getAdvancedTypefaceMetrics(info, NULL, 0));
+        fontMetrics.reset(RefFontMetrics(typeface, info));
 #if defined (SK_SFNTLY_SUBSETTER)
         if (fontMetrics.get() &&
             fontMetrics->fType != SkAdvancedTypefaceMetrics::kTrueType_Font) {
             // Font does not support subsetting, get new info with advance.
             info = SkTBitOr<SkAdvancedTypefaceMetrics::PerGlyphInfo>(
                       info, SkAdvancedTypefaceMetrics::kHAdvance_PerGlyphInfo);
-            fontMetrics.reset(
-                typeface->getAdvancedTypefaceMetrics(info, NULL, 0));
+            fontMetrics.reset(RefFontMetrics(typeface, info));
         }
 #endif
     }
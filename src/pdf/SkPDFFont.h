@@ -31,7 +31,13 @@ public:
     void exportTo(SkTDArray<uint32_t>* glyphIDs) const;
 
 private:
+    bool isEmpty() const { return fFirstGlyphID > fLastGlyphID; }
+
     SkBitSet fBitSet;
+    // The range of set glyphs, so merging and exporting skip the unused
+    // words of the bit set.  Empty while fFirstGlyphID > fLastGlyphID.
+    int fFirstGlyphID;
+    int fLastGlyphID;
 };
 
 class SkPDFGlyphSetMap : SkNoncopyable {
@@ -199,6 +205,12 @@ private:
     // This should be made a hash table if performance is a problem.
     static SkTDArray<FontRec>& CanonicalFonts();
     static SkBaseMutex& CanonicalFontsMutex();
+
+    // Returns a ref to the whole-font metrics of typeface, from a small
+    // cache shared by all documents.
+    static SkAdvancedTypefaceMetrics* RefFontMetrics(
+            SkTypeface* typeface,
+            SkAdvancedTypefaceMetrics::PerGlyphInfo info);
     typedef SkPDFDict INHERITED;
 };
 
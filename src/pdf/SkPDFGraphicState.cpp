@@ -5,6 +5,8 @@
  * found in the LICENSE file.
  */
 
+#include "SkChecksum.h"
+#include "SkFloatBits.h"
 #include "SkPDFFormXObject.h"
 #include "SkPDFGraphicState.h"
 #include "SkPDFUtils.h"
@@ -55,10 +57,8 @@ static const char* blend_mode_from_xfermode(SkXfermode::Mode mode) {
 SkPDFGraphicState::~SkPDFGraphicState() {
     SkAutoMutexAcquire lock(CanonicalPaintsMutex());
     if (!fSMask) {
-        int index = Find(fPaint);
-        SkASSERT(index >= 0);
-        SkASSERT(CanonicalPaints()[index].fGraphicState == this);
-        CanonicalPaints().removeShuffle(index);
+        SkASSERT(Find(fPaint) == this);
+        CanonicalPaints().remove(fKey);
     }
     fResources.unrefAll();
 }
@@ -82,9 +82,10 @@ size_t SkPDFGraphicState::getOutputSize(SkPDFCatalog* catalog, bool indirect) {
 }
 
 // static
-SkTDArray<SkPDFGraphicState::GSCanonicalEntry>& SkPDFGraphicState::CanonicalPaints() {
+SkTDynamicHash<SkPDFGraphicState, SkPDFGraphicState::GSCanonicalKey>&
+SkPDFGraphicState::CanonicalPaints() {
     CanonicalPaintsMutex().assertHeld();
-    static SkTDArray<SkPDFGraphicState::GSCanonicalEntry> gCanonicalPaints;
+    static SkTDynamicHash<SkPDFGraphicState, GSCanonicalKey> gCanonicalPaints;
     return gCanonicalPaints;
 }
 
@@ -97,14 +98,14 @@ SkBaseMutex& SkPDFGraphicState::CanonicalPaintsMutex() {
 // static
 SkPDFGraphicState* SkPDFGraphicState::GetGraphicStateForPaint(const SkPaint& paint) {
     SkAutoMutexAcquire lock(CanonicalPaintsMutex());
-    int index = Find(paint);
-    if (index >= 0) {
-        CanonicalPaints()[index].fGraphicState->ref();
-        return CanonicalPaints()[index].fGraphicState;
+    SkPDFGraphicState* result = Find(paint);
+    if (result) {
+        result->ref();
+        return result;
     }
-    GSCanonicalEntry newEntry(new SkPDFGraphicState(paint));
-    CanonicalPaints().push(newEntry);
-    return newEntry.fGraphicState;
+    result = new SkPDFGraphicState(paint);
+    CanonicalPaints().add(result);
+    return result;
 }
 
 // static
@@ -181,21 +182,23 @@ SkPDFGraphicState* SkPDFGraphicState::GetNoSMaskGraphicState() {
 }
 
 // static
-int SkPDFGraphicState::Find(const SkPaint& paint) {
+SkPDFGraphicState* SkPDFGraphicState::Find(const SkPaint& paint) {
     CanonicalPaintsMutex().assertHeld();
-    GSCanonicalEntry search(&paint);
+    GSCanonicalKey search(&paint);
     return CanonicalPaints().find(search);
 }
 
 SkPDFGraphicState::SkPDFGraphicState()
     : fPopulated(false),
-      fSMask(false) {
+      fSMask(false),
+      fKey(&fPaint) {
 }
 
 SkPDFGraphicState::SkPDFGraphicState(const SkPaint& paint)
     : fPaint(paint),
       fPopulated(false),
-      fSMask(false) {
+      fSMask(false),
+      fKey(&fPaint) {
 }
 
 // populateDict and operator== have to stay in sync with each other.
@@ -241,10 +244,48 @@ void SkPDFGraphicState::populateDict() {
     }
 }
 
+// The blend mode the graphic state of paint uses.
+static const char* paint_blend_mode(const SkPaint& paint) {
+    SkXfermode::Mode xfermode = SkXfermode::kSrcOver_Mode;
+    SkXfermode* paintXfermode = paint.getXfermode();
+    if (paintXfermode) {
+        paintXfermode->asMode(&xfermode);
+    }
+    if (xfermode < 0 || xfermode > SkXfermode::kLastMode ||
+            blend_mode_from_xfermode(xfermode) == NULL) {
+        xfermode = SkXfermode::kSrcOver_Mode;
+    }
+    const char* xfermodeString = blend_mode_from_xfermode(xfermode);
+    SkASSERT(xfermodeString != NULL);
+    return xfermodeString;
+}
+
+// A stroke width of -0 matches one of 0, so both get the bits of 0.
+static uint32_t scalar_hash_bits(SkScalar value) {
+    return SkFloat2Bits(SkScalarToFloat(value) + 0.0f);
+}
+
+// The hash has to stay in sync with operator==.
+SkPDFGraphicState::GSCanonicalKey::GSCanonicalKey(const SkPaint* paint)
+    : fPaint(paint) {
+    SkASSERT(paint != NULL);
+    uint32_t words[4];
+    words[0] = SkColorGetA(paint->getColor()) |
+               (paint->getStrokeCap() << 8) |
+               (paint->getStrokeJoin() << 16);
+    words[1] = scalar_hash_bits(paint->getStrokeWidth());
+    words[2] = scalar_hash_bits(paint->getStrokeMiter());
+    words[3] = 0;
+    for (const char* c = paint_blend_mode(*paint); *c; c++) {
+        words[3] = words[3] * 31 + *c;
+    }
+    fHash = SkChecksum::Murmur3(words, sizeof(words));
+}
+
 // We're only interested in some fields of the SkPaint, so we have a custom
 // operator== function.
-bool SkPDFGraphicState::GSCanonicalEntry::operator==(
-        const SkPDFGraphicState::GSCanonicalEntry& gs) const {
+bool SkPDFGraphicState::GSCanonicalKey::operator==(
+        const SkPDFGraphicState::GSCanonicalKey& gs) const {
     const SkPaint* a = fPaint;
     const SkPaint* b = gs.fPaint;
     SkASSERT(a != NULL);
@@ -258,29 +299,5 @@ bool SkPDFGraphicState::GSCanonicalEntry::operator==(
         return false;
     }
 
-    SkXfermode::Mode aXfermodeName = SkXfermode::kSrcOver_Mode;
-    SkXfermode* aXfermode = a->getXfermode();
-    if (aXfermode) {
-        aXfermode->asMode(&aXfermodeName);
-    }
-    if (aXfermodeName < 0 || aXfermodeName > SkXfermode::kLastMode ||
-            blend_mode_from_xfermode(aXfermodeName) == NULL) {
-        aXfermodeName = SkXfermode::kSrcOver_Mode;
-    }
-    const char* aXfermodeString = blend_mode_from_xfermode(aXfermodeName);
-    SkASSERT(aXfermodeString != NULL);
-
-    SkXfermode::Mode bXfermodeName = SkXfermode::kSrcOver_Mode;
-    SkXfermode* bXfermode = b->getXfermode();
-    if (bXfermode) {
-        bXfermode->asMode(&bXfermodeName);
-    }
-    if (bXfermodeName < 0 || bXfermodeName > SkXfermode::kLastMode ||
-            blend_mode_from_xfermode(bXfermodeName) == NULL) {
-        bXfermodeName = SkXfermode::kSrcOver_Mode;
-    }
-    const char* bXfermodeString = blend_mode_from_xfermode(bXfermodeName);
-    SkASSERT(bXfermodeString != NULL);
-
-    return strcmp(aXfermodeString, bXfermodeString) == 0;
+    return strcmp(paint_blend_mode(*a), paint_blend_mode(*b)) == 0;
 }
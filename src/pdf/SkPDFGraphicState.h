@@ -12,6 +12,7 @@
 
 #include "SkPaint.h"
 #include "SkPDFTypes.h"
+#include "SkTDynamicHash.h"
 #include "SkTemplates.h"
 #include "SkThread.h"
 
@@ -79,22 +80,25 @@ private:
     bool fPopulated;
     bool fSMask;
 
-    class GSCanonicalEntry {
+    // The parts of a paint the graphic state depends on; paints with equal
+    // keys share a graphic state.
+    class GSCanonicalKey {
     public:
-        SkPDFGraphicState* fGraphicState;
-        const SkPaint* fPaint;
+        explicit GSCanonicalKey(const SkPaint* paint);
+        bool operator==(const GSCanonicalKey& b) const;
 
-        bool operator==(const GSCanonicalEntry& b) const;
-        explicit GSCanonicalEntry(SkPDFGraphicState* gs)
-            : fGraphicState(gs),
-              fPaint(&gs->fPaint) {}
-        explicit GSCanonicalEntry(const SkPaint* paint)
-            : fGraphicState(NULL),
-              fPaint(paint) {}
+        const SkPaint* fPaint;
+        uint32_t fHash;
     };
+    const GSCanonicalKey fKey;
+
+    friend class SkTDynamicHash<SkPDFGraphicState, GSCanonicalKey>;
+    static const GSCanonicalKey& GetKey(const SkPDFGraphicState& gs) {
+        return gs.fKey;
+    }
+    static uint32_t Hash(const GSCanonicalKey& key) { return key.fHash; }
 
-    // This should be made a hash table if performance is a problem.
-    static SkTDArray<GSCanonicalEntry>& CanonicalPaints();
+    static SkTDynamicHash<SkPDFGraphicState, GSCanonicalKey>& CanonicalPaints();
     static SkBaseMutex& CanonicalPaintsMutex();
 
     SkPDFGraphicState();
@@ -104,7 +108,7 @@ private:
 
     static SkPDFObject* GetInvertFunction();
 
-    static int Find(const SkPaint& paint);
+    static SkPDFGraphicState* Find(const SkPaint& paint);
     typedef SkPDFDict INHERITED;
 };
 
@@ -8,11 +8,15 @@
 #include "SkPDFImage.h"
 
 #include "SkBitmap.h"
+#include "SkBitmapHasher.h"
+#include "SkChecksum.h"
 #include "SkColor.h"
 #include "SkColorPriv.h"
 #include "SkData.h"
 #include "SkFlate.h"
+#include "SkMD5.h"
 #include "SkPDFCatalog.h"
+#include "SkPixelRef.h"
 #include "SkRect.h"
 #include "SkStream.h"
 #include "SkString.h"
@@ -436,6 +440,145 @@ static SkBitmap unpremultiply_bitmap(const SkBitmap& bitmap,
     return outBitmap;
 }
 
+// Returns true if data is an 8 bit baseline or progressive JPEG (which PDF
+// readers can decode), along with its size and number of color components.
+static bool parse_jpeg_header(const SkData* data, int* width, int* height,
+                              int* components) {
+    const uint8_t* bytes = data->bytes();
+    const size_t size = data->size();
+    if (size < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8) {
+        return false;
+    }
+    size_t offset = 2;
+    while (offset + 4 <= size) {
+        if (bytes[offset] != 0xFF) {
+            return false;
+        }
+        const uint8_t marker = bytes[offset + 1];
+        if (0xFF == marker) {
+            // Fill byte.
+            offset++;
+            continue;
+        }
+        if (0xD9 == marker || 0xDA == marker) {
+            // The image or its data started without a frame header.
+            return false;
+        }
+        if (marker >= 0xC0 && marker <= 0xCF &&
+                marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            // A start of frame.  Only the Huffman coded 8 bit ones are
+            // supported by DCTDecode.
+            if (marker > 0xC2 || offset + 10 > size) {
+                return false;
+            }
+            *height = (bytes[offset + 5] << 8) | bytes[offset + 6];
+            *width = (bytes[offset + 7] << 8) | bytes[offset + 8];
+            *components = bytes[offset + 9];
+            return 8 == bytes[offset + 4];
+        }
+        offset += 2 + ((bytes[offset + 2] << 8) | bytes[offset + 3]);
+    }
+    return false;
+}
+
+// If the whole bitmap was decoded from a JPEG that a PDF can embed as is,
+// returns the JPEG data (ref'd) and its number of color components.
+static SkData* ref_jpeg_data(const SkBitmap& bitmap, const SkIRect& srcRect,
+                             int* components) {
+    SkPixelRef* pixelRef = bitmap.pixelRef();
+    if (NULL == pixelRef || !bitmap.isOpaque() ||
+            bitmap.pixelRefOrigin() != SkIPoint::Make(0, 0) ||
+            srcRect != SkIRect::MakeWH(bitmap.width(), bitmap.height())) {
+        return NULL;
+    }
+    SkAutoTUnref<SkData> data(pixelRef->refEncodedData());
+    int width, height;
+    if (NULL == data.get() ||
+            !parse_jpeg_header(data, &width, &height, components) ||
+            width != bitmap.width() || height != bitmap.height() ||
+            (1 != *components && 3 != *components)) {
+        return NULL;
+    }
+    return data.detach();
+}
+
+static uint64_t digest_data(const SkData* data) {
+    SkMD5 md5;
+    md5.write(data->data(), data->size());
+    SkMD5::Digest digest;
+    md5.finish(digest);
+    uint64_t result;
+    memcpy(&result, digest.data, sizeof(result));
+    return result;
+}
+
+// Whether a and b, which have the same digest, draw the same pixels in srcRect.
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b,
+                        const SkIRect& srcRect) {
+    if (a.colorType() != b.colorType() || a.alphaType() != b.alphaType() ||
+            a.width() != b.width() || a.height() != b.height()) {
+        return false;
+    }
+    if (a.getGenerationID() == b.getGenerationID()) {
+        return true;
+    }
+
+    SkAutoLockPixels lockA(a), lockB(b);
+    if (NULL == a.getPixels() || NULL == b.getPixels()) {
+        return false;
+    }
+    if (kIndex_8_SkColorType == a.colorType()) {
+        const SkColorTable* ctA = a.getColorTable();
+        const SkColorTable* ctB = b.getColorTable();
+        if (NULL == ctA || NULL == ctB || ctA->count() != ctB->count()) {
+            return false;
+        }
+        for (int i = 0; i < ctA->count(); i++) {
+            if ((*ctA)[i] != (*ctB)[i]) {
+                return false;
+            }
+        }
+    }
+
+    SkIRect rect = srcRect;
+    if (!rect.intersect(SkIRect::MakeWH(a.width(), a.height()))) {
+        return true;
+    }
+    const size_t rowBytes = rect.width() * a.bytesPerPixel();
+    for (int y = rect.fTop; y < rect.fBottom; y++) {
+        if (0 != memcmp(a.getAddr(rect.fLeft, y), b.getAddr(rect.fLeft, y),
+                        rowBytes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// static
+SkPDFImage* SkPDFImage::FindCanonical(const CanonicalKey& key,
+                                      const SkBitmap& bitmap,
+                                      const SkData* jpeg) {
+    SkPDFImage* image;
+    {
+        SkAutoMutexAcquire lock(CanonicalImagesMutex());
+        image = CanonicalImages().find(key);
+        if (NULL == image) {
+            return NULL;
+        }
+        image->ref();
+    }
+    // The canonical image's sources never change, so they are compared
+    // without the lock held.
+    const bool same = NULL != jpeg
+            ? jpeg->equals(image->fCanonicalJPEG.get())
+            : same_pixels(bitmap, image->fCanonicalBitmap, key.fSrcRect);
+    if (!same) {
+        image->unref();
+        return NULL;
+    }
+    return image;
+}
+
 // static
 SkPDFImage* SkPDFImage::CreateImage(const SkBitmap& bitmap,
                                     const SkIRect& srcRect,
@@ -444,6 +587,65 @@ SkPDFImage* SkPDFImage::CreateImage(const SkBitmap& bitmap,
         return NULL;
     }
 
+    CanonicalKey key;
+    sk_bzero(&key, sizeof(key));  // The key is hashed and compared as bytes.
+    key.fSrcRect = srcRect;
+    key.fColorType = bitmap.colorType();
+    key.fEncoder = encoder;
+
+    int components = 0;
+    SkAutoTUnref<SkData> jpeg(ref_jpeg_data(bitmap, srcRect, &components));
+    bool haveDigest = true;
+    if (jpeg.get()) {
+        key.fIsJPEG = true;
+        key.fDigest = digest_data(jpeg);
+    } else {
+        haveDigest = SkBitmapHasher::ComputeFastDigest(bitmap, &key.fDigest);
+    }
+
+    if (haveDigest) {
+        SkPDFImage* image = FindCanonical(key, bitmap, jpeg);
+        if (image) {
+            return image;
+        }
+    }
+
+    // Images are made without the lock held, so another thread may make the
+    // same one; the first to be added wins.
+    SkPDFImage* image;
+    if (jpeg.get()) {
+        image = SkNEW_ARGS(SkPDFImage, (jpeg, bitmap.width(), bitmap.height(),
+                                        components));
+    } else {
+        image = MakeImage(bitmap, srcRect, encoder);
+    }
+    if (image && haveDigest) {
+        {
+            SkAutoMutexAcquire lock(CanonicalImagesMutex());
+            if (NULL == CanonicalImages().find(key)) {
+                image->fCanonicalKey = key;
+                image->fIsCanonical = true;
+                image->fCanonicalBitmap = bitmap;
+                image->fCanonicalJPEG.reset(SkSafeRef(jpeg.get()));
+                CanonicalImages().add(image);
+                return image;
+            }
+        }
+        // If the image already there differs from ours, ours is not shared.
+        SkPDFImage* canonical = FindCanonical(key, bitmap, jpeg);
+        if (canonical) {
+            image->unref();
+            return canonical;
+        }
+    }
+    return image;
+}
+
+// static
+SkPDFImage* SkPDFImage::MakeImage(const SkBitmap& bitmap,
+                                  const SkIRect& srcRect,
+                                  SkPicture::EncodeBitmap encoder) {
+
     bool isTransparent = false;
     SkAutoTUnref<SkStream> alphaData;
     if (!bitmap.isOpaque()) {
@@ -480,9 +682,34 @@ SkPDFImage* SkPDFImage::CreateImage(const SkBitmap& bitmap,
 }
 
 SkPDFImage::~SkPDFImage() {
+    if (fIsCanonical) {
+        SkAutoMutexAcquire lock(CanonicalImagesMutex());
+        SkASSERT(CanonicalImages().find(fCanonicalKey) == this);
+        CanonicalImages().remove(fCanonicalKey);
+    }
     fResources.unrefAll();
 }
 
+// static
+uint32_t SkPDFImage::Hash(const CanonicalKey& key) {
+    return SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(&key),
+                               sizeof(key));
+}
+
+// static
+SkTDynamicHash<SkPDFImage, SkPDFImage::CanonicalKey>&
+SkPDFImage::CanonicalImages() {
+    CanonicalImagesMutex().assertHeld();
+    static SkTDynamicHash<SkPDFImage, CanonicalKey> gCanonicalImages;
+    return gCanonicalImages;
+}
+
+// static
+SkBaseMutex& SkPDFImage::CanonicalImagesMutex() {
+    SK_DECLARE_STATIC_MUTEX(gCanonicalImagesMutex);
+    return gCanonicalImagesMutex;
+}
+
 SkPDFImage* SkPDFImage::addSMask(SkPDFImage* mask) {
     fResources.push(mask);
     mask->ref();
@@ -502,7 +729,8 @@ SkPDFImage::SkPDFImage(SkStream* stream,
                        SkPicture::EncodeBitmap encoder)
     : fIsAlpha(isAlpha),
       fSrcRect(srcRect),
-      fEncoder(encoder) {
+      fEncoder(encoder),
+      fIsCanonical(false) {
 
     if (bitmap.isImmutable()) {
         fBitmap = bitmap;
@@ -571,13 +799,33 @@ SkPDFImage::SkPDFImage(SkStream* stream,
     }
 }
 
+SkPDFImage::SkPDFImage(SkData* jpeg, int width, int height, int components)
+    : fIsAlpha(false),
+      fSrcRect(SkIRect::MakeWH(width, height)),
+      fEncoder(NULL),
+      fStreamValid(true),
+      fIsCanonical(false) {
+    setData(jpeg);
+
+    insertName("Type", "XObject");
+    insertName("Subtype", "Image");
+    insertInt("Width", width);
+    insertInt("Height", height);
+    insertName("ColorSpace", 1 == components ? "DeviceGray" : "DeviceRGB");
+    insertInt("BitsPerComponent", 8);
+    insertName("Filter", "DCTDecode");
+    insertInt("Length", jpeg->size());
+    setState(kCompressed_State);
+}
+
 SkPDFImage::SkPDFImage(SkPDFImage& pdfImage)
     : SkPDFStream(pdfImage),
       fBitmap(pdfImage.fBitmap),
       fIsAlpha(pdfImage.fIsAlpha),
       fSrcRect(pdfImage.fSrcRect),
       fEncoder(pdfImage.fEncoder),
-      fStreamValid(pdfImage.fStreamValid) {
+      fStreamValid(pdfImage.fStreamValid),
+      fIsCanonical(false) {
     // Nothing to do here - the image params are already copied in SkPDFStream's
     // constructor, and the bitmap will be regenerated and encoded in
     // populate.
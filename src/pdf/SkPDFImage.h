@@ -15,6 +15,8 @@
 #include "SkPDFStream.h"
 #include "SkPDFTypes.h"
 #include "SkRefCnt.h"
+#include "SkTDynamicHash.h"
+#include "SkThread.h"
 
 class SkBitmap;
 class SkPDFCatalog;
@@ -25,15 +27,18 @@ struct SkIRect;
     An image XObject.
 */
 
-// We could play the same trick here as is done in SkPDFGraphicState, storing
-// a copy of the Bitmap object (not the pixels), the pixel generation number,
-// and settings used from the paint to canonicalize image objects.
+// Like SkPDFGraphicState, image objects are canonicalized with a static weak
+// reference list, keyed on a digest of the pixels (or of the encoded data for
+// JPEG passthrough), so the same image drawn several times is embedded once.
 class SkPDFImage : public SkPDFStream {
 public:
-    /** Create a new Image XObject to represent the passed bitmap.
+    /** Create a new Image XObject to represent the passed bitmap, or return
+     *  (and ref) an existing one with the same content.  If the bitmap's
+     *  pixels were decoded from a JPEG that is used whole, the JPEG data is
+     *  embedded as is.
      *  @param bitmap   The image to encode.
      *  @param srcRect  The rectangle to cut out of bitmap.
-     *  @param paint    Used to calculate alpha, masks, etc.
+     *  @param encoder  A function used to encode the bitmap for compression.
      *  @return  The image XObject or NUll if there is nothing to draw for
      *           the given parameters.
      */
@@ -58,6 +63,32 @@ public:
                               SkTSet<SkPDFObject*>* newResourceObjects);
 
 private:
+    struct CanonicalKey {
+        uint64_t fDigest;
+        SkIRect fSrcRect;
+        int32_t fColorType;
+        int32_t fIsJPEG;
+        SkPicture::EncodeBitmap fEncoder;
+
+        bool operator==(const CanonicalKey& other) const {
+            return 0 == memcmp(this, &other, sizeof(*this));
+        }
+    };
+
+    friend class SkTDynamicHash<SkPDFImage, CanonicalKey>;
+    static const CanonicalKey& GetKey(const SkPDFImage& image) {
+        return image.fCanonicalKey;
+    }
+    static uint32_t Hash(const CanonicalKey& key);
+
+    static SkTDynamicHash<SkPDFImage, CanonicalKey>& CanonicalImages();
+    static SkBaseMutex& CanonicalImagesMutex();
+    // Returns the canonical image (ref'd) for key if it was made from the same
+    // pixels or JPEG data, else NULL.  Digests can collide.
+    static SkPDFImage* FindCanonical(const CanonicalKey& key,
+                                     const SkBitmap& bitmap,
+                                     const SkData* jpeg);
+
     SkBitmap fBitmap;
     bool fIsAlpha;
     SkIRect fSrcRect;
@@ -65,6 +96,11 @@ private:
     bool fStreamValid;
 
     SkTDArray<SkPDFObject*> fResources;
+    CanonicalKey fCanonicalKey;
+    bool fIsCanonical;
+    // What a canonical image was made from, to check digest matches against.
+    SkBitmap fCanonicalBitmap;
+    SkAutoTUnref<SkData> fCanonicalJPEG;
 
     /** Create a PDF image XObject. Entries for the image properties are
      *  automatically added to the stream dictionary.
@@ -83,6 +119,21 @@ private:
     SkPDFImage(SkStream* stream, const SkBitmap& bitmap, bool isAlpha,
                const SkIRect& srcRect, SkPicture::EncodeBitmap encoder);
 
+    /** Create a PDF image XObject that embeds JPEG data as is.
+     *  @param jpeg       The JPEG file data.
+     *  @param width      The width of the JPEG.
+     *  @param height     The height of the JPEG.
+     *  @param components The number of color components of the JPEG; 1 or 3.
+     */
+    SkPDFImage(SkData* jpeg, int width, int height, int components);
+
+    /** Create a new Image XObject for the bitmap, without looking for an
+     *  existing one.  @see CreateImage
+     */
+    static SkPDFImage* MakeImage(const SkBitmap& bitmap,
+                                 const SkIRect& srcRect,
+                                 SkPicture::EncodeBitmap encoder);
+
     /** Copy constructor, used to generate substitutes.
      *  @param image      The SkPDFImage to copy.
      */
@@ -15,7 +15,8 @@
 
 SkPDFPage::SkPDFPage(SkPDFDevice* content)
     : SkPDFDict("Page"),
-      fDevice(content) {
+      fDevice(content),
+      fFinalized(false) {
   SkSafeRef(content);
 }
 
@@ -25,7 +26,7 @@ void SkPDFPage::finalizePage(SkPDFCatalog* catalog, bool firstPage,
                              const SkTSet<SkPDFObject*>& knownResourceObjects,
                              SkTSet<SkPDFObject*>* newResourceObjects) {
     SkPDFResourceDict* resourceDict = fDevice->getResourceDict();
-    if (fContentStream.get() == NULL) {
+    if (!fFinalized) {
         insert("Resources", resourceDict);
         SkSafeUnref(this->insert("MediaBox", fDevice->copyMediaBox()));
         if (!SkToBool(catalog->getDocumentFlags() &
@@ -36,9 +37,9 @@ void SkPDFPage::finalizePage(SkPDFCatalog* catalog, bool firstPage,
             }
         }
 
-        SkAutoTUnref<SkStream> content(fDevice->content());
-        fContentStream.reset(new SkPDFStream(content.get()));
+        makeContentStream();
         insert("Contents", new SkPDFObjRef(fContentStream.get()))->unref();
+        fFinalized = true;
     }
     catalog->addObject(fContentStream.get(), firstPage);
     resourceDict->getReferencedResources(knownResourceObjects,
@@ -46,6 +47,18 @@ void SkPDFPage::finalizePage(SkPDFCatalog* catalog, bool firstPage,
                                          true);
 }
 
+void SkPDFPage::prepareToEmit(SkPDFCatalog* catalog) {
+    makeContentStream();
+    fContentStream->prepareToEmit(catalog);
+}
+
+void SkPDFPage::makeContentStream() {
+    if (fContentStream.get() == NULL) {
+        SkAutoTUnref<SkStream> content(fDevice->content());
+        fContentStream.reset(new SkPDFStream(content.get()));
+    }
+}
+
 off_t SkPDFPage::getPageSize(SkPDFCatalog* catalog, off_t fileOffset) {
     SkASSERT(fContentStream.get() != NULL);
     catalog->setFileOffset(fContentStream.get(), fileOffset);
@@ -57,6 +70,18 @@ void SkPDFPage::emitPage(SkWStream* stream, SkPDFCatalog* catalog) {
     fContentStream->emitObject(stream, catalog, true);
 }
 
+void SkPDFPage::emitStreamed(SkPDFCatalog* catalog) {
+    SkASSERT(fContentStream.get() != NULL);
+    catalog->emitStreamed(this);
+    catalog->emitStreamed(fContentStream.get());
+    catalog->forgetObject(fContentStream.get());
+
+    // Dropping the entries also breaks the cycle with the page tree.
+    this->clear();
+    fContentStream.reset(NULL);
+    fDevice.reset(NULL);
+}
+
 // static
 void SkPDFPage::GeneratePageTree(const SkTDArray<SkPDFPage*>& pages,
                                  SkPDFCatalog* catalog,
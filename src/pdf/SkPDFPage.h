@@ -51,6 +51,13 @@ public:
                       const SkTSet<SkPDFObject*>& knownResourceObjects,
                       SkTSet<SkPDFObject*>* newResourceObjects);
 
+    /** Build and compress the page content.  This only reads the device, so
+     *  pages can be prepared on several threads before they are finalized.
+     *  Optional: finalizePage() builds the content if it hasn't been.
+     *  @param catalog         The catalog the page will be emitted with.
+     */
+    virtual void prepareToEmit(SkPDFCatalog* catalog);
+
     /** Add destinations for this page to the supplied dictionary.
      *  @param dict       Dictionary to add destinations to.
      */
@@ -71,6 +78,15 @@ public:
      */
     void emitPage(SkWStream* stream, SkPDFCatalog* catalog);
 
+    /** For a streaming catalog: output the page and its content, then
+     *  release them.  The page must have been finalized and added to the
+     *  catalog, and stays there (as an empty dictionary) since the page tree
+     *  and destinations refer to it.  Only the object number of the page is
+     *  usable afterwards.
+     *  @param catalog    The active, streaming, object catalog.
+     */
+    void emitStreamed(SkPDFCatalog* catalog);
+
     /** Generate a page tree for the passed vector of pages.  New objects are
      *  added to the catalog.  The pageTree vector is populated with all of
      *  the 'Pages' dictionaries as well as the 'Page' objects.  Page trees
@@ -103,6 +119,10 @@ private:
 
     // Once the content is finalized, put it into a stream for output.
     SkAutoTUnref<SkPDFStream> fContentStream;
+    bool fFinalized;
+
+    void makeContentStream();
+
     typedef SkPDFDict INHERITED;
 };
 
@@ -9,7 +9,9 @@
 
 #include "SkPDFShader.h"
 
+#include "SkChecksum.h"
 #include "SkData.h"
+#include "SkFloatBits.h"
 #include "SkPDFCatalog.h"
 #include "SkPDFDevice.h"
 #include "SkPDFFormXObject.h"
@@ -486,6 +488,8 @@ public:
           const SkIRect& bbox);
 
     bool operator==(const State& b) const;
+    // Hash of the fields operator== compares.
+    uint32_t hash() const;
 
     SkPDFShader::State* CreateAlphaToLuminosityState() const;
     SkPDFShader::State* CreateOpaqueState() const;
@@ -504,7 +508,7 @@ public:
     explicit SkPDFFunctionShader(SkPDFShader::State* state);
     virtual ~SkPDFFunctionShader() {
         if (isValid()) {
-            RemoveShader(this);
+            RemoveShader(this, fState.get());
         }
         fResources.unrefAll();
     }
@@ -538,7 +542,7 @@ public:
     explicit SkPDFAlphaFunctionShader(SkPDFShader::State* state);
     virtual ~SkPDFAlphaFunctionShader() {
         if (isValid()) {
-            RemoveShader(this);
+            RemoveShader(this, fState.get());
         }
     }
 
@@ -567,7 +571,7 @@ public:
     explicit SkPDFImageShader(SkPDFShader::State* state);
     virtual ~SkPDFImageShader() {
         if (isValid()) {
-            RemoveShader(this);
+            RemoveShader(this, fState.get());
         }
         fResources.unrefAll();
     }
@@ -603,15 +607,17 @@ SkPDFObject* SkPDFShader::GetPDFShaderByState(State* inState) {
     }
 
     ShaderCanonicalEntry entry(NULL, shaderState.get());
-    int index = CanonicalShaders().find(entry);
-    if (index >= 0) {
-        result = CanonicalShaders()[index].fPDFShader;
+    ShaderCanonicalEntry* found = CanonicalShaders().find(entry);
+    if (found) {
+        result = found->fPDFShader;
         result->ref();
         return result;
     }
 
     bool valid = false;
-    // The PDFShader takes ownership of the shaderSate.
+    // The PDFShader takes ownership of the shaderSate, which stays the
+    // canonical entry's key while the shader lives.
+    const State* state = shaderState.get();
     if (shaderState.get()->fType == SkShader::kNone_GradientType) {
         SkPDFImageShader* imageShader =
             new SkPDFImageShader(shaderState.detach());
@@ -634,18 +640,18 @@ SkPDFObject* SkPDFShader::GetPDFShaderByState(State* inState) {
         delete result;
         return NULL;
     }
-    entry.fPDFShader = result;
-    CanonicalShaders().push(entry);
+    CanonicalShaders().add(SkNEW_ARGS(ShaderCanonicalEntry, (result, state)));
     return result;  // return the reference that came from new.
 }
 
 // static
-void SkPDFShader::RemoveShader(SkPDFObject* shader) {
+void SkPDFShader::RemoveShader(SkPDFObject* shader, const State* state) {
     SkAutoMutexAcquire lock(CanonicalShadersMutex());
-    ShaderCanonicalEntry entry(shader, NULL);
-    int index = CanonicalShaders().find(entry);
-    SkASSERT(index >= 0);
-    CanonicalShaders().removeShuffle(index);
+    ShaderCanonicalEntry entry(shader, state);
+    ShaderCanonicalEntry* found = CanonicalShaders().find(entry);
+    SkASSERT(found && found->fPDFShader == shader);
+    CanonicalShaders().remove(entry);
+    SkDELETE(found);
 }
 
 // static
@@ -658,9 +664,9 @@ SkPDFObject* SkPDFShader::GetPDFShader(const SkShader& shader,
 }
 
 // static
-SkTDArray<SkPDFShader::ShaderCanonicalEntry>& SkPDFShader::CanonicalShaders() {
+SkPDFShader::ShaderHash& SkPDFShader::CanonicalShaders() {
     // This initialization is only thread safe with gcc.
-    static SkTDArray<ShaderCanonicalEntry> gCanonicalShaders;
+    static ShaderHash gCanonicalShaders;
     return gCanonicalShaders;
 }
 
@@ -1176,7 +1182,8 @@ SkPDFStream* SkPDFFunctionShader::makePSFunction(const SkString& psCode,
 SkPDFShader::ShaderCanonicalEntry::ShaderCanonicalEntry(SkPDFObject* pdfShader,
                                                         const State* state)
     : fPDFShader(pdfShader),
-      fState(state) {
+      fState(state),
+      fHash(state->hash()) {
 }
 
 bool SkPDFShader::ShaderCanonicalEntry::operator==(
@@ -1185,6 +1192,44 @@ bool SkPDFShader::ShaderCanonicalEntry::operator==(
            (fState != NULL && b.fState != NULL && *fState == *b.fState);
 }
 
+// Scalars that compare equal must hash the same, but 0 and -0 have different
+// bits; adding 0 turns -0 into 0.
+static void append_scalar(SkScalar value, SkTDArray<uint32_t>* words) {
+    *words->append() = SkFloat2Bits(SkScalarToFloat(value) + 0.0f);
+}
+
+static void append_matrix(const SkMatrix& matrix, SkTDArray<uint32_t>* words) {
+    for (int i = 0; i < 9; i++) {
+        append_scalar(matrix[i], words);
+    }
+}
+
+uint32_t SkPDFShader::State::hash() const {
+    SkTDArray<uint32_t> words;
+    *words.append() = fType;
+    words.append(4, reinterpret_cast<const uint32_t*>(&fBBox));
+    append_matrix(fCanvasTransform, &words);
+    append_matrix(fShaderTransform, &words);
+
+    if (fType == SkShader::kNone_GradientType) {
+        *words.append() = fPixelGeneration;
+        *words.append() = fImageTileModes[0];
+        *words.append() = fImageTileModes[1];
+    } else {
+        // Colors and offsets are compared bitwise, so they hash as they are.
+        *words.append() = fInfo.fColorCount;
+        words.append(fInfo.fColorCount, fInfo.fColors);
+        words.append(fInfo.fColorCount,
+                     reinterpret_cast<const uint32_t*>(fInfo.fColorOffsets));
+        *words.append() = fInfo.fTileMode;
+        append_scalar(fInfo.fPoint[0].fX, &words);
+        append_scalar(fInfo.fPoint[0].fY, &words);
+        // operator== ignores the other points and radii for some types,
+        // so they are left out here.
+    }
+    return SkChecksum::Murmur3(words.begin(), words.count() * sizeof(uint32_t));
+}
+
 bool SkPDFShader::State::operator==(const SkPDFShader::State& b) const {
     if (fType != b.fType ||
             fCanvasTransform != b.fCanvasTransform ||
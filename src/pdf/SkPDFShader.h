@@ -15,6 +15,7 @@
 #include "SkMatrix.h"
 #include "SkRefCnt.h"
 #include "SkShader.h"
+#include "SkTDynamicHash.h"
 
 class SkObjRef;
 class SkPDFCatalog;
@@ -53,16 +54,25 @@ protected:
 
         SkPDFObject* fPDFShader;
         const State* fState;
+        uint32_t fHash;  // of *fState
+
+        // Entries are their own keys in CanonicalShaders().
+        static const ShaderCanonicalEntry& GetKey(const ShaderCanonicalEntry& entry) {
+            return entry;
+        }
+        static uint32_t Hash(const ShaderCanonicalEntry& entry) {
+            return entry.fHash;
+        }
     };
-    // This should be made a hash table if performance is a problem.
-    static SkTDArray<ShaderCanonicalEntry>& CanonicalShaders();
+    typedef SkTDynamicHash<ShaderCanonicalEntry, ShaderCanonicalEntry> ShaderHash;
+    static ShaderHash& CanonicalShaders();
     static SkBaseMutex& CanonicalShadersMutex();
 
     // This is an internal method.
     // CanonicalShadersMutex() should already be acquired.
     // This also takes ownership of shaderState.
     static SkPDFObject* GetPDFShaderByState(State* shaderState);
-    static void RemoveShader(SkPDFObject* shader);
+    static void RemoveShader(SkPDFObject* shader, const State* state);
 
     SkPDFShader();
     virtual ~SkPDFShader() {};
@@ -12,12 +12,36 @@
 #include "SkPDFCatalog.h"
 #include "SkPDFStream.h"
 #include "SkStream.h"
+#include "SkTLS.h"
 
 static bool skip_compression(SkPDFCatalog* catalog) {
     return SkToBool(catalog->getDocumentFlags() &
                     SkPDFDocument::kFavorSpeedOverSize_Flags);
 }
 
+// Documents hold many small streams, so each thread keeps one deflater
+// rather than setting up zlib for every stream.
+static void* create_deflater() {
+    return SkNEW(SkDeflateWStream);
+}
+
+static void delete_deflater(void* deflater) {
+    SkDELETE(static_cast<SkDeflateWStream*>(deflater));
+}
+
+static bool deflate_stream(SkStream* src, SkWStream* dst) {
+    SkDeflateWStream* deflater = static_cast<SkDeflateWStream*>(
+            SkTLS::Get(create_deflater, delete_deflater));
+    deflater->reset(dst);
+    const size_t length = src->getLength();
+    const void* base = src->getMemoryBase();
+    bool ok = NULL != base ? deflater->write(base, length)
+                           : deflater->writeStream(src, length);
+    ok = deflater->finish() && ok;
+    src->rewind();
+    return ok;
+}
+
 SkPDFStream::SkPDFStream(SkStream* stream) : fState(kUnused_State) {
     setData(stream);
 }
@@ -78,6 +102,14 @@ size_t SkPDFStream::getOutputSize(SkPDFCatalog* catalog, bool indirect) {
         strlen(" stream\n\nendstream") + fData->getLength();
 }
 
+void SkPDFStream::prepareToEmit(SkPDFCatalog* catalog) {
+    // Only the first population is self contained; a later one may add a
+    // substitute to the catalog.
+    if (fState == kUnused_State) {
+        this->populate(catalog);
+    }
+}
+
 SkPDFStream::SkPDFStream() : fState(kUnused_State) {}
 
 void SkPDFStream::setData(SkData* data) {
@@ -101,7 +133,7 @@ bool SkPDFStream::populate(SkPDFCatalog* catalog) {
         if (!skip_compression(catalog) && SkFlate::HaveFlate()) {
             SkDynamicMemoryWStream compressedData;
 
-            SkAssertResult(SkFlate::Deflate(fData.get(), &compressedData));
+            SkAssertResult(deflate_stream(fData.get(), &compressedData));
             if (compressedData.getOffset() < fData->getLength()) {
                 SkMemoryStream* stream = new SkMemoryStream;
                 stream->setData(compressedData.copyToData())->unref();
@@ -45,6 +45,7 @@ public:
     virtual void emitObject(SkWStream* stream, SkPDFCatalog* catalog,
                             bool indirect);
     virtual size_t getOutputSize(SkPDFCatalog* catalog, bool indirect);
+    virtual void prepareToEmit(SkPDFCatalog* catalog);
 
 protected:
     enum State {
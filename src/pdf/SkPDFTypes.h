@@ -50,6 +50,14 @@ public:
     virtual void getResources(const SkTSet<SkPDFObject*>& knownResourceObjects,
                               SkTSet<SkPDFObject*>* newResourceObjects);
 
+    /** Do the part of getting this object ready for output that only
+     *  involves the object itself, such as compressing a stream, so that it
+     *  can be done on another thread before the object is sized or emitted.
+     *  It must only read the catalog, and is a no-op for most objects.
+     *  @param catalog  The object catalog to use.
+     */
+    virtual void prepareToEmit(SkPDFCatalog* catalog) {}
+
     /** Emit this object unless the catalog has a substitute object, in which
      *  case emit that.
      *  @see emitObject
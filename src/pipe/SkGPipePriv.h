@@ -76,6 +76,8 @@ enum DrawOps {
     kDef_Flattenable_DrawOp,
     kDef_Bitmap_DrawOp,
     kDef_Factory_DrawOp,
+    kDef_SharedBitmap_DrawOp,
+    kEvict_Flattenable_DrawOp,
 
     // these are signals to playback, not drawing verbs
     kReportFlags_DrawOp,
@@ -157,6 +159,14 @@ enum {
 enum {
     kClip_HasAntiAlias_DrawOpFlag = 1 << 0,
 };
+enum {
+    // The serialized typeface carries font data, to be kept in the reader's
+    // SkFontDataCache until it is purged.
+    kDefTypeface_PinFontData_DrawOpFlag = 1 << 0,
+    // Only the font descriptor is sent, followed by the SkFontDataCache::ID
+    // of font data sent earlier.
+    kDefTypeface_FontDataID_DrawOpFlag  = 1 << 1,
+};
 ///////////////////////////////////////////////////////////////////////////////
 
 class BitmapInfo : SkNoncopyable {
@@ -12,12 +12,16 @@
 #include "SkPaint.h"
 #include "SkGPipe.h"
 #include "SkGPipePriv.h"
+#include "SkGPipeSharedPixels.h"
 #include "SkReader32.h"
 #include "SkStream.h"
 
 #include "SkAnnotation.h"
 #include "SkColorFilter.h"
+#include "SkData.h"
 #include "SkDrawLooper.h"
+#include "SkFontDataCache.h"
+#include "SkFontDescriptor.h"
 #include "SkImageFilter.h"
 #include "SkMaskFilter.h"
 #include "SkReadBuffer.h"
@@ -94,6 +98,14 @@ public:
         return !fSilent;
     }
 
+    /**
+     *  Whether the stream referred to something this reader doesn't have, such as shared font
+     *  data that was never sent to this process. The reader must then be replaced.
+     */
+    bool failed() const {
+        return fFailed;
+    }
+
     void setFlags(unsigned flags) {
         if (fFlags != flags) {
             fFlags = flags;
@@ -131,6 +143,18 @@ public:
         }
     }
 
+    /**
+     * Drop a flattenable the writer has evicted. Its index may be defined
+     * again later. Paints that use it keep their own ref.
+     */
+    void evictFlattenable(int index) {
+        index--;
+        if (index >= 0 && index < fFlatArray.count()) {
+            SkSafeUnref(fFlatArray[index]);
+            fFlatArray[index] = NULL;
+        }
+    }
+
     void defFactory(const char* name) {
         SkFlattenable::Factory factory = SkFlattenable::NameToFactory(name);
         if (factory) {
@@ -155,6 +179,33 @@ public:
         fReader->readBitmap(bm);
     }
 
+    /**
+     * Add or replace a bitmap whose pixels the writer put in shared memory.
+     * Like addBitmap(), only used in cross process mode.
+     */
+    void addSharedBitmap(int index, SkReader32* reader) {
+        SkASSERT(shouldFlattenBitmaps(fFlags));
+        int width = reader->readInt();
+        int height = reader->readInt();
+        SkColorType colorType = (SkColorType)reader->readInt();
+        SkAlphaType alphaType = (SkAlphaType)reader->readInt();
+        size_t rowBytes = reader->readU32();
+        const char* name = reader->readString();
+
+        SkBitmap* bm;
+        if (fBitmaps.count() == index) {
+            bm = SkNEW(SkBitmap);
+            *fBitmaps.append() = bm;
+        } else {
+            bm = fBitmaps[index];
+        }
+        SkImageInfo info = SkImageInfo::Make(width, height, colorType, alphaType);
+        if (!SkGPipeSharedPixels::Map(name, info, rowBytes, bm)) {
+            SkDebugf("SkGPipe: could not map the shared pixels of bitmap %d\n", index);
+            bm->reset();
+        }
+    }
+
     /**
      * Override of SkBitmapHeapReader, so that SkReadBuffer can use
      * these SkBitmaps for bitmap shaders. Used only in cross process mode
@@ -185,11 +236,34 @@ public:
         return fSharedHeap;
     }
 
-    void addTypeface() {
+    void addTypeface(unsigned flags) {
         size_t size = fReader->read32();
         const void* data = fReader->skip(SkAlign4(size));
         SkMemoryStream stream(data, size, false);
-        *fTypefaces.append() = SkTypeface::Deserialize(&stream);
+        SkTypeface* face = NULL;
+        if (flags & kDefTypeface_FontDataID_DrawOpFlag) {
+            SkFontDataCache::ID id;
+            memcpy(&id, fReader->skip(sizeof(id)), sizeof(id));
+            face = SkFontDataCache::Find(id);
+            if (NULL == face) {
+                // The data was purged while the writer still counted on it. A font found by
+                // name would draw the wrong glyphs, so stop instead.
+                fFailed = true;
+            }
+        } else if (flags & kDefTypeface_PinFontData_DrawOpFlag) {
+            SkFontDescriptor desc(&stream);
+            size_t length = stream.readPackedUInt();
+            if (length > 0 && length <= stream.getLength() - stream.getPosition()) {
+                SkAutoDataUnref fontData(SkData::NewWithCopy(stream.getAtPos(), length));
+                face = SkFontDataCache::FindOrCreate(fontData, true);
+            }
+            if (NULL == face) {
+                face = SkTypeface::CreateFromName(desc.getFamilyName(), desc.getStyle());
+            }
+        } else {
+            face = SkTypeface::Deserialize(&stream);
+        }
+        *fTypefaces.append() = face;
     }
 
     void setTypeface(SkPaint* paint, unsigned id) {
@@ -223,6 +297,7 @@ private:
     SkTDArray<SkFlattenable::Factory> fFactoryArray;
     SkTDArray<SkBitmap*>      fBitmaps;
     bool                      fSilent;
+    bool                      fFailed;
     // Only used when sharing bitmaps with the writer.
     SkBitmapHeap*             fSharedHeap;
     unsigned                  fFlags;
@@ -715,8 +790,8 @@ static void annotation_rp(SkCanvas*, SkReader32* reader, uint32_t op32,
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static void def_Typeface_rp(SkCanvas*, SkReader32*, uint32_t, SkGPipeState* state) {
-    state->addTypeface();
+static void def_Typeface_rp(SkCanvas*, SkReader32*, uint32_t op32, SkGPipeState* state) {
+    state->addTypeface(DrawOp_unpackFlags(op32));
 }
 
 static void def_PaintFlat_rp(SkCanvas*, SkReader32*, uint32_t op32,
@@ -726,6 +801,11 @@ static void def_PaintFlat_rp(SkCanvas*, SkReader32*, uint32_t op32,
     state->defFlattenable(pf, index);
 }
 
+static void evict_PaintFlat_rp(SkCanvas*, SkReader32*, uint32_t op32,
+                               SkGPipeState* state) {
+    state->evictFlattenable(DrawOp_unpackData(op32));
+}
+
 static void def_Bitmap_rp(SkCanvas*, SkReader32*, uint32_t op32,
                           SkGPipeState* state) {
     unsigned index = DrawOp_unpackData(op32);
@@ -737,6 +817,12 @@ static void def_Factory_rp(SkCanvas*, SkReader32* reader, uint32_t,
     state->defFactory(reader->readString());
 }
 
+static void def_SharedBitmap_rp(SkCanvas*, SkReader32* reader, uint32_t op32,
+                                SkGPipeState* state) {
+    unsigned index = DrawOp_unpackData(op32);
+    state->addSharedBitmap(index, reader);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static void skip_rp(SkCanvas*, SkReader32* reader, uint32_t op32, SkGPipeState*) {
@@ -746,7 +832,8 @@ static void skip_rp(SkCanvas*, SkReader32* reader, uint32_t op32, SkGPipeState*)
 
 static void reportFlags_rp(SkCanvas*, SkReader32*, uint32_t op32,
                            SkGPipeState* state) {
-    unsigned flags = DrawOp_unpackFlags(op32);
+    // The flags don't fit in the op's flag bits, so they are sent as its data.
+    unsigned flags = DrawOp_unpackData(op32);
     state->setFlags(flags);
 }
 
@@ -803,6 +890,8 @@ static const ReadProc gReadTable[] = {
     def_PaintFlat_rp,
     def_Bitmap_rp,
     def_Factory_rp,
+    def_SharedBitmap_rp,
+    evict_PaintFlat_rp,
 
     reportFlags_rp,
     shareBitmapHeap_rp,
@@ -814,6 +903,7 @@ static const ReadProc gReadTable[] = {
 SkGPipeState::SkGPipeState()
     : fReader(0)
     , fSilent(false)
+    , fFailed(false)
     , fSharedHeap(NULL)
     , fFlags(0) {
 
@@ -852,6 +942,10 @@ SkGPipeReader::~SkGPipeReader() {
     delete fState;
 }
 
+void SkGPipeReader::PurgeSharedFonts() {
+    SkFontDataCache::Purge();
+}
+
 SkGPipeReader::Status SkGPipeReader::playback(const void* data, size_t length,
                                               uint32_t playbackFlags, size_t* bytesRead) {
     if (NULL == fCanvas) {
@@ -860,6 +954,8 @@ SkGPipeReader::Status SkGPipeReader::playback(const void* data, size_t length,
 
     if (NULL == fState) {
         fState = new SkGPipeState;
+    } else if (fState->failed()) {
+        return kError_Status;
     }
 
     fState->setSilent(playbackFlags & kSilent_PlaybackFlag);
@@ -888,10 +984,15 @@ SkGPipeReader::Status SkGPipeReader::playback(const void* data, size_t length,
             break;
         }
         table[op](canvas, reader.getReader32(), op32, fState);
+        if (fState->failed()) {
+            status = kError_Status;
+            break;
+        }
         if ((playbackFlags & kReadAtom_PlaybackFlag) &&
             (table[op] != paintOp_rp &&
              table[op] != def_Typeface_rp &&
              table[op] != def_PaintFlat_rp &&
+             table[op] != evict_PaintFlat_rp &&
              table[op] != def_Bitmap_rp
              )) {
                 status = kReadAtom_Status;
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGPipeSharedPixels.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+
+#include "SkMallocPixelRef.h"
+#include "SkThread.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// The count of processes that still have to open the segment comes first. The pixels follow,
+// aligned as well as any pixels.
+static const size_t kHeaderSize = 16;
+
+static int32_t* pending_opens(void* base) {
+    return static_cast<int32_t*>(base);
+}
+
+// Drops one count on the segment mapped at 'base', unlinking its name with the last one.
+static void release_open(void* base, const char name[]) {
+    if (1 == sk_atomic_dec(pending_opens(base))) {
+        shm_unlink(name);
+    }
+}
+
+static void unmap_segment(void* addr, void* context) {
+    munmap(static_cast<char*>(addr) - kHeaderSize, reinterpret_cast<size_t>(context));
+}
+
+bool SkGPipeSharedPixels::Share(const SkBitmap& bitmap, int readerCount, SkString* name) {
+    if (kIndex_8_SkColorType == bitmap.colorType() || bitmap.empty()) {
+        return false;
+    }
+    SkAutoLockPixels alp(bitmap);
+    if (NULL == bitmap.getPixels()) {
+        return false;
+    }
+
+    static int32_t gNextSegmentID;
+    name->printf("/skgpipe-%d-%d", (int) getpid(), sk_atomic_inc(&gNextSegmentID));
+
+    const size_t size = kHeaderSize + bitmap.getSize();
+    int fd = shm_open(name->c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        return false;
+    }
+    void* base = MAP_FAILED;
+    if (0 == ftruncate(fd, size)) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (MAP_FAILED == base) {
+        shm_unlink(name->c_str());
+        return false;
+    }
+
+    *pending_opens(base) = readerCount + 1;
+    memcpy(static_cast<char*>(base) + kHeaderSize, bitmap.getPixels(), bitmap.getSize());
+    munmap(base, size);
+    return true;
+}
+
+void SkGPipeSharedPixels::Release(const char name[]) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return;
+    }
+    void* base = mmap(NULL, kHeaderSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED != base) {
+        release_open(base, name);
+        munmap(base, kHeaderSize);
+    }
+}
+
+void SkGPipeSharedPixels::Discard(const char name[]) {
+    shm_unlink(name);
+}
+
+bool SkGPipeSharedPixels::Map(const char name[], const SkImageInfo& info, size_t rowBytes,
+                              SkBitmap* bitmap) {
+    if (kIndex_8_SkColorType == info.colorType() || rowBytes < info.minRowBytes()) {
+        return false;
+    }
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return false;
+    }
+    // Don't trust the stream with the size of the mapping.
+    const size_t size = kHeaderSize + info.height() * rowBytes;
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (0 == fstat(fd, &st) && st.st_size >= 0 && (size_t) st.st_size >= size) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (MAP_FAILED == base) {
+        return false;
+    }
+    release_open(base, name);
+
+    SkAutoTUnref<SkMallocPixelRef> pr(SkMallocPixelRef::NewWithProc(
+            info, rowBytes, NULL, static_cast<char*>(base) + kHeaderSize,
+            unmap_segment, reinterpret_cast<void*>(size)));
+    if (NULL == pr.get()) {
+        munmap(base, size);
+        return false;
+    }
+    bitmap->setInfo(info, rowBytes);
+    bitmap->setPixelRef(pr);
+    bitmap->setImmutable();
+    return true;
+}
+
+#else
+
+bool SkGPipeSharedPixels::Share(const SkBitmap&, int, SkString*) {
+    return false;
+}
+
+void SkGPipeSharedPixels::Release(const char[]) {}
+
+void SkGPipeSharedPixels::Discard(const char[]) {}
+
+bool SkGPipeSharedPixels::Map(const char[], const SkImageInfo&, size_t, SkBitmap*) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGPipeSharedPixels_DEFINED
+#define SkGPipeSharedPixels_DEFINED
+
+#include "SkBitmap.h"
+#include "SkString.h"
+
+/**
+ *  Puts the pixels of bitmaps sent through a cross process pipe in named shared memory, so that
+ *  each reader maps the writer's copy instead of receiving the pixels in the stream and
+ *  allocating a copy of its own.
+ *
+ *  A segment starts with a count of the processes that still have to open it. The writer sets
+ *  it to the number of readers plus one for itself. Each reader drops one when it has mapped
+ *  the pixels, the writer drops its own when it no longer refers to the segment, and whoever
+ *  drops the last one unlinks the name. The pixels stay valid until the last mapping is gone.
+ *
+ *  Only available where POSIX shared memory is; elsewhere Share() fails and the writer falls
+ *  back to flattening the bitmap.
+ */
+class SkGPipeSharedPixels {
+public:
+    /**
+     *  Copies the pixels of 'bitmap' into a new segment that 'readerCount' readers will open,
+     *  and returns its name in 'name'. Returns false if the bitmap has no pixels, or pixels
+     *  that can't be shared (e.g. they need a color table), or no segment could be made.
+     */
+    static bool Share(const SkBitmap& bitmap, int readerCount, SkString* name);
+
+    /**
+     *  Drops the writer's count on the segment called 'name'.
+     */
+    static void Release(const char name[]);
+
+    /**
+     *  Unlinks the segment called 'name' regardless of its count, for when the readers will
+     *  never hear of it.
+     */
+    static void Discard(const char name[]);
+
+    /**
+     *  Maps the segment called 'name', which must hold pixels described by 'info' and
+     *  'rowBytes', and makes 'bitmap' use them. Drops this reader's count on the segment.
+     */
+    static bool Map(const char name[], const SkImageInfo& info, size_t rowBytes,
+                    SkBitmap* bitmap);
+};
+
+#endif
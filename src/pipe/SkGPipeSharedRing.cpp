@@ -0,0 +1,325 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGPipeSharedRing.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+
+#include "SkMath.h"
+#include "SkThread.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+    #include <limits.h>
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #define SK_GPIPE_RING_USE_FUTEX
+#endif
+
+/**
+ *  Positions in the ring count the bytes that have gone through it, wrapping at 2^32; the
+ *  capacity is a power of two, so a position's offset in the ring survives the wrap. The
+ *  fields each process writes are kept on their own cache line.
+ */
+struct SkGPipeSharedRingHeader {
+    // Written by the writer.
+    int32_t fCapacity;
+    int32_t fWritten;       // Position up to which commands are ready.
+    int32_t fPadStart;      // Position where the unused end of the ring starts, or 0.
+    int32_t fWriterClosed;
+    int32_t fWriterWaiting;
+    int32_t fReaderWake;    // Bumped to wake the reader.
+    char    fWriterPad[40];
+
+    // Written by the reader.
+    int32_t fRead;          // Position up to which the space is free again.
+    int32_t fReaderClosed;
+    int32_t fReaderWaiting;
+    int32_t fWriterWake;    // Bumped to wake the writer.
+    char    fReaderPad[48];
+};
+
+static const size_t kHeaderSize = sizeof(SkGPipeSharedRingHeader);
+SK_COMPILE_ASSERT(128 == sizeof(SkGPipeSharedRingHeader), ring_header_size);
+
+// Room for a few of the writer's smallest blocks.
+static const size_t kMinCapacity = 64 * 1024;
+
+static char* ring_data(SkGPipeSharedRingHeader* header) {
+    return reinterpret_cast<char*>(header) + kHeaderSize;
+}
+
+static uint32_t load(int32_t* field) {
+    return static_cast<uint32_t>(sk_acquire_load(field));
+}
+
+#ifdef SK_GPIPE_RING_USE_FUTEX
+static void wait_for_change(int32_t* addr, int32_t value) {
+    syscall(SYS_futex, addr, FUTEX_WAIT, value, NULL, NULL, 0);
+}
+
+static void wake_all(int32_t* addr) {
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+#else
+static void wait_for_change(int32_t*, int32_t) {
+    usleep(50);
+}
+
+static void wake_all(int32_t*) {}
+#endif
+
+typedef bool (*ReadyProc)(SkGPipeSharedRingHeader*, uint32_t arg);
+
+/**
+ *  Waits until ready() holds. The waiter samples 'wake' before it announces itself in
+ *  'waiting' and checks again, and the other side changes its state with a full barrier before
+ *  it looks at 'waiting', so a change is either seen by the check or bumps 'wake' in time.
+ */
+static void wait_until(ReadyProc ready, SkGPipeSharedRingHeader* header, uint32_t arg,
+                       int32_t* waiting, int32_t* wake) {
+    while (!ready(header, arg)) {
+        const int32_t seen = sk_acquire_load(wake);
+        sk_atomic_inc(waiting);
+        if (!ready(header, arg)) {
+            wait_for_change(wake, seen);
+        }
+        sk_atomic_dec(waiting);
+    }
+}
+
+// Called after a change made with an atomic operation.
+static void signal(int32_t* waiting, int32_t* wake) {
+    if (sk_acquire_load(waiting) > 0) {
+        sk_atomic_inc(wake);
+        wake_all(wake);
+    }
+}
+
+static bool has_room(SkGPipeSharedRingHeader* header, uint32_t bytes) {
+    const uint32_t used = load(&header->fWritten) - load(&header->fRead);
+    return static_cast<uint32_t>(header->fCapacity) - used >= bytes ||
+           0 != load(&header->fReaderClosed);
+}
+
+static bool has_data(SkGPipeSharedRingHeader* header, uint32_t read) {
+    return load(&header->fWritten) != read || 0 != load(&header->fWriterClosed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkGPipeSharedRingController* SkGPipeSharedRingController::Create(size_t capacity) {
+    if (capacity > (1 << 30)) {
+        return NULL;
+    }
+    capacity = SkNextPow2(SkTMax(SkToInt(capacity), SkToInt(kMinCapacity)));
+
+    static int32_t gNextRingID;
+    SkString name;
+    name.printf("/skgpipe-ring-%d-%d", (int) getpid(), sk_atomic_inc(&gNextRingID));
+
+    const size_t size = kHeaderSize + capacity;
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        return NULL;
+    }
+    void* base = MAP_FAILED;
+    if (0 == ftruncate(fd, size)) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (MAP_FAILED == base) {
+        shm_unlink(name.c_str());
+        return NULL;
+    }
+
+    // ftruncate() zeroed the segment.
+    SkGPipeSharedRingHeader* header = static_cast<SkGPipeSharedRingHeader*>(base);
+    header->fCapacity = SkToS32(capacity);
+    return SkNEW_ARGS(SkGPipeSharedRingController, (header, size, name));
+}
+
+SkGPipeSharedRingController::SkGPipeSharedRingController(SkGPipeSharedRingHeader* header,
+                                                         size_t mappedSize,
+                                                         const SkString& name)
+    : fHeader(header)
+    , fMappedSize(mappedSize)
+    , fName(name) {
+}
+
+SkGPipeSharedRingController::~SkGPipeSharedRingController() {
+    sk_atomic_inc(&fHeader->fWriterClosed);
+    signal(&fHeader->fReaderWaiting, &fHeader->fReaderWake);
+    munmap(fHeader, fMappedSize);
+    // In case the reader never opened the ring.
+    shm_unlink(fName.c_str());
+}
+
+void* SkGPipeSharedRingController::requestBlock(size_t minRequest, size_t* actual) {
+    SkASSERT(SkIsAlign4(minRequest));
+    const uint32_t capacity = fHeader->fCapacity;
+    // Larger blocks might never fit next to what the reader has yet to consume.
+    if (minRequest > capacity / 2) {
+        return NULL;
+    }
+
+    // Only this side changes fWritten.
+    uint32_t written = fHeader->fWritten;
+    uint32_t offset = written & (capacity - 1);
+    const uint32_t toEnd = capacity - offset;
+    const bool wrap = toEnd < minRequest;
+    wait_until(has_room, fHeader, wrap ? toEnd + SkToU32(minRequest) : SkToU32(minRequest),
+               &fHeader->fWriterWaiting, &fHeader->fWriterWake);
+    if (0 != load(&fHeader->fReaderClosed)) {
+        return NULL;
+    }
+
+    if (wrap) {
+        // The reader skips from fPadStart to the start of the ring.
+        fHeader->fPadStart = written;
+        sk_atomic_add(&fHeader->fWritten, toEnd);
+        signal(&fHeader->fReaderWaiting, &fHeader->fReaderWake);
+        written += toEnd;
+        offset = 0;
+    }
+
+    const uint32_t room = capacity - (written - load(&fHeader->fRead));
+    *actual = SkTMin(room, capacity - offset);
+    SkASSERT(*actual >= minRequest);
+    return ring_data(fHeader) + offset;
+}
+
+void SkGPipeSharedRingController::notifyWritten(size_t bytes) {
+    SkASSERT(SkIsAlign4(bytes));
+    if (0 == bytes) {
+        sk_atomic_inc(&fHeader->fWriterClosed);
+    } else {
+        sk_atomic_add(&fHeader->fWritten, SkToS32(bytes));
+    }
+    signal(&fHeader->fReaderWaiting, &fHeader->fReaderWake);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkGPipeSharedRingReader* SkGPipeSharedRingReader::Open(const char name[]) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    void* base = MAP_FAILED;
+    size_t size = 0;
+    if (0 == fstat(fd, &st) && st.st_size > (off_t) kHeaderSize) {
+        size = st.st_size;
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    shm_unlink(name);
+    if (MAP_FAILED == base) {
+        return NULL;
+    }
+
+    // Don't trust the segment with the size of the ring.
+    SkGPipeSharedRingHeader* header = static_cast<SkGPipeSharedRingHeader*>(base);
+    const int32_t capacity = header->fCapacity;
+    if (capacity <= 0 || !SkIsPow2(capacity) || kHeaderSize + capacity != size) {
+        munmap(base, size);
+        return NULL;
+    }
+    return SkNEW_ARGS(SkGPipeSharedRingReader, (header, size));
+}
+
+SkGPipeSharedRingReader::SkGPipeSharedRingReader(SkGPipeSharedRingHeader* header,
+                                                 size_t mappedSize)
+    : fHeader(header)
+    , fMappedSize(mappedSize) {
+}
+
+SkGPipeSharedRingReader::~SkGPipeSharedRingReader() {
+    sk_atomic_inc(&fHeader->fReaderClosed);
+    signal(&fHeader->fWriterWaiting, &fHeader->fWriterWake);
+    munmap(fHeader, fMappedSize);
+}
+
+SkGPipeReader::Status SkGPipeSharedRingReader::playback(SkGPipeReader* reader, bool wait) {
+    const uint32_t capacity = fHeader->fCapacity;
+    for (;;) {
+        // Only this side changes fRead.
+        const uint32_t read = fHeader->fRead;
+        const uint32_t written = load(&fHeader->fWritten);
+        if (read == written) {
+            if (0 != load(&fHeader->fWriterClosed)) {
+                return SkGPipeReader::kDone_Status;
+            }
+            if (!wait) {
+                return SkGPipeReader::kEOF_Status;
+            }
+            wait_until(has_data, fHeader, read,
+                       &fHeader->fReaderWaiting, &fHeader->fReaderWake);
+            continue;
+        }
+
+        // The writer only moves fPadStart once the reader is past it, so it is current.
+        const uint32_t offset = read & (capacity - 1);
+        const uint32_t padStart = fHeader->fPadStart;
+        size_t bytesRead;
+        SkGPipeReader::Status status = SkGPipeReader::kEOF_Status;
+        // A pad never starts at offset 0, so 0 means there is none.
+        const bool padded = 0 != padStart;
+        if (padded && read == padStart) {
+            fHeader->fPadStart = 0;
+            bytesRead = capacity - offset;
+        } else {
+            uint32_t length = SkTMin(written - read, capacity - offset);
+            if (padded && padStart - read < length) {
+                length = padStart - read;
+            }
+            bytesRead = 0;
+            status = reader->playback(ring_data(fHeader) + offset, length, 0, &bytesRead);
+            if (0 == bytesRead && SkGPipeReader::kEOF_Status == status) {
+                // The writer notifies whole commands, so this is garbage.
+                return SkGPipeReader::kError_Status;
+            }
+        }
+
+        sk_atomic_add(&fHeader->fRead, SkToS32(bytesRead));
+        signal(&fHeader->fWriterWaiting, &fHeader->fWriterWake);
+        if (SkGPipeReader::kEOF_Status != status) {
+            return status;
+        }
+    }
+}
+
+#else
+
+SkGPipeSharedRingController* SkGPipeSharedRingController::Create(size_t) {
+    return NULL;
+}
+
+SkGPipeSharedRingController::~SkGPipeSharedRingController() {}
+
+void* SkGPipeSharedRingController::requestBlock(size_t, size_t*) {
+    return NULL;
+}
+
+void SkGPipeSharedRingController::notifyWritten(size_t) {}
+
+SkGPipeSharedRingReader* SkGPipeSharedRingReader::Open(const char[]) {
+    return NULL;
+}
+
+SkGPipeSharedRingReader::~SkGPipeSharedRingReader() {}
+
+SkGPipeReader::Status SkGPipeSharedRingReader::playback(SkGPipeReader*, bool) {
+    return SkGPipeReader::kError_Status;
+}
+
+#endif
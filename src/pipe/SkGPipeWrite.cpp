@@ -10,11 +10,15 @@
 #include "SkBitmapDevice.h"
 #include "SkBitmapHeap.h"
 #include "SkCanvas.h"
+#include "SkChecksum.h"
 #include "SkColorFilter.h"
 #include "SkData.h"
 #include "SkDrawLooper.h"
+#include "SkFontDataCache.h"
+#include "SkFontDescriptor.h"
 #include "SkGPipe.h"
 #include "SkGPipePriv.h"
+#include "SkGPipeSharedPixels.h"
 #include "SkImageFilter.h"
 #include "SkMaskFilter.h"
 #include "SkWriteBuffer.h"
@@ -25,7 +29,11 @@
 #include "SkRRect.h"
 #include "SkShader.h"
 #include "SkStream.h"
+#include "SkTArray.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
 #include "SkTSearch.h"
+#include "SkThread.h"
 #include "SkTypeface.h"
 #include "SkWriter32.h"
 
@@ -53,18 +61,47 @@ static SkFlattenable* get_paintflat(const SkPaint& paint, unsigned paintFlat) {
     return NULL;
 }
 
-static size_t writeTypeface(SkWriter32* writer, SkTypeface* typeface) {
-    SkASSERT(typeface);
-    SkDynamicMemoryWStream stream;
-    typeface->serialize(&stream);
-    size_t size = stream.getOffset();
-    if (writer) {
-        writer->write32(SkToU32(size));
-        SkAutoDataUnref data(stream.copyToData());
-        writer->writePad(data->data(), size);
+// Counts the calls to SkGPipeWriter::ForgetSharedFonts(), so that every writer drops its list
+// of sent font data before it next records.
+static int32_t gSharedFontsGeneration = 0;
+
+// The font data that a writer with kSharedFontData_Flag has sent to the reader process. The
+// readers play each pipe back in the order it was written, so once a session that sent some data
+// has ended normally, later sessions of the same writer can refer to it by its ID. There are
+// seldom more than a few dozen fonts with data, so a list will do.
+class SkGPipeSentFonts {
+public:
+    SkGPipeSentFonts() : fGeneration(sk_acquire_load(&gSharedFontsGeneration)) {}
+
+    bool find(const SkFontDataCache::ID& id) const {
+        for (int i = 0; i < fSent.count(); ++i) {
+            if (fSent[i] == id) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void add(const SkFontDataCache::ID& id) {
+        if (!this->find(id)) {
+            *fSent.append() = id;
+        }
+    }
+
+    // Called before each session, and after one that failed, when the readers may not have
+    // played back everything it sent.
+    void reset(bool force) {
+        int32_t generation = sk_acquire_load(&gSharedFontsGeneration);
+        if (force || generation != fGeneration) {
+            fSent.reset();
+            fGeneration = generation;
+        }
     }
-    return 4 + SkAlign4(size);
-}
+
+private:
+    SkTDArray<SkFontDataCache::ID> fSent;
+    int32_t                        fGeneration;
+};
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -162,6 +199,173 @@ typedef SkFlatDictionary<SkFlattenable, SkFlattenableTraits> FlatDictionary;
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * What an SkGPipeWriter keeps between recording sessions when
+ * kPersistentFlattenables_Flag is set: the flattened effects the readers hold,
+ * found by their content, and the factory names, typefaces and paint state
+ * the readers were sent. Effects are given ids that stay the same across
+ * sessions; when there are too many, the least recently used are evicted, and
+ * their ids reused.
+ */
+class SkGPipeFlatCache {
+public:
+    SkGPipeFlatCache(uint32_t flags);
+    ~SkGPipeFlatCache();
+
+    /**
+     * Whether the next session may build on this one. The readers are out of
+     * date once a session fails, and the flags have to match.
+     */
+    bool canContinue(uint32_t flags) const {
+        return fValid && flags == fFlags;
+    }
+
+    void invalidate() { fValid = false; }
+
+    SkNamedFactorySet* factorySet() const { return fFactorySet; }
+    SkRefCntSet* typefaceSet() const { return fTypefaceSet; }
+
+    /**
+     * Effects found or added from here until the next call are on one paint,
+     * so they are not evicted for each other.
+     */
+    void beginPaint() { fPaintSerial++; }
+
+    /**
+     * Returns the id of the flattened effect in 'data'. If the readers don't
+     * have it yet, it is added and 'added' is set, so the caller sends it. The
+     * ids of effects evicted to make room are appended to 'evicted'.
+     */
+    int findOrAdd(const void* data, size_t size, bool* added, SkTDArray<int>* evicted);
+
+    // The paint state the readers were left with at the end of a session.
+    SkPaint fPaint;
+    int     fCurrFlatIndex[kCount_PaintFlats];
+
+private:
+    enum {
+        kMaxEntries = 256,
+        kMaxBytes   = 1024 * 1024,
+    };
+
+    struct FlatKey {
+        const void* fData;
+        size_t      fSize;
+        uint32_t    fHash;
+
+        bool operator==(const FlatKey& other) const {
+            return fHash == other.fHash && fSize == other.fSize &&
+                   0 == memcmp(fData, other.fData, fSize);
+        }
+    };
+
+    struct Entry {
+        Entry(SkData* data, uint32_t hash, int id) : fData(data), fID(id), fPaintSerial(0) {
+            fKey.fData = data->data();
+            fKey.fSize = data->size();
+            fKey.fHash = hash;
+        }
+        ~Entry() { fData->unref(); }
+
+        static const FlatKey& GetKey(const Entry& entry) { return entry.fKey; }
+        static uint32_t Hash(const FlatKey& key) { return key.fHash; }
+
+        FlatKey  fKey;
+        SkData*  fData;
+        int      fID;
+        uint32_t fPaintSerial;
+
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+    };
+
+    void evict(Entry*, SkTDArray<int>* evicted);
+
+    SkTDynamicHash<Entry, FlatKey> fEntries;
+    SkTInternalLList<Entry>        fLRU;    // Most recently used at the head.
+    SkTDArray<int>                 fFreeIDs;
+    int                            fNextID;
+    size_t                         fBytes;
+    uint32_t                       fPaintSerial;
+
+    SkNamedFactorySet*             fFactorySet;
+    SkRefCntSet*                   fTypefaceSet;
+    const uint32_t                 fFlags;
+    bool                           fValid;
+};
+
+SkGPipeFlatCache::SkGPipeFlatCache(uint32_t flags)
+    : fNextID(1)
+    , fBytes(0)
+    , fPaintSerial(0)
+    , fFactorySet(isCrossProcess(flags) ? SkNEW(SkNamedFactorySet) : NULL)
+    , fTypefaceSet(SkNEW(SkRefCntSet))
+    , fFlags(flags)
+    , fValid(true) {
+    sk_bzero(fCurrFlatIndex, sizeof(fCurrFlatIndex));
+}
+
+SkGPipeFlatCache::~SkGPipeFlatCache() {
+    while (NULL != fLRU.head()) {
+        Entry* entry = fLRU.head();
+        fLRU.remove(entry);
+        SkDELETE(entry);
+    }
+    SkSafeUnref(fFactorySet);
+    fTypefaceSet->unref();
+}
+
+int SkGPipeFlatCache::findOrAdd(const void* data, size_t size, bool* added,
+                                SkTDArray<int>* evicted) {
+    SkASSERT(SkIsAlign4(size));
+    FlatKey key;
+    key.fData = data;
+    key.fSize = size;
+    key.fHash = SkChecksum::Murmur3(static_cast<const uint32_t*>(data), size);
+
+    Entry* entry = fEntries.find(key);
+    if (NULL != entry) {
+        fLRU.remove(entry);
+        fLRU.addToHead(entry);
+        entry->fPaintSerial = fPaintSerial;
+        *added = false;
+        return entry->fID;
+    }
+
+    // The entries used by the current paint are at the head, so stop at them.
+    while (fEntries.count() >= kMaxEntries || fBytes + size > kMaxBytes) {
+        Entry* victim = fLRU.tail();
+        if (NULL == victim || victim->fPaintSerial == fPaintSerial) {
+            break;
+        }
+        this->evict(victim, evicted);
+    }
+
+    int id;
+    if (fFreeIDs.count() > 0) {
+        fFreeIDs.pop(&id);
+    } else {
+        id = fNextID++;
+    }
+    entry = SkNEW_ARGS(Entry, (SkData::NewWithCopy(data, size), key.fHash, id));
+    entry->fPaintSerial = fPaintSerial;
+    fEntries.add(entry);
+    fLRU.addToHead(entry);
+    fBytes += size;
+    *added = true;
+    return id;
+}
+
+void SkGPipeFlatCache::evict(Entry* entry, SkTDArray<int>* evicted) {
+    fLRU.remove(entry);
+    fEntries.remove(entry->fKey);
+    fBytes -= entry->fKey.fSize;
+    *fFreeIDs.append() = entry->fID;
+    *evicted->append() = entry->fID;
+    SkDELETE(entry);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 /**
  * If SkBitmaps are to be flattened to send to the reader, this class is
  * provided to the SkBitmapHeap to tell the SkGPipeCanvas to do so.
@@ -189,7 +393,8 @@ private:
 class SkGPipeCanvas : public SkCanvas {
 public:
     SkGPipeCanvas(SkGPipeController*, SkWriter32*, uint32_t flags,
-                  uint32_t width, uint32_t height);
+                  uint32_t width, uint32_t height, SkGPipeFlatCache* = NULL,
+                  SkGPipeSentFonts* = NULL);
     virtual ~SkGPipeCanvas();
 
     /**
@@ -209,6 +414,19 @@ public:
             this->writeOp(kDone_DrawOp);
             this->doNotify();
         }
+        if (NULL != fFlatCache) {
+            // The readers only have everything this session sent if it ended
+            // normally, in which case the next session picks up from here.
+            if (notifyReaders && !fDone) {
+                fFlatCache->fPaint = fPaint;
+                memcpy(fFlatCache->fCurrFlatIndex, fCurrFlatIndex, sizeof(fCurrFlatIndex));
+            } else {
+                fFlatCache->invalidate();
+            }
+        }
+        if (NULL != fSentFonts && !notifyReaders) {
+            fSentFonts->reset(true);
+        }
         if (shouldFlattenBitmaps(fFlags)) {
             // The following circular references exist:
             // fFlattenableHeap -> fWriteBuffer -> fBitmapStorage -> fExternalStorage -> fCanvas
@@ -218,6 +436,14 @@ public:
             // Break them all by destroying the final link to this SkGPipeCanvas.
             fBitmapShuttle->removeCanvas();
         }
+        // No more bitmaps will be defined, so the readers are the only ones left to open the
+        // shared pixels.
+        for (int i = 0; i < fSharedPixelNames.count(); ++i) {
+            if (!fSharedPixelNames[i].isEmpty()) {
+                SkGPipeSharedPixels::Release(fSharedPixelNames[i].c_str());
+            }
+        }
+        fSharedPixelNames.reset();
         fDone = true;
     }
 
@@ -236,6 +462,7 @@ public:
                             const SkPaint&) SK_OVERRIDE;
     virtual void drawOval(const SkRect&, const SkPaint&) SK_OVERRIDE;
     virtual void drawRect(const SkRect& rect, const SkPaint&) SK_OVERRIDE;
+    virtual void drawRects(const SkRect[], int count, const SkPaint&) SK_OVERRIDE;
     virtual void drawRRect(const SkRRect&, const SkPaint&) SK_OVERRIDE;
     virtual void drawPath(const SkPath& path, const SkPaint&) SK_OVERRIDE;
     virtual void drawBitmap(const SkBitmap&, SkScalar left, SkScalar top,
@@ -265,6 +492,12 @@ public:
      */
     bool shuttleBitmap(const SkBitmap&, int32_t slot);
 
+    /**
+     * Send an SkBitmap to the reader through shared memory, if the flags
+     * allow it and the pixels can be shared.
+     */
+    bool shareBitmapPixels(const SkBitmap&, int32_t slot);
+
 protected:
     virtual void willSave(SaveFlags) SK_OVERRIDE;
     virtual SaveLayerStrategy willSaveLayer(const SkRect*, const SkPaint*, SaveFlags) SK_OVERRIDE;
@@ -308,9 +541,10 @@ private:
     bool               fDone;
     const uint32_t     fFlags;
 
-    SkRefCntSet        fTypefaceSet;
+    SkAutoTUnref<SkRefCntSet> fTypefaceSet;
 
     uint32_t getTypefaceID(SkTypeface*);
+    void writeTypeface(SkTypeface*);
 
     inline void writeOp(DrawOps op, unsigned flags, unsigned data) {
         fWriter.write32(DrawOp_packOpFlagData(op, flags, data));
@@ -339,9 +573,16 @@ private:
     FlattenableHeap             fFlattenableHeap;
     FlatDictionary              fFlatDictionary;
     SkAutoTUnref<BitmapShuttle> fBitmapShuttle;
+    // Names of the shared pixels defined in each bitmap slot, if any.
+    SkTArray<SkString>          fSharedPixelNames;
     int                         fCurrFlatIndex[kCount_PaintFlats];
+    // Owned by the SkGPipeWriter. Only used with kPersistentFlattenables_Flag.
+    SkGPipeFlatCache*           fFlatCache;
+    // Owned by the writer, and only set if sharing font data.
+    SkGPipeSentFonts*           fSentFonts;
 
     int flattenToIndex(SkFlattenable* obj, PaintFlats);
+    int flattenToCache(SkFlattenable* obj, PaintFlats);
 
     // Common code used by drawBitmap*. Behaves differently depending on the
     // type of SkBitmapHeap being used, which is determined by the flags used.
@@ -376,6 +617,16 @@ void SkGPipeCanvas::flattenFactoryNames() {
 
 bool SkGPipeCanvas::shuttleBitmap(const SkBitmap& bm, int32_t slot) {
     SkASSERT(shouldFlattenBitmaps(fFlags));
+    // The slot is being reused, so this writer is done with whatever was
+    // shared in it before.
+    if (slot < fSharedPixelNames.count() && !fSharedPixelNames[slot].isEmpty()) {
+        SkGPipeSharedPixels::Release(fSharedPixelNames[slot].c_str());
+        fSharedPixelNames[slot].reset();
+    }
+    if (this->shareBitmapPixels(bm, slot)) {
+        return true;
+    }
+
     SkWriteBuffer buffer;
     buffer.setNamedFactoryRecorder(fFactorySet);
     buffer.writeBitmap(bm);
@@ -390,6 +641,34 @@ bool SkGPipeCanvas::shuttleBitmap(const SkBitmap& bm, int32_t slot) {
     return false;
 }
 
+bool SkGPipeCanvas::shareBitmapPixels(const SkBitmap& bm, int32_t slot) {
+    if (!SkToBool(fFlags & SkGPipeWriter::kSharedPixelMemory_Flag)) {
+        return false;
+    }
+    SkString name;
+    if (!SkGPipeSharedPixels::Share(bm, fController->numberOfReaders(), &name)) {
+        return false;
+    }
+    size_t size = 5 * sizeof(uint32_t) + SkWriter32::WriteStringSize(name.c_str(), name.size());
+    if (!this->needOpBytes(size)) {
+        SkGPipeSharedPixels::Discard(name.c_str());
+        return false;
+    }
+    this->writeOp(kDef_SharedBitmap_DrawOp, 0, slot);
+    fWriter.write32(bm.width());
+    fWriter.write32(bm.height());
+    fWriter.write32(bm.colorType());
+    fWriter.write32(bm.alphaType());
+    fWriter.write32(SkToU32(bm.rowBytes()));
+    fWriter.writeString(name.c_str(), name.size());
+
+    while (fSharedPixelNames.count() <= slot) {
+        fSharedPixelNames.push_back();
+    }
+    fSharedPixelNames[slot] = name;
+    return true;
+}
+
 // return 0 for NULL (or unflattenable obj), or index-base-1
 // return ~(index-base-1) if an old flattenable was replaced
 int SkGPipeCanvas::flattenToIndex(SkFlattenable* obj, PaintFlats paintflat) {
@@ -398,6 +677,10 @@ int SkGPipeCanvas::flattenToIndex(SkFlattenable* obj, PaintFlats paintflat) {
         return 0;
     }
 
+    if (NULL != fFlatCache) {
+        return this->flattenToCache(obj, paintflat);
+    }
+
     fBitmapHeap->deferAddingOwners();
     bool added, replaced;
     const SkFlatData* flat = fFlatDictionary.findAndReplace(*obj, fFlattenableHeap.flatToReplace(),
@@ -420,6 +703,43 @@ int SkGPipeCanvas::flattenToIndex(SkFlattenable* obj, PaintFlats paintflat) {
     return index;
 }
 
+// Like flattenToIndex, but the index is an id in fFlatCache, which outlives
+// this session.
+int SkGPipeCanvas::flattenToCache(SkFlattenable* obj, PaintFlats paintflat) {
+    SkASSERT(NULL != obj && NULL != fFlatCache);
+
+    // Without a bitmap heap, whose slots are only good for this session, the
+    // bitmaps of the effect are written into it.
+    SkWriteBuffer buffer(isCrossProcess(fFlags) ? SkWriteBuffer::kCrossProcess_Flag : 0);
+    buffer.setNamedFactoryRecorder(fFactorySet);
+    buffer.writeFlattenable(obj);
+    const size_t size = buffer.bytesWritten();
+    SkAutoSTMalloc<64, uint32_t> flat(size / sizeof(uint32_t));
+    buffer.writeToMemory(flat.get());
+
+    bool added;
+    SkTDArray<int> evicted;
+    int index = fFlatCache->findOrAdd(flat.get(), size, &added, &evicted);
+    for (int i = 0; i < evicted.count(); i++) {
+        if (this->needOpBytes()) {
+            this->writeOp(kEvict_Flattenable_DrawOp, 0, evicted[i]);
+        }
+    }
+    if (added) {
+        if (isCrossProcess(fFlags)) {
+            this->flattenFactoryNames();
+        }
+        if (this->needOpBytes(size)) {
+            this->writeOp(kDef_Flattenable_DrawOp, paintflat, index);
+            fWriter.write(flat.get(), size);
+        }
+        // The id may have been used for an evicted effect that a paint still
+        // has, so the paint must be told again.
+        index = ~index;
+    }
+    return index;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #define MIN_BLOCK_SIZE  (16 * 1024)
@@ -428,9 +748,12 @@ int SkGPipeCanvas::flattenToIndex(SkFlattenable* obj, PaintFlats paintflat) {
 
 SkGPipeCanvas::SkGPipeCanvas(SkGPipeController* controller,
                              SkWriter32* writer, uint32_t flags,
-                             uint32_t width, uint32_t height)
+                             uint32_t width, uint32_t height,
+                             SkGPipeFlatCache* flatCache,
+                             SkGPipeSentFonts* sentFonts)
     : SkCanvas(width, height)
-    , fFactorySet(isCrossProcess(flags) ? SkNEW(SkNamedFactorySet) : NULL)
+    , fFactorySet(NULL != flatCache ? SkSafeRef(flatCache->factorySet())
+                  : isCrossProcess(flags) ? SkNEW(SkNamedFactorySet) : NULL)
     , fWriter(*writer)
     , fFlags(flags)
     , fFlattenableHeap(FLATTENABLES_TO_KEEP, fFactorySet, isCrossProcess(flags))
@@ -442,10 +765,21 @@ SkGPipeCanvas::SkGPipeCanvas(SkGPipeController* controller,
     fBytesNotified = 0;
     fFirstSaveLayerStackLevel = kNoSaveLayer;
     sk_bzero(fCurrFlatIndex, sizeof(fCurrFlatIndex));
+    fFlatCache = flatCache;
+    fSentFonts = sentFonts;
+    if (NULL != flatCache) {
+        // The readers still have the typefaces and paint of the last session.
+        fTypefaceSet.reset(SkRef(flatCache->typefaceSet()));
+        fPaint = flatCache->fPaint;
+        memcpy(fCurrFlatIndex, flatCache->fCurrFlatIndex, sizeof(fCurrFlatIndex));
+    } else {
+        fTypefaceSet.reset(SkNEW(SkRefCntSet));
+    }
 
-    // Tell the reader the appropriate flags to use.
+    // Tell the reader the appropriate flags to use. There are more of them
+    // than flag bits, so they go in the data.
     if (this->needOpBytes()) {
-        this->writeOp(kReportFlags_DrawOp, fFlags, 0);
+        this->writeOp(kReportFlags_DrawOp, 0, fFlags);
     }
 
     if (shouldFlattenBitmaps(flags)) {
@@ -497,19 +831,56 @@ bool SkGPipeCanvas::needOpBytes(size_t needed) {
 uint32_t SkGPipeCanvas::getTypefaceID(SkTypeface* face) {
     uint32_t id = 0; // 0 means default/null typeface
     if (face) {
-        id = fTypefaceSet.find(face);
+        id = fTypefaceSet->find(face);
         if (0 == id) {
-            id = fTypefaceSet.add(face);
-            size_t size = writeTypeface(NULL, face);
-            if (this->needOpBytes(size)) {
-                this->writeOp(kDef_Typeface_DrawOp);
-                writeTypeface(&fWriter, face);
-            }
+            id = fTypefaceSet->add(face);
+            this->writeTypeface(face);
         }
     }
     return id;
 }
 
+void SkGPipeCanvas::writeTypeface(SkTypeface* face) {
+    SkDynamicMemoryWStream stream;
+    face->serialize(&stream);
+    SkAutoDataUnref data(stream.copyToData());
+    size_t size = data->size();
+
+    unsigned flags = 0;
+    SkFontDataCache::ID fontDataID;
+    if (NULL != fSentFonts) {
+        // The serialization is a descriptor, then the length of the font data and the data.
+        SkMemoryStream reader(data);
+        SkFontDescriptor desc(&reader);
+        const size_t descriptorSize = reader.getPosition();
+        const size_t fontDataSize = reader.readPackedUInt();
+        if (fontDataSize > 0) {
+            SkAutoDataUnref fontData(SkData::NewSubset(data, reader.getPosition(), fontDataSize));
+            fontDataID = SkFontDataCache::ComputeID(fontData);
+            if (fSentFonts->find(fontDataID)) {
+                flags = kDefTypeface_FontDataID_DrawOpFlag;
+                size = descriptorSize;
+            } else {
+                flags = kDefTypeface_PinFontData_DrawOpFlag;
+            }
+        }
+    }
+
+    const size_t idSize = SkToBool(flags & kDefTypeface_FontDataID_DrawOpFlag)
+                        ? sizeof(fontDataID) : 0;
+    if (this->needOpBytes(4 + SkAlign4(size) + idSize)) {
+        this->writeOp(kDef_Typeface_DrawOp, flags, 0);
+        fWriter.write32(SkToU32(size));
+        fWriter.writePad(data->data(), size);
+        if (idSize > 0) {
+            fWriter.write(&fontDataID, idSize);
+        }
+        if (SkToBool(flags & kDefTypeface_PinFontData_DrawOpFlag)) {
+            fSentFonts->add(fontDataID);
+        }
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #define NOTIFY_SETUP(canvas)    \
@@ -730,6 +1101,12 @@ void SkGPipeCanvas::drawRect(const SkRect& rect, const SkPaint& paint) {
     }
 }
 
+void SkGPipeCanvas::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    for (int i = 0; i < count; ++i) {
+        this->drawRect(rects[i], paint);
+    }
+}
+
 void SkGPipeCanvas::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
     NOTIFY_SETUP(this);
     this->writePaint(paint);
@@ -1124,7 +1501,7 @@ void SkGPipeCanvas::writePaint(const SkPaint& paint) {
             *ptr++ = PaintOp_packOpData(kTypeface_PaintOp, id);
         } else if (this->needOpBytes(sizeof(void*))) {
             // Add to the set for ref counting.
-            fTypefaceSet.add(paint.getTypeface());
+            fTypefaceSet->add(paint.getTypeface());
             // It is safe to write the typeface to the stream before the rest
             // of the paint unless we ever send a kReset_PaintOp, which we
             // currently never do.
@@ -1136,6 +1513,9 @@ void SkGPipeCanvas::writePaint(const SkPaint& paint) {
 
     // This is a new paint, so all old flats can be safely purged, if necessary.
     fFlattenableHeap.markAllFlatsSafeToDelete();
+    if (NULL != fFlatCache) {
+        fFlatCache->beginPaint();
+    }
     for (int i = 0; i < kCount_PaintFlats; i++) {
         int index = this->flattenToIndex(get_paintflat(paint, i), (PaintFlats)i);
         bool replaced = index < 0;
@@ -1146,7 +1526,7 @@ void SkGPipeCanvas::writePaint(const SkPaint& paint) {
         if (index > 0) {
             fFlattenableHeap.markFlatForKeeping(index);
         }
-        SkASSERT(index >= 0 && index <= fFlatDictionary.count());
+        SkASSERT(index >= 0 && (NULL != fFlatCache || index <= fFlatDictionary.count()));
         if (index != fCurrFlatIndex[i] || replaced) {
             *ptr++ = PaintOp_packOpFlagData(kFlatIndex_PaintOp, i, index);
             fCurrFlatIndex[i] = index;
@@ -1200,17 +1580,37 @@ void SkGPipeController::setCanvas(SkGPipeCanvas* canvas) {
 SkGPipeWriter::SkGPipeWriter()
 : fWriter(0) {
     fCanvas = NULL;
+    fFlatCache = NULL;
+    fSentFonts = NULL;
 }
 
 SkGPipeWriter::~SkGPipeWriter() {
     this->endRecording();
+    SkDELETE(fFlatCache);
+    SkDELETE(fSentFonts);
 }
 
 SkCanvas* SkGPipeWriter::startRecording(SkGPipeController* controller, uint32_t flags,
                                         uint32_t width, uint32_t height) {
     if (NULL == fCanvas) {
+        if (NULL != fFlatCache && !fFlatCache->canContinue(flags)) {
+            SkDELETE(fFlatCache);
+            fFlatCache = NULL;
+        }
+        if (NULL == fFlatCache && SkToBool(flags & kPersistentFlattenables_Flag)) {
+            fFlatCache = SkNEW_ARGS(SkGPipeFlatCache, (flags));
+        }
+        SkGPipeSentFonts* sentFonts = NULL;
+        if (SkToBool(flags & kSharedFontData_Flag) && isCrossProcess(flags)) {
+            if (NULL == fSentFonts) {
+                fSentFonts = SkNEW(SkGPipeSentFonts);
+            }
+            fSentFonts->reset(false);
+            sentFonts = fSentFonts;
+        }
         fWriter.reset(NULL, 0);
-        fCanvas = SkNEW_ARGS(SkGPipeCanvas, (controller, &fWriter, flags, width, height));
+        fCanvas = SkNEW_ARGS(SkGPipeCanvas, (controller, &fWriter, flags, width, height,
+                                             fFlatCache, sentFonts));
     }
     controller->setCanvas(fCanvas);
     return fCanvas;
@@ -1237,6 +1637,10 @@ size_t SkGPipeWriter::freeMemoryIfPossible(size_t bytesToFree) {
     return 0;
 }
 
+void SkGPipeWriter::ForgetSharedFonts() {
+    sk_atomic_inc(&gSharedFontsGeneration);
+}
+
 size_t SkGPipeWriter::storageAllocatedForRecording() const {
     return NULL == fCanvas ? 0 : fCanvas->storageAllocatedForRecording();
 }
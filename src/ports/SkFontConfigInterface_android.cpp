@@ -13,6 +13,7 @@
 #include "SkFontConfigTypeface.h"
 #include "SkFontMgr.h"
 #include "SkGlyphCache.h"
+#include "SkOnce.h"
 #include "SkPaint.h"
 #include "SkString.h"
 #include "SkStream.h"
@@ -131,27 +132,30 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static SkFontConfigInterfaceAndroid* getSingletonInterface() {
-    SK_DECLARE_STATIC_MUTEX(gMutex);
-    static SkFontConfigInterfaceAndroid* gFontConfigInterface;
-
-    SkAutoMutexAcquire ac(gMutex);
-    if (NULL == gFontConfigInterface) {
-        // load info from a configuration file that we can use to populate the
-        // system/fallback font structures
-        SkTDArray<FontFamily*> fontFamilies;
-        if (!gTestMainConfigFile) {
-            SkFontConfigParser::GetFontFamilies(fontFamilies);
-        } else {
-            SkFontConfigParser::GetTestFontFamilies(fontFamilies, gTestMainConfigFile,
-                                                    gTestFallbackConfigFile);
-        }
+static SkFontConfigInterfaceAndroid* gFontConfigInterface;
 
-        gFontConfigInterface = new SkFontConfigInterfaceAndroid(fontFamilies);
-
-        // cleanup the data we received from the parser
-        fontFamilies.deleteAll();
+static void createSingletonInterface() {
+    // load info from a configuration file that we can use to populate the
+    // system/fallback font structures
+    SkTDArray<FontFamily*> fontFamilies;
+    if (!gTestMainConfigFile) {
+        SkFontConfigParser::GetFontFamilies(fontFamilies);
+    } else {
+        SkFontConfigParser::GetTestFontFamilies(fontFamilies, gTestMainConfigFile,
+                                                gTestFallbackConfigFile);
     }
+
+    gFontConfigInterface = new SkFontConfigInterfaceAndroid(fontFamilies);
+
+    // cleanup the data we received from the parser
+    fontFamilies.deleteAll();
+}
+
+// The configuration is only parsed on first use, and exactly once, since it
+// creates typefaces; after that every lookup finds it without taking a lock.
+static SkFontConfigInterfaceAndroid* getSingletonInterface() {
+    SK_DECLARE_STATIC_ONCE(once);
+    SkOnce(&once, createSingletonInterface);
     return gFontConfigInterface;
 }
 
@@ -198,6 +202,7 @@ static void insert_into_name_dict(SkTDict<FamilyRecID>& familyNameDict,
 // Defined in SkFontHost_FreeType.cpp
 bool find_name_and_attributes(SkStream* stream, SkString* name,
                               SkTypeface::Style* style, bool* isFixedWidth);
+SkStream* open_shared_font_file(const char path[]);
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -455,7 +460,7 @@ bool SkFontConfigInterfaceAndroid::matchFamilyName(const char familyName[],
 }
 
 SkStream* SkFontConfigInterfaceAndroid::openStream(const FontIdentity& identity) {
-    return SkStream::NewFromFile(identity.fString.c_str());
+    return open_shared_font_file(identity.fString.c_str());
 }
 
 SkDataTable* SkFontConfigInterfaceAndroid::getFamilyNames() {
@@ -14,9 +14,12 @@
 #include <fontconfig/fontconfig.h>
 
 #include "SkBuffer.h"
+#include "SkChecksum.h"
 #include "SkFontConfigInterface.h"
 #include "SkLazyPtr.h"
 #include "SkStream.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
 
 size_t SkFontConfigInterface::FontIdentity::writeToMemory(void* addr) const {
     size_t size = sizeof(fID) + sizeof(fTTCIndex);
@@ -102,6 +105,103 @@ static void fontconfiginterface_unittest() {
 }
 #endif
 
+namespace {
+
+// The number of matchFamilyName() results to remember.
+static const int kMatchCacheCount = 256;
+
+struct MatchKey {
+    MatchKey(const char familyName[], SkTypeface::Style style)
+        : fFamilyName(familyName)
+        , fHasFamilyName(NULL != familyName)
+        , fStyle(style) {
+        // Murmur3 wants whole words; copy the name so the padding is zero.
+        size_t words = (fFamilyName.size() + 3) >> 2;
+        SkAutoSTMalloc<64, uint32_t> storage(words);
+        sk_bzero(storage.get(), words << 2);
+        memcpy(storage.get(), fFamilyName.c_str(), fFamilyName.size());
+        fHash = SkChecksum::Murmur3(storage.get(), words << 2,
+                                    (fStyle << 1) | fHasFamilyName);
+    }
+
+    bool operator==(const MatchKey& other) const {
+        return fHash == other.fHash && fStyle == other.fStyle &&
+               fHasFamilyName == other.fHasFamilyName && fFamilyName == other.fFamilyName;
+    }
+
+    SkString            fFamilyName;
+    bool                fHasFamilyName;
+    SkTypeface::Style   fStyle;
+    uint32_t            fHash;
+};
+
+struct MatchRec {
+    explicit MatchRec(const MatchKey& key) : fKey(key), fFound(false) {}
+
+    static const MatchKey& GetKey(const MatchRec& rec) { return rec.fKey; }
+    static uint32_t Hash(const MatchKey& key) { return key.fHash; }
+
+    const MatchKey      fKey;
+    bool                fFound;     // if false, the family is not installed
+    int                 fTTCIndex;
+    SkString            fFileName;
+    SkString            fFamilyName;
+    SkTypeface::Style   fStyle;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(MatchRec);
+};
+
+/*  The most recently used matchFamilyName() results. Families that are not
+    installed are remembered too, since CSS font-family lists ask for many of
+    them before reaching one that is.
+    Not thread-safe; guarded by SkFontConfigInterfaceDirect's mutex.
+ */
+class MatchCache {
+public:
+    MatchCache() : fCount(0) {}
+
+    ~MatchCache() {
+        while (NULL != fLRU.head()) {
+            this->remove(fLRU.head());
+        }
+    }
+
+    // Returns the result for key and marks it most recently used, or NULL.
+    const MatchRec* find(const MatchKey& key) {
+        MatchRec* rec = fHash.find(key);
+        if (NULL != rec) {
+            fLRU.remove(rec);
+            fLRU.addToHead(rec);
+        }
+        return rec;
+    }
+
+    // Takes ownership of rec.
+    void add(MatchRec* rec) {
+        SkASSERT(NULL == fHash.find(rec->fKey));
+        if (fCount == kMatchCacheCount) {
+            this->remove(fLRU.tail());
+        }
+        fHash.add(rec);
+        fLRU.addToHead(rec);
+        fCount += 1;
+    }
+
+private:
+    void remove(MatchRec* rec) {
+        fLRU.remove(rec);
+        fHash.remove(rec->fKey);
+        SkDELETE(rec);
+        fCount -= 1;
+    }
+
+    SkTDynamicHash<MatchRec, MatchKey>  fHash;
+    SkTInternalLList<MatchRec>          fLRU;
+    int                                 fCount;
+};
+
+}  // namespace
+
 class SkFontConfigInterfaceDirect : public SkFontConfigInterface {
 public:
             SkFontConfigInterfaceDirect();
@@ -122,6 +222,7 @@ public:
 
 private:
     SkMutex mutex_;
+    MatchCache fMatchCache;  // guarded by mutex_
 };
 
 SkFontConfigInterface* SkFontConfigInterface::GetSingletonDirectInterface() {
@@ -432,17 +533,14 @@ SkFontConfigInterfaceDirect::SkFontConfigInterfaceDirect() {
 SkFontConfigInterfaceDirect::~SkFontConfigInterfaceDirect() {
 }
 
-bool SkFontConfigInterfaceDirect::matchFamilyName(const char familyName[],
-                                                  SkTypeface::Style style,
-                                                  FontIdentity* outIdentity,
-                                                  SkString* outFamilyName,
-                                                  SkTypeface::Style* outStyle) {
+/*  Asks fontconfig for the best match for familyName and style. Returns false if
+    that is not the family asked for (or an acceptable substitute for it).
+    Caller must hold the interface's mutex.
+ */
+static bool fc_match_family_name(const char familyName[], SkTypeface::Style style,
+                                 int* ttcIndex, SkString* fileName,
+                                 SkString* outFamilyName, SkTypeface::Style* outStyle) {
     std::string familyStr(familyName ? familyName : "");
-    if (familyStr.length() > kMaxFontFamilyLength) {
-        return false;
-    }
-
-    SkAutoMutexAcquire ac(mutex_);
 
     FcPattern* pattern = FcPatternCreate();
 
@@ -533,21 +631,56 @@ bool SkFontConfigInterfaceDirect::matchFamilyName(const char familyName[],
 
     FcFontSetDestroy(font_set);
 
+    *ttcIndex = face_index;
+    fileName->set(c_filename);
+    outFamilyName->set(post_config_family);
+    *outStyle = GetFontStyle(match);
+    return true;
+}
+
+bool SkFontConfigInterfaceDirect::matchFamilyName(const char familyName[],
+                                                  SkTypeface::Style style,
+                                                  FontIdentity* outIdentity,
+                                                  SkString* outFamilyName,
+                                                  SkTypeface::Style* outStyle) {
+    if (familyName && strlen(familyName) > kMaxFontFamilyLength) {
+        return false;
+    }
+
+    SkAutoMutexAcquire ac(mutex_);
+
+    const MatchKey key(familyName, style);
+    const MatchRec* rec = fMatchCache.find(key);
+    if (NULL == rec) {
+        MatchRec* newRec = SkNEW_ARGS(MatchRec, (key));
+        newRec->fFound = fc_match_family_name(familyName, style, &newRec->fTTCIndex,
+                                              &newRec->fFileName, &newRec->fFamilyName,
+                                              &newRec->fStyle);
+        fMatchCache.add(newRec);
+        rec = newRec;
+    }
+    if (!rec->fFound) {
+        return false;
+    }
+
     if (outIdentity) {
-        outIdentity->fTTCIndex = face_index;
-        outIdentity->fString.set(c_filename);
+        outIdentity->fTTCIndex = rec->fTTCIndex;
+        outIdentity->fString = rec->fFileName;
     }
     if (outFamilyName) {
-        outFamilyName->set(post_config_family);
+        *outFamilyName = rec->fFamilyName;
     }
     if (outStyle) {
-        *outStyle = GetFontStyle(match);
+        *outStyle = rec->fStyle;
     }
     return true;
 }
 
+// Defined in SkFontHost_FreeType.cpp
+SkStream* open_shared_font_file(const char path[]);
+
 SkStream* SkFontConfigInterfaceDirect::openStream(const FontIdentity& identity) {
-    return SkStream::NewFromFile(identity.fString.c_str());
+    return open_shared_font_file(identity.fString.c_str());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
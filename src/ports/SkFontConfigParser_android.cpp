@@ -6,6 +6,8 @@
  */
 
 #include "SkFontConfigParser_android.h"
+#include "SkOSFile.h"
+#include "SkStream.h"
 #include "SkTDArray.h"
 #include "SkTypeface.h"
 
@@ -252,11 +254,141 @@ static void getFallbackFontFamilies(SkTDArray<FontFamily*> &fallbackFonts) {
     }
 }
 
+#ifdef SK_FONT_CONFIG_SNAPSHOT_FILE
+
+/**
+ * The parsed families can be kept in a compact binary snapshot, so that later
+ * processes skip the XML parsing. A snapshot is only used while the locale and
+ * the sizes of the configuration files are the same as when it was written.
+ */
+static const uint32_t kSnapshotTag = SkSetFourByteTag('s', 'k', 'f', 'c');
+static const uint32_t kSnapshotVersion = 1;
+static const size_t kSnapshotMaxString = 4096;
+
+static SkString snapshotKey() {
+    static const char* gConfigFiles[] = {
+        SYSTEM_FONTS_FILE, FALLBACK_FONTS_FILE, VENDOR_FONTS_FILE
+    };
+    SkString key(SkFontConfigParser::GetLocale().c_str());
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gConfigFiles); ++i) {
+        size_t size = 0;
+        SkFILE* file = sk_fopen(gConfigFiles[i], kRead_SkFILE_Flag);
+        if (file) {
+            size = sk_fgetsize(file);
+            sk_fclose(file);
+        }
+        key.appendf(":%u", (unsigned)size);
+    }
+    return key;
+}
+
+static void writeString(SkWStream* stream, const SkString& str) {
+    stream->writePackedUInt(str.size());
+    stream->write(str.c_str(), str.size());
+}
+
+static bool readString(SkStream* stream, SkString* str) {
+    size_t len = stream->readPackedUInt();
+    if (len > kSnapshotMaxString) {
+        return false;
+    }
+    str->resize(len);
+    return stream->read(str->writable_str(), len) == len;
+}
+
+static void writeSnapshot(const char* path, const SkString& key,
+                          const SkTDArray<FontFamily*> &fontFamilies) {
+    // Write to the side and rename, so readers never see a partial snapshot.
+    SkString tmpPath(path);
+    tmpPath.append(".tmp");
+    {
+        SkFILEWStream stream(tmpPath.c_str());
+        if (!stream.isValid()) {
+            return;
+        }
+        stream.write32(kSnapshotTag);
+        stream.write32(kSnapshotVersion);
+        writeString(&stream, key);
+        stream.writePackedUInt(fontFamilies.count());
+        for (int i = 0; i < fontFamilies.count(); ++i) {
+            const FontFamily* family = fontFamilies[i];
+            stream.writeBool(family->fIsFallbackFont);
+            stream.write32(family->order);
+            stream.writePackedUInt(family->fNames.count());
+            for (int j = 0; j < family->fNames.count(); ++j) {
+                writeString(&stream, family->fNames[j]);
+            }
+            stream.writePackedUInt(family->fFontFiles.count());
+            for (int j = 0; j < family->fFontFiles.count(); ++j) {
+                const FontFileInfo& info = family->fFontFiles[j];
+                writeString(&stream, info.fFileName);
+                writeString(&stream, info.fPaintOptions.getLanguage().getTag());
+                stream.writePackedUInt(info.fPaintOptions.getFontVariant());
+            }
+        }
+    }
+    rename(tmpPath.c_str(), path);
+}
+
+static bool readSnapshot(const char* path, const SkString& key,
+                         SkTDArray<FontFamily*> &fontFamilies) {
+    SkAutoTUnref<SkStreamAsset> stream(SkStream::NewFromFile(path));
+    if (NULL == stream.get()) {
+        return false;
+    }
+    SkString str;
+    if (stream->readU32() != kSnapshotTag || stream->readU32() != kSnapshotVersion ||
+            !readString(stream, &str) || str != key) {
+        return false;
+    }
+
+    SkTDArray<FontFamily*> families;
+    const size_t familyCount = stream->readPackedUInt();
+    bool ok = familyCount <= stream->getLength();
+    for (size_t i = 0; ok && i < familyCount; ++i) {
+        FontFamily* family = new FontFamily();
+        *families.append() = family;
+        family->fIsFallbackFont = stream->readBool();
+        family->order = stream->readS32();
+        const size_t nameCount = stream->readPackedUInt();
+        ok = nameCount <= stream->getLength();
+        for (size_t j = 0; ok && j < nameCount; ++j) {
+            ok = readString(stream, &family->fNames.push_back());
+        }
+        const size_t fileCount = ok ? stream->readPackedUInt() : 0;
+        ok = ok && fileCount <= stream->getLength();
+        for (size_t j = 0; ok && j < fileCount; ++j) {
+            FontFileInfo& info = family->fFontFiles.push_back();
+            ok = readString(stream, &info.fFileName) && readString(stream, &str);
+            const size_t variant = stream->readPackedUInt();
+            ok = ok && variant <= SkPaintOptionsAndroid::kLast_Variant;
+            if (ok) {
+                info.fPaintOptions.setLanguage(str);
+                info.fPaintOptions.setFontVariant((SkPaintOptionsAndroid::FontVariant)variant);
+            }
+        }
+    }
+    if (!ok || !stream->isAtEnd()) {
+        families.deleteAll();
+        return false;
+    }
+    fontFamilies.append(families.count(), families.begin());
+    return true;
+}
+
+#endif
+
 /**
  * Loads data on font families from various expected configuration files. The
  * resulting data is returned in the given fontFamilies array.
  */
 void SkFontConfigParser::GetFontFamilies(SkTDArray<FontFamily*> &fontFamilies) {
+#ifdef SK_FONT_CONFIG_SNAPSHOT_FILE
+    const SkString key = snapshotKey();
+    if (readSnapshot(SK_FONT_CONFIG_SNAPSHOT_FILE, key, fontFamilies)) {
+        return;
+    }
+#endif
 
     getSystemFontFamilies(fontFamilies);
 
@@ -267,6 +399,10 @@ void SkFontConfigParser::GetFontFamilies(SkTDArray<FontFamily*> &fontFamilies) {
         fallbackFonts[i]->fIsFallbackFont = true;
         *fontFamilies.append() = fallbackFonts[i];
     }
+
+#ifdef SK_FONT_CONFIG_SNAPSHOT_FILE
+    writeSnapshot(SK_FONT_CONFIG_SNAPSHOT_FILE, key, fontFamilies);
+#endif
 }
 
 void SkFontConfigParser::GetTestFontFamilies(SkTDArray<FontFamily*> &fontFamilies,
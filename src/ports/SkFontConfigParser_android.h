@@ -40,7 +40,10 @@ namespace SkFontConfigParser {
 
 /**
  * Parses all system font configuration files and returns the results in an
- * array of FontFamily structures.
+ * array of FontFamily structures. If SK_FONT_CONFIG_SNAPSHOT_FILE names a
+ * writable path, the results are cached there in binary form, and read back
+ * instead of parsing for as long as the locale and configuration files are
+ * unchanged.
  */
 void GetFontFamilies(SkTDArray<FontFamily*> &fontFamilies);
 
@@ -10,6 +10,7 @@
 #include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkColorPriv.h"
+#include "SkData.h"
 #include "SkDescriptor.h"
 #include "SkFDot6.h"
 #include "SkFloatingPoint.h"
@@ -120,48 +121,56 @@ static int          gLCDExtra;  // number of extra pixels for filtering.
 // Android >= Gingerbread (good)
 typedef FT_Error (*FT_Library_SetLcdFilterWeightsProc)(FT_Library, unsigned char*);
 
-// Caller must lock gFTMutex before calling this function.
-static bool InitFreetype() {
-    FT_Error err = FT_Init_FreeType(&gFTLibrary);
-    if (err) {
-        return false;
-    }
-
-    // Setup LCD filtering. This reduces color fringes for LCD smoothed glyphs.
+// Sets up LCD filtering on library, returning true if the runtime supports it.
+// This reduces color fringes for LCD smoothed glyphs.
+static bool setup_lcd_filter(FT_Library library) {
 #ifdef FT_LCD_FILTER_H
     // Use default { 0x10, 0x40, 0x70, 0x40, 0x10 }, as it adds up to 0x110, simulating ink spread.
     // SetLcdFilter must be called before SetLcdFilterWeights.
-    err = FT_Library_SetLcdFilter(gFTLibrary, FT_LCD_FILTER_DEFAULT);
-    if (0 == err) {
-        gLCDSupport = true;
-        gLCDExtra = 2; //Using a filter adds one full pixel to each side.
+    FT_Error err = FT_Library_SetLcdFilter(library, FT_LCD_FILTER_DEFAULT);
+    if (err) {
+        return false;
+    }
 
 #ifdef SK_FONTHOST_FREETYPE_USE_NORMAL_LCD_FILTER
-        // This also adds to 0x110 simulating ink spread, but provides better results than default.
-        static unsigned char gGaussianLikeHeavyWeights[] = { 0x1A, 0x43, 0x56, 0x43, 0x1A, };
+    // This also adds to 0x110 simulating ink spread, but provides better results than default.
+    static unsigned char gGaussianLikeHeavyWeights[] = { 0x1A, 0x43, 0x56, 0x43, 0x1A, };
 
 #if defined(SK_FONTHOST_FREETYPE_RUNTIME_VERSION) && \
             SK_FONTHOST_FREETYPE_RUNTIME_VERSION > 0x020400
-        err = FT_Library_SetLcdFilterWeights(gFTLibrary, gGaussianLikeHeavyWeights);
+    err = FT_Library_SetLcdFilterWeights(library, gGaussianLikeHeavyWeights);
 #elif defined(SK_CAN_USE_DLOPEN) && SK_CAN_USE_DLOPEN == 1
-        //The FreeType library is already loaded, so symbols are available in process.
-        void* self = dlopen(NULL, RTLD_LAZY);
-        if (NULL != self) {
-            FT_Library_SetLcdFilterWeightsProc setLcdFilterWeights;
-            //The following cast is non-standard, but safe for POSIX.
-            *reinterpret_cast<void**>(&setLcdFilterWeights) = dlsym(self, "FT_Library_SetLcdFilterWeights");
-            dlclose(self);
-
-            if (NULL != setLcdFilterWeights) {
-                err = setLcdFilterWeights(gFTLibrary, gGaussianLikeHeavyWeights);
-            }
+    //The FreeType library is already loaded, so symbols are available in process.
+    void* self = dlopen(NULL, RTLD_LAZY);
+    if (NULL != self) {
+        FT_Library_SetLcdFilterWeightsProc setLcdFilterWeights;
+        //The following cast is non-standard, but safe for POSIX.
+        *reinterpret_cast<void**>(&setLcdFilterWeights) = dlsym(self, "FT_Library_SetLcdFilterWeights");
+        dlclose(self);
+
+        if (NULL != setLcdFilterWeights) {
+            err = setLcdFilterWeights(library, gGaussianLikeHeavyWeights);
         }
+    }
 #endif
 #endif
-    }
+    return true;
 #else
-    gLCDSupport = false;
+    return false;
 #endif
+}
+
+// Caller must lock gFTMutex before calling this function.
+static bool InitFreetype() {
+    FT_Error err = FT_Init_FreeType(&gFTLibrary);
+    if (err) {
+        return false;
+    }
+
+    gLCDSupport = setup_lcd_filter(gFTLibrary);
+    if (gLCDSupport) {
+        gLCDExtra = 2; //Using a filter adds one full pixel to each side.
+    }
     gLCDSupportValid = true;
 
     return true;
@@ -187,7 +196,10 @@ static bool is_lcd_supported() {
 
 class SkScalerContext_FreeType : public SkScalerContext_FreeType_Base {
 public:
-    SkScalerContext_FreeType(SkTypeface*, const SkDescriptor* desc);
+    /** If privateFace is true the context opens its own FT_Library and
+        FT_Face, so it never needs to take gFTMutex to generate glyphs.
+    */
+    SkScalerContext_FreeType(SkTypeface*, const SkDescriptor* desc, bool privateFace = false);
     virtual ~SkScalerContext_FreeType();
 
     bool success() const {
@@ -206,8 +218,11 @@ protected:
     virtual void generateFontMetrics(SkPaint::FontMetrics* mx,
                                      SkPaint::FontMetrics* my) SK_OVERRIDE;
     virtual SkUnichar generateGlyphToChar(uint16_t glyph) SK_OVERRIDE;
+    virtual SkScalerContext* createIndependentContext(const SkDescriptor*) const SK_OVERRIDE;
 
 private:
+    SkBaseMutex* fFaceMutex;        // &gFTMutex, or NULL if the face is private
+    FT_Library  fPrivateLibrary;    // NULL unless the face is private
     SkFaceRec*  fFaceRec;
     FT_Face     fFace;              // reference to shared face in gFaceRecHead
     FT_Size     fFTSize;            // our own copy
@@ -226,9 +241,9 @@ private:
     void getBBoxForCurrentGlyph(SkGlyph* glyph, FT_BBox* bbox,
                                 bool snapToPixelBoundary = false);
     bool getCBoxForLetter(char letter, FT_BBox* bbox);
-    // Caller must lock gFTMutex before calling this function.
+    // Caller must lock fFaceMutex before calling this function.
     void updateGlyphIfLCD(SkGlyph* glyph);
-    // Caller must lock gFTMutex before calling this function.
+    // Caller must lock fFaceMutex before calling this function.
     // update FreeType2 glyph slot with glyph emboldened
     void emboldenIfNeeded(FT_Face face, FT_GlyphSlot glyph);
 };
@@ -293,20 +308,10 @@ SkFaceRec::SkFaceRec(SkStream* strm, uint32_t fontID)
     fFTStream.close = sk_stream_close;
 }
 
-// Will return 0 on failure
-// Caller must lock gFTMutex before calling this function.
-static SkFaceRec* ref_ft_face(const SkTypeface* typeface) {
+// Opens a new face for typeface in library, or returns NULL on failure.
+// The returned rec is not in the gFaceRecHead list.
+static SkFaceRec* open_ft_face(FT_Library library, const SkTypeface* typeface) {
     const SkFontID fontID = typeface->uniqueID();
-    SkFaceRec* rec = gFaceRecHead;
-    while (rec) {
-        if (rec->fFontID == fontID) {
-            SkASSERT(rec->fFace);
-            rec->fRefCnt += 1;
-            return rec;
-        }
-        rec = rec->fNext;
-    }
-
     int face_index;
     SkStream* strm = typeface->openStream(&face_index);
     if (NULL == strm) {
@@ -314,7 +319,7 @@ static SkFaceRec* ref_ft_face(const SkTypeface* typeface) {
     }
 
     // this passes ownership of strm to the rec
-    rec = SkNEW_ARGS(SkFaceRec, (strm, fontID));
+    SkFaceRec* rec = SkNEW_ARGS(SkFaceRec, (strm, fontID));
 
     FT_Open_Args    args;
     memset(&args, 0, sizeof(args));
@@ -331,18 +336,37 @@ static SkFaceRec* ref_ft_face(const SkTypeface* typeface) {
         args.stream = &rec->fFTStream;
     }
 
-    FT_Error err = FT_Open_Face(gFTLibrary, &args, face_index, &rec->fFace);
+    FT_Error err = FT_Open_Face(library, &args, face_index, &rec->fFace);
     if (err) {    // bad filename, try the default font
         fprintf(stderr, "ERROR: unable to open font '%x'\n", fontID);
         SkDELETE(rec);
         return NULL;
-    } else {
-        SkASSERT(rec->fFace);
-        //fprintf(stderr, "Opened font '%s'\n", filename.c_str());
+    }
+    SkASSERT(rec->fFace);
+    //fprintf(stderr, "Opened font '%s'\n", filename.c_str());
+    return rec;
+}
+
+// Will return 0 on failure
+// Caller must lock gFTMutex before calling this function.
+static SkFaceRec* ref_ft_face(const SkTypeface* typeface) {
+    const SkFontID fontID = typeface->uniqueID();
+    SkFaceRec* rec = gFaceRecHead;
+    while (rec) {
+        if (rec->fFontID == fontID) {
+            SkASSERT(rec->fFace);
+            rec->fRefCnt += 1;
+            return rec;
+        }
+        rec = rec->fNext;
+    }
+
+    rec = open_ft_face(gFTLibrary, typeface);
+    if (NULL != rec) {
         rec->fNext = gFaceRecHead;
         gFaceRecHead = rec;
-        return rec;
     }
+    return rec;
 }
 
 // Caller must lock gFTMutex before calling this function.
@@ -831,22 +855,37 @@ static FT_Int chooseBitmapStrike(FT_Face face, SkFixed scaleY) {
 }
 
 SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
-                                                   const SkDescriptor* desc)
-        : SkScalerContext_FreeType_Base(typeface, desc) {
-    SkAutoMutexAcquire  ac(gFTMutex);
-
-    if (gFTCount == 0) {
-        if (!InitFreetype()) {
-            sk_throw();
+                                                   const SkDescriptor* desc,
+                                                   bool privateFace)
+        : SkScalerContext_FreeType_Base(typeface, desc)
+        , fFaceMutex(privateFace ? NULL : &gFTMutex)
+        , fPrivateLibrary(NULL) {
+    SkAutoMutexAcquire  ac(fFaceMutex);
+
+    if (privateFace) {
+        if (FT_Init_FreeType(&fPrivateLibrary)) {
+            fPrivateLibrary = NULL;
+        } else {
+            setup_lcd_filter(fPrivateLibrary);
         }
+    } else {
+        if (gFTCount == 0) {
+            if (!InitFreetype()) {
+                sk_throw();
+            }
+        }
+        ++gFTCount;
     }
-    ++gFTCount;
 
     // load the font file
     fStrikeIndex = -1;
     fFTSize = NULL;
     fFace = NULL;
-    fFaceRec = ref_ft_face(typeface);
+    if (privateFace) {
+        fFaceRec = fPrivateLibrary ? open_ft_face(fPrivateLibrary, typeface) : NULL;
+    } else {
+        fFaceRec = ref_ft_face(typeface);
+    }
     if (NULL == fFaceRec) {
         return;
     }
@@ -1023,12 +1062,23 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
 }
 
 SkScalerContext_FreeType::~SkScalerContext_FreeType() {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceMutex);
 
     if (fFTSize != NULL) {
         FT_Done_Size(fFTSize);
     }
 
+    if (NULL == fFaceMutex) {
+        if (fFaceRec != NULL) {
+            FT_Done_Face(fFaceRec->fFace);
+            SkDELETE(fFaceRec);
+        }
+        if (fPrivateLibrary != NULL) {
+            FT_Done_FreeType(fPrivateLibrary);
+        }
+        return;
+    }
+
     if (fFace != NULL) {
         unref_ft_face(fFace);
     }
@@ -1038,6 +1088,17 @@ SkScalerContext_FreeType::~SkScalerContext_FreeType() {
     }
 }
 
+SkScalerContext* SkScalerContext_FreeType::createIndependentContext(
+                                               const SkDescriptor* desc) const {
+    SkScalerContext_FreeType* c = SkNEW_ARGS(SkScalerContext_FreeType,
+                                             (this->getTypeface(), desc, true));
+    if (!c->success()) {
+        SkDELETE(c);
+        c = NULL;
+    }
+    return c;
+}
+
 /*  We call this before each use of the fFace, since we may be sharing
     this face with other context (at different sizes).
 */
@@ -1085,7 +1146,7 @@ void SkScalerContext_FreeType::generateAdvance(SkGlyph* glyph) {
     * which are very cheap to compute with some font formats...
     */
     if (fDoLinearMetrics) {
-        SkAutoMutexAcquire  ac(gFTMutex);
+        SkAutoMutexAcquire  ac(fFaceMutex);
 
         if (this->setupSize()) {
             glyph->zeroMetrics();
@@ -1186,7 +1247,7 @@ inline void scaleGlyphMetrics(SkGlyph& glyph, SkScalar scale) {
 }
 
 void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceMutex);
 
     glyph->fRsbDelta = 0;
     glyph->fLsbDelta = 0;
@@ -1291,7 +1352,7 @@ void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
 
 
 void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceMutex);
 
     FT_Error    err;
 
@@ -1315,7 +1376,7 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
 
 void SkScalerContext_FreeType::generatePath(const SkGlyph& glyph,
                                             SkPath* path) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceMutex);
 
     SkASSERT(&glyph && path);
 
@@ -1357,7 +1418,7 @@ void SkScalerContext_FreeType::generateFontMetrics(SkPaint::FontMetrics* mx,
         return;
     }
 
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceMutex);
 
     if (this->setupSize()) {
         ERROR:
@@ -1738,3 +1799,53 @@ bool find_name_and_attributes(SkStream* stream, SkString* name,
     FT_Done_FreeType(library);
     return true;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct SkSharedFontFile {
+    SkSharedFontFile*   fNext;
+    SkString            fPath;
+    SkData*             fData;  // the mapped file
+};
+
+SK_DECLARE_STATIC_MUTEX(gSharedFontFileMutex);
+static SkSharedFontFile* gSharedFontFileHead;
+
+/*  Export this so that the FreeType ports can open their font files through it.
+    Each file is mapped once, and its pages are shared read-only by every stream
+    (and so every FT_Face) opened on it, rather than each typeface mapping or
+    reading its own copy. A file nothing uses any more is unmapped the next time
+    a font file is opened.
+*/
+SkStream* open_shared_font_file(const char path[]) {
+    SkAutoMutexAcquire ac(gSharedFontFileMutex);
+
+    SkData* data = NULL;
+    SkSharedFontFile** prev = &gSharedFontFileHead;
+    while (NULL != *prev) {
+        SkSharedFontFile* file = *prev;
+        if (NULL == data && file->fPath.equals(path)) {
+            data = file->fData;
+        } else if (file->fData->unique()) {
+            *prev = file->fNext;
+            file->fData->unref();
+            SkDELETE(file);
+            continue;
+        }
+        prev = &file->fNext;
+    }
+
+    if (NULL == data) {
+        data = SkData::NewFromFileName(path);
+        if (NULL == data) {
+            // Can't be mapped, so read it through a stream.
+            return SkStream::NewFromFile(path);
+        }
+        SkSharedFontFile* file = SkNEW(SkSharedFontFile);
+        file->fNext = gSharedFontFileHead;
+        file->fPath.set(path);
+        file->fData = data;     // takes the ref from NewFromFileName()
+        gSharedFontFileHead = file;
+    }
+    return SkNEW_ARGS(SkMemoryStream, (data));
+}
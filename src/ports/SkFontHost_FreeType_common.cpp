@@ -12,6 +12,7 @@
 #include "SkColorPriv.h"
 #include "SkFDot6.h"
 #include "SkFontHost_FreeType_common.h"
+#include "SkLCDFilter.h"
 #include "SkPath.h"
 
 #include <ft2build.h>
@@ -44,14 +45,14 @@ static FT_Pixel_Mode compute_pixel_mode(SkMask::Format format) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static uint16_t packTriple(U8CPU r, U8CPU g, U8CPU b) {
 #ifdef SK_SHOW_TEXT_BLIT_COVERAGE
+static uint16_t packTriple(U8CPU r, U8CPU g, U8CPU b) {
     r = SkTMax(r, (U8CPU)0x40);
     g = SkTMax(g, (U8CPU)0x40);
     b = SkTMax(b, (U8CPU)0x40);
-#endif
     return SkPack888ToRGB16(r, g, b);
 }
+#endif
 
 static uint16_t grayToRGB16(U8CPU gray) {
 #ifdef SK_SHOW_TEXT_BLIT_COVERAGE
@@ -66,6 +67,28 @@ static int bittst(const uint8_t data[], int bitOffset) {
     return lowBit & 1;
 }
 
+/**
+ *  Applies the gamma tables (if APPLY_PREBLEND) to a row of planar subpixels,
+ *  then packs them into dst.
+ */
+template<bool APPLY_PREBLEND>
+static void packLCD16Row(const SkLCDFilter& filter, uint8_t* r, uint8_t* g, uint8_t* b, int width,
+                         const uint8_t* tableR, const uint8_t* tableG, const uint8_t* tableB,
+                         uint16_t* dst) {
+    if (APPLY_PREBLEND) {
+        SkLCDFilter::ApplyLUT(r, width, tableR);
+        SkLCDFilter::ApplyLUT(g, width, tableG);
+        SkLCDFilter::ApplyLUT(b, width, tableB);
+    }
+#ifdef SK_SHOW_TEXT_BLIT_COVERAGE
+    for (int x = 0; x < width; ++x) {
+        dst[x] = packTriple(r[x], g[x], b[x]);
+    }
+#else
+    filter.packRow(r, g, b, dst, width);
+#endif
+}
+
 /**
  *  Copies a FT_Bitmap into an SkMask with the same dimensions.
  *
@@ -93,6 +116,14 @@ static void copyFT2LCD16(const FT_Bitmap& bitmap, const SkMask& mask, int lcdIsB
     const int width = mask.fBounds.width();
     const int height = mask.fBounds.height();
 
+    // Subpixels are gathered into planar rows, gamma corrected a channel at a
+    // time, then packed.
+    const SkLCDFilter filter;
+    SkAutoSTMalloc<3 * 256, uint8_t> storage(3 * width);
+    uint8_t* rowR = storage.get();
+    uint8_t* rowG = rowR + width;
+    uint8_t* rowB = rowG + width;
+
     switch (bitmap.pixel_mode) {
         case FT_PIXEL_MODE_MONO:
             for (int y = height; y --> 0;) {
@@ -105,9 +136,13 @@ static void copyFT2LCD16(const FT_Bitmap& bitmap, const SkMask& mask, int lcdIsB
             break;
         case FT_PIXEL_MODE_GRAY:
             for (int y = height; y --> 0;) {
+#ifdef SK_SHOW_TEXT_BLIT_COVERAGE
                 for (int x = 0; x < width; ++x) {
                     dst[x] = grayToRGB16(src[x]);
                 }
+#else
+                filter.packRow(src, src, src, dst, width);
+#endif
                 dst = (uint16_t*)((char*)dst + dstRB);
                 src += bitmap.pitch;
             }
@@ -116,21 +151,16 @@ static void copyFT2LCD16(const FT_Bitmap& bitmap, const SkMask& mask, int lcdIsB
             SkASSERT(3 * mask.fBounds.width() == bitmap.width);
             for (int y = height; y --> 0;) {
                 const uint8_t* triple = src;
-                if (lcdIsBGR) {
-                    for (int x = 0; x < width; x++) {
-                        dst[x] = packTriple(sk_apply_lut_if<APPLY_PREBLEND>(triple[2], tableR),
-                                            sk_apply_lut_if<APPLY_PREBLEND>(triple[1], tableG),
-                                            sk_apply_lut_if<APPLY_PREBLEND>(triple[0], tableB));
-                        triple += 3;
-                    }
-                } else {
-                    for (int x = 0; x < width; x++) {
-                        dst[x] = packTriple(sk_apply_lut_if<APPLY_PREBLEND>(triple[0], tableR),
-                                            sk_apply_lut_if<APPLY_PREBLEND>(triple[1], tableG),
-                                            sk_apply_lut_if<APPLY_PREBLEND>(triple[2], tableB));
-                        triple += 3;
-                    }
+                uint8_t* first = lcdIsBGR ? rowB : rowR;
+                uint8_t* last = lcdIsBGR ? rowR : rowB;
+                for (int x = 0; x < width; x++) {
+                    first[x] = triple[0];
+                    rowG[x] = triple[1];
+                    last[x] = triple[2];
+                    triple += 3;
                 }
+                packLCD16Row<APPLY_PREBLEND>(filter, rowR, rowG, rowB, width,
+                                             tableR, tableG, tableB, dst);
                 src += bitmap.pitch;
                 dst = (uint16_t*)((char*)dst + dstRB);
             }
@@ -144,11 +174,12 @@ static void copyFT2LCD16(const FT_Bitmap& bitmap, const SkMask& mask, int lcdIsB
                 if (lcdIsBGR) {
                     SkTSwap(srcR, srcB);
                 }
-                for (int x = 0; x < width; x++) {
-                    dst[x] = packTriple(sk_apply_lut_if<APPLY_PREBLEND>(*srcR++, tableR),
-                                        sk_apply_lut_if<APPLY_PREBLEND>(*srcG++, tableG),
-                                        sk_apply_lut_if<APPLY_PREBLEND>(*srcB++, tableB));
-                }
+                // The rows are already planar, but the tables are applied in place.
+                memcpy(rowR, srcR, width);
+                memcpy(rowG, srcG, width);
+                memcpy(rowB, srcB, width);
+                packLCD16Row<APPLY_PREBLEND>(filter, rowR, rowG, rowB, width,
+                                             tableR, tableG, tableB, dst);
                 src += 3 * bitmap.pitch;
                 dst = (uint16_t*)((char*)dst + dstRB);
             }
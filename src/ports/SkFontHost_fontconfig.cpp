@@ -18,6 +18,7 @@
 // Defined in SkFontHost_FreeType.cpp
 bool find_name_and_attributes(SkStream* stream, SkString* name,
                               SkTypeface::Style* style, bool* isFixedWidth);
+SkStream* open_shared_font_file(const char path[]);
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -63,22 +64,6 @@ SkFontConfigInterface* SkFontHost_fontconfig_ref_global() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-struct FindRec {
-    FindRec(const char* name, SkTypeface::Style style)
-        : fFamilyName(name)  // don't need to make a deep copy
-        , fStyle(style) {}
-
-    const char* fFamilyName;
-    SkTypeface::Style fStyle;
-};
-
-static bool find_proc(SkTypeface* face, SkTypeface::Style style, void* ctx) {
-    FontConfigTypeface* fci = (FontConfigTypeface*)face;
-    const FindRec* rec = (const FindRec*)ctx;
-
-    return rec->fStyle == style && fci->isFamilyName(rec->fFamilyName);
-}
-
 SkTypeface* FontConfigTypeface::LegacyCreateTypeface(
                 const SkTypeface* familyFace,
                 const char familyName[],
@@ -93,8 +78,7 @@ SkTypeface* FontConfigTypeface::LegacyCreateTypeface(
         familyName = fct->getFamilyName();
     }
 
-    FindRec rec(familyName, style);
-    SkTypeface* face = SkTypefaceCache::FindByProcAndRef(find_proc, &rec);
+    SkTypeface* face = SkTypefaceCache::FindByNameAndRef(familyName, style);
     if (face) {
 //        SkDebugf("found cached face <%s> <%s> %p [%d]\n", familyName, ((FontConfigTypeface*)face)->getFamilyName(), face, face->getRefCnt());
         return face;
@@ -111,15 +95,17 @@ SkTypeface* FontConfigTypeface::LegacyCreateTypeface(
 
     // check if we, in fact, already have this. perhaps fontconfig aliased the
     // requested name to some other name we actually have...
-    rec.fFamilyName = outFamilyName.c_str();
-    rec.fStyle = outStyle;
-    face = SkTypefaceCache::FindByProcAndRef(find_proc, &rec);
+    face = SkTypefaceCache::FindByNameAndRef(outFamilyName.c_str(), outStyle);
     if (face) {
+        // ...in which case, remember the alias so the next lookup is direct.
+        SkTypefaceCache::AddName(face, familyName, style);
         return face;
     }
 
     face = FontConfigTypeface::Create(outStyle, indentity, outFamilyName);
     SkTypefaceCache::Add(face, style);
+    SkTypefaceCache::AddName(face, outFamilyName.c_str(), outStyle);
+    SkTypefaceCache::AddName(face, familyName, style);
 //    SkDebugf("add face <%s> <%s> %p [%d]\n", familyName, outFamilyName.c_str(), face, face->getRefCnt());
     return face;
 }
@@ -157,7 +143,7 @@ SkTypeface* SkFontHost::CreateTypefaceFromStream(SkStream* stream) {
 }
 
 SkTypeface* SkFontHost::CreateTypefaceFromFile(const char path[]) {
-    SkAutoTUnref<SkStream> stream(SkStream::NewFromFile(path));
+    SkAutoTUnref<SkStream> stream(open_shared_font_file(path));
     return stream.get() ? CreateTypefaceFromStream(stream) : NULL;
 }
 
@@ -27,6 +27,7 @@
 
 bool find_name_and_attributes(SkStream* stream, SkString* name,
                               SkTypeface::Style* style, bool* isFixedPitch);
+SkStream* open_shared_font_file(const char path[]);
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -115,7 +116,7 @@ public:
 protected:
     virtual SkStream* onOpenStream(int* ttcIndex) const SK_OVERRIDE {
         *ttcIndex = 0;
-        return SkStream::NewFromFile(fPath.c_str());
+        return open_shared_font_file(fPath.c_str());
     }
 
 private:
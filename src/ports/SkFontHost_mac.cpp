@@ -568,19 +568,6 @@ SkTypeface* SkCreateTypefaceFromCTFont(CTFontRef fontRef) {
     return face;
 }
 
-struct NameStyleRec {
-    const char*         fName;
-    SkTypeface::Style   fStyle;
-};
-
-static bool FindByNameStyle(SkTypeface* face, SkTypeface::Style style,
-                            void* ctx) {
-    const SkTypeface_Mac* mface = reinterpret_cast<SkTypeface_Mac*>(face);
-    const NameStyleRec* rec = reinterpret_cast<const NameStyleRec*>(ctx);
-
-    return rec->fStyle == style && mface->fName.equals(rec->fName);
-}
-
 static const char* map_css_names(const char* name) {
     static const struct {
         const char* fFrom;  // name the caller specified
@@ -617,13 +604,13 @@ static SkTypeface* create_typeface(const SkTypeface* familyFace,
         familyName = FONT_DEFAULT_NAME;
     }
 
-    NameStyleRec rec = { familyName, style };
-    SkTypeface* face = SkTypefaceCache::FindByProcAndRef(FindByNameStyle, &rec);
+    SkTypeface* face = SkTypefaceCache::FindByNameAndRef(familyName, style);
 
     if (NULL == face) {
         face = NewFromName(familyName, style);
         if (face) {
             SkTypefaceCache::Add(face, style);
+            SkTypefaceCache::AddName(face, familyName, style);
         } else {
             face = GetDefaultFace();
             face->ref();
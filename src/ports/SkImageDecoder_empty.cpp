@@ -52,6 +52,10 @@ bool SkImageDecoder::decodeSubset(SkBitmap*, const SkIRect&, SkColorType) {
     return false;
 }
 
+bool SkImageDecoder::decodeYUV8Planes(SkStream*, SkISize[3], void*[3], size_t[3]) {
+    return false;
+}
+
 SkImageDecoder::Format SkImageDecoder::getFormat() const {
     return kUnknown_Format;
 }
@@ -80,6 +84,8 @@ SkBitmap::Allocator* SkImageDecoder::setAllocator(SkBitmap::Allocator*) {
 
 void SkImageDecoder::setSampleSize(int) {}
 
+void SkImageDecoder::setTargetSize(int, int) {}
+
 bool SkImageDecoder::cropBitmap(SkBitmap*, SkBitmap*, int, int, int, int, int,
                     int, int) {
     return false;
@@ -6,6 +6,7 @@
  * found in the LICENSE file.
  */
 #include "SkTypes.h"
+#include "SkAllocationCounter.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -32,6 +33,7 @@ void* sk_malloc_throw(size_t size) {
 }
 
 void* sk_realloc_throw(void* addr, size_t size) {
+    SkCountAllocation(size);
     return throw_on_failure(size, realloc(addr, size));
 }
 
@@ -43,6 +45,9 @@ void sk_free(void* p) {
 
 void* sk_malloc_flags(size_t size, unsigned flags) {
     void* p = malloc(size);
+    if (p) {
+        SkCountAllocation(size);
+    }
     if (flags & SK_MALLOC_THROW) {
         return throw_on_failure(size, p);
     } else {
@@ -51,7 +56,11 @@ void* sk_malloc_flags(size_t size, unsigned flags) {
 }
 
 void* sk_calloc(size_t size) {
-    return calloc(size, 1);
+    void* p = calloc(size, 1);
+    if (p) {
+        SkCountAllocation(size);
+    }
+    return p;
 }
 
 void* sk_calloc_throw(size_t size) {
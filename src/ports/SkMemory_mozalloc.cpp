@@ -7,6 +7,7 @@
  */
 
 #include "SkTypes.h"
+#include "SkAllocationCounter.h"
 
 #include "mozilla/mozalloc.h"
 #include "mozilla/mozalloc_abort.h"
@@ -27,6 +28,7 @@ void* sk_malloc_throw(size_t size) {
 }
 
 void* sk_realloc_throw(void* addr, size_t size) {
+    SkCountAllocation(size);
     return moz_xrealloc(addr, size);
 }
 
@@ -35,13 +37,22 @@ void sk_free(void* p) {
 }
 
 void* sk_malloc_flags(size_t size, unsigned flags) {
-    return (flags & SK_MALLOC_THROW) ? moz_xmalloc(size) : moz_malloc(size);
+    void* p = (flags & SK_MALLOC_THROW) ? moz_xmalloc(size) : moz_malloc(size);
+    if (p) {
+        SkCountAllocation(size);
+    }
+    return p;
 }
 
 void* sk_calloc(size_t size) {
-    return moz_calloc(size, 1);
+    void* p = moz_calloc(size, 1);
+    if (p) {
+        SkCountAllocation(size);
+    }
+    return p;
 }
 
 void* sk_calloc_throw(size_t size) {
+    SkCountAllocation(size);
     return moz_xcalloc(size, 1);
 }
@@ -0,0 +1,385 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBackendCostModel.h"
+
+#include "SkPaint.h"
+#include "SkPicture.h"
+#include "SkRecord.h"
+#include "SkRecordDraw.h"
+#include "SkRecorder.h"
+#include "SkRecords.h"
+
+typedef SkBackendCostModel::OpClass OpClass;
+
+// Starting values, from timing SKPs op by op with profile_record on a desktop CPU, and by
+// trace marker on a desktop GPU.  The GPU pays more per op, for state changes and uploads, and
+// much less per pixel, except where it falls back to software masks.
+static const SkBackendCostModel::Coefficients kDefaultRaster[] = {
+    {  0.05,    0 },    // State
+    {  0.3,   800 },    // Fill
+    {  2,    1500 },    // Path
+    {  4,    2000 },    // ConcavePath
+    {  0.5,   100 },    // Hairline
+    { 10,    1500 },    // PathEffect
+    { 20,    8000 },    // MaskFilter
+    {  1,    2500 },    // Bitmap
+    {  2,    1500 },    // Text
+    {  1,    1500 },    // Layer
+    {  5,    2000 },    // Other
+};
+static const SkBackendCostModel::Coefficients kDefaultGpu[] = {
+    {  0.1,     0 },    // State
+    {  2,      20 },    // Fill
+    {  8,      40 },    // Path
+    { 60,    1500 },    // ConcavePath
+    {  3,      10 },    // Hairline
+    { 40,     300 },    // PathEffect
+    { 60,     400 },    // MaskFilter
+    { 15,      30 },    // Bitmap
+    {  5,      50 },    // Text
+    { 50,     100 },    // Layer
+    { 10,     100 },    // Other
+};
+SK_COMPILE_ASSERT(SK_ARRAY_COUNT(kDefaultRaster) == SkBackendCostModel::kOpClassCount,
+                  raster_coefficients_match_op_classes);
+SK_COMPILE_ASSERT(SK_ARRAY_COUNT(kDefaultGpu) == SkBackendCostModel::kOpClassCount,
+                  gpu_coefficients_match_op_classes);
+
+// How strongly Calibrate() pulls each coefficient towards its prior, relative to how much the
+// samples say about it.
+static const double kPriorWeight = 0.1;
+
+namespace {
+
+// An SkRecord visitor that classifies each op.  Returns false for ops that draw nothing at all.
+class Classify {
+public:
+    Classify(OpClass* opClass, int* count) : fClass(opClass), fCount(count) {}
+
+    // Anything not listed draws nothing.
+    template <typename T> bool operator()(const T&) { return false; }
+
+    bool operator()(const SkRecords::Save&)       { return this->state(); }
+    bool operator()(const SkRecords::Restore&)    { return this->state(); }
+    bool operator()(const SkRecords::Concat&)     { return this->state(); }
+    bool operator()(const SkRecords::SetMatrix&)  { return this->state(); }
+    bool operator()(const SkRecords::ClipPath&)   { return this->state(); }
+    bool operator()(const SkRecords::ClipRRect&)  { return this->state(); }
+    bool operator()(const SkRecords::ClipRect&)   { return this->state(); }
+    bool operator()(const SkRecords::ClipRegion&) { return this->state(); }
+    bool operator()(const SkRecords::SaveLayer&) {
+        return this->set(SkBackendCostModel::kLayer_OpClass);
+    }
+
+    bool operator()(const SkRecords::Clear&) {
+        return this->set(SkBackendCostModel::kFill_OpClass);
+    }
+    bool operator()(const SkRecords::DrawPaint& r)  { return this->shape(r.paint); }
+    bool operator()(const SkRecords::DrawRect& r)   { return this->shape(r.paint); }
+    bool operator()(const SkRecords::DrawOval& r)   { return this->shape(r.paint); }
+    bool operator()(const SkRecords::DrawRRect& r)  { return this->shape(r.paint); }
+    bool operator()(const SkRecords::DrawDRRect& r) { return this->shape(r.paint); }
+    bool operator()(const SkRecords::BatchedDrawRect& r) {
+        *fCount = r.count;
+        return this->shape(r.paint);
+    }
+
+    bool operator()(const SkRecords::DrawPath& r) {
+        if (r.paint.isAntiAlias() && !r.path.isConvex() && !is_hairline(r.paint)) {
+            return this->effects(r.paint, SkBackendCostModel::kConcavePath_OpClass);
+        }
+        return this->shape(r.paint);
+    }
+    bool operator()(const SkRecords::DrawPoints& r) {
+        *fCount = SkToInt(r.count);
+        return this->effects(r.paint, SkBackendCostModel::kHairline_OpClass);
+    }
+
+    bool operator()(const SkRecords::DrawBitmap& r)           { return this->bitmap(r.paint); }
+    bool operator()(const SkRecords::DrawBitmapMatrix& r)     { return this->bitmap(r.paint); }
+    bool operator()(const SkRecords::DrawBitmapNine& r)       { return this->bitmap(r.paint); }
+    bool operator()(const SkRecords::DrawBitmapRectToRect& r) { return this->bitmap(r.paint); }
+    bool operator()(const SkRecords::DrawSprite& r)           { return this->bitmap(r.paint); }
+
+    bool operator()(const SkRecords::DrawText& r)       { return this->text(r.paint); }
+    bool operator()(const SkRecords::DrawPosText& r)    { return this->text(r.paint); }
+    bool operator()(const SkRecords::DrawPosTextH& r)   { return this->text(r.paint); }
+    bool operator()(const SkRecords::DrawTextOnPath& r) { return this->text(r.paint); }
+    bool operator()(const SkRecords::DrawTextBlob& r)   { return this->text(r.paint); }
+    bool operator()(const SkRecords::BoundedDrawPosTextH& r) { return this->text(r.base->paint); }
+
+    bool operator()(const SkRecords::DrawVertices& r) {
+        return this->effects(r.paint, SkBackendCostModel::kOther_OpClass);
+    }
+
+private:
+    static bool is_hairline(const SkPaint& paint) {
+        return SkPaint::kFill_Style != paint.getStyle() && 0 == paint.getStrokeWidth();
+    }
+
+    bool set(OpClass opClass) {
+        *fClass = opClass;
+        return true;
+    }
+
+    bool state() { return this->set(SkBackendCostModel::kState_OpClass); }
+
+    // Path effects and mask filters cost more than whatever they apply to.
+    bool effects(const SkPaint& paint, OpClass opClass) {
+        if (NULL != paint.getPathEffect()) {
+            opClass = SkBackendCostModel::kPathEffect_OpClass;
+        } else if (NULL != paint.getMaskFilter()) {
+            opClass = SkBackendCostModel::kMaskFilter_OpClass;
+        }
+        return this->set(opClass);
+    }
+
+    bool shape(const SkPaint& paint) {
+        if (is_hairline(paint)) {
+            return this->effects(paint, SkBackendCostModel::kHairline_OpClass);
+        }
+        return this->effects(paint, SkPaint::kFill_Style == paint.getStyle()
+                                        ? SkBackendCostModel::kFill_OpClass
+                                        : SkBackendCostModel::kPath_OpClass);
+    }
+
+    bool bitmap(const SkPaint* paint) {
+        if (NULL != paint && NULL != paint->getMaskFilter()) {
+            return this->set(SkBackendCostModel::kMaskFilter_OpClass);
+        }
+        return this->set(SkBackendCostModel::kBitmap_OpClass);
+    }
+
+    bool text(const SkPaint& paint) {
+        return this->effects(paint, SkBackendCostModel::kText_OpClass);
+    }
+
+    OpClass* fClass;
+    int* fCount;
+};
+
+}  // namespace
+
+static double cost(const SkBackendCostModel::Coefficients& c, int count, const SkIRect& area) {
+    return count * c.fFixedUs + c.fPerMPixelUs * ((double)area.width() * area.height() / 1e6);
+}
+
+void SkBackendCostModel::DefaultCalibration(Calibration* calibration) {
+    memcpy(calibration->fRaster, kDefaultRaster, sizeof(kDefaultRaster));
+    memcpy(calibration->fGpu, kDefaultGpu, sizeof(kDefaultGpu));
+}
+
+void SkBackendCostModel::Analyze(const SkPicture* picture, SkTDArray<Op>* ops) {
+    ops->rewind();
+    const int w = picture->width(), h = picture->height();
+
+    // Playing the picture into an SkRecord inlines nested pictures.
+    SkRecord record;
+    SkRecorder recorder(&record, w, h);
+    picture->draw(&recorder);
+
+    const unsigned count = record.count();
+    SkAutoTMalloc<SkIRect> bounds(count);
+    for (unsigned i = 0; i < count; i++) {
+        bounds[i].setEmpty();
+    }
+    SkRecords::FillBounds fill(w, h, bounds.get());
+    for (unsigned i = 0; i < count; i++) {
+        fill.setCurrentOp(i);
+        record.visit<void>(i, fill);
+    }
+    fill.finish();
+
+    const SkIRect pictureBounds = SkIRect::MakeWH(w, h);
+    for (unsigned i = 0; i < count; i++) {
+        Op op;
+        op.fCount = 1;
+        Classify classify(&op.fClass, &op.fCount);
+        if (!record.visit<bool>(i, classify)) {
+            continue;
+        }
+        // Ops that touch nothing are rejected before they cost anything to speak of.
+        op.fBounds = bounds[i];
+        if (op.fCount > 0 && op.fBounds.intersect(pictureBounds)) {
+            *ops->append() = op;
+        }
+    }
+}
+
+SkBackendCostModel::SkBackendCostModel(const SkPicture* picture, const SkISize& tileSize,
+                                       const Calibration* calibration)
+    : fTilesWide(0)
+    , fTilesHigh(0)
+    , fPictureRasterUs(0)
+    , fPictureGpuUs(0) {
+    SkASSERT(NULL != picture);
+    SkASSERT(!tileSize.isEmpty());
+
+    Calibration defaults;
+    if (NULL == calibration) {
+        DefaultCalibration(&defaults);
+        calibration = &defaults;
+    }
+
+    fTilesWide = (picture->width() + tileSize.width() - 1) / tileSize.width();
+    fTilesHigh = (picture->height() + tileSize.height() - 1) / tileSize.height();
+    fRasterUs.setCount(fTilesWide * fTilesHigh);
+    fGpuUs.setCount(fTilesWide * fTilesHigh);
+    sk_bzero(fRasterUs.begin(), fRasterUs.bytes());
+    sk_bzero(fGpuUs.begin(), fGpuUs.bytes());
+
+    SkTDArray<Op> ops;
+    Analyze(picture, &ops);
+    for (int i = 0; i < ops.count(); ++i) {
+        const Op& op = ops[i];
+        const Coefficients& raster = calibration->fRaster[op.fClass];
+        const Coefficients& gpu = calibration->fGpu[op.fClass];
+        fPictureRasterUs += cost(raster, op.fCount, op.fBounds);
+        fPictureGpuUs += cost(gpu, op.fCount, op.fBounds);
+
+        for (int y = op.fBounds.fTop / tileSize.height();
+             y <= (op.fBounds.fBottom - 1) / tileSize.height(); ++y) {
+            for (int x = op.fBounds.fLeft / tileSize.width();
+                 x <= (op.fBounds.fRight - 1) / tileSize.width(); ++x) {
+                SkIRect area = SkIRect::MakeXYWH(x * tileSize.width(), y * tileSize.height(),
+                                                 tileSize.width(), tileSize.height());
+                SkAssertResult(area.intersect(op.fBounds));
+                fRasterUs[y * fTilesWide + x] += cost(raster, op.fCount, area);
+                fGpuUs[y * fTilesWide + x] += cost(gpu, op.fCount, area);
+            }
+        }
+    }
+}
+
+double SkBackendCostModel::predictUs(Backend backend, int x, int y) const {
+    SkASSERT(x >= 0 && x < fTilesWide && y >= 0 && y < fTilesHigh);
+    return kRaster_Backend == backend ? fRasterUs[y * fTilesWide + x]
+                                      : fGpuUs[y * fTilesWide + x];
+}
+
+SkBackendCostModel::Backend SkBackendCostModel::suggestBackend(int x, int y) const {
+    return this->predictUs(kGpu_Backend, x, y) < this->predictUs(kRaster_Backend, x, y)
+                ? kGpu_Backend : kRaster_Backend;
+}
+
+// Solves a x = b in place, by Gaussian elimination with partial pivoting.  a is n x n, row by
+// row, and b ends up holding x.  Returns false if a is singular.
+static bool solve(double* a, double* b, int n) {
+    for (int col = 0; col < n; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < n; ++row) {
+            if (fabs(a[row * n + col]) > fabs(a[pivot * n + col])) {
+                pivot = row;
+            }
+        }
+        if (0 == a[pivot * n + col]) {
+            return false;
+        }
+        if (pivot != col) {
+            for (int k = 0; k < n; ++k) {
+                SkTSwap(a[pivot * n + k], a[col * n + k]);
+            }
+            SkTSwap(b[pivot], b[col]);
+        }
+        for (int row = col + 1; row < n; ++row) {
+            const double f = a[row * n + col] / a[col * n + col];
+            for (int k = col; k < n; ++k) {
+                a[row * n + k] -= f * a[col * n + k];
+            }
+            b[row] -= f * b[col];
+        }
+    }
+    for (int row = n - 1; row >= 0; --row) {
+        for (int k = row + 1; k < n; ++k) {
+            b[row] -= a[row * n + k] * b[k];
+        }
+        b[row] /= a[row * n + row];
+    }
+    return true;
+}
+
+// Fits coefficients so that features x times them predicts times, by least squares pulled
+// towards the coefficients' current values.  Each feature row holds the op count of each class,
+// then the megapixels of each class.
+static bool fit(const double* features, const double times[], int samples,
+                SkBackendCostModel::Coefficients coefficients[]) {
+    static const int kClasses = SkBackendCostModel::kOpClassCount;
+    static const int n = 2 * kClasses;
+
+    double prior[n];
+    for (int k = 0; k < kClasses; ++k) {
+        prior[k] = coefficients[k].fFixedUs;
+        prior[kClasses + k] = coefficients[k].fPerMPixelUs;
+    }
+
+    // The normal equations, (XtX + L) w = Xt t + L prior, with L diagonal.
+    double a[n * n], b[n];
+    sk_bzero(a, sizeof(a));
+    sk_bzero(b, sizeof(b));
+    for (int s = 0; s < samples; ++s) {
+        const double* row = features + s * n;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                a[i * n + j] += row[i] * row[j];
+            }
+            b[i] += row[i] * times[s];
+        }
+    }
+    // Scaling each penalty by how much the samples exercise its feature keeps the pull
+    // independent of units.  Features the samples never use are left at their prior.
+    for (int i = 0; i < n; ++i) {
+        const double penalty = kPriorWeight * (a[i * n + i] + 1);
+        a[i * n + i] += penalty;
+        b[i] += penalty * prior[i];
+    }
+    if (!solve(a, b, n)) {
+        return false;
+    }
+
+    // A negative cost means the samples can't tell classes apart; zero is the nearest sense.
+    for (int k = 0; k < kClasses; ++k) {
+        coefficients[k].fFixedUs = SkTMax(b[k], 0.0);
+        coefficients[k].fPerMPixelUs = SkTMax(b[kClasses + k], 0.0);
+    }
+    return true;
+}
+
+bool SkBackendCostModel::Calibrate(const SkPicture* const pictures[], const double rasterUs[],
+                                   const double gpuUs[], int count, Calibration* calibration) {
+    if (count < 1) {
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (rasterUs[i] < 0 || gpuUs[i] < 0) {
+            return false;
+        }
+    }
+
+    const int n = 2 * kOpClassCount;
+    SkAutoTMalloc<double> features(count * n);
+    sk_bzero(features.get(), count * n * sizeof(double));
+    SkTDArray<Op> ops;
+    for (int i = 0; i < count; ++i) {
+        double* row = features.get() + i * n;
+        Analyze(pictures[i], &ops);
+        for (int j = 0; j < ops.count(); ++j) {
+            const Op& op = ops[j];
+            row[op.fClass] += op.fCount;
+            row[kOpClassCount + op.fClass] +=
+                    (double)op.fBounds.width() * op.fBounds.height() / 1e6;
+        }
+    }
+
+    Calibration fitted = *calibration;
+    if (!fit(features.get(), rasterUs, count, fitted.fRaster) ||
+        !fit(features.get(), gpuUs, count, fitted.fGpu)) {
+        return false;
+    }
+    *calibration = fitted;
+    return true;
+}
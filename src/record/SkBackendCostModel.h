@@ -0,0 +1,114 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBackendCostModel_DEFINED
+#define SkBackendCostModel_DEFINED
+
+#include "SkRect.h"
+#include "SkSize.h"
+#include "SkTDArray.h"
+
+class SkPicture;
+
+// Predicts how long each tile of a picture takes to draw with the raster backend and with the
+// GPU, so that each tile can go to whichever is faster.  This is a finer grained take on
+// SkPicture::suitableForGpuRasterization(), which vetoes the GPU for a whole picture on a few
+// counts.
+//
+// Each op falls into a class, by its type and paint, and costs a fixed time plus a time per
+// pixel of its bounds, with one pair of coefficients per class and backend.  An op costs its
+// fixed time in every tile it touches, as each tile plays it back.  The default coefficients
+// are rough starting values; Calibrate() fits them to times measured on the target device.
+class SkBackendCostModel : SkNoncopyable {
+public:
+    enum Backend {
+        kRaster_Backend,
+        kGpu_Backend,
+    };
+
+    enum OpClass {
+        kState_OpClass,         // Saves, restores, matrix changes and clips.
+        kFill_OpClass,          // Rects, ovals, round rects and paints, filled with no effects.
+        kPath_OpClass,          // Strokes, and paths the GPU draws directly.
+        kConcavePath_OpClass,   // Anti-aliased concave paths, which the GPU masks in software.
+        kHairline_OpClass,      // Hairlines and points.
+        kPathEffect_OpClass,    // Anything drawn with a path effect, e.g. dashes.
+        kMaskFilter_OpClass,    // Anything drawn with a mask filter, e.g. blurs.
+        kBitmap_OpClass,
+        kText_OpClass,
+        kLayer_OpClass,         // Save layers, by the area they composite.
+        kOther_OpClass,         // Vertices.
+
+        kLast_OpClass = kOther_OpClass
+    };
+    static const int kOpClassCount = kLast_OpClass + 1;
+
+    // Microseconds per op, and per million pixels it covers.
+    struct Coefficients {
+        double fFixedUs;
+        double fPerMPixelUs;
+    };
+
+    struct Calibration {
+        Coefficients fRaster[kOpClassCount];
+        Coefficients fGpu[kOpClassCount];
+
+        const Coefficients& get(Backend backend, OpClass opClass) const {
+            return kRaster_Backend == backend ? fRaster[opClass] : fGpu[opClass];
+        }
+    };
+
+    // The coefficients used when no calibration is given.
+    static void DefaultCalibration(Calibration*);
+
+    // Fits the coefficients in calibration to measured times: drawing pictures[i] whole took
+    // rasterUs[i] microseconds with the raster backend and gpuUs[i] with the GPU.  The fit is
+    // pulled towards the coefficients calibration holds on the way in, so that a few samples
+    // refine them rather than replace them, and classes the samples don't use keep theirs.
+    // Returns false, leaving calibration alone, if there are no samples or a time is negative.
+    static bool Calibrate(const SkPicture* const pictures[], const double rasterUs[],
+                          const double gpuUs[], int count, Calibration*);
+
+    // Prices each tileSize tile of the picture.  Uses the default calibration if NULL.
+    SkBackendCostModel(const SkPicture*, const SkISize& tileSize, const Calibration* = NULL);
+
+    int tilesWide() const { return fTilesWide; }
+    int tilesHigh() const { return fTilesHigh; }
+
+    // Predicted microseconds to draw the tile in column x and row y.
+    double predictUs(Backend, int x, int y) const;
+    // The backend predicted to draw the tile in column x and row y faster.
+    Backend suggestBackend(int x, int y) const;
+
+    // Predicted microseconds to draw the whole picture, in one piece.
+    double predictUs(Backend backend) const {
+        return kRaster_Backend == backend ? fPictureRasterUs : fPictureGpuUs;
+    }
+    // The backend predicted to draw the whole picture faster.
+    Backend suggestBackend() const {
+        return fPictureGpuUs < fPictureRasterUs ? kGpu_Backend : kRaster_Backend;
+    }
+
+    struct Op {
+        OpClass fClass;
+        int     fCount;     // How many draws the op stands for, e.g. the rects of a batch.
+        SkIRect fBounds;    // In picture coordinates.
+    };
+
+    // Classifies and bounds the ops of the picture, as the model sees them.
+    static void Analyze(const SkPicture*, SkTDArray<Op>*);
+
+private:
+    int fTilesWide;
+    int fTilesHigh;
+    SkTDArray<double> fRasterUs;    // Per tile, row by row.
+    SkTDArray<double> fGpuUs;
+    double fPictureRasterUs;
+    double fPictureGpuUs;
+};
+
+#endif//SkBackendCostModel_DEFINED
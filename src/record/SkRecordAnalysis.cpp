@@ -0,0 +1,35 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkRecordAnalysis.h"
+
+#include "SkRecords.h"
+
+namespace {
+
+// An SkRecord visitor that returns true for commands that draw a bitmap.
+struct BitmapTester {
+    template <typename T> bool operator()(const T&) { return false; }
+
+    bool operator()(const SkRecords::DrawBitmap&) { return true; }
+    bool operator()(const SkRecords::DrawBitmapMatrix&) { return true; }
+    bool operator()(const SkRecords::DrawBitmapNine&) { return true; }
+    bool operator()(const SkRecords::DrawBitmapRectToRect&) { return true; }
+    bool operator()(const SkRecords::DrawSprite&) { return true; }
+};
+
+}  // namespace
+
+bool SkRecordWillPlaybackBitmaps(const SkRecord& record) {
+    BitmapTester tester;
+    for (unsigned i = 0; i < record.count(); ++i) {
+        if (record.visit<bool>(i, tester)) {
+            return true;
+        }
+    }
+    return false;
+}
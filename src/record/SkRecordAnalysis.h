@@ -0,0 +1,17 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkRecordAnalysis_DEFINED
+#define SkRecordAnalysis_DEFINED
+
+#include "SkRecord.h"
+
+// Returns true if drawing the record may draw a bitmap.
+// Like SkPicturePlayback::containsBitmaps(), this looks at bitmap draws, not at shaders.
+bool SkRecordWillPlaybackBitmaps(const SkRecord&);
+
+#endif//SkRecordAnalysis_DEFINED
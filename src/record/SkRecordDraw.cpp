@@ -6,9 +6,90 @@
  */
 
 #include "SkRecordDraw.h"
+#include "SkTSort.h"
+#include "SkTraceEvent.h"
+#include "SkXfermode.h"
+
+SkRecordBBH::SkRecordBBH(const SkRecord& record, int width, int height, SkBBoxHierarchy* bbh)
+    : fBBH(SkRef(bbh)) {
+    SkAutoTMalloc<SkIRect> bounds(record.count());
+    for (unsigned i = 0; i < record.count(); i++) {
+        bounds[i].setEmpty();
+    }
+
+    SkRecords::FillBounds fill(width, height, bounds.get());
+    for (unsigned i = 0; i < record.count(); i++) {
+        fill.setCurrentOp(i);
+        record.visit<void>(i, fill);
+    }
+    fill.finish();
+
+    int count = 0;
+    for (unsigned i = 0; i < record.count(); i++) {
+        count += !bounds[i].isEmpty();
+    }
+    // fDraws must not move once the BBH points into it.
+    fDraws.setCount(count);
+    SkPictureStateTree::Draw* draw = fDraws.begin();
+    for (unsigned i = 0; i < record.count(); i++) {
+        if (!bounds[i].isEmpty()) {
+            draw->fMatrix = NULL;
+            draw->fNode = NULL;
+            draw->fOffset = i;
+            fBBH->insert(draw++, bounds[i], true/*ok to defer*/);
+        }
+    }
+    fBBH->flushDeferredInserts();
+}
+
+void SkRecordBBH::search(const SkIRect& query, SkTDArray<unsigned>* ops) const {
+    SkTDArray<void*> results;
+    fBBH->search(query, &results);
+    if (results.count() > 1) {
+        SkTQSort<SkPictureStateTree::Draw>(
+            reinterpret_cast<SkPictureStateTree::Draw**>(results.begin()),
+            reinterpret_cast<SkPictureStateTree::Draw**>(results.end() - 1));
+    }
+
+    ops->rewind();
+    ops->setReserve(results.count());
+    for (int i = 0; i < results.count(); i++) {
+        const unsigned op = static_cast<const SkPictureStateTree::Draw*>(results[i])->fOffset;
+        if (ops->isEmpty() || op != ops->top()) {
+            *ops->append() = op;
+        }
+    }
+}
+
+void SkRecordDraw(const SkRecord& record, SkCanvas* canvas, const SkRecordBBH* bbh,
+                  SkDrawPictureCallback* callback) {
+    TRACE_EVENT0("skia", "SkRecordDraw");
+    if (NULL != bbh) {
+        SkRect clipBounds;
+        if (!canvas->getClipBounds(&clipBounds)) {
+            return;
+        }
+        SkIRect query;
+        clipBounds.roundOut(&query);
+
+        SkTDArray<unsigned> ops;
+        bbh->search(query, &ops);
+
+        // The BBH never returns culls, so Draw's own skipping never kicks in.
+        SkRecords::Draw draw(canvas);
+        for (int i = 0; i < ops.count(); i++) {
+            if (NULL != callback && callback->abortDrawing()) {
+                return;
+            }
+            record.visit<void>(ops[i], draw);
+        }
+        return;
+    }
 
-void SkRecordDraw(const SkRecord& record, SkCanvas* canvas) {
     for (SkRecords::Draw draw(canvas); draw.index() < record.count(); draw.next()) {
+        if (NULL != callback && callback->abortDrawing()) {
+            return;
+        }
         record.visit<void>(draw.index(), draw);
     }
 }
@@ -61,11 +142,316 @@ DRAW(DrawRect, drawRect(r.rect, r.paint));
 DRAW(DrawSprite, drawSprite(r.bitmap, r.left, r.top, r.paint));
 DRAW(DrawText, drawText(r.text, r.byteLength, r.x, r.y, r.paint));
 DRAW(DrawTextOnPath, drawTextOnPath(r.text, r.byteLength, r.path, r.matrix, r.paint));
+DRAW(DrawTextBlob, drawTextBlob(r.blob, r.x, r.y, r.paint));
 DRAW(DrawVertices, drawVertices(r.vmode, r.vertexCount, r.vertices, r.texs, r.colors,
                                 r.xmode.get(), r.indices, r.indexCount, r.paint));
 #undef DRAW
 
 template <> void Draw::draw(const PairedPushCull& r) { this->draw(*r.base); }
 template <> void Draw::draw(const BoundedDrawPosTextH& r) { this->draw(*r.base); }
+template <> void Draw::draw(const BatchedDrawRect& r) {
+    for (unsigned i = 0; i < r.count; i++) {
+        fCanvas->drawRect(r.rects[i], r.paint);
+    }
+}
+
+FillBounds::FillBounds(int width, int height, SkIRect bounds[])
+    : fState(SkNEW_ARGS(SkCanvas, (width, height)))
+    , fDeviceBounds(SkIRect::MakeWH(width, height))
+    , fBounds(bounds)
+    , fCurrentOp(0) {}
+
+FillBounds::FillBounds(SkCanvas* state, SkIRect bounds[])
+    : fState(SkRef(state))
+    , fDeviceBounds(SkIRect::MakeSize(state->getBaseLayerSize()))
+    , fBounds(bounds)
+    , fCurrentOp(0) {}
+
+void FillBounds::finish() {
+    // Close any Save blocks left open, so their ops get bounds too.
+    while (!fSaveStack.isEmpty()) {
+        fBounds[fControlIndices.top()] = this->popSaveBlock();
+        fControlIndices.pop();
+    }
+    // Control ops outside any Save block affect every draw after them.
+    for (int i = 0; i < fControlIndices.count(); i++) {
+        fBounds[fControlIndices[i]] = fDeviceBounds;
+    }
+    fControlIndices.rewind();
+}
+
+void FillBounds::pushControl() {
+    fControlIndices.push(fCurrentOp);
+    if (!fSaveStack.isEmpty()) {
+        fSaveStack.top().controlOps++;
+    }
+}
+
+void FillBounds::pushSaveBlock(const SkPaint* paint) {
+    // The block's control ops are counted by pushControl(), starting with its Save.
+    SaveBounds block = { 0, SkIRect::MakeEmpty(), paint, this->clipBounds() };
+    fSaveStack.push(block);
+    this->pushControl();
+}
+
+// Some layer paints turn transparent black into something else, so restoring the layer
+// draws everywhere it covers, not just where the block drew.
+static bool paint_may_affect_transparent_black(const SkPaint* paint) {
+    if (NULL == paint) {
+        return false;
+    }
+    if (NULL != paint->getImageFilter() || NULL != paint->getColorFilter()) {
+        return true;
+    }
+    SkXfermode::Mode mode;
+    if (SkXfermode::AsMode(paint->getXfermode(), &mode)) {
+        switch (mode) {
+            // With a transparent black source, these don't leave the destination alone.
+            case SkXfermode::kClear_Mode:
+            case SkXfermode::kSrc_Mode:
+            case SkXfermode::kSrcIn_Mode:
+            case SkXfermode::kDstIn_Mode:
+            case SkXfermode::kSrcOut_Mode:
+            case SkXfermode::kDstATop_Mode:
+            case SkXfermode::kModulate_Mode:
+                return true;
+            default:
+                break;
+        }
+        return false;
+    }
+    // A custom xfermode could do anything.
+    return true;
+}
+
+// Gives the block's bounds to all its control ops but its Save, which the caller pairs up.
+SkIRect FillBounds::popSaveBlock() {
+    SaveBounds block;
+    fSaveStack.pop(&block);
+    if (paint_may_affect_transparent_black(block.paint)) {
+        block.bounds = block.clip;
+    }
+    while (block.controlOps-- > 1) {
+        fBounds[fControlIndices.top()] = block.bounds;
+        fControlIndices.pop();
+    }
+    this->updateSaveBounds(block.bounds);
+    return block.bounds;
+}
+
+void FillBounds::updateSaveBounds(const SkIRect& bounds) {
+    if (!fSaveStack.isEmpty()) {
+        fSaveStack.top().bounds.join(bounds);
+    }
+}
+
+void FillBounds::operator()(const Save&) {
+    this->pushSaveBlock(NULL);
+    fState->save();
+}
+
+void FillBounds::operator()(const SaveLayer& r) {
+    // Only the layer's clip matters here; a no-pixel canvas need not allocate it.
+    fState->save();
+    if (NULL != r.bounds) {
+        fState->clipRect(*r.bounds);
+    }
+    this->pushSaveBlock(r.paint);
+}
+
+void FillBounds::operator()(const Restore&) {
+    if (fSaveStack.isEmpty()) {
+        // Keep an unbalanced restore with the other top-level controls.  It is a no-op unless
+        // fState was saved before we started.
+        this->pushControl();
+        fState->restore();
+        return;
+    }
+    const SkIRect bounds = this->popSaveBlock();
+    fBounds[fControlIndices.top()] = bounds;  // The Save.
+    fControlIndices.pop();
+    fBounds[fCurrentOp] = bounds;
+    fState->restore();
+}
+
+void FillBounds::operator()(const Concat& r) {
+    this->pushControl();
+    fState->concat(r.matrix);
+}
+
+void FillBounds::operator()(const SetMatrix& r) {
+    this->pushControl();
+    fState->setMatrix(r.matrix);
+}
+
+void FillBounds::operator()(const ClipPath& r) {
+    this->pushControl();
+    fState->clipPath(r.path, r.op, r.doAA);
+}
+
+void FillBounds::operator()(const ClipRRect& r) {
+    this->pushControl();
+    fState->clipRRect(r.rrect, r.op, r.doAA);
+}
+
+void FillBounds::operator()(const ClipRect& r) {
+    this->pushControl();
+    fState->clipRect(r.rect, r.op, r.doAA);
+}
+
+void FillBounds::operator()(const ClipRegion& r) {
+    this->pushControl();
+    fState->clipRegion(r.region, r.op);
+}
+
+SkIRect FillBounds::clipBounds() const {
+    SkIRect clip;
+    if (!fState->getClipDeviceBounds(&clip)) {
+        return SkIRect::MakeEmpty();
+    }
+    return clip;
+}
+
+// Adjusts rect, in local coordinates, for paint's effects, and maps it to clipped device bounds.
+SkIRect FillBounds::adjustAndMap(SkRect rect, const SkPaint* paint) const {
+    if (NULL != paint) {
+        if (!paint->canComputeFastBounds()) {
+            return this->clipBounds();
+        }
+        SkRect storage;
+        rect = paint->computeFastBounds(rect, &storage);
+    }
+    fState->getTotalMatrix().mapRect(&rect);
+
+    SkIRect devBounds;
+    rect.roundOut(&devBounds);
+    devBounds.outset(1, 1);  // Antialiasing can touch one more pixel.
+    if (!devBounds.intersect(this->clipBounds())) {
+        return SkIRect::MakeEmpty();
+    }
+    return devBounds;
+}
+
+// Glyphs reach past their origins by at most the font's largest glyph extents.
+static SkRect pad_for_text(SkRect rect, const SkPaint& paint) {
+    SkPaint::FontMetrics metrics;
+    paint.getFontMetrics(&metrics);
+    const SkScalar pad = SkMaxScalar(SkMaxScalar(metrics.fBottom - metrics.fTop,
+                                                 metrics.fXMax - metrics.fXMin),
+                                     metrics.fMaxCharWidth);
+    rect.outset(pad, pad);
+    return rect;
+}
+
+// These ignore the clip, or draw everywhere inside it.
+template <> SkIRect FillBounds::bounds(const Clear&) const { return fDeviceBounds; }
+template <> SkIRect FillBounds::bounds(const DrawPaint&) const { return this->clipBounds(); }
+// Sprites are placed in device space, which need not be ours at playback.
+template <> SkIRect FillBounds::bounds(const DrawSprite&) const { return this->clipBounds(); }
+
+template <> SkIRect FillBounds::bounds(const DrawRect& r) const {
+    return this->adjustAndMap(r.rect, &r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawOval& r) const {
+    return this->adjustAndMap(r.oval, &r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawRRect& r) const {
+    return this->adjustAndMap(r.rrect.rect(), &r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawDRRect& r) const {
+    return this->adjustAndMap(r.outer.rect(), &r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawPath& r) const {
+    if (r.path.isInverseFillType()) {
+        return this->clipBounds();
+    }
+    return this->adjustAndMap(r.path.getBounds(), &r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawPoints& r) const {
+    SkRect rect;
+    rect.set(r.pts, SkToInt(r.count));
+    // Points and lines are stroked, with square caps at worst.
+    const SkScalar stroke = SkMaxScalar(r.paint.getStrokeWidth(), SK_Scalar1);
+    rect.outset(stroke, stroke);
+    return this->adjustAndMap(rect, &r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawVertices& r) const {
+    SkRect rect;
+    rect.set(r.vertices, r.vertexCount);
+    return this->adjustAndMap(rect, &r.paint);
+}
+
+static SkRect bitmap_bounds(const SkBitmap& bitmap) {
+    return SkRect::MakeWH(SkIntToScalar(bitmap.width()), SkIntToScalar(bitmap.height()));
+}
+
+template <> SkIRect FillBounds::bounds(const DrawBitmap& r) const {
+    return this->adjustAndMap(bitmap_bounds(r.bitmap).makeOffset(r.left, r.top), r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawBitmapMatrix& r) const {
+    SkRect rect = bitmap_bounds(r.bitmap);
+    r.matrix.mapRect(&rect);
+    return this->adjustAndMap(rect, r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawBitmapNine& r) const {
+    return this->adjustAndMap(r.dst, r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawBitmapRectToRect& r) const {
+    return this->adjustAndMap(r.dst, r.paint);
+}
+
+template <> SkIRect FillBounds::bounds(const DrawText& r) const {
+    // Alignment can put the text on either side of its origin.
+    const SkScalar length = r.paint.measureText(r.text, r.byteLength);
+    SkRect rect = SkRect::MakeXYWH(r.x, r.y, 0, 0);
+    if (r.paint.isVerticalText()) {
+        rect.outset(0, length);
+    } else {
+        rect.outset(length, 0);
+    }
+    return this->adjustAndMap(pad_for_text(rect, r.paint), &r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawPosText& r) const {
+    const int count = r.paint.countText(r.text, r.byteLength);
+    if (0 == count) {
+        return SkIRect::MakeEmpty();
+    }
+    SkRect rect;
+    rect.set(r.pos, count);
+    return this->adjustAndMap(pad_for_text(rect, r.paint), &r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawPosTextH& r) const {
+    const int count = r.paint.countText(r.text, r.byteLength);
+    if (0 == count) {
+        return SkIRect::MakeEmpty();
+    }
+    SkRect rect = SkRect::MakeXYWH(r.xpos[0], r.y, 0, 0);
+    for (int i = 1; i < count; i++) {
+        rect.fLeft  = SkMinScalar(rect.fLeft,  r.xpos[i]);
+        rect.fRight = SkMaxScalar(rect.fRight, r.xpos[i]);
+    }
+    return this->adjustAndMap(pad_for_text(rect, r.paint), &r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawTextOnPath& r) const {
+    SkRect rect = r.path.getBounds();
+    if (NULL != r.matrix) {
+        r.matrix->mapRect(&rect);
+    }
+    return this->adjustAndMap(pad_for_text(rect, r.paint), &r.paint);
+}
+template <> SkIRect FillBounds::bounds(const DrawTextBlob& r) const {
+    // The blob's bounds already cover its glyphs, so need no padding.
+    return this->adjustAndMap(r.blob->bounds().makeOffset(r.x, r.y), &r.paint);
+}
+template <> SkIRect FillBounds::bounds(const BoundedDrawPosTextH& r) const {
+    return this->bounds(*r.base);
+}
+template <> SkIRect FillBounds::bounds(const BatchedDrawRect& r) const {
+    SkRect rect = r.rects[0];
+    for (unsigned i = 1; i < r.count; i++) {
+        rect.join(r.rects[i]);
+    }
+    return this->adjustAndMap(rect, &r.paint);
+}
 
 }  // namespace SkRecords
@@ -8,11 +8,37 @@
 #ifndef SkRecordDraw_DEFINED
 #define SkRecordDraw_DEFINED
 
-#include "SkRecord.h"
+#include "SkBBoxHierarchy.h"
 #include "SkCanvas.h"
+#include "SkPicture.h"
+#include "SkPictureStateTree.h"
+#include "SkRecord.h"
+
+// A spatial index over the ops of an SkRecord, in the record's own coordinates.  It is immutable
+// once built, so copies of a picture may share it.
+class SkRecordBBH : public SkRefCnt {
+public:
+    // Fills bbh with the bounds of each of record's ops as drawn into a width x height canvas.
+    // Ops inside a Save/Restore block, and the block's Save, Restore, clip and matrix ops, are
+    // bounded by the union of the block's draws.
+    SkRecordBBH(const SkRecord& record, int width, int height, SkBBoxHierarchy* bbh);
+
+    // Replaces ops with the indices, in record order, of the ops that may draw into query.
+    void search(const SkIRect& query, SkTDArray<unsigned>* ops) const;
+
+private:
+    SkAutoTUnref<SkBBoxHierarchy> fBBH;
+    // The BBH's data.  fOffset is the op's index; SkTileGrid sorts on it.
+    SkTDArray<SkPictureStateTree::Draw> fDraws;
+
+    typedef SkRefCnt INHERITED;
+};
 
 // Draw an SkRecord into an SkCanvas.  A convenience wrapper around SkRecords::Draw.
-void SkRecordDraw(const SkRecord&, SkCanvas*);
+// If bbh is given, only the ops intersecting the canvas' clip are drawn.
+// If callback is given, we stop drawing as soon as its abortDrawing() returns true.
+void SkRecordDraw(const SkRecord&, SkCanvas*, const SkRecordBBH* bbh = NULL,
+                  SkDrawPictureCallback* callback = NULL);
 
 namespace SkRecords {
 
@@ -22,6 +48,11 @@ public:
     explicit Draw(SkCanvas* canvas)
         : fInitialCTM(canvas->getTotalMatrix()), fCanvas(canvas), fIndex(0) {}
 
+    // Use this when canvas's current matrix is not the one SetMatrix commands are relative to,
+    // e.g. when replaying a record incrementally into a canvas that has kept its state.
+    Draw(SkCanvas* canvas, const SkMatrix& initialCTM)
+        : fInitialCTM(initialCTM), fCanvas(canvas), fIndex(0) {}
+
     unsigned index() const { return fIndex; }
     void next() { ++fIndex; }
 
@@ -50,6 +81,67 @@ private:
     unsigned fIndex;
 };
 
+// This is an SkRecord visitor that computes the bounds of each op as drawn into a width x height
+// canvas.  Call finish() after the last op.
+class FillBounds : SkNoncopyable {
+public:
+    // bounds must have room for each op, and start out empty.
+    FillBounds(int width, int height, SkIRect bounds[]);
+    // As above, but tracks the matrix and clip in state, so ops can be bounded in the state left
+    // behind by earlier ops, and later ops in the state these leave behind.
+    FillBounds(SkCanvas* state, SkIRect bounds[]);
+
+    void setCurrentOp(unsigned i) { fCurrentOp = i; }
+    void finish();
+
+    // Draws
+    template <typename T> void operator()(const T& r) {
+        fBounds[fCurrentOp] = this->bounds(r);
+        this->updateSaveBounds(fBounds[fCurrentOp]);
+    }
+
+    // Culls are only hints, and draw nothing.
+    void operator()(const NoOp&) {}
+    void operator()(const PushCull&) {}
+    void operator()(const PopCull&) {}
+    void operator()(const PairedPushCull&) {}
+
+    void operator()(const Save&);
+    void operator()(const SaveLayer&);
+    void operator()(const Restore&);
+    void operator()(const Concat&);
+    void operator()(const SetMatrix&);
+    void operator()(const ClipPath&);
+    void operator()(const ClipRRect&);
+    void operator()(const ClipRect&);
+    void operator()(const ClipRegion&);
+
+private:
+    struct SaveBounds {
+        int            controlOps;  // Control ops in this block, including its Save.
+        SkIRect        bounds;      // Union of the bounds of the block's draws.
+        const SkPaint* paint;       // The SaveLayer's paint, if any.
+        SkIRect        clip;        // Device clip when the block started.
+    };
+
+    void pushControl();
+    void pushSaveBlock(const SkPaint*);
+    SkIRect popSaveBlock();
+    void updateSaveBounds(const SkIRect&);
+
+    SkIRect clipBounds() const;
+    SkIRect adjustAndMap(SkRect rect, const SkPaint*) const;
+
+    template <typename T> SkIRect bounds(const T&) const;
+
+    SkAutoTUnref<SkCanvas> fState;  // Tracks the matrix and clip; need have no pixels.
+    const SkIRect fDeviceBounds;
+    SkIRect* fBounds;
+    unsigned fCurrentOp;
+    SkTDArray<SaveBounds> fSaveStack;
+    SkTDArray<unsigned> fControlIndices;
+};
+
 }  // namespace SkRecords
 
 #endif//SkRecordDraw_DEFINED
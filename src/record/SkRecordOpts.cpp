@@ -10,16 +10,22 @@
 #include "SkRecordPattern.h"
 #include "SkRecords.h"
 #include "SkTDArray.h"
+#include "SkXfermode.h"
 
 using namespace SkRecords;
 
 void SkRecordOptimize(SkRecord* record) {
     // TODO(mtklein): fuse independent optimizations to reduce number of passes?
     SkRecordNoopCulls(record);
+    SkRecordNoopRedundantClips(record);
+    SkRecordFoldMatrices(record);
     SkRecordNoopSaveRestores(record);
     // TODO(mtklein): figure out why we draw differently and reenable
     //SkRecordNoopSaveLayerDrawRestores(record);
 
+    SkRecordNoopOccludedDraws(record);
+    SkRecordBatchDrawRects(record);  // After NoopOccludedDraws, which only looks at DrawRects.
+
     SkRecordAnnotateCullingPairs(record);
     SkRecordReduceDrawPosTextStrength(record);  // Helpful to run this before BoundDrawPosTextH.
     SkRecordBoundDrawPosTextH(record);
@@ -60,6 +66,147 @@ void SkRecordNoopCulls(SkRecord* record) {
     while (apply(&pass, record));
 }
 
+// Tracks a conservative, record-space bounding rect of the clip through the record, and NoOps
+// ClipRects that can't shrink it.  We only do this for non-antialiased clips: a pixel is in a
+// non-AA clip exactly when its center is, so a containing rect removes nothing at any playback
+// matrix.  Antialiased edges would multiply their coverage again.
+// There's no efficient way to express this one as a pattern either.
+class RedundantClipNooper {
+public:
+    RedundantClipNooper() {
+        State initial;
+        initial.matrix.reset();
+        initial.clip = kOpen_Clip;
+        fStates.push(initial);
+    }
+
+    // Draws don't change the clip.
+    template <typename T> void operator()(T*) {}
+
+    void operator()(Save*)      { fStates.push(fStates.top()); }
+    void operator()(SaveLayer*) { fStates.push(fStates.top()); }
+    void operator()(Restore*) {
+        if (fStates.count() > 1) {
+            fStates.pop();
+        }
+    }
+
+    void operator()(Concat* r)    { fStates.top().matrix.preConcat(r->matrix); }
+    void operator()(SetMatrix* r) { fStates.top().matrix = r->matrix; }
+
+    void operator()(ClipRect* r) {
+        State& state = fStates.top();
+        if (r->doAA || !state.matrix.rectStaysRect()) {
+            this->clipShape(r->op, r->doAA);
+            return;
+        }
+        SkRect devRect;
+        state.matrix.mapRect(&devRect, r->rect);
+
+        if (SkRegion::kIntersect_Op == r->op) {
+            if (kOpen_Clip == state.clip) {
+                state.clip = kRect_Clip;
+                state.bounds = devRect;
+            } else if (kRect_Clip == state.clip) {
+                if (devRect.contains(state.bounds)) {
+                    fRecord->replace<NoOp>(fIndex);
+                } else if (!state.bounds.intersect(devRect)) {
+                    state.bounds.setEmpty();
+                }
+            }
+        } else if (SkRegion::kReplace_Op == r->op) {
+            state.clip = kRect_Clip;
+            state.bounds = devRect;
+        } else {
+            this->clipShape(r->op, r->doAA);
+        }
+    }
+    void operator()(ClipRRect* r)  { this->clipShape(r->op, r->doAA); }
+    void operator()(ClipPath* r)   { this->clipShape(r->op, r->doAA); }
+    void operator()(ClipRegion* r) { this->clipShape(r->op, false); }
+
+    void apply(SkRecord* record) {
+        for (fRecord = record, fIndex = 0; fIndex < record->count(); fIndex++) {
+            fRecord->mutate<void>(fIndex, *this);
+        }
+    }
+
+private:
+    enum ClipState {
+        kOpen_Clip,     // No clips yet.
+        kRect_Clip,     // Every pixel in the clip has its center in bounds.
+        kUnknown_Clip,  // We've lost track; keep every clip.
+    };
+
+    struct State {
+        SkMatrix  matrix;
+        ClipState clip;
+        SkRect    bounds;
+    };
+
+    // Any other clip.  Intersecting or subtracting a non-AA shape can only shrink the clip, so
+    // bounds stays conservative.  Anything else and we give up until the next Restore.
+    void clipShape(SkRegion::Op op, bool doAA) {
+        if (doAA || (SkRegion::kIntersect_Op != op && SkRegion::kDifference_Op != op)) {
+            fStates.top().clip = kUnknown_Clip;
+        }
+    }
+
+    SkTDArray<State> fStates;
+    SkRecord* fRecord;
+    unsigned fIndex;
+};
+void SkRecordNoopRedundantClips(SkRecord* record) {
+    RedundantClipNooper pass;
+    pass.apply(record);
+}
+
+// Concat(A)-NoOp*-Concat(B) becomes NoOp-NoOp*-Concat(AB).
+struct ConcatFolder {
+    typedef Pattern3<Is<Concat>, Star<Is<NoOp> >, Is<Concat> > Pattern;
+
+    bool onMatch(SkRecord* record, Pattern* pattern, unsigned begin, unsigned end) {
+        Concat* second = pattern->third<Concat>();
+        second->matrix.setConcat(pattern->first<Concat>()->matrix, second->matrix);
+        record->replace<NoOp>(begin);
+        return true;
+    }
+};
+
+// SetMatrix(A)-NoOp*-Concat(B) becomes NoOp-NoOp*-SetMatrix(AB).
+struct SetMatrixConcatFolder {
+    typedef Pattern3<Is<SetMatrix>, Star<Is<NoOp> >, Is<Concat> > Pattern;
+
+    bool onMatch(SkRecord* record, Pattern* pattern, unsigned begin, unsigned end) {
+        SkMatrix matrix;
+        matrix.setConcat(pattern->first<SetMatrix>()->matrix, pattern->third<Concat>()->matrix);
+        SkNEW_PLACEMENT_ARGS(record->replace<SetMatrix>(end-1), SetMatrix, (matrix));
+        record->replace<NoOp>(begin);
+        return true;
+    }
+};
+
+// (Concat or SetMatrix)-NoOp*-SetMatrix: the SetMatrix wins, so the first does nothing.
+struct OverwrittenMatrixNooper {
+    typedef Pattern3<Or<Is<Concat>, Is<SetMatrix> >, Star<Is<NoOp> >, Is<SetMatrix> > Pattern;
+
+    bool onMatch(SkRecord* record, Pattern* pattern, unsigned begin, unsigned end) {
+        record->replace<NoOp>(begin);
+        return true;
+    }
+};
+
+void SkRecordFoldMatrices(SkRecord* record) {
+    ConcatFolder concats;
+    SetMatrixConcatFolder setMatrixConcats;
+    OverwrittenMatrixNooper overwritten;
+
+    // Run until they stop changing things.
+    while (apply(&concats, record) ||
+           apply(&setMatrixConcats, record) ||
+           apply(&overwritten, record));
+}
+
 // Turns the logical NoOp Save and Restore in Save-Draw*-Restore patterns into actual NoOps.
 struct SaveOnlyDrawsRestoreNooper {
     typedef Pattern3<Is<Save>,
@@ -172,6 +319,182 @@ void SkRecordNoopSaveLayerDrawRestores(SkRecord* record) {
 }
 
 
+// Tracks whether an antialiased clip is in effect, through Save/Restore.
+struct AAClipTracker {
+    AAClipTracker() : fAA(false) {}
+
+    template <typename T> void operator()(T*) {}
+    void operator()(Save*)      { fSaved.push(fAA); }
+    void operator()(SaveLayer*) { fSaved.push(fAA); }
+    void operator()(Restore*) {
+        if (!fSaved.isEmpty()) {
+            fSaved.pop(&fAA);
+        }
+    }
+    void operator()(ClipPath* r)  { fAA = fAA || r->doAA; }
+    void operator()(ClipRRect* r) { fAA = fAA || r->doAA; }
+    void operator()(ClipRect* r)  { fAA = fAA || r->doAA; }
+
+    bool fAA;
+    SkTDArray<bool> fSaved;
+};
+
+// Finds opaque, non-AA DrawRects and NoOps the draws just before them that they cover.  Only draws
+// that, like the DrawRect, touch just the pixels whose centers they cover are considered, so this
+// holds at any playback matrix.  Anything but a draw or NoOp in between ends the search.
+//
+// An antialiased clip blends the edge pixels of both draws, so the earlier one still shows through
+// there.  No DrawRect under an AA clip in the record occludes anything, and the canvas the record
+// is played back into must not have an AA clip either.
+class OccludedDrawNooper {
+public:
+    // Finds conservative bounds for draws that touch only pixels whose centers those bounds
+    // contain.  Everything else returns false.
+    template <typename T> bool operator()(T*) { return false; }
+
+    bool operator()(DrawRect* r)  { fBounds = r->rect;         return IsCentersOnly(&r->paint); }
+    bool operator()(DrawOval* r)  { fBounds = r->oval;         return IsCentersOnly(&r->paint); }
+    bool operator()(DrawRRect* r) { fBounds = r->rrect.rect(); return IsCentersOnly(&r->paint); }
+    bool operator()(DrawDRRect* r) { fBounds = r->outer.rect(); return IsCentersOnly(&r->paint); }
+    bool operator()(DrawPath* r) {
+        fBounds = r->path.getBounds();
+        return !r->path.isInverseFillType() && IsCentersOnly(&r->paint);
+    }
+    bool operator()(DrawBitmap* r) {
+        const SkBitmap& bitmap = r->bitmap;
+        fBounds = SkRect::MakeXYWH(r->left, r->top,
+                                   SkIntToScalar(bitmap.width()), SkIntToScalar(bitmap.height()));
+        return IsCentersOnly(r->paint);
+    }
+    bool operator()(DrawBitmapNine* r)       { fBounds = r->dst; return IsCentersOnly(r->paint); }
+    bool operator()(DrawBitmapRectToRect* r) { fBounds = r->dst; return IsCentersOnly(r->paint); }
+    bool operator()(BatchedDrawRect* r) {
+        fBounds = r->rects[0];
+        for (unsigned i = 1; i < r->count; i++) {
+            fBounds.join(r->rects[i]);
+        }
+        return IsCentersOnly(&r->paint);
+    }
+
+    void apply(SkRecord* record) {
+        // Where the current run of draws and NoOps began.
+        unsigned runStart = 0;
+        for (unsigned i = 0; i < record->count(); i++) {
+            IsDraw isDraw;
+            if (!record->mutate<bool>(i, isDraw)) {
+                Is<NoOp> isNoOp;
+                if (!record->mutate<bool>(i, isNoOp)) {
+                    record->mutate<void>(i, fClip);
+                    runStart = i + 1;
+                }
+                continue;
+            }
+
+            Is<DrawRect> isRect;
+            if (fClip.fAA ||
+                !record->mutate<bool>(i, isRect) || !IsOpaqueOccluder(isRect.get()->paint)) {
+                continue;
+            }
+            const SkRect occluder = isRect.get()->rect;
+
+            const unsigned stop = runStart + kMaxLookBack < i ? i - kMaxLookBack : runStart;
+            for (unsigned j = i; j-- > stop;) {
+                if (record->mutate<bool>(j, *this) && occluder.contains(fBounds)) {
+                    record->replace<NoOp>(j);
+                }
+            }
+        }
+    }
+
+private:
+    // How far back from an occluder we look, to keep this pass linear.
+    static const unsigned kMaxLookBack = 32;
+
+    // Does a draw with this paint touch only the pixels whose centers its geometry covers?
+    static bool IsCentersOnly(const SkPaint* paint) {
+        return NULL == paint || (!paint->isAntiAlias() &&
+                                 SkPaint::kFill_Style == paint->getStyle() &&
+                                 NULL == paint->getMaskFilter() &&
+                                 NULL == paint->getPathEffect() &&
+                                 NULL == paint->getLooper() &&
+                                 NULL == paint->getImageFilter() &&
+                                 NULL == paint->getRasterizer());
+    }
+
+    // Does a DrawRect with this paint replace every pixel it touches with an opaque color?
+    static bool IsOpaqueOccluder(const SkPaint& paint) {
+        if (!IsCentersOnly(&paint) ||
+            0xFF != paint.getAlpha() ||
+            NULL != paint.getShader() ||
+            NULL != paint.getColorFilter()) {
+            return false;
+        }
+        SkXfermode::Mode mode;
+        return SkXfermode::AsMode(paint.getXfermode(), &mode) &&
+               (SkXfermode::kSrcOver_Mode == mode || SkXfermode::kSrc_Mode == mode);
+    }
+
+    SkRect fBounds;
+    AAClipTracker fClip;
+};
+void SkRecordNoopOccludedDraws(SkRecord* record) {
+    OccludedDrawNooper pass;
+    pass.apply(record);
+}
+
+// Merges runs of DrawRects that share a paint, skipping NoOps, into one BatchedDrawRect.
+// Runs are capped so a batch doesn't cover too much of the record for a BBH to cull.
+class DrawRectBatcher {
+public:
+    // Anything else ends the run.
+    template <typename T> void operator()(T*) { this->flush(); }
+    void operator()(NoOp*) {}
+    void operator()(DrawRect* draw) {
+        if (!fRun.isEmpty() && (fRun.count() == kMaxRun || draw->paint != fPaint)) {
+            this->flush();
+        }
+        if (fRun.isEmpty()) {
+            fPaint = draw->paint;
+        }
+        fRun.push(fIndex);
+    }
+
+    void apply(SkRecord* record) {
+        for (fRecord = record, fIndex = 0; fIndex < record->count(); fIndex++) {
+            fRecord->mutate<void>(fIndex, *this);
+        }
+        this->flush();
+    }
+
+private:
+    static const int kMaxRun = 32;
+
+    // Replaces the run's first DrawRect with a BatchedDrawRect, and NoOps the rest.
+    void flush() {
+        if (fRun.count() > 1) {
+            SkRect* rects = fRecord->alloc<SkRect>(fRun.count());
+            for (int i = 0; i < fRun.count(); i++) {
+                Is<DrawRect> isRect;
+                SkAssertResult(fRecord->mutate<bool>(fRun[i], isRect));
+                rects[i] = isRect.get()->rect;
+                fRecord->replace<NoOp>(fRun[i]);
+            }
+            SkNEW_PLACEMENT_ARGS(fRecord->replace<BatchedDrawRect>(fRun[0]),
+                                 BatchedDrawRect, (fPaint, rects, fRun.count()));
+        }
+        fRun.rewind();
+    }
+
+    SkTDArray<unsigned> fRun;  // Indices of the DrawRects in the current run.
+    SkPaint fPaint;            // Their paint.
+    SkRecord* fRecord;
+    unsigned fIndex;
+};
+void SkRecordBatchDrawRects(SkRecord* record) {
+    DrawRectBatcher pass;
+    pass.apply(record);
+}
+
 // Replaces DrawPosText with DrawPosTextH when all Y coordinates are equal.
 struct StrengthReducer {
     typedef Pattern1<Is<DrawPosText> > Pattern;
@@ -16,9 +16,23 @@ void SkRecordOptimize(SkRecord*);
 // NoOp away pointless PushCull/PopCull pairs with nothing between them.
 void SkRecordNoopCulls(SkRecord*);
 
+// NoOp away non-antialiased intersect ClipRects that contain the current clip, as far as we can
+// tell it through Save/Restore and matrix changes.
+void SkRecordNoopRedundantClips(SkRecord*);
+
+// Fold runs of Concats, and Concats following a SetMatrix, into one Concat or SetMatrix.
+void SkRecordFoldMatrices(SkRecord*);
+
 // Turns logical no-op Save-[non-drawing command]*-Restore patterns into actual no-ops.
 void SkRecordNoopSaveRestores(SkRecord*);
 
+// NoOp away draws that a later opaque DrawRect, with no state changes in between, fully covers.
+// Not under antialiased clips: the record must be played back into a canvas without one.
+void SkRecordNoopOccludedDraws(SkRecord*);
+
+// Merge runs of DrawRects that share a paint into BatchedDrawRects.
+void SkRecordBatchDrawRects(SkRecord*);
+
 // For some SaveLayer-[drawing command]-Restore patterns, merge the SaveLayer's alpha into the
 // draw, and no-op the SaveLayer and Restore.
 void SkRecordNoopSaveLayerDrawRestores(SkRecord*);
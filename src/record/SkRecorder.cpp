@@ -10,15 +10,32 @@
 
 // SkCanvas will fail in mysterious ways if it doesn't know the real width and height.
 SkRecorder::SkRecorder(SkRecord* record, int width, int height)
-    : SkCanvas(width, height), fRecord(record) {}
+    : SkCanvas(width, height), fRecord(record), fChunkSink(NULL), fChunkSize(0) {}
 
 void SkRecorder::forgetRecord() {
     fRecord = NULL;
 }
 
+void SkRecorder::setRecord(SkRecord* record) {
+    fRecord = record;
+}
+
+void SkRecorder::setChunkSink(ChunkSink* sink, unsigned chunkSize) {
+    fChunkSink = sink;
+    fChunkSize = chunkSize;
+}
+
 // To make appending to fRecord a little less verbose.
-#define APPEND(T, ...) \
-        SkNEW_PLACEMENT_ARGS(fRecord->append<SkRecords::T>(), SkRecords::T, (__VA_ARGS__))
+#define APPEND(T, ...)                                                                   \
+        do {                                                                             \
+            SkNEW_PLACEMENT_ARGS(fRecord->append<SkRecords::T>(),                        \
+                                 SkRecords::T, (__VA_ARGS__));                           \
+            this->didAppend();                                                           \
+        } while (false)
+
+// Draws (but not state changes) let any SkSurface we belong to know its contents will change.
+#define APPEND_DRAW(T, ...) \
+        do { this->predrawNotify(); APPEND(T, __VA_ARGS__); } while (false)
 
 // For methods which must call back into SkCanvas.
 #define INHERITED(method, ...) this->SkCanvas::method(__VA_ARGS__)
@@ -82,45 +99,51 @@ char* SkRecorder::copy(const char src[], unsigned count) {
 }
 
 void SkRecorder::clear(SkColor color) {
-    APPEND(Clear, color);
+    APPEND_DRAW(Clear, color);
 }
 
 void SkRecorder::drawPaint(const SkPaint& paint) {
-    APPEND(DrawPaint, delay_copy(paint));
+    APPEND_DRAW(DrawPaint, delay_copy(paint));
 }
 
 void SkRecorder::drawPoints(PointMode mode,
                             size_t count,
                             const SkPoint pts[],
                             const SkPaint& paint) {
-    APPEND(DrawPoints, delay_copy(paint), mode, count, this->copy(pts, count));
+    APPEND_DRAW(DrawPoints, delay_copy(paint), mode, count, this->copy(pts, count));
 }
 
 void SkRecorder::drawRect(const SkRect& rect, const SkPaint& paint) {
-    APPEND(DrawRect, delay_copy(paint), rect);
+    APPEND_DRAW(DrawRect, delay_copy(paint), rect);
+}
+
+void SkRecorder::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    for (int i = 0; i < count; ++i) {
+        this->drawRect(rects[i], paint);
+    }
 }
 
 void SkRecorder::drawOval(const SkRect& oval, const SkPaint& paint) {
-    APPEND(DrawOval, delay_copy(paint), oval);
+    APPEND_DRAW(DrawOval, delay_copy(paint), oval);
 }
 
 void SkRecorder::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
-    APPEND(DrawRRect, delay_copy(paint), rrect);
+    APPEND_DRAW(DrawRRect, delay_copy(paint), rrect);
 }
 
 void SkRecorder::onDrawDRRect(const SkRRect& outer, const SkRRect& inner, const SkPaint& paint) {
-    APPEND(DrawDRRect, delay_copy(paint), outer, inner);
+    APPEND_DRAW(DrawDRRect, delay_copy(paint), outer, inner);
 }
 
 void SkRecorder::drawPath(const SkPath& path, const SkPaint& paint) {
-    APPEND(DrawPath, delay_copy(paint), delay_copy(path));
+    APPEND_DRAW(DrawPath, delay_copy(paint), delay_copy(path));
 }
 
 void SkRecorder::drawBitmap(const SkBitmap& bitmap,
                             SkScalar left,
                             SkScalar top,
                             const SkPaint* paint) {
-    APPEND(DrawBitmap, this->copy(paint), delay_copy(bitmap), left, top);
+    APPEND_DRAW(DrawBitmap, this->copy(paint), delay_copy(bitmap), left, top);
 }
 
 void SkRecorder::drawBitmapRectToRect(const SkBitmap& bitmap,
@@ -128,62 +151,67 @@ void SkRecorder::drawBitmapRectToRect(const SkBitmap& bitmap,
                                       const SkRect& dst,
                                       const SkPaint* paint,
                                       DrawBitmapRectFlags flags) {
-    APPEND(DrawBitmapRectToRect,
-           this->copy(paint), delay_copy(bitmap), this->copy(src), dst, flags);
+    APPEND_DRAW(DrawBitmapRectToRect,
+                this->copy(paint), delay_copy(bitmap), this->copy(src), dst, flags);
 }
 
 void SkRecorder::drawBitmapMatrix(const SkBitmap& bitmap,
                                   const SkMatrix& matrix,
                                   const SkPaint* paint) {
-    APPEND(DrawBitmapMatrix, this->copy(paint), delay_copy(bitmap), matrix);
+    APPEND_DRAW(DrawBitmapMatrix, this->copy(paint), delay_copy(bitmap), matrix);
 }
 
 void SkRecorder::drawBitmapNine(const SkBitmap& bitmap,
                                 const SkIRect& center,
                                 const SkRect& dst,
                                 const SkPaint* paint) {
-    APPEND(DrawBitmapNine, this->copy(paint), delay_copy(bitmap), center, dst);
+    APPEND_DRAW(DrawBitmapNine, this->copy(paint), delay_copy(bitmap), center, dst);
 }
 
 void SkRecorder::drawSprite(const SkBitmap& bitmap, int left, int top, const SkPaint* paint) {
-    APPEND(DrawSprite, this->copy(paint), delay_copy(bitmap), left, top);
+    APPEND_DRAW(DrawSprite, this->copy(paint), delay_copy(bitmap), left, top);
 }
 
 void SkRecorder::onDrawText(const void* text, size_t byteLength,
                             SkScalar x, SkScalar y, const SkPaint& paint) {
-    APPEND(DrawText,
-           delay_copy(paint), this->copy((const char*)text, byteLength), byteLength, x, y);
+    APPEND_DRAW(DrawText,
+                delay_copy(paint), this->copy((const char*)text, byteLength), byteLength, x, y);
 }
 
 void SkRecorder::onDrawPosText(const void* text, size_t byteLength,
                                const SkPoint pos[], const SkPaint& paint) {
     const unsigned points = paint.countText(text, byteLength);
-    APPEND(DrawPosText,
-           delay_copy(paint),
-           this->copy((const char*)text, byteLength),
-           byteLength,
-           this->copy(pos, points));
+    APPEND_DRAW(DrawPosText,
+                delay_copy(paint),
+                this->copy((const char*)text, byteLength),
+                byteLength,
+                this->copy(pos, points));
 }
 
 void SkRecorder::onDrawPosTextH(const void* text, size_t byteLength,
                                 const SkScalar xpos[], SkScalar constY, const SkPaint& paint) {
     const unsigned points = paint.countText(text, byteLength);
-    APPEND(DrawPosTextH,
-           delay_copy(paint),
-           this->copy((const char*)text, byteLength),
-           byteLength,
-           this->copy(xpos, points),
-           constY);
+    APPEND_DRAW(DrawPosTextH,
+                delay_copy(paint),
+                this->copy((const char*)text, byteLength),
+                byteLength,
+                this->copy(xpos, points),
+                constY);
 }
 
 void SkRecorder::onDrawTextOnPath(const void* text, size_t byteLength, const SkPath& path,
                                   const SkMatrix* matrix, const SkPaint& paint) {
-    APPEND(DrawTextOnPath,
-           delay_copy(paint),
-           this->copy((const char*)text, byteLength),
-           byteLength,
-           delay_copy(path),
-           this->copy(matrix));
+    APPEND_DRAW(DrawTextOnPath,
+                delay_copy(paint),
+                this->copy((const char*)text, byteLength),
+                byteLength,
+                delay_copy(path),
+                this->copy(matrix));
+}
+
+void SkRecorder::onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                                const SkPaint& paint) {
+    APPEND_DRAW(DrawTextBlob, delay_copy(paint), blob, x, y);
 }
 
 void SkRecorder::onDrawPicture(const SkPicture* picture) {
@@ -195,15 +223,15 @@ void SkRecorder::drawVertices(VertexMode vmode,
                               const SkPoint texs[], const SkColor colors[],
                               SkXfermode* xmode,
                               const uint16_t indices[], int indexCount, const SkPaint& paint) {
-    APPEND(DrawVertices, delay_copy(paint),
-                         vmode,
-                         vertexCount,
-                         this->copy(vertices, vertexCount),
-                         texs ? this->copy(texs, vertexCount) : NULL,
-                         colors ? this->copy(colors, vertexCount) : NULL,
-                         xmode,
-                         this->copy(indices, indexCount),
-                         indexCount);
+    APPEND_DRAW(DrawVertices, delay_copy(paint),
+                              vmode,
+                              vertexCount,
+                              this->copy(vertices, vertexCount),
+                              texs ? this->copy(texs, vertexCount) : NULL,
+                              colors ? this->copy(colors, vertexCount) : NULL,
+                              xmode,
+                              this->copy(indices, indexCount),
+                              indexCount);
 }
 
 void SkRecorder::willSave(SkCanvas::SaveFlags flags) {
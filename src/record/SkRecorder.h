@@ -22,6 +22,22 @@ public:
     // Make SkRecorder forget entirely about its SkRecord*; all calls to SkRecorder will fail.
     void forgetRecord();
 
+    // Start appending to a new SkRecord.  Canvas state (matrix, clip, save stack) is kept.
+    // Does not take ownership of the SkRecord.
+    void setRecord(SkRecord*);
+
+    // Lets the owner of our SkRecord hand it off once it's full, and give us a new one.
+    class ChunkSink {
+    public:
+        virtual ~ChunkSink() {}
+        // Called after a command is appended that gives the SkRecord at least chunkSize commands.
+        // Implementations will usually take the SkRecord and call setRecord() with a fresh one.
+        virtual void chunkFull(SkRecorder*) = 0;
+    };
+
+    // Does not take ownership of the ChunkSink.  NULL turns chunking off.
+    void setChunkSink(ChunkSink*, unsigned chunkSize);
+
     void clear(SkColor) SK_OVERRIDE;
     void drawPaint(const SkPaint& paint) SK_OVERRIDE;
     void drawPoints(PointMode mode,
@@ -29,6 +45,7 @@ public:
                     const SkPoint pts[],
                     const SkPaint& paint) SK_OVERRIDE;
     void drawRect(const SkRect& rect, const SkPaint& paint) SK_OVERRIDE;
+    void drawRects(const SkRect rects[], int count, const SkPaint& paint) SK_OVERRIDE;
     void drawOval(const SkRect& oval, const SkPaint&) SK_OVERRIDE;
     void drawRRect(const SkRRect& rrect, const SkPaint& paint) SK_OVERRIDE;
     void drawPath(const SkPath& path, const SkPaint& paint) SK_OVERRIDE;
@@ -89,6 +106,10 @@ public:
                           const SkPath& path,
                           const SkMatrix* matrix,
                           const SkPaint& paint) SK_OVERRIDE;
+    void onDrawTextBlob(const SkTextBlob* blob,
+                        SkScalar x,
+                        SkScalar y,
+                        const SkPaint& paint) SK_OVERRIDE;
     void onClipRect(const SkRect& rect, SkRegion::Op op, ClipEdgeStyle edgeStyle) SK_OVERRIDE;
     void onClipRRect(const SkRRect& rrect, SkRegion::Op op, ClipEdgeStyle edgeStyle) SK_OVERRIDE;
     void onClipPath(const SkPath& path, SkRegion::Op op, ClipEdgeStyle edgeStyle) SK_OVERRIDE;
@@ -106,7 +127,15 @@ private:
     template <typename T>
     T* copy(const T[], unsigned count);
 
+    void didAppend() {
+        if (NULL != fChunkSink && fRecord->count() >= fChunkSize) {
+            fChunkSink->chunkFull(this);
+        }
+    }
+
     SkRecord* fRecord;
+    ChunkSink* fChunkSink;
+    unsigned fChunkSize;
 };
 
 #endif//SkRecorder_DEFINED
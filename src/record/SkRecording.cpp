@@ -7,6 +7,7 @@
 
 #include "SkRecording.h"
 
+#include "SkCondVar.h"
 #include "SkRecord.h"
 #include "SkRecordOpts.h"
 #include "SkRecordDraw.h"
@@ -41,4 +42,126 @@ SkCanvas* SkRecording::canvas() {
     return fRecord.get() ? fRecorder.get() : NULL;
 }
 
+// Passes full SkRecords from the recording thread to the playback thread, oldest first.
+class SkPipelinedRecording::ChunkQueue : public SkRecorder::ChunkSink {
+public:
+    ChunkQueue() : fRecording(SkNEW(SkRecord)), fHead(0), fFinished(false) {}
+
+    ~ChunkQueue() {
+        for (int i = fHead; i < fChunks.count(); i++) {
+            SkDELETE(fChunks[i]);
+        }
+    }
+
+    SkRecord* recording() { return fRecording.get(); }
+    bool finished() const { return NULL == fRecording.get(); }
+
+    // Recording thread.
+    virtual void chunkFull(SkRecorder* recorder) SK_OVERRIDE {
+        this->push(false);
+        recorder->setRecord(fRecording.get());
+    }
+
+    // Hands off the SkRecord being recorded, if it has anything in it.  If last, there will be
+    // no more chunks, and fRecording is left NULL.
+    void push(bool last) {
+        SkRecord* chunk = NULL;
+        if (fRecording->count() > 0) {
+            chunk = fRecording.detach();
+        }
+        if (last) {
+            fRecording.free();
+        } else if (NULL == fRecording.get()) {
+            fRecording.reset(SkNEW(SkRecord));
+        }
+
+        if (NULL == chunk && !last) {
+            return;
+        }
+        fCond.lock();
+        if (NULL != chunk) {
+            fChunks.push(chunk);
+        }
+        fFinished = last;
+        fCond.signal();
+        fCond.unlock();
+    }
+
+    // Playback thread.  Blocks until a chunk arrives, returning NULL when none ever will.
+    SkRecord* pop() {
+        fCond.lock();
+        while (fHead == fChunks.count() && !fFinished) {
+            fCond.wait();
+        }
+        SkRecord* chunk = NULL;
+        if (fHead < fChunks.count()) {
+            chunk = fChunks[fHead++];
+            if (fHead == fChunks.count()) {
+                // Drained; start the array over rather than letting it grow forever.
+                fChunks.rewind();
+                fHead = 0;
+            }
+        }
+        fCond.unlock();
+        return chunk;
+    }
+
+private:
+    SkAutoTDelete<SkRecord> fRecording;  // Only touched by the recording thread.
+
+    // All guarded by fCond.
+    SkCondVar fCond;
+    SkTDArray<SkRecord*> fChunks;  // Chunks in [fHead, count()) are waiting to be drawn.
+    int fHead;
+    bool fFinished;
+};
+
+SkPipelinedRecording::SkPipelinedRecording(int width, int height, int chunkSize)
+    : fQueue(SkNEW(ChunkQueue))
+    , fRecorder(SkNEW_ARGS(SkRecorder, (fQueue->recording(), width, height))) {
+    SkASSERT(chunkSize > 0);
+    fRecorder->setChunkSink(fQueue.get(), chunkSize);
+}
+
+SkPipelinedRecording::~SkPipelinedRecording() {
+    // Our canvas may outlive us, but our chunks will not.
+    fRecorder->setChunkSink(NULL, 0);
+    fRecorder->forgetRecord();
+}
+
+SkCanvas* SkPipelinedRecording::canvas() {
+    return fQueue->finished() ? NULL : fRecorder.get();
+}
+
+void SkPipelinedRecording::flush() {
+    if (!fQueue->finished()) {
+        fQueue->push(false);
+        fRecorder->setRecord(fQueue->recording());
+    }
+}
+
+void SkPipelinedRecording::finish() {
+    SkASSERT(fRecorder->unique());
+    if (!fQueue->finished()) {
+        fRecorder->setChunkSink(NULL, 0);
+        fRecorder->forgetRecord();
+        fQueue->push(true);
+    }
+}
+
+void SkPipelinedRecording::draw(SkCanvas* canvas) {
+    // Like SkPicture::draw(), leave the canvas as we found it, however the saves fall.
+    SkAutoCanvasRestore acr(canvas, true/*save now*/);
+    const SkMatrix initialCTM = canvas->getTotalMatrix();
+
+    SkRecord* chunk;
+    while (NULL != (chunk = fQueue->pop())) {
+        SkAutoTDelete<SkRecord> autoDelete(chunk);
+        SkRecords::Draw draw(canvas, initialCTM);
+        for (; draw.index() < chunk->count(); draw.next()) {
+            chunk->visit<void>(draw.index(), draw);
+        }
+    }
+}
+
 }  // namespace EXPERIMENTAL
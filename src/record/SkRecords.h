@@ -9,6 +9,7 @@
 #define SkRecords_DEFINED
 
 #include "SkCanvas.h"
+#include "SkTextBlob.h"
 
 namespace SkRecords {
 
@@ -53,8 +54,10 @@ namespace SkRecords {
     M(DrawSprite)                                                   \
     M(DrawText)                                                     \
     M(DrawTextOnPath)                                               \
+    M(DrawTextBlob)                                                 \
     M(DrawVertices)                                                 \
-    M(BoundedDrawPosTextH)    /*From SkRecordBoundDrawPosTextH*/
+    M(BoundedDrawPosTextH)    /*From SkRecordBoundDrawPosTextH*/ \
+    M(BatchedDrawRect)        /*From SkRecordBatchDrawRects*/
 
 // Defines SkRecords::Type, an enum of all record types.
 #define ENUM(T) T##_Type,
@@ -159,6 +162,18 @@ private:
     T* fPtr;
 };
 
+// RefBox holds a ref on an immutable ref-counted object, which is shared rather than copied.
+template <typename T>
+class RefBox : SkNoncopyable {
+public:
+    RefBox(T* obj) : fObj(SkRef(obj)) {}
+    ~RefBox() { fObj->unref(); }
+
+    ACT_AS_PTR(fObj);
+private:
+    T* fObj;
+};
+
 #undef ACT_AS_PTR
 
 // Like SkBitmap, but deep copies pixels if they're not immutable.
@@ -240,6 +255,10 @@ RECORD5(DrawTextOnPath, SkPaint, paint,
                         size_t, byteLength,
                         SkPath, path,
                         Optional<SkMatrix>, matrix);
+RECORD4(DrawTextBlob, SkPaint, paint,
+                      RefBox<const SkTextBlob>, blob,
+                      SkScalar, x,
+                      SkScalar, y);
 
 // This guy is so ugly we just write it manually.
 struct DrawVertices {
@@ -278,6 +297,7 @@ struct DrawVertices {
 // Records added by optimizations.
 RECORD2(PairedPushCull, Adopted<PushCull>, base, unsigned, skip);
 RECORD3(BoundedDrawPosTextH, Adopted<DrawPosTextH>, base, SkScalar, minY, SkScalar, maxY);
+RECORD3(BatchedDrawRect, SkPaint, paint, PODArray<SkRect>, rects, unsigned, count);
 
 #undef RECORD0
 #undef RECORD1
@@ -4,6 +4,12 @@
 
 #include "skia-c.h"
 
+#include "GrContextShareGroup.h"
+#include "SkCanvas.h"
+#include "SkPicture.h"
+#include "SkPictureRecorder.h"
+#include "SkRegion.h"
+#include "SkSurface.h"
 #include "gl/GrGLUtil.h"
 
 extern "C" SkiaGrGLInterfaceRef
@@ -50,3 +56,255 @@ extern "C" void
 SkiaGrContextRelease(SkiaGrContextRef aContext) {
     SkSafeUnref(static_cast<GrContext*>(aContext));
 }
+
+extern "C" void
+SkiaGrContextResetContext(SkiaGrContextRef aContext) {
+    static_cast<GrContext*>(aContext)->resetContext();
+}
+
+extern "C" SkiaGrFence
+SkiaGrContextFlushWithFence(SkiaGrContextRef aContext) {
+    return static_cast<GrContext*>(aContext)->flushWithFence();
+}
+
+extern "C" bool
+SkiaGrContextWaitFence(SkiaGrContextRef aContext, SkiaGrFence aFence) {
+    return static_cast<GrContext*>(aContext)->waitFence(aFence);
+}
+
+extern "C" void
+SkiaGrContextDeleteFence(SkiaGrContextRef aContext, SkiaGrFence aFence) {
+    static_cast<GrContext*>(aContext)->deleteFence(aFence);
+}
+
+extern "C" void
+SkiaGrContextFlush(SkiaGrContextRef aContext) {
+    static_cast<GrContext*>(aContext)->flush();
+}
+
+extern "C" void
+SkiaGrContextGetResourceCacheLimits(SkiaGrContextRef aContext, int32_t* maxResources,
+                                    size_t* maxResourceBytes) {
+    int max;
+    static_cast<GrContext*>(aContext)->getResourceCacheLimits(&max, maxResourceBytes);
+    *maxResources = max;
+}
+
+extern "C" void
+SkiaGrContextSetResourceCacheLimits(SkiaGrContextRef aContext, int32_t maxResources,
+                                    size_t maxResourceBytes) {
+    static_cast<GrContext*>(aContext)->setResourceCacheLimits(maxResources, maxResourceBytes);
+}
+
+extern "C" void
+SkiaGrContextGetResourceCacheUsage(SkiaGrContextRef aContext, int32_t* resourceCount,
+                                   size_t* resourceBytes) {
+    int count;
+    static_cast<GrContext*>(aContext)->getResourceCacheUsage(&count, resourceBytes);
+    *resourceCount = count;
+}
+
+extern "C" void
+SkiaGrContextPerformDeferredCleanup(SkiaGrContextRef aContext) {
+    static_cast<GrContext*>(aContext)->performDeferredCleanup();
+}
+
+extern "C" void
+SkiaGrContextPurgeUnlockedResources(SkiaGrContextRef aContext, size_t maxResourceBytes) {
+    static_cast<GrContext*>(aContext)->purgeUnlockedResources(maxResourceBytes);
+}
+
+extern "C" void
+SkiaGrContextFreeGpuResources(SkiaGrContextRef aContext) {
+    static_cast<GrContext*>(aContext)->freeGpuResources();
+}
+
+extern "C" SkiaGrContextShareGroupRef
+SkiaGrContextShareGroupCreate() {
+    return SkNEW(GrContextShareGroup);
+}
+
+extern "C" void
+SkiaGrContextShareGroupRetain(SkiaGrContextShareGroupRef aShareGroup) {
+    SkSafeRef(static_cast<GrContextShareGroup*>(aShareGroup));
+}
+
+extern "C" void
+SkiaGrContextShareGroupRelease(SkiaGrContextShareGroupRef aShareGroup) {
+    SkSafeUnref(static_cast<GrContextShareGroup*>(aShareGroup));
+}
+
+extern "C" SkiaGrContextRef
+SkiaGrContextCreateWithShareGroup(SkiaGrGLInterfaceRef anInterface,
+                                  SkiaGrContextShareGroupRef aShareGroup) {
+    return GrContext::Create(kOpenGL_GrBackend, reinterpret_cast<GrBackendContext>(anInterface),
+                             static_cast<GrContextShareGroup*>(aShareGroup));
+}
+
+extern "C" SkiaSkSurfaceRef
+SkiaSkSurfaceCreateRaster(int32_t width, int32_t height) {
+    return SkSurface::NewRaster(SkImageInfo::MakeN32Premul(width, height));
+}
+
+extern "C" SkiaSkSurfaceRef
+SkiaSkSurfaceCreateRenderTarget(SkiaGrContextRef aContext, int32_t width, int32_t height,
+                                int32_t sampleCount) {
+    return SkSurface::NewRenderTarget(static_cast<GrContext*>(aContext),
+                                      SkImageInfo::MakeN32Premul(width, height), sampleCount);
+}
+
+extern "C" void
+SkiaSkSurfaceRetain(SkiaSkSurfaceRef aSurface) {
+    SkSafeRef(static_cast<SkSurface*>(aSurface));
+}
+
+extern "C" void
+SkiaSkSurfaceRelease(SkiaSkSurfaceRef aSurface) {
+    SkSafeUnref(static_cast<SkSurface*>(aSurface));
+}
+
+extern "C" SkiaSkCanvasRef
+SkiaSkSurfaceGetCanvas(SkiaSkSurfaceRef aSurface) {
+    return static_cast<SkSurface*>(aSurface)->getCanvas();
+}
+
+extern "C" void
+SkiaSkSurfaceDrawPicture(SkiaSkSurfaceRef aSurface, SkiaSkPictureRef aPicture) {
+    static_cast<SkSurface*>(aSurface)->getCanvas()->drawPicture(
+            static_cast<const SkPicture*>(aPicture));
+}
+
+extern "C" void
+SkiaSkSurfaceSetTracksDamage(SkiaSkSurfaceRef aSurface, bool tracksDamage) {
+    static_cast<SkSurface*>(aSurface)->setTracksDamage(tracksDamage);
+}
+
+extern "C" int32_t
+SkiaSkSurfaceGetDamage(SkiaSkSurfaceRef aSurface, int32_t rects[], int32_t maxRects) {
+    int32_t count = 0;
+    for (SkRegion::Iterator iter(static_cast<SkSurface*>(aSurface)->damage());
+         !iter.done();
+         iter.next(), ++count) {
+        if (count < maxRects) {
+            const SkIRect& rect = iter.rect();
+            rects[4 * count + 0] = rect.fLeft;
+            rects[4 * count + 1] = rect.fTop;
+            rects[4 * count + 2] = rect.fRight;
+            rects[4 * count + 3] = rect.fBottom;
+        }
+    }
+    return count;
+}
+
+extern "C" void
+SkiaSkSurfaceResetDamage(SkiaSkSurfaceRef aSurface) {
+    static_cast<SkSurface*>(aSurface)->resetDamage();
+}
+
+// True if b is a rect drawn with the same paint as the rect a.
+static bool
+same_rect_paint(const SkiaCanvasCommand& a, const SkiaCanvasCommand& b) {
+    return SkiaCanvasCommandDrawRect == b.fType && a.fFlags == b.fFlags &&
+           a.fColor == b.fColor && a.fStrokeWidth == b.fStrokeWidth;
+}
+
+extern "C" int32_t
+SkiaSkCanvasDrawCommands(SkiaSkCanvasRef aCanvas, const SkiaCanvasCommand commands[],
+                         int32_t count) {
+    SkCanvas* canvas = static_cast<SkCanvas*>(aCanvas);
+    // One paint for the whole batch, only its color, style and stroke width change.
+    SkPaint paint;
+    for (int32_t i = 0; i < count; ++i) {
+        const SkiaCanvasCommand& command = commands[i];
+        const float* args = command.fArgs;
+        const bool antiAlias = SkToBool(command.fFlags & SkiaCanvasCommandAntiAlias);
+        paint.setColor(command.fColor);
+        paint.setAntiAlias(antiAlias);
+        paint.setStyle(command.fFlags & SkiaCanvasCommandStroke ? SkPaint::kStroke_Style
+                                                                : SkPaint::kFill_Style);
+        paint.setStrokeWidth(command.fStrokeWidth);
+
+        switch (command.fType) {
+            case SkiaCanvasCommandSave:
+                canvas->save();
+                break;
+            case SkiaCanvasCommandRestore:
+                canvas->restore();
+                break;
+            case SkiaCanvasCommandTranslate:
+                canvas->translate(args[0], args[1]);
+                break;
+            case SkiaCanvasCommandScale:
+                canvas->scale(args[0], args[1]);
+                break;
+            case SkiaCanvasCommandClipRect:
+                canvas->clipRect(SkRect::MakeLTRB(args[0], args[1], args[2], args[3]),
+                                 SkRegion::kIntersect_Op, antiAlias);
+                break;
+            case SkiaCanvasCommandClear:
+                canvas->clear(command.fColor);
+                break;
+            case SkiaCanvasCommandDrawRect: {
+                // Consecutive rects with the same paint are drawn as a batch.
+                int32_t end = i + 1;
+                while (end < count && same_rect_paint(command, commands[end])) {
+                    ++end;
+                }
+                SkAutoSTMalloc<16, SkRect> rects(end - i);
+                for (int32_t j = i; j < end; ++j) {
+                    const float* rectArgs = commands[j].fArgs;
+                    rects[j - i] = SkRect::MakeLTRB(rectArgs[0], rectArgs[1],
+                                                    rectArgs[2], rectArgs[3]);
+                }
+                canvas->drawRects(rects.get(), end - i, paint);
+                i = end - 1;
+                break;
+            }
+            case SkiaCanvasCommandDrawOval:
+                canvas->drawOval(SkRect::MakeLTRB(args[0], args[1], args[2], args[3]), paint);
+                break;
+            case SkiaCanvasCommandDrawLine:
+                canvas->drawLine(args[0], args[1], args[2], args[3], paint);
+                break;
+            default:
+                return i;
+        }
+    }
+    return count;
+}
+
+extern "C" void
+SkiaSkCanvasDrawPicture(SkiaSkCanvasRef aCanvas, SkiaSkPictureRef aPicture) {
+    static_cast<SkCanvas*>(aCanvas)->drawPicture(static_cast<const SkPicture*>(aPicture));
+}
+
+extern "C" SkiaSkPictureRecorderRef
+SkiaSkPictureRecorderCreate() {
+    return SkNEW(SkPictureRecorder);
+}
+
+extern "C" void
+SkiaSkPictureRecorderDestroy(SkiaSkPictureRecorderRef aRecorder) {
+    SkDELETE(static_cast<SkPictureRecorder*>(aRecorder));
+}
+
+extern "C" SkiaSkCanvasRef
+SkiaSkPictureRecorderBeginRecording(SkiaSkPictureRecorderRef aRecorder, int32_t width,
+                                    int32_t height) {
+    return static_cast<SkPictureRecorder*>(aRecorder)->beginRecording(width, height);
+}
+
+extern "C" SkiaSkPictureRef
+SkiaSkPictureRecorderEndRecording(SkiaSkPictureRecorderRef aRecorder) {
+    return static_cast<SkPictureRecorder*>(aRecorder)->endRecording();
+}
+
+extern "C" void
+SkiaSkPictureRetain(SkiaSkPictureRef aPicture) {
+    SkSafeRef(static_cast<const SkPicture*>(aPicture));
+}
+
+extern "C" void
+SkiaSkPictureRelease(SkiaSkPictureRef aPicture) {
+    SkSafeUnref(static_cast<const SkPicture*>(aPicture));
+}
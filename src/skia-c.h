@@ -8,7 +8,42 @@
 #define SKIA_C_DEFINED
 
 typedef void* SkiaGrContextRef;
+typedef void* SkiaGrContextShareGroupRef;
 typedef const void* SkiaGrGLInterfaceRef;
+typedef uint64_t SkiaGrFence;
+typedef void* SkiaSkSurfaceRef;
+typedef void* SkiaSkCanvasRef;
+typedef void* SkiaSkPictureRecorderRef;
+typedef const void* SkiaSkPictureRef;
+
+/* The commands SkiaSkCanvasDrawCommands() takes, so that one call can make many draws.
+ * Consecutive DrawRects with the same paint are drawn as one batch. */
+enum {
+    SkiaCanvasCommandSave,
+    SkiaCanvasCommandRestore,
+    SkiaCanvasCommandTranslate,  /* fArgs: dx, dy */
+    SkiaCanvasCommandScale,      /* fArgs: sx, sy */
+    SkiaCanvasCommandClipRect,   /* fArgs: left, top, right, bottom */
+    SkiaCanvasCommandClear,      /* fColor */
+    SkiaCanvasCommandDrawRect,   /* fArgs: left, top, right, bottom */
+    SkiaCanvasCommandDrawOval,   /* fArgs: left, top, right, bottom */
+    SkiaCanvasCommandDrawLine    /* fArgs: x0, y0, x1, y1 */
+};
+
+/* SkiaCanvasCommand flags. Clips only use AntiAlias. */
+enum {
+    SkiaCanvasCommandAntiAlias = 0x1,
+    SkiaCanvasCommandStroke    = 0x2
+};
+
+/* The paint of the draws is fColor (unpremultiplied ARGB), fFlags and fStrokeWidth. */
+typedef struct {
+    uint32_t fType;
+    uint32_t fFlags;
+    uint32_t fColor;
+    float    fStrokeWidth;
+    float    fArgs[4];
+} SkiaCanvasCommand;
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,6 +58,51 @@ bool SkiaGrGLInterfaceGLVersionGreaterThanOrEqualTo(SkiaGrGLInterfaceRef, int32_
 SkiaGrContextRef SkiaGrContextCreate(SkiaGrGLInterfaceRef);
 void SkiaGrContextRetain(SkiaGrContextRef);
 void SkiaGrContextRelease(SkiaGrContextRef);
+void SkiaGrContextResetContext(SkiaGrContextRef);
+SkiaGrFence SkiaGrContextFlushWithFence(SkiaGrContextRef);
+bool SkiaGrContextWaitFence(SkiaGrContextRef, SkiaGrFence);
+void SkiaGrContextDeleteFence(SkiaGrContextRef, SkiaGrFence);
+void SkiaGrContextFlush(SkiaGrContextRef);
+void SkiaGrContextGetResourceCacheLimits(SkiaGrContextRef, int32_t* maxResources, size_t* maxResourceBytes);
+void SkiaGrContextSetResourceCacheLimits(SkiaGrContextRef, int32_t maxResources, size_t maxResourceBytes);
+void SkiaGrContextGetResourceCacheUsage(SkiaGrContextRef, int32_t* resourceCount, size_t* resourceBytes);
+void SkiaGrContextPerformDeferredCleanup(SkiaGrContextRef);
+void SkiaGrContextPurgeUnlockedResources(SkiaGrContextRef, size_t maxResourceBytes);
+void SkiaGrContextFreeGpuResources(SkiaGrContextRef);
+
+SkiaGrContextShareGroupRef SkiaGrContextShareGroupCreate();
+void SkiaGrContextShareGroupRetain(SkiaGrContextShareGroupRef);
+void SkiaGrContextShareGroupRelease(SkiaGrContextShareGroupRef);
+SkiaGrContextRef SkiaGrContextCreateWithShareGroup(SkiaGrGLInterfaceRef, SkiaGrContextShareGroupRef);
+
+/* Surfaces are N32 premultiplied. Both return NULL on failure. */
+SkiaSkSurfaceRef SkiaSkSurfaceCreateRaster(int32_t width, int32_t height);
+SkiaSkSurfaceRef SkiaSkSurfaceCreateRenderTarget(SkiaGrContextRef, int32_t width, int32_t height, int32_t sampleCount);
+void SkiaSkSurfaceRetain(SkiaSkSurfaceRef);
+void SkiaSkSurfaceRelease(SkiaSkSurfaceRef);
+/* The canvas is owned by the surface. */
+SkiaSkCanvasRef SkiaSkSurfaceGetCanvas(SkiaSkSurfaceRef);
+void SkiaSkSurfaceDrawPicture(SkiaSkSurfaceRef, SkiaSkPictureRef);
+/* See SkSurface::setTracksDamage(). */
+void SkiaSkSurfaceSetTracksDamage(SkiaSkSurfaceRef, bool);
+/* Writes up to maxRects rects of the damage to rects, four values each (left, top, right,
+ * bottom), and returns how many rects the damage has, which may be more than maxRects. */
+int32_t SkiaSkSurfaceGetDamage(SkiaSkSurfaceRef, int32_t rects[], int32_t maxRects);
+void SkiaSkSurfaceResetDamage(SkiaSkSurfaceRef);
+
+/* Returns how many commands were drawn; it stops early at a command it doesn't know. */
+int32_t SkiaSkCanvasDrawCommands(SkiaSkCanvasRef, const SkiaCanvasCommand commands[], int32_t count);
+void SkiaSkCanvasDrawPicture(SkiaSkCanvasRef, SkiaSkPictureRef);
+
+SkiaSkPictureRecorderRef SkiaSkPictureRecorderCreate();
+void SkiaSkPictureRecorderDestroy(SkiaSkPictureRecorderRef);
+/* The canvas is owned by the recorder, and valid until SkiaSkPictureRecorderEndRecording(). */
+SkiaSkCanvasRef SkiaSkPictureRecorderBeginRecording(SkiaSkPictureRecorderRef, int32_t width, int32_t height);
+/* The caller owns the returned picture. */
+SkiaSkPictureRef SkiaSkPictureRecorderEndRecording(SkiaSkPictureRecorderRef);
+
+void SkiaSkPictureRetain(SkiaSkPictureRef);
+void SkiaSkPictureRelease(SkiaSkPictureRef);
 
 #ifdef __cplusplus
 }
@@ -10,6 +10,34 @@ use libc::*;
 
 pub type SkiaGrContextRef = *mut c_void;
 pub type SkiaGrGLInterfaceRef = *const c_void;
+pub type SkiaGrFence = u64;
+pub type SkiaSkSurfaceRef = *mut c_void;
+pub type SkiaSkCanvasRef = *mut c_void;
+pub type SkiaSkPictureRecorderRef = *mut c_void;
+pub type SkiaSkPictureRef = *const c_void;
+
+pub const SkiaCanvasCommandSave: u32 = 0;
+pub const SkiaCanvasCommandRestore: u32 = 1;
+pub const SkiaCanvasCommandTranslate: u32 = 2;
+pub const SkiaCanvasCommandScale: u32 = 3;
+pub const SkiaCanvasCommandClipRect: u32 = 4;
+pub const SkiaCanvasCommandClear: u32 = 5;
+pub const SkiaCanvasCommandDrawRect: u32 = 6;
+pub const SkiaCanvasCommandDrawOval: u32 = 7;
+pub const SkiaCanvasCommandDrawLine: u32 = 8;
+
+pub const SkiaCanvasCommandAntiAlias: u32 = 0x1;
+pub const SkiaCanvasCommandStroke: u32 = 0x2;
+
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct SkiaCanvasCommand {
+    pub fType: u32,
+    pub fFlags: u32,
+    pub fColor: u32,
+    pub fStrokeWidth: f32,
+    pub fArgs: [f32; 4],
+}
 
 extern {
 
@@ -22,5 +50,37 @@ pub fn SkiaGrGLInterfaceGLVersionGreaterThanOrEqualTo(anInterface: SkiaGrGLInter
 pub fn SkiaGrContextCreate(anInterface: SkiaGrGLInterfaceRef) -> SkiaGrContextRef;
 pub fn SkiaGrContextRetain(aContext: SkiaGrContextRef);
 pub fn SkiaGrContextRelease(aContext: SkiaGrContextRef);
+pub fn SkiaGrContextResetContext(aContext: SkiaGrContextRef);
+pub fn SkiaGrContextFlushWithFence(aContext: SkiaGrContextRef) -> SkiaGrFence;
+pub fn SkiaGrContextWaitFence(aContext: SkiaGrContextRef, aFence: SkiaGrFence) -> bool;
+pub fn SkiaGrContextDeleteFence(aContext: SkiaGrContextRef, aFence: SkiaGrFence);
+pub fn SkiaGrContextFlush(aContext: SkiaGrContextRef);
+pub fn SkiaGrContextGetResourceCacheLimits(aContext: SkiaGrContextRef, maxResources: *mut i32, maxResourceBytes: *mut size_t);
+pub fn SkiaGrContextSetResourceCacheLimits(aContext: SkiaGrContextRef, maxResources: i32, maxResourceBytes: size_t);
+pub fn SkiaGrContextGetResourceCacheUsage(aContext: SkiaGrContextRef, resourceCount: *mut i32, resourceBytes: *mut size_t);
+pub fn SkiaGrContextPerformDeferredCleanup(aContext: SkiaGrContextRef);
+pub fn SkiaGrContextPurgeUnlockedResources(aContext: SkiaGrContextRef, maxResourceBytes: size_t);
+pub fn SkiaGrContextFreeGpuResources(aContext: SkiaGrContextRef);
+
+pub fn SkiaSkSurfaceCreateRaster(width: i32, height: i32) -> SkiaSkSurfaceRef;
+pub fn SkiaSkSurfaceCreateRenderTarget(aContext: SkiaGrContextRef, width: i32, height: i32, sampleCount: i32) -> SkiaSkSurfaceRef;
+pub fn SkiaSkSurfaceRetain(aSurface: SkiaSkSurfaceRef);
+pub fn SkiaSkSurfaceRelease(aSurface: SkiaSkSurfaceRef);
+pub fn SkiaSkSurfaceGetCanvas(aSurface: SkiaSkSurfaceRef) -> SkiaSkCanvasRef;
+pub fn SkiaSkSurfaceDrawPicture(aSurface: SkiaSkSurfaceRef, aPicture: SkiaSkPictureRef);
+pub fn SkiaSkSurfaceSetTracksDamage(aSurface: SkiaSkSurfaceRef, tracksDamage: bool);
+pub fn SkiaSkSurfaceGetDamage(aSurface: SkiaSkSurfaceRef, rects: *mut i32, maxRects: i32) -> i32;
+pub fn SkiaSkSurfaceResetDamage(aSurface: SkiaSkSurfaceRef);
+
+pub fn SkiaSkCanvasDrawCommands(aCanvas: SkiaSkCanvasRef, commands: *const SkiaCanvasCommand, count: i32) -> i32;
+pub fn SkiaSkCanvasDrawPicture(aCanvas: SkiaSkCanvasRef, aPicture: SkiaSkPictureRef);
+
+pub fn SkiaSkPictureRecorderCreate() -> SkiaSkPictureRecorderRef;
+pub fn SkiaSkPictureRecorderDestroy(aRecorder: SkiaSkPictureRecorderRef);
+pub fn SkiaSkPictureRecorderBeginRecording(aRecorder: SkiaSkPictureRecorderRef, width: i32, height: i32) -> SkiaSkCanvasRef;
+pub fn SkiaSkPictureRecorderEndRecording(aRecorder: SkiaSkPictureRecorderRef) -> SkiaSkPictureRef;
+
+pub fn SkiaSkPictureRetain(aPicture: SkiaSkPictureRef);
+pub fn SkiaSkPictureRelease(aPicture: SkiaSkPictureRef);
 
 }
@@ -81,3 +81,17 @@ bool SkBitSet::orBits(const SkBitSet& source) {
     }
     return true;
 }
+
+bool SkBitSet::orBits(const SkBitSet& source, int first, int last) {
+    if (fBitCount != source.fBitCount) {
+        return false;
+    }
+    SkASSERT(first >= 0 && first <= last);
+    uint32_t* targetBitmap = internalGet(first);
+    uint32_t* sourceBitmap = source.internalGet(first);
+    const size_t dwordCount = last / 32 - first / 32 + 1;
+    for (size_t i = 0; i < dwordCount; ++i) {
+        targetBitmap[i] |= sourceBitmap[i];
+    }
+    return true;
+}
@@ -41,13 +41,30 @@ public:
      */
     bool orBits(const SkBitSet& source);
 
+    /** Or bits from source, only looking at the dwords that hold bits first
+     *  through last.  The result is the same as orBits() if source has no
+     *  bits set outside of that range, but sparse sets are much faster to
+     *  merge.  false is returned if this doesn't have the same bit count as
+     *  source.
+     */
+    bool orBits(const SkBitSet& source, int first, int last);
+
     /** Export indices of set bits to T array.
      */
     template<typename T>
     void exportTo(SkTDArray<T>* array) const {
+        this->exportTo(array, 0, SkToInt(fBitCount) - 1);
+    }
+
+    /** Export indices of set bits to T array, only looking at the dwords
+     *  that hold bits first through last.
+     */
+    template<typename T>
+    void exportTo(SkTDArray<T>* array, int first, int last) const {
         SkASSERT(array);
+        SkASSERT(first >= 0 && first <= last && (size_t)last < fBitCount);
         uint32_t* data = reinterpret_cast<uint32_t*>(fBitData.get());
-        for (unsigned int i = 0; i < fDwordCount; ++i) {
+        for (unsigned int i = first / 32; i <= (unsigned int)last / 32; ++i) {
             uint32_t value = data[i];
             if (value) {  // There are set bits
                 unsigned int index = i * 32;
@@ -7,6 +7,7 @@
 
 #include "SkBitmap.h"
 #include "SkBitmapHasher.h"
+#include "SkBitmapHasher_opts.h"
 #include "SkEndian.h"
 #include "SkImageEncoder.h"
 
@@ -30,6 +31,94 @@ static inline uint64_t first_8_bytes_as_uint64(const uint8_t *bytearray) {
     return SkEndian_SwapLE64(*(reinterpret_cast<const uint64_t *>(bytearray)));
 }
 
+/**
+ * A 64-bit hash in the style of xxHash64: four independent lanes of
+ * multiply-rotate over 32-byte stripes, for CPUs without a faster
+ * SkBitmapHasherHashProc.
+ */
+static const uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+static const uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return SkEndian_SwapLE64(v);
+}
+
+static inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return SkEndian_SwapLE32(v);
+}
+
+static inline uint64_t hash_round(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    return rotl64(acc, 31) * kPrime1;
+}
+
+static inline uint64_t merge_round(uint64_t acc, uint64_t lane) {
+    acc ^= hash_round(0, lane);
+    return acc * kPrime1 + kPrime4;
+}
+
+static uint64_t hash64(const void* data, size_t bytes, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* const stop = p + bytes;
+    uint64_t h;
+
+    if (bytes >= 32) {
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+        const uint8_t* const lastStripe = stop - 32;
+        do {
+            v1 = hash_round(v1, read64(p));
+            v2 = hash_round(v2, read64(p + 8));
+            v3 = hash_round(v3, read64(p + 16));
+            v4 = hash_round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= lastStripe);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = merge_round(h, v1);
+        h = merge_round(h, v2);
+        h = merge_round(h, v3);
+        h = merge_round(h, v4);
+    } else {
+        h = seed + kPrime5;
+    }
+    h += bytes;
+
+    for (; p + 8 <= stop; p += 8) {
+        h ^= hash_round(0, read64(p));
+        h = rotl64(h, 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= stop) {
+        h ^= read32(p) * kPrime1;
+        h = rotl64(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < stop; ++p) {
+        h ^= *p * kPrime5;
+        h = rotl64(h, 11) * kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
 /*static*/ bool SkBitmapHasher::ComputeDigestInternal(const SkBitmap& bitmap, uint64_t *result) {
     SkMD5 out;
 
@@ -62,3 +151,37 @@ static inline uint64_t first_8_bytes_as_uint64(const uint8_t *bytearray) {
     }
     return ComputeDigestInternal(copyBitmap, result);
 }
+
+/*static*/ bool SkBitmapHasher::ComputeFastDigest(const SkBitmap& bitmap, uint64_t *result) {
+    // Indices mean nothing without their color table, so hash the colors they stand for.
+    if (kIndex_8_SkColorType == bitmap.colorType()) {
+        SkBitmap copyBitmap;
+        if (!bitmap.copyTo(&copyBitmap, kN32_SkColorType)) {
+            return false;
+        }
+        return ComputeFastDigest(copyBitmap, result);
+    }
+
+    SkAutoLockPixels alp(bitmap);
+    if (NULL == bitmap.getPixels() && !bitmap.empty()) {
+        return false;
+    }
+
+    const uint32_t header[4] = {
+        SkEndian_SwapLE32(SkToU32(bitmap.width())),
+        SkEndian_SwapLE32(SkToU32(bitmap.height())),
+        SkEndian_SwapLE32(SkToU32(bitmap.colorType())),
+        SkEndian_SwapLE32(SkToU32(bitmap.alphaType())),
+    };
+    static const SkBitmapHasherHashProc gProc = SkBitmapHasherGetPlatformHashProc();
+    const SkBitmapHasherHashProc proc = gProc ? gProc : hash64;
+    uint64_t hash = proc(header, sizeof(header), 0);
+
+    // Each row seeds the next, leaving out any padding at the ends of the rows.
+    const size_t rowBytes = bitmap.width() * bitmap.bytesPerPixel();
+    for (int y = 0; y < bitmap.height() && rowBytes > 0; ++y) {
+        hash = proc(bitmap.getAddr(0, y), rowBytes, hash);
+    }
+    *result = hash;
+    return true;
+}
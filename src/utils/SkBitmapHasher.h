@@ -28,6 +28,22 @@ public:
      */
     static bool ComputeDigest(const SkBitmap& bitmap, uint64_t *result);
 
+    /**
+     * Fills in "result" with a fast 64-bit hash of the pixels in this bitmap,
+     * along with its dimensions, colortype and alphatype.
+     *
+     * This reads the pixels in place, a row at a time, so it is many times
+     * faster than ComputeDigest(), and bitmaps whose pixels match hash the
+     * same whatever their rowBytes.  Unlike ComputeDigest(), the result may
+     * change between versions of Skia, differs between CPUs (SSE4.2 ones use
+     * CRC32C) and between colortypes, so it is only for comparing bitmaps
+     * within one process (e.g. as a cache key), never for comparing against
+     * stored expectations.  Equal digests do not prove equal pixels.
+     *
+     * Returns false if the pixels cannot be read.
+     */
+    static bool ComputeFastDigest(const SkBitmap& bitmap, uint64_t *result);
+
 private:
     static bool ComputeDigestInternal(const SkBitmap& bitmap, uint64_t *result);
 };
@@ -11,6 +11,7 @@
 #include "SkBitmapDevice.h"
 #include "SkChunkAlloc.h"
 #include "SkColorFilter.h"
+#include "SkCondVar.h"
 #include "SkDrawFilter.h"
 #include "SkGPipe.h"
 #include "SkPaint.h"
@@ -18,6 +19,7 @@
 #include "SkRRect.h"
 #include "SkShader.h"
 #include "SkSurface.h"
+#include "SkThreadUtils.h"
 
 enum {
     // Deferred canvas will auto-flush when recording reaches this limit
@@ -60,14 +62,25 @@ static bool shouldDrawImmediately(const SkBitmap* bitmap, const SkPaint* paint,
 
 class DeferredPipeController : public SkGPipeController {
 public:
+    typedef SkDeferredCanvas::Fence Fence;
+
     DeferredPipeController();
     void setPlaybackCanvas(SkCanvas*);
     virtual ~DeferredPipeController();
     virtual void* requestBlock(size_t minRequest, size_t* actual) SK_OVERRIDE;
     virtual void notifyWritten(size_t bytes) SK_OVERRIDE;
-    void playback(bool silent);
-    bool hasPendingCommands() const { return fAllocator.blockCount() != 0; }
-    size_t storageAllocatedForRecording() const { return fAllocator.totalCapacity(); }
+    // Plays back the recorded blocks, or hands them to the playback thread if there is one.
+    // Returns the fence that is passed once they have been drawn.
+    Fence submit(bool silent);
+    bool setThreaded(bool threaded);
+    bool isThreaded() const { return NULL != fThread; }
+    Fence lastFence() const { return fLastFence; }
+    bool isFencePassed(Fence) const;
+    void waitForFence(Fence);
+    void waitForIdle() { this->waitForFence(fLastFence); }
+    bool hasPendingCommands() const { return fAllocator->blockCount() != 0; }
+    bool hasCommandsInFlight() const { return !this->isFencePassed(fLastFence); }
+    size_t storageAllocatedForRecording() const;
 private:
     enum {
         kMinBlockSize = 4096
@@ -77,24 +90,52 @@ private:
         void* fBlock;
         size_t fSize;
     };
+    // Blocks handed to the playback thread, with the allocator that owns them.
+    struct Batch {
+        SkChunkAlloc* fAllocator;
+        SkTDArray<PipeBlock> fBlockList;
+        uint32_t fFlags;
+        Fence fFence;
+        size_t fBytes;
+    };
+    static void PlaybackThreadMain(void* controller);
+    void playbackLoop();
+    void playBlocks(const SkTDArray<PipeBlock>&, uint32_t flags);
+
     void* fBlock;
     size_t fBytesWritten;
-    SkChunkAlloc fAllocator;
+    SkChunkAlloc* fAllocator;
     SkTDArray<PipeBlock> fBlockList;
     SkGPipeReader fReader;
+    Fence fLastFence;
+
+    // The members below are guarded by fCondVar once fThread is running.
+    SkThread* fThread;
+    mutable SkCondVar fCondVar;
+    SkTDArray<Batch*> fQueue;
+    Fence fCompletedFence;
+    size_t fBytesInFlight;
+    bool fStopping;
 };
 
-DeferredPipeController::DeferredPipeController() :
-    fAllocator(kMinBlockSize) {
+DeferredPipeController::DeferredPipeController() {
     fBlock = NULL;
     fBytesWritten = 0;
+    fAllocator = SkNEW_ARGS(SkChunkAlloc, (kMinBlockSize));
+    fLastFence = 0;
+    fThread = NULL;
+    fCompletedFence = 0;
+    fBytesInFlight = 0;
+    fStopping = false;
 }
 
 DeferredPipeController::~DeferredPipeController() {
-    fAllocator.reset();
+    this->setThreaded(false);
+    SkDELETE(fAllocator);
 }
 
 void DeferredPipeController::setPlaybackCanvas(SkCanvas* canvas) {
+    SkASSERT(!this->hasCommandsInFlight());
     fReader.setCanvas(canvas);
 }
 
@@ -105,7 +146,7 @@ void* DeferredPipeController::requestBlock(size_t minRequest, size_t *actual) {
         fBlockList.push(previousBloc);
     }
     size_t blockSize = SkTMax<size_t>(minRequest, kMinBlockSize);
-    fBlock = fAllocator.allocThrow(blockSize);
+    fBlock = fAllocator->allocThrow(blockSize);
     fBytesWritten = 0;
     *actual = blockSize;
     return fBlock;
@@ -115,21 +156,133 @@ void DeferredPipeController::notifyWritten(size_t bytes) {
     fBytesWritten += bytes;
 }
 
-void DeferredPipeController::playback(bool silent) {
-    uint32_t flags = silent ? SkGPipeReader::kSilent_PlaybackFlag : 0;
-    for (int currentBlock = 0; currentBlock < fBlockList.count(); currentBlock++ ) {
-        fReader.playback(fBlockList[currentBlock].fBlock, fBlockList[currentBlock].fSize,
-                         flags);
+void DeferredPipeController::playBlocks(const SkTDArray<PipeBlock>& blocks, uint32_t flags) {
+    for (int currentBlock = 0; currentBlock < blocks.count(); currentBlock++ ) {
+        fReader.playback(blocks[currentBlock].fBlock, blocks[currentBlock].fSize, flags);
     }
-    fBlockList.reset();
+}
 
+DeferredPipeController::Fence DeferredPipeController::submit(bool silent) {
+    uint32_t flags = silent ? SkGPipeReader::kSilent_PlaybackFlag : 0;
     if (fBlock) {
-        fReader.playback(fBlock, fBytesWritten, flags);
+        fBlockList.push(PipeBlock(fBlock, fBytesWritten));
         fBlock = NULL;
     }
+    ++fLastFence;
+
+    if (NULL == fThread) {
+        this->playBlocks(fBlockList, flags);
+        fBlockList.reset();
+        // Release all allocated blocks
+        fAllocator->reset();
+        fCompletedFence = fLastFence;
+        return fLastFence;
+    }
+
+    // The recording continues in a fresh allocator while the thread plays this one back.
+    Batch* batch = SkNEW(Batch);
+    batch->fAllocator = fAllocator;
+    batch->fBlockList.swap(fBlockList);
+    batch->fFlags = flags;
+    batch->fFence = fLastFence;
+    batch->fBytes = fAllocator->totalCapacity();
+    fAllocator = SkNEW_ARGS(SkChunkAlloc, (kMinBlockSize));
+
+    fCondVar.lock();
+    fQueue.push(batch);
+    fBytesInFlight += batch->fBytes;
+    fCondVar.broadcast();
+    fCondVar.unlock();
+    return fLastFence;
+}
+
+bool DeferredPipeController::isFencePassed(Fence fence) const {
+    if (NULL == fThread) {
+        return true;
+    }
+    fCondVar.lock();
+    // Fences wrap around, so compare them by their distance.
+    bool passed = static_cast<int32_t>(fCompletedFence - fence) >= 0;
+    fCondVar.unlock();
+    return passed;
+}
+
+void DeferredPipeController::waitForFence(Fence fence) {
+    if (NULL == fThread) {
+        return;
+    }
+    fCondVar.lock();
+    while (static_cast<int32_t>(fCompletedFence - fence) < 0) {
+        fCondVar.wait();
+    }
+    fCondVar.unlock();
+}
+
+size_t DeferredPipeController::storageAllocatedForRecording() const {
+    size_t bytes = fAllocator->totalCapacity();
+    if (NULL != fThread) {
+        fCondVar.lock();
+        bytes += fBytesInFlight;
+        fCondVar.unlock();
+    }
+    return bytes;
+}
+
+bool DeferredPipeController::setThreaded(bool threaded) {
+    if (threaded == this->isThreaded()) {
+        return true;
+    }
+    if (threaded) {
+        fThread = SkNEW_ARGS(SkThread, (PlaybackThreadMain, this));
+        if (!fThread->start()) {
+            SkDELETE(fThread);
+            fThread = NULL;
+            return false;
+        }
+        return true;
+    }
 
-    // Release all allocated blocks
-    fAllocator.reset();
+    // The thread plays back whatever is queued before it stops.
+    fCondVar.lock();
+    fStopping = true;
+    fCondVar.broadcast();
+    fCondVar.unlock();
+    fThread->join();
+    SkDELETE(fThread);
+    fThread = NULL;
+    fStopping = false;
+    SkASSERT(0 == fQueue.count() && 0 == fBytesInFlight);
+    return true;
+}
+
+void DeferredPipeController::PlaybackThreadMain(void* controller) {
+    static_cast<DeferredPipeController*>(controller)->playbackLoop();
+}
+
+void DeferredPipeController::playbackLoop() {
+    for (;;) {
+        fCondVar.lock();
+        while (0 == fQueue.count() && !fStopping) {
+            fCondVar.wait();
+        }
+        if (0 == fQueue.count()) {
+            fCondVar.unlock();
+            return;
+        }
+        Batch* batch = fQueue[0];
+        fQueue.remove(0);
+        fCondVar.unlock();
+
+        this->playBlocks(batch->fBlockList, batch->fFlags);
+        SkDELETE(batch->fAllocator);
+
+        fCondVar.lock();
+        fCompletedFence = batch->fFence;
+        fBytesInFlight -= batch->fBytes;
+        fCondVar.broadcast();
+        fCondVar.unlock();
+        SkDELETE(batch);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -153,7 +306,14 @@ public:
     size_t getBitmapSizeThreshold() const;
     void setBitmapSizeThreshold(size_t sizeThreshold);
     void flushPendingCommands(PlaybackMode);
+    SkDeferredCanvas::Fence submitPendingCommands(PlaybackMode);
     void skipPendingCommands();
+    bool setThreadedPlayback(bool threaded);
+    bool isFencePassed(SkDeferredCanvas::Fence fence) const {
+        return fPipeController.isFencePassed(fence);
+    }
+    void waitForFence(SkDeferredCanvas::Fence fence) { fPipeController.waitForFence(fence); }
+    void waitForPlayback() { fPipeController.waitForIdle(); }
     void setMaxRecordingStorage(size_t);
     void recordedDrawCommand();
 
@@ -276,6 +436,11 @@ SkDeferredDevice::SkDeferredDevice(SkSurface* surface) {
 }
 
 void SkDeferredDevice::setSurface(SkSurface* surface) {
+    // The playback thread may still be drawing into the old surface.
+    fPipeController.waitForIdle();
+    if (NULL != surface->getCanvas()->getTopDevice()->accessRenderTarget()) {
+        fPipeController.setThreaded(false);
+    }
     SkRefCnt_SafeAssign(fImmediateCanvas, surface->getCanvas());
     SkRefCnt_SafeAssign(fSurface, surface);
     fPipeController.setPlaybackCanvas(fImmediateCanvas);
@@ -294,6 +459,7 @@ void SkDeferredDevice::init() {
 
 SkDeferredDevice::~SkDeferredDevice() {
     this->flushPendingCommands(kSilent_PlaybackMode);
+    fPipeController.setThreaded(false);
     SkSafeUnref(fImmediateCanvas);
     SkSafeUnref(fSurface);
 }
@@ -331,7 +497,15 @@ bool SkDeferredDevice::isFreshFrame() {
 }
 
 bool SkDeferredDevice::hasPendingCommands() {
-    return fPipeController.hasPendingCommands();
+    return fPipeController.hasPendingCommands() || fPipeController.hasCommandsInFlight();
+}
+
+bool SkDeferredDevice::setThreadedPlayback(bool threaded) {
+    // Only a raster device can be drawn into from another thread.
+    if (threaded && NULL != immediateDevice()->accessRenderTarget()) {
+        return false;
+    }
+    return fPipeController.setThreaded(threaded);
 }
 
 void SkDeferredDevice::aboutToDraw()
@@ -341,6 +515,7 @@ void SkDeferredDevice::aboutToDraw()
     }
     if (fCanDiscardCanvasContents) {
         if (NULL != fSurface) {
+            fPipeController.waitForIdle();
             fSurface->notifyContentWillChange(SkSurface::kDiscard_ContentChangeMode);
         }
         fCanDiscardCanvasContents = false;
@@ -348,14 +523,18 @@ void SkDeferredDevice::aboutToDraw()
 }
 
 void SkDeferredDevice::flushPendingCommands(PlaybackMode playbackMode) {
+    fPipeController.waitForFence(this->submitPendingCommands(playbackMode));
+}
+
+SkDeferredCanvas::Fence SkDeferredDevice::submitPendingCommands(PlaybackMode playbackMode) {
     if (!fPipeController.hasPendingCommands()) {
-        return;
+        return fPipeController.lastFence();
     }
     if (playbackMode == kNormal_PlaybackMode) {
         aboutToDraw();
     }
     fPipeWriter.flushRecording(true);
-    fPipeController.playback(kSilent_PlaybackMode == playbackMode);
+    SkDeferredCanvas::Fence fence = fPipeController.submit(kSilent_PlaybackMode == playbackMode);
     if (fNotificationClient) {
         if (playbackMode == kSilent_PlaybackMode) {
             fNotificationClient->skippedPendingDrawCommands();
@@ -365,6 +544,7 @@ void SkDeferredDevice::flushPendingCommands(PlaybackMode playbackMode) {
     }
 
     fPreviousStorageAllocated = storageAllocatedForRecording();
+    return fence;
 }
 
 void SkDeferredDevice::flush() {
@@ -399,7 +579,14 @@ void SkDeferredDevice::recordedDrawCommand() {
         size_t tryFree = storageAllocated - fMaxRecordingStorageBytes;
         if (this->freeMemoryIfPossible(tryFree) < tryFree) {
             // Flush is necessary to free more space.
-            this->flushPendingCommands(kNormal_PlaybackMode);
+            if (fPipeController.isThreaded()) {
+                // Keep recording while this batch is drawn, but not further ahead than that.
+                SkDeferredCanvas::Fence previous = fPipeController.lastFence();
+                this->submitPendingCommands(kNormal_PlaybackMode);
+                fPipeController.waitForFence(previous);
+            } else {
+                this->flushPendingCommands(kNormal_PlaybackMode);
+            }
             // Free as much as possible to avoid oscillating around fMaxRecordingStorageBytes
             // which could cause a high flushing frequency.
             this->freeMemoryIfPossible(~0U);
@@ -439,6 +626,7 @@ void SkDeferredDevice::prepareForImmediatePixelWrite() {
     if (fPipeController.hasPendingCommands()) {
         this->flushPendingCommands(kNormal_PlaybackMode);
     } else {
+        fPipeController.waitForIdle();
         bool mustNotifyDirectly = !fCanDiscardCanvasContents;
         this->aboutToDraw();
         if (mustNotifyDirectly) {
@@ -574,6 +762,7 @@ SkCanvas* SkDeferredCanvas::drawingCanvas() const {
 
 SkCanvas* SkDeferredCanvas::immediateCanvas() const {
     this->validate();
+    this->getDeferredDevice()->waitForPlayback();
     return this->getDeferredDevice()->immediateCanvas();
 }
 
@@ -610,6 +799,22 @@ void SkDeferredCanvas::silentFlush() {
     }
 }
 
+bool SkDeferredCanvas::setThreadedPlayback(bool threaded) {
+    return this->getDeferredDevice()->setThreadedPlayback(threaded);
+}
+
+SkDeferredCanvas::Fence SkDeferredCanvas::insertFence() {
+    return this->getDeferredDevice()->submitPendingCommands(kNormal_PlaybackMode);
+}
+
+bool SkDeferredCanvas::isFencePassed(Fence fence) const {
+    return this->getDeferredDevice()->isFencePassed(fence);
+}
+
+void SkDeferredCanvas::waitForFence(Fence fence) {
+    this->getDeferredDevice()->waitForFence(fence);
+}
+
 SkDeferredCanvas::~SkDeferredCanvas() {
 }
 
@@ -789,6 +994,12 @@ void SkDeferredCanvas::drawRect(const SkRect& rect, const SkPaint& paint) {
     this->recordedDrawCommand();
 }
 
+void SkDeferredCanvas::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    for (int i = 0; i < count; ++i) {
+        this->drawRect(rects[i], paint);
+    }
+}
+
 void SkDeferredCanvas::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
     if (rrect.isRect()) {
         this->SkDeferredCanvas::drawRect(rrect.getBounds(), paint);
@@ -323,6 +323,12 @@ void SkDumpCanvas::drawRect(const SkRect& rect, const SkPaint& paint) {
     this->dump(kDrawRect_Verb, &paint, "drawRect(%s)", str.c_str());
 }
 
+void SkDumpCanvas::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    for (int i = 0; i < count; ++i) {
+        this->drawRect(rects[i], paint);
+    }
+}
+
 void SkDumpCanvas::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
     SkString str;
     toString(rrect, &str);
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkImageDecodeService.h"
+#include "SkData.h"
+#include "SkPictureUtils.h"
+#include "SkPixelRef.h"
+#include "SkTSort.h"
+
+// Decodes one pixel ref by locking it. Deletes itself.
+class SkImageDecodeService::DecodeTask : public SkRunnable {
+public:
+    explicit DecodeTask(SkPixelRef* pixelRef) : fPixelRef(SkRef(pixelRef)) {}
+
+    virtual void run() SK_OVERRIDE {
+        // If the raster thread got to the pixel ref first there's nothing left to do.
+        if (!fPixelRef->isLocked()) {
+            fPixelRef->lockPixels();
+            fPixelRef->unlockPixels();
+        }
+        SkDELETE(this);
+    }
+
+private:
+    SkAutoTUnref<SkPixelRef> fPixelRef;
+};
+
+SkImageDecodeService::SkImageDecodeService(SkThreadPool* pool) : fTasks(pool) {
+}
+
+SkImageDecodeService::~SkImageDecodeService() {
+    this->wait();
+}
+
+void SkImageDecodeService::prefetch(SkPixelRef* pixelRef) {
+    if (NULL == pixelRef || pixelRef->isLocked()) {
+        return;
+    }
+    fTasks.add(SkNEW_ARGS(DecodeTask, (pixelRef)));
+}
+
+void SkImageDecodeService::prefetch(SkPicture* picture, const SkRect& area) {
+    SkAutoDataUnref data(SkPictureUtils::GatherPixelRefs(picture, area));
+    if (NULL == data.get()) {
+        return;
+    }
+
+    // The list may hold the same pixel ref several times, queue each one once.
+    int count = SkToInt(data->size() / sizeof(SkPixelRef*));
+    SkAutoTMalloc<SkPixelRef*> pixelRefs(count);
+    memcpy(pixelRefs.get(), data->data(), count * sizeof(SkPixelRef*));
+    SkTQSort<SkPixelRef*>(pixelRefs.get(), pixelRefs.get() + count - 1);
+    for (int i = 0; i < count; ++i) {
+        if (0 == i || pixelRefs[i] != pixelRefs[i - 1]) {
+            this->prefetch(pixelRefs[i]);
+        }
+    }
+}
+
+void SkImageDecodeService::wait() {
+    fTasks.wait();
+}
@@ -7,6 +7,7 @@
  */
 #include "SkLayer.h"
 #include "SkCanvas.h"
+#include "SkSurface.h"
 
 //#define DEBUG_DRAW_LAYER_BOUNDS
 //#define DEBUG_TRACK_NEW_DELETE
@@ -28,6 +29,10 @@ SkLayer::SkLayer() {
     fChildrenMatrix.reset();
     fFlags = 0;
 
+    fCache = NULL;
+    fCacheContext = NULL;
+    fInvalidRect.setEmpty();
+
 #ifdef DEBUG_TRACK_NEW_DELETE
     gLayerAllocCount += 1;
     SkDebugf("SkLayer new:    %d\n", gLayerAllocCount);
@@ -45,6 +50,11 @@ SkLayer::SkLayer(const SkLayer& src) : INHERITED() {
     fChildrenMatrix = src.fChildrenMatrix;
     fFlags = src.fFlags;
 
+    // The copy rasterizes its own content when it is first drawn.
+    fCache = NULL;
+    fCacheContext = NULL;
+    fInvalidRect.setEmpty();
+
 #ifdef DEBUG_TRACK_NEW_DELETE
     gLayerAllocCount += 1;
     SkDebugf("SkLayer copy:   %d\n", gLayerAllocCount);
@@ -53,6 +63,7 @@ SkLayer::SkLayer(const SkLayer& src) : INHERITED() {
 
 SkLayer::~SkLayer() {
     this->removeChildren();
+    SkSafeUnref(fCache);
 
 #ifdef DEBUG_TRACK_NEW_DELETE
     gLayerAllocCount -= 1;
@@ -74,6 +85,33 @@ void SkLayer::setInheritFromRootTransform(bool doInherit) {
     }
 }
 
+bool SkLayer::cachesContent() const {
+    return (fFlags & kCachesContent_Flag) != 0;
+}
+
+void SkLayer::setCachesContent(bool doCache) {
+    if (doCache) {
+        fFlags |= kCachesContent_Flag;
+    } else {
+        fFlags &= ~kCachesContent_Flag;
+        this->purgeCachedContent();
+    }
+}
+
+void SkLayer::invalidate() {
+    fInvalidRect = SkRect::MakeSize(m_size);
+}
+
+void SkLayer::invalidate(const SkRect& rect) {
+    fInvalidRect.join(rect);
+}
+
+void SkLayer::purgeCachedContent() {
+    SkSafeSetNull(fCache);
+    fCacheContext = NULL;
+    fInvalidRect.setEmpty();
+}
+
 void SkLayer::setMatrix(const SkMatrix& matrix) {
     fMatrix = matrix;
 }
@@ -173,6 +211,46 @@ void SkLayer::onDraw(SkCanvas*, SkScalar opacity) {
 //    SkDebugf("----- no onDraw for %p\n", this);
 }
 
+bool SkLayer::updateCachedContent(SkCanvas* canvas) {
+    const int width = SkScalarCeilToInt(m_size.width());
+    const int height = SkScalarCeilToInt(m_size.height());
+    if (width <= 0 || height <= 0) {
+        this->purgeCachedContent();
+        return false;
+    }
+
+    if (NULL != fCache && (fCache->width() != width || fCache->height() != height ||
+                           fCacheContext != canvas->getGrContext())) {
+        this->purgeCachedContent();
+    }
+    if (NULL == fCache) {
+        fCache = canvas->newSurface(SkImageInfo::MakeN32Premul(width, height));
+        if (NULL == fCache) {
+            return false;
+        }
+        fCacheContext = canvas->getGrContext();
+        fInvalidRect = SkRect::MakeWH(SkIntToScalar(width), SkIntToScalar(height));
+    }
+
+    SkIRect dirty;
+    fInvalidRect.roundOut(&dirty);
+    fInvalidRect.setEmpty();
+    if (!dirty.intersect(0, 0, width, height)) {
+        return true;
+    }
+
+    SkCanvas* cacheCanvas = fCache->getCanvas();
+    SkAutoCanvasRestore acr(cacheCanvas, true);
+    if (dirty == SkIRect::MakeWH(width, height)) {
+        cacheCanvas->clear(SK_ColorTRANSPARENT);
+    } else {
+        cacheCanvas->clipRect(SkRect::Make(dirty));
+        cacheCanvas->drawColor(SK_ColorTRANSPARENT, SkXfermode::kClear_Mode);
+    }
+    this->onDraw(cacheCanvas, SK_Scalar1);
+    return true;
+}
+
 #include "SkString.h"
 
 void SkLayer::draw(SkCanvas* canvas, SkScalar opacity) {
@@ -204,7 +282,14 @@ void SkLayer::draw(SkCanvas* canvas, SkScalar opacity) {
         canvas->concat(tmp);
     }
 
-    this->onDraw(canvas, opacity);
+    if (this->cachesContent() && this->updateCachedContent(canvas)) {
+        SkPaint paint;
+        paint.setAlpha(SkScalarRoundToInt(SkTMin(opacity, SK_Scalar1) * 255));
+        paint.setFilterLevel(SkPaint::kLow_FilterLevel);
+        fCache->draw(canvas, 0, 0, &paint);
+    } else {
+        this->onDraw(canvas, opacity);
+    }
 
 #ifdef DEBUG_DRAW_LAYER_BOUNDS
     {
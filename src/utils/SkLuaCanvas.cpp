@@ -186,6 +186,12 @@ void SkLuaCanvas::drawRect(const SkRect& rect, const SkPaint& paint) {
     lua.pushPaint(paint, "paint");
 }
 
+void SkLuaCanvas::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    for (int i = 0; i < count; ++i) {
+        this->drawRect(rects[i], paint);
+    }
+}
+
 void SkLuaCanvas::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
     AUTO_LUA("drawRRect");
     lua.pushRRect(rrect, "rrect");
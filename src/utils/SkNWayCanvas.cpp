@@ -163,6 +163,13 @@ void SkNWayCanvas::drawRect(const SkRect& rect, const SkPaint& paint) {
     }
 }
 
+void SkNWayCanvas::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    Iter iter(fList);
+    while (iter.next()) {
+        iter->drawRects(rects, count, paint);
+    }
+}
+
 void SkNWayCanvas::drawOval(const SkRect& rect, const SkPaint& paint) {
     Iter iter(fList);
     while (iter.next()) {
@@ -251,23 +251,32 @@ void SkNinePatch::DrawMesh(SkCanvas* canvas, const SkRect& bounds,
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static void drawNineViaRects(SkCanvas* canvas, const SkRect& dst,
-                             const SkBitmap& bitmap, const SkIRect& margins,
-                             const SkPaint* paint) {
-    const int32_t srcX[4] = {
-        0, margins.fLeft, bitmap.width() - margins.fRight, bitmap.width()
-    };
-    const int32_t srcY[4] = {
-        0, margins.fTop, bitmap.height() - margins.fBottom, bitmap.height()
-    };
-    SkScalar dstX[4] = {
-        dst.fLeft, dst.fLeft + SkIntToScalar(margins.fLeft),
-        dst.fRight - SkIntToScalar(margins.fRight), dst.fRight
-    };
-    SkScalar dstY[4] = {
-        dst.fTop, dst.fTop + SkIntToScalar(margins.fTop),
-        dst.fBottom - SkIntToScalar(margins.fBottom), dst.fBottom
-    };
+// Splits the bitmap into its nine patches: srcX[] and srcY[] are the edges of
+// the columns and rows.
+static void computeNineSrc(const SkBitmap& bitmap, const SkIRect& margins,
+                           int32_t srcX[4], int32_t srcY[4]) {
+    srcX[0] = 0;
+    srcX[1] = margins.fLeft;
+    srcX[2] = bitmap.width() - margins.fRight;
+    srcX[3] = bitmap.width();
+    srcY[0] = 0;
+    srcY[1] = margins.fTop;
+    srcY[2] = bitmap.height() - margins.fBottom;
+    srcY[3] = bitmap.height();
+}
+
+// Where the edges of the columns and rows land in dst. If dst is too small for
+// the margins, they shrink in proportion and the center collapses.
+static void computeNineDst(const SkRect& dst, const SkIRect& margins,
+                           SkScalar dstX[4], SkScalar dstY[4]) {
+    dstX[0] = dst.fLeft;
+    dstX[1] = dst.fLeft + SkIntToScalar(margins.fLeft);
+    dstX[2] = dst.fRight - SkIntToScalar(margins.fRight);
+    dstX[3] = dst.fRight;
+    dstY[0] = dst.fTop;
+    dstY[1] = dst.fTop + SkIntToScalar(margins.fTop);
+    dstY[2] = dst.fBottom - SkIntToScalar(margins.fBottom);
+    dstY[3] = dst.fBottom;
 
     if (dstX[1] > dstX[2]) {
         dstX[1] = dstX[0] + (dstX[3] - dstX[0]) * SkIntToScalar(margins.fLeft) /
@@ -280,6 +289,15 @@ static void drawNineViaRects(SkCanvas* canvas, const SkRect& dst,
             (SkIntToScalar(margins.fTop) + SkIntToScalar(margins.fBottom));
         dstY[2] = dstY[1];
     }
+}
+
+static void drawNineViaRects(SkCanvas* canvas, const SkRect& dst,
+                             const SkBitmap& bitmap, const SkIRect& margins,
+                             const SkPaint* paint) {
+    int32_t srcX[4], srcY[4];
+    SkScalar dstX[4], dstY[4];
+    computeNineSrc(bitmap, margins, srcX, srcY);
+    computeNineDst(dst, margins, dstX, dstY);
 
     SkIRect s;
     SkRect  d;
@@ -298,38 +316,83 @@ static void drawNineViaRects(SkCanvas* canvas, const SkRect& dst,
     }
 }
 
+// Each nine-patch is a 4x4 grid of vertices, triangulated by g3x3Indices.
+static const int kNineVertexCount = 16;
+static const int kNineIndexCount = SK_ARRAY_COUNT(g3x3Indices);
+// As many as 16-bit indices can address.
+static const int kMaxNinesPerMesh = (1 << 16) / kNineVertexCount;
+
+static void drawNinesViaMesh(SkCanvas* canvas, const SkRect dst[], int count,
+                             const SkBitmap& bitmap, const SkIRect& margins,
+                             const SkPaint* paint) {
+    int32_t srcX[4], srcY[4];
+    computeNineSrc(bitmap, margins, srcX, srcY);
+
+    const int maxCount = SkTMin(count, kMaxNinesPerMesh);
+    SkAutoMalloc storage(maxCount * (kNineVertexCount * sizeof(SkPoint) * 2 +
+                                     kNineIndexCount * sizeof(uint16_t)));
+    SkPoint* verts = (SkPoint*)storage.get();
+    SkPoint* texs = verts + maxCount * kNineVertexCount;
+    uint16_t* indices = (uint16_t*)(texs + maxCount * kNineVertexCount);
+
+    SkShader* shader = SkShader::CreateBitmapShader(bitmap,
+                                                    SkShader::kClamp_TileMode,
+                                                    SkShader::kClamp_TileMode);
+    SkPaint p;
+    if (paint) {
+        p = *paint;
+    }
+    p.setShader(shader)->unref();
+
+    for (int first = 0; first < count; first += maxCount) {
+        const int n = SkTMin(count - first, maxCount);
+        SkPoint* v = verts;
+        SkPoint* t = texs;
+        uint16_t* idx = indices;
+        for (int i = 0; i < n; i++) {
+            SkScalar dstX[4], dstY[4];
+            computeNineDst(dst[first + i], margins, dstX, dstY);
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    v->set(dstX[x], dstY[y]); v++;
+                    t->set(SkIntToScalar(srcX[x]), SkIntToScalar(srcY[y])); t++;
+                }
+            }
+            const uint16_t base = SkToU16(i * kNineVertexCount);
+            for (int j = 0; j < kNineIndexCount; j++) {
+                *idx++ = base + g3x3Indices[j];
+            }
+        }
+        canvas->drawVertices(SkCanvas::kTriangles_VertexMode,
+                             n * kNineVertexCount, verts, texs, NULL, NULL,
+                             indices, n * kNineIndexCount, p);
+    }
+}
+
 void SkNinePatch::DrawNine(SkCanvas* canvas, const SkRect& bounds,
                            const SkBitmap& bitmap, const SkIRect& margins,
                            const SkPaint* paint) {
+    DrawNines(canvas, &bounds, 1, bitmap, margins, paint);
+}
+
+void SkNinePatch::DrawNines(SkCanvas* canvas, const SkRect dst[], int count,
+                            const SkBitmap& bitmap, const SkIRect& margins,
+                            const SkPaint* paint) {
+    if (count <= 0 || bitmap.width() == 0 || bitmap.height() == 0) {
+        return;
+    }
+
     /** Our vertices code has numerical precision problems if the transformed
      coordinates land directly on a 1/2 pixel boundary. To work around that
      for now, we only take the vertices case if we are in opengl. Also,
      when not in GL, the vertices impl is slower (more math) than calling
      the viaRects code.
      */
-    if (false /* is our canvas backed by a gpu?*/) {
-        int32_t xDivs[2];
-        int32_t yDivs[2];
-
-        xDivs[0] = margins.fLeft;
-        xDivs[1] = bitmap.width() - margins.fRight;
-        yDivs[0] = margins.fTop;
-        yDivs[1] = bitmap.height() - margins.fBottom;
-
-        if (xDivs[0] > xDivs[1]) {
-            xDivs[0] = bitmap.width() * margins.fLeft /
-                (margins.fLeft + margins.fRight);
-            xDivs[1] = xDivs[0];
-        }
-        if (yDivs[0] > yDivs[1]) {
-            yDivs[0] = bitmap.height() * margins.fTop /
-                (margins.fTop + margins.fBottom);
-            yDivs[1] = yDivs[0];
-        }
-
-        SkNinePatch::DrawMesh(canvas, bounds, bitmap,
-                              xDivs, 2, yDivs, 2, paint);
+    if (NULL != canvas->getGrContext()) {
+        drawNinesViaMesh(canvas, dst, count, bitmap, margins, paint);
     } else {
-        drawNineViaRects(canvas, bounds, bitmap, margins, paint);
+        for (int i = 0; i < count; i++) {
+            drawNineViaRects(canvas, dst[i], bitmap, margins, paint);
+        }
     }
 }
@@ -82,6 +82,10 @@ void SkProxyCanvas::drawRect(const SkRect& rect, const SkPaint& paint) {
     fProxy->drawRect(rect, paint);
 }
 
+void SkProxyCanvas::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    fProxy->drawRects(rects, count, paint);
+}
+
 void SkProxyCanvas::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
     fProxy->drawRRect(rrect, paint);
 }
@@ -0,0 +1,342 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkRingBufferEventTracer.h"
+#include "SkMath.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkTLS.h"
+#include "SkTraceEvent.h"
+
+#if defined(SK_BUILD_FOR_WIN32)
+    #include <windows.h>
+#elif defined(SK_BUILD_FOR_MAC) || defined(SK_BUILD_FOR_IOS)
+    #include <mach/mach_time.h>
+#else
+    #include <time.h>
+#endif
+
+static uint64_t now_ns() {
+#if defined(SK_BUILD_FOR_WIN32)
+    static LARGE_INTEGER gFrequency;
+    if (0 == gFrequency.QuadPart) {
+        QueryPerformanceFrequency(&gFrequency);
+    }
+    LARGE_INTEGER count;
+    QueryPerformanceCounter(&count);
+    return static_cast<uint64_t>(count.QuadPart / gFrequency.QuadPart * 1000000000 +
+                                 count.QuadPart % gFrequency.QuadPart * 1000000000 /
+                                 gFrequency.QuadPart);
+#elif defined(SK_BUILD_FOR_MAC) || defined(SK_BUILD_FOR_IOS)
+    static mach_timebase_info_data_t gTimebase;
+    if (0 == gTimebase.denom) {
+        mach_timebase_info(&gTimebase);
+    }
+    return mach_absolute_time() * gTimebase.numer / gTimebase.denom;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// The macros keep the flag pointers they are handed in statics, so the flags live here rather
+// than in a tracer that may be deleted. The last flag is handed out once the table is full,
+// and is never set.
+static const int kMaxCategories = 64;
+static const char* gCategoryNames[kMaxCategories];
+static uint8_t gCategoryFlags[kMaxCategories + 1];
+static int gCategoryCount;
+SK_DECLARE_STATIC_MUTEX(gCategoryMutex);
+
+static const char kDisabledByDefaultPrefix[] = TRACE_DISABLED_BY_DEFAULT("");
+
+static bool disabled_by_default(const char* name) {
+    return 0 == strncmp(name, kDisabledByDefaultPrefix, sizeof(kDisabledByDefaultPrefix) - 1);
+}
+
+static uint8_t category_flag(const char* name, bool enabled) {
+    return enabled && !disabled_by_default(name)
+           ? SkEventTracer::kEnabledForRecording_CategoryGroupEnabledFlags : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static const int kMaxArgs = 2;
+
+struct SkRingBufferEventTracer::Event {
+    const char*     fName;
+    const uint8_t*  fCategory;
+    uint64_t        fStart;         // ns since the tracer was made
+    uint64_t        fDuration;      // of kComplete events, once their scope ends
+    const char*     fArgNames[kMaxArgs];
+    uint64_t        fArgValues[kMaxArgs];
+    uint8_t         fArgTypes[kMaxArgs];
+    uint8_t         fNumArgs;
+    char            fPhase;
+};
+
+/**
+ *  Only its thread writes to a ring. fCount is the number of events that went through it, and
+ *  is published after the event, so a reader sees every event below it complete unless the
+ *  writer has since come around the ring again.
+ */
+struct SkRingBufferEventTracer::Ring {
+    Ring*       fNext;
+    int         fThreadIndex;
+    uint32_t    fCount;
+    Event*      fEvents;
+};
+
+namespace {
+
+// What each thread remembers of the ring it records into. The tracer ID tells whether the ring
+// belongs to the current tracer; the ring itself belongs to the tracer and outlives the thread.
+struct ThreadRing {
+    int32_t fTracerID;
+    void*   fRing;
+};
+
+}
+
+static void* create_thread_ring() {
+    ThreadRing* threadRing = SkNEW(ThreadRing);
+    threadRing->fTracerID = 0;
+    threadRing->fRing = NULL;
+    return threadRing;
+}
+
+static void delete_thread_ring(void* threadRing) {
+    SkDELETE(static_cast<ThreadRing*>(threadRing));
+}
+
+static int32_t gNextTracerID;
+
+SkRingBufferEventTracer::SkRingBufferEventTracer(int eventsPerThread)
+    : fID(sk_atomic_inc(&gNextTracerID) + 1)
+    , fEventsPerThread(SkNextPow2(SkTMax(eventsPerThread, 1)))
+    , fStartTime(now_ns())
+    , fEnabled(false)
+    , fRings(NULL)
+    , fRingCount(0) {
+}
+
+SkRingBufferEventTracer::~SkRingBufferEventTracer() {
+    this->setEnabled(false);
+    Ring* ring = fRings;
+    while (NULL != ring) {
+        Ring* next = ring->fNext;
+        sk_free(ring->fEvents);
+        SkDELETE(ring);
+        ring = next;
+    }
+}
+
+void SkRingBufferEventTracer::setEnabled(bool enabled) {
+    SkAutoMutexAcquire lock(gCategoryMutex);
+    fEnabled = enabled;
+    for (int i = 0; i < gCategoryCount; ++i) {
+        gCategoryFlags[i] = category_flag(gCategoryNames[i], enabled);
+    }
+}
+
+const uint8_t* SkRingBufferEventTracer::getCategoryGroupEnabled(const char* name) {
+    SkAutoMutexAcquire lock(gCategoryMutex);
+    for (int i = 0; i < gCategoryCount; ++i) {
+        if (0 == strcmp(gCategoryNames[i], name)) {
+            return &gCategoryFlags[i];
+        }
+    }
+    if (gCategoryCount == kMaxCategories) {
+        return &gCategoryFlags[kMaxCategories];
+    }
+    gCategoryNames[gCategoryCount] = name;
+    gCategoryFlags[gCategoryCount] = category_flag(name, fEnabled);
+    return &gCategoryFlags[gCategoryCount++];
+}
+
+static const char* category_name(const uint8_t* categoryEnabledFlag) {
+    if (categoryEnabledFlag >= gCategoryFlags &&
+        categoryEnabledFlag < gCategoryFlags + kMaxCategories) {
+        const int index = SkToInt(categoryEnabledFlag - gCategoryFlags);
+        SkAutoMutexAcquire lock(gCategoryMutex);
+        if (index < gCategoryCount) {
+            return gCategoryNames[index];
+        }
+    }
+    return "unknown";
+}
+
+const char* SkRingBufferEventTracer::getCategoryGroupName(const uint8_t* categoryEnabledFlag) {
+    return category_name(categoryEnabledFlag);
+}
+
+SkRingBufferEventTracer::Ring* SkRingBufferEventTracer::threadRing() {
+    ThreadRing* threadRing = static_cast<ThreadRing*>(SkTLS::Get(create_thread_ring,
+                                                                 delete_thread_ring));
+    if (threadRing->fTracerID != fID) {
+        Ring* ring = SkNEW(Ring);
+        ring->fCount = 0;
+        ring->fEvents = static_cast<Event*>(sk_malloc_throw(fEventsPerThread * sizeof(Event)));
+
+        SkAutoMutexAcquire lock(fRingMutex);
+        ring->fThreadIndex = fRingCount++;
+        ring->fNext = fRings;
+        fRings = ring;
+
+        threadRing->fTracerID = fID;
+        threadRing->fRing = ring;
+    }
+    return static_cast<Ring*>(threadRing->fRing);
+}
+
+SkEventTracer::Handle SkRingBufferEventTracer::addTraceEvent(char phase,
+                                                             const uint8_t* categoryEnabledFlag,
+                                                             const char* name,
+                                                             uint64_t id,
+                                                             int32_t numArgs,
+                                                             const char** argNames,
+                                                             const uint8_t* argTypes,
+                                                             const uint64_t* argValues,
+                                                             uint8_t flags) {
+    Ring* ring = this->threadRing();
+    const uint32_t count = ring->fCount;
+    Event& event = ring->fEvents[count & (fEventsPerThread - 1)];
+
+    event.fName = SkToBool(flags & TRACE_EVENT_FLAG_COPY) ? NULL : name;
+    event.fCategory = categoryEnabledFlag;
+    event.fStart = now_ns() - fStartTime;
+    event.fDuration = 0;
+    event.fPhase = phase;
+    event.fNumArgs = 0;
+    for (int i = 0; i < numArgs && event.fNumArgs < kMaxArgs; ++i) {
+        if (TRACE_VALUE_TYPE_COPY_STRING == argTypes[i] ||
+            TRACE_VALUE_TYPE_CONVERTABLE == argTypes[i]) {
+            continue;
+        }
+        event.fArgNames[event.fNumArgs] = argNames[i];
+        event.fArgTypes[event.fNumArgs] = argTypes[i];
+        event.fArgValues[event.fNumArgs] = argValues[i];
+        event.fNumArgs++;
+    }
+
+    sk_release_store(&ring->fCount, count + 1);
+    // 0 is not a handle, so the handle is the count after the event.
+    return count + 1;
+}
+
+void SkRingBufferEventTracer::updateTraceEventDuration(const uint8_t* categoryEnabledFlag,
+                                                       const char* name,
+                                                       SkEventTracer::Handle handle) {
+    // The scope that started the event ends on the same thread.
+    Ring* ring = this->threadRing();
+    const uint32_t index = static_cast<uint32_t>(handle) - 1;
+    if (0 == handle || ring->fCount - index > static_cast<uint32_t>(fEventsPerThread)) {
+        // The event has already been overwritten.
+        return;
+    }
+    Event& event = ring->fEvents[index & (fEventsPerThread - 1)];
+    event.fDuration = now_ns() - fStartTime - event.fStart;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void append_json_string(SkString* json, const char* str) {
+    json->append("\"");
+    for (; NULL != str && '\0' != *str; ++str) {
+        const unsigned char c = *str;
+        if ('"' == c || '\\' == c) {
+            json->appendf("\\%c", c);
+        } else if (c < 0x20) {
+            json->appendf("\\u%04x", c);
+        } else {
+            json->append(str, 1);
+        }
+    }
+    json->append("\"");
+}
+
+static void append_json_arg(SkString* json, uint8_t type, uint64_t value) {
+    switch (type) {
+        case TRACE_VALUE_TYPE_BOOL:
+            json->append(0 != value ? "true" : "false");
+            break;
+        case TRACE_VALUE_TYPE_UINT:
+            json->appendU64(value);
+            break;
+        case TRACE_VALUE_TYPE_INT:
+            json->appendS64(static_cast<int64_t>(value));
+            break;
+        case TRACE_VALUE_TYPE_DOUBLE: {
+            double d;
+            memcpy(&d, &value, sizeof(d));
+            if (d == d && d - d == 0) {
+                json->appendf("%.17g", d);
+            } else {
+                // JSON has no NaN or infinity.
+                append_json_string(json, d == d ? "inf" : "nan");
+            }
+            break;
+        }
+        case TRACE_VALUE_TYPE_POINTER: {
+            SkString hex;
+            hex.printf("0x%llx", static_cast<unsigned long long>(value));
+            append_json_string(json, hex.c_str());
+            break;
+        }
+        case TRACE_VALUE_TYPE_STRING:
+            append_json_string(json, reinterpret_cast<const char*>(static_cast<uintptr_t>(value)));
+            break;
+        default:
+            json->append("null");
+            break;
+    }
+}
+
+void SkRingBufferEventTracer::writeJSON(SkWStream* stream) const {
+    SkAutoMutexAcquire lock(fRingMutex);
+    stream->writeText("{\"traceEvents\":[");
+    bool first = true;
+    SkString json;
+    for (const Ring* ring = fRings; NULL != ring; ring = ring->fNext) {
+        const uint32_t count = sk_acquire_load(const_cast<uint32_t*>(&ring->fCount));
+        const uint32_t capacity = fEventsPerThread;
+        for (uint32_t i = count > capacity ? count - capacity : 0; i != count; ++i) {
+            const Event& event = ring->fEvents[i & (capacity - 1)];
+            json.reset();
+            json.append(first ? "\n" : ",\n");
+            first = false;
+
+            json.append("{\"name\":");
+            append_json_string(&json, NULL != event.fName ? event.fName : "(copied)");
+            json.append(",\"cat\":");
+            append_json_string(&json, category_name(event.fCategory));
+            json.appendf(",\"ph\":\"%c\",\"pid\":0,\"tid\":%d,\"ts\":%.3f",
+                         event.fPhase, ring->fThreadIndex, event.fStart * 1e-3);
+            if (TRACE_EVENT_PHASE_COMPLETE == event.fPhase) {
+                json.appendf(",\"dur\":%.3f", event.fDuration * 1e-3);
+            }
+            if (event.fNumArgs > 0) {
+                json.append(",\"args\":{");
+                for (int a = 0; a < event.fNumArgs; ++a) {
+                    if (a > 0) {
+                        json.append(",");
+                    }
+                    append_json_string(&json, event.fArgNames[a]);
+                    json.append(":");
+                    append_json_arg(&json, event.fArgTypes[a], event.fArgValues[a]);
+                }
+                json.append("}");
+            }
+            json.append("}");
+            stream->writeText(json.c_str());
+        }
+    }
+    stream->writeText("\n]}\n");
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTaskGroup.h"
+#include "SkThread.h"
+
+// Runs the caller's runnable, then tells the group it's done.  Deletes itself.
+class SkTaskGroup::Tracked : public SkRunnable {
+public:
+    Tracked(SkRunnable* runnable, SkTaskGroup* group) : fRunnable(runnable), fGroup(group) {}
+
+    virtual void run() SK_OVERRIDE {
+        fRunnable->run();
+        fGroup->done();
+        SkDELETE(this);
+    }
+
+private:
+    SkRunnable*  fRunnable;  // Unowned.
+    SkTaskGroup* fGroup;     // Unowned.
+};
+
+// Runs body for indices [start, end), then tells the group it's done.  Deletes itself.
+class SkTaskGroup::ForChunk : public SkRunnable {
+public:
+    ForChunk(SkParallelForBody* body, int start, int end, SkTaskGroup* group)
+        : fBody(body), fStart(start), fEnd(end), fGroup(group) {}
+
+    virtual void run() SK_OVERRIDE {
+        for (int i = fStart; i < fEnd; i++) {
+            fBody->run(i);
+        }
+        fGroup->done();
+        SkDELETE(this);
+    }
+
+private:
+    SkParallelForBody* fBody;   // Unowned.
+    const int          fStart;
+    const int          fEnd;
+    SkTaskGroup*       fGroup;  // Unowned.
+};
+
+SkTaskGroup::SkTaskGroup(SkThreadPool* pool) : fPool(pool), fPending(0) {
+    SkASSERT(NULL != fPool);
+}
+
+SkTaskGroup::~SkTaskGroup() {
+    this->wait();
+}
+
+void SkTaskGroup::add(SkRunnable* runnable) {
+    if (NULL == runnable) {
+        return;
+    }
+    sk_atomic_inc(&fPending);
+    fPool->add(SkNEW_ARGS(Tracked, (runnable, this)));
+}
+
+void SkTaskGroup::parallelFor(int start, int end, SkParallelForBody* body, int grainSize) {
+    SkASSERT(NULL != body);
+    if (grainSize < 1) {
+        grainSize = 1;
+    }
+    // Without threads there's nothing to gain from chunking; just run it all right here.
+    if (0 == fPool->threadCount()) {
+        for (int i = start; i < end; i++) {
+            body->run(i);
+        }
+        return;
+    }
+    for (int i = start; i < end; i += grainSize) {
+        sk_atomic_inc(&fPending);
+        fPool->add(SkNEW_ARGS(ForChunk, (body, i, SkTMin(i + grainSize, end), this)));
+    }
+}
+
+void SkTaskGroup::done() {
+    // We decrement while holding the lock so that wait() can't return (and maybe destroy this
+    // group) while we're still signaling.  It's still atomic because add() doesn't lock.
+    fReady.lock();
+    if (1 == sk_atomic_dec(&fPending)) {
+        fReady.broadcast();
+    }
+    fReady.unlock();
+}
+
+void SkTaskGroup::wait() {
+    fReady.lock();
+    while (fPending > 0) {
+        fReady.wait();
+    }
+    fReady.unlock();
+}
@@ -10,6 +10,12 @@
 #include "SkBitmap.h"
 #include "SkData.h"
 #include "SkEndian.h"
+#include "SkGraphics.h"
+#include "SkTaskGroup.h"
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////
 //
@@ -29,23 +35,55 @@ template <typename T> inline T abs_diff(const T &a, const T &b) {
 //
 ////////////////////////////////////////////////////////////////////////////////
 
-// Return the squared minimum error cost of approximating 'pixel' using the
-// provided palette. Return this in the middle 16 bits of the integer. Return
-// the best index in the palette for this pixel in the bottom 8 bits.
-static uint32_t compute_error(uint8_t pixel, uint8_t palette[8]) {
-    int minIndex = 0;
-    uint8_t error = abs_diff(palette[0], pixel);
-    for (int i = 1; i < 8; ++i) {
-        uint8_t diff = abs_diff(palette[i], pixel);
-        if (diff < error) {
-            minIndex = i;
-            error = diff;
+// Find the entry of the palette nearest to each pixel of a 4x4 block, the first
+// one if several are as near. Store its index in 'indices' and return the sum
+// of the squared distances.
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+static uint32_t select_indices(const uint8_t block[16], const uint8_t palette[8],
+                               uint8_t indices[16]) {
+    const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    __m128i minDiff = _mm_set1_epi8(static_cast<char>(0xFF));
+    __m128i minIndex = _mm_setzero_si128();
+    for (int i = 0; i < 8; ++i) {
+        const __m128i entry = _mm_set1_epi8(static_cast<char>(palette[i]));
+        const __m128i diff = _mm_or_si128(_mm_subs_epu8(pixels, entry),
+                                          _mm_subs_epu8(entry, pixels));
+        // Keep the old index wherever the old distance is no greater.
+        const __m128i keep = _mm_cmpeq_epi8(_mm_min_epu8(diff, minDiff), minDiff);
+        minIndex = _mm_or_si128(_mm_and_si128(keep, minIndex),
+                                _mm_andnot_si128(keep, _mm_set1_epi8(i)));
+        minDiff = _mm_min_epu8(diff, minDiff);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), minIndex);
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_unpacklo_epi8(minDiff, zero);
+    const __m128i hi = _mm_unpackhi_epi8(minDiff, zero);
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(sum));
+}
+#else
+static uint32_t select_indices(const uint8_t block[16], const uint8_t palette[8],
+                               uint8_t indices[16]) {
+    uint32_t error = 0;
+    for (int p = 0; p < 16; ++p) {
+        int minIndex = 0;
+        uint8_t minDiff = abs_diff(palette[0], block[p]);
+        for (int i = 1; i < 8; ++i) {
+            uint8_t diff = abs_diff(palette[i], block[p]);
+            if (diff < minDiff) {
+                minIndex = i;
+                minDiff = diff;
+            }
         }
+        indices[p] = minIndex;
+        error += static_cast<uint32_t>(minDiff) * minDiff;
     }
-    uint16_t errSq = static_cast<uint16_t>(error) * static_cast<uint16_t>(error);
-    SkASSERT(minIndex >= 0 && minIndex < 8);
-    return (static_cast<uint32_t>(errSq) << 8) | static_cast<uint32_t>(minIndex);
+    return error;
 }
+#endif
 
 // Compress LATC block. Each 4x4 block of pixels is decompressed by LATC from two
 // values LUM0 and LUM1, and an index into the generated palette. LATC constructs
@@ -107,18 +145,13 @@ static uint64_t compress_latc_block(uint8_t block[16]) {
     //     the associated palette
     //  -  indices holds the best indices for each palette in the
     //     bottom 48 (16*3) bits.
-    uint32_t accumError[2] = { 0, 0 };
+    uint32_t accumError[2];
     uint64_t indices[2] = { 0, 0 };
-    for (int i = 15; i >= 0; --i) {
-        // For each palette:
-        // 1. Retreive the result of this pixel
-        // 2. Store the error in accumError
-        // 3. Store the minimum palette index in indices.
-        for (int p = 0; p < 2; ++p) {
-            uint32_t result = compute_error(block[i], palettes[p]);
-            accumError[p] += (result >> 8);
-            indices[p] <<= 3;
-            indices[p] |= result & 7;
+    for (int p = 0; p < 2; ++p) {
+        uint8_t pixelIndices[16];
+        accumError[p] = select_indices(block, palettes[p], pixelIndices);
+        for (int i = 15; i >= 0; --i) {
+            indices[p] = (indices[p] << 3) | pixelIndices[i];
         }
     }
 
@@ -143,68 +176,228 @@ static uint64_t compress_latc_block(uint8_t block[16]) {
     return SkEndian_SwapLE64(result);
 }
 
-static SkData *compress_a8_to_latc(const SkBitmap &bm) {
-    // LATC compressed texels down into square 4x4 blocks
-    static const int kLATCBlockSize = 4;
+////////////////////////////////////////////////////////////////////////////////
+//
+// R11 EAC compressor
+//
+////////////////////////////////////////////////////////////////////////////////
 
-    // Make sure that our data is well-formed enough to be
-    // considered for LATC compression
-    if (bm.width() == 0 || bm.height() == 0 ||
-        (bm.width() % kLATCBlockSize) != 0 ||
-        (bm.height() % kLATCBlockSize) != 0 ||
-        (bm.colorType() != kAlpha_8_SkColorType)) {
-        return NULL;
+// Each 4x4 block of pixels is stored by R11 EAC in 64 bits (big endian):
+//
+// bits 63-56: base codeword
+// bits 55-52: multiplier
+// bits 51-48: modifier table index
+// bits 47-0 : 3-bit modifier indices for the sixteen pixels in column-major
+//             order, the top left pixel in the most significant bits.
+//
+// The 11-bit value of a pixel decodes as
+//
+// clamp(base*8 + 4 + modifier*multiplier*8, 0, 2047), if multiplier != 0
+// clamp(base*8 + 4 + modifier, 0, 2047),              if multiplier == 0
+//
+// which, for 8-bit data, is closely approximated by base + modifier*multiplier.
+static const int kR11EACModifierTables[16][8] = {
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 }
+};
+
+// Table 13 is the only one with a zero modifier (at index 4).
+static const int kR11EACZeroTable = 13;
+static const int kR11EACZeroIndex = 4;
+
+// Compress R11 EAC block. Masks are mostly made of blocks that are entirely
+// covered or uncovered, so those are encoded directly. For other blocks every
+// modifier table is tried with the multiplier that stretches it over the
+// block's range and the base that centers it, and the one with the smallest
+// error wins.
+static uint64_t compress_r11eac_block(uint8_t block[16]) {
+    uint8_t maxVal = 0;
+    uint8_t minVal = 255;
+    for (int i = 0; i < 16; ++i) {
+        maxVal = SkMax32(maxVal, block[i]);
+        minVal = SkMin32(minVal, block[i]);
+    }
+
+    uint64_t result;
+    if (minVal == maxVal) {
+        // A multiplier of zero and the zero modifier decode to the base itself.
+        result = (static_cast<uint64_t>(minVal) << 56) |
+                 (static_cast<uint64_t>(kR11EACZeroTable) << 48);
+        for (int i = 0; i < 16; ++i) {
+            result |= static_cast<uint64_t>(kR11EACZeroIndex) << (45 - 3*i);
+        }
+    } else {
+        uint32_t bestError = 0xFFFFFFFF;
+        result = 0;
+        for (int t = 0; t < 16; ++t) {
+            const int* modifiers = kR11EACModifierTables[t];
+            // Index 3 holds the smallest modifier and index 7 the largest.
+            int span = modifiers[7] - modifiers[3];
+            int multiplier = SkPin32((maxVal - minVal + span - 1) / span, 1, 15);
+            int base = SkPin32((maxVal + minVal - (modifiers[3] + modifiers[7]) * multiplier) / 2,
+                               0, 255);
+
+            uint8_t palette[8];
+            for (int i = 0; i < 8; ++i) {
+                palette[i] = SkPin32(base + modifiers[i] * multiplier, 0, 255);
+            }
+
+            uint8_t pixelIndices[16];
+            uint32_t error = select_indices(block, palette, pixelIndices);
+            uint64_t indices = 0;
+            for (int x = 0; x < 4; ++x) {
+                for (int y = 0; y < 4; ++y) {
+                    indices = (indices << 3) | pixelIndices[4*y + x];
+                }
+            }
+
+            if (error < bestError) {
+                bestError = error;
+                result = (static_cast<uint64_t>(base) << 56) |
+                         (static_cast<uint64_t>(multiplier) << 52) |
+                         (static_cast<uint64_t>(t) << 48) |
+                         indices;
+                if (0 == error) {
+                    break;
+                }
+            }
+        }
     }
 
-    // The LATC format is 64 bits per 4x4 block.
-    static const int kLATCEncodedBlockSize = 8;
+    // R11 EAC blocks are big endian.
+    return SkEndian_SwapBE64(result);
+}
 
-    int blocksX = bm.width() / kLATCBlockSize;
-    int blocksY = bm.height() / kLATCBlockSize;
+////////////////////////////////////////////////////////////////////////////////
+//
+// Block rows
+//
+////////////////////////////////////////////////////////////////////////////////
 
-    int compressedDataSize = blocksX * blocksY * kLATCEncodedBlockSize;
-    uint64_t* dst = reinterpret_cast<uint64_t*>(sk_malloc_throw(compressedDataSize));
+// Both formats compress square 4x4 blocks of texels into 64 bits each.
+static const int kBlockSize = 4;
+static const int kEncodedBlockSize = 8;
 
-    uint8_t block[16];
-    const uint8_t* row = reinterpret_cast<const uint8_t*>(bm.getPixels());
-    uint64_t* encPtr = dst;
-    for (int y = 0; y < blocksY; ++y) {
-        for (int x = 0; x < blocksX; ++x) {
-            memcpy(block, row + (kLATCBlockSize * x), 4);
-            memcpy(block + 4, row + bm.rowBytes() + (kLATCBlockSize * x), 4);
-            memcpy(block + 8, row + 2*bm.rowBytes() + (kLATCBlockSize * x), 4);
-            memcpy(block + 12, row + 3*bm.rowBytes() + (kLATCBlockSize * x), 4);
-
-            *encPtr = compress_latc_block(block);
-            ++encPtr;
-        }
-        row += kLATCBlockSize * bm.rowBytes();
+typedef uint64_t (*CompressBlockProc)(uint8_t block[16]);
+
+static CompressBlockProc get_a8_block_proc(SkTextureCompressor::Format format) {
+    switch (format) {
+        case SkTextureCompressor::kLATC_Format:
+            return compress_latc_block;
+        case SkTextureCompressor::kR11_EAC_Format:
+            return compress_r11eac_block;
     }
+    return NULL;
+}
 
-    return SkData::NewFromMalloc(dst, compressedDataSize);
+// Compress the blocks of the four rows at src into blocksX blocks at dst.
+static void compress_block_row(CompressBlockProc proc, uint64_t* dst, const uint8_t* src,
+                               int blocksX, size_t rowBytes) {
+    uint8_t block[16];
+    for (int x = 0; x < blocksX; ++x) {
+        memcpy(block, src + (kBlockSize * x), 4);
+        memcpy(block + 4, src + rowBytes + (kBlockSize * x), 4);
+        memcpy(block + 8, src + 2*rowBytes + (kBlockSize * x), 4);
+        memcpy(block + 12, src + 3*rowBytes + (kBlockSize * x), 4);
+
+        dst[x] = proc(block);
+    }
 }
 
+// Below this many blocks, compressing on the calling thread beats starting a
+// pool. Each task gets about as many too.
+static const int kMinThreadedBlocks = 64 * 64;
+
+class CompressBlockRows : public SkParallelForBody {
+public:
+    CompressBlockRows(CompressBlockProc proc, uint64_t* dst, const uint8_t* src,
+                      int blocksX, size_t rowBytes)
+        : fProc(proc), fDst(dst), fSrc(src), fBlocksX(blocksX), fRowBytes(rowBytes) {}
+
+    virtual void run(int y) SK_OVERRIDE {
+        compress_block_row(fProc, fDst + y * fBlocksX, fSrc + kBlockSize * y * fRowBytes,
+                           fBlocksX, fRowBytes);
+    }
+
+private:
+    CompressBlockProc fProc;
+    uint64_t*         fDst;
+    const uint8_t*    fSrc;
+    int               fBlocksX;
+    size_t            fRowBytes;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace SkTextureCompressor {
 
-typedef SkData *(*CompressBitmapProc)(const SkBitmap &bitmap);
+size_t GetCompressedDataSize(Format format, int width, int height) {
+    if (NULL == get_a8_block_proc(format) ||
+        width <= 0 || height <= 0 ||
+        (width % kBlockSize) != 0 || (height % kBlockSize) != 0) {
+        return 0;
+    }
+    return (width / kBlockSize) * (height / kBlockSize) * kEncodedBlockSize;
+}
 
-SkData *CompressBitmapToFormat(const SkBitmap &bitmap, Format format) {
-    SkAutoLockPixels alp(bitmap);
+bool CompressA8Rows(Format format, void* dst, const uint8_t* src,
+                    int width, int height, size_t rowBytes) {
+    if (0 == GetCompressedDataSize(format, width, height)) {
+        return false;
+    }
+    CompressBlockProc proc = get_a8_block_proc(format);
+    const int blocksX = width / kBlockSize;
+    const int blocksY = height / kBlockSize;
+    uint64_t* encPtr = static_cast<uint64_t*>(dst);
+
+    const int threadCount = SkGraphics::GetTextureCompressionThreadCount();
+    if ((threadCount >= 0 && threadCount <= 1) || blocksX * blocksY < 2 * kMinThreadedBlocks) {
+        for (int y = 0; y < blocksY; ++y) {
+            compress_block_row(proc, encPtr, src, blocksX, rowBytes);
+            encPtr += blocksX;
+            src += kBlockSize * rowBytes;
+        }
+        return true;
+    }
 
-    CompressBitmapProc kProcMap[kLastEnum_SkColorType + 1][kFormatCnt];
-    memset(kProcMap, 0, sizeof(kProcMap));
+    CompressBlockRows rows(proc, encPtr, src, blocksX, rowBytes);
+    SkThreadPool pool(threadCount);
+    SkTaskGroup group(&pool);
+    group.parallelFor(0, blocksY, &rows, SkTMax(1, kMinThreadedBlocks / blocksX));
+    group.wait();
+    return true;
+}
 
-    // Map available bitmap configs to compression functions
-    kProcMap[kAlpha_8_SkColorType][kLATC_Format] = compress_a8_to_latc;
+SkData *CompressBitmapToFormat(const SkBitmap &bitmap, Format format) {
+    SkAutoLockPixels alp(bitmap);
 
-    CompressBitmapProc proc = kProcMap[bitmap.colorType()][format];
-    if (NULL != proc) {
-        return proc(bitmap);
+    if (kAlpha_8_SkColorType != bitmap.colorType() || NULL == bitmap.getPixels()) {
+        return NULL;
+    }
+    const size_t compressedDataSize = GetCompressedDataSize(format, bitmap.width(),
+                                                            bitmap.height());
+    if (0 == compressedDataSize) {
+        return NULL;
     }
 
-    return NULL;
+    void* dst = sk_malloc_throw(compressedDataSize);
+    SkAssertResult(CompressA8Rows(format, dst, static_cast<const uint8_t*>(bitmap.getPixels()),
+                                  bitmap.width(), bitmap.height(), bitmap.rowBytes()));
+    return SkData::NewFromMalloc(dst, compressedDataSize);
 }
 
 }  // namespace SkTextureCompressor
@@ -8,16 +8,19 @@
 #ifndef SkTextureCompressor_DEFINED
 #define SkTextureCompressor_DEFINED
 
+#include "SkTypes.h"
+
 class SkBitmap;
 class SkData;
 
 namespace SkTextureCompressor {
     // Various texture compression formats that we support.
     enum Format {
-        // Alpha only format.
+        // Alpha only formats. LATC is the same bitstream as RGTC1/BC4.
         kLATC_Format,
+        kR11_EAC_Format,
 
-        kLast_Format = kLATC_Format
+        kLast_Format = kR11_EAC_Format
     };
     static const int kFormatCnt = kLast_Format + 1;
 
@@ -26,6 +29,23 @@ namespace SkTextureCompressor {
     // associated format, then we return NULL. The caller is responsible for
     // calling unref() on the returned data.
     SkData* CompressBitmapToFormat(const SkBitmap& bitmap, Format format);
+
+    // Returns the number of bytes that a width x height A8 image takes when
+    // compressed to format, or 0 if it can't be: each format compresses 4x4
+    // blocks, so both dimensions must be multiples of 4.
+    size_t GetCompressedDataSize(Format format, int width, int height);
+
+    // Compresses the height rows of width A8 pixels at src, rowBytes apart,
+    // into dst, which must hold GetCompressedDataSize(format, width, height)
+    // bytes. Returns false, writing nothing, if that size is 0.
+    //
+    // Since the blocks are laid out a row of blocks at a time, a caller that
+    // produces a mask in bands whose heights are multiples of 4 can compress
+    // each band, into the matching stretch of dst, as soon as it is done.
+    // Large images are split into rows of blocks compressed on up to
+    // SkGraphics::GetTextureCompressionThreadCount() threads.
+    bool CompressA8Rows(Format format, void* dst, const uint8_t* src,
+                        int width, int height, size_t rowBytes);
 }
 
 #endif
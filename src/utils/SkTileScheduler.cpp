@@ -0,0 +1,332 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTileScheduler.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkTime.h"
+#include "SkTSort.h"
+
+// A first guess at how long a tile takes, until some have been timed.
+static const double kInitialTileMs = 4;
+// Stands for a tile that the viewport isn't heading towards.
+static const double kNever = 1e9;
+
+// Narrows [*enter, *leave] to the times at which the span [viewMin, viewMax), moving at
+// velocity, overlaps [tileMin, tileMax). Returns false if it never does.
+static bool overlap_times(int tileMin, int tileMax, int viewMin, int viewMax, SkScalar velocity,
+                          double* enter, double* leave) {
+    if (0 == velocity) {
+        return viewMin < tileMax && viewMax > tileMin;
+    }
+    double t0 = (tileMin - viewMax) / (double)velocity;
+    double t1 = (tileMax - viewMin) / (double)velocity;
+    if (t0 > t1) {
+        SkTSwap(t0, t1);
+    }
+    *enter = SkTMax(*enter, t0);
+    *leave = SkTMin(*leave, t1);
+    return true;
+}
+
+// How long until the viewport, moving at velocity, first shows part of the tile.
+static double seconds_to_visible(const SkIRect& tile, const SkIRect& viewport,
+                                 const SkVector& velocity) {
+    double enter = 0, leave = kNever;
+    if (!overlap_times(tile.fLeft, tile.fRight, viewport.fLeft, viewport.fRight, velocity.fX,
+                       &enter, &leave) ||
+        !overlap_times(tile.fTop, tile.fBottom, viewport.fTop, viewport.fBottom, velocity.fY,
+                       &enter, &leave) ||
+        enter >= leave) {
+        return kNever;
+    }
+    return enter;
+}
+
+namespace {
+
+struct Candidate {
+    int    fTile;
+    double fSeconds;    // Until the tile is visible.
+    int64_t fDistance;  // Squared, from the tile's center to the viewport's.
+};
+
+// Sooner first, and nearer first among tiles that are equally soon.
+struct SoonerCandidate {
+    bool operator()(const Candidate& a, const Candidate& b) const {
+        return a.fSeconds < b.fSeconds || (a.fSeconds == b.fSeconds && a.fDistance < b.fDistance);
+    }
+};
+
+}  // namespace
+
+// Draws queued tiles until the queue is empty. Deletes itself.
+class SkTileScheduler::Worker : public SkRunnable {
+public:
+    explicit Worker(SkTileScheduler* scheduler) : fScheduler(scheduler) {}
+
+    virtual void run() SK_OVERRIDE {
+        fScheduler->drainQueue();
+        SkDELETE(this);
+    }
+
+private:
+    SkTileScheduler* fScheduler;  // Unowned.
+};
+
+SkTileScheduler::SkTileScheduler(SkThreadPool* pool, Client* client, const SkISize& tileSize)
+    : fTasks(pool)
+    , fClient(client)
+    , fTileSize(tileSize)
+    , fMaxWorkers(SkTMax(1, pool->threadCount()))
+    , fClones(NULL)
+    , fColumns(0)
+    , fRows(0)
+    , fWorkers(0)
+    , fTileMs(kInitialTileMs)
+    , fViewport(SkIRect::MakeEmpty())
+    , fVelocity(SkVector::Make(0, 0))
+    , fLowResScale(SK_Scalar1 / 4)
+    , fPrefetchSeconds(SK_ScalarHalf) {
+    SkASSERT(NULL != fClient);
+    SkASSERT(!fTileSize.isEmpty());
+}
+
+SkTileScheduler::~SkTileScheduler() {
+    this->setPicture(NULL);
+}
+
+void SkTileScheduler::setPicture(SkPicture* picture) {
+    {
+        SkAutoMutexAcquire lock(fMutex);
+        fQueue.reset();
+    }
+    // With nothing queued the workers stop after their current tile, and leave the clones alone.
+    fTasks.wait();
+
+    int count;
+    {
+        SkAutoMutexAcquire lock(fMutex);
+        SkASSERT(0 == fWorkers);
+        SkDELETE_ARRAY(fClones);
+        fClones = NULL;
+        fPicture.reset(SkSafeRef(picture));
+        fColumns = fRows = 0;
+        if (NULL != picture) {
+            fClones = SkNEW_ARRAY(SkPicture, fMaxWorkers);
+            picture->clone(fClones, fMaxWorkers);
+            fCloneInUse.setCount(fMaxWorkers);
+            sk_bzero(fCloneInUse.begin(), fCloneInUse.bytes());
+            fColumns = (picture->width() + fTileSize.width() - 1) / fTileSize.width();
+            fRows = (picture->height() + fTileSize.height() - 1) / fTileSize.height();
+        }
+        fTiles.setCount(fColumns * fRows);
+        for (int i = 0; i < fTiles.count(); ++i) {
+            fTiles[i].fGeneration = 0;
+            fTiles[i].fContent = kNone_Content;
+        }
+        count = this->schedule();
+    }
+    this->startWorkers(count);
+}
+
+void SkTileScheduler::setViewport(const SkIRect& viewport, const SkVector& velocity) {
+    int count;
+    {
+        SkAutoMutexAcquire lock(fMutex);
+        fViewport = viewport;
+        fVelocity = velocity;
+        count = this->schedule();
+    }
+    this->startWorkers(count);
+}
+
+void SkTileScheduler::invalidate(const SkIRect& area) {
+    int count;
+    {
+        SkAutoMutexAcquire lock(fMutex);
+        for (int i = 0; i < fTiles.count(); ++i) {
+            if (SkIRect::Intersects(this->tileRect(i), area)) {
+                fTiles[i].fGeneration++;
+                fTiles[i].fContent = kNone_Content;
+            }
+        }
+        count = this->schedule();
+    }
+    this->startWorkers(count);
+}
+
+void SkTileScheduler::setLowResScale(SkScalar scale) {
+    SkAutoMutexAcquire lock(fMutex);
+    fLowResScale = SkTMin(scale, SK_Scalar1);
+}
+
+void SkTileScheduler::setPrefetchSeconds(SkScalar seconds) {
+    SkAutoMutexAcquire lock(fMutex);
+    fPrefetchSeconds = SkTMax(seconds, 0.0f);
+}
+
+void SkTileScheduler::wait() {
+    fTasks.wait();
+}
+
+SkIRect SkTileScheduler::tileRect(int index) const {
+    SkIRect tile = SkIRect::MakeXYWH((index % fColumns) * fTileSize.width(),
+                                     (index / fColumns) * fTileSize.height(),
+                                     fTileSize.width(), fTileSize.height());
+    SkAssertResult(tile.intersect(SkIRect::MakeWH(fPicture->width(), fPicture->height())));
+    return tile;
+}
+
+// Rebuilds the queue for the current viewport. Returns how many more workers it needs.
+int SkTileScheduler::schedule() {
+    fQueue.reset();
+    if (NULL == fPicture.get() || fViewport.isEmpty()) {
+        return 0;
+    }
+
+    // Tiles are worth drawing if they are visible, will be within fPrefetchSeconds, or are
+    // next to the viewport.
+    SkIRect area = fViewport;
+    SkIRect ahead = fViewport;
+    ahead.offset(SkScalarRoundToInt(fVelocity.fX * fPrefetchSeconds),
+                 SkScalarRoundToInt(fVelocity.fY * fPrefetchSeconds));
+    area.join(ahead);
+    area.outset(fTileSize.width(), fTileSize.height());
+    if (!area.intersect(SkIRect::MakeWH(fPicture->width(), fPicture->height()))) {
+        return 0;
+    }
+
+    SkTDArray<Candidate> candidates;
+    const int firstColumn = area.fLeft / fTileSize.width();
+    const int lastColumn = (area.fRight - 1) / fTileSize.width();
+    const int firstRow = area.fTop / fTileSize.height();
+    const int lastRow = (area.fBottom - 1) / fTileSize.height();
+    for (int y = firstRow; y <= lastRow; ++y) {
+        for (int x = firstColumn; x <= lastColumn; ++x) {
+            const int index = y * fColumns + x;
+            if (kFull_Content == fTiles[index].fContent) {
+                continue;
+            }
+            const SkIRect tile = this->tileRect(index);
+            const int64_t dx = tile.centerX() - fViewport.centerX();
+            const int64_t dy = tile.centerY() - fViewport.centerY();
+            Candidate* candidate = candidates.append();
+            candidate->fTile = index;
+            candidate->fSeconds = seconds_to_visible(tile, fViewport, fVelocity);
+            candidate->fDistance = dx * dx + dy * dy;
+        }
+    }
+    if (candidates.isEmpty()) {
+        return 0;
+    }
+    SkTQSort(candidates.begin(), candidates.end() - 1, SoonerCandidate());
+
+    // A tile whose turn comes after it becomes visible gets a placeholder first. The
+    // placeholders are cheap, so they all go ahead of the finished tiles.
+    SkTDArray<Work> lowRes, full;
+    double readyMs = 0;
+    for (int i = 0; i < candidates.count(); ++i) {
+        const Candidate& candidate = candidates[i];
+        const Tile& tile = fTiles[candidate.fTile];
+        readyMs += fTileMs / fMaxWorkers;
+        if (fLowResScale > 0 && kNone_Content == tile.fContent &&
+            candidate.fSeconds * 1000 < readyMs) {
+            Work* work = lowRes.append();
+            work->fTile = candidate.fTile;
+            work->fGeneration = tile.fGeneration;
+            work->fLowRes = true;
+        }
+        Work* work = full.append();
+        work->fTile = candidate.fTile;
+        work->fGeneration = tile.fGeneration;
+        work->fLowRes = false;
+    }
+
+    for (int i = full.count() - 1; i >= 0; --i) {
+        *fQueue.append() = full[i];
+    }
+    for (int i = lowRes.count() - 1; i >= 0; --i) {
+        *fQueue.append() = lowRes[i];
+    }
+
+    const int needed = SkTMin(fMaxWorkers, fQueue.count()) - fWorkers;
+    if (needed <= 0) {
+        return 0;
+    }
+    fWorkers += needed;
+    return needed;
+}
+
+void SkTileScheduler::startWorkers(int count) {
+    // Not under fMutex: a pool without threads runs the worker right here.
+    for (int i = 0; i < count; ++i) {
+        fTasks.add(SkNEW_ARGS(Worker, (this)));
+    }
+}
+
+void SkTileScheduler::drainQueue() {
+    for (;;) {
+        Work work;
+        SkIRect tile;
+        SkScalar scale;
+        int clone = 0;
+        {
+            SkAutoMutexAcquire lock(fMutex);
+            bool found = false;
+            while (!found && !fQueue.isEmpty()) {
+                fQueue.pop(&work);
+                const Tile& state = fTiles[work.fTile];
+                const Content wanted = work.fLowRes ? kLowRes_Content : kFull_Content;
+                found = work.fGeneration == state.fGeneration && state.fContent < wanted;
+            }
+            if (!found) {
+                fWorkers--;
+                return;
+            }
+            while (fCloneInUse[clone]) {
+                ++clone;
+            }
+            fCloneInUse[clone] = true;
+            tile = this->tileRect(work.fTile);
+            scale = work.fLowRes ? fLowResScale : SK_Scalar1;
+        }
+
+        const SkMSec start = SkTime::GetMSecs();
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(SkScalarCeilToInt(tile.width() * scale),
+                              SkScalarCeilToInt(tile.height() * scale));
+        bitmap.eraseColor(SK_ColorTRANSPARENT);
+        {
+            SkCanvas canvas(bitmap);
+            canvas.scale(scale, scale);
+            canvas.clipRect(SkRect::MakeWH(SkIntToScalar(tile.width()),
+                                           SkIntToScalar(tile.height())));
+            canvas.translate(-SkIntToScalar(tile.fLeft), -SkIntToScalar(tile.fTop));
+            fClones[clone].draw(&canvas);
+        }
+        const SkMSec elapsed = SkTime::GetMSecs() - start;
+
+        bool current;
+        {
+            SkAutoMutexAcquire lock(fMutex);
+            fCloneInUse[clone] = false;
+            Tile& state = fTiles[work.fTile];
+            current = work.fGeneration == state.fGeneration;
+            if (current) {
+                state.fContent = SkTMax(state.fContent,
+                                        work.fLowRes ? kLowRes_Content : kFull_Content);
+            }
+            if (!work.fLowRes) {
+                fTileMs = 0.75 * fTileMs + 0.25 * elapsed;
+            }
+        }
+        if (current) {
+            fClient->tileReady(tile, scale, bitmap);
+        }
+    }
+}
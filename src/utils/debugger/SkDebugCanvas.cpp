@@ -544,6 +544,12 @@ void SkDebugCanvas::drawRect(const SkRect& rect, const SkPaint& paint) {
     addDrawCommand(new SkDrawRectCommand(rect, paint));
 }
 
+void SkDebugCanvas::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    for (int i = 0; i < count; ++i) {
+        this->drawRect(rects[i], paint);
+    }
+}
+
 void SkDebugCanvas::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
     this->addDrawCommand(new SkDrawRRectCommand(rrect, paint));
 }
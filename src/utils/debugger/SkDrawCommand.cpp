@@ -69,6 +69,7 @@ const char* SkDrawCommand::GetCommandString(DrawType type) {
         case DRAW_DRRECT: return "Draw DRRect";
         case PUSH_CULL: return "PushCull";
         case POP_CULL: return "PopCull";
+        case DRAW_TEXT_BLOB: return "Draw Text Blob";
         default:
             SkDebugf("DrawType error 0x%08x\n", type);
             SkASSERT(0);
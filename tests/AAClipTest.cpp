@@ -382,6 +382,53 @@ static void test_nearly_integral(skiatest::Reporter* reporter) {
     did_dx_affect(reporter, gUnsafeX, SK_ARRAY_COUNT(gUnsafeX), true);
 }
 
+static bool same_coverage(const SkAAClip& a, const SkAAClip& b) {
+    if (a.isEmpty() || b.isEmpty()) {
+        return a.isEmpty() == b.isEmpty();
+    }
+    SkMask ma, mb;
+    a.copyToMask(&ma);
+    b.copyToMask(&mb);
+    SkAutoMaskFreeImage aCleanUp(ma.fImage);
+    SkAutoMaskFreeImage bCleanUp(mb.fImage);
+    return ma == mb;
+}
+
+// Intersecting with integer rects crops an aaclip directly, and is deferred by
+// SkRasterClip; both should give the same clip as merging with a rect aaclip.
+static void test_rect_intersects(skiatest::Reporter* reporter) {
+    SkPath path;
+    path.addCircle(50, 50, 45);
+    path.addRect(SkRect::MakeLTRB(30, 30, 70, 70), SkPath::kCCW_Direction);
+
+    SkRandom rand;
+    for (int i = 0; i < 50; ++i) {
+        SkRasterClip rc;
+        rc.setPath(path, SkIRect::MakeWH(100, 100), i & 1);
+        SkRasterClip expected(rc);
+        SkAAClip expectedAA;
+        expectedAA.setPath(path, NULL, i & 1);
+
+        for (int j = 0; j < 3; ++j) {
+            SkIRect r;
+            rand_irect(&r, 100, rand);
+            rc.op(r, SkRegion::kIntersect_Op);
+
+            SkRegion rgn(r);
+            expected.op(rgn, SkRegion::kIntersect_Op);
+
+            SkAAClip rectClip;
+            rectClip.setRect(r);
+            SkAAClip cropped(expectedAA);
+            expectedAA.op(rectClip, SkRegion::kIntersect_Op);
+            cropped.op(r, SkRegion::kIntersect_Op);
+            REPORTER_ASSERT(reporter, same_coverage(cropped, expectedAA));
+        }
+        REPORTER_ASSERT(reporter, rc == expected);
+        REPORTER_ASSERT(reporter, rc.getBounds() == expected.getBounds());
+    }
+}
+
 static void test_regressions() {
     // these should not assert in the debug build
     // bug was introduced in rev. 3209
@@ -404,4 +451,5 @@ DEF_TEST(AAClip, reporter) {
     test_path_with_hole(reporter);
     test_regressions();
     test_nearly_integral(reporter);
+    test_rect_intersects(reporter);
 }
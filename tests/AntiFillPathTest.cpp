@@ -0,0 +1,111 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkPath.h"
+#include "Test.h"
+
+static const int W = 8;
+static const int H = 8;
+
+static void fill_path(const SkPath& path, SkBitmap* bm) {
+    bm->allocPixels(SkImageInfo::MakeA8(W, H));
+    bm->eraseColor(SK_ColorTRANSPARENT);
+
+    SkCanvas canvas(*bm);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    canvas.drawPath(path, paint);
+}
+
+static void check_alpha(skiatest::Reporter* reporter, const SkBitmap& bm, int x, int y,
+                        U8CPU expected) {
+    U8CPU actual = *bm.getAddr8(x, y);
+    if (actual != expected) {
+        ERRORF(reporter, "pixel (%d, %d): expected alpha %d, got %d", x, y, expected, actual);
+    }
+}
+
+// Coverage should be the area of each pixel inside the path, not a multiple of
+// a supersampled step.
+DEF_TEST(AntiFillPath_ExactCoverage, reporter) {
+    SkBitmap bm;
+
+    // Triangle below the diagonal x + y = 4: the pixels it cuts are half covered.
+    SkPath triangle;
+    triangle.moveTo(0, 0);
+    triangle.lineTo(4, 0);
+    triangle.lineTo(0, 4);
+    triangle.close();
+    fill_path(triangle, &bm);
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            U8CPU expected = x + y < 3 ? 0xFF : (x + y == 3 ? 0x80 : 0);
+            check_alpha(reporter, bm, x, y, expected);
+        }
+    }
+
+    // Thin sliver, a quarter of a pixel wide and tilted so it is not a rect.
+    SkPath sliver;
+    sliver.moveTo(2, SkFloatToScalar(1.5f));
+    sliver.lineTo(SkFloatToScalar(2.25f), SkFloatToScalar(1.5f));
+    sliver.lineTo(SkFloatToScalar(2.25f), SkFloatToScalar(5.0f));
+    sliver.lineTo(2, SkFloatToScalar(6.0f));
+    sliver.close();
+    fill_path(sliver, &bm);
+    check_alpha(reporter, bm, 2, 1, 0x20);
+    check_alpha(reporter, bm, 2, 3, 0x40);
+    check_alpha(reporter, bm, 2, 5, 0x20);
+    check_alpha(reporter, bm, 1, 3, 0);
+    check_alpha(reporter, bm, 3, 3, 0);
+}
+
+DEF_TEST(AntiFillPath_FillTypes, reporter) {
+    SkBitmap bm;
+
+    // Two squares overlapping in [2,4]x[2,4], drawn as one path.
+    SkPath squares;
+    squares.moveTo(0, 0);
+    squares.lineTo(4, 0);
+    squares.lineTo(4, 4);
+    squares.lineTo(0, 4);
+    squares.close();
+    squares.moveTo(2, 2);
+    squares.lineTo(6, 2);
+    squares.lineTo(6, 6);
+    squares.lineTo(2, 6);
+    squares.close();
+
+    squares.setFillType(SkPath::kWinding_FillType);
+    fill_path(squares, &bm);
+    check_alpha(reporter, bm, 1, 1, 0xFF);
+    check_alpha(reporter, bm, 3, 3, 0xFF);
+    check_alpha(reporter, bm, 5, 5, 0xFF);
+    check_alpha(reporter, bm, 6, 1, 0);
+
+    squares.setFillType(SkPath::kEvenOdd_FillType);
+    fill_path(squares, &bm);
+    check_alpha(reporter, bm, 1, 1, 0xFF);
+    check_alpha(reporter, bm, 3, 3, 0);
+    check_alpha(reporter, bm, 5, 5, 0xFF);
+
+    // The inverse of the triangle from AntiFillPath_ExactCoverage.
+    SkPath triangle;
+    triangle.moveTo(0, 0);
+    triangle.lineTo(4, 0);
+    triangle.lineTo(0, 4);
+    triangle.close();
+    triangle.setFillType(SkPath::kInverseWinding_FillType);
+    fill_path(triangle, &bm);
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            U8CPU expected = x + y < 3 ? 0 : (x + y == 3 ? 0x80 : 0xFF);
+            check_alpha(reporter, bm, x, y, expected);
+        }
+    }
+}
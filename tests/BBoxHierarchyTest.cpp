@@ -6,6 +6,8 @@
  */
 
 #include "Test.h"
+#include "SkBBHFactory.h"
+#include "SkPictureStateTree.h"
 #include "SkRandom.h"
 #include "SkQuadTree.h"
 #include "SkRTree.h"
@@ -116,12 +118,55 @@ static void tree_test_main(SkBBoxHierarchy* tree, int minChildren, int maxChildr
         for (int i = 0; i < NUM_RECTS; ++i) {
             tree->insert(rects[i].data, rects[i].rect, true);
         }
+        // Updating an insert that is still deferred just changes its bounds.
+        SkIRect moved = random_rect(rand);
+        REPORTER_ASSERT(reporter, tree->update(rects[0].data, rects[0].rect, moved));
+        rects[0].rect = moved;
         tree->flushDeferredInserts();
         run_queries(reporter, rand, rects, *tree);
         REPORTER_ASSERT(reporter, NUM_RECTS == tree->getCount());
         REPORTER_ASSERT(reporter,
             ((expectedDepthMin <= 0) || (expectedDepthMin <= tree->getDepth())) &&
             ((expectedDepthMax <= 0) || (expectedDepthMax >= tree->getDepth())));
+
+        // Update a third of them in place.
+        for (int i = 0; i < NUM_RECTS; i += 3) {
+            REPORTER_ASSERT(reporter, tree->remove(rects[i].data, rects[i].rect));
+            rects[i].rect = random_rect(rand);
+            tree->insert(rects[i].data, rects[i].rect);
+        }
+        run_queries(reporter, rand, rects, *tree);
+        REPORTER_ASSERT(reporter, NUM_RECTS == tree->getCount());
+
+        // Move another third with update(), alternately shrinking them where they are, which
+        // hierarchies may do in place, and moving them anywhere.
+        for (int i = 1; i < NUM_RECTS; i += 3) {
+            const SkIRect& oldRect = rects[i].rect;
+            SkIRect newRect = (i & 1) ? SkIRect::MakeXYWH(oldRect.fLeft, oldRect.fTop,
+                                                          SkMax32(1, oldRect.width() / 2),
+                                                          SkMax32(1, oldRect.height() / 2))
+                                      : random_rect(rand);
+            REPORTER_ASSERT(reporter, tree->update(rects[i].data, oldRect, newRect));
+            rects[i].rect = newRect;
+        }
+        run_queries(reporter, rand, rects, *tree);
+        REPORTER_ASSERT(reporter, NUM_RECTS == tree->getCount());
+
+        // Removing or updating something that isn't there does nothing.
+        SkIRect elsewhere = rects[1].rect;
+        elsewhere.offset(1, 0);
+        REPORTER_ASSERT(reporter, !tree->remove(rects[1].data, elsewhere));
+        REPORTER_ASSERT(reporter, !tree->update(rects[1].data, elsewhere, rects[2].rect));
+        REPORTER_ASSERT(reporter, NUM_RECTS == tree->getCount());
+        run_queries(reporter, rand, rects, *tree);
+
+        // Then remove all of them, one by one.
+        for (int i = 0; i < NUM_RECTS; ++i) {
+            REPORTER_ASSERT(reporter, tree->remove(rects[i].data, rects[i].rect));
+        }
+        REPORTER_ASSERT(reporter, 0 == tree->getCount());
+        // Nothing is left of the structure but, at most, an empty root.
+        REPORTER_ASSERT(reporter, tree->getDepth() <= 1);
         tree->clear();
         REPORTER_ASSERT(reporter, 0 == tree->getCount());
 
@@ -155,6 +200,48 @@ static void tree_test_main(SkBBoxHierarchy* tree, int minChildren, int maxChildr
     }
 }
 
+// Builds an adaptive hierarchy from ops up to maxOpSize wide and tall, checks which hierarchy
+// it chose, and that searching each query tile finds every op that touches it.
+static void test_adaptive(skiatest::Reporter* reporter, int maxOpSize, bool expectGrid) {
+    static const int kTileSize = 100;
+    SkRandom rand;
+    SkPictureStateTree::Draw draws[NUM_RECTS];
+    DataRect rects[NUM_RECTS];
+    for (int i = 0; i < NUM_RECTS; ++i) {
+        draws[i].fMatrix = NULL;
+        draws[i].fNode = NULL;
+        draws[i].fOffset = i;
+        rects[i].rect = SkIRect::MakeXYWH(rand.nextULessThan(MAX_SIZE),
+                                          rand.nextULessThan(MAX_SIZE),
+                                          rand.nextRangeU(1, maxOpSize),
+                                          rand.nextRangeU(1, maxOpSize));
+        rects[i].data = &draws[i];
+    }
+
+    SkAdaptiveBBHFactory factory(SkISize::Make(kTileSize, kTileSize));
+    SkAutoTUnref<SkBBoxHierarchy> bbh(factory(MAX_SIZE, MAX_SIZE));
+    for (int i = 0; i < NUM_RECTS; ++i) {
+        bbh->insert(rects[i].data, rects[i].rect, true);
+    }
+    REPORTER_ASSERT(reporter, 0 == bbh->getDepth());
+    bbh->flushDeferredInserts();
+    REPORTER_ASSERT(reporter, expectGrid == (-1 == bbh->getDepth()));
+    REPORTER_ASSERT(reporter, NUM_RECTS == bbh->getCount());
+
+    for (int y = 0; y < MAX_SIZE; y += kTileSize) {
+        for (int x = 0; x < MAX_SIZE; x += kTileSize) {
+            const SkIRect query = SkIRect::MakeXYWH(x, y, kTileSize, kTileSize);
+            SkTDArray<void*> found;
+            bbh->search(query, &found);
+            for (int i = 0; i < NUM_RECTS; ++i) {
+                if (SkIRect::Intersects(query, rects[i].rect)) {
+                    REPORTER_ASSERT(reporter, found.find(rects[i].data) >= 0);
+                }
+            }
+        }
+    }
+}
+
 DEF_TEST(BBoxHierarchy, reporter) {
     // RTree
     {
@@ -181,4 +268,10 @@ DEF_TEST(BBoxHierarchy, reporter) {
         SkAutoUnref auo(unsortedQuadTree);
         tree_test_main(unsortedQuadTree, QUADTREE_MIN_CHILDREN, QUADTREE_MAX_CHILDREN, reporter);
     }
+
+    // Adaptive
+    {
+        test_adaptive(reporter, 20, true);
+        test_adaptive(reporter, MAX_SIZE / 2, false);
+    }
 }
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Test.h"
+
+#include "SkBackendCostModel.h"
+#include "SkCanvas.h"
+#include "SkPath.h"
+#include "SkPicture.h"
+#include "SkPictureRecorder.h"
+
+static const int kTile = 256;
+
+// Big plain rects, which the GPU fills much faster, in the left tile, and small anti-aliased
+// concave paths, which it has to mask in software, in the right tile.
+static SkPicture* record_picture(int rects, int paths) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(2 * kTile, kTile, NULL, 0);
+
+    SkPaint paint;
+    for (int i = 0; i < rects; ++i) {
+        paint.setColor(0xFF000000 | (i * 0x10101));
+        canvas->drawRect(SkRect::MakeWH(SkIntToScalar(kTile), SkIntToScalar(kTile)), paint);
+    }
+
+    SkPath star;
+    star.moveTo(5, 0);
+    star.lineTo(8, 10);
+    star.lineTo(0, 4);
+    star.lineTo(10, 4);
+    star.lineTo(2, 10);
+    star.close();
+    paint.setAntiAlias(true);
+    for (int i = 0; i < paths; ++i) {
+        canvas->save();
+        canvas->translate(SkIntToScalar(kTile + (i * 13) % (kTile - 10)),
+                          SkIntToScalar((i * 7) % (kTile - 10)));
+        canvas->drawPath(star, paint);
+        canvas->restore();
+    }
+    return recorder.endRecording();
+}
+
+static double relative_error(double predicted, double actual) {
+    return fabs(predicted - actual) / actual;
+}
+
+DEF_TEST(BackendCostModel, r) {
+    SkAutoTUnref<SkPicture> picture(record_picture(20, 200));
+    SkBackendCostModel model(picture, SkISize::Make(kTile, kTile));
+    REPORTER_ASSERT(r, 2 == model.tilesWide());
+    REPORTER_ASSERT(r, 1 == model.tilesHigh());
+    REPORTER_ASSERT(r, SkBackendCostModel::kGpu_Backend == model.suggestBackend(0, 0));
+    REPORTER_ASSERT(r, SkBackendCostModel::kRaster_Backend == model.suggestBackend(1, 0));
+
+    // The tiles split the picture's cost between them, but both pay the fixed cost of ops that
+    // straddle them.
+    for (int b = SkBackendCostModel::kRaster_Backend; b <= SkBackendCostModel::kGpu_Backend; ++b) {
+        const SkBackendCostModel::Backend backend = (SkBackendCostModel::Backend)b;
+        const double tiles = model.predictUs(backend, 0, 0) + model.predictUs(backend, 1, 0);
+        REPORTER_ASSERT(r, tiles >= model.predictUs(backend));
+        REPORTER_ASSERT(r, relative_error(tiles, model.predictUs(backend)) < 0.05);
+    }
+
+    // Smaller tiles don't see the rects on the right, or the paths on the left.
+    SkBackendCostModel quarters(picture, SkISize::Make(kTile / 2, kTile / 2));
+    REPORTER_ASSERT(r, 4 == quarters.tilesWide());
+    REPORTER_ASSERT(r, 2 == quarters.tilesHigh());
+    REPORTER_ASSERT(r, SkBackendCostModel::kGpu_Backend == quarters.suggestBackend(1, 1));
+    REPORTER_ASSERT(r, SkBackendCostModel::kRaster_Backend == quarters.suggestBackend(2, 0));
+}
+
+DEF_TEST(BackendCostModel_Calibrate, r) {
+    SkBackendCostModel::Calibration calibration;
+    SkBackendCostModel::DefaultCalibration(&calibration);
+    REPORTER_ASSERT(r, !SkBackendCostModel::Calibrate(NULL, NULL, NULL, 0, &calibration));
+
+    // A device whose CPU draws everything twice as slowly as the defaults assume, and whose GPU
+    // matches them.
+    SkBackendCostModel::Calibration device = calibration;
+    for (int i = 0; i < SkBackendCostModel::kOpClassCount; ++i) {
+        device.fRaster[i].fFixedUs *= 2;
+        device.fRaster[i].fPerMPixelUs *= 2;
+    }
+
+    static const int kSamples = 6;
+    SkPicture* pictures[kSamples];
+    double rasterUs[kSamples], gpuUs[kSamples];
+    for (int i = 0; i < kSamples; ++i) {
+        pictures[i] = record_picture(5 + 7 * i, 300 - 40 * i);
+        const SkBackendCostModel measured(pictures[i], SkISize::Make(kTile, kTile), &device);
+        rasterUs[i] = measured.predictUs(SkBackendCostModel::kRaster_Backend);
+        gpuUs[i] = measured.predictUs(SkBackendCostModel::kGpu_Backend);
+    }
+
+    const double negative[kSamples] = { -1, 0, 0, 0, 0, 0 };
+    REPORTER_ASSERT(r, !SkBackendCostModel::Calibrate(pictures, negative, gpuUs, kSamples,
+                                                      &calibration));
+
+    SkBackendCostModel::Calibration fitted = calibration;
+    REPORTER_ASSERT(r, SkBackendCostModel::Calibrate(pictures, rasterUs, gpuUs, kSamples,
+                                                     &fitted));
+    for (int i = 0; i < kSamples; ++i) {
+        const SkBackendCostModel before(pictures[i], SkISize::Make(kTile, kTile), &calibration);
+        const SkBackendCostModel after(pictures[i], SkISize::Make(kTile, kTile), &fitted);
+        // The defaults are half the measured raster times, and the fit gets much closer.
+        REPORTER_ASSERT(r, relative_error(before.predictUs(SkBackendCostModel::kRaster_Backend),
+                                          rasterUs[i]) > 0.4);
+        REPORTER_ASSERT(r, relative_error(after.predictUs(SkBackendCostModel::kRaster_Backend),
+                                          rasterUs[i]) < 0.1);
+        // The GPU times already match, so the fit leaves them be.
+        REPORTER_ASSERT(r, relative_error(after.predictUs(SkBackendCostModel::kGpu_Backend),
+                                          gpuUs[i]) < 1e-3);
+    }
+
+    for (int i = 0; i < kSamples; ++i) {
+        pictures[i]->unref();
+    }
+}
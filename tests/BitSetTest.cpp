@@ -73,4 +73,24 @@ DEF_TEST(BitSet, reporter) {
     set3 = set2;
     set2 = set2;
     REPORTER_ASSERT(reporter, set2 == set3);
+
+    // Range limited or and export only look at the words of the range.
+    SkBitSet set6(SK_MaxU16 + 1);
+    SkBitSet set7(SK_MaxU16 + 1);
+    set6.setBit(40, true);
+    set6.setBit(70, true);
+    set6.setBit(1000, true);
+    set7.orBits(set6, 33, 95);
+    REPORTER_ASSERT(reporter, set7.isBitSet(40) == true);
+    REPORTER_ASSERT(reporter, set7.isBitSet(70) == true);
+    REPORTER_ASSERT(reporter, set7.isBitSet(1000) == false);
+    REPORTER_ASSERT(reporter, set7.orBits(set2, 0, 0) == false);
+
+    set7.orBits(set6, 40, 1000);
+    REPORTER_ASSERT(reporter, set7 == set6);
+    data.rewind();
+    set7.exportTo(&data, 64, 1000);
+    REPORTER_ASSERT(reporter, data.count() == 2);
+    REPORTER_ASSERT(reporter, data[0] == 70);
+    REPORTER_ASSERT(reporter, data[1] == 1000);
 }
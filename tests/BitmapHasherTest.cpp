@@ -39,3 +39,40 @@ DEF_TEST(BitmapHasher, reporter) {
     REPORTER_ASSERT(reporter, SkBitmapHasher::ComputeDigest(bitmap, &digest));
     REPORTER_ASSERT(reporter, digest == 0x2423c51cad6d1edcULL);
 }
+
+DEF_TEST(BitmapHasher_Fast, reporter) {
+    SkBitmap bitmap;
+    uint64_t blue, wide, green, padded, changed;
+    CreateTestBitmap(&bitmap, 333, 555, SK_ColorBLUE, reporter);
+    REPORTER_ASSERT(reporter, SkBitmapHasher::ComputeFastDigest(bitmap, &blue));
+    // Hashing the same pixels again gives the same digest.
+    uint64_t again;
+    REPORTER_ASSERT(reporter, SkBitmapHasher::ComputeFastDigest(bitmap, &again));
+    REPORTER_ASSERT(reporter, blue == again);
+
+    // Same pixel data but different dimensions, or different colors, hash differently.
+    CreateTestBitmap(&bitmap, 555, 333, SK_ColorBLUE, reporter);
+    REPORTER_ASSERT(reporter, SkBitmapHasher::ComputeFastDigest(bitmap, &wide));
+    REPORTER_ASSERT(reporter, wide != blue);
+    CreateTestBitmap(&bitmap, 555, 333, SK_ColorGREEN, reporter);
+    REPORTER_ASSERT(reporter, SkBitmapHasher::ComputeFastDigest(bitmap, &green));
+    REPORTER_ASSERT(reporter, green != wide);
+
+    // Padding at the ends of the rows is left out.
+    SkBitmap paddedBitmap;
+    const SkImageInfo info = SkImageInfo::MakeN32(555, 333, kOpaque_SkAlphaType);
+    REPORTER_ASSERT(reporter, paddedBitmap.setInfo(info, info.minRowBytes() + 12));
+    REPORTER_ASSERT(reporter, paddedBitmap.allocPixels());
+    memset(paddedBitmap.getPixels(), 0x5A, paddedBitmap.getSize());
+    paddedBitmap.eraseColor(SK_ColorGREEN);
+    REPORTER_ASSERT(reporter, SkBitmapHasher::ComputeFastDigest(paddedBitmap, &padded));
+    REPORTER_ASSERT(reporter, padded == green);
+
+    // Every pixel counts, including the last few bytes of a row.
+    for (int x = 550; x < 555; ++x) {
+        *bitmap.getAddr32(x, 200) = SK_ColorRED;
+        REPORTER_ASSERT(reporter, SkBitmapHasher::ComputeFastDigest(bitmap, &changed));
+        REPORTER_ASSERT(reporter, changed != green);
+        *bitmap.getAddr32(x, 200) = SK_ColorGREEN;
+    }
+}
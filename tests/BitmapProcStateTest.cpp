@@ -0,0 +1,209 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmapProcState.h"
+#include "SkColorPriv.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
+#include "Test.h"
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+
+#include "SkBitmapProcState_opts_SSE2.h"
+
+static const int kMaxCount = 40;
+
+static void setup_state(SkBitmapProcState* s, const SkBitmap& bm, const SkMatrix& inv,
+                        unsigned alphaScale) {
+    s->fBitmap = &bm;
+    s->fInvMatrix = inv;
+    s->fInvType = inv.getType();
+    s->fFilterOneX = SK_Fixed1;
+    s->fFilterOneY = SK_Fixed1;
+    s->fAlphaScale = alphaScale;
+    s->fFilterLevel = SkPaint::kLow_FilterLevel;
+}
+
+// The SSE2 perspective procs work on 4 points at a time; they must agree
+// with the portable procs for every count, including the remainders.
+static void test_persp_matrix_procs(skiatest::Reporter* reporter) {
+    SkBitmap bm;
+    bm.allocN32Pixels(37, 23);
+
+    SkMatrix inv[3];
+    inv[0].setAll(0.9f, 0.1f, -3, 0.05f, 1.1f, 2, 0.002f, 0.001f, 1);
+    inv[1].setAll(2, -0.5f, 10, 0.3f, 0.7f, -5, -0.004f, 0.003f, 0.8f);
+    // Points near the vanishing line map far outside the bitmap.
+    inv[2].setAll(1, 0, 0, 0, 1, 0, 0, -0.01f, 1.05f);
+
+    uint32_t expected[2 * kMaxCount];
+    uint32_t actual[2 * kMaxCount];
+    for (size_t m = 0; m < SK_ARRAY_COUNT(inv); ++m) {
+        SkBitmapProcState s;
+        setup_state(&s, bm, inv[m], 256);
+        for (int count = 1; count <= kMaxCount; ++count) {
+            for (int y = -2; y < 120; y += 11) {
+                ClampX_ClampY_filter_persp(s, expected, count, -3, y);
+                ClampX_ClampY_filter_persp_SSE2(s, actual, count, -3, y);
+                REPORTER_ASSERT(reporter,
+                                0 == memcmp(expected, actual, 2 * count * sizeof(uint32_t)));
+
+                ClampX_ClampY_nofilter_persp(s, expected, count, -3, y);
+                ClampX_ClampY_nofilter_persp_SSE2(s, actual, count, -3, y);
+                REPORTER_ASSERT(reporter,
+                                0 == memcmp(expected, actual, count * sizeof(uint32_t)));
+            }
+        }
+    }
+}
+
+// The DXDY sample procs get a (y, x) pair per pixel, as the perspective and
+// affine matrix procs write them.
+static void test_filter_DXDY_procs(skiatest::Reporter* reporter) {
+    SkRandom rand;
+    SkBitmap bm;
+    bm.allocN32Pixels(19, 17);
+    for (int y = 0; y < bm.height(); ++y) {
+        for (int x = 0; x < bm.width(); ++x) {
+            *bm.getAddr32(x, y) = SkPreMultiplyColor(rand.nextU());
+        }
+    }
+
+    SkMatrix inv;
+    inv.setAll(0.8f, 0.3f, -2, -0.2f, 0.9f, 1, 0.003f, -0.002f, 1);
+
+    uint32_t xy[2 * kMaxCount];
+    SkPMColor expected[kMaxCount];
+    SkPMColor actual[kMaxCount];
+    static const unsigned gAlphaScales[] = { 256, 255, 128, 1 };
+    for (size_t a = 0; a < SK_ARRAY_COUNT(gAlphaScales); ++a) {
+        SkBitmapProcState s;
+        setup_state(&s, bm, inv, gAlphaScales[a]);
+        const bool opaque = 256 == gAlphaScales[a];
+        for (int count = 1; count <= kMaxCount; ++count) {
+            ClampX_ClampY_filter_persp(s, xy, count, -5, count % 20);
+            if (opaque) {
+                S32_opaque_D32_filter_DXDY(s, xy, count, expected);
+                S32_opaque_D32_filter_DXDY_SSE2(s, xy, count, actual);
+            } else {
+                S32_alpha_D32_filter_DXDY(s, xy, count, expected);
+                S32_alpha_D32_filter_DXDY_SSE2(s, xy, count, actual);
+            }
+            REPORTER_ASSERT(reporter,
+                            0 == memcmp(expected, actual, count * sizeof(SkPMColor)));
+        }
+    }
+}
+
+// The SSE2 repeat procs step through normalized coordinates 8 at a time, after
+// aligning their output; they must agree with the portable procs everywhere.
+static void test_repeat_matrix_procs(skiatest::Reporter* reporter) {
+    static const int gWidths[] = { 1, 7, 50, 300, 4000 };
+    static const SkScalar gScales[] = { 1, 0.37f, 1.7f, -2.3f };
+
+    uint32_t expected[kMaxCount + 4];
+    uint32_t actual[kMaxCount + 4];
+    for (size_t w = 0; w < SK_ARRAY_COUNT(gWidths); ++w) {
+        SkBitmap bm;
+        bm.setInfo(SkImageInfo::MakeN32Premul(gWidths[w], 13));
+        for (size_t i = 0; i < SK_ARRAY_COUNT(gScales); ++i) {
+            SkMatrix inv;
+            inv.setScale(gScales[i], 0.6f);
+            inv.postTranslate(-31.3f, 7.2f);
+            inv.postIDiv(bm.width(), bm.height());
+
+            SkBitmapProcState s;
+            setup_state(&s, bm, inv, 256);
+            s.fInvProc = inv.getMapXYProc();
+            s.fInvSx = SkScalarToFixed(inv.getScaleX());
+            s.fInvSxFractionalInt = SkScalarToFractionalInt(inv.getScaleX());
+            s.fInvKy = 0;
+            s.fFilterOneX = SK_Fixed1 / bm.width();
+            s.fFilterOneY = SK_Fixed1 / bm.height();
+            for (int count = 1; count <= kMaxCount; ++count) {
+                // Offset the output to exercise every alignment.
+                for (int offset = 0; offset < 4; ++offset) {
+                    const int x = count * 17 - 200;
+                    RepeatX_RepeatY_filter_scale(s, expected + offset, count, x, 5);
+                    RepeatX_RepeatY_filter_scale_SSE2(s, actual + offset, count, x, 5);
+                    REPORTER_ASSERT(reporter, 0 == memcmp(expected + offset, actual + offset,
+                                                          (1 + count) * sizeof(uint32_t)));
+
+                    RepeatX_RepeatY_nofilter_scale(s, expected + offset, count, x, 5);
+                    RepeatX_RepeatY_nofilter_scale_SSE2(s, actual + offset, count, x, 5);
+                    REPORTER_ASSERT(reporter, 0 == memcmp(expected + offset, actual + offset,
+                                                          sizeof(uint32_t) +
+                                                          count * sizeof(uint16_t)));
+                }
+            }
+        }
+    }
+}
+
+DEF_TEST(BitmapProcState_SSE2, reporter) {
+    test_persp_matrix_procs(reporter);
+    test_filter_DXDY_procs(reporter);
+    test_repeat_matrix_procs(reporter);
+}
+
+#endif
+
+#include "SkCanvas.h"
+#include "SkShader.h"
+
+static int tile(SkShader::TileMode mode, int x, int n) {
+    const int period = SkShader::kMirror_TileMode == mode ? 2 * n : n;
+    x %= period;
+    if (x < 0) {
+        x += period;
+    }
+    return x < n ? x : 2 * n - 1 - x;
+}
+
+// Small repeat and mirror bitmaps are sampled from a copy already tiled out,
+// which must not show at integer translates.
+DEF_TEST(BitmapProcState_Pretiled, reporter) {
+    SkRandom rand;
+    SkBitmap src;
+    src.allocN32Pixels(7, 5);
+    for (int y = 0; y < src.height(); ++y) {
+        for (int x = 0; x < src.width(); ++x) {
+            *src.getAddr32(x, y) = SkPreMultiplyColor(rand.nextU());
+        }
+    }
+
+    static const SkShader::TileMode gModes[] = {
+        SkShader::kRepeat_TileMode, SkShader::kMirror_TileMode
+    };
+    SkBitmap dst;
+    dst.allocN32Pixels(100, 30);
+    for (size_t mx = 0; mx < SK_ARRAY_COUNT(gModes); ++mx) {
+        for (size_t my = 0; my < SK_ARRAY_COUNT(gModes); ++my) {
+            // Draw twice, so the second draw finds the cached copy.
+            for (int pass = 0; pass < 2; ++pass) {
+                dst.eraseColor(SK_ColorTRANSPARENT);
+                SkCanvas canvas(dst);
+                canvas.translate(-11, 3);
+                SkPaint paint;
+                paint.setShader(SkShader::CreateBitmapShader(src, gModes[mx],
+                                                             gModes[my]))->unref();
+                paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+                canvas.drawPaint(paint);
+
+                bool same = true;
+                for (int y = 0; y < dst.height(); ++y) {
+                    for (int x = 0; x < dst.width(); ++x) {
+                        const int sx = tile(gModes[mx], x + 11, src.width());
+                        const int sy = tile(gModes[my], y - 3, src.height());
+                        same &= *dst.getAddr32(x, y) == *src.getAddr32(sx, sy);
+                    }
+                }
+                REPORTER_ASSERT(reporter, same);
+            }
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkBitmapProcState.h"
+#include "SkBitmapScaler.h"
+#include "SkColorPriv.h"
+#include "SkConvolver.h"
+#include "SkGraphics.h"
+#include "SkRandom.h"
+#include "Test.h"
+
+static void fill_random(SkBitmap* bm, int width, int height) {
+    bm->allocN32Pixels(width, height);
+    SkRandom rand;
+    for (int y = 0; y < height; ++y) {
+        SkPMColor* row = bm->getAddr32(0, y);
+        for (int x = 0; x < width; ++x) {
+            U8CPU a = rand.nextU() & 0xFF;
+            row[x] = SkPackARGB32(a, rand.nextRangeU(0, a), rand.nextRangeU(0, a),
+                                  rand.nextRangeU(0, a));
+        }
+    }
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    if (a.width() != b.width() || a.height() != b.height()) {
+        return false;
+    }
+    for (int y = 0; y < a.height(); ++y) {
+        if (0 != memcmp(a.getAddr32(0, y), b.getAddr32(0, y), a.width() * 4)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Resizing in bands on several threads must give the same pixels as resizing on one.
+DEF_TEST(BitmapScaler_Threaded, reporter) {
+    SkBitmap src;
+    fill_random(&src, 301, 517);
+
+    SkConvolutionProcs procs;
+    sk_bzero(&procs, sizeof(procs));
+    SkBitmapProcState state;
+    state.platformConvolutionProcs(&procs);
+
+    static const float gSizes[][2] = {
+        { 150, 250 }, { 97, 411 }, { 640, 1100 }, { 33, 40 },
+    };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gSizes); ++i) {
+        SkBitmap one, many;
+        SkGraphics::SetResizeThreadCount(1);
+        bool oneOK = SkBitmapScaler::Resize(&one, src, SkBitmapScaler::RESIZE_LANCZOS3,
+                                            gSizes[i][0], gSizes[i][1], procs);
+        int prevCount = SkGraphics::SetResizeThreadCount(3);
+        bool manyOK = SkBitmapScaler::Resize(&many, src, SkBitmapScaler::RESIZE_LANCZOS3,
+                                             gSizes[i][0], gSizes[i][1], procs);
+        SkGraphics::SetResizeThreadCount(prevCount);
+
+        REPORTER_ASSERT(reporter, oneOK && manyOK);
+        REPORTER_ASSERT(reporter, same_pixels(one, many));
+    }
+}
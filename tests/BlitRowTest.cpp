@@ -6,9 +6,11 @@
  */
 
 #include "SkBitmap.h"
+#include "SkBlitRow.h"
 #include "SkCanvas.h"
 #include "SkColorPriv.h"
 #include "SkGradientShader.h"
+#include "SkRandom.h"
 #include "SkRect.h"
 #include "Test.h"
 
@@ -258,7 +260,133 @@ static void test_diagonal(skiatest::Reporter* reporter) {
     }
 }
 
+static SkPMColor random_pmcolor(SkRandom* rand) {
+    SkColor c = rand->nextU();
+    // Mix in some opaque and transparent pixels, which the procs special-case.
+    switch (rand->nextULessThan(4)) {
+        case 0:  c |= 0xFF000000; break;
+        case 1:  c &= 0x00FFFFFF; break;
+        default: break;
+    }
+    return SkPreMultiplyColor(c);
+}
+
+static SkPMColor blit_row_expected(unsigned flags, SkPMColor src, SkPMColor dst, U8CPU alpha) {
+    unsigned scale = SkAlpha255To256(alpha);
+    switch (flags) {
+        case 0:
+            return src;
+        case SkBlitRow::kGlobalAlpha_Flag32:
+            return SkAlphaMulQ(src, scale) + SkAlphaMulQ(dst, 256 - scale);
+        case SkBlitRow::kSrcPixelAlpha_Flag32:
+            return SkPMSrcOver(src, dst);
+        default:
+            return SkBlendARGB32(src, dst, alpha);
+    }
+}
+
+/*  The platform procs (SSE2, AVX2, NEON...) work on several pixels at a time, with
+ *  different code for the unaligned head and the short tail; check every mix of dst
+ *  alignment and count against the scalar math they must agree with.
+ */
+static void test_procs32(skiatest::Reporter* reporter) {
+    static const int kMaxCount = 40;
+    static const int kMaxOffset = 8;
+    // Callers drop kGlobalAlpha_Flag32 when the alpha is 255, and the SIMD procs
+    // rely on that.
+    static const U8CPU gAlphas[] = { 0, 1, 127, 128, 254 };
+
+    SkRandom rand;
+    SkPMColor src[kMaxCount + kMaxOffset];
+    SkPMColor dst[kMaxCount + kMaxOffset];
+    SkPMColor expected[kMaxCount + kMaxOffset];
+
+    for (unsigned flags = 0; flags < 4; ++flags) {
+        SkBlitRow::Proc32 proc = SkBlitRow::Factory32(flags);
+        bool globalAlpha = SkToBool(flags & SkBlitRow::kGlobalAlpha_Flag32);
+        for (size_t a = 0; a < (globalAlpha ? SK_ARRAY_COUNT(gAlphas) : 1); ++a) {
+            U8CPU alpha = globalAlpha ? gAlphas[a] : 255;
+            for (int offset = 0; offset < kMaxOffset; ++offset) {
+                for (int count = 0; count <= kMaxCount; ++count) {
+                    for (int i = 0; i < kMaxCount + kMaxOffset; ++i) {
+                        src[i] = random_pmcolor(&rand);
+                        dst[i] = expected[i] = random_pmcolor(&rand);
+                    }
+                    for (int i = offset; i < offset + count; ++i) {
+                        expected[i] = blit_row_expected(flags, src[i], dst[i], alpha);
+                    }
+                    proc(dst + offset, src + offset, count, alpha);
+                    REPORTER_ASSERT(reporter, 0 == memcmp(dst, expected, sizeof(dst)));
+                }
+            }
+        }
+    }
+
+    SkBlitRow::ColorProc colorProc = SkBlitRow::ColorProcFactory();
+    for (int c = 0; c < 16; ++c) {
+        SkPMColor color = 0 == c ? 0 : random_pmcolor(&rand);
+        unsigned scale = 256 - SkAlpha255To256(SkGetPackedA32(color));
+        for (int offset = 0; offset < kMaxOffset; ++offset) {
+            for (int count = 0; count <= kMaxCount; ++count) {
+                for (int i = 0; i < kMaxCount + kMaxOffset; ++i) {
+                    src[i] = random_pmcolor(&rand);
+                    dst[i] = expected[i] = random_pmcolor(&rand);
+                }
+                for (int i = offset; i < offset + count; ++i) {
+                    // SkAlphaMulQ(x, 256) is not quite x, so transparent black is a copy.
+                    expected[i] = 0 == color ? src[i] : color + SkAlphaMulQ(src[i], scale);
+                }
+                colorProc(dst + offset, src + offset, count, color);
+                REPORTER_ASSERT(reporter, 0 == memcmp(dst, expected, sizeof(dst)));
+            }
+        }
+    }
+}
+
+/*  The same for the 565 procs. Their scalar math is too fiddly to repeat here, but a
+ *  single pixel always takes the scalar tail, so a row at a time must match a pixel at
+ *  a time, dither and all.
+ */
+static void test_procs565(skiatest::Reporter* reporter) {
+    static const int kMaxCount = 40;
+    static const int kMaxOffset = 8;
+    static const U8CPU gAlphas[] = { 0, 1, 127, 128, 254 };
+
+    SkRandom rand;
+    SkPMColor src[kMaxCount + kMaxOffset];
+    uint16_t dst[kMaxCount + kMaxOffset];
+    uint16_t expected[kMaxCount + kMaxOffset];
+
+    for (unsigned flags = 0; flags < 8; ++flags) {  // Every combination of Flags16.
+        SkBlitRow::Proc proc = SkBlitRow::Factory(flags, kRGB_565_SkColorType);
+        bool globalAlpha = SkToBool(flags & SkBlitRow::kGlobalAlpha_Flag);
+        for (size_t a = 0; a < (globalAlpha ? SK_ARRAY_COUNT(gAlphas) : 1); ++a) {
+            U8CPU alpha = globalAlpha ? gAlphas[a] : 255;
+            for (int offset = 0; offset < kMaxOffset; ++offset) {
+                for (int count = 0; count <= kMaxCount; ++count) {
+                    const int x = rand.nextULessThan(16);
+                    const int y = rand.nextULessThan(16);
+                    for (int i = 0; i < kMaxCount + kMaxOffset; ++i) {
+                        src[i] = random_pmcolor(&rand);
+                        if (!(flags & SkBlitRow::kSrcPixelAlpha_Flag)) {
+                            src[i] |= SK_A32_MASK << SK_A32_SHIFT;
+                        }
+                        dst[i] = expected[i] = rand.nextU() & 0xFFFF;
+                    }
+                    for (int i = offset; i < offset + count; ++i) {
+                        proc(expected + i, src + i, 1, alpha, x + i - offset, y);
+                    }
+                    proc(dst + offset, src + offset, count, alpha, x, y);
+                    REPORTER_ASSERT(reporter, 0 == memcmp(dst, expected, sizeof(dst)));
+                }
+            }
+        }
+    }
+}
+
 DEF_TEST(BlitRow, reporter) {
     test_00_FF(reporter);
     test_diagonal(reporter);
+    test_procs32(reporter);
+    test_procs565(reporter);
 }
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkBlitter.h"
+#include "SkCanvas.h"
+#include "SkColorFilter.h"
+#include "SkColorPriv.h"
+#include "Test.h"
+
+static void test_reuse(skiatest::Reporter* reporter) {
+    SkBlitterScratch::PurgeThread();
+
+    void* a = SkBlitterScratch::Acquire(400);
+    void* b = SkBlitterScratch::Acquire(400);
+    REPORTER_ASSERT(reporter, NULL != a && NULL != b && a != b);
+    REPORTER_ASSERT(reporter, SkIsAlign8((intptr_t)a) && SkIsAlign8((intptr_t)b));
+    memset(a, 0xAB, 400);
+    memset(b, 0xCD, 400);
+    SkBlitterScratch::Release(a);
+    SkBlitterScratch::Release(b);
+
+    // Released blocks are handed out again, for the same or a smaller size.
+    void* c = SkBlitterScratch::Acquire(400);
+    void* d = SkBlitterScratch::Acquire(10);
+    REPORTER_ASSERT(reporter, (c == a && d == b) || (c == b && d == a));
+
+    // A block that is too small is not reused.
+    SkBlitterScratch::Release(d);
+    void* e = SkBlitterScratch::Acquire(100 * 1024);
+    REPORTER_ASSERT(reporter, e != d);
+    memset(e, 0, 100 * 1024);
+
+    SkBlitterScratch::Release(NULL);
+    SkBlitterScratch::Release(c);
+    SkBlitterScratch::Release(e);
+    SkBlitterScratch::PurgeThread();
+}
+
+// Color filters and xfermodes make SkBlitter::Choose wrap the paint's color
+// in shaders owned by its allocator, and use a shader blitter's scratch row.
+static void test_draws(skiatest::Reporter* reporter) {
+    SkBitmap bm;
+    bm.allocN32Pixels(300, 4);
+
+    SkAutoTUnref<SkColorFilter> cf(SkColorFilter::CreateModeFilter(SK_ColorBLUE,
+                                                                   SkXfermode::kSrc_Mode));
+    for (int i = 0; i < 3; ++i) {
+        bm.eraseColor(SK_ColorWHITE);
+        SkCanvas canvas(bm);
+
+        SkPaint paint;
+        paint.setColor(SK_ColorRED);
+        paint.setColorFilter(cf);
+        canvas.drawRect(SkRect::MakeWH(300, 2), paint);
+
+        paint.setColorFilter(NULL);
+        paint.setXfermodeMode(SkXfermode::kDst_Mode);
+        canvas.drawRect(SkRect::MakeXYWH(0, 2, 300, 1), paint);
+        paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+        paint.setColorFilter(cf);
+        canvas.drawRect(SkRect::MakeXYWH(0, 3, 300, 1), paint);
+
+        SkAutoLockPixels alp(bm);
+        REPORTER_ASSERT(reporter, SkPreMultiplyColor(SK_ColorBLUE) == *bm.getAddr32(150, 1));
+        REPORTER_ASSERT(reporter, SkPreMultiplyColor(SK_ColorWHITE) == *bm.getAddr32(299, 2));
+        REPORTER_ASSERT(reporter, SkPreMultiplyColor(SK_ColorBLUE) == *bm.getAddr32(0, 3));
+    }
+}
+
+DEF_TEST(BlitterScratch, reporter) {
+    test_reuse(reporter);
+    test_draws(reporter);
+}
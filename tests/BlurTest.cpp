@@ -11,6 +11,9 @@
 #include "SkLayerDrawLooper.h"
 #include "SkEmbossMaskFilter.h"
 #include "SkCanvas.h"
+#include "SkGraphics.h"
+#include "SkMaskCache.h"
+#include "SkRRect.h"
 #include "SkMath.h"
 #include "SkPaint.h"
 #include "Test.h"
@@ -560,10 +563,99 @@ static void test_asABlur(skiatest::Reporter* reporter) {
     }
 }
 
+// Blurring a mask big enough to be split into bands on several threads must give the same
+// pixels as blurring it on one.
+static void test_threaded_blur(skiatest::Reporter* reporter) {
+    SkMask src;
+    src.fBounds.set(0, 0, 700, 500);
+    src.fFormat = SkMask::kA8_Format;
+    src.fRowBytes = src.fBounds.width();
+    src.fImage = SkMask::AllocImage(src.computeImageSize());
+    for (size_t i = 0; i < src.computeImageSize(); ++i) {
+        src.fImage[i] = (i * 97) & 0xFF;
+    }
+
+    const SkScalar sigmas[] = { 1.5f, 4, 7.3f };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(sigmas); ++i) {
+        for (int quality = kLow_SkBlurQuality; quality <= kHigh_SkBlurQuality; ++quality) {
+            SkMask one, many;
+            SkGraphics::SetBlurThreadCount(1);
+            bool oneOK = SkBlurMask::BoxBlur(&one, src, sigmas[i], kNormal_SkBlurStyle,
+                                             (SkBlurQuality) quality, NULL, true);
+            int prevCount = SkGraphics::SetBlurThreadCount(3);
+            bool manyOK = SkBlurMask::BoxBlur(&many, src, sigmas[i], kNormal_SkBlurStyle,
+                                              (SkBlurQuality) quality, NULL, true);
+            SkGraphics::SetBlurThreadCount(prevCount);
+
+            REPORTER_ASSERT(reporter, oneOK && manyOK);
+            REPORTER_ASSERT(reporter, one.fBounds == many.fBounds);
+            REPORTER_ASSERT(reporter, 0 == memcmp(one.fImage, many.fImage,
+                                                  one.computeImageSize()));
+            SkMask::FreeImage(one.fImage);
+            SkMask::FreeImage(many.fImage);
+        }
+    }
+    SkMask::FreeImage(src.fImage);
+}
+
+static void draw_shadows(const SkRRect& rrect, SkMaskFilter* mf, SkBitmap* bitmap) {
+    bitmap->allocN32Pixels(200, 200);
+    SkCanvas canvas(*bitmap);
+    canvas.clear(SK_ColorWHITE);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setMaskFilter(mf);
+    // The translations share one nine-patch; the fraction is part of the key.
+    static const SkScalar gOffsets[][2] = {
+        { 0, 0 }, { 90, 3 }, { 20, 100 }, { 100.5f, 90.25f },
+    };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gOffsets); ++i) {
+        canvas.save();
+        canvas.translate(gOffsets[i][0], gOffsets[i][1]);
+        if (rrect.isRect()) {
+            canvas.drawRect(rrect.rect(), paint);
+        } else {
+            canvas.drawRRect(rrect, paint);
+        }
+        canvas.restore();
+    }
+}
+
+// Blurred rects and round rects draw the same with their nine-patches cached as without.
+static void test_nine_patch_cache(skiatest::Reporter* reporter) {
+    const size_t limit = SkMaskCache::GetByteLimit();
+
+    SkRRect rrects[2];
+    rrects[0].setRect(SkRect::MakeXYWH(20, 20, 70, 50));
+    rrects[1].setRectXY(SkRect::MakeXYWH(20, 20, 70, 50), 8, 8);
+    const SkScalar sigmas[] = { 1.5f, 4 };
+    for (size_t r = 0; r < SK_ARRAY_COUNT(rrects); ++r) {
+        for (size_t i = 0; i < SK_ARRAY_COUNT(sigmas); ++i) {
+            SkAutoTUnref<SkMaskFilter> mf(SkBlurMaskFilter::Create(kNormal_SkBlurStyle,
+                                                                   sigmas[i]));
+            SkBitmap expected, actual;
+            SkMaskCache::SetByteLimit(0);
+            draw_shadows(rrects[r], mf, &expected);
+            REPORTER_ASSERT(reporter, 0 == SkMaskCache::GetBytesUsed());
+
+            SkMaskCache::SetByteLimit(limit);
+            SkMaskCache::Purge();
+            draw_shadows(rrects[r], mf, &actual);
+            REPORTER_ASSERT(reporter, SkMaskCache::GetBytesUsed() > 0);
+
+            SkAutoLockPixels alpExpected(expected), alpActual(actual);
+            REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                                  expected.getSize()));
+        }
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 
 DEF_GPUTEST(Blur, reporter, factory) {
     test_blur_drawing(reporter);
     test_sigma_range(reporter, factory);
     test_asABlur(reporter);
+    test_threaded_blur(reporter);
+    test_nine_patch_cache(reporter);
 }
@@ -936,6 +936,98 @@ static void test_newraster(skiatest::Reporter* reporter) {
     SkDELETE(canvas);
 }
 
+// Levels share the matrix and clip of the level below until they change them, and the inverse
+// used for the local clip bounds goes with the matrix.
+static void test_save_restore_sharing(skiatest::Reporter* reporter) {
+    SkCanvas* canvas = SkCanvas::NewRaster(SkImageInfo::MakeN32Premul(100, 100));
+    SkRect bounds;
+    SkMatrix scale;
+    scale.setScale(2, 2);
+
+    canvas->scale(2, 2);
+    REPORTER_ASSERT(reporter, canvas->getClipBounds(&bounds));
+    REPORTER_ASSERT(reporter, bounds == SkRect::MakeLTRB(-0.5f, -0.5f, 50.5f, 50.5f));
+
+    canvas->save();
+    REPORTER_ASSERT(reporter, canvas->getClipBounds(&bounds));
+    REPORTER_ASSERT(reporter, bounds == SkRect::MakeLTRB(-0.5f, -0.5f, 50.5f, 50.5f));
+    canvas->translate(10, 10);
+    canvas->clipRect(SkRect::MakeWH(20, 20));
+    REPORTER_ASSERT(reporter, canvas->getClipBounds(&bounds));
+    REPORTER_ASSERT(reporter, bounds == SkRect::MakeLTRB(-0.5f, -0.5f, 20.5f, 20.5f));
+
+    // A level that only saves the matrix changes the clip of the level below.
+    canvas->save(SkCanvas::kMatrix_SaveFlag);
+    canvas->scale(0, 0);
+    REPORTER_ASSERT(reporter, !canvas->getClipBounds(&bounds));
+    canvas->setMatrix(SkMatrix::I());
+    canvas->clipRect(SkRect::MakeLTRB(20, 20, 40, 40));
+    canvas->restore();
+    REPORTER_ASSERT(reporter, canvas->getClipBounds(&bounds));
+    REPORTER_ASSERT(reporter, bounds == SkRect::MakeLTRB(-0.5f, -0.5f, 10.5f, 10.5f));
+
+    // One that only saves the clip changes the matrix of the level below.
+    canvas->save(SkCanvas::kClip_SaveFlag);
+    canvas->translate(-10, -10);
+    canvas->clipRect(SkRect::MakeLTRB(10, 10, 15, 15));
+    canvas->restore();
+    REPORTER_ASSERT(reporter, canvas->getTotalMatrix() == scale);
+    REPORTER_ASSERT(reporter, canvas->getClipBounds(&bounds));
+    REPORTER_ASSERT(reporter, bounds == SkRect::MakeLTRB(9.5f, 9.5f, 20.5f, 20.5f));
+
+    canvas->restore();
+    REPORTER_ASSERT(reporter, canvas->getTotalMatrix() == scale);
+    REPORTER_ASSERT(reporter, canvas->getClipBounds(&bounds));
+    REPORTER_ASSERT(reporter, bounds == SkRect::MakeLTRB(-0.5f, -0.5f, 50.5f, 50.5f));
+    SkDELETE(canvas);
+}
+
+// drawRects() draws the same pixels as calling drawRect() for each rect, whether or not the
+// paint and matrix let the raster device batch them.
+static void test_draw_rects(skiatest::Reporter* reporter) {
+    const SkRect rects[] = {
+        SkRect::MakeLTRB(1, 1, 5, 5),
+        SkRect::MakeLTRB(4.5f, 3.25f, 20, 9.75f),
+        SkRect::MakeLTRB(30, 30, 10, 12),     // unsorted
+        SkRect::MakeLTRB(-10, -10, 2, 40),    // partly clipped
+        SkRect::MakeLTRB(200, 200, 210, 210), // rejected
+        SkRect::MakeLTRB(12, 12, 12, 30),     // empty
+    };
+    const int count = SK_ARRAY_COUNT(rects);
+
+    for (int i = 0; i < 8; ++i) {
+        SkPaint paint;
+        paint.setColor(0x80FF4020);
+        paint.setAntiAlias(SkToBool(i & 1));
+        if (i & 2) {
+            paint.setStyle(SkPaint::kStroke_Style);
+            paint.setStrokeWidth(SkIntToScalar(i));
+        }
+
+        SkBitmap batched, single;
+        batched.allocN32Pixels(48, 48);
+        single.allocN32Pixels(48, 48);
+        batched.eraseColor(SK_ColorWHITE);
+        single.eraseColor(SK_ColorWHITE);
+        SkCanvas batchedCanvas(batched), singleCanvas(single);
+        if (i & 4) {
+            batchedCanvas.rotate(10);
+            singleCanvas.rotate(10);
+        }
+        batchedCanvas.clipRect(SkRect::MakeLTRB(0, 0, 40, 40));
+        singleCanvas.clipRect(SkRect::MakeLTRB(0, 0, 40, 40));
+
+        batchedCanvas.drawRects(rects, count, paint);
+        for (int j = 0; j < count; ++j) {
+            singleCanvas.drawRect(rects[j], paint);
+        }
+
+        SkAutoLockPixels batchedLock(batched), singleLock(single);
+        REPORTER_ASSERT(reporter, 0 == memcmp(batched.getPixels(), single.getPixels(),
+                                              batched.getSize()));
+    }
+}
+
 DEF_TEST(Canvas, reporter) {
     // Init global here because bitmap pixels cannot be alocated during
     // static initialization
@@ -954,4 +1046,6 @@ DEF_TEST(Canvas, reporter) {
     kTestBitmap.reset();
 
     test_newraster(reporter);
+    test_save_restore_sharing(reporter);
+    test_draw_rects(reporter);
 }
@@ -18,10 +18,13 @@ static uint32_t murmur_noseed(const uint32_t* d, size_t l) { return SkChecksum::
 DEF_TEST(Checksum, r) {
     // Algorithms to test.  They're currently all uint32_t(const uint32_t*, size_t).
     typedef uint32_t(*algorithmProc)(const uint32_t*, size_t);
-    const algorithmProc kAlgorithms[] = { &SkChecksum::Compute, &murmur_noseed };
+    const algorithmProc kAlgorithms[] = {
+        &SkChecksum::Compute, &murmur_noseed, &SkChecksum::HashKey
+    };
 
-    // Put 128 random bytes into two identical buffers.  Any multiple of 4 will do.
-    const size_t kBytes = SkAlign4(128);
+    // Put 132 random bytes into two identical buffers.  Any multiple of 4 will do, but this one
+    // leaves a word over after HashKey()'s 8-byte steps.
+    const size_t kBytes = SkAlign4(132);
     SkRandom rand;
     uint32_t data[kBytes/4], tweaked[kBytes/4];
     for (size_t i = 0; i < SK_ARRAY_COUNT(tweaked); ++i) {
@@ -50,3 +53,22 @@ DEF_TEST(Checksum, r) {
         }
     }
 }
+
+DEF_TEST(Checksum_HashKey, r) {
+    // HashKey() takes different paths for short and long keys, and for odd words at the end.
+    SkRandom rand;
+    uint32_t data[64];
+    for (size_t i = 0; i < SK_ARRAY_COUNT(data); ++i) {
+        data[i] = rand.nextU();
+    }
+    for (size_t words = 1; words <= SK_ARRAY_COUNT(data); ++words) {
+        const size_t bytes = words * sizeof(uint32_t);
+        const uint32_t hash = SkChecksum::HashKey(data, bytes);
+        ASSERT(hash == SkChecksum::HashKey(data, bytes));
+        for (size_t j = 0; j < words; ++j) {
+            data[j] ^= 1u << (j % 32);
+            ASSERT(hash != SkChecksum::HashKey(data, bytes));
+            data[j] ^= 1u << (j % 32);
+        }
+    }
+}
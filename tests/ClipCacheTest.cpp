@@ -99,37 +99,30 @@ static void test_clip_bounds(skiatest::Reporter* reporter, GrContext* context) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// verify that the top state of the stack matches the passed in state
+// verify that the cache holds the passed in mask for the clip
 static void check_state(skiatest::Reporter* reporter,
-                        const GrClipMaskCache& cache,
+                        GrClipMaskCache* cache,
                         const SkClipStack& clip,
                         GrTexture* mask,
+                        const SkIPoint& maskOffset,
                         const SkIRect& bound) {
-    REPORTER_ASSERT(reporter, clip.getTopmostGenID() == cache.getLastClipGenID());
-
-    REPORTER_ASSERT(reporter, mask == cache.getLastMask());
-
-    SkIRect cacheBound;
-    cache.getLastBound(&cacheBound);
-    REPORTER_ASSERT(reporter, bound == cacheBound);
+    SkIPoint cacheOffset;
+    REPORTER_ASSERT(reporter,
+                    mask == cache->findMask(clip.getTopmostGenID(), bound, &cacheOffset));
+    REPORTER_ASSERT(reporter, maskOffset == cacheOffset);
 }
 
-static void check_empty_state(skiatest::Reporter* reporter,
-                              const GrClipMaskCache& cache) {
-    REPORTER_ASSERT(reporter, SkClipStack::kInvalidGenID == cache.getLastClipGenID());
-    REPORTER_ASSERT(reporter, NULL == cache.getLastMask());
-
-    SkIRect emptyBound;
-    emptyBound.setEmpty();
-
-    SkIRect cacheBound;
-    cache.getLastBound(&cacheBound);
-    REPORTER_ASSERT(reporter, emptyBound == cacheBound);
+static void check_missing(skiatest::Reporter* reporter,
+                          GrClipMaskCache* cache,
+                          const SkClipStack& clip,
+                          const SkIRect& bound) {
+    SkIPoint cacheOffset;
+    REPORTER_ASSERT(reporter, NULL == cache->findMask(clip.getTopmostGenID(), bound, &cacheOffset));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // basic test of the cache's base functionality:
-//  push, pop, set, canReuse & getters
+//  acquire, find, remove & eviction
 static void test_cache(skiatest::Reporter* reporter, GrContext* context) {
 
     if (false) { // avoid bit rot, suppress warning
@@ -140,83 +133,89 @@ static void test_cache(skiatest::Reporter* reporter, GrContext* context) {
     cache.setContext(context);
 
     // check initial state
-    check_empty_state(reporter, cache);
+    REPORTER_ASSERT(reporter, 0 == cache.count());
 
-    // set the current state
     SkIRect bound1;
-    bound1.set(0, 0, 100, 100);
+    bound1.set(0, 0, X_SIZE, Y_SIZE);
 
     SkClipStack clip1(bound1);
 
+    check_missing(reporter, &cache, clip1, bound1);
+
     GrTextureDesc desc;
     desc.fFlags = kRenderTarget_GrTextureFlagBit;
     desc.fWidth = X_SIZE;
     desc.fHeight = Y_SIZE;
     desc.fConfig = kSkia8888_GrPixelConfig;
 
-    cache.acquireMask(clip1.getTopmostGenID(), desc, bound1);
-
-    GrTexture* texture1 = cache.getLastMask();
+    // only A8 masks go in the atlas
+    SkIPoint offset1;
+    GrTexture* texture1 = cache.acquireMask(clip1.getTopmostGenID(), desc, bound1, &offset1);
     REPORTER_ASSERT(reporter, texture1);
     if (NULL == texture1) {
         return;
     }
+    REPORTER_ASSERT(reporter, 0 == offset1.fX && 0 == offset1.fY);
 
     // check that the set took
-    check_state(reporter, cache, clip1, texture1, bound1);
-    REPORTER_ASSERT(reporter, texture1->getRefCnt());
-
-    // push the state
-    cache.push();
+    check_state(reporter, &cache, clip1, texture1, offset1, bound1);
+    REPORTER_ASSERT(reporter, 1 == cache.count());
 
-    // verify that the pushed state is initially empty
-    check_empty_state(reporter, cache);
-    REPORTER_ASSERT(reporter, texture1->getRefCnt());
-
-    // modify the new state
+    // add a second mask, which may go in the atlas
     SkIRect bound2;
-    bound2.set(-10, -10, 10, 10);
+    bound2.set(-10, -10, X_SIZE - 10, Y_SIZE - 10);
 
     SkClipStack clip2(bound2);
 
-    cache.acquireMask(clip2.getTopmostGenID(), desc, bound2);
-
-    GrTexture* texture2 = cache.getLastMask();
+    if (context->isConfigRenderable(kAlpha_8_GrPixelConfig, false)) {
+        desc.fConfig = kAlpha_8_GrPixelConfig;
+    }
+    SkIPoint offset2;
+    GrTexture* texture2 = cache.acquireMask(clip2.getTopmostGenID(), desc, bound2, &offset2);
     REPORTER_ASSERT(reporter, texture2);
     if (NULL == texture2) {
         return;
     }
 
-    // check that the changes took
-    check_state(reporter, cache, clip2, texture2, bound2);
-    REPORTER_ASSERT(reporter, texture1->getRefCnt());
-    REPORTER_ASSERT(reporter, texture2->getRefCnt());
-
-    // check to make sure canReuse works
-    REPORTER_ASSERT(reporter, cache.canReuse(clip2.getTopmostGenID(), bound2));
-    REPORTER_ASSERT(reporter, !cache.canReuse(clip1.getTopmostGenID(), bound1));
-
-    // pop the state
-    cache.pop();
-
-    // verify that the old state is restored
-    check_state(reporter, cache, clip1, texture1, bound1);
-    REPORTER_ASSERT(reporter, texture1->getRefCnt());
+    // both masks are kept
+    check_state(reporter, &cache, clip2, texture2, offset2, bound2);
+    check_state(reporter, &cache, clip1, texture1, offset1, bound1);
+    REPORTER_ASSERT(reporter, 2 == cache.count());
+
+    // the bounds are part of the key
+    check_missing(reporter, &cache, clip1, bound2);
+
+    // removing one mask leaves the other
+    cache.removeMask(clip1.getTopmostGenID(), bound1);
+    check_missing(reporter, &cache, clip1, bound1);
+    check_state(reporter, &cache, clip2, texture2, offset2, bound2);
+    REPORTER_ASSERT(reporter, 1 == cache.count());
+
+    // adding many masks evicts the least recently used ones
+    static const int kNumClips = 20;
+    SkClipStack clips[kNumClips];
+    for (int i = 0; i < kNumClips; ++i) {
+        SkIRect bound = SkIRect::MakeXYWH(i, i, X_SIZE, Y_SIZE);
+        clips[i].clipDevRect(bound, SkRegion::kReplace_Op);
+        SkIPoint offset;
+        GrTexture* texture = cache.acquireMask(clips[i].getTopmostGenID(), desc, bound, &offset);
+        REPORTER_ASSERT(reporter, texture);
+        if (NULL == texture) {
+            return;
+        }
+        check_state(reporter, &cache, clips[i], texture, offset, bound);
+    }
+    REPORTER_ASSERT(reporter, cache.count() < kNumClips);
+    check_missing(reporter, &cache, clip2, bound2);
+    check_missing(reporter, &cache, clips[0], SkIRect::MakeXYWH(0, 0, X_SIZE, Y_SIZE));
 
     // manually clear the state
-    cache.reset();
+    cache.releaseResources();
 
     // verify it is now empty
-    check_empty_state(reporter, cache);
-
-    // pop again - so there is no state
-    cache.pop();
-
-#if !defined(SK_DEBUG)
-    // verify that the getters don't crash
-    // only do in release since it generates asserts in debug
-    check_empty_state(reporter, cache);
-#endif
+    REPORTER_ASSERT(reporter, 0 == cache.count());
+    check_missing(reporter, &cache, clips[kNumClips - 1],
+                  SkIRect::MakeXYWH(kNumClips - 1, kNumClips - 1, X_SIZE, Y_SIZE));
 }
 
 DEF_GPUTEST(ClipCache, reporter, factory) {
@@ -184,6 +184,45 @@ static void test_iterators(skiatest::Reporter* reporter) {
     }
 }
 
+// Copies share their clips until one of them changes.
+static void test_shared_copies(skiatest::Reporter* reporter) {
+    SkClipStack stack;
+    stack.clipDevRect(SkRect::MakeWH(100, 100), SkRegion::kIntersect_Op, false);
+    stack.save();
+    stack.clipDevRect(SkRect::MakeWH(50, 50), SkRegion::kIntersect_Op, false);
+
+    SkClipStack copy(stack);
+    REPORTER_ASSERT(reporter, copy == stack);
+    REPORTER_ASSERT(reporter, copy.getTopmostGenID() == stack.getTopmostGenID());
+
+    // Intersecting in place must not change the copy.
+    stack.clipDevRect(SkRect::MakeWH(20, 20), SkRegion::kIntersect_Op, false);
+    assert_count(reporter, stack, 2);
+    assert_count(reporter, copy, 2);
+    SkClipStack::Iter iter(copy, SkClipStack::Iter::kTop_IterStart);
+    REPORTER_ASSERT(reporter, iter.prev()->getRect() == SkRect::MakeWH(50, 50));
+    iter.reset(stack, SkClipStack::Iter::kTop_IterStart);
+    REPORTER_ASSERT(reporter, iter.prev()->getRect() == SkRect::MakeWH(20, 20));
+    REPORTER_ASSERT(reporter, copy != stack);
+
+    stack.restore();
+    copy.restore();
+    REPORTER_ASSERT(reporter, copy == stack);
+    copy.clipEmpty();
+    REPORTER_ASSERT(reporter, SkClipStack::kEmptyGenID != stack.getTopmostGenID());
+    REPORTER_ASSERT(reporter, SkClipStack::kEmptyGenID == copy.getTopmostGenID());
+
+    // A deep stack is freed without recursing once per clip.
+    SkClipStack deep;
+    for (int i = 0; i < 100000; ++i) {
+        deep.save();
+        deep.clipDevRect(SkRect::MakeWH(100, 100), SkRegion::kDifference_Op, false);
+    }
+    SkClipStack deepCopy(deep);
+    deep.reset();
+    assert_count(reporter, deepCopy, 100000);
+}
+
 // Exercise the SkClipStack's getConservativeBounds computation
 static void test_bounds(skiatest::Reporter* reporter, SkClipStack::Element::Type primType) {
     static const int gNumCases = 20;
@@ -1204,6 +1243,7 @@ DEF_TEST(ClipStack, reporter) {
 
     test_assign_and_comparison(reporter);
     test_iterators(reporter);
+    test_shared_copies(reporter);
     test_bounds(reporter, SkClipStack::Element::kRect_Type);
     test_bounds(reporter, SkClipStack::Element::kRRect_Type);
     test_bounds(reporter, SkClipStack::Element::kPath_Type);
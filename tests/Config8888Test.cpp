@@ -0,0 +1,96 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkColorPriv.h"
+#include "SkConfig8888.h"
+#include "SkTemplates.h"
+#include "SkUnPreMultiply.h"
+#include "Test.h"
+
+// Every alpha with every component, in rows of an odd width so that rows end partway through
+// a group of pixels. Red, green and blue each take a different component.
+static const int kWidth = 255;
+static const int kHeight = 257;
+
+static uint32_t test_pixel(int x, int y) {
+    int i = y * kWidth + x;
+    U8CPU a = i >> 8;
+    U8CPU c = i & 0xFF;
+    return SkPackARGB32NoCheck(a, c, (c + 85) & 0xFF, (c + 170) & 0xFF);
+}
+
+static uint32_t expected(uint32_t c, bool swapRB, SkAlphaType srcAT, SkAlphaType dstAT) {
+    if (swapRB) {
+        c = SkSwizzle_RB(c);
+    }
+    if (kPremul_SkAlphaType == srcAT && kUnpremul_SkAlphaType == dstAT) {
+        c = SkUnPreMultiply::UnPreMultiplyPreservingByteOrder(c);
+    } else if (kUnpremul_SkAlphaType == srcAT && kPremul_SkAlphaType == dstAT) {
+        c = SkPreMultiplyARGB(SkGetPackedA32(c), SkGetPackedR32(c),
+                              SkGetPackedG32(c), SkGetPackedB32(c));
+    }
+    return c;
+}
+
+static void test_conversion(skiatest::Reporter* reporter, SkColorType srcCT,
+                            SkAlphaType srcAT, SkColorType dstCT, SkAlphaType dstAT,
+                            bool inPlace) {
+    SkAutoTMalloc<uint32_t> src(kWidth * kHeight);
+    SkAutoTMalloc<uint32_t> dst(kWidth * kHeight);
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            src[y * kWidth + x] = test_pixel(x, y);
+        }
+    }
+
+    SkSrcPixelInfo srcPI;
+    srcPI.fColorType = srcCT;
+    srcPI.fAlphaType = srcAT;
+    srcPI.fPixels = src.get();
+    srcPI.fRowBytes = kWidth * 4;
+
+    SkDstPixelInfo dstPI;
+    dstPI.fColorType = dstCT;
+    dstPI.fAlphaType = dstAT;
+    dstPI.fPixels = inPlace ? src.get() : dst.get();
+    dstPI.fRowBytes = kWidth * 4;
+
+    REPORTER_ASSERT(reporter, srcPI.convertPixelsTo(&dstPI, kWidth, kHeight));
+
+    const uint32_t* result = static_cast<const uint32_t*>(dstPI.fPixels);
+    const bool swapRB = srcCT != dstCT;
+    int failures = 0;
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            if (result[y * kWidth + x] != expected(test_pixel(x, y), swapRB, srcAT, dstAT)) {
+                ++failures;
+            }
+        }
+    }
+    REPORTER_ASSERT(reporter, 0 == failures);
+}
+
+DEF_TEST(Config8888_ConvertPixels, reporter) {
+    static const SkColorType gColorTypes[] = {
+        kRGBA_8888_SkColorType, kBGRA_8888_SkColorType,
+    };
+    static const SkAlphaType gAlphaTypes[] = {
+        kPremul_SkAlphaType, kUnpremul_SkAlphaType,
+    };
+    for (size_t sc = 0; sc < SK_ARRAY_COUNT(gColorTypes); ++sc) {
+        for (size_t dc = 0; dc < SK_ARRAY_COUNT(gColorTypes); ++dc) {
+            for (size_t sa = 0; sa < SK_ARRAY_COUNT(gAlphaTypes); ++sa) {
+                for (size_t da = 0; da < SK_ARRAY_COUNT(gAlphaTypes); ++da) {
+                    for (int inPlace = 0; inPlace < 2; ++inPlace) {
+                        test_conversion(reporter, gColorTypes[sc], gAlphaTypes[sa],
+                                        gColorTypes[dc], gAlphaTypes[da], SkToBool(inPlace));
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCanvas.h"
+#include "SkCoverageMask.h"
+#include "SkPath.h"
+#include "Test.h"
+
+static const int W = 61;
+static const int H = 47;
+
+static void make_paths(SkPath paths[3]) {
+    // Large enough to be scanned directly, with curves and concavities.
+    paths[0].moveTo(3.3f, 2.1f);
+    paths[0].cubicTo(80, 10, -20, 40, 57.5f, 44.2f);
+    paths[0].lineTo(30.7f, 20.2f);
+    paths[0].quadTo(5, 45, 3.3f, 2.1f);
+    // Small, so it is supersampled into a mask of its own.
+    paths[1].addCircle(20.3f, 15.6f, 6.2f);
+    // Covers everything but a rect.
+    paths[2].addRect(SkRect::MakeLTRB(10.5f, 8.25f, 40.75f, 30.5f));
+    paths[2].setFillType(SkPath::kInverseWinding_FillType);
+}
+
+static SkMask mask_of(const SkBitmap& bm) {
+    SkMask mask;
+    mask.fImage = static_cast<uint8_t*>(bm.getPixels());
+    mask.fBounds.set(0, 0, bm.width(), bm.height());
+    mask.fRowBytes = SkToU32(bm.rowBytes());
+    mask.fFormat = SkMask::kA8_Format;
+    return mask;
+}
+
+DEF_TEST(CoverageMask_Replace, reporter) {
+    SkPath paths[3];
+    make_paths(paths);
+    SkMatrix matrix;
+    matrix.setRotate(10, 30, 20);
+    matrix.postTranslate(0.4f, -0.3f);
+    const SkIRect clip = SkIRect::MakeLTRB(2, 3, W - 2, H - 5);
+
+    for (int i = 0; i < 3; ++i) {
+        for (int aa = 0; aa < 2; ++aa) {
+            // The coverage a paint draws with into a cleared A8 bitmap.
+            SkBitmap expected;
+            expected.allocPixels(SkImageInfo::MakeA8(W, H));
+            expected.eraseColor(SK_ColorTRANSPARENT);
+            {
+                SkCanvas canvas(expected);
+                canvas.clipRect(SkRect::Make(clip));
+                canvas.concat(matrix);
+                SkPaint paint;
+                paint.setAntiAlias(SkToBool(aa));
+                canvas.drawPath(paths[i], paint);
+            }
+
+            SkBitmap actual;
+            actual.allocPixels(SkImageInfo::MakeA8(W, H));
+            actual.eraseColor(SK_ColorTRANSPARENT);
+            SkCoverageMask::Fill(paths[i], matrix, clip, SkToBool(aa),
+                                 SkCoverageMask::kReplace_Op, mask_of(actual));
+
+            SkMask created;
+            REPORTER_ASSERT(reporter, SkCoverageMask::Create(paths[i], matrix, clip,
+                                                             SkToBool(aa), &created));
+            REPORTER_ASSERT(reporter, clip.contains(created.fBounds));
+
+            for (int y = 0; y < H; ++y) {
+                for (int x = 0; x < W; ++x) {
+                    const uint8_t want = *expected.getAddr8(x, y);
+                    REPORTER_ASSERT(reporter, want == *actual.getAddr8(x, y));
+                    const uint8_t got = created.fBounds.contains(x, y) ?
+                                        *created.getAddr8(x, y) : 0;
+                    REPORTER_ASSERT(reporter, want == got);
+                }
+            }
+            SkMask::FreeImage(created.fImage);
+        }
+    }
+
+    // Nothing in the clip.
+    SkMask empty;
+    REPORTER_ASSERT(reporter, !SkCoverageMask::Create(paths[0], matrix,
+                                                      SkIRect::MakeLTRB(100, 100, 200, 200),
+                                                      true, &empty));
+    REPORTER_ASSERT(reporter, NULL == empty.fImage);
+}
+
+DEF_TEST(CoverageMask_Union, reporter) {
+    SkPath paths[3];
+    make_paths(paths);
+    const SkIRect clip = SkIRect::MakeWH(W, H);
+
+    // Each path's coverage alone, and all of them accumulated.
+    SkBitmap single[3];
+    SkBitmap accumulated;
+    accumulated.allocPixels(SkImageInfo::MakeA8(W, H));
+    accumulated.eraseColor(SK_ColorTRANSPARENT);
+    for (int i = 0; i < 3; ++i) {
+        single[i].allocPixels(SkImageInfo::MakeA8(W, H));
+        single[i].eraseColor(SK_ColorTRANSPARENT);
+        SkCoverageMask::Fill(paths[i], SkMatrix::I(), clip, true,
+                             SkCoverageMask::kReplace_Op, mask_of(single[i]));
+        SkCoverageMask::Fill(paths[i], SkMatrix::I(), clip, true,
+                             SkCoverageMask::kUnion_Op, mask_of(accumulated));
+    }
+
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            unsigned want = 0;
+            for (int i = 0; i < 3; ++i) {
+                const unsigned c = *single[i].getAddr8(x, y);
+                want = c + SkMulDiv255Round(want, 255 - c);
+            }
+            REPORTER_ASSERT(reporter, want == *accumulated.getAddr8(x, y));
+        }
+    }
+}
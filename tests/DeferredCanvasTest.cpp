@@ -816,6 +816,66 @@ static void TestDeferredCanvasCreateCompatibleDevice(skiatest::Reporter* reporte
     REPORTER_ASSERT(reporter, notificationCounter.fStorageAllocatedChangedCount == 1);
 }
 
+static void draw_threaded_frame(SkDeferredCanvas* canvas, const SkBitmap& sprite, int frame) {
+    SkPaint paint;
+    for (int i = 0; i < 200; ++i) {
+        paint.setColor(SkColorSetARGB(0x80, (i * 7 + frame) & 0xFF, i & 0xFF, frame & 0xFF));
+        canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar((i * 13) % 48),
+                                          SkIntToScalar((i * 29 + frame) % 48),
+                                          SkIntToScalar(16), SkIntToScalar(16)), paint);
+    }
+    // Bitmaps go through the heap shared with the playback thread.
+    canvas->drawBitmap(sprite, SkIntToScalar(frame % 32), SkIntToScalar(8), NULL);
+}
+
+static void TestDeferredCanvasThreadedPlayback(skiatest::Reporter* reporter) {
+    static const int kSize = 64;
+    static const int kFrames = 20;
+    SkBitmap sprite;
+    sprite.allocN32Pixels(24, 24);
+    sprite.eraseColor(0xFF00FF00);
+    sprite.setImmutable();
+
+    SkAutoTUnref<SkSurface> expectedSurface(SkSurface::NewRasterPMColor(kSize, kSize));
+    SkAutoTUnref<SkDeferredCanvas> expected(SkDeferredCanvas::Create(expectedSurface.get()));
+    SkAutoTUnref<SkSurface> surface(SkSurface::NewRasterPMColor(kSize, kSize));
+    SkAutoTUnref<SkDeferredCanvas> canvas(SkDeferredCanvas::Create(surface.get()));
+    REPORTER_ASSERT(reporter, canvas->setThreadedPlayback(true));
+    // Small enough that some of the frames are submitted by the limit.
+    canvas->setMaxRecordingStorage(16 * 1024);
+
+    expected->clear(SK_ColorWHITE);
+    canvas->clear(SK_ColorWHITE);
+    SkDeferredCanvas::Fence previous = canvas->insertFence();
+    for (int frame = 0; frame < kFrames; ++frame) {
+        draw_threaded_frame(expected, sprite, frame);
+        draw_threaded_frame(canvas, sprite, frame);
+        SkDeferredCanvas::Fence fence = canvas->insertFence();
+        // Wait for the frame before the one just submitted, as a double-buffered client would.
+        canvas->waitForFence(previous);
+        REPORTER_ASSERT(reporter, canvas->isFencePassed(previous));
+        previous = fence;
+    }
+    canvas->waitForFence(previous);
+    REPORTER_ASSERT(reporter, canvas->isFencePassed(previous));
+    REPORTER_ASSERT(reporter, !canvas->hasPendingCommands());
+
+    SkBitmap expectedPixels, pixels;
+    expectedPixels.allocN32Pixels(kSize, kSize);
+    pixels.allocN32Pixels(kSize, kSize);
+    REPORTER_ASSERT(reporter, expected->readPixels(&expectedPixels, 0, 0));
+    REPORTER_ASSERT(reporter, canvas->readPixels(&pixels, 0, 0));
+    REPORTER_ASSERT(reporter, 0 == memcmp(expectedPixels.getPixels(), pixels.getPixels(),
+                                          pixels.getSize()));
+
+    // Turning it off again plays back on the calling thread.
+    draw_threaded_frame(canvas, sprite, kFrames);
+    REPORTER_ASSERT(reporter, canvas->setThreadedPlayback(false));
+    SkDeferredCanvas::Fence fence = canvas->insertFence();
+    REPORTER_ASSERT(reporter, canvas->isFencePassed(fence));
+    REPORTER_ASSERT(reporter, !canvas->hasPendingCommands());
+}
+
 DEF_TEST(DeferredCanvas_CPU, reporter) {
     TestDeferredCanvasBitmapAccess(reporter);
     TestDeferredCanvasFlush(reporter);
@@ -830,6 +890,7 @@ DEF_TEST(DeferredCanvas_CPU, reporter) {
     TestDeferredCanvasWritePixelsToSurface(reporter);
     TestDeferredCanvasSurface(reporter, NULL);
     TestDeferredCanvasSetSurface(reporter, NULL);
+    TestDeferredCanvasThreadedPlayback(reporter);
 }
 
 DEF_GPUTEST(DeferredCanvas_GPU, reporter, factory) {
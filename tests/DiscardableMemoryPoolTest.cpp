@@ -33,3 +33,51 @@ DEF_TEST(DiscardableMemoryPool, reporter) {
     REPORTER_ASSERT(reporter, !dm2->lock());
     REPORTER_ASSERT(reporter, 0 == pool->getRAMUsed());
 }
+
+static void count_purge(SkDiscardableMemoryPool::MemoryPressure pressure, void* context) {
+    int* counts = static_cast<int*>(context);
+    ++counts[pressure];
+}
+
+DEF_TEST(DiscardableMemoryPool_MemoryPressure, reporter) {
+    SkAutoTUnref<SkDiscardableMemoryPool> pool(
+        SkDiscardableMemoryPool::Create(1000, NULL));
+    int counts[2] = { 0, 0 };
+    pool->addPurgeCallback(count_purge, counts);
+
+    SkAutoTDelete<SkDiscardableMemory> dm1(pool->createForClient(100, "a"));
+    SkAutoTDelete<SkDiscardableMemory> dm2(pool->createForClient(100, "b"));
+    SkAutoTDelete<SkDiscardableMemory> dm3(pool->create(200));
+    REPORTER_ASSERT(reporter, 100 == pool->getClientRAMUsed("a"));
+    REPORTER_ASSERT(reporter, 100 == pool->getClientRAMUsed("b"));
+    REPORTER_ASSERT(reporter, 200 == pool->getClientRAMUsed(NULL));
+    REPORTER_ASSERT(reporter, 0 == pool->getClientRAMUsed("c"));
+    dm1->unlock();
+    dm2->unlock();
+    dm3->unlock();
+
+    // Moderate pressure purges the least recently used half.
+    pool->handleMemoryPressure(SkDiscardableMemoryPool::kModerate_MemoryPressure);
+    REPORTER_ASSERT(reporter, 200 == pool->getRAMUsed());
+    REPORTER_ASSERT(reporter, 0 == pool->getClientRAMUsed("a"));
+    REPORTER_ASSERT(reporter, 0 == pool->getClientRAMUsed("b"));
+    REPORTER_ASSERT(reporter, 200 == pool->getClientRAMUsed(NULL));
+    REPORTER_ASSERT(reporter, !dm1->lock());
+    REPORTER_ASSERT(reporter, 1 == counts[SkDiscardableMemoryPool::kModerate_MemoryPressure]);
+
+    // Critical pressure purges everything unlocked.
+    pool->handleMemoryPressure(SkDiscardableMemoryPool::kCritical_MemoryPressure);
+    REPORTER_ASSERT(reporter, 0 == pool->getRAMUsed());
+    REPORTER_ASSERT(reporter, !dm3->lock());
+    REPORTER_ASSERT(reporter, 1 == counts[SkDiscardableMemoryPool::kCritical_MemoryPressure]);
+
+    pool->removePurgeCallback(count_purge, counts);
+    pool->handleMemoryPressure(SkDiscardableMemoryPool::kCritical_MemoryPressure);
+    REPORTER_ASSERT(reporter, 1 == counts[SkDiscardableMemoryPool::kCritical_MemoryPressure]);
+
+    #if SK_LAZY_CACHE_STATS
+    REPORTER_ASSERT(reporter, 3 == pool->getCachePurges());
+    pool->resetCacheHitsAndMisses();
+    REPORTER_ASSERT(reporter, 0 == pool->getCachePurges());
+    #endif
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDistanceFieldGen.h"
+#include "SkPoint.h"
+#include "SkRect.h"
+#include "SkTemplates.h"
+#include "Test.h"
+
+static const int kWidth = 37;
+static const int kHeight = 23;
+static const int kDFWidth = kWidth + 2*SK_DistanceFieldPad;
+static const int kDFHeight = kHeight + 2*SK_DistanceFieldPad;
+
+// signed distance from (x, y) to the edge of 'rect', negative inside
+static float rect_distance(const SkRect& rect, float x, float y) {
+    float dx = SkTMax(rect.fLeft - x, x - rect.fRight);
+    float dy = SkTMax(rect.fTop - y, y - rect.fBottom);
+    if (dx < 0 && dy < 0) {
+        return SkTMax(dx, dy);
+    }
+    return SkPoint::Length(SkTMax(dx, 0.0f), SkTMax(dy, 0.0f));
+}
+
+static unsigned char expected_value(float dist) {
+    const float magnitude = (float)SK_DistanceFieldMagnitude;
+    if (dist <= -magnitude) {
+        return 255;
+    } else if (dist > magnitude) {
+        return 0;
+    }
+    return (unsigned char)((magnitude - dist)*128.0f/magnitude);
+}
+
+DEF_TEST(DistanceField, reporter) {
+    const SkIRect rect = SkIRect::MakeLTRB(6, 5, 29, 17);
+    unsigned char a8[kWidth*kHeight];
+    unsigned char bw[((kWidth + 7)/8)*kHeight];
+    const int bwRowBytes = (kWidth + 7)/8;
+    sk_bzero(bw, sizeof(bw));
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            bool in = rect.contains(x, y);
+            a8[y*kWidth + x] = in ? 0xFF : 0;
+            if (in) {
+                bw[y*bwRowBytes + x/8] |= 0x80 >> (x % 8);
+            }
+        }
+    }
+
+    unsigned char fromA8[kDFWidth*kDFHeight];
+    unsigned char fromBW[kDFWidth*kDFHeight];
+    REPORTER_ASSERT(reporter, SkGenerateDistanceFieldFromA8Image(fromA8, a8,
+                                                                  kWidth, kHeight, kWidth));
+    REPORTER_ASSERT(reporter, SkGenerateDistanceFieldFromBWImage(fromBW, bw,
+                                                                  kWidth, kHeight, bwRowBytes));
+    REPORTER_ASSERT(reporter, 0 == memcmp(fromA8, fromBW, sizeof(fromA8)));
+
+    // Every texel, including those past the corners, should be close to the true distance
+    // from its center to the rect. The initial estimate at the edge texels is least accurate
+    // right at the corners, where it is off by about 0.2 texels.
+    SkRect bounds = SkRect::Make(rect);
+    bounds.offset(SK_DistanceFieldPad, SK_DistanceFieldPad);
+    int maxError = 0;
+    for (int y = 0; y < kDFHeight; ++y) {
+        for (int x = 0; x < kDFWidth; ++x) {
+            float dist = rect_distance(bounds, x + 0.5f, y + 0.5f);
+            int error = SkAbs32(fromA8[y*kDFWidth + x] - expected_value(dist));
+            maxError = SkTMax(maxError, error);
+        }
+    }
+    REPORTER_ASSERT(reporter, maxError <= 6);
+}
@@ -7,7 +7,9 @@
 
 #include "SkBitmap.h"
 #include "SkCanvas.h"
+#include "SkColorPriv.h"
 #include "SkDashPathEffect.h"
+#include "SkRRect.h"
 #include "SkSurface.h"
 #include "Test.h"
 
@@ -275,6 +277,221 @@ static void test_crbug_165432(skiatest::Reporter* reporter) {
     REPORTER_ASSERT(reporter, filteredPath.isEmpty());
 }
 
+// Dashed hairlines are drawn a dash at a time, without building the dashed
+// path. They should hit the same pixels as the dashed path does.
+static void test_dashed_hairlines(skiatest::Reporter* reporter) {
+    SkPath path;
+    path.moveTo(-20.5f, 10.25f);
+    path.lineTo(90.75f, 60.5f);
+    path.lineTo(30, 95.125f);
+    path.moveTo(5, 5);
+    path.lineTo(95, 7.5f);
+
+    SkScalar intervals[] = { 4.5f, 2.25f, 1, 3 };
+    SkAutoTUnref<SkDashPathEffect> dash(SkDashPathEffect::Create(intervals, 4, 1.5f));
+
+    for (int aa = 0; aa < 2; ++aa) {
+        SkPaint paint;
+        paint.setStyle(SkPaint::kStroke_Style);
+        paint.setAntiAlias(SkToBool(aa));
+        paint.setPathEffect(dash);
+
+        SkPath dashedPath;
+        REPORTER_ASSERT(reporter, !paint.getFillPath(path, &dashedPath));
+        SkPaint hairPaint(paint);
+        hairPaint.setPathEffect(NULL);
+
+        SkBitmap dashed, expected;
+        dashed.allocN32Pixels(100, 100);
+        expected.allocN32Pixels(100, 100);
+        dashed.eraseColor(SK_ColorWHITE);
+        expected.eraseColor(SK_ColorWHITE);
+        SkCanvas dashedCanvas(dashed);
+        SkCanvas expectedCanvas(expected);
+        dashedCanvas.rotate(5);
+        expectedCanvas.rotate(5);
+        dashedCanvas.drawPath(path, paint);
+        expectedCanvas.drawPath(dashedPath, hairPaint);
+
+        SkAutoLockPixels alp0(dashed), alp1(expected);
+        REPORTER_ASSERT(reporter, 0 == memcmp(dashed.getPixels(), expected.getPixels(),
+                                              dashed.getSize()));
+    }
+}
+
+// Antialiased ovals and simple rrects are scan converted analytically rather
+// than as paths. They should cover about the same pixels, and respect the clip.
+static void test_analytic_rrects(skiatest::Reporter* reporter) {
+    static const SkRect kRects[] = {
+        { 10.3f, 20.7f, 150.2f, 120.1f },
+        { 5, 5, 105, 105 },
+        { -50, -20, 400, 230 },
+    };
+    static const SkScalar kScales[] = { 1, 1.3f };
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kRects); ++i) {
+        for (int type = 0; type < 3; ++type) {
+            for (size_t s = 0; s < SK_ARRAY_COUNT(kScales); ++s) {
+                SkRRect rrect;
+                if (0 == type) {
+                    rrect.setOval(kRects[i]);
+                } else if (1 == type) {
+                    rrect.setRectXY(kRects[i], 12, 12);
+                } else {
+                    rrect.setRectXY(kRects[i], 20.5f, 7);
+                }
+                SkPath path;
+                path.addRRect(rrect);
+
+                SkPaint paint;
+                paint.setAntiAlias(true);
+
+                SkBitmap analytic, expected;
+                analytic.allocN32Pixels(300, 200);
+                expected.allocN32Pixels(300, 200);
+                analytic.eraseColor(0);
+                expected.eraseColor(0);
+                SkCanvas analyticCanvas(analytic);
+                SkCanvas expectedCanvas(expected);
+                analyticCanvas.scale(kScales[s], 1);
+                expectedCanvas.scale(kScales[s], 1);
+                analyticCanvas.drawRRect(rrect, paint);
+                expectedCanvas.drawPath(path, paint);
+
+                SkAutoLockPixels alp0(analytic), alp1(expected);
+                int maxDiff = 0;
+                int64_t analyticSum = 0, expectedSum = 0;
+                for (int y = 0; y < 200; ++y) {
+                    for (int x = 0; x < 300; ++x) {
+                        int a = SkGetPackedA32(*analytic.getAddr32(x, y));
+                        int e = SkGetPackedA32(*expected.getAddr32(x, y));
+                        maxDiff = SkMax32(maxDiff, SkAbs32(a - e));
+                        analyticSum += a;
+                        expectedSum += e;
+                    }
+                }
+                // The path is flattened, so its edge pixels can be off by a quarter.
+                REPORTER_ASSERT(reporter, maxDiff <= 80);
+                REPORTER_ASSERT(reporter, SkTAbs(analyticSum - expectedSum) * 200 <= expectedSum);
+            }
+        }
+    }
+
+    // With a clip that isn't a rect, nothing is drawn outside of it.
+    SkBitmap clipped;
+    clipped.allocN32Pixels(100, 100);
+    clipped.eraseColor(0);
+    SkCanvas canvas(clipped);
+    SkRegion clip;
+    clip.setRect(0, 0, 50, 50);
+    clip.op(SkIRect::MakeLTRB(50, 50, 100, 100), SkRegion::kUnion_Op);
+    canvas.clipRegion(clip);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    canvas.drawOval(SkRect::MakeLTRB(10.5f, 10.5f, 90.5f, 90.5f), paint);
+
+    SkAutoLockPixels alp(clipped);
+    REPORTER_ASSERT(reporter, 0 != *clipped.getAddr32(30, 30));
+    REPORTER_ASSERT(reporter, 0 != *clipped.getAddr32(70, 70));
+    for (int y = 0; y < 100; ++y) {
+        for (int x = 0; x < 100; ++x) {
+            if (!clip.contains(x, y)) {
+                REPORTER_ASSERT(reporter, 0 == *clipped.getAddr32(x, y));
+            }
+        }
+    }
+}
+
+// Contours and curves wholly outside the clip are culled before they are
+// chopped or flattened. Those to the side still add their winding.
+static void test_offscreen_contours(skiatest::Reporter* reporter) {
+    SkPath visible;
+    visible.moveTo(10, 10);
+    visible.cubicTo(90, 0, 110, 60, 50, 90);
+    visible.quadTo(0, 60, 10, 10);
+
+    // A contour around the whole view, whose curves are all off to the sides,
+    // above or below, and contours that are entirely out of view.
+    SkPath path(visible);
+    path.moveTo(-50, -50);
+    path.quadTo(50, -90, 150, -50);
+    path.cubicTo(190, 0, 250, 100, 150, 150);
+    path.conicTo(50, 190, -50, 150, 0.5f);
+    path.cubicTo(-90, 100, -10, 0, -50, -50);
+    path.moveTo(-300, 20);
+    path.cubicTo(-200, -40, -150, 200, -300, 80);
+    path.moveTo(30, 500);
+    path.quadTo(200, 400, 60, 700);
+
+    SkPath expected(visible);
+    expected.addRect(-50, -50, 150, 150);
+
+    for (int evenOdd = 0; evenOdd < 2; ++evenOdd) {
+        for (int aa = 0; aa < 2; ++aa) {
+            SkPath::FillType fillType = evenOdd ? SkPath::kEvenOdd_FillType
+                                                : SkPath::kWinding_FillType;
+            path.setFillType(fillType);
+            expected.setFillType(fillType);
+            SkPaint paint;
+            paint.setAntiAlias(SkToBool(aa));
+
+            SkBitmap culled, reference;
+            culled.allocN32Pixels(100, 100);
+            reference.allocN32Pixels(100, 100);
+            culled.eraseColor(0);
+            reference.eraseColor(0);
+            SkCanvas(culled).drawPath(path, paint);
+            SkCanvas(reference).drawPath(expected, paint);
+
+            SkAutoLockPixels alp0(culled), alp1(reference);
+            REPORTER_ASSERT(reporter, 0 == memcmp(culled.getPixels(), reference.getPixels(),
+                                                  culled.getSize()));
+        }
+    }
+}
+
+// Hairline polylines and line arrays are clipped and blitted as one batch,
+// which must draw the same pixels as their segments one at a time.
+static void test_hairline_batches(skiatest::Reporter* reporter) {
+    SkPoint pts[64];
+    for (int i = 0; i < (int)SK_ARRAY_COUNT(pts); ++i) {
+        // Mostly shallow segments, with a few steep ones and some off canvas.
+        pts[i].set(i * 2.3f - 10, 50 + 45 * SkScalarSin(i * 0.3f) + (i % 7) * 1.7f);
+    }
+
+    SkRegion clip;
+    clip.setRect(0, 0, 60, 60);
+    clip.op(SkIRect::MakeLTRB(40, 40, 100, 100), SkRegion::kUnion_Op);
+
+    for (int aa = 0; aa < 2; ++aa) {
+        SkPaint paint;
+        paint.setAntiAlias(SkToBool(aa));
+        paint.setColor(0xFF3060C0);
+
+        SkBitmap batched, reference;
+        batched.allocN32Pixels(100, 100);
+        reference.allocN32Pixels(100, 100);
+        batched.eraseColor(0);
+        reference.eraseColor(0);
+        {
+            SkCanvas canvas(batched);
+            canvas.clipRegion(clip);
+            canvas.drawPoints(SkCanvas::kPolygon_PointMode, SK_ARRAY_COUNT(pts), pts, paint);
+        }
+        {
+            SkCanvas canvas(reference);
+            canvas.clipRegion(clip);
+            for (int i = 0; i < (int)SK_ARRAY_COUNT(pts) - 1; ++i) {
+                canvas.drawLine(pts[i].fX, pts[i].fY, pts[i + 1].fX, pts[i + 1].fY, paint);
+            }
+        }
+
+        SkAutoLockPixels alp0(batched), alp1(reference);
+        REPORTER_ASSERT(reporter, 0 == memcmp(batched.getPixels(), reference.getPixels(),
+                                              batched.getSize()));
+    }
+}
+
 DEF_TEST(DrawPath, reporter) {
     test_giantaa();
     test_bug533();
@@ -288,4 +505,8 @@ DEF_TEST(DrawPath, reporter) {
     test_infinite_dash(reporter);
     test_crbug_165432(reporter);
     test_big_aa_rect(reporter);
+    test_dashed_hairlines(reporter);
+    test_analytic_rrects(reporter);
+    test_offscreen_contours(reporter);
+    test_hairline_batches(reporter);
 }
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkData.h"
+#include "SkRingBufferEventTracer.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkTraceEvent.h"
+#include "Test.h"
+
+static SkString write_json(const SkRingBufferEventTracer& tracer) {
+    SkDynamicMemoryWStream stream;
+    tracer.writeJSON(&stream);
+    SkAutoTUnref<SkData> data(stream.copyToData());
+    return SkString(static_cast<const char*>(data->data()), data->size());
+}
+
+static int count_occurrences(const SkString& str, const char* substring) {
+    int count = 0;
+    for (const char* s = strstr(str.c_str(), substring); NULL != s; s = strstr(s + 1, substring)) {
+        ++count;
+    }
+    return count;
+}
+
+static const char* gNames[] = { "zero", "one", "two", "three", "four", "five", "six" };
+
+// The tracer is used directly, rather than installed, so that the test does not change what
+// the rest of Skia traces into.
+DEF_TEST(EventTracer_RingBuffer, reporter) {
+    SkRingBufferEventTracer tracer(4);
+    const uint8_t* category = tracer.getCategoryGroupEnabled("test");
+    const uint8_t* disabled = tracer.getCategoryGroupEnabled(TRACE_DISABLED_BY_DEFAULT("test"));
+    REPORTER_ASSERT(reporter, 0 == *category);
+    REPORTER_ASSERT(reporter, category == tracer.getCategoryGroupEnabled("test"));
+    REPORTER_ASSERT(reporter, 0 == strcmp("test", tracer.getCategoryGroupName(category)));
+
+    tracer.setEnabled(true);
+    REPORTER_ASSERT(reporter, 0 != *category);
+    REPORTER_ASSERT(reporter, 0 == *disabled);
+
+    // Only the last four events are kept: four, five, six and the instant one below.
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gNames); ++i) {
+        SkEventTracer::Handle handle = tracer.addTraceEvent(TRACE_EVENT_PHASE_COMPLETE, category,
+                                                            gNames[i], 0, 0, NULL, NULL, NULL,
+                                                            TRACE_EVENT_FLAG_NONE);
+        REPORTER_ASSERT(reporter, 0 != handle);
+        tracer.updateTraceEventDuration(category, gNames[i], handle);
+    }
+
+    const char* argNames[] = { "count", "label" };
+    const uint8_t argTypes[] = { TRACE_VALUE_TYPE_INT, TRACE_VALUE_TYPE_STRING };
+    const uint64_t argValues[] = { static_cast<uint64_t>(-3),
+                                   static_cast<uint64_t>(reinterpret_cast<uintptr_t>("a\"b")) };
+    tracer.addTraceEvent(TRACE_EVENT_PHASE_INSTANT, category, "instant", 0, 2,
+                         argNames, argTypes, argValues, TRACE_EVENT_FLAG_NONE);
+    tracer.setEnabled(false);
+    REPORTER_ASSERT(reporter, 0 == *category);
+
+    SkString json = write_json(tracer);
+    REPORTER_ASSERT(reporter, json.startsWith("{\"traceEvents\":["));
+    REPORTER_ASSERT(reporter, json.endsWith("]}\n"));
+    REPORTER_ASSERT(reporter, NULL == strstr(json.c_str(), "\"three\""));
+    REPORTER_ASSERT(reporter, NULL != strstr(json.c_str(), "\"four\""));
+    REPORTER_ASSERT(reporter, NULL != strstr(json.c_str(), "\"six\""));
+    REPORTER_ASSERT(reporter, 3 == count_occurrences(json, "\"dur\":"));
+    REPORTER_ASSERT(reporter, 4 == count_occurrences(json, "\"cat\":\"test\""));
+    REPORTER_ASSERT(reporter, NULL != strstr(json.c_str(),
+                                             "\"args\":{\"count\":-3,\"label\":\"a\\\"b\"}"));
+}
@@ -97,3 +97,46 @@ DEF_TEST(Flate, reporter) {
     TestFlate(reporter, &fileStream, 10240);
 #endif
 }
+
+DEF_TEST(Flate_DeflateWStream, reporter) {
+#if defined(SK_ZLIB_INCLUDE) && !defined(SK_DEBUG)
+    SkDeflateWStream deflater(SkDeflateWStream::kSmallest_Level,
+                              SkDeflateWStream::kFiltered_Strategy);
+    // Each stream is independent of those before it, and of how it is
+    // written: in one piece, or byte by byte.
+    static const size_t kSizes[] = { 0, 1, 700, 20000, 700 };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kSizes); ++i) {
+        const size_t size = kSizes[i];
+        SkAutoTMalloc<uint8_t> data(size);
+        for (size_t j = 0; j < size; ++j) {
+            data[j] = (uint8_t)((j / 7) ^ (j % 13));
+        }
+
+        SkDynamicMemoryWStream compressed;
+        deflater.reset(&compressed);
+        if (i & 1) {
+            for (size_t j = 0; j < size; ++j) {
+                REPORTER_ASSERT(reporter, deflater.write(&data[j], 1));
+            }
+        } else {
+            REPORTER_ASSERT(reporter, deflater.write(data.get(), size));
+        }
+        REPORTER_ASSERT(reporter, size == deflater.bytesWritten());
+        REPORTER_ASSERT(reporter, deflater.finish());
+
+        SkAutoTUnref<SkData> compressedData(compressed.copyToData());
+        SkMemoryStream compressedStream(compressedData);
+        SkDynamicMemoryWStream uncompressed;
+        REPORTER_ASSERT(reporter,
+                        SkFlate::Inflate(&compressedStream, &uncompressed));
+        SkAutoTUnref<SkData> uncompressedData(uncompressed.copyToData());
+        REPORTER_ASSERT(reporter, size == uncompressedData->size());
+        REPORTER_ASSERT(reporter,
+                        0 == memcmp(data.get(), uncompressedData->data(), size));
+    }
+
+    // Nothing is written once the stream is finished.
+    REPORTER_ASSERT(reporter, !deflater.write("x", 1));
+    REPORTER_ASSERT(reporter, !deflater.finish());
+#endif
+}
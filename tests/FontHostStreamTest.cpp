@@ -10,6 +10,7 @@
 #include "SkColor.h"
 #include "SkFontHost.h"
 #include "SkGraphics.h"
+#include "SkOSFile.h"
 #include "SkPaint.h"
 #include "SkPoint.h"
 #include "SkRect.h"
@@ -108,3 +109,72 @@ DEF_TEST(FontHostStream, reporter) {
     //Make sure the typeface is deleted and removed.
     SkGraphics::PurgeFontCache();
 }
+
+#if defined(SK_BUILD_FOR_ANDROID) || defined(SK_BUILD_FOR_UNIX)
+// Defined in SkFontHost_FreeType.cpp.
+SkStream* open_shared_font_file(const char path[]);
+
+DEF_TEST(FontHostStream_SharedFile, reporter) {
+    SkString resourcePath = skiatest::Test::GetResourcePath();
+    if (resourcePath.isEmpty()) {
+        SkDebugf("Could not run FontHostStream_SharedFile test because resourcePath not "
+                 "specified.");
+        return;
+    }
+    SkString filename = SkOSPath::SkPathJoin(resourcePath.c_str(), "Funkster.ttf");
+
+    SkAutoTUnref<SkStream> stream1(open_shared_font_file(filename.c_str()));
+    SkAutoTUnref<SkStream> stream2(open_shared_font_file(filename.c_str()));
+    if (NULL == stream1.get() || NULL == stream2.get()) {
+        SkDebugf("Could not run FontHostStream_SharedFile test because Funkster.ttf not found.");
+        return;
+    }
+    // Both streams read the one mapping of the file.
+    REPORTER_ASSERT(reporter, NULL != stream1->getMemoryBase());
+    REPORTER_ASSERT(reporter, stream1->getMemoryBase() == stream2->getMemoryBase());
+    REPORTER_ASSERT(reporter, stream1->getLength() == stream2->getLength());
+
+    SkAutoTUnref<SkTypeface> face1(SkTypeface::CreateFromStream(stream1));
+    SkAutoTUnref<SkTypeface> face2(SkTypeface::CreateFromStream(stream2));
+    if (NULL == face1.get() || NULL == face2.get()) {
+        SkDebugf("Could not run FontHostStream_SharedFile test because no font host reads "
+                 "Funkster.ttf.");
+        return;
+    }
+
+    // The typefaces sharing the mapping draw the same glyphs.
+    SkIRect rect = SkIRect::MakeWH(64, 64);
+    SkBitmap bitmap1, bitmap2;
+    create(&bitmap1, rect);
+    create(&bitmap2, rect);
+    SkCanvas canvas1(bitmap1);
+    SkCanvas canvas2(bitmap2);
+
+    SkPaint paint;
+    paint.setColor(SK_ColorGRAY);
+    paint.setTextSize(SkIntToScalar(30));
+
+    paint.setTypeface(face1);
+    drawBG(&canvas1);
+    canvas1.drawText("Ag", 2, 8, 40, paint);
+
+    paint.setTypeface(face2);
+    drawBG(&canvas2);
+    canvas2.drawText("Ag", 2, 8, 40, paint);
+
+    REPORTER_ASSERT(reporter, compare(bitmap1, rect, bitmap2, rect));
+
+    // Something was drawn, so the comparison means something.
+    bool drew = false;
+    for (int y = 0; y < bitmap1.height() && !drew; ++y) {
+        for (int x = 0; x < bitmap1.width() && !drew; ++x) {
+            drew = bitmap1.getColor(x, y) != bgColor;
+        }
+    }
+    REPORTER_ASSERT(reporter, drew);
+
+    face1.reset(NULL);
+    face2.reset(NULL);
+    SkGraphics::PurgeFontCache();
+}
+#endif  // SK_BUILD_FOR_ANDROID || SK_BUILD_FOR_UNIX
@@ -33,6 +33,58 @@ static void testChopCubic(skiatest::Reporter* reporter) {
     }
 }
 
+// Flattening with the returned shift must stay within the tolerance, and the
+// uniform evaluators must agree with SkEvalQuadAt and SkEvalCubicAt.
+static void test_flatten(skiatest::Reporter* reporter) {
+    const SkScalar tol = SK_ScalarHalf;
+    const SkPoint quad[] = { { 0, 0 }, { 300, 40 }, { 10, 200 } };
+    const SkPoint cubic[] = { { 0, 0 }, { 400, 0 }, { -200, 300 }, { 200, 300 } };
+    const SkPoint line[] = { { 0, 0 }, { 10, 10 }, { 20, 20 }, { 30, 30 } };
+
+    REPORTER_ASSERT(reporter, 0 == SkQuadSubdivisionShift(line, tol, 10));
+    REPORTER_ASSERT(reporter, 0 == SkCubicSubdivisionShift(line, tol, 10));
+    REPORTER_ASSERT(reporter, 2 == SkCubicSubdivisionShift(cubic, tol, 2));
+    REPORTER_ASSERT(reporter, 1 == SkQuadSubdivisionCount(line, tol, 1024));
+    REPORTER_ASSERT(reporter, 4 == SkCubicSubdivisionCount(cubic, tol, 4));
+
+    // The power of two is the next one up from the count.
+    int quadCount = SkQuadSubdivisionCount(quad, tol, 1024);
+    int quadShift = SkQuadSubdivisionShift(quad, tol, 10);
+    REPORTER_ASSERT(reporter, quadCount <= (1 << quadShift) && (1 << quadShift) < 2 * quadCount);
+
+    SkPoint pts[1 << 10];
+    int count = 1 << SkQuadSubdivisionShift(quad, tol, 10);
+    SkEvalQuadUniform(quad, count, pts);
+    REPORTER_ASSERT(reporter, pts[count - 1] == quad[2]);
+    for (int i = 0; i < count; ++i) {
+        SkPoint expected;
+        SkEvalQuadAt(quad, SkIntToScalar(i + 1) / count, &expected);
+        REPORTER_ASSERT(reporter, SkPoint::Distance(expected, pts[i]) < SK_Scalar1 / 1000);
+
+        // The middle of each chord must be close to the curve.
+        SkPoint mid;
+        SkEvalQuadAt(quad, (i + SK_ScalarHalf) / count, &mid);
+        const SkPoint& start = i ? pts[i - 1] : quad[0];
+        SkPoint chordMid = { SkScalarAve(start.fX, pts[i].fX), SkScalarAve(start.fY, pts[i].fY) };
+        REPORTER_ASSERT(reporter, SkPoint::Distance(mid, chordMid) <= tol);
+    }
+
+    count = 1 << SkCubicSubdivisionShift(cubic, tol, 10);
+    SkEvalCubicUniform(cubic, count, pts);
+    REPORTER_ASSERT(reporter, pts[count - 1] == cubic[3]);
+    for (int i = 0; i < count; ++i) {
+        SkPoint expected;
+        SkEvalCubicAt(cubic, SkIntToScalar(i + 1) / count, &expected, NULL, NULL);
+        REPORTER_ASSERT(reporter, SkPoint::Distance(expected, pts[i]) < SK_Scalar1 / 1000);
+
+        SkPoint mid;
+        SkEvalCubicAt(cubic, (i + SK_ScalarHalf) / count, &mid, NULL, NULL);
+        const SkPoint& start = i ? pts[i - 1] : cubic[0];
+        SkPoint chordMid = { SkScalarAve(start.fX, pts[i].fX), SkScalarAve(start.fY, pts[i].fY) };
+        REPORTER_ASSERT(reporter, SkPoint::Distance(mid, chordMid) <= tol);
+    }
+}
+
 DEF_TEST(Geometry, reporter) {
     SkPoint pts[3], dst[5];
 
@@ -58,4 +110,5 @@ DEF_TEST(Geometry, reporter) {
     }
 
     testChopCubic(reporter);
+    test_flatten(reporter);
 }
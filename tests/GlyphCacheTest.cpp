@@ -0,0 +1,203 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkGlyphCache.h"
+#include "SkGraphics.h"
+#include "SkTaskGroup.h"
+#include "Test.h"
+
+static const int kSizes = 48;
+
+static void draw_text(SkBitmap* bm, int index) {
+    bm->allocN32Pixels(64, 32);
+    bm->eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(*bm);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    // Every index is a strike of its own.
+    paint.setTextSize(SkIntToScalar(8 + index));
+    static const char gText[] = "Strike";
+    canvas.drawText(gText, sizeof(gText) - 1, 2, 28, paint);
+}
+
+namespace {
+
+class DrawText : public SkParallelForBody {
+public:
+    explicit DrawText(SkBitmap* bitmaps) : fBitmaps(bitmaps) {}
+    virtual void run(int i) SK_OVERRIDE { draw_text(&fBitmaps[i % kSizes], i % kSizes); }
+private:
+    SkBitmap* fBitmaps;
+};
+
+}  // namespace
+
+static bool equal(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a), alpb(b);
+    return a.getSize() == b.getSize() && 0 == memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+// The budgets hold across all the stripes of the shared cache.
+static void test_budgets(skiatest::Reporter* reporter) {
+    SkGraphics::PurgeFontCache();
+    REPORTER_ASSERT(reporter, 0 == SkGraphics::GetFontCacheUsed());
+    REPORTER_ASSERT(reporter, 0 == SkGraphics::GetFontCacheCountUsed());
+
+    const int countLimit = SkGraphics::SetFontCacheCountLimit(10);
+    SkBitmap bm;
+    for (int i = 0; i < kSizes; ++i) {
+        draw_text(&bm, i);
+        REPORTER_ASSERT(reporter, SkGraphics::GetFontCacheCountUsed() <= 10);
+    }
+    REPORTER_ASSERT(reporter, SkGraphics::GetFontCacheCountUsed() > 0);
+    SkGraphics::SetFontCacheCountLimit(countLimit);
+
+    const size_t sizeLimit = SkGraphics::SetFontCacheLimit(256 * 1024);
+    for (int i = 0; i < kSizes; ++i) {
+        draw_text(&bm, i + 100);
+        REPORTER_ASSERT(reporter, SkGraphics::GetFontCacheUsed() <= 256 * 1024);
+    }
+    SkGraphics::SetFontCacheLimit(sizeLimit);
+
+    SkGraphics::PurgeFontCache();
+    REPORTER_ASSERT(reporter, 0 == SkGraphics::GetFontCacheUsed());
+    REPORTER_ASSERT(reporter, 0 == SkGraphics::GetFontCacheCountUsed());
+}
+
+// Many threads sharing the cache, while it purges, draw what one thread does.
+static void test_threads(skiatest::Reporter* reporter) {
+    SkBitmap expected[kSizes];
+    for (int i = 0; i < kSizes; ++i) {
+        draw_text(&expected[i], i);
+    }
+
+    const int countLimit = SkGraphics::SetFontCacheCountLimit(kSizes / 3);
+    SkBitmap actual[kSizes];
+    {
+        SkThreadPool pool(4);
+        SkTaskGroup group(&pool);
+        DrawText body(actual);
+        for (int round = 0; round < 3; ++round) {
+            group.parallelFor(0, kSizes, &body);
+            group.wait();
+            for (int i = 0; i < kSizes; ++i) {
+                REPORTER_ASSERT(reporter, equal(expected[i], actual[i]));
+            }
+        }
+    }
+    REPORTER_ASSERT(reporter, SkGraphics::GetFontCacheCountUsed() <= kSizes / 3);
+    SkGraphics::SetFontCacheCountLimit(countLimit);
+}
+
+// Glyphs prepared across threads match those generated one at a time.
+static void test_prepare(skiatest::Reporter* reporter) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(20));
+    static const char gText[] = "The quick brown fox jumps over the lazy dog. "
+                                "SPHINX OF BLACK QUARTZ, JUDGE MY VOW! 0123456789";
+    uint16_t glyphs[sizeof(gText)];
+    const int count = paint.textToGlyphs(gText, sizeof(gText) - 1, glyphs);
+
+    // Both are detached at once, so they are separate strikes.
+    SkAutoGlyphCache prepared(paint, NULL, NULL);
+    SkAutoGlyphCache serial(paint, NULL, NULL);
+    REPORTER_ASSERT(reporter, prepared.getCache() != serial.getCache());
+    prepared.getCache()->prepareGlyphIDImages(glyphs, count, 4);
+
+    for (int i = 0; i < count; ++i) {
+        const SkGlyph& a = prepared.getCache()->getGlyphIDMetrics(glyphs[i]);
+        const SkGlyph& b = serial.getCache()->getGlyphIDMetrics(glyphs[i]);
+        REPORTER_ASSERT(reporter, a.fWidth == b.fWidth && a.fHeight == b.fHeight &&
+                                  a.fLeft == b.fLeft && a.fTop == b.fTop &&
+                                  a.fAdvanceX == b.fAdvanceX && a.fMaskFormat == b.fMaskFormat);
+        const void* imageA = a.fImage;
+        const void* imageB = serial.getCache()->findImage(b);
+        REPORTER_ASSERT(reporter, prepared.getCache()->findImage(a) == imageA);
+        if (NULL != imageA && NULL != imageB) {
+            REPORTER_ASSERT(reporter, 0 == memcmp(imageA, imageB, a.computeImageSize()));
+        }
+    }
+}
+
+// Large A8 glyphs are kept compressed, and come back the same.
+static void test_compression(skiatest::Reporter* reporter) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(120));
+    uint16_t glyphs[2];
+    paint.textToGlyphs("WM", 2, glyphs);
+
+    SkAutoGlyphCache autoCache(paint, NULL, NULL);
+    SkGlyphCache* cache = autoCache.getCache();
+    REPORTER_ASSERT(reporter, cache->isLargeStrike() ||
+                              0 == cache->getGlyphIDMetrics(glyphs[0]).fWidth);
+
+    const SkGlyph& first = cache->getGlyphIDMetrics(glyphs[0]);
+    const SkGlyph& second = cache->getGlyphIDMetrics(glyphs[1]);
+    if (SkMask::kA8_Format != first.fMaskFormat || NULL == cache->findImage(first)) {
+        return;
+    }
+    const size_t size = first.computeImageSize();
+    SkAutoMalloc expected(size);
+    memcpy(expected.get(), first.fImage, size);
+
+    cache->findImage(second);
+    SkGraphics::FontCacheStrikeStats stats;
+    cache->getStats(&stats);
+    if (stats.fCompressedImageCount > 0) {
+        REPORTER_ASSERT(reporter, NULL == first.fImage);
+    }
+    const void* image = cache->findImage(first);
+    REPORTER_ASSERT(reporter, NULL != image && 0 == memcmp(expected.get(), image, size));
+
+    cache->getStats(&stats);
+    REPORTER_ASSERT(reporter, 2 == stats.fImageMisses);
+    REPORTER_ASSERT(reporter, 1 == stats.fImageHits);
+    REPORTER_ASSERT(reporter, stats.fIsLarge);
+}
+
+// Large strikes are purged to their own budget, leaving smaller text cached.
+static void test_large_budget(skiatest::Reporter* reporter) {
+    SkGraphics::PurgeFontCache();
+    const size_t largeLimit = SkGraphics::SetFontCacheLargeStrikeLimit(64 * 1024);
+
+    SkBitmap bm;
+    draw_text(&bm, 0);
+    REPORTER_ASSERT(reporter, 1 == SkGraphics::GetFontCacheCountUsed());
+    for (int i = 0; i < 16; ++i) {
+        draw_text(&bm, 60 + 4 * i);
+    }
+
+    SkGraphics::FontCacheStrikeStats stats[32];
+    const int count = SkGraphics::GetFontCacheStrikeStats(stats, SK_ARRAY_COUNT(stats));
+    REPORTER_ASSERT(reporter, count > 0 && count <= (int)SK_ARRAY_COUNT(stats));
+    size_t largeUsed = 0;
+    bool foundSmall = false;
+    for (int i = 0; i < count; ++i) {
+        if (stats[i].fIsLarge) {
+            largeUsed += stats[i].fMemoryUsed;
+        } else {
+            foundSmall |= stats[i].fTextSize == 8;
+        }
+    }
+    REPORTER_ASSERT(reporter, largeUsed <= 64 * 1024);
+    REPORTER_ASSERT(reporter, foundSmall);
+
+    SkGraphics::SetFontCacheLargeStrikeLimit(largeLimit);
+    SkGraphics::PurgeFontCache();
+}
+
+DEF_TEST(GlyphCache, reporter) {
+    test_budgets(reporter);
+    test_threads(reporter);
+    test_prepare(reporter);
+    test_compression(reporter);
+    test_large_budget(reporter);
+}
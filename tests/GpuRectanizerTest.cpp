@@ -7,6 +7,7 @@
 
 #if SK_SUPPORT_GPU
 
+#include "GrRectanizer_maxrects.h"
 #include "GrRectanizer_pow2.h"
 #include "GrRectanizer_skyline.h"
 #include "SkRandom.h"
@@ -58,6 +59,43 @@ static void test_pow2(skiatest::Reporter* reporter, const SkTDArray<SkISize>& re
     test_rectanizer_inserts(reporter, &pow2Rectanizer, rects);
 }
 
+static void test_maxrects(skiatest::Reporter* reporter, const SkTDArray<SkISize>& rects) {
+    GrRectanizerMaxRects maxRectsRectanizer(kWidth, kHeight);
+
+    test_rectanizer_basic(reporter, &maxRectsRectanizer);
+    test_rectanizer_inserts(reporter, &maxRectsRectanizer, rects);
+    maxRectsRectanizer.reset();
+
+    // Fill the rectanizer with quarter-size rects, then check that freeing one makes room for
+    // exactly one more and that freeing all of them empties it.
+    SkIPoint16 locs[4];
+    for (int i = 0; i < 4; ++i) {
+        REPORTER_ASSERT(reporter, maxRectsRectanizer.addRect(kWidth / 2, kHeight / 2, &locs[i]));
+    }
+    SkIPoint16 loc;
+    REPORTER_ASSERT(reporter, !maxRectsRectanizer.addRect(kWidth / 2, kHeight / 2, &loc));
+
+    REPORTER_ASSERT(reporter, maxRectsRectanizer.freeRect(locs[2], kWidth / 2, kHeight / 2));
+    REPORTER_ASSERT(reporter, maxRectsRectanizer.addRect(kWidth / 2, kHeight / 2, &loc));
+    REPORTER_ASSERT(reporter, loc.fX == locs[2].fX && loc.fY == locs[2].fY);
+    REPORTER_ASSERT(reporter, !maxRectsRectanizer.addRect(1, 1, &loc));
+
+    // Freeing two neighbors leaves room for a rect spanning both.
+    REPORTER_ASSERT(reporter, maxRectsRectanizer.freeRect(locs[0], kWidth / 2, kHeight / 2));
+    REPORTER_ASSERT(reporter, maxRectsRectanizer.freeRect(locs[1], kWidth / 2, kHeight / 2));
+    bool neighbors = locs[0].fX == locs[1].fX || locs[0].fY == locs[1].fY;
+    REPORTER_ASSERT(reporter, neighbors);
+    int wideWidth = locs[0].fY == locs[1].fY ? kWidth : kWidth / 2;
+    int wideHeight = locs[0].fY == locs[1].fY ? kHeight / 2 : kHeight;
+    REPORTER_ASSERT(reporter, maxRectsRectanizer.addRect(wideWidth, wideHeight, &loc));
+    REPORTER_ASSERT(reporter, maxRectsRectanizer.freeRect(loc, wideWidth, wideHeight));
+
+    REPORTER_ASSERT(reporter, maxRectsRectanizer.freeRect(locs[2], kWidth / 2, kHeight / 2));
+    REPORTER_ASSERT(reporter, maxRectsRectanizer.freeRect(locs[3], kWidth / 2, kHeight / 2));
+    REPORTER_ASSERT(reporter, maxRectsRectanizer.percentFull() == 0.0f);
+    REPORTER_ASSERT(reporter, maxRectsRectanizer.addRect(kWidth, kHeight, &loc));
+}
+
 DEF_GPUTEST(GpuRectanizer, reporter, factory) {
     SkTDArray<SkISize> rects;
     SkRandom rand;
@@ -69,6 +107,7 @@ DEF_GPUTEST(GpuRectanizer, reporter, factory) {
 
     test_skyline(reporter, rects);
     test_pow2(reporter, rects);
+    test_maxrects(reporter, rects);
 }
 
 #endif
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Test.h"
+
+// This is a GPU-backend specific test
+#if SK_SUPPORT_GPU
+
+#include "gl/GrGLDefines.h"
+#include "gl/GrGLInterface.h"
+#include "gl/GrGLUtil.h"
+#include "SkTDArray.h"
+
+// The threaded interface is tested by wrapping the null interface with functions that log each
+// call they get. The log is only written on the GL thread, and only read once the test has waited
+// for that thread to catch up.
+namespace {
+
+enum Call {
+    kMakeCurrent_Call,
+    kEnable_Call,
+    kDisable_Call,
+    kBufferData_Call,
+    kGenTextures_Call,
+    kGetIntegerv_Call,
+    kGetError_Call,
+    kSubmit_Call,
+};
+
+SkTDArray<Call> gCalls;
+SkTDArray<GrGLenum> gArgs;          // the enum passed to each Enable and Disable
+SkTDArray<uint8_t> gBufferData;     // what the last BufferData was given
+GrGLuint gNextName = 1;
+
+void log(Call call) { *gCalls.append() = call; }
+
+void make_current(void*) { log(kMakeCurrent_Call); }
+void submit(void*) { log(kSubmit_Call); }
+
+GrGLvoid GR_GL_FUNCTION_TYPE logEnable(GrGLenum cap) {
+    log(kEnable_Call);
+    *gArgs.append() = cap;
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE logDisable(GrGLenum cap) {
+    log(kDisable_Call);
+    *gArgs.append() = cap;
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE logBufferData(GrGLenum, GrGLsizeiptr size, const GrGLvoid* data,
+                                           GrGLenum) {
+    log(kBufferData_Call);
+    gBufferData.setCount(SkToInt(size));
+    memcpy(gBufferData.begin(), data, size);
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE logGenTextures(GrGLsizei n, GrGLuint* textures) {
+    log(kGenTextures_Call);
+    for (int i = 0; i < n; ++i) {
+        textures[i] = gNextName++;
+    }
+}
+
+GrGLvoid GR_GL_FUNCTION_TYPE logGetIntegerv(GrGLenum pname, GrGLint* params) {
+    log(kGetIntegerv_Call);
+    *params = GR_GL_MAX_TEXTURE_SIZE == pname ? 1234 : 0;
+}
+
+GrGLenum GR_GL_FUNCTION_TYPE logGetError() {
+    log(kGetError_Call);
+    return GR_GL_INVALID_VALUE;
+}
+
+void reset_log() {
+    gCalls.rewind();
+    gArgs.rewind();
+    gBufferData.rewind();
+}
+
+bool log_is(const Call expected[], int count) {
+    if (gCalls.count() != count) {
+        return false;
+    }
+    return 0 == memcmp(gCalls.begin(), expected, count * sizeof(Call));
+}
+
+}  // namespace
+
+DEF_TEST(GrGLThreadedInterface, reporter) {
+    SkAutoTUnref<const GrGLInterface> nullGL(GrGLCreateNullInterface());
+    SkAutoTUnref<GrGLInterface> gl(GrGLInterface::NewClone(nullGL));
+    gl->fFunctions.fEnable = logEnable;
+    gl->fFunctions.fDisable = logDisable;
+    gl->fFunctions.fBufferData = logBufferData;
+    gl->fFunctions.fGenTextures = logGenTextures;
+    gl->fFunctions.fGetIntegerv = logGetIntegerv;
+    gl->fFunctions.fGetError = logGetError;
+    reset_log();
+
+    SkAutoTUnref<const GrGLInterface> threaded(GrGLCreateThreadedInterface(gl, make_current, NULL));
+    REPORTER_ASSERT(reporter, NULL != threaded.get());
+    if (NULL == threaded.get()) {
+        return;
+    }
+
+    // Calls that return nothing are recorded and forwarded later, in order. The data a call reads
+    // through a pointer is copied when it is recorded.
+    uint8_t data[] = { 1, 2, 3, 4 };
+    GR_GL_CALL(threaded.get(), Enable(GR_GL_BLEND));
+    GR_GL_CALL(threaded.get(), BufferData(GR_GL_ARRAY_BUFFER, sizeof(data), data,
+                                          GR_GL_STATIC_DRAW));
+    data[0] = 5;
+    GR_GL_CALL(threaded.get(), Disable(GR_GL_DITHER));
+    GrGLThreadedInterfaceFinish(threaded);
+    {
+        static const Call kExpected[] = {
+            kMakeCurrent_Call, kEnable_Call, kBufferData_Call, kDisable_Call,
+        };
+        REPORTER_ASSERT(reporter, log_is(kExpected, SK_ARRAY_COUNT(kExpected)));
+        REPORTER_ASSERT(reporter, 2 == gArgs.count() &&
+                                  GR_GL_BLEND == gArgs[0] && GR_GL_DITHER == gArgs[1]);
+        REPORTER_ASSERT(reporter, 4 == gBufferData.count() && 1 == gBufferData[0] &&
+                                  4 == gBufferData[3]);
+    }
+    reset_log();
+
+    // Queries wait for everything recorded before them, and bring back what GL wrote.
+    GR_GL_CALL(threaded.get(), Enable(GR_GL_BLEND));
+    GrGLint maxTextureSize = 0;
+    GR_GL_CALL(threaded.get(), GetIntegerv(GR_GL_MAX_TEXTURE_SIZE, &maxTextureSize));
+    REPORTER_ASSERT(reporter, 1234 == maxTextureSize);
+    {
+        static const Call kExpected[] = { kEnable_Call, kGetIntegerv_Call };
+        REPORTER_ASSERT(reporter, log_is(kExpected, SK_ARRAY_COUNT(kExpected)));
+    }
+    reset_log();
+
+    GR_GL_CALL(threaded.get(), Disable(GR_GL_BLEND));
+    GrGLenum error;
+    GR_GL_CALL_RET(threaded.get(), error, GetError());
+    REPORTER_ASSERT(reporter, GR_GL_INVALID_VALUE == error);
+    {
+        static const Call kExpected[] = { kDisable_Call, kGetError_Call };
+        REPORTER_ASSERT(reporter, log_is(kExpected, SK_ARRAY_COUNT(kExpected)));
+    }
+    reset_log();
+
+    // Names come from GL in batches, so only the first Gen call has to wait for one.
+    GrGLuint textures[2] = { 0, 0 };
+    GR_GL_CALL(threaded.get(), GenTextures(1, &textures[0]));
+    GR_GL_CALL(threaded.get(), GenTextures(1, &textures[1]));
+    REPORTER_ASSERT(reporter, 0 != textures[0] && 0 != textures[1] && textures[0] != textures[1]);
+    REPORTER_ASSERT(reporter, textures[0] < gNextName && textures[1] < gNextName);
+    REPORTER_ASSERT(reporter, 1 == gCalls.count() && kGenTextures_Call == gCalls[0]);
+    reset_log();
+
+    // Submitted procs run on the GL thread after the calls recorded before them.
+    GR_GL_CALL(threaded.get(), Enable(GR_GL_BLEND));
+    GrGLThreadedInterfaceSubmit(threaded, submit, NULL);
+    GrGLThreadedInterfaceFinish(threaded);
+    {
+        static const Call kExpected[] = { kEnable_Call, kSubmit_Call };
+        REPORTER_ASSERT(reporter, log_is(kExpected, SK_ARRAY_COUNT(kExpected)));
+    }
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#if SK_SUPPORT_GPU
+
+#include "GrBufferAllocPool.h"
+#include "GrContext.h"
+#include "GrContextFactory.h"
+#include "GrGpu.h"
+#include "GrInOrderDrawBuffer.h"
+#include "SkClipStack.h"
+#include "Test.h"
+
+class GrInOrderDrawBufferTester {
+public:
+    // Fills draws with the index of each recorded draw, in the order flush() would play them.
+    // No trace markers are recorded by these tests, so commands carry no trace bit.
+    static void DrawOrder(GrInOrderDrawBuffer* buffer, SkTDArray<int>* draws) {
+        SkTDArray<int> items, order;
+        buffer->orderCommands(&items, &order);
+        for (int i = 0; i < order.count(); ++i) {
+            const int c = order[i];
+            if (GrInOrderDrawBuffer::kDraw_Cmd == buffer->fCmds[c]) {
+                *draws->append() = items[c];
+            }
+        }
+    }
+
+    static int DrawCount(GrInOrderDrawBuffer* buffer) {
+        return buffer->fDraws.count();
+    }
+};
+
+// Records a draw with dither on, two draws with it off that are concatenated into one record,
+// then a draw with dither on again at 'last'. Returns the records in playback order.
+static void order_around_concat(GrContext* context, GrRenderTarget* rt, const SkRect& last,
+                                SkTDArray<int>* draws) {
+    GrVertexBufferAllocPool vertexPool(context->getGpu(), false, 1 << 15, 4);
+    GrIndexBufferAllocPool indexPool(context->getGpu(), false, 1 << 11, 4);
+    GrInOrderDrawBuffer buffer(context->getGpu(), &vertexPool, &indexPool);
+
+    SkClipStack stack;
+    GrClipData clip;
+    clip.fClipStack = &stack;
+    buffer.setClip(&clip);
+    GrDrawState* drawState = buffer.drawState();
+    drawState->setRenderTarget(rt);
+
+    drawState->enableState(GrDrawState::kDither_StateBit);
+    buffer.drawSimpleRect(SkRect::MakeLTRB(200, 200, 210, 210));
+
+    drawState->disableState(GrDrawState::kDither_StateBit);
+    buffer.drawSimpleRect(SkRect::MakeLTRB(0, 0, 10, 10));
+    buffer.drawSimpleRect(SkRect::MakeLTRB(20, 0, 30, 10));
+
+    drawState->enableState(GrDrawState::kDither_StateBit);
+    buffer.drawSimpleRect(last);
+
+    // The second and third draws share a record.
+    if (3 == GrInOrderDrawBufferTester::DrawCount(&buffer)) {
+        GrInOrderDrawBufferTester::DrawOrder(&buffer, draws);
+    }
+    buffer.reset();
+}
+
+// A draw may move ahead of a batch of concatenated draws only if it overlaps none of them.
+DEF_GPUTEST(GrInOrderDrawBuffer_ReorderConcat, reporter, factory) {
+    GrContext* context = factory->get(GrContextFactory::kNull_GLContextType);
+    if (NULL == context) {
+        return;
+    }
+    GrTextureDesc desc;
+    desc.fFlags = kRenderTarget_GrTextureFlagBit;
+    desc.fWidth = 256;
+    desc.fHeight = 256;
+    desc.fConfig = kSkia8888_GrPixelConfig;
+    SkAutoTUnref<GrTexture> texture(context->createUncachedTexture(desc, NULL, 0));
+    if (NULL == texture.get()) {
+        return;
+    }
+    GrRenderTarget* rt = texture->asRenderTarget();
+
+    // Apart from all of them, the last draw joins the first.
+    SkTDArray<int> draws;
+    order_around_concat(context, rt, SkRect::MakeLTRB(50, 0, 60, 10), &draws);
+    REPORTER_ASSERT(reporter, 3 == draws.count());
+    if (3 == draws.count()) {
+        REPORTER_ASSERT(reporter, 0 == draws[0] && 2 == draws[1] && 1 == draws[2]);
+    }
+
+    // Overlapping only the second of the concatenated draws, it stays last.
+    draws.rewind();
+    order_around_concat(context, rt, SkRect::MakeLTRB(25, 0, 35, 10), &draws);
+    REPORTER_ASSERT(reporter, 3 == draws.count());
+    if (3 == draws.count()) {
+        REPORTER_ASSERT(reporter, 0 == draws[0] && 1 == draws[1] && 2 == draws[2]);
+    }
+}
+
+#endif
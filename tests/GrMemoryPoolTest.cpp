@@ -9,10 +9,12 @@
 // This is a GPU-backend specific test
 #if SK_SUPPORT_GPU
 #include "GrMemoryPool.h"
+#include "GrSlabPool.h"
 #include "SkInstCnt.h"
 #include "SkRandom.h"
 #include "SkTDArray.h"
 #include "SkTemplates.h"
+#include "SkThreadUtils.h"
 
 // A is the top of an inheritance tree of classes that overload op new and
 // and delete to use a GrMemoryPool. The objects have values of different types
@@ -239,4 +241,103 @@ DEF_TEST(GrMemoryPool, reporter) {
     }
 }
 
+
+namespace {
+
+struct Block {
+    uint8_t* fPtr;
+    size_t   fSize;
+    uint8_t  fValue;
+};
+
+void fill_block(Block* block, GrSlabPool* pool, size_t size, uint8_t value) {
+    block->fPtr = static_cast<uint8_t*>(pool->allocate(size));
+    block->fSize = size;
+    block->fValue = value;
+    memset(block->fPtr, value, size);
+}
+
+bool check_block(const Block& block) {
+    for (size_t i = 0; i < block.fSize; ++i) {
+        if (block.fPtr[i] != block.fValue) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct ReleaseRec {
+    SkTDArray<Block>* fBlocks;
+    bool              fValuesOK;
+};
+
+// Releases every block through a pool of its own, as another thread's TLS pool would.
+void release_blocks(void* data) {
+    ReleaseRec* rec = static_cast<ReleaseRec*>(data);
+    GrSlabPool pool;
+    rec->fValuesOK = true;
+    for (int i = 0; i < rec->fBlocks->count(); ++i) {
+        rec->fValuesOK &= check_block((*rec->fBlocks)[i]);
+        pool.release((*rec->fBlocks)[i].fPtr);
+    }
+}
+
+}  // namespace
+
+DEF_TEST(SlabPool, reporter) {
+    SkRandom r;
+    // Small slabs, so that slabs fill up and are freed often.
+    GrSlabPool pool(1024);
+    SkTDArray<Block> blocks;
+    for (int i = 0; i < 20000; ++i) {
+        if (r.nextBool() || 0 == blocks.count()) {
+            // Mostly pooled sizes, with the occasional unpooled one.
+            size_t size = r.nextULessThan(8) ? r.nextULessThan(GrSlabPool::kMaxSlotSize + 1)
+                                             : r.nextRangeU(GrSlabPool::kMaxSlotSize + 1, 1000);
+            fill_block(blocks.append(), &pool, size, static_cast<uint8_t>(i));
+        } else {
+            int d = r.nextULessThan(blocks.count());
+            REPORTER_ASSERT(reporter, check_block(blocks[d]));
+            pool.release(blocks[d].fPtr);
+            blocks.removeShuffle(d);
+        }
+    }
+    for (int i = 0; i < blocks.count(); ++i) {
+        REPORTER_ASSERT(reporter, check_block(blocks[i]));
+        pool.release(blocks[i].fPtr);
+    }
+    REPORTER_ASSERT(reporter, pool.isEmpty());
+    blocks.reset();
+
+    // Release half the blocks on another thread while this one keeps allocating and releasing.
+    // The memory goes back to this pool, which must reuse it without clobbering live blocks.
+    SkTDArray<Block> remoteBlocks;
+    for (int i = 0; i < 4000; ++i) {
+        SkTDArray<Block>* dst = r.nextBool() ? &blocks : &remoteBlocks;
+        fill_block(dst->append(), &pool, r.nextULessThan(GrSlabPool::kMaxSlotSize + 200),
+                   static_cast<uint8_t>(i));
+    }
+    ReleaseRec rec = { &remoteBlocks, false };
+    SkThread thread(release_blocks, &rec);
+    thread.start();
+    for (int i = 0; i < 20000; ++i) {
+        if (r.nextBool()) {
+            fill_block(blocks.append(), &pool, r.nextULessThan(GrSlabPool::kMaxSlotSize + 1),
+                       static_cast<uint8_t>(i));
+        } else {
+            int d = r.nextULessThan(blocks.count());
+            REPORTER_ASSERT(reporter, check_block(blocks[d]));
+            pool.release(blocks[d].fPtr);
+            blocks.removeShuffle(d);
+        }
+    }
+    thread.join();
+    REPORTER_ASSERT(reporter, rec.fValuesOK);
+    for (int i = 0; i < blocks.count(); ++i) {
+        REPORTER_ASSERT(reporter, check_block(blocks[i]));
+        pool.release(blocks[i].fPtr);
+    }
+    REPORTER_ASSERT(reporter, pool.isEmpty());
+}
+
 #endif
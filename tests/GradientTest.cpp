@@ -156,6 +156,74 @@ static void TestConstantGradient(skiatest::Reporter*) {
     }
 }
 
+// Shades a span at a time and a pixel at a time, which take the vectorized and scalar paths of
+// the sweep and conical gradients. The geometry is chosen so that stepping across a span is
+// exact, so both must give the same colors.
+static void test_span_matches_pixels(skiatest::Reporter* reporter, SkShader* shader) {
+    static const int kW = 37;
+    static const int kH = 9;
+    SkBitmap device;
+    device.allocN32Pixels(kW, kH);
+    SkPaint paint;
+    SkShader::ContextRec rec(device, paint, SkMatrix::I());
+    SkAutoMalloc storage(shader->contextSize());
+    SkShader::Context* ctx = shader->createContext(rec, storage.get());
+    REPORTER_ASSERT(reporter, NULL != ctx);
+    if (NULL == ctx) {
+        return;
+    }
+
+    for (int y = 0; y < kH; ++y) {
+        SkPMColor span[kW];
+        ctx->shadeSpan(0, y, span, kW);
+        for (int x = 0; x < kW; ++x) {
+            SkPMColor pixel;
+            ctx->shadeSpan(x, y, &pixel, 1);
+            REPORTER_ASSERT(reporter, span[x] == pixel);
+        }
+        if (ctx->getFlags() & SkShader::kHasSpan16_Flag) {
+            uint16_t span16[kW];
+            ctx->shadeSpan16(0, y, span16, kW);
+            for (int x = 0; x < kW; ++x) {
+                uint16_t pixel;
+                ctx->shadeSpan16(x, y, &pixel, 1);
+                REPORTER_ASSERT(reporter, span16[x] == pixel);
+            }
+        }
+    }
+    ctx->~Context();
+}
+
+static void TestSpanShading(skiatest::Reporter* reporter) {
+    static const SkColor gColors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE, SK_ColorRED };
+    static const SkShader::TileMode gModes[] = {
+        SkShader::kClamp_TileMode,
+        SkShader::kRepeat_TileMode,
+        SkShader::kMirror_TileMode,
+    };
+
+    // Through the center, so that pixels land on the axes, and off it.
+    SkAutoTUnref<SkShader> sweep(SkGradientShader::CreateSweep(16.5f, 4.5f, gColors, NULL,
+                                                               SK_ARRAY_COUNT(gColors)));
+    test_span_matches_pixels(reporter, sweep);
+    sweep.reset(SkGradientShader::CreateSweep(10.25f, 3, gColors, NULL, SK_ARRAY_COUNT(gColors)));
+    test_span_matches_pixels(reporter, sweep);
+
+    const SkPoint start = SkPoint::Make(12, 4);
+    const SkPoint end = SkPoint::Make(20.5f, 2);
+    for (size_t m = 0; m < SK_ARRAY_COUNT(gModes); ++m) {
+        // Growing and shrinking, the latter being flipped, and with either circle inside the
+        // other or not.
+        static const SkScalar gRadii[][2] = { { 2, 11 }, { 11, 2 }, { 3, 5 }, { 5, 3 } };
+        for (size_t r = 0; r < SK_ARRAY_COUNT(gRadii); ++r) {
+            SkAutoTUnref<SkShader> conical(SkGradientShader::CreateTwoPointConical(
+                    start, gRadii[r][0], end, gRadii[r][1],
+                    gColors, NULL, SK_ARRAY_COUNT(gColors), gModes[m]));
+            test_span_matches_pixels(reporter, conical);
+        }
+    }
+}
+
 typedef void (*GradProc)(skiatest::Reporter* reporter, const GradRec&);
 
 static void TestGradientShaders(skiatest::Reporter* reporter) {
@@ -193,4 +261,5 @@ static void TestGradientShaders(skiatest::Reporter* reporter) {
 DEF_TEST(Gradient, reporter) {
     TestGradientShaders(reporter);
     TestConstantGradient(reporter);
+    TestSpanShading(reporter);
 }
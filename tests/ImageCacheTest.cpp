@@ -131,3 +131,125 @@ DEF_TEST(ImageCache_doubleAdd, r) {
     REPORTER_ASSERT(r, tmp.getGenerationID() == scaled2.getGenerationID());
     cache.unlock(id);
 }
+
+DEF_TEST(ImageCache_picture, r) {
+    SkScaledImageCache cache(4096);
+
+    SkBitmap scaled;
+    scaled.allocN32Pixels(20, 20);
+    const SkIRect tile = SkIRect::MakeWH(20, 20);
+    // Picture and pixel IDs are counted separately, so keys must not collide.
+    const uint32_t pictureID = scaled.getGenerationID();
+
+    SkBitmap tmp;
+    REPORTER_ASSERT(r, NULL == cache.findAndLockPicture(pictureID, 2, 2, tile, &tmp));
+    SkScaledImageCache::ID* id = cache.addAndLockPicture(pictureID, 2, 2, tile, scaled);
+    REPORTER_ASSERT(r, NULL != id);
+    cache.unlock(id);
+
+    id = cache.findAndLockPicture(pictureID, 2, 2, tile, &tmp);
+    REPORTER_ASSERT(r, NULL != id);
+    REPORTER_ASSERT(r, tmp.pixelRef() == scaled.pixelRef());
+    cache.unlock(id);
+
+    REPORTER_ASSERT(r, NULL == cache.findAndLockPicture(pictureID, 1, 1, tile, &tmp));
+    REPORTER_ASSERT(r, NULL == cache.findAndLock(pictureID, 20, 20, &tmp));
+    REPORTER_ASSERT(r, NULL == cache.addAndLockPicture(pictureID, 2, 2, SkIRect::MakeEmpty(),
+                                                       scaled));
+}
+
+DEF_TEST(ImageCache_counters, r) {
+    // Room for one scaled bitmap.
+    SkScaledImageCache cache(DIM * DIM * 4 + 1024);
+
+    SkBitmap original;
+    original.allocN32Pixels(40, 40);
+    SkBitmap scaled;
+    make_bm(&scaled, DIM, DIM);
+
+    SkBitmap tmp;
+    REPORTER_ASSERT(r, NULL == cache.findAndLock(original, 2, 2, &tmp));
+    // Adding checks for an existing entry, but that is not a lookup.
+    SkScaledImageCache::ID* id = cache.addAndLock(original, 2, 2, scaled);
+    cache.unlock(id);
+    id = cache.findAndLock(original, 2, 2, &tmp);
+    REPORTER_ASSERT(r, NULL != id);
+    cache.unlock(id);
+    REPORTER_ASSERT(r, 1 == cache.counters().fHits);
+    REPORTER_ASSERT(r, 1 == cache.counters().fMisses);
+    REPORTER_ASSERT(r, 0 == cache.counters().fEvictions);
+
+    // The cache only has room for one, so this purges the first.
+    id = cache.addAndLock(original, 3, 3, scaled);
+    cache.unlock(id);
+    REPORTER_ASSERT(r, 1 == cache.counters().fEvictions);
+}
+
+#include "SkTaskGroup.h"
+
+namespace {
+
+// Adds, finds and unlocks scaled copies of one original in the global cache.
+class AddAndFind : public SkParallelForBody {
+public:
+    explicit AddAndFind(const SkBitmap* originals) : fOriginals(originals) {}
+    virtual void run(int i) SK_OVERRIDE {
+        const SkBitmap& orig = fOriginals[i % COUNT];
+        const SkScalar scale = SkIntToScalar(2 + i / COUNT);
+
+        SkBitmap tmp;
+        make_bm(&tmp, DIM / 4, DIM / 4);
+        SkScaledImageCache::ID* id = SkScaledImageCache::AddAndLock(orig, scale, scale, tmp);
+        SkBitmap found;
+        SkScaledImageCache::ID* id2 = SkScaledImageCache::FindAndLock(orig, scale, scale,
+                                                                      &found);
+        // Both are locked, so neither can have been purged.
+        if (NULL == id || id != id2 || found.pixelRef() != tmp.pixelRef()) {
+            sk_atomic_inc(&fFailures);
+        }
+        if (id2) {
+            SkScaledImageCache::Unlock(id2);
+        }
+        if (id) {
+            SkScaledImageCache::Unlock(id);
+        }
+    }
+
+    int32_t fFailures;
+
+private:
+    const SkBitmap* fOriginals;
+};
+
+}  // namespace
+
+// The global cache is sharded, but keeps one byte budget.
+DEF_TEST(ImageCache_global, reporter) {
+    static const size_t kLimit = DIM * DIM;
+    const size_t prevLimit = SkScaledImageCache::SetByteLimit(kLimit);
+    if (0 == prevLimit && 0 == SkScaledImageCache::GetByteLimit()) {
+        // discardable, so there is no byte budget to test
+        return;
+    }
+
+    SkBitmap originals[COUNT];
+    for (int i = 0; i < COUNT; ++i) {
+        make_bm(&originals[i], DIM, DIM);
+    }
+
+    AddAndFind body(originals);
+    body.fFailures = 0;
+    {
+        SkThreadPool pool(4);
+        SkTaskGroup group(&pool);
+        group.parallelFor(0, COUNT * 20, &body);
+        group.wait();
+    }
+    REPORTER_ASSERT(reporter, 0 == body.fFailures);
+    REPORTER_ASSERT(reporter, SkScaledImageCache::GetBytesUsed() < kLimit);
+
+    // Unlocked entries are purged when the limit drops.
+    SkScaledImageCache::SetByteLimit(0);
+    REPORTER_ASSERT(reporter, 0 == SkScaledImageCache::GetBytesUsed());
+    SkScaledImageCache::SetByteLimit(prevLimit);
+}
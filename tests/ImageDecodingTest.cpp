@@ -17,6 +17,7 @@
 #include "SkImageDecoder.h"
 #include "SkImageEncoder.h"
 #include "SkImageGeneratorPriv.h"
+#include "SkIncrementalImageDecoder.h"
 #include "SkImagePriv.h"
 #include "SkOSFile.h"
 #include "SkPoint.h"
@@ -725,3 +726,220 @@ DEF_TEST(ImageDecoderOptions, reporter) {
         }
     }
 }
+
+/**
+ *  Decoding a subset of a JPEG through the generator must give the same
+ *  pixels as decoding the whole image, at every sample size libjpeg
+ *  can scale the DCT by.
+ */
+DEF_TEST(ImageDecoding_generatorSubset, reporter) {
+    SkBitmap original;
+    original.allocN32Pixels(320, 240);
+    for (int y = 0; y < original.height(); ++y) {
+        for (int x = 0; x < original.width(); ++x) {
+            // Blocks of flat color survive the JPEG round trip nearly unchanged.
+            *original.getAddr32(x, y) = SkPackARGB32(0xFF, (x / 32) * 25, (y / 32) * 25, 0x80);
+        }
+    }
+    SkAutoDataUnref encoded(SkImageEncoder::EncodeData(original, SkImageEncoder::kJPEG_Type,
+                                                       100));
+    REPORTER_ASSERT(reporter, encoded.get() != NULL);
+    if (NULL == encoded.get()) {
+        return;
+    }
+
+    SkAutoTDelete<SkImageGenerator> gen(
+        SkDecodingImageGenerator::Create(encoded, SkDecodingImageGenerator::Options()));
+    REPORTER_ASSERT(reporter, gen.get() != NULL);
+    if (NULL == gen.get()) {
+        return;
+    }
+    SkImageInfo info;
+    REPORTER_ASSERT(reporter, gen->getInfo(&info));
+    SkBitmap full;
+    REPORTER_ASSERT(reporter, full.allocPixels(info));
+    REPORTER_ASSERT(reporter, gen->getPixels(info, full.getPixels(), full.rowBytes()));
+
+    const SkIRect subset = SkIRect::MakeXYWH(64, 96, 128, 96);
+    const int sampleSizes[] = { 1, 2, 4, 8 };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(sampleSizes); ++i) {
+        const int sampleSize = sampleSizes[i];
+        SkBitmap bm;
+        REPORTER_ASSERT(reporter, gen->getPixels(subset, sampleSize, &bm));
+        REPORTER_ASSERT(reporter, bm.width() == subset.width() / sampleSize);
+        REPORTER_ASSERT(reporter, bm.height() == subset.height() / sampleSize);
+        if (bm.isNull()) {
+            continue;
+        }
+        SkAutoLockPixels alp(bm);
+        SkAutoLockPixels alpFull(full);
+        // Compare the centers of the blocks, away from any filtering at their edges.
+        for (int y = 16; y < subset.height(); y += 32) {
+            for (int x = 16; x < subset.width(); x += 32) {
+                SkPMColor expected = *full.getAddr32(subset.fLeft + x, subset.fTop + y);
+                SkPMColor actual = *bm.getAddr32(x / sampleSize, y / sampleSize);
+                REPORTER_ASSERT(reporter,
+                                SkAbs32(SkGetPackedR32(expected) - SkGetPackedR32(actual)) <= 4 &&
+                                SkAbs32(SkGetPackedG32(expected) - SkGetPackedG32(actual)) <= 4 &&
+                                SkAbs32(SkGetPackedB32(expected) - SkGetPackedB32(actual)) <= 4);
+            }
+        }
+    }
+}
+
+DEF_TEST(ImageDecoding_incremental, reporter) {
+    SkBitmap original;
+    original.allocN32Pixels(64, 48);
+    for (int y = 0; y < original.height(); ++y) {
+        for (int x = 0; x < original.width(); ++x) {
+            *original.getAddr32(x, y) = SkPreMultiplyARGB(x * 4, y * 5, x ^ y, 0x80);
+        }
+    }
+    SkAutoDataUnref encoded(SkImageEncoder::EncodeData(original, SkImageEncoder::kPNG_Type, 100));
+    REPORTER_ASSERT(reporter, encoded.get() != NULL);
+    if (NULL == encoded.get()) {
+        return;
+    }
+    SkBitmap expected;
+    REPORTER_ASSERT(reporter, SkImageDecoder::DecodeMemory(encoded->data(), encoded->size(),
+                                                           &expected, kN32_SkColorType,
+                                                           SkImageDecoder::kDecodePixels_Mode));
+
+    SkAutoTUnref<SkIncrementalImageDecoder> decoder(
+        SkIncrementalImageDecoder::Create(encoded->data(), encoded->size()));
+    REPORTER_ASSERT(reporter, decoder.get() != NULL);
+    if (NULL == decoder.get()) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, SkImageDecoder::kPNG_Format == decoder->getFormat());
+
+    // Feed the image a few bytes at a time; the decoded rows should only ever grow.
+    const uint8_t* data = encoded->bytes();
+    const size_t kChunkSize = 16;
+    int rowCount = 0;
+    SkIncrementalImageDecoder::Status status = SkIncrementalImageDecoder::kNeedMoreData_Status;
+    for (size_t offset = 0; offset < encoded->size(); offset += kChunkSize) {
+        REPORTER_ASSERT(reporter, SkIncrementalImageDecoder::kNeedMoreData_Status == status);
+        status = decoder->append(data + offset, SkTMin(kChunkSize, encoded->size() - offset));
+        REPORTER_ASSERT(reporter, decoder->getDecodedRowCount() >= rowCount);
+        rowCount = decoder->getDecodedRowCount();
+    }
+    REPORTER_ASSERT(reporter, SkIncrementalImageDecoder::kComplete_Status == status);
+    REPORTER_ASSERT(reporter, original.height() == rowCount);
+
+    SkAutoTDelete<SkImageGenerator> gen(decoder->newGenerator());
+    REPORTER_ASSERT(reporter, gen.get() != NULL);
+    if (NULL == gen.get()) {
+        return;
+    }
+    SkImageInfo info;
+    REPORTER_ASSERT(reporter, gen->getInfo(&info));
+    REPORTER_ASSERT(reporter, info.width() == original.width());
+    REPORTER_ASSERT(reporter, info.height() == original.height());
+    SkBitmap bm;
+    REPORTER_ASSERT(reporter, bm.allocPixels(info));
+    REPORTER_ASSERT(reporter, gen->getPixels(info, bm.getPixels(), bm.rowBytes()));
+    SkAutoLockPixels alp(bm);
+    SkAutoLockPixels alpExpected(expected);
+    for (int y = 0; y < bm.height(); ++y) {
+        REPORTER_ASSERT(reporter, 0 == memcmp(bm.getAddr32(0, y), expected.getAddr32(0, y),
+                                              bm.width() * sizeof(SkPMColor)));
+    }
+}
+
+// Encoding a PNG with several threads splits it into independently deflated strips, which
+// must decode to the same pixels as the single threaded encode.
+DEF_TEST(ImageEncoding_PNGThreads, reporter) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(300, 500);
+    {
+        SkPoint pts[] = { SkPoint::Make(0, 0), SkPoint::Make(300, 500) };
+        SkColor colors[] = { SK_ColorRED, 0x8000FF00, SK_ColorBLUE };
+        SkAutoTUnref<SkShader> shader(SkGradientShader::CreateLinear(
+                pts, colors, NULL, SK_ARRAY_COUNT(colors), SkShader::kMirror_TileMode));
+        SkPaint paint;
+        paint.setShader(shader);
+        SkCanvas canvas(bitmap);
+        canvas.clear(SK_ColorTRANSPARENT);
+        canvas.drawPaint(paint);
+    }
+
+    SkAutoTDelete<SkImageEncoder> encoder(SkImageEncoder::Create(SkImageEncoder::kPNG_Type));
+    if (NULL == encoder.get()) {
+        return;
+    }
+    SkAutoTUnref<SkData> single(encoder->encodeData(bitmap, 100));
+    encoder->setThreadCount(4);
+    SkAutoTUnref<SkData> threaded(encoder->encodeData(bitmap, 100));
+    REPORTER_ASSERT(reporter, NULL != single.get() && NULL != threaded.get());
+    if (NULL == single.get() || NULL == threaded.get()) {
+        return;
+    }
+
+    SkBitmap singleDecoded, threadedDecoded;
+    REPORTER_ASSERT(reporter, SkImageDecoder::DecodeMemory(single->data(), single->size(),
+                                                           &singleDecoded));
+    REPORTER_ASSERT(reporter, SkImageDecoder::DecodeMemory(threaded->data(), threaded->size(),
+                                                           &threadedDecoded));
+    REPORTER_ASSERT(reporter, singleDecoded.info() == threadedDecoded.info());
+    if (singleDecoded.info() != threadedDecoded.info()) {
+        return;
+    }
+    SkAutoLockPixels alp0(singleDecoded);
+    SkAutoLockPixels alp1(threadedDecoded);
+    REPORTER_ASSERT(reporter, 0 == memcmp(singleDecoded.getPixels(), threadedDecoded.getPixels(),
+                                          singleDecoded.getSize()));
+}
+
+DEF_TEST(ImageDecoding_TargetSize, reporter) {
+    // Each 3x3 block of this averages to the color of its middle pixel.
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(90, 60);
+    for (int y = 0; y < 60; y++) {
+        for (int x = 0; x < 90; x++) {
+            *bitmap.getAddr32(x, y) = SkPackARGB32(0xFF, 2 * x, 3 * y, 0x80);
+        }
+    }
+    SkAutoTUnref<SkData> data(SkImageEncoder::EncodeData(bitmap, SkImageEncoder::kPNG_Type, 100));
+    if (NULL == data.get()) {
+        return;
+    }
+    SkMemoryStream stream(data);
+    SkAutoTDelete<SkImageDecoder> decoder(SkImageDecoder::Factory(&stream));
+    if (NULL == decoder.get()) {
+        return;
+    }
+
+    SkBitmap decoded;
+    decoder->setTargetSize(30, 20);
+    REPORTER_ASSERT(reporter, decoder->decode(&stream, &decoded, kN32_SkColorType,
+                                              SkImageDecoder::kDecodePixels_Mode));
+    REPORTER_ASSERT(reporter, 30 == decoded.width() && 20 == decoded.height());
+    if (30 != decoded.width() || 20 != decoded.height()) {
+        return;
+    }
+    {
+        SkAutoLockPixels alp(decoded);
+        for (int y = 0; y < 20; y++) {
+            for (int x = 0; x < 30; x++) {
+                REPORTER_ASSERT(reporter, *decoded.getAddr32(x, y) ==
+                                          *bitmap.getAddr32(3 * x + 1, 3 * y + 1));
+            }
+        }
+    }
+
+    // A fractional scale of a solid color stays that color.
+    bitmap.eraseColor(0x80402010);
+    data.reset(SkImageEncoder::EncodeData(bitmap, SkImageEncoder::kPNG_Type, 100));
+    stream.setData(data);
+    decoder->setTargetSize(41, 27);
+    REPORTER_ASSERT(reporter, decoder->decode(&stream, &decoded, kN32_SkColorType,
+                                              SkImageDecoder::kDecodePixels_Mode));
+    REPORTER_ASSERT(reporter, 41 == decoded.width() && 27 == decoded.height());
+    SkAutoLockPixels alp(decoded);
+    for (int y = 0; y < decoded.height(); y++) {
+        for (int x = 0; x < decoded.width(); x++) {
+            REPORTER_ASSERT(reporter, *decoded.getAddr32(x, y) == *decoded.getAddr32(0, 0));
+        }
+    }
+}
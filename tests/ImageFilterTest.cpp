@@ -13,6 +13,7 @@
 #include "SkCanvas.h"
 #include "SkColorFilterImageFilter.h"
 #include "SkColorMatrixFilter.h"
+#include "SkComposeImageFilter.h"
 #include "SkDeviceImageFilterProxy.h"
 #include "SkDisplacementMapEffect.h"
 #include "SkDropShadowImageFilter.h"
@@ -20,6 +21,7 @@
 #include "SkFlattenableSerialization.h"
 #include "SkGradientShader.h"
 #include "SkLightingImageFilter.h"
+#include "SkMagnifierImageFilter.h"
 #include "SkMatrixConvolutionImageFilter.h"
 #include "SkMatrixImageFilter.h"
 #include "SkMergeImageFilter.h"
@@ -29,6 +31,7 @@
 #include "SkPictureImageFilter.h"
 #include "SkPictureRecorder.h"
 #include "SkRect.h"
+#include "SkTableColorFilter.h"
 #include "SkTileImageFilter.h"
 #include "SkXfermodeImageFilter.h"
 #include "Test.h"
@@ -72,6 +75,33 @@ private:
     SkMatrix fExpectedMatrix;
 };
 
+class CountingImageFilter : public SkImageFilter {
+public:
+    explicit CountingImageFilter(int* count) : SkImageFilter(0), fCount(count) {}
+
+    virtual bool onFilterImage(Proxy*, const SkBitmap& src, const Context&,
+                               SkBitmap* result, SkIPoint* offset) const SK_OVERRIDE {
+        ++*fCount;
+        *result = src;
+        offset->set(0, 0);
+        return true;
+    }
+
+    SK_DECLARE_PUBLIC_FLATTENABLE_DESERIALIZATION_PROCS(CountingImageFilter)
+
+protected:
+    explicit CountingImageFilter(SkReadBuffer& buffer) : SkImageFilter(0) {
+        fCount = static_cast<int*>(buffer.readFunctionPtr());
+    }
+
+    virtual void flatten(SkWriteBuffer& buffer) const SK_OVERRIDE {
+        buffer.writeFunctionPtr(fCount);
+    }
+
+private:
+    int* fCount;
+};
+
 }
 
 static void make_small_bitmap(SkBitmap& bitmap) {
@@ -143,6 +173,54 @@ DEF_TEST(ImageFilter, reporter) {
         REPORTER_ASSERT(reporter, NULL != halfBrightness->getInput(0));
     }
 
+    {
+        // Check that concatenated color matrices apply the input's matrix first.
+        SkScalar swap[20] = { 0, 1, 0, 0, 0,
+                              1, 0, 0, 0, 0,
+                              0, 0, 1, 0, 0,
+                              0, 0, 0, 1, 0 };
+        SkScalar dimRed[20] = { 0.5f, 0, 0, 0, 0,
+                                0,    1, 0, 0, 0,
+                                0,    0, 1, 0, 0,
+                                0,    0, 0, 1, 0 };
+        SkAutoTUnref<SkColorFilter> swapFilter(SkColorMatrixFilter::Create(swap));
+        SkAutoTUnref<SkColorFilter> dimRedFilter(SkColorMatrixFilter::Create(dimRed));
+        SkAutoTUnref<SkImageFilter> swapped(SkColorFilterImageFilter::Create(swapFilter));
+        SkAutoTUnref<SkImageFilter> dimmed(SkColorFilterImageFilter::Create(dimRedFilter,
+                                                                            swapped));
+        SkColorFilter* combined;
+        REPORTER_ASSERT(reporter, NULL == dimmed->getInput(0));
+        REPORTER_ASSERT(reporter, dimmed->asColorFilter(&combined));
+        SkColor color = combined->filterColor(SkColorSetARGB(0xFF, 0, 0xFF, 0));
+        REPORTER_ASSERT(reporter, SkColorGetR(color) < 0xFF && 0 == SkColorGetG(color));
+        combined->unref();
+    }
+
+    {
+        // Check that two table filters concatenate into a single filter, unless
+        // the input's can make colors transparent.
+        uint8_t darken[256], invert[256], opaque[256];
+        for (int i = 0; i < 256; ++i) {
+            darken[i] = i / 2;
+            invert[i] = 255 - i;
+            opaque[i] = 255;
+        }
+        SkAutoTUnref<SkColorFilter> darkenRGB(SkTableColorFilter::CreateARGB(NULL, darken,
+                                                                             darken, darken));
+        SkAutoTUnref<SkColorFilter> invertAll(SkTableColorFilter::Create(invert));
+        SkAutoTUnref<SkColorFilter> makeOpaque(SkTableColorFilter::CreateARGB(opaque, NULL,
+                                                                              NULL, NULL));
+        SkAutoTUnref<SkImageFilter> darkened(SkColorFilterImageFilter::Create(darkenRGB));
+        SkAutoTUnref<SkImageFilter> opaqued(SkColorFilterImageFilter::Create(makeOpaque,
+                                                                             darkened));
+        REPORTER_ASSERT(reporter, NULL == opaqued->getInput(0));
+
+        SkAutoTUnref<SkImageFilter> allInverted(SkColorFilterImageFilter::Create(invertAll));
+        SkAutoTUnref<SkImageFilter> allOpaqued(SkColorFilterImageFilter::Create(makeOpaque,
+                                                                                allInverted));
+        REPORTER_ASSERT(reporter, NULL != allOpaqued->getInput(0));
+    }
+
     {
         // Check that a color filter image filter without a crop rect can be
         // expressed as a color filter.
@@ -399,6 +477,43 @@ DEF_TEST(ImageFilterDrawTiled, reporter) {
     }
 }
 
+DEF_TEST(ImageFilterSharedInput, reporter) {
+    // A filter used by several inputs of the same DAG is only evaluated once per source.
+    int count = 0;
+    SkAutoTUnref<SkImageFilter> counting(SkNEW_ARGS(CountingImageFilter, (&count)));
+    SkImageFilter* inputs[] = { counting.get(), counting.get(), counting.get() };
+    SkAutoTUnref<SkImageFilter> merge(SkMergeImageFilter::Create(inputs, SK_ARRAY_COUNT(inputs)));
+
+    SkBitmap bitmap;
+    make_small_bitmap(bitmap);
+    SkBitmapDevice device(bitmap);
+    SkDeviceImageFilterProxy proxy(&device);
+    SkBitmap result;
+    SkIPoint offset;
+    {
+        SkAutoTUnref<SkImageFilter::Cache> cache(SkImageFilter::Cache::Create(2));
+        SkImageFilter::Context ctx(SkMatrix::I(), SkIRect::MakeWH(kBitmapSize, kBitmapSize),
+                                   cache.get());
+        REPORTER_ASSERT(reporter, merge->filterImage(&proxy, bitmap, ctx, &result, &offset));
+        REPORTER_ASSERT(reporter, 1 == count);
+    }
+
+    // Under a compose the filter sees the inner result instead, so it has to run for both.
+    count = 0;
+    SkAutoTUnref<SkImageFilter> scale(make_scale(0.5f));
+    SkAutoTUnref<SkImageFilter> compose(SkComposeImageFilter::Create(counting, scale));
+    SkImageFilter* mixed[] = { counting.get(), compose.get() };
+    SkAutoTUnref<SkImageFilter> mixedMerge(SkMergeImageFilter::Create(mixed,
+                                                                      SK_ARRAY_COUNT(mixed)));
+    {
+        SkAutoTUnref<SkImageFilter::Cache> cache(SkImageFilter::Cache::Create(2));
+        SkImageFilter::Context ctx(SkMatrix::I(), SkIRect::MakeWH(kBitmapSize, kBitmapSize),
+                                   cache.get());
+        REPORTER_ASSERT(reporter, mixedMerge->filterImage(&proxy, bitmap, ctx, &result, &offset));
+        REPORTER_ASSERT(reporter, 2 == count);
+    }
+}
+
 DEF_TEST(ImageFilterMatrixConvolution, reporter) {
     // Check that a 1x3 filter does not cause a spurious assert.
     SkScalar kernel[3] = {
@@ -736,6 +851,48 @@ DEF_TEST(XfermodeImageFilterCroppedInput, reporter) {
 }
 
 #if SK_SUPPORT_GPU
+DEF_TEST(ImageFilterGraphGPU, reporter) {
+    SkAutoTUnref<SkImageFilter> blur(SkBlurImageFilter::Create(3, 3));
+    SkAutoTUnref<SkImageFilter> dilate(SkDilateImageFilter::Create(2, 2, blur));
+    SkAutoTUnref<SkImageFilter> offset(SkOffsetImageFilter::Create(5, 5, dilate));
+    SkAutoTUnref<SkImageFilter> gray(make_grayscale());
+    SkAutoTUnref<SkImageFilter> tile(SkTileImageFilter::Create(SkRect::MakeWH(10, 10),
+                                                               SkRect::MakeWH(50, 50), gray));
+    SkAutoTUnref<SkImageFilter> merge(SkMergeImageFilter::Create(offset, tile));
+    const SkImageFilter* cpuFilter = NULL;
+    REPORTER_ASSERT(reporter, merge->canFilterGraphGPU(&cpuFilter));
+    REPORTER_ASSERT(reporter, NULL == cpuFilter);
+
+    // A filter that only has onFilterImage() needs the pixels, wherever it is in the DAG.
+    int count = 0;
+    SkAutoTUnref<SkImageFilter> counting(SkNEW_ARGS(CountingImageFilter, (&count)));
+    SkAutoTUnref<SkImageFilter> composed(SkComposeImageFilter::Create(blur, counting));
+    SkAutoTUnref<SkImageFilter> merged(SkMergeImageFilter::Create(merge, composed));
+    REPORTER_ASSERT(reporter, !merged->canFilterGraphGPU(&cpuFilter));
+    REPORTER_ASSERT(reporter, counting.get() == cpuFilter);
+
+    // Which vetoes recording the picture for the GPU.
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(100, 100, NULL, 0);
+    SkPaint paint;
+    paint.setImageFilter(merge);
+    canvas->saveLayer(NULL, &paint);
+    canvas->drawRect(SkRect::MakeWH(50, 50), SkPaint());
+    canvas->restore();
+    SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+    REPORTER_ASSERT(reporter, picture->suitableForGpuRasterization(NULL));
+
+    canvas = recorder.beginRecording(100, 100, NULL, 0);
+    paint.setImageFilter(merged);
+    canvas->saveLayer(NULL, &paint);
+    canvas->drawRect(SkRect::MakeWH(50, 50), SkPaint());
+    canvas->restore();
+    picture.reset(recorder.endRecording());
+    const char* reason = NULL;
+    REPORTER_ASSERT(reporter, !picture->suitableForGpuRasterization(NULL, &reason));
+    REPORTER_ASSERT(reporter, NULL != reason);
+}
+
 DEF_GPUTEST(ImageFilterCropRectGPU, reporter, factory) {
     GrContext* context = factory->get(static_cast<GrContextFactory::GLContextType>(0));
     SkAutoTUnref<SkGpuDevice> device(SkGpuDevice::Create(context,
@@ -752,6 +909,95 @@ DEF_GPUTEST(HugeBlurImageFilterGPU, reporter, factory) {
     test_huge_blur(device, reporter);
 }
 
+// A 256x256 opaque bitmap whose red is x and whose green is y, so that reading
+// from a pixel off by one changes a channel by one.
+static void make_ramp(SkBitmap* bitmap) {
+    bitmap->allocN32Pixels(256, 256);
+    for (int y = 0; y < 256; ++y) {
+        for (int x = 0; x < 256; ++x) {
+            *bitmap->getAddr32(x, y) = SkPackARGB32(0xFF, x, y, 0x80);
+        }
+    }
+}
+
+static void draw_filtered(SkBaseDevice* device, const SkBitmap& bitmap, SkImageFilter* filter,
+                          SkBitmap* result) {
+    SkCanvas canvas(device);
+    canvas.clear(0);
+    SkPaint paint;
+    paint.setImageFilter(filter);
+    canvas.drawSprite(bitmap, 0, 0, &paint);
+    result->allocN32Pixels(bitmap.width(), bitmap.height());
+    canvas.readPixels(result->info(), result->getPixels(), result->rowBytes(), 0, 0);
+}
+
+// Checks that the raster and GPU versions of filter agree within tolerance
+// per channel over area, which avoids the edges where they sample differently.
+static void test_gpu_parity(GrContext* context, SkImageFilter* filter, const SkIRect& area,
+                            int tolerance, skiatest::Reporter* reporter) {
+    SkBitmap ramp;
+    make_ramp(&ramp);
+    SkBitmap temp;
+    temp.allocN32Pixels(ramp.width(), ramp.height());
+    SkBitmapDevice rasterDevice(temp);
+    SkAutoTUnref<SkGpuDevice> gpuDevice(SkGpuDevice::Create(context, temp.info(), 0));
+    SkBitmap raster, gpu;
+    draw_filtered(&rasterDevice, ramp, filter, &raster);
+    draw_filtered(gpuDevice, ramp, filter, &gpu);
+
+    int maxDiff = 0;
+    for (int y = area.top(); y < area.bottom(); ++y) {
+        for (int x = area.left(); x < area.right(); ++x) {
+            SkPMColor r = *raster.getAddr32(x, y), g = *gpu.getAddr32(x, y);
+            maxDiff = SkMax32(maxDiff, SkAbs32(SkGetPackedA32(r) - SkGetPackedA32(g)));
+            maxDiff = SkMax32(maxDiff, SkAbs32(SkGetPackedR32(r) - SkGetPackedR32(g)));
+            maxDiff = SkMax32(maxDiff, SkAbs32(SkGetPackedG32(r) - SkGetPackedG32(g)));
+            maxDiff = SkMax32(maxDiff, SkAbs32(SkGetPackedB32(r) - SkGetPackedB32(g)));
+        }
+    }
+    REPORTER_ASSERT(reporter, maxDiff <= tolerance);
+}
+
+DEF_GPUTEST(ImageFilterDisplacementMapGPUParity, reporter, factory) {
+    GrContext* context = factory->get(static_cast<GrContextFactory::GLContextType>(0));
+    if (NULL == context) {
+        return;
+    }
+    // A smooth displacement of up to 8 pixels. The GPU floors where the raster
+    // version truncates, so they may read pixels one apart.
+    SkBitmap map;
+    map.allocN32Pixels(256, 256);
+    for (int y = 0; y < 256; ++y) {
+        for (int x = 0; x < 256; ++x) {
+            *map.getAddr32(x, y) = SkPackARGB32(0xFF, 255 - y, x, (x + y) / 2);
+        }
+    }
+    SkAutoTUnref<SkImageFilter> mapSource(SkBitmapSource::Create(map));
+    static const SkDisplacementMapEffect::ChannelSelectorType kChannels[] = {
+        SkDisplacementMapEffect::kR_ChannelSelectorType,
+        SkDisplacementMapEffect::kG_ChannelSelectorType,
+        SkDisplacementMapEffect::kB_ChannelSelectorType,
+    };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kChannels); ++i) {
+        SkAutoTUnref<SkImageFilter> displacement(SkDisplacementMapEffect::Create(
+            kChannels[i], kChannels[(i + 1) % SK_ARRAY_COUNT(kChannels)], 16, mapSource));
+        test_gpu_parity(context, displacement, SkIRect::MakeLTRB(16, 16, 240, 240), 2,
+                        reporter);
+    }
+}
+
+DEF_GPUTEST(ImageFilterMagnifierGPUParity, reporter, factory) {
+    GrContext* context = factory->get(static_cast<GrContextFactory::GLContextType>(0));
+    if (NULL == context) {
+        return;
+    }
+    // The GPU measures the lens from pixel centers, half a pixel further from
+    // the edges, which moves pixels near the inset by up to a few pixels.
+    SkAutoTUnref<SkImageFilter> magnifier(SkMagnifierImageFilter::Create(
+        SkRect::MakeXYWH(64, 64, 128, 128), 16));
+    test_gpu_parity(context, magnifier, SkIRect::MakeLTRB(1, 1, 255, 255), 8, reporter);
+}
+
 DEF_GPUTEST(XfermodeImageFilterCroppedInputGPU, reporter, factory) {
     GrContext* context = factory->get(static_cast<GrContextFactory::GLContextType>(0));
     SkAutoTUnref<SkGpuDevice> device(SkGpuDevice::Create(context,
@@ -6,10 +6,12 @@
  */
 
 #include "SkBitmap.h"
+#include "SkColorPriv.h"
 #include "SkData.h"
 #include "SkForceLinking.h"
 #include "SkImage.h"
 #include "SkImageDecoder.h"
+#include "SkImageEncoder.h"
 #include "SkStream.h"
 #include "Test.h"
 
@@ -447,3 +449,67 @@ DEF_TEST(Jpeg, reporter) {
     SkASSERT(writeSuccess);
     #endif
 }
+
+/**
+  The YUV planes of a JPEG, converted to RGB, should give back the pixels of
+  a regular decode.
+*/
+DEF_TEST(Jpeg_YUV8Planes, reporter) {
+    const int width = 37, height = 21;
+    SkBitmap src;
+    src.allocN32Pixels(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            *src.getAddr32(x, y) = SkPackARGB32(0xFF, (x * 7) & 0xFF, (y * 11) & 0xFF,
+                                                ((x + y) * 3) & 0xFF);
+        }
+    }
+    SkAutoTUnref<SkData> encoded(SkImageEncoder::EncodeData(src, SkImageEncoder::kJPEG_Type,
+                                                            90));
+    REPORTER_ASSERT(reporter, NULL != encoded.get());
+    if (NULL == encoded.get()) {
+        return;
+    }
+
+    SkMemoryStream stream(encoded);
+    SkAutoTDelete<SkImageDecoder> decoder(SkImageDecoder::Factory(&stream));
+    REPORTER_ASSERT(reporter, NULL != decoder.get());
+    if (NULL == decoder.get()) {
+        return;
+    }
+
+    SkISize sizes[3];
+    REPORTER_ASSERT(reporter, stream.rewind());
+    if (!decoder->decodeYUV8Planes(&stream, sizes, NULL, NULL)) {
+        // Not every build of libjpeg gives out raw data.
+        return;
+    }
+    REPORTER_ASSERT(reporter, sizes[0] == SkISize::Make(width, height));
+    REPORTER_ASSERT(reporter, sizes[1] == sizes[2]);
+
+    SkAutoMalloc storage[3];
+    void* planes[3];
+    size_t rowBytes[3];
+    for (int i = 0; i < 3; ++i) {
+        rowBytes[i] = sizes[i].width();
+        planes[i] = storage[i].reset(rowBytes[i] * sizes[i].height());
+    }
+    REPORTER_ASSERT(reporter, stream.rewind());
+    REPORTER_ASSERT(reporter, decoder->decodeYUV8Planes(&stream, sizes, planes, rowBytes));
+
+    SkBitmap decoded;
+    REPORTER_ASSERT(reporter, SkImageDecoder::DecodeMemory(encoded->data(), encoded->size(),
+                                                           &decoded));
+    SkAutoLockPixels alp(decoded);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int cx = x * sizes[1].width() / width;
+            int cy = y * sizes[1].height() / height;
+            int lum = static_cast<uint8_t*>(planes[0])[y * rowBytes[0] + x];
+            int cr = static_cast<uint8_t*>(planes[2])[cy * rowBytes[2] + cx] - 128;
+            int r = SkTMax(0, SkTMin(255, lum + (1436 * cr + 512) / 1024));
+            int expected = SkGetPackedR32(*decoded.getAddr32(x, y));
+            REPORTER_ASSERT(reporter, SkAbs32(r - expected) <= 1);
+        }
+    }
+}
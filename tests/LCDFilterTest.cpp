@@ -0,0 +1,89 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkColorPriv.h"
+#include "SkLCDFilter.h"
+#include "SkRandom.h"
+#include "Test.h"
+
+// A copy of the coefficients in SkLCDFilter.cpp, to check the platform procs against.
+static const uint8_t gCoefficients[3][12] = {
+    { 0x03, 0x0b, 0x1c, 0x33,  0x40, 0x39, 0x24, 0x10,  0x05, 0x01, 0x00, 0x00, },
+    { 0x00, 0x02, 0x08, 0x16,  0x2b, 0x3d, 0x3d, 0x2b,  0x16, 0x08, 0x02, 0x00, },
+    { 0x00, 0x00, 0x01, 0x05,  0x10, 0x24, 0x39, 0x40,  0x33, 0x1c, 0x0b, 0x03, },
+};
+
+static uint8_t reference_fir(const uint8_t samples[], int channel) {
+    unsigned sum = 0;
+    for (int k = 0; k < 12; ++k) {
+        sum += gCoefficients[channel][k] * samples[k];
+    }
+    return SkTMin(sum >> 8, 255u);
+}
+
+static void test_filter_row(skiatest::Reporter* reporter, const SkLCDFilter& filter,
+                            SkRandom* rand) {
+    // Odd widths, so SIMD procs have leftovers.
+    static const int kWidths[] = { 1, 2, 7, 8, 9, 33 };
+    for (size_t w = 0; w < SK_ARRAY_COUNT(kWidths); ++w) {
+        const int width = kWidths[w];
+        SkAutoTMalloc<uint8_t> padded(SkLCDFilter::PaddedSampleCount(width));
+        sk_bzero(padded.get(), SkLCDFilter::PaddedSampleCount(width));
+        for (int i = 0; i < 4 * width; ++i) {
+            // Mostly full coverage, to exercise the clamp.
+            padded[8 + i] = rand->nextBool() ? 0xFF : rand->nextU() & 0xFF;
+        }
+
+        SkAutoTMalloc<uint8_t> r(width), g(width), b(width);
+        filter.filterRow(padded.get(), width, r.get(), g.get(), b.get());
+        for (int i = 0; i < width; ++i) {
+            const uint8_t* samples = padded.get() + 4 * i;
+            REPORTER_ASSERT(reporter, reference_fir(samples, 0) == r[i]);
+            REPORTER_ASSERT(reporter, reference_fir(samples, 1) == g[i]);
+            REPORTER_ASSERT(reporter, reference_fir(samples, 2) == b[i]);
+        }
+    }
+}
+
+static void test_pack_row(skiatest::Reporter* reporter, const SkLCDFilter& filter,
+                          SkRandom* rand) {
+    static const int kWidth = 37;
+    uint8_t r[kWidth], g[kWidth], b[kWidth];
+    for (int i = 0; i < kWidth; ++i) {
+        r[i] = rand->nextU() & 0xFF;
+        g[i] = rand->nextU() & 0xFF;
+        b[i] = rand->nextU() & 0xFF;
+    }
+    // Every count up to kWidth, so all the SIMD tails are covered.
+    for (int count = 0; count <= kWidth; ++count) {
+        uint16_t dst[kWidth + 1];
+        dst[count] = 0xBEEF;
+        filter.packRow(r, g, b, dst, count);
+        for (int i = 0; i < count; ++i) {
+            REPORTER_ASSERT(reporter, SkPack888ToRGB16(r[i], g[i], b[i]) == dst[i]);
+        }
+        REPORTER_ASSERT(reporter, 0xBEEF == dst[count]);
+    }
+}
+
+static void test_apply_lut(skiatest::Reporter* reporter) {
+    uint8_t lut[256];
+    for (int i = 0; i < 256; ++i) {
+        lut[i] = 255 - i;
+    }
+    uint8_t row[] = { 0, 1, 128, 255 };
+    SkLCDFilter::ApplyLUT(row, SK_ARRAY_COUNT(row), lut);
+    REPORTER_ASSERT(reporter, 255 == row[0] && 254 == row[1] && 127 == row[2] && 0 == row[3]);
+}
+
+DEF_TEST(LCDFilter, reporter) {
+    const SkLCDFilter filter;
+    SkRandom rand;
+    test_filter_row(reporter, filter, &rand);
+    test_pack_row(reporter, filter, &rand);
+    test_apply_lut(reporter);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTLRUByteCache.h"
+#include "Test.h"
+
+namespace {
+
+struct Rec {
+    Rec(int key, size_t bytes) : fKey(key), fBytes(bytes) { ++gLive; }
+    ~Rec() { --gLive; }
+
+    static const int& GetKey(const Rec& rec) { return rec.fKey; }
+    static uint32_t Hash(const int& key) { return key; }
+    size_t bytesUsed() const { return fBytes; }
+
+    const int   fKey;
+    size_t      fBytes;
+
+    static int gLive;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Rec);
+};
+
+int Rec::gLive = 0;
+
+typedef SkTLRUByteCache<Rec, int> Cache;
+
+}  // namespace
+
+DEF_TEST(LRUByteCache, reporter) {
+    {
+        Cache cache(30);
+        cache.add(SkNEW_ARGS(Rec, (1, 10)));
+        cache.add(SkNEW_ARGS(Rec, (2, 10)));
+        cache.add(SkNEW_ARGS(Rec, (3, 10)));
+        REPORTER_ASSERT(reporter, 30 == cache.bytesUsed());
+        REPORTER_ASSERT(reporter, 3 == Rec::gLive);
+
+        // Finding 1 makes 2 the least recently used, so 2 goes to make room for 4.
+        REPORTER_ASSERT(reporter, NULL != cache.find(1));
+        cache.add(SkNEW_ARGS(Rec, (4, 10)));
+        REPORTER_ASSERT(reporter, NULL == cache.find(2));
+        REPORTER_ASSERT(reporter, NULL != cache.find(1));
+        REPORTER_ASSERT(reporter, NULL != cache.find(3));
+        REPORTER_ASSERT(reporter, NULL != cache.find(4));
+        REPORTER_ASSERT(reporter, 30 == cache.bytesUsed());
+        REPORTER_ASSERT(reporter, 3 == Rec::gLive);
+
+        // Growing 4 past the limit pushes out the least recently used, now 1 and 3.
+        Rec* rec = cache.find(4);
+        size_t prevBytes = rec->bytesUsed();
+        rec->fBytes = 25;
+        cache.resized(rec, prevBytes);
+        REPORTER_ASSERT(reporter, NULL == cache.find(1));
+        REPORTER_ASSERT(reporter, NULL == cache.find(3));
+        REPORTER_ASSERT(reporter, rec == cache.find(4));
+        REPORTER_ASSERT(reporter, 25 == cache.bytesUsed());
+        REPORTER_ASSERT(reporter, 1 == Rec::gLive);
+
+        // A rec over the limit on its own doesn't stay.
+        REPORTER_ASSERT(reporter, 30 == cache.setByteLimit(20));
+        REPORTER_ASSERT(reporter, 0 == cache.bytesUsed());
+        REPORTER_ASSERT(reporter, 0 == Rec::gLive);
+
+        cache.add(SkNEW_ARGS(Rec, (5, 10)));
+        cache.purgeAll();
+        REPORTER_ASSERT(reporter, NULL == cache.find(5));
+        REPORTER_ASSERT(reporter, 0 == cache.bytesUsed());
+        REPORTER_ASSERT(reporter, 0 == Rec::gLive);
+
+        cache.add(SkNEW_ARGS(Rec, (6, 10)));
+    }
+    // The cache deletes what is left in it.
+    REPORTER_ASSERT(reporter, 0 == Rec::gLive);
+}
+
+DEF_TEST(LRUByteCache_Pinned, reporter) {
+    {
+        Cache cache(20);
+        cache.add(SkNEW_ARGS(Rec, (1, 10)), true);
+        cache.add(SkNEW_ARGS(Rec, (2, 10)));
+        cache.add(SkNEW_ARGS(Rec, (3, 10)));
+        // The pinned rec doesn't count towards the limit.
+        REPORTER_ASSERT(reporter, 20 == cache.bytesUsed());
+        REPORTER_ASSERT(reporter, 3 == Rec::gLive);
+
+        // Pinning 2 takes its bytes out of the count, and it stays whatever the limit.
+        cache.pin(cache.find(2));
+        REPORTER_ASSERT(reporter, 10 == cache.bytesUsed());
+        cache.setByteLimit(0);
+        REPORTER_ASSERT(reporter, NULL != cache.find(1));
+        REPORTER_ASSERT(reporter, NULL != cache.find(2));
+        REPORTER_ASSERT(reporter, NULL == cache.find(3));
+        REPORTER_ASSERT(reporter, 0 == cache.bytesUsed());
+        REPORTER_ASSERT(reporter, 2 == Rec::gLive);
+
+        // Pinned recs only go with purgeAll().
+        cache.purgeAll();
+        REPORTER_ASSERT(reporter, NULL == cache.find(1));
+        REPORTER_ASSERT(reporter, NULL == cache.find(2));
+        REPORTER_ASSERT(reporter, 0 == Rec::gLive);
+
+        cache.add(SkNEW_ARGS(Rec, (4, 10)), true);
+    }
+    REPORTER_ASSERT(reporter, 0 == Rec::gLive);
+}
+
+DEF_TEST(LRUByteCache_SecondSighting, reporter) {
+    {
+        Cache cache(1000, Cache::kSecondSighting_AdmitPolicy);
+
+        // The first miss only remembers the key, the second lets it in.
+        REPORTER_ASSERT(reporter, !cache.admit(1));
+        REPORTER_ASSERT(reporter, 0 == Rec::gLive);
+        REPORTER_ASSERT(reporter, 0 != cache.bytesUsed());
+        REPORTER_ASSERT(reporter, cache.admit(1));
+        REPORTER_ASSERT(reporter, 0 == cache.bytesUsed());
+        cache.add(SkNEW_ARGS(Rec, (1, 10)));
+        REPORTER_ASSERT(reporter, 10 == cache.bytesUsed());
+
+        // Remembered keys take up at most a quarter of the limit, so the oldest are forgotten.
+        for (int key = 2; key < 1000; key++) {
+            REPORTER_ASSERT(reporter, !cache.admit(key));
+        }
+        REPORTER_ASSERT(reporter, cache.bytesUsed() <= 10 + 1000 / 4);
+        REPORTER_ASSERT(reporter, !cache.admit(2));
+        REPORTER_ASSERT(reporter, cache.admit(999));
+        REPORTER_ASSERT(reporter, NULL != cache.find(1));
+
+        // purgeAll() forgets remembered keys too.
+        REPORTER_ASSERT(reporter, !cache.admit(5000));
+        cache.purgeAll();
+        REPORTER_ASSERT(reporter, 0 == cache.bytesUsed());
+        REPORTER_ASSERT(reporter, !cache.admit(5000));
+    }
+    REPORTER_ASSERT(reporter, 0 == Rec::gLive);
+
+    // By default every key is let in.
+    Cache cache(1000);
+    REPORTER_ASSERT(reporter, cache.admit(1));
+    REPORTER_ASSERT(reporter, 0 == cache.bytesUsed());
+}
@@ -5,10 +5,14 @@
  * found in the LICENSE file.
  */
 
+#include "SkBlurMaskFilter.h"
 #include "SkDeque.h"
 #include "SkLayerRasterizer.h"
+#include "SkMask.h"
 #include "SkPaint.h"
+#include "SkPath.h"
 #include "SkRasterizer.h"
+#include "SkXfermode.h"
 #include "Test.h"
 
 class SkReadBuffer;
@@ -142,3 +146,77 @@ DEF_TEST(LayerRasterizer_detachEmpty, reporter) {
     SkLayerRasterizer::Builder builder;
     REPORTER_ASSERT(reporter, NULL == builder.detachRasterizer());
 }
+
+// Builds layers that differ only by offset, color and xfermode. When shareMaskFilter is false,
+// each layer gets its own (identical) mask filter, which keeps them from sharing coverage.
+static SkLayerRasterizer* make_offset_layers(bool shareMaskFilter) {
+    SkAutoTUnref<SkMaskFilter> blur(SkBlurMaskFilter::Create(kNormal_SkBlurStyle, 1.5f));
+    static const struct {
+        SkColor         fColor;
+        SkXfermode::Mode fMode;
+        SkScalar        fDX, fDY;
+    } gLayers[] = {
+        { 0x80000000, SkXfermode::kSrcOver_Mode,  0,  0 },
+        { 0xFF000000, SkXfermode::kSrcOver_Mode,  2,  1 },
+        { 0xFF000000, SkXfermode::kClear_Mode,    0,  0 },
+        { 0x40000000, SkXfermode::kXor_Mode,     -1,  3 },
+    };
+    SkLayerRasterizer::Builder builder;
+    for (size_t i = 0; i < SK_ARRAY_COUNT(gLayers); ++i) {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setColor(gLayers[i].fColor);
+        paint.setXfermodeMode(gLayers[i].fMode);
+        if (shareMaskFilter) {
+            paint.setMaskFilter(blur);
+        } else {
+            paint.setMaskFilter(SkBlurMaskFilter::Create(kNormal_SkBlurStyle, 1.5f))->unref();
+        }
+        builder.addLayer(paint, gLayers[i].fDX, gLayers[i].fDY);
+    }
+    return builder.detachRasterizer();
+}
+
+// Layers that share the rasterized coverage of the path must draw the same mask as layers that
+// rasterize it themselves.
+DEF_TEST(LayerRasterizer_sharedCoverage, reporter) {
+    SkAutoTUnref<SkLayerRasterizer> shared(make_offset_layers(true));
+    SkAutoTUnref<SkLayerRasterizer> separate(make_offset_layers(false));
+
+    SkPath path;
+    path.addCircle(20.3f, 18.7f, 11);
+    path.addRect(4, 30, 27.5f, 41);
+
+    // Whole pixel offsets can be shared at 2x; at 1.5x only some of them can.
+    const SkScalar scales[] = { SK_Scalar1, 2, 1.5f };
+    const SkIRect clips[] = { SkIRect::MakeLTRB(-100, -100, 200, 200),
+                              SkIRect::MakeLTRB(10, 10, 30, 30) };
+    for (size_t s = 0; s < SK_ARRAY_COUNT(scales); ++s) {
+        for (size_t c = 0; c < SK_ARRAY_COUNT(clips); ++c) {
+            SkMatrix matrix;
+            matrix.setScale(scales[s], scales[s]);
+            matrix.postTranslate(3, 5);
+
+            SkMask sharedMask, separateMask;
+            REPORTER_ASSERT(reporter, shared->rasterize(path, matrix, &clips[c], NULL,
+                    &sharedMask, SkMask::kComputeBoundsAndRenderImage_CreateMode));
+            REPORTER_ASSERT(reporter, separate->rasterize(path, matrix, &clips[c], NULL,
+                    &separateMask, SkMask::kComputeBoundsAndRenderImage_CreateMode));
+            SkAutoMaskFreeImage freeShared(sharedMask.fImage);
+            SkAutoMaskFreeImage freeSeparate(separateMask.fImage);
+
+            REPORTER_ASSERT(reporter, sharedMask.fBounds == separateMask.fBounds);
+            if (sharedMask.fBounds != separateMask.fBounds) {
+                continue;
+            }
+            int maxDiff = 0;
+            for (int y = sharedMask.fBounds.fTop; y < sharedMask.fBounds.fBottom; ++y) {
+                for (int x = sharedMask.fBounds.fLeft; x < sharedMask.fBounds.fRight; ++x) {
+                    int diff = *sharedMask.getAddr8(x, y) - *separateMask.getAddr8(x, y);
+                    maxDiff = SkTMax(maxDiff, SkAbs32(diff));
+                }
+            }
+            REPORTER_ASSERT(reporter, maxDiff <= 1);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkLayer.h"
+#include "Test.h"
+
+namespace {
+// Fills itself with a color, and counts how often it had to.
+class ColorLayer : public SkLayer {
+public:
+    explicit ColorLayer(SkColor color) : fColor(color), fDrawCount(0) {}
+
+    SkColor fColor;
+    int fDrawCount;
+
+protected:
+    virtual void onDraw(SkCanvas* canvas, SkScalar opacity) SK_OVERRIDE {
+        fDrawCount++;
+        canvas->drawColor(fColor);
+    }
+};
+}
+
+DEF_TEST(Layer_CachedContent, reporter) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(40, 40);
+    SkCanvas canvas(bitmap);
+
+    SkAutoTUnref<ColorLayer> layer(SkNEW_ARGS(ColorLayer, (SK_ColorRED)));
+    layer->setSize(10, 10);
+    layer->setCachesContent(true);
+
+    bitmap.eraseColor(SK_ColorWHITE);
+    layer->draw(&canvas);
+    REPORTER_ASSERT(reporter, 1 == layer->fDrawCount);
+    REPORTER_ASSERT(reporter, SK_ColorRED == bitmap.getColor(5, 5));
+
+    // Moving and fading the layer reuses its content.
+    layer->setPosition(20, 20);
+    layer->setOpacity(SK_Scalar1 / 2);
+    bitmap.eraseColor(SK_ColorWHITE);
+    layer->draw(&canvas);
+    REPORTER_ASSERT(reporter, 1 == layer->fDrawCount);
+    REPORTER_ASSERT(reporter, SK_ColorWHITE == bitmap.getColor(5, 5));
+    SkColor faded = bitmap.getColor(25, 25);
+    REPORTER_ASSERT(reporter, 0xFF == SkColorGetR(faded));
+    REPORTER_ASSERT(reporter, SkColorGetG(faded) > 0x70 && SkColorGetG(faded) < 0x90);
+
+    // Only the invalid part is drawn again.
+    layer->setPosition(0, 0);
+    layer->setOpacity(SK_Scalar1);
+    layer->fColor = SK_ColorBLUE;
+    layer->invalidate(SkRect::MakeWH(5, 10));
+    bitmap.eraseColor(SK_ColorWHITE);
+    layer->draw(&canvas);
+    REPORTER_ASSERT(reporter, 2 == layer->fDrawCount);
+    REPORTER_ASSERT(reporter, SK_ColorBLUE == bitmap.getColor(2, 5));
+    REPORTER_ASSERT(reporter, SK_ColorRED == bitmap.getColor(7, 5));
+
+    // A new size needs new content.
+    layer->setSize(20, 20);
+    layer->draw(&canvas);
+    REPORTER_ASSERT(reporter, 3 == layer->fDrawCount);
+    REPORTER_ASSERT(reporter, SK_ColorBLUE == bitmap.getColor(15, 15));
+
+    layer->setCachesContent(false);
+    layer->draw(&canvas);
+    layer->draw(&canvas);
+    REPORTER_ASSERT(reporter, 5 == layer->fDrawCount);
+}
@@ -696,6 +696,50 @@ static void test_matrix_homogeneous(skiatest::Reporter* reporter) {
 
 }
 
+// mapPoints() maps arrays a vector at a time, with a scalar tail; every count
+// should give the same points as mapping each one alone with mapXY().
+static void test_matrix_map_points(skiatest::Reporter* reporter) {
+    SkMatrix mats[5];
+    mats[0].setTranslate(10.5f, -3.25f);
+    mats[1].setScale(2.5f, -0.75f);
+    mats[2].setScale(2.5f, -0.75f, 7, 11);
+    mats[3].setRotate(30);
+    mats[4].setRotate(-75, 13, 4);
+
+    const int kMaxCount = 11;
+    SkRandom rand;
+    SkPoint src[kMaxCount], dst[kMaxCount];
+    for (size_t m = 0; m < SK_ARRAY_COUNT(mats); ++m) {
+        for (int count = 0; count <= kMaxCount; ++count) {
+            for (int i = 0; i < count; ++i) {
+                src[i].set(rand.nextRangeF(-1000, 1000), rand.nextRangeF(-1000, 1000));
+            }
+            mats[m].mapPoints(dst, src, count);
+            bool success = true;
+            for (int i = 0; i < count; ++i) {
+                SkPoint expected;
+                mats[m].mapXY(src[i].fX, src[i].fY, &expected);
+                success &= expected == dst[i];
+            }
+            // In place.
+            mats[m].mapPoints(src, count);
+            success &= 0 == memcmp(src, dst, count * sizeof(SkPoint));
+            REPORTER_ASSERT(reporter, success);
+        }
+    }
+
+    // With perspective, points whose w is zero map to the origin.
+    SkMatrix persp;
+    persp.setAll(1, 0, 0, 0, 1, 0, SK_Scalar1 / 100, 0, 0);
+    SkPoint pts[3] = { { 0, 5 }, { 100, 5 }, { -200, 10 } };
+    persp.mapPoints(pts, SK_ARRAY_COUNT(pts));
+    REPORTER_ASSERT(reporter, pts[0] == SkPoint::Make(0, 0));
+    REPORTER_ASSERT(reporter, nearly_equal_scalar(pts[1].fX, 100) &&
+                              nearly_equal_scalar(pts[1].fY, 5));
+    REPORTER_ASSERT(reporter, nearly_equal_scalar(pts[2].fX, 100) &&
+                              nearly_equal_scalar(pts[2].fY, -5));
+}
+
 DEF_TEST(Matrix, reporter) {
     SkMatrix    mat, inverse, iden1, iden2;
 
@@ -813,6 +857,7 @@ DEF_TEST(Matrix, reporter) {
     test_matrix_recttorect(reporter);
     test_matrix_decomposition(reporter);
     test_matrix_homogeneous(reporter);
+    test_matrix_map_points(reporter);
 }
 
 DEF_TEST(Matrix_Concat, r) {
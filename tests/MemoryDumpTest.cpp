@@ -0,0 +1,89 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDiscardableMemoryPool.h"
+#include "SkGraphics.h"
+#include "SkMemoryDump.h"
+#include "SkScaledImageCache.h"
+#include "SkTArray.h"
+#include "Test.h"
+
+namespace {
+
+class RecordingDump : public SkMemoryDump {
+public:
+    explicit RecordingDump(skiatest::Reporter* reporter) : fReporter(reporter) {}
+
+    virtual void dumpCache(const char name[], size_t allocatedBytes,
+                           size_t purgeableBytes) SK_OVERRIDE {
+        REPORTER_ASSERT(fReporter, purgeableBytes <= allocatedBytes);
+        fNames.push_back(name);
+    }
+
+    bool has(const char name[]) const {
+        for (int i = 0; i < fNames.count(); ++i) {
+            if (0 == strcmp(name, fNames[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    skiatest::Reporter*      fReporter;
+    SkTArray<const char*>    fNames;
+};
+
+}  // namespace
+
+DEF_TEST(MemoryDump_Global, reporter) {
+    // Makes sure the global pool exists, and so has registered itself.
+    SkGetGlobalDiscardableMemoryPool();
+
+    RecordingDump dump(reporter);
+    SkGraphics::DumpMemoryStatistics(&dump);
+    REPORTER_ASSERT(reporter, dump.has("skia/font_cache"));
+    REPORTER_ASSERT(reporter, dump.has("skia/image_cache"));
+    REPORTER_ASSERT(reporter, dump.has("skia/discardable_pool"));
+}
+
+// The global caches are shared with other tests, so the byte counts are
+// checked on caches of our own.
+DEF_TEST(MemoryDump_ImageCache, reporter) {
+    SkScaledImageCache cache(1024 * 1024);
+    SkBitmap src, scaled;
+    src.allocN32Pixels(10, 10);
+    scaled.allocN32Pixels(20, 20);
+
+    SkScaledImageCache::ID* id = cache.addAndLock(src, 2, 2, scaled);
+    REPORTER_ASSERT(reporter, NULL != id);
+    size_t allocated = 0, purgeable = 0;
+    cache.getUsage(&allocated, &purgeable);
+    REPORTER_ASSERT(reporter, scaled.getSize() == allocated);
+    REPORTER_ASSERT(reporter, 0 == purgeable);
+
+    cache.unlock(id);
+    allocated = purgeable = 0;
+    cache.getUsage(&allocated, &purgeable);
+    REPORTER_ASSERT(reporter, scaled.getSize() == allocated);
+    REPORTER_ASSERT(reporter, scaled.getSize() == purgeable);
+}
+
+DEF_TEST(MemoryDump_DiscardableMemoryPool, reporter) {
+    SkAutoTUnref<SkDiscardableMemoryPool> pool(SkDiscardableMemoryPool::Create(1000, NULL));
+    SkAutoTDelete<SkDiscardableMemory> dm1(pool->create(100));
+    SkAutoTDelete<SkDiscardableMemory> dm2(pool->create(200));
+    REPORTER_ASSERT(reporter, 0 == pool->getRAMPurgeable());
+
+    dm2->unlock();
+    REPORTER_ASSERT(reporter, 300 == pool->getRAMUsed());
+    REPORTER_ASSERT(reporter, 200 == pool->getRAMPurgeable());
+
+    pool->dumpPool();
+    REPORTER_ASSERT(reporter, 100 == pool->getRAMUsed());
+    REPORTER_ASSERT(reporter, 0 == pool->getRAMPurgeable());
+}
@@ -35,6 +35,49 @@ static void test_chunkalloc(skiatest::Reporter* reporter) {
     REPORTER_ASSERT(reporter, !alloc.contains(ptr));
     REPORTER_ASSERT(reporter, 0 == alloc.totalCapacity());
     REPORTER_ASSERT(reporter, 0 == alloc.totalUsed());
+
+    // rewind() keeps the largest block, and refills it from the start.
+    alloc.allocThrow(size);
+    void* big = alloc.allocThrow(min * 8);
+    REPORTER_ASSERT(reporter, alloc.blockCount() == 2);
+    alloc.rewind();
+    REPORTER_ASSERT(reporter, alloc.blockCount() == 1);
+    REPORTER_ASSERT(reporter, alloc.totalCapacity() >= min * 8);
+    REPORTER_ASSERT(reporter, 0 == alloc.totalUsed());
+    REPORTER_ASSERT(reporter, alloc.allocThrow(min * 8) == big);
+    REPORTER_ASSERT(reporter, alloc.blockCount() == 1);
+
+    alloc.reset();
+    alloc.rewind();
+    REPORTER_ASSERT(reporter, 0 == alloc.totalCapacity());
+    REPORTER_ASSERT(reporter, 0 == alloc.blockCount());
+}
+
+// Blocks an allocator frees are reused by the next allocator on the same thread.
+static void test_chunkalloc_reuse(skiatest::Reporter* reporter) {
+    void* first;
+    {
+        SkChunkAlloc alloc(2000);
+        first = alloc.allocThrow(100);
+    }
+    SkChunkAlloc alloc(2000);
+    REPORTER_ASSERT(reporter, alloc.allocThrow(100) == first);
+    REPORTER_ASSERT(reporter, alloc.contains(first));
+
+    // A power-of-two request gets a block of that size, not the next one up.
+    {
+        SkChunkAlloc pow2(16 * 1024);
+        pow2.allocThrow(16 * 1024);
+        REPORTER_ASSERT(reporter, 16 * 1024 == pow2.totalCapacity());
+        REPORTER_ASSERT(reporter, 1 == pow2.blockCount());
+    }
+
+    // Blocks too large to keep still work.
+    void* huge = alloc.allocThrow(1 << 20);
+    REPORTER_ASSERT(reporter, alloc.contains(huge));
+    REPORTER_ASSERT(reporter, alloc.blockCount() == 2);
+    alloc.reset();
+    REPORTER_ASSERT(reporter, 0 == alloc.blockCount());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -120,4 +163,5 @@ DEF_TEST(Memset, reporter) {
     test_32(reporter);
 
     test_chunkalloc(reporter);
+    test_chunkalloc_reuse(reporter);
 }
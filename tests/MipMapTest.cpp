@@ -6,6 +6,8 @@
  */
 
 #include "SkBitmap.h"
+#include "SkColorPriv.h"
+#include "SkDiscardableMemoryPool.h"
 #include "SkMipMap.h"
 #include "SkRandom.h"
 #include "Test.h"
@@ -53,3 +55,107 @@ DEF_TEST(MipMap, reporter) {
         }
     }
 }
+
+// Each pixel of a level should be the 2x2 box average of the one above it.
+static bool check_level(const SkBitmap& src, const SkMipMap::Level& level) {
+    for (uint32_t y = 0; y < level.fHeight; ++y) {
+        const SkPMColor* row = (const SkPMColor*)((const char*)level.fPixels +
+                                                  y * level.fRowBytes);
+        for (uint32_t x = 0; x < level.fWidth; ++x) {
+            const SkPMColor c[4] = {
+                *src.getAddr32(2 * x, 2 * y), *src.getAddr32(2 * x + 1, 2 * y),
+                *src.getAddr32(2 * x, 2 * y + 1), *src.getAddr32(2 * x + 1, 2 * y + 1),
+            };
+            for (int shift = 0; shift < 32; shift += 8) {
+                unsigned sum = 0;
+                for (int i = 0; i < 4; ++i) {
+                    sum += (c[i] >> shift) & 0xFF;
+                }
+                if ((sum >> 2) != ((row[x] >> shift) & 0xFF)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static void make_random_bitmap(SkBitmap* bm, SkRandom& rand, int w, int h) {
+    bm->allocN32Pixels(w, h);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            SkColor c = rand.nextU() | 0xFF000000;
+            *bm->getAddr32(x, y) = SkPreMultiplyColor(rand.nextBool() ? c : c & 0x80FFFFFF);
+        }
+    }
+}
+
+static void level_bitmap(const SkMipMap::Level& level, SkBitmap* bm) {
+    bm->installPixels(SkImageInfo::MakeN32Premul(level.fWidth, level.fHeight),
+                      level.fPixels, level.fRowBytes);
+}
+
+DEF_TEST(MipMap_Pixels, reporter) {
+    SkRandom rand;
+    // Odd sizes and widths that leave a tail for vector procs.
+    static const int kSizes[][2] = { { 2, 2 }, { 3, 7 }, { 17, 5 }, { 37, 38 }, { 64, 64 } };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kSizes); ++i) {
+        SkBitmap bm;
+        make_random_bitmap(&bm, rand, kSizes[i][0], kSizes[i][1]);
+        SkAutoTUnref<SkMipMap> mm(SkMipMap::Build(bm));
+
+        // The smallest level first, so it is built without being asked for the others.
+        SkMipMap::Level smallest, first;
+        REPORTER_ASSERT(reporter, mm->extractLevel(SK_Scalar1 / 1024, &smallest));
+        REPORTER_ASSERT(reporter, mm->extractLevel(SK_Scalar1 / 2, &first));
+        REPORTER_ASSERT(reporter, check_level(bm, first));
+
+        SkBitmap larger;
+        level_bitmap(first, &larger);
+        for (SkScalar scale = SK_Scalar1 / 4; scale > SK_Scalar1 / 1024; scale /= 2) {
+            SkMipMap::Level level;
+            REPORTER_ASSERT(reporter, mm->extractLevel(scale, &level));
+            if (level.fWidth == (uint32_t)larger.width()) {
+                break;
+            }
+            REPORTER_ASSERT(reporter, check_level(larger, level));
+            level_bitmap(level, &larger);
+        }
+        REPORTER_ASSERT(reporter, smallest.fWidth == (uint32_t)larger.width());
+    }
+}
+
+static SkDiscardableMemoryPool* gMipMapTestPool;
+
+static SkDiscardableMemory* mip_map_test_factory(size_t bytes) {
+    return gMipMapTestPool->create(bytes);
+}
+
+DEF_TEST(MipMap_Discardable, reporter) {
+    SkAutoTUnref<SkDiscardableMemoryPool> pool(SkDiscardableMemoryPool::Create(1024 * 1024));
+    gMipMapTestPool = pool;
+
+    SkRandom rand;
+    SkBitmap bm;
+    make_random_bitmap(&bm, rand, 40, 30);
+    SkAutoTUnref<SkMipMap> mm(SkMipMap::Build(bm, mip_map_test_factory));
+
+    SkMipMap::Level level;
+    // Without a lock there is no storage to build into.
+    REPORTER_ASSERT(reporter, !mm->extractLevel(SK_Scalar1 / 2, &level));
+
+    mm->lockStorage();
+    REPORTER_ASSERT(reporter, mm->extractLevel(SK_Scalar1 / 2, &level));
+    REPORTER_ASSERT(reporter, check_level(bm, level));
+    mm->unlockStorage();
+
+    // Purged while unlocked, the levels are built again.
+    pool->dumpPool();
+    mm->lockStorage();
+    REPORTER_ASSERT(reporter, mm->extractLevel(SK_Scalar1 / 2, &level));
+    REPORTER_ASSERT(reporter, check_level(bm, level));
+    mm->unlockStorage();
+
+    mm.reset(NULL);
+    gMipMapTestPool = NULL;
+}
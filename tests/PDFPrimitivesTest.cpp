@@ -8,11 +8,18 @@
 #include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkData.h"
+#include "SkDecodingImageGenerator.h"
 #include "SkFlate.h"
+#include "SkGradientShader.h"
 #include "SkImageEncoder.h"
 #include "SkMatrix.h"
 #include "SkPDFCatalog.h"
 #include "SkPDFDevice.h"
+#include "SkPDFDocument.h"
+#include "SkPDFFont.h"
+#include "SkPDFGraphicState.h"
+#include "SkPDFImage.h"
+#include "SkPDFShader.h"
 #include "SkPDFStream.h"
 #include "SkPDFTypes.h"
 #include "SkScalar.h"
@@ -344,6 +351,317 @@ static void test_issue1083() {
     doc.emitPDF(&stream);
 }
 
+static void draw_streamed_page(SkPDFDevice* dev, const SkBitmap& bitmap,
+                               int pageNumber) {
+    SkCanvas canvas(dev);
+    SkPaint paint;
+    paint.setTextSize(20);
+    SkString text;
+    text.printf("Page %d", pageNumber);
+    canvas.drawText(text.c_str(), text.size(), 10, 30, paint);
+    canvas.drawBitmap(bitmap, 10, 50);
+}
+
+// Returns the last occurrence of text in the (binary) data, or NULL.
+static const char* find_last(const SkData* data, const char* text) {
+    const char* bytes = static_cast<const char*>(data->data());
+    size_t len = strlen(text);
+    for (size_t offset = data->size() - len + 1; offset-- > 0;) {
+        if (0 == memcmp(bytes + offset, text, len)) {
+            return bytes + offset;
+        }
+    }
+    return NULL;
+}
+
+// Every object in the cross reference table must be at its recorded offset.
+static void check_xref(skiatest::Reporter* reporter, const SkData* pdf,
+                       int expectedObjects) {
+    const char* bytes = static_cast<const char*>(pdf->data());
+    const char* startXRef = find_last(pdf, "startxref\n");
+    REPORTER_ASSERT(reporter, NULL != startXRef);
+    if (NULL == startXRef) {
+        return;
+    }
+    size_t xrefOffset = atoi(startXRef + strlen("startxref\n"));
+    REPORTER_ASSERT(reporter, bytes + xrefOffset < startXRef);
+    if (bytes + xrefOffset >= startXRef) {
+        return;
+    }
+    const char* xref = bytes + xrefOffset;
+    REPORTER_ASSERT(reporter, 0 == strncmp(xref, "xref\n0 ", 7));
+
+    int count = atoi(xref + 7);
+    REPORTER_ASSERT(reporter, expectedObjects + 1 == count);
+    const char* entry = strchr(xref + 7, '\n') + 1;
+    entry += 20;  // The free entry for object 0.
+    for (int i = 1; i < count; i++, entry += 20) {
+        size_t offset = atoi(entry);
+        SkString expected;
+        expected.printf("%d 0 obj\n", i);
+        REPORTER_ASSERT(reporter, offset < pdf->size() &&
+                        0 == strncmp(bytes + offset, expected.c_str(),
+                                     expected.size()));
+    }
+}
+
+static void TestStreamingDocument(skiatest::Reporter* reporter) {
+    SkBitmap bitmap;
+    setup_bitmap(&bitmap, 16, 16);
+    bitmap.eraseColor(SK_ColorBLUE);
+
+    SkISize pageSize = SkISize::Make(200, 200);
+    SkDynamicMemoryWStream stream;
+    stream.writeText("garbage");  // Offsets are from the start of the PDF.
+    int objects;
+    {
+        SkPDFDocument doc(&stream);
+        static const int kPageCount = 3;
+        for (int i = 1; i <= kPageCount; i++) {
+            SkAutoTUnref<SkPDFDevice> dev(
+                new SkPDFDevice(pageSize, pageSize, SkMatrix::I()));
+            draw_streamed_page(dev, bitmap, i);
+            REPORTER_ASSERT(reporter, doc.appendPage(dev));
+        }
+        // Streamed documents can't have their pages replaced.
+        SkAutoTUnref<SkPDFDevice> dev(
+            new SkPDFDevice(pageSize, pageSize, SkMatrix::I()));
+        REPORTER_ASSERT(reporter, !doc.setPage(1, dev));
+
+        int counts[SkAdvancedTypefaceMetrics::kNotEmbeddable_Font + 1];
+        doc.getCountOfFontTypes(counts);
+        int fonts = 0;
+        for (size_t i = 0; i < SK_ARRAY_COUNT(counts); i++) {
+            fonts += counts[i];
+        }
+        REPORTER_ASSERT(reporter, 1 == fonts);
+
+        SkDynamicMemoryWStream other;
+        REPORTER_ASSERT(reporter, !doc.emitPDF(&other));
+        REPORTER_ASSERT(reporter, doc.emitPDF(&stream));
+        REPORTER_ASSERT(reporter, !doc.emitPDF(&stream));
+        REPORTER_ASSERT(reporter, !doc.appendPage(dev));
+        REPORTER_ASSERT(reporter, stream_contains(stream, "/Count 3"));
+
+        const char* size = "/Size ";
+        SkAutoDataUnref data(stream.copyToData());
+        const char* trailerSize = find_last(data, size);
+        REPORTER_ASSERT(reporter, NULL != trailerSize);
+        objects = NULL != trailerSize ? atoi(trailerSize + strlen(size)) - 1 : 0;
+    }
+
+    SkAutoDataUnref data(stream.copyToData());
+    const size_t garbage = strlen("garbage");
+    REPORTER_ASSERT(reporter, stream_equals(stream, garbage, "%PDF-1.4\n", 9));
+    REPORTER_ASSERT(reporter, stream_equals(stream, data->size() - 5, "%%EOF", 5));
+    SkAutoDataUnref pdf(SkData::NewSubset(data, garbage, data->size() - garbage));
+    // The catalog, the page tree, and at least a page, its content and a font.
+    REPORTER_ASSERT(reporter, objects > 5);
+    check_xref(reporter, pdf, objects);
+}
+
+static SkData* make_document(int threadCount, bool streaming) {
+    SkBitmap bitmap;
+    setup_bitmap(&bitmap, 16, 16);
+    bitmap.eraseColor(SK_ColorGREEN);
+
+    SkISize pageSize = SkISize::Make(200, 200);
+    SkDynamicMemoryWStream stream;
+    SkAutoTDelete<SkPDFDocument> doc(streaming ? SkNEW_ARGS(SkPDFDocument, (&stream))
+                                               : SkNEW(SkPDFDocument));
+    doc->setThreadCount(threadCount);
+    for (int i = 1; i <= 5; i++) {
+        SkAutoTUnref<SkPDFDevice> dev(
+            new SkPDFDevice(pageSize, pageSize, SkMatrix::I()));
+        draw_streamed_page(dev, bitmap, i);
+        doc->appendPage(dev);
+    }
+    doc->emitPDF(&stream);
+    return stream.copyToData();
+}
+
+// The contents are built and compressed on other threads, but the output
+// must not change.
+static void TestThreadedDocument(skiatest::Reporter* reporter) {
+    for (int streaming = 0; streaming < 2; streaming++) {
+        SkAutoDataUnref expected(make_document(1, SkToBool(streaming)));
+        SkAutoDataUnref threaded(make_document(4, SkToBool(streaming)));
+        REPORTER_ASSERT(reporter, expected->equals(threaded));
+    }
+}
+
+static int count_occurrences(const SkData* data, const char* text) {
+    const char* bytes = static_cast<const char*>(data->data());
+    size_t len = strlen(text);
+    int count = 0;
+    for (size_t offset = 0; offset + len <= data->size(); offset++) {
+        if (0 == memcmp(bytes + offset, text, len)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static SkData* emit_pages_with_bitmaps(const SkBitmap& a, const SkBitmap& b) {
+    SkISize pageSize = SkISize::Make(100, 100);
+    SkPDFDocument doc;
+    SkAutoTUnref<SkPDFDevice> dev1(new SkPDFDevice(pageSize, pageSize, SkMatrix::I()));
+    SkAutoTUnref<SkPDFDevice> dev2(new SkPDFDevice(pageSize, pageSize, SkMatrix::I()));
+    {
+        SkCanvas canvas(dev1);
+        canvas.drawBitmap(a, 0, 0);
+        canvas.drawBitmap(b, 50, 50);
+    }
+    {
+        SkCanvas canvas(dev2);
+        canvas.drawBitmap(b, 10, 10);
+    }
+    doc.appendPage(dev1);
+    doc.appendPage(dev2);
+
+    SkDynamicMemoryWStream stream;
+    doc.emitPDF(&stream);
+    return stream.copyToData();
+}
+
+// Bitmaps with the same pixels are embedded once, even if they don't share a
+// pixel ref.
+static void TestImageDeduplication(skiatest::Reporter* reporter) {
+    SkBitmap a, b, c;
+    setup_bitmap(&a, 20, 20);
+    a.eraseColor(SK_ColorRED);
+    setup_bitmap(&b, 20, 20);
+    b.eraseColor(SK_ColorRED);
+    setup_bitmap(&c, 20, 20);
+    c.eraseColor(SK_ColorGREEN);
+
+    SkAutoDataUnref same(emit_pages_with_bitmaps(a, b));
+    REPORTER_ASSERT(reporter, 1 == count_occurrences(same, "/Subtype /Image"));
+    SkAutoDataUnref different(emit_pages_with_bitmaps(a, c));
+    REPORTER_ASSERT(reporter, 2 == count_occurrences(different, "/Subtype /Image"));
+}
+
+// A bitmap decoded from a JPEG embeds the JPEG data.
+static void TestJPEGPassthrough(skiatest::Reporter* reporter) {
+    SkBitmap original;
+    setup_bitmap(&original, 32, 24);
+    original.eraseColor(SK_ColorBLUE);
+    SkAutoDataUnref jpeg(SkImageEncoder::EncodeData(original, SkImageEncoder::kJPEG_Type,
+                                                    80));
+    if (NULL == jpeg.get()) {
+        return;  // No JPEG encoder.
+    }
+    SkBitmap decoded;
+    REPORTER_ASSERT(reporter, SkInstallDiscardablePixelRef(
+            SkDecodingImageGenerator::Create(jpeg, SkDecodingImageGenerator::Options()),
+            &decoded));
+
+    SkAutoDataUnref pdf(emit_pages_with_bitmaps(decoded, decoded));
+    REPORTER_ASSERT(reporter, 1 == count_occurrences(pdf, "/Filter /DCTDecode"));
+
+    // The JPEG data is there, unchanged.
+    const uint8_t* bytes = pdf->bytes();
+    bool found = false;
+    for (size_t offset = 0; offset + jpeg->size() <= pdf->size(); offset++) {
+        if (0 == memcmp(bytes + offset, jpeg->data(), jpeg->size())) {
+            found = true;
+            break;
+        }
+    }
+    REPORTER_ASSERT(reporter, found);
+
+    // A subset can't use it.
+    SkBitmap subset;
+    decoded.extractSubset(&subset, SkIRect::MakeXYWH(4, 4, 8, 8));
+    SkAutoDataUnref subsetPdf(emit_pages_with_bitmaps(subset, subset));
+    REPORTER_ASSERT(reporter, 0 == count_occurrences(subsetPdf, "/Filter /DCTDecode"));
+}
+
+// Glyph sets only track the range of glyphs in use; merging and exporting
+// must still see every glyph.
+static void TestGlyphSet(skiatest::Reporter* reporter) {
+    SkPDFGlyphSet empty, a, b;
+    SkTDArray<uint32_t> glyphs;
+    empty.exportTo(&glyphs);
+    REPORTER_ASSERT(reporter, 0 == glyphs.count());
+
+    const uint16_t aGlyphs[] = { 300, 5 };
+    const uint16_t bGlyphs[] = { SK_MaxU16, 40 };
+    a.set(aGlyphs, SK_ARRAY_COUNT(aGlyphs));
+    b.set(bGlyphs, SK_ARRAY_COUNT(bGlyphs));
+    a.merge(empty);
+    a.merge(b);
+    a.exportTo(&glyphs);
+    REPORTER_ASSERT(reporter, 4 == glyphs.count());
+    if (4 == glyphs.count()) {
+        REPORTER_ASSERT(reporter, 5 == glyphs[0] && 40 == glyphs[1] &&
+                                  300 == glyphs[2] && SK_MaxU16 == glyphs[3]);
+    }
+    REPORTER_ASSERT(reporter, a.has(40) && !a.has(41) && !b.has(300));
+
+    empty.merge(a);
+    REPORTER_ASSERT(reporter, empty.has(5) && empty.has(SK_MaxU16));
+}
+
+static SkShader* make_gradient(SkColor end) {
+    const SkPoint points[] = { { 0, 0 }, { 10, 10 } };
+    const SkColor colors[] = { SK_ColorBLACK, end };
+    return SkGradientShader::CreateLinear(points, colors, NULL, 2,
+                                          SkShader::kClamp_TileMode);
+}
+
+// Paints and shaders that make the same PDF object share one.
+static void TestCanonicalObjects(skiatest::Reporter* reporter) {
+    SkPaint a, b, c;
+    a.setAlpha(0x80);
+    a.setStrokeWidth(0);
+    b.setAlpha(0x80);
+    b.setStrokeWidth(-0.0f);
+    b.setColor(SkColorSetA(SK_ColorRED, 0x80));  // Only the alpha matters.
+    c.setAlpha(0x40);
+    SkAutoTUnref<SkPDFGraphicState> gsA(SkPDFGraphicState::GetGraphicStateForPaint(a));
+    SkAutoTUnref<SkPDFGraphicState> gsB(SkPDFGraphicState::GetGraphicStateForPaint(b));
+    SkAutoTUnref<SkPDFGraphicState> gsC(SkPDFGraphicState::GetGraphicStateForPaint(c));
+    REPORTER_ASSERT(reporter, gsA.get() == gsB.get());
+    REPORTER_ASSERT(reporter, gsA.get() != gsC.get());
+
+    const SkIRect bbox = SkIRect::MakeWH(100, 100);
+    SkAutoTUnref<SkShader> blue1(make_gradient(SK_ColorBLUE));
+    SkAutoTUnref<SkShader> blue2(make_gradient(SK_ColorBLUE));
+    SkAutoTUnref<SkShader> green(make_gradient(SK_ColorGREEN));
+    SkAutoTUnref<SkPDFObject> pdfBlue1(
+            SkPDFShader::GetPDFShader(*blue1, SkMatrix::I(), bbox));
+    SkAutoTUnref<SkPDFObject> pdfBlue2(
+            SkPDFShader::GetPDFShader(*blue2, SkMatrix::I(), bbox));
+    SkAutoTUnref<SkPDFObject> pdfGreen(
+            SkPDFShader::GetPDFShader(*green, SkMatrix::I(), bbox));
+    REPORTER_ASSERT(reporter, NULL != pdfBlue1.get());
+    REPORTER_ASSERT(reporter, pdfBlue1.get() == pdfBlue2.get());
+    REPORTER_ASSERT(reporter, pdfBlue1.get() != pdfGreen.get());
+
+    SkMatrix translate;
+    translate.setTranslate(5, 0);
+    SkAutoTUnref<SkPDFObject> pdfMoved(
+            SkPDFShader::GetPDFShader(*blue1, translate, bbox));
+    REPORTER_ASSERT(reporter, pdfBlue1.get() != pdfMoved.get());
+
+    // Images are shared when their pixels match, and only then.
+    SkBitmap red1, red2, redDot;
+    red1.allocN32Pixels(16, 16);
+    red2.allocN32Pixels(16, 16);
+    red1.eraseColor(SK_ColorRED);
+    red2.eraseColor(SK_ColorRED);
+    red2.copyTo(&redDot);
+    redDot.eraseArea(SkIRect::MakeXYWH(3, 4, 1, 1), SK_ColorBLUE);
+    const SkIRect imageRect = SkIRect::MakeWH(16, 16);
+    SkAutoTUnref<SkPDFImage> pdfRed1(SkPDFImage::CreateImage(red1, imageRect, NULL));
+    SkAutoTUnref<SkPDFImage> pdfRed2(SkPDFImage::CreateImage(red2, imageRect, NULL));
+    SkAutoTUnref<SkPDFImage> pdfRedDot(SkPDFImage::CreateImage(redDot, imageRect, NULL));
+    REPORTER_ASSERT(reporter, NULL != pdfRed1.get());
+    REPORTER_ASSERT(reporter, pdfRed1.get() == pdfRed2.get());
+    REPORTER_ASSERT(reporter, pdfRed1.get() != pdfRedDot.get());
+}
+
 DEF_TEST(PDFPrimitives, reporter) {
     SkAutoTUnref<SkPDFInt> int42(new SkPDFInt(42));
     SimpleCheckObjectOutput(reporter, int42.get(), "42");
@@ -427,4 +745,16 @@ DEF_TEST(PDFPrimitives, reporter) {
     test_issue1083();
 
     TestImages(reporter);
+
+    TestStreamingDocument(reporter);
+
+    TestThreadedDocument(reporter);
+
+    TestImageDeduplication(reporter);
+
+    TestJPEGPassthrough(reporter);
+
+    TestGlyphSet(reporter);
+
+    TestCanonicalObjects(reporter);
 }
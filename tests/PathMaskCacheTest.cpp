@@ -0,0 +1,145 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkPath.h"
+#include "SkPathMaskCache.h"
+#include "Test.h"
+
+static const int W = 100;
+static const int H = 80;
+
+// A star with enough verbs to be worth caching.
+static void make_star(SkPath* path) {
+    static const int kPoints = 12;
+    path->reset();
+    for (int i = 0; i < 2 * kPoints; ++i) {
+        SkScalar angle = SK_ScalarPI * i / kPoints;
+        SkScalar radius = (i & 1) ? 12 : 30;
+        SkScalar x = 32 + SkScalarMul(radius, SkScalarCos(angle));
+        SkScalar y = 32 + SkScalarMul(radius, SkScalarSin(angle));
+        if (0 == i) {
+            path->moveTo(x, y);
+        } else if (i & 1) {
+            path->lineTo(x, y);
+        } else {
+            path->quadTo(x + 2, y - 3, x, y);
+        }
+    }
+    path->close();
+}
+
+enum ClipType {
+    kNone_ClipType,
+    kRect_ClipType,
+    kAA_ClipType,
+};
+
+static void draw(const SkPath& path, const SkPaint& paint, SkScalar dx, SkScalar dy,
+                 ClipType clip, SkBitmap* bm) {
+    bm->allocN32Pixels(W, H);
+    bm->eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(*bm);
+    if (kRect_ClipType == clip) {
+        canvas.clipRect(SkRect::MakeLTRB(10, 12, 60, 50));
+    } else if (kAA_ClipType == clip) {
+        SkPath circle;
+        circle.addCircle(40, 40, SkFloatToScalar(25.5f));
+        canvas.clipPath(circle, SkRegion::kIntersect_Op, true);
+    }
+    canvas.translate(dx, dy);
+    canvas.drawPath(path, paint);
+}
+
+static bool equal(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a), alpb(b);
+    for (int y = 0; y < H; ++y) {
+        if (0 != memcmp(a.getAddr32(0, y), b.getAddr32(0, y), W * sizeof(SkPMColor))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The mask is scan converted without the device clip, which can move a clipped
+// edge's coverage by a rounding step.
+static bool nearly_equal(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a), alpb(b);
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            SkPMColor ca = *a.getAddr32(x, y);
+            SkPMColor cb = *b.getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                if (SkAbs32(((ca >> shift) & 0xFF) - ((cb >> shift) & 0xFF)) > 1) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+DEF_TEST(PathMaskCache, reporter) {
+    const size_t limit = SkPathMaskCache::GetByteLimit();
+    SkPathMaskCache::Purge();
+
+    SkPath star;
+    make_star(&star);
+
+    SkPaint fill;
+    fill.setAntiAlias(true);
+    fill.setColor(0xC0336699);
+    SkPaint stroke(fill);
+    stroke.setStyle(SkPaint::kStroke_Style);
+    stroke.setStrokeWidth(3);
+    const SkPaint* paints[] = { &fill, &stroke };
+
+    for (size_t p = 0; p < SK_ARRAY_COUNT(paints); ++p) {
+        for (int clip = kNone_ClipType; clip <= kAA_ClipType; ++clip) {
+            // Integer steps of the translate share one mask; the fraction is part of the key.
+            static const SkScalar gOffsets[][2] = {
+                { 0, 0 }, { 5, 3 }, { 20, -4 }, { 0.25f, 0.5f }, { 30.25f, 7.5f },
+            };
+            for (size_t o = 0; o < SK_ARRAY_COUNT(gOffsets); ++o) {
+                const SkScalar dx = gOffsets[o][0], dy = gOffsets[o][1];
+
+                // With no budget nothing is cached, which gives us the reference.
+                SkPathMaskCache::SetByteLimit(0);
+                SkBitmap expected;
+                draw(star, *paints[p], dx, dy, (ClipType)clip, &expected);
+                REPORTER_ASSERT(reporter, 0 == SkPathMaskCache::GetBytesUsed());
+
+                SkPathMaskCache::SetByteLimit(limit);
+                // First draw records the key, second renders the mask, third reuses it.
+                for (int i = 0; i < 3; ++i) {
+                    SkBitmap actual;
+                    draw(star, *paints[p], dx, dy, (ClipType)clip, &actual);
+                    REPORTER_ASSERT(reporter, nearly_equal(expected, actual));
+                }
+                REPORTER_ASSERT(reporter, SkPathMaskCache::GetBytesUsed() > 0);
+            }
+        }
+    }
+
+    // Editing the path gives it a new key.
+    SkPathMaskCache::Purge();
+    REPORTER_ASSERT(reporter, 0 == SkPathMaskCache::GetBytesUsed());
+    SkBitmap before, after;
+    for (int i = 0; i < 3; ++i) {
+        draw(star, fill, 0, 0, kNone_ClipType, &before);
+    }
+    star.offset(10, 10);
+    draw(star, fill, 0, 0, kNone_ClipType, &after);
+    REPORTER_ASSERT(reporter, !equal(before, after));
+    SkBitmap shifted;
+    star.offset(-10, -10);
+    draw(star, fill, 10, 10, kNone_ClipType, &shifted);
+    REPORTER_ASSERT(reporter, equal(after, shifted));
+
+    SkPathMaskCache::SetByteLimit(limit);
+}
@@ -73,6 +73,75 @@ static void test_small_segment() {
     meas.getLength();
 }
 
+static void make_curvy_path(SkPath* path) {
+    path->reset();
+    path->moveTo(10, 10);
+    path->cubicTo(200, 10, -100, 300, 150, 150);
+    path->quadTo(300, 0, 50, 40);
+    path->lineTo(60, 90);
+    path->close();
+    path->moveTo(300, 300);
+    path->quadTo(500, 300, 500, 500);
+    path->cubicTo(500, 600, 300, 600, 310, 320);
+}
+
+// Record what a measure reports for each contour of path.
+static void measure_contours(const SkPath& path, SkTDArray<SkScalar>* results,
+                             SkPath* segments) {
+    SkPathMeasure meas(path, false);
+    do {
+        SkScalar length = meas.getLength();
+        *results->append() = length;
+        *results->append() = meas.isClosed();
+        for (int i = 0; i <= 8; ++i) {
+            SkPoint pos;
+            SkVector tan;
+            if (meas.getPosTan(length * i / 8, &pos, &tan)) {
+                *results->append() = pos.fX;
+                *results->append() = pos.fY;
+                *results->append() = tan.fX;
+                *results->append() = tan.fY;
+            }
+        }
+        meas.getSegment(length / 3, length * 2 / 3, segments, true);
+    } while (meas.nextContour());
+}
+
+/*  The second and later measures of a path with curves share its measurements
+    through a cache; they must report exactly what a fresh measure does.
+ */
+static void test_cached_measure(skiatest::Reporter* reporter) {
+    SkPath path;
+    make_curvy_path(&path);
+
+    SkTDArray<SkScalar> expected;
+    SkPath expectedSegments;
+    measure_contours(path, &expected, &expectedSegments);
+    REPORTER_ASSERT(reporter, expected.count() > 2);
+
+    for (int i = 0; i < 3; ++i) {
+        SkTDArray<SkScalar> results;
+        SkPath segments;
+        measure_contours(path, &results, &segments);
+        REPORTER_ASSERT(reporter, results == expected);
+        REPORTER_ASSERT(reporter, segments == expectedSegments);
+    }
+
+    // An identical path has its own generation ID, so is measured afresh.
+    SkPath copy;
+    make_curvy_path(&copy);
+    SkTDArray<SkScalar> results;
+    SkPath segments;
+    measure_contours(copy, &results, &segments);
+    REPORTER_ASSERT(reporter, results == expected);
+    REPORTER_ASSERT(reporter, segments == expectedSegments);
+
+    // nextContour() before anything is measured reports the first contour.
+    SkPathMeasure meas(path, false);
+    REPORTER_ASSERT(reporter, meas.nextContour());
+    REPORTER_ASSERT(reporter, meas.getLength() == expected[0]);
+}
+
 DEF_TEST(PathMeasure, reporter) {
     SkPath  path;
 
@@ -200,4 +269,5 @@ DEF_TEST(PathMeasure, reporter) {
     test_small_segment();
     test_small_segment2();
     test_small_segment3();
+    test_cached_measure(reporter);
 }
@@ -408,24 +408,27 @@ static bool bruteForceCheck(skiatest::Reporter* reporter, const SkDQuad& quad1,
 
 class PathOpsSegmentTester {
 public:
-    static void ConstructQuad(SkOpSegment* segment, SkPoint shortQuad[3]) {
-        segment->debugConstructQuad(shortQuad);
+    static void ConstructQuad(SkOpSegment* segment, SkPoint shortQuad[3],
+                              SkChunkAlloc* allocator) {
+        segment->debugConstructQuad(shortQuad, allocator);
     }
 };
 
-static void makeSegment(const SkDQuad& quad, SkPoint shortQuad[3], SkOpSegment* result) {
+static void makeSegment(const SkDQuad& quad, SkPoint shortQuad[3], SkOpSegment* result,
+                        SkChunkAlloc* allocator) {
     shortQuad[0] = quad[0].asSkPoint();
     shortQuad[1] = quad[1].asSkPoint();
     shortQuad[2] = quad[2].asSkPoint();
-    PathOpsSegmentTester::ConstructQuad(result, shortQuad);
+    PathOpsSegmentTester::ConstructQuad(result, shortQuad, allocator);
 }
 
 static void testQuadAngles(skiatest::Reporter* reporter, const SkDQuad& quad1, const SkDQuad& quad2,
         int testNo) {
     SkPoint shortQuads[2][3];
+    SkChunkAlloc allocator(4096);
     SkOpSegment seg[2];
-    makeSegment(quad1, shortQuads[0], &seg[0]);
-    makeSegment(quad2, shortQuads[1], &seg[1]);
+    makeSegment(quad1, shortQuads[0], &seg[0], &allocator);
+    makeSegment(quad2, shortQuads[1], &seg[1], &allocator);
     int realOverlap = PathOpsAngleTester::ConvexHullOverlaps(seg[0].angle(0), seg[1].angle(0));
     const SkDPoint& origin = quad1[0];
     REPORTER_ASSERT(reporter, origin == quad2[0]);
@@ -214,16 +214,17 @@ public:
 
 class PathOpsSegmentTester {
 public:
-    static void ConstructCubic(SkOpSegment* segment, SkPoint shortCubic[4]) {
-        segment->debugConstructCubic(shortCubic);
+    static void ConstructCubic(SkOpSegment* segment, SkPoint shortCubic[4],
+                               SkChunkAlloc* allocator) {
+        segment->debugConstructCubic(shortCubic, allocator);
     }
 
-    static void ConstructLine(SkOpSegment* segment, SkPoint shortLine[2]) {
-        segment->debugConstructLine(shortLine);
+    static void ConstructLine(SkOpSegment* segment, SkPoint shortLine[2], SkChunkAlloc* allocator) {
+        segment->debugConstructLine(shortLine, allocator);
     }
 
-    static void ConstructQuad(SkOpSegment* segment, SkPoint shortQuad[3]) {
-        segment->debugConstructQuad(shortQuad);
+    static void ConstructQuad(SkOpSegment* segment, SkPoint shortQuad[3], SkChunkAlloc* allocator) {
+        segment->debugConstructQuad(shortQuad, allocator);
     }
 
     static void DebugReset(SkOpSegment* segment) {
@@ -246,6 +247,7 @@ static CircleData circleDataSet[] = {
 static const int circleDataSetSize = (int) SK_ARRAY_COUNT(circleDataSet);
 
 DEF_TEST(PathOpsAngleCircle, reporter) {
+    SkChunkAlloc allocator(4096);
     SkOpSegment segment[2];
     for (int index = 0; index < circleDataSetSize; ++index) {
         CircleData& data = circleDataSet[index];
@@ -254,13 +256,13 @@ DEF_TEST(PathOpsAngleCircle, reporter) {
         }
         switch (data.fPtCount) {
             case 2:
-                PathOpsSegmentTester::ConstructLine(&segment[index], data.fShortPts);
+                PathOpsSegmentTester::ConstructLine(&segment[index], data.fShortPts, &allocator);
                 break;
             case 3:
-                PathOpsSegmentTester::ConstructQuad(&segment[index], data.fShortPts);
+                PathOpsSegmentTester::ConstructQuad(&segment[index], data.fShortPts, &allocator);
                 break;
             case 4:
-                PathOpsSegmentTester::ConstructCubic(&segment[index], data.fShortPts);
+                PathOpsSegmentTester::ConstructCubic(&segment[index], data.fShortPts, &allocator);
                 break;
         }
     }
@@ -402,6 +404,7 @@ DEF_TEST(PathOpsAngleAfter, reporter) {
     for (int index = intersectDataSetsSize - 1; index >= 0; --index) {
         IntersectData* dataArray = intersectDataSets[index];
         const int dataSize = intersectDataSetSizes[index];
+        SkChunkAlloc allocator(4096);
         SkOpSegment segment[3];
         for (int index2 = 0; index2 < dataSize - 2; ++index2) {
             for (int temp = 0; temp < (int) SK_ARRAY_COUNT(segment); ++temp) {
@@ -419,14 +422,16 @@ DEF_TEST(PathOpsAngleAfter, reporter) {
                                 data.fTStart < data.fTEnd ? 1 : 0);
                         data.fShortPts[0] = seg[0].asSkPoint();
                         data.fShortPts[1] = seg[1].asSkPoint();
-                        PathOpsSegmentTester::ConstructLine(&segment[index3], data.fShortPts);
+                        PathOpsSegmentTester::ConstructLine(&segment[index3], data.fShortPts,
+                                &allocator);
                         } break;
                     case 3: {
                         SkDQuad seg = SkDQuad::SubDivide(temp, data.fTStart, data.fTEnd);
                         data.fShortPts[0] = seg[0].asSkPoint();
                         data.fShortPts[1] = seg[1].asSkPoint();
                         data.fShortPts[2] = seg[2].asSkPoint();
-                        PathOpsSegmentTester::ConstructQuad(&segment[index3], data.fShortPts);
+                        PathOpsSegmentTester::ConstructQuad(&segment[index3], data.fShortPts,
+                                &allocator);
                         } break;
                     case 4: {
                         SkDCubic seg = SkDCubic::SubDivide(temp, data.fTStart, data.fTEnd);
@@ -434,7 +439,8 @@ DEF_TEST(PathOpsAngleAfter, reporter) {
                         data.fShortPts[1] = seg[1].asSkPoint();
                         data.fShortPts[2] = seg[2].asSkPoint();
                         data.fShortPts[3] = seg[3].asSkPoint();
-                        PathOpsSegmentTester::ConstructCubic(&segment[index3], data.fShortPts);
+                        PathOpsSegmentTester::ConstructCubic(&segment[index3], data.fShortPts,
+                                &allocator);
                         } break;
                 }
             }
@@ -463,22 +469,22 @@ void SkOpSegment::debugAddAngle(int start, int end) {
     angle.set(this, start, end);
 }
 
-void SkOpSegment::debugConstructCubic(SkPoint shortQuad[4]) {
-    addCubic(shortQuad, false, false);
+void SkOpSegment::debugConstructCubic(SkPoint shortQuad[4], SkChunkAlloc* allocator) {
+    addCubic(shortQuad, false, false, allocator);
     addT(NULL, shortQuad[0], 0);
     addT(NULL, shortQuad[3], 1);
     debugConstruct();
 }
 
-void SkOpSegment::debugConstructLine(SkPoint shortQuad[2]) {
-    addLine(shortQuad, false, false);
+void SkOpSegment::debugConstructLine(SkPoint shortQuad[2], SkChunkAlloc* allocator) {
+    addLine(shortQuad, false, false, allocator);
     addT(NULL, shortQuad[0], 0);
     addT(NULL, shortQuad[1], 1);
     debugConstruct();
 }
 
-void SkOpSegment::debugConstructQuad(SkPoint shortQuad[3]) {
-    addQuad(shortQuad, false, false);
+void SkOpSegment::debugConstructQuad(SkPoint shortQuad[3], SkChunkAlloc* allocator) {
+    addQuad(shortQuad, false, false, allocator);
     addT(NULL, shortQuad[0], 0);
     addT(NULL, shortQuad[2], 1);
     debugConstruct();
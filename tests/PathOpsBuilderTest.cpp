@@ -0,0 +1,91 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#include "PathOpsExtendedTest.h"
+
+static void make_shapes(SkTArray<SkPath>* shapes) {
+    for (int index = 0; index < 24; ++index) {
+        SkScalar x = SkIntToScalar(index % 6 * 10);
+        SkScalar y = SkIntToScalar(index / 6 * 10);
+        SkPath* path = &shapes->push_back();
+        switch (index % 3) {
+            case 0:
+                path->addCircle(x, y, 8);
+                break;
+            case 1:
+                path->addRect(x, y, x + 14, y + 9, SkPath::kCCW_Direction);
+                break;
+            case 2:
+                path->moveTo(x, y);
+                path->lineTo(x + 12, y + 3);
+                path->lineTo(x + 4, y + 12);
+                path->close();
+                break;
+        }
+    }
+}
+
+static bool same_area(const SkPath& one, const SkPath& two) {
+    SkPath diff;
+    return Op(one, two, kXOR_PathOp, &diff) && diff.isEmpty();
+}
+
+DEF_TEST(PathOpsBuilder, reporter) {
+    SkTArray<SkPath> shapes;
+    make_shapes(&shapes);
+
+    SkOpBuilder builder;
+    SkPath result;
+    REPORTER_ASSERT(reporter, builder.resolve(&result));
+    REPORTER_ASSERT(reporter, result.isEmpty());
+
+    // Unions of convex paths, wound both ways, are resolved together.
+    SkPath expected;
+    for (int index = 0; index < shapes.count(); ++index) {
+        builder.add(shapes[index], kUnion_PathOp);
+        REPORTER_ASSERT(reporter, Op(expected, shapes[index], kUnion_PathOp, &expected));
+    }
+    REPORTER_ASSERT(reporter, builder.resolve(&result));
+    REPORTER_ASSERT(reporter, same_area(result, expected));
+
+    // Anything else is resolved one operation at a time, starting from empty.
+    builder.add(shapes[0], kDifference_PathOp);
+    builder.add(shapes[1], kUnion_PathOp);
+    builder.add(shapes[2], kXOR_PathOp);
+    builder.add(shapes[3], kIntersect_PathOp);
+    expected.reset();
+    REPORTER_ASSERT(reporter, Op(expected, shapes[1], kUnion_PathOp, &expected));
+    REPORTER_ASSERT(reporter, Op(expected, shapes[2], kXOR_PathOp, &expected));
+    REPORTER_ASSERT(reporter, Op(expected, shapes[3], kIntersect_PathOp, &expected));
+    REPORTER_ASSERT(reporter, builder.resolve(&result));
+    REPORTER_ASSERT(reporter, same_area(result, expected));
+}
+
+DEF_TEST(PathOpsBatchOp, reporter) {
+    SkTArray<SkPath> shapes;
+    make_shapes(&shapes);
+    SkPath clip;
+    clip.addRect(5, 5, 45, 25);
+    SkTArray<SkPath> clips;
+    for (int index = 0; index < shapes.count(); ++index) {
+        clips.push_back(clip);
+    }
+    int threadCounts[] = { 0, 4, -1 };
+    for (size_t t = 0; t < SK_ARRAY_COUNT(threadCounts); ++t) {
+        for (int op = kDifference_PathOp; op <= kReverseDifference_PathOp; ++op) {
+            SkTArray<SkPath> results(shapes);
+            SkAutoTMalloc<bool> succeeded(shapes.count());
+            REPORTER_ASSERT(reporter, BatchOp(results.begin(), clips.begin(), shapes.count(),
+                    (SkPathOp) op, results.begin(), succeeded.get(), threadCounts[t]));
+            for (int index = 0; index < shapes.count(); ++index) {
+                SkPath expected;
+                REPORTER_ASSERT(reporter, succeeded[index]);
+                REPORTER_ASSERT(reporter, Op(shapes[index], clip, (SkPathOp) op, &expected));
+                REPORTER_ASSERT(reporter, results[index] == expected);
+            }
+        }
+    }
+}
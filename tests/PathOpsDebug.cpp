@@ -202,7 +202,7 @@ void SkIntersectionHelper::dump() const {
     }
 }
 
-const SkTDArray<SkOpSpan>& SkOpSegment::debugSpans() const {
+const SkOpArray<SkOpSpan>& SkOpSegment::debugSpans() const {
     return fTs;
 }
 
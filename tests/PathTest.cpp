@@ -258,8 +258,13 @@ static void test_gen_id(skiatest::Reporter* reporter) {
     const uint32_t v = c.getGenerationID();
     REPORTER_ASSERT(reporter, (v == w) == kExpectGenIDToIgnoreFill);
 
+    // Transforming in place moves the points, so needs a new ID.
+    c.offset(1, 1);
+    const uint32_t u = c.getGenerationID();
+    REPORTER_ASSERT(reporter, u != v);
+
     c.rewind();
-    REPORTER_ASSERT(reporter, v != c.getGenerationID());
+    REPORTER_ASSERT(reporter, u != c.getGenerationID());
 }
 
 // This used to assert in the debug build, as the edges did not all line-up.
@@ -5,8 +5,11 @@
  * found in the LICENSE file.
  */
 
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
+#include "SkScaledImageCache.h"
 #include "SkShader.h"
 #include "Test.h"
 
@@ -24,3 +27,45 @@ DEF_TEST(PictureShader_empty, reporter) {
             SkShader::kClamp_TileMode, SkShader::kClamp_TileMode);
     REPORTER_ASSERT(reporter, NULL == shader);
 }
+
+// Test that picture shaders drawing the same picture at the same scale share
+// one rasterized tile through the scaled image cache.
+DEF_TEST(PictureShader_sharedTile, reporter) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(10, 10, NULL, 0);
+    SkPaint paint;
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawRect(SkRect::MakeWH(5, 10), paint);
+    SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+
+    SkAutoTUnref<SkShader> shaders[2];
+    SkBitmap results[2];
+    for (int i = 0; i < 2; ++i) {
+        shaders[i].reset(SkShader::CreatePictureShader(picture.get(),
+                SkShader::kRepeat_TileMode, SkShader::kRepeat_TileMode));
+        REPORTER_ASSERT(reporter, NULL != shaders[i].get());
+
+        results[i].allocN32Pixels(40, 40);
+        results[i].eraseColor(SK_ColorTRANSPARENT);
+        SkCanvas bitmapCanvas(results[i]);
+        bitmapCanvas.scale(2, 2);
+        SkPaint shaderPaint;
+        shaderPaint.setShader(shaders[i]);
+        bitmapCanvas.drawPaint(shaderPaint);
+    }
+
+    SkBitmap tile;
+    SkScaledImageCache::ID* id = SkScaledImageCache::FindAndLockPicture(
+        picture->uniqueID(), 2, 2, SkIRect::MakeWH(20, 20), &tile);
+    REPORTER_ASSERT(reporter, NULL != id);
+    if (NULL != id) {
+        REPORTER_ASSERT(reporter, tile.isImmutable());
+        SkScaledImageCache::Unlock(id);
+    }
+
+    SkAutoLockPixels alp0(results[0]), alp1(results[1]);
+    REPORTER_ASSERT(reporter, SkPreMultiplyColor(SK_ColorGREEN) == *results[0].getAddr32(25, 5));
+    REPORTER_ASSERT(reporter, SK_ColorTRANSPARENT == *results[0].getAddr32(35, 5));
+    REPORTER_ASSERT(reporter, 0 == memcmp(results[0].getPixels(), results[1].getPixels(),
+                                          results[0].getSize()));
+}
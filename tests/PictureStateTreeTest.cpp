@@ -118,6 +118,49 @@ static void test_reference_picture(skiatest::Reporter* reporter) {
     check_bms(reporter, referenceBitmap, bbhBitmap);
 }
 
+class SetMatrixCountingCanvas : public SkCanvas {
+public:
+    explicit SetMatrixCountingCanvas(const SkBitmap& bitmap) : INHERITED(bitmap), fCount(0) {}
+
+    int fCount;
+
+protected:
+    virtual void didSetMatrix(const SkMatrix& matrix) SK_OVERRIDE {
+        ++fCount;
+        this->INHERITED::didSetMatrix(matrix);
+    }
+
+private:
+    typedef SkCanvas INHERITED;
+};
+
+// Draws recorded under equal matrices share one in the state tree, so playback sets it once.
+static void test_shared_matrices(skiatest::Reporter* reporter) {
+    SkRTreeFactory bbhFactory;
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(100, 100, &bbhFactory, 0);
+    SkPaint paint;
+    SkMatrix translate;
+    translate.setTranslate(5, 5);
+    for (int i = 0; i < 10; ++i) {
+        canvas->translate(5, 5);
+        canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(i), 0, 1, 1), paint);
+        canvas->translate(-5, -5);
+        canvas->setMatrix(translate);
+        canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(i), 2, 1, 1), paint);
+        canvas->resetMatrix();
+    }
+    SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(100, 100);
+    SetMatrixCountingCanvas counter(bitmap);
+    counter.drawPicture(picture.get());
+    // Once for the draws, and once to put the canvas's own matrix back.
+    REPORTER_ASSERT(reporter, 2 == counter.fCount);
+}
+
 DEF_TEST(PictureStateTree, reporter) {
     test_reference_picture(reporter);
+    test_shared_matrices(reporter);
 }
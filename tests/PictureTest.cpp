@@ -13,6 +13,8 @@
 #include "SkData.h"
 #include "SkDecodingImageGenerator.h"
 #include "SkError.h"
+#include "SkFlate.h"
+#include "SkGradientShader.h"
 #if SK_SUPPORT_GPU
 #include "SkGpuDevice.h"
 #endif
@@ -26,6 +28,7 @@
 #include "SkRandom.h"
 #include "SkShader.h"
 #include "SkStream.h"
+#include "SkThread.h"
 
 #if SK_SUPPORT_GPU
 #include "SkSurface.h"
@@ -984,6 +987,10 @@ public:
 
         return recorder2.endRecording();
     }
+
+    static void Replay(const SkPictureRecorder* recorder, SkCanvas* canvas) {
+        recorder->partialReplay(canvas);
+    }
 };
 
 static void create_imbalance(SkCanvas* canvas) {
@@ -1581,6 +1588,171 @@ static void test_gen_id(skiatest::Reporter* reporter) {
     }
 }
 
+static void draw_paths(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    SkPath polyline;
+    polyline.moveTo(3, 5);
+    for (int i = 1; i < 40; ++i) {
+        polyline.lineTo(3 + 2.3f * i, 5 + 40 * SkScalarSin(i * 0.3f) + 40);
+    }
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeJoin(SkPaint::kRound_Join);
+    paint.setStrokeWidth(1.5f);
+    canvas->drawPath(polyline, paint);
+
+    SkPath curves;
+    curves.moveTo(10, 10);
+    curves.quadTo(90, 20, 50, 90);
+    curves.cubicTo(3, 4, 80, 60, 95, 95);
+    curves.conicTo(0, 95, 10, 10, 0.7f);
+    curves.close();
+    curves.addOval(SkRect::MakeXYWH(30, 30, 40, 20));
+    curves.setFillType(SkPath::kEvenOdd_FillType);
+    paint.setStyle(SkPaint::kFill_Style);
+    paint.setColor(0x8000FF00);
+    canvas->drawPath(curves, paint);
+
+    SkPath oval;
+    oval.addOval(SkRect::MakeXYWH(60, 10, 30, 35));
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawPath(oval, paint);
+
+    // Not finite, so it can't be quantized.
+    SkPath infinite;
+    infinite.moveTo(0, 0);
+    infinite.lineTo(SK_ScalarInfinity, 5);
+    canvas->drawPath(infinite, paint);
+}
+
+static void test_compact_paths(skiatest::Reporter* reporter) {
+    SkPictureRecorder recorder;
+    draw_paths(recorder.beginRecording(100, 100, NULL, 0));
+    SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+
+    SkDynamicMemoryWStream fullStream, compactStream;
+    picture->serialize(&fullStream);
+    picture->serialize(&compactStream, NULL, SkPicture::kCompactPaths_SerializeFlag);
+    REPORTER_ASSERT(reporter, compactStream.getOffset() < fullStream.getOffset());
+
+    SkAutoDataUnref compactData(compactStream.copyToData());
+    SkMemoryStream stream(compactData);
+    SkAutoTUnref<SkPicture> compact(SkPicture::CreateFromStream(&stream));
+    REPORTER_ASSERT(reporter, NULL != compact.get());
+    if (NULL == compact.get()) {
+        return;
+    }
+
+    // The points moved by at most 1/131070 of their path's size.
+    SkBitmap expected, actual;
+    draw(picture, 100, 100, &expected);
+    draw(compact, 100, 100, &actual);
+    int maxDiff = 0;
+    for (int y = 0; y < 100; ++y) {
+        for (int x = 0; x < 100; ++x) {
+            SkPMColor e = *expected.getAddr32(x, y), a = *actual.getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                maxDiff = SkMax32(maxDiff, SkAbs32((int)((e >> shift) & 0xFF) -
+                                                   (int)((a >> shift) & 0xFF)));
+            }
+        }
+    }
+    REPORTER_ASSERT(reporter, maxDiff <= 2);
+
+    // Serializing the read picture compactly again writes the same paths.
+    SkDynamicMemoryWStream againStream;
+    compact->serialize(&againStream, NULL, SkPicture::kCompactPaths_SerializeFlag);
+    SkAutoDataUnref againData(againStream.copyToData());
+    REPORTER_ASSERT(reporter, againData->equals(compactData));
+}
+
+static void test_compressed(skiatest::Reporter* reporter) {
+    SkPictureRecorder recorder;
+    draw_paths(recorder.beginRecording(100, 100, NULL, 0));
+    SkAutoTUnref<SkPicture> paths(recorder.endRecording());
+    // A sub-picture is compressed on its own.
+    SkCanvas* canvas = recorder.beginRecording(100, 100, NULL, 0);
+    for (int i = 0; i < 20; ++i) {
+        SkPaint paint;
+        paint.setColor(SkColorSetARGB(0xFF, 10 * i, 0, 0));
+        canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(5 * i), 0, 3, 100), paint);
+    }
+    canvas->drawPicture(paths);
+    SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+
+    SkDynamicMemoryWStream plainStream, compressedStream;
+    picture->serialize(&plainStream);
+    picture->serialize(&compressedStream, NULL, SkPicture::kCompressed_SerializeFlag);
+    if (SkFlate::HaveFlate()) {
+        REPORTER_ASSERT(reporter, compressedStream.getOffset() < plainStream.getOffset());
+    } else {
+        REPORTER_ASSERT(reporter, compressedStream.getOffset() == plainStream.getOffset());
+    }
+
+    SkAutoDataUnref compressedData(compressedStream.copyToData());
+    SkMemoryStream stream(compressedData);
+    SkAutoTUnref<SkPicture> compressed(SkPicture::CreateFromStream(&stream));
+    REPORTER_ASSERT(reporter, NULL != compressed.get());
+    if (NULL == compressed.get()) {
+        return;
+    }
+
+    SkBitmap expected, actual;
+    draw(picture, 100, 100, &expected);
+    draw(compressed, 100, 100, &actual);
+    SkAutoLockPixels alp0(expected), alp1(actual);
+    REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                          expected.getSize()));
+
+    // A truncated or corrupt payload fails to read, rather than drawing garbage.
+    SkAutoDataUnref truncated(SkData::NewSubset(compressedData, 0, compressedData->size() / 2));
+    SkAutoTUnref<SkPicture> broken(SkPicture::CreateFromData(truncated));
+    REPORTER_ASSERT(reporter, NULL == broken.get());
+}
+
+// Draws with paints that repeat, and with a gradient whose local matrix changes between draws.
+static void draw_repeated_paints(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setColor(SK_ColorRED);
+    for (int i = 0; i < 4; ++i) {
+        canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(10 * i), 0, 8, 8), paint);
+    }
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawRect(SkRect::MakeXYWH(0, 10, 8, 8), paint);
+
+    const SkPoint pts[] = { { 0, 0 }, { 20, 0 } };
+    const SkColor colors[] = { SK_ColorBLUE, SK_ColorYELLOW };
+    SkAutoTUnref<SkShader> shader(SkGradientShader::CreateLinear(pts, colors, NULL, 2,
+                                                                 SkShader::kClamp_TileMode));
+    paint.setShader(shader);
+    canvas->drawRect(SkRect::MakeXYWH(0, 20, 40, 10), paint);
+#ifdef SK_SUPPORT_LEGACY_SHADER_LOCALMATRIX
+    SkMatrix localMatrix;
+    localMatrix.setTranslate(15, 0);
+    shader->setLocalMatrix(localMatrix);
+    canvas->drawRect(SkRect::MakeXYWH(0, 40, 40, 10), paint);
+    shader->resetLocalMatrix();
+#endif
+    canvas->drawRect(SkRect::MakeXYWH(0, 60, 40, 10), paint);
+}
+
+static void test_repeated_paints(skiatest::Reporter* reporter) {
+    SkPictureRecorder recorder;
+    draw_repeated_paints(recorder.beginRecording(50, 80, NULL, 0));
+    SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+
+    SkBitmap expected, actual;
+    make_bm(&expected, 50, 80, SK_ColorBLACK, false);
+    SkCanvas canvas(expected);
+    draw_repeated_paints(&canvas);
+    draw(picture, 50, 80, &actual);
+
+    SkAutoLockPixels expectedLock(expected), actualLock(actual);
+    REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                          expected.getSize()));
+}
+
 DEF_TEST(Picture, reporter) {
 #ifdef SK_DEBUG
     test_deleting_empty_playback();
@@ -1602,6 +1774,9 @@ DEF_TEST(Picture, reporter) {
     test_clip_expansion(reporter);
     test_hierarchical(reporter);
     test_gen_id(reporter);
+    test_compact_paths(reporter);
+    test_compressed(reporter);
+    test_repeated_paints(reporter);
 }
 
 #if SK_SUPPORT_GPU
@@ -1643,3 +1818,350 @@ DEF_TEST(Canvas_EmptyBitmap, r) {
 
     test_draw_bitmaps(&canvas);
 }
+
+static void draw_scene(SkCanvas* canvas, bool withBitmap) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(SK_ColorRED);
+    canvas->clear(SK_ColorWHITE);
+    canvas->drawRect(SkRect::MakeXYWH(2, 2, 20, 12), paint);
+
+    canvas->save();
+    canvas->translate(10, 10);
+    canvas->clipRect(SkRect::MakeWH(15, 15));
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawCircle(8, 8, 10, paint);
+    canvas->restore();
+
+    canvas->saveLayerAlpha(NULL, 0x80);
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawOval(SkRect::MakeXYWH(16, 4, 12, 22), paint);
+    canvas->restore();
+
+    if (withBitmap) {
+        SkBitmap bm;
+        make_bm(&bm, 6, 6, SK_ColorCYAN, true);
+        canvas->drawBitmap(bm, 1, 22);
+    }
+}
+
+static void draw_picture(const SkPicture& picture, SkBitmap* bm) {
+    bm->allocN32Pixels(picture.width(), picture.height());
+    bm->eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(*bm);
+    picture.draw(&canvas);
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a), alpb(b);
+    return a.getSize() == b.getSize() && 0 == memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+// An SkRecord-backed picture must be indistinguishable from an SkPicturePlayback one.
+DEF_TEST(Picture_SkRecordBackend, reporter) {
+    for (int withBitmap = 0; withBitmap < 2; ++withBitmap) {
+        SkPictureRecorder recorder;
+        draw_scene(recorder.beginRecording(32, 32), SkToBool(withBitmap));
+        SkAutoTUnref<SkPicture> expected(recorder.endRecording());
+
+        draw_scene(recorder.EXPERIMENTAL_beginRecording(32, 32), SkToBool(withBitmap));
+        SkAutoTUnref<SkPicture> actual(recorder.endRecording());
+        REPORTER_ASSERT(reporter, withBitmap == actual->willPlayBackBitmaps());
+
+        SkBitmap expectedBM, actualBM;
+        draw_picture(*expected, &expectedBM);
+        draw_picture(*actual, &actualBM);
+        REPORTER_ASSERT(reporter, same_pixels(expectedBM, actualBM));
+
+        // Copies re-record the SkRecord.
+        SkAutoTUnref<SkPicture> clone(actual->clone());
+        draw_picture(*clone, &actualBM);
+        REPORTER_ASSERT(reporter, same_pixels(expectedBM, actualBM));
+        SkPicture copy(*actual);
+        draw_picture(copy, &actualBM);
+        REPORTER_ASSERT(reporter, same_pixels(expectedBM, actualBM));
+
+        // Serializing writes the usual .skp format.
+        SkDynamicMemoryWStream wstream;
+        actual->serialize(&wstream);
+        SkAutoTUnref<SkStreamAsset> rstream(wstream.detachAsStream());
+        SkAutoTUnref<SkPicture> loaded(SkPicture::CreateFromStream(rstream));
+        REPORTER_ASSERT(reporter, NULL != loaded);
+        if (NULL != loaded) {
+            REPORTER_ASSERT(reporter, withBitmap == loaded->willPlayBackBitmaps());
+            draw_picture(*loaded, &actualBM);
+            REPORTER_ASSERT(reporter, same_pixels(expectedBM, actualBM));
+        }
+
+        // Partial replay draws what has been recorded so far.
+        draw_scene(recorder.EXPERIMENTAL_beginRecording(32, 32), SkToBool(withBitmap));
+        actualBM.eraseColor(SK_ColorTRANSPARENT);
+        {
+            SkCanvas canvas(actualBM);
+            SkPictureRecorderReplayTester::Replay(&recorder, &canvas);
+        }
+        REPORTER_ASSERT(reporter, same_pixels(expectedBM, actualBM));
+        SkAutoTUnref<SkPicture> unused(recorder.endRecording());
+    }
+}
+
+// Culling playback with a BBH must not change what the picture draws.
+DEF_TEST(Picture_SkRecordBackendBBH, reporter) {
+    SkTileGridFactory::TileGridInfo gridInfo;
+    gridInfo.fMargin.setEmpty();
+    gridInfo.fOffset.setZero();
+    gridInfo.fTileInterval.set(8, 8);
+    SkTileGridFactory tileGrid(gridInfo);
+    SkRTreeFactory rtree;
+    SkBBHFactory* factories[] = { &tileGrid, &rtree };
+
+    SkPictureRecorder recorder;
+    draw_scene(recorder.EXPERIMENTAL_beginRecording(32, 32), true);
+    SkAutoTUnref<SkPicture> unculled(recorder.endRecording());
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(factories); ++i) {
+        draw_scene(recorder.EXPERIMENTAL_beginRecording(32, 32, factories[i]), true);
+        SkAutoTUnref<SkPicture> culled(recorder.endRecording());
+        SkAutoTUnref<SkPicture> clone(culled->clone());
+
+        const SkPicture* pictures[] = { culled.get(), clone.get() };
+        for (size_t p = 0; p < SK_ARRAY_COUNT(pictures); ++p) {
+            // Draw in 8x8 tiles, as a tiled rasterizer would.
+            for (int y = 0; y < 32; y += 8) {
+                for (int x = 0; x < 32; x += 8) {
+                    SkBitmap expected, actual;
+                    expected.allocN32Pixels(8, 8);
+                    actual.allocN32Pixels(8, 8);
+                    expected.eraseColor(SK_ColorTRANSPARENT);
+                    actual.eraseColor(SK_ColorTRANSPARENT);
+
+                    SkCanvas expectedCanvas(expected);
+                    expectedCanvas.translate(-SkIntToScalar(x), -SkIntToScalar(y));
+                    unculled->draw(&expectedCanvas);
+
+                    SkCanvas actualCanvas(actual);
+                    actualCanvas.translate(-SkIntToScalar(x), -SkIntToScalar(y));
+                    pictures[p]->draw(&actualCanvas);
+
+                    REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+                }
+            }
+        }
+    }
+}
+
+static void draw_occluded_scene(SkCanvas* canvas, SkColor occluderColor) {
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRect(SkRect::MakeWH(50, 50), paint);
+
+    canvas->save();
+    canvas->clipRect(SkRect::MakeLTRB(10, 10, 40, 40));
+    paint.setColor(SK_ColorRED);
+    canvas->drawRect(SkRect::MakeWH(30, 30), paint);
+    canvas->restore();
+
+    // This clip grows past the playback clip, so its draw cannot be culled.
+    canvas->save();
+    canvas->clipRect(SkRect::MakeLTRB(-20, -20, 60, 60), SkRegion::kReplace_Op);
+    canvas->drawRect(SkRect::MakeLTRB(-10, -10, 20, 20), paint);
+    canvas->restore();
+
+    paint.setColor(occluderColor);
+    canvas->drawRect(SkRect::MakeLTRB(-5, -5, 105, 105), paint);
+
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRect(SkRect::MakeXYWH(20, 20, 10, 10), paint);
+}
+
+class DrawRectCountingCanvas : public SkCanvas {
+public:
+    DrawRectCountingCanvas(int width, int height)
+        : INHERITED(width, height)
+        , fDrawRectCount(0) {
+    }
+
+    virtual void drawRect(const SkRect& rect, const SkPaint& paint) SK_OVERRIDE {
+        fDrawRectCount += 1;
+        this->INHERITED::drawRect(rect, paint);
+    }
+
+    int getDrawRectCount() const { return fDrawRectCount; }
+
+private:
+    int fDrawRectCount;
+
+    typedef SkCanvas INHERITED;
+};
+
+DEF_TEST(Picture_OcclusionCulling, reporter) {
+    SkRTreeFactory factory;
+    SkPictureRecorder recorder;
+
+    draw_occluded_scene(recorder.beginRecording(100, 100, &factory), SK_ColorGREEN);
+    SkAutoTUnref<SkPicture> opaque(recorder.endRecording());
+    DrawRectCountingCanvas opaqueCanvas(100, 100);
+    opaque->draw(&opaqueCanvas);
+    // Only the kReplace_Op clipped draw survives behind the opaque rect.
+    REPORTER_ASSERT(reporter, 3 == opaqueCanvas.getDrawRectCount());
+
+    draw_occluded_scene(recorder.beginRecording(100, 100, &factory), 0x8000FF00);
+    SkAutoTUnref<SkPicture> translucent(recorder.endRecording());
+    DrawRectCountingCanvas translucentCanvas(100, 100);
+    translucent->draw(&translucentCanvas);
+    REPORTER_ASSERT(reporter, 5 == translucentCanvas.getDrawRectCount());
+
+    // Culling must not change what is drawn, whatever the playback clip.
+    draw_occluded_scene(recorder.beginRecording(100, 100), SK_ColorGREEN);
+    SkAutoTUnref<SkPicture> unculled(recorder.endRecording());
+    for (int y = 0; y < 100; y += 25) {
+        for (int x = 0; x < 100; x += 25) {
+            SkBitmap expected, actual;
+            expected.allocN32Pixels(25, 25);
+            actual.allocN32Pixels(25, 25);
+            expected.eraseColor(SK_ColorTRANSPARENT);
+            actual.eraseColor(SK_ColorTRANSPARENT);
+
+            SkCanvas expectedCanvas(expected);
+            expectedCanvas.translate(-SkIntToScalar(x), -SkIntToScalar(y));
+            unculled->draw(&expectedCanvas);
+
+            SkCanvas actualCanvas(actual);
+            actualCanvas.translate(-SkIntToScalar(x), -SkIntToScalar(y));
+            opaque->draw(&actualCanvas);
+
+            REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+        }
+    }
+}
+
+static void draw_serialized_scene(SkCanvas* canvas) {
+    SkPictureRecorder recorder;
+    SkCanvas* nested = recorder.beginRecording(20, 20);
+    SkPaint paint;
+    paint.setColor(SK_ColorRED);
+    nested->drawCircle(10, 10, 8, paint);
+    SkAutoTUnref<SkPicture> child(recorder.endRecording());
+
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRect(SkRect::MakeXYWH(2, 2, 30, 20), paint);
+    canvas->save();
+    canvas->translate(10, 15);
+    canvas->drawPicture(child);
+    canvas->restore();
+    SkPath path;
+    path.moveTo(0, 40);
+    path.lineTo(40, 30);
+    path.lineTo(30, 10);
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawPath(path, paint);
+}
+
+static void draw_picture_to(const SkPicture* picture, SkBitmap* bitmap) {
+    bitmap->allocN32Pixels(40, 40);
+    bitmap->eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(*bitmap);
+    canvas.drawPicture(const_cast<SkPicture*>(picture));
+}
+
+DEF_TEST(Picture_CreateFromData, reporter) {
+    SkPictureRecorder recorder;
+    draw_serialized_scene(recorder.beginRecording(40, 40));
+    SkAutoTUnref<SkPicture> original(recorder.endRecording());
+
+    SkAutoDataUnref data(NULL);
+    {
+        // The stream keeps a ref on the data it hands out.
+        SkDynamicMemoryWStream wStream;
+        original->serialize(&wStream);
+        data.reset(wStream.copyToData());
+    }
+
+    SkBitmap expected;
+    draw_picture_to(original, &expected);
+
+    SkAutoTUnref<SkPicture> loaded(SkPicture::CreateFromData(data));
+    REPORTER_ASSERT(reporter, NULL != loaded.get());
+    if (NULL == loaded.get()) {
+        return;
+    }
+    // The loaded picture reads its ops in place, so it has to keep the data alive.
+    REPORTER_ASSERT(reporter, !data->unique());
+
+    SkBitmap actual;
+    draw_picture_to(loaded, &actual);
+    REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+
+    loaded.reset(NULL);
+    REPORTER_ASSERT(reporter, data->unique());
+
+    // Data at an odd address can't be read in place, and is copied instead.
+    SkAutoMalloc storage(data->size() + 1);
+    memcpy(static_cast<char*>(storage.get()) + 1, data->data(), data->size());
+    SkAutoDataUnref shifted(SkData::NewWithCopy(storage.get(), data->size() + 1));
+    SkAutoDataUnref unaligned(SkData::NewSubset(shifted, 1, data->size()));
+    loaded.reset(SkPicture::CreateFromData(unaligned));
+    REPORTER_ASSERT(reporter, NULL != loaded.get());
+    if (NULL != loaded.get()) {
+        draw_picture_to(loaded, &actual);
+        REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+    }
+
+    REPORTER_ASSERT(reporter, NULL == SkPicture::CreateFromData(NULL));
+}
+
+namespace {
+
+// Hands out a bitmap-backed canvas per tile and remembers the bitmaps.
+class BitmapTileFactory : public SkPicture::TileCanvasFactory {
+public:
+    virtual SkCanvas* newTileCanvas(const SkIRect& tile) SK_OVERRIDE {
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(tile.width(), tile.height());
+        bitmap.eraseColor(SK_ColorTRANSPARENT);
+
+        SkAutoMutexAcquire lock(fMutex);
+        fTiles.push_back(tile);
+        fBitmaps.push_back(bitmap);
+        return SkNEW_ARGS(SkCanvas, (bitmap));
+    }
+
+    SkTArray<SkIRect> fTiles;
+    SkTArray<SkBitmap> fBitmaps;
+
+private:
+    SkMutex fMutex;
+};
+
+}  // namespace
+
+DEF_TEST(Picture_PlaybackTiled, reporter) {
+    SkRTreeFactory factory;
+    SkPictureRecorder recorder;
+    draw_serialized_scene(recorder.beginRecording(40, 40, &factory));
+    SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+
+    static const int kThreadCounts[] = { 1, 3 };
+    for (size_t t = 0; t < SK_ARRAY_COUNT(kThreadCounts); ++t) {
+        BitmapTileFactory tiles;
+        picture->playbackTiled(&tiles, SkISize::Make(16, 12), kThreadCounts[t]);
+        // 3 columns of 16, 16 and 8 pixels by 4 rows of 12, 12, 12 and 4.
+        REPORTER_ASSERT(reporter, 12 == tiles.fTiles.count());
+
+        int area = 0;
+        for (int i = 0; i < tiles.fTiles.count(); ++i) {
+            const SkIRect& tile = tiles.fTiles[i];
+            area += tile.width() * tile.height();
+
+            SkBitmap expected;
+            expected.allocN32Pixels(tile.width(), tile.height());
+            expected.eraseColor(SK_ColorTRANSPARENT);
+            SkCanvas canvas(expected);
+            canvas.translate(-SkIntToScalar(tile.fLeft), -SkIntToScalar(tile.fTop));
+            picture->draw(&canvas);
+
+            REPORTER_ASSERT(reporter, same_pixels(expected, tiles.fBitmaps[i]));
+        }
+        REPORTER_ASSERT(reporter, 40 * 40 == area);
+    }
+}
@@ -9,8 +9,14 @@
 #include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkGPipe.h"
+#include "SkGPipeSharedRing.h"
+#include "SkGradientShader.h"
+#include "SkOSFile.h"
 #include "SkPaint.h"
 #include "SkShader.h"
+#include "SkStream.h"
+#include "SkThreadUtils.h"
+#include "SkTypeface.h"
 #include "Test.h"
 
 // Ensures that the pipe gracefully handles drawing an invalid bitmap.
@@ -54,3 +60,373 @@ DEF_TEST(Pipe, reporter) {
 
     testDrawingAfterEndRecording(&canvas);
 }
+
+// Ensures that bitmaps sent through shared memory draw the same as bitmaps flattened into the
+// stream.
+DEF_TEST(Pipe_SharedPixelMemory, reporter) {
+    SkBitmap bm;
+    bm.allocN32Pixels(8, 8);
+    for (int y = 0; y < bm.height(); ++y) {
+        for (int x = 0; x < bm.width(); ++x) {
+            *bm.getAddr32(x, y) = SkPreMultiplyColor(SkColorSetARGB(0xFF, x * 30, y * 30, 0x80));
+        }
+    }
+
+    const uint32_t flags[] = {
+        SkGPipeWriter::kCrossProcess_Flag,
+        SkGPipeWriter::kCrossProcess_Flag | SkGPipeWriter::kSharedPixelMemory_Flag,
+    };
+    SkBitmap results[SK_ARRAY_COUNT(flags)];
+    for (size_t i = 0; i < SK_ARRAY_COUNT(flags); ++i) {
+        results[i].allocN32Pixels(32, 32);
+        results[i].eraseColor(SK_ColorWHITE);
+        SkCanvas canvas(results[i]);
+        PipeController pipeController(&canvas);
+        SkGPipeWriter writer;
+        SkCanvas* pipeCanvas = writer.startRecording(&pipeController, flags[i]);
+        pipeCanvas->drawBitmap(bm, 3, 5);
+        pipeCanvas->drawBitmap(bm, 20, 17);
+        writer.endRecording();
+    }
+
+    SkAutoLockPixels alp0(results[0]), alp1(results[1]);
+    REPORTER_ASSERT(reporter, 0 == memcmp(results[0].getPixels(), results[1].getPixels(),
+                                          results[0].getSize()));
+}
+
+static void draw_many_rects(SkCanvas* canvas) {
+    SkPaint paint;
+    for (int i = 0; i < 10000; ++i) {
+        paint.setColor(SkColorSetARGB(0xFF, i & 0xFF, (i * 7) & 0xFF, (i * 13) & 0xFF));
+        canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(i % 29), SkIntToScalar(i % 31), 3, 3),
+                         paint);
+    }
+}
+
+struct RingPlayback {
+    const char* fName;
+    SkCanvas* fCanvas;
+    SkGPipeReader::Status fStatus;
+};
+
+static void play_ring(void* data) {
+    RingPlayback* playback = static_cast<RingPlayback*>(data);
+    SkAutoTDelete<SkGPipeSharedRingReader> ring(SkGPipeSharedRingReader::Open(playback->fName));
+    if (NULL == ring.get()) {
+        playback->fStatus = SkGPipeReader::kError_Status;
+        return;
+    }
+    SkGPipeReader reader(playback->fCanvas);
+    playback->fStatus = ring->playback(&reader);
+}
+
+// Draws through a ring much smaller than the stream, so the writer has to wrap around and wait
+// for the reader, and checks the result against the plain controller.
+DEF_TEST(Pipe_SharedRing, reporter) {
+    SkAutoTDelete<SkGPipeSharedRingController> controller(
+            SkGPipeSharedRingController::Create(64 * 1024));
+    if (NULL == controller.get()) {
+        return;  // No shared memory here.
+    }
+
+    SkBitmap expected, actual;
+    expected.allocN32Pixels(32, 32);
+    expected.eraseColor(SK_ColorWHITE);
+    actual.allocN32Pixels(32, 32);
+    actual.eraseColor(SK_ColorWHITE);
+    {
+        SkCanvas canvas(expected);
+        PipeController pipeController(&canvas);
+        SkGPipeWriter writer;
+        draw_many_rects(writer.startRecording(&pipeController, SkGPipeWriter::kCrossProcess_Flag));
+    }
+
+    SkCanvas canvas(actual);
+    RingPlayback playback = { controller->name(), &canvas, SkGPipeReader::kError_Status };
+    SkThread thread(play_ring, &playback);
+    REPORTER_ASSERT(reporter, thread.start());
+    {
+        SkGPipeWriter writer;
+        draw_many_rects(writer.startRecording(controller.get(),
+                                              SkGPipeWriter::kCrossProcess_Flag));
+    }
+    thread.join();
+
+    REPORTER_ASSERT(reporter, SkGPipeReader::kDone_Status == playback.fStatus);
+    SkAutoLockPixels alpe(expected), alpa(actual);
+    REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                          expected.getSize()));
+
+    // A reader that goes away stops the writer.
+    SkAutoTDelete<SkGPipeSharedRingController> orphan(
+            SkGPipeSharedRingController::Create(64 * 1024));
+    SkAutoTDelete<SkGPipeSharedRingReader> gone(SkGPipeSharedRingReader::Open(orphan->name()));
+    REPORTER_ASSERT(reporter, NULL != gone.get());
+    gone.free();
+    size_t size;
+    REPORTER_ASSERT(reporter, NULL == orphan->requestBlock(16 * 1024, &size));
+}
+
+class CountingPipeController : public PipeController {
+public:
+    CountingPipeController(SkCanvas* target) : INHERITED(target), fBytes(0) {}
+
+    virtual void notifyWritten(size_t bytes) SK_OVERRIDE {
+        fBytes += bytes;
+        this->INHERITED::notifyWritten(bytes);
+    }
+
+    size_t fBytes;
+
+private:
+    typedef PipeController INHERITED;
+};
+
+// Draws 'count' rects, each with its own gradient.
+static void draw_gradient_frame(SkCanvas* canvas, int count) {
+    canvas->clear(SK_ColorWHITE);
+    const SkPoint pts[] = { { 0, 0 }, { 16, 16 } };
+    for (int i = 0; i < count; ++i) {
+        const SkColor colors[] = { SkColorSetRGB(i & 0xFF, 0x80, (i >> 8) * 0x40), SK_ColorBLUE };
+        SkPaint paint;
+        paint.setShader(SkGradientShader::CreateLinear(pts, colors, NULL, 2,
+                                                       SkShader::kClamp_TileMode))->unref();
+        canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(i % 61), SkIntToScalar(i % 53), 4, 4),
+                         paint);
+    }
+}
+
+// Plays 'sessions' frames of 'count' gradients through one writer and reader, checking each
+// frame against drawing directly, and returns the bytes the last session took.
+static size_t play_gradient_frames(skiatest::Reporter* reporter, uint32_t flags, int count,
+                                   int sessions) {
+    SkBitmap expected, actual;
+    expected.allocN32Pixels(64, 64);
+    actual.allocN32Pixels(64, 64);
+    SkCanvas expectedCanvas(expected);
+    draw_gradient_frame(&expectedCanvas, count);
+
+    SkCanvas canvas(actual);
+    CountingPipeController controller(&canvas);
+    SkGPipeWriter writer;
+    size_t bytes = 0;
+    for (int i = 0; i < sessions; ++i) {
+        actual.eraseColor(SK_ColorBLACK);
+        controller.fBytes = 0;
+        draw_gradient_frame(writer.startRecording(&controller, flags), count);
+        writer.endRecording();
+        bytes = controller.fBytes;
+
+        SkAutoLockPixels alpe(expected), alpa(actual);
+        REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                              expected.getSize()));
+    }
+    return bytes;
+}
+
+// Effects are only sent in the first of several sessions with kPersistentFlattenables_Flag, and
+// are evicted and sent again when there are more than fit.
+DEF_TEST(Pipe_PersistentFlattenables, reporter) {
+    const uint32_t modes[] = { 0, SkGPipeWriter::kCrossProcess_Flag };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(modes); ++i) {
+        const uint32_t flags = modes[i];
+        const uint32_t persistent = flags | SkGPipeWriter::kPersistentFlattenables_Flag;
+
+        const size_t plain = play_gradient_frames(reporter, flags, 100, 3);
+        const size_t first = play_gradient_frames(reporter, persistent, 100, 1);
+        const size_t cached = play_gradient_frames(reporter, persistent, 100, 3);
+        REPORTER_ASSERT(reporter, first <= plain + 64);
+        REPORTER_ASSERT(reporter, cached * 3 < first);
+
+        // More gradients than the cache holds.
+        play_gradient_frames(reporter, persistent, 600, 3);
+    }
+}
+
+static void draw_text_frame(SkCanvas* canvas, SkTypeface* face) {
+    canvas->clear(SK_ColorWHITE);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(24);
+    paint.setTypeface(face);
+    canvas->drawText("Funk", 4, 4, 40, paint);
+}
+
+// Keeps everything a writer sends in one buffer, to be played back later.
+class BufferingPipeController : public SkGPipeController {
+public:
+    BufferingPipeController() : fStorage(kCapacity), fUsed(0) {}
+
+    virtual void* requestBlock(size_t minRequest, size_t* actual) SK_OVERRIDE {
+        if (fUsed + minRequest > kCapacity) {
+            return NULL;
+        }
+        *actual = kCapacity - fUsed;
+        return static_cast<char*>(fStorage.get()) + fUsed;
+    }
+
+    virtual void notifyWritten(size_t bytes) SK_OVERRIDE {
+        fUsed += bytes;
+    }
+
+    SkGPipeReader::Status play(SkCanvas* canvas) {
+        SkGPipeReader reader(canvas);
+        return reader.playback(fStorage.get(), fUsed);
+    }
+
+    size_t bytes() const { return fUsed; }
+
+private:
+    static const size_t kCapacity = 1 << 20;
+
+    SkAutoMalloc fStorage;
+    size_t       fUsed;
+};
+
+static void check_text_frame(skiatest::Reporter* reporter, const SkBitmap& actual,
+                             SkTypeface* face) {
+    SkBitmap expected;
+    expected.allocN32Pixels(64, 64);
+    SkCanvas expectedCanvas(expected);
+    draw_text_frame(&expectedCanvas, face);
+
+    SkAutoLockPixels alpe(expected), alpa(actual);
+    REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                          expected.getSize()));
+}
+
+// Plays back what controller holds, and checks it drew a frame of text in face.
+static void play_text_frame(skiatest::Reporter* reporter, BufferingPipeController* controller,
+                            SkTypeface* face) {
+    SkBitmap actual;
+    actual.allocN32Pixels(64, 64);
+    SkCanvas canvas(actual);
+    REPORTER_ASSERT(reporter, SkGPipeReader::kDone_Status == controller->play(&canvas));
+    check_text_frame(reporter, actual, face);
+}
+
+// Records a frame of text in face in a new session of writer, plays it back and checks it
+// against drawing directly. Returns the bytes the session took.
+static size_t play_text_frame(skiatest::Reporter* reporter, SkGPipeWriter* writer,
+                              uint32_t flags, SkTypeface* face) {
+    BufferingPipeController controller;
+    draw_text_frame(writer->startRecording(&controller, flags), face);
+    writer->endRecording();
+    play_text_frame(reporter, &controller, face);
+    return controller.bytes();
+}
+
+static SkTypeface* create_web_font(const char testName[]) {
+    SkString resourcePath = skiatest::Test::GetResourcePath();
+    if (resourcePath.isEmpty()) {
+        SkDebugf("Could not run %s test because resourcePath not specified.", testName);
+        return NULL;
+    }
+    SkString filename = SkOSPath::SkPathJoin(resourcePath.c_str(), "Funkster.ttf");
+    SkTypeface* face = SkTypeface::CreateFromFile(filename.c_str());
+    if (NULL == face) {
+        SkDebugf("Could not run %s test because Funkster.ttf not loaded.", testName);
+    }
+    return face;
+}
+
+static const uint32_t kSharedFontFlags = SkGPipeWriter::kCrossProcess_Flag |
+                                         SkGPipeWriter::kSharedFontData_Flag;
+
+// With kSharedFontData_Flag, a writer only sends font data in the first session that uses it.
+DEF_TEST(Pipe_SharedFontData, reporter) {
+    SkAutoTUnref<SkTypeface> face(create_web_font("Pipe_SharedFontData"));
+    if (NULL == face.get()) {
+        return;
+    }
+    SkAutoTUnref<SkStream> fontStream(face->openStream(NULL));
+    const size_t fontSize = NULL == fontStream.get() ? 0 : fontStream->getLength();
+
+    const uint32_t flags = SkGPipeWriter::kCrossProcess_Flag;
+    SkGPipeWriter::ForgetSharedFonts();
+    SkGPipeReader::PurgeSharedFonts();
+
+    SkGPipeWriter plainWriter;
+    const size_t plain = play_text_frame(reporter, &plainWriter, flags, face);
+    REPORTER_ASSERT(reporter, plain == play_text_frame(reporter, &plainWriter, flags, face));
+
+    SkGPipeWriter writer;
+    const size_t first = play_text_frame(reporter, &writer, kSharedFontFlags, face);
+    const size_t second = play_text_frame(reporter, &writer, kSharedFontFlags, face);
+    REPORTER_ASSERT(reporter, first <= plain);
+    if (plain > fontSize) {
+        // The font host sends its data; the second session sends a 12 byte ID in its place.
+        REPORTER_ASSERT(reporter, second + fontSize <= first + 12);
+    }
+
+    // Another writer can't know what the reader process has played back, so it sends the data
+    // too; the reader still makes one typeface of both.
+    SkGPipeWriter otherWriter;
+    REPORTER_ASSERT(reporter, first == play_text_frame(reporter, &otherWriter, kSharedFontFlags,
+                                                       face));
+
+    // Once they are forgotten and purged, fonts are sent again.
+    SkGPipeWriter::ForgetSharedFonts();
+    SkGPipeReader::PurgeSharedFonts();
+    REPORTER_ASSERT(reporter, first == play_text_frame(reporter, &writer, kSharedFontFlags, face));
+
+    SkGPipeWriter::ForgetSharedFonts();
+    SkGPipeReader::PurgeSharedFonts();
+}
+
+// Each writer sends the font data its readers need, so pipes recorded side by side can be played
+// back in any order.
+DEF_TEST(Pipe_SharedFontDataOrder, reporter) {
+    SkAutoTUnref<SkTypeface> face(create_web_font("Pipe_SharedFontDataOrder"));
+    if (NULL == face.get()) {
+        return;
+    }
+    SkGPipeWriter::ForgetSharedFonts();
+    SkGPipeReader::PurgeSharedFonts();
+
+    BufferingPipeController first, second;
+    SkGPipeWriter firstWriter, secondWriter;
+    SkCanvas* firstCanvas = firstWriter.startRecording(&first, kSharedFontFlags);
+    SkCanvas* secondCanvas = secondWriter.startRecording(&second, kSharedFontFlags);
+    draw_text_frame(firstCanvas, face);
+    draw_text_frame(secondCanvas, face);
+    firstWriter.endRecording();
+    secondWriter.endRecording();
+
+    play_text_frame(reporter, &second, face);
+    play_text_frame(reporter, &first, face);
+
+    SkGPipeWriter::ForgetSharedFonts();
+    SkGPipeReader::PurgeSharedFonts();
+}
+
+// A reader that is sent the ID of font data it no longer has fails, rather than draw with some
+// other font.
+DEF_TEST(Pipe_SharedFontDataPurged, reporter) {
+    SkAutoTUnref<SkTypeface> face(create_web_font("Pipe_SharedFontDataPurged"));
+    if (NULL == face.get()) {
+        return;
+    }
+    SkGPipeWriter::ForgetSharedFonts();
+    SkGPipeReader::PurgeSharedFonts();
+
+    SkGPipeWriter writer;
+    play_text_frame(reporter, &writer, kSharedFontFlags, face);
+
+    // Purged without telling the writer, which sends only the ID.
+    SkGPipeReader::PurgeSharedFonts();
+    BufferingPipeController controller;
+    draw_text_frame(writer.startRecording(&controller, kSharedFontFlags), face);
+    writer.endRecording();
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(64, 64);
+    SkCanvas canvas(bitmap);
+    REPORTER_ASSERT(reporter, SkGPipeReader::kError_Status == controller.play(&canvas));
+
+    // Once the writer forgets, the data is sent again.
+    SkGPipeWriter::ForgetSharedFonts();
+    play_text_frame(reporter, &writer, kSharedFontFlags, face);
+
+    SkGPipeWriter::ForgetSharedFonts();
+    SkGPipeReader::PurgeSharedFonts();
+}
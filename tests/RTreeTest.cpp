@@ -114,6 +114,18 @@ static void rtree_test_main(SkRTree* rtree, skiatest::Reporter* reporter) {
         rtree->clear();
         REPORTER_ASSERT(reporter, 0 == rtree->getCount());
 
+        // Bulk-load most of them, then insert the rest into the bulk-loaded tree.
+        for (int i = 0; i < NUM_RECTS - 10; ++i) {
+            rtree->insert(rects[i].data, rects[i].rect, true);
+        }
+        rtree->flushDeferredInserts();
+        for (int i = NUM_RECTS - 10; i < NUM_RECTS; ++i) {
+            rtree->insert(rects[i].data, rects[i].rect);
+        }
+        run_queries(reporter, rand, rects, *rtree);
+        REPORTER_ASSERT(reporter, NUM_RECTS == rtree->getCount());
+        rtree->clear();
+
         // Then try immediate inserts
         for (int i = 0; i < NUM_RECTS; ++i) {
             rtree->insert(rects[i].data, rects[i].rect);
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkBlitter.h"
+#include "SkColorMatrixFilter.h"
+#include "SkColorPriv.h"
+#include "SkCoreBlitters.h"
+#include "SkGradientShader.h"
+#include "SkHalf.h"
+#include "SkMask.h"
+#include "SkRandom.h"
+#include "SkRasterPipeline.h"
+#include "Test.h"
+
+DEF_TEST(Half, reporter) {
+    // Every half that isn't a NaN survives the trip through float.
+    int mismatches = 0;
+    for (int i = 0; i < 0x10000; ++i) {
+        SkHalf h = SkToU16(i);
+        if ((h & 0x7c00) == 0x7c00 && (h & 0x03ff)) {
+            continue;
+        }
+        if (SkFloatToHalf(SkHalfToFloat(h)) != h) {
+            ++mismatches;
+        }
+    }
+    REPORTER_ASSERT(reporter, 0 == mismatches);
+
+    REPORTER_ASSERT(reporter, 1.0f == SkHalfToFloat(SK_Half1));
+    REPORTER_ASSERT(reporter, 65504.0f == SkHalfToFloat(SK_HalfMax));
+    REPORTER_ASSERT(reporter, 0x0001 == SkFloatToHalf(5.9604645e-8f));     // smallest denormal
+    REPORTER_ASSERT(reporter, 0x7c00 == SkFloatToHalf(65520.0f));          // rounds up to infinity
+    REPORTER_ASSERT(reporter, 0xfc00 == SkFloatToHalf(-1e9f));
+    REPORTER_ASSERT(reporter, 0x8000 == SkFloatToHalf(-0.0f));
+    // Halfway between 1 and the next half rounds to the even one, 1.
+    REPORTER_ASSERT(reporter, SK_Half1 == SkFloatToHalf(1.0f + 1.0f / 2048));
+    REPORTER_ASSERT(reporter, SK_Half1 + 2 == SkFloatToHalf(1.0f + 3.0f / 2048));
+    REPORTER_ASSERT(reporter, 0x3555 == SkFloatToHalf(1.0f / 3));
+}
+
+static uint64_t pack_f16(float r, float g, float b, float a) {
+    SkHalf h[4] = { SkFloatToHalf(r), SkFloatToHalf(g), SkFloatToHalf(b), SkFloatToHalf(a) };
+    uint64_t px;
+    memcpy(&px, h, sizeof(px));
+    return px;
+}
+
+static float channel_f16(uint64_t px, int channel) {
+    SkHalf h[4];
+    memcpy(h, &px, sizeof(px));
+    return SkHalfToFloat(h[channel]);
+}
+
+// Composites F16 onto F16, with colors brighter than 1, and a span that doesn't fill the last four.
+DEF_TEST(RasterPipeline_F16, reporter) {
+    static const int N = 7;
+    uint64_t src[N], dst[N], expected[N];
+    SkRandom rand;
+    for (int i = 0; i < N; ++i) {
+        float sa = rand.nextF(),
+              da = rand.nextF();
+        float s[4] = { rand.nextF() * 4 * sa, rand.nextF() * sa, rand.nextF() * sa, sa };
+        float d[4] = { rand.nextF() * da, rand.nextF() * 2 * da, rand.nextF() * da, da };
+        src[i] = pack_f16(s[0], s[1], s[2], s[3]);
+        dst[i] = pack_f16(d[0], d[1], d[2], d[3]);
+
+        float result[4];
+        for (int c = 0; c < 4; ++c) {
+            result[c] = channel_f16(src[i], c) +
+                        channel_f16(dst[i], c) * (1 - channel_f16(src[i], 3));
+        }
+        expected[i] = pack_f16(result[0], result[1], result[2], result[3]);
+    }
+    const uint64_t sentinel = dst[N - 1];
+
+    const uint64_t* srcPtr = src;
+    uint64_t* dstPtr = dst;
+    SkRasterPipeline pipeline;
+    pipeline.append(SkRasterPipeline::kLoadS_F16_StockStage, &srcPtr);
+    pipeline.append(SkRasterPipeline::kLoadD_F16_StockStage, &dstPtr);
+    REPORTER_ASSERT(reporter, pipeline.appendXfermode(SkXfermode::kSrcOver_Mode));
+    pipeline.append(SkRasterPipeline::kStore_F16_StockStage, &dstPtr);
+    pipeline.run(N - 1);
+
+    for (int i = 0; i < N - 1; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            REPORTER_ASSERT(reporter, SkScalarNearlyEqual(channel_f16(dst[i], c),
+                                                          channel_f16(expected[i], c),
+                                                          channel_f16(expected[i], c) / 1000));
+        }
+    }
+    // The tail stops at the end of the span.
+    REPORTER_ASSERT(reporter, sentinel == dst[N - 1]);
+}
+
+static int max_channel_diff(SkPMColor a, SkPMColor b) {
+    int diff = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        diff = SkTMax(diff, SkAbs32((int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF)));
+    }
+    return diff;
+}
+
+// Every supported mode matches SkXfermode's procs, which round more often.
+DEF_TEST(RasterPipeline_Xfermodes, reporter) {
+    static const int N = 37;
+    SkPMColor src[N], dst[N], result[N];
+    SkRandom rand;
+    for (int i = 0; i < N; ++i) {
+        src[i] = SkPreMultiplyColor(rand.nextU());
+        dst[i] = SkPreMultiplyColor(rand.nextU());
+    }
+    src[0] = dst[1] = 0;
+    src[2] = dst[3] = SK_ColorBLACK;
+
+    for (int m = 0; m <= SkXfermode::kLastMode; ++m) {
+        SkXfermode::Mode mode = (SkXfermode::Mode)m;
+        SkRasterPipeline pipeline;
+        const SkPMColor* srcPtr = src;
+        SkPMColor* resultPtr = result;
+        pipeline.append(SkRasterPipeline::kLoadS_8888_StockStage, &srcPtr);
+        pipeline.append(SkRasterPipeline::kLoadD_8888_StockStage, &resultPtr);
+        bool supported = pipeline.appendXfermode(mode);
+        REPORTER_ASSERT(reporter, supported == SkRasterPipeline::SupportsXfermode(mode));
+        if (!supported) {
+            REPORTER_ASSERT(reporter, mode >= SkXfermode::kOverlay_Mode);
+            continue;
+        }
+        pipeline.append(SkRasterPipeline::kStore_8888_StockStage, &resultPtr);
+
+        memcpy(result, dst, sizeof(dst));
+        pipeline.run(N);
+
+        SkXfermodeProc proc = SkXfermode::GetProc(mode);
+        int maxDiff = 0;
+        for (int i = 0; i < N; ++i) {
+            maxDiff = SkTMax(maxDiff, max_channel_diff(result[i], proc(src[i], dst[i])));
+        }
+        REPORTER_ASSERT(reporter, maxDiff <= 2);
+    }
+}
+
+// Draws a row with full coverage, a row of runs and a few rows of mask, then checks them against
+// the usual blitters.
+static void blit_rows(SkBlitter* blitter, int width) {
+    blitter->blitH(0, 0, width);
+
+    SkAutoSTMalloc<64, SkAlpha> aa(width);
+    SkAutoSTMalloc<64, int16_t> runs(width + 1);
+    for (int x = 0; x < width; ++x) {
+        aa[x] = SkToU8(x * 255 / (width - 1));
+        runs[x] = 1;
+    }
+    runs[width] = 0;
+    blitter->blitAntiH(0, 1, aa.get(), runs.get());
+
+    SkAutoSTMalloc<256, uint8_t> maskImage(width * 3);
+    for (int i = 0; i < width * 3; ++i) {
+        maskImage[i] = SkToU8((i * 37) & 0xFF);
+    }
+    SkMask mask;
+    mask.fImage = maskImage.get();
+    mask.fBounds.set(0, 2, width, 5);
+    mask.fRowBytes = width;
+    mask.fFormat = SkMask::kA8_Format;
+    blitter->blitMask(mask, mask.fBounds);
+}
+
+DEF_TEST(RasterPipeline_Blitter, reporter) {
+    static const int W = 41;
+    static const int H = 5;
+    SkBitmap background;
+    background.allocN32Pixels(W, H);
+    SkRandom rand;
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            *background.getAddr32(x, y) = SkPreMultiplyColor(rand.nextU());
+        }
+    }
+
+    SkColorMatrix saturation;
+    saturation.setSaturation(0.3f);
+    saturation.fMat[4] = 20;
+    SkAutoTUnref<SkColorFilter> filter(SkColorMatrixFilter::Create(saturation));
+    const SkPoint pts[] = { { 0, 0 }, { SkIntToScalar(W), 0 } };
+    const SkColor colors[] = { 0xFF2080F0, 0x40F04010 };
+    SkAutoTUnref<SkShader> gradient(SkGradientShader::CreateLinear(pts, colors, NULL, 2,
+                                                                   SkShader::kClamp_TileMode));
+
+    static const SkXfermode::Mode gModes[] = {
+        SkXfermode::kSrcOver_Mode, SkXfermode::kSrc_Mode, SkXfermode::kMultiply_Mode,
+        SkXfermode::kScreen_Mode, SkXfermode::kDarken_Mode,
+    };
+    for (size_t m = 0; m < SK_ARRAY_COUNT(gModes); ++m) {
+        for (int variant = 0; variant < 3; ++variant) {
+            SkPaint paint;
+            paint.setColor(0xC0C04020);
+            paint.setXfermodeMode(gModes[m]);
+            if (variant & 1) {
+                paint.setColorFilter(filter);
+            }
+            if (variant & 2) {
+                paint.setShader(gradient);
+            }
+
+            SkBitmap expected, actual;
+            background.copyTo(&expected);
+            background.copyTo(&actual);
+            {
+                SkTBlitterAllocator allocator;
+                blit_rows(SkBlitter::Choose(expected, SkMatrix::I(), paint, &allocator), W);
+            }
+            {
+                SkTBlitterAllocator allocator;
+                SkBlitter* blitter = SkCreateRasterPipelineBlitter(actual, paint, SkMatrix::I(),
+                                                                   &allocator);
+                REPORTER_ASSERT(reporter, blitter);
+                if (NULL == blitter) {
+                    continue;
+                }
+                blit_rows(blitter, W);
+            }
+
+            int maxDiff = 0;
+            for (int y = 0; y < H; ++y) {
+                for (int x = 0; x < W; ++x) {
+                    maxDiff = SkTMax(maxDiff, max_channel_diff(*expected.getAddr32(x, y),
+                                                               *actual.getAddr32(x, y)));
+                }
+            }
+            REPORTER_ASSERT(reporter, maxDiff <= 3);
+        }
+    }
+
+    // Modes and filters it can't do are left to the usual blitters.
+    SkTBlitterAllocator allocator;
+    SkPaint paint;
+    paint.setXfermodeMode(SkXfermode::kHue_Mode);
+    REPORTER_ASSERT(reporter, NULL == SkCreateRasterPipelineBlitter(background, paint,
+                                                                    SkMatrix::I(), &allocator));
+}
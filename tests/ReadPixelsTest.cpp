@@ -10,6 +10,7 @@
 #include "SkColorPriv.h"
 #include "SkMathPriv.h"
 #include "SkRegion.h"
+#include "SkUtils.h"
 #include "Test.h"
 
 #if SK_SUPPORT_GPU
@@ -393,3 +394,82 @@ DEF_GPUTEST(ReadPixels, reporter, factory) {
         }
     }
 }
+
+#if SK_SUPPORT_GPU
+// An asynchronous read returns the same pixels as a synchronous one, whether or not the backend
+// could issue it asynchronously.
+DEF_GPUTEST(ReadPixelsAsync, reporter, factory) {
+    static const GrPixelConfig gConfigs[] = {
+        kRGBA_8888_GrPixelConfig,
+        kBGRA_8888_GrPixelConfig,
+    };
+    const SkIRect srcRect = SkIRect::MakeLTRB(DEV_W / 4, 3, DEV_W - 5, DEV_H / 2);
+    const int w = srcRect.width();
+    const int h = srcRect.height();
+
+    for (int type = 0; type < GrContextFactory::kGLContextTypeCnt; ++type) {
+        GrContextFactory::GLContextType glType = static_cast<GrContextFactory::GLContextType>(type);
+        if (!GrContextFactory::IsRenderingGLContext(glType)) {
+            continue;
+        }
+        GrContext* context = factory->get(glType);
+        if (NULL == context) {
+            continue;
+        }
+        for (int origin = 0; origin < 2; ++origin) {
+            GrTextureDesc desc;
+            desc.fFlags = kRenderTarget_GrTextureFlagBit | kNoStencil_GrTextureFlagBit;
+            desc.fWidth = DEV_W;
+            desc.fHeight = DEV_H;
+            desc.fConfig = kSkia8888_GrPixelConfig;
+            desc.fOrigin = 0 == origin ? kBottomLeft_GrSurfaceOrigin : kTopLeft_GrSurfaceOrigin;
+            GrAutoScratchTexture ast(context, desc, GrContext::kExact_ScratchTexMatch);
+            SkAutoTUnref<GrTexture> tex(ast.detach());
+            if (NULL == tex.get()) {
+                continue;
+            }
+            SkAutoTUnref<SkBaseDevice> device(SkNEW_ARGS(SkGpuDevice, (context, tex)));
+            SkCanvas canvas(device);
+            fillCanvas(&canvas);
+            GrRenderTarget* target = tex->asRenderTarget();
+
+            for (size_t c = 0; c < SK_ARRAY_COUNT(gConfigs); ++c) {
+                for (int unpremul = 0; unpremul < 2; ++unpremul) {
+                    const uint32_t flags = unpremul ? GrContext::kUnpremul_PixelOpsFlag : 0;
+                    SkAutoTMalloc<uint32_t> expected(w * h);
+                    REPORTER_ASSERT(reporter, context->readRenderTargetPixels(
+                            target, srcRect.fLeft, srcRect.fTop, w, h, gConfigs[c],
+                            expected.get(), 0, flags));
+
+                    uint32_t token = context->beginReadRenderTargetPixels(
+                            target, srcRect.fLeft, srcRect.fTop, w, h, gConfigs[c], flags);
+                    REPORTER_ASSERT(reporter, 0 != token);
+                    // Rows padded past the width are left alone.
+                    const int rowPixels = w + 3;
+                    SkAutoTMalloc<uint32_t> actual(rowPixels * h);
+                    sk_memset32(actual.get(), 0xDEADBEEF, rowPixels * h);
+                    REPORTER_ASSERT(reporter, context->finishReadRenderTargetPixels(
+                            token, actual.get(), rowPixels * sizeof(uint32_t)));
+                    // The token is retired.
+                    REPORTER_ASSERT(reporter, !context->isReadRenderTargetPixelsReady(token));
+                    REPORTER_ASSERT(reporter, !context->finishReadRenderTargetPixels(
+                            token, actual.get(), 0));
+
+                    for (int y = 0; y < h; ++y) {
+                        REPORTER_ASSERT(reporter, 0 == memcmp(&expected[y * w],
+                                                              &actual[y * rowPixels],
+                                                              w * sizeof(uint32_t)));
+                        for (int x = w; x < rowPixels; ++x) {
+                            REPORTER_ASSERT(reporter, 0xDEADBEEF == actual[y * rowPixels + x]);
+                        }
+                    }
+                }
+            }
+
+            // Reads outside the target are refused.
+            REPORTER_ASSERT(reporter, 0 == context->beginReadRenderTargetPixels(
+                    target, DEV_W - 10, 0, 20, 10, kRGBA_8888_GrPixelConfig));
+        }
+    }
+}
+#endif
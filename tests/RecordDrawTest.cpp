@@ -8,6 +8,7 @@
 #include "Test.h"
 #include "RecordTestUtils.h"
 
+#include "SkBBHFactory.h"
 #include "SkDebugCanvas.h"
 #include "SkRecord.h"
 #include "SkRecordOpts.h"
@@ -103,3 +104,66 @@ DEF_TEST(RecordDraw_SetMatrixClobber, r) {
     expected.postConcat(translate);
     REPORTER_ASSERT(r, setMatrix->matrix == expected);
 }
+
+// A tall page of blocks, each a translated rect inside its own save/restore.
+static void record_page(SkRecord* record, SkPaint paint = SkPaint()) {
+    SkRecorder recorder(record, W, H);
+    for (int i = 0; i < 10; i++) {
+        recorder.save();
+            recorder.translate(0, SkIntToScalar(100 * i));
+            recorder.drawRect(SkRect::MakeWH(50, 50), paint);
+        recorder.restore();
+    }
+}
+
+DEF_TEST(RecordDraw_BBH, r) {
+    SkRecord record;
+    record_page(&record);
+
+    SkRTreeFactory factory;
+    SkAutoTUnref<SkBBoxHierarchy> rtree(factory(W, H));
+    SkAutoTUnref<SkRecordBBH> bbh(SkNEW_ARGS(SkRecordBBH, (record, W, H, rtree)));
+
+    // Only the fourth block touches this strip.
+    SkRecord clipped;
+    SkRecorder recorder(&clipped, W, H);
+    recorder.clipRect(SkRect::MakeLTRB(0, 320, SkIntToScalar(W), 380));
+    SkRecordDraw(record, &recorder, bbh);
+
+    // The clipRect, then save, translate, drawRect, restore.
+    REPORTER_ASSERT(r, 5 == clipped.count());
+    assert_type<SkRecords::Save>(r, clipped, 1);
+    assert_type<SkRecords::DrawRect>(r, clipped, 3);
+    assert_type<SkRecords::Restore>(r, clipped, 4);
+
+    // Nothing touches this one.
+    SkRecord empty;
+    SkRecorder emptyRecorder(&empty, W, H);
+    emptyRecorder.clipRect(SkRect::MakeLTRB(100, 0, 200, 200));
+    SkRecordDraw(record, &emptyRecorder, bbh);
+    REPORTER_ASSERT(r, 1 == empty.count());
+}
+
+DEF_TEST(RecordDraw_BBHSaveLayer, r) {
+    // A layer whose paint draws over transparent black covers its whole clip, not just its draws.
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+    SkPaint paint;
+    paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+    recorder.saveLayer(NULL, &paint);
+        recorder.drawRect(SkRect::MakeWH(50, 50), SkPaint());
+    recorder.restore();
+
+    SkRTreeFactory factory;
+    SkAutoTUnref<SkBBoxHierarchy> rtree(factory(W, H));
+    SkAutoTUnref<SkRecordBBH> bbh(SkNEW_ARGS(SkRecordBBH, (record, W, H, rtree)));
+
+    SkRecord clipped;
+    SkRecorder clippedRecorder(&clipped, W, H);
+    clippedRecorder.clipRect(SkRect::MakeLTRB(500, 500, 600, 600));
+    SkRecordDraw(record, &clippedRecorder, bbh);
+    // The clipRect, then the saveLayer and restore, but not the drawRect.
+    REPORTER_ASSERT(r, 3 == clipped.count());
+    assert_type<SkRecords::SaveLayer>(r, clipped, 1);
+    assert_type<SkRecords::Restore>(r, clipped, 2);
+}
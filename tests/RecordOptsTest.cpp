@@ -243,3 +243,150 @@ DEF_TEST(RecordOpts_NoopSaveLayerDrawRestore, r) {
     REPORTER_ASSERT(r, drawRect != NULL);
     REPORTER_ASSERT(r, drawRect->paint.getColor() == 0x03020202);
 }
+
+DEF_TEST(RecordOpts_NoopRedundantClips, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.clipRect(SkRect::MakeWH(100, 100));
+    recorder.clipRect(SkRect::MakeWH(200, 200));             // Contains the clip: nooped.
+    recorder.save();
+        recorder.translate(10, 10);
+        recorder.clipRect(SkRect::MakeXYWH(-10, -10, 100, 100));  // Same clip: nooped.
+        recorder.clipRect(SkRect::MakeWH(50, 50));           // Shrinks it: kept.
+        recorder.clipRect(SkRect::MakeWH(60, 60));           // Nooped.
+    recorder.restore();
+    recorder.clipRect(SkRect::MakeWH(60, 60));               // Restore grew the clip back: kept.
+    recorder.clipRect(SkRect::MakeWH(80, 80), SkRegion::kIntersect_Op, true);  // AA: kept.
+    recorder.clipRect(SkRect::MakeWH(80, 80));               // The AA clip lost us: kept.
+
+    SkRecordNoopRedundantClips(&record);
+
+    assert_type<SkRecords::ClipRect>(r, record, 0);
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    assert_type<SkRecords::NoOp>(r, record, 4);
+    assert_type<SkRecords::ClipRect>(r, record, 5);
+    assert_type<SkRecords::NoOp>(r, record, 6);
+    assert_type<SkRecords::ClipRect>(r, record, 8);
+    assert_type<SkRecords::ClipRect>(r, record, 9);
+    assert_type<SkRecords::ClipRect>(r, record, 10);
+}
+
+DEF_TEST(RecordOpts_FoldMatrices, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.translate(10, 20);
+    recorder.scale(2, 3);
+    recorder.translate(1, 1);
+    recorder.drawRect(SkRect::MakeWH(10, 10), SkPaint());
+    recorder.rotate(30);
+    recorder.resetMatrix();
+    recorder.translate(5, 5);
+
+    SkRecordFoldMatrices(&record);
+
+    SkMatrix expected;
+    expected.setTranslate(10, 20);
+    expected.preScale(2, 3);
+    expected.preTranslate(1, 1);
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    REPORTER_ASSERT(r, expected == assert_type<SkRecords::Concat>(r, record, 2)->matrix);
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+
+    // The rotate is overwritten, and the translate folds into the reset.
+    assert_type<SkRecords::NoOp>(r, record, 4);
+    assert_type<SkRecords::NoOp>(r, record, 5);
+    expected.setTranslate(5, 5);
+    REPORTER_ASSERT(r, expected == assert_type<SkRecords::SetMatrix>(r, record, 6)->matrix);
+}
+
+DEF_TEST(RecordOpts_NoopOccludedDraws, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint opaque, translucent, aa;
+    translucent.setAlpha(0x80);
+    aa.setAntiAlias(true);
+
+    recorder.drawRect(SkRect::MakeWH(50, 50), translucent);    // Covered: nooped.
+    recorder.drawOval(SkRect::MakeXYWH(10, 10, 20, 20), aa);   // AA may spill over: kept.
+    recorder.drawRect(SkRect::MakeWH(150, 50), opaque);        // Not covered: kept.
+    recorder.drawRect(SkRect::MakeWH(100, 100), opaque);
+    recorder.drawRect(SkRect::MakeWH(10, 10), opaque);         // Covered by 6, under 5: nooped.
+    recorder.drawRect(SkRect::MakeWH(20, 20), translucent);    // Not an occluder: kept.
+    recorder.drawRect(SkRect::MakeWH(10, 10), opaque);         // Behind a state change: kept.
+    recorder.translate(1, 1);
+    recorder.drawRect(SkRect::MakeWH(20, 20), opaque);
+
+    SkRecordNoopOccludedDraws(&record);
+
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::DrawOval>(r, record, 1);
+    assert_type<SkRecords::DrawRect>(r, record, 2);
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+    assert_type<SkRecords::NoOp>(r, record, 4);
+    assert_type<SkRecords::DrawRect>(r, record, 5);
+    assert_type<SkRecords::DrawRect>(r, record, 6);
+    assert_type<SkRecords::DrawRect>(r, record, 8);
+}
+
+DEF_TEST(RecordOpts_NoopOccludedDrawsAAClip, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint opaque;
+    recorder.save();
+        recorder.clipRect(SkRect::MakeXYWH(0.5f, 0.5f, 50, 50), SkRegion::kIntersect_Op, true);
+        recorder.drawRect(SkRect::MakeWH(10, 10), opaque);     // Edges show through: kept.
+        recorder.drawRect(SkRect::MakeWH(20, 20), opaque);
+        recorder.save();
+            recorder.clipRect(SkRect::MakeWH(50, 50));         // Still under the AA clip.
+            recorder.drawRect(SkRect::MakeWH(10, 10), opaque); // Kept.
+            recorder.drawRect(SkRect::MakeWH(20, 20), opaque);
+        recorder.restore();
+    recorder.restore();
+    recorder.drawRect(SkRect::MakeWH(10, 10), opaque);         // AA clip is gone: nooped.
+    recorder.drawRect(SkRect::MakeWH(20, 20), opaque);
+
+    SkRecordNoopOccludedDraws(&record);
+
+    assert_type<SkRecords::DrawRect>(r, record, 2);
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+    assert_type<SkRecords::DrawRect>(r, record, 6);
+    assert_type<SkRecords::DrawRect>(r, record, 7);
+    assert_type<SkRecords::NoOp>(r, record, 10);
+    assert_type<SkRecords::DrawRect>(r, record, 11);
+}
+
+DEF_TEST(RecordOpts_BatchDrawRects, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint red, blue;
+    red.setColor(SK_ColorRED);
+    blue.setColor(SK_ColorBLUE);
+
+    recorder.drawRect(SkRect::MakeWH(10, 10), red);
+    recorder.drawRect(SkRect::MakeXYWH(20, 0, 10, 10), red);
+    recorder.drawRect(SkRect::MakeXYWH(40, 0, 10, 10), red);
+    recorder.drawRect(SkRect::MakeWH(10, 10), blue);   // Different paint: alone.
+    recorder.save();                                   // Not a DrawRect: ends the run.
+    recorder.drawRect(SkRect::MakeWH(10, 10), blue);
+    recorder.drawRect(SkRect::MakeWH(20, 20), blue);
+
+    SkRecordBatchDrawRects(&record);
+
+    const SkRecords::BatchedDrawRect* batch =
+        assert_type<SkRecords::BatchedDrawRect>(r, record, 0);
+    REPORTER_ASSERT(r, 3 == batch->count);
+    REPORTER_ASSERT(r, SkRect::MakeXYWH(40, 0, 10, 10) == batch->rects[2]);
+    REPORTER_ASSERT(r, red == batch->paint);
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    assert_type<SkRecords::NoOp>(r, record, 2);
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+    assert_type<SkRecords::Save>(r, record, 4);
+    REPORTER_ASSERT(r, 2 == assert_type<SkRecords::BatchedDrawRect>(r, record, 5)->count);
+    assert_type<SkRecords::NoOp>(r, record, 6);
+}
@@ -7,7 +7,9 @@
 
 #include "Test.h"
 
+#include "SkBitmap.h"
 #include "SkRecording.h"
+#include "SkThreadUtils.h"
 
 // Minimally exercise the public SkRecording API.
 
@@ -27,3 +29,75 @@ DEF_TEST(RecordingTest, r) {
     EXPERIMENTAL::SkRecording pointless(1920, 1080);
     pointless.canvas()->clipRect(SkRect::MakeWH(320, 240));
 }
+
+// Exercises matrix, clip and save state that spans chunks.
+static void draw_scene(SkCanvas* canvas) {
+    SkPaint paint;
+    canvas->save();
+        canvas->translate(10, 10);
+        canvas->clipRect(SkRect::MakeWH(60, 60));
+        paint.setColor(SK_ColorRED);
+        canvas->drawRect(SkRect::MakeWH(100, 100), paint);
+        canvas->save();
+            canvas->resetMatrix();
+            canvas->scale(2, 2);
+            paint.setColor(SK_ColorBLUE);
+            canvas->drawRect(SkRect::MakeXYWH(5, 5, 10, 10), paint);
+    canvas->restore();  // Leave the outer save open.
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawRect(SkRect::MakeXYWH(0, 0, 20, 20), paint);
+}
+
+struct PipelinedPlayback {
+    EXPERIMENTAL::SkPipelinedRecording* pipelined;
+    SkCanvas* canvas;
+};
+
+static void draw_pipelined(void* data) {
+    PipelinedPlayback* playback = static_cast<PipelinedPlayback*>(data);
+    playback->pipelined->draw(playback->canvas);
+}
+
+DEF_TEST(Recording_Pipelined, r) {
+    SkBitmap expected;
+    expected.allocN32Pixels(100, 100);
+    expected.eraseColor(SK_ColorWHITE);
+    {
+        SkCanvas canvas(expected);
+        draw_scene(&canvas);
+        canvas.drawRect(SkRect::MakeWH(1, 1), SkPaint());
+    }
+
+    // Smaller chunks than the scene has commands, one chunk, and a flush in the middle.
+    static const int kChunkSizes[] = { 1, 2, 3, 1000 };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kChunkSizes); i++) {
+        SkBitmap actual;
+        actual.allocN32Pixels(100, 100);
+        actual.eraseColor(SK_ColorWHITE);
+        SkCanvas canvas(actual);
+
+        EXPERIMENTAL::SkPipelinedRecording pipelined(100, 100, kChunkSizes[i]);
+        PipelinedPlayback playback = { &pipelined, &canvas };
+        SkThread thread(draw_pipelined, &playback);
+        REPORTER_ASSERT(r, thread.start());
+
+        draw_scene(pipelined.canvas());
+        pipelined.flush();
+        pipelined.canvas()->drawRect(SkRect::MakeWH(1, 1), SkPaint());
+        pipelined.finish();
+        REPORTER_ASSERT(r, NULL == pipelined.canvas());
+        thread.join();
+
+        // draw() leaves the canvas as it found it.
+        REPORTER_ASSERT(r, 1 == canvas.getSaveCount());
+        REPORTER_ASSERT(r, canvas.getTotalMatrix().isIdentity());
+
+        SkAutoLockPixels expectedLock(expected), actualLock(actual);
+        REPORTER_ASSERT(r, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                       expected.getSize()));
+    }
+
+    // finish() with nothing recorded, and no one drawing.
+    EXPERIMENTAL::SkPipelinedRecording unused(100, 100);
+    unused.finish();
+}
@@ -51,7 +51,13 @@ static void test_cache(skiatest::Reporter* reporter,
         size_t curCacheSize;
         context->getResourceCacheUsage(NULL, &curCacheSize);
 
-        // we should never go over the size limit
+        // draws may only go over the size limit by the hard budget's headroom
+        REPORTER_ASSERT(reporter,
+                        curCacheSize <= maxCacheSize * GrResourceCache::kHardBudgetScale);
+
+        // and the deferred cleanup brings the cache back within it
+        context->performDeferredCleanup();
+        context->getResourceCacheUsage(NULL, &curCacheSize);
         REPORTER_ASSERT(reporter, curCacheSize <= maxCacheSize);
     }
 
@@ -239,13 +245,36 @@ static void test_resource_size_changed(skiatest::Reporter* reporter,
         REPORTER_ASSERT(reporter, 200 == cache.getCachedResourceBytes());
         REPORTER_ASSERT(reporter, 2 == cache.getCachedResourceCount());
 
+        // Growing past the soft budget doesn't purge until the deferred cleanup.
         static_cast<TestResource*>(cache.find(key2))->setSize(201);
+        REPORTER_ASSERT(reporter, 301 == cache.getCachedResourceBytes());
+        REPORTER_ASSERT(reporter, 2 == cache.getCachedResourceCount());
+
+        cache.performDeferredCleanup();
         REPORTER_ASSERT(reporter, NULL == cache.find(key1));
 
         REPORTER_ASSERT(reporter, 201 == cache.getCachedResourceBytes());
         REPORTER_ASSERT(reporter, 1 == cache.getCachedResourceCount());
     }
 
+    // Test increasing a resources size beyond the hard budget.
+    {
+        GrResourceCache cache(2, 300);
+
+        TestResource* a = new TestResource(100);
+        cache.addResource(key1, a);
+        a->unref();
+
+        TestResource* b = new TestResource(100);
+        cache.addResource(key2, b);
+        b->unref();
+
+        static_cast<TestResource*>(cache.find(key2))->setSize(
+            300 * GrResourceCache::kHardBudgetScale);
+        REPORTER_ASSERT(reporter, NULL == cache.find(key1));
+        REPORTER_ASSERT(reporter, 1 == cache.getCachedResourceCount());
+    }
+
     // Test changing the size of an exclusively-held resource.
     {
         GrResourceCache cache(2, 300);
@@ -278,6 +307,89 @@ static void test_resource_size_changed(skiatest::Reporter* reporter,
     }
 }
 
+static void test_purge_priority(skiatest::Reporter* reporter, GrContext* context) {
+    GrCacheID::Domain domain = GrCacheID::GenerateDomain();
+    GrResourceKey::ResourceType t = GrResourceKey::GenerateResourceType();
+
+    GrCacheID::Key keyData;
+    keyData.fData64[0] = 0;
+    keyData.fData64[1] = 0;
+    GrResourceKey atlasKey(GrCacheID(domain, keyData), t, 0);
+    keyData.fData64[0] = 1;
+    GrResourceKey contentKey(GrCacheID(domain, keyData), t, 0);
+    keyData.fData64[0] = 2;
+    GrResourceKey scratchKey(GrCacheID(GrResourceKey::ScratchDomain(), keyData), t, 0);
+
+    GrResourceCache cache(3, 300);
+
+    // Add them from the highest priority to the lowest so that LRU alone would get them wrong.
+    TestResource* atlas = new TestResource(100);
+    cache.addResource(atlasKey, atlas);
+    atlas->getCacheEntry()->setPriority(GrResourceCache::kAtlas_Priority);
+    atlas->unref();
+
+    TestResource* content = new TestResource(100);
+    cache.addResource(contentKey, content);
+    REPORTER_ASSERT(reporter, GrResourceCache::kContent_Priority ==
+                              content->getCacheEntry()->priority());
+    content->unref();
+
+    TestResource* scratch = new TestResource(100);
+    cache.addResource(scratchKey, scratch);
+    REPORTER_ASSERT(reporter, GrResourceCache::kScratch_Priority ==
+                              scratch->getCacheEntry()->priority());
+    scratch->unref();
+
+    cache.setLimits(2, 300);
+    REPORTER_ASSERT(reporter, NULL == cache.find(scratchKey));
+    REPORTER_ASSERT(reporter, NULL != cache.find(contentKey));
+    REPORTER_ASSERT(reporter, NULL != cache.find(atlasKey));
+
+    cache.setLimits(1, 300);
+    REPORTER_ASSERT(reporter, NULL == cache.find(contentKey));
+    REPORTER_ASSERT(reporter, NULL != cache.find(atlasKey));
+}
+
+static void test_scratch_reuse(skiatest::Reporter* reporter, GrContext* context) {
+    GrTextureDesc desc;
+    desc.fConfig = kSkia8888_GrPixelConfig;
+    desc.fFlags = kRenderTarget_GrTextureFlagBit | kNoStencil_GrTextureFlagBit;
+    desc.fWidth = 100;
+    desc.fHeight = 70;
+
+    SkCacheCounters before;
+    context->getScratchTextureCounters(&before);
+    int width, height;
+    {
+        GrAutoScratchTexture ast(context, desc);
+        REPORTER_ASSERT(reporter, NULL != ast.texture());
+        width = ast.texture()->width();
+        height = ast.texture()->height();
+        REPORTER_ASSERT(reporter, width >= 100 && width <= 128);
+        REPORTER_ASSERT(reporter, height >= 70 && height <= 128);
+    }
+
+    // A request in the same size class gets the same texture back.
+    desc.fWidth = width - 1;
+    desc.fHeight = height;
+    {
+        GrAutoScratchTexture ast(context, desc);
+        REPORTER_ASSERT(reporter, NULL != ast.texture());
+        REPORTER_ASSERT(reporter, width == ast.texture()->width());
+        REPORTER_ASSERT(reporter, height == ast.texture()->height());
+    }
+
+    SkCacheCounters after;
+    context->getScratchTextureCounters(&after);
+    REPORTER_ASSERT(reporter, after.fHits + after.fMisses == before.fHits + before.fMisses + 2);
+    REPORTER_ASSERT(reporter, after.fHits >= before.fHits + 1);
+
+    // Purging the unlocked scratch counts as a scratch eviction.
+    context->purgeUnlockedResources(0);
+    context->getScratchTextureCounters(&after);
+    REPORTER_ASSERT(reporter, after.fEvictions > before.fEvictions);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 DEF_GPUTEST(ResourceCache, reporter, factory) {
     for (int type = 0; type < GrContextFactory::kLastGLContextType; ++type) {
@@ -304,6 +416,8 @@ DEF_GPUTEST(ResourceCache, reporter, factory) {
         test_purge_invalidated(reporter, context);
         test_cache_delete_on_destruction(reporter, context);
         test_resource_size_changed(reporter, context);
+        test_purge_priority(reporter, context);
+        test_scratch_reuse(reporter, context);
     }
 }
 
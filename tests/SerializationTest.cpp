@@ -422,4 +422,39 @@ DEF_TEST(Serialization, reporter) {
             SkPicture::CreateFromBuffer(reader));
         REPORTER_ASSERT(reporter, NULL != readPict.get());
     }
+
+    // Test truncated flattenables
+    {
+        SkAutoTUnref<SkImageFilter> filter(SkXfermodeImageFilter::Create(NULL, NULL));
+        SkWriteBuffer writer(SkWriteBuffer::kValidation_Flag);
+        writer.writeFlattenable(filter);
+        size_t size = writer.bytesWritten();
+        SkAutoTMalloc<unsigned char> data(size);
+        writer.writeToMemory(static_cast<void*>(data.get()));
+
+        for (size_t length = 0; length <= size; length += 4) {
+            SkValidatingReadBuffer reader(static_cast<void*>(data.get()), length);
+            SkAutoTUnref<SkFlattenable> obj(
+                reader.readFlattenable(SkFlattenable::kSkImageFilter_Type));
+            REPORTER_ASSERT(reporter, (length == size) == (NULL != obj.get()));
+            REPORTER_ASSERT(reporter, (length == size) == reader.isValid());
+        }
+    }
+
+    // Test the factory registry
+    {
+        SkAutoTUnref<SkImageFilter> filter(SkXfermodeImageFilter::Create(NULL, NULL));
+        SkFlattenable::Factory factory = filter->getFactory();
+        const char* name = SkFlattenable::FactoryToName(factory);
+        REPORTER_ASSERT(reporter, NULL != name);
+        if (NULL != name) {
+            // Lookups must not depend on the name's address.
+            SkString copy(name);
+            REPORTER_ASSERT(reporter, factory == SkFlattenable::NameToFactory(copy.c_str()));
+            SkFlattenable::Type type;
+            REPORTER_ASSERT(reporter, SkFlattenable::NameToType(copy.c_str(), &type));
+            REPORTER_ASSERT(reporter, SkFlattenable::kSkImageFilter_Type == type);
+        }
+        REPORTER_ASSERT(reporter, NULL == SkFlattenable::NameToFactory("SkNoSuchFlattenable"));
+    }
 }
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCanvas.h"
+#include "SkColorFilter.h"
+#include "SkColorPriv.h"
+#include "SkShader.h"
+#include "SkXfermode.h"
+#include "Test.h"
+
+static const int W = 16;
+static const int H = 8;
+
+// Premultiplied colors varying across the bitmap, translucent on odd rows unless opaque.
+static void make_source(SkBitmap* bm, SkColorType colorType, bool opaque) {
+    SkBitmap n32;
+    n32.allocN32Pixels(W, H, opaque);
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            const U8CPU a = opaque || 0 == (y & 1) ? 0xFF : 0x11 * x;
+            *n32.getAddr32(x, y) = SkPreMultiplyARGB(a, 0x10 * x, 0x20 * y, 0xC0);
+        }
+    }
+    if (kN32_SkColorType == colorType) {
+        *bm = n32;
+    } else {
+        n32.copyTo(bm, colorType);
+    }
+}
+
+static void make_device(SkBitmap* bm) {
+    bm->allocN32Pixels(W + 4, H + 4);
+    for (int y = 0; y < bm->height(); ++y) {
+        for (int x = 0; x < bm->width(); ++x) {
+            *bm->getAddr32(x, y) = SkPreMultiplyARGB(0x80 + 0x08 * y, 0xFF, 0x0C * x, 0x40);
+        }
+    }
+}
+
+static bool close_enough(SkPMColor a, SkPMColor b) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        const int diff = (int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF);
+        if (SkAbs32(diff) > 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Draws the source as a sprite, which takes the sprite blitters, and as a rect filled with
+// a bitmap shader, which doesn't, and checks that they agree.
+static void check_sprite(skiatest::Reporter* reporter, const SkBitmap& source,
+                         const SkPaint& paint) {
+    SkBitmap sprite, shaded;
+    make_device(&sprite);
+    make_device(&shaded);
+
+    SkCanvas(sprite).drawBitmap(source, 2, 2, &paint);
+
+    SkMatrix matrix;
+    matrix.setTranslate(2, 2);
+    SkShader* shader = SkShader::CreateBitmapShader(source, SkShader::kClamp_TileMode,
+                                                    SkShader::kClamp_TileMode, &matrix);
+    SkPaint shaderPaint(paint);
+    shaderPaint.setShader(shader)->unref();
+    SkCanvas(shaded).drawRect(SkRect::MakeXYWH(2, 2, W, H), shaderPaint);
+
+    for (int y = 0; y < sprite.height(); ++y) {
+        for (int x = 0; x < sprite.width(); ++x) {
+            if (!close_enough(*sprite.getAddr32(x, y), *shaded.getAddr32(x, y))) {
+                SkXfermode::Mode mode;
+                SkXfermode::AsMode(paint.getXfermode(), &mode);
+                ERRORF(reporter, "mode %d alpha %d filter %d: %08x != %08x at (%d, %d)",
+                       mode, paint.getAlpha(),
+                       NULL != paint.getColorFilter(),
+                       *sprite.getAddr32(x, y), *shaded.getAddr32(x, y), x, y);
+                return;
+            }
+        }
+    }
+}
+
+DEF_TEST(SpriteBlitter_XferFilterAlpha, reporter) {
+    const SkColorType colorTypes[] = { kN32_SkColorType, kARGB_4444_SkColorType };
+    const U8CPU alphas[] = { 0xFF, 0x80, 0x01 };
+
+    for (int i = 0; i < 2 * (int)SK_ARRAY_COUNT(colorTypes); ++i) {
+        SkBitmap source;
+        make_source(&source, colorTypes[i / 2], SkToBool(i & 1));
+
+        for (int mode = 0; mode <= SkXfermode::kLastMode; ++mode) {
+            for (size_t a = 0; a < SK_ARRAY_COUNT(alphas); ++a) {
+                for (int filter = 0; filter < 2; ++filter) {
+                    SkPaint paint;
+                    paint.setXfermodeMode((SkXfermode::Mode)mode);
+                    paint.setAlpha(alphas[a]);
+                    if (filter) {
+                        // Changes the alpha, so opaque sources come out translucent.
+                        paint.setColorFilter(SkColorFilter::CreateModeFilter(
+                                0x80FF8000, SkXfermode::kSrcIn_Mode))->unref();
+                    }
+                    check_sprite(reporter, source, paint);
+                }
+            }
+        }
+    }
+}
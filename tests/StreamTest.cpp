@@ -71,6 +71,29 @@ static void test_filestreams(skiatest::Reporter* reporter, const char* tmpDir) {
         SkAutoTUnref<SkStreamAsset> stream2(stream.duplicate());
         test_loop_stream(reporter, stream2.get(), s, 26, 100);
     }
+
+    {
+        // Files are mapped on demand, and the mapping is shared.
+        SkFILEStream stream(path.c_str());
+        const void* base = stream.getMemoryBase();
+        REPORTER_ASSERT(reporter, NULL != base);
+        if (NULL != base) {
+            for (int i = 0; i < 100; ++i) {
+                REPORTER_ASSERT(reporter, !memcmp((const char*)base + 26 * i, s, 26));
+            }
+        }
+        test_loop_stream(reporter, &stream, s, 26, 100);
+
+        SkAutoTUnref<SkStreamAsset> stream2(stream.fork());
+        REPORTER_ASSERT(reporter, base == stream2->getMemoryBase());
+        REPORTER_ASSERT(reporter, stream2->isAtEnd());
+        stream2->rewind();
+        test_loop_stream(reporter, stream2.get(), s, 26, 100);
+
+        SkAutoTUnref<SkStreamAsset> stream3(SkStream::NewFromFile(path.c_str()));
+        REPORTER_ASSERT(reporter, NULL != stream3->getMemoryBase());
+        test_loop_stream(reporter, stream3.get(), s, 26, 100);
+    }
 }
 
 static void TestWStream(skiatest::Reporter* reporter) {
@@ -8,7 +8,9 @@
 #include "SkPaint.h"
 #include "SkPath.h"
 #include "SkRect.h"
+#include "SkRandom.h"
 #include "SkStroke.h"
+#include "SkStrokeCache.h"
 #include "Test.h"
 
 static bool equal(const SkRect& a, const SkRect& b) {
@@ -55,6 +57,65 @@ static void test_strokerect(skiatest::Reporter* reporter) {
     }
 }
 
+static bool equal(const SkPath& a, const SkPath& b) {
+    if (a.getFillType() != b.getFillType() || a.countVerbs() != b.countVerbs() ||
+            a.countPoints() != b.countPoints()) {
+        return false;
+    }
+    for (int i = 0; i < a.countPoints(); ++i) {
+        if (a.getPoint(i) != b.getPoint(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A path stroked repeatedly must come out the same whether or not it was cached.
+static void test_strokecache(skiatest::Reporter* reporter) {
+    SkStrokeCache::Purge();
+
+    SkRandom rand;
+    SkPath path;
+    path.moveTo(0, 0);
+    for (int i = 0; i < 40; ++i) {
+        path.quadTo(rand.nextUScalar1() * 100, rand.nextUScalar1() * 100,
+                    rand.nextUScalar1() * 100, rand.nextUScalar1() * 100);
+    }
+    path.setFillType(SkPath::kInverseWinding_FillType);
+
+    SkStroke stroke;
+    stroke.setWidth(SkIntToScalar(4));
+    stroke.setJoin(SkPaint::kRound_Join);
+
+    SkPath first, second, third;
+    stroke.strokePath(path, &first);
+    // The first sighting only records the key.
+    REPORTER_ASSERT(reporter, SkStrokeCache::GetBytesUsed() < 256);
+    stroke.strokePath(path, &second);
+    size_t bytesUsed = SkStrokeCache::GetBytesUsed();
+    REPORTER_ASSERT(reporter, bytesUsed > (size_t)second.countPoints() * sizeof(SkPoint));
+    stroke.strokePath(path, &third);
+    REPORTER_ASSERT(reporter, bytesUsed == SkStrokeCache::GetBytesUsed());
+    REPORTER_ASSERT(reporter, equal(first, second));
+    REPORTER_ASSERT(reporter, equal(first, third));
+    REPORTER_ASSERT(reporter, first.isInverseFillType());
+
+    // Stroking in place must also work from the cache.
+    SkPath inPlace(path);
+    stroke.strokePath(inPlace, &inPlace);
+    REPORTER_ASSERT(reporter, equal(first, inPlace));
+
+    // A different width is a different entry.
+    stroke.setWidth(SkIntToScalar(5));
+    SkPath wider;
+    stroke.strokePath(path, &wider);
+    REPORTER_ASSERT(reporter, !equal(first, wider));
+
+    SkStrokeCache::Purge();
+    REPORTER_ASSERT(reporter, 0 == SkStrokeCache::GetBytesUsed());
+}
+
 DEF_TEST(Stroke, reporter) {
     test_strokerect(reporter);
+    test_strokecache(reporter);
 }
@@ -8,6 +8,7 @@
 #include "SkCanvas.h"
 #include "SkData.h"
 #include "SkImageEncoder.h"
+#include "SkPictureRecorder.h"
 #include "SkRRect.h"
 #include "SkSurface.h"
 #include "SkUtils.h"
@@ -81,6 +82,36 @@ static void test_image(skiatest::Reporter* reporter) {
     data->unref();
 }
 
+static void release_pixels(const void* pixels, void* context) {
+    *static_cast<int*>(context) += 1;
+}
+
+static void test_image_from_pixels(skiatest::Reporter* reporter) {
+    SkImageInfo info = SkImageInfo::MakeN32Premul(2, 2);
+    SkPMColor pixels[4];
+    sk_memset32(pixels, SkPreMultiplyColor(SK_ColorRED), 4);
+    int released = 0;
+
+    SkImage* image = SkImage::NewFromPixels(info, pixels, info.minRowBytes(),
+                                            release_pixels, &released);
+    REPORTER_ASSERT(reporter, NULL != image);
+    REPORTER_ASSERT(reporter, pixels == image->peekPixels(NULL, NULL));
+
+    // A picture the image was drawn into keeps the pixels alive.
+    SkPictureRecorder recorder;
+    image->draw(recorder.beginRecording(2, 2, NULL, 0), 0, 0, NULL);
+    SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+    image->unref();
+    REPORTER_ASSERT(reporter, 0 == released);
+    picture.reset(NULL);
+    REPORTER_ASSERT(reporter, 1 == released);
+
+    // A failed image releases the pixels right away.
+    image = SkImage::NewFromPixels(info, pixels, 1, release_pixels, &released);
+    REPORTER_ASSERT(reporter, NULL == image);
+    REPORTER_ASSERT(reporter, 2 == released);
+}
+
 static SkImage* createImage(ImageType imageType, GrContext* context,
                             SkColor color) {
     const SkPMColor pmcolor = SkPreMultiplyColor(color);
@@ -286,6 +317,78 @@ static void TestSurfaceCopyOnWrite(skiatest::Reporter* reporter, SurfaceType sur
         testPaint))
 }
 
+static SkPMColor image_pixel(const SkImage* image, int x, int y) {
+    SkImageInfo info;
+    size_t rowBytes;
+    const void* addr = image->peekPixels(&info, &rowBytes);
+    SkASSERT(NULL != addr);
+    return *(const SkPMColor*)((const char*)addr + y * rowBytes + x * sizeof(SkPMColor));
+}
+
+static void TestSurfacePartialCopyOnWrite(skiatest::Reporter* reporter) {
+    // Large enough to span several copy tiles, so that a small draw leaves most of them to be
+    // copied lazily.
+    const int kSize = 200;
+    SkAutoTUnref<SkSurface> surface(SkSurface::NewRasterPMColor(kSize, kSize));
+    SkCanvas* canvas = surface->getCanvas();
+    canvas->clear(SK_ColorRED);
+    SkAutoTUnref<SkImage> before(surface->newImageSnapshot());
+
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(10), SkIntToScalar(10),
+                                      SkIntToScalar(20), SkIntToScalar(20)), paint);
+    SkAutoTUnref<SkImage> after(surface->newImageSnapshot());
+    REPORTER_ASSERT(reporter, before.get() != after.get());
+    REPORTER_ASSERT(reporter, SkPreMultiplyColor(SK_ColorRED) == image_pixel(before, 15, 15));
+    REPORTER_ASSERT(reporter, SkPreMultiplyColor(SK_ColorBLUE) == image_pixel(after, 15, 15));
+    REPORTER_ASSERT(reporter, SkPreMultiplyColor(SK_ColorRED) == image_pixel(after, 150, 150));
+
+    // An opaque fill of the whole surface discards instead of copying.
+    SkAutoTUnref<SkImage> beforeFill(surface->newImageSnapshot());
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawPaint(paint);
+    SkAutoTUnref<SkImage> afterFill(surface->newImageSnapshot());
+    REPORTER_ASSERT(reporter, SkPreMultiplyColor(SK_ColorRED) == image_pixel(beforeFill, 150, 150));
+    REPORTER_ASSERT(reporter, SkPreMultiplyColor(SK_ColorGREEN) == image_pixel(afterFill, 15, 15));
+}
+
+static void TestSurfaceDamage(skiatest::Reporter* reporter) {
+    SkAutoTUnref<SkSurface> surface(SkSurface::NewRasterPMColor(100, 100));
+    SkCanvas* canvas = surface->getCanvas();
+    REPORTER_ASSERT(reporter, !surface->tracksDamage());
+    canvas->clear(SK_ColorWHITE);
+    REPORTER_ASSERT(reporter, surface->damage().isEmpty());
+
+    surface->setTracksDamage(true);
+    SkPaint paint;
+    canvas->drawRect(SkRect::MakeXYWH(10, 10, 5, 20), paint);
+    // Outset by a pixel for antialiasing.
+    REPORTER_ASSERT(reporter, surface->damage().isRect());
+    REPORTER_ASSERT(reporter, SkIRect::MakeLTRB(9, 9, 16, 31) == surface->damage().getBounds());
+
+    canvas->drawRect(SkRect::MakeXYWH(80, 80, 5, 5), paint);
+    REPORTER_ASSERT(reporter, surface->damage().contains(SkIRect::MakeXYWH(10, 10, 5, 20)));
+    REPORTER_ASSERT(reporter, surface->damage().contains(SkIRect::MakeXYWH(80, 80, 5, 5)));
+    REPORTER_ASSERT(reporter, !surface->damage().contains(SkIRect::MakeXYWH(50, 50, 1, 1)));
+
+    // The clip bounds draws that aren't bounded themselves.
+    surface->resetDamage();
+    canvas->save();
+    canvas->clipRect(SkRect::MakeXYWH(20, 30, 10, 10));
+    canvas->drawPaint(paint);
+    canvas->restore();
+    REPORTER_ASSERT(reporter, SkIRect::MakeXYWH(20, 30, 10, 10) == surface->damage().getBounds());
+
+    surface->resetDamage();
+    surface->notifyContentWillChange(SkSurface::kRetain_ContentChangeMode);
+    REPORTER_ASSERT(reporter, SkIRect::MakeWH(100, 100) == surface->damage().getBounds());
+
+    surface->setTracksDamage(false);
+    canvas->drawRect(SkRect::MakeXYWH(10, 10, 5, 20), paint);
+    REPORTER_ASSERT(reporter, surface->damage().isEmpty());
+}
+
 static void TestSurfaceWritableAfterSnapshotRelease(skiatest::Reporter* reporter,
                                                     SurfaceType surfaceType,
                                                     GrContext* context) {
@@ -413,8 +516,11 @@ static void TestSurfaceNoCanvas(skiatest::Reporter* reporter,
 
 DEF_GPUTEST(Surface, reporter, factory) {
     test_image(reporter);
+    test_image_from_pixels(reporter);
 
     TestSurfaceCopyOnWrite(reporter, kRaster_SurfaceType, NULL);
+    TestSurfacePartialCopyOnWrite(reporter);
+    TestSurfaceDamage(reporter);
     TestSurfaceWritableAfterSnapshotRelease(reporter, kRaster_SurfaceType, NULL);
     TestSurfaceNoCanvas(reporter, kRaster_SurfaceType, NULL, SkSurface::kDiscard_ContentChangeMode);
     TestSurfaceNoCanvas(reporter, kRaster_SurfaceType, NULL, SkSurface::kRetain_ContentChangeMode);
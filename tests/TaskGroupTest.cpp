@@ -0,0 +1,97 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTaskGroup.h"
+#include "SkThread.h"
+#include "SkThreadPool.h"
+#include "Test.h"
+
+namespace {
+
+class Increment : public SkRunnable {
+public:
+    explicit Increment(int32_t* counter) : fCounter(counter) {}
+    virtual void run() SK_OVERRIDE { sk_atomic_inc(fCounter); }
+private:
+    int32_t* fCounter;
+};
+
+// Adds more work to the pool from inside a running task, as DM does.
+class Spawner : public SkRunnable {
+public:
+    Spawner(SkThreadPool* pool, Increment* child, int depth)
+        : fPool(pool), fChild(child), fDepth(depth) {}
+    virtual void run() SK_OVERRIDE {
+        fPool->add(fChild);
+        if (fDepth > 0) {
+            fPool->addNext(SkNEW_ARGS(Spawner, (fPool, fChild, fDepth - 1)));
+        }
+        SkDELETE(this);
+    }
+private:
+    SkThreadPool* fPool;
+    Increment*    fChild;
+    int           fDepth;
+};
+
+class Square : public SkParallelForBody {
+public:
+    explicit Square(int* out) : fOut(out) {}
+    virtual void run(int i) SK_OVERRIDE { fOut[i] = i * i; }
+private:
+    int* fOut;
+};
+
+}  // namespace
+
+static const int kThreadCounts[] = { 0, 1, 4, 16 };
+
+DEF_TEST(ThreadPool_AddFromTasks, reporter) {
+    for (size_t t = 0; t < SK_ARRAY_COUNT(kThreadCounts); t++) {
+        int32_t counter = 0;
+        Increment increment(&counter);
+        {
+            SkThreadPool pool(kThreadCounts[t]);
+            for (int i = 0; i < 50; i++) {
+                pool.add(SkNEW_ARGS(Spawner, (&pool, &increment, 9)));
+            }
+            pool.wait();
+        }
+        REPORTER_ASSERT(reporter, 500 == counter);
+    }
+}
+
+DEF_TEST(TaskGroup, reporter) {
+    for (size_t t = 0; t < SK_ARRAY_COUNT(kThreadCounts); t++) {
+        SkThreadPool pool(kThreadCounts[t]);
+        SkTaskGroup group(&pool);
+
+        // Groups can be waited on, and reused, while the pool keeps running.
+        for (int round = 1; round <= 3; round++) {
+            int32_t counter = 0;
+            Increment increment(&counter);
+            for (int i = 0; i < 200 * round; i++) {
+                group.add(&increment);
+            }
+            group.add(NULL);
+            group.wait();
+            REPORTER_ASSERT(reporter, 200 * round == counter);
+        }
+
+        static const int kN = 1000;
+        int squares[kN];
+        sk_bzero(squares, sizeof(squares));
+        Square body(squares);
+        group.parallelFor(0, kN, &body, 7);
+        group.wait();
+        bool allSquared = true;
+        for (int i = 0; i < kN; i++) {
+            allSquared = allSquared && (i * i == squares[i]);
+        }
+        REPORTER_ASSERT(reporter, allSquared);
+    }
+}
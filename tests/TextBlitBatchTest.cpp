@@ -0,0 +1,127 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkBlitMask.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkPath.h"
+#include "SkRandom.h"
+#include "Test.h"
+
+static const int W = 120;
+static const int H = 40;
+
+enum ClipType {
+    kNone_ClipType,
+    kRgn_ClipType,
+    kAA_ClipType,
+};
+
+static void setup(SkCanvas* canvas, ClipType clip) {
+    if (kRgn_ClipType == clip) {
+        canvas->clipRect(SkRect::MakeLTRB(5, 5, 50, 30));
+        canvas->clipRect(SkRect::MakeLTRB(40, 10, 100, 35), SkRegion::kUnion_Op);
+    } else if (kAA_ClipType == clip) {
+        SkPath oval;
+        oval.addOval(SkRect::MakeLTRB(3.5f, 2.5f, 110.5f, 37.5f));
+        canvas->clipPath(oval, SkRegion::kIntersect_Op, true);
+    }
+}
+
+// Each glyph drawn on its own never fills more than one batch, so the run
+// must come out the same as the glyphs drawn one at a time.
+static void test_run_matches_glyphs(skiatest::Reporter* reporter, const SkPaint& paint,
+                                    ClipType clip) {
+    static const char gText[] = "Batched glyphs: ajWgq%@!";
+    const int count = paint.textToGlyphs(gText, sizeof(gText) - 1, NULL);
+    SkAutoTMalloc<uint16_t> glyphs(count);
+    paint.textToGlyphs(gText, sizeof(gText) - 1, glyphs.get());
+    SkAutoTMalloc<SkPoint> pos(count);
+    for (int i = 0; i < count; ++i) {
+        // Overlapping glyphs check that the order is kept.
+        pos[i].set(SkIntToScalar(2 + 4 * i) + 0.3f * i, SkIntToScalar(20 + (i % 5)));
+    }
+
+    SkPaint glyphPaint(paint);
+    glyphPaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+
+    SkBitmap expected, actual;
+    expected.allocN32Pixels(W, H);
+    expected.eraseColor(0xFF80C0E0);
+    actual.allocN32Pixels(W, H);
+    actual.eraseColor(0xFF80C0E0);
+    {
+        SkCanvas canvas(expected);
+        setup(&canvas, clip);
+        for (int i = 0; i < count; ++i) {
+            canvas.drawPosText(&glyphs[i], sizeof(uint16_t), &pos[i], glyphPaint);
+        }
+    }
+    {
+        SkCanvas canvas(actual);
+        setup(&canvas, clip);
+        canvas.drawPosText(glyphs.get(), count * sizeof(uint16_t), pos.get(), glyphPaint);
+    }
+
+    SkAutoLockPixels alpe(expected), alpa(actual);
+    REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                          expected.getSize()));
+}
+
+// The SSE2 black proc must agree with the portable formula.
+static void test_black_a8_proc(skiatest::Reporter* reporter) {
+    SkBlitMask::ColorProc proc = SkBlitMask::ColorFactory(kN32_SkColorType,
+                                                          SkMask::kA8_Format,
+                                                          SK_ColorBLACK);
+    REPORTER_ASSERT(reporter, NULL != proc);
+
+    SkRandom rand;
+    static const int kW = 23, kH = 3;
+    uint8_t mask[kH][kW];
+    SkPMColor dst[kH][kW + 1];
+    SkPMColor expected[kH][kW + 1];
+    for (int width = 1; width <= kW; ++width) {
+        for (int y = 0; y < kH; ++y) {
+            for (int x = 0; x < kW; ++x) {
+                // Plenty of empty and full coverage, as glyphs have.
+                uint32_t r = rand.nextU();
+                mask[y][x] = (r & 3) == 0 ? 0 : (r & 3) == 1 ? 0xFF : r >> 24;
+            }
+            for (int x = 0; x <= kW; ++x) {
+                dst[y][x] = expected[y][x] = SkPreMultiplyColor(rand.nextU());
+            }
+            for (int x = 0; x < width; ++x) {
+                unsigned aa = mask[y][x];
+                expected[y][x + 1] = (aa << SK_A32_SHIFT) +
+                                     SkAlphaMulQ(expected[y][x + 1], SkAlpha255To256(255 - aa));
+            }
+        }
+        // Start one pixel in, so the destination rows are not 16 byte aligned.
+        proc(&dst[0][1], sizeof(dst[0]), &mask[0][0], sizeof(mask[0]), SK_ColorBLACK,
+             width, kH);
+        REPORTER_ASSERT(reporter, 0 == memcmp(dst, expected, sizeof(dst)));
+    }
+}
+
+DEF_TEST(TextBlitBatch, reporter) {
+    static const SkColor gColors[] = { SK_ColorBLACK, 0xFF336699, 0x80993366 };
+    for (size_t c = 0; c < SK_ARRAY_COUNT(gColors); ++c) {
+        for (int lcd = 0; lcd <= 1; ++lcd) {
+            for (int clip = kNone_ClipType; clip <= kAA_ClipType; ++clip) {
+                SkPaint paint;
+                paint.setAntiAlias(true);
+                paint.setLCDRenderText(1 == lcd);
+                paint.setSubpixelText(true);
+                paint.setTextSize(18);
+                paint.setColor(gColors[c]);
+                test_run_matches_glyphs(reporter, paint, (ClipType)clip);
+            }
+        }
+    }
+    test_black_a8_proc(reporter);
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkPicture.h"
+#include "SkPictureRecorder.h"
+#include "SkStream.h"
+#include "SkTextBlob.h"
+#include "Test.h"
+
+static const char gText[] = "Blobs";
+static const int kCount = sizeof(gText) - 1;
+
+static void make_font(SkPaint* font, SkScalar size) {
+    font->setAntiAlias(true);
+    font->setTextSize(size);
+}
+
+static int text_to_glyphs(const SkPaint& font, uint16_t glyphs[]) {
+    return font.textToGlyphs(gText, kCount, glyphs);
+}
+
+// One run of each positioning, with different sizes.
+static const SkTextBlob* make_blob() {
+    SkTextBlobBuilder builder;
+    SkPaint font;
+
+    make_font(&font, 12);
+    const SkTextBlobBuilder::RunBuffer& run = builder.allocRun(font, kCount, 4, 20);
+    text_to_glyphs(font, run.glyphs);
+
+    make_font(&font, 16);
+    const SkTextBlobBuilder::RunBuffer& runH = builder.allocRunPosH(font, kCount, 40);
+    text_to_glyphs(font, runH.glyphs);
+    for (int i = 0; i < kCount; ++i) {
+        runH.pos[i] = SkIntToScalar(4 + 12 * i);
+    }
+
+    make_font(&font, 20);
+    const SkTextBlobBuilder::RunBuffer& runPos = builder.allocRunPos(font, kCount);
+    text_to_glyphs(font, runPos.glyphs);
+    for (int i = 0; i < kCount; ++i) {
+        runPos.pos[2 * i] = SkIntToScalar(4 + 14 * i);
+        runPos.pos[2 * i + 1] = SkIntToScalar(60 + 2 * i);
+    }
+    return builder.build();
+}
+
+// Draws what make_blob() holds, with the equivalent text calls.
+static void draw_expected(SkCanvas* canvas, SkScalar x, SkScalar y, const SkPaint& paint) {
+    SkPaint runPaint(paint);
+    runPaint.setAntiAlias(true);
+    runPaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    uint16_t glyphs[kCount];
+
+    SkPaint font;
+    make_font(&font, 12);
+    text_to_glyphs(font, glyphs);
+    runPaint.setTextSize(12);
+    canvas->drawText(glyphs, sizeof(glyphs), x + 4, y + 20, runPaint);
+
+    make_font(&font, 16);
+    text_to_glyphs(font, glyphs);
+    runPaint.setTextSize(16);
+    SkScalar xpos[kCount];
+    for (int i = 0; i < kCount; ++i) {
+        xpos[i] = x + SkIntToScalar(4 + 12 * i);
+    }
+    canvas->drawPosTextH(glyphs, sizeof(glyphs), xpos, y + 40, runPaint);
+
+    make_font(&font, 20);
+    text_to_glyphs(font, glyphs);
+    runPaint.setTextSize(20);
+    SkPoint pos[kCount];
+    for (int i = 0; i < kCount; ++i) {
+        pos[i].set(x + SkIntToScalar(4 + 14 * i), y + SkIntToScalar(60 + 2 * i));
+    }
+    canvas->drawPosText(glyphs, sizeof(glyphs), pos, runPaint);
+}
+
+static void make_bitmap(SkBitmap* bm) {
+    bm->allocN32Pixels(96, 96);
+    bm->eraseColor(SK_ColorWHITE);
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a), alpb(b);
+    return a.width() == b.width() && a.height() == b.height() &&
+           0 == memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+static bool is_white(const SkBitmap& bm, const SkIRect& r) {
+    SkAutoLockPixels alp(bm);
+    for (int y = r.fTop; y < r.fBottom; ++y) {
+        for (int x = r.fLeft; x < r.fRight; ++x) {
+            if (SK_ColorWHITE != bm.getColor(x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void test_build(skiatest::Reporter* reporter) {
+    SkTextBlobBuilder builder;
+    SkAutoTUnref<const SkTextBlob> empty(builder.build());
+    REPORTER_ASSERT(reporter, NULL != empty.get());
+    REPORTER_ASSERT(reporter, empty->bounds().isEmpty());
+    REPORTER_ASSERT(reporter, SkTextBlob::RunIterator(empty).done());
+
+    SkAutoTUnref<const SkTextBlob> blob(make_blob());
+    SkAutoTUnref<const SkTextBlob> blob2(make_blob());
+    REPORTER_ASSERT(reporter, 0 != blob->uniqueID());
+    REPORTER_ASSERT(reporter, blob->uniqueID() != blob2->uniqueID());
+
+    static const SkTextBlob::GlyphPositioning gPositioning[] = {
+        SkTextBlob::kDefault_Positioning,
+        SkTextBlob::kHorizontal_Positioning,
+        SkTextBlob::kFull_Positioning,
+    };
+    int runs = 0;
+    for (SkTextBlob::RunIterator it(blob); !it.done(); it.next()) {
+        REPORTER_ASSERT(reporter, kCount == it.glyphCount());
+        REPORTER_ASSERT(reporter, gPositioning[runs] == it.positioning());
+        REPORTER_ASSERT(reporter, (NULL == it.pos()) ==
+                                  (SkTextBlob::kDefault_Positioning == it.positioning()));
+
+        SkPaint paint;
+        paint.setTextAlign(SkPaint::kCenter_Align);
+        it.applyFontToPaint(&paint);
+        REPORTER_ASSERT(reporter, SkPaint::kGlyphID_TextEncoding == paint.getTextEncoding());
+        REPORTER_ASSERT(reporter, SkPaint::kLeft_Align == paint.getTextAlign());
+        REPORTER_ASSERT(reporter, SkIntToScalar(12 + 4 * runs) == paint.getTextSize());
+        ++runs;
+    }
+    REPORTER_ASSERT(reporter, 3 == runs);
+
+    // The measured bounds cover every run.
+    const SkRect& bounds = blob->bounds();
+    REPORTER_ASSERT(reporter, bounds.fLeft >= 0 && bounds.fLeft < 8);
+    REPORTER_ASSERT(reporter, bounds.fTop < 20 && bounds.fBottom > 60);
+
+    // Explicit bounds are used instead of measuring.
+    SkPaint font;
+    make_font(&font, 12);
+    const SkRect explicitBounds = SkRect::MakeLTRB(1, 2, 3, 4);
+    const SkTextBlobBuilder::RunBuffer& run = builder.allocRun(font, kCount, 0, 0,
+                                                               &explicitBounds);
+    text_to_glyphs(font, run.glyphs);
+    SkAutoTUnref<const SkTextBlob> bounded(builder.build());
+    REPORTER_ASSERT(reporter, explicitBounds == bounded->bounds());
+}
+
+static void test_draw(skiatest::Reporter* reporter) {
+    SkAutoTUnref<const SkTextBlob> blob(make_blob());
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+
+    SkBitmap expected, actual;
+    make_bitmap(&expected);
+    make_bitmap(&actual);
+    {
+        SkCanvas canvas(expected);
+        draw_expected(&canvas, 3, 5, paint);
+    }
+    {
+        SkCanvas canvas(actual);
+        canvas.drawTextBlob(blob, 3, 5, paint);
+    }
+    REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+
+    // Nothing is drawn outside the bounds.
+    SkIRect inside;
+    blob->bounds().makeOffset(3, 5).roundOut(&inside);
+    REPORTER_ASSERT(reporter, !is_white(actual, inside));
+    REPORTER_ASSERT(reporter, is_white(actual, SkIRect::MakeLTRB(0, 0, 96, inside.fTop)));
+    REPORTER_ASSERT(reporter, is_white(actual, SkIRect::MakeLTRB(0, inside.fBottom, 96, 96)));
+
+    // Drawing a NULL blob is a no-op.
+    make_bitmap(&actual);
+    {
+        SkCanvas canvas(actual);
+        canvas.drawTextBlob(NULL, 0, 0, paint);
+    }
+    REPORTER_ASSERT(reporter, is_white(actual, SkIRect::MakeWH(96, 96)));
+}
+
+static void draw_picture(SkPicture* picture, SkBitmap* bm) {
+    make_bitmap(bm);
+    SkCanvas canvas(*bm);
+    picture->draw(&canvas);
+}
+
+static void test_picture(skiatest::Reporter* reporter) {
+    SkAutoTUnref<const SkTextBlob> blob(make_blob());
+    SkPaint paint;
+    paint.setColor(SK_ColorRED);
+
+    SkBitmap expected;
+    make_bitmap(&expected);
+    {
+        SkCanvas canvas(expected);
+        canvas.drawTextBlob(blob, 2, 4, paint);
+        canvas.drawTextBlob(blob, 2, 4, paint);
+    }
+
+    for (int useRecord = 0; useRecord < 2; ++useRecord) {
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = useRecord ? recorder.EXPERIMENTAL_beginRecording(96, 96)
+                                     : recorder.beginRecording(96, 96);
+        canvas->drawTextBlob(blob, 2, 4, paint);
+        // The same blob twice is recorded once.
+        canvas->drawTextBlob(blob, 2, 4, paint);
+        SkAutoTUnref<SkPicture> picture(recorder.endRecording());
+
+        SkBitmap actual;
+        draw_picture(picture, &actual);
+        REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+
+        SkDynamicMemoryWStream wstream;
+        picture->serialize(&wstream);
+        SkAutoTUnref<SkStreamAsset> rstream(wstream.detachAsStream());
+        SkAutoTUnref<SkPicture> loaded(SkPicture::CreateFromStream(rstream));
+        REPORTER_ASSERT(reporter, NULL != loaded.get());
+        if (NULL != loaded.get()) {
+            draw_picture(loaded, &actual);
+            REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+        }
+
+        SkAutoTUnref<SkPicture> clone(picture->clone());
+        draw_picture(clone, &actual);
+        REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+    }
+}
+
+DEF_TEST(TextBlob, reporter) {
+    test_build(reporter);
+    test_draw(reporter);
+    test_picture(reporter);
+}
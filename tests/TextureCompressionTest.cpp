@@ -8,7 +8,9 @@
 #include "SkBitmap.h"
 #include "SkData.h"
 #include "SkEndian.h"
+#include "SkGraphics.h"
 #include "SkImageInfo.h"
+#include "SkRandom.h"
 #include "SkTextureCompressor.h"
 #include "Test.h"
 
@@ -112,3 +114,108 @@ DEF_TEST(CompressLATC, reporter) {
         }
     }
 }
+
+/**
+ * Make sure that a solid color bitmap compresses to R11 EAC blocks that decode to that color.
+ */
+DEF_TEST(CompressR11EAC, reporter) {
+    SkBitmap bitmap;
+    static const int kWidth = 8;
+    static const int kHeight = 8;
+    SkImageInfo info = SkImageInfo::MakeA8(kWidth, kHeight);
+
+    bool allocPixelsSuccess = bitmap.allocPixels(info);
+    REPORTER_ASSERT(reporter, allocPixelsSuccess);
+
+    // R11 EAC uses the same block dimensions and size as LATC.
+    const int numBlocks = (kWidth / kLATCBlockDimension) * (kHeight / kLATCBlockDimension);
+    const size_t kSizeToBe = static_cast<size_t>(kLATCEncodedBlockSize * numBlocks);
+
+    for (int lum = 0; lum < 256; ++lum) {
+        bitmap.lockPixels();
+        uint8_t* pixels = reinterpret_cast<uint8_t*>(bitmap.getPixels());
+        REPORTER_ASSERT(reporter, NULL != pixels);
+
+        for (int i = 0; i < kWidth*kHeight; ++i) {
+            pixels[i] = lum;
+        }
+        bitmap.unlockPixels();
+
+        const SkTextureCompressor::Format kR11EACFormat = SkTextureCompressor::kR11_EAC_Format;
+        SkAutoDataUnref r11Data(
+            SkTextureCompressor::CompressBitmapToFormat(bitmap, kR11EACFormat));
+        REPORTER_ASSERT(reporter, NULL != r11Data);
+        REPORTER_ASSERT(reporter, kSizeToBe == r11Data->size());
+
+        // A solid block is encoded with the value as the base codeword, a zero multiplier and
+        // every pixel using the zero modifier (index 4 of table 13).
+        uint64_t constColorEncoding = (static_cast<uint64_t>(lum) << 56) |
+                                      (static_cast<uint64_t>(13) << 48);
+        for (int i = 0; i < 16; ++i) {
+            constColorEncoding |= static_cast<uint64_t>(4) << (3*i);
+        }
+        constColorEncoding = SkEndian_SwapBE64(constColorEncoding);
+
+        const uint64_t* blockPtr = reinterpret_cast<const uint64_t*>(r11Data->data());
+        for (int i = 0; i < numBlocks; ++i) {
+            REPORTER_ASSERT(reporter, blockPtr[i] == constColorEncoding);
+        }
+    }
+}
+
+/**
+ * Make sure that compressing a mask in bands of rows, or on several threads, gives the same
+ * blocks as compressing it all at once.
+ */
+DEF_TEST(CompressA8Rows, reporter) {
+    static const int kWidth = 512;
+    static const int kHeight = 260;
+    SkBitmap bitmap;
+    REPORTER_ASSERT(reporter, bitmap.setInfo(SkImageInfo::MakeA8(kWidth, kHeight), kWidth + 12));
+    REPORTER_ASSERT(reporter, bitmap.allocPixels());
+
+    // Noise, ramps and solid blocks.
+    SkRandom rand;
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            uint8_t value;
+            switch ((x / 64 + y / 64) % 3) {
+                case 0:  value = rand.nextU() & 0xFF; break;
+                case 1:  value = (3 * x + 5 * y) & 0xFF; break;
+                default: value = (x / 4 + y / 4) & 1 ? 0xFF : 0; break;
+            }
+            *bitmap.getAddr8(x, y) = value;
+        }
+    }
+    const uint8_t* pixels = static_cast<const uint8_t*>(bitmap.getPixels());
+
+    REPORTER_ASSERT(reporter, 0 == SkTextureCompressor::GetCompressedDataSize(
+            SkTextureCompressor::kLATC_Format, kWidth, kHeight - 2));
+
+    for (int f = 0; f < SkTextureCompressor::kFormatCnt; ++f) {
+        const SkTextureCompressor::Format format = static_cast<SkTextureCompressor::Format>(f);
+        SkAutoDataUnref whole(SkTextureCompressor::CompressBitmapToFormat(bitmap, format));
+        REPORTER_ASSERT(reporter, NULL != whole);
+        const size_t size = SkTextureCompressor::GetCompressedDataSize(format, kWidth, kHeight);
+        REPORTER_ASSERT(reporter, size == whole->size());
+
+        // Bands of 4, 8, ... rows, as a mask might be produced.
+        SkAutoMalloc banded(size);
+        uint8_t* dst = static_cast<uint8_t*>(banded.get());
+        for (int y = 0, band = 4; y < kHeight; y += band, band += 4) {
+            const int rows = SkTMin(band, kHeight - y);
+            REPORTER_ASSERT(reporter, SkTextureCompressor::CompressA8Rows(
+                    format, dst, pixels + y * bitmap.rowBytes(), kWidth, rows,
+                    bitmap.rowBytes()));
+            dst += SkTextureCompressor::GetCompressedDataSize(format, kWidth, rows);
+        }
+        REPORTER_ASSERT(reporter, 0 == memcmp(banded.get(), whole->data(), size));
+
+        const int oldThreadCount = SkGraphics::SetTextureCompressionThreadCount(4);
+        SkAutoDataUnref threaded(SkTextureCompressor::CompressBitmapToFormat(bitmap, format));
+        SkGraphics::SetTextureCompressionThreadCount(oldThreadCount);
+        REPORTER_ASSERT(reporter, NULL != threaded);
+        REPORTER_ASSERT(reporter, size == threaded->size());
+        REPORTER_ASSERT(reporter, 0 == memcmp(threaded->data(), whole->data(), size));
+    }
+}
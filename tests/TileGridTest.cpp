@@ -38,7 +38,7 @@ static void verifyTileHits(skiatest::Reporter* reporter, SkIRect rect,
     info.fMargin.set(borderPixels, borderPixels);
     info.fOffset.setZero();
     info.fTileInterval.set(10 - 2 * borderPixels, 10 - 2 * borderPixels);
-    SkTileGrid grid(2, 2, info, NULL);
+    SkTileGrid grid(2, 2, info);
     grid.insert(NULL, rect, false);
     REPORTER_ASSERT(reporter, grid.tileCount(0, 0) ==
                     ((tileMask & kTopLeft_Tile)? 1 : 0));
@@ -250,3 +250,77 @@ DEF_TEST(TileGrid, reporter) {
     verifyTileHits(reporter, SkIRect::MakeXYWH(5, 5, 10, 10),  kAll_Tile);
     verifyTileHits(reporter, SkIRect::MakeXYWH(-10, -10, 40, 40),  kAll_Tile);
 }
+
+DEF_TEST(TileGrid_Remove, reporter) {
+    SkTileGridFactory::TileGridInfo info;
+    info.fMargin.setEmpty();
+    info.fOffset.setZero();
+    info.fTileInterval.set(10, 10);
+    SkTileGrid grid(2, 2, info);
+
+    int a, b, c;
+    const SkIRect spanning = SkIRect::MakeXYWH(5, 5, 10, 1);
+    grid.insert(&a, spanning, false);
+    grid.insert(&b, SkIRect::MakeXYWH(0, 0, 5, 5), false);
+    grid.insert(&c, spanning, false);
+    REPORTER_ASSERT(reporter, 3 == grid.getCount());
+
+    // Not there, or not with those bounds.
+    REPORTER_ASSERT(reporter, !grid.remove(&b, SkIRect::MakeXYWH(15, 15, 1, 1)));
+    REPORTER_ASSERT(reporter, !grid.remove(NULL, spanning));
+    REPORTER_ASSERT(reporter, 3 == grid.getCount());
+
+    // Removed from every tile it touched, leaving the rest in order.
+    REPORTER_ASSERT(reporter, grid.remove(&a, spanning));
+    REPORTER_ASSERT(reporter, 2 == grid.getCount());
+    REPORTER_ASSERT(reporter, 2 == grid.tileCount(0, 0));
+    REPORTER_ASSERT(reporter, 1 == grid.tileCount(1, 0));
+
+    SkTDArray<void*> results;
+    grid.search(SkIRect::MakeXYWH(0, 0, 10, 10), &results);
+    REPORTER_ASSERT(reporter, 2 == results.count() && &b == results[0] && &c == results[1]);
+    grid.search(SkIRect::MakeXYWH(10, 0, 10, 10), &results);
+    REPORTER_ASSERT(reporter, 1 == results.count() && &c == results[0]);
+}
+
+DEF_TEST(TileGrid_MergeOrder, reporter) {
+    SkTileGridFactory::TileGridInfo info;
+    info.fMargin.setEmpty();
+    info.fOffset.setZero();
+    info.fTileInterval.set(10, 10);
+    SkTileGrid grid(4, 4, info);
+
+    // Inserted out of order across the tiles, one of them spanning all of them.
+    int data[6];
+    grid.insert(&data[0], SkIRect::MakeXYWH(22, 22, 5, 5), false);
+    grid.insert(&data[1], SkIRect::MakeXYWH(2, 2, 5, 5), false);
+    grid.insert(&data[2], SkIRect::MakeXYWH(0, 0, 40, 40), false);
+    grid.insert(&data[3], SkIRect::MakeXYWH(12, 2, 5, 5), false);
+    grid.insert(&data[4], SkIRect::MakeXYWH(2, 12, 5, 5), false);
+    grid.insert(&data[5], SkIRect::MakeXYWH(12, 12, 5, 5), false);
+
+    // Two tiles, four tiles and nine tiles all come back in insertion order, once each.
+    SkTDArray<void*> results;
+    grid.search(SkIRect::MakeXYWH(0, 0, 20, 10), &results);
+    REPORTER_ASSERT(reporter, 3 == results.count() && &data[1] == results[0] &&
+                              &data[2] == results[1] && &data[3] == results[2]);
+    grid.search(SkIRect::MakeXYWH(0, 0, 20, 20), &results);
+    REPORTER_ASSERT(reporter, 5 == results.count() && &data[1] == results[0] &&
+                              &data[2] == results[1] && &data[3] == results[2] &&
+                              &data[4] == results[3] && &data[5] == results[4]);
+    grid.search(SkIRect::MakeXYWH(0, 0, 30, 30), &results);
+    REPORTER_ASSERT(reporter, 6 == results.count());
+    for (int i = 0; i < results.count(); ++i) {
+        REPORTER_ASSERT(reporter, &data[i] == results[i]);
+    }
+
+    // Removing and inserting between searches is picked up.
+    REPORTER_ASSERT(reporter, grid.remove(&data[2], SkIRect::MakeXYWH(0, 0, 40, 40)));
+    grid.insert(&data[2], SkIRect::MakeXYWH(32, 32, 5, 5), false);
+    grid.search(SkIRect::MakeXYWH(0, 0, 20, 10), &results);
+    REPORTER_ASSERT(reporter, 2 == results.count() && &data[1] == results[0] &&
+                              &data[3] == results[1]);
+    grid.search(SkIRect::MakeXYWH(30, 30, 10, 10), &results);
+    REPORTER_ASSERT(reporter, 1 == results.count() && &data[2] == results[0]);
+    REPORTER_ASSERT(reporter, 6 == grid.getCount());
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkPictureRecorder.h"
+#include "SkThread.h"
+#include "SkThreadPool.h"
+#include "SkTileScheduler.h"
+#include "Test.h"
+
+namespace {
+
+// Remembers the tiles in the order they arrive.
+class RecordingClient : public SkTileScheduler::Client {
+public:
+    RecordingClient() : fColorsMatch(true) {}
+
+    virtual void tileReady(const SkIRect& tile, SkScalar scale,
+                           const SkBitmap& bitmap) SK_OVERRIDE {
+        SkAutoMutexAcquire lock(fMutex);
+        Ready* ready = fReady.append();
+        ready->fTile = tile;
+        ready->fLowRes = scale < SK_Scalar1;
+        // The picture is blue on the left half and red on the right.
+        const SkColor expected = tile.fLeft < kSize / 2 ? SK_ColorBLUE : SK_ColorRED;
+        fColorsMatch = fColorsMatch && expected == bitmap.getColor(0, 0);
+    }
+
+    struct Ready {
+        SkIRect fTile;
+        bool    fLowRes;
+    };
+
+    SkMutex           fMutex;
+    SkTDArray<Ready>  fReady;
+    bool              fColorsMatch;
+
+    static const int kSize = 100;
+};
+
+}  // namespace
+
+static SkPicture* make_picture() {
+    const int size = RecordingClient::kSize;
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(size, size, NULL, 0);
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRect(SkRect::MakeWH(SkIntToScalar(size / 2), SkIntToScalar(size)), paint);
+    paint.setColor(SK_ColorRED);
+    canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(size / 2), 0,
+                                      SkIntToScalar(size / 2), SkIntToScalar(size)), paint);
+    return recorder.endRecording();
+}
+
+DEF_TEST(TileScheduler_Priority, reporter) {
+    SkAutoTUnref<SkPicture> picture(make_picture());
+    SkThreadPool pool(0);  // Draws each tile as soon as it is queued, in queue order.
+    RecordingClient client;
+    SkTileScheduler scheduler(&pool, &client, SkISize::Make(10, 10));
+    scheduler.setPicture(picture);
+    REPORTER_ASSERT(reporter, client.fReady.isEmpty());
+
+    // Scrolling right: the visible tile first (with a placeholder), then the tile to its right.
+    scheduler.setViewport(SkIRect::MakeXYWH(40, 40, 10, 10), SkVector::Make(100, 0));
+    REPORTER_ASSERT(reporter, client.fReady.count() > 3);
+    REPORTER_ASSERT(reporter, client.fReady[0].fLowRes);
+    REPORTER_ASSERT(reporter, SkIRect::MakeXYWH(40, 40, 10, 10) == client.fReady[0].fTile);
+    int visible = -1, right = -1, left = -1;
+    for (int i = 0; i < client.fReady.count(); ++i) {
+        if (client.fReady[i].fLowRes) {
+            continue;
+        }
+        const SkIRect& tile = client.fReady[i].fTile;
+        if (SkIRect::MakeXYWH(40, 40, 10, 10) == tile) {
+            visible = i;
+        } else if (SkIRect::MakeXYWH(50, 40, 10, 10) == tile) {
+            right = i;
+        } else if (SkIRect::MakeXYWH(30, 40, 10, 10) == tile) {
+            left = i;
+        }
+    }
+    REPORTER_ASSERT(reporter, visible >= 0 && right > visible && left > right);
+    REPORTER_ASSERT(reporter, client.fColorsMatch);
+
+    // Finished tiles aren't drawn again until they are invalidated.
+    const int count = client.fReady.count();
+    scheduler.setViewport(SkIRect::MakeXYWH(40, 40, 10, 10), SkVector::Make(0, 0));
+    REPORTER_ASSERT(reporter, count == client.fReady.count());
+    scheduler.invalidate(SkIRect::MakeXYWH(45, 45, 1, 1));
+    REPORTER_ASSERT(reporter, count + 2 == client.fReady.count());
+    REPORTER_ASSERT(reporter, SkIRect::MakeXYWH(40, 40, 10, 10) == client.fReady.top().fTile);
+}
+
+DEF_TEST(TileScheduler_Threads, reporter) {
+    SkAutoTUnref<SkPicture> picture(make_picture());
+    SkThreadPool pool(4);
+    RecordingClient client;
+    SkTileScheduler scheduler(&pool, &client, SkISize::Make(16, 16));
+    scheduler.setLowResScale(0);
+    scheduler.setPicture(picture);
+    scheduler.setViewport(SkIRect::MakeWH(RecordingClient::kSize, RecordingClient::kSize),
+                          SkVector::Make(0, 0));
+    scheduler.wait();
+    // 7 x 7 tiles, each drawn once.
+    REPORTER_ASSERT(reporter, 49 == client.fReady.count());
+    REPORTER_ASSERT(reporter, client.fColorsMatch);
+}
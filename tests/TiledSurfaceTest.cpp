@@ -0,0 +1,158 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Test.h"
+
+#include "SkCanvas.h"
+#include "SkImage.h"
+#include "SkImageInfo.h"
+#include "SkPath.h"
+#include "SkSurface.h"
+
+static const int kW = 100;
+static const int kH = 70;
+
+// Draws something that crosses tile boundaries, leaving a save() outstanding.
+// (Curves are avoided: they are clipped to each tile before being scan converted, which may
+// change their antialiasing slightly from one tiling to the next.)
+static void draw_first_half(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    canvas->clear(SK_ColorWHITE);
+
+    canvas->save();
+    canvas->translate(7, 5);
+    canvas->clipRect(SkRect::MakeWH(80, 50));
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRect(SkRect::MakeLTRB(2.5f, 3.25f, 70.75f, 44.5f), paint);
+}
+
+// Finishes the drawing, relying on the state set up by draw_first_half().
+static void draw_second_half(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(0x80FF0000);
+    SkPath path;
+    path.moveTo(0, 0);
+    path.lineTo(90, 60);
+    path.lineTo(10, 60);
+    path.close();
+    canvas->drawPath(path, paint);
+    canvas->restore();
+
+    SkMatrix matrix;
+    matrix.setRotate(15);
+    canvas->setMatrix(matrix);
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawRect(SkRect::MakeXYWH(30, 10, 40, 20), paint);
+}
+
+static bool images_match(SkImage* a, SkImage* b) {
+    SkBitmap bmA, bmB;
+    bmA.allocN32Pixels(kW, kH);
+    bmB.allocN32Pixels(kW, kH);
+    bmA.eraseColor(SK_ColorTRANSPARENT);
+    bmB.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvasA(bmA), canvasB(bmB);
+    SkPaint src;
+    src.setXfermodeMode(SkXfermode::kSrc_Mode);
+    a->draw(&canvasA, 0, 0, &src);
+    b->draw(&canvasB, 0, 0, &src);
+
+    SkAutoLockPixels alpA(bmA), alpB(bmB);
+    for (int y = 0; y < kH; y++) {
+        if (0 != memcmp(bmA.getAddr32(0, y), bmB.getAddr32(0, y), kW * sizeof(SkPMColor))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DEF_TEST(TiledSurface_MatchesRaster, reporter) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+    SkAutoTUnref<SkSurface> raster(SkSurface::NewRaster(info));
+    draw_first_half(raster->getCanvas());
+    draw_second_half(raster->getCanvas());
+    SkAutoTUnref<SkImage> expected(raster->newImageSnapshot());
+
+    // Odd tile sizes so the last row and column of tiles are partial.
+    const int kThreadCounts[] = { 0, 1, 3 };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kThreadCounts); i++) {
+        SkAutoTUnref<SkSurface> tiled(SkSurface::NewRasterTiled(info, 17, 23, kThreadCounts[i]));
+        REPORTER_ASSERT(reporter, NULL != tiled.get());
+
+        draw_first_half(tiled->getCanvas());
+        // Force a flush in the middle of the drawing, with a save() outstanding.
+        SkAutoTUnref<SkImage> partial(tiled->newImageSnapshot());
+        draw_second_half(tiled->getCanvas());
+
+        SkAutoTUnref<SkImage> actual(tiled->newImageSnapshot());
+        REPORTER_ASSERT(reporter, images_match(expected, actual));
+        // The first snapshot must not see the draws made after it was taken.
+        REPORTER_ASSERT(reporter, !images_match(partial, actual));
+        REPORTER_ASSERT(reporter, partial->uniqueID() != actual->uniqueID());
+
+        SkImageInfo peekInfo;
+        size_t rowBytes;
+        REPORTER_ASSERT(reporter, NULL != tiled->peekPixels(&peekInfo, &rowBytes));
+        REPORTER_ASSERT(reporter, peekInfo == info);
+    }
+}
+
+// Scatters small shapes, each touching only a tile or two, inside a clip that the second batch
+// restores away before drawing some more.
+static void draw_scattered(SkCanvas* canvas, bool firstBatch) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    if (firstBatch) {
+        canvas->clear(SK_ColorWHITE);
+        canvas->save();
+        SkPath clip;
+        clip.addRect(SkRect::MakeLTRB(10, 10, 60, 50));
+        canvas->clipPath(clip);
+    } else {
+        canvas->restore();
+    }
+
+    SkPath triangle;
+    triangle.moveTo(0, 0);
+    triangle.lineTo(6, 0);
+    triangle.lineTo(0, 6);
+    triangle.close();
+    for (int y = 0; y < kH; y += 9) {
+        for (int x = firstBatch ? 0 : 4; x < kW; x += 11) {
+            paint.setColor(SkColorSetARGB(0xFF, x * 2, y * 3, 0x80));
+            canvas->drawRect(SkRect::MakeXYWH(SkIntToScalar(x), SkIntToScalar(y), 5, 4), paint);
+            canvas->save();
+            canvas->translate(SkIntToScalar(x), SkIntToScalar(y + 4));
+            canvas->drawPath(triangle, paint);
+            canvas->restore();
+        }
+    }
+}
+
+DEF_TEST(TiledSurface_CullsPerTile, reporter) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+    SkAutoTUnref<SkSurface> raster(SkSurface::NewRaster(info));
+    draw_scattered(raster->getCanvas(), true);
+    draw_scattered(raster->getCanvas(), false);
+    SkAutoTUnref<SkImage> expected(raster->newImageSnapshot());
+
+    SkAutoTUnref<SkSurface> tiled(SkSurface::NewRasterTiled(info, 16, 16, 4));
+    draw_scattered(tiled->getCanvas(), true);
+    // Flush, so the second batch is culled in the state the first left behind.
+    SkAutoTUnref<SkImage> partial(tiled->newImageSnapshot());
+    draw_scattered(tiled->getCanvas(), false);
+    SkAutoTUnref<SkImage> actual(tiled->newImageSnapshot());
+    REPORTER_ASSERT(reporter, images_match(expected, actual));
+}
+
+DEF_TEST(TiledSurface_Invalid, reporter) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+    REPORTER_ASSERT(reporter, NULL == SkSurface::NewRasterTiled(info, 0, 16));
+    REPORTER_ASSERT(reporter, NULL == SkSurface::NewRasterTiled(info, 16, -1));
+}
@@ -5,9 +5,73 @@
  * found in the LICENSE file.
  */
 
+#include "../src/fonts/SkGScalerContext.h"
+#include "SkData.h"
+#include "SkFontDataCache.h"
+#include "SkOSFile.h"
+#include "SkStream.h"
 #include "SkTypeface.h"
+#include "SkTypefaceCache.h"
 #include "Test.h"
 
+// Each call makes a typeface with a new fontID.
+static SkTypeface* new_typeface() {
+    SkAutoTUnref<SkTypeface> proxy(SkTypeface::RefDefault());
+    return SkNEW_ARGS(SkGTypeface, (proxy, SkPaint()));
+}
+
+static bool find_all_proc(SkTypeface*, SkTypeface::Style, void*) {
+    return true;
+}
+
+DEF_TEST(TypefaceCache, reporter) {
+    SkTypefaceCache cache;
+    SkAutoTUnref<SkTypeface> face(new_typeface());
+    SkAutoTUnref<SkTypeface> other(new_typeface());
+
+    cache.add(face, SkTypeface::kBold);
+    cache.addName(face, "Family", SkTypeface::kBold);
+    cache.addName(face, "Alias", SkTypeface::kNormal);
+    REPORTER_ASSERT(reporter, face.get() == cache.findByID(face->uniqueID()));
+    REPORTER_ASSERT(reporter, NULL == cache.findByID(other->uniqueID()));
+
+    SkAutoTUnref<SkTypeface> found(cache.findByNameAndRef("Family", SkTypeface::kBold));
+    REPORTER_ASSERT(reporter, face.get() == found.get());
+    found.reset(cache.findByNameAndRef("Alias", SkTypeface::kNormal));
+    REPORTER_ASSERT(reporter, face.get() == found.get());
+    found.reset(cache.findByNameAndRef("Family", SkTypeface::kNormal));
+    REPORTER_ASSERT(reporter, NULL == found.get());
+    found.reset(cache.findByNameAndRef("Famil", SkTypeface::kBold));
+    REPORTER_ASSERT(reporter, NULL == found.get());
+
+    // A name already taken keeps its first typeface.
+    cache.add(other, SkTypeface::kNormal);
+    cache.addName(other, "Alias", SkTypeface::kNormal);
+    found.reset(cache.findByNameAndRef("Alias", SkTypeface::kNormal));
+    REPORTER_ASSERT(reporter, face.get() == found.get());
+
+    // Adding the same typeface again does not duplicate it.
+    cache.add(face, SkTypeface::kBold);
+    found.reset(cache.findByProcAndRef(find_all_proc, NULL));
+    REPORTER_ASSERT(reporter, face.get() == found.get());
+    found.reset(NULL);
+
+    // Purging drops typefaces only the cache refers to, along with their names.
+    other.reset(NULL);
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, face.get() == cache.findByID(face->uniqueID()));
+    found.reset(cache.findByNameAndRef("Family", SkTypeface::kBold));
+    REPORTER_ASSERT(reporter, face.get() == found.get());
+    found.reset(NULL);
+
+    const SkFontID faceID = face->uniqueID();
+    face.reset(NULL);
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, NULL == cache.findByID(faceID));
+    found.reset(cache.findByNameAndRef("Family", SkTypeface::kBold));
+    REPORTER_ASSERT(reporter, NULL == found.get());
+}
+
 DEF_TEST(Typeface, reporter) {
 
     SkAutoTUnref<SkTypeface> t1(SkTypeface::CreateFromName(NULL, SkTypeface::kNormal));
@@ -24,3 +88,89 @@ DEF_TEST(Typeface, reporter) {
     REPORTER_ASSERT(reporter, NULL == t3.get());
 #endif
 }
+
+// Serializes face and deserializes it again.
+static SkTypeface* round_trip(SkTypeface* face) {
+    SkDynamicMemoryWStream wstream;
+    face->serialize(&wstream);
+    SkAutoTUnref<SkStreamAsset> stream(wstream.detachAsStream());
+    return SkTypeface::Deserialize(stream);
+}
+
+DEF_TEST(FontDataCache, reporter) {
+    // The leading '_' is only there to test unaligned data.
+    static const char kPadded[] = "_Not the data of any font, but a few words of text.";
+    const char* bytes = kPadded + 1;
+    const size_t size = sizeof(kPadded) - 1;
+    SkAutoDataUnref data(SkData::NewWithCopy(bytes, size));
+    SkAutoDataUnref copy(SkData::NewWithCopy(bytes, size));
+    SkAutoDataUnref shorter(SkData::NewWithCopy(bytes, size - 1));
+    const SkFontDataCache::ID id = SkFontDataCache::ComputeID(data);
+    REPORTER_ASSERT(reporter, id == SkFontDataCache::ComputeID(copy));
+    REPORTER_ASSERT(reporter, !(id == SkFontDataCache::ComputeID(shorter)));
+
+    // The same bytes at an unaligned address.
+    SkAutoDataUnref padded(SkData::NewWithCopy(kPadded, sizeof(kPadded)));
+    SkAutoDataUnref unaligned(SkData::NewSubset(padded, 1, size));
+    REPORTER_ASSERT(reporter, id == SkFontDataCache::ComputeID(unaligned));
+
+    // No typeface can be made from this data, so nothing is cached.
+    SkAutoTUnref<SkTypeface> face(SkFontDataCache::FindOrCreate(data));
+    REPORTER_ASSERT(reporter, NULL == face.get());
+    face.reset(SkFontDataCache::Find(id));
+    REPORTER_ASSERT(reporter, NULL == face.get());
+
+    SkString resourcePath = skiatest::Test::GetResourcePath();
+    if (resourcePath.isEmpty()) {
+        SkDebugf("Could not run FontDataCache test because resourcePath not specified.");
+        return;
+    }
+    SkString filename = SkOSPath::SkPathJoin(resourcePath.c_str(), "Funkster.ttf");
+    SkAutoDataUnref fontData(SkData::NewFromFileName(filename.c_str()));
+    if (NULL == fontData.get()) {
+        SkDebugf("Could not run FontDataCache test because Funkster.ttf not found.");
+        return;
+    }
+    face.reset(SkFontDataCache::FindOrCreate(fontData));
+    if (NULL == face.get()) {
+        SkDebugf("Could not run FontDataCache test because no font host reads Funkster.ttf.");
+        return;
+    }
+
+    // Every copy of the font data shares one typeface.
+    SkAutoDataUnref fontCopy(SkData::NewWithCopy(fontData->data(), fontData->size()));
+    SkAutoTUnref<SkTypeface> found(SkFontDataCache::FindOrCreate(fontCopy));
+    REPORTER_ASSERT(reporter, face.get() == found.get());
+    found.reset(SkFontDataCache::Find(SkFontDataCache::ComputeID(fontData)));
+    REPORTER_ASSERT(reporter, face.get() == found.get());
+
+    SkAutoTUnref<SkTypeface> deserialized(round_trip(face));
+    if (NULL != deserialized.get() && deserialized.get() != face.get()) {
+        // Typefaces that don't serialize their data are deserialized by name instead.
+        SkDebugf("Skipping FontDataCache deserialization: the font host doesn't send font data.");
+    } else {
+        REPORTER_ASSERT(reporter, face.get() == deserialized.get());
+        found.reset(round_trip(deserialized));
+        REPORTER_ASSERT(reporter, face.get() == found.get());
+    }
+    found.reset(NULL);
+    deserialized.reset(NULL);
+
+    // A byte limit smaller than the font leaves it out of the cache, unless it is pinned.
+    const size_t prevLimit = SkFontDataCache::SetByteLimit(fontData->size() / 2);
+    REPORTER_ASSERT(reporter, 0 == SkFontDataCache::GetBytesUsed());
+    found.reset(SkFontDataCache::Find(SkFontDataCache::ComputeID(fontData)));
+    REPORTER_ASSERT(reporter, NULL == found.get());
+
+    found.reset(SkFontDataCache::FindOrCreate(fontData, true));
+    REPORTER_ASSERT(reporter, NULL != found.get());
+    REPORTER_ASSERT(reporter, 0 == SkFontDataCache::GetBytesUsed());
+    SkFontDataCache::SetByteLimit(0);
+    SkAutoTUnref<SkTypeface> pinned(SkFontDataCache::Find(SkFontDataCache::ComputeID(fontData)));
+    REPORTER_ASSERT(reporter, found.get() == pinned.get());
+
+    SkFontDataCache::Purge();
+    pinned.reset(SkFontDataCache::Find(SkFontDataCache::ComputeID(fontData)));
+    REPORTER_ASSERT(reporter, NULL == pinned.get());
+    SkFontDataCache::SetByteLimit(prevLimit);
+}
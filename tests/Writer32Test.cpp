@@ -312,3 +312,48 @@ DEF_TEST(Writer32_snapshot_dynamic, reporter) {
     // test it triggered COW anyway
     REPORTER_ASSERT(reporter, writer.contiguousArray() != beforeData);
 }
+
+// Writes records of varying size, so that they run over several segments, and reads and
+// overwrites them in place.
+DEF_TEST(Writer32_segments, reporter) {
+    SkSWriter32<64> writer;
+    SkTDArray<size_t> offsets;
+    SkRandom rand;
+    for (int i = 0; i < 5000; ++i) {
+        *offsets.append() = writer.bytesWritten();
+        writer.write32(i);
+        const size_t padding = 4 * rand.nextULessThan(64);
+        sk_bzero(writer.reserve(padding), padding);
+    }
+    for (int i = 0; i < offsets.count(); ++i) {
+        REPORTER_ASSERT(reporter, i == writer.readTAt<int32_t>(offsets[i]));
+        writer.overwriteTAt(offsets[i], -i);
+    }
+
+    // Rewinding to an earlier segment frees the ones after it.
+    const int kKeep = 3000;
+    writer.rewindToOffset(offsets[kKeep]);
+    REPORTER_ASSERT(reporter, offsets[kKeep] == writer.bytesWritten());
+    writer.write32(12345);
+
+    const size_t size = writer.bytesWritten();
+    SkAutoMalloc flat(size);
+    writer.flatten(flat.get());
+    SkDynamicMemoryWStream stream;
+    REPORTER_ASSERT(reporter, writer.writeToStream(&stream));
+    SkAutoDataUnref streamed(stream.copyToData());
+    REPORTER_ASSERT(reporter, streamed->size() == size);
+    REPORTER_ASSERT(reporter, !memcmp(streamed->data(), flat.get(), size));
+
+    const char* contiguous = (const char*)writer.contiguousArray();
+    REPORTER_ASSERT(reporter, !memcmp(contiguous, flat.get(), size));
+    for (int i = 0; i < kKeep; ++i) {
+        REPORTER_ASSERT(reporter, -i == *(const int32_t*)(contiguous + offsets[i]));
+        REPORTER_ASSERT(reporter, -i == writer.readTAt<int32_t>(offsets[i]));
+    }
+    REPORTER_ASSERT(reporter, 12345 == writer.readTAt<int32_t>(offsets[kKeep]));
+
+    SkAutoDataUnref snapshot(writer.snapshotAsData());
+    REPORTER_ASSERT(reporter, snapshot->size() == size);
+    REPORTER_ASSERT(reporter, !memcmp(snapshot->data(), flat.get(), size));
+}
@@ -6,6 +6,8 @@
  */
 
 #include "SkColor.h"
+#include "SkColorPriv.h"
+#include "SkRandom.h"
 #include "SkXfermode.h"
 #include "Test.h"
 
@@ -51,7 +53,74 @@ static void test_IsMode(skiatest::Reporter* reporter) {
     }
 }
 
+static SkPMColor random_pmcolor(SkRandom* rand) {
+    U8CPU a = rand->nextU() & 0xFF;
+    return SkPackARGB32(a, rand->nextRangeU(0, a), rand->nextRangeU(0, a),
+                        rand->nextRangeU(0, a));
+}
+
+// The xfer32 and xferA8 of each mode must blend as its proc does, one pixel at a time, with
+// and without coverage. Starting at each of the first 9 pixels covers every alignment and
+// every number of pixels left over by loops that take 4 or 8 at a time.
+static void test_xfer(skiatest::Reporter* reporter) {
+    static const int kCount = 67;
+    SkRandom rand;
+    SkPMColor src[kCount], dst[kCount], expected[kCount], actual[kCount];
+    SkAlpha aa[kCount], dstA[kCount], expectedA[kCount], actualA[kCount];
+    for (int i = 0; i < kCount; ++i) {
+        src[i] = random_pmcolor(&rand);
+        dst[i] = random_pmcolor(&rand);
+        dstA[i] = SkGetPackedA32(dst[i]);
+        // Plenty of no and full coverage.
+        uint32_t r = rand.nextU();
+        aa[i] = (r & 3) == 0 ? 0 : ((r & 3) == 1 ? 0xFF : (r >> 8) & 0xFF);
+    }
+
+    for (int mode = 0; mode <= SkXfermode::kLastMode; mode++) {
+        // These have classes of their own, which apply coverage differently.
+        if (SkXfermode::kClear_Mode == mode || SkXfermode::kSrc_Mode == mode) {
+            continue;
+        }
+        SkXfermode* xfer = SkXfermode::Create((SkXfermode::Mode) mode);
+        if (NULL == xfer) {
+            continue;
+        }
+        SkXfermodeProc proc = SkXfermode::GetProc((SkXfermode::Mode) mode);
+
+        for (int useAA = 0; useAA < 2; ++useAA) {
+            const SkAlpha* coverage = useAA ? aa : NULL;
+            for (int i = 0; i < kCount; ++i) {
+                unsigned a = coverage ? coverage[i] : 0xFF;
+                SkPMColor C = proc(src[i], dst[i]);
+                expected[i] = 0 == a ? dst[i] : SkFourByteInterp(C, dst[i], a);
+                unsigned A = SkGetPackedA32(proc(src[i], dstA[i] << SK_A32_SHIFT));
+                expectedA[i] = 0 == a ? dstA[i]
+                                      : SkToU8(SkAlphaBlend(A, dstA[i], SkAlpha255To256(a)));
+            }
+
+            for (int start = 0; start <= 8; ++start) {
+                const int count = kCount - start;
+                const SkAlpha* startAA = coverage ? coverage + start : NULL;
+
+                memcpy(actual, dst, sizeof(dst));
+                xfer->xfer32(actual + start, src + start, count, startAA);
+                REPORTER_ASSERT(reporter, 0 == memcmp(actual, dst, start * sizeof(SkPMColor)));
+                REPORTER_ASSERT(reporter, 0 == memcmp(actual + start, expected + start,
+                                                      count * sizeof(SkPMColor)));
+
+                memcpy(actualA, dstA, sizeof(dstA));
+                xfer->xferA8(actualA + start, src + start, count, startAA);
+                REPORTER_ASSERT(reporter, 0 == memcmp(actualA, dstA, start));
+                REPORTER_ASSERT(reporter, 0 == memcmp(actualA + start, expectedA + start,
+                                                      count));
+            }
+        }
+        xfer->unref();
+    }
+}
+
 DEF_TEST(Xfermode, reporter) {
     test_asMode(reporter);
     test_IsMode(reporter);
+    test_xfer(reporter);
 }
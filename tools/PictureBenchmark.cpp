@@ -22,6 +22,7 @@ PictureBenchmark::PictureBenchmark()
 , fTimeIndividualTiles(false)
 , fPurgeDecodedTex(false)
 , fPreprocess(false)
+, fPerfCounters(false)
 , fWriter(NULL)
 {}
 
@@ -51,6 +52,25 @@ BenchTimer* PictureBenchmark::setupTimer(bool useGLTimer) {
     return SkNEW_ARGS(BenchTimer, (NULL));
 }
 
+// Adds the counts of the timer's last session to the totals. A total stays negative once an
+// event was not counted.
+static void accumulate_counts(double totals[], const BenchTimer& timer) {
+    for (int i = 0; i < BenchPerfCounters::kEventCount; ++i) {
+        if (totals[i] >= 0) {
+            totals[i] = timer.fPerfCounts[i] < 0 ? -1 : totals[i] + timer.fPerfCounts[i];
+        }
+    }
+}
+
+void PictureBenchmark::writeCounters(const double totals[], int iterations) {
+    for (int i = 0; i < BenchPerfCounters::kEventCount; ++i) {
+        if (totals[i] >= 0) {
+            fWriter->tileCounter(BenchPerfCounters::Name(static_cast<BenchPerfCounters::Event>(i)),
+                                 totals[i] / iterations);
+        }
+    }
+}
+
 PictureRenderer* PictureBenchmark::setRenderer(sk_tools::PictureRenderer* renderer) {
     SkRefCnt_SafeAssign(fRenderer, renderer);
     return renderer;
@@ -149,6 +169,10 @@ void PictureBenchmark::run(SkPicture* pict) {
             // long running timer.
             SkAutoTDelete<BenchTimer> longRunningTimer(this->setupTimer());
             TimerData longRunningTimerData(numOuterLoops);
+            double counts[BenchPerfCounters::kEventCount] = { 0 };
+            if (fPerfCounters) {
+                longRunningTimer->enablePerfCounters();
+            }
 
             for (int outer = 0; outer < numOuterLoops; ++outer) {
                 SkAutoTDelete<BenchTimer> perTileTimer(this->setupTimer(false));
@@ -171,6 +195,7 @@ void PictureBenchmark::run(SkPicture* pict) {
                 tiledRenderer->resetState(true);       // flush, swapBuffers and Finish
                 longRunningTimer->end();
                 SkAssertResult(longRunningTimerData.appendTimes(longRunningTimer.get()));
+                accumulate_counts(counts, *longRunningTimer);
             }
 
             fWriter->tileConfig(tiledRenderer->getConfigName());
@@ -199,10 +224,15 @@ void PictureBenchmark::run(SkPicture* pict) {
                 TimerData::kAvg_Result,
                 timerTypes,
                 numInnerLoops);
+            this->writeCounters(counts, numOuterLoops * numInnerLoops);
         }
     } else {
         SkAutoTDelete<BenchTimer> longRunningTimer(this->setupTimer());
         TimerData longRunningTimerData(numOuterLoops);
+        double counts[BenchPerfCounters::kEventCount] = { 0 };
+        if (fPerfCounters) {
+            longRunningTimer->enablePerfCounters();
+        }
 
         for (int outer = 0; outer < numOuterLoops; ++outer) {
             SkAutoTDelete<BenchTimer> perRunTimer(this->setupTimer(false));
@@ -234,6 +264,7 @@ void PictureBenchmark::run(SkPicture* pict) {
             fRenderer->resetState(true);        // flush, swapBuffers and Finish
             longRunningTimer->end();
             SkAssertResult(longRunningTimerData.appendTimes(longRunningTimer.get()));
+            accumulate_counts(counts, *longRunningTimer);
         }
 
         fWriter->tileConfig(fRenderer->getConfigName());
@@ -257,6 +288,7 @@ void PictureBenchmark::run(SkPicture* pict) {
                 timerTypes,
                 numInnerLoops);
 #endif
+        this->writeCounters(counts, numOuterLoops * numInnerLoops);
     }
 
     fRenderer->end();
@@ -50,6 +50,13 @@ public:
     void setPreprocess(bool preprocess) { fPreprocess = preprocess; }
     bool preprocess() const { return fPreprocess; }
 
+    /**
+     * If true, also report how many cycles, instructions, cache misses and so on each draw
+     * takes, where the OS lets us count them.
+     */
+    void setPerfCounters(bool perfCounters) { fPerfCounters = perfCounters; }
+    bool perfCounters() const { return fPerfCounters; }
+
     PictureRenderer* setRenderer(PictureRenderer*);
 
     void setTimerResultType(TimerData::Result resultType) { fTimerResult = resultType; }
@@ -66,10 +73,12 @@ private:
     bool              fTimeIndividualTiles;
     bool              fPurgeDecodedTex;
     bool              fPreprocess;
+    bool              fPerfCounters;
 
     PictureResultsWriter* fWriter;
 
     BenchTimer* setupTimer(bool useGLTimer = true);
+    void writeCounters(const double totals[], int iterations);
 };
 
 }
@@ -30,6 +30,7 @@
 #include "SkScalar.h"
 #include "SkStream.h"
 #include "SkString.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkTDArray.h"
 #include "SkThreadUtils.h"
@@ -703,8 +704,8 @@ class CloneData : public SkRunnable {
 
 public:
     CloneData(SkPicture* clone, SkCanvas* canvas, SkTDArray<SkRect>& rects, int start, int end,
-              SkRunnable* done, ImageResultsAndExpectations* jsonSummaryPtr,
-              bool useChecksumBasedFilenames, bool enableWrites)
+              ImageResultsAndExpectations* jsonSummaryPtr, bool useChecksumBasedFilenames,
+              bool enableWrites)
         : fClone(clone)
         , fCanvas(canvas)
         , fEnableWrites(enableWrites)
@@ -712,10 +713,8 @@ public:
         , fStart(start)
         , fEnd(end)
         , fSuccess(NULL)
-        , fDone(done)
         , fJsonSummaryPtr(jsonSummaryPtr)
         , fUseChecksumBasedFilenames(useChecksumBasedFilenames) {
-        SkASSERT(fDone != NULL);
     }
 
     virtual void run() SK_OVERRIDE {
@@ -750,7 +749,6 @@ public:
                 }
             }
         }
-        fDone->run();
     }
 
     void setPathsAndSuccess(const SkString& writePath, const SkString& mismatchPath,
@@ -780,7 +778,6 @@ private:
     const int          fEnd;
     bool*              fSuccess;    // Only meaningful if path is non-null. Shared by all threads,
                                     // and only set to false upon failure to write to a PNG.
-    SkRunnable*        fDone;
     SkBitmap*          fBitmap;
     ImageResultsAndExpectations* fJsonSummaryPtr;
     bool               fUseChecksumBasedFilenames;
@@ -788,8 +785,7 @@ private:
 
 MultiCorePictureRenderer::MultiCorePictureRenderer(int threadCount)
 : fNumThreads(threadCount)
-, fThreadPool(threadCount)
-, fCountdown(threadCount) {
+, fThreadPool(threadCount) {
     // Only need to create fNumThreads - 1 clones, since one thread will use the base
     // picture.
     fPictureClones = SkNEW_ARRAY(SkPicture, fNumThreads - 1);
@@ -821,7 +817,7 @@ void MultiCorePictureRenderer::init(SkPicture *pict, const SkString* writePath,
         const int start = i * chunkSize;
         const int end = SkMin32(start + chunkSize, fTileRects.count());
         fCloneData[i] = SkNEW_ARGS(CloneData,
-                                   (pic, fCanvasPool[i], fTileRects, start, end, &fCountdown,
+                                   (pic, fCanvasPool[i], fTileRects, start, end,
                                     fJsonSummaryPtr, useChecksumBasedFilenames, fEnableWrites));
     }
 }
@@ -846,11 +842,11 @@ bool MultiCorePictureRenderer::render(SkBitmap** out) {
         }
     }
 
-    fCountdown.reset(fNumThreads);
+    SkTaskGroup group(&fThreadPool);
     for (int i = 0; i < fNumThreads; i++) {
-        fThreadPool.add(fCloneData[i]);
+        group.add(fCloneData[i]);
     }
-    fCountdown.wait();
+    group.wait();
 
     return success;
 }
@@ -913,6 +909,8 @@ SkBBHFactory* PictureRenderer::getFactory() {
             return SkNEW(SkRTreeFactory);
         case kTileGrid_BBoxHierarchyType:
             return SkNEW_ARGS(SkTileGridFactory, (fGridInfo));
+        case kAdaptive_BBoxHierarchyType:
+            return SkNEW_ARGS(SkAdaptiveBBHFactory, (fGridInfo.fTileInterval));
     }
     SkASSERT(0); // invalid bbhType
     return NULL;
@@ -9,7 +9,6 @@
 #define PictureRenderer_DEFINED
 
 #include "SkCanvas.h"
-#include "SkCountdown.h"
 #include "SkDrawFilter.h"
 #include "SkMath.h"
 #include "SkPaint.h"
@@ -61,8 +60,9 @@ public:
         kQuadTree_BBoxHierarchyType,
         kRTree_BBoxHierarchyType,
         kTileGrid_BBoxHierarchyType,
+        kAdaptive_BBoxHierarchyType,
 
-        kLast_BBoxHierarchyType = kTileGrid_BBoxHierarchyType,
+        kLast_BBoxHierarchyType = kAdaptive_BBoxHierarchyType,
     };
 
     // this uses SkPaint::Flags as a base and adds additional flags
@@ -264,6 +264,8 @@ public:
             config.appendS32(fGridInfo.fTileInterval.width());
             config.append("x");
             config.appendS32(fGridInfo.fTileInterval.height());
+        } else if (kAdaptive_BBoxHierarchyType == fBBoxHierarchyType) {
+            config.append("_adaptive");
         }
 #if SK_SUPPORT_GPU
         switch (fDeviceType) {
@@ -391,7 +393,8 @@ protected:
     SkString               fWritePath;
     SkString               fMismatchPath;
     SkString               fInputFilename;
-    SkTileGridFactory::TileGridInfo fGridInfo; // used when fBBoxHierarchyType is TileGrid
+    SkTileGridFactory::TileGridInfo fGridInfo; // used when fBBoxHierarchyType is TileGrid or
+                                               // Adaptive
 
     void buildBBoxHierarchy();
 
@@ -626,7 +629,6 @@ private:
     SkThreadPool         fThreadPool;
     SkPicture*           fPictureClones;
     CloneData**          fCloneData;
-    SkCountdown          fCountdown;
 
     typedef TiledPictureRenderer INHERITED;
 };
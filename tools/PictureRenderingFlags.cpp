@@ -18,11 +18,12 @@
 
 // Alphabetized list of flags used by this file or bench_ and render_pictures.
 DEFINE_string(bbh, "none", "bbhType [width height]: Set the bounding box hierarchy type to "
-              "be used. Accepted values are: none, rtree, quadtree, grid. "
-              "Not compatible with --pipe. With value "
+              "be used. Accepted values are: none, rtree, quadtree, grid, "
+              "adaptive. Not compatible with --pipe. With value "
               "'grid', width and height must be specified. 'grid' can "
               "only be used with modes tile, record, and "
-              "playbackCreation.");
+              "playbackCreation. With value 'adaptive', width and height "
+              "give the expected tile size, 256x256 by default.");
 
 
 #if SK_SUPPORT_GPU
@@ -361,6 +362,13 @@ sk_tools::PictureRenderer* parseRenderer(SkString& error, PictureTool tool) {
             int gridHeight = atoi(FLAGS_bbh[2]);
             renderer->setGridSize(gridWidth, gridHeight);
 
+        } else if (0 == strcmp(type, "adaptive")) {
+            bbhType = sk_tools::PictureRenderer::kAdaptive_BBoxHierarchyType;
+            if (FLAGS_bbh.count() == 3) {
+                renderer->setGridSize(atoi(FLAGS_bbh[1]), atoi(FLAGS_bbh[2]));
+            } else {
+                renderer->setGridSize(256, 256);
+            }
         } else {
             error.printf("%s is not a valid value for --bbhType\n", type);
             return NULL;
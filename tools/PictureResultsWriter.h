@@ -36,6 +36,8 @@ public:
             const TimerData::Result result,
             uint32_t timerTypes,
             int numInnerLoops = 1) = 0;
+    // How many times a hardware event happened per draw of the current tile or picture.
+    virtual void tileCounter(const char name[], double perIteration) {}
    virtual void end() = 0;
 };
 
@@ -83,6 +85,11 @@ public:
                                  numInnerLoops);
         }
     }
+    virtual void tileCounter(const char name[], double perIteration) {
+        for(int i=0; i<fWriters.count(); ++i) {
+            fWriters[i]->tileCounter(name, perIteration);
+        }
+    }
    virtual void end() {
         for(int i=0; i<fWriters.count(); ++i) {
             fWriters[i]->end();
@@ -134,6 +141,11 @@ public:
         results.append("\n");
         this->logProgress(results.c_str());
     }
+    virtual void tileCounter(const char name[], double perIteration) {
+        SkString result;
+        result.printf("%s: %s = %.1f per iteration\n", currentLine.c_str(), name, perIteration);
+        this->logProgress(result.c_str());
+    }
     virtual void end() {}
 private:
     SkBenchLogger* fLogger;
@@ -161,6 +173,9 @@ private:
  *                              data: {
  *                                  wsecs: [....] //Actual data ends up here
  *                              }
+ *                              counters: {
+ *                                  cycles: 1.2e6 // Per iteration, with --perfCounters
+ *                              }
  *                          }
  *                      ]
  *                  }
@@ -215,6 +230,10 @@ public:
         SkASSERT(fCurrentTile != NULL);
         (*fCurrentTile)["data"] = data->getJSON(timerTypes, result, numInnerLoops);
     }
+    virtual void tileCounter(const char name[], double perIteration) {
+        SkASSERT(fCurrentTile != NULL);
+        (*fCurrentTile)["counters"][name] = perIteration;
+    }
     virtual void end() {
        SkFILEWStream stream(fFilename.c_str());
        stream.writeText(Json::FastWriter().write(fRoot).c_str());
@@ -0,0 +1,329 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+// Benches whole frames: each SKP is recorded, optimized, indexed with a BBH and drawn as tiles,
+// and each of those stages is timed on every sample.  bench_record and bench_playback time the
+// stages one at a time; this reports what a frame costs from start to finish.
+
+#include "SkBBHFactory.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkCommandLineFlags.h"
+#include "SkForceLinking.h"
+#include "SkGraphics.h"
+#include "SkOSFile.h"
+#include "SkPicture.h"
+#include "SkRecord.h"
+#include "SkRecordDraw.h"
+#include "SkRecordOpts.h"
+#include "SkRecorder.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkTSort.h"
+#include "SkThreadPool.h"
+
+#if SK_SUPPORT_GPU
+#include "GrContextFactory.h"
+#include "SkSurface.h"
+#include "gl/SkGLContextHelper.h"
+#endif
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+#include <sys/resource.h>
+#endif
+
+#include "BenchTimer.h"
+#include "LazyDecodeBitmap.h"
+
+typedef WallTimer Timer;
+
+__SK_FORCE_IMAGE_DECODER_LINKING;
+
+DEFINE_string2(skps, r, "skps", "Directory containing SKPs to bench.");
+DEFINE_int32(samples, 20, "Number of frames to time for each SKP.");
+DEFINE_string(match, "", "The usual filters on file names of SKPs to bench.");
+DEFINE_string(config, "8888", "Where to draw the frame, 8888 (tiled, on --threads threads) or gpu.");
+DEFINE_string(bbh, "rtree", "BBH to build over the record, rtree or tilegrid.");
+DEFINE_int32(tile, 256, "Size of the tiles drawn by the 8888 config, and of the tile grid.");
+DEFINE_int32(threads, SkThreadPool::kThreadPerCore,
+             "Threads drawing tiles in the 8888 config.  -1 means one per core, 0 draws inline.");
+DEFINE_string(timescale, "ms", "Print times in ms, us, or ns");
+DEFINE_int32(verbose, 0, "0: print percentiles of each stage; "
+                         "1: also print all samples");
+
+static double timescale() {
+    if (FLAGS_timescale.contains("us")) return 1000;
+    if (FLAGS_timescale.contains("ns")) return 1000000;
+    return 1;
+}
+
+static SkBBHFactory* parse_FLAGS_bbh() {
+    if (FLAGS_bbh.contains("rtree")) {
+        return SkNEW(SkRTreeFactory);
+    }
+    if (FLAGS_bbh.contains("tilegrid")) {
+        SkTileGridFactory::TileGridInfo info;
+        info.fTileInterval.set(FLAGS_tile, FLAGS_tile);
+        info.fMargin.setEmpty();
+        info.fOffset.setZero();
+        return SkNEW_ARGS(SkTileGridFactory, (info));
+    }
+    SkDebugf("Invalid bbh type %s, must be one of rtree, tilegrid.\n", FLAGS_bbh[0]);
+    return NULL;
+}
+
+// Peak resident set size of the process so far, in KB, or 0 if we can't tell.
+static long peak_rss_kb() {
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+    struct rusage usage;
+    if (0 != getrusage(RUSAGE_SELF, &usage)) {
+        return 0;
+    }
+#if defined(SK_BUILD_FOR_MAC)
+    return usage.ru_maxrss / 1024;  // Bytes on Mac.
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+enum Stage {
+    kRecord_Stage,
+    kOptimize_Stage,
+    kBBH_Stage,
+    kDraw_Stage,
+    kFrame_Stage,  // The sum of the others.
+
+    kStageCount
+};
+
+static const char* gStageNames[kStageCount] = { "record", "optimize", "bbh", "draw", "frame" };
+
+// Draws one tile of a record into a bitmap owned by the pool thread running it.
+class TileRunnable : public SkTRunnable<SkBitmap> {
+public:
+    TileRunnable(const SkRecord& record, const SkRecordBBH& bbh, const SkIRect& tile)
+        : fRecord(record), fBBH(bbh), fTile(tile) {}
+
+    virtual void run(SkBitmap& bitmap) SK_OVERRIDE {
+        if (bitmap.width() != FLAGS_tile || bitmap.height() != FLAGS_tile) {
+            bitmap.allocN32Pixels(FLAGS_tile, FLAGS_tile);
+        }
+        SkCanvas canvas(bitmap);
+        canvas.clear(SK_ColorTRANSPARENT);
+        canvas.clipRect(SkRect::MakeWH(SkIntToScalar(fTile.width()),
+                                       SkIntToScalar(fTile.height())));
+        canvas.translate(-SkIntToScalar(fTile.fLeft), -SkIntToScalar(fTile.fTop));
+        SkRecordDraw(fRecord, &canvas, &fBBH);
+    }
+
+private:
+    const SkRecord& fRecord;
+    const SkRecordBBH& fBBH;
+    const SkIRect fTile;
+};
+
+static void make_tiles(const SkRecord& record, const SkRecordBBH& bbh, int width, int height,
+                       SkTArray<TileRunnable>* tiles) {
+    tiles->reset();
+    for (int y = 0; y < height; y += FLAGS_tile) {
+        for (int x = 0; x < width; x += FLAGS_tile) {
+            SkIRect tile = SkIRect::MakeXYWH(x, y, FLAGS_tile, FLAGS_tile);
+            SkAssertResult(tile.intersect(SkIRect::MakeWH(width, height)));
+            tiles->push_back(TileRunnable(record, bbh, tile));
+        }
+    }
+}
+
+// Draws the tiles on the pool's threads.  Pools can't be reused once wait() returns.
+static void draw_tiles(SkTArray<TileRunnable>* tiles, SkTThreadPool<SkBitmap>* pool) {
+    for (int i = 0; i < tiles->count(); i++) {
+        pool->add(&(*tiles)[i]);
+    }
+    pool->wait();
+}
+
+// Draws the whole record into the GPU surface and waits for the GPU to finish.
+#if SK_SUPPORT_GPU
+static void draw_gpu(const SkRecord& record, const SkRecordBBH& bbh, SkSurface* surface,
+                     GrContext* context, SkGLContextHelper* glContext) {
+    SkCanvas* canvas = surface->getCanvas();
+    canvas->clear(SK_ColorTRANSPARENT);
+    SkRecordDraw(record, canvas, &bbh);
+    context->flush();
+    SK_GL(*glContext, Finish());
+}
+#endif
+
+// The sample at nearest rank p (in percent) among count sorted samples.
+static double percentile(const double sorted[], int count, int p) {
+    int rank = (p * count + 99) / 100;
+    return sorted[SkTMax(rank, 1) - 1];
+}
+
+static void print_stats(SkTDArray<double> samples[kStageCount], const char* name) {
+    for (int s = 0; s < kStageCount; s++) {
+        SkTDArray<double>& stage = samples[s];
+        if (FLAGS_verbose == 1) {
+            printf("%s\t%s", name, gStageNames[s]);
+            for (int i = 0; i < stage.count(); i++) {
+                printf("\t%g", stage[i]);
+            }
+            printf("\n");
+        }
+        SkTQSort(stage.begin(), stage.end() - 1);
+        printf("%g\t%g\t%g\t%s\t%s\n",
+               percentile(stage.begin(), stage.count(), 50),
+               percentile(stage.begin(), stage.count(), 90),
+               percentile(stage.begin(), stage.count(), 99),
+               gStageNames[s], name);
+    }
+    printf("%ld\tpeak RSS (KB) so far\t%s\n", peak_rss_kb(), name);
+}
+
+static bool bench_frame(const SkPicture& src, const SkBBHFactory& factory, const char* name) {
+    const int width = src.width(), height = src.height();
+    const bool gpu = FLAGS_config.contains("gpu");
+
+#if SK_SUPPORT_GPU
+    static GrContextFactory gContextFactory;
+    const GrContextFactory::GLContextType type = GrContextFactory::kNative_GLContextType;
+    GrContext* context = NULL;
+    SkGLContextHelper* glContext = NULL;
+    SkAutoTUnref<SkSurface> surface;
+    if (gpu) {
+        context = gContextFactory.get(type);
+        glContext = gContextFactory.getGLContext(type);
+        if (NULL != context) {
+            surface.reset(SkSurface::NewRenderTarget(context,
+                                                     SkImageInfo::MakeN32Premul(width, height)));
+        }
+        if (NULL == surface.get()) {
+            SkDebugf("Could not make a %dx%d GPU surface for %s.\n", width, height, name);
+            return false;
+        }
+    }
+#else
+    if (gpu) {
+        SkDebugf("This build does not support the gpu config.\n");
+        return false;
+    }
+#endif
+
+    SkTDArray<double> samples[kStageCount];
+    SkTArray<TileRunnable> tiles;
+    Timer timer;
+    // Sample 0 warms up caches (fonts, decoded images, the GPU's resources) and is dropped.
+    for (int i = 0; i <= FLAGS_samples; i++) {
+        double times[kStageCount];
+
+        SkRecord record;
+        timer.start(timescale());
+        {
+            SkRecorder recorder(&record, width, height);
+            src.draw(&recorder);
+        }
+        timer.end();
+        times[kRecord_Stage] = timer.fWall;
+
+        timer.start(timescale());
+        SkRecordOptimize(&record);
+        timer.end();
+        times[kOptimize_Stage] = timer.fWall;
+
+        timer.start(timescale());
+        SkAutoTUnref<SkBBoxHierarchy> tree(factory(width, height));
+        SkRecordBBH bbh(record, width, height, tree);
+        timer.end();
+        times[kBBH_Stage] = timer.fWall;
+
+        // Each frame gets a fresh pool, started before the timer so that its threads are
+        // already waiting for work.
+        if (!gpu) {
+            make_tiles(record, bbh, width, height, &tiles);
+        }
+        SkTThreadPool<SkBitmap> pool(gpu ? 0 : FLAGS_threads);
+        timer.start(timescale());
+#if SK_SUPPORT_GPU
+        if (gpu) {
+            draw_gpu(record, bbh, surface, context, glContext);
+        } else
+#endif
+        {
+            draw_tiles(&tiles, &pool);
+        }
+        timer.end();
+        times[kDraw_Stage] = timer.fWall;
+
+        times[kFrame_Stage] = 0;
+        for (int s = 0; s < kFrame_Stage; s++) {
+            times[kFrame_Stage] += times[s];
+        }
+        if (i > 0) {
+            for (int s = 0; s < kStageCount; s++) {
+                *samples[s].append() = times[s];
+            }
+        }
+    }
+
+    print_stats(samples, name);
+    return true;
+}
+
+int tool_main(int argc, char** argv);
+int tool_main(int argc, char** argv) {
+    SkCommandLineFlags::Parse(argc, argv);
+    SkAutoGraphics autoGraphics;
+
+    if (FLAGS_samples < 1 || FLAGS_tile < 1) {
+        SkDebugf("--samples and --tile must be positive.\n");
+        return 1;
+    }
+    SkAutoTDelete<SkBBHFactory> factory(parse_FLAGS_bbh());
+    if (NULL == factory.get()) {
+        return 1;
+    }
+
+    printf("p50\tp90\tp99\tstage\tskp\t(times in %s)\n", FLAGS_timescale[0]);
+
+    SkOSFile::Iter it(FLAGS_skps[0], ".skp");
+    SkString filename;
+    bool failed = false;
+    while (it.next(&filename)) {
+        if (SkCommandLineFlags::ShouldSkip(FLAGS_match, filename.c_str())) {
+            continue;
+        }
+
+        const SkString path = SkOSPath::SkPathJoin(FLAGS_skps[0], filename.c_str());
+
+        SkAutoTUnref<SkStream> stream(SkStream::NewFromFile(path.c_str()));
+        if (!stream) {
+            SkDebugf("Could not read %s.\n", path.c_str());
+            failed = true;
+            continue;
+        }
+        SkAutoTUnref<SkPicture> src(
+            SkPicture::CreateFromStream(stream, sk_tools::LazyDecodeBitmap));
+        if (!src) {
+            SkDebugf("Could not read %s as an SkPicture.\n", path.c_str());
+            failed = true;
+            continue;
+        }
+        if (!bench_frame(*src, *factory, filename.c_str())) {
+            failed = true;
+        }
+    }
+    return failed ? 1 : 0;
+}
+
+#if !defined SK_BUILD_FOR_IOS
+int main(int argc, char * const argv[]) {
+    return tool_main(argc, (char**) argv);
+}
+#endif
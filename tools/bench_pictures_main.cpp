@@ -57,6 +57,8 @@ DEFINE_bool(trackDeferredCaching, false, "Only meaningful with --deferImageDecod
             "deferred image decoding.");
 
 DEFINE_bool(preprocess, false, "If true, perform device specific preprocessing before timing.");
+DEFINE_bool(perfCounters, false, "Also report hardware event counts per draw, such as cycles and "
+            "cache misses (Linux only).");
 
 static char const * const gFilterTypes[] = {
     "paint",
@@ -347,6 +349,7 @@ static void setup_benchmark(sk_tools::PictureBenchmark* benchmark) {
 
     benchmark->setPurgeDecodedTex(FLAGS_purgeDecodedTex);
     benchmark->setPreprocess(FLAGS_preprocess);
+    benchmark->setPerfCounters(FLAGS_perfCounters);
 
     if (FLAGS_readPath.count() < 1) {
         gLogger.logError(".skp files or directories are required.\n");
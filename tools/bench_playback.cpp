@@ -5,13 +5,13 @@
  * found in the LICENSE file.
  */
 
+#include "SkCanvas.h"
 #include "SkCommandLineFlags.h"
 #include "SkForceLinking.h"
 #include "SkGraphics.h"
 #include "SkOSFile.h"
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
-#include "SkRecording.h"
 #include "SkStream.h"
 #include "SkString.h"
 
@@ -24,11 +24,10 @@ __SK_FORCE_IMAGE_DECODER_LINKING;
 
 DEFINE_string2(skps, r, "skps", "Directory containing SKPs to playback.");
 DEFINE_int32(samples, 10, "Gather this many samples of each picture playback.");
-DEFINE_bool(skr, false, "Play via SkRecord instead of SkPicture.");
 DEFINE_int32(tile, 1000000000, "Simulated tile size.");
 DEFINE_string(match, "", "The usual filters on file names of SKPs to bench.");
 DEFINE_string(timescale, "ms", "Print times in ms, us, or ns");
-DEFINE_int32(verbose, 0, "0: print min sample; "
+DEFINE_int32(verbose, 0, "0: print min sample of each backend and their ratio; "
                          "1: print min, mean, max and noise indication "
                          "2: print all samples");
 
@@ -38,44 +37,35 @@ static double timescale() {
     return 1;
 }
 
-static SkPicture* rerecord_with_tilegrid(SkPicture& src) {
+static SkTileGridFactory::TileGridInfo tile_grid_info() {
     SkTileGridFactory::TileGridInfo info;
     info.fTileInterval.set(FLAGS_tile, FLAGS_tile);
     info.fMargin.setEmpty();
     info.fOffset.setZero();
-    SkTileGridFactory factory(info);
+    return info;
+}
+
+static SkPicture* rerecord_with_tilegrid(SkPicture& src) {
+    SkTileGridFactory factory(tile_grid_info());
 
     SkPictureRecorder recorder;
     src.draw(recorder.beginRecording(src.width(), src.height(), &factory));
     return recorder.endRecording();
 }
 
-static EXPERIMENTAL::SkPlayback* rerecord_with_skr(SkPicture& src) {
-    EXPERIMENTAL::SkRecording recording(src.width(), src.height());
-    src.draw(recording.canvas());
-    return recording.releasePlayback();
-}
+static SkPicture* rerecord_with_skr(SkPicture& src) {
+    SkTileGridFactory factory(tile_grid_info());
 
-static void draw(const EXPERIMENTAL::SkPlayback& skr, const SkPicture& skp, SkCanvas* canvas) {
-    if (FLAGS_skr) {
-        skr.draw(canvas);
-    } else {
-        skp.draw(canvas);
-    }
+    SkPictureRecorder recorder;
+    src.draw(recorder.EXPERIMENTAL_beginRecording(src.width(), src.height(), &factory));
+    return recorder.endRecording();
 }
 
-static void bench(SkPMColor* scratch, SkPicture& src, const char* name) {
-    SkAutoTUnref<SkPicture> picture(rerecord_with_tilegrid(src));
-    SkAutoTDelete<EXPERIMENTAL::SkPlayback> record(rerecord_with_skr(src));
-
-    SkAutoTDelete<SkCanvas> canvas(SkCanvas::NewRasterDirectN32(src.width(),
-                                                                src.height(),
-                                                                scratch,
-                                                                src.width() * sizeof(SkPMColor)));
-    canvas->clipRect(SkRect::MakeWH(SkIntToScalar(FLAGS_tile), SkIntToScalar(FLAGS_tile)));
-
+// Returns the minimum sample, printing the rest as asked by --verbose.
+static double bench(SkCanvas* canvas, const SkPicture& picture, const char* backend,
+                    const char* name) {
     // Draw once to warm any caches.  The first sample otherwise can be very noisy.
-    draw(*record, *picture, canvas.get());
+    picture.draw(canvas);
 
     Timer timer;
     SkAutoTMalloc<double> samples(FLAGS_samples);
@@ -83,25 +73,45 @@ static void bench(SkPMColor* scratch, SkPicture& src, const char* name) {
         // We assume timer overhead (typically, ~30ns) is insignificant
         // compared to draw runtime (at least ~100us, usually several ms).
         timer.start(timescale());
-        draw(*record, *picture, canvas.get());
+        picture.draw(canvas);
         timer.end();
         samples[i] = timer.fWall;
     }
 
     Stats stats(samples.get(), FLAGS_samples);
-    if (FLAGS_verbose == 0) {
-        printf("%g\t%s\n", stats.min, name);
-    } else if (FLAGS_verbose == 1) {
+    if (FLAGS_verbose == 1) {
         // Get a rough idea of how noisy the measurements were.
         const double noisePercent = 100 * sqrt(stats.var) / stats.mean;
-        printf("%g\t%g\t%g\t±%.0f%%\t%s\n", stats.min, stats.mean, stats.max, noisePercent, name);
+        printf("%g\t%g\t%g\t±%.0f%%\t%s\t%s\n",
+               stats.min, stats.mean, stats.max, noisePercent, backend, name);
     } else if (FLAGS_verbose == 2) {
-        printf("%s", name);
+        printf("%s\t%s", backend, name);
         for (int i = 0; i < FLAGS_samples; i++) {
             printf("\t%g", samples[i]);
         }
         printf("\n");
     }
+    return stats.min;
+}
+
+// Benches both backends on src, printing their times.  Returns SkRecord's time over SkPicture's.
+static double bench_both(SkPMColor* scratch, SkPicture& src, const char* name) {
+    SkAutoTUnref<SkPicture> picture(rerecord_with_tilegrid(src));
+    SkAutoTUnref<SkPicture> record(rerecord_with_skr(src));
+
+    SkAutoTDelete<SkCanvas> canvas(SkCanvas::NewRasterDirectN32(src.width(),
+                                                                src.height(),
+                                                                scratch,
+                                                                src.width() * sizeof(SkPMColor)));
+    canvas->clipRect(SkRect::MakeWH(SkIntToScalar(FLAGS_tile), SkIntToScalar(FLAGS_tile)));
+
+    const double skp = bench(canvas.get(), *picture, "SkPicture", name);
+    const double skr = bench(canvas.get(), *record, "SkRecord", name);
+    const double ratio = skr / skp;
+    if (FLAGS_verbose == 0) {
+        printf("%g\t%g\t%.2fx\t%s\n", skp, skr, ratio, name);
+    }
+    return ratio;
 }
 
 int tool_main(int argc, char** argv);
@@ -116,6 +126,8 @@ int tool_main(int argc, char** argv) {
     SkOSFile::Iter it(FLAGS_skps[0], ".skp");
     SkString filename;
     bool failed = false;
+    double logRatioSum = 0;
+    int benched = 0;
     while (it.next(&filename)) {
         if (SkCommandLineFlags::ShouldSkip(FLAGS_match, filename.c_str())) {
             continue;
@@ -143,7 +155,13 @@ int tool_main(int argc, char** argv) {
             continue;
         }
 
-        bench(scratch.get(), *src, filename.c_str());
+        logRatioSum += log(bench_both(scratch.get(), *src, filename.c_str()));
+        benched++;
+    }
+
+    if (benched > 0) {
+        printf("SkRecord / SkPicture, geometric mean over %d SKPs: %.2fx\n",
+               benched, exp(logRatioSum / benched));
     }
     return failed ? 1 : 0;
 }
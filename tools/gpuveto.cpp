@@ -6,17 +6,22 @@
  */
 
 #include "LazyDecodeBitmap.h"
+#include "SkBackendCostModel.h"
 #include "SkCommandLineFlags.h"
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
 #include "SkStream.h"
+#include "SkString.h"
 
 DEFINE_string2(readFile, r, "", "skp file to process.");
 DEFINE_bool2(quiet, q, false, "quiet");
+DEFINE_int32(tileSize, 256, "If positive, also predict which backend draws each tile of this "
+                            "size faster, and print a map of the tiles: G for GPU, R for raster.");
 
 // This tool just loads a single skp, replays into a new SkPicture (to
 // regenerate the GPU-specific tracking information) and reports
-// the value of the suitableForGpuRasterization method.
+// the value of the suitableForGpuRasterization method, then which backend
+// SkBackendCostModel predicts is faster for each tile.
 // Return codes:
 static const int kSuccess = 0;
 static const int kError = 1;
@@ -64,6 +69,21 @@ int tool_main(int argc, char** argv) {
         SkDebugf("unsuitable\n");
     }
 
+    if (FLAGS_tileSize > 0 && !FLAGS_quiet) {
+        const SkBackendCostModel model(picture, SkISize::Make(FLAGS_tileSize, FLAGS_tileSize));
+        SkDebugf("predicted: %.0fus raster, %.0fus gpu\n",
+                 model.predictUs(SkBackendCostModel::kRaster_Backend),
+                 model.predictUs(SkBackendCostModel::kGpu_Backend));
+        for (int y = 0; y < model.tilesHigh(); ++y) {
+            SkString row;
+            for (int x = 0; x < model.tilesWide(); ++x) {
+                row.append(SkBackendCostModel::kGpu_Backend == model.suggestBackend(x, y)
+                           ? "G" : "R");
+            }
+            SkDebugf("%s\n", row.c_str());
+        }
+    }
+
     return kSuccess;
 #else
     SkDebugf("gpuveto is only useful when GPU rendering is enabled\n");
@@ -0,0 +1,282 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+// Profiles the playback of SKPs op by op: which ops and which kinds of ops take the time, and,
+// as a heatmap over the page, where on the page that time goes.
+
+#include <stdio.h>
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColor.h"
+#include "SkCommandLineFlags.h"
+#include "SkForceLinking.h"
+#include "SkGraphics.h"
+#include "SkImageEncoder.h"
+#include "SkOSFile.h"
+#include "SkPicture.h"
+#include "SkRecord.h"
+#include "SkRecordDraw.h"
+#include "SkRecordOpts.h"
+#include "SkRecorder.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkTSort.h"
+
+#include "BenchTimer.h"
+#include "LazyDecodeBitmap.h"
+
+__SK_FORCE_IMAGE_DECODER_LINKING;
+
+DEFINE_string2(skps, r, "", ".SKPs to profile.");
+DEFINE_string(match, "", "The usual filters on file names to profile.");
+DEFINE_bool2(optimize, O, false, "Run SkRecordOptimize before profiling.");
+DEFINE_int32(loops, 10, "Play each SKP back this many times.  An op's time is its fastest.");
+DEFINE_int32(top, 20, "Print this many of the slowest ops.");
+DEFINE_string(heatmaps, "", "If given, write a heatmap of each SKP into this directory.");
+DEFINE_int32(cell, 8, "Size in pixels of the squares the heatmap averages time over.");
+
+static const char* gTypeNames[] = {
+#define NAME(T) #T,
+    SK_RECORD_TYPES(NAME)
+#undef NAME
+};
+static const int kTypeCount = SK_ARRAY_COUNT(gTypeNames);
+
+struct TypeOf {
+    template <typename T>
+    SkRecords::Type operator()(const T&) { return T::kType; }
+};
+
+// Plays back a record one op at a time, timing each op.  Ops that Draw skips over get no time.
+class Profiler : SkNoncopyable {
+public:
+    Profiler(SkCanvas* canvas, WallTimer* timer, double times[])
+        : fDraw(canvas), fTimer(timer), fTimes(times) {}
+
+    unsigned index() const { return fDraw.index(); }
+    void next() { fDraw.next(); }
+
+    template <typename T>
+    void operator()(const T& op) {
+        // Draw may skip ahead, so note the index before it runs.
+        const unsigned i = fDraw.index();
+        fTimer->start();
+            fDraw(op);
+        fTimer->end();
+        fTimes[i] = fTimer->fWall;
+    }
+
+private:
+    SkRecords::Draw fDraw;
+    WallTimer* fTimer;
+    double* fTimes;
+};
+
+// Sorts op indices by decreasing time.
+struct SlowerOp {
+    explicit SlowerOp(const double* times) : fTimes(times) {}
+    bool operator()(unsigned a, unsigned b) const { return fTimes[a] > fTimes[b]; }
+    const double* fTimes;
+};
+
+// Maps 0 (no time) to transparent and 1 (the hottest cell) to opaque red, through blue and
+// yellow, so that a little time on an otherwise idle page still shows.
+static SkColor heat_color(double heat) {
+    const SkScalar hsv[3] = { SkDoubleToScalar(240 * (1 - heat)), SK_Scalar1, SK_Scalar1 };
+    return SkHSVToColor(SkToU8(64 + (int)(160 * heat)), hsv);
+}
+
+// Spreads each op's time evenly over its bounds on the page, sums it per cell and draws the
+// result over the page.
+static bool write_heatmap(const SkBitmap& page, const SkIRect bounds[], const double times[],
+                          unsigned count, const char* name) {
+    const int cell = FLAGS_cell;
+    const int cols = (page.width() + cell - 1) / cell, rows = (page.height() + cell - 1) / cell;
+    SkAutoTArray<double> heat(cols * rows);
+    sk_bzero(heat.get(), cols * rows * sizeof(double));
+
+    const SkIRect pageBounds = SkIRect::MakeWH(page.width(), page.height());
+    for (unsigned i = 0; i < count; i++) {
+        SkIRect b = bounds[i];
+        if (!b.intersect(pageBounds)) {
+            continue;
+        }
+        const double perPixel = times[i] / ((double)b.width() * b.height());
+        for (int y = b.fTop / cell; y <= (b.fBottom - 1) / cell; y++) {
+            for (int x = b.fLeft / cell; x <= (b.fRight - 1) / cell; x++) {
+                SkIRect c = SkIRect::MakeXYWH(x * cell, y * cell, cell, cell);
+                SkAssertResult(c.intersect(b));
+                heat[y * cols + x] += perPixel * c.width() * c.height();
+            }
+        }
+    }
+
+    double hottest = 0;
+    for (int i = 0; i < cols * rows; i++) {
+        hottest = SkTMax(hottest, heat[i]);
+    }
+
+    SkBitmap map;
+    if (!page.copyTo(&map)) {
+        return false;
+    }
+    SkCanvas canvas(map);
+    SkPaint paint;
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            if (heat[y * cols + x] > 0) {
+                paint.setColor(heat_color(heat[y * cols + x] / hottest));
+                canvas.drawRect(SkRect::MakeXYWH(SkIntToScalar(x * cell), SkIntToScalar(y * cell),
+                                                 SkIntToScalar(cell), SkIntToScalar(cell)),
+                                paint);
+            }
+        }
+    }
+
+    SkString basename = SkOSPath::SkBasename(name);
+    basename.remove(basename.size() - 4, 4);  // ".skp"
+    basename.append(".heatmap.png");
+    const SkString path = SkOSPath::SkPathJoin(FLAGS_heatmaps[0], basename.c_str());
+    if (!SkImageEncoder::EncodeFile(path.c_str(), map, SkImageEncoder::kPNG_Type, 100)) {
+        return false;
+    }
+    printf("heatmap written to %s\n", path.c_str());
+    return true;
+}
+
+static bool profile(const char* name, int w, int h, const SkRecord& record) {
+    const unsigned count = record.count();
+    SkAutoTArray<double> times(count), fastest(count);
+    SkAutoTArray<SkRecords::Type> types(count);
+    TypeOf typeOf;
+    for (unsigned i = 0; i < count; i++) {
+        types[i] = record.visit<SkRecords::Type>(i, typeOf);
+    }
+
+    SkBitmap page;
+    page.allocN32Pixels(w, h);
+    WallTimer timer;
+    for (int loop = 0; loop < FLAGS_loops; loop++) {
+        sk_bzero(times.get(), count * sizeof(double));
+        page.eraseColor(SK_ColorTRANSPARENT);
+        SkCanvas canvas(page);
+        for (Profiler profiler(&canvas, &timer, times.get());
+             profiler.index() < count;
+             profiler.next()) {
+            record.visit<void>(profiler.index(), profiler);
+        }
+        for (unsigned i = 0; i < count; i++) {
+            fastest[i] = 0 == loop ? times[i] : SkTMin(fastest[i], times[i]);
+        }
+    }
+
+    double total = 0;
+    double typeTimes[kTypeCount];
+    int typeCounts[kTypeCount];
+    sk_bzero(typeTimes, sizeof(typeTimes));
+    sk_bzero(typeCounts, sizeof(typeCounts));
+    for (unsigned i = 0; i < count; i++) {
+        total += fastest[i];
+        typeTimes[types[i]] += fastest[i];
+        typeCounts[types[i]]++;
+    }
+
+    printf("%s: %.3f ms over %u ops, fastest of %d loops\n", name, total, count, FLAGS_loops);
+    printf("%10s\t%6s\t%6s\t%s\n", "ms", "%", "ops", "type");
+    for (int t = 0; t < kTypeCount; t++) {
+        if (typeCounts[t] > 0) {
+            printf("%10.3f\t%6.1f\t%6d\t%s\n",
+                   typeTimes[t], 100 * typeTimes[t] / total, typeCounts[t], gTypeNames[t]);
+        }
+    }
+
+    // Each op's bounds on the page, to say where the slowest ops are.
+    SkAutoTArray<SkIRect> bounds(count);
+    SkRecords::FillBounds fill(w, h, bounds.get());
+    for (unsigned i = 0; i < count; i++) {
+        bounds[i].setEmpty();
+    }
+    for (unsigned i = 0; i < count; i++) {
+        fill.setCurrentOp(i);
+        record.visit<void>(i, fill);
+    }
+    fill.finish();
+
+    SkTDArray<unsigned> slowest;
+    for (unsigned i = 0; i < count; i++) {
+        *slowest.append() = i;
+    }
+    SkTQSort(slowest.begin(), slowest.end() - 1, SlowerOp(fastest.get()));
+    printf("%10s\t%6s\t%6s\t%-20s\t%s\n", "ms", "%", "index", "type", "bounds (l t r b)");
+    for (int i = 0; i < SkTMin(FLAGS_top, slowest.count()); i++) {
+        const unsigned op = slowest[i];
+        const SkIRect& b = bounds[op];
+        printf("%10.3f\t%6.1f\t%6u\t%-20s\t%d %d %d %d\n",
+               fastest[op], 100 * fastest[op] / total, op, gTypeNames[types[op]],
+               b.fLeft, b.fTop, b.fRight, b.fBottom);
+    }
+
+    if (FLAGS_heatmaps.count() > 0 &&
+        !write_heatmap(page, bounds.get(), fastest.get(), count, name)) {
+        SkDebugf("Could not write a heatmap for %s.\n", name);
+        return false;
+    }
+    return true;
+}
+
+int tool_main(int argc, char** argv);
+int tool_main(int argc, char** argv) {
+    SkCommandLineFlags::Parse(argc, argv);
+    SkAutoGraphics ag;
+
+    if (FLAGS_loops < 1 || FLAGS_cell < 1) {
+        SkDebugf("--loops and --cell must be positive.\n");
+        return 1;
+    }
+
+    bool failed = false;
+    for (int i = 0; i < FLAGS_skps.count(); i++) {
+        if (SkCommandLineFlags::ShouldSkip(FLAGS_match, FLAGS_skps[i])) {
+            continue;
+        }
+
+        SkAutoTUnref<SkStream> stream(SkStream::NewFromFile(FLAGS_skps[i]));
+        if (!stream) {
+            SkDebugf("Could not read %s.\n", FLAGS_skps[i]);
+            failed = true;
+            continue;
+        }
+        SkAutoTUnref<SkPicture> src(
+                SkPicture::CreateFromStream(stream, sk_tools::LazyDecodeBitmap));
+        if (!src) {
+            SkDebugf("Could not read %s as an SkPicture.\n", FLAGS_skps[i]);
+            failed = true;
+            continue;
+        }
+        const int w = src->width(), h = src->height();
+
+        SkRecord record;
+        SkRecorder canvas(&record, w, h);
+        src->draw(&canvas);
+
+        if (FLAGS_optimize) {
+            SkRecordOptimize(&record);
+        }
+
+        if (!profile(FLAGS_skps[i], w, h, record)) {
+            failed = true;
+        }
+    }
+    return failed ? 1 : 0;
+}
+
+#if !defined SK_BUILD_FOR_IOS
+int main(int argc, char * const argv[]) {
+    return tool_main(argc, (char**) argv);
+}
+#endif
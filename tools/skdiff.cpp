@@ -10,6 +10,7 @@
 #include "SkColor.h"
 #include "SkColorPriv.h"
 #include "SkTypes.h"
+#include "SkUtils.h"
 
 /*static*/ char const * const DiffRecord::ResultNames[DiffRecord::kResultCount] = {
     "EqualBits",
@@ -175,6 +176,13 @@ void compute_diff(DiffRecord* dr, DiffMetricProc diffFunction, const int colorTh
     // # of pixels at the end.
     dr->fWeightedFraction = 0;
     for (int y = 0; y < h; y++) {
+        // Most rows of most diffs match exactly, and add nothing to the totals.
+        if (0 == memcmp(dr->fBase.fBitmap.getAddr32(0, y),
+                        dr->fComparison.fBitmap.getAddr32(0, y), w * sizeof(SkPMColor))) {
+            sk_bzero(dr->fDifference.fBitmap.getAddr32(0, y), w * sizeof(SkPMColor));
+            sk_memset32(dr->fWhite.fBitmap.getAddr32(0, y), PMCOLOR_BLACK, w);
+            continue;
+        }
         for (int x = 0; x < w; x++) {
             SkPMColor c0 = *dr->fBase.fBitmap.getAddr32(x, y);
             SkPMColor c1 = *dr->fComparison.fBitmap.getAddr32(x, y);
@@ -14,9 +14,11 @@
 #include "SkImageEncoder.h"
 #include "SkOSFile.h"
 #include "SkStream.h"
+#include "SkTaskGroup.h"
 #include "SkTDArray.h"
 #include "SkTemplates.h"
 #include "SkTSearch.h"
+#include "SkThreadPool.h"
 #include "SkTypes.h"
 
 __SK_FORCE_IMAGE_DECODER_LINKING;
@@ -323,10 +325,87 @@ static void get_bounds(DiffRecord& drp) {
 #define ANSI_COLOR_RESET   "\x1b[0m"
 #endif
 
-#define VERBOSE_STATUS(status,color,filename) if (verbose) printf( "[ " color " %10s " ANSI_COLOR_RESET " ] %s\n", status, filename->c_str())
+#define VERBOSE_STATUS(status,color,filename) if (verbose) printf( "[ " color " %10s " ANSI_COLOR_RESET " ] %s\n", status, (filename)->c_str())
+
+/// Reads, compares and, if they differ, diffs the two files of drp, which both exist.
+static void compare_file_pair(DiffRecord* drp,
+                              DiffMetricProc dmp,
+                              const int colorThreshold,
+                              const SkString& outputDir,
+                              bool getBounds,
+                              bool verbose) {
+    SkAutoDataUnref baseFileBits(read_file(drp->fBase.fFullPath.c_str()));
+    if (NULL != baseFileBits) {
+        drp->fBase.fStatus = DiffResource::kRead_Status;
+    }
+    SkAutoDataUnref comparisonFileBits(read_file(drp->fComparison.fFullPath.c_str()));
+    if (NULL != comparisonFileBits) {
+        drp->fComparison.fStatus = DiffResource::kRead_Status;
+    }
+    if (NULL == baseFileBits || NULL == comparisonFileBits) {
+        if (NULL == baseFileBits) {
+            drp->fBase.fStatus = DiffResource::kCouldNotRead_Status;
+            VERBOSE_STATUS("READ FAIL", ANSI_COLOR_RED, &drp->fBase.fFilename);
+        }
+        if (NULL == comparisonFileBits) {
+            drp->fComparison.fStatus = DiffResource::kCouldNotRead_Status;
+            VERBOSE_STATUS("READ FAIL", ANSI_COLOR_RED, &drp->fComparison.fFilename);
+        }
+        drp->fResult = DiffRecord::kCouldNotCompare_Result;
+
+    } else if (are_buffers_equal(baseFileBits, comparisonFileBits)) {
+        drp->fResult = DiffRecord::kEqualBits_Result;
+        VERBOSE_STATUS("MATCH", ANSI_COLOR_GREEN, &drp->fBase.fFilename);
+    } else {
+        AutoReleasePixels arp(drp);
+        get_bitmap(baseFileBits, drp->fBase, SkImageDecoder::kDecodePixels_Mode);
+        get_bitmap(comparisonFileBits, drp->fComparison,
+                   SkImageDecoder::kDecodePixels_Mode);
+        VERBOSE_STATUS("DIFFERENT", ANSI_COLOR_RED, &drp->fBase.fFilename);
+        if (DiffResource::kDecoded_Status == drp->fBase.fStatus &&
+            DiffResource::kDecoded_Status == drp->fComparison.fStatus) {
+            create_and_write_diff_image(drp, dmp, colorThreshold,
+                                        outputDir, drp->fBase.fFilename);
+        } else {
+            drp->fResult = DiffRecord::kCouldNotCompare_Result;
+        }
+    }
+
+    if (getBounds) {
+        get_bounds(*drp);
+    }
+    SkASSERT(DiffRecord::kUnknown_Result != drp->fResult);
+}
+
+/// Runs compare_file_pair() on a thread pool.  Deletes itself.
+class ComparePairTask : public SkRunnable {
+public:
+    ComparePairTask(DiffRecord* drp, DiffMetricProc dmp, int colorThreshold,
+                    const SkString& outputDir, bool getBounds, bool verbose)
+        : fDrp(drp)
+        , fDmp(dmp)
+        , fColorThreshold(colorThreshold)
+        , fOutputDir(outputDir)
+        , fGetBounds(getBounds)
+        , fVerbose(verbose) {}
+
+    virtual void run() SK_OVERRIDE {
+        compare_file_pair(fDrp, fDmp, fColorThreshold, fOutputDir, fGetBounds, fVerbose);
+        SkDELETE(this);
+    }
+
+private:
+    DiffRecord*     fDrp;
+    DiffMetricProc  fDmp;
+    const int       fColorThreshold;
+    const SkString& fOutputDir;     // Unowned, outlives the task.
+    const bool      fGetBounds;
+    const bool      fVerbose;
+};
 
 /// Creates difference images, returns the number that have a 0 metric.
 /// If outputDir.isEmpty(), don't write out diff files.
+/// File pairs are compared on pool's threads, or serially if it has none.
 static void create_diff_images (DiffMetricProc dmp,
                                 const int colorThreshold,
                                 RecordArray* differences,
@@ -338,10 +417,14 @@ static void create_diff_images (DiffMetricProc dmp,
                                 bool recurseIntoSubdirs,
                                 bool getBounds,
                                 bool verbose,
+                                SkThreadPool* pool,
                                 DiffSummary* summary) {
     SkASSERT(!baseDir.isEmpty());
     SkASSERT(!comparisonDir.isEmpty());
 
+    SkTaskGroup group(pool);
+    const int firstRecord = differences->count();
+
     FileArray baseFiles;
     FileArray comparisonFiles;
 
@@ -421,45 +504,14 @@ static void create_diff_images (DiffMetricProc dmp,
             drp->fComparison.fFullPath = comparisonPath;
             drp->fComparison.fStatus = DiffResource::kExists_Status;
 
-            SkAutoDataUnref baseFileBits(read_file(drp->fBase.fFullPath.c_str()));
-            if (NULL != baseFileBits) {
-                drp->fBase.fStatus = DiffResource::kRead_Status;
-            }
-            SkAutoDataUnref comparisonFileBits(read_file(drp->fComparison.fFullPath.c_str()));
-            if (NULL != comparisonFileBits) {
-                drp->fComparison.fStatus = DiffResource::kRead_Status;
-            }
-            if (NULL == baseFileBits || NULL == comparisonFileBits) {
-                if (NULL == baseFileBits) {
-                    drp->fBase.fStatus = DiffResource::kCouldNotRead_Status;
-                    VERBOSE_STATUS("READ FAIL", ANSI_COLOR_RED, baseFiles[i]);
-                }
-                if (NULL == comparisonFileBits) {
-                    drp->fComparison.fStatus = DiffResource::kCouldNotRead_Status;
-                    VERBOSE_STATUS("READ FAIL", ANSI_COLOR_RED, comparisonFiles[j]);
-                }
-                drp->fResult = DiffRecord::kCouldNotCompare_Result;
-
-            } else if (are_buffers_equal(baseFileBits, comparisonFileBits)) {
-                drp->fResult = DiffRecord::kEqualBits_Result;
-                VERBOSE_STATUS("MATCH", ANSI_COLOR_GREEN, baseFiles[i]);
-            } else {
-                AutoReleasePixels arp(drp);
-                get_bitmap(baseFileBits, drp->fBase, SkImageDecoder::kDecodePixels_Mode);
-                get_bitmap(comparisonFileBits, drp->fComparison,
-                           SkImageDecoder::kDecodePixels_Mode);
-                VERBOSE_STATUS("DIFFERENT", ANSI_COLOR_RED, baseFiles[i]);
-                if (DiffResource::kDecoded_Status == drp->fBase.fStatus &&
-                    DiffResource::kDecoded_Status == drp->fComparison.fStatus) {
-                    create_and_write_diff_image(drp, dmp, colorThreshold,
-                                                outputDir, drp->fBase.fFilename);
-                } else {
-                    drp->fResult = DiffRecord::kCouldNotCompare_Result;
-                }
-            }
+            // Reading, decoding and diffing the pair is the slow part, so that goes to the pool.
+            differences->push(drp);
+            group.add(SkNEW_ARGS(ComparePairTask, (drp, dmp, colorThreshold, outputDir,
+                                                   getBounds, verbose)));
 
             ++i;
             ++j;
+            continue;
         }
 
         if (getBounds) {
@@ -467,7 +519,6 @@ static void create_diff_images (DiffMetricProc dmp,
         }
         SkASSERT(DiffRecord::kUnknown_Result != drp->fResult);
         differences->push(drp);
-        summary->add(drp);
     }
 
     for (; i < baseFiles.count(); ++i) {
@@ -488,7 +539,6 @@ static void create_diff_images (DiffMetricProc dmp,
             get_bounds(*drp);
         }
         differences->push(drp);
-        summary->add(drp);
     }
 
     for (; j < comparisonFiles.count(); ++j) {
@@ -509,7 +559,11 @@ static void create_diff_images (DiffMetricProc dmp,
             get_bounds(*drp);
         }
         differences->push(drp);
-        summary->add(drp);
+    }
+
+    group.wait();
+    for (int k = firstRecord; k < differences->count(); ++k) {
+        summary->add((*differences)[k]);
     }
 
     release_file_list(&baseFiles);
@@ -546,6 +600,8 @@ static void usage (char * argv0) {
 "\n    --sortbymaxmismatch: sort by worst color channel mismatch;"
 "\n                         break ties with -sortbymismatch"
 "\n    --sortbymismatch: sort by average color channel mismatch"
+"\n    --threads <n>: compare file pairs on n threads, or one per core if n is -1;"
+"\n                   0 compares them serially [default 0]"
 "\n    --threshold <n>: only report differences > n (per color channel) [default 0]"
 "\n    --weighted: sort by # pixels different weighted by color difference"
 "\n"
@@ -581,6 +637,7 @@ int tool_main(int argc, char** argv) {
     bool printDirNames = true;
     bool recurseIntoSubdirs = true;
     bool verbose = false;
+    int threadCount = 0;
 
     RecordArray differences;
     DiffSummary summary;
@@ -680,6 +737,10 @@ int tool_main(int argc, char** argv) {
             sortProc = compare<CompareDiffMeanMismatches>;
             continue;
         }
+        if (!strcmp(argv[i], "--threads")) {
+            threadCount = atoi(argv[++i]);
+            continue;
+        }
         if (!strcmp(argv[i], "--threshold")) {
             colorThreshold = atoi(argv[++i]);
             continue;
@@ -752,10 +813,13 @@ int tool_main(int argc, char** argv) {
         matchSubstrings.push(new SkString(""));
     }
 
-    create_diff_images(diffProc, colorThreshold, &differences,
-                       baseDir, comparisonDir, outputDir,
-                       matchSubstrings, nomatchSubstrings, recurseIntoSubdirs, generateDiffs,
-                       verbose, &summary);
+    {
+        SkThreadPool pool(threadCount);
+        create_diff_images(diffProc, colorThreshold, &differences,
+                           baseDir, comparisonDir, outputDir,
+                           matchSubstrings, nomatchSubstrings, recurseIntoSubdirs, generateDiffs,
+                           verbose, &pool, &summary);
+    }
     summary.print(listFilenames, failOnResultType, failOnStatusType);
 
     if (differences.count()) {
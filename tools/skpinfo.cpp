@@ -103,6 +103,10 @@ int tool_main(int argc, char** argv) {
             if (FLAGS_tags && !FLAGS_quiet) {
                 SkDebugf("SK_PICT_READER_TAG %d\n", chunkSize);
             }
+            if (info.fVersion >= 29) {
+                // The payload is preceded by its 4 byte alignment padding.
+                chunkSize += stream.readU32();
+            }
             break;
         case SK_PICT_FACTORY_TAG:
             if (FLAGS_tags && !FLAGS_quiet) {
@@ -136,6 +140,20 @@ int tool_main(int argc, char** argv) {
             if (FLAGS_tags && !FLAGS_quiet) {
                 SkDebugf("SK_PICT_BUFFER_SIZE_TAG %d\n", chunkSize);
             }
+            if (info.fVersion >= 29) {
+                // The payload is preceded by its 4 byte alignment padding.
+                chunkSize += stream.readU32();
+            }
+            break;
+        case SK_PICT_DEFLATED_READER_TAG:
+            if (FLAGS_tags && !FLAGS_quiet) {
+                SkDebugf("SK_PICT_DEFLATED_READER_TAG %d\n", chunkSize);
+            }
+            break;
+        case SK_PICT_DEFLATED_BUFFER_SIZE_TAG:
+            if (FLAGS_tags && !FLAGS_quiet) {
+                SkDebugf("SK_PICT_DEFLATED_BUFFER_SIZE_TAG %d\n", chunkSize);
+            }
             break;
         default:
             if (!FLAGS_quiet) {